@@ -63,9 +63,30 @@ CgroupsMgr::CgroupsMgr(ExecEnv* exec_env, const string& root_cgroups_path)
 CgroupsMgr::~CgroupsMgr() {
 }
 
+int32_t CgroupsMgr::get_level_share(const std::string& user, const std::string& level,
+                                    int32_t default_share) {
+    std::lock_guard<std::mutex> l(_shares_lock);
+    auto user_it = _level_shares.find(user);
+    if (user_it == _level_shares.end()) {
+        return default_share;
+    }
+    auto it = user_it->second.find(level);
+    if (it == user_it->second.end() || it->second <= 0) {
+        return default_share;
+    }
+    return it->second;
+}
+
 AgentStatus CgroupsMgr::update_local_cgroups(const TFetchResourceResult&  new_fetched_resource) {
    
     std::lock_guard<std::mutex> lck(_update_cgroups_mtx);
+    {
+        std::lock_guard<std::mutex> l(_shares_lock);
+        _level_shares.clear();
+        for (auto& it : new_fetched_resource.resourceByUser) {
+            _level_shares[it.first] = it.second.shareByGroup;
+        }
+    }
     if (!_is_cgroups_init_success) {
         return AgentStatus::DORIS_ERROR;
     }
@@ -106,6 +106,12 @@ public:
         return _cur_version;
     }
 
+    // Returns the share of the resource group 'level' of 'user' fetched from fe,
+    // 'default_share' if it is not known. It is kept even if cgroups are not
+    // used, the scanner threads are shared by it too.
+    int32_t get_level_share(const std::string& user, const std::string& level,
+                            int32_t default_share);
+
     // set the disk throttle for the user by getting resource value from the map and echo it to the cgroups.
     // currently, both the user and groups under the user are set to the same value 
     // because throttle does not support hierachy.
@@ -176,6 +182,10 @@ private:
     std::set<std::string>  _local_users;
     std::mutex _update_cgroups_mtx;    
 
+    // user -> resource group -> share
+    std::map<std::string, std::map<std::string, int32_t>> _level_shares;
+    std::mutex _shares_lock;
+
     // A static mapping from fe's resource type to cgroups file
     static std::map<TResourceType::type, std::string> _s_resource_cgroups; 
 };
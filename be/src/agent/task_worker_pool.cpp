@@ -18,15 +18,18 @@
 #include "agent/task_worker_pool.h"
 #include <pthread.h>
 #include <sys/stat.h>
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
 #include <ctime>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <sys/stat.h>
 
 #include "boost/filesystem.hpp"
@@ -49,8 +52,11 @@
 #include "service/backend_options.h"
 #include "runtime/exec_env.h"
 #include "runtime/snapshot_loader.h"
+#include "runtime/tracer.h"
 #include "util/doris_metrics.h"
+#include "util/rate_limiter.h"
 #include "util/stopwatch.hpp"
+#include "util/time.h"
 
 using std::deque;
 using std::list;
@@ -87,6 +93,8 @@ map<TTaskType::type, map<string, uint32_t>> TaskWorkerPool::_s_running_task_user
 map<TTaskType::type, map<string, uint32_t>> TaskWorkerPool::_s_total_task_user_count;
 map<TTaskType::type, uint32_t> TaskWorkerPool::_s_total_task_count;
 FrontendServiceClientCache TaskWorkerPool::_master_service_client_cache;
+std::mutex TaskWorkerPool::_s_disk_download_limiters_lock;
+std::map<std::string, std::unique_ptr<RateLimiter>> TaskWorkerPool::_s_disk_download_limiters;
 
 TaskWorkerPool::TaskWorkerPool(
         const TaskWorkerType task_worker_type,
@@ -229,6 +237,10 @@ void TaskWorkerPool::submit_task(const TAgentTaskRequest& task) {
         {
             lock_guard<Mutex> worker_thread_lock(_worker_thread_lock);
             _tasks.push_back(task);
+            _task_submit_us[signature] = MonotonicMicros();
+            if (task.__isset.priority && task.priority == TPriority::HIGH) {
+                ++_num_high_priority_tasks;
+            }
             _worker_thread_condition_lock.notify();
         }
     }
@@ -288,6 +300,67 @@ void TaskWorkerPool::_remove_task_info(
               << ", queue size: " << signature_set.size();
 }
 
+TAgentTaskRequest TaskWorkerPool::_take_task_with_lock() {
+    size_t index = 0;
+    if (_num_high_priority_tasks > 0) {
+        for (size_t i = 0; i < _tasks.size(); ++i) {
+            if (_tasks[i].__isset.priority && _tasks[i].priority == TPriority::HIGH) {
+                index = i;
+                break;
+            }
+        }
+    }
+    TAgentTaskRequest task = std::move(_tasks[index]);
+    _tasks.erase(_tasks.begin() + index);
+    _on_task_taken_with_lock(task);
+    return task;
+}
+
+// Queue metrics of the tasks of a type, registered when the first task of
+// the type is taken. They live as long as the process.
+struct TaskQueueMetrics {
+    // tasks taken out of the queue
+    IntCounter tasks_total;
+    // sum of the time they waited in the queue
+    IntCounter queue_time_us;
+};
+
+static TaskQueueMetrics* get_task_queue_metrics(TTaskType::type task_type) {
+    static std::mutex s_lock;
+    static std::map<TTaskType::type, TaskQueueMetrics*> s_metrics;
+    std::lock_guard<std::mutex> l(s_lock);
+    TaskQueueMetrics*& metrics = s_metrics[task_type];
+    if (metrics == nullptr) {
+        metrics = new TaskQueueMetrics();
+        std::string task_name;
+        EnumToString(TTaskType, task_type, task_name);
+        if (DorisMetrics::metrics() != nullptr) {
+            DorisMetrics::metrics()->register_metric(
+                "agent_task_queue_tasks_total", MetricLabels().add("type", task_name),
+                &metrics->tasks_total);
+            DorisMetrics::metrics()->register_metric(
+                "agent_task_queue_time_us", MetricLabels().add("type", task_name),
+                &metrics->queue_time_us);
+        }
+    }
+    return metrics;
+}
+
+void TaskWorkerPool::_on_task_taken_with_lock(const TAgentTaskRequest& task) {
+    if (task.__isset.priority && task.priority == TPriority::HIGH) {
+        --_num_high_priority_tasks;
+    }
+    auto it = _task_submit_us.find(task.signature);
+    if (it == _task_submit_us.end()) {
+        return;
+    }
+    int64_t queue_time_us = MonotonicMicros() - it->second;
+    _task_submit_us.erase(it);
+    TaskQueueMetrics* metrics = get_task_queue_metrics(task.task_type);
+    metrics->tasks_total.increment(1);
+    metrics->queue_time_us.increment(queue_time_us);
+}
+
 void TaskWorkerPool::_spawn_callback_worker_thread(CALLBACK_FUNCTION callback_func) {
     // Create worker thread
     pthread_t thread;
@@ -426,9 +499,8 @@ void* TaskWorkerPool::_create_table_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             create_tablet_req = agent_task_req.create_tablet_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         TStatusCode::type status_code = TStatusCode::OK;
@@ -478,9 +550,8 @@ void* TaskWorkerPool::_drop_table_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             drop_tablet_req = agent_task_req.drop_tablet_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         TStatusCode::type status_code = TStatusCode::OK;
@@ -525,9 +596,8 @@ void* TaskWorkerPool::_alter_table_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             alter_tablet_request = agent_task_req.alter_tablet_req;
-            worker_pool_this->_tasks.pop_front();
         }
         // Try to register to cgroups_mgr
         CgroupsMgr::apply_system_cgroup();
@@ -739,6 +809,7 @@ void* TaskWorkerPool::_push_worker_thread_callback(void* arg_this) {
             }
             push_req = agent_task_req.push_req;
             worker_pool_this->_tasks.erase(worker_pool_this->_tasks.begin() + index);
+            worker_pool_this->_on_task_taken_with_lock(agent_task_req);
         } while (0);
 
 #ifndef BE_TEST
@@ -864,9 +935,8 @@ void* TaskWorkerPool::_publish_version_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             publish_version_req = agent_task_req.publish_version_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         DorisMetrics::publish_task_request_total.increment(1);
@@ -879,6 +949,12 @@ void* TaskWorkerPool::_publish_version_worker_thread_callback(void* arg_this) {
         vector<TTabletId> error_tablet_ids;
         uint32_t retry_time = 0;
         OLAPStatus res = OLAP_SUCCESS;
+        // a publish which is not part of a traced load is sampled by its transaction
+        Span span(publish_version_req.__isset.trace_context
+                  ? TraceContext::from_thrift(publish_version_req.trace_context)
+                  : Tracer::instance()->trace_context(0, publish_version_req.transaction_id),
+                  "publish_version");
+        span.add_attribute("transaction_id", publish_version_req.transaction_id);
         while (retry_time < PUBLISH_VERSION_MAX_RETRY) {
             error_tablet_ids.clear();
             res = worker_pool_this->_env->olap_engine()->publish_version(
@@ -893,6 +969,12 @@ void* TaskWorkerPool::_publish_version_worker_thread_callback(void* arg_this) {
                 sleep(1);
             }
         }
+        span.add_attribute("retries", retry_time);
+        span.add_attribute("error_tablets", error_tablet_ids.size());
+        if (res != OLAP_SUCCESS) {
+            span.set_status(Status("publish version failed"));
+        }
+        span.end();
 
         TFinishTaskRequest finish_task_request;
         if (res != OLAP_SUCCESS) {
@@ -935,9 +1017,8 @@ void* TaskWorkerPool::_clear_alter_task_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             clear_alter_task_req = agent_task_req.clear_alter_task_req;
-            worker_pool_this->_tasks.pop_front();
         }
         LOG(INFO) << "get clear alter task task, signature:" << agent_task_req.signature;
 
@@ -987,9 +1068,8 @@ void* TaskWorkerPool::_clear_transaction_task_worker_thread_callback(void* arg_t
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             clear_transaction_task_req = agent_task_req.clear_transaction_task_req;
-            worker_pool_this->_tasks.pop_front();
         }
         LOG(INFO) << "get clear transaction task task, signature:" << agent_task_req.signature
                   << ", transaction_id:" << clear_transaction_task_req.transaction_id;
@@ -1036,9 +1116,8 @@ void* TaskWorkerPool::_clone_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             clone_req = agent_task_req.clone_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         DorisMetrics::clone_requests_total.increment(1);
@@ -1289,6 +1368,239 @@ void* TaskWorkerPool::_clone_worker_thread_callback(void* arg_this) {
     return (void*)0;
 }
 
+// Runs 'task' for 0 .. num_tasks - 1 on up to 'num_threads' threads. No more
+// tasks are started once one fails, its status is returned.
+static Status run_in_parallel(size_t num_tasks, int num_threads,
+                              const std::function<Status(size_t)>& task) {
+    std::atomic<size_t> next_task(0);
+    std::atomic<bool> failed(false);
+    std::mutex status_lock;
+    Status status;
+    auto worker = [&] () {
+        while (!failed) {
+            size_t i = next_task++;
+            if (i >= num_tasks) {
+                return;
+            }
+            Status task_status = task(i);
+            if (!task_status.ok()) {
+                std::lock_guard<std::mutex> l(status_lock);
+                if (!failed) {
+                    status = task_status;
+                    failed = true;
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    size_t num_workers = std::max<size_t>(1, std::min<size_t>(num_threads, num_tasks));
+    for (size_t i = 1; i < num_workers; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return status;
+}
+
+// Links 'local_file_path' to the file of 'link_path' if it has the size and
+// the md5 of the remote file. Sources which do not send the md5 have no
+// files linked.
+static bool link_same_file(
+        const std::string& remote_file_path,
+        const std::string& link_path,
+        const std::string& local_file_path,
+        int64_t file_size) {
+    struct stat st;
+    if (stat(link_path.c_str(), &st) != 0 || st.st_size != file_size) {
+        return false;
+    }
+    std::string remote_md5;
+    auto get_md5_cb = [&remote_file_path, &remote_md5] (HttpClient* client) {
+        RETURN_IF_ERROR(client->init(remote_file_path + "&checksum=md5"));
+        client->set_timeout_ms(GET_LENGTH_TIMEOUT * 1000);
+        RETURN_IF_ERROR(client->head());
+        remote_md5 = client->get_response_header(HttpHeaders::CONTENT_MD5);
+        return Status::OK;
+    };
+    if (!HttpClient::execute_with_retry(DOWNLOAD_FILE_MAX_RETRY, 1, get_md5_cb).ok()
+            || remote_md5.empty()) {
+        return false;
+    }
+    std::string local_md5;
+    if (!FileUtils::md5sum(link_path, &local_md5).ok() || local_md5 != remote_md5) {
+        return false;
+    }
+    if (link(link_path.c_str(), local_file_path.c_str()) != 0) {
+        LOG(WARNING) << "fail to link the same file when clone. from=" << link_path
+            << ", to=" << local_file_path << ", errno=" << errno;
+        return false;
+    }
+    return true;
+}
+
+static Status download_files(
+        const std::string& remote_dir_url,
+        const std::string& local_dir,
+        const std::string& link_dir,
+        const std::vector<std::string>& file_names,
+        RateLimiter* limiter,
+        int64_t signature,
+        uint64_t* total_size) {
+    // get file lengths
+    std::vector<int64_t> file_sizes(file_names.size(), 0);
+    RETURN_IF_ERROR(run_in_parallel(file_names.size(), config::clone_download_threads,
+            [&] (size_t i) {
+        std::string remote_file_path = remote_dir_url + file_names[i];
+        auto get_file_size_cb = [&remote_file_path, &file_sizes, i] (HttpClient* client) {
+            RETURN_IF_ERROR(client->init(remote_file_path));
+            client->set_timeout_ms(GET_LENGTH_TIMEOUT * 1000);
+            RETURN_IF_ERROR(client->head());
+            file_sizes[i] = client->get_content_length();
+            return Status::OK;
+        };
+        Status st = HttpClient::execute_with_retry(DOWNLOAD_FILE_MAX_RETRY, 1, get_file_size_cb);
+        if (!st.ok()) {
+            LOG(WARNING) << "clone copy get file length failed over max time. remote_path="
+                << remote_file_path
+                << ", signature=" << signature;
+        }
+        return st;
+    }));
+
+    // files the tablet already has are linked instead of downloaded
+    std::vector<char> linked(file_names.size(), 0);
+    if (!link_dir.empty()) {
+        RETURN_IF_ERROR(run_in_parallel(file_names.size(), config::clone_download_threads,
+                [&] (size_t i) {
+            linked[i] = link_same_file(remote_dir_url + file_names[i],
+                                       link_dir + file_names[i],
+                                       local_dir + file_names[i],
+                                       file_sizes[i]);
+            return Status::OK;
+        }));
+    }
+
+    // large files are split into ranges downloaded at the same time
+    struct FileRange {
+        size_t file;
+        int64_t offset;
+        int64_t length;
+    };
+    std::vector<FileRange> ranges;
+    int64_t range_bytes = config::clone_download_range_mb * 1024 * 1024;
+    for (size_t i = 0; i < file_names.size(); ++i) {
+        if (linked[i]) {
+            continue;
+        }
+        if (range_bytes <= 0 || file_sizes[i] <= range_bytes) {
+            ranges.push_back({i, 0, file_sizes[i]});
+            continue;
+        }
+        for (int64_t offset = 0; offset < file_sizes[i]; offset += range_bytes) {
+            ranges.push_back({i, offset, std::min(range_bytes, file_sizes[i] - offset)});
+        }
+    }
+
+    RETURN_IF_ERROR(run_in_parallel(ranges.size(), config::clone_download_threads,
+            [&] (size_t i) {
+        const FileRange& range = ranges[i];
+        std::string remote_file_path = remote_dir_url + file_names[range.file];
+        std::string local_file_path = local_dir + file_names[range.file];
+        uint64_t estimate_timeout = range.length / config::download_low_speed_limit_kbps / 1024;
+        if (estimate_timeout < config::download_low_speed_time) {
+            estimate_timeout = config::download_low_speed_time;
+        }
+        // kept across retries, which resume after the bytes written
+        int64_t downloaded = 0;
+        auto download_cb = [&] (HttpClient* client) {
+            RETURN_IF_ERROR(client->init(remote_file_path));
+            client->set_timeout_ms(estimate_timeout * 1000);
+            return client->download_range(local_file_path, range.offset, range.length,
+                                          limiter, &downloaded);
+        };
+        Status st = HttpClient::execute_with_retry(DOWNLOAD_FILE_MAX_RETRY, 1, download_cb);
+        if (!st.ok()) {
+            LOG(WARNING) << "download file failed over max retry."
+                << ", remote_path=" << remote_file_path
+                << ", offset=" << range.offset + downloaded
+                << ", signature=" << signature
+                << ", errormsg=" << st.get_error_msg();
+        }
+        return st;
+    }));
+
+    // Check file length
+    for (size_t i = 0; i < file_names.size(); ++i) {
+        std::string local_file_path = local_dir + file_names[i];
+        uint64_t local_file_size = boost::filesystem::file_size(local_file_path);
+        if (local_file_size != static_cast<uint64_t>(file_sizes[i])) {
+            LOG(WARNING) << "download file length error"
+                << ", remote_path=" << remote_dir_url + file_names[i]
+                << ", file_size=" << file_sizes[i]
+                << ", local_file_size=" << local_file_size;
+            return Status("downloaded file size is not equal");
+        }
+        if (linked[i]) {
+            continue;
+        }
+        chmod(local_file_path.c_str(), S_IRUSR | S_IWUSR);
+        *total_size += file_sizes[i];
+    }
+    return Status::OK;
+}
+
+Status TaskWorkerPool::_download_clone_files(
+        const std::string& remote_dir_url,
+        const std::string& local_dir,
+        const std::string& link_dir,
+        const std::vector<std::string>& file_names,
+        int64_t signature,
+        uint64_t* total_size) {
+    // If the header file is not exist, the table could't loaded by olap engine.
+    // Avoid of data is not complete, we copy the header file at last.
+    std::vector<std::string> data_files;
+    std::vector<std::string> header_files;
+    for (auto& file_name : file_names) {
+        if (file_name.size() > 4 && file_name.substr(file_name.size() - 4, 4) == ".hdr") {
+            header_files.push_back(file_name);
+        } else {
+            data_files.push_back(file_name);
+        }
+    }
+    RateLimiter* limiter = _get_disk_download_limiter(local_dir);
+    *total_size = 0;
+    RETURN_IF_ERROR(download_files(remote_dir_url, local_dir, link_dir, data_files, limiter,
+                                   signature, total_size));
+    // the header of the source is always downloaded
+    return download_files(remote_dir_url, local_dir, "", header_files, limiter,
+                          signature, total_size);
+}
+
+RateLimiter* TaskWorkerPool::_get_disk_download_limiter(const std::string& local_path) {
+    if (config::clone_disk_max_download_mbps <= 0) {
+        return nullptr;
+    }
+    // the disk of the longest path the local path is in
+    std::string disk_path;
+    for (auto store : _env->olap_engine()->get_stores()) {
+        const std::string& path = store->path();
+        if (local_path.compare(0, path.size(), path) == 0 && path.size() > disk_path.size()) {
+            disk_path = path;
+        }
+    }
+    int64_t bytes_per_second = config::clone_disk_max_download_mbps * 1024L * 1024L;
+    std::lock_guard<std::mutex> l(_s_disk_download_limiters_lock);
+    std::unique_ptr<RateLimiter>& limiter = _s_disk_download_limiters[disk_path];
+    if (limiter == nullptr) {
+        limiter.reset(new RateLimiter(bytes_per_second));
+    } else {
+        limiter->set_rate(bytes_per_second);
+    }
+    return limiter.get();
+}
+
 AgentStatus TaskWorkerPool::_clone_copy(
         const TCloneReq& clone_req,
         int64_t signature,
@@ -1303,7 +1615,12 @@ AgentStatus TaskWorkerPool::_clone_copy(
     AgentStatus status = DORIS_SUCCESS;
 
     std::string token = _master_info.token;
-    for (auto& src_backend : clone_req.src_backends) {
+    // clones of the tablets of a lost backend start at different replicas,
+    // instead of all reading from the first one
+    size_t num_src_backends = clone_req.src_backends.size();
+    for (size_t k = 0; k < num_src_backends; ++k) {
+        const TBackend& src_backend =
+            clone_req.src_backends[(clone_req.tablet_id + k) % num_src_backends];
         stringstream http_host_stream;
         http_host_stream << "http://" << src_backend.host << ":" << src_backend.http_port;
         string http_host = http_host_stream.str();
@@ -1448,71 +1765,24 @@ AgentStatus TaskWorkerPool::_clone_copy(
             }
         }
 
-        // Get copy from remote
+        // Get copy from remote, the files a tablet already has are linked.
+        // Incremental snapshots only have the missing versions, but full ones
+        // have the files of all the versions.
+        std::string link_dir;
+        OLAPTablePtr tablet = _env->olap_engine()->get_table(
+            clone_req.tablet_id, clone_req.schema_hash);
+        if (tablet != nullptr) {
+            link_dir = tablet->tablet_path() + "/";
+        }
         uint64_t total_file_size = 0;
         MonotonicStopWatch watch;
         watch.start();
-        for (auto& file_name : file_name_list) {
-            remote_file_path = http_host + HTTP_REQUEST_PREFIX
-                + HTTP_REQUEST_TOKEN_PARAM + token
-                + HTTP_REQUEST_FILE_PARAM + src_file_full_path + file_name;
-
-            // get file length
-            uint64_t file_size = 0;
-            auto get_file_size_cb = [&remote_file_path, &file_size] (HttpClient* client) {
-                RETURN_IF_ERROR(client->init(remote_file_path));
-                client->set_timeout_ms(GET_LENGTH_TIMEOUT * 1000);
-                RETURN_IF_ERROR(client->head());
-                file_size = client->get_content_length();
-                return Status::OK;
-            };
-            download_status = HttpClient::execute_with_retry(
-                DOWNLOAD_FILE_MAX_RETRY, 1, get_file_size_cb);
-            if (!download_status.ok()) {
-                LOG(WARNING) << "clone copy get file length failed over max time. remote_path="
-                    << remote_file_path
-                    << ", signature=" << signature;
-                status = DORIS_ERROR;
-                break;
-            }
-
-            total_file_size += file_size;
-            uint64_t estimate_timeout = file_size / config::download_low_speed_limit_kbps / 1024;
-            if (estimate_timeout < config::download_low_speed_time) {
-                estimate_timeout = config::download_low_speed_time;
-            }
-
-            std::string local_file_path = local_file_full_path + file_name;
-
-            auto download_cb = [&remote_file_path,
-                                estimate_timeout,
-                                &local_file_path,
-                                file_size] (HttpClient* client) {
-                RETURN_IF_ERROR(client->init(remote_file_path));
-                client->set_timeout_ms(estimate_timeout * 1000);
-                RETURN_IF_ERROR(client->download(local_file_path));
-
-                // Check file length
-                uint64_t local_file_size = boost::filesystem::file_size(local_file_path);
-                if (local_file_size != file_size) {
-                    LOG(WARNING) << "download file length error"
-                        << ", remote_path=" << remote_file_path
-                        << ", file_size=" << file_size
-                        << ", local_file_size=" << local_file_size;
-                    return Status("downloaded file size is not equal");
-                }
-                chmod(local_file_path.c_str(), S_IRUSR | S_IWUSR);
-                return Status::OK;
-            };
-            download_status = HttpClient::execute_with_retry(
-                DOWNLOAD_FILE_MAX_RETRY, 1, download_cb);
+        if (status == DORIS_SUCCESS) {
+            download_status = _download_clone_files(remote_file_path, local_file_full_path,
+                                                    link_dir, file_name_list, signature,
+                                                    &total_file_size);
             if (!download_status.ok()) {
-                LOG(WARNING) << "download file failed over max retry."
-                    << ", remote_path=" << remote_file_path
-                    << ", signature=" << signature
-                    << ", errormsg=" << download_status.get_error_msg();
                 status = DORIS_ERROR;
-                break;
             }
         } // Clone files from remote backend
 
@@ -1568,9 +1838,8 @@ void* TaskWorkerPool::_storage_medium_migrate_worker_thread_callback(void* arg_t
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             storage_medium_migrate_req = agent_task_req.storage_medium_migrate_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         TStatusCode::type status_code = TStatusCode::OK;
@@ -1622,9 +1891,8 @@ void* TaskWorkerPool::_cancel_delete_data_worker_thread_callback(void* arg_this)
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             cancel_delete_data_req = agent_task_req.cancel_delete_data_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         LOG(INFO) << "get cancel delete data task. signature:" << agent_task_req.signature;
@@ -1678,9 +1946,8 @@ void* TaskWorkerPool::_check_consistency_worker_thread_callback(void* arg_this)
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             check_consistency_req = agent_task_req.check_consistency_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         TStatusCode::type status_code = TStatusCode::OK;
@@ -1827,6 +2094,8 @@ void* TaskWorkerPool::_report_olap_table_worker_thread_callback(void* arg_this)
     request.__set_backend(worker_pool_this->_backend);
     request.__isset.tablets = true;
     AgentStatus status = DORIS_SUCCESS;
+    // the first report is a full one
+    time_t last_full_report_time = 0;
 
 #ifndef BE_TEST
     while (true) {
@@ -1841,11 +2110,22 @@ void* TaskWorkerPool::_report_olap_table_worker_thread_callback(void* arg_this)
         request.tablets.clear();
 
         request.__set_report_version(_s_report_version);
-        OLAPStatus report_all_tablets_info_status =
-                worker_pool_this->_env->olap_engine()->report_all_tablets_info(&request.tablets);
+        // the tablets changed before the report are taken first, the ones
+        // changed while it is built are in the next report
+        std::set<TTabletId> changed_tablets;
+        worker_pool_this->_env->olap_engine()->take_changed_tablets(&changed_tablets);
+        bool is_incremental = config::enable_incremental_tablet_report
+            && time(NULL) - last_full_report_time < config::full_tablet_report_interval_seconds;
+        request.__set_incremental_tablet_report(is_incremental);
+        OLAPStatus report_all_tablets_info_status = is_incremental
+            ? worker_pool_this->_env->olap_engine()->report_tablets_info(
+                changed_tablets, &request.tablets)
+            : worker_pool_this->_env->olap_engine()->report_all_tablets_info(
+                &request.tablets, &changed_tablets);
         if (report_all_tablets_info_status != OLAP_SUCCESS) {
             OLAP_LOG_WARNING("report get all tablets info failed. status: %d",
                              report_all_tablets_info_status);
+            worker_pool_this->_env->olap_engine()->restore_changed_tablets(changed_tablets);
 #ifndef BE_TEST
             // wait for notifying until timeout
             OLAPEngine::get_instance()->wait_for_report_notify(
@@ -1864,6 +2144,9 @@ void* TaskWorkerPool::_report_olap_table_worker_thread_callback(void* arg_this)
             LOG(WARNING) << "finish report olap table state failed. status:" << status
                 << ", master host:" << worker_pool_this->_master_info.network_address.hostname
                 << ", port:" << worker_pool_this->_master_info.network_address.port;
+            worker_pool_this->_env->olap_engine()->restore_changed_tablets(changed_tablets);
+        } else if (!is_incremental) {
+            last_full_report_time = time(NULL);
         }
 
 #ifndef BE_TEST
@@ -1890,9 +2173,8 @@ void* TaskWorkerPool::_upload_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             upload_request = agent_task_req.upload_req;
-            worker_pool_this->_tasks.pop_front();
         }
 
         LOG(INFO) << "get upload task, signature:" << agent_task_req.signature
@@ -1952,9 +2234,8 @@ void* TaskWorkerPool::_download_worker_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             download_request = agent_task_req.download_req;
-            worker_pool_this->_tasks.pop_front();
         }
         // Try to register to cgroups_mgr
         CgroupsMgr::apply_system_cgroup();
@@ -2017,9 +2298,8 @@ void* TaskWorkerPool::_make_snapshot_thread_callback(void* arg_this) {
                  worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             snapshot_request = agent_task_req.snapshot_req;
-            worker_pool_this->_tasks.pop_front();
         }
         // Try to register to cgroups_mgr
         CgroupsMgr::apply_system_cgroup();
@@ -2102,9 +2382,8 @@ void* TaskWorkerPool::_release_snapshot_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             release_snapshot_request = agent_task_req.release_snapshot_req;
-            worker_pool_this->_tasks.pop_front();
         }
         // Try to register to cgroups_mgr
         CgroupsMgr::apply_system_cgroup();
@@ -2194,9 +2473,8 @@ void* TaskWorkerPool::_move_dir_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             move_dir_req =  agent_task_req.move_dir_req;
-            worker_pool_this->_tasks.pop_front();
         }
         // Try to register to cgroups_mgr
         CgroupsMgr::apply_system_cgroup();
@@ -2311,9 +2589,8 @@ void* TaskWorkerPool::_recover_tablet_thread_callback(void* arg_this) {
                 worker_pool_this->_worker_thread_condition_lock.wait();
             }
 
-            agent_task_req = worker_pool_this->_tasks.front();
+            agent_task_req = worker_pool_this->_take_task_with_lock();
             recover_tablet_req = agent_task_req.recover_tablet_req;
-            worker_pool_this->_tasks.pop_front();
         }
         // Try to register to cgroups_mgr
         CgroupsMgr::apply_system_cgroup();
@@ -23,6 +23,8 @@
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
 #include <deque>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -38,6 +40,7 @@
 namespace doris {
 
 class ExecEnv;
+class RateLimiter;
 
 class TaskWorkerPool {
 public:
@@ -93,6 +96,11 @@ private:
     void _finish_task(const TFinishTaskRequest& finish_task_request);
     uint32_t _get_next_task_index(int32_t thread_count, std::deque<TAgentTaskRequest>& tasks,
             TPriority::type priority);
+    // Takes the next task out of the queue, HIGH priority ones first.
+    // _worker_thread_lock must be held and the queue must not be empty.
+    TAgentTaskRequest _take_task_with_lock();
+    // Updates the queue time metrics of a task taken out of the queue.
+    void _on_task_taken_with_lock(const TAgentTaskRequest& task);
 
     static void* _create_table_worker_thread_callback(void* arg_this);
     static void* _drop_table_worker_thread_callback(void* arg_this);
@@ -127,6 +135,23 @@ private:
             int64_t* copy_size,
             int64_t* copy_time_ms);
 
+    // Downloads 'file_names' of the snapshot directory at 'remote_dir_url'
+    // into 'local_dir', several files and ranges of large files at a time.
+    // Header files are downloaded last, once all the data is there. Data
+    // files 'link_dir' has with the same md5 are linked, 'total_size' only
+    // counts the downloaded bytes.
+    Status _download_clone_files(
+            const std::string& remote_dir_url,
+            const std::string& local_dir,
+            const std::string& link_dir,
+            const std::vector<std::string>& file_names,
+            int64_t signature,
+            uint64_t* total_size);
+
+    // Returns the limiter of the downloads into the disk of 'local_path',
+    // nullptr if they are not limited.
+    RateLimiter* _get_disk_download_limiter(const std::string& local_path);
+
     void _alter_table(
             const TAlterTabletReq& create_rollup_request,
             int64_t signature,
@@ -164,12 +189,19 @@ private:
 #endif
 
     std::deque<TAgentTaskRequest> _tasks;
+    // monotonic time in microseconds each queued task was submitted, by signature
+    std::map<int64_t, int64_t> _task_submit_us;
+    // number of queued tasks of HIGH priority
+    size_t _num_high_priority_tasks = 0;
     Mutex _worker_thread_lock;
     Condition _worker_thread_condition_lock;
     uint32_t _worker_count;
     TaskWorkerType _task_worker_type;
     CALLBACK_FUNCTION _callback_function;
     static std::atomic_ulong _s_report_version;
+    static std::mutex _s_disk_download_limiters_lock;
+    // by the path of the disk
+    static std::map<std::string, std::unique_ptr<RateLimiter>> _s_disk_download_limiters;
     static std::map<TTaskType::type, std::set<int64_t>> _s_task_signatures;
     static std::map<TTaskType::type, std::map<std::string, uint32_t>> _s_running_task_user_count;
     static std::map<TTaskType::type, std::map<std::string, uint32_t>> _s_total_task_user_count;
@@ -0,0 +1,257 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "codegen/codegen_cache.h"
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/JIT.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "runtime/mem_tracker.h"
+#include "util/debug_util.h"
+#include "util/hash_util.hpp"
+
+namespace doris {
+
+CodegenCache::Entry::~Entry() {
+    if (_mem_tracker != NULL) {
+        _mem_tracker->release(_size);
+    }
+}
+
+void* CodegenCache::Entry::fn(const std::string& name) const {
+    auto it = _fns.find(name);
+    return it == _fns.end() ? NULL : it->second;
+}
+
+CodegenCache* CodegenCache::instance() {
+    static CodegenCache* cache = config::codegen_cache_capacity > 0
+            ? new CodegenCache(config::codegen_cache_capacity, config::codegen_cache_dir) : NULL;
+    return cache;
+}
+
+CodegenCache::CodegenCache(int64_t capacity, const std::string& dir) :
+        _dir(dir),
+        _mem_tracker(new MemTracker(capacity, "CodegenCache")) {
+}
+
+CodegenCache::~CodegenCache() {
+    // entries still used by codegens release the tracker when they are freed
+    std::lock_guard<std::mutex> l(_lock);
+    for (auto& it : _entries) {
+        it.second.entry->_mem_tracker = NULL;
+    }
+}
+
+std::string CodegenCache::make_key(const std::string& bitcode,
+                                   const std::vector<std::string>& fn_names,
+                                   const GlobalMappings& mappings) {
+    std::stringstream extra;
+    for (auto& name : fn_names) {
+        extra << name << ';';
+    }
+    // the addresses differ in every process, the functions they are of do not
+    for (auto& it : mappings) {
+        extra << it.first << ';';
+    }
+    // the functions of the process the module calls may change with its build
+    extra << get_build_version(false);
+    std::string extra_str = extra.str();
+    // two independent hashes make collisions of different modules negligible
+    uint64_t h1 = HashUtil::murmur_hash64A(bitcode.data(), bitcode.size(), 0);
+    h1 ^= HashUtil::murmur_hash64A(extra_str.data(), extra_str.size(), 0)
+        + 0x9e3779b97f4a7c15ULL + (h1 << 6) + (h1 >> 2);
+    uint64_t h2 = HashUtil::murmur_hash2_64(bitcode.data(), bitcode.size(), 0x5bd1e995);
+    h2 = HashUtil::murmur_hash2_64(extra_str.data(), extra_str.size(), h2);
+    std::stringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << h1 << std::setw(16) << h2
+        << std::dec << '_' << bitcode.size();
+    return key.str();
+}
+
+std::shared_ptr<CodegenCache::Entry> CodegenCache::lookup(
+        const std::string& key,
+        const std::vector<std::string>& fn_names,
+        const GlobalMappings& mappings) {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        auto it = _entries.find(key);
+        if (it != _entries.end() && it->second.entry->_mappings == mappings) {
+            _lru.splice(_lru.begin(), _lru, it->second.lru_pos);
+            return it->second.entry;
+        }
+    }
+    if (_dir.empty()) {
+        return NULL;
+    }
+    std::ifstream file(_file_path(key).c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        return NULL;
+    }
+    std::stringstream bitcode;
+    bitcode << file.rdbuf();
+    std::shared_ptr<Entry> entry;
+    Status status = _compile(bitcode.str(), fn_names, mappings, &entry);
+    if (!status.ok()) {
+        LOG(WARNING) << "fail to compile cached codegen module " << _file_path(key)
+            << ": " << status.get_error_msg();
+        return NULL;
+    }
+    return _add(key, entry);
+}
+
+Status CodegenCache::insert(const std::string& key, const std::string& bitcode,
+                            const std::vector<std::string>& fn_names,
+                            const GlobalMappings& mappings, std::shared_ptr<Entry>* entry) {
+    RETURN_IF_ERROR(_compile(bitcode, fn_names, mappings, entry));
+    *entry = _add(key, *entry);
+    if (!_dir.empty()) {
+        _write_file(key, bitcode);
+    }
+    return Status::OK;
+}
+
+Status CodegenCache::_compile(const std::string& bitcode,
+                              const std::vector<std::string>& fn_names,
+                              const GlobalMappings& mappings, std::shared_ptr<Entry>* entry) {
+    std::shared_ptr<Entry> result(new Entry());
+    result->_context.reset(new llvm::LLVMContext());
+    boost::scoped_ptr<llvm::MemoryBuffer> buffer(
+            llvm::MemoryBuffer::getMemBuffer(bitcode, "", false));
+    std::string error;
+    llvm::Module* module = llvm::ParseBitcodeFile(buffer.get(), *result->_context, &error);
+    if (module == NULL) {
+        return Status("could not parse codegen module: " + error);
+    }
+
+    // the same as LlvmCodeGen::init()
+    llvm::CodeGenOpt::Level opt_level = llvm::CodeGenOpt::Aggressive;
+#ifndef NDEBUG
+    opt_level = llvm::CodeGenOpt::None;
+#endif
+    llvm::EngineBuilder builder = llvm::EngineBuilder(module).setOptLevel(opt_level);
+    builder.setErrorStr(&error);
+    result->_engine.reset(builder.create());
+    if (result->_engine == NULL) {
+        delete module;
+        return Status("could not create execution engine: " + error);
+    }
+    // the entry is called by several threads, all functions are compiled now
+    // instead of on their first call
+    result->_engine->DisableLazyCompilation(true);
+    for (auto& it : mappings) {
+        llvm::Function* fn = module->getFunction(it.first);
+        if (fn != NULL) {
+            result->_engine->addGlobalMapping(fn, it.second);
+        }
+    }
+    for (auto& name : fn_names) {
+        llvm::Function* fn = module->getFunction(name);
+        void* fn_ptr = fn == NULL ? NULL : result->_engine->getPointerToFunction(fn);
+        if (fn_ptr == NULL) {
+            return Status("could not compile codegen function " + name);
+        }
+        result->_fns[name] = fn_ptr;
+    }
+    result->_mappings = mappings;
+    // the module and its machine code are each about as large as the bitcode
+    result->_size = bitcode.size() * 2;
+    *entry = result;
+    return Status::OK;
+}
+
+std::shared_ptr<CodegenCache::Entry> CodegenCache::_add(const std::string& key,
+                                                       std::shared_ptr<Entry> entry) {
+    std::lock_guard<std::mutex> l(_lock);
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        if (it->second.entry->_mappings == entry->_mappings) {
+            // compiled by another fragment at the same time
+            _lru.splice(_lru.begin(), _lru, it->second.lru_pos);
+            return it->second.entry;
+        }
+        // e.g. a library of native UDFs is loaded again
+        _evict(it);
+    }
+    while (!_mem_tracker->try_consume(entry->_size)) {
+        if (_lru.empty()) {
+            // larger than the cache, only used by its codegen
+            return entry;
+        }
+        _evict(_entries.find(_lru.back()));
+    }
+    entry->_mem_tracker = _mem_tracker.get();
+    _lru.push_front(key);
+    CachedEntry& cached = _entries[key];
+    cached.entry = entry;
+    cached.lru_pos = _lru.begin();
+    return entry;
+}
+
+void CodegenCache::_evict(EntryMap::iterator it) {
+    // the codegens still using the entry keep it, its memory is not the cache's
+    // any more, else entries in use would evict all others
+    Entry* entry = it->second.entry.get();
+    if (entry->_mem_tracker != NULL) {
+        entry->_mem_tracker->release(entry->_size);
+        entry->_mem_tracker = NULL;
+    }
+    _lru.erase(it->second.lru_pos);
+    _entries.erase(it);
+}
+
+std::string CodegenCache::_file_path(const std::string& key) const {
+    return _dir + "/" + key + ".bc";
+}
+
+void CodegenCache::_write_file(const std::string& key, const std::string& bitcode) {
+    std::string path = _file_path(key);
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG(WARNING) << "fail to open " << tmp_path << " to persist codegen module";
+            return;
+        }
+        file.write(bitcode.data(), bitcode.size());
+        if (!file.good()) {
+            LOG(WARNING) << "fail to write codegen module to " << tmp_path;
+            file.close();
+            remove(tmp_path.c_str());
+            return;
+        }
+    }
+    // readers never see partly written modules
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        LOG(WARNING) << "fail to rename " << tmp_path << " to " << path;
+        remove(tmp_path.c_str());
+    }
+}
+
+}
@@ -0,0 +1,142 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_CODEGEN_CODEGEN_CACHE_H
+#define DORIS_BE_SRC_CODEGEN_CODEGEN_CACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "common/status.h"
+
+namespace llvm {
+class ExecutionEngine;
+class LLVMContext;
+}
+
+namespace doris {
+
+class MemTracker;
+
+// Machine code of optimized codegen modules shared by the fragments of all
+// queries, so repeated queries skip the optimization and compilation of their
+// IR. Entries are keyed by the hash of the module before optimization, the
+// functions to jit, the names of the functions mapped into it and the build of
+// the process, which stay the same after a restart. The addresses of the mapped
+// functions do not, they are bound when an entry is compiled, and an entry is
+// compiled again for other addresses. Each entry is compiled in its own context
+// from the bitcode of the optimized module and kept in LRU order within
+// config::codegen_cache_capacity bytes, tracked by a MemTracker. If
+// config::codegen_cache_dir is set the optimized bitcode is also written there
+// and read back by a later process, which then only compiles it.
+class CodegenCache {
+public:
+    // Addresses of functions which are declared in a module but not defined by
+    // the process, e.g. of native UDFs, by function name
+    typedef std::map<std::string, void*> GlobalMappings;
+
+    class Entry {
+    public:
+        ~Entry();
+
+        // Returns the compiled function 'name', NULL if it was not compiled.
+        void* fn(const std::string& name) const;
+
+    private:
+        friend class CodegenCache;
+
+        Entry() : _size(0), _mem_tracker(NULL) { }
+
+        // the engine owns the module, it is destroyed before the context
+        boost::scoped_ptr<llvm::LLVMContext> _context;
+        boost::scoped_ptr<llvm::ExecutionEngine> _engine;
+        std::map<std::string, void*> _fns;
+        // the addresses the functions are compiled with
+        GlobalMappings _mappings;
+        int64_t _size;
+        // set while the cache holds the entry and its size is consumed from it
+        MemTracker* _mem_tracker;
+    };
+
+    // The process wide cache, NULL if config::codegen_cache_capacity is not positive.
+    static CodegenCache* instance();
+
+    CodegenCache(int64_t capacity, const std::string& dir);
+    ~CodegenCache();
+
+    // Returns the key of a not optimized module given as 'bitcode', from which
+    // 'fn_names' are compiled with 'mappings'. Only the names of 'mappings' are
+    // part of it.
+    static std::string make_key(const std::string& bitcode,
+                                const std::vector<std::string>& fn_names,
+                                const GlobalMappings& mappings);
+
+    // Returns the entry of 'key' compiled with 'mappings', compiled from the
+    // cache dir if it is only there or with other addresses, NULL if there is none.
+    std::shared_ptr<Entry> lookup(const std::string& key,
+                                  const std::vector<std::string>& fn_names,
+                                  const GlobalMappings& mappings);
+
+    // Compiles 'fn_names' of the optimized module 'bitcode' and adds them as the
+    // entry of 'key', which is returned in 'entry' even if it does not fit in
+    // the cache.
+    Status insert(const std::string& key, const std::string& bitcode,
+                  const std::vector<std::string>& fn_names,
+                  const GlobalMappings& mappings, std::shared_ptr<Entry>* entry);
+
+private:
+    struct CachedEntry {
+        std::shared_ptr<Entry> entry;
+        std::list<std::string>::iterator lru_pos;
+    };
+    typedef std::unordered_map<std::string, CachedEntry> EntryMap;
+
+    Status _compile(const std::string& bitcode, const std::vector<std::string>& fn_names,
+                    const GlobalMappings& mappings, std::shared_ptr<Entry>* entry);
+
+    // Adds 'entry' unless there is one of 'key' with the same mappings already,
+    // which is returned then. Least recently used entries are evicted to make
+    // room for it.
+    std::shared_ptr<Entry> _add(const std::string& key, std::shared_ptr<Entry> entry);
+
+    // Removes the entry at 'it' and releases its size, the caller holds _lock.
+    void _evict(EntryMap::iterator it);
+
+    std::string _file_path(const std::string& key) const;
+
+    void _write_file(const std::string& key, const std::string& bitcode);
+
+    const std::string _dir;
+    boost::scoped_ptr<MemTracker> _mem_tracker;
+
+    std::mutex _lock;
+    // keys of the entries, the most recently used first
+    std::list<std::string> _lru;
+    EntryMap _entries;
+};
+
+}
+
+#endif
@@ -48,6 +48,7 @@
 #include "codegen/doris_ir_data.h"
 #include "doris_ir/doris_ir_names.h"
 #include "util/cpu_info.h"
+#include "util/doris_metrics.h"
 #include "util/path_builder.h"
 
 using llvm::Value;
@@ -93,6 +94,8 @@ LlvmCodeGen::LlvmCodeGen(ObjectPool* pool, const std::string& name) :
         _optimizations_enabled(false),
         _is_corrupt(false),
         _is_compiled(false),
+        _compile_threshold_rows(std::numeric_limits<int64_t>::max()),
+        _async_compile_started(false),
         _context(new llvm::LLVMContext()),
         _module(NULL),
         _execution_engine(NULL),
@@ -299,6 +302,7 @@ Status LlvmCodeGen::init() {
 }
 
 LlvmCodeGen::~LlvmCodeGen() {
+    wait_for_async_compile();
     for (auto& it : _jitted_functions) {
         _execution_engine->freeMachineCodeForFunction(it.first);
     }
@@ -687,15 +691,22 @@ Status LlvmCodeGen::finalize_module() {
 
     // Don't waste time optimizing module if there are no functions to JIT. This can happen
     // if the codegen object is created but no functions are successfully codegen'd.
-    if (_optimizations_enabled // TODO(zc): && !FLAGS_disable_optimization_passes 
-            && !_fns_to_jit_compile.empty()) {
+    bool optimize = _optimizations_enabled // TODO(zc): && !FLAGS_disable_optimization_passes 
+            && !_fns_to_jit_compile.empty();
+    CodegenCache* cache = CodegenCache::instance();
+    if (cache != NULL && !_fns_to_jit_compile.empty() && jit_from_cache(cache, &optimize)) {
+        return Status::OK;
+    }
+    if (optimize) {
         optimize_module();
     }
 
     SCOPED_TIMER(_compile_timer);
-    // JIT compile all codegen'd functions
+    // JIT compile all codegen'd functions. They may be read by operators running
+    // interpreted if the module is finalized by finalize_module_after_rows()
     for (int i = 0; i < _fns_to_jit_compile.size(); ++i) {
-        *_fns_to_jit_compile[i].second = jit_function(_fns_to_jit_compile[i].first);
+        __atomic_store_n(_fns_to_jit_compile[i].second,
+                         jit_function(_fns_to_jit_compile[i].first), __ATOMIC_RELEASE);
     }
 #if 0
     if (FLAGS_opt_module_dir.size() != 0) {
@@ -713,23 +724,91 @@ Status LlvmCodeGen::finalize_module() {
     return Status::OK;
 }
 
+void LlvmCodeGen::finalize_module_after_rows(int64_t threshold_rows) {
+    if (_fns_to_jit_compile.empty()) {
+        return;
+    }
+    _profile.add_info_string("CompileAfterRows", std::to_string(threshold_rows));
+    _compile_threshold_rows.store(threshold_rows);
+}
+
+void LlvmCodeGen::start_async_compile() {
+    if (_async_compile_started.exchange(true)) {
+        return;
+    }
+    _compile_threshold_rows.store(std::numeric_limits<int64_t>::max());
+    _compile_thread = boost::thread([this] {
+        Status status = finalize_module();
+        if (!status.ok()) {
+            LOG(WARNING) << "fail to finalize codegen module " << _name
+                << " asynchronously: " << status.get_error_msg();
+        }
+    });
+}
+
+void LlvmCodeGen::wait_for_async_compile() {
+    if (_compile_thread.joinable()) {
+        _compile_thread.join();
+    }
+}
+
+bool LlvmCodeGen::jit_from_cache(CodegenCache* cache, bool* optimize) {
+    std::vector<std::string> fn_names;
+    for (int i = 0; i < _fns_to_jit_compile.size(); ++i) {
+        fn_names.push_back(_fns_to_jit_compile[i].first->getName().str());
+    }
+    // the key is taken after the unused functions are removed, they are most of
+    // the cross compiled module
+    std::string key;
+    {
+        SCOPED_TIMER(_optimization_timer);
+        internalize_module();
+        key = CodegenCache::make_key(module_bitcode(), fn_names, _global_mappings);
+    }
+    std::shared_ptr<CodegenCache::Entry> entry = cache->lookup(key, fn_names, _global_mappings);
+    if (entry != NULL) {
+        DorisMetrics::codegen_cache_hits_total.increment(1);
+        _profile.add_info_string("CodegenCache", "Hit");
+    } else {
+        DorisMetrics::codegen_cache_misses_total.increment(1);
+        _profile.add_info_string("CodegenCache", "Miss");
+        if (*optimize) {
+            SCOPED_TIMER(_optimization_timer);
+            run_optimization_passes();
+        }
+        // the module is optimized now, whether it is cached or not
+        *optimize = false;
+        SCOPED_TIMER(_compile_timer);
+        Status status = cache->insert(key, module_bitcode(), fn_names, _global_mappings, &entry);
+        if (!status.ok()) {
+            LOG(WARNING) << "fail to compile codegen module " << _name << " in codegen cache: "
+                << status.get_error_msg();
+            return false;
+        }
+    }
+    for (int i = 0; i < _fns_to_jit_compile.size(); ++i) {
+        __atomic_store_n(_fns_to_jit_compile[i].second, entry->fn(fn_names[i]),
+                         __ATOMIC_RELEASE);
+    }
+    _cache_entry = entry;
+    return true;
+}
+
+std::string LlvmCodeGen::module_bitcode() const {
+    std::string bitcode;
+    llvm::raw_string_ostream stream(bitcode);
+    llvm::WriteBitcodeToFile(_module, stream);
+    stream.flush();
+    return bitcode;
+}
+
 void LlvmCodeGen::optimize_module() {
     SCOPED_TIMER(_optimization_timer);
+    internalize_module();
+    run_optimization_passes();
+}
 
-    // This pass manager will construct optimizations passes that are "typical" for
-    // c/c++ programs.  We're relying on llvm to pick the best passes for us.
-    // TODO: we can likely muck with this to get better compile speeds or write
-    // our own passes.  Our subexpression elimination optimization can be rolled into
-    // a pass.
-    PassManagerBuilder pass_builder;
-    // 2 maps to -O2
-    // TODO: should we switch to 3? (3 may not produce different IR than 2 while taking
-    // longer, but we should check)
-    pass_builder.OptLevel = 2;
-    // Don't optimize for code size (this corresponds to -O2/-O3)
-    pass_builder.SizeLevel = 0;
-    pass_builder.Inliner = llvm::createFunctionInliningPass() ;
-
+void LlvmCodeGen::internalize_module() {
     // Specifying the data layout is necessary for some optimizations (e.g. removing many
     // of the loads/stores produced by structs).
     const std::string& data_layout_str = _module->getDataLayout();
@@ -749,6 +828,24 @@ void LlvmCodeGen::optimize_module() {
     module_pass_manager->add(llvm::createInternalizePass(exported_fn_names));
     module_pass_manager->add(llvm::createGlobalDCEPass());
     module_pass_manager->run(*_module);
+}
+
+void LlvmCodeGen::run_optimization_passes() {
+    // This pass manager will construct optimizations passes that are "typical" for
+    // c/c++ programs.  We're relying on llvm to pick the best passes for us.
+    // TODO: we can likely muck with this to get better compile speeds or write
+    // our own passes.  Our subexpression elimination optimization can be rolled into
+    // a pass.
+    PassManagerBuilder pass_builder;
+    // 2 maps to -O2
+    // TODO: should we switch to 3? (3 may not produce different IR than 2 while taking
+    // longer, but we should check)
+    pass_builder.OptLevel = 2;
+    // Don't optimize for code size (this corresponds to -O2/-O3)
+    pass_builder.SizeLevel = 0;
+    pass_builder.Inliner = llvm::createFunctionInliningPass() ;
+
+    const std::string& data_layout_str = _module->getDataLayout();
 
     // Create and run function pass manager
     boost::scoped_ptr<FunctionPassManager> fn_pass_manager(new FunctionPassManager(_module));
@@ -761,7 +858,7 @@ void LlvmCodeGen::optimize_module() {
     fn_pass_manager->doFinalization();
 
     // Create and run module pass manager
-    module_pass_manager.reset(new PassManager());
+    boost::scoped_ptr<PassManager> module_pass_manager(new PassManager());
     module_pass_manager->add(new DataLayout(data_layout_str));
     pass_builder.populateModulePassManager(*module_pass_manager);
     module_pass_manager->run(*_module);
@@ -812,6 +909,11 @@ void LlvmCodeGen::add_function_to_jit(llvm::Function* fn, void** fn_ptr) {
     _fns_to_jit_compile.push_back(std::make_pair(fn, fn_ptr));
 }
 
+void LlvmCodeGen::add_global_mapping(llvm::Function* fn, void* addr) {
+    _execution_engine->addGlobalMapping(fn, addr);
+    _global_mappings[fn->getName().str()] = addr;
+}
+
 
 void* LlvmCodeGen::jit_function(llvm::Function* function, int* scratch_size) {
     if (_is_corrupt) {
@@ -868,8 +970,7 @@ void LlvmCodeGen::codegen_debug_trace(LlvmBuilder* builder, const char* str) {
         _debug_trace_fn->setCallingConv(llvm::CallingConv::C);
 
         // Add a mapping to the execution engine so it can link the debug_trace function
-        _execution_engine->addGlobalMapping(_debug_trace_fn,
-                                            reinterpret_cast<void*>(&debug_trace));
+        add_global_mapping(_debug_trace_fn, reinterpret_cast<void*>(&debug_trace));
     }
 
     // Make a copy of str into memory owned by this object.  This is no guarantee that str is
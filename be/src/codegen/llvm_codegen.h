@@ -18,11 +18,14 @@
 #ifndef DORIS_BE_SRC_QUERY_CODEGEN_LLVM_CODEGEN_H
 #define DORIS_BE_SRC_QUERY_CODEGEN_LLVM_CODEGEN_H
 
+#include <atomic>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Intrinsics.h>
@@ -33,6 +36,8 @@
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/MemoryBuffer.h>
 
+#include "codegen/codegen_cache.h"
+#include "common/compiler_util.h"
 #include "common/status.h"
 #include "runtime/primitive_type.h"
 #include "exprs/expr.h"
@@ -271,6 +276,27 @@ public:
     /// false, the module will not be optimized before compilation.
     Status finalize_module();
 
+    /// Instead of finalize_module(), compiles the module only after an operator has
+    /// processed more than 'threshold_rows' rows without its jitted functions, see
+    /// add_interpreted_rows(). The module is then finalized by a thread of its own
+    /// while the operators go on interpreted, they swap to the jitted functions at the
+    /// first batch after these are set. Modules of fragments which stay below the
+    /// threshold are never optimized.
+    void finalize_module_after_rows(int64_t threshold_rows);
+
+    /// Called by operators whose jitted functions are not set yet, with the number of
+    /// rows they have processed so far.
+    void add_interpreted_rows(int64_t num_rows) {
+        if (UNLIKELY(num_rows > _compile_threshold_rows.load(std::memory_order_relaxed))) {
+            start_async_compile();
+        }
+    }
+
+    /// Waits for the module being finalized by finalize_module_after_rows(), no
+    /// function pointer is set after it returns. Must be called before the operators
+    /// which added functions to jit are closed.
+    void wait_for_async_compile();
+
     // Optimize the entire module.  LLVM is more built for running its optimization
     // passes over the entire module (all the functions) rather than individual
     // functions.
@@ -342,6 +368,11 @@ public:
     /// call non-compliant code from native code.
     void add_function_to_jit(llvm::Function* fn, void** fn_ptr);
 
+    /// Links the declaration 'fn' to the function at 'addr' of the process, e.g. of a
+    /// native UDF. Mappings must be added by this function, not by the execution engine,
+    /// for modules compiled by the codegen cache to be linked the same.
+    void add_global_mapping(llvm::Function* fn, void* addr);
+
     // Jit compile the function.  This will run optimization passes and verify
     // the function.  The result is a function pointer that is dynamically linked
     // into the process.
@@ -498,6 +529,26 @@ private:
     friend class LlvmCodeGenTest;
     friend class SubExprElimination;
 
+    /// Marks the functions which are not jitted as internal and removes the unused
+    /// ones, the first step of optimize_module().
+    void internalize_module();
+
+    /// Runs the function and module optimization passes, the rest of optimize_module().
+    void run_optimization_passes();
+
+    /// Looks up the optimized and compiled functions of this module in 'cache', or
+    /// optimizes the module and compiles it into the cache. Sets the function pointers
+    /// of _fns_to_jit_compile and returns true on success, returns false if they must
+    /// be jitted by _execution_engine, the module is optimized then if 'optimize' is
+    /// true.
+    bool jit_from_cache(CodegenCache* cache, bool* optimize);
+
+    /// Returns the bitcode of _module.
+    std::string module_bitcode() const;
+
+    /// Starts _compile_thread, once.
+    void start_async_compile();
+
     // Top level codegen object.  'module_name' is only used for debugging when
     // outputting the IR.  module's loaded from disk will be named as the file
     // path.
@@ -556,6 +607,12 @@ private:
     // functions after this point.
     bool _is_compiled;
 
+    /// Rows after which finalize_module_after_rows() compiles the module, the maximum
+    /// of int64 if it is not deferred or already started.
+    std::atomic<int64_t> _compile_threshold_rows;
+    std::atomic<bool> _async_compile_started;
+    boost::thread _compile_thread;
+
     // Error string that llvm will write to
     std::string _error_string;
 
@@ -615,6 +672,14 @@ private:
     /// The vector of functions to automatically JIT compile after FinalizeModule().
     std::vector<std::pair<llvm::Function*, void**> > _fns_to_jit_compile;
 
+    /// Functions linked by add_global_mapping(), by name.
+    CodegenCache::GlobalMappings _global_mappings;
+
+    /// The cached machine code of the functions of _fns_to_jit_compile, if they were
+    /// compiled by the codegen cache. Kept until the jitted functions are not called
+    /// any more.
+    std::shared_ptr<CodegenCache::Entry> _cache_entry;
+
     // Debug utility that will insert a printf-like function into the generated
     // IR.  Useful for debugging the IR.  This is lazily created.
     llvm::Function* _debug_trace_fn;
@@ -29,6 +29,10 @@ namespace config {
 
     // port for brpc
     CONF_Int32(brpc_port, "8060");
+    // connection type of brpc channels to other backends, "single" sends all
+    // calls to a peer over one multiplexed connection, "pooled" takes a
+    // connection of a pool for every call
+    CONF_String(brpc_connection_type, "single");
 
     // Declare a selection strategy for those servers have many ips.
     // Note that there should at most one ip match this list.
@@ -64,6 +68,8 @@ namespace config {
     CONF_Int32(push_worker_count_high_priority, "3");
     // the count of thread to publish version
     CONF_Int32(publish_version_worker_count, "2");
+    // the count of thread to publish the version of the tablets of one transaction
+    CONF_Int32(publish_version_tablet_threads, "8");
     // the count of thread to clear alter task
     CONF_Int32(clear_alter_task_worker_count, "1");
     // the count of thread to clear transaction task
@@ -80,6 +86,11 @@ namespace config {
     CONF_Int32(cancel_delete_data_worker_count, "3");
     // the count of thread to check consistency
     CONF_Int32(check_consistency_worker_count, "1");
+    // compute the checksum of duplicate key tablets without deletes from the row
+    // checksums stored in the segments, reading only the versions without them.
+    // the checksum differs from the one computed by reading, so all backends
+    // have to agree on it
+    CONF_Bool(consistency_checksum_from_segments, "false");
     // the count of thread to upload
     CONF_Int32(upload_worker_count, "1");
     // the count of thread to download
@@ -94,6 +105,11 @@ namespace config {
     CONF_Int32(report_disk_state_interval_seconds, "60");
     // the interval time(seconds) for agent report olap table to FE
     CONF_Int32(report_olap_table_interval_seconds, "60");
+    // if true, the tablet reports between full ones only have the tablets changed since the
+    // last report. Enable it only after all FEs are upgraded, older ones drop the others.
+    CONF_Bool(enable_incremental_tablet_report, "false");
+    // the interval time(seconds) of full tablet reports if incremental ones are enabled
+    CONF_Int32(full_tablet_report_interval_seconds, "3600");
     // the timeout(seconds) for alter table
     CONF_Int32(alter_table_timeout_seconds, "86400");
     // the timeout(seconds) for make snapshot
@@ -106,6 +122,16 @@ namespace config {
     CONF_Int32(download_low_speed_limit_kbps, "50");
     // download low speed time(seconds)
     CONF_Int32(download_low_speed_time, "300");
+    // the number of files, or ranges of files, a clone downloads at a time
+    CONF_Int32(clone_download_threads, "4");
+    // files of snapshots larger than this (MB) are downloaded by clones in ranges of
+    // this size. Only enable it after all backends are upgraded, older ones can not
+    // send ranges. 0 disables it
+    CONF_Int64(clone_download_range_mb, "0");
+    // the max speed (MB/s) of all the clones downloading into one disk, 0 for no limit
+    CONF_Int32(clone_disk_max_download_mbps, "0");
+    // the max speed (MB/s) of every connection the http server sends files on, 0 for no limit
+    CONF_Int32(download_max_send_mbps, "0");
     // curl verbose mode
     CONF_Int64(curl_verbose_mode, "1");
     // seconds to sleep for each time check table status
@@ -122,6 +148,9 @@ namespace config {
     // log dir
     CONF_String(sys_log_dir, "${DORIS_HOME}/log");
     CONF_String(user_function_dir, "${DORIS_HOME}/lib/usr");
+    // if true, the user function libraries cached in user_function_dir are opened
+    // when BE starts instead of by the first query which calls them
+    CONF_Bool(preload_user_function_libs, "true");
     // INFO, WARNING, ERROR, FATAL
     CONF_String(sys_log_level, "INFO");
     // TIME-DAY, TIME-HOUR, SIZE-MB-nnn
@@ -145,6 +174,13 @@ namespace config {
 
     // If non-zero, Doris will output memory usage every log_mem_usage_interval'th fragment completion.
     CONF_Int32(log_mem_usage_interval, "0");
+    // consumption a mem tracker adds to its ancestors is gathered per core and
+    // added once it reaches this many bytes, so threads of a query hardly share
+    // the counters of the query and process trackers. ancestors may lag by this
+    // per core and tracker, but by no more than 1/64 of their limit in all; the
+    // trackers below a limit get smaller batches, or none, once that is taken.
+    // 0 adds every consumption to the ancestors at once
+    CONF_Int64(mem_tracker_consume_batch_bytes, "65536");
     // if non-empty, enable heap profiling and output to specified directory.
     CONF_String(heap_profile_dir, "");
 
@@ -157,8 +193,34 @@ namespace config {
     CONF_Int32(num_threads_per_core, "3");
     // if true, compresses tuple data in Serialize
     CONF_Bool(compress_rowbatches, "true");
+    // level of the zstd compression of exchanged row batches, negative levels are
+    // faster and compress less
+    CONF_Int32(exchange_zstd_level, "1");
+    // network bandwidth of a backend in MB per second assumed by the adaptive
+    // exchange compression to weigh the time to compress against the bytes saved
+    CONF_Int64(exchange_network_mb_per_second, "1250");
     // serialize and deserialize each returned row batch
     CONF_Bool(serialize_batch, "false");
+    // rows sent to an exchange node on the same backend are copied to its receiver
+    // directly instead of being serialized and sent by brpc
+    CONF_Bool(enable_local_exchange, "true");
+    // if true, partitioned and unpartitioned exchanges send rows column by column,
+    // compressed by LZ4 if compress_rowbatches is true. Only enable it after all
+    // backends are upgraded, older ones can not read such batches.
+    CONF_Bool(exchange_columnar_batch, "false");
+    // if true, exchanges send the tuple data of row batches as the attachment
+    // of the RPC, which the receiver copies into the batch at once instead of
+    // parsing it into the request first. Only enable it after all backends
+    // are upgraded.
+    CONF_Bool(exchange_tuple_data_in_attachment, "false");
+    // capacity in bytes of the cache of the results of fragments aggregating
+    // tablets, kept between queries reading the same versions. 0 disables it
+    CONF_Int64(fragment_result_cache_capacity, "0");
+    // results of a fragment instance larger than this are not cached
+    CONF_Int64(fragment_result_cache_max_entry_bytes, "16777216");
+    // number of descriptor tables kept for fragment instances which the frontend
+    // sends the same hash of the table with. 0 disables it
+    CONF_Int64(descriptor_tbl_cache_capacity, "1024");
     // interval between profile reports; in seconds
     CONF_Int32(status_report_interval, "5");
     // Local directory to copy UDF libraries from HDFS into
@@ -167,6 +229,10 @@ namespace config {
     CONF_Int32(doris_scanner_thread_pool_thread_num, "48");
     // number of olap scanner thread pool size
     CONF_Int32(doris_scanner_thread_pool_queue_size, "102400");
+    // On hosts with several NUMA nodes, split the scanner threads into one pool per
+    // node, run each fragment on the cores of one node, and the disk threads on the
+    // node of their disk, so memory is allocated and read on the node using it
+    CONF_Bool(numa_aware, "false");
     // number of etl thread pool size
     CONF_Int32(etl_thread_pool_size, "8");
     // number of etl thread pool size
@@ -175,18 +241,51 @@ namespace config {
     CONF_Int32(port, "20001");
     // default thrift client connect timeout(in seconds)
     CONF_Int32(thrift_connect_timeout_seconds, "3");
+    // A host which could not be connected by thrift is not connected again
+    // for this long, calls to it fail at once meanwhile
+    CONF_Int32(thrift_client_open_backoff_ms, "500");
     // max row count number for single scan range
     CONF_Int32(doris_scan_range_row_count, "524288");
     // size of scanner queue between scanner thread and compute thread
     CONF_Int32(doris_scanner_queue_size, "1024");
     // single read execute fragment row size
     CONF_Int32(doris_scanner_row_num, "16384");
+    // adjust the number of running scanners of a scan node to how fast its
+    // batches are consumed, otherwise as many run as the queue size allows
+    CONF_Bool(doris_scanner_adaptive_concurrency, "true");
+    // number of sliced scrolls each elasticsearch shard is read by, every one
+    // on its own scanner thread of the es scan node. 1 reads a shard by one scroll
+    CONF_Int32(es_scroll_slices_per_shard, "1");
+    // rows of mysql external tables are streamed from mysql instead of being
+    // read in memory entirely first. mysql keeps the query open while they are
+    // consumed, slow consumers may need a larger net_write_timeout of mysql
+    CONF_Bool(mysql_scanner_use_result, "true");
+    // number of connections a mysql scan node reads a table by in parallel,
+    // each one a range of its integer primary key. 1 reads it by one query
+    CONF_Int32(mysql_scan_parallel_ranges, "1");
+    // a full top-n node publishes its last value of the first ordering column
+    // to the olap scan below, which skips rows ordered after it
+    CONF_Bool(enable_topn_scan_pruning, "true");
     // number of max scan keys
     CONF_Int32(doris_max_scan_key_num, "1024");
     // return_row / total_row
     CONF_Int32(doris_max_pushdown_conjuncts_return_rate, "90");
+    // convert whole row blocks to tuples column by column when scanned rows
+    // need not be merged, e.g. for duplicate key tables
+    CONF_Bool(doris_scanner_convert_by_block, "true");
+    // threads reading and merging the scanners of a scan node returning its rows in
+    // key order, each takes at least two scanners. 1 reads all on the calling thread
+    CONF_Int32(doris_sorted_scan_merge_threads, "4");
     // (Advanced) Maximum size of per-query receive-side buffer
     CONF_Int32(exchg_node_buffer_size_bytes, "10485760");
+    // threads merging the senders of a merging exchange node before the final
+    // merge, each takes at least two senders. 1 merges all on the calling thread
+    CONF_Int32(exchg_node_merge_threads, "1");
+    // evaluate ROWS windows ending at the current row without buffering the rows
+    CONF_Bool(enable_streaming_analytic, "true");
+    // threads evaluating whole partitions of the input of an analytic node with
+    // PARTITION BY exprs, which are evaluated by the thread of the node when it is 1
+    CONF_Int32(parallel_analytic_num_threads, "1");
     // insert sort threadhold for sorter
     CONF_Int32(insertion_threadhold, "16");
     // the block_size every block allocate for sorter
@@ -202,6 +301,13 @@ namespace config {
     CONF_String(module_output, "");
     // memory_limitation_per_thread_for_schema_change unit GB
     CONF_Int32(memory_limitation_per_thread_for_schema_change, "2");
+    // the count of threads of a store converting the versions of the tablets
+    // altered on it, shared by all schema change and rollup jobs of the store.
+    // 1 converts the versions of a tablet one by one on its alter thread
+    CONF_Int32(schema_change_threads_per_store, "1");
+    // read and write buffer of each sorted run a sorting schema change spills
+    // to disk, unit MB. runs beyond memory_limitation / buffer are merged in passes
+    CONF_Int32(schema_change_sorted_run_buffer_mbytes, "8");
 
     CONF_Int64(max_unpacked_row_block_size, "104857600");
 
@@ -220,6 +326,9 @@ namespace config {
     // garbage sweep policy
     CONF_Int32(max_garbage_sweep_interval, "43200");
     CONF_Int32(min_garbage_sweep_interval, "200");
+    // the max count of files removed per second on one disk by the unused
+    // index gc and the trash sweep, 0 means no limit
+    CONF_Int32(gc_max_files_removed_per_second_per_disk, "500");
     CONF_Int32(snapshot_expire_time_sec, "172800");
     // 仅仅是建议值，当磁盘空间不足时，trash下的文件保存期可不遵守这个参数
     CONF_Int32(trash_file_expire_time_sec, "259200");
@@ -228,7 +337,86 @@ namespace config {
     CONF_Bool(row_nums_check, "true")
     //file descriptors cache, by default, cache 30720 descriptors
     CONF_Int32(file_descriptor_cache_capacity, "30720");
+    // pack the index and data files of the segment groups written by loads into
+    // one file when they take at most packed_segment_group_max_bytes, so that
+    // small loads take one descriptor of the cache and one inode
+    CONF_Bool(enable_packed_segment_group, "false");
+    CONF_Int64(packed_segment_group_max_bytes, "8388608");
     CONF_Int64(index_stream_cache_capacity, "10737418240");
+    // capacity of the cache of data stream chunks shared by all segment readers,
+    // 0 disables it
+    CONF_Int64(data_page_cache_capacity, "0");
+    // segment groups up to this size keep their chunks decompressed in the data
+    // page cache, larger ones keep the compressed chunks
+    CONF_Int64(data_page_cache_decompressed_max_size, "104857600");
+    // segment files up to this size, e.g. of small dimension tables, are read from
+    // a memory mapping kept with their descriptor in the fd cache instead of
+    // with pread, 0 disables it
+    CONF_Int64(segment_mmap_max_size, "0");
+    // eviction policy of the index stream and data page caches, "lru" or
+    // "segmented_lru". segmented_lru keeps entries hit more than once from being
+    // evicted by large scans and compactions
+    CONF_String(index_stream_cache_policy, "lru");
+    CONF_String(data_page_cache_policy, "lru");
+    // capacity of the cache of short key index entries. Segment groups load
+    // their entries on first use and they may be evicted once no reader uses
+    // them. 0 loads all entries when the tablets are opened and keeps them
+    CONF_Int64(short_key_index_cache_capacity, "2147483648");
+    // write smallint, int, bigint, date and datetime columns of new segments
+    // with the BIT_PACKED encoding instead of run length encoding. Segments
+    // written so can not be read by BEs without support for the encoding
+    CONF_Bool(enable_bit_packed_integer_encoding, "false");
+    // choose run length or BIT_PACKED encoding per integer column and segment,
+    // by the estimated scan cost of the first block of values. Overrides
+    // enable_bit_packed_integer_encoding, with the same compatibility caveat
+    CONF_Bool(enable_adaptive_integer_encoding, "false");
+    // write float and double columns of new segments with the XOR encoding
+    // instead of plain values, for slowly changing metrics. Segments written
+    // so can not be read by BEs without support for the encoding
+    CONF_Bool(enable_xor_float_encoding, "false");
+    // size of the zstd dictionary trained for the string streams of a segment
+    // of tables created with compress_dictionary
+    CONF_Int32(zstd_dictionary_size, "16384");
+    // number of threads shared by segment writers to encode and compress the
+    // columns of a segment in parallel, 0 to write them on the writing thread
+    CONF_Int32(segment_writer_threads, "4");
+    // segments write no bitmap index of a column with more distinct values than
+    // this, such an index would be larger than what it saves
+    CONF_Int32(bitmap_index_max_values_per_segment, "4096");
+    // segments write no ngram index of a column with more distinct 3 bytes
+    // grams than this, such a column is closer to binary data than to text
+    CONF_Int32(ngram_index_max_grams_per_segment, "262144");
+    // bloom filters of new segments and of runtime filters have the blocked layout,
+    // whose probes read one cache line. Backends before it do not filter rows by
+    // such segment filters and drop such runtime filters
+    CONF_Bool(bloom_filter_blocked_layout, "true");
+    // queries whose columns are kept in the pre-aggregates of segment groups
+    // read those in place of the segments
+    CONF_Bool(enable_pre_aggregate_read, "true");
+    // buffer of every pre-aggregate file written or read
+    CONF_Int32(pre_aggregate_buffer_kbytes, "256");
+    // segment groups written by loads, compactions and schema changes keep the value
+    // distribution of their columns: null count, hll of the values and a histogram.
+    // tablet reports carry them merged over the versions of the tablet
+    CONF_Bool(enable_column_distribution, "true");
+    // values kept of every column to build the histograms, and buckets of a histogram
+    CONF_Int32(column_distribution_sample_size, "1024");
+    CONF_Int32(column_histogram_buckets, "64");
+    // the rows and bytes scanned and written of every tablet are kept as sums decayed
+    // by half each half-life, reported to the FE and shown by /api/tablet_heat
+    CONF_Int32(tablet_heat_half_life_sec, "600");
+    // number of compressed chunks every column stream reads ahead of the decoder
+    // on HDD stores, 0 disables read ahead
+    CONF_Int32(storage_read_ahead_chunks, "2");
+    // threads reading ahead and max number of read ahead requests in flight, per store
+    CONF_Int32(storage_read_ahead_threads_per_store, "4");
+    CONF_Int32(storage_read_ahead_queue_depth_per_store, "32");
+    // storage media whose stores read the chunks of a row block with one batched
+    // io_uring submission, e.g. "SSD" or "SSD,HDD". falls back to pread on kernels
+    // without io_uring. stores using io_uring do not use the read ahead threads
+    CONF_String(storage_io_uring_media, "");
+    // number of entries of the io_uring ring of every scanner thread
+    CONF_Int32(io_uring_queue_depth, "64");
     CONF_Int64(max_packed_row_block_size, "20971520");
 
     // be policy
@@ -248,7 +436,31 @@ namespace config {
     CONF_Int32(cumulative_compaction_num_threads, "1");
     CONF_Int32(cumulative_compaction_num_threads_per_disk, "1");
     CONF_Int64(cumulative_compaction_budgeted_bytes, "104857600");
+    // how the deltas of a cumulative compaction are picked. "budgeted" merges the
+    // deltas after the cumulative point until budgeted_bytes are reached,
+    // "size_tiered" merges the run of small deltas of similar size that saves
+    // reads the most versions per byte written
+    CONF_String(cumulative_compaction_policy, "budgeted");
+    // size_tiered: max size ratio of the largest delta to the others of a run,
+    // and max number of deltas merged at a time
+    CONF_Double(cumulative_compaction_size_tiered_ratio, "4");
+    CONF_Int64(cumulative_compaction_size_tiered_max_deltas, "1000");
     CONF_Int32(cumulative_compaction_write_mbytes_per_sec, "100");
+    // bytes all compactions of a store may read and write per second. the next
+    // compaction of a store waits until the bytes of the previous ones are paid
+    // back, 0 means no limit
+    CONF_Int64(compaction_io_budget_mbytes_per_sec_per_disk, "0");
+    // compactions wait while queries scan more than this, 0 means never
+    CONF_Int64(compaction_pause_query_scan_mbytes_per_sec, "0");
+    // tablets with at least this many columns are compacted a group of value columns
+    // at a time, which bounds the memory of the readers. 0 means never
+    CONF_Int32(vertical_compaction_min_columns, "100");
+    CONF_Int32(vertical_compaction_columns_per_group, "20");
+
+    // UNIQUE_KEYS tables mark the rows a version replaces when it is published,
+    // so queries read their versions without merging them. The primary key
+    // index this needs is kept in memory and built on the first query of a tablet
+    CONF_Bool(enable_unique_key_merge_on_write, "false");
 
     // if compaction of a tablet failed, this tablet should not be chosen to
     // compaction until this interval passes.
@@ -260,6 +472,12 @@ namespace config {
     CONF_String(webserver_interface, "");
     CONF_String(webserver_doc_root, "${DORIS_HOME}");
     CONF_Int32(webserver_num_workers, "5");
+    // If true, every worker of the webserver listens on its own socket bound
+    // by SO_REUSEPORT, so that the kernel spreads the connections over them
+    CONF_Bool(webserver_reuse_port, "true");
+    // Number of threads running the handlers of the webserver which may
+    // block, like waiting for stream loads. 0 runs them in the workers.
+    CONF_Int32(webserver_handler_threads, "32");
     // If true, webserver may serve static files from the webserver_doc_root
     CONF_Bool(enable_webserver_doc_root, "true");
     // Period to update rate counters and sampling counters in ms.
@@ -269,13 +487,61 @@ namespace config {
     CONF_Int64(load_data_reserve_hours, "4");
     CONF_Int64(mini_load_max_mb, "2048");
     CONF_Int32(number_tablet_writer_threads, "16");
+    // tablet writer requests of a load index are handled by one of this many
+    // pools of number_tablet_writer_threads threads each, so loads waiting for
+    // flushes or slow disks do not hold the threads of the other loads
+    CONF_Int32(tablet_writer_pools, "1");
+    // requests queued by a pool, the rpc handlers wait once it is full and
+    // the senders of the loads stop with their windows of in flight packets
+    CONF_Int32(tablet_writer_pool_queue_size, "10240");
 
     CONF_Int64(streaming_load_max_mb, "10240");
     CONF_Int32(streaming_load_rpc_max_alive_time_sec, "600");
+    // csv stream loads with the header group_commit: true and a body of at most
+    // group_commit_max_load_bytes are appended to a shared load of their table,
+    // committed every group_commit_interval_ms or once it holds group_commit_max_bytes
+    CONF_Int32(group_commit_interval_ms, "1000");
+    CONF_Int64(group_commit_max_bytes, "67108864");
+    CONF_Int64(group_commit_max_load_bytes, "4194304");
+    // if true, OlapTableSink sends rows to tablet writers column by column,
+    // compressed by LZ4 if compress_rowbatches is true. Only enable it after
+    // all backends are upgraded, older ones can not read such batches.
+    CONF_Bool(tablet_writer_columnar_batch, "false");
+    // max add_batch packets of one OlapTableSink channel waiting for their
+    // results, more than 1 hides the round trip time of loads across data
+    // centers. Only set it after all backends are upgraded, older ones reject
+    // packets arriving out of order.
+    CONF_Int32(tablet_writer_max_in_flight_packets, "1");
+    // if true, OlapTableSink sends the rows of a tablet only to its first
+    // replica, which forwards them to the other ones while writing them. A
+    // failed replica fails the load then, unless it is a first one failing
+    // to open. Only enable it after all backends are upgraded.
+    CONF_Bool(tablet_writer_chain_replication, "false");
+    // threads parsing the body of one csv stream load. More than 1 cuts the
+    // body into chunks of lines which are parsed at the same time, rows are
+    // still sent to the tablets in the order of the body.
+    CONF_Int32(stream_load_parse_threads, "1");
+    // files an export fragment writes at the same time, each on its own
+    // thread through its own broker connection
+    CONF_Int32(export_sink_parallel_files, "1");
+    // approximate size of the values of a row group of the parquet files of exports
+    CONF_Int32(export_parquet_row_group_mbytes, "64");
 
     // Fragment thread pool
     CONF_Int32(fragment_pool_thread_num, "64");
     CONF_Int32(fragment_pool_queue_size, "1024");
+    // Fragments are queued instead of started while the process consumption is above
+    // this ratio of mem_limit, 0 to disable
+    CONF_Double(fragment_admission_mem_ratio, "0");
+    // ... while the runnable threads per core, as in /proc/loadavg, are above this,
+    // 0 to disable
+    CONF_Double(fragment_admission_max_runnable_per_core, "0");
+    // ... while more scanner tasks than this are queued, 0 to disable
+    CONF_Int32(fragment_admission_max_scanner_queue, "0");
+    // a queued fragment is started anyway once it waited this long
+    CONF_Int32(fragment_admission_max_wait_ms, "10000");
+    // interval to check if queued fragments can be started
+    CONF_Int32(fragment_admission_check_interval_ms, "100");
 
     //for cast
     CONF_Bool(cast, "true");
@@ -309,9 +575,30 @@ namespace config {
     CONF_String(pprof_profile_dir, "${DORIS_HOME}/log")
 
     // for partition
+    // use the hash join which spills the partitions of its build side to scratch
+    // files when they do not fit in memory
     CONF_Bool(enable_partitioned_hash_join, "false")
     CONF_Bool(enable_partitioned_aggregation, "false")
+    // threads aggregating the input of a GROUP BY in the in-memory aggregation node,
+    // which is used instead of the new partitioned aggregation when it is above 1
+    CONF_Int32(parallel_aggregation_num_threads, "1")
     CONF_Bool(enable_new_partitioned_aggregation, "true")
+    // update count, sum, min, max and avg of numeric slots of a group of rows at a
+    // time with type specialized loops in the new partitioned aggregation
+    CONF_Bool(enable_vectorized_aggregation, "true")
+    // build the hash tables of the joins not returning unmatched build rows with
+    // open addressing on normalized keys, when all the join keys have a fixed width
+    CONF_Bool(enable_normalized_join_hash_table, "true")
+    // a normalized hash table of a left semi or anti join without other join
+    // conjuncts keeps only the distinct keys, not the build rows
+    CONF_Bool(enable_keys_only_join_hash_table, "true")
+    // the instances of a query on one backend build one hash table together
+    // for a broadcast join and probe it, instead of building one each
+    CONF_Bool(enable_shared_broadcast_join_hash_table, "true")
+    // threads probing a batch of the left child of a cross join with conjuncts,
+    // if its rows times the build rows are at least cross_join_parallel_probe_min_pairs
+    CONF_Int32(cross_join_probe_threads, "4")
+    CONF_Int64(cross_join_parallel_probe_min_pairs, "4194304")
     
     // for kudu
     // "The maximum size of the row batch queue, for Kudu scanners."
@@ -353,6 +640,15 @@ namespace config {
 
     // Writable scratch directories
     CONF_String(scratch_dirs, "/tmp");
+    // compress the blocks spilled to the scratch directories with LZ4, blocks
+    // which do not get smaller are written as they are
+    CONF_Bool(spill_compression, "false");
+    // blocks spilled to a scratch directory on an SSD for every one spilled to
+    // a directory on a rotational disk
+    CONF_Int32(scratch_ssd_weight, "1");
+    // spilling operators are asked to free memory once the process consumption
+    // passes this ratio of mem_limit, checked every memory_maintenance_sleep_time_s
+    CONF_Double(mem_arbitrator_revoke_ratio, "0.9");
 
     // If false and --scratch_dirs contains multiple directories on the same device,
     // then only the first writable directory is used
@@ -370,6 +666,10 @@ namespace config {
     // clean page can be hold by buffer pool
     CONF_String(buffer_pool_clean_pages_limit, "20G");
 
+    // max bytes of free mem pool chunks kept for reuse by the pools of all
+    // queries, 0 returns the chunks to the system once a pool frees them
+    CONF_Int64(chunk_reserved_bytes_limit, "2147483648");
+
     // Sleep time in seconds between memory maintenance iterations
     CONF_Int64(memory_maintenance_sleep_time_s, "10");
 
@@ -378,10 +678,57 @@ namespace config {
 
     // write buffer size before flush
     CONF_Int32(write_buffer_size, "104857600");
+    // number of skiplists in the memtable of a tablet. Rows of different senders
+    // of a load go to different skiplists and are inserted in parallel, they are
+    // merged when the memtable is flushed
+    CONF_Int32(memtable_partitions, "1");
+    // append rows to the memtable unsorted and sort them once when it is
+    // flushed, instead of inserting every row into a skiplist
+    CONF_Bool(memtable_sort_on_flush, "false");
+    // rows of an AGG_KEYS memtable kept in a hash table in front of its
+    // skiplist, rows with equal keys are aggregated there and only distinct
+    // keys are inserted into the skiplist once it is full. 0 disables it
+    CONF_Int32(memtable_pre_aggregate_rows, "0");
+    // threads of every store writing full memtables in the background, and the
+    // max number of memtables waiting for them. 0 flushes on the loading thread
+    CONF_Int32(memtable_flush_threads_per_store, "2");
+    CONF_Int32(memtable_flush_queue_size_per_store, "10");
+    // max memory of the memtables being flushed in the background. writers wait
+    // for their own flushes once it is exceeded, -1 means no limit
+    CONF_Int64(memtable_flush_memory_limit, "2147483648");
+    // max memory of the memtables being written by all loads. once it is
+    // exceeded the largest memtables are flushed, -1 means no limit
+    CONF_Int64(load_memtable_memory_limit, "10737418240");
+    // memtables grow beyond write_buffer_size while few tablets are loaded,
+    // up to load_memtable_memory_limit divided by their number, but not
+    // beyond this size
+    CONF_Int32(max_write_buffer_size, "1073741824");
 
     // update interval of tablet stat cache
     CONF_Int32(tablet_stat_cache_update_interval_second, "300");
 
+    // tablets on SSD which have not been queried for this long are moved to
+    // HDD by the BE itself, 0 means tablets are only moved when asked by FE
+    CONF_Int64(storage_cooldown_idle_second, "0");
+    // interval to look for the tablets to cool down
+    CONF_Int32(storage_cooldown_check_interval_second, "600");
+    // the data files of old versions of idle tablets are moved to this storage,
+    // only file://<dir> is supported, e.g. a mounted object store; empty keeps
+    // all the data on the stores
+    CONF_String(cold_storage_uri, "");
+    // tablets which have not been queried for this long have their old
+    // versions moved to the cold storage
+    CONF_Int64(cold_storage_idle_second, "604800");
+    // only the versions created this long ago are moved to the cold storage
+    CONF_Int64(cold_storage_version_age_second, "86400");
+    // local copies of the cold data files read by the queries
+    CONF_String(cold_file_cache_path, "${DORIS_HOME}/cold_file_cache");
+    // the least recently read copies are removed beyond this size
+    CONF_Int64(cold_file_cache_capacity_bytes, "10737418240");
+
+    // the count of thread to load the tablets of one data dir at startup
+    CONF_Int32(load_tablet_threads_per_store, "4");
+
     // result buffer cancelled time (unit: second)
     CONF_Int32(result_buffer_cancelled_interval_time, "300");
 
@@ -394,6 +741,11 @@ namespace config {
     // sync tablet_meta when modifing meta
     CONF_Bool(sync_tablet_meta, "false");
 
+    // save every delta of a tablet header as a record of its own in the meta,
+    // so only the changed ones are written. BEs of earlier versions can not
+    // read such headers.
+    CONF_Bool(save_header_delta_records, "false");
+
     // default thrift rpc timeout ms
     CONF_Int32(thrift_rpc_timeout_ms, "5000");
 
@@ -403,8 +755,15 @@ namespace config {
     // If set to true, metric calculator will run
     CONF_Bool(enable_metric_calculator, "true");
 
+    // measure how long the instrumented locks are held exclusively, which
+    // reads the clock twice on every acquisition of them
+    CONF_Bool(lock_hold_time_stats, "false");
+
     // max consumer num in one data consumer group, for routine load
     CONF_Int32(max_consumer_num_per_group, "3");
+    // max number of msgs a kafka consumer passes to its group at a time,
+    // for routine load
+    CONF_Int32(kafka_consume_batch_size, "100");
 
     // Is set to true, index loading failure will not causing BE exit,
     // and the tablet will be marked as bad, so that FE will try to repair it.
@@ -419,6 +778,45 @@ namespace config {
     // same cache size configuration.
     // TODO(cmy): use different config to set different client cache if necessary.
     CONF_Int32(max_client_cache_size_per_host, "10");
+
+    // a hash join builds no bloom filter for its runtime filters if it has
+    // more build rows, only min and max values are published
+    CONF_Int64(runtime_filter_max_bloom_filter_entries, "4194304");
+    // false positive probability of the bloom filters of runtime filters
+    CONF_Double(runtime_filter_bloom_filter_fpp, "0.05");
+    // rpc timeout of publishing runtime filters to remote scans
+    CONF_Int32(runtime_filter_rpc_timeout_ms, "2000");
+    // runtime filters which are not taken by any scan are dropped after it
+    CONF_Int32(runtime_filter_expire_time_s, "600");
+
+    // bytes of the machine code of optimized codegen modules kept for the
+    // fragments of later queries with the same IR, 0 disables the cache
+    CONF_Int64(codegen_cache_capacity, "268435456");
+    // directory the optimized modules of the codegen cache are written to, so
+    // they are only compiled, not optimized, after a restart. empty to keep
+    // them in memory only
+    CONF_String(codegen_cache_dir, "");
+    // fragments run interpreted until one of their operators has processed this
+    // many rows, their codegen module is then compiled in the background. 0 to
+    // compile it before the fragment is opened
+    CONF_Int64(codegen_compile_threshold_rows, "100000");
+
+    // constant subtrees of exprs which are not literals are evaluated once when
+    // the exprs are opened
+    CONF_Bool(enable_expr_constant_folding, "true");
+    // subexprs which occur several times in the conjuncts of a node are computed
+    // once per row by the interpreted evaluation
+    CONF_Bool(enable_expr_subexpr_sharing, "true");
+
+    // the share of the queries, loads and publishes whose spans are recorded, in
+    // [0, 1]. The traces are sampled by their ids, so all backends pick the same
+    CONF_Double(trace_sample_ratio, "0");
+    // the OTLP/HTTP endpoint the spans are posted to, as the JSON encoding of OTLP,
+    // e.g. http://collector:4318/v1/traces. The spans are dropped if it is empty
+    CONF_String(trace_export_url, "");
+    CONF_Int32(trace_export_interval_ms, "5000");
+    // spans finished beyond this many unexported ones are dropped
+    CONF_Int32(trace_max_buffered_spans, "100000");
 } // namespace config
 
 } // namespace doris
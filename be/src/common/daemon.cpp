@@ -49,6 +49,7 @@
 #include "exprs/utility_functions.h"
 #include "exprs/json_functions.h"
 #include "exprs/hll_hash_function.h"
+#include "exprs/bitmap_function.h"
 #include "geo/geo_functions.h"
 #include "olap/options.h"
 #include "util/time.h"
@@ -103,6 +104,9 @@ void* memory_maintenance_thread(void* dummy) {
                      !env->process_mem_tracker()->is_consumption_metric_null()) {
                 env->process_mem_tracker()->RefreshConsumptionFromMetric();
             }   
+            if (env->mem_arbitrator() != nullptr) {
+                env->mem_arbitrator()->maintain(env->process_mem_tracker());
+            }
         }   
     }   
     
@@ -264,6 +268,7 @@ void init_daemon(int argc, char** argv, const std::vector<StorePath>& paths) {
     CompoundPredicate::init();
     JsonFunctions::init();
     HllHashFunctions::init();
+    BitmapFunctions::init();
     ESFunctions::init();
     GeoFunctions::init();
 
@@ -23,9 +23,12 @@
 #include <thrift/protocol/TDebugProtocol.h>
 #include <x86intrin.h>
 #include <gperftools/profiler.h>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "codegen/codegen_anyval.h"
 #include "codegen/llvm_codegen.h"
+#include "common/config.h"
 #include "exec/hash_table.hpp"
 #include "exprs/agg_fn_evaluator.h"
 #include "exprs/expr.h"
@@ -38,6 +41,7 @@
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "runtime/string_value.hpp"
+#include "runtime/thread_resource_mgr.h"
 #include "runtime/tuple.h"
 #include "runtime/tuple_row.h"
 #include "util/runtime_profile.h"
@@ -66,6 +70,9 @@ AggregationNode::AggregationNode(
             _singleton_output_tuple(NULL),
             //_tuple_pool(new MemPool()),
             //
+            _num_active_threads(0),
+            _output_partition(0),
+            _input_eos(false),
             _codegen_process_row_batch_fn(NULL),
             _process_row_batch_fn(NULL),
             _needs_finalize(tnode.agg_node.need_finalize),
@@ -89,6 +96,7 @@ Status AggregationNode::init(const TPlanNode& tnode, RuntimeState* state) {
             _pool, tnode.agg_node.aggregate_functions[i], &evaluator);
         _aggregate_evaluators.push_back(evaluator);
     }
+    _agg_fn_texprs = tnode.agg_node.aggregate_functions;
     return Status::OK;
 }
 
@@ -154,9 +162,11 @@ Status AggregationNode::prepare(RuntimeState* state) {
         // create single output tuple now; we need to output something
         // even if our input is empty
         _singleton_output_tuple = construct_intermediate_tuple();
+    } else if (config::parallel_aggregation_num_threads > 1) {
+        RETURN_IF_ERROR(prepare_thread_states(state, config::parallel_aggregation_num_threads));
     }
 
-    if (state->codegen_level() > 0) {
+    if (state->codegen_level() > 0 && _thread_states.empty()) {
         LlvmCodeGen* codegen = NULL;
         RETURN_IF_ERROR(state->get_codegen(&codegen));
         Function* update_tuple_fn = codegen_update_tuple(state);
@@ -175,6 +185,43 @@ Status AggregationNode::prepare(RuntimeState* state) {
     return Status::OK;
 }
 
+Status AggregationNode::prepare_thread_states(RuntimeState* state, int num_threads) {
+    RowDescriptor build_row_desc(_intermediate_tuple_desc, false);
+    for (int t = 0; t < num_threads; ++t) {
+        _thread_states.emplace_back(new AggregationThreadState());
+        AggregationThreadState* thread_state = _thread_states.back().get();
+        for (int i = 0; i < _probe_expr_ctxs.size(); ++i) {
+            Expr* expr = state->obj_pool()->add(new SlotRef(_intermediate_tuple_desc->slots()[i]));
+            thread_state->build_expr_ctxs.push_back(state->obj_pool()->add(new ExprContext(expr)));
+        }
+        RETURN_IF_ERROR(Expr::prepare(
+                thread_state->build_expr_ctxs, state, build_row_desc, expr_mem_tracker()));
+
+        thread_state->tuple_pool.reset(new MemPool(mem_tracker()));
+        int j = _probe_expr_ctxs.size();
+        for (int i = 0; i < _agg_fn_texprs.size(); ++i, ++j) {
+            AggFnEvaluator* evaluator = NULL;
+            RETURN_IF_ERROR(AggFnEvaluator::create(_pool, _agg_fn_texprs[i], &evaluator));
+            FunctionContext* fn_ctx = NULL;
+            RETURN_IF_ERROR(evaluator->prepare(
+                    state, child(0)->row_desc(), thread_state->tuple_pool.get(),
+                    _intermediate_tuple_desc->slots()[j], _output_tuple_desc->slots()[j],
+                    mem_tracker(), &fn_ctx));
+            state->obj_pool()->add(fn_ctx);
+            thread_state->evaluators.push_back(evaluator);
+            thread_state->fn_ctxs.push_back(fn_ctx);
+        }
+
+        // the probe exprs are cloned in open(), the tables only keep references to them
+        for (int i = 0; i < NUM_PARALLEL_PARTITIONS; ++i) {
+            thread_state->hash_tbls.emplace_back(new HashTable(
+                    thread_state->build_expr_ctxs, thread_state->probe_expr_ctxs,
+                    1, true, id(), mem_tracker(), 1024));
+        }
+    }
+    return Status::OK;
+}
+
 Status AggregationNode::open(RuntimeState* state) {
     RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::OPEN));
     SCOPED_TIMER(_runtime_profile->total_time_counter());
@@ -188,6 +235,10 @@ Status AggregationNode::open(RuntimeState* state) {
 
     RETURN_IF_ERROR(_children[0]->open(state));
 
+    if (!_thread_states.empty()) {
+        return aggregate_in_parallel(state);
+    }
+
     RowBatch batch(_children[0]->row_desc(), state->batch_size(), mem_tracker());
     int64_t num_input_rows = 0;
     int64_t num_agg_rows = 0;
@@ -235,6 +286,9 @@ Status AggregationNode::open(RuntimeState* state) {
         COUNTER_SET(_hash_table_load_factor_counter, _hash_tbl->load_factor());
         num_agg_rows += (_hash_tbl->size() - agg_rows_before);
         num_input_rows += batch.num_rows();
+        if (_process_row_batch_fn == NULL && _codegen_process_row_batch_fn != NULL) {
+            state->codegen()->add_interpreted_rows(num_input_rows);
+        }
 
         batch.reset();
 
@@ -258,6 +312,156 @@ Status AggregationNode::open(RuntimeState* state) {
     return Status::OK;
 }
 
+Status AggregationNode::aggregate_in_parallel(RuntimeState* state) {
+    for (auto& thread_state : _thread_states) {
+        RETURN_IF_ERROR(Expr::clone_if_not_exists(
+                _probe_expr_ctxs, state, &thread_state->probe_expr_ctxs));
+        RETURN_IF_ERROR(Expr::open(thread_state->build_expr_ctxs, state));
+        for (int i = 0; i < thread_state->evaluators.size(); ++i) {
+            RETURN_IF_ERROR(thread_state->evaluators[i]->open(state, thread_state->fn_ctxs[i]));
+        }
+    }
+
+    // this thread always aggregates, the others only run if they get a token
+    _num_active_threads = 1;
+    while (_num_active_threads < _thread_states.size()
+            && state->resource_pool()->try_acquire_thread_token()) {
+        ++_num_active_threads;
+    }
+
+    {
+        SCOPED_TIMER(_build_timer);
+        boost::thread_group threads;
+        for (int i = 1; i < _num_active_threads; ++i) {
+            threads.create_thread(boost::bind(&AggregationNode::aggregate_thread, this, state, i));
+        }
+        aggregate_thread(state, 0);
+        threads.join_all();
+
+        // the partitions are only merged once all the threads are done with the input
+        if (_input_status.ok()) {
+            _merged_tbls.resize(NUM_PARALLEL_PARTITIONS);
+            for (int i = 1; i < _num_active_threads; ++i) {
+                threads.create_thread(boost::bind(&AggregationNode::merge_thread, this, state, i));
+            }
+            merge_thread(state, 0);
+            threads.join_all();
+        }
+    }
+    for (int i = 1; i < _num_active_threads; ++i) {
+        state->resource_pool()->release_thread_token(false);
+    }
+    RETURN_IF_ERROR(_input_status);
+    RETURN_IF_ERROR(state->check_query_state());
+
+    int64_t memory_used = 0;
+    int64_t num_agg_rows = 0;
+    for (auto& thread_state : _thread_states) {
+        memory_used += thread_state->tuple_pool->peak_allocated_bytes();
+        for (auto& hash_tbl : thread_state->hash_tbls) {
+            memory_used += hash_tbl->byte_size();
+        }
+    }
+    for (auto& hash_tbl : _merged_tbls) {
+        memory_used += hash_tbl->byte_size();
+        num_agg_rows += hash_tbl->size();
+    }
+    COUNTER_SET(memory_used_counter(), memory_used);
+    VLOG_ROW << "id=" << id() << " aggregated the input into " << num_agg_rows
+             << " output rows with " << _num_active_threads << " threads";
+
+    _output_partition = -1;
+    next_output_partition();
+    return Status::OK;
+}
+
+void AggregationNode::aggregate_thread(RuntimeState* state, int thread_idx) {
+    AggregationThreadState* thread_state = _thread_states[thread_idx].get();
+    // the rows of a batch are aggregated while the other threads get further batches,
+    // which is fine since batches own the memory of their rows
+    RowBatch batch(_children[0]->row_desc(), state->batch_size(), mem_tracker());
+    while (true) {
+        {
+            boost::lock_guard<boost::mutex> l(_input_lock);
+            if (_input_eos || !_input_status.ok()) {
+                break;
+            }
+            if (state->is_cancelled()) {
+                _input_status = Status::CANCELLED;
+                break;
+            }
+            _input_status = state->check_query_state();
+            if (_input_status.ok()) {
+                _input_status = _children[0]->get_next(state, &batch, &_input_eos);
+            }
+            if (!_input_status.ok()) {
+                break;
+            }
+        }
+        process_row_batch_parallel(thread_state, &batch);
+        batch.reset();
+    }
+
+    // the merge functions take serialized intermediate values, as they do for the
+    // results of other instances
+    for (int i = 0; i < NUM_PARALLEL_PARTITIONS; ++i) {
+        if (i % _num_active_threads == thread_idx) {
+            continue;
+        }
+        HashTable::Iterator it = thread_state->hash_tbls[i]->begin();
+        for (; !it.at_end(); it.next<false>()) {
+            AggFnEvaluator::serialize(
+                    thread_state->evaluators, thread_state->fn_ctxs, it.get_row()->get_tuple(0));
+        }
+    }
+}
+
+void AggregationNode::merge_thread(RuntimeState* state, int thread_idx) {
+    AggregationThreadState* thread_state = _thread_states[thread_idx].get();
+    for (int i = thread_idx; i < NUM_PARALLEL_PARTITIONS; i += _num_active_threads) {
+        HashTable* own_tbl = thread_state->hash_tbls[i].get();
+        // the rows probing the merged table are intermediate tuples as well
+        HashTable* merged_tbl = new HashTable(
+                thread_state->build_expr_ctxs, thread_state->build_expr_ctxs,
+                1, true, id(), mem_tracker(), own_tbl->num_buckets());
+        _merged_tbls[i].reset(merged_tbl);
+        for (HashTable::Iterator it = own_tbl->begin(); !it.at_end(); it.next<false>()) {
+            merged_tbl->insert(it.get_row());
+        }
+
+        for (int j = 0; j < _num_active_threads; ++j) {
+            if (j == thread_idx) {
+                continue;
+            }
+            HashTable* tbl = _thread_states[j]->hash_tbls[i].get();
+            for (HashTable::Iterator it = tbl->begin(); !it.at_end(); it.next<false>()) {
+                Tuple* src = it.get_row()->get_tuple(0);
+                Tuple* dst = NULL;
+                HashTable::Iterator dst_it = merged_tbl->find(it.get_row());
+                if (dst_it.at_end()) {
+                    dst = construct_intermediate_tuple(thread_state->evaluators,
+                            thread_state->fn_ctxs, merged_tbl, thread_state->tuple_pool.get());
+                    merged_tbl->insert(reinterpret_cast<TupleRow*>(&dst));
+                } else {
+                    dst = dst_it.get_row()->get_tuple(0);
+                }
+                for (int k = 0; k < thread_state->evaluators.size(); ++k) {
+                    thread_state->evaluators[k]->merge(thread_state->fn_ctxs[k], src, dst);
+                }
+            }
+        }
+    }
+}
+
+void AggregationNode::next_output_partition() {
+    while (++_output_partition < NUM_PARALLEL_PARTITIONS) {
+        _output_iterator = _merged_tbls[_output_partition]->begin();
+        if (!_output_iterator.at_end()) {
+            return;
+        }
+    }
+}
+
 Status AggregationNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eos) {
     SCOPED_TIMER(_runtime_profile->total_time_counter());
     RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::GETNEXT));
@@ -285,8 +489,14 @@ Status AggregationNode::get_next(RuntimeState* state, RowBatch* row_batch, bool*
         int row_idx = row_batch->add_row();
         TupleRow* row = row_batch->get_row(row_idx);
         Tuple* intermediate_tuple = _output_iterator.get_row()->get_tuple(0);
-        Tuple* output_tuple =
-            finalize_tuple(intermediate_tuple, row_batch->tuple_data_pool());
+        Tuple* output_tuple = NULL;
+        if (_thread_states.empty()) {
+            output_tuple = finalize_tuple(intermediate_tuple, row_batch->tuple_data_pool());
+        } else {
+            AggregationThreadState* thread_state = output_thread_state();
+            output_tuple = finalize_tuple(thread_state->evaluators, thread_state->fn_ctxs,
+                                          intermediate_tuple, row_batch->tuple_data_pool());
+        }
         row->set_tuple(0, output_tuple);
 
         if (ExecNode::eval_conjuncts(ctxs, num_ctxs, row)) {
@@ -300,6 +510,9 @@ Status AggregationNode::get_next(RuntimeState* state, RowBatch* row_batch, bool*
         }
 
         _output_iterator.next<false>();
+        if (_output_iterator.at_end() && !_thread_states.empty()) {
+            next_output_partition();
+        }
     }
 
     *eos = _output_iterator.at_end() || reached_limit();
@@ -330,12 +543,21 @@ Status AggregationNode::close(RuntimeState* state) {
     }
     while (!_output_iterator.at_end()) {
         Tuple* tuple = _output_iterator.get_row()->get_tuple(0);
+        const std::vector<AggFnEvaluator*>* evaluators = &_aggregate_evaluators;
+        const std::vector<FunctionContext*>* fn_ctxs = &_agg_fn_ctxs;
+        if (!_thread_states.empty()) {
+            evaluators = &output_thread_state()->evaluators;
+            fn_ctxs = &output_thread_state()->fn_ctxs;
+        }
         if (_needs_finalize) {
-            AggFnEvaluator::finalize(_aggregate_evaluators, _agg_fn_ctxs, tuple, dummy_dst);
+            AggFnEvaluator::finalize(*evaluators, *fn_ctxs, tuple, dummy_dst);
         } else {
-            AggFnEvaluator::serialize(_aggregate_evaluators, _agg_fn_ctxs, tuple);
+            AggFnEvaluator::serialize(*evaluators, *fn_ctxs, tuple);
         }
         _output_iterator.next<false>();
+        if (_output_iterator.at_end() && !_thread_states.empty()) {
+            next_output_partition();
+        }
     }
 
     for (int i = 0; i < _aggregate_evaluators.size(); ++i) {
@@ -351,6 +573,25 @@ Status AggregationNode::close(RuntimeState* state) {
     if (_hash_tbl.get() != NULL) {
         _hash_tbl->close();
     }
+    for (auto& thread_state : _thread_states) {
+        for (int i = 0; i < thread_state->evaluators.size(); ++i) {
+            thread_state->evaluators[i]->close(state);
+            if (thread_state->fn_ctxs[i]->impl()) {
+                thread_state->fn_ctxs[i]->impl()->close();
+            }
+        }
+        thread_state->tuple_pool->free_all();
+        for (auto& hash_tbl : thread_state->hash_tbls) {
+            hash_tbl->close();
+        }
+        Expr::close(thread_state->probe_expr_ctxs, state);
+        Expr::close(thread_state->build_expr_ctxs, state);
+    }
+    for (auto& hash_tbl : _merged_tbls) {
+        if (hash_tbl != nullptr) {
+            hash_tbl->close();
+        }
+    }
 
     Expr::close(_probe_expr_ctxs, state);
     Expr::close(_build_expr_ctxs, state);
@@ -359,28 +600,36 @@ Status AggregationNode::close(RuntimeState* state) {
 }
 
 Tuple* AggregationNode::construct_intermediate_tuple() {
-    Tuple* agg_tuple = Tuple::create(_intermediate_tuple_desc->byte_size(), _tuple_pool.get());
+    return construct_intermediate_tuple(
+            _aggregate_evaluators, _agg_fn_ctxs, _hash_tbl.get(), _tuple_pool.get());
+}
+
+Tuple* AggregationNode::construct_intermediate_tuple(
+        const std::vector<AggFnEvaluator*>& evaluators,
+        const std::vector<FunctionContext*>& fn_ctxs,
+        HashTable* hash_tbl, MemPool* tuple_pool) {
+    Tuple* agg_tuple = Tuple::create(_intermediate_tuple_desc->byte_size(), tuple_pool);
     vector<SlotDescriptor*>::const_iterator slot_desc = _intermediate_tuple_desc->slots().begin();
 
     // copy grouping values
     for (int i = 0; i < _probe_expr_ctxs.size(); ++i, ++slot_desc) {
-        if (_hash_tbl->last_expr_value_null(i)) {
+        if (hash_tbl->last_expr_value_null(i)) {
             agg_tuple->set_null((*slot_desc)->null_indicator_offset());
         } else {
-            void* src = _hash_tbl->last_expr_value(i);
+            void* src = hash_tbl->last_expr_value(i);
             void* dst = agg_tuple->get_slot((*slot_desc)->tuple_offset());
-            RawValue::write(src, dst, (*slot_desc)->type(), _tuple_pool.get());
+            RawValue::write(src, dst, (*slot_desc)->type(), tuple_pool);
         }
     }
 
     // Initialize aggregate output.
-    for (int i = 0; i < _aggregate_evaluators.size(); ++i, ++slot_desc) {
+    for (int i = 0; i < evaluators.size(); ++i, ++slot_desc) {
         while (!(*slot_desc)->is_materialized()) {
             ++slot_desc;
         }
 
-        AggFnEvaluator* evaluator = _aggregate_evaluators[i];
-        evaluator->init(_agg_fn_ctxs[i], agg_tuple);
+        AggFnEvaluator* evaluator = evaluators[i];
+        evaluator->init(fn_ctxs[i], agg_tuple);
 
         // Codegen specific path.
         // To minimize branching on the UpdateAggTuple path, initialize the result value
@@ -436,6 +685,13 @@ void AggregationNode::update_tuple(Tuple* tuple, TupleRow* row) {
 }
 
 Tuple* AggregationNode::finalize_tuple(Tuple* tuple, MemPool* pool) {
+    return finalize_tuple(_aggregate_evaluators, _agg_fn_ctxs, tuple, pool);
+}
+
+Tuple* AggregationNode::finalize_tuple(
+        const std::vector<AggFnEvaluator*>& evaluators,
+        const std::vector<FunctionContext*>& fn_ctxs,
+        Tuple* tuple, MemPool* pool) {
     DCHECK(tuple != NULL);
 
     Tuple* dst = tuple;
@@ -443,9 +699,9 @@ Tuple* AggregationNode::finalize_tuple(Tuple* tuple, MemPool* pool) {
         dst = Tuple::create(_output_tuple_desc->byte_size(), pool);
     }
     if (_needs_finalize) {
-        AggFnEvaluator::finalize(_aggregate_evaluators, _agg_fn_ctxs, tuple, dst);
+        AggFnEvaluator::finalize(evaluators, fn_ctxs, tuple, dst);
     } else {
-        AggFnEvaluator::serialize(_aggregate_evaluators, _agg_fn_ctxs, tuple);
+        AggFnEvaluator::serialize(evaluators, fn_ctxs, tuple);
     }
     // Copy grouping values from tuple to dst.
     // TODO: Codegen this.
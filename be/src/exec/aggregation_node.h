@@ -19,7 +19,9 @@
 #define DORIS_BE_SRC_QUERY_EXEC_AGGREGATION_NODE_H
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <functional>
+#include <memory>
 
 #include "exec/exec_node.h"
 #include "exec/hash_table.h"
@@ -54,6 +56,12 @@ class SlotDescriptor;
 // will be appended to the end of the normal tuple data that stores the size of buffer
 // for that string slot.  This also results in the correct alignment because StringValue
 // slots are 8-byte aligned and form the tail end of the tuple.
+//
+// If config::parallel_aggregation_num_threads is greater than 1 and there are grouping
+// exprs, several threads take turns to get batches from the child and aggregate them
+// into thread-local hash tables, one for each of NUM_PARALLEL_PARTITIONS partitions of
+// the hash values of the grouping exprs. Each partition is then merged by one thread
+// from the tables of all the threads, the partitions are merged in parallel.
 class AggregationNode : public ExecNode {
 public:
     AggregationNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
@@ -71,6 +79,19 @@ public:
 
     static const char* _s_llvm_class_name;
 private:
+    static const int NUM_PARALLEL_PARTITIONS = 16;
+
+    // Copies of the exprs and the aggregate functions used by one of the threads which
+    // aggregate the input in parallel, with the hash tables of its partitions.
+    struct AggregationThreadState {
+        std::vector<ExprContext*> probe_expr_ctxs;
+        std::vector<ExprContext*> build_expr_ctxs;
+        std::vector<AggFnEvaluator*> evaluators;
+        std::vector<doris_udf::FunctionContext*> fn_ctxs;
+        boost::scoped_ptr<MemPool> tuple_pool;
+        std::vector<std::unique_ptr<HashTable>> hash_tbls;
+    };
+
     boost::scoped_ptr<HashTable> _hash_tbl;
     HashTable::Iterator _output_iterator;
 
@@ -98,6 +119,20 @@ private:
     Tuple* _singleton_output_tuple;  // result of aggregation w/o GROUP BY
     boost::scoped_ptr<MemPool> _tuple_pool;
 
+    std::vector<TExpr> _agg_fn_texprs;
+    // one for each thread if the input is aggregated in parallel, empty otherwise
+    std::vector<std::unique_ptr<AggregationThreadState>> _thread_states;
+    // number of threads which aggregated the input, partition i was merged by
+    // _thread_states[i % _num_active_threads]
+    int _num_active_threads;
+    // the merged partitions, the next one is output after _output_partition
+    std::vector<std::unique_ptr<HashTable>> _merged_tbls;
+    int _output_partition;
+    // serializes getting batches from the child
+    boost::mutex _input_lock;
+    bool _input_eos;
+    Status _input_status;
+
     /// IR for process row batch.  NULL if codegen is disabled.
     llvm::Function* _codegen_process_row_batch_fn;
 
@@ -124,6 +159,11 @@ private:
     // initialized to grouping values computed over '_current_row'.
     // Aggregation expr slots are set to their initial values.
     Tuple* construct_intermediate_tuple();
+    // Same as above, with the grouping values of the last row of 'hash_tbl' and the
+    // aggregate functions and the pool of a thread.
+    Tuple* construct_intermediate_tuple(const std::vector<AggFnEvaluator*>& evaluators,
+                                        const std::vector<doris_udf::FunctionContext*>& fn_ctxs,
+                                        HashTable* hash_tbl, MemPool* tuple_pool);
 
     // Updates the aggregation output tuple 'tuple' with aggregation values
     // computed over 'row'.
@@ -132,6 +172,40 @@ private:
     // Called when all rows have been aggregated for the aggregation tuple to compute final
     // aggregate values
     Tuple* finalize_tuple(Tuple* tuple, MemPool* pool);
+    Tuple* finalize_tuple(const std::vector<AggFnEvaluator*>& evaluators,
+                          const std::vector<doris_udf::FunctionContext*>& fn_ctxs,
+                          Tuple* tuple, MemPool* pool);
+
+    // Creates the state of 'num_threads' threads which aggregate the input in parallel.
+    Status prepare_thread_states(RuntimeState* state, int num_threads);
+
+    // Aggregates the input with _thread_states[0] in this thread and as many of the other
+    // thread states as thread tokens can be acquired for, then merges the partitions.
+    Status aggregate_in_parallel(RuntimeState* state);
+
+    // Body of a thread aggregating input batches into _thread_states[thread_idx] until
+    // the child is exhausted, then serializing the tuples of the partitions which are
+    // merged by other threads.
+    void aggregate_thread(RuntimeState* state, int thread_idx);
+
+    // Body of a thread merging the partitions it owns from the tables of all threads.
+    void merge_thread(RuntimeState* state, int thread_idx);
+
+    void process_row_batch_parallel(AggregationThreadState* thread_state, RowBatch* batch);
+
+    // Returns the partition of the grouping values of 'row'. FNV is used because the
+    // hash tables use CRC, a CRC with another seed would send the rows of a partition
+    // to a few buckets.
+    int partition_of(AggregationThreadState* thread_state, TupleRow* row);
+
+    // Returns the thread state owning the tuples output from _output_iterator.
+    AggregationThreadState* output_thread_state() {
+        return _thread_states[_output_partition % _num_active_threads].get();
+    }
+
+    // Moves _output_iterator to the first row of the next merged partition which is not
+    // empty, or leaves it at the end after the last one.
+    void next_output_partition();
 
     // Do the aggregation for all tuple rows in the batch
     void process_row_batch_no_grouping(RowBatch* batch, MemPool* pool);
@@ -18,6 +18,9 @@
 #include "exec/aggregation_node.h"
 
 #include "exec/hash_table.hpp"
+#include "exprs/agg_fn_evaluator.h"
+#include "exprs/expr_context.h"
+#include "runtime/raw_value.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "runtime/tuple.h"
@@ -48,5 +51,33 @@ void AggregationNode::process_row_batch_with_grouping(RowBatch* batch, MemPool*
     }
 }
 
+int AggregationNode::partition_of(AggregationThreadState* thread_state, TupleRow* row) {
+    uint32_t hash = 0;
+    for (ExprContext* ctx : thread_state->probe_expr_ctxs) {
+        hash = RawValue::get_hash_value_fvn(ctx->get_value(row), ctx->root()->type(), hash);
+    }
+    return hash % NUM_PARALLEL_PARTITIONS;
+}
+
+void AggregationNode::process_row_batch_parallel(
+        AggregationThreadState* thread_state, RowBatch* batch) {
+    for (int i = 0; i < batch->num_rows(); ++i) {
+        TupleRow* row = batch->get_row(i);
+        HashTable* hash_tbl = thread_state->hash_tbls[partition_of(thread_state, row)].get();
+        Tuple* agg_tuple = NULL;
+        HashTable::Iterator it = hash_tbl->find(row);
+
+        if (it.at_end()) {
+            agg_tuple = construct_intermediate_tuple(thread_state->evaluators,
+                    thread_state->fn_ctxs, hash_tbl, thread_state->tuple_pool.get());
+            hash_tbl->insert(reinterpret_cast<TupleRow*>(&agg_tuple));
+        } else {
+            agg_tuple = it.get_row()->get_tuple(0);
+        }
+
+        AggFnEvaluator::add(thread_state->evaluators, thread_state->fn_ctxs, row, agg_tuple);
+    }
+}
+
 }
 
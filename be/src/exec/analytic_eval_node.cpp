@@ -17,6 +17,10 @@
 
 #include "exec/analytic_eval_node.h"
 
+#include <limits>
+#include <boost/bind.hpp>
+
+#include "common/config.h"
 #include "exprs/agg_fn_evaluator.h"
 #include "exprs/anyval_util.h"
 
@@ -24,14 +28,76 @@
 #include "runtime/descriptors.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
+#include "runtime/thread_resource_mgr.h"
 #include "udf/udf_internal.h"
 
 static const int MAX_TUPLE_POOL_SIZE = 8 * 1024 * 1024; // 8MB
 
+// Minimum number of batches of rows of the chunks dealt to the workers in parallel mode.
+// The rows of a chunk are returned before the ones of the next chunk of its worker are
+// needed as long as a chunk has more than a batch of rows.
+static const int PARALLEL_CHUNK_BATCHES = 8;
+
 namespace doris {
 
 using doris_udf::BigIntVal;
 
+// Child of a worker in parallel mode, returns the batches the dispatch thread queues.
+class AnalyticWorkerInputNode : public ExecNode {
+public:
+    AnalyticWorkerInputNode(ObjectPool* pool, const TPlanNode& tnode,
+                            const DescriptorTbl& descs, BlockingQueue<RowBatch*>* queue) :
+            ExecNode(pool, tnode, descs),
+            _queue(queue),
+            _batch(NULL),
+            _batch_idx(0) {
+    }
+
+    virtual Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos) {
+        *eos = false;
+        if (_batch == NULL) {
+            if (!_queue->blocking_get(&_batch)) {
+                *eos = true;
+                return Status::OK;
+            }
+            _batch_idx = 0;
+        }
+        int num_rows = std::min(row_batch->capacity() - row_batch->num_rows(),
+                                _batch->num_rows() - _batch_idx);
+        for (int i = 0; i < num_rows; ++i) {
+            TupleRow* dest = row_batch->get_row(row_batch->add_row());
+            _batch->copy_row(_batch->get_row(_batch_idx++), dest);
+            row_batch->commit_last_row();
+        }
+        _num_rows_returned += num_rows;
+        if (_batch_idx == _batch->num_rows()) {
+            _batch->transfer_resource_ownership(row_batch);
+            delete _batch;
+            _batch = NULL;
+        }
+        return Status::OK;
+    }
+
+    virtual Status close(RuntimeState* state) {
+        delete _batch;
+        _batch = NULL;
+        return ExecNode::close(state);
+    }
+
+private:
+    BlockingQueue<RowBatch*>* _queue;
+    RowBatch* _batch;
+    int _batch_idx;
+};
+
+AnalyticEvalNode::AnalyticWorker::AnalyticWorker() :
+        node(NULL),
+        input(std::numeric_limits<uint32_t>::max()),
+        output(std::numeric_limits<uint32_t>::max()),
+        output_batch(NULL),
+        output_idx(0) {
+}
+
 AnalyticEvalNode::AnalyticEvalNode(ObjectPool* pool, const TPlanNode& tnode,
                                    const DescriptorTbl& descs) :
         ExecNode(pool, tnode, descs),
@@ -55,7 +121,16 @@ AnalyticEvalNode::AnalyticEvalNode(ObjectPool* pool, const TPlanNode& tnode,
         _curr_partition_idx(-1),
         _prev_input_row(NULL),
         _input_eos(false),
-        _evaluation_timer(NULL) {
+        _evaluation_timer(NULL),
+        _is_streaming(false),
+        _stream_idx(0),
+        _prev_input_tuple(NULL),
+        _block_mgr(NULL),
+        _is_worker(false),
+        _num_active_workers(0),
+        _dispatch_done(false),
+        _output_worker(0),
+        _output_chunk_rows(0) {
     if (tnode.analytic_node.__isset.buffered_tuple_id) {
         _buffered_tuple_desc = descs.get_tuple_descriptor(
                                    tnode.analytic_node.buffered_tuple_id);
@@ -105,6 +180,10 @@ AnalyticEvalNode::AnalyticEvalNode(ObjectPool* pool, const TPlanNode& tnode,
         }
     }
 
+    // The result of a row is known once it is added when the window ends at the row.
+    _is_streaming = config::enable_streaming_analytic && _fn_scope == ROWS &&
+            _window.__isset.window_end && _rows_end_offset == 0;
+
     VLOG_ROW << "tnode=" <<  apache::thrift::ThriftDebugString(tnode);
 }
 
@@ -127,6 +206,9 @@ Status AnalyticEvalNode::init(const TPlanNode& tnode, RuntimeState* state) {
     DCHECK(_fn_scope != PARTITION || analytic_node.order_by_exprs.empty());
     DCHECK(_window.__isset.window_end || !_window.__isset.window_start)
             << "UNBOUNDED FOLLOWING is only supported with UNBOUNDED PRECEDING.";
+    if (config::parallel_analytic_num_threads > 1) {
+        _tnode = tnode;
+    }
 
     if (analytic_node.__isset.partition_by_eq) {
         DCHECK(analytic_node.__isset.buffered_tuple_id);
@@ -150,9 +232,13 @@ Status AnalyticEvalNode::prepare(RuntimeState* state) {
     _child_tuple_desc = child(0)->row_desc().tuple_descriptors()[0];
     _curr_tuple_pool.reset(new MemPool(mem_tracker()));
     _prev_tuple_pool.reset(new MemPool(mem_tracker()));
+    _prev_input_tuple_pool.reset(new MemPool(mem_tracker()));
     _mem_pool.reset(new MemPool(mem_tracker()));
 
     _evaluation_timer = ADD_TIMER(runtime_profile(), "EvaluationTime");
+    if (_is_streaming) {
+        runtime_profile()->add_info_string("EvaluationMode", "Streaming");
+    }
     DCHECK_EQ(_result_tuple_desc->slots().size(), _evaluators.size());
 
     for (int i = 0; i < _evaluators.size(); ++i) {
@@ -186,6 +272,50 @@ Status AnalyticEvalNode::prepare(RuntimeState* state) {
 
     _child_tuple_cmp_row = reinterpret_cast<TupleRow*>(
                                _mem_pool->allocate(sizeof(Tuple*) * 2));
+
+    // The input is sorted by the partition exprs, whole partitions can be evaluated
+    // apart from each other.
+    if (config::parallel_analytic_num_threads > 1 && _partition_by_eq_expr_ctx != NULL
+            && !_is_worker) {
+        RETURN_IF_ERROR(prepare_workers(state));
+    }
+    return Status::OK;
+}
+
+Status AnalyticEvalNode::prepare_workers(RuntimeState* state) {
+    RowDescriptor input_row_desc = child(0)->row_desc();
+    TPlanNode input_tnode;
+    input_tnode.node_id = id();
+    input_tnode.node_type = TPlanNodeType::EXCHANGE_NODE;
+    input_tnode.num_children = 0;
+    input_tnode.limit = -1;
+    input_tnode.compact_data = false;
+    input_row_desc.to_thrift(&input_tnode.row_tuples);
+    for (int i = 0; i < input_row_desc.tuple_descriptors().size(); ++i) {
+        input_tnode.nullable_tuples.push_back(input_row_desc.tuple_is_nullable(i));
+    }
+
+    // This node applies the conjuncts and the limit to the rows of all the workers.
+    TPlanNode worker_tnode = _tnode;
+    worker_tnode.conjuncts.clear();
+    worker_tnode.__isset.conjuncts = false;
+    worker_tnode.limit = -1;
+    for (int i = 0; i < config::parallel_analytic_num_threads; ++i) {
+        std::unique_ptr<AnalyticWorker> worker(new AnalyticWorker());
+        worker->node = _pool->add(new AnalyticEvalNode(_pool, worker_tnode, state->desc_tbl()));
+        worker->node->_is_worker = true;
+        worker->node->runtime_profile()->set_name(
+            runtime_profile()->name() + " worker " + std::to_string(i));
+        RETURN_IF_ERROR(worker->node->init(worker_tnode, state));
+        worker->node->_children.push_back(_pool->add(new AnalyticWorkerInputNode(
+                    _pool, input_tnode, state->desc_tbl(), &worker->input)));
+        RETURN_IF_ERROR(worker->node->prepare(state));
+        RETURN_IF_ERROR(BufferedBlockMgr::create(
+                state, config::sorter_block_size, &worker->block_mgr));
+        worker->node->_block_mgr = worker->block_mgr.get();
+        runtime_profile()->add_child(worker->node->runtime_profile(), true, NULL);
+        _workers.push_back(std::move(worker));
+    }
     return Status::OK;
 }
 
@@ -195,8 +325,14 @@ Status AnalyticEvalNode::open(RuntimeState* state) {
     RETURN_IF_CANCELLED(state);
     //RETURN_IF_ERROR(QueryMaintenance(state));
     RETURN_IF_ERROR(child(0)->open(state));
+    if (!_workers.empty()) {
+        return start_workers(state);
+    }
     // RETURN_IF_ERROR(state->block_mgr()->RegisterClient(2, mem_tracker(), state, &client_));
-    _input_stream.reset(new BufferedTupleStream(state, child(0)->row_desc(), state->block_mgr()));
+    if (_block_mgr == NULL) {
+        _block_mgr = state->block_mgr();
+    }
+    _input_stream.reset(new BufferedTupleStream(state, child(0)->row_desc(), _block_mgr));
     RETURN_IF_ERROR(_input_stream->init(runtime_profile()));
     DCHECK_EQ(_evaluators.size(), _fn_ctxs.size());
 
@@ -228,6 +364,11 @@ Status AnalyticEvalNode::open(RuntimeState* state) {
     // Initialize state for the first partition.
     init_next_partition(0);
 
+    if (_is_streaming) {
+        // Child batches are fetched by get_next_streaming().
+        return Status::OK;
+    }
+
     // Fetch the first input batch so that some _prev_input_row can be set here to avoid
     // special casing in GetNext().
     _prev_child_batch.reset(new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
@@ -810,6 +951,18 @@ Status AnalyticEvalNode::get_next(RuntimeState* state, RowBatch* row_batch, bool
         *eos = false;
     }
 
+    if (!_workers.empty()) {
+        RETURN_IF_ERROR(get_next_parallel(state, row_batch, eos));
+        COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+        return Status::OK;
+    }
+
+    if (_is_streaming) {
+        RETURN_IF_ERROR(get_next_streaming(state, row_batch, eos));
+        COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+        return Status::OK;
+    }
+
     RETURN_IF_ERROR(process_child_batches(state));
     bool output_eos = false;
     RETURN_IF_ERROR(get_next_output_batch(state, row_batch, &output_eos));
@@ -836,11 +989,352 @@ Status AnalyticEvalNode::get_next(RuntimeState* state, RowBatch* row_batch, bool
     return Status::OK;
 }
 
+Status AnalyticEvalNode::get_next_streaming(RuntimeState* state, RowBatch* row_batch,
+        bool* eos) {
+    const int num_child_tuples = child(0)->row_desc().tuple_descriptors().size();
+    ExprContext** ctxs = &_conjunct_ctxs[0];
+    int num_ctxs = _conjunct_ctxs.size();
+    // All rows of a child batch fit in the output batch, which gets its resources.
+    if (_curr_child_batch == NULL || _curr_child_batch->capacity() != row_batch->capacity()) {
+        _curr_child_batch.reset(
+                new RowBatch(child(0)->row_desc(), row_batch->capacity(), mem_tracker()));
+    }
+
+    while (row_batch->num_rows() == 0 && !_input_eos && !reached_limit()) {
+        RETURN_IF_CANCELLED(state);
+        _curr_child_batch->reset();
+        RETURN_IF_ERROR(child(0)->get_next(state, _curr_child_batch.get(), &_input_eos));
+        if (_curr_child_batch->num_rows() == 0) {
+            continue;
+        }
+
+        SCOPED_TIMER(_evaluation_timer);
+        if (_prev_input_row == NULL) {
+            _prev_input_row = _curr_child_batch->get_row(0);
+        }
+        for (int i = 0; i < _curr_child_batch->num_rows() && !reached_limit();
+                ++i, ++_stream_idx) {
+            TupleRow* row = _curr_child_batch->get_row(i);
+            _child_tuple_cmp_row->set_tuple(0, _prev_input_row->get_tuple(0));
+            _child_tuple_cmp_row->set_tuple(1, row->get_tuple(0));
+            try_remove_rows_before_window(_stream_idx);
+            if (_partition_by_eq_expr_ctx != NULL &&
+                    !prev_row_compare(_partition_by_eq_expr_ctx)) {
+                init_next_partition(_stream_idx);
+            }
+
+            // The window starts at or before the current row, every row is in it.
+            AggFnEvaluator::add(_evaluators, _fn_ctxs, row, _curr_tuple);
+            if (_window.__isset.window_start) {
+                Tuple* tuple = row->get_tuple(0)->deep_copy(*_child_tuple_desc,
+                               _curr_tuple_pool.get());
+                _window_tuples.push_back(std::pair<int64_t, Tuple*>(_stream_idx, tuple));
+            }
+
+            Tuple* result_tuple = Tuple::create(_result_tuple_desc->byte_size(),
+                                                row_batch->tuple_data_pool());
+            AggFnEvaluator::get_value(_evaluators, _fn_ctxs, _curr_tuple, result_tuple);
+            TupleRow* dest = row_batch->get_row(row_batch->add_row());
+            _curr_child_batch->copy_row(row, dest);
+            dest->set_tuple(num_child_tuples, result_tuple);
+            if (ExecNode::eval_conjuncts(ctxs, num_ctxs, dest)) {
+                row_batch->commit_last_row();
+                ++_num_rows_returned;
+            }
+            _prev_input_row = row;
+        }
+
+        // The rows of the next batch are compared with the last one of this batch,
+        // which is returned by the parent in the mean time.
+        _prev_input_tuple_pool->clear();
+        _prev_input_tuple = _prev_input_row->get_tuple(0)->deep_copy(*_child_tuple_desc,
+                            _prev_input_tuple_pool.get());
+        _prev_input_row = reinterpret_cast<TupleRow*>(&_prev_input_tuple);
+        _curr_child_batch->transfer_resource_ownership(row_batch);
+
+        // Window tuples are freed once they are all removed from the window.
+        if (_prev_pool_last_window_idx != -1 && (_window_tuples.empty() ||
+                    _prev_pool_last_window_idx < _window_tuples.front().first)) {
+            _prev_tuple_pool->free_all();
+            _prev_pool_last_window_idx = -1;
+        }
+        if (_curr_tuple_pool->total_allocated_bytes() > MAX_TUPLE_POOL_SIZE) {
+            if (_window_tuples.empty()) {
+                _curr_tuple_pool->clear();
+            } else if (_prev_pool_last_window_idx == -1) {
+                _prev_tuple_pool->acquire_data(_curr_tuple_pool.get(), false);
+                _prev_pool_last_window_idx = _window_tuples.back().first;
+            }
+        }
+    }
+
+    *eos = _input_eos || reached_limit();
+    return Status::OK;
+}
+
+Status AnalyticEvalNode::start_workers(RuntimeState* state) {
+    // The dispatch thread finds the ends of the partitions.
+    RETURN_IF_ERROR(_partition_by_eq_expr_ctx->open(state));
+    // This thread only waits for the workers, their first one does not need a token.
+    _num_active_workers = 1;
+    while (_num_active_workers < _workers.size()
+            && state->resource_pool()->try_acquire_thread_token()) {
+        ++_num_active_workers;
+    }
+    runtime_profile()->add_info_string("ParallelWorkers", std::to_string(_num_active_workers));
+    for (int i = 0; i < _num_active_workers; ++i) {
+        _parallel_threads.create_thread(
+            boost::bind(&AnalyticEvalNode::worker_thread, this, state, i));
+    }
+    _parallel_threads.create_thread(boost::bind(&AnalyticEvalNode::dispatch_thread, this, state));
+    return Status::OK;
+}
+
+void AnalyticEvalNode::dispatch_thread(RuntimeState* state) {
+    const std::vector<TupleDescriptor*>& descs = child(0)->row_desc().tuple_descriptors();
+    const int64_t min_chunk_rows = PARALLEL_CHUNK_BATCHES * state->batch_size();
+    int worker_idx = 0;
+    int64_t num_chunk_rows = 0;
+    bool eos = false;
+    Status status;
+    while (!eos && status.ok()) {
+        if (state->is_cancelled()) {
+            status = Status::CANCELLED;
+            break;
+        }
+        std::unique_ptr<RowBatch> batch(
+            new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
+        status = child(0)->get_next(state, batch.get(), &eos);
+        if (!status.ok() || batch->num_rows() == 0) {
+            continue;
+        }
+
+        for (int i = 0; i < batch->num_rows(); ++i) {
+            TupleRow* row = batch->get_row(i);
+            if (num_chunk_rows >= min_chunk_rows) {
+                _child_tuple_cmp_row->set_tuple(0, _prev_input_row->get_tuple(0));
+                _child_tuple_cmp_row->set_tuple(1, row->get_tuple(0));
+            }
+            if (num_chunk_rows < min_chunk_rows || prev_row_compare(_partition_by_eq_expr_ctx)) {
+                ++num_chunk_rows;
+                _prev_input_row = row;
+                continue;
+            }
+
+            // The rows from the new partition on go to the next worker, they are copied
+            // since a batch is owned by the worker it is given to.
+            if (i > 0) {
+                RowBatch* tail = new RowBatch(
+                    child(0)->row_desc(), state->batch_size(), mem_tracker());
+                for (int j = i; j < batch->num_rows(); ++j) {
+                    TupleRow* dest = tail->get_row(tail->add_row());
+                    batch->get_row(j)->deep_copy(dest, descs, tail->tuple_data_pool(), false);
+                    tail->commit_last_row();
+                }
+                batch->set_num_rows(i);
+                if (_workers[worker_idx]->input.blocking_put(batch.get())) {
+                    batch.release();
+                }
+                batch.reset(tail);
+                i = 0;
+                row = batch->get_row(0);
+            }
+
+            boost::unique_lock<boost::mutex> l(_parallel_lock);
+            _chunks.push_back(std::make_pair(worker_idx, num_chunk_rows));
+            _parallel_cv.notify_all();
+            // A worker needs the first rows of the next chunk it is dealt to end the last
+            // partition of the current one, which is dealt before the rows of the chunks
+            // in between are all returned. Dealing more chunks would only buffer them.
+            while (_chunks.size() >= 2 * static_cast<size_t>(_num_active_workers) && _parallel_status.ok()) {
+                _parallel_cv.wait(l);
+            }
+            status = _parallel_status;
+            if (!status.ok()) {
+                break;
+            }
+            worker_idx = (worker_idx + 1) % _num_active_workers;
+            num_chunk_rows = 1;
+            _prev_input_row = row;
+        }
+        if (!status.ok()) {
+            break;
+        }
+
+        // The rows of the next batch are compared with the last one of this batch,
+        // which may be freed by the worker in the mean time.
+        _prev_input_tuple_pool->clear();
+        _prev_input_tuple = _prev_input_row->get_tuple(0)->deep_copy(*_child_tuple_desc,
+                            _prev_input_tuple_pool.get());
+        _prev_input_row = reinterpret_cast<TupleRow*>(&_prev_input_tuple);
+        if (_workers[worker_idx]->input.blocking_put(batch.get())) {
+            batch.release();
+        }
+    }
+
+    {
+        boost::lock_guard<boost::mutex> l(_parallel_lock);
+        if (status.ok() && num_chunk_rows > 0) {
+            _chunks.push_back(std::make_pair(worker_idx, num_chunk_rows));
+        }
+        _dispatch_done = true;
+    }
+    _parallel_cv.notify_all();
+    if (!status.ok()) {
+        set_parallel_status(status);
+    }
+    // The workers end their last partition once their input is done.
+    for (auto& worker : _workers) {
+        worker->input.shutdown();
+    }
+}
+
+void AnalyticEvalNode::worker_thread(RuntimeState* state, int worker_idx) {
+    AnalyticWorker* worker = _workers[worker_idx].get();
+    Status status = worker->node->open(state);
+    bool eos = false;
+    while (status.ok() && !eos) {
+        std::unique_ptr<RowBatch> batch(new RowBatch(
+                worker->node->row_desc(), state->batch_size(), worker->node->mem_tracker()));
+        status = worker->node->get_next(state, batch.get(), &eos);
+        if (!status.ok() || batch->num_rows() == 0) {
+            continue;
+        }
+        if (!worker->output.blocking_put(batch.get())) {
+            break;
+        }
+        batch.release();
+    }
+    if (!status.ok()) {
+        set_parallel_status(status);
+    }
+    worker->output.shutdown();
+}
+
+void AnalyticEvalNode::set_parallel_status(const Status& status) {
+    {
+        boost::lock_guard<boost::mutex> l(_parallel_lock);
+        if (!_parallel_status.ok()) {
+            return;
+        }
+        _parallel_status = status;
+    }
+    _parallel_cv.notify_all();
+    for (auto& worker : _workers) {
+        worker->input.shutdown();
+        worker->output.shutdown();
+    }
+}
+
+Status AnalyticEvalNode::get_next_parallel(RuntimeState* state, RowBatch* row_batch,
+        bool* eos) {
+    ExprContext** ctxs = &_conjunct_ctxs[0];
+    int num_ctxs = _conjunct_ctxs.size();
+    while (!row_batch->at_capacity() && !reached_limit()) {
+        if (_output_chunk_rows == 0) {
+            boost::unique_lock<boost::mutex> l(_parallel_lock);
+            while (_chunks.empty() && !_dispatch_done && _parallel_status.ok()) {
+                _parallel_cv.wait(l);
+            }
+            RETURN_IF_ERROR(_parallel_status);
+            if (_chunks.empty()) {
+                break;
+            }
+            _output_worker = _chunks.front().first;
+            _output_chunk_rows = _chunks.front().second;
+            _chunks.pop_front();
+            _parallel_cv.notify_all();
+        }
+
+        AnalyticWorker* worker = _workers[_output_worker].get();
+        if (worker->output_batch == NULL
+                || worker->output_idx == worker->output_batch->num_rows()) {
+            // The rows of the batch were all returned, which are valid as long as its
+            // resources are.
+            if (worker->output_batch != NULL) {
+                worker->output_batch->transfer_resource_ownership(row_batch);
+                delete worker->output_batch;
+                worker->output_batch = NULL;
+            }
+            bool got_batch = worker->output.blocking_get(&worker->output_batch);
+            {
+                boost::lock_guard<boost::mutex> l(_parallel_lock);
+                RETURN_IF_ERROR(_parallel_status);
+            }
+            if (!got_batch) {
+                return Status("analytic worker returned fewer rows than it was given");
+            }
+            worker->output_idx = 0;
+            continue;
+        }
+
+        int64_t num_rows = std::min<int64_t>(_output_chunk_rows,
+                worker->output_batch->num_rows() - worker->output_idx);
+        int64_t i = 0;
+        while (i < num_rows && !row_batch->at_capacity() && !reached_limit()) {
+            TupleRow* row = worker->output_batch->get_row(worker->output_idx + i);
+            TupleRow* dest = row_batch->get_row(row_batch->add_row());
+            worker->output_batch->copy_row(row, dest);
+            if (ExecNode::eval_conjuncts(ctxs, num_ctxs, dest)) {
+                row_batch->commit_last_row();
+                ++_num_rows_returned;
+            }
+            ++i;
+        }
+        worker->output_idx += i;
+        _output_chunk_rows -= i;
+    }
+
+    if (_output_chunk_rows == 0 || reached_limit()) {
+        boost::lock_guard<boost::mutex> l(_parallel_lock);
+        *eos = reached_limit() || (_chunks.empty() && _dispatch_done);
+    }
+    if (*eos) {
+        // The last rows may be from any worker.
+        for (auto& worker : _workers) {
+            if (worker->output_batch != NULL) {
+                worker->output_batch->transfer_resource_ownership(row_batch);
+                delete worker->output_batch;
+                worker->output_batch = NULL;
+            }
+        }
+    }
+    return Status::OK;
+}
+
+void AnalyticEvalNode::close_workers(RuntimeState* state) {
+    // Stops the threads which are still running, this does nothing once they are done.
+    set_parallel_status(Status::CANCELLED);
+    _parallel_threads.join_all();
+    for (int i = 1; i < _num_active_workers; ++i) {
+        state->resource_pool()->release_thread_token(false);
+    }
+    _num_active_workers = 0;
+
+    for (auto& worker : _workers) {
+        RowBatch* batch = NULL;
+        while (worker->input.blocking_get(&batch)) {
+            delete batch;
+        }
+        while (worker->output.blocking_get(&batch)) {
+            delete batch;
+        }
+        delete worker->output_batch;
+        worker->output_batch = NULL;
+        worker->node->close(state);
+        worker->block_mgr.reset();
+    }
+}
+
 Status AnalyticEvalNode::close(RuntimeState* state) {
     if (is_closed()) {
         return Status::OK;
     }
 
+    if (!_workers.empty()) {
+        close_workers(state);
+    }
+
     if (_input_stream.get() != NULL) {
         _input_stream->close();
     }
@@ -884,6 +1378,9 @@ Status AnalyticEvalNode::close(RuntimeState* state) {
     if (_prev_tuple_pool.get() != NULL) {
         _prev_tuple_pool->free_all();
     }
+    if (_prev_input_tuple_pool.get() != NULL) {
+        _prev_input_tuple_pool->free_all();
+    }
     if (_mem_pool.get() != NULL) {
         _mem_pool->free_all();
     }
@@ -18,6 +18,12 @@
 #ifndef INF_DORIS_BE_SRC_EXEC_ANALYTIC_EVAL_NODE_H
 #define INF_DORIS_BE_SRC_EXEC_ANALYTIC_EVAL_NODE_H
 
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <memory>
+
 #include "exec/exec_node.h"
 #include "exprs/expr.h"
 //#include "exprs/expr_context.h"
@@ -25,6 +31,7 @@
 #include "runtime/buffered_tuple_stream.h"
 #include "runtime/tuple.h"
 #include "thrift/protocol/TDebugProtocol.h"
+#include "util/blocking_queue.hpp"
 
 namespace doris {
 
@@ -59,6 +66,11 @@ class AggFnEvaluator;
 // multiple rows have the same values for the order by exprs. The number of buffered
 // rows may be an entire partition or even the entire input. Therefore, the output
 // rows are buffered and may spill to disk via the BufferedTupleStream.
+//
+// ROWS windows ending at the current row (e.g. row_number(), rank() and running or
+// sliding aggregates over N PRECEDING) have the result of a row once it is added to
+// the evaluators. They are evaluated in streaming mode: the rows of each child batch
+// are returned with their results at once, no rows are buffered.
 class AnalyticEvalNode : public ExecNode {
 public:
     ~AnalyticEvalNode() {}
@@ -124,10 +136,57 @@ private:
     // are ready to return an output batch.
     Status process_child_batches(RuntimeState* state);
 
+    // Implements get_next() in streaming mode: evaluates the next child batch and
+    // returns its rows with their results in 'row_batch'.
+    Status get_next_streaming(RuntimeState* state, RowBatch* row_batch, bool* eos);
+
     // Returns a batch of output rows from _input_stream with the analytic function
     // results (from _result_tuples) set as the last tuple.
     Status get_next_output_batch(RuntimeState* state, RowBatch* row_batch, bool* eos);
 
+    // An analytic node evaluating the whole partitions of some chunks of the input in
+    // parallel mode, with the queues of the batches it is given and returns.
+    struct AnalyticWorker {
+        AnalyticWorker();
+
+        AnalyticEvalNode* node;
+        // the block mgr of the runtime state may not be used by several threads
+        boost::shared_ptr<BufferedBlockMgr> block_mgr;
+        // not bounded, the dispatch thread bounds the number of chunks in flight
+        BlockingQueue<RowBatch*> input;
+        BlockingQueue<RowBatch*> output;
+        // output batch of which rows are returned and the index of the next one
+        RowBatch* output_batch;
+        int output_idx;
+    };
+
+    // Creates the workers of parallel mode, which is used when there are partition
+    // exprs and config::parallel_analytic_num_threads is above 1.
+    Status prepare_workers(RuntimeState* state);
+
+    // Starts the dispatch thread and the threads of as many workers as thread tokens
+    // are available for.
+    Status start_workers(RuntimeState* state);
+
+    // Implements get_next() in parallel mode: returns the rows of the workers in the
+    // order of the chunks, applying the conjuncts and the limit.
+    Status get_next_parallel(RuntimeState* state, RowBatch* row_batch, bool* eos);
+
+    // Reads the child batches and deals chunks of whole partitions to the workers in
+    // turn, each with at least PARALLEL_CHUNK_BATCHES batches of rows.
+    void dispatch_thread(RuntimeState* state);
+
+    // Evaluates the chunks of the worker and queues its output batches.
+    void worker_thread(RuntimeState* state, int worker_idx);
+
+    // Records the first error of the threads of parallel mode and shuts down the
+    // queues so that none of them keeps waiting.
+    void set_parallel_status(const Status& status);
+
+    // Stops the threads of parallel mode, frees the queued batches and closes the
+    // workers.
+    void close_workers(RuntimeState* state);
+
     // Determines if there is a window ending at the previous row, and if so, calls
     // add_result_tuple() with the index of the previous row in _input_stream. next_partition
     // indicates if the current row is the start of a new partition. stream_idx is the
@@ -327,6 +386,47 @@ private:
 
     // Time spent processing the child rows.
     RuntimeProfile::Counter* _evaluation_timer;
+
+    // True if the window ends at the current row, rows are then not buffered in
+    // _input_stream but returned with their results by get_next_streaming().
+    bool _is_streaming;
+
+    // Index of the next child row in streaming mode.
+    int64_t _stream_idx;
+
+    // Copy of the tuple of the last row of the previous child batch in streaming mode,
+    // _prev_input_row points to it while the batch is returned by the parent.
+    Tuple* _prev_input_tuple;
+    boost::scoped_ptr<MemPool> _prev_input_tuple_pool;
+
+    // Block mgr of _input_stream, the one of the runtime state unless set by the node
+    // of which this one is a worker.
+    BufferedBlockMgr* _block_mgr;
+
+    // Plan node the workers are created from in parallel mode.
+    TPlanNode _tnode;
+
+    // True if this node evaluates chunks of the input of another one in parallel mode.
+    bool _is_worker;
+
+    // Workers of parallel mode, empty otherwise. Only the first _num_active_workers
+    // ones are given chunks, the others did not get a thread token.
+    std::vector<std::unique_ptr<AnalyticWorker> > _workers;
+    int _num_active_workers;
+    boost::thread_group _parallel_threads;
+
+    // Protects the state below, shared by the dispatch thread, the workers and the
+    // thread calling get_next(). _parallel_cv is signaled when any of it changes.
+    boost::mutex _parallel_lock;
+    boost::condition_variable _parallel_cv;
+    Status _parallel_status;
+    // Worker and number of rows of the chunks dealt but not returned yet, in order.
+    std::deque<std::pair<int, int64_t> > _chunks;
+    bool _dispatch_done;
+
+    // Worker and number of rows left of the chunk get_next_parallel() returns rows of.
+    int _output_worker;
+    int64_t _output_chunk_rows;
 };
 
 }
@@ -0,0 +1,316 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/base_scanner.h"
+
+#include <sstream>
+
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "exprs/slot_ref.h"
+#include "runtime/datetime_value.h"
+#include "runtime/decimal_value.h"
+#include "runtime/decimalv2_value.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/raw_value.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple_row.h"
+#include "util/string_parser.hpp"
+
+namespace doris {
+
+BaseScanner::BaseScanner(RuntimeState* state,
+                         RuntimeProfile* profile,
+                         const TBrokerScanRangeParams& params,
+                         BrokerScanCounter* counter) :
+        _state(state),
+        _profile(profile),
+        _params(params),
+        _src_tuple_desc(nullptr),
+        _src_tuple(nullptr),
+        _src_tuple_row(nullptr),
+#if BE_TEST
+        _mem_tracker(new MemTracker()),
+        _mem_pool(_mem_tracker.get()),
+#else 
+        _mem_tracker(new MemTracker(-1, "Broker Scanner", state->instance_mem_tracker())),
+        _mem_pool(_state->instance_mem_tracker()),
+#endif
+        _dest_tuple_desc(nullptr),
+        _counter(counter),
+        _rows_read_counter(nullptr),
+        _read_timer(nullptr),
+        _materialize_timer(nullptr) {
+}
+
+Status BaseScanner::init_expr_ctxes() {
+    // Constcut _src_slot_descs
+    _src_tuple_desc = _state->desc_tbl().get_tuple_descriptor(_params.src_tuple_id);
+    if (_src_tuple_desc == nullptr) {
+        std::stringstream ss;
+        ss << "Unknown source tuple descriptor, tuple_id=" << _params.src_tuple_id;
+        return Status(ss.str());
+    }
+
+    std::map<SlotId, SlotDescriptor*> src_slot_desc_map;
+    for (auto slot_desc : _src_tuple_desc->slots()) {
+        src_slot_desc_map.emplace(slot_desc->id(), slot_desc);
+    }
+    for (auto slot_id : _params.src_slot_ids) {
+        auto it = src_slot_desc_map.find(slot_id);
+        if (it == std::end(src_slot_desc_map)) {
+            std::stringstream ss;
+            ss << "Unknown source slot descriptor, slot_id=" << slot_id;
+            return Status(ss.str());
+        }
+        _src_slot_descs.emplace_back(it->second);
+    }
+    // Construct source tuple and tuple row
+    _src_tuple = (Tuple*) _mem_pool.allocate(_src_tuple_desc->byte_size());
+    _src_tuple_row = (TupleRow*) _mem_pool.allocate(sizeof(Tuple*));
+    _src_tuple_row->set_tuple(0, _src_tuple);
+    _row_desc.reset(new RowDescriptor(_state->desc_tbl(), 
+                                      std::vector<TupleId>({_params.src_tuple_id}), 
+                                      std::vector<bool>({false})));
+
+    // Construct dest slots information
+    _dest_tuple_desc = _state->desc_tbl().get_tuple_descriptor(_params.dest_tuple_id);
+    if (_dest_tuple_desc == nullptr) {
+        std::stringstream ss;
+        ss << "Unknown dest tuple descriptor, tuple_id=" << _params.dest_tuple_id;
+        return Status(ss.str());
+    }
+
+    for (auto slot_desc : _dest_tuple_desc->slots()) {
+        if (!slot_desc->is_materialized()) {
+            continue;
+        }
+        auto it = _params.expr_of_dest_slot.find(slot_desc->id());
+        if (it == std::end(_params.expr_of_dest_slot)) {
+            std::stringstream ss;
+            ss << "No expr for dest slot, id=" << slot_desc->id() 
+                << ", name=" << slot_desc->col_name();
+            return Status(ss.str());
+        }
+        ExprContext* ctx = nullptr;
+        RETURN_IF_ERROR(Expr::create_expr_tree(_state->obj_pool(), it->second, &ctx));
+        RETURN_IF_ERROR(ctx->prepare(_state, *_row_desc.get(), _mem_tracker.get()));
+        RETURN_IF_ERROR(ctx->open(_state));
+        _dest_expr_ctx.emplace_back(ctx);
+        _dest_slot_descs.push_back(slot_desc);
+        _direct_src_slots.push_back(direct_src_slot(ctx, slot_desc));
+        _direct_write_fns.push_back(_direct_src_slots.back() != nullptr
+                                    ? get_write_string_fn(slot_desc->type()) : nullptr);
+    }
+
+    return Status::OK;
+}
+
+const SlotDescriptor* BaseScanner::direct_src_slot(
+        ExprContext* ctx, const SlotDescriptor* dest_slot_desc) {
+    Expr* root = ctx->root();
+    Expr* slot_ref = root;
+    bool is_cast = root->node_type() == TExprNodeType::CAST_EXPR;
+    if (is_cast && root->get_num_children() == 1) {
+        slot_ref = root->get_child(0);
+    }
+    if (slot_ref->node_type() != TExprNodeType::SLOT_REF
+            || !slot_ref->type().is_string_type()) {
+        return nullptr;
+    }
+    const SlotDescriptor* src_slot_desc = nullptr;
+    for (auto slot_desc : _src_slot_descs) {
+        if (slot_desc->id() == static_cast<SlotRef*>(slot_ref)->slot_id()) {
+            src_slot_desc = slot_desc;
+            break;
+        }
+    }
+    if (src_slot_desc == nullptr || !src_slot_desc->type().is_string_type()) {
+        return nullptr;
+    }
+
+    const TypeDescriptor& dest_type = dest_slot_desc->type();
+    if (!is_cast) {
+        // the string is copied as it is
+        if (dest_type.type == TYPE_CHAR || dest_type.type == TYPE_VARCHAR) {
+            return src_slot_desc;
+        }
+        return nullptr;
+    }
+    if (!(root->type() == dest_type)) {
+        return nullptr;
+    }
+    switch (dest_type.type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_DECIMAL:
+    case TYPE_DECIMALV2:
+        return src_slot_desc;
+    default:
+        return nullptr;
+    }
+}
+
+static bool copy_string(const StringValue& str, void* slot, MemPool* pool) {
+    RawValue::write(&str, slot, TypeDescriptor(TYPE_VARCHAR), pool);
+    return true;
+}
+
+template<typename T>
+static bool parse_int(const StringValue& str, void* slot, MemPool* pool) {
+    StringParser::ParseResult result;
+    T value = StringParser::string_to_int<T>(str.ptr, str.len, &result);
+    if (UNLIKELY(result != StringParser::PARSE_SUCCESS)) {
+        return false;
+    }
+    *reinterpret_cast<T*>(slot) = value;
+    return true;
+}
+
+template<typename T>
+static bool parse_float(const StringValue& str, void* slot, MemPool* pool) {
+    StringParser::ParseResult result;
+    T value = StringParser::string_to_float<T>(str.ptr, str.len, &result);
+    if (UNLIKELY(result != StringParser::PARSE_SUCCESS)) {
+        return false;
+    }
+    *reinterpret_cast<T*>(slot) = value;
+    return true;
+}
+
+template<bool is_date>
+static bool parse_datetime(const StringValue& str, void* slot, MemPool* pool) {
+    DateTimeValue value;
+    if (!value.from_date_str(str.ptr, str.len)) {
+        return false;
+    }
+    if (is_date) {
+        value.cast_to_date();
+    } else {
+        value.to_datetime();
+    }
+    *reinterpret_cast<DateTimeValue*>(slot) = value;
+    return true;
+}
+
+template<typename T>
+static bool parse_decimal(const StringValue& str, void* slot, MemPool* pool) {
+    T value;
+    if (value.parse_from_str(str.ptr, str.len)) {
+        return false;
+    }
+    *reinterpret_cast<T*>(slot) = value;
+    return true;
+}
+
+BaseScanner::WriteStringFn BaseScanner::get_write_string_fn(const TypeDescriptor& type) {
+    switch (type.type) {
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        return &copy_string;
+    case TYPE_TINYINT:
+        return &parse_int<int8_t>;
+    case TYPE_SMALLINT:
+        return &parse_int<int16_t>;
+    case TYPE_INT:
+        return &parse_int<int32_t>;
+    case TYPE_BIGINT:
+        return &parse_int<int64_t>;
+    case TYPE_LARGEINT:
+        return &parse_int<__int128>;
+    case TYPE_FLOAT:
+        return &parse_float<float>;
+    case TYPE_DOUBLE:
+        return &parse_float<double>;
+    case TYPE_DATE:
+        return &parse_datetime<true>;
+    case TYPE_DATETIME:
+        return &parse_datetime<false>;
+    case TYPE_DECIMAL:
+        return &parse_decimal<DecimalValue>;
+    case TYPE_DECIMALV2:
+        return &parse_decimal<DecimalV2Value>;
+    default:
+        DCHECK(false) << "unsupported type of direct conversion: " << type;
+        return nullptr;
+    }
+}
+
+Status BaseScanner::open() {
+    RETURN_IF_ERROR(init_expr_ctxes());
+
+    _rows_read_counter = ADD_COUNTER(_profile, "RowsRead", TUnit::UNIT);
+    _read_timer = ADD_TIMER(_profile, "TotalRawReadTime(*)");
+    _materialize_timer = ADD_TIMER(_profile, "MaterializeTupleTime(*)");
+
+    return Status::OK;
+}
+
+void BaseScanner::close() {
+    Expr::close(_dest_expr_ctx, _state);
+}
+
+bool BaseScanner::fill_dest_tuple(const Slice& line, Tuple* dest_tuple, MemPool* mem_pool) {
+    for (int ctx_idx = 0; ctx_idx < _dest_slot_descs.size(); ++ctx_idx) {
+        const SlotDescriptor* slot_desc = _dest_slot_descs[ctx_idx];
+        const SlotDescriptor* src_slot_desc = _direct_src_slots[ctx_idx];
+        void* slot = dest_tuple->get_slot(slot_desc->tuple_offset());
+        void* value = nullptr;
+        bool is_null = false;
+        if (src_slot_desc != nullptr) {
+            is_null = _src_tuple->is_null(src_slot_desc->null_indicator_offset())
+                || !_direct_write_fns[ctx_idx](
+                    *_src_tuple->get_string_slot(src_slot_desc->tuple_offset()), slot, mem_pool);
+        } else {
+            value = _dest_expr_ctx[ctx_idx]->get_value(_src_tuple_row);
+            is_null = value == nullptr;
+        }
+        if (is_null) {
+            if (slot_desc->is_nullable()) {
+                dest_tuple->set_null(slot_desc->null_indicator_offset());
+                continue;
+            } else {
+                std::stringstream error_msg;
+                error_msg << "column(" << slot_desc->col_name() << ") value is null";
+                if (line.size > 0) {
+                    _state->append_error_msg_to_file(
+                        std::string(line.data, line.size), error_msg.str());
+                } else {
+                    _state->append_error_msg_to_file(
+                        Tuple::to_string(_src_tuple, *_src_tuple_desc), error_msg.str());
+                }
+                _counter->num_rows_filtered++;
+                return false;
+            }
+        }
+        dest_tuple->set_not_null(slot_desc->null_indicator_offset());
+        if (value != nullptr) {
+            RawValue::write(value, slot, slot_desc->type(), mem_pool);
+        }
+    }
+    return true;
+}
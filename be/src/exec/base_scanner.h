@@ -0,0 +1,133 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/status.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/mem_pool.h"
+#include "util/runtime_profile.h"
+#include "util/slice.h"
+
+namespace doris {
+
+class Tuple;
+class TupleDescriptor;
+class TupleRow;
+class RowDescriptor;
+class SlotDescriptor;
+struct TypeDescriptor;
+class ExprContext;
+class MemTracker;
+class RuntimeState;
+struct StringValue;
+
+struct BrokerScanCounter {
+    BrokerScanCounter() :
+        num_rows_total(0),
+        // num_rows_returned(0),
+        num_rows_filtered(0),
+        num_rows_unselected(0) {
+    }
+    
+    int64_t num_rows_total; // total read rows (read from source)
+    // int64_t num_rows_returned;  // qualified rows (match the dest schema)
+    int64_t num_rows_filtered;  // unqualified rows (unmatch the dest schema, or no partition)
+    int64_t num_rows_unselected; // rows filterd by predicates
+};
+
+// Base of scanners of BrokerScanNode. A scanner puts every row of its file
+// in the source tuple, whose slots are all strings, then the dest tuple is
+// got by evaluating the exprs of dest slots over it. Most of these exprs
+// are a source slot or a cast of one, which are converted directly
+// instead.
+class BaseScanner {
+public:
+    BaseScanner(RuntimeState* state,
+                RuntimeProfile* profile,
+                const TBrokerScanRangeParams& params,
+                BrokerScanCounter* counter);
+    virtual ~BaseScanner() { }
+
+    // Open this scanner, will initialize information need to 
+    virtual Status open();
+
+    // Get next tuple 
+    virtual Status get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof) = 0;
+
+    // Close this scanner
+    virtual void close();
+
+protected:
+    Status init_expr_ctxes();
+
+    // The source slot 'ctx' is, or casts to the type of 'dest_slot_desc', if
+    // it is converted directly. NULL if the expr has to be evaluated.
+    const SlotDescriptor* direct_src_slot(ExprContext* ctx,
+                                          const SlotDescriptor* dest_slot_desc);
+
+    // Fill 'dest_tuple' from the source tuple. 'line' is the source row
+    // written to the error log if fails, the source tuple is written if it
+    // is empty.
+    bool fill_dest_tuple(const Slice& line, Tuple* dest_tuple, MemPool* mem_pool);
+
+    // Writes a source string to a dest slot of the type it is specialized for, as
+    // the cast functions from strings do. Returns false if they would return null.
+    typedef bool (*WriteStringFn)(const StringValue& str, void* slot, MemPool* pool);
+    // The function writing to a slot of 'type', one of the types direct_src_slot()
+    // converts directly. It is looked up once per dest slot so that rows are
+    // written without switching on the types.
+    static WriteStringFn get_write_string_fn(const TypeDescriptor& type);
+
+    RuntimeState* _state;
+    RuntimeProfile* _profile;
+    const TBrokerScanRangeParams& _params;
+
+    // Used for constructing tuple
+    // slots for value read from broker file
+    std::vector<SlotDescriptor*> _src_slot_descs;
+    const TupleDescriptor* _src_tuple_desc;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    Tuple* _src_tuple;
+    TupleRow* _src_tuple_row;
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    // Mem pool used to allocate _src_tuple and _src_tuple_row
+    MemPool _mem_pool;
+
+    // Dest tuple descriptor and dest expr context
+    const TupleDescriptor* _dest_tuple_desc;
+    std::vector<ExprContext*> _dest_expr_ctx;
+    // for every expr of _dest_expr_ctx, see direct_src_slot()
+    std::vector<const SlotDescriptor*> _direct_src_slots;
+    // the materialized dest slots, and how each directly converted one is written
+    std::vector<const SlotDescriptor*> _dest_slot_descs;
+    std::vector<WriteStringFn> _direct_write_fns;
+
+    // used for process stat
+    BrokerScanCounter* _counter;
+
+    // Profile
+    RuntimeProfile::Counter* _rows_read_counter;
+    RuntimeProfile::Counter* _read_timer;
+    RuntimeProfile::Counter* _materialize_timer;
+};
+
+}
@@ -36,12 +36,14 @@ BrokerReader::BrokerReader(
         const std::vector<TNetworkAddress>& broker_addresses,
         const std::map<std::string, std::string>& properties,
         const std::string& path,
-        int64_t start_offset) :
+        int64_t start_offset,
+        int64_t file_size) :
             _env(env),
             _addresses(broker_addresses),
             _properties(properties),
             _path(path),
             _cur_offset(start_offset),
+            _file_size(file_size),
             _is_fd_valid(false),
             _eof(false),
             _addr_idx(0) {
@@ -123,12 +125,90 @@ Status BrokerReader::read(uint8_t* buf, size_t* buf_len, bool* eof) {
         *eof = true;
         return Status::OK;
     }
-    
+    RETURN_IF_ERROR(_pread(_cur_offset, buf, buf_len, eof));
+    if (*eof) {
+        _eof = true;
+        return Status::OK;
+    }
+    _cur_offset += *buf_len; 
+    return Status::OK;
+}
+
+Status BrokerReader::readat(int64_t position, int64_t nbytes, int64_t* bytes_read, void* out) {
+    *bytes_read = 0;
+    while (*bytes_read < nbytes) {
+        size_t buf_len = nbytes - *bytes_read;
+        bool eof = false;
+        RETURN_IF_ERROR(_pread(position + *bytes_read,
+                               reinterpret_cast<uint8_t*>(out) + *bytes_read,
+                               &buf_len, &eof));
+        if (eof || buf_len == 0) {
+            break;
+        }
+        *bytes_read += buf_len;
+    }
+    return Status::OK;
+}
+
+Status BrokerReader::size(int64_t* size) {
+    if (_file_size >= 0) {
+        *size = _file_size;
+        return Status::OK;
+    }
+    TBrokerListPathRequest request;
+    const TNetworkAddress& broker_addr = _addresses[_addr_idx];
+    request.__set_version(TBrokerVersion::VERSION_ONE);
+    request.__set_path(_path);
+    request.__set_isRecursive(false);
+    request.__set_properties(_properties);
+
+    TBrokerListResponse response;
+    try {
+        Status status;
+        BrokerServiceConnection client(client_cache(_env), broker_addr, 10000, &status);
+        if (!status.ok()) {
+            LOG(WARNING) << "Create broker client failed. broker=" << broker_addr
+                << ", status=" << status.get_error_msg();
+            return status;
+        }
+
+        try {
+            client->listPath(response, request);
+        } catch (apache::thrift::transport::TTransportException& e) {
+            usleep(1000 * 1000);
+            RETURN_IF_ERROR(client.reopen());
+            client->listPath(response, request);
+        }
+    } catch (apache::thrift::TException& e) {
+        std::stringstream ss;
+        ss << "Get file size from broker failed, broker:" << broker_addr << " failed:" << e.what();
+        LOG(WARNING) << ss.str();
+        return Status(TStatusCode::THRIFT_RPC_ERROR, ss.str(), false);
+    }
+
+    if (response.opStatus.statusCode != TBrokerOperationStatusCode::OK) {
+        std::stringstream ss;
+        ss << "Get file size from broker failed, broker:" << broker_addr 
+            << " failed:" << response.opStatus.message;
+        LOG(WARNING) << ss.str();
+        return Status(ss.str());
+    }
+    if (response.files.size() != 1) {
+        std::stringstream ss;
+        ss << "Get file size from broker failed, path is not a file, path=" << _path;
+        return Status(ss.str());
+    }
+    _file_size = response.files[0].size;
+    *size = _file_size;
+    return Status::OK;
+}
+
+Status BrokerReader::_pread(int64_t offset, uint8_t* buf, size_t* buf_len, bool* eof) {
     const TNetworkAddress& broker_addr = _addresses[_addr_idx];
     TBrokerPReadRequest request;
     request.__set_version(TBrokerVersion::VERSION_ONE);
     request.__set_fd(_fd);
-    request.__set_offset(_cur_offset);
+    request.__set_offset(offset);
     request.__set_length(*buf_len);
 
     TBrokerReadResponse response;
@@ -158,7 +238,7 @@ Status BrokerReader::read(uint8_t* buf, size_t* buf_len, bool* eof) {
 
     if (response.opStatus.statusCode == TBrokerOperationStatusCode::END_OF_FILE) {
         // read the end of broker's file
-        *eof = _eof = true;
+        *eof = true;
         return Status::OK;
     } else if (response.opStatus.statusCode != TBrokerOperationStatusCode::OK) {
         std::stringstream ss;
@@ -170,7 +250,6 @@ Status BrokerReader::read(uint8_t* buf, size_t* buf_len, bool* eof) {
 
     *buf_len = response.data.size();
     memcpy(buf, response.data.data(), *buf_len);
-    _cur_offset += *buf_len; 
     *eof = false;
 
     return Status::OK;
@@ -41,7 +41,8 @@ public:
                  const std::vector<TNetworkAddress>& broker_addresses,
                  const std::map<std::string, std::string>& properties,
                  const std::string& path,
-                 int64_t start_offset);
+                 int64_t start_offset,
+                 int64_t file_size = -1);
     virtual ~BrokerReader();
 
     Status open();
@@ -49,14 +50,24 @@ public:
     // Read 
     virtual Status read(uint8_t* buf, size_t* buf_len, bool* eof) override;
 
+    virtual Status readat(int64_t position, int64_t nbytes,
+                          int64_t* bytes_read, void* out) override;
+
+    // Got from broker if it is not given when this reader is created
+    virtual Status size(int64_t* size) override;
+
     virtual void close() override;
 private:
+    // One pread call to broker, it may read less than 'buf_len'
+    Status _pread(int64_t offset, uint8_t* buf, size_t* buf_len, bool* eof);
+
     ExecEnv* _env;
     const std::vector<TNetworkAddress>& _addresses;
     const std::map<std::string, std::string>& _properties;
     const std::string& _path;
 
     int64_t _cur_offset;
+    int64_t _file_size;
 
     bool _is_fd_valid;
     TBrokerFD _fd;
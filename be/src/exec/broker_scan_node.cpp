@@ -20,16 +20,26 @@
 #include <chrono>
 #include <sstream>
 
+#include "common/config.h"
 #include "common/object_pool.h"
+#include "runtime/exec_env.h"
 #include "runtime/runtime_state.h"
 #include "runtime/row_batch.h"
 #include "runtime/dpp_sink_internal.h"
+#include "runtime/stream_load/load_stream_mgr.h"
+#include "runtime/stream_load/stream_load_pipe.h"
 #include "exec/broker_scanner.h"
+#include "exec/line_chunk_splitter.h"
+#include "exec/parquet_scanner.h"
 #include "exprs/expr.h"
 #include "util/runtime_profile.h"
+#include "util/uid_util.h"
 
 namespace doris {
 
+// bytes of stream load body parsed by one scanner at a time
+static const size_t STREAM_LOAD_CHUNK_SIZE = 1024 * 1024;
+
 BrokerScanNode::BrokerScanNode(
         ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs) : 
             ScanNode(pool, tnode, descs), 
@@ -39,6 +49,7 @@ BrokerScanNode::BrokerScanNode(
             _num_running_scanners(0),
             _scan_finished(false),
             _max_buffered_batches(1024),
+            _next_chunk_seq(0),
             _wait_scanner_timer(nullptr) {
 }
 
@@ -128,6 +139,9 @@ Status BrokerScanNode::open(RuntimeState* state) {
 }
 
 Status BrokerScanNode::start_scanners() {
+    if (config::stream_load_parse_threads > 1 && can_scan_chunks()) {
+        return start_chunk_scanners(config::stream_load_parse_threads);
+    }
     {
         std::unique_lock<std::mutex> l(_batch_queue_lock);
         _num_running_scanners = 1;
@@ -136,6 +150,44 @@ Status BrokerScanNode::start_scanners() {
     return Status::OK;
 }
 
+bool BrokerScanNode::can_scan_chunks() const {
+    if (_scan_ranges.size() != 1) {
+        return false;
+    }
+    const TBrokerScanRange& scan_range = _scan_ranges[0].scan_range.broker_scan_range;
+    // quoted fields may contain line delimiters, chunks can not be cut by them
+    if (scan_range.ranges.size() != 1 || scan_range.params.__isset.enclose) {
+        return false;
+    }
+    const TBrokerRangeDesc& range = scan_range.ranges[0];
+    // json strings have no raw line delimiters, so json lines are cut as csv
+    return range.file_type == TFileType::FILE_STREAM
+        && (range.format_type == TFileFormatType::FORMAT_CSV_PLAIN
+            || range.format_type == TFileFormatType::FORMAT_JSON);
+}
+
+Status BrokerScanNode::start_chunk_scanners(int num_scanners) {
+    const TBrokerScanRange& scan_range = _scan_ranges[0].scan_range.broker_scan_range;
+    const TBrokerRangeDesc& range = scan_range.ranges[0];
+    _stream_load_pipe = _runtime_state->exec_env()->load_stream_mgr()->get(range.load_id);
+    if (_stream_load_pipe == nullptr) {
+        VLOG(3) << "unknown stream load id: " << UniqueId(range.load_id);
+        return Status("unknown stream load id");
+    }
+    _chunk_splitter.reset(new LineChunkSplitter(
+            _stream_load_pipe.get(),
+            static_cast<uint8_t>(scan_range.params.line_delimiter),
+            STREAM_LOAD_CHUNK_SIZE));
+    {
+        std::unique_lock<std::mutex> l(_batch_queue_lock);
+        _num_running_scanners = num_scanners;
+    }
+    for (int i = 0; i < num_scanners; ++i) {
+        _scanner_threads.emplace_back(&BrokerScanNode::chunk_scanner_worker, this);
+    }
+    return Status::OK;
+}
+
 Status BrokerScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eos) {
     SCOPED_TIMER(_runtime_profile->total_time_counter());
     // check if CANCELLED.
@@ -231,6 +283,8 @@ Status BrokerScanNode::close(RuntimeState* state) {
     for (int i = 0; i < _scanner_threads.size(); ++i) {
         _scanner_threads[i].join();
     }
+    _chunk_splitter.reset();
+    _stream_load_pipe.reset();
 
     // Open partition
     if (_partition_expr_ctxs.size() > 0) {
@@ -272,13 +326,25 @@ Status BrokerScanNode::scanner_scan(
         const std::vector<ExprContext*>& conjunct_ctxs, 
         const std::vector<ExprContext*>& partition_expr_ctxs,
         BrokerScanCounter* counter) {
-    std::unique_ptr<BrokerScanner> scanner(new BrokerScanner(
-            _runtime_state, 
-            runtime_profile(),
-            scan_range.params, 
-            scan_range.ranges, 
-            scan_range.broker_addresses, 
-            counter));
+    std::unique_ptr<BaseScanner> scanner;
+    if (!scan_range.ranges.empty()
+            && scan_range.ranges[0].format_type == TFileFormatType::FORMAT_PARQUET) {
+        scanner.reset(new ParquetScanner(
+                _runtime_state, 
+                runtime_profile(),
+                scan_range.params, 
+                scan_range.ranges, 
+                scan_range.broker_addresses, 
+                counter));
+    } else {
+        scanner.reset(new BrokerScanner(
+                _runtime_state, 
+                runtime_profile(),
+                scan_range.params, 
+                scan_range.ranges, 
+                scan_range.broker_addresses, 
+                counter));
+    }
     RETURN_IF_ERROR(scanner->open());
     bool scanner_eof = false;
     
@@ -286,66 +352,12 @@ Status BrokerScanNode::scanner_scan(
         // Fill one row batch
         std::shared_ptr<RowBatch> row_batch(
             new RowBatch(row_desc(), _runtime_state->batch_size(), mem_tracker()));
-
-        // create new tuple buffer for row_batch
-        MemPool* tuple_pool = row_batch->tuple_data_pool();
-        int tuple_buffer_size = row_batch->capacity() * _tuple_desc->byte_size();
-        void* tuple_buffer = tuple_pool->allocate(tuple_buffer_size);
-        if (tuple_buffer == nullptr) {
-            return Status("Allocate memory for row batch failed.");
-        }
-
-        Tuple* tuple = reinterpret_cast<Tuple*>(tuple_buffer);
-        while (!scanner_eof) {
-            RETURN_IF_CANCELLED(_runtime_state);
-            // If we have finished all works
-            if (_scan_finished.load()) {
-                return Status::OK;
-            }
-
-            // This row batch has been filled up, and break this
-            if (row_batch->is_full()) {
-                break;
-            }
-
-            int row_idx = row_batch->add_row();
-            TupleRow* row = row_batch->get_row(row_idx);
-            // scan node is the first tuple of tuple row
-            row->set_tuple(0, tuple);
-            memset(tuple, 0, _tuple_desc->num_null_bytes());
-
-            // Get from scanner
-            RETURN_IF_ERROR(scanner->get_next(tuple, tuple_pool, &scanner_eof));
-            if (scanner_eof) {
-                continue;
-            }
-
-            if (scan_range.params.__isset.partition_ids) {
-                int64_t partition_id = get_partition_id(partition_expr_ctxs, row);
-                if (partition_id == -1 || 
-                        !std::binary_search(scan_range.params.partition_ids.begin(), 
-                                           scan_range.params.partition_ids.end(), 
-                                           partition_id)) {
-                    counter->num_rows_filtered++;
-
-                    std::stringstream error_msg;
-                    error_msg << "No corresponding partition, partition id: " << partition_id;
-                    _runtime_state->append_error_msg_to_file(Tuple::to_string(tuple, *_tuple_desc), 
-                                                             error_msg.str());
-                    continue;
-                }
-            }
-
-            // eval conjuncts of this row.
-            if (eval_conjuncts(&conjunct_ctxs[0], conjunct_ctxs.size(), row)) {
-                row_batch->commit_last_row();
-                char* new_tuple = reinterpret_cast<char*>(tuple);
-                new_tuple += _tuple_desc->byte_size();
-                tuple = reinterpret_cast<Tuple*>(new_tuple);
-                // counter->num_rows_returned++;
-            } else {
-                counter->num_rows_unselected++;
-            }
+        RETURN_IF_ERROR(fill_batch(scanner.get(), scan_range, conjunct_ctxs,
+                                   partition_expr_ctxs, counter,
+                                   row_batch.get(), &scanner_eof));
+        // If we have finished all works
+        if (_scan_finished.load()) {
+            return Status::OK;
         }
 
         // Row batch has been filled, push this to the queue
@@ -380,6 +392,159 @@ Status BrokerScanNode::scanner_scan(
     return Status::OK;
 }
 
+Status BrokerScanNode::fill_batch(
+        BaseScanner* scanner,
+        const TBrokerScanRange& scan_range,
+        const std::vector<ExprContext*>& conjunct_ctxs,
+        const std::vector<ExprContext*>& partition_expr_ctxs,
+        BrokerScanCounter* counter,
+        RowBatch* row_batch,
+        bool* scanner_eof) {
+    // create new tuple buffer for row_batch
+    MemPool* tuple_pool = row_batch->tuple_data_pool();
+    int tuple_buffer_size = row_batch->capacity() * _tuple_desc->byte_size();
+    void* tuple_buffer = tuple_pool->allocate(tuple_buffer_size);
+    if (tuple_buffer == nullptr) {
+        return Status("Allocate memory for row batch failed.");
+    }
+
+    Tuple* tuple = reinterpret_cast<Tuple*>(tuple_buffer);
+    while (!*scanner_eof) {
+        RETURN_IF_CANCELLED(_runtime_state);
+        // If we have finished all works
+        if (_scan_finished.load()) {
+            return Status::OK;
+        }
+
+        // This row batch has been filled up, and break this
+        if (row_batch->is_full()) {
+            break;
+        }
+
+        int row_idx = row_batch->add_row();
+        TupleRow* row = row_batch->get_row(row_idx);
+        // scan node is the first tuple of tuple row
+        row->set_tuple(0, tuple);
+        memset(tuple, 0, _tuple_desc->num_null_bytes());
+
+        // Get from scanner
+        RETURN_IF_ERROR(scanner->get_next(tuple, tuple_pool, scanner_eof));
+        if (*scanner_eof) {
+            continue;
+        }
+
+        if (scan_range.params.__isset.partition_ids) {
+            int64_t partition_id = get_partition_id(partition_expr_ctxs, row);
+            if (partition_id == -1 || 
+                    !std::binary_search(scan_range.params.partition_ids.begin(), 
+                                       scan_range.params.partition_ids.end(), 
+                                       partition_id)) {
+                counter->num_rows_filtered++;
+
+                std::stringstream error_msg;
+                error_msg << "No corresponding partition, partition id: " << partition_id;
+                _runtime_state->append_error_msg_to_file(Tuple::to_string(tuple, *_tuple_desc), 
+                                                         error_msg.str());
+                continue;
+            }
+        }
+
+        // eval conjuncts of this row.
+        if (eval_conjuncts(&conjunct_ctxs[0], conjunct_ctxs.size(), row)) {
+            row_batch->commit_last_row();
+            char* new_tuple = reinterpret_cast<char*>(tuple);
+            new_tuple += _tuple_desc->byte_size();
+            tuple = reinterpret_cast<Tuple*>(new_tuple);
+            // counter->num_rows_returned++;
+        } else {
+            counter->num_rows_unselected++;
+        }
+    }
+    return Status::OK;
+}
+
+Status BrokerScanNode::scan_chunks(
+        const std::vector<ExprContext*>& conjunct_ctxs, 
+        const std::vector<ExprContext*>& partition_expr_ctxs,
+        BrokerScanCounter* counter) {
+    const TBrokerScanRange& scan_range = _scan_ranges[0].scan_range.broker_scan_range;
+    std::unique_ptr<BrokerScanner> scanner(new BrokerScanner(
+            _runtime_state, 
+            runtime_profile(),
+            scan_range.params, 
+            scan_range.ranges, 
+            scan_range.broker_addresses, 
+            counter));
+    RETURN_IF_ERROR(scanner->open());
+
+    std::string chunk;
+    std::vector<std::shared_ptr<RowBatch>> row_batches;
+    while (true) {
+        int64_t seq = 0;
+        RETURN_IF_ERROR(_chunk_splitter->next_chunk(&chunk, &seq));
+        // The empty chunk is the end of the body, its seq must still be
+        // passed for the scanners waiting after it.
+        row_batches.clear();
+        if (!chunk.empty()) {
+            scanner->open_chunk(reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size());
+            bool scanner_eof = false;
+            while (!scanner_eof) {
+                std::shared_ptr<RowBatch> row_batch(
+                    new RowBatch(row_desc(), _runtime_state->batch_size(), mem_tracker()));
+                RETURN_IF_ERROR(fill_batch(scanner.get(), scan_range, conjunct_ctxs,
+                                           partition_expr_ctxs, counter,
+                                           row_batch.get(), &scanner_eof));
+                if (_scan_finished.load()) {
+                    return Status::OK;
+                }
+                if (row_batch->num_rows() > 0) {
+                    row_batches.push_back(row_batch);
+                }
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> l(_batch_queue_lock);
+            // Rows of a tablet must be sent in the order of the body, so
+            // batches are queued by the order of chunks.
+            while (_process_status.ok() &&
+                   !_scan_finished.load() &&
+                   !_runtime_state->is_cancelled() &&
+                   _next_chunk_seq != seq) {
+                _queue_writer_cond.wait_for(l, std::chrono::seconds(1));
+            }
+            for (auto& row_batch : row_batches) {
+                while (_process_status.ok() && 
+                       !_scan_finished.load() && 
+                       !_runtime_state->is_cancelled() &&
+                       _batch_queue.size() >= _max_buffered_batches) {
+                    _queue_writer_cond.wait_for(l, std::chrono::seconds(1));
+                }
+                if (!_process_status.ok() || _scan_finished.load()) {
+                    return Status::OK;
+                }
+                if (_runtime_state->is_cancelled()) {
+                    return Status::CANCELLED;
+                }
+                _batch_queue.push_back(row_batch);
+                _queue_reader_cond.notify_one();
+            }
+            if (!_process_status.ok() || _scan_finished.load()) {
+                return Status::OK;
+            }
+            if (_runtime_state->is_cancelled()) {
+                return Status::CANCELLED;
+            }
+            _next_chunk_seq++;
+        }
+        // wake up the scanner of the next chunk
+        _queue_writer_cond.notify_all();
+        if (chunk.empty()) {
+            return Status::OK;
+        }
+    }
+}
+
 void BrokerScanNode::scanner_worker(int start_idx, int length) {
     // Clone expr context
     std::vector<ExprContext*> scanner_expr_ctxs;
@@ -429,6 +594,50 @@ void BrokerScanNode::scanner_worker(int start_idx, int length) {
     Expr::close(partition_expr_ctxs, _runtime_state);
 }
 
+void BrokerScanNode::chunk_scanner_worker() {
+    // Clone expr context
+    std::vector<ExprContext*> scanner_expr_ctxs;
+    auto status = Expr::clone_if_not_exists(_conjunct_ctxs, _runtime_state, &scanner_expr_ctxs);
+    if (!status.ok()) {
+        LOG(WARNING) << "Clone conjuncts failed.";
+    }
+    std::vector<ExprContext*> partition_expr_ctxs;
+    if (status.ok()) {
+        status = Expr::clone_if_not_exists(
+            _partition_expr_ctxs, _runtime_state, &partition_expr_ctxs);
+        if (!status.ok()) {
+            LOG(WARNING) << "Clone conjuncts failed.";
+        }
+    }
+    BrokerScanCounter counter;
+    if (status.ok()) {
+        status = scan_chunks(scanner_expr_ctxs, partition_expr_ctxs, &counter);
+        if (!status.ok()) {
+            LOG(WARNING) << "Chunk scanner prcess failed. status=" << status.get_error_msg();
+        }
+    }
+
+    // Update stats
+    _runtime_state->update_num_rows_load_total(counter.num_rows_total);
+    _runtime_state->update_num_rows_load_filtered(counter.num_rows_filtered);
+    _runtime_state->update_num_rows_load_unselected(counter.num_rows_unselected);
+
+    {
+        std::lock_guard<std::mutex> l(_batch_queue_lock);
+        if (!status.ok()) {
+            update_status(status);
+        }
+        _num_running_scanners--;
+    }
+    _queue_reader_cond.notify_all();
+    // scanners waiting for the chunk of this one must give up
+    if (!status.ok()) {
+        _queue_writer_cond.notify_all();
+    }
+    Expr::close(scanner_expr_ctxs, _runtime_state);
+    Expr::close(partition_expr_ctxs, _runtime_state);
+}
+
 int64_t BrokerScanNode::binary_find_partition_id(const PartRangeKey& key) const {
     int low = 0;
     int high = _partition_infos.size() - 1;
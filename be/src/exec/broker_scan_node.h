@@ -20,6 +20,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <mutex>
@@ -35,6 +36,9 @@ class RuntimeState;
 class PartRangeKey;
 class PartitionInfo;
 class BrokerScanCounter;
+class BaseScanner;
+class LineChunkSplitter;
+class StreamLoadPipe;
 
 class BrokerScanNode : public ScanNode {
 public:
@@ -94,6 +98,29 @@ private:
                         const std::vector<ExprContext*>& partition_expr_ctxs,
                         BrokerScanCounter* counter);
 
+    // Fill one row batch with rows got from scanner, it may not be full
+    // when the scanner reaches its end.
+    Status fill_batch(BaseScanner* scanner,
+                      const TBrokerScanRange& scan_range,
+                      const std::vector<ExprContext*>& conjunct_ctxs,
+                      const std::vector<ExprContext*>& partition_expr_ctxs,
+                      BrokerScanCounter* counter,
+                      RowBatch* row_batch,
+                      bool* scanner_eof);
+
+    // A stream load of one csv body may be parsed by several threads
+    bool can_scan_chunks() const;
+
+    Status start_chunk_scanners(int num_scanners);
+
+    // One scanner worker parsing chunks of the stream load body, batches of
+    // a chunk are queued after those of the chunks before it.
+    void chunk_scanner_worker();
+
+    Status scan_chunks(const std::vector<ExprContext*>& conjunct_ctxs,
+                       const std::vector<ExprContext*>& partition_expr_ctxs,
+                       BrokerScanCounter* counter);
+
     // Find partition id with PartRangeKey
     int64_t binary_find_partition_id(const PartRangeKey& key) const;
 
@@ -121,6 +148,12 @@ private:
 
     int _max_buffered_batches;
 
+    // Used when chunks of a stream load body are parsed by several scanners
+    std::shared_ptr<StreamLoadPipe> _stream_load_pipe;
+    std::unique_ptr<LineChunkSplitter> _chunk_splitter;
+    // seq of the chunk whose batches are to be queued next
+    int64_t _next_chunk_seq;
+
     // Partition informations
     std::vector<ExprContext*> _partition_expr_ctxs;
     std::vector<PartitionInfo*> _partition_infos;
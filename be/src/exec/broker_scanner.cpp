@@ -31,6 +31,9 @@
 #include "exec/text_converter.h"
 #include "exec/text_converter.hpp"
 #include "exec/plain_text_line_reader.h"
+#include "exec/line_chunk_splitter.h"
+#include "exec/json_line_parser.h"
+#include "exec/pipe_line_reader.h"
 #include "exec/local_file_reader.h"
 #include "exec/broker_reader.h"
 #include "exec/decompressor.h"
@@ -43,112 +46,35 @@ BrokerScanner::BrokerScanner(RuntimeState* state,
                              const std::vector<TBrokerRangeDesc>& ranges,
                              const std::vector<TNetworkAddress>& broker_addresses,
                              BrokerScanCounter* counter) : 
-        _state(state),
-        _profile(profile),
-        _params(params),
+        BaseScanner(state, profile, params, counter),
         _ranges(ranges),
         _broker_addresses(broker_addresses),
         // _splittable(params.splittable),
         _value_separator(static_cast<char>(params.column_separator)),
         _line_delimiter(static_cast<char>(params.line_delimiter)),
+        _enclose(params.__isset.enclose ? static_cast<char>(params.enclose) : 0),
+        _tokenizer(_value_separator, _line_delimiter, _enclose),
+        _is_json(false),
         _cur_file_reader(nullptr),
         _cur_line_reader(nullptr),
         _cur_decompressor(nullptr),
         _next_range(0),
         _cur_line_reader_eof(false),
         _scanner_eof(false),
-        _skip_next_line(false),
-        _src_tuple(nullptr),
-        _src_tuple_row(nullptr),
-#if BE_TEST
-        _mem_tracker(new MemTracker()),
-        _mem_pool(_mem_tracker.get()),
-#else 
-        _mem_tracker(new MemTracker(-1, "Broker Scanner", state->instance_mem_tracker())),
-        _mem_pool(_state->instance_mem_tracker()),
-#endif
-        _dest_tuple_desc(nullptr),
-        _counter(counter),
-        _rows_read_counter(nullptr),
-        _read_timer(nullptr),
-        _materialize_timer(nullptr) {
+        _skip_next_line(false) {
 }
 
 BrokerScanner::~BrokerScanner() {
     close();
 }
 
-Status BrokerScanner::init_expr_ctxes() {
-    // Constcut _src_slot_descs
-    const TupleDescriptor* src_tuple_desc = 
-        _state->desc_tbl().get_tuple_descriptor(_params.src_tuple_id);
-    if (src_tuple_desc == nullptr) {
-        std::stringstream ss;
-        ss << "Unknown source tuple descriptor, tuple_id=" << _params.src_tuple_id;
-        return Status(ss.str());
-    }
-
-    std::map<SlotId, SlotDescriptor*> src_slot_desc_map;
-    for (auto slot_desc : src_tuple_desc->slots()) {
-        src_slot_desc_map.emplace(slot_desc->id(), slot_desc);
-    }
-    for (auto slot_id : _params.src_slot_ids) {
-        auto it = src_slot_desc_map.find(slot_id);
-        if (it == std::end(src_slot_desc_map)) {
-            std::stringstream ss;
-            ss << "Unknown source slot descriptor, slot_id=" << slot_id;
-            return Status(ss.str());
-        }
-        _src_slot_descs.emplace_back(it->second);
-    }
-    // Construct source tuple and tuple row
-    _src_tuple = (Tuple*) _mem_pool.allocate(src_tuple_desc->byte_size());
-    _src_tuple_row = (TupleRow*) _mem_pool.allocate(sizeof(Tuple*));
-    _src_tuple_row->set_tuple(0, _src_tuple);
-    _row_desc.reset(new RowDescriptor(_state->desc_tbl(), 
-                                      std::vector<TupleId>({_params.src_tuple_id}), 
-                                      std::vector<bool>({false})));
-
-    // Construct dest slots information
-    _dest_tuple_desc = _state->desc_tbl().get_tuple_descriptor(_params.dest_tuple_id);
-    if (_dest_tuple_desc == nullptr) {
-        std::stringstream ss;
-        ss << "Unknown dest tuple descriptor, tuple_id=" << _params.dest_tuple_id;
-        return Status(ss.str());
-    }
-
-    for (auto slot_desc : _dest_tuple_desc->slots()) {
-        if (!slot_desc->is_materialized()) {
-            continue;
-        }
-        auto it = _params.expr_of_dest_slot.find(slot_desc->id());
-        if (it == std::end(_params.expr_of_dest_slot)) {
-            std::stringstream ss;
-            ss << "No expr for dest slot, id=" << slot_desc->id() 
-                << ", name=" << slot_desc->col_name();
-            return Status(ss.str());
-        }
-        ExprContext* ctx = nullptr;
-        RETURN_IF_ERROR(Expr::create_expr_tree(_state->obj_pool(), it->second, &ctx));
-        RETURN_IF_ERROR(ctx->prepare(_state, *_row_desc.get(), _mem_tracker.get()));
-        RETURN_IF_ERROR(ctx->open(_state));
-        _dest_expr_ctx.emplace_back(ctx);
-    }
-
-    return Status::OK;
-}
-
 Status BrokerScanner::open() {
-    RETURN_IF_ERROR(init_expr_ctxes());
+    RETURN_IF_ERROR(BaseScanner::open());
     _text_converter.reset(new(std::nothrow) TextConverter('\\'));
     if (_text_converter == nullptr) {
         return Status("No memory error.");
     }
 
-    _rows_read_counter = ADD_COUNTER(_profile, "RowsRead", TUnit::UNIT);
-    _read_timer = ADD_TIMER(_profile, "TotalRawReadTime(*)");
-    _materialize_timer = ADD_TIMER(_profile, "MaterializeTupleTime(*)");
-
     return Status::OK;
 }
 
@@ -192,6 +118,19 @@ Status BrokerScanner::get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof) {
     return Status::OK;
 }
 
+void BrokerScanner::open_chunk(const uint8_t* data, size_t size) {
+    if (_cur_line_reader != nullptr) {
+        delete _cur_line_reader;
+    }
+    _cur_line_reader = new ChunkLineReader(data, size, _line_delimiter);
+    _is_json = _ranges[0].format_type == TFileFormatType::FORMAT_JSON;
+    _cur_line_reader_eof = false;
+    _skip_next_line = false;
+    // no range is read after the chunk
+    _next_range = _ranges.size();
+    _scanner_eof = false;
+}
+
 Status BrokerScanner::open_next_reader() {
     if (_next_range >= _ranges.size()) {
         _scanner_eof = true;
@@ -262,6 +201,7 @@ Status BrokerScanner::create_decompressor(TFileFormatType::type type) {
     CompressType compress_type;
     switch (type) {
     case TFileFormatType::FORMAT_CSV_PLAIN:
+    case TFileFormatType::FORMAT_JSON:
         compress_type = CompressType::UNCOMPRESSED;
         break;
     case TFileFormatType::FORMAT_CSV_GZ:
@@ -302,7 +242,8 @@ Status BrokerScanner::open_line_reader() {
     const TBrokerRangeDesc& range = _ranges[_next_range];
     int64_t size = range.size;
     if (range.start_offset != 0) {
-        if (range.format_type != TFileFormatType::FORMAT_CSV_PLAIN) {
+        if (range.format_type != TFileFormatType::FORMAT_CSV_PLAIN
+                && range.format_type != TFileFormatType::FORMAT_JSON) {
             std::stringstream ss;
             ss << "For now we do not support split compressed file";
             return Status(ss.str());
@@ -317,6 +258,11 @@ Status BrokerScanner::open_line_reader() {
     // _decompressor may be NULL if this is not a compressed file
     RETURN_IF_ERROR(create_decompressor(range.format_type));
 
+    // lines of an uncompressed stream load are read in place from the
+    // buffers of its pipe
+    bool read_pipe = _stream_load_pipe != nullptr
+        && _cur_decompressor == nullptr && !_skip_next_line;
+
     // open line reader
     switch (range.format_type) {
     case TFileFormatType::FORMAT_CSV_PLAIN:
@@ -324,6 +270,23 @@ Status BrokerScanner::open_line_reader() {
     case TFileFormatType::FORMAT_CSV_BZ2:
     case TFileFormatType::FORMAT_CSV_LZ4FRAME:
     case TFileFormatType::FORMAT_CSV_LZOP:
+        if (read_pipe) {
+            _cur_line_reader = new PipeLineReader(
+                    _profile, _stream_load_pipe.get(), _line_delimiter, _enclose);
+            break;
+        }
+        _cur_line_reader = new PlainTextLineReader(
+                _profile,
+                _cur_file_reader, _cur_decompressor,
+                size, _line_delimiter, _enclose);
+        break;
+    case TFileFormatType::FORMAT_JSON:
+        // json strings have no raw line delimiters, lines are found as csv
+        if (read_pipe) {
+            _cur_line_reader = new PipeLineReader(
+                    _profile, _stream_load_pipe.get(), _line_delimiter);
+            break;
+        }
         _cur_line_reader = new PlainTextLineReader(
                 _profile,
                 _cur_file_reader, _cur_decompressor,
@@ -337,6 +300,7 @@ Status BrokerScanner::open_line_reader() {
     }
 
     _cur_line_reader_eof = false;
+    _is_json = range.format_type == TFileFormatType::FORMAT_JSON;
 
     return Status::OK;
 }
@@ -361,21 +325,12 @@ void BrokerScanner::close() {
             _cur_file_reader = nullptr;
         }
     }
-    Expr::close(_dest_expr_ctx, _state);
+    BaseScanner::close();
 }
 
 void BrokerScanner::split_line(
         const Slice& line, std::vector<Slice>* values) {
-    // line-begin char and line-end char are considered to be 'delimeter'
-    const char* value = line.data;
-    const char* ptr = line.data;
-    for (size_t i = 0; i < line.size; ++i, ++ptr) {
-        if (*ptr == _value_separator) {
-            values->emplace_back(value, ptr - value);
-            value = ptr + 1;
-        }
-    }
-    values->emplace_back(value, ptr - value);
+    _tokenizer.split_line(line, values);
 }
 
 void BrokerScanner::fill_fix_length_string(
@@ -528,7 +483,11 @@ bool BrokerScanner::write_slot(
 bool BrokerScanner::convert_one_row(
         const Slice& line,
         Tuple* tuple, MemPool* tuple_pool) {
-    if (!line_to_src_tuple(line)) {
+    if (_is_json) {
+        if (!json_to_src_tuple(line)) {
+            return false;
+        }
+    } else if (!line_to_src_tuple(line)) {
         return false;
     }
     return fill_dest_tuple(line, tuple, tuple_pool);
@@ -578,31 +537,55 @@ bool BrokerScanner::line_to_src_tuple(const Slice& line) {
     return true;
 }
 
-bool BrokerScanner::fill_dest_tuple(const Slice& line, Tuple* dest_tuple, MemPool* mem_pool) {
-    int ctx_idx = 0;
-    for (auto slot_desc : _dest_tuple_desc->slots()) {
-        if (!slot_desc->is_materialized()) {
-            continue;
+bool BrokerScanner::json_to_src_tuple(const Slice& line) {
+    if (_json_parser == nullptr) {
+        std::vector<std::string> paths;
+        if (_params.__isset.json_paths) {
+            paths = _params.json_paths;
+        } else {
+            for (auto slot_desc : _src_slot_descs) {
+                paths.push_back(slot_desc->col_name());
+            }
         }
+        if (paths.size() != _src_slot_descs.size()) {
+            std::stringstream error_msg;
+            error_msg << "json paths number is not equal to schema column number. "
+                << "json paths number: " << paths.size() << ", "
+                << "schema number: " << _src_slot_descs.size() << "; ";
+            _state->append_error_msg_to_file(std::string(line.data, line.size),
+                                             error_msg.str());
+            _counter->num_rows_filtered++;
+            return false;
+        }
+        _json_parser.reset(new JsonLineParser(paths));
+    }
 
-        ExprContext* ctx = _dest_expr_ctx[ctx_idx++];
-        void* value = ctx->get_value(_src_tuple_row);
-        if (value == nullptr) {
-            if (slot_desc->is_nullable()) {
-                dest_tuple->set_null(slot_desc->null_indicator_offset());
-                continue;
-            } else {
+    std::string error;
+    if (!_json_parser->parse(line, &_json_values, &_json_nulls, &error)) {
+        _state->append_error_msg_to_file(std::string(line.data, line.size), error);
+        _counter->num_rows_filtered++;
+        return false;
+    }
+    for (int i = 0; i < _src_slot_descs.size(); ++i) {
+        auto slot_desc = _src_slot_descs[i];
+        if (_json_nulls[i]) {
+            if (!slot_desc->is_nullable()) {
                 std::stringstream error_msg;
                 error_msg << "column(" << slot_desc->col_name() << ") value is null";
-                _state->append_error_msg_to_file(
-                    std::string(line.data, line.size), error_msg.str());
+                _state->append_error_msg_to_file(std::string(line.data, line.size),
+                                                 error_msg.str());
                 _counter->num_rows_filtered++;
                 return false;
             }
+            _src_tuple->set_null(slot_desc->null_indicator_offset());
+            continue;
         }
-        dest_tuple->set_not_null(slot_desc->null_indicator_offset());
-        void* slot = dest_tuple->get_slot(slot_desc->tuple_offset());
-        RawValue::write(value, slot, slot_desc->type(), mem_pool);
+        const Slice& value = _json_values[i];
+        _src_tuple->set_not_null(slot_desc->null_indicator_offset());
+        void* slot = _src_tuple->get_slot(slot_desc->tuple_offset());
+        StringValue* str_slot = reinterpret_cast<StringValue*>(slot);
+        str_slot->ptr = value.data;
+        str_slot->len = value.size;
     }
     return true;
 }
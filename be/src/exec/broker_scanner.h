@@ -24,6 +24,8 @@
 #include <sstream>
 
 #include "common/status.h"
+#include "exec/base_scanner.h"
+#include "exec/csv_tokenizer.h"
 #include "gen_cpp/PlanNodes_types.h"
 #include "gen_cpp/Types_types.h"
 #include "runtime/mem_pool.h"
@@ -47,23 +49,10 @@ class RowDescriptor;
 class MemTracker;
 class RuntimeProfile;
 class StreamLoadPipe;
-
-struct BrokerScanCounter {
-    BrokerScanCounter() :
-        num_rows_total(0),
-        // num_rows_returned(0),
-        num_rows_filtered(0),
-        num_rows_unselected(0) {
-    }
-    
-    int64_t num_rows_total; // total read rows (read from source)
-    // int64_t num_rows_returned;  // qualified rows (match the dest schema)
-    int64_t num_rows_filtered;  // unqualified rows (unmatch the dest schema, or no partition)
-    int64_t num_rows_unselected; // rows filterd by predicates
-};
+class JsonLineParser;
 
 // Broker scanner convert the data read from broker to doris's tuple.
-class BrokerScanner {
+class BrokerScanner : public BaseScanner {
 public:
     BrokerScanner(
         RuntimeState* state,
@@ -75,13 +64,17 @@ public:
     ~BrokerScanner();
 
     // Open this scanner, will initialize informtion need to 
-    Status open();
+    Status open() override;
 
     // Get next tuple 
-    Status get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof);
+    Status get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof) override;
+
+    // Reads lines of 'data' instead of the ranges, they are got by get_next
+    // until it returns eof. 'data' must be valid until then.
+    void open_chunk(const uint8_t* data, size_t size);
 
     // Close this scanner
-    void close();
+    void close() override;
 
 private:
     Status open_file_reader();
@@ -114,15 +107,11 @@ private:
     //  output is tuple
     bool convert_one_row(const Slice& line, Tuple* tuple, MemPool* tuple_pool);
 
-    Status init_expr_ctxes();
-
     Status line_to_src_tuple();
     bool line_to_src_tuple(const Slice& line);
-    bool fill_dest_tuple(const Slice& line, Tuple* dest_tuple, MemPool* mem_pool);
+    // 'line' is a json object
+    bool json_to_src_tuple(const Slice& line);
 private:
-    RuntimeState* _state;
-    RuntimeProfile* _profile;
-    const TBrokerScanRangeParams& _params;
     const std::vector<TBrokerRangeDesc>& _ranges;
     const std::vector<TNetworkAddress>& _broker_addresses;
 
@@ -130,6 +119,15 @@ private:
 
     char _value_separator;
     char _line_delimiter;
+    // 0 if fields are not quoted
+    char _enclose;
+    CsvTokenizer _tokenizer;
+
+    // lines are json objects if current range is FORMAT_JSON
+    bool _is_json;
+    std::unique_ptr<JsonLineParser> _json_parser;
+    std::vector<Slice> _json_values;
+    std::vector<uint8_t> _json_nulls;
 
     // Reader
     FileReader* _cur_file_reader;
@@ -144,31 +142,8 @@ private:
     // we will read to one ahead, and skip the first line
     bool _skip_next_line;
 
-    // Used for constructing tuple
-    // slots for value read from broker file
-    std::vector<SlotDescriptor*> _src_slot_descs;
-    std::unique_ptr<RowDescriptor> _row_desc;
-    Tuple* _src_tuple;
-    TupleRow* _src_tuple_row;
-
-    std::unique_ptr<MemTracker> _mem_tracker;
-    // Mem pool used to allocate _src_tuple and _src_tuple_row
-    MemPool _mem_pool;
-
-    // Dest tuple descriptor and dest expr context
-    const TupleDescriptor* _dest_tuple_desc;
-    std::vector<ExprContext*> _dest_expr_ctx;
-
     // used to hold current StreamLoadPipe
     std::shared_ptr<StreamLoadPipe> _stream_load_pipe;
-
-    // used for process stat
-    BrokerScanCounter* _counter;
-
-    // Profile
-    RuntimeProfile::Counter* _rows_read_counter;
-    RuntimeProfile::Counter* _read_timer;
-    RuntimeProfile::Counter* _materialize_timer;
 };
 
 }
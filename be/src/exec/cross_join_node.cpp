@@ -19,24 +19,65 @@
 
 #include <sstream>
 
+#include "common/config.h"
 #include "exprs/expr.h"
+#include "exprs/expr_context.h"
 #include "gen_cpp/PlanNodes_types.h"
+#include "runtime/exec_env.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
+#include "util/count_down_latch.hpp"
 #include "util/debug_util.h"
+#include "util/fair_share_thread_pool.h"
 #include "util/runtime_profile.h"
 
 namespace doris {
 
 CrossJoinNode::CrossJoinNode(
     ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs)
-    : BlockingJoinNode("CrossJoinNode", TJoinOp::CROSS_JOIN, pool, tnode, descs) {
+    : BlockingJoinNode("CrossJoinNode", TJoinOp::CROSS_JOIN, pool, tnode, descs),
+      _current_build_row(0),
+      _probe_group(0),
+      _left_batch_in_parallel(false),
+      _left_batch_probed(false),
+      _match_task(0),
+      _match_pos(0),
+      _tile_eval_timer(NULL),
+      _parallel_probe_counter(NULL) {
 }
 
 Status CrossJoinNode::prepare(RuntimeState* state) {
     DCHECK(_join_op == TJoinOp::CROSS_JOIN);
     RETURN_IF_ERROR(BlockingJoinNode::prepare(state));
     _build_batch_pool.reset(new ObjectPool());
+    _tile_eval_timer = ADD_TIMER(runtime_profile(), "TileEvalTime");
+    _parallel_probe_counter = ADD_COUNTER(runtime_profile(), "ParallelProbedBatches",
+                                          TUnit::UNIT);
+    _probe_group = (state->query_id().hi ^ state->query_id().lo) + id();
+    return Status::OK;
+}
+
+Status CrossJoinNode::open(RuntimeState* state) {
+    RETURN_IF_ERROR(BlockingJoinNode::open(state));
+    SCOPED_TIMER(_runtime_profile->total_time_counter());
+
+    // without conjuncts the rows are only copied, which is not worth threads
+    int num_tasks = 1;
+    if (!_conjunct_ctxs.empty() && config::cross_join_probe_threads > 1) {
+        num_tasks = config::cross_join_probe_threads;
+    }
+    for (int i = 0; i < num_tasks; ++i) {
+        std::unique_ptr<ProbeTask> task(new ProbeTask());
+        if (i == 0) {
+            task->conjunct_ctxs = _conjunct_ctxs;
+        } else {
+            RETURN_IF_ERROR(Expr::clone_if_not_exists(
+                    _conjunct_ctxs, state, &task->conjunct_ctxs));
+        }
+        task->tile.reset(new RowBatch(row_desc(), state->batch_size(), mem_tracker()));
+        _probe_tasks.push_back(std::move(task));
+    }
+    _left_batch_in_parallel = probe_in_parallel(_left_batch.get());
     return Status::OK;
 }
 
@@ -45,6 +86,11 @@ Status CrossJoinNode::close(RuntimeState* state) {
     if (is_closed()) {
         return Status::OK;
     }
+    for (size_t i = 1; i < _probe_tasks.size(); ++i) {
+        Expr::close(_probe_tasks[i]->conjunct_ctxs, state);
+    }
+    _probe_tasks.clear();
+    _build_rows.clear();
     _build_batches.reset();
     _build_batch_pool.reset();
     BlockingJoinNode::close(state);
@@ -79,11 +125,16 @@ Status CrossJoinNode::construct_build_side(RuntimeState* state) {
         }
     }
 
+    SCOPED_TIMER(_build_timer);
+    _build_rows.reserve(_build_batches.total_num_rows());
+    for (RowBatchList::TupleRowIterator it = _build_batches.iterator(); !it.at_end(); it.next()) {
+        _build_rows.push_back(it.get_row());
+    }
     return Status::OK;
 }
 
 void CrossJoinNode::init_get_next(TupleRow* first_left_row) {
-    _current_build_row = _build_batches.iterator();
+    _current_build_row = 0;
 }
 
 Status CrossJoinNode::get_next(RuntimeState* state, RowBatch* output_batch, bool* eos) {
@@ -110,8 +161,21 @@ Status CrossJoinNode::get_next(RuntimeState* state, RowBatch* output_batch, bool
         }
 
         // Continue processing this row batch
-        _num_rows_returned +=
-            process_left_child_batch(output_batch, _left_batch.get(), max_added_rows);
+        int rows_added = 0;
+        if (_left_batch_in_parallel) {
+            if (!_left_batch_probed) {
+                RETURN_IF_ERROR(probe_left_batch_in_parallel(state, _left_batch.get()));
+                _left_batch_probed = true;
+            }
+            if (add_matches(output_batch, _left_batch.get(), max_added_rows, &rows_added)) {
+                _left_batch_pos = _left_batch->num_rows();
+                _current_build_row = _build_rows.size();
+            }
+        } else {
+            RETURN_IF_ERROR(process_left_child_batch(
+                    output_batch, _left_batch.get(), max_added_rows, &rows_added));
+        }
+        _num_rows_returned += rows_added;
         COUNTER_SET(_rows_returned_counter, _num_rows_returned);
 
         if (reached_limit() || output_batch->is_full()) {
@@ -120,7 +184,8 @@ Status CrossJoinNode::get_next(RuntimeState* state, RowBatch* output_batch, bool
         }
 
         // Check to see if we're done processing the current left child batch
-        if (_current_build_row.at_end() && _left_batch_pos == _left_batch->num_rows()) {
+        if (_current_build_row == _build_rows.size()
+                && _left_batch_pos == _left_batch->num_rows()) {
             _left_batch->transfer_resource_ownership(output_batch);
             _left_batch_pos = 0;
 
@@ -136,6 +201,8 @@ Status CrossJoinNode::get_next(RuntimeState* state, RowBatch* output_batch, bool
                 RETURN_IF_ERROR(child(0)->get_next(state, _left_batch.get(), &_left_side_eos));
                 timer.start();
                 COUNTER_UPDATE(_left_child_row_counter, _left_batch->num_rows());
+                _left_batch_in_parallel = probe_in_parallel(_left_batch.get());
+                _left_batch_probed = false;
             }
         }
     }
@@ -151,53 +218,199 @@ std::string CrossJoinNode::build_list_debug_string() {
     return out.str();
 }
 
-// TODO: this can be replaced with a codegen'd function
-int CrossJoinNode::process_left_child_batch(RowBatch* output_batch, RowBatch* batch,
-        int max_added_rows) {
+Status CrossJoinNode::eval_tile(ProbeTask* task, RowBatch* batch, int* num_selected) {
+    int n = task->candidates.size();
+    task->sel.resize(n);
+    int* sel = task->sel.data();
+    for (int i = 0; i < n; ++i) {
+        sel[i] = i;
+    }
+    if (task->conjunct_ctxs.empty()) {
+        *num_selected = n;
+        return Status::OK;
+    }
+
+    SCOPED_TIMER(_tile_eval_timer);
+    RowBatch* tile = task->tile.get();
+    tile->reset();
+    int row_idx = tile->add_rows(n);
+    DCHECK_EQ(row_idx, 0);
+    for (int i = 0; i < n; ++i) {
+        const std::pair<int, TupleRow*>& candidate = task->candidates[i];
+        create_output_row(tile->get_row(i), batch->get_row(candidate.first), candidate.second);
+    }
+    tile->commit_rows(n);
+
+    for (ExprContext* ctx : task->conjunct_ctxs) {
+        RETURN_IF_ERROR(ctx->evaluate(tile, sel, n, &task->column));
+        const bool* values = task->column.values<bool>();
+        const uint8_t* nulls = task->column.nulls();
+        int num_passed = 0;
+        for (int k = 0; k < n; ++k) {
+            int i = sel[k];
+            sel[num_passed] = i;
+            num_passed += !nulls[i] & values[i];
+        }
+        n = num_passed;
+        if (n == 0) {
+            break;
+        }
+    }
+    ExprContext::free_local_allocations(task->conjunct_ctxs);
+    *num_selected = n;
+    return Status::OK;
+}
+
+Status CrossJoinNode::process_left_child_batch(RowBatch* output_batch, RowBatch* batch,
+        int max_added_rows, int* rows_added) {
     int row_idx = output_batch->add_rows(max_added_rows);
     DCHECK(row_idx != RowBatch::INVALID_ROW_INDEX);
     uint8_t* output_row_mem = reinterpret_cast<uint8_t*>(output_batch->get_row(row_idx));
-    TupleRow* output_row = reinterpret_cast<TupleRow*>(output_row_mem);
 
+    ProbeTask* task = _probe_tasks[0].get();
     int rows_returned = 0;
-    ExprContext* const* ctxs = &_conjunct_ctxs[0];
-    int ctx_size = _conjunct_ctxs.size();
-
-    while (true) {
-        while (!_current_build_row.at_end()) {
-            create_output_row(output_row, _current_left_child_row, _current_build_row.get_row());
-            _current_build_row.next();
-
-            if (!eval_conjuncts(ctxs, ctx_size, output_row)) {
+    while (rows_returned < max_added_rows) {
+        // no more candidates than free rows, which all may pass
+        size_t max_candidates = std::min(task->tile->capacity(), max_added_rows - rows_returned);
+        task->candidates.clear();
+        while (task->candidates.size() < max_candidates) {
+            if (_current_build_row == _build_rows.size()) {
+                // Advance to the next row in the left child batch
+                if (_left_batch_pos == batch->num_rows()) {
+                    break;
+                }
+                _current_left_child_row = batch->get_row(_left_batch_pos++);
+                _current_build_row = 0;
                 continue;
             }
+            task->candidates.emplace_back(_left_batch_pos - 1, _build_rows[_current_build_row++]);
+        }
+        if (task->candidates.empty()) {
+            break;
+        }
+
+        int num_selected = 0;
+        Status status = eval_tile(task, batch, &num_selected);
+        if (!status.ok()) {
+            output_batch->commit_rows(rows_returned);
+            return status;
+        }
+        for (int k = 0; k < num_selected; ++k) {
+            const std::pair<int, TupleRow*>& candidate = task->candidates[task->sel[k]];
+            create_output_row(reinterpret_cast<TupleRow*>(output_row_mem),
+                              batch->get_row(candidate.first), candidate.second);
+            output_row_mem += output_batch->row_byte_size();
+        }
+        rows_returned += num_selected;
+    }
+
+    output_batch->commit_rows(rows_returned);
+    *rows_added = rows_returned;
+    return Status::OK;
+}
 
-            ++rows_returned;
+bool CrossJoinNode::probe_in_parallel(RowBatch* batch) const {
+    return _probe_tasks.size() > 1 && batch->num_rows() > 0
+        && static_cast<int64_t>(batch->num_rows()) * static_cast<int64_t>(_build_rows.size())
+            >= config::cross_join_parallel_probe_min_pairs;
+}
 
-            // Filled up out batch or hit limit
-            if (UNLIKELY(rows_returned == max_added_rows)) {
-                output_batch->commit_rows(rows_returned);
-                return rows_returned;
+void CrossJoinNode::probe_left_rows(RuntimeState* state, ProbeTask* task, RowBatch* batch,
+                                    int begin, int end) {
+    size_t tile_capacity = task->tile->capacity();
+    auto eval_candidates = [this, task, batch]() {
+        int num_selected = 0;
+        task->status = eval_tile(task, batch, &num_selected);
+        for (int k = 0; k < num_selected; ++k) {
+            task->matches.push_back(task->candidates[task->sel[k]]);
+        }
+        task->candidates.clear();
+        return task->status.ok();
+    };
+
+    task->candidates.clear();
+    for (int left = begin; left < end; ++left) {
+        if (state->is_cancelled()) {
+            task->status = Status::CANCELLED;
+            return;
+        }
+        for (TupleRow* build_row : _build_rows) {
+            task->candidates.emplace_back(left, build_row);
+            if (task->candidates.size() == tile_capacity && !eval_candidates()) {
+                return;
             }
+        }
+    }
+    if (!task->candidates.empty()) {
+        eval_candidates();
+    }
+}
 
-            // Advance to next out row
-            output_row_mem += output_batch->row_byte_size();
-            output_row = reinterpret_cast<TupleRow*>(output_row_mem);
+Status CrossJoinNode::probe_left_batch_in_parallel(RuntimeState* state, RowBatch* batch) {
+    COUNTER_UPDATE(_parallel_probe_counter, 1);
+    for (auto& task : _probe_tasks) {
+        task->matches.clear();
+        task->status = Status::OK;
+    }
+    _match_task = 0;
+    _match_pos = 0;
+
+    int num_rows = batch->num_rows();
+    int rows_per_task = (num_rows + _probe_tasks.size() - 1) / _probe_tasks.size();
+    int num_tasks = (num_rows + rows_per_task - 1) / rows_per_task;
+
+    // the first task runs in this thread
+    FairShareThreadPool* thread_pool = state->exec_env()->thread_pool();
+    CountDownLatch latch(num_tasks - 1);
+    for (int i = 1; i < num_tasks; ++i) {
+        ProbeTask* task = _probe_tasks[i].get();
+        int begin = i * rows_per_task;
+        int end = std::min(num_rows, begin + rows_per_task);
+        auto work = [this, state, task, batch, begin, end, &latch]() {
+            probe_left_rows(state, task, batch, begin, end);
+            latch.count_down();
+        };
+        if (!thread_pool->offer(_probe_group, 1, work)) {
+            work();
         }
+    }
+    probe_left_rows(state, _probe_tasks[0].get(), batch, 0, std::min(num_rows, rows_per_task));
+    latch.await();
 
-        DCHECK(_current_build_row.at_end());
+    for (auto& task : _probe_tasks) {
+        RETURN_IF_ERROR(task->status);
+    }
+    return Status::OK;
+}
 
-        // Advance to the next row in the left child batch
-        if (UNLIKELY(_left_batch_pos == batch->num_rows())) {
-            output_batch->commit_rows(rows_returned);
-            return rows_returned;
-        }
+bool CrossJoinNode::add_matches(RowBatch* output_batch, RowBatch* batch, int max_added_rows,
+                                int* rows_added) {
+    int row_idx = output_batch->add_rows(max_added_rows);
+    DCHECK(row_idx != RowBatch::INVALID_ROW_INDEX);
+    uint8_t* output_row_mem = reinterpret_cast<uint8_t*>(output_batch->get_row(row_idx));
 
-        _current_left_child_row = batch->get_row(_left_batch_pos++);
-        _current_build_row = _build_batches.iterator();
+    int rows_returned = 0;
+    while (_match_task < _probe_tasks.size()) {
+        const std::vector<std::pair<int, TupleRow*>>& matches =
+            _probe_tasks[_match_task]->matches;
+        if (_match_pos == matches.size()) {
+            ++_match_task;
+            _match_pos = 0;
+            continue;
+        }
+        if (rows_returned == max_added_rows) {
+            break;
+        }
+        const std::pair<int, TupleRow*>& match = matches[_match_pos++];
+        create_output_row(reinterpret_cast<TupleRow*>(output_row_mem),
+                          batch->get_row(match.first), match.second);
+        output_row_mem += output_batch->row_byte_size();
+        ++rows_returned;
     }
 
     output_batch->commit_rows(rows_returned);
-    return rows_returned;
+    *rows_added = rows_returned;
+    return _match_task == _probe_tasks.size();
 }
+
 }
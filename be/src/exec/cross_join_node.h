@@ -21,17 +21,22 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/thread.hpp>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "exec/exec_node.h"
 #include "exec/blocking_join_node.h"
 #include "exec/row_batch_list.h"
+#include "exprs/expr_column.h"
 #include "runtime/descriptors.h"
 #include "runtime/mem_pool.h"
 #include "gen_cpp/PlanNodes_types.h"
 
 namespace doris {
 
+class ExprContext;
 class RowBatch;
 class TupleRow;
 
@@ -41,11 +46,17 @@ class TupleRow;
 // build batches are kept in a list that is fully constructed from the right child in
 // construct_build_side() (called by BlockingJoinNode::open()) while rows are fetched from
 // the left child as necessary in get_next().
+//
+// The combinations are written to a tile batch and the conjuncts are evaluated
+// over the tile a conjunct at a time, narrowing a selection of the rows. If the
+// rows of a left batch times the build rows are many, the left rows are split among
+// threads of the exec env, which collect their matches before they are returned.
 class CrossJoinNode : public BlockingJoinNode {
 public:
     CrossJoinNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
 
     virtual Status prepare(RuntimeState* state);
+    virtual Status open(RuntimeState* state);
     virtual Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
     virtual Status close(RuntimeState* state);
 
@@ -54,19 +65,71 @@ protected:
     virtual Status construct_build_side(RuntimeState* state);
 
 private:
+    // What evaluates the conjuncts over tiles in one thread.
+    struct ProbeTask {
+        // the conjuncts of the node for the first task, clones for the others
+        std::vector<ExprContext*> conjunct_ctxs;
+        // the combined rows evaluated at a time
+        std::unique_ptr<RowBatch> tile;
+        // left row index in the left batch and build row of the rows of the tile
+        std::vector<std::pair<int, TupleRow*>> candidates;
+        std::vector<int> sel;
+        ExprColumn column;
+        // candidates passing the conjuncts, for parallel probes
+        std::vector<std::pair<int, TupleRow*>> matches;
+        Status status;
+    };
+
     // Object pool for build RowBatches, stores all BuildBatches in _build_rows
     boost::scoped_ptr<ObjectPool> _build_batch_pool;
     // List of build batches, constructed in prepare()
     RowBatchList _build_batches;
-    RowBatchList::TupleRowIterator _current_build_row;
+    // the rows of _build_batches, join against the current left row from
+    // _current_build_row on
+    std::vector<TupleRow*> _build_rows;
+    size_t _current_build_row;
+
+    std::vector<std::unique_ptr<ProbeTask>> _probe_tasks;
+    // group of the probe tasks in the thread pool
+    uint64_t _probe_group;
+    // matches of the current left batch in the order of the tasks, if it was
+    // probed in parallel, of which those before _match_pos have been returned
+    bool _left_batch_in_parallel;
+    bool _left_batch_probed;
+    size_t _match_task;
+    size_t _match_pos;
+
+    RuntimeProfile::Counter* _tile_eval_timer;
+    RuntimeProfile::Counter* _parallel_probe_counter;
 
     // Processes a batch from the left child.
     //  output_batch: the batch for resulting tuple rows
     //  batch: the batch from the left child to process.  This function can be called to
     //    continue processing a batch in the middle
     //  max_added_rows: maximum rows that can be added to output_batch
-    // return the number of rows added to output_batch
-    int process_left_child_batch(RowBatch* output_batch, RowBatch* batch, int max_added_rows);
+    //  rows_added: the number of rows added to output_batch
+    Status process_left_child_batch(RowBatch* output_batch, RowBatch* batch,
+                                    int max_added_rows, int* rows_added);
+
+    // Returns true if the rows of 'batch' are joined on the probe tasks.
+    bool probe_in_parallel(RowBatch* batch) const;
+
+    // Joins all rows of 'batch' on the probe tasks and keeps their matches.
+    Status probe_left_batch_in_parallel(RuntimeState* state, RowBatch* batch);
+
+    // Adds up to 'max_added_rows' of the kept matches to 'output_batch'. Returns true
+    // if all matches have been added.
+    bool add_matches(RowBatch* output_batch, RowBatch* batch, int max_added_rows,
+                     int* rows_added);
+
+    // Joins rows [begin, end) of 'batch' with all build rows, appending the
+    // matches to those of 'task'.
+    void probe_left_rows(RuntimeState* state, ProbeTask* task, RowBatch* batch,
+                         int begin, int end);
+
+    // Evaluates the conjuncts of 'task' over its candidates, whose left rows are in
+    // 'batch', and leaves the indexes of the passing ones in task->sel[0, *num_selected).
+    Status eval_tile(ProbeTask* task, RowBatch* batch, int* num_selected);
 
     // Returns a debug string for _build_rows. This is used for debugging during the
     // build list construction and before doing the join.
@@ -0,0 +1,183 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/csv_tokenizer.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "util/cpu_info.h"
+#include "util/sse_util.hpp"
+
+namespace doris {
+
+static const size_t BLOCK_SIZE = 64;
+static const size_t SEARCH_SIZE = 16 * BLOCK_SIZE;
+
+static void find_chars_sse2(const char* data, size_t num_blocks, char c1, char c2,
+                            uint64_t* masks) {
+    const __m128i v1 = _mm_set1_epi8(c1);
+    const __m128i v2 = _mm_set1_epi8(c2);
+    for (size_t k = 0; k < num_blocks; ++k) {
+        const char* ptr = data + k * BLOCK_SIZE;
+        uint64_t mask = 0;
+        for (size_t j = 0; j < BLOCK_SIZE / sse_util::CHARS_PER_128_BIT_REGISTER; ++j) {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                    ptr + j * sse_util::CHARS_PER_128_BIT_REGISTER));
+            __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(chars, v1), _mm_cmpeq_epi8(chars, v2));
+            uint64_t bits = static_cast<uint16_t>(_mm_movemask_epi8(eq));
+            mask |= bits << (j * sse_util::CHARS_PER_128_BIT_REGISTER);
+        }
+        masks[k] = mask;
+    }
+}
+
+__attribute__((target("avx2")))
+static void find_chars_avx2(const char* data, size_t num_blocks, char c1, char c2,
+                            uint64_t* masks) {
+    const __m256i v1 = _mm256_set1_epi8(c1);
+    const __m256i v2 = _mm256_set1_epi8(c2);
+    for (size_t k = 0; k < num_blocks; ++k) {
+        const char* ptr = data + k * BLOCK_SIZE;
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 32));
+        __m256i eq_lo = _mm256_or_si256(_mm256_cmpeq_epi8(lo, v1), _mm256_cmpeq_epi8(lo, v2));
+        __m256i eq_hi = _mm256_or_si256(_mm256_cmpeq_epi8(hi, v1), _mm256_cmpeq_epi8(hi, v2));
+        uint64_t mask_lo = static_cast<uint32_t>(_mm256_movemask_epi8(eq_lo));
+        uint64_t mask_hi = static_cast<uint32_t>(_mm256_movemask_epi8(eq_hi));
+        masks[k] = mask_lo | (mask_hi << 32);
+    }
+}
+
+CsvTokenizer::CsvTokenizer(char column_separator, char line_delimiter, char enclose) :
+        _column_separator(column_separator),
+        _line_delimiter(line_delimiter),
+        _enclose(enclose),
+        _use_avx2(CpuInfo::is_supported(CpuInfo::AVX2)) {
+}
+
+void CsvTokenizer::_find_chars(const char* data, size_t size, char c1, char c2) {
+    size_t num_blocks = size / BLOCK_SIZE;
+    _masks.resize(num_blocks + 1);
+    if (_use_avx2) {
+        find_chars_avx2(data, num_blocks, c1, c2, _masks.data());
+    } else {
+        find_chars_sse2(data, num_blocks, c1, c2, _masks.data());
+    }
+    // the last block is shorter, it must not be read beyond the end
+    uint64_t mask = 0;
+    for (size_t i = num_blocks * BLOCK_SIZE; i < size; ++i) {
+        if (data[i] == c1 || data[i] == c2) {
+            mask |= 1ULL << (i - num_blocks * BLOCK_SIZE);
+        }
+    }
+    _masks[num_blocks] = mask;
+}
+
+void CsvTokenizer::split_line(const Slice& line, std::vector<Slice>* values) {
+    const char* data = line.data;
+    size_t size = line.size;
+    // line-begin char and line-end char are considered to be 'delimeter'
+    size_t start = 0;
+    if (_enclose == 0) {
+        _find_chars(data, size, _column_separator, _column_separator);
+        for (size_t k = 0; k < _masks.size(); ++k) {
+            for (uint64_t mask = _masks[k]; mask != 0; mask &= mask - 1) {
+                size_t pos = k * BLOCK_SIZE + __builtin_ctzll(mask);
+                values->emplace_back(data + start, pos - start);
+                start = pos + 1;
+            }
+        }
+        values->emplace_back(data + start, size - start);
+        return;
+    }
+
+    // unescaped fields are never longer than the line, so the buffer is not
+    // reallocated while fields point into it
+    _unescaped.clear();
+    _unescaped.reserve(size);
+    _find_chars(data, size, _column_separator, _enclose);
+    bool in_quote = false;
+    int num_quotes = 0;
+    for (size_t k = 0; k < _masks.size(); ++k) {
+        for (uint64_t mask = _masks[k]; mask != 0; mask &= mask - 1) {
+            size_t pos = k * BLOCK_SIZE + __builtin_ctzll(mask);
+            if (data[pos] == _enclose) {
+                in_quote = !in_quote;
+                ++num_quotes;
+            } else if (!in_quote) {
+                _add_field(data + start, pos - start, num_quotes, values);
+                start = pos + 1;
+                num_quotes = 0;
+            }
+        }
+    }
+    _add_field(data + start, size - start, num_quotes, values);
+}
+
+void CsvTokenizer::_add_field(const char* data, size_t size, int num_quotes,
+                              std::vector<Slice>* values) {
+    if (num_quotes < 2 || size < 2 || data[0] != _enclose || data[size - 1] != _enclose) {
+        // not quoted, quotes in it are kept
+        values->emplace_back(data, size);
+        return;
+    }
+    ++data;
+    size -= 2;
+    if (num_quotes == 2) {
+        values->emplace_back(data, size);
+        return;
+    }
+    size_t offset = _unescaped.size();
+    for (size_t i = 0; i < size; ++i) {
+        _unescaped.push_back(data[i]);
+        if (data[i] == _enclose) {
+            // skip the second quote of the pair
+            ++i;
+        }
+    }
+    values->emplace_back(&_unescaped[offset], _unescaped.size() - offset);
+}
+
+const uint8_t* CsvTokenizer::find_line_delimiter(const uint8_t* data, size_t size,
+                                                 bool* in_quote) {
+    if (_enclose == 0) {
+        // glibc already searches one byte with SIMD
+        return reinterpret_cast<const uint8_t*>(memchr(data, _line_delimiter, size));
+    }
+    // lines are much shorter than the buffer, which is searched in parts not
+    // to look far beyond the line
+    for (size_t offset = 0; offset < size; offset += SEARCH_SIZE) {
+        const char* chars = reinterpret_cast<const char*>(data) + offset;
+        _find_chars(chars, std::min(SEARCH_SIZE, size - offset), _line_delimiter, _enclose);
+        for (size_t k = 0; k < _masks.size(); ++k) {
+            for (uint64_t mask = _masks[k]; mask != 0; mask &= mask - 1) {
+                size_t pos = k * BLOCK_SIZE + __builtin_ctzll(mask);
+                if (chars[pos] == _enclose) {
+                    *in_quote = !*in_quote;
+                } else if (!*in_quote) {
+                    return data + offset + pos;
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+}
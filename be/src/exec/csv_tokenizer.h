@@ -0,0 +1,67 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "util/slice.h"
+
+namespace doris {
+
+// Finds the fields and lines of delimited text. The positions of all special
+// bytes of a buffer are found first, 64 bytes at a time with SSE2 or AVX2,
+// then they are walked by bit scans, so the cost hardly depends on the length
+// of the fields.
+//
+// If 'enclose' is not 0 fields may be quoted by it: separators and line
+// delimiters between quotes belong to the field, the quotes around the field
+// are removed and two quotes in it stand for one.
+class CsvTokenizer {
+public:
+    CsvTokenizer(char column_separator, char line_delimiter, char enclose = 0);
+
+    // Fields point into 'line', or into this tokenizer if they contain
+    // doubled quotes, until the next call.
+    void split_line(const Slice& line, std::vector<Slice>* values);
+
+    // Returns the first line delimiter in [data, data + size) which is not
+    // quoted, nullptr if there is none. 'in_quote' keeps the quote state if a
+    // line is searched in several parts, it must be false for a new line.
+    const uint8_t* find_line_delimiter(const uint8_t* data, size_t size, bool* in_quote);
+
+private:
+    // bit i of _masks[k] is set if data[k * 64 + i] equals c1 or c2
+    void _find_chars(const char* data, size_t size, char c1, char c2);
+
+    void _add_field(const char* data, size_t size, int num_quotes,
+                    std::vector<Slice>* values);
+
+    char _column_separator;
+    char _line_delimiter;
+    char _enclose;
+    bool _use_avx2;
+
+    std::vector<uint64_t> _masks;
+    // fields with doubled quotes removed
+    std::string _unescaped;
+};
+
+}
@@ -0,0 +1,365 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/es/es_agg_reader.h"
+
+#include <sstream>
+
+#include "common/logging.h"
+#include "common/status.h"
+#include "exec/es/es_query_builder.h"
+#include "exec/es/es_scan_reader.h"
+#include "exec/es/es_scroll_parser.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "runtime/datetime_value.h"
+#include "runtime/descriptors.h"
+#include "runtime/tuple.h"
+
+namespace doris {
+
+static const std::string REQUEST_AGG_FILTER_PATH = "filter_path=hits.total,aggregations";
+static const char* FIELD_GROUPS = "groups";
+static const char* FIELD_AFTER_KEY = "after_key";
+
+static std::string function_name(int i) {
+    return "a" + std::to_string(i);
+}
+
+static std::string group_by_name(int i) {
+    return "g" + std::to_string(i);
+}
+
+// metric values are doubles, integers only if they are document counts
+static int64_t get_int64(const rapidjson::Value& value) {
+    return value.IsInt64() ? value.GetInt64() : static_cast<int64_t>(value.GetDouble());
+}
+
+ESAggReader::ESAggReader(const std::string& target,
+                         const std::map<std::string, std::string>& props,
+                         const TEsAggregation& aggregation) :
+        _aggregation(aggregation),
+        _buckets(nullptr),
+        _bucket_index(0),
+        _has_more(true) {
+    if (props.find(ESScanReader::KEY_USER_NAME) != props.end()) {
+        _user_name = props.at(ESScanReader::KEY_USER_NAME);
+    }
+    if (props.find(ESScanReader::KEY_PASS_WORD) != props.end()) {
+        _passwd = props.at(ESScanReader::KEY_PASS_WORD);
+    }
+    std::string shards;
+    if (props.find(ESScanReader::KEY_SHARD) != props.end()) {
+        shards = props.at(ESScanReader::KEY_SHARD);
+    }
+    _page_size = atoi(props.at(ESScanReader::KEY_BATCH_SIZE).c_str());
+    _search_url = target + "/" + props.at(ESScanReader::KEY_INDEX) + "/"
+        + props.at(ESScanReader::KEY_TYPE) + "/_search?preference=_shards:" + shards
+        + "&" + REQUEST_AGG_FILTER_PATH;
+    _query.Parse(props.at(ESScanReader::KEY_QUERY).c_str());
+}
+
+ESAggReader::~ESAggReader() {
+}
+
+Status ESAggReader::check(const TEsAggregation& aggregation,
+                          const TupleDescriptor* tuple_desc) {
+    for (auto& function : aggregation.functions) {
+        const std::string& name = function.function_name;
+        if (name != "count" && name != "sum" && name != "min" && name != "max") {
+            return Status("aggregate function can not be pushed down to elasticsearch: " + name);
+        }
+        if (name != "count" && !function.__isset.column) {
+            return Status("aggregate function pushed down to elasticsearch has no column: " + name);
+        }
+    }
+    int num_slots = 0;
+    for (auto slot_desc : tuple_desc->slots()) {
+        if (slot_desc->is_materialized()) {
+            ++num_slots;
+        }
+    }
+    if (num_slots != aggregation.group_by.size() + aggregation.functions.size()) {
+        std::stringstream ss;
+        ss << "es scan tuple has " << num_slots << " slots, but the pushed down aggregation has "
+            << aggregation.group_by.size() << " group by columns and "
+            << aggregation.functions.size() << " functions";
+        return Status(ss.str());
+    }
+    return Status::OK;
+}
+
+std::string ESAggReader::build_query(const std::map<std::string, std::string>& properties,
+                                     const TEsAggregation& aggregation,
+                                     std::vector<EsPredicate*>& predicates) {
+    rapidjson::Document es_query_dsl;
+    rapidjson::Document::AllocatorType& allocator = es_query_dsl.GetAllocator();
+    es_query_dsl.SetObject();
+    rapidjson::Document scratch_document;
+    rapidjson::Value query_node(rapidjson::kObjectType);
+    BooleanQueryBuilder::to_query(predicates, &scratch_document, &query_node);
+    es_query_dsl.AddMember("query", query_node, allocator);
+    // only the aggregations are returned, no documents
+    es_query_dsl.AddMember("size", 0, allocator);
+
+    rapidjson::Value functions_node(rapidjson::kObjectType);
+    for (int i = 0; i < aggregation.functions.size(); ++i) {
+        const TEsAggregateFunction& function = aggregation.functions[i];
+        if (!function.__isset.column) {
+            // count(*) is the document count of the bucket
+            continue;
+        }
+        const char* type = function.function_name == "count"
+            ? "value_count" : function.function_name.c_str();
+        rapidjson::Value field_node(rapidjson::kObjectType);
+        field_node.AddMember("field", rapidjson::Value(function.column.c_str(), allocator),
+                             allocator);
+        rapidjson::Value function_node(rapidjson::kObjectType);
+        function_node.AddMember(rapidjson::Value(type, allocator), field_node, allocator);
+        functions_node.AddMember(rapidjson::Value(function_name(i).c_str(), allocator),
+                                 function_node, allocator);
+    }
+
+    if (aggregation.group_by.empty()) {
+        es_query_dsl.AddMember("aggs", functions_node, allocator);
+    } else {
+        rapidjson::Value sources_node(rapidjson::kArrayType);
+        for (int i = 0; i < aggregation.group_by.size(); ++i) {
+            const TEsGroupBy& group_by = aggregation.group_by[i];
+            rapidjson::Value field_node(rapidjson::kObjectType);
+            field_node.AddMember("field", rapidjson::Value(group_by.column.c_str(), allocator),
+                                 allocator);
+            // documents without a value are grouped into a null bucket as in sql
+            field_node.AddMember("missing_bucket", true, allocator);
+            rapidjson::Value source_node(rapidjson::kObjectType);
+            if (group_by.__isset.date_interval) {
+                field_node.AddMember("interval",
+                                     rapidjson::Value(group_by.date_interval.c_str(), allocator),
+                                     allocator);
+                source_node.AddMember("date_histogram", field_node, allocator);
+            } else {
+                source_node.AddMember("terms", field_node, allocator);
+            }
+            rapidjson::Value named_source_node(rapidjson::kObjectType);
+            named_source_node.AddMember(rapidjson::Value(group_by_name(i).c_str(), allocator),
+                                        source_node, allocator);
+            sources_node.PushBack(named_source_node, allocator);
+        }
+        rapidjson::Value composite_node(rapidjson::kObjectType);
+        composite_node.AddMember(
+                "size", atoi(properties.at(ESScanReader::KEY_BATCH_SIZE).c_str()), allocator);
+        composite_node.AddMember("sources", sources_node, allocator);
+        rapidjson::Value groups_node(rapidjson::kObjectType);
+        groups_node.AddMember("composite", composite_node, allocator);
+        groups_node.AddMember("aggs", functions_node, allocator);
+        rapidjson::Value aggs_node(rapidjson::kObjectType);
+        aggs_node.AddMember(rapidjson::StringRef(FIELD_GROUPS), groups_node, allocator);
+        es_query_dsl.AddMember("aggs", aggs_node, allocator);
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    es_query_dsl.Accept(writer);
+    return buffer.GetString();
+}
+
+Status ESAggReader::open(const TupleDescriptor* tuple_desc) {
+    if (_query.HasParseError() || !_query.IsObject()) {
+        return Status("invalid aggregation query of elasticsearch");
+    }
+    for (auto slot_desc : tuple_desc->slots()) {
+        if (slot_desc->is_materialized()) {
+            _slots.push_back(slot_desc);
+        }
+    }
+    DCHECK_EQ(_slots.size(), _aggregation.group_by.size() + _aggregation.functions.size());
+    return Status::OK;
+}
+
+Status ESAggReader::_fetch_page() {
+    rapidjson::Document::AllocatorType& allocator = _query.GetAllocator();
+    if (_buckets != nullptr) {
+        // the next page of the composite aggregation starts after the last
+        // bucket of this one
+        rapidjson::Value& composite = _query["aggs"][FIELD_GROUPS]["composite"];
+        composite.RemoveMember("after");
+        rapidjson::Value after_key;
+        after_key.CopyFrom(_response["aggregations"][FIELD_GROUPS][FIELD_AFTER_KEY], allocator);
+        composite.AddMember("after", after_key, allocator);
+    }
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    _query.Accept(writer);
+
+    RETURN_IF_ERROR(_network_client.init(_search_url));
+    _network_client.set_basic_auth(_user_name, _passwd);
+    _network_client.set_content_type("application/json");
+    std::string response;
+    Status status = _network_client.execute_post_request(buffer.GetString(), &response);
+    if (!status.ok() || _network_client.get_http_status() != 200) {
+        std::stringstream ss;
+        ss << "Failed to aggregate in ES server, errmsg is: " << status.get_error_msg()
+            << ", response: " << response;
+        LOG(WARNING) << ss.str();
+        return Status(ss.str());
+    }
+
+    _response.Parse(response.c_str());
+    if (_response.HasParseError() || !_response.HasMember("hits")) {
+        return Status("Parsing json error, json is: " + response);
+    }
+    _bucket_index = 0;
+    if (_aggregation.group_by.empty()) {
+        _buckets = nullptr;
+        _has_more = false;
+        return Status::OK;
+    }
+    if (!_response.HasMember("aggregations")) {
+        // no document matches
+        _has_more = false;
+        return Status::OK;
+    }
+    const rapidjson::Value& groups = _response["aggregations"][FIELD_GROUPS];
+    if (!groups.HasMember("buckets") || !groups["buckets"].IsArray()) {
+        return Status("buckets of es aggregation is not an array");
+    }
+    _buckets = &groups["buckets"];
+    _has_more = groups.HasMember(FIELD_AFTER_KEY) && _buckets->Size() >= _page_size;
+    return Status::OK;
+}
+
+Status ESAggReader::get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof) {
+    *eof = false;
+    if (_aggregation.group_by.empty()) {
+        if (!_has_more) {
+            *eof = true;
+            return Status::OK;
+        }
+        RETURN_IF_ERROR(_fetch_page());
+        // the total is an object since elasticsearch 7
+        const rapidjson::Value& total = _response["hits"]["total"];
+        int64_t doc_count = total.IsObject() ? get_int64(total["value"]) : get_int64(total);
+        rapidjson::Value empty_aggs(rapidjson::kObjectType);
+        const rapidjson::Value& aggs = _response.HasMember("aggregations")
+            ? _response["aggregations"] : empty_aggs;
+        return _fill_row(nullptr, doc_count, aggs, tuple, tuple_pool);
+    }
+
+    while (_buckets == nullptr || _bucket_index >= _buckets->Size()) {
+        if (!_has_more) {
+            *eof = true;
+            return Status::OK;
+        }
+        RETURN_IF_ERROR(_fetch_page());
+    }
+    const rapidjson::Value& bucket = (*_buckets)[_bucket_index++];
+    return _fill_row(&bucket["key"], get_int64(bucket["doc_count"]), bucket, tuple, tuple_pool);
+}
+
+Status ESAggReader::_fill_row(const rapidjson::Value* key, int64_t doc_count,
+                              const rapidjson::Value& aggs, Tuple* tuple, MemPool* tuple_pool) {
+    int slot_idx = 0;
+    for (int i = 0; i < _aggregation.group_by.size(); ++i) {
+        const SlotDescriptor* slot_desc = _slots[slot_idx++];
+        rapidjson::Value::ConstMemberIterator itr = key->FindMember(group_by_name(i).c_str());
+        if (itr == key->MemberEnd()) {
+            return Status("key of es aggregation bucket has no group by column "
+                          + _aggregation.group_by[i].column);
+        }
+        RETURN_IF_ERROR(_fill_value(itr->value, slot_desc, tuple, tuple_pool));
+    }
+    for (int i = 0; i < _aggregation.functions.size(); ++i) {
+        const SlotDescriptor* slot_desc = _slots[slot_idx++];
+        const TEsAggregateFunction& function = _aggregation.functions[i];
+        if (!function.__isset.column) {
+            rapidjson::Value value(doc_count);
+            RETURN_IF_ERROR(_fill_value(value, slot_desc, tuple, tuple_pool));
+            continue;
+        }
+        // the sum of no documents is null, elasticsearch returns 0
+        rapidjson::Value::ConstMemberIterator itr = aggs.FindMember(function_name(i).c_str());
+        if (itr == aggs.MemberEnd() || !itr->value.HasMember("value")
+                || (doc_count == 0 && function.function_name == "sum")) {
+            tuple->set_null(slot_desc->null_indicator_offset());
+            continue;
+        }
+        RETURN_IF_ERROR(_fill_value(itr->value["value"], slot_desc, tuple, tuple_pool));
+    }
+    return Status::OK;
+}
+
+Status ESAggReader::_fill_value(const rapidjson::Value& value, const SlotDescriptor* slot_desc,
+                                Tuple* tuple, MemPool* tuple_pool) {
+    if (value.IsNull()) {
+        tuple->set_null(slot_desc->null_indicator_offset());
+        return Status::OK;
+    }
+    tuple->set_not_null(slot_desc->null_indicator_offset());
+    void* slot = tuple->get_slot(slot_desc->tuple_offset());
+    PrimitiveType type = slot_desc->type().type;
+    if (!value.IsNumber()) {
+        return ScrollParser::fill_slot(value, type, slot, tuple_pool);
+    }
+    switch (type) {
+    case TYPE_TINYINT:
+        *reinterpret_cast<int8_t*>(slot) = get_int64(value);
+        break;
+    case TYPE_SMALLINT:
+        *reinterpret_cast<int16_t*>(slot) = get_int64(value);
+        break;
+    case TYPE_INT:
+        *reinterpret_cast<int32_t*>(slot) = get_int64(value);
+        break;
+    case TYPE_BIGINT:
+        *reinterpret_cast<int64_t*>(slot) = get_int64(value);
+        break;
+    case TYPE_LARGEINT: {
+        __int128 v = get_int64(value);
+        memcpy(slot, &v, sizeof(v));
+        break;
+    }
+    case TYPE_FLOAT:
+        *reinterpret_cast<float*>(slot) = value.GetDouble();
+        break;
+    case TYPE_DOUBLE:
+        *reinterpret_cast<double*>(slot) = value.GetDouble();
+        break;
+    case TYPE_BOOLEAN:
+        *reinterpret_cast<int8_t*>(slot) = get_int64(value) != 0;
+        break;
+    case TYPE_DATE:
+    case TYPE_DATETIME: {
+        // dates of aggregations are milliseconds since the epoch
+        DateTimeValue* ts_slot = reinterpret_cast<DateTimeValue*>(slot);
+        if (!ts_slot->from_unixtime(get_int64(value) / 1000)) {
+            return Status("invalid date of es aggregation");
+        }
+        if (type == TYPE_DATE) {
+            ts_slot->cast_to_date();
+        } else {
+            ts_slot->set_type(TIME_DATETIME);
+        }
+        break;
+    }
+    default:
+        return ScrollParser::fill_slot(value, type, slot, tuple_pool);
+    }
+    return Status::OK;
+}
+
+}
@@ -0,0 +1,92 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gen_cpp/PlanNodes_types.h"
+#include "http/http_client.h"
+#include "rapidjson/document.h"
+
+namespace doris {
+
+class EsPredicate;
+class MemPool;
+class SlotDescriptor;
+class Status;
+class Tuple;
+class TupleDescriptor;
+
+// Reads the result of an aggregation evaluated by elasticsearch over one
+// shard instead of its documents. The group by columns are the sources of a
+// composite aggregation whose buckets are paged by their after key, every
+// bucket is one row of the group by columns followed by the results of the
+// aggregate functions. Without group by columns the shard gives a single row.
+//
+// count(*) is the document count of a bucket, the other functions are
+// metric aggregations of the bucket.
+class ESAggReader {
+public:
+    ESAggReader(const std::string& target, const std::map<std::string, std::string>& props,
+                const TEsAggregation& aggregation);
+    ~ESAggReader();
+
+    // checks that elasticsearch can evaluate 'aggregation' and that the
+    // materialized slots of 'tuple_desc' are its result
+    static Status check(const TEsAggregation& aggregation, const TupleDescriptor* tuple_desc);
+
+    // the search body of the aggregation of the documents matching 'predicates',
+    // 'properties' are those of ESScanReader
+    static std::string build_query(const std::map<std::string, std::string>& properties,
+                                   const TEsAggregation& aggregation,
+                                   std::vector<EsPredicate*>& predicates);
+
+    Status open(const TupleDescriptor* tuple_desc);
+    Status get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof);
+
+private:
+    // requests the next page of buckets
+    Status _fetch_page();
+
+    // 'key' holds the values of the group by columns, unset without them
+    Status _fill_row(const rapidjson::Value* key, int64_t doc_count,
+                     const rapidjson::Value& aggs, Tuple* tuple, MemPool* tuple_pool);
+
+    Status _fill_value(const rapidjson::Value& value, const SlotDescriptor* slot_desc,
+                       Tuple* tuple, MemPool* tuple_pool);
+
+    std::string _search_url;
+    std::string _user_name;
+    std::string _passwd;
+    const TEsAggregation& _aggregation;
+    int _page_size;
+
+    std::vector<SlotDescriptor*> _slots;
+    HttpClient _network_client;
+    rapidjson::Document _query;
+    rapidjson::Document _response;
+    // buckets of the last page, null before the first page
+    const rapidjson::Value* _buckets;
+    rapidjson::SizeType _bucket_index;
+    bool _has_more;
+};
+
+}
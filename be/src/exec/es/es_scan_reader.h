@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <set>
 #include <string>
 
 #include "exec/es/es_scroll_parser.h"
@@ -39,6 +40,11 @@ public:
     static constexpr const char* KEY_SHARD = "shard_id";
     static constexpr const char* KEY_QUERY = "query";
     static constexpr const char* KEY_BATCH_SIZE = "batch_size";
+    // columns read from doc values, separated by ','
+    static constexpr const char* KEY_DOCVALUE_FIELDS = "docvalue_fields";
+    // the slice of the shard read if it is scanned by several sliced scrolls
+    static constexpr const char* KEY_SLICE_ID = "slice_id";
+    static constexpr const char* KEY_SLICE_MAX = "slice_max";
     ESScanReader(const std::string& target, const std::map<std::string, std::string>& props);
     ~ESScanReader();
 
@@ -67,6 +73,7 @@ private:
     std::string _next_scroll_url;
     bool _eos;
     int _batch_size;
+    std::set<std::string> _docvalue_fields;
 
     std::string _cached_response;
 };
@@ -34,6 +34,7 @@ static const char* FIELD_HITS = "hits";
 static const char* FIELD_INNER_HITS = "hits";
 static const char* FIELD_SOURCE = "_source";
 static const char* FIELD_TOTAL = "total";
+static const char* FIELD_DOCVALUES = "fields";
 
 static const string ERROR_INVALID_COL_DATA = "Data source returned inconsistent column data. "
     "Expected value of type $0 based on column metadata. This likely indicates a "
@@ -120,6 +121,14 @@ ScrollParser::ScrollParser() :
     _line_index(0) {
 }
 
+ScrollParser::ScrollParser(const std::set<std::string>& docvalue_fields) :
+    _scroll_id(""),
+    _total(0),
+    _size(0),
+    _line_index(0),
+    _docvalue_fields(docvalue_fields) {
+}
+
 ScrollParser::~ScrollParser() {
 }
 
@@ -170,184 +179,208 @@ int ScrollParser::get_total() {
     return _total;
 }
 
-Status ScrollParser::fill_tuple(const TupleDescriptor* tuple_desc, 
-            Tuple* tuple, MemPool* tuple_pool, bool* line_eof) {
-    *line_eof = true;
-    if (_size <= 0 || _line_index >= _size) {
-        return Status::OK;
-    }
-
-    const rapidjson::Value& obj = _inner_hits_node[_line_index++];
-    const rapidjson::Value& line = obj[FIELD_SOURCE];
-    if (!line.IsObject()) {
-        return Status("Parse inner hits failed");
-    }
-
-    tuple->init(tuple_desc->byte_size());
-    for (int i = 0; i < tuple_desc->slots().size(); ++i) {
-        const SlotDescriptor* slot_desc = tuple_desc->slots()[i];
+Status ScrollParser::fill_slot(const rapidjson::Value& col, PrimitiveType type, void* slot,
+                               MemPool* tuple_pool) {
+    switch (type) {
+        case TYPE_CHAR:
+        case TYPE_VARCHAR: {
+            RETURN_ERROR_IF_COL_IS_ARRAY(col, type);
+            RETURN_ERROR_IF_COL_IS_NOT_STRING(col, type);
+
+            const std::string& val = col.GetString();
+            size_t val_size = col.GetStringLength();
+            char* buffer = reinterpret_cast<char*>(tuple_pool->try_allocate_unaligned(val_size));
+            if (UNLIKELY(buffer == NULL)) {
+                string details = strings::Substitute(ERROR_MEM_LIMIT_EXCEEDED, "MaterializeNextRow",
+                            val_size, "string slot");
+                return tuple_pool->mem_tracker()->MemLimitExceeded(NULL, details, val_size);
+            }
+            memcpy(buffer, val.data(), val_size);
+            reinterpret_cast<StringValue*>(slot)->ptr = buffer;
+            reinterpret_cast<StringValue*>(slot)->len = val_size;
+            break;
+        }
 
-        if (!slot_desc->is_materialized()) {
-            continue;
+        case TYPE_TINYINT: {
+            Status status = get_int_value<int8_t>(col, type, slot);
+            if (!status.ok()) {
+                return status;
+            }
+            break;
         }
 
-        const char* col_name = slot_desc->col_name().c_str();
-        rapidjson::Value::ConstMemberIterator itr = line.FindMember(col_name);
-        if (itr == line.MemberEnd()) {
-            tuple->set_null(slot_desc->null_indicator_offset());
-            continue;
+        case TYPE_SMALLINT: {
+            Status status = get_int_value<int16_t>(col, type, slot);
+            if (!status.ok()) {
+                return status;
+            }
+            break;
         }
 
-        tuple->set_not_null(slot_desc->null_indicator_offset());
-        const rapidjson::Value &col = line[col_name];
+        case TYPE_INT: {
+            Status status = get_int_value<int32_t>(col, type, slot);
+            if (!status.ok()) {
+                return status;
+            }
+            break;
+        }
 
-        void* slot = tuple->get_slot(slot_desc->tuple_offset());
-        PrimitiveType type = slot_desc->type().type;
-        switch (type) {
-            case TYPE_CHAR:
-            case TYPE_VARCHAR: {
-                RETURN_ERROR_IF_COL_IS_ARRAY(col, type);
-                RETURN_ERROR_IF_COL_IS_NOT_STRING(col, type);
-
-                const std::string& val = col.GetString();
-                size_t val_size = col.GetStringLength();
-                char* buffer = reinterpret_cast<char*>(tuple_pool->try_allocate_unaligned(val_size));
-                if (UNLIKELY(buffer == NULL)) {
-                    string details = strings::Substitute(ERROR_MEM_LIMIT_EXCEEDED, "MaterializeNextRow",
-                                val_size, "string slot");
-                    return tuple_pool->mem_tracker()->MemLimitExceeded(NULL, details, val_size);
-                }
-                memcpy(buffer, val.data(), val_size);
-                reinterpret_cast<StringValue*>(slot)->ptr = buffer;
-                reinterpret_cast<StringValue*>(slot)->len = val_size;
-                break;
+        case TYPE_BIGINT: {
+            Status status = get_int_value<int64_t>(col, type, slot);
+            if (!status.ok()) {
+                return status;
             }
+            break;
+        }
 
-            case TYPE_TINYINT: {
-                Status status = get_int_value<int8_t>(col, type, slot);
-                if (!status.ok()) {
-                    return status;
-                }
-                break;
+        case TYPE_LARGEINT: {
+            Status status = get_int_value<__int128>(col, type, slot);
+            if (!status.ok()) {
+                return status;
             }
+            break;
+        }
 
-            case TYPE_SMALLINT: {
-                Status status = get_int_value<int16_t>(col, type, slot);
-                if (!status.ok()) {
-                    return status;
-                }
-                break;
+        case TYPE_DOUBLE: {
+            Status status = get_float_value<double>(col, type, slot);
+            if (!status.ok()) {
+                return status;
             }
+            break;
+        }
 
-            case TYPE_INT: {
-                Status status = get_int_value<int32_t>(col, type, slot);
-                if (!status.ok()) {
-                    return status;
-                }
-                break;
+        case TYPE_FLOAT: {
+            Status status = get_float_value<float>(col, type, slot);
+            if (!status.ok()) {
+                return status;
             }
+            break;
+        }
 
-            case TYPE_BIGINT: {
-                Status status = get_int_value<int64_t>(col, type, slot);
-                if (!status.ok()) {
-                    return status;
-                }
+        case TYPE_BOOLEAN: {
+            if (col.IsBool()) {
+                *reinterpret_cast<int8_t*>(slot) = col.GetBool();
                 break;
             }
 
-            case TYPE_LARGEINT: {
-                Status status = get_int_value<__int128>(col, type, slot);
-                if (!status.ok()) {
-                    return status;
-                }
+            if (col.IsNumber()) {
+                *reinterpret_cast<int8_t*>(slot) = col.GetInt();
                 break;
             }
 
-            case TYPE_DOUBLE: {
-                Status status = get_float_value<double>(col, type, slot);
-                if (!status.ok()) {
-                    return status;
+            RETURN_ERROR_IF_COL_IS_ARRAY(col, type);
+            RETURN_ERROR_IF_COL_IS_NOT_STRING(col, type);
+
+            const std::string& val = col.GetString();
+            size_t val_size = col.GetStringLength();
+            StringParser::ParseResult result;
+            bool b = 
+                StringParser::string_to_bool(val.c_str(), val_size, &result);
+            RETURN_ERROR_IF_PARSING_FAILED(result, type);
+            *reinterpret_cast<int8_t*>(slot) = b;
+            break;
+        }
+
+        case TYPE_DATE:
+        case TYPE_DATETIME: {
+            if (col.IsNumber()) {
+                if (!reinterpret_cast<DateTimeValue*>(slot)->from_unixtime(col.GetInt64())) {
+                    return Status(strings::Substitute(ERROR_INVALID_COL_DATA, type_to_string(type)));
                 }
-                break;
-            }
 
-            case TYPE_FLOAT: {
-                Status status = get_float_value<float>(col, type, slot);
-                if (!status.ok()) {
-                    return status;
+                if (type == TYPE_DATE) {
+                    reinterpret_cast<DateTimeValue*>(slot)->cast_to_date();
+                } else {
+                    reinterpret_cast<DateTimeValue*>(slot)->set_type(TIME_DATETIME);
                 }
                 break;
             }
 
-            case TYPE_BOOLEAN: {
-                if (col.IsBool()) {
-                    *reinterpret_cast<int8_t*>(slot) = col.GetBool();
-                    break;
-                }
+            RETURN_ERROR_IF_COL_IS_ARRAY(col, type);
+            RETURN_ERROR_IF_COL_IS_NOT_STRING(col, type);
 
-                if (col.IsNumber()) {
-                    *reinterpret_cast<int8_t*>(slot) = col.GetInt();
-                    break;
-                }
+            DateTimeValue* ts_slot = reinterpret_cast<DateTimeValue*>(slot);
+            const std::string& val = col.GetString();
+            size_t val_size = col.GetStringLength();
+            if (!ts_slot->from_date_str(val.c_str(), val_size)) {
+                return Status(strings::Substitute(ERROR_INVALID_COL_DATA, type_to_string(type)));
+            }
 
-                RETURN_ERROR_IF_COL_IS_ARRAY(col, type);
-                RETURN_ERROR_IF_COL_IS_NOT_STRING(col, type);
+            if (ts_slot->year() < 1900) {
+                return Status(strings::Substitute(ERROR_INVALID_COL_DATA, type_to_string(type)));
+            }
 
-                const std::string& val = col.GetString();
-                size_t val_size = col.GetStringLength();
-                StringParser::ParseResult result;
-                bool b = 
-                    StringParser::string_to_bool(val.c_str(), val_size, &result);
-                RETURN_ERROR_IF_PARSING_FAILED(result, type);
-                *reinterpret_cast<int8_t*>(slot) = b;
-                break;
+            if (type == TYPE_DATE) {
+                ts_slot->cast_to_date();
+            } else {
+                ts_slot->to_datetime();
             }
+            break;
+        }
 
-            case TYPE_DATE:
-            case TYPE_DATETIME: {
-                if (col.IsNumber()) {
-                    if (!reinterpret_cast<DateTimeValue*>(slot)->from_unixtime(col.GetInt64())) {
-                        return Status(strings::Substitute(ERROR_INVALID_COL_DATA, type_to_string(type)));
-                    }
-
-                    if (type == TYPE_DATE) {
-                        reinterpret_cast<DateTimeValue*>(slot)->cast_to_date();
-                    } else {
-                        reinterpret_cast<DateTimeValue*>(slot)->set_type(TIME_DATETIME);
-                    }
-                    break;
-                }
+        default: {
+            DCHECK(false);
+            break;
+        }
+    }
+    return Status::OK;
+}
 
-                RETURN_ERROR_IF_COL_IS_ARRAY(col, type);
-                RETURN_ERROR_IF_COL_IS_NOT_STRING(col, type);
+Status ScrollParser::fill_tuple(const TupleDescriptor* tuple_desc, 
+            Tuple* tuple, MemPool* tuple_pool, bool* line_eof) {
+    *line_eof = true;
+    if (_size <= 0 || _line_index >= _size) {
+        return Status::OK;
+    }
 
-                DateTimeValue* ts_slot = reinterpret_cast<DateTimeValue*>(slot);
-                const std::string& val = col.GetString();
-                size_t val_size = col.GetStringLength();
-                if (!ts_slot->from_date_str(val.c_str(), val_size)) {
-                    return Status(strings::Substitute(ERROR_INVALID_COL_DATA, type_to_string(type)));
-                }
+    const rapidjson::Value& obj = _inner_hits_node[_line_index++];
+    rapidjson::Value::ConstMemberIterator source = obj.FindMember(FIELD_SOURCE);
+    rapidjson::Value::ConstMemberIterator docvalues = obj.FindMember(FIELD_DOCVALUES);
+    if (source != obj.MemberEnd() && !source->value.IsObject()) {
+        return Status("Parse inner hits failed");
+    }
+    // _source is not returned if all columns are read from doc values
+    if (source == obj.MemberEnd() && _docvalue_fields.empty()) {
+        return Status("Parse inner hits failed");
+    }
 
-                if (ts_slot->year() < 1900) {
-                    return Status(strings::Substitute(ERROR_INVALID_COL_DATA, type_to_string(type)));
-                }
+    tuple->init(tuple_desc->byte_size());
+    for (int i = 0; i < tuple_desc->slots().size(); ++i) {
+        const SlotDescriptor* slot_desc = tuple_desc->slots()[i];
 
-                if (type == TYPE_DATE) {
-                    ts_slot->cast_to_date();
-                } else {
-                    ts_slot->to_datetime();
+        if (!slot_desc->is_materialized()) {
+            continue;
+        }
+
+        const char* col_name = slot_desc->col_name().c_str();
+        const rapidjson::Value* col = nullptr;
+        if (_docvalue_fields.count(slot_desc->col_name()) > 0) {
+            // doc values of a field are always an array, empty or missing
+            // if the document has no value
+            if (docvalues != obj.MemberEnd()) {
+                rapidjson::Value::ConstMemberIterator itr = docvalues->value.FindMember(col_name);
+                if (itr != docvalues->value.MemberEnd() && itr->value.IsArray()
+                        && !itr->value.Empty()) {
+                    col = &itr->value[0];
                 }
-                break;
             }
-
-            default: {
-                DCHECK(false);
-                break;
+        } else if (source != obj.MemberEnd()) {
+            rapidjson::Value::ConstMemberIterator itr = source->value.FindMember(col_name);
+            if (itr != source->value.MemberEnd()) {
+                col = &itr->value;
             }
         }
+        if (col == nullptr) {
+            tuple->set_null(slot_desc->null_indicator_offset());
+            continue;
+        }
+
+        tuple->set_not_null(slot_desc->null_indicator_offset());
+        void* slot = tuple->get_slot(slot_desc->tuple_offset());
+        RETURN_IF_ERROR(fill_slot(*col, slot_desc->type().type, slot, tuple_pool));
     }
 
     *line_eof = false;
     return Status::OK;
 }
-}
+}
\ No newline at end of file
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <set>
 #include <string>
 
 #include "rapidjson/document.h"
@@ -31,6 +32,8 @@ class ScrollParser {
 
 public:
     ScrollParser();
+    // columns in 'docvalue_fields' are read from the doc values of the hits
+    explicit ScrollParser(const std::set<std::string>& docvalue_fields);
     ~ScrollParser();
 
     Status parse(const std::string& scroll_result);
@@ -41,12 +44,17 @@ public:
     int get_total();
     int get_size();
 
+    // fill the slot of 'type' with the JSON value 'col' of _source or of doc values
+    static Status fill_slot(const rapidjson::Value& col, PrimitiveType type, void* slot,
+                            MemPool* tuple_pool);
+
 private:
 
     std::string _scroll_id;
     int _total;
     int _size;
     rapidjson::SizeType _line_index;
+    std::set<std::string> _docvalue_fields;
 
     rapidjson::Document _document_node;
     rapidjson::Value _inner_hits_node;
@@ -17,6 +17,7 @@
 
 #include "exec/es/es_scroll_query.h"
 
+#include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <sstream>
 
@@ -76,7 +77,27 @@ std::string ESScrollQueryBuilder::build(const std::map<std::string, std::string>
     // note: add `query` for this value....
     es_query_dsl.AddMember("query", query_node, allocator);
     // just filter the selected fields for reducing the network cost
-    if (fields.size() > 0) {
+    std::set<std::string> docvalue_field_set = docvalue_fields(properties);
+    if (!docvalue_field_set.empty()) {
+        // doc values are stored by column, they are much cheaper to read and
+        // to transfer than the whole _source of the documents
+        rapidjson::Value source_node(rapidjson::kArrayType);
+        rapidjson::Value docvalue_node(rapidjson::kArrayType);
+        for (auto iter = fields.begin(); iter != fields.end(); iter++) {
+            rapidjson::Value field(iter->c_str(), allocator);
+            if (docvalue_field_set.count(*iter) > 0) {
+                docvalue_node.PushBack(field, allocator);
+            } else {
+                source_node.PushBack(field, allocator);
+            }
+        }
+        if (source_node.Empty()) {
+            es_query_dsl.AddMember("_source", false, allocator);
+        } else {
+            es_query_dsl.AddMember("_source", source_node, allocator);
+        }
+        es_query_dsl.AddMember("docvalue_fields", docvalue_node, allocator);
+    } else if (fields.size() > 0) {
         rapidjson::Value source_node(rapidjson::kArrayType);
         for (auto iter = fields.begin(); iter != fields.end(); iter++) {
             rapidjson::Value field(iter->c_str(), allocator);
@@ -92,6 +113,15 @@ std::string ESScrollQueryBuilder::build(const std::map<std::string, std::string>
     es_query_dsl.AddMember("sort", sort_node, allocator);
     // number of docuements returned
     es_query_dsl.AddMember("size", size, allocator);
+    // a sliced scroll reads the documents of the shard whose ids hash to the
+    // slice, several of them scan a large shard in parallel
+    auto slice_max_iter = properties.find(ESScanReader::KEY_SLICE_MAX);
+    if (slice_max_iter != properties.end() && atoi(slice_max_iter->second.c_str()) > 1) {
+        rapidjson::Value slice_node(rapidjson::kObjectType);
+        slice_node.AddMember("id", atoi(properties.at(ESScanReader::KEY_SLICE_ID).c_str()), allocator);
+        slice_node.AddMember("max", atoi(slice_max_iter->second.c_str()), allocator);
+        es_query_dsl.AddMember("slice", slice_node, allocator);
+    }
     rapidjson::StringBuffer buffer;
     rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
     es_query_dsl.Accept(writer);
@@ -99,4 +129,22 @@ std::string ESScrollQueryBuilder::build(const std::map<std::string, std::string>
     return es_query_dsl_json;                
 
 }
+
+std::set<std::string> ESScrollQueryBuilder::docvalue_fields(
+        const std::map<std::string, std::string>& properties) {
+    std::set<std::string> fields;
+    auto iter = properties.find(ESScanReader::KEY_DOCVALUE_FIELDS);
+    if (iter == properties.end()) {
+        return fields;
+    }
+    std::vector<std::string> names;
+    boost::split(names, iter->second, boost::is_any_of(","));
+    for (auto& name : names) {
+        boost::trim(name);
+        if (!name.empty()) {
+            fields.insert(name);
+        }
+    }
+    return fields;
+}
 }
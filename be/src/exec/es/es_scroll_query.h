@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include<map>
+#include<set>
 #include<string>
 #include<vector>
 
@@ -34,7 +36,12 @@ public:
     static std::string build_clear_scroll_body(const std::string& scroll_id);
     // @note: predicates should processed before pass it to this method, 
     // tie breaker for predicate wheather can push down es can reference the push-down filters
+    // fields in the docvalue fields of 'properties' are fetched from doc values
+    // instead of _source, a sliced scroll is built if the properties have a
+    // slice max larger than 1
     static std::string build(const std::map<std::string, std::string>& properties,
                 const std::vector<std::string>& fields, std::vector<EsPredicate*>& predicates);
+    // the docvalue fields of 'properties', separated by ',' in it
+    static std::set<std::string> docvalue_fields(const std::map<std::string, std::string>& properties);
 };
 }
@@ -17,10 +17,16 @@
 
 #include "exec/es_http_scan_node.h"
 
+#include <algorithm>
 #include <chrono>
+#include <set>
 #include <sstream>
 
+#include <boost/algorithm/string/join.hpp>
+
+#include "common/config.h"
 #include "common/object_pool.h"
+#include "exec/es/es_agg_reader.h"
 #include "exec/es/es_predicate.h"
 #include "exec/es/es_query_builder.h"
 #include "exec/es/es_scan_reader.h"
@@ -44,6 +50,7 @@ EsHttpScanNode::EsHttpScanNode(
             _scan_finished(false),
             _eos(false),
             _max_buffered_batches(1024),
+            _push_down_aggregation(false),
             _wait_scanner_timer(nullptr) {
 }
 
@@ -55,6 +62,10 @@ Status EsHttpScanNode::init(const TPlanNode& tnode, RuntimeState* state) {
 
     // use TEsScanNode
     _properties = tnode.es_scan_node.properties;
+    if (tnode.es_scan_node.__isset.aggregation) {
+        _push_down_aggregation = true;
+        _aggregation = tnode.es_scan_node.aggregation;
+    }
     return Status::OK;
 }
 
@@ -78,6 +89,26 @@ Status EsHttpScanNode::prepare(RuntimeState* state) {
         _column_names.push_back(slot_desc->col_name());
     }
 
+    // the formats of the doc values of dates differ between the versions of
+    // elasticsearch, so dates are always read from _source
+    auto docvalue_iter = _properties.find(ESScanReader::KEY_DOCVALUE_FIELDS);
+    if (docvalue_iter != _properties.end()) {
+        std::set<std::string> docvalue_fields = ESScrollQueryBuilder::docvalue_fields(_properties);
+        std::vector<std::string> fields;
+        for (auto slot_desc : _tuple_desc->slots()) {
+            PrimitiveType type = slot_desc->type().type;
+            if (slot_desc->is_materialized() && type != TYPE_DATE && type != TYPE_DATETIME
+                    && docvalue_fields.count(slot_desc->col_name()) > 0) {
+                fields.push_back(slot_desc->col_name());
+            }
+        }
+        docvalue_iter->second = boost::algorithm::join(fields, ",");
+    }
+
+    if (_push_down_aggregation) {
+        RETURN_IF_ERROR(ESAggReader::check(_aggregation, _tuple_desc));
+    }
+
     _wait_scanner_timer = ADD_TIMER(runtime_profile(), "WaitScannerTime");
 
     return Status::OK;
@@ -141,6 +172,12 @@ Status EsHttpScanNode::open(RuntimeState* state) {
         _conjunct_ctxs[conjunct_index]->close(_runtime_state);
         _conjunct_ctxs.erase(_conjunct_ctxs.begin() + conjunct_index);
     }
+    // the buckets are aggregated from the documents matching the query, rows
+    // can not be filtered after that
+    if (_push_down_aggregation && !_conjunct_ctxs.empty()) {
+        return Status("aggregation is pushed down to elasticsearch, but some "
+                      "predicates can not be evaluated by elasticsearch");
+    }
 
     RETURN_IF_ERROR(start_scanners());
 
@@ -148,18 +185,20 @@ Status EsHttpScanNode::open(RuntimeState* state) {
 }
 
 Status EsHttpScanNode::start_scanners() {
+    // only scrolls can be sliced, aggregations read each shard by one search
+    int num_slices = _push_down_aggregation ? 1 : std::max(1, config::es_scroll_slices_per_shard);
     {
         std::unique_lock<std::mutex> l(_batch_queue_lock);
-        _num_running_scanners = _scan_ranges.size();
+        _num_running_scanners = _scan_ranges.size() * num_slices;
     }
 
+    // scanners run concurrently, the failure of one of them is reported by
+    // _process_status to get_next()
     for (int i = 0; i < _scan_ranges.size(); i++) {
-        std::promise<Status> p;
-        std::future<Status> f = p.get_future();
-        _scanner_threads.emplace_back(&EsHttpScanNode::scanner_worker, this, i,
-                    _scan_ranges.size(), std::ref(p));
-        Status status = f.get();
-        if (!status.ok()) return status;
+        for (int slice = 0; slice < num_slices; ++slice) {
+            _scanner_threads.emplace_back(&EsHttpScanNode::scanner_worker, this, i,
+                                          slice, num_slices);
+        }
     }
     return Status::OK;
 }
@@ -388,10 +427,10 @@ static std::string get_host_port(const std::vector<TNetworkAddress>& es_hosts) {
     return host_port;
 }
 
-void EsHttpScanNode::scanner_worker(int start_idx, int length, std::promise<Status>& p_status) {
+void EsHttpScanNode::scanner_worker(int range_idx, int slice_id, int num_slices) {
     // Clone expr context
     std::vector<ExprContext*> scanner_expr_ctxs;
-    DCHECK(start_idx < length);
+    DCHECK(slice_id < num_slices);
     auto status = Expr::clone_if_not_exists(_conjunct_ctxs, _runtime_state, 
                 &scanner_expr_ctxs);
     if (!status.ok()) {
@@ -400,7 +439,7 @@ void EsHttpScanNode::scanner_worker(int start_idx, int length, std::promise<Stat
 
     EsScanCounter counter;
     const TEsScanRange& es_scan_range = 
-        _scan_ranges[start_idx].scan_range.es_scan_range;
+        _scan_ranges[range_idx].scan_range.es_scan_range;
 
     // Collect the informations from scan range to perperties
     std::map<std::string, std::string> properties(_properties);
@@ -411,16 +450,27 @@ void EsHttpScanNode::scanner_worker(int start_idx, int length, std::promise<Stat
     properties[ESScanReader::KEY_SHARD] = std::to_string(es_scan_range.shard_id);
     properties[ESScanReader::KEY_BATCH_SIZE] = std::to_string(_runtime_state->batch_size());
     properties[ESScanReader::KEY_HOST_PORT] = get_host_port(es_scan_range.es_hosts);
-    properties[ESScanReader::KEY_QUERY] 
-        = ESScrollQueryBuilder::build(properties, _column_names, _predicates);
+    if (num_slices > 1) {
+        properties[ESScanReader::KEY_SLICE_ID] = std::to_string(slice_id);
+        properties[ESScanReader::KEY_SLICE_MAX] = std::to_string(num_slices);
+    }
+    if (_push_down_aggregation) {
+        properties[ESScanReader::KEY_QUERY]
+            = ESAggReader::build_query(properties, _aggregation, _predicates);
+    } else {
+        properties[ESScanReader::KEY_QUERY] 
+            = ESScrollQueryBuilder::build(properties, _column_names, _predicates);
+    }
 
     // start scanner to scan
     std::unique_ptr<EsHttpScanner> scanner(new EsHttpScanner(
                     _runtime_state, runtime_profile(), _tuple_id,
-                    properties, scanner_expr_ctxs, &counter));
+                    properties, scanner_expr_ctxs, &counter,
+                    _push_down_aggregation ? &_aggregation : nullptr));
     status = scanner_scan(std::move(scanner), scanner_expr_ctxs, &counter);
     if (!status.ok()) {
-        LOG(WARNING) << "Scanner[" << start_idx << "] process failed. status="
+        LOG(WARNING) << "Scanner[" << range_idx << ", slice " << slice_id
+            << "] process failed. status="
             << status.get_error_msg();
     }
 
@@ -439,7 +489,5 @@ void EsHttpScanNode::scanner_worker(int start_idx, int length, std::promise<Stat
     if (!status.ok()) {
         _queue_writer_cond.notify_all();
     }
-
-    p_status.set_value(status);
 }
 }
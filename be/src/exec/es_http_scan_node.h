@@ -70,8 +70,9 @@ private:
     // Create scanners to do scan job
     Status start_scanners();
 
-    // One scanner worker, This scanner will hanle 'length' ranges start from start_idx
-    void scanner_worker(int start_idx, int length, std::promise<Status>& p_status);
+    // One scanner worker, it reads the slice 'slice_id' of 'num_slices' of the
+    // shard of the range 'range_idx'
+    void scanner_worker(int range_idx, int slice_id, int num_slices);
 
     // Scan one range
     Status scanner_scan(std::unique_ptr<EsHttpScanner> scanner,
@@ -95,6 +96,9 @@ private:
 
     std::vector<std::thread> _scanner_threads;
     std::map<std::string, std::string> _properties;
+    // the aggregation above this scan evaluated by elasticsearch
+    bool _push_down_aggregation;
+    TEsAggregation _aggregation;
     std::vector<TScanRangeParams> _scan_ranges;
     std::vector<std::string> _column_names;
 
@@ -36,7 +36,8 @@ EsHttpScanner::EsHttpScanner(
             TupleId tuple_id,
             const std::map<std::string, std::string>& properties,
             const std::vector<ExprContext*>& conjunct_ctxs,
-            EsScanCounter* counter) :
+            EsScanCounter* counter,
+            const TEsAggregation* aggregation) :
         _state(state),
         _profile(profile),
         _tuple_id(tuple_id),
@@ -56,6 +57,7 @@ EsHttpScanner::EsHttpScanner(
         _counter(counter),
         _es_reader(nullptr),
         _es_scroll_parser(nullptr),
+        _aggregation(aggregation),
         _rows_read_counter(nullptr),
         _read_timer(nullptr),
         _materialize_timer(nullptr) {
@@ -74,12 +76,17 @@ Status EsHttpScanner::open() {
     }
 
     const std::string& host = _properties.at(ESScanReader::KEY_HOST_PORT);
-    _es_reader.reset(new ESScanReader(host, _properties));
-    if (_es_reader == nullptr) {
-        return Status("Es reader construct failed.");
-    }
+    if (_aggregation != nullptr) {
+        _es_agg_reader.reset(new ESAggReader(host, _properties, *_aggregation));
+        RETURN_IF_ERROR(_es_agg_reader->open(_tuple_desc));
+    } else {
+        _es_reader.reset(new ESScanReader(host, _properties));
+        if (_es_reader == nullptr) {
+            return Status("Es reader construct failed.");
+        }
 
-    RETURN_IF_ERROR(_es_reader->open());
+        RETURN_IF_ERROR(_es_reader->open());
+    }
 
     _rows_read_counter = ADD_COUNTER(_profile, "RowsRead", TUnit::UNIT);
     _read_timer = ADD_TIMER(_profile, "TotalRawReadTime(*)");
@@ -90,6 +97,13 @@ Status EsHttpScanner::open() {
 
 Status EsHttpScanner::get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof) {
     SCOPED_TIMER(_read_timer);
+    if (_es_agg_reader != nullptr) {
+        RETURN_IF_ERROR(_es_agg_reader->get_next(tuple, tuple_pool, eof));
+        if (!*eof) {
+            COUNTER_UPDATE(_rows_read_counter, 1);
+        }
+        return Status::OK;
+    }
     if (_line_eof && _batch_eof) {
         *eof = true;
         return Status::OK;
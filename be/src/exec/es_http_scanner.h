@@ -26,6 +26,7 @@
 
 #include "common/status.h"
 #include "common/global_types.h"
+#include "exec/es/es_agg_reader.h"
 #include "exec/es/es_scan_reader.h"
 #include "gen_cpp/PlanNodes_types.h"
 #include "gen_cpp/Types_types.h"
@@ -61,7 +62,8 @@ public:
         TupleId tuple_id,
         const std::map<std::string, std::string>& properties,
         const std::vector<ExprContext*>& conjunct_ctxs,
-        EsScanCounter* counter);
+        EsScanCounter* counter,
+        const TEsAggregation* aggregation = nullptr);
     ~EsHttpScanner();
 
     Status open();
@@ -92,6 +94,9 @@ private:
     EsScanCounter* _counter;
     std::unique_ptr<ESScanReader> _es_reader;
     std::unique_ptr<ScrollParser> _es_scroll_parser;
+    // set if the rows are the buckets of an aggregation instead of documents
+    const TEsAggregation* _aggregation;
+    std::unique_ptr<ESAggReader> _es_agg_reader;
 
     // Profile
     RuntimeProfile::Counter* _rows_read_counter;
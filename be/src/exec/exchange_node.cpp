@@ -87,7 +87,7 @@ Status ExchangeNode::open(RuntimeState* state) {
         TupleRowComparator less_than(_sort_exec_exprs, _is_asc_order, _nulls_first);
         // create_merger() will populate its merging heap with batches from the _stream_recvr,
         // so it is not necessary to call fill_input_row_batch().
-        RETURN_IF_ERROR(_stream_recvr->create_merger(less_than));
+        RETURN_IF_ERROR(_stream_recvr->create_merger(less_than, state));
     } else {
         RETURN_IF_ERROR(fill_input_row_batch(state));
     }
@@ -104,13 +104,14 @@ Status ExchangeNode::close(RuntimeState* state) {
     if (is_closed()) {
         return Status::OK;
     }
-    if (_is_merging) {
-        _sort_exec_exprs.close(state);
-    }
+    // the merge threads of the receiver evaluate clones of the sort exprs
     if (_stream_recvr != NULL) {
         _stream_recvr->close();
     }
     _stream_recvr.reset();
+    if (_is_merging) {
+        _sort_exec_exprs.close(state);
+    }
     return ExecNode::close(state);
 }
 
@@ -25,6 +25,7 @@
 #include "codegen/codegen_anyval.h"
 #include "common/object_pool.h"
 #include "common/status.h"
+#include "exprs/expr_column.h"
 #include "exprs/expr_context.h"
 #include "exec/aggregation_node.h"
 #include "exec/partitioned_aggregation_node.h"
@@ -34,6 +35,7 @@
 #include "exec/es_http_scan_node.h"
 #include "exec/pre_aggregation_node.h"
 #include "exec/hash_join_node.h"
+#include "exec/partitioned_hash_join_node.h"
 #include "exec/broker_scan_node.h"
 #include "exec/cross_join_node.h"
 #include "exec/empty_set_node.h"
@@ -204,7 +206,8 @@ Status ExecNode::prepare(RuntimeState* state) {
 
 Status ExecNode::open(RuntimeState* state) {
     RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::OPEN));
-    return Expr::open(_conjunct_ctxs, state);
+    RETURN_IF_ERROR(Expr::open(_conjunct_ctxs, state));
+    return ExprContext::share_subexprs(state, _conjunct_ctxs);
 }
 
 
@@ -386,6 +389,9 @@ Status ExecNode::create_node(RuntimeState* state, ObjectPool* pool, const TPlanN
     case TPlanNodeType::AGGREGATION_NODE:
         if (config::enable_partitioned_aggregation) {
             *node = pool->add(new PartitionedAggregationNode(pool, tnode, descs));
+        } else if (config::parallel_aggregation_num_threads > 1
+                && !tnode.agg_node.grouping_exprs.empty()) {
+            *node = pool->add(new AggregationNode(pool, tnode, descs));
         } else if (config::enable_new_partitioned_aggregation) {
             *node = pool->add(new NewPartitionedAggregationNode(pool, tnode, descs));
         } else {
@@ -397,7 +403,11 @@ Status ExecNode::create_node(RuntimeState* state, ObjectPool* pool, const TPlanN
           *node = pool->add(new PreAggregationNode(pool, tnode, descs));
           return Status::OK;*/
     case TPlanNodeType::HASH_JOIN_NODE:
-        *node = pool->add(new HashJoinNode(pool, tnode, descs));
+        if (config::enable_partitioned_hash_join) {
+            *node = pool->add(new PartitionedHashJoinNode(pool, tnode, descs));
+        } else {
+            *node = pool->add(new HashJoinNode(pool, tnode, descs));
+        }
         return Status::OK;
 
     case TPlanNodeType::CROSS_JOIN_NODE:
@@ -501,6 +511,8 @@ void ExecNode::debug_string(int indentation_level, std::stringstream* out) const
 }
 
 bool ExecNode::eval_conjuncts(ExprContext* const* ctxs, int num_ctxs, TupleRow* row) {
+    // the conjuncts compute their common subexprs once for the row
+    ExprContext::SubexprScope scope(num_ctxs > 0 ? ctxs[0] : nullptr);
     for (int i = 0; i < num_ctxs; ++i) {
         BooleanVal v = ctxs[i]->get_boolean_val(row);
         if (v.is_null || !v.val) {
@@ -510,6 +522,44 @@ bool ExecNode::eval_conjuncts(ExprContext* const* ctxs, int num_ctxs, TupleRow*
     return true;
 }
 
+Status ExecNode::filter_batch(const std::vector<ExprContext*>& ctxs, RowBatch* batch,
+                              std::vector<int>* sel, ExprColumn* result) {
+    int n = batch->num_rows();
+    if (ctxs.empty() || n == 0) {
+        return Status::OK;
+    }
+    sel->resize(n);
+    int* rows = sel->data();
+    for (int i = 0; i < n; ++i) {
+        rows[i] = i;
+    }
+    for (ExprContext* ctx : ctxs) {
+        RETURN_IF_ERROR(ctx->evaluate(batch, rows, n, result));
+        const bool* values = result->values<bool>();
+        const uint8_t* nulls = result->nulls();
+        int num_passed = 0;
+        for (int k = 0; k < n; ++k) {
+            int i = rows[k];
+            rows[num_passed] = i;
+            num_passed += !nulls[i] & values[i];
+        }
+        n = num_passed;
+        if (n == 0) {
+            break;
+        }
+    }
+    ExprContext::free_local_allocations(ctxs);
+
+    // the kept rows only move towards the front
+    for (int k = 0; k < n; ++k) {
+        if (rows[k] != k) {
+            batch->copy_row(batch->get_row(rows[k]), batch->get_row(k));
+        }
+    }
+    batch->set_num_rows(n);
+    return Status::OK;
+}
+
 void ExecNode::collect_nodes(TPlanNodeType::type node_type, vector<ExecNode*>* nodes) {
     if (_type == node_type) {
         nodes->push_back(this);
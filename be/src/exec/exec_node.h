@@ -38,6 +38,7 @@ class Function;
 namespace doris {
 
 class Expr;
+class ExprColumn;
 class ExprContext;
 class ObjectPool;
 class Counters;
@@ -163,6 +164,12 @@ public:
     // out how to deal with declaring a templated std:vector type in IR
     static bool eval_conjuncts(ExprContext* const* ctxs, int num_ctxs, TupleRow* row);
 
+    // Evaluates 'ctxs' over all the rows of 'batch' a batch at a time, and keeps in
+    // place the rows for which all of them return true, in their order. 'sel' and
+    // 'result' are scratch space of the caller.
+    static Status filter_batch(const std::vector<ExprContext*>& ctxs, RowBatch* batch,
+                               std::vector<int>* sel, ExprColumn* result);
+
     // Returns a string representation in DFS order of the plan rooted at this.
     std::string debug_string() const;
 
@@ -34,6 +34,18 @@ public:
     // is set to zero.
     virtual Status read(uint8_t* buf, size_t* buf_len, bool* eof) = 0;
 
+    // Read at most 'nbytes' at 'position' to 'out', it doesn't move the
+    // position of read(). 'bytes_read' is less than 'nbytes' only at the end
+    // of file. Used by columnar formats which read parts of a file.
+    virtual Status readat(int64_t position, int64_t nbytes, int64_t* bytes_read, void* out) {
+        return Status("readat is not supported by this reader");
+    }
+
+    // Get the size of the whole file
+    virtual Status size(int64_t* size) {
+        return Status("size is not supported by this reader");
+    }
+
     virtual void close() = 0;
 };
 
@@ -20,12 +20,17 @@
 #include <sstream>
 
 #include "codegen/llvm_codegen.h"
+#include "common/config.h"
 #include "exec/hash_table.hpp"
+#include "exec/join_runtime_filters.h"
 #include "exprs/expr.h"
 #include "exprs/in_predicate.h"
 #include "exprs/slot_ref.h"
+#include "runtime/exec_env.h"
 #include "runtime/row_batch.h"
+#include "runtime/runtime_filter.h"
 #include "runtime/runtime_state.h"
+#include "runtime/shared_hash_table_mgr.h"
 #include "util/runtime_profile.h"
 #include "gen_cpp/PlanNodes_types.h"
 
@@ -42,6 +47,9 @@ HashJoinNode::HashJoinNode(
         ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs) :
             ExecNode(pool, tnode, descs),
             _join_op(tnode.hash_join_node.join_op),
+            _join_hash_tbl(NULL),
+            _is_shared_builder(false),
+            _build_row_idx(-1),
             _probe_eos(false),
             _codegen_process_build_batch_fn(NULL),
             _process_build_batch_fn(NULL),
@@ -53,6 +61,8 @@ HashJoinNode::HashJoinNode(
     _match_all_build =
         (_join_op == TJoinOp::RIGHT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN);
     _is_push_down = tnode.hash_join_node.is_push_down;
+    _is_broadcast = tnode.hash_join_node.__isset.is_broadcast
+        && tnode.hash_join_node.is_broadcast;
 }
 
 HashJoinNode::~HashJoinNode() {
@@ -77,6 +87,12 @@ Status HashJoinNode::init(const TPlanNode& tnode, RuntimeState* state) {
         Expr::create_expr_trees(_pool, tnode.hash_join_node.other_join_conjuncts,
                               &_other_join_conjunct_ctxs));
 
+    if (tnode.hash_join_node.__isset.runtime_filters) {
+        RETURN_IF_ERROR(JoinRuntimeFilters::check(tnode.hash_join_node.runtime_filters,
+                                                   _build_expr_ctxs.size()));
+        _runtime_filter_descs = tnode.hash_join_node.runtime_filters;
+    }
+
     return Status::OK;
 }
 
@@ -100,6 +116,8 @@ Status HashJoinNode::prepare(RuntimeState* state) {
         ADD_COUNTER(runtime_profile(), "ProbeRows", TUnit::UNIT);
     _hash_tbl_load_factor_counter =
         ADD_COUNTER(runtime_profile(), "LoadFactor", TUnit::DOUBLE_VALUE);
+    _runtime_filter_timer =
+        ADD_TIMER(runtime_profile(), "RuntimeFilterTime");
 
     // build and probe exprs are evaluated in the context of the rows produced by our
     // right and left children, respectively
@@ -135,12 +153,34 @@ Status HashJoinNode::prepare(RuntimeState* state) {
         || _join_op == TJoinOp::FULL_OUTER_JOIN
         || _join_op == TJoinOp::RIGHT_ANTI_JOIN
         || _join_op == TJoinOp::RIGHT_SEMI_JOIN;
+    _probe_batch.reset(new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
+    if (config::enable_normalized_join_hash_table && !stores_nulls
+            && JoinHashTable::can_normalize_keys(_build_expr_ctxs, _probe_expr_ctxs)) {
+        // these joins only check whether a probe row has a match, the pushed
+        // down predicates are built from the build rows
+        const bool keys_only = config::enable_keys_only_join_hash_table
+            && (_join_op == TJoinOp::LEFT_SEMI_JOIN || _join_op == TJoinOp::LEFT_ANTI_JOIN)
+            && _other_join_conjunct_ctxs.empty() && !_is_push_down;
+        // nothing to codegen, the keys are not evaluated row by row
+        if (_is_broadcast && config::enable_shared_broadcast_join_hash_table) {
+            _shared_build = state->exec_env()->shared_hash_table_mgr()->get_or_create(
+                state->query_id(), id(), _build_expr_ctxs, _build_tuple_size, id(),
+                state->exec_env()->process_mem_tracker(), keys_only, &_is_shared_builder);
+            _join_hash_tbl = _shared_build->table();
+            add_runtime_exec_option(_is_shared_builder
+                                    ? "Shared Hash Table Builder" : "Shared Hash Table");
+        } else {
+            _local_join_hash_tbl.reset(new JoinHashTable(
+                    _build_expr_ctxs, _build_tuple_size, id(), mem_tracker(), keys_only));
+            _join_hash_tbl = _local_join_hash_tbl.get();
+        }
+        add_runtime_exec_option(keys_only ? "Normalized Join Keys Only" : "Normalized Join Keys");
+        return Status::OK;
+    }
     _hash_tbl.reset(new HashTable(
             _build_expr_ctxs, _probe_expr_ctxs, _build_tuple_size,
             stores_nulls, id(), mem_tracker(), 1024));
 
-    _probe_batch.reset(new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
-
     if (state->codegen_level() > 0) {
         if (_join_op == TJoinOp::LEFT_ANTI_JOIN) {
             return Status::OK;
@@ -190,9 +230,26 @@ Status HashJoinNode::close(RuntimeState* state) {
         COUNTER_UPDATE(_memory_used_counter, _build_pool->peak_allocated_bytes());
         COUNTER_UPDATE(_memory_used_counter, _hash_tbl->byte_size());
     }
+    if (_memory_used_counter != NULL && _local_join_hash_tbl.get() != NULL) {
+        COUNTER_UPDATE(_memory_used_counter, _build_pool->peak_allocated_bytes());
+        COUNTER_UPDATE(_memory_used_counter, _local_join_hash_tbl->byte_size());
+    }
     if (_hash_tbl.get() != NULL) {
         _hash_tbl->close();
     }
+    if (_local_join_hash_tbl.get() != NULL) {
+        _local_join_hash_tbl->close();
+    }
+    if (_shared_build != nullptr) {
+        if (_is_shared_builder) {
+            // the others must not wait for rows this instance will not add,
+            // it is a no-op if the table is built already
+            _shared_build->build(Status::CANCELLED);
+        }
+        // the last instance using the table frees it
+        _join_hash_tbl = NULL;
+        _shared_build.reset();
+    }
     if (_build_pool.get() != NULL) {
         _build_pool->free_all();
     }
@@ -218,10 +275,44 @@ void HashJoinNode::build_side_thread(RuntimeState* state, boost::promise<Status>
 }
 
 Status HashJoinNode::construct_hash_table(RuntimeState* state) {
+    if (_shared_build != nullptr && !_is_shared_builder) {
+        // the builder receives the same rows, this instance only helps it to
+        // build the table. Closing the build child drops the rows sent to it,
+        // so that the senders are not blocked.
+        RETURN_IF_ERROR(child(1)->close(state));
+        SCOPED_TIMER(_build_timer);
+        RETURN_IF_ERROR(_shared_build->wait(state));
+        COUNTER_SET(_build_rows_counter, _join_hash_tbl->size());
+        COUNTER_SET(_build_buckets_counter, _join_hash_tbl->num_buckets());
+        COUNTER_SET(_hash_tbl_load_factor_counter, _join_hash_tbl->load_factor());
+        return Status::OK;
+    }
+
+    Status status = add_build_rows(state);
+    if (_join_hash_tbl != NULL) {
+        SCOPED_TIMER(_build_timer);
+        if (_shared_build != nullptr) {
+            // the others are told about a failure as well
+            RETURN_IF_ERROR(_shared_build->build(status));
+        } else {
+            RETURN_IF_ERROR(status);
+            _join_hash_tbl->build();
+        }
+        COUNTER_SET(_build_rows_counter, _join_hash_tbl->size());
+        COUNTER_SET(_build_buckets_counter, _join_hash_tbl->num_buckets());
+        COUNTER_SET(_hash_tbl_load_factor_counter, _join_hash_tbl->load_factor());
+    }
+    return status;
+}
+
+Status HashJoinNode::add_build_rows(RuntimeState* state) {
     // Do a full scan of child(1) and store everything in _hash_tbl
     // The hash join node needs to keep in memory all build tuples, including the tuple
     // row ptrs.  The row ptrs are copied into the hash table's internal structure so they
     // don't need to be stored in the _build_pool.
+    // tuples of a shared table outlive this instance
+    MemPool* build_pool =
+        _shared_build != nullptr ? _shared_build->build_pool() : _build_pool.get();
     RowBatch build_batch(child(1)->row_desc(), state->batch_size(), mem_tracker());
     RETURN_IF_ERROR(child(1)->open(state));
 
@@ -230,22 +321,32 @@ Status HashJoinNode::construct_hash_table(RuntimeState* state) {
         bool eos = true;
         RETURN_IF_ERROR(child(1)->get_next(state, &build_batch, &eos));
         SCOPED_TIMER(_build_timer);
-        // take ownership of tuple data of build_batch
-        _build_pool->acquire_data(build_batch.tuple_data_pool(), false);
+        // take ownership of tuple data of build_batch, a keys only table copies
+        // the keys
+        if (_join_hash_tbl == NULL || !_join_hash_tbl->keys_only()) {
+            build_pool->acquire_data(build_batch.tuple_data_pool(), false);
+        }
         RETURN_IF_LIMIT_EXCEEDED(state);
 
-        // Call codegen version if possible
-        if (_process_build_batch_fn == NULL) {
-            process_build_batch(&build_batch);
+        if (_join_hash_tbl != NULL) {
+            _join_hash_tbl->add_batch(_build_expr_ctxs, &build_batch);
         } else {
-            _process_build_batch_fn(this, &build_batch);
-        }
+            // Call codegen version if possible
+            if (_process_build_batch_fn == NULL) {
+                process_build_batch(&build_batch);
+                if (_codegen_process_build_batch_fn != NULL) {
+                    state->codegen()->add_interpreted_rows(_hash_tbl->size());
+                }
+            } else {
+                _process_build_batch_fn(this, &build_batch);
+            }
 
-        VLOG_ROW << _hash_tbl->debug_string(true, &child(1)->row_desc());
+            VLOG_ROW << _hash_tbl->debug_string(true, &child(1)->row_desc());
 
-        COUNTER_SET(_build_rows_counter, _hash_tbl->size());
-        COUNTER_SET(_build_buckets_counter, _hash_tbl->num_buckets());
-        COUNTER_SET(_hash_tbl_load_factor_counter, _hash_tbl->load_factor());
+            COUNTER_SET(_build_rows_counter, _hash_tbl->size());
+            COUNTER_SET(_build_buckets_counter, _hash_tbl->num_buckets());
+            COUNTER_SET(_hash_tbl_load_factor_counter, _hash_tbl->load_factor());
+        }
         build_batch.reset();
 
         if (eos) {
@@ -256,6 +357,56 @@ Status HashJoinNode::construct_hash_table(RuntimeState* state) {
     return Status::OK;
 }
 
+void HashJoinNode::publish_runtime_filters(RuntimeState* state) {
+    if (_runtime_filter_descs.empty() || !JoinRuntimeFilters::filters_probe(_join_op)) {
+        return;
+    }
+    SCOPED_TIMER(_runtime_filter_timer);
+
+    std::vector<std::unique_ptr<RuntimeFilter>> filters;
+    JoinRuntimeFilters::create(_runtime_filter_descs, _build_expr_ctxs, num_build_rows(),
+                               &filters);
+
+    HashTable::Iterator iter;
+    if (_hash_tbl.get() != NULL) {
+        iter = _hash_tbl->begin();
+    }
+    // the values of the keys are in their normalized bytes
+    if (_join_hash_tbl != NULL && _join_hash_tbl->keys_only()) {
+        _join_hash_tbl->for_each_key([&](const uint8_t* key) {
+            for (int i = 0; i < filters.size(); ++i) {
+                if (filters[i] != nullptr) {
+                    int expr_order = _runtime_filter_descs[i].expr_order;
+                    filters[i]->insert(key + _join_hash_tbl->key_offset(expr_order));
+                }
+            }
+        });
+    }
+    for (int64_t idx = 0; _join_hash_tbl == NULL || !_join_hash_tbl->keys_only(); ++idx) {
+        TupleRow* row = NULL;
+        if (_join_hash_tbl != NULL) {
+            if (idx == _join_hash_tbl->size()) {
+                break;
+            }
+            row = _join_hash_tbl->get_row(idx);
+        } else {
+            if (!iter.has_next()) {
+                break;
+            }
+            row = iter.get_row();
+            iter.next<false>();
+        }
+        for (int i = 0; i < filters.size(); ++i) {
+            if (filters[i] != nullptr) {
+                int expr_order = _runtime_filter_descs[i].expr_order;
+                filters[i]->insert(_build_expr_ctxs[expr_order]->get_value(row));
+            }
+        }
+    }
+
+    JoinRuntimeFilters::publish(state, _runtime_filter_descs, filters);
+}
+
 Status HashJoinNode::open(RuntimeState* state) {
     RETURN_IF_ERROR(ExecNode::open(state));
     RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::OPEN));
@@ -291,52 +442,54 @@ Status HashJoinNode::open(RuntimeState* state) {
         // the hash table is fully constructed and we can start the probe
         // phase.
         RETURN_IF_ERROR(thread_status.get_future().get());
+        publish_runtime_filters(state);
 
-        if (_hash_tbl->size() == 0 && _join_op == TJoinOp::INNER_JOIN) {
+        if (num_build_rows() == 0 && _join_op == TJoinOp::INNER_JOIN) {
             // Hash table size is zero
             LOG(INFO) << "No element need to push down, no need to read probe table";
             RETURN_IF_ERROR(child(0)->open(state));
             _probe_batch_pos = 0;
-            _hash_tbl_iterator = _hash_tbl->begin();
+            if (_hash_tbl.get() != NULL) {
+                _hash_tbl_iterator = _hash_tbl->begin();
+            }
             _eos = true;
             return Status::OK;
         }
 
-        if (_hash_tbl->size() > 1024) {
+        if (num_build_rows() > 1024) {
             _is_push_down = false;
         }
 
         // TODO: this is used for Code Check, Remove this later
         if (_is_push_down || 0 != child(1)->conjunct_ctxs().size()) {
             for (int i = 0; i < _probe_expr_ctxs.size(); ++i) {
-                TExprNode node;
-                node.__set_node_type(TExprNodeType::IN_PRED);
-                TScalarType tscalar_type;
-                tscalar_type.__set_type(TPrimitiveType::BOOLEAN);
-                TTypeNode ttype_node;
-                ttype_node.__set_type(TTypeNodeType::SCALAR);
-                ttype_node.__set_scalar_type(tscalar_type);
-                TTypeDesc t_type_desc;
-                t_type_desc.types.push_back(ttype_node);
-                node.__set_type(t_type_desc);
-                node.in_predicate.__set_is_not_in(false);
-                node.__set_opcode(TExprOpcode::FILTER_IN);
-                node.__isset.vector_opcode = true;
-                node.__set_vector_opcode(to_in_opcode(_probe_expr_ctxs[i]->root()->type().type));
-                // NOTE(zc): in predicate only used here, no need prepare.
-                InPredicate* in_pred = _pool->add(new InPredicate(node));
-                RETURN_IF_ERROR(in_pred->prepare(state, _probe_expr_ctxs[i]->root()->type()));
-                in_pred->add_child(Expr::copy(_pool, _probe_expr_ctxs[i]->root()));
-                ExprContext* ctx = _pool->add(new ExprContext(in_pred));
+                ExprContext* ctx = nullptr;
+                RETURN_IF_ERROR(JoinRuntimeFilters::create_in_predicate(
+                        _pool, state, _probe_expr_ctxs[i], &ctx));
                 _push_down_expr_ctxs.push_back(ctx);
             }
 
             {
                 SCOPED_TIMER(_push_compute_timer);
-                HashTable::Iterator iter = _hash_tbl->begin();
+                HashTable::Iterator iter;
+                if (_hash_tbl.get() != NULL) {
+                    iter = _hash_tbl->begin();
+                }
 
-                while (iter.has_next()) {
-                    TupleRow* row  = iter.get_row();
+                for (int64_t idx = 0; ; ++idx) {
+                    TupleRow* row = NULL;
+                    if (_join_hash_tbl != NULL) {
+                        if (idx == _join_hash_tbl->size()) {
+                            break;
+                        }
+                        row = _join_hash_tbl->get_row(idx);
+                    } else {
+                        if (!iter.has_next()) {
+                            break;
+                        }
+                        row = iter.get_row();
+                        iter.next<false>();
+                    }
                     std::list<ExprContext*>::iterator ctx_iter = _push_down_expr_ctxs.begin();
 
                     for (int i = 0; i < _build_expr_ctxs.size(); ++i, ++ctx_iter) {
@@ -346,7 +499,6 @@ Status HashJoinNode::open(RuntimeState* state) {
                     }
 
                     SCOPED_TIMER(_build_timer);
-                    iter.next<false>();
                 }
             }
 
@@ -375,6 +527,8 @@ Status HashJoinNode::open(RuntimeState* state) {
         // If this return first, build thread will use 'thread_status'
         // which is already destructor and then coredump.
         RETURN_IF_ERROR(open_status);
+        // the probe child does not scan before the first get_next()
+        publish_runtime_filters(state);
     }
 
     // seed probe batch and _current_probe_row, etc.
@@ -385,7 +539,9 @@ Status HashJoinNode::open(RuntimeState* state) {
 
         if (_probe_batch->num_rows() == 0) {
             if (_probe_eos) {
-                _hash_tbl_iterator = _hash_tbl->begin();
+                if (_hash_tbl.get() != NULL) {
+                    _hash_tbl_iterator = _hash_tbl->begin();
+                }
                 _eos = true;
                 break;
             }
@@ -396,7 +552,12 @@ Status HashJoinNode::open(RuntimeState* state) {
             _current_probe_row = _probe_batch->get_row(_probe_batch_pos++);
             VLOG_ROW << "probe row: " << get_probe_row_output_string(_current_probe_row);
             _matched_probe = false;
-            _hash_tbl_iterator = _hash_tbl->find(_current_probe_row);
+            if (_join_hash_tbl != NULL) {
+                _join_hash_tbl->find_batch(_probe_expr_ctxs, _probe_batch.get(), &_probe_matches);
+                _build_row_idx = _probe_matches.first_match(0);
+            } else {
+                _hash_tbl_iterator = _hash_tbl->find(_current_probe_row);
+            }
             break;
         }
     }
@@ -663,10 +824,18 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state,
         }
 
         // Continue processing this row batch
-        if (_process_probe_batch_fn == NULL) {
+        if (_join_hash_tbl != NULL) {
+            _num_rows_returned +=
+                process_probe_batch_normalized(out_batch, _probe_batch.get(), max_added_rows);
+            COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+        } else if (_process_probe_batch_fn == NULL) {
             _num_rows_returned +=
                 process_probe_batch(out_batch, _probe_batch.get(), max_added_rows);
             COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+            if (_codegen_process_build_batch_fn != NULL) {
+                // the probe function is only generated with the build one
+                state->codegen()->add_interpreted_rows(_probe_rows_counter->value());
+            }
         } else {
             // Use codegen'd function
             _num_rows_returned +=
@@ -680,7 +849,7 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state,
         }
 
         // Check to see if we're done processing the current probe batch
-        if (!_hash_tbl_iterator.has_next() && _probe_batch_pos == _probe_batch->num_rows()) {
+        if (probe_row_done() && _probe_batch_pos == _probe_batch->num_rows()) {
             _probe_batch->transfer_resource_ownership(out_batch);
             _probe_batch_pos = 0;
 
@@ -696,6 +865,10 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state,
                 RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
                 probe_timer.start();
                 COUNTER_UPDATE(_probe_rows_counter, _probe_batch->num_rows());
+                if (_join_hash_tbl != NULL) {
+                    _join_hash_tbl->find_batch(
+                        _probe_expr_ctxs, _probe_batch.get(), &_probe_matches);
+                }
             }
         }
     }
@@ -703,6 +876,102 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state,
     return Status::OK;
 }
 
+int HashJoinNode::process_probe_batch_normalized(RowBatch* out_batch, RowBatch* probe_batch,
+                                                 int max_added_rows) {
+    int row_idx = out_batch->add_rows(max_added_rows);
+    DCHECK(row_idx != RowBatch::INVALID_ROW_INDEX);
+    uint8_t* out_row_mem = reinterpret_cast<uint8_t*>(out_batch->get_row(row_idx));
+    TupleRow* out_row = reinterpret_cast<TupleRow*>(out_row_mem);
+
+    int rows_returned = 0;
+    int probe_rows = probe_batch->num_rows();
+
+    ExprContext* const* other_conjunct_ctxs = &_other_join_conjunct_ctxs[0];
+    int num_other_conjunct_ctxs = _other_join_conjunct_ctxs.size();
+
+    ExprContext* const* conjunct_ctxs = &_conjunct_ctxs[0];
+    int num_conjunct_ctxs = _conjunct_ctxs.size();
+
+    while (true) {
+        // Create output row for each matching build row
+        while (_build_row_idx >= 0) {
+            TupleRow* matched_build_row = _join_hash_tbl->get_row(_build_row_idx);
+            _build_row_idx = _join_hash_tbl->next_match(_build_row_idx);
+            create_output_row(out_row, _current_probe_row, matched_build_row);
+
+            if (!eval_conjuncts(other_conjunct_ctxs, num_other_conjunct_ctxs, out_row)) {
+                continue;
+            }
+
+            _matched_probe = true;
+
+            // left_anti_join: equal match won't return
+            if (_join_op == TJoinOp::LEFT_ANTI_JOIN) {
+                _build_row_idx = -1;
+                break;
+            }
+
+            if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+                ++rows_returned;
+
+                // Filled up out batch or hit limit
+                if (UNLIKELY(rows_returned == max_added_rows)) {
+                    goto end;
+                }
+
+                // Advance to next out row
+                out_row_mem += out_batch->row_byte_size();
+                out_row = reinterpret_cast<TupleRow*>(out_row_mem);
+            }
+
+            // Handle left semi-join
+            if (_match_one_build) {
+                _build_row_idx = -1;
+                break;
+            }
+        }
+
+        // Handle left outer-join and left anti-join
+        if (!_matched_probe && (_match_all_probe || _join_op == TJoinOp::LEFT_ANTI_JOIN)) {
+            create_output_row(out_row, _current_probe_row, NULL);
+            _matched_probe = true;
+
+            if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+                ++rows_returned;
+
+                if (UNLIKELY(rows_returned == max_added_rows)) {
+                    goto end;
+                }
+
+                // Advance to next out row
+                out_row_mem += out_batch->row_byte_size();
+                out_row = reinterpret_cast<TupleRow*>(out_row_mem);
+            }
+        }
+
+        if (_build_row_idx < 0) {
+            // Advance to the next probe row, whose matches were found with the batch
+            if (UNLIKELY(_probe_batch_pos == probe_rows)) {
+                goto end;
+            }
+
+            _current_probe_row = probe_batch->get_row(_probe_batch_pos);
+            _build_row_idx = _probe_matches.first_match(_probe_batch_pos);
+            ++_probe_batch_pos;
+            _matched_probe = false;
+        }
+    }
+
+end:
+
+    if (_match_one_build && _matched_probe) {
+        _build_row_idx = -1;
+    }
+
+    out_batch->commit_rows(rows_returned);
+    return rows_returned;
+}
+
 string HashJoinNode::get_probe_row_output_string(TupleRow* probe_row) {
     std::stringstream out;
     out << "[";
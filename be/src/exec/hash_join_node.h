@@ -21,16 +21,19 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/thread.hpp>
+#include <memory>
 #include <string>
 
 #include "exec/exec_node.h"
 #include "exec/hash_table.h"
+#include "exec/join_hash_table.h"
 #include "gen_cpp/PlanNodes_types.h"
 
 namespace doris {
 
 class MemPool;
 class RowBatch;
+class SharedJoinBuild;
 class TupleRow;
 
 // Node for in-memory hash joins:
@@ -66,6 +69,21 @@ protected:
 private:
     boost::scoped_ptr<HashTable> _hash_tbl;
     HashTable::Iterator _hash_tbl_iterator;
+    // used instead of _hash_tbl by the joins not returning build rows when the
+    // join keys can be normalized, see JoinHashTable. It is either
+    // _local_join_hash_tbl or the table of _shared_build.
+    JoinHashTable* _join_hash_tbl;
+    boost::scoped_ptr<JoinHashTable> _local_join_hash_tbl;
+    // set if the build side is broadcast and the table is built once for all
+    // the instances of this node on the backend
+    std::shared_ptr<SharedJoinBuild> _shared_build;
+    // true if this instance adds the build rows of _shared_build
+    bool _is_shared_builder;
+    // matches of the rows of _probe_batch in _join_hash_tbl
+    JoinHashTable::ProbeBatch _probe_matches;
+    // next build row of _join_hash_tbl matching _current_probe_row, -1 if none
+    int32_t _build_row_idx;
+    bool _is_broadcast;
     bool _is_push_down;
 
     // for right outer joins, keep track of what's been joined
@@ -80,6 +98,9 @@ private:
     std::vector<ExprContext*> _build_expr_ctxs;
     std::list<ExprContext*> _push_down_expr_ctxs;
 
+    // filters built from the build side for the scans of the probe side
+    std::vector<TRuntimeFilterDesc> _runtime_filter_descs;
+
     // non-equi-join conjuncts from the JOIN clause
     std::vector<ExprContext*> _other_join_conjunct_ctxs;
 
@@ -138,6 +159,7 @@ private:
     RuntimeProfile::Counter* _probe_rows_counter;   // num probe rows
     RuntimeProfile::Counter* _build_buckets_counter;   // num buckets in hash table
     RuntimeProfile::Counter* _hash_tbl_load_factor_counter;
+    RuntimeProfile::Counter* _runtime_filter_timer;
 
     // Supervises ConstructHashTable in a separate thread, and
     // returns its status in the promise parameter.
@@ -149,6 +171,15 @@ private:
     // same time.
     Status construct_hash_table(RuntimeState* state);
 
+    // Reads the build rows from child(1) into the hash table, which is not
+    // built yet if it is a JoinHashTable.
+    Status add_build_rows(RuntimeState* state);
+
+    // Builds the runtime filters from the rows of the hash table and
+    // publishes them to their target scans. They only filter rows, so they
+    // are not published when they fail to be built or sent.
+    void publish_runtime_filters(RuntimeState* state);
+
     // GetNext helper function for the common join cases: Inner join, left semi and left
     // outer
     Status left_join_get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
@@ -161,6 +192,21 @@ private:
     // return the number of rows added to out_batch
     int process_probe_batch(RowBatch* out_batch, RowBatch* probe_batch, int max_added_rows);
 
+    // process_probe_batch() for _join_hash_tbl, it must have found the rows of
+    // 'probe_batch'
+    int process_probe_batch_normalized(RowBatch* out_batch, RowBatch* probe_batch,
+                                       int max_added_rows);
+
+    // Returns true if the current probe row has no more matches to process.
+    bool probe_row_done() {
+        return _join_hash_tbl != NULL ? _build_row_idx < 0 : !_hash_tbl_iterator.has_next();
+    }
+
+    // Number of rows in the hash table.
+    int64_t num_build_rows() const {
+        return _join_hash_tbl != NULL ? _join_hash_tbl->size() : _hash_tbl->size();
+    }
+
     // Construct the build hash table, adding all the rows in 'build_batch'
     void process_build_batch(RowBatch* build_batch);
 
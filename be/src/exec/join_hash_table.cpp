@@ -0,0 +1,401 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/join_hash_table.h"
+
+#include <emmintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "common/logging.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/tuple_row.h"
+#include "util/hash_util.hpp"
+
+namespace doris {
+
+// rows whose groups are prefetched ahead of the inserted row
+static const int PREFETCH_DISTANCE = 8;
+// a keys only table becomes a bitmap if it has at least one key per that many bits
+static const uint64_t MAX_BITS_PER_BITMAP_KEY = 64;
+
+static bool has_normalized_value(PrimitiveType type) {
+    switch (type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_DECIMALV2:
+        return true;
+    default:
+        // floats have two zeros, the other types have padding or several
+        // representations of a value
+        return false;
+    }
+}
+
+bool JoinHashTable::can_normalize_keys(const std::vector<ExprContext*>& build_expr_ctxs,
+                                       const std::vector<ExprContext*>& probe_expr_ctxs) {
+    if (build_expr_ctxs.empty() || build_expr_ctxs.size() != probe_expr_ctxs.size()) {
+        return false;
+    }
+    int key_size = 0;
+    for (int i = 0; i < build_expr_ctxs.size(); ++i) {
+        const TypeDescriptor& type = build_expr_ctxs[i]->root()->type();
+        if (!has_normalized_value(type.type)
+                || probe_expr_ctxs[i]->root()->type().type != type.type) {
+            return false;
+        }
+        key_size += type.get_slot_size();
+    }
+    return key_size <= MAX_KEY_SIZE;
+}
+
+JoinHashTable::JoinHashTable(const std::vector<ExprContext*>& build_expr_ctxs,
+                             int num_build_tuples, uint32_t seed, MemTracker* mem_tracker,
+                             bool keys_only) :
+        _num_build_tuples(num_build_tuples),
+        _seed(seed),
+        _mem_tracker(mem_tracker),
+        _key_size(0),
+        _consumed_bytes(0),
+        _keys_only(keys_only),
+        _is_integer_key(false),
+        _num_added_rows(0),
+        _use_bitmap(false),
+        _bitmap_min(0),
+        _bitmap_range(0) {
+    for (auto ctx : build_expr_ctxs) {
+        _key_offsets.push_back(_key_size);
+        _key_sizes.push_back(ctx->root()->type().get_slot_size());
+        _key_size += _key_sizes.back();
+    }
+    DCHECK_LE(_key_size, MAX_KEY_SIZE);
+    _slot_size = (sizeof(int32_t) + _key_size + 3) & ~3;
+    if (build_expr_ctxs.size() == 1) {
+        PrimitiveType type = build_expr_ctxs[0]->root()->type().type;
+        _is_integer_key = type == TYPE_TINYINT || type == TYPE_SMALLINT
+            || type == TYPE_INT || type == TYPE_BIGINT;
+    }
+    if (_keys_only) {
+        // build row 0, which every key finds
+        _rows.assign(_num_build_tuples, NULL);
+        _next_rows.assign(1, -1);
+    }
+}
+
+JoinHashTable::~JoinHashTable() {
+}
+
+void JoinHashTable::close() {
+    for (auto& partition : _partitions) {
+        free(partition.tags);
+        free(partition.slots);
+        partition = Partition();
+    }
+    std::vector<Tuple*>().swap(_rows);
+    std::vector<int32_t>().swap(_next_rows);
+    std::vector<uint64_t>().swap(_key_bitmap);
+    _use_bitmap = false;
+    finish_build();
+    _mem_tracker->release(_consumed_bytes);
+    _consumed_bytes = 0;
+}
+
+int64_t JoinHashTable::num_buckets() const {
+    int64_t num_slots = 0;
+    for (auto& partition : _partitions) {
+        num_slots += partition.num_slots;
+    }
+    return num_slots;
+}
+
+float JoinHashTable::load_factor() const {
+    int64_t num_keys = 0;
+    for (auto& partition : _partitions) {
+        num_keys += partition.num_keys;
+    }
+    int64_t num_slots = num_buckets();
+    return num_slots == 0 ? 0 : num_keys / static_cast<float>(num_slots);
+}
+
+int64_t JoinHashTable::byte_size() const {
+    return num_buckets() * (1 + _slot_size) + _rows.capacity() * sizeof(Tuple*)
+        + _next_rows.capacity() * sizeof(int32_t) + _row_keys.capacity()
+        + _row_hashes.capacity() * sizeof(uint64_t)
+        + (_partition_rows.capacity() + _partition_offsets.capacity()) * sizeof(int32_t)
+        + _key_bitmap.capacity() * sizeof(uint64_t);
+}
+
+void JoinHashTable::update_mem_usage() {
+    int64_t bytes = byte_size();
+    _mem_tracker->consume(bytes - _consumed_bytes);
+    _consumed_bytes = bytes;
+}
+
+uint64_t JoinHashTable::hash_key(const uint8_t* key) const {
+    return HashUtil::murmur_hash2_64(key, _key_size, _seed);
+}
+
+bool JoinHashTable::eval_key(const std::vector<ExprContext*>& ctxs, TupleRow* row,
+                             uint8_t* key) const {
+    for (int i = 0; i < ctxs.size(); ++i) {
+        void* value = ctxs[i]->get_value(row);
+        if (value == NULL) {
+            return false;
+        }
+        memcpy(key + _key_offsets[i], value, _key_sizes[i]);
+    }
+    return true;
+}
+
+int64_t JoinHashTable::integer_key(const uint8_t* key) const {
+    switch (_key_size) {
+    case 1:
+        return *reinterpret_cast<const int8_t*>(key);
+    case 2:
+        return *reinterpret_cast<const int16_t*>(key);
+    case 4:
+        return *reinterpret_cast<const int32_t*>(key);
+    default:
+        return *reinterpret_cast<const int64_t*>(key);
+    }
+}
+
+void JoinHashTable::add_batch(const std::vector<ExprContext*>& build_expr_ctxs,
+                              RowBatch* batch) {
+    DCHECK(_partition_offsets.empty()) << "rows are added after the build";
+    for (int i = 0; i < batch->num_rows(); ++i) {
+        TupleRow* row = batch->get_row(i);
+        size_t key_offset = _row_keys.size();
+        _row_keys.resize(key_offset + _key_size);
+        if (!eval_key(build_expr_ctxs, row, &_row_keys[key_offset])) {
+            _row_keys.resize(key_offset);
+            continue;
+        }
+        _row_hashes.push_back(hash_key(&_row_keys[key_offset]));
+        if (_keys_only) {
+            ++_num_added_rows;
+            continue;
+        }
+        for (int j = 0; j < _num_build_tuples; ++j) {
+            _rows.push_back(row->get_tuple(j));
+        }
+        _next_rows.push_back(-1);
+    }
+    DCHECK_LE(_row_hashes.size(), static_cast<size_t>(INT32_MAX));
+    update_mem_usage();
+}
+
+void JoinHashTable::prepare_build() {
+    // counting sort of the rows by partition, which keeps their order
+    int64_t num_rows = _row_hashes.size();
+    _partition_offsets.assign(NUM_PARTITIONS + 1, 0);
+    for (int64_t i = 0; i < num_rows; ++i) {
+        ++_partition_offsets[partition_of(_row_hashes[i]) + 1];
+    }
+    for (int i = 0; i < NUM_PARTITIONS; ++i) {
+        _partition_offsets[i + 1] += _partition_offsets[i];
+    }
+    _partition_rows.resize(num_rows);
+    std::vector<int32_t> positions(_partition_offsets.begin(), _partition_offsets.end() - 1);
+    for (int64_t i = 0; i < num_rows; ++i) {
+        _partition_rows[positions[partition_of(_row_hashes[i])]++] = i;
+    }
+
+    // the rows of a partition fill at most 7/8 of its slots
+    for (int i = 0; i < NUM_PARTITIONS; ++i) {
+        Partition& partition = _partitions[i];
+        int64_t num_partition_rows = _partition_offsets[i + 1] - _partition_offsets[i];
+        int64_t num_slots = GROUP_SIZE;
+        while (num_slots / 8 * 7 < num_partition_rows) {
+            num_slots *= 2;
+        }
+        partition.num_slots = num_slots;
+        partition.group_mask = num_slots / GROUP_SIZE - 1;
+        // the tags of a group are loaded aligned
+        if (posix_memalign(reinterpret_cast<void**>(&partition.tags), GROUP_SIZE,
+                           num_slots) != 0) {
+            LOG(FATAL) << "fail to allocate tags of join hash table, num_slots=" << num_slots;
+        }
+        memset(partition.tags, EMPTY, num_slots);
+        partition.slots = reinterpret_cast<uint8_t*>(malloc(num_slots * _slot_size));
+    }
+    update_mem_usage();
+}
+
+int64_t JoinHashTable::find_slot(const Partition& partition, const uint8_t* key,
+                                 uint64_t hash, bool* found) const {
+    const __m128i tag = _mm_set1_epi8(static_cast<char>(hash & 0x7F));
+    int64_t group = (hash >> 7) & partition.group_mask;
+    // triangular probing visits every group since their number is a power of 2
+    for (int64_t step = 1; ; ++step) {
+        const uint8_t* tags = partition.tags + group * GROUP_SIZE;
+        __m128i group_tags = _mm_load_si128(reinterpret_cast<const __m128i*>(tags));
+        uint32_t matches = _mm_movemask_epi8(_mm_cmpeq_epi8(group_tags, tag));
+        for (; matches != 0; matches &= matches - 1) {
+            int64_t slot = group * GROUP_SIZE + __builtin_ctz(matches);
+            if (memcmp(slot_key(partition, slot), key, _key_size) == 0) {
+                *found = true;
+                return slot;
+            }
+        }
+        // only EMPTY has the high bit set, and there are no removals, so the key
+        // would be in the first empty slot
+        uint32_t empties = _mm_movemask_epi8(group_tags);
+        if (empties != 0) {
+            *found = false;
+            return group * GROUP_SIZE + __builtin_ctz(empties);
+        }
+        group = (group + step) & partition.group_mask;
+    }
+}
+
+void JoinHashTable::build_partition(int partition_idx) {
+    Partition& partition = _partitions[partition_idx];
+    const int32_t* rows = _partition_rows.data() + _partition_offsets[partition_idx];
+    int64_t num_rows = _partition_offsets[partition_idx + 1] - _partition_offsets[partition_idx];
+    for (int64_t i = 0; i < num_rows; ++i) {
+        if (i + PREFETCH_DISTANCE < num_rows) {
+            prefetch(_row_hashes[rows[i + PREFETCH_DISTANCE]]);
+        }
+        int32_t row_idx = rows[i];
+        const uint8_t* key = &_row_keys[static_cast<size_t>(row_idx) * _key_size];
+        uint64_t hash = _row_hashes[row_idx];
+        bool found = false;
+        int64_t slot = find_slot(partition, key, hash, &found);
+        int32_t* head = slot_head(partition, slot);
+        if (_keys_only) {
+            if (!found) {
+                partition.tags[slot] = hash & 0x7F;
+                memcpy(slot_key(partition, slot), key, _key_size);
+                ++partition.num_keys;
+                *head = 0;
+            }
+            continue;
+        }
+        if (found) {
+            _next_rows[row_idx] = *head;
+        } else {
+            partition.tags[slot] = hash & 0x7F;
+            memcpy(slot_key(partition, slot), key, _key_size);
+            ++partition.num_keys;
+        }
+        *head = row_idx;
+    }
+}
+
+void JoinHashTable::finish_build() {
+    if (_keys_only && _is_integer_key && !_partition_offsets.empty()) {
+        try_build_bitmap();
+    }
+    std::vector<uint8_t>().swap(_row_keys);
+    std::vector<uint64_t>().swap(_row_hashes);
+    std::vector<int32_t>().swap(_partition_rows);
+    std::vector<int32_t>().swap(_partition_offsets);
+    update_mem_usage();
+}
+
+void JoinHashTable::try_build_bitmap() {
+    int64_t num_keys = 0;
+    int64_t min_key = INT64_MAX;
+    int64_t max_key = INT64_MIN;
+    for_each_key([&](const uint8_t* key) {
+        int64_t value = integer_key(key);
+        min_key = std::min(min_key, value);
+        max_key = std::max(max_key, value);
+        ++num_keys;
+    });
+    if (num_keys == 0) {
+        return;
+    }
+    uint64_t range = static_cast<uint64_t>(max_key) - static_cast<uint64_t>(min_key) + 1;
+    // the range of BIGINT keys overflows to 0
+    if (range == 0 || range / MAX_BITS_PER_BITMAP_KEY > static_cast<uint64_t>(num_keys)) {
+        return;
+    }
+    _key_bitmap.assign((range + 63) / 64, 0);
+    for_each_key([&](const uint8_t* key) {
+        uint64_t bit = static_cast<uint64_t>(integer_key(key)) - static_cast<uint64_t>(min_key);
+        _key_bitmap[bit / 64] |= 1ULL << (bit % 64);
+    });
+    _bitmap_min = min_key;
+    _bitmap_range = range;
+    _use_bitmap = true;
+    for (auto& partition : _partitions) {
+        free(partition.tags);
+        free(partition.slots);
+        partition = Partition();
+    }
+}
+
+void JoinHashTable::find_batch(const std::vector<ExprContext*>& probe_expr_ctxs,
+                               RowBatch* batch, ProbeBatch* probe) const {
+    int num_rows = batch->num_rows();
+    if (_use_bitmap) {
+        probe->_matches.resize(num_rows);
+        uint8_t key[sizeof(int64_t)];
+        for (int i = 0; i < num_rows; ++i) {
+            probe->_matches[i] = -1;
+            if (!eval_key(probe_expr_ctxs, batch->get_row(i), key)) {
+                continue;
+            }
+            uint64_t bit = static_cast<uint64_t>(integer_key(key))
+                - static_cast<uint64_t>(_bitmap_min);
+            if (bit < _bitmap_range && ((_key_bitmap[bit / 64] >> (bit % 64)) & 1)) {
+                probe->_matches[i] = 0;
+            }
+        }
+        return;
+    }
+    probe->_keys.resize(static_cast<size_t>(num_rows) * _key_size);
+    probe->_hashes.resize(num_rows);
+    probe->_valid.resize(num_rows);
+    probe->_matches.resize(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+        uint8_t* key = &probe->_keys[static_cast<size_t>(i) * _key_size];
+        probe->_valid[i] = eval_key(probe_expr_ctxs, batch->get_row(i), key);
+        if (probe->_valid[i]) {
+            probe->_hashes[i] = hash_key(key);
+            prefetch(probe->_hashes[i]);
+        }
+    }
+    for (int i = 0; i < num_rows; ++i) {
+        probe->_matches[i] = -1;
+        if (!probe->_valid[i]) {
+            continue;
+        }
+        uint64_t hash = probe->_hashes[i];
+        const Partition& partition = _partitions[partition_of(hash)];
+        bool found = false;
+        int64_t slot = find_slot(partition, &probe->_keys[static_cast<size_t>(i) * _key_size],
+                                 hash, &found);
+        if (found) {
+            probe->_matches[i] = *slot_head(partition, slot);
+        }
+    }
+}
+
+}
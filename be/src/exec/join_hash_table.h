@@ -0,0 +1,287 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_EXEC_JOIN_HASH_TABLE_H
+#define DORIS_BE_SRC_EXEC_JOIN_HASH_TABLE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+namespace doris {
+
+class ExprContext;
+class MemTracker;
+class RowBatch;
+class Tuple;
+class TupleRow;
+
+// Hash table of the build rows of a hash join whose keys have a fixed width.
+//
+// The values of the join exprs of a row are copied one after the other into a
+// normalized key of a few bytes, two rows join iff their keys have the same bytes.
+// The table is open addressing: every slot holds a key and the index of the last
+// build row with that key, the other rows of the key are chained by their
+// indices. Slots are in groups of 16 which have a tag byte per slot, the low 7
+// bits of the hash of its key or EMPTY. A lookup compares the tags of a whole
+// group with SSE2 and only reads the keys whose tag matches, so it usually
+// touches one group of tags and one slot.
+//
+// The table is made of NUM_PARTITIONS sub-tables picked by the high bits of the
+// hash. All the rows are added first, then the sub-tables are built, with their
+// final size, independently of each other, so that several threads can build
+// them at the same time. Once built the table is not changed, and can be
+// probed by several threads, each with its own ProbeBatch.
+//
+// Rows are probed a RowBatch at a time: the keys and hashes of all the rows are
+// computed and their groups prefetched first, so the cache misses of the rows
+// overlap instead of being taken one after another.
+//
+// Rows with a NULL key are not added and match no row. Only the tuple pointers
+// of the build rows are copied, the tuples must outlive the table.
+//
+// A keys only table is for the joins that only check whether a probe row has a
+// match, it keeps no build rows: their tuples need not outlive the table, and
+// every key is found as the single build row 0, whose tuples are all NULL.
+// If the key is a single integer whose distinct values are dense, the built
+// table is a bitmap of the values above the smallest one.
+class JoinHashTable {
+public:
+    // max byte size of a normalized key
+    static const int MAX_KEY_SIZE = 32;
+    static const int NUM_PARTITIONS = 16;
+
+    // The matches of the rows of a probe batch.
+    class ProbeBatch {
+    public:
+        // Returns the index of the first build row matching row 'probe_idx' of the
+        // batch, -1 if there is no match.
+        int32_t first_match(int probe_idx) const {
+            return _matches[probe_idx];
+        }
+
+    private:
+        friend class JoinHashTable;
+
+        std::vector<uint8_t> _keys;
+        std::vector<uint64_t> _hashes;
+        std::vector<uint8_t> _valid;
+        std::vector<int32_t> _matches;
+    };
+
+    // Returns true if the rows of the exprs can be joined by their normalized keys:
+    // both sides have the same types, of which equal values have equal bytes.
+    static bool can_normalize_keys(const std::vector<ExprContext*>& build_expr_ctxs,
+                                   const std::vector<ExprContext*>& probe_expr_ctxs);
+
+    // The keys are laid out after the types of 'build_expr_ctxs', which are
+    // not kept; rows are evaluated with the exprs passed to each call.
+    JoinHashTable(const std::vector<ExprContext*>& build_expr_ctxs,
+                  int num_build_tuples, uint32_t seed, MemTracker* mem_tracker,
+                  bool keys_only = false);
+
+    ~JoinHashTable();
+
+    // Call to cleanup any resources. Must be called once.
+    void close();
+
+    // Adds the rows of 'batch' which have no NULL key. They are not found
+    // before the table is built.
+    void add_batch(const std::vector<ExprContext*>& build_expr_ctxs, RowBatch* batch);
+
+    // Distributes the added rows to the partitions and allocates them. No rows
+    // can be added after it.
+    void prepare_build();
+
+    // Inserts the rows of 'partition' into its sub-table. Different partitions
+    // can be built by different threads at the same time.
+    void build_partition(int partition);
+
+    // Frees the keys of the added rows, once all partitions are built. Turns a
+    // keys only table into a bitmap if dense enough.
+    void finish_build();
+
+    // Builds all the partitions from this thread.
+    void build() {
+        prepare_build();
+        for (int i = 0; i < NUM_PARTITIONS; ++i) {
+            build_partition(i);
+        }
+        finish_build();
+    }
+
+    // Looks up all the rows of 'batch', which are evaluated with 'probe_expr_ctxs'.
+    void find_batch(const std::vector<ExprContext*>& probe_expr_ctxs, RowBatch* batch,
+                    ProbeBatch* probe) const;
+
+    // Returns the index of the next build row with the key of build row
+    // 'row_idx', -1 if there is none.
+    int32_t next_match(int32_t row_idx) const {
+        return _next_rows[row_idx];
+    }
+
+    TupleRow* get_row(int32_t row_idx) const {
+        return reinterpret_cast<TupleRow*>(const_cast<Tuple**>(
+                &_rows[static_cast<size_t>(row_idx) * _num_build_tuples]));
+    }
+
+    // number of build rows
+    int64_t size() const {
+        return _keys_only ? _num_added_rows : _next_rows.size();
+    }
+
+    bool keys_only() const {
+        return _keys_only;
+    }
+
+    // Calls 'fn' with every distinct key of a built keys only table. The value of
+    // the join expr i is at key + key_offset(i).
+    template<typename Fn>
+    void for_each_key(Fn fn) const;
+
+    int key_offset(int expr_idx) const {
+        return _key_offsets[expr_idx];
+    }
+
+    int64_t num_buckets() const;
+
+    // number of distinct keys / number of slots
+    float load_factor() const;
+
+    int64_t byte_size() const;
+
+private:
+    static const int GROUP_SIZE = 16;
+    // tag of the slots without key
+    static const uint8_t EMPTY = 0x80;
+
+    struct Partition {
+        int64_t num_slots = 0;
+        int64_t group_mask = 0;
+        int64_t num_keys = 0;
+        // tags of the slots, num_slots bytes aligned to 16 bytes
+        uint8_t* tags = nullptr;
+        uint8_t* slots = nullptr;
+    };
+
+    // Returns false if the key of 'row' is NULL.
+    bool eval_key(const std::vector<ExprContext*>& ctxs, TupleRow* row, uint8_t* key) const;
+
+    uint64_t hash_key(const uint8_t* key) const;
+
+    static int partition_of(uint64_t hash) {
+        return hash >> 60;
+    }
+
+    // Returns the slot of 'key', or the empty slot where it would be inserted
+    // if it is not in the table, in which case *found is false.
+    int64_t find_slot(const Partition& partition, const uint8_t* key, uint64_t hash,
+                      bool* found) const;
+
+    uint8_t* slot_key(const Partition& partition, int64_t slot) const {
+        return partition.slots + slot * _slot_size + sizeof(int32_t);
+    }
+
+    int32_t* slot_head(const Partition& partition, int64_t slot) const {
+        return reinterpret_cast<int32_t*>(partition.slots + slot * _slot_size);
+    }
+
+    void prefetch(uint64_t hash) const {
+        const Partition& partition = _partitions[partition_of(hash)];
+        int64_t group = (hash >> 7) & partition.group_mask;
+        __builtin_prefetch(partition.tags + group * GROUP_SIZE);
+        __builtin_prefetch(partition.slots + group * GROUP_SIZE * _slot_size);
+    }
+
+    // Consumes the memory allocated since the last call from _mem_tracker.
+    void update_mem_usage();
+
+    // the value of an integer key
+    int64_t integer_key(const uint8_t* key) const;
+
+    // Replaces the partitions of a keys only table with _key_bitmap if its
+    // values are dense.
+    void try_build_bitmap();
+
+    const int _num_build_tuples;
+    const uint32_t _seed;
+    MemTracker* _mem_tracker;
+
+    // offset and size of the value of each expr in the normalized key
+    std::vector<int> _key_offsets;
+    std::vector<int> _key_sizes;
+    int _key_size;
+    // the head row index followed by the key, aligned to 4 bytes
+    int _slot_size;
+
+    Partition _partitions[NUM_PARTITIONS];
+
+    // _num_build_tuples tuple pointers per build row
+    std::vector<Tuple*> _rows;
+    // _next_rows[i] is the previous build row with the key of row i, or -1
+    std::vector<int32_t> _next_rows;
+
+    // keys and hashes of the added rows until the table is built
+    std::vector<uint8_t> _row_keys;
+    std::vector<uint64_t> _row_hashes;
+    // the rows of partition i are _partition_rows[_partition_offsets[i],
+    // _partition_offsets[i + 1])
+    std::vector<int32_t> _partition_rows;
+    std::vector<int32_t> _partition_offsets;
+
+    int64_t _consumed_bytes;
+
+    const bool _keys_only;
+    // the key is a single TINYINT, SMALLINT, INT or BIGINT
+    bool _is_integer_key;
+    int64_t _num_added_rows;
+    // set in a keys only table instead of the partitions: bit i is set if
+    // _bitmap_min + i is a key
+    bool _use_bitmap;
+    int64_t _bitmap_min;
+    uint64_t _bitmap_range;
+    std::vector<uint64_t> _key_bitmap;
+};
+
+template<typename Fn>
+void JoinHashTable::for_each_key(Fn fn) const {
+    if (_use_bitmap) {
+        uint8_t key[sizeof(int64_t)];
+        for (uint64_t i = 0; i < _bitmap_range; ++i) {
+            if ((_key_bitmap[i / 64] >> (i % 64)) & 1) {
+                // the low bytes are the value of the narrower types
+                int64_t value = _bitmap_min + static_cast<int64_t>(i);
+                memcpy(key, &value, _key_size);
+                fn(static_cast<const uint8_t*>(key));
+            }
+        }
+        return;
+    }
+    for (auto& partition : _partitions) {
+        for (int64_t slot = 0; slot < partition.num_slots; ++slot) {
+            if (partition.tags[slot] != EMPTY) {
+                fn(static_cast<const uint8_t*>(slot_key(partition, slot)));
+            }
+        }
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/join_runtime_filters.h"
+
+#include <deque>
+#include <sstream>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "exprs/in_predicate.h"
+#include "runtime/exec_env.h"
+#include "runtime/runtime_filter.h"
+#include "runtime/runtime_filter_mgr.h"
+#include "runtime/runtime_state.h"
+#include "service/backend_options.h"
+#include "util/brpc_stub_cache.h"
+#include "util/ref_count_closure.h"
+
+namespace doris {
+
+Status JoinRuntimeFilters::check(const std::vector<TRuntimeFilterDesc>& descs, int num_exprs) {
+    for (auto& desc : descs) {
+        if (desc.expr_order < 0 || desc.expr_order >= num_exprs) {
+            std::stringstream ss;
+            ss << "invalid expr order of runtime filter " << desc.filter_id
+                << ", expr_order=" << desc.expr_order;
+            return Status(ss.str());
+        }
+    }
+    return Status::OK;
+}
+
+bool JoinRuntimeFilters::filters_probe(TJoinOp::type join_op) {
+    return join_op == TJoinOp::INNER_JOIN || join_op == TJoinOp::LEFT_SEMI_JOIN
+        || join_op == TJoinOp::RIGHT_OUTER_JOIN || join_op == TJoinOp::RIGHT_SEMI_JOIN;
+}
+
+void JoinRuntimeFilters::create(const std::vector<TRuntimeFilterDesc>& descs,
+                                const std::vector<ExprContext*>& build_expr_ctxs,
+                                int64_t num_build_rows,
+                                std::vector<std::unique_ptr<RuntimeFilter>>* filters) {
+    filters->clear();
+    filters->resize(descs.size());
+    for (int i = 0; i < descs.size(); ++i) {
+        const TRuntimeFilterDesc& desc = descs[i];
+        PrimitiveType type = build_expr_ctxs[desc.expr_order]->root()->type().type;
+        if (!RuntimeFilter::is_supported(type)) {
+            continue;
+        }
+        (*filters)[i].reset(new RuntimeFilter(type));
+        Status st = (*filters)[i]->init(desc.__isset.bloom_filter_entries
+                                        ? desc.bloom_filter_entries : num_build_rows);
+        if (!st.ok()) {
+            LOG(WARNING) << "fail to init runtime filter " << desc.filter_id
+                << ", errmsg=" << st.get_error_msg();
+            (*filters)[i].reset();
+        }
+    }
+}
+
+void JoinRuntimeFilters::publish(RuntimeState* state,
+                                 const std::vector<TRuntimeFilterDesc>& descs,
+                                 const std::vector<std::unique_ptr<RuntimeFilter>>& filters) {
+    // sent to all targets at once, the filter is shared by their requests
+    std::vector<PRuntimeFilter> pfilters(filters.size());
+    std::deque<PPublishRuntimeFilterRequest> requests;
+    std::vector<RefCountClosure<PPublishRuntimeFilterResult>*> closures;
+    for (int i = 0; i < filters.size(); ++i) {
+        if (filters[i] == nullptr) {
+            continue;
+        }
+        const TRuntimeFilterDesc& desc = descs[i];
+        filters[i]->to_protobuf(&pfilters[i]);
+        for (auto& target : desc.targets) {
+            const TNetworkAddress& addr = target.target_fragment_instance_addr;
+            if (addr.hostname == BackendOptions::get_localhost()
+                    && addr.port == config::brpc_port) {
+                // a copy, the filter may have several targets on this backend
+                std::unique_ptr<RuntimeFilter> filter(new RuntimeFilter(filters[i]->type()));
+                if (filter->from_protobuf(pfilters[i]).ok()) {
+                    state->exec_env()->runtime_filter_mgr()->publish(
+                        target.target_fragment_instance_id, desc.filter_id, std::move(filter));
+                }
+                continue;
+            }
+            palo::PInternalService_Stub* stub =
+                state->exec_env()->brpc_stub_cache()->get_stub(addr);
+            if (stub == nullptr) {
+                LOG(WARNING) << "fail to get brpc stub to publish runtime filter, addr=" << addr;
+                continue;
+            }
+            requests.emplace_back();
+            PPublishRuntimeFilterRequest& request = requests.back();
+            request.mutable_finst_id()->set_hi(target.target_fragment_instance_id.hi);
+            request.mutable_finst_id()->set_lo(target.target_fragment_instance_id.lo);
+            request.set_filter_id(desc.filter_id);
+            request.set_allocated_filter(&pfilters[i]);
+
+            auto closure = new RefCountClosure<PPublishRuntimeFilterResult>();
+            closure->ref();
+            // This ref is for RPC's reference
+            closure->ref();
+            closure->cntl.set_timeout_ms(config::runtime_filter_rpc_timeout_ms);
+            stub->publish_runtime_filter(&closure->cntl, &request, &closure->result, closure);
+            closures.push_back(closure);
+        }
+    }
+    for (auto closure : closures) {
+        closure->join();
+        if (closure->cntl.Failed()) {
+            LOG(WARNING) << "fail to publish runtime filter, error="
+                << berror(closure->cntl.ErrorCode())
+                << ", error_text=" << closure->cntl.ErrorText();
+        }
+        if (closure->unref()) {
+            delete closure;
+        }
+    }
+    for (auto& request : requests) {
+        request.release_filter();
+    }
+}
+
+Status JoinRuntimeFilters::create_in_predicate(ObjectPool* pool, RuntimeState* state,
+                                               ExprContext* probe_expr_ctx, ExprContext** ctx) {
+    TExprNode node;
+    node.__set_node_type(TExprNodeType::IN_PRED);
+    TScalarType tscalar_type;
+    tscalar_type.__set_type(TPrimitiveType::BOOLEAN);
+    TTypeNode ttype_node;
+    ttype_node.__set_type(TTypeNodeType::SCALAR);
+    ttype_node.__set_scalar_type(tscalar_type);
+    TTypeDesc t_type_desc;
+    t_type_desc.types.push_back(ttype_node);
+    node.__set_type(t_type_desc);
+    node.in_predicate.__set_is_not_in(false);
+    node.__set_opcode(TExprOpcode::FILTER_IN);
+    node.__isset.vector_opcode = true;
+    node.__set_vector_opcode(to_in_opcode(probe_expr_ctx->root()->type().type));
+    // NOTE(zc): in predicate only used here, no need prepare.
+    InPredicate* in_pred = pool->add(new InPredicate(node));
+    RETURN_IF_ERROR(in_pred->prepare(state, probe_expr_ctx->root()->type()));
+    in_pred->add_child(Expr::copy(pool, probe_expr_ctx->root()));
+    *ctx = pool->add(new ExprContext(in_pred));
+    return Status::OK;
+}
+
+}
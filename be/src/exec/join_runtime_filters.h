@@ -0,0 +1,69 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_EXEC_JOIN_RUNTIME_FILTERS_H
+#define DORIS_BE_SRC_EXEC_JOIN_RUNTIME_FILTERS_H
+
+#include <memory>
+#include <vector>
+
+#include "common/status.h"
+#include "gen_cpp/PlanNodes_types.h"
+
+namespace doris {
+
+class ExprContext;
+class ObjectPool;
+class RuntimeFilter;
+class RuntimeState;
+
+// What the hash join nodes push to their probe side once the build side is
+// read: the runtime filters the planner assigned to them, and the IN predicates
+// over the build keys of is_push_down.
+class JoinRuntimeFilters {
+public:
+    // Checks that the filters refer to one of the 'num_exprs' equi-join conjuncts
+    static Status check(const std::vector<TRuntimeFilterDesc>& descs, int num_exprs);
+
+    // Probe rows matching no build row are only dropped by these joins, so only
+    // they can filter their probe side
+    static bool filters_probe(TJoinOp::type join_op);
+
+    // Creates the filters of 'descs' for 'build_expr_ctxs', sized for
+    // 'num_build_rows' unless the planner sized them. An entry is nullptr if
+    // the type of its expr is not supported.
+    static void create(const std::vector<TRuntimeFilterDesc>& descs,
+                       const std::vector<ExprContext*>& build_expr_ctxs,
+                       int64_t num_build_rows,
+                       std::vector<std::unique_ptr<RuntimeFilter>>* filters);
+
+    // Sends filters[i] to the targets of descs[i], those on this backend directly.
+    // Returns once all of them are sent, failures are only logged as the scans
+    // then read without the filter.
+    static void publish(RuntimeState* state, const std::vector<TRuntimeFilterDesc>& descs,
+                        const std::vector<std::unique_ptr<RuntimeFilter>>& filters);
+
+    // Creates an IN predicate over 'probe_expr_ctx' without values, they are
+    // inserted into its InPredicate root.
+    static Status create_in_predicate(ObjectPool* pool, RuntimeState* state,
+                                      ExprContext* probe_expr_ctx, ExprContext** ctx);
+};
+
+}
+
+#endif // DORIS_BE_SRC_EXEC_JOIN_RUNTIME_FILTERS_H
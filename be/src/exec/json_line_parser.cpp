@@ -0,0 +1,110 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/json_line_parser.h"
+
+#include <sstream>
+
+#include <rapidjson/error/en.h>
+
+namespace doris {
+
+static const size_t ALLOCATOR_BUFFER_SIZE = 64 * 1024;
+static const size_t PARSE_STACK_CAPACITY = 1024;
+
+JsonLineParser::JsonLineParser(const std::vector<std::string>& paths) :
+        _path_strs(paths),
+        _value_buffer(new char[ALLOCATOR_BUFFER_SIZE]),
+        _stack_buffer(new char[ALLOCATOR_BUFFER_SIZE]),
+        _value_allocator(_value_buffer.get(), ALLOCATOR_BUFFER_SIZE),
+        _stack_allocator(_stack_buffer.get(), ALLOCATOR_BUFFER_SIZE) {
+    for (auto& path : paths) {
+        std::vector<std::string> keys;
+        size_t start = 0;
+        if (path.compare(0, 2, "$.") == 0) {
+            start = 2;
+        }
+        while (true) {
+            size_t end = path.find('.', start);
+            if (end == std::string::npos) {
+                keys.push_back(path.substr(start));
+                break;
+            }
+            keys.push_back(path.substr(start, end - start));
+            start = end + 1;
+        }
+        _paths.push_back(std::move(keys));
+    }
+}
+
+bool JsonLineParser::parse(const Slice& line, std::vector<Slice>* values,
+                           std::vector<uint8_t>* is_null, std::string* error) {
+    // memory of the previous line is reused
+    _value_allocator.Clear();
+    _stack_allocator.Clear();
+    _buffer.assign(line.data, line.size);
+
+    Document doc(&_value_allocator, PARSE_STACK_CAPACITY, &_stack_allocator);
+    doc.ParseInsitu<rapidjson::kParseInsituFlag | rapidjson::kParseNumbersAsStringsFlag>(
+        &_buffer[0]);
+    if (doc.HasParseError()) {
+        std::stringstream ss;
+        ss << "invalid json: " << rapidjson::GetParseError_En(doc.GetParseError())
+            << " offset: " << doc.GetErrorOffset();
+        *error = ss.str();
+        return false;
+    }
+    if (!doc.IsObject()) {
+        *error = "json line is not an object";
+        return false;
+    }
+
+    values->resize(_paths.size());
+    is_null->assign(_paths.size(), 0);
+    for (int i = 0; i < _paths.size(); ++i) {
+        const Document::ValueType* value = &doc;
+        for (auto& key : _paths[i]) {
+            if (!value->IsObject()) {
+                value = nullptr;
+                break;
+            }
+            auto it = value->FindMember(
+                Document::ValueType(rapidjson::StringRef(key.data(), key.size())));
+            if (it == value->MemberEnd()) {
+                value = nullptr;
+                break;
+            }
+            value = &it->value;
+        }
+        if (value == nullptr || value->IsNull()) {
+            (*is_null)[i] = 1;
+        } else if (value->IsString()) {
+            // numbers are strings too
+            (*values)[i] = Slice(value->GetString(), value->GetStringLength());
+        } else if (value->IsBool()) {
+            (*values)[i] = Slice(value->GetBool() ? "1" : "0", 1);
+        } else {
+            std::stringstream ss;
+            ss << "value of json path " << _path_strs[i] << " is an object or an array";
+            *error = ss.str();
+            return false;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,65 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "util/slice.h"
+
+namespace doris {
+
+// Finds values of json paths in lines which are json objects. A line is
+// parsed in place in a copy of it, strings are unescaped in the copy and
+// numbers are kept as their text, and the parser only allocates from its
+// own buffers once they are large enough, so values are got without
+// allocations.
+class JsonLineParser {
+public:
+    // 'paths' are keys separated by '.', like "$.a.b" or "a.b"
+    JsonLineParser(const std::vector<std::string>& paths);
+
+    // Parse 'line' and find the value of every path. 'values' point into
+    // this parser until the next call, 'is_null' is set if a value is null
+    // or missing. Returns false and sets 'error' if 'line' is not a json
+    // object or a value is an object or an array.
+    bool parse(const Slice& line, std::vector<Slice>* values,
+               std::vector<uint8_t>* is_null, std::string* error);
+
+private:
+    typedef rapidjson::MemoryPoolAllocator<> Allocator;
+    typedef rapidjson::GenericDocument<rapidjson::UTF8<>, Allocator, Allocator> Document;
+
+    std::vector<std::string> _path_strs;
+    // keys of every path
+    std::vector<std::vector<std::string>> _paths;
+    // copy of the line parsed in place
+    std::string _buffer;
+
+    std::unique_ptr<char[]> _value_buffer;
+    std::unique_ptr<char[]> _stack_buffer;
+    Allocator _value_allocator;
+    Allocator _stack_allocator;
+};
+
+}
@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/line_chunk_splitter.h"
+
+#include <string.h>
+
+#include "exec/file_reader.h"
+
+namespace doris {
+
+LineChunkSplitter::LineChunkSplitter(
+        FileReader* reader, uint8_t line_delimiter, size_t chunk_size) :
+            _reader(reader),
+            _line_delimiter(line_delimiter),
+            _chunk_size(chunk_size),
+            _next_seq(0),
+            _eof(false) {
+}
+
+Status LineChunkSplitter::next_chunk(std::string* chunk, int64_t* seq) {
+    std::lock_guard<std::mutex> l(_lock);
+    chunk->clear();
+    chunk->swap(_remain);
+    *seq = _next_seq++;
+    while (!_eof) {
+        size_t offset = chunk->size();
+        chunk->resize(offset + _chunk_size);
+        size_t read_size = _chunk_size;
+        RETURN_IF_ERROR(_reader->read(
+                reinterpret_cast<uint8_t*>(&(*chunk)[offset]), &read_size, &_eof));
+        chunk->resize(offset + read_size);
+        // the remain of the previous chunk has no line delimiter
+        const char* last = reinterpret_cast<const char*>(
+            memrchr(chunk->data() + offset, _line_delimiter, read_size));
+        if (last != nullptr) {
+            size_t line_end = last - chunk->data() + 1;
+            _remain.assign(chunk->data() + line_end, chunk->size() - line_end);
+            chunk->resize(line_end);
+            break;
+        }
+    }
+    return Status::OK;
+}
+
+Status ChunkLineReader::read_line(const uint8_t** ptr, size_t* size, bool* eof) {
+    if (_ptr >= _end) {
+        *size = 0;
+        *eof = true;
+        return Status::OK;
+    }
+    const uint8_t* pos = reinterpret_cast<const uint8_t*>(
+        memchr(_ptr, _line_delimiter, _end - _ptr));
+    *ptr = _ptr;
+    if (pos == nullptr) {
+        *size = _end - _ptr;
+        _ptr = _end;
+    } else {
+        *size = pos - _ptr;
+        _ptr = pos + 1;
+    }
+    *eof = false;
+    return Status::OK;
+}
+
+}
@@ -0,0 +1,73 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+
+#include "common/status.h"
+#include "exec/line_reader.h"
+
+namespace doris {
+
+class FileReader;
+
+// Cuts the content of a reader into chunks which end with a line delimiter,
+// so that every chunk can be parsed by a different thread. Chunks are
+// numbered in the order of the content.
+// This class is thread safe.
+class LineChunkSplitter {
+public:
+    LineChunkSplitter(FileReader* reader, uint8_t line_delimiter, size_t chunk_size);
+
+    // Gets the next chunk of about 'chunk_size' bytes, it is only longer if a
+    // line is. The last chunk may not end with a line delimiter. An empty
+    // chunk means all the content has been read.
+    Status next_chunk(std::string* chunk, int64_t* seq);
+
+private:
+    FileReader* _reader;
+    uint8_t _line_delimiter;
+    size_t _chunk_size;
+
+    std::mutex _lock;
+    // bytes after the last line delimiter of the previous chunk
+    std::string _remain;
+    int64_t _next_seq;
+    bool _eof;
+};
+
+// Reads lines from a chunk in memory.
+class ChunkLineReader : public LineReader {
+public:
+    ChunkLineReader(const uint8_t* data, size_t size, uint8_t line_delimiter) :
+            _ptr(data), _end(data + size), _line_delimiter(line_delimiter) { }
+
+    Status read_line(const uint8_t** ptr, size_t* size, bool* eof) override;
+
+    void close() override { }
+
+private:
+    const uint8_t* _ptr;
+    const uint8_t* _end;
+    uint8_t _line_delimiter;
+};
+
+}
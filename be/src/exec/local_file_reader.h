@@ -37,6 +37,11 @@ public:
     // is set to zero.
     virtual Status read(uint8_t* buf, size_t* buf_len, bool* eof) override;
 
+    virtual Status readat(int64_t position, int64_t nbytes,
+                          int64_t* bytes_read, void* out) override;
+
+    virtual Status size(int64_t* size) override;
+
     virtual void close() override;
 private:
     std::string _path;
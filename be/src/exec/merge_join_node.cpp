@@ -22,6 +22,8 @@
 #include "exprs/expr.h"
 #include "exprs/in_predicate.h"
 #include "gen_cpp/PlanNodes_types.h"
+#include "runtime/mem_pool.h"
+#include "runtime/raw_value.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "util/debug_util.h"
@@ -48,6 +50,8 @@ int compare_value(const StringValue* left_value,  const StringValue* right_value
 MergeJoinNode::MergeJoinNode(
         ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs) :
             ExecNode(pool, tnode, descs),
+            _is_join(false),
+            _right_group_idx(0),
             _out_batch(NULL) {
 }
 
@@ -71,6 +75,13 @@ Status MergeJoinNode::init(const TPlanNode& tnode, RuntimeState* state) {
     RETURN_IF_ERROR(Expr::create_expr_trees(
             _pool, tnode.merge_join_node.other_join_conjuncts,
             &_other_join_conjunct_ctxs));
+
+    if (tnode.merge_join_node.__isset.join_op) {
+        if (tnode.merge_join_node.join_op != TJoinOp::INNER_JOIN) {
+            return Status("merge join only supports inner join.");
+        }
+        _is_join = true;
+    }
     return Status::OK;
 }
 
@@ -84,7 +95,8 @@ Status MergeJoinNode::prepare(RuntimeState* state) {
     RETURN_IF_ERROR(Expr::prepare(
             _right_expr_ctxs, state, child(1)->row_desc(), expr_mem_tracker()));
 
-    for (int i = 0; i < _left_expr_ctxs.size(); ++i) {
+    // the keys of a join are compared by RawValue::compare()
+    for (int i = 0; !_is_join && i < _left_expr_ctxs.size(); ++i) {
         switch (_left_expr_ctxs[i]->root()->type().type) {
         case TYPE_TINYINT:
             _cmp_func.push_back(compare_value<int8_t>);
@@ -137,6 +149,7 @@ Status MergeJoinNode::prepare(RuntimeState* state) {
             new ChildReaderContext(row_desc(), state->batch_size(), state->instance_mem_tracker()));
     _right_child_ctx.reset(
             new ChildReaderContext(row_desc(), state->batch_size(), state->instance_mem_tracker()));
+    _right_group_pool.reset(new MemPool(mem_tracker()));
 
     return Status::OK;
 }
@@ -149,6 +162,9 @@ Status MergeJoinNode::close(RuntimeState* state) {
     Expr::close(_left_expr_ctxs, state);
     Expr::close(_right_expr_ctxs, state);
     Expr::close(_other_join_conjunct_ctxs, state);
+    if (_right_group_pool.get() != NULL) {
+        _right_group_pool->free_all();
+    }
     return ExecNode::close(state);
 }
 
@@ -183,6 +199,11 @@ Status MergeJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* e
         return Status::OK;
     }
 
+    if (_is_join) {
+        _out_batch = out_batch;
+        return get_next_join(state, out_batch, eos);
+    }
+
     while (true) {
         int row_idx = out_batch->add_row();
         DCHECK(row_idx != RowBatch::INVALID_ROW_INDEX);
@@ -210,6 +231,112 @@ Status MergeJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* e
     return Status::OK;
 }
 
+Status MergeJoinNode::get_next_join(RuntimeState* state, RowBatch* out_batch, bool* eos) {
+    while (true) {
+        TupleRow* left_row = _left_child_ctx->current_row;
+        if (!_right_group.empty()) {
+            // the next left row may join the same right rows
+            if (_right_group_idx == 0
+                    && (left_row == NULL || compare_keys(left_row, _right_group[0]) != 0)) {
+                reset_right_group(out_batch);
+                continue;
+            }
+            while (_right_group_idx < _right_group.size()) {
+                int row_idx = out_batch->add_row();
+                DCHECK(row_idx != RowBatch::INVALID_ROW_INDEX);
+                TupleRow* row = out_batch->get_row(row_idx);
+                create_join_row(row, left_row, _right_group[_right_group_idx++]);
+
+                if (eval_conjuncts(&_other_join_conjunct_ctxs[0],
+                                   _other_join_conjunct_ctxs.size(), row)
+                        && eval_conjuncts(&_conjunct_ctxs[0], _conjunct_ctxs.size(), row)) {
+                    out_batch->commit_last_row();
+                    ++_num_rows_returned;
+                    COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+                }
+
+                if (out_batch->is_full() || out_batch->at_resource_limit() || reached_limit()) {
+                    return Status::OK;
+                }
+            }
+            _right_group_idx = 0;
+            RETURN_IF_ERROR(get_input_row(state, 0));
+            continue;
+        }
+
+        TupleRow* right_row = _right_child_ctx->current_row;
+        if (left_row == NULL || right_row == NULL) {
+            *eos = true;
+            _eos = true;
+            return Status::OK;
+        }
+
+        // NULL keys join nothing
+        if (has_null_key(0, left_row)) {
+            RETURN_IF_ERROR(get_input_row(state, 0));
+            continue;
+        }
+        if (has_null_key(1, right_row)) {
+            RETURN_IF_ERROR(get_input_row(state, 1));
+            continue;
+        }
+
+        int cmp_val = compare_keys(left_row, right_row);
+        if (cmp_val < 0) {
+            RETURN_IF_ERROR(get_input_row(state, 0));
+        } else if (cmp_val > 0) {
+            RETURN_IF_ERROR(get_input_row(state, 1));
+        } else {
+            // the right rows are copied, since the batches they are in are handed
+            // to the output while reading the rest of the group
+            const std::vector<TupleDescriptor*>& descs = child(1)->row_desc().tuple_descriptors();
+            do {
+                _right_group.push_back(right_row->deep_copy(descs, _right_group_pool.get()));
+                RETURN_IF_ERROR(get_input_row(state, 1));
+                right_row = _right_child_ctx->current_row;
+            } while (right_row != NULL && !has_null_key(1, right_row)
+                     && compare_keys(left_row, right_row) == 0);
+            _right_group_idx = 0;
+        }
+    }
+}
+
+bool MergeJoinNode::has_null_key(int child_idx, TupleRow* row) {
+    const std::vector<ExprContext*>& ctxs = child_idx == 0 ? _left_expr_ctxs : _right_expr_ctxs;
+    for (int i = 0; i < ctxs.size(); ++i) {
+        if (ctxs[i]->get_value(row) == NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int MergeJoinNode::compare_keys(TupleRow* left_row, TupleRow* right_row) {
+    for (int i = 0; i < _left_expr_ctxs.size(); ++i) {
+        void* left_value = _left_expr_ctxs[i]->get_value(left_row);
+        void* right_value = _right_expr_ctxs[i]->get_value(right_row);
+        int cmp_val = RawValue::compare(
+                left_value, right_value, _left_expr_ctxs[i]->root()->type());
+        if (cmp_val != 0) {
+            return cmp_val;
+        }
+    }
+    return 0;
+}
+
+void MergeJoinNode::create_join_row(TupleRow* out, TupleRow* left, TupleRow* right) {
+    memcpy(out, left, _left_tuple_size * sizeof(Tuple*));
+    for (int i = 0; i < _right_tuple_size; ++i) {
+        out->set_tuple(_right_tuple_idx[i], right->get_tuple(i));
+    }
+}
+
+void MergeJoinNode::reset_right_group(RowBatch* out_batch) {
+    _right_group.clear();
+    _right_group_idx = 0;
+    out_batch->tuple_data_pool()->acquire_data(_right_group_pool.get(), false);
+}
+
 void MergeJoinNode::create_output_row(TupleRow* out, TupleRow* left, TupleRow* right) {
     if (left == NULL) {
         memset(out, 0, _left_tuple_size);
@@ -34,6 +34,8 @@ class TupleRow;
 
 // Node for in-memory merge joins:
 // find the minimal tuple and output
+// If the plan sets a join op, the children return their rows sorted by the
+// cmp conjunct exprs and this node inner joins them on those exprs instead.
 class MergeJoinNode : public ExecNode {
 public:
     MergeJoinNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
@@ -63,6 +65,14 @@ private:
 
     bool _eos;            // if true, nothing left to return in get_next()
 
+    // true if the children are inner joined rather than merged
+    bool _is_join;
+    // the right rows of the key being joined, copied into _right_group_pool
+    std::vector<TupleRow*> _right_group;
+    boost::scoped_ptr<MemPool> _right_group_pool;
+    // index in _right_group of the next row to join with the current left row
+    int _right_group_idx;
+
     struct ChildReaderContext {
         RowBatch batch;
         int row_idx;
@@ -95,6 +105,16 @@ private:
     Status compare_row(TupleRow* left_row, TupleRow* right_row, bool* is_lt);
     Status get_next_row(RuntimeState* state, TupleRow* out_row, bool* eos);
     Status get_input_row(RuntimeState* state, int child_idx);
+
+    // Inner joins the children into 'out_batch'.
+    Status get_next_join(RuntimeState* state, RowBatch* out_batch, bool* eos);
+    // Returns true if one of the keys of the row of child 'child_idx' is NULL.
+    bool has_null_key(int child_idx, TupleRow* row);
+    // Compares the keys of 'left_row' and 'right_row', neither of which has a NULL key.
+    int compare_keys(TupleRow* left_row, TupleRow* right_row);
+    void create_join_row(TupleRow* out, TupleRow* left, TupleRow* right);
+    // Starts a new group of right rows, handing the memory the last one to 'out_batch'.
+    void reset_right_group(RowBatch* out_batch);
 };
 
 }
@@ -19,6 +19,7 @@
 
 #include <sstream>
 
+#include "common/config.h"
 #include "exec/text_converter.hpp"
 #include "gen_cpp/PlanNodes_types.h"
 #include "runtime/runtime_state.h"
@@ -76,6 +77,7 @@ Status MysqlScanNode::prepare(RuntimeState* state) {
     _my_param.user = mysql_table->user();
     _my_param.passwd = mysql_table->passwd();
     _my_param.db = mysql_table->mysql_db();
+    _my_param.use_result = config::mysql_scanner_use_result;
     // new one scanner
     _mysql_scanner.reset(new(std::nothrow) MysqlScanner(_my_param));
 
@@ -95,6 +97,13 @@ Status MysqlScanNode::prepare(RuntimeState* state) {
         return Status("new a text convertor failed.");
     }
 
+    for (int i = 0; i < _tuple_desc->slots().size(); ++i) {
+        if (_tuple_desc->slots()[i]->is_materialized()) {
+            _materialize_num++;
+        }
+    }
+
+    _runtime_state = state;
     _is_init = true;
 
     return Status::OK;
@@ -116,32 +125,241 @@ Status MysqlScanNode::open(RuntimeState* state) {
     RETURN_IF_CANCELLED(state);
     SCOPED_TIMER(_runtime_profile->total_time_counter());
     RETURN_IF_ERROR(_mysql_scanner->open());
-    RETURN_IF_ERROR(_mysql_scanner->query(_table_name, _columns, _filters));
+
+    // a limit is cheaper to read by one query, it ends as soon as it is reached
+    if (config::mysql_scan_parallel_ranges > 1 && _limit < 0) {
+        RETURN_IF_ERROR(split_ranges());
+    }
+
+    if (!_range_filters.empty()) {
+        {
+            std::unique_lock<std::mutex> l(_batch_queue_lock);
+            _num_running_scanners = _range_filters.size();
+        }
+        for (int i = 0; i < _range_filters.size(); ++i) {
+            _scanner_threads.emplace_back(&MysqlScanNode::scanner_worker, this, i);
+        }
+        return Status::OK;
+    }
+
+    // the limit is applied by MySQL, rows beyond it are not sent at all
+    RETURN_IF_ERROR(_mysql_scanner->query(_table_name, _columns, _filters, _limit));
+
     // check materialize slot num
-    int materialize_num = 0;
+    if (_mysql_scanner->field_num() != _materialize_num) {
+        return Status("input and output not equal.");
+    }
 
-    for (int i = 0; i < _tuple_desc->slots().size(); ++i) {
-        if (_tuple_desc->slots()[i]->is_materialized()) {
-            materialize_num++;
+    return Status::OK;
+}
+
+Status MysqlScanNode::split_ranges() {
+    std::string key;
+    int64_t min_value = 0;
+    int64_t max_value = 0;
+    RETURN_IF_ERROR(_mysql_scanner->get_int_key_range(
+            _table_name, _filters, &key, &min_value, &max_value));
+    if (key.empty()) {
+        return Status::OK;
+    }
+
+    split_int_key_range(key, min_value, max_value, config::mysql_scan_parallel_ranges,
+                        _filters, &_range_filters);
+    if (!_range_filters.empty()) {
+        VLOG(1) << "read mysql table " << _table_name << " by " << _range_filters.size()
+            << " ranges of " << key;
+    }
+    return Status::OK;
+}
+
+void MysqlScanNode::split_int_key_range(const std::string& key, int64_t min_value,
+                                        int64_t max_value, int max_ranges,
+                                        const std::vector<std::string>& filters,
+                                        std::vector<std::vector<std::string>>* range_filters) {
+    // computed in 128 bits, the range may be wider than int64
+    __int128 width = static_cast<__int128>(max_value) - min_value + 1;
+    int64_t num_ranges = std::min<__int128>(max_ranges, width);
+    if (num_ranges <= 1) {
+        return;
+    }
+    for (int64_t i = 0; i < num_ranges; ++i) {
+        std::vector<std::string> range(filters);
+        // the first and the last ranges are open, they also read the rows
+        // written beyond [min_value, max_value] since
+        if (i > 0) {
+            int64_t lower = min_value + width * i / num_ranges;
+            range.push_back(key + " >= " + std::to_string(lower));
+        }
+        if (i + 1 < num_ranges) {
+            int64_t upper = min_value + width * (i + 1) / num_ranges;
+            range.push_back(key + " < " + std::to_string(upper));
+        }
+        range_filters->push_back(std::move(range));
+    }
+}
+
+void MysqlScanNode::scanner_worker(int range_idx) {
+    Status status = scan_range(range_idx);
+    if (!status.ok()) {
+        LOG(WARNING) << "Scanner[" << range_idx << "] of mysql table " << _table_name
+            << " failed. status=" << status.get_error_msg();
+    }
+
+    {
+        std::lock_guard<std::mutex> l(_batch_queue_lock);
+        if (!status.ok() && _process_status.ok()) {
+            _process_status = status;
         }
+        _num_running_scanners--;
     }
+    _queue_reader_cond.notify_all();
+    // If one scanner failed, others don't need scan any more
+    if (!status.ok()) {
+        _queue_writer_cond.notify_all();
+    }
+}
 
-    if (_mysql_scanner->field_num() != materialize_num) {
+Status MysqlScanNode::scan_range(int range_idx) {
+    MysqlScanner scanner(_my_param);
+    RETURN_IF_ERROR(scanner.open());
+    RETURN_IF_ERROR(scanner.query(_table_name, _columns, _range_filters[range_idx]));
+    if (scanner.field_num() != _materialize_num) {
         return Status("input and output not equal.");
     }
+    TextConverter converter('\\');
+
+    bool scanner_eos = false;
+    while (!scanner_eos) {
+        RETURN_IF_CANCELLED(_runtime_state);
+        if (_scan_finished.load()) {
+            return Status::OK;
+        }
+
+        std::shared_ptr<RowBatch> row_batch(
+            new RowBatch(row_desc(), _runtime_state->batch_size(), mem_tracker()));
+        MemPool* tuple_pool = row_batch->tuple_data_pool();
+        int tuple_buffer_size = row_batch->capacity() * _tuple_desc->byte_size();
+        void* tuple_buffer = tuple_pool->allocate(tuple_buffer_size);
+        if (tuple_buffer == nullptr) {
+            return Status("Allocate memory for row batch failed.");
+        }
+
+        Tuple* tuple = reinterpret_cast<Tuple*>(tuple_buffer);
+        while (!row_batch->is_full()) {
+            char** data = NULL;
+            unsigned long* length = NULL;
+            RETURN_IF_ERROR(scanner.get_next_row(&data, &length, &scanner_eos));
+            if (scanner_eos) {
+                break;
+            }
+
+            int row_idx = row_batch->add_row();
+            row_batch->get_row(row_idx)->set_tuple(0, tuple);
+            RETURN_IF_ERROR(fill_tuple(data, length, tuple, tuple_pool, &converter));
+            row_batch->commit_last_row();
+            char* new_tuple = reinterpret_cast<char*>(tuple);
+            new_tuple += _tuple_desc->byte_size();
+            tuple = reinterpret_cast<Tuple*>(new_tuple);
+        }
+
+        if (row_batch->num_rows() > 0) {
+            std::unique_lock<std::mutex> l(_batch_queue_lock);
+            while (_process_status.ok() &&
+                   !_scan_finished.load() &&
+                   !_runtime_state->is_cancelled() &&
+                   _batch_queue.size() >= config::doris_scanner_queue_size) {
+                _queue_writer_cond.wait_for(l, std::chrono::seconds(1));
+            }
+            if (!_process_status.ok() || _scan_finished.load()) {
+                return Status::OK;
+            }
+            if (_runtime_state->is_cancelled()) {
+                return Status::CANCELLED;
+            }
+            _batch_queue.push_back(row_batch);
+            _queue_reader_cond.notify_one();
+        }
+    }
+
+    return Status::OK;
+}
+
+Status MysqlScanNode::fill_tuple(char** data, unsigned long* length, Tuple* tuple,
+                                 MemPool* pool, TextConverter* converter) {
+    memset(tuple, 0, _tuple_desc->num_null_bytes());
+    int j = 0;
+
+    for (int i = 0; i < _slot_num; ++i) {
+        auto slot_desc = _tuple_desc->slots()[i];
+        // because the fe planner filter the non_materialize column
+        if (!slot_desc->is_materialized()) {
+            continue;
+        }
+
+        if (data[j] == nullptr) {
+            if (slot_desc->is_nullable()) {
+                tuple->set_null(slot_desc->null_indicator_offset());
+            } else {
+                std::stringstream ss;
+                ss << "nonnull column contains NULL. table=" << _table_name
+                    << ", column=" << slot_desc->col_name();
+                return Status(ss.str());
+            }
+        } else if (!converter->write_slot(slot_desc, tuple, data[j], length[j],
+                                          true, false, pool)) {
+            std::stringstream ss;
+            ss << "fail to convert mysql value '" << data[j] << "' TO " << slot_desc->type();
+            return Status(ss.str());
+        }
+
+        j++;
+    }
 
     return Status::OK;
 }
 
-Status MysqlScanNode::write_text_slot(char* value, int value_length,
-                                    SlotDescriptor* slot, RuntimeState* state) {
-    if (!_text_converter->write_slot(slot, _tuple, value, value_length,
-                                     true, false, _tuple_pool.get())) {
-        std::stringstream ss;
-        ss << "fail to convert mysql value '" << value << "' TO " << slot->type();
-        return Status(ss.str());
+Status MysqlScanNode::get_next_from_scanners(RuntimeState* state, RowBatch* row_batch,
+                                             bool* eos) {
+    if (_scan_finished.load()) {
+        *eos = true;
+        return Status::OK;
+    }
+
+    std::shared_ptr<RowBatch> scanner_batch;
+    {
+        std::unique_lock<std::mutex> l(_batch_queue_lock);
+        while (_process_status.ok() &&
+               !state->is_cancelled() &&
+               _num_running_scanners > 0 &&
+               _batch_queue.empty()) {
+            _queue_reader_cond.wait_for(l, std::chrono::seconds(1));
+        }
+        if (!_process_status.ok()) {
+            return _process_status;
+        }
+        if (state->is_cancelled()) {
+            _process_status = Status::CANCELLED;
+            _queue_writer_cond.notify_all();
+            return _process_status;
+        }
+        if (!_batch_queue.empty()) {
+            scanner_batch = _batch_queue.front();
+            _batch_queue.pop_front();
+        }
+    }
+
+    // All scanner has been finished, and all cached batch has been read
+    if (scanner_batch == nullptr) {
+        _scan_finished.store(true);
+        *eos = true;
+        return Status::OK;
     }
 
+    _queue_writer_cond.notify_one();
+    row_batch->acquire_state(scanner_batch.get());
+    _num_rows_returned += row_batch->num_rows();
+    COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+    *eos = false;
     return Status::OK;
 }
 
@@ -166,6 +384,10 @@ Status MysqlScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* e
         return Status::OK;
     }
 
+    if (!_range_filters.empty()) {
+        return get_next_from_scanners(state, row_batch, eos);
+    }
+
     // create new tuple buffer for row_batch
     int tuple_buffer_size = row_batch->capacity() * _tuple_desc->byte_size();
     void* tuple_buffer = _tuple_pool->allocate(tuple_buffer_size);
@@ -204,31 +426,8 @@ Status MysqlScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* e
         TupleRow* row = row_batch->get_row(row_idx);
         // scan node is the first tuple of tuple row
         row->set_tuple(0, _tuple);
-        memset(_tuple, 0, _tuple_desc->num_null_bytes());
-        int j = 0;
-
-        for (int i = 0; i < _slot_num; ++i) {
-            auto slot_desc = _tuple_desc->slots()[i];
-            // because the fe planner filter the non_materialize column
-            if (!slot_desc->is_materialized()) {
-                continue;
-            }
-
-            if (data[j] == nullptr) {
-                if (slot_desc->is_nullable()) {
-                    _tuple->set_null(slot_desc->null_indicator_offset());
-                } else {
-                    std::stringstream ss;
-                    ss << "nonnull column contains NULL. table=" << _table_name
-                        << ", column=" << slot_desc->col_name();
-                    return Status(ss.str());
-                }
-            } else {
-                RETURN_IF_ERROR(write_text_slot(data[j], length[j], slot_desc, state));
-            }
-
-            j++;
-        }
+        RETURN_IF_ERROR(fill_tuple(data, length, _tuple, _tuple_pool.get(),
+                                   _text_converter.get()));
 
         // MySQL has filter all rows, no need check.
         {
@@ -250,6 +449,13 @@ Status MysqlScanNode::close(RuntimeState* state) {
     }
     RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::CLOSE));
     SCOPED_TIMER(_runtime_profile->total_time_counter());
+    _scan_finished.store(true);
+    _queue_writer_cond.notify_all();
+    _queue_reader_cond.notify_all();
+    for (int i = 0; i < _scanner_threads.size(); ++i) {
+        _scanner_threads[i].join();
+    }
+    _batch_queue.clear();
 
     if (memory_used_counter() != NULL) {
         COUNTER_UPDATE(memory_used_counter(), _tuple_pool->peak_allocated_bytes());
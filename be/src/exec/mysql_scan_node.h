@@ -18,7 +18,12 @@
 #ifndef  DORIS_BE_SRC_QUERY_EXEC_MYSQL_SCAN_NODE_H
 #define  DORIS_BE_SRC_QUERY_EXEC_MYSQL_SCAN_NODE_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "runtime/descriptors.h"
 #include "exec/mysql_scanner.h"
@@ -26,6 +31,7 @@
 
 namespace doris {
 
+class RowBatch;
 class TextConverter;
 class Tuple;
 class TupleDescriptor;
@@ -59,10 +65,28 @@ protected:
     virtual void debug_string(int indentation_level, std::stringstream* out) const;
 
 private:
-    // Writes a slot in _tuple from an MySQL value containing text data.
-    // The Mysql value is converted into the appropriate target type.
-    Status write_text_slot(char* value, int value_length, SlotDescriptor* slot,
-                         RuntimeState* state);
+    // Writes the materialized slots of 'tuple' from a MySQL row containing text
+    // data. The Mysql values are converted into the appropriate target types.
+    Status fill_tuple(char** data, unsigned long* length, Tuple* tuple, MemPool* pool,
+                      TextConverter* converter);
+
+    // Splits the range of an integer primary key into _range_filters, leaves
+    // them empty if the table has no such key.
+    Status split_ranges();
+    // Splits the keys from 'min_value' to 'max_value' into at most 'max_ranges'
+    // ranges, whose where clauses are 'filters' and the bounds of the range.
+    // Adds none if there would be only one range.
+    static void split_int_key_range(const std::string& key, int64_t min_value,
+                                    int64_t max_value, int max_ranges,
+                                    const std::vector<std::string>& filters,
+                                    std::vector<std::vector<std::string>>* range_filters);
+
+    // Reads the range 'range_idx' on a connection of its own, and pushes its
+    // row batches to _batch_queue.
+    void scanner_worker(int range_idx);
+    Status scan_range(int range_idx);
+
+    Status get_next_from_scanners(RuntimeState* state, RowBatch* row_batch, bool* eos);
 
     bool _is_init;
     MysqlScannerParam _my_param;
@@ -89,6 +113,22 @@ private:
     std::unique_ptr<TextConverter> _text_converter;
     // Current tuple.
     Tuple* _tuple = nullptr;
+    // Number of materialized slots, which are the columns read from MySQL.
+    int _materialize_num = 0;
+
+    RuntimeState* _runtime_state = nullptr;
+    // where clause of each range read in parallel, empty if the table is read
+    // by _mysql_scanner only
+    std::vector<std::vector<std::string>> _range_filters;
+    std::vector<std::thread> _scanner_threads;
+    std::mutex _batch_queue_lock;
+    std::condition_variable _queue_reader_cond;
+    std::condition_variable _queue_writer_cond;
+    std::deque<std::shared_ptr<RowBatch>> _batch_queue;
+    int _num_running_scanners = 0;
+    // first error of the scanner threads
+    Status _process_status;
+    std::atomic<bool> _scan_finished{false};
 };
 
 }
@@ -23,6 +23,7 @@
 
 
 #include "common/logging.h"
+#include "util/string_parser.hpp"
 
 namespace doris {
 
@@ -80,10 +81,21 @@ Status MysqlScanner::open() {
 }
 
 Status MysqlScanner::query(const std::string& query) {
+    return _query(query, _my_param.use_result);
+}
+
+Status MysqlScanner::_query(const std::string& query, bool use_result) {
     if (!_is_open) {
         return Status("Query before open.");
     }
 
+    // a streamed result must be read to its end before the next query, else
+    // the connection is out of sync. Freeing it reads the rest of its rows.
+    if (_my_result) {
+        mysql_free_result(_my_result);
+        _my_result = NULL;
+    }
+
     int sql_result = mysql_query(_my_conn, query.c_str());
 
     if (0 != sql_result) {
@@ -93,14 +105,14 @@ Status MysqlScanner::query(const std::string& query) {
         LOG(INFO) << "mysql query success. query =" << query;
     }
 
-    // clean the last query result
-    if (_my_result) {
-        mysql_free_result(_my_result);
+    // store result loads small tables in memory avoid of many RPC, use result
+    // streams large ones, the rows are fetched as fast as they are consumed
+    if (use_result) {
+        _my_result = mysql_use_result(_my_conn);
+    } else {
+        _my_result = mysql_store_result(_my_conn);
     }
 
-    // use store result because mysql table is small, can load in memory avoid of many RPC
-    _my_result = mysql_store_result(_my_conn);
-
     if (NULL == _my_result) {
         return _error_status("mysql store result failed.");
     }
@@ -111,11 +123,17 @@ Status MysqlScanner::query(const std::string& query) {
 }
 
 Status MysqlScanner::query(const std::string& table, const std::vector<std::string>& fields,
-                           const std::vector<std::string>& filters) {
+                           const std::vector<std::string>& filters, int64_t limit) {
     if (!_is_open) {
         return Status("Query before open.");
     }
 
+    _build_sql(table, fields, filters, limit);
+    return query(_sql_str);
+}
+
+void MysqlScanner::_build_sql(const std::string& table, const std::vector<std::string>& fields,
+                              const std::vector<std::string>& filters, int64_t limit) {
     _sql_str = "SELECT";
 
     for (int i = 0; i < fields.size(); ++i) {
@@ -140,7 +158,62 @@ Status MysqlScanner::query(const std::string& table, const std::vector<std::stri
         }
     }
 
-    return query(_sql_str);
+    if (limit >= 0) {
+        _sql_str += " LIMIT " + std::to_string(limit);
+    }
+}
+
+Status MysqlScanner::get_int_key_range(const std::string& table,
+                                       const std::vector<std::string>& filters,
+                                       std::string* key, int64_t* min_value,
+                                       int64_t* max_value) {
+    key->clear();
+    char** row = NULL;
+    unsigned long* lengths = NULL;
+    bool eos = false;
+
+    // the 5th column of SHOW KEYS is the name of the column
+    RETURN_IF_ERROR(_query("SHOW KEYS FROM " + table + " WHERE Key_name = 'PRIMARY'", false));
+    RETURN_IF_ERROR(get_next_row(&row, &lengths, &eos));
+    if (eos || _field_num < 5 || row[4] == NULL) {
+        return Status::OK;
+    }
+    std::string column(row[4], lengths[4]);
+    RETURN_IF_ERROR(get_next_row(&row, &lengths, &eos));
+    if (!eos) {
+        // the key has several columns
+        return Status::OK;
+    }
+
+    // the 2nd column of SHOW COLUMNS is the type, e.g. "bigint(20) unsigned"
+    RETURN_IF_ERROR(_query("SHOW COLUMNS FROM " + table + " LIKE '" + column + "'", false));
+    RETURN_IF_ERROR(get_next_row(&row, &lengths, &eos));
+    if (eos || _field_num < 2 || row[1] == NULL) {
+        return Status::OK;
+    }
+    std::string type(row[1], lengths[1]);
+    if (type.find("int") == std::string::npos || type.find("point") != std::string::npos) {
+        return Status::OK;
+    }
+
+    // stored, the result is one row which is not read to its end
+    std::vector<std::string> fields = {"MIN(`" + column + "`)", "MAX(`" + column + "`)"};
+    _build_sql(table, fields, filters, -1);
+    RETURN_IF_ERROR(_query(_sql_str, false));
+    RETURN_IF_ERROR(get_next_row(&row, &lengths, &eos));
+    if (eos || row[0] == NULL || row[1] == NULL) {
+        return Status::OK;
+    }
+    StringParser::ParseResult min_result;
+    StringParser::ParseResult max_result;
+    *min_value = StringParser::string_to_int<int64_t>(row[0], lengths[0], &min_result);
+    *max_value = StringParser::string_to_int<int64_t>(row[1], lengths[1], &max_result);
+    // unsigned bigints may be out of the range of int64
+    if (min_result != StringParser::PARSE_SUCCESS || max_result != StringParser::PARSE_SUCCESS) {
+        return Status::OK;
+    }
+    *key = "`" + column + "`";
+    return Status::OK;
 }
 
 Status MysqlScanner::get_next_row(char** *buf, unsigned long** lengths, bool* eos) {
@@ -159,6 +232,10 @@ Status MysqlScanner::get_next_row(char** *buf, unsigned long** lengths, bool* eo
     *buf = mysql_fetch_row(_my_result);
 
     if (NULL == *buf) {
+        // a streamed result also ends if the connection fails
+        if (0 != mysql_errno(_my_conn)) {
+            return _error_status("mysql fetch row failed.");
+        }
         *eos = true;
         return Status::OK;
     }
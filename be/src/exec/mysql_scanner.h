@@ -42,7 +42,10 @@ struct MysqlScannerParam {
     std::string passwd;
     std::string db;
     unsigned long client_flag;
-    MysqlScannerParam(): client_flag(0) { }
+    // rows are streamed from the server by mysql_use_result instead of being
+    // stored in memory by mysql_store_result first
+    bool use_result;
+    MysqlScannerParam(): client_flag(0), use_result(false) { }
 };
 
 // Mysql Scanner for scan data from mysql
@@ -54,15 +57,25 @@ public:
     Status open();
     Status query(const std::string& query);
 
-    // query for DORIS
+    // query for DORIS, at most 'limit' rows are returned unless it is negative
     Status query(const std::string& table, const std::vector<std::string>& fields,
-                 const std::vector<std::string>& filters);
+                 const std::vector<std::string>& filters, int64_t limit = -1);
     Status get_next_row(char** *buf, unsigned long** lengths, bool* eos);
 
+    // Finds the range of the primary key of 'table' among the rows matching
+    // 'filters', if the key is one integer column. 'key' is left empty
+    // otherwise, or if no row matches.
+    Status get_int_key_range(const std::string& table, const std::vector<std::string>& filters,
+                             std::string* key, int64_t* min_value, int64_t* max_value);
+
     int field_num() const {
         return _field_num;
     }
 private:
+    Status _query(const std::string& query, bool use_result);
+    // sets _sql_str to the query of query()
+    void _build_sql(const std::string& table, const std::vector<std::string>& fields,
+                    const std::vector<std::string>& filters, int64_t limit);
     Status _error_status(const std::string& prefix);
 
     const MysqlScannerParam& _my_param;
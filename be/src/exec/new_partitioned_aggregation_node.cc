@@ -22,10 +22,12 @@
 #include <set>
 #include <sstream>
 
+#include "common/config.h"
 //#include "codegen/codegen_anyval.h"
 //#include "codegen/llvm_codegen.h"
 #include "exec/new_partitioned_hash_table.h"
 #include "exec/new_partitioned_hash_table.inline.h"
+#include "exprs/agg_update_kernel.h"
 #include "exprs/new_agg_fn_evaluator.h"
 #include "exprs/anyval_util.h"
 #include "exprs/expr_context.h"
@@ -109,6 +111,7 @@ NewPartitionedAggregationNode::NewPartitionedAggregationNode(
     output_tuple_desc_(descs.get_tuple_descriptor(output_tuple_id_)),
     needs_finalize_(tnode.agg_node.need_finalize),
     needs_serialize_(false),
+    direct_key_size_(0),
     output_partition_(NULL),
     process_batch_no_grouping_fn_(NULL),
     process_batch_fn_(NULL),
@@ -224,6 +227,18 @@ Status NewPartitionedAggregationNode::prepare(RuntimeState* state) {
   const RowDescriptor& row_desc = child(0)->row_desc();
   RETURN_IF_ERROR(NewAggFnEvaluator::Create(agg_fns_, state, _pool, agg_fn_pool_.get(),
       &agg_fn_evals_, expr_mem_tracker(), row_desc));
+  if (config::enable_vectorized_aggregation && !is_streaming_preagg_) {
+    bool has_kernel = false;
+    for (AggFn* agg_fn : agg_fns_) {
+      agg_update_kernels_.push_back(AggUpdateKernel::Create(*agg_fn, _pool));
+      has_kernel |= agg_update_kernels_.back() != NULL;
+    }
+    if (has_kernel) {
+      runtime_profile()->append_exec_option("Vectorized Aggregation");
+    } else {
+      agg_update_kernels_.clear();
+    }
+  }
   
   expr_results_pool_.reset(new MemPool(_expr_mem_tracker.get()));
   if (!grouping_exprs_.empty()) {
@@ -232,6 +247,20 @@ Status NewPartitionedAggregationNode::prepare(RuntimeState* state) {
         grouping_exprs_, true, vector<bool>(build_exprs_.size(), true),
         state->fragment_hash_seed(), MAX_PARTITION_DEPTH, 1, expr_mem_pool(),
         expr_results_pool_.get(), expr_mem_tracker(), build_row_desc, row_desc, &ht_ctx_));
+    // streaming preaggregations do not keep their hash tables
+    if (grouping_exprs_.size() == 1 && !is_streaming_preagg_) {
+      PrimitiveType type = build_exprs_[0]->type().type;
+      if (type == TYPE_BOOLEAN || type == TYPE_TINYINT) {
+        direct_key_size_ = 1;
+        direct_tuples_.resize((1 << 8) + 1);
+      } else if (type == TYPE_SMALLINT) {
+        direct_key_size_ = 2;
+        direct_tuples_.resize((1 << 16) + 1);
+      }
+      if (!direct_tuples_.empty()) {
+        runtime_profile()->append_exec_option("Direct Group By Array");
+      }
+    }
   }
   // AddCodegenDisabledMessage(state);
   return Status::OK;
@@ -837,6 +866,8 @@ Status NewPartitionedAggregationNode::Partition::Spill(bool more_aggregate_rows)
   RETURN_IF_ERROR(parent->state_->StartSpilling(parent->mem_tracker()));
 
   RETURN_IF_ERROR(SerializeStreamForSpilling());
+  // the tuples of this partition are not kept in memory
+  std::fill(parent->direct_tuples_.begin(), parent->direct_tuples_.end(), nullptr);
 
   // Free the in-memory result data.
   NewAggFnEvaluator::Close(agg_fn_evals, parent->state_);
@@ -1116,6 +1147,8 @@ Status NewPartitionedAggregationNode::CreateHashPartitions(
         return state_->set_mem_limit_exceeded(error_msg.str());
   }
   ht_ctx_->set_level(level);
+  // the tuples belong to the previous partitions
+  std::fill(direct_tuples_.begin(), direct_tuples_.end(), nullptr);
 
   DCHECK(hash_partitions_.empty());
   int num_partitions_created = 0;
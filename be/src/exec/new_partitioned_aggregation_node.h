@@ -39,6 +39,7 @@ class Function;
 namespace doris {
 
 class AggFn;
+class AggUpdateKernel;
 class NewAggFnEvaluator;
 class CodegenAnyVal;
 //class LlvmCodeGen;
@@ -221,6 +222,24 @@ class NewPartitionedAggregationNode : public ExecNode {
   std::vector<NewAggFnEvaluator*> agg_fn_evals_;
   boost::scoped_ptr<MemPool> agg_fn_pool_;
 
+  /// The kernel updating each aggregate function for a batch of rows at a time, NULL
+  /// for the functions which have none. Empty if ProcessBatchVectorized() is not used.
+  std::vector<AggUpdateKernel*> agg_update_kernels_;
+
+  /// The input rows of the current group of ProcessBatchVectorized() whose updates are
+  /// not applied yet, with the intermediate tuple and the partition they update.
+  std::vector<TupleRow*> pending_rows_;
+  std::vector<Tuple*> pending_tuples_;
+  std::vector<Partition*> pending_partitions_;
+
+  /// The intermediate tuples of the values of the grouping expr if it is the only one
+  /// and is a BOOLEAN, TINYINT or SMALLINT. Rows look up their tuple in this array before
+  /// the hash table; the last entry is the tuple of NULL. An entry is set once its key is
+  /// found in a hash table, they are all cleared when partitions are spilled or created.
+  std::vector<Tuple*> direct_tuples_;
+  /// byte size of the values of the grouping expr if direct_tuples_ is used
+  int direct_key_size_;
+
   /// Exprs used to evaluate input rows
   std::vector<Expr*> grouping_exprs_;
 
@@ -447,6 +466,15 @@ class NewPartitionedAggregationNode : public ExecNode {
   /// a temporary buffer.
   boost::scoped_ptr<BufferedTupleStream3> serialize_stream_;
 
+  /// Returns the entry of direct_tuples_ of the current row of 'ht_ctx'.
+  Tuple** ALWAYS_INLINE GetDirectTuple(const NewPartitionedHashTableCtx* ht_ctx) {
+    if (ht_ctx->ExprValueNull(0)) return &direct_tuples_.back();
+    const void* value = ht_ctx->ExprValue(0);
+    int idx = direct_key_size_ == 1 ? *reinterpret_cast<const int8_t*>(value) + 128
+        : *reinterpret_cast<const int16_t*>(value) + 32768;
+    return &direct_tuples_[idx];
+  }
+
   /// Accessor for 'hash_tbls_' that verifies consistency with the partitions.
   NewPartitionedHashTable* ALWAYS_INLINE GetHashTable(int partition_idx) {
     NewPartitionedHashTable* ht = hash_tbls_[partition_idx];
@@ -542,6 +570,22 @@ class NewPartitionedAggregationNode : public ExecNode {
   template<bool AGGREGATED_ROWS>
   Status IR_ALWAYS_INLINE ProcessBatch(RowBatch* batch, NewPartitionedHashTableCtx* ht_ctx);
 
+  /// ProcessBatch() for unaggregated rows when some aggregate functions have an
+  /// AggUpdateKernel. The intermediate tuples of a group of rows are found or created
+  /// first, after prefetching their buckets, then every function updates the tuples of
+  /// the whole group, through its kernel if it has one.
+  Status ProcessBatchVectorized(RowBatch* batch, NewPartitionedHashTableCtx* ht_ctx);
+
+  /// Returns in 'tuple' the intermediate tuple of the current row of the expr values
+  /// cache of 'ht_ctx', which is created if the row is a new group. 'tuple' is NULL if
+  /// the partition of the row is spilled, in which case the row is appended to it.
+  /// If a partition must be spilled the pending updates are applied first.
+  Status FindOrAddIntermediateTuple(TupleRow* row, uint32_t hash,
+      NewPartitionedHashTableCtx* ht_ctx, int* num_pending, Tuple** tuple);
+
+  /// Applies the updates of the first 'num_pending' pending rows.
+  void UpdatePendingTuples(int num_pending);
+
   /// Evaluates the rows in 'batch' starting at 'start_row_idx' and stores the results in
   /// the expression values cache in 'ht_ctx'. The number of rows evaluated depends on
   /// the capacity of the cache. 'prefetch_mode' specifies the prefetching mode in use.
@@ -18,6 +18,7 @@
 #include "exec/new_partitioned_aggregation_node.h"
 
 #include "exec/new_partitioned_hash_table.inline.h"
+#include "exprs/agg_update_kernel.h"
 #include "exprs/new_agg_fn_evaluator.h"
 #include "exprs/expr_context.h"
 #include "runtime/buffered_tuple_stream3.inline.h"
@@ -29,6 +30,18 @@ using namespace doris;
 
 Status NewPartitionedAggregationNode::ProcessBatchNoGrouping(RowBatch* batch) {
   Tuple* output_tuple = singleton_output_tuple_;
+  if (!agg_update_kernels_.empty()) {
+    // all the rows update the single tuple
+    const int num_rows = batch->num_rows();
+    pending_rows_.resize(num_rows);
+    pending_tuples_.assign(num_rows, output_tuple);
+    pending_partitions_.assign(num_rows, NULL);
+    for (int i = 0; i < num_rows; ++i) {
+      pending_rows_[i] = batch->get_row(i);
+    }
+    UpdatePendingTuples(num_rows);
+    return Status::OK;
+  }
   FOREACH_ROW(batch, 0, batch_iter) {
     UpdateTuple(agg_fn_evals_.data(), output_tuple, batch_iter.get());
   }
@@ -40,6 +53,9 @@ Status NewPartitionedAggregationNode::ProcessBatch(RowBatch* batch,
     NewPartitionedHashTableCtx* ht_ctx) {
   DCHECK(!hash_partitions_.empty());
   DCHECK(!is_streaming_preagg_);
+  if (!AGGREGATED_ROWS && !agg_update_kernels_.empty()) {
+    return ProcessBatchVectorized(batch, ht_ctx);
+  }
 
   // Make sure that no resizes will happen when inserting individual rows to the hash
   // table of each partition by pessimistically assuming that all the rows in each batch
@@ -63,6 +79,112 @@ Status NewPartitionedAggregationNode::ProcessBatch(RowBatch* batch,
   return Status::OK;
 }
 
+Status NewPartitionedAggregationNode::ProcessBatchVectorized(RowBatch* batch,
+    NewPartitionedHashTableCtx* ht_ctx) {
+  // no resizes while the tuples of a group are found, see ProcessBatch()
+  RETURN_IF_ERROR(CheckAndResizeHashPartitions(false, batch->num_rows(), ht_ctx));
+
+  NewPartitionedHashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx->expr_values_cache();
+  const int cache_size = expr_vals_cache->capacity();
+  const int num_rows = batch->num_rows();
+  if (pending_rows_.size() < static_cast<size_t>(cache_size)) {
+    pending_rows_.resize(cache_size);
+    pending_tuples_.resize(cache_size);
+    pending_partitions_.resize(cache_size);
+  }
+  for (int group_start = 0; group_start < num_rows; group_start += cache_size) {
+    EvalAndHashPrefetchGroup<false>(batch, group_start, ht_ctx);
+
+    int num_pending = 0;
+    FOREACH_ROW_LIMIT(batch, group_start, cache_size, batch_iter) {
+      if (!expr_vals_cache->IsRowNull()) {
+        TupleRow* row = batch_iter.get();
+        const uint32_t hash = expr_vals_cache->CurExprValuesHash();
+        const uint32_t partition_idx = hash >> (32 - NUM_PARTITIONING_BITS);
+        Tuple* tuple = NULL;
+        RETURN_IF_ERROR(FindOrAddIntermediateTuple(row, hash, ht_ctx, &num_pending, &tuple));
+        if (tuple != NULL) {
+          pending_rows_[num_pending] = row;
+          pending_tuples_[num_pending] = tuple;
+          pending_partitions_[num_pending] = hash_partitions_[partition_idx];
+          ++num_pending;
+        }
+      }
+      expr_vals_cache->NextRow();
+    }
+    DCHECK(expr_vals_cache->AtEnd());
+    UpdatePendingTuples(num_pending);
+  }
+  return Status::OK;
+}
+
+Status NewPartitionedAggregationNode::FindOrAddIntermediateTuple(TupleRow* row,
+    uint32_t hash, NewPartitionedHashTableCtx* ht_ctx, int* num_pending, Tuple** tuple) {
+  const uint32_t partition_idx = hash >> (32 - NUM_PARTITIONING_BITS);
+  while (true) {
+    NewPartitionedHashTable* hash_tbl = GetHashTable(partition_idx);
+    Partition* dst_partition = hash_partitions_[partition_idx];
+    DCHECK(dst_partition != nullptr);
+    DCHECK_EQ(dst_partition->is_spilled(), hash_tbl == NULL);
+    if (hash_tbl == NULL) {
+      *tuple = NULL;
+      return AppendSpilledRow<false>(dst_partition, row);
+    }
+
+    DCHECK(dst_partition->aggregated_row_stream->is_pinned());
+    Tuple** direct_tuple = NULL;
+    if (!direct_tuples_.empty()) {
+      direct_tuple = GetDirectTuple(ht_ctx);
+      if (*direct_tuple != NULL) {
+        *tuple = *direct_tuple;
+        return Status::OK;
+      }
+    }
+    bool found;
+    NewPartitionedHashTable::Iterator it = hash_tbl->FindBuildRowBucket(ht_ctx, &found);
+    DCHECK(!it.AtEnd()) << "Hash table had no free buckets";
+    if (found) {
+      *tuple = it.GetTuple();
+      if (direct_tuple != NULL) *direct_tuple = *tuple;
+      return Status::OK;
+    }
+    Tuple* intermediate_tuple = ConstructIntermediateTuple(dst_partition->agg_fn_evals,
+        dst_partition->aggregated_row_stream.get(), &process_batch_status_);
+    if (LIKELY(intermediate_tuple != NULL)) {
+      it.SetTuple(intermediate_tuple, hash);
+      *tuple = intermediate_tuple;
+      if (direct_tuple != NULL) *direct_tuple = intermediate_tuple;
+      return Status::OK;
+    } else if (!process_batch_status_.ok()) {
+      return std::move(process_batch_status_);
+    }
+
+    // The tuples of the partition to spill must be up to date, then the row is
+    // looked up again since its partition may be the spilled one.
+    UpdatePendingTuples(*num_pending);
+    *num_pending = 0;
+    RETURN_IF_ERROR(SpillPartition(false));
+  }
+}
+
+void NewPartitionedAggregationNode::UpdatePendingTuples(int num_pending) {
+  // one function after another, each for all the rows
+  for (int i = 0; i < agg_fns_.size(); ++i) {
+    if (agg_update_kernels_[i] != NULL) {
+      agg_update_kernels_[i]->Update(pending_rows_.data(), pending_tuples_.data(),
+          num_pending);
+      continue;
+    }
+    for (int j = 0; j < num_pending; ++j) {
+      // no partition if there is no grouping
+      Partition* partition = pending_partitions_[j];
+      NewAggFnEvaluator* eval =
+          partition != NULL ? partition->agg_fn_evals[i] : agg_fn_evals_[i];
+      eval->Add(pending_rows_[j], pending_tuples_[j]);
+    }
+  }
+}
+
 template<bool AGGREGATED_ROWS>
 void IR_ALWAYS_INLINE NewPartitionedAggregationNode::EvalAndHashPrefetchGroup(
     RowBatch* batch, int start_row_idx,
@@ -116,6 +238,14 @@ Status NewPartitionedAggregationNode::ProcessRow(TupleRow* row,
   }
 
   DCHECK(dst_partition->aggregated_row_stream->is_pinned());
+  Tuple** direct_tuple = NULL;
+  if (!AGGREGATED_ROWS && !direct_tuples_.empty()) {
+    direct_tuple = GetDirectTuple(ht_ctx);
+    if (*direct_tuple != NULL) {
+      UpdateTuple(dst_partition->agg_fn_evals.data(), *direct_tuple, row);
+      return Status::OK;
+    }
+  }
   bool found;
   // Find the appropriate bucket in the hash table. There will always be a free
   // bucket because we checked the size above.
@@ -128,6 +258,7 @@ Status NewPartitionedAggregationNode::ProcessRow(TupleRow* row,
     DCHECK(!found);
   } else if (found) {
     // Row is already in hash table. Do the aggregation and we're done.
+    if (direct_tuple != NULL) *direct_tuple = it.GetTuple();
     UpdateTuple(dst_partition->agg_fn_evals.data(), it.GetTuple(), row);
     return Status::OK;
   }
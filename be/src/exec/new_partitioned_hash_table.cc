@@ -17,6 +17,8 @@
 
 #include "exec/new_partitioned_hash_table.inline.h"
 
+#include <string.h>
+
 #include <functional>
 #include <numeric>
 #include <gutil/strings/substitute.h>
@@ -110,6 +112,26 @@ NewPartitionedHashTableCtx::NewPartitionedHashTableCtx(const std::vector<Expr*>&
   for (int i = 1; i <= max_levels; ++i) {
     seeds_[i] = seeds_[i - 1] * SEED_PRIMES[i];
   }
+
+  fixed_size_keys_ = true;
+  for (Expr* expr : build_exprs_) {
+    switch (expr->type().type) {
+      case TYPE_BOOLEAN:
+      case TYPE_TINYINT:
+      case TYPE_SMALLINT:
+      case TYPE_INT:
+      case TYPE_BIGINT:
+      case TYPE_LARGEINT:
+      case TYPE_DECIMALV2:
+        break;
+      default:
+        // floats have two zeros, the other types have padding or several
+        // representations of a value
+        fixed_size_keys_ = false;
+    }
+    fixed_size_keys_ &= expr->is_slotref();
+    key_sizes_.push_back(expr->type().get_slot_size());
+  }
 }
 
 Status NewPartitionedHashTableCtx::Init(ObjectPool* pool, RuntimeState* state, int num_build_tuples,
@@ -279,6 +301,9 @@ uint32_t NewPartitionedHashTableCtx::HashVariableLenRow(const uint8_t* expr_valu
 template <bool FORCE_NULL_EQUALITY>
 bool NewPartitionedHashTableCtx::Equals(TupleRow* build_row, const uint8_t* expr_values,
     const uint8_t* expr_values_null) const noexcept {
+  if (fixed_size_keys_) {
+    return FixedSizeEquals<FORCE_NULL_EQUALITY>(build_row, expr_values, expr_values_null);
+  }
   for (int i = 0; i < build_expr_evals_.size(); ++i) {
     void* val = build_expr_evals_[i]->get_value(build_row);
     if (val == NULL) {
@@ -297,6 +322,24 @@ bool NewPartitionedHashTableCtx::Equals(TupleRow* build_row, const uint8_t* expr
   return true;
 }
 
+template <bool FORCE_NULL_EQUALITY>
+bool NewPartitionedHashTableCtx::FixedSizeEquals(TupleRow* build_row,
+    const uint8_t* expr_values, const uint8_t* expr_values_null) const {
+  for (int i = 0; i < build_exprs_.size(); ++i) {
+    const void* val = SlotRef::get_value(build_exprs_[i], build_row);
+    if (val == NULL) {
+      if (!(FORCE_NULL_EQUALITY || finds_nulls_[i])) return false;
+      if (!expr_values_null[i]) return false;
+      continue;
+    } else {
+      if (expr_values_null[i]) return false;
+    }
+    const void* loc = expr_values_cache_.ExprValuePtr(expr_values, i);
+    if (memcmp(loc, val, key_sizes_[i]) != 0) return false;
+  }
+  return true;
+}
+
 template bool NewPartitionedHashTableCtx::Equals<true>(TupleRow* build_row,
     const uint8_t* expr_values, const uint8_t* expr_values_null) const;
 template bool NewPartitionedHashTableCtx::Equals<false>(TupleRow* build_row,
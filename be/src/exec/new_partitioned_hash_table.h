@@ -468,6 +468,12 @@ class NewPartitionedHashTableCtx {
   bool IR_NO_INLINE Equals(TupleRow* build_row, const uint8_t* expr_values,
       const uint8_t* expr_values_null) const noexcept;
 
+  /// Equals() for fixed_size_keys_: the slots of 'build_row' are read directly and
+  /// compared by their bytes.
+  template <bool FORCE_NULL_EQUALITY>
+  bool FixedSizeEquals(TupleRow* build_row, const uint8_t* expr_values,
+      const uint8_t* expr_values_null) const;
+
   /// Helper function that calls Equals() with the current row. Always inlined so that
   /// it does not appear in cross-compiled IR.
   template <bool FORCE_NULL_EQUALITY>
@@ -502,6 +508,13 @@ class NewPartitionedHashTableCtx {
   /// finds_some_nulls_ is just the logical OR of finds_nulls_.
   const bool finds_some_nulls_;
 
+  /// True if the build exprs are all SlotRefs of integer types (or DECIMALV2), whose
+  /// equal values have equal bytes, so that a key is packed in a few machine words
+  /// and is compared without evaluating the build exprs. 'key_sizes_' are the byte
+  /// sizes of their values.
+  bool fixed_size_keys_;
+  std::vector<int> key_sizes_;
+
   /// The current level this context is working on. Each level needs to use a
   /// different seed.
   int level_;
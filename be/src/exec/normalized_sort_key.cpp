@@ -0,0 +1,235 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/normalized_sort_key.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "runtime/datetime_value.h"
+#include "runtime/string_value.h"
+#include "util/types.h"
+
+namespace doris {
+
+const int NormalizedSortKey::STRING_PREFIX_SIZE;
+
+// writes the 'num_bytes' low bytes of 'value' in big endian order
+static inline void write_big_endian(unsigned __int128 value, int num_bytes, uint8_t* key) {
+    for (int i = num_bytes - 1; i >= 0; --i) {
+        key[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+// flips the sign bit, so signed integers compare as unsigned ones
+template<typename T>
+static inline unsigned __int128 flip_sign(T value) {
+    typedef typename std::make_unsigned<T>::type U;
+    U bits = static_cast<U>(value) ^ (static_cast<U>(1) << (sizeof(T) * 8 - 1));
+    return bits;
+}
+
+static inline unsigned __int128 flip_int128_sign(__int128 value) {
+    return static_cast<unsigned __int128>(value) ^ (static_cast<unsigned __int128>(1) << 127);
+}
+
+// positive floats are ordered as their bits, negative ones reversely
+template<typename F, typename U>
+static inline unsigned __int128 float_bits(F value) {
+    if (value == 0) {
+        // -0.0 equals 0.0
+        value = 0;
+    }
+    U bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const U sign = static_cast<U>(1) << (sizeof(U) * 8 - 1);
+    return (bits & sign) ? ~bits : (bits ^ sign);
+}
+
+int NormalizedSortKey::value_size(PrimitiveType type) {
+    switch (type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+        return 1 + 1;
+    case TYPE_SMALLINT:
+        return 1 + 2;
+    case TYPE_INT:
+    case TYPE_FLOAT:
+        return 1 + 4;
+    case TYPE_BIGINT:
+    case TYPE_DOUBLE:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        return 1 + 8;
+    case TYPE_LARGEINT:
+    case TYPE_DECIMALV2:
+        return 1 + 16;
+    default:
+        return 0;
+    }
+}
+
+bool NormalizedSortKey::is_supported(const std::vector<ExprContext*>& ordering_expr_ctxs) {
+    if (ordering_expr_ctxs.empty()) {
+        return false;
+    }
+    for (auto ctx : ordering_expr_ctxs) {
+        if (value_size(ctx->root()->type().type) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NormalizedSortKey::encode_value(const void* value, PrimitiveType type, bool is_asc,
+                                     bool nulls_first, uint8_t* key) {
+    int size = value_size(type);
+    DCHECK_GT(size, 0);
+    if (value == nullptr) {
+        // nulls are placed the same for both orders
+        key[0] = nulls_first ? 0 : 2;
+        memset(key + 1, 0, size - 1);
+        return;
+    }
+    key[0] = 1;
+    unsigned __int128 bits = 0;
+    switch (type) {
+    case TYPE_BOOLEAN:
+        bits = *reinterpret_cast<const bool*>(value) ? 1 : 0;
+        break;
+    case TYPE_TINYINT:
+        bits = flip_sign(*reinterpret_cast<const int8_t*>(value));
+        break;
+    case TYPE_SMALLINT:
+        bits = flip_sign(*reinterpret_cast<const int16_t*>(value));
+        break;
+    case TYPE_INT:
+        bits = flip_sign(*reinterpret_cast<const int32_t*>(value));
+        break;
+    case TYPE_BIGINT:
+        bits = flip_sign(*reinterpret_cast<const int64_t*>(value));
+        break;
+    case TYPE_FLOAT:
+        bits = float_bits<float, uint32_t>(*reinterpret_cast<const float*>(value));
+        break;
+    case TYPE_DOUBLE:
+        bits = float_bits<double, uint64_t>(*reinterpret_cast<const double*>(value));
+        break;
+    case TYPE_DATE:
+    case TYPE_DATETIME: {
+        // the fields in the order DateTimeValue compares them
+        const DateTimeValue* dt = reinterpret_cast<const DateTimeValue*>(value);
+        int64_t ymd = ((dt->year() * 13 + dt->month()) << 5) | dt->day();
+        int64_t hms = (dt->hour() << 12) | (dt->minute() << 6) | dt->second();
+        int64_t packed = (((ymd << 17) | hms) << 24) + dt->microsecond();
+        bits = flip_sign(packed);
+        break;
+    }
+    case TYPE_LARGEINT:
+    case TYPE_DECIMALV2: {
+        // may not be aligned
+        __int128 v;
+        memcpy(&v, value, sizeof(v));
+        bits = flip_int128_sign(v);
+        break;
+    }
+    default:
+        DCHECK(false) << "unsupported type of normalized sort key " << type;
+        break;
+    }
+    if (!is_asc) {
+        bits = ~bits;
+    }
+    write_big_endian(bits, size - 1, key + 1);
+}
+
+bool NormalizedSortKey::encode_string_prefix(const void* value, bool is_asc, bool nulls_first,
+                                             int size, uint8_t* key) {
+    DCHECK_GT(size, 0);
+    memset(key + 1, 0, size - 1);
+    if (value == nullptr) {
+        key[0] = nulls_first ? 0 : 2;
+        return true;
+    }
+    key[0] = 1;
+    const StringValue* str = reinterpret_cast<const StringValue*>(value);
+    int len = std::min<int>(str->len, size - 1);
+    if (len > 0 && memchr(str->ptr, '\0', len) != nullptr) {
+        return false;
+    }
+    memcpy(key + 1, str->ptr, len);
+    if (!is_asc) {
+        for (int i = 1; i < size; ++i) {
+            key[i] = ~key[i];
+        }
+    }
+    return true;
+}
+
+NormalizedSortKey::NormalizedSortKey(const std::vector<ExprContext*>& ordering_expr_ctxs,
+                                     const std::vector<bool>& is_asc,
+                                     const std::vector<bool>& nulls_first,
+                                     int max_size) :
+        _ordering_expr_ctxs(ordering_expr_ctxs),
+        _is_asc(is_asc),
+        _nulls_first(nulls_first),
+        _size(0),
+        _is_complete(true) {
+    DCHECK_EQ(_ordering_expr_ctxs.size(), _is_asc.size());
+    DCHECK_EQ(_ordering_expr_ctxs.size(), _nulls_first.size());
+    for (auto ctx : _ordering_expr_ctxs) {
+        PrimitiveType type = ctx->root()->type().type;
+        int size = value_size(type);
+        if (size == 0 && (type == TYPE_CHAR || type == TYPE_VARCHAR) && max_size - _size > 1) {
+            // the rest of the key
+            _types.push_back(type);
+            _sizes.push_back(std::min(max_size - _size, STRING_PREFIX_SIZE));
+            _size += _sizes.back();
+            _is_complete = false;
+            break;
+        }
+        if (size == 0 || size > max_size - _size) {
+            _is_complete = false;
+            break;
+        }
+        _types.push_back(type);
+        _sizes.push_back(size);
+        _size += size;
+    }
+    _ordering_expr_ctxs.resize(_types.size());
+}
+
+bool NormalizedSortKey::encode(TupleRow* row, uint8_t* key) const {
+    for (int i = 0; i < _ordering_expr_ctxs.size(); ++i) {
+        void* value = _ordering_expr_ctxs[i]->get_value(row);
+        if (_types[i] == TYPE_CHAR || _types[i] == TYPE_VARCHAR) {
+            if (!encode_string_prefix(value, _is_asc[i], _nulls_first[i], _sizes[i], key)) {
+                return false;
+            }
+        } else {
+            encode_value(value, _types[i], _is_asc[i], _nulls_first[i], key);
+        }
+        key += _sizes[i];
+    }
+    return true;
+}
+
+}
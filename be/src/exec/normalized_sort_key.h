@@ -0,0 +1,101 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_EXEC_NORMALIZED_SORT_KEY_H
+#define DORIS_BE_EXEC_NORMALIZED_SORT_KEY_H
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "runtime/primitive_type.h"
+
+namespace doris {
+
+class ExprContext;
+class TupleRow;
+
+// Encodes the values of ordering exprs of fixed width types into bytes which
+// compare by memcmp() in the order TupleRowComparator gives the rows: every
+// value is a null byte placing nulls first or last, then its bits in big
+// endian order, with the sign bit flipped so negative numbers come first and
+// inverted for descending order. Comparing two keys is then one memcmp()
+// instead of evaluating and comparing the exprs of both rows.
+//
+// Keys may also be prefixes of the order: a string is encoded by its first
+// bytes padded with zeros and ends the key, so do the exprs which don't fit
+// in the size of the key. Rows with equal prefixes must then be compared by
+// the exprs.
+class NormalizedSortKey {
+public:
+    // false if an expr is of a type which can't be encoded, e.g. a string
+    static bool is_supported(const std::vector<ExprContext*>& ordering_expr_ctxs);
+
+    // bytes of the key of one value of 'type', 0 if it is not of fixed width
+    static int value_size(PrimitiveType type);
+
+    // the most bytes of a string in a key, the null byte included
+    static const int STRING_PREFIX_SIZE = 32;
+
+    // Writes value_size(type) bytes to 'key', 'value' is nullptr for null.
+    static void encode_value(const void* value, PrimitiveType type, bool is_asc,
+                             bool nulls_first, uint8_t* key);
+
+    // Writes the key of a string of 'size' bytes, the null byte included.
+    // Returns false if the prefix contains '\0': strings are compared by
+    // strncmp(), which stops there, so the key does not order the string.
+    static bool encode_string_prefix(const void* value, bool is_asc, bool nulls_first,
+                                     int size, uint8_t* key);
+
+    // Keys are not longer than 'max_size' bytes, 'max_size' must be enough
+    // for the first expr if it is of a fixed width type.
+    NormalizedSortKey(const std::vector<ExprContext*>& ordering_expr_ctxs,
+                      const std::vector<bool>& is_asc,
+                      const std::vector<bool>& nulls_first,
+                      int max_size = INT_MAX);
+
+    // bytes of a key
+    int size() const { return _size; }
+
+    // true if rows with equal keys are equal by all exprs
+    bool is_complete() const { return _is_complete; }
+
+    // Writes the key of 'row' to 'key'. Returns false if the key does not
+    // order the row, which happens only if it is not complete.
+    bool encode(TupleRow* row, uint8_t* key) const;
+
+    int compare(const uint8_t* lhs, const uint8_t* rhs) const {
+        return memcmp(lhs, rhs, _size);
+    }
+
+private:
+    std::vector<ExprContext*> _ordering_expr_ctxs;
+    std::vector<bool> _is_asc;
+    std::vector<bool> _nulls_first;
+    std::vector<PrimitiveType> _types;
+    // bytes of the encoded exprs, the last may be a string prefix
+    std::vector<int> _sizes;
+    int _size;
+    bool _is_complete;
+};
+
+}
+
+#endif
@@ -29,16 +29,24 @@
 #include "exprs/expr.h"
 #include "exprs/binary_predicate.h"
 #include "exprs/in_predicate.h"
+#include "exprs/slot_ref.h"
 #include "gen_cpp/PlanNodes_types.h"
+#include "olap/read_ahead.h"
 #include "runtime/exec_env.h"
 #include "runtime/runtime_state.h"
 #include "runtime/row_batch.h"
+#include "runtime/runtime_filter.h"
+#include "runtime/runtime_filter_mgr.h"
 #include "runtime/string_value.h"
 #include "runtime/tuple_row.h"
+#include "runtime/tracer.h"
 #include "util/runtime_profile.h"
+#include "util/time.h"
 #include "util/thread_pool.hpp"
 #include "util/debug_util.h"
-#include "util/priority_thread_pool.hpp"
+#include "util/fair_share_thread_pool.h"
+#include "util/tuple_row_compare.h"
+#include "util/doris_metrics.h"
 #include "agent/cgroups_mgr.h"
 #include "common/resource_tls.h"
 #include <boost/variant.hpp>
@@ -49,6 +57,9 @@ namespace doris {
 
 #define DS_SUCCESS(x) ((x) >= 0)
 
+// share of the normal resource group in fe
+static const int DEFAULT_SCANNER_WEIGHT = 400;
+
 OlapScanNode::OlapScanNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs):
         ScanNode(pool, tnode, descs),
         _tuple_id(tnode.olap_scan_node.tuple_id),
@@ -61,7 +72,6 @@ OlapScanNode::OlapScanNode(ObjectPool* pool, const TPlanNode& tnode, const Descr
         _start(false),
         _scanner_done(false),
         _transfer_done(false),
-        _wait_duration(0, 0, 1, 0),
         _status(Status::OK),
         _resource_info(nullptr),
         _buffered_bytes(0),
@@ -85,6 +95,8 @@ Status OlapScanNode::init(const TPlanNode& tnode, RuntimeState* state) {
     // Before, we support scan data ordered, but is not used in production
     // Now, we drop this functional
     DCHECK(!_is_result_order) << "ordered result don't support any more";
+    _sorted_output = tnode.olap_scan_node.__isset.sorted_output
+        && tnode.olap_scan_node.sorted_output;
 
     return Status::OK;
 }
@@ -128,17 +140,37 @@ void OlapScanNode::_init_counter(RuntimeState* state) {
         ADD_COUNTER(_runtime_profile, "RowsVectorPredFiltered", TUnit::UNIT);
     _vec_cond_timer =
         ADD_TIMER(_runtime_profile, "VectorPredEvalTime");
+    _lazy_read_skipped_counter =
+        ADD_COUNTER(_runtime_profile, "LazyReadSkippedValues", TUnit::UNIT);
 
     _stats_filtered_counter =
         ADD_COUNTER(_runtime_profile, "RowsStatsFiltered", TUnit::UNIT);
     _del_filtered_counter =
         ADD_COUNTER(_runtime_profile, "RowsDelFiltered", TUnit::UNIT);
+    _replaced_filtered_counter =
+        ADD_COUNTER(_runtime_profile, "RowsReplacedFiltered", TUnit::UNIT);
+    _bitmap_index_filtered_counter =
+        ADD_COUNTER(_runtime_profile, "RowsBitmapIndexFiltered", TUnit::UNIT);
+    _pre_aggregate_rows_counter =
+        ADD_COUNTER(_runtime_profile, "PreAggregateRowsRead", TUnit::UNIT);
+    _metadata_rows_counter =
+        ADD_COUNTER(_runtime_profile, "RowsAnsweredByMetadata", TUnit::UNIT);
 
     _io_timer = ADD_TIMER(_runtime_profile, "IOTimer");
     _decompressor_timer = ADD_TIMER(_runtime_profile, "DecompressorTimer");
+    _data_page_cache_hit_counter =
+        ADD_COUNTER(_runtime_profile, "DataPageCacheHit", TUnit::UNIT);
     _index_load_timer = ADD_TIMER(_runtime_profile, "IndexLoadTime");
 
     _scan_timer = ADD_TIMER(_runtime_profile, "ScanTime");
+
+    _runtime_filter_wait_timer = ADD_TIMER(_runtime_profile, "RuntimeFilterWaitTime");
+    _runtime_filter_counter = ADD_COUNTER(_runtime_profile, "RuntimeFiltersApplied", TUnit::UNIT);
+    _topn_conditions_counter = ADD_COUNTER(_runtime_profile, "TopNConditionsPushed", TUnit::UNIT);
+    _topn_filtered_counter = ADD_COUNTER(_runtime_profile, "RowsTopNFiltered", TUnit::UNIT);
+    _scanner_queue_wait_timer = ADD_TIMER(_runtime_profile, "ScannerQueueWaitTime");
+    _peak_scanner_tasks_counter = _runtime_profile->AddHighWaterMarkCounter(
+            "PeakScannerTasks", TUnit::UNIT);
 }
 
 Status OlapScanNode::prepare(RuntimeState* state) {
@@ -171,6 +203,25 @@ Status OlapScanNode::prepare(RuntimeState* state) {
         _string_slots.push_back(slots[i]);
     }
 
+    if (_sorted_output) {
+        // the rows are ordered by the key columns up to the first one not read
+        for (const std::string& key_name : _olap_scan_node.key_column_name) {
+            SlotDescriptor* key_slot = NULL;
+            for (SlotDescriptor* slot : slots) {
+                if (slot->is_materialized() && slot->col_name() == key_name) {
+                    key_slot = slot;
+                    break;
+                }
+            }
+            if (key_slot == NULL) {
+                break;
+            }
+            Expr* expr = state->obj_pool()->add(new SlotRef(key_slot));
+            _sort_key_ctxs.push_back(state->obj_pool()->add(new ExprContext(expr)));
+        }
+        RETURN_IF_ERROR(Expr::prepare(_sort_key_ctxs, state, row_desc(), expr_mem_tracker()));
+    }
+
     if (state->codegen_level() > 0) {
         LlvmCodeGen* codegen = NULL;
         RETURN_IF_ERROR(state->get_codegen(&codegen));
@@ -183,6 +234,9 @@ Status OlapScanNode::prepare(RuntimeState* state) {
     }
 
     _runtime_state = state;
+    _free_row_batches.reset(new RowBatchFreeList(
+            row_desc(), state->batch_size(), state->fragment_mem_tracker(),
+            _max_materialized_row_batches));
     return Status::OK;
 }
 
@@ -191,6 +245,7 @@ Status OlapScanNode::open(RuntimeState* state) {
     SCOPED_TIMER(_runtime_profile->total_time_counter());
     RETURN_IF_CANCELLED(state);
     RETURN_IF_ERROR(ExecNode::open(state));
+    RETURN_IF_ERROR(Expr::open(_sort_key_ctxs, state));
 
     for (int conj_idx = 0; conj_idx < _conjunct_ctxs.size(); ++conj_idx) {
         // if conjunct is constant, compute direct and set eos = true
@@ -213,8 +268,18 @@ Status OlapScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eo
 
     // check if Canceled.
     if (state->is_cancelled()) {
-        boost::unique_lock<boost::mutex> l(_row_batches_lock);
-        _transfer_done = true;
+        {
+            boost::unique_lock<boost::mutex> l(_row_batches_lock);
+            _transfer_done = true;
+        }
+        // the queued batches are not returned any more, this is the only consumer
+        // of the queues so they are freed here instead of when the node is closed
+        RowBatch* row_batch = NULL;
+        while (_pop_batch(&row_batch)) {
+            __sync_fetch_and_sub(&_buffered_bytes,
+                                 row_batch->tuple_data_pool()->total_reserved_bytes());
+            delete row_batch;
+        }
         boost::lock_guard<boost::mutex> guard(_status_mutex);
         if (LIKELY(_status.ok())) {
             _status = Status::CANCELLED;
@@ -238,31 +303,58 @@ Status OlapScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eo
         }
 
         _start = true;
+        // a runtime filter leaves nothing to scan
+        if (_eos) {
+            *eos = true;
+            return Status::OK;
+        }
+    }
+
+    if (_sorted_output) {
+        return _get_next_sorted(state, row_batch, eos);
     }
 
     // wait for batch from queue
     RowBatch* materialized_batch = NULL;
-    {
-        boost::unique_lock<boost::mutex> l(_row_batches_lock);
-        while (_materialized_row_batches.empty() && !_transfer_done) {
+    bool waited = false;
+    while (!_pop_batch(&materialized_batch)) {
+        EventCount::Key key = _batch_added.prepare_wait();
+        bool transfer_done = false;
+        {
+            boost::lock_guard<boost::mutex> l(_row_batches_lock);
             if (state->is_cancelled()) {
                 _transfer_done = true;
             }
-
-            _row_batch_added_cv.timed_wait(l, _wait_duration);
+            transfer_done = _transfer_done;
         }
+        // the batches queued before the scanners are done are still returned
+        if (transfer_done || _pop_batch(&materialized_batch)) {
+            _batch_added.cancel_wait();
+            if (transfer_done && materialized_batch == NULL) {
+                _pop_batch(&materialized_batch);
+            }
+            break;
+        }
+        waited = true;
+        // cancellation is not notified, it is checked every second
+        _batch_added.wait(key, 1000);
+    }
 
-        if (!_materialized_row_batches.empty()) {
-            materialized_batch = dynamic_cast<RowBatch*>(_materialized_row_batches.front());
-            DCHECK(materialized_batch != NULL);
-            _materialized_row_batches.pop_front();
+    if (materialized_batch != NULL) {
+        std::vector<OlapScanner*> scanners;
+        {
+            boost::unique_lock<boost::mutex> l(_row_batches_lock);
+            if (_concurrency_controller != nullptr) {
+                _concurrency_controller->on_batch_consumed(waited);
+            }
+            // scanners wait for room in the queue
+            _choose_scanners(&scanners);
         }
+        _submit_scanners(scanners);
     }
 
     // return batch
     if (NULL != materialized_batch) {
-        // notify scanner
-        _row_batch_consumed_cv.notify_one();
         // get scanner's batch memory
         row_batch->acquire_state(materialized_batch);
         _num_rows_returned += row_batch->num_rows();
@@ -280,7 +372,6 @@ Status OlapScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eo
                 _transfer_done = true;
             }
 
-            _row_batch_consumed_cv.notify_all();
             *eos = true;
             LOG(INFO) << "OlapScanNode ReachedLimit.";
         } else {
@@ -297,7 +388,7 @@ Status OlapScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eo
         __sync_fetch_and_sub(&_buffered_bytes,
                              row_batch->tuple_data_pool()->total_reserved_bytes());
 
-        delete materialized_batch;
+        _free_row_batches->put(materialized_batch);
         return Status::OK;
     }
 
@@ -320,37 +411,34 @@ Status OlapScanNode::close(RuntimeState* state) {
     }
     RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::CLOSE));
 
-    // change done status
+    // change done status, no scanner is scheduled any more, wait for the
+    // running ones
     {
         boost::unique_lock<boost::mutex> l(_row_batches_lock);
         _transfer_done = true;
+        while (_running_thread > 0) {
+            _scanner_exit_cv.wait(l);
+        }
     }
-    // notify all scanner thread
-    _row_batch_consumed_cv.notify_all();
-    _row_batch_added_cv.notify_all();
-    _scan_batch_added_cv.notify_all();
 
-    // join transfer thread
-    _transfer_thread.join_all();
+    // stops the merge threads reading the scanners
+    _merger.reset();
 
     // clear some row batch in queue
-    for (auto row_batch : _materialized_row_batches) {
+    RowBatch* row_batch = NULL;
+    while (_pop_batch(&row_batch)) {
         delete row_batch;
     }
-
-    _materialized_row_batches.clear();
-
-    for (auto row_batch : _scan_row_batches) {
-        delete row_batch;
-    }
-
-    _scan_row_batches.clear();
+    _scanner_batches.clear();
+    _free_row_batches.reset();
 
     // OlapScanNode terminate by exception
     // so that initiative close the Scanner
     for (auto scanner : _all_olap_scanners) {
         scanner->close(state);
     }
+    _sorted_runs.clear();
+    Expr::close(_sort_key_ctxs, state);
 
     VLOG(1) << "OlapScanNode::close()";
     return ScanNode::close(state);
@@ -377,6 +465,13 @@ Status OlapScanNode::start_scan(RuntimeState* state) {
     VLOG(1) << "NormalizeConjuncts";
     // 1. Convert conjuncts to ColumnValueRange in each column
     RETURN_IF_ERROR(normalize_conjuncts());
+    RETURN_IF_ERROR(normalize_like_predicates());
+
+    VLOG(1) << "ApplyRuntimeFilters";
+    RETURN_IF_ERROR(apply_runtime_filters(state));
+    if (_eos) {
+        return Status::OK;
+    }
 
     VLOG(1) << "BuildOlapFilters";
     // 2. Using ColumnValueRange to Build OlapEngine filters
@@ -513,6 +608,89 @@ Status OlapScanNode::normalize_conjuncts() {
     return Status::OK;
 }
 
+Status OlapScanNode::normalize_like_predicates() {
+    _like_patterns.clear();
+    for (auto ctx : _conjunct_ctxs) {
+        Expr* root_expr = ctx->root();
+        if (TExprNodeType::FUNCTION_CALL != root_expr->node_type()
+                || root_expr->fn().name.function_name != "like"
+                || root_expr->get_num_children() != 2
+                || TExprNodeType::SLOT_REF != root_expr->get_child(0)->node_type()) {
+            continue;
+        }
+        Expr* pattern_expr = root_expr->get_child(1);
+        if (!pattern_expr->is_constant()) {
+            continue;
+        }
+        std::vector<SlotId> slot_ids;
+        if (root_expr->get_child(0)->get_slot_ids(&slot_ids) != 1) {
+            continue;
+        }
+        SlotDescriptor* slot = nullptr;
+        for (auto slot_desc : _tuple_desc->slots()) {
+            if (slot_desc->id() == slot_ids[0]) {
+                slot = slot_desc;
+                break;
+            }
+        }
+        if (slot == nullptr
+                || (slot->type().type != TYPE_VARCHAR && slot->type().type != TYPE_CHAR)) {
+            continue;
+        }
+        StringValue* pattern = reinterpret_cast<StringValue*>(ctx->get_value(pattern_expr, NULL));
+        if (pattern == nullptr) {
+            continue;
+        }
+        _like_patterns.emplace_back(slot->col_name(), pattern->to_string());
+    }
+    return Status::OK;
+}
+
+Status OlapScanNode::apply_runtime_filters(RuntimeState* state) {
+    if (!_olap_scan_node.__isset.runtime_filters) {
+        return Status::OK;
+    }
+    SCOPED_TIMER(_runtime_filter_wait_timer);
+    // all filters are built at the same time, so they share the wait time
+    int64_t deadline_ms = MonotonicMillis() + state->query_options().runtime_filter_wait_time_ms;
+    for (auto& tfilter : _olap_scan_node.runtime_filters) {
+        std::shared_ptr<RuntimeFilter> filter = state->exec_env()->runtime_filter_mgr()->take(
+            state->fragment_instance_id(), tfilter.filter_id, tfilter.num_sources, deadline_ms);
+        if (filter == nullptr) {
+            VLOG(1) << "runtime filter " << tfilter.filter_id << " is not published in time";
+            continue;
+        }
+        SlotDescriptor* slot = nullptr;
+        for (auto slot_desc : _tuple_desc->slots()) {
+            if (slot_desc->col_name() == tfilter.column_name) {
+                slot = slot_desc;
+                break;
+            }
+        }
+        if (slot == nullptr || slot->type().type != filter->type()) {
+            LOG(WARNING) << "runtime filter " << tfilter.filter_id
+                << " does not match column " << tfilter.column_name;
+            continue;
+        }
+        COUNTER_UPDATE(_runtime_filter_counter, 1);
+        if (filter->is_empty()) {
+            // the build side has no rows, none of this scan can be joined
+            _eos = true;
+            return Status::OK;
+        }
+        auto iter = _column_value_ranges.find(tfilter.column_name);
+        if (iter != _column_value_ranges.end()) {
+            AddMinMaxVisitor visitor(filter->min_value(), filter->max_value());
+            RETURN_IF_ERROR(boost::apply_visitor(visitor, iter->second));
+        }
+        if (filter->bloom_filter() != nullptr) {
+            _bloom_filters.emplace_back(tfilter.column_name, filter->bloom_filter());
+        }
+        _runtime_filters.push_back(filter);
+    }
+    return Status::OK;
+}
+
 Status OlapScanNode::build_olap_filters() {
     _olap_filter.clear();
 
@@ -642,6 +820,11 @@ Status OlapScanNode::start_scan_thread(RuntimeState* state) {
         OlapScanner* scanner = new OlapScanner(
             state, this, _olap_scan_node.is_preaggregation,
             scan_range.get(), key_ranges);
+        scanner->set_id(_scanner_batches.size());
+        // a scanner is only started while fewer batches are queued, its queue can
+        // not be full then
+        _scanner_batches.emplace_back(
+            new SpscQueue<RowBatch*>(std::max(_max_materialized_row_batches, 1)));
 
         _scanner_pool->add(scanner);
         _olap_scanners.push_back(scanner);
@@ -654,9 +837,48 @@ Status OlapScanNode::start_scan_thread(RuntimeState* state) {
     _progress = ProgressUpdater(ss.str(), _olap_scanners.size(), 1);
     _progress.set_logging_level(1);
 
-    _transfer_thread.add_thread(
-        new boost::thread(
-            &OlapScanNode::transfer_thread, this, state));
+    // scanner open pushdown to scanThread
+    for (auto scanner : _olap_scanners) {
+        RETURN_IF_ERROR(Expr::clone_if_not_exists(
+                _conjunct_ctxs, state, scanner->conjunct_ctxs()));
+    }
+
+    // the scanners of all instances of a query share its weight
+    _scanner_group = state->query_id().hi ^ state->query_id().lo;
+    _scanner_weight = DEFAULT_SCANNER_WEIGHT;
+    if (_resource_info != nullptr) {
+        _scanner_weight = state->exec_env()->cgroups_mgr()->get_level_share(
+                _resource_info->user, _resource_info->group, DEFAULT_SCANNER_WEIGHT);
+    }
+
+    if (_sorted_output) {
+        return _start_sorted_merge(state);
+    }
+
+    _scanner_mem_limit = 512 * 1024 * 1024;
+    // TODO(zc): use memory limit
+    if (state->fragment_mem_tracker() != nullptr) {
+        _scanner_mem_limit = state->fragment_mem_tracker()->limit();
+    }
+    _max_scanner_tasks = _max_materialized_row_batches;
+    if (config::doris_scanner_row_num > state->batch_size()) {
+        _max_scanner_tasks /= config::doris_scanner_row_num / state->batch_size();
+    }
+    _max_scanner_tasks = std::max(1, _max_scanner_tasks);
+    if (config::doris_scanner_adaptive_concurrency) {
+        // half of them to begin with, the parent's pace decides afterwards
+        _concurrency_controller.reset(new ScannerConcurrencyController(
+                _max_scanner_tasks, _max_scanner_tasks / 2));
+    }
+
+    // the scanners are run by the tasks of the shared scanner thread pool, which
+    // schedule the next ones as they end
+    std::vector<OlapScanner*> scanners;
+    {
+        boost::unique_lock<boost::mutex> l(_row_batches_lock);
+        _choose_scanners(&scanners);
+    }
+    _submit_scanners(scanners);
 
     return Status::OK;
 }
@@ -1013,152 +1235,167 @@ Status OlapScanNode::get_sub_scan_range(
     return Status::OK;
 }
 
-void OlapScanNode::transfer_thread(RuntimeState* state) {
-    // scanner open pushdown to scanThread
-    Status status = Status::OK;
-    for (auto scanner : _olap_scanners) {
-        status = Expr::clone_if_not_exists(_conjunct_ctxs, state, scanner->conjunct_ctxs());
-        if (!status.ok()) {
-            boost::lock_guard<boost::mutex> guard(_status_mutex);
-            _status = status;
-            break;
-        }
+void OlapScanNode::_choose_scanners(std::vector<OlapScanner*>* scanners) {
+    if (_transfer_done || _scanner_done) {
+        return;
+    }
+    // scanners add their batches without waiting, none is started while the
+    // queue is full
+    if (_num_queued_batches.load() >= _max_materialized_row_batches) {
+        return;
     }
-
-    /*********************************
-     * 优先级调度基本策略:
-     * 1. 通过查询拆分的Range个数来确定初始nice值
-     *    Range个数越多，越倾向于认定为大查询，nice值越小
-     * 2. 通过查询累计读取的数据量来调整nice值
-     *    读取的数据越多，越倾向于认定为大查询，nice值越小
-     * 3. 通过nice值来判断查询的优先级
-     *    nice值越大的，越优先获得的查询资源
-     * 4. 定期提高队列内残留任务的优先级，避免大查询完全饿死
-     *********************************/
-    PriorityThreadPool* thread_pool = state->exec_env()->thread_pool();
-    _total_assign_num = 0;
-    _nice = 18 + std::max(0, 2 - (int)_olap_scanners.size() / 5);
-    std::list<OlapScanner*> olap_scanners;
-
-    int64_t mem_limit = 512 * 1024 * 1024;
-    // TODO(zc): use memory limit
     int64_t mem_consume = __sync_fetch_and_add(&_buffered_bytes, 0);
-    if (state->fragment_mem_tracker() != nullptr) {
-        mem_limit = state->fragment_mem_tracker()->limit();
-        mem_consume = state->fragment_mem_tracker()->consumption();
+    if (_runtime_state->fragment_mem_tracker() != nullptr) {
+        mem_consume = _runtime_state->fragment_mem_tracker()->consumption();
     }
-    int max_thread = _max_materialized_row_batches;
-    if (config::doris_scanner_row_num > state->batch_size()) {
-        max_thread /= config::doris_scanner_row_num / state->batch_size();
+    // How many thread can apply to this query
+    int64_t num_scanners = 0;
+    if (mem_consume < (_scanner_mem_limit * 6) / 10) {
+        int max_tasks = _concurrency_controller != nullptr
+            ? _concurrency_controller->target() : _max_scanner_tasks;
+        num_scanners = max_tasks - _running_thread;
+    } else if (_running_thread == 0 && _num_queued_batches.load() <= 0) {
+        // Memory already exceed, one scanner keeps the scan going
+        num_scanners = 1;
     }
-    // read from scanner
-    while (LIKELY(status.ok())) {
-        int assigned_thread_num = 0;
-        // copy to local
-        {
-            boost::unique_lock<boost::mutex> l(_scan_batches_lock);
-            assigned_thread_num = _running_thread;
-            // int64_t buf_bytes = __sync_fetch_and_add(&_buffered_bytes, 0);
-            // How many thread can apply to this query
-            size_t thread_slot_num = 0;
-            mem_consume = __sync_fetch_and_add(&_buffered_bytes, 0);
-            if (state->fragment_mem_tracker() != nullptr) {
-                mem_consume = state->fragment_mem_tracker()->consumption();
-            }
-            if (mem_consume < (mem_limit * 6) / 10) {
-                thread_slot_num = max_thread - assigned_thread_num;
-            } else {
-                // Memory already exceed
-                if (_scan_row_batches.empty()) {
-                    // NOTE(zc): here need to lock row_batches_lock_
-                    //  be worried about dead lock, so don't check here
-                    // if (materialized_row_batches_.empty()) {
-                    //     LOG(FATAL) << "Scan_row_batches_ and materialized_row_batches_"
-                    //         " are empty when memory exceed";
-                    // }
-                    // Just for notify if scan_row_batches_ is empty and no running thread
-                    if (assigned_thread_num == 0) {
-                        thread_slot_num = 1;
-                        // NOTE: if olap_scanners_ is empty, scanner_done_ should be true
-                    }
-                }
-            }
-            thread_slot_num = std::min(thread_slot_num, _olap_scanners.size());
-            for (int i = 0; i < thread_slot_num; ++i) {
-                olap_scanners.push_back(_olap_scanners.front());
-                _olap_scanners.pop_front();
-                _running_thread++;
-                assigned_thread_num++;
-            }
-        }
+    num_scanners = std::min<int64_t>(num_scanners, _olap_scanners.size());
+    for (int i = 0; i < num_scanners; ++i) {
+        scanners->push_back(_olap_scanners.front());
+        _olap_scanners.pop_front();
+        _running_thread++;
+    }
+    if (num_scanners > 0) {
+        _peak_scanner_tasks_counter->set(_running_thread);
+    }
+}
 
-        auto iter = olap_scanners.begin();
-        while (iter != olap_scanners.end()) {
-            PriorityThreadPool::Task task;
-            task.work_function = boost::bind(&OlapScanNode::scanner_thread, this, *iter);
-            task.priority = _nice;
-            if (thread_pool->offer(task)) {
-                olap_scanners.erase(iter++);
-            } else {
-                LOG(FATAL) << "Failed to assign scanner task to thread pool!";
-            }
-            ++_total_assign_num;
+void OlapScanNode::_submit_scanners(const std::vector<OlapScanner*>& scanners) {
+    if (scanners.empty()) {
+        return;
+    }
+    FairShareThreadPool* thread_pool = _runtime_state->exec_env()->thread_pool();
+    for (auto scanner : scanners) {
+        int64_t submit_nanos = MonotonicNanos();
+        if (!thread_pool->offer(_scanner_group, _scanner_weight,
+                                std::bind(&OlapScanNode::scanner_thread, this,
+                                          scanner, submit_nanos))) {
+            LOG(FATAL) << "Failed to assign scanner task to thread pool!";
         }
+    }
+}
 
-        RowBatchInterface* scan_batch = NULL;
-        {
-            // 1 scanner idle task not empty, assign new sanner task
-            boost::unique_lock<boost::mutex> l(_scan_batches_lock);
-
-            // scanner_row_num = 16k
-            // 16k * 10 * 12 * 8 = 15M(>2s)  --> nice=10
-            // 16k * 20 * 22 * 8 = 55M(>6s)  --> nice=0
-            while (_nice > 0
-                       && _total_assign_num > (22 - _nice) * (20 - _nice) * 6) {
-                --_nice;
-            }
-
-            // 2 wait when all scanner are running & no result in queue
-            while (UNLIKELY(_running_thread == assigned_thread_num
-                            && _scan_row_batches.empty()
-                            && !_scanner_done)) {
-                _scan_batch_added_cv.wait(l);
-            }
+Status OlapScanNode::_start_sorted_merge(RuntimeState* state) {
+    // a scanner returns its key ranges one after the other, which follow each
+    // other in key order, so each is a sorted run
+    std::vector<SortedRunMerger::RunBatchSupplier> runs;
+    for (OlapScanner* scanner : _olap_scanners) {
+        SortedRun run;
+        run.scanner = scanner;
+        run.batch.reset(new RowBatch(row_desc(), state->batch_size(), mem_tracker()));
+        run.eos = false;
+        _sorted_runs.push_back(std::move(run));
+        runs.push_back(std::bind(&OlapScanNode::_get_sorted_run_batch,
+                                 this, runs.size(), std::placeholders::_1));
+    }
+    _olap_scanners.clear();
+
+    // the storage orders nulls before all other values
+    TupleRowComparator less_than(_sort_key_ctxs, _sort_key_ctxs, true, true);
+    _merger.reset(new SortedRunMerger(less_than, &_row_descriptor, runtime_profile(), false));
+    // as decided by SortedRunMerger::prepare_parallel()
+    _parallel_sorted_merge = std::min<int>(config::doris_sorted_scan_merge_threads,
+                                           runs.size() / 2) > 1;
+    if (_parallel_sorted_merge) {
+        return _merger->prepare_parallel(runs, config::doris_sorted_scan_merge_threads,
+                                         state, mem_tracker());
+    }
+    return _merger->prepare(runs);
+}
 
-            // 3 transfer result row batch when queue is not empty
-            if (LIKELY(!_scan_row_batches.empty())) {
-                scan_batch = _scan_row_batches.front();
-                _scan_row_batches.pop_front();
+Status OlapScanNode::_get_sorted_run_batch(int run, RowBatch** batch) {
+    SortedRun* sorted_run = &_sorted_runs[run];
+    OlapScanner* scanner = sorted_run->scanner;
+    *batch = NULL;
+    if (!scanner->is_open()) {
+        RETURN_IF_ERROR(scanner->open());
+        scanner->set_opened();
+    }
+    while (!sorted_run->eos) {
+        RETURN_IF_CANCELLED(_runtime_state);
+        // the merger is done with the rows of the last batch
+        sorted_run->batch->reset();
+        RETURN_IF_ERROR(scanner->get_batch(
+                _runtime_state, sorted_run->batch.get(), &sorted_run->eos));
+        if (sorted_run->batch->num_rows() > 0) {
+            *batch = sorted_run->batch.get();
+            return Status::OK;
+        }
+    }
+    scanner->close(_runtime_state);
+    return Status::OK;
+}
 
-                // delete scan_batch if transfer thread should be stoped
-                // because scan_batch wouldn't be useful anymore
-                if (UNLIKELY(_transfer_done)) {
-                    delete scan_batch;
-                    scan_batch = NULL;
-                }
-            } else {
-                if (_scanner_done) {
-                    break;
-                }
+Status OlapScanNode::_get_next_sorted(RuntimeState* state, RowBatch* row_batch, bool* eos) {
+    if (_merger == nullptr) {
+        *eos = true;
+        return Status::OK;
+    }
+    RETURN_IF_ERROR(_merger->get_next(row_batch, eos));
+    _num_rows_returned += row_batch->num_rows();
+    if (reached_limit()) {
+        int num_rows_over = _num_rows_returned - _limit;
+        row_batch->set_num_rows(row_batch->num_rows() - num_rows_over);
+        _num_rows_returned -= num_rows_over;
+        *eos = true;
+    }
+    COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+
+    if (*eos) {
+        _eos = true;
+        _merger->transfer_all_resources(row_batch);
+        // the rows point into the batches of the runs unless merge threads copied
+        // them, which may still read the runs
+        if (!_parallel_sorted_merge) {
+            for (SortedRun& run : _sorted_runs) {
+                run.batch->transfer_resource_ownership(row_batch);
             }
         }
+    }
+    return Status::OK;
+}
 
-        if (NULL != scan_batch) {
-            add_one_batch(scan_batch);
+bool OlapScanNode::_pop_batch(RowBatch** batch) {
+    if (_num_queued_batches.load() <= 0) {
+        return false;
+    }
+    for (size_t i = 0; i < _scanner_batches.size(); ++i) {
+        SpscQueue<RowBatch*>* batches = _scanner_batches[_next_scanner_batches].get();
+        _next_scanner_batches = (_next_scanner_batches + 1) % _scanner_batches.size();
+        if (batches->try_pop(batch)) {
+            --_num_queued_batches;
+            return true;
         }
     }
-
-    VLOG(1) << "TransferThread finish.";
-    boost::unique_lock<boost::mutex> l(_row_batches_lock);
-    _transfer_done = true;
-    _row_batch_added_cv.notify_all();
+    return false;
 }
 
-void OlapScanNode::scanner_thread(OlapScanner* scanner) {
+void OlapScanNode::scanner_thread(OlapScanner* scanner, int64_t submit_nanos) {
+    int64_t wait_nanos = MonotonicNanos() - submit_nanos;
+    COUNTER_UPDATE(_scanner_queue_wait_timer, wait_nanos);
+    DorisMetrics::scanner_tasks_total.increment(1);
+    DorisMetrics::scanner_queue_wait_us.increment(wait_nanos / 1000);
+    ReadAheadQueue::set_thread_group(_scanner_group, _scanner_weight);
+
     Status status = Status::OK;
     bool eos = false;
     RuntimeState* state = scanner->runtime_state();
     DCHECK(NULL != state);
+    {
+        int64_t now_ns = Tracer::now_ns();
+        Span span(state->trace_context(), "scanner_schedule_wait", now_ns - wait_nanos);
+        span.add_attribute("node_id", id());
+        span.end(now_ns);
+    }
     if (!scanner->is_open()) {
         status = scanner->open();
         if (!status.ok()) {
@@ -1174,7 +1411,9 @@ void OlapScanNode::scanner_thread(OlapScanner* scanner) {
         CgroupsMgr::apply_cgroup(_resource_info->user, _resource_info->group);
     }
 
-    std::vector<RowBatch*> row_batchs;
+    SpscQueue<RowBatch*>* batches = _scanner_batches[scanner->id()].get();
+    int64_t slice_start_nanos = MonotonicNanos();
+    int64_t io_ns_start = scanner->io_ns();
 
     // Because we use thread pool to scan data from storage. One scanner can't
     // use this thread too long, this can starve other query's scanner. So, we
@@ -1191,10 +1430,25 @@ void OlapScanNode::scanner_thread(OlapScanner* scanner) {
             LOG(INFO) << "Scan thread cancelled, cause query done, maybe reach limit.";
             break;
         }
-        RowBatch *row_batch = new RowBatch(
-                this->row_desc(), state->batch_size(), _runtime_state->fragment_mem_tracker());
+        if (UNLIKELY(state->is_cancelled())) {
+            eos = true;
+            status = Status::CANCELLED;
+            break;
+        }
+        // the other scanners already produced the rows of the limit
+        if (_scan_rows_left() == 0) {
+            eos = true;
+            break;
+        }
+        // the rest waits for the next slice
+        if (batches->full()) {
+            break;
+        }
+        RowBatch* row_batch = _free_row_batches->get();
         row_batch->set_scanner_id(scanner->id());
+        int64_t batch_start_nanos = MonotonicNanos();
         status = scanner->get_batch(_runtime_state, row_batch, &eos);
+        DorisMetrics::scanner_batch_latency_us.add((MonotonicNanos() - batch_start_nanos) / 1000);
         if (!status.ok()) {
             LOG(WARNING) << "Scan thread read OlapScanner failed!";
             eos = true;
@@ -1203,72 +1457,77 @@ void OlapScanNode::scanner_thread(OlapScanner* scanner) {
         // 4. if status not ok, change status_.
         if (UNLIKELY(row_batch->num_rows() == 0)) {
             // may be failed, push already, scan node delete this batch.
-            delete row_batch;
+            _free_row_batches->put(row_batch);
             row_batch = NULL;
         } else {
-            row_batchs.push_back(row_batch);
             __sync_fetch_and_add(&_buffered_bytes,
                                  row_batch->tuple_data_pool()->total_reserved_bytes());
+            __sync_fetch_and_add(&_num_rows_produced, row_batch->num_rows());
+            // this task is the only producer of the queue of the scanner
+            batches->try_push(row_batch);
+            ++_num_queued_batches;
+            _batch_added.notify();
         }
         raw_rows_read = scanner->raw_rows_read();
     }
 
-    boost::unique_lock<boost::mutex> l(_scan_batches_lock);
-    // if we failed, check status.
-    if (UNLIKELY(!status.ok())) {
-        _transfer_done = true;
-        boost::lock_guard<boost::mutex> guard(_status_mutex);
-        if (LIKELY(_status.ok())) {
-            _status = status;
-        }
-    }
+    int64_t slice_nanos = MonotonicNanos() - slice_start_nanos;
+    int64_t slice_io_nanos = scanner->io_ns() - io_ns_start;
 
-    bool global_status_ok = false;
+    std::vector<OlapScanner*> next_scanners;
     {
-        boost::lock_guard<boost::mutex> guard(_status_mutex);
-        global_status_ok = _status.ok();
-    }
-    if (UNLIKELY(!global_status_ok)) {
-        eos = true;
-        for (auto rb : row_batchs) {
-            delete rb;
+        boost::unique_lock<boost::mutex> l(_row_batches_lock);
+        // if we failed, check status.
+        if (UNLIKELY(!status.ok())) {
+            _transfer_done = true;
+            boost::lock_guard<boost::mutex> guard(_status_mutex);
+            if (LIKELY(_status.ok())) {
+                _status = status;
+            }
         }
-    } else {
-        for (auto rb : row_batchs) {
-            _scan_row_batches.push_back(rb);
+
+        {
+            boost::lock_guard<boost::mutex> guard(_status_mutex);
+            if (UNLIKELY(!_status.ok())) {
+                eos = true;
+            }
         }
-    }
-    // Scanner thread completed. Take a look and update the status
-    if (UNLIKELY(eos)) {
-        _progress.update(1);
-        if (_progress.done()) {
-            // this is the right out
+        // Scanner thread completed. Take a look and update the status
+        if (UNLIKELY(eos)) {
+            _progress.update(1);
+            if (_progress.done()) {
+                // this is the right out
+                _scanner_done = true;
+            }
+            scanner->close(_runtime_state);
+        } else {
+            _olap_scanners.push_front(scanner);
+        }
+        // the idle scanners are not needed any more once the limit is met,
+        // the node is done when the running ones exit
+        if (_scan_rows_left() == 0) {
             _scanner_done = true;
         }
-        scanner->close(_runtime_state);
-    } else {
-        _olap_scanners.push_front(scanner);
-    }
-    _running_thread--;
-    _scan_batch_added_cv.notify_one();
-}
-
-Status OlapScanNode::add_one_batch(RowBatchInterface* row_batch) {
-    {
-        boost::unique_lock<boost::mutex> l(_row_batches_lock);
-
-        while (UNLIKELY(_materialized_row_batches.size()
-                        >= _max_materialized_row_batches
-                        && !_transfer_done)) {
-            _row_batch_consumed_cv.wait(l);
+        _running_thread--;
+        if (_scanner_done && _running_thread == 0) {
+            VLOG(1) << "all scanners of the scan node are done";
+            _transfer_done = true;
         }
 
-        VLOG(2) << "Push row_batch to materialized_row_batches";
-        _materialized_row_batches.push_back(row_batch);
+        if (_concurrency_controller != nullptr) {
+            _concurrency_controller->on_slice_done(
+                    slice_nanos, slice_io_nanos,
+                    _num_queued_batches.load(), _max_materialized_row_batches);
+        }
+        _choose_scanners(&next_scanners);
+        // this node may be closed once the lock is released if no scanner
+        // runs, it must not be touched any more then
+        _batch_added.notify();
+        if (_running_thread == 0) {
+            _scanner_exit_cv.notify_all();
+        }
     }
-    // remove one batch, notify main thread
-    _row_batch_added_cv.notify_one();
-    return Status::OK;
+    _submit_scanners(next_scanners);
 }
 
 void OlapScanNode::debug_string(
@@ -18,6 +18,8 @@
 #ifndef  DORIS_BE_SRC_QUERY_EXEC_OLAP_SCAN_NODE_H
 #define  DORIS_BE_SRC_QUERY_EXEC_OLAP_SCAN_NODE_H
 
+#include <algorithm>
+#include <atomic>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
@@ -25,19 +27,29 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <memory>
 #include <queue>
 
 #include "exec/olap_common.h"
 #include "exec/olap_meta_reader.h"
 #include "exec/olap_scanner.h"
 #include "exec/scan_node.h"
+#include "exec/scanner_concurrency_controller.h"
+#include "exec/topn_boundary.h"
 #include "runtime/descriptors.h"
+#include "runtime/row_batch_free_list.h"
 #include "runtime/row_batch_interface.hpp"
+#include "runtime/sorted_run_merger.h"
 #include "runtime/vectorized_row_batch.h"
+#include "util/event_count.h"
 #include "util/progress_updater.h"
+#include "util/spsc_queue.hpp"
 
 namespace doris {
 
+class BloomFilter;
+class RuntimeFilter;
+
 enum TransferStatus {
     READ_ROWBATCH = 1,
     INIT_HEAP = 2,
@@ -60,6 +72,12 @@ public:
     virtual Status close(RuntimeState* state);
     virtual Status set_scan_ranges(const std::vector<TScanRangeParams>& scan_ranges);
 
+    // Set by the TopNNode above before this is opened, the scanners skip the
+    // rows that are ordered after the boundary.
+    void set_topn_boundary(std::shared_ptr<TopNBoundary> boundary) {
+        _topn_boundary = std::move(boundary);
+    }
+
 protected:
     typedef struct {
         Tuple* tuple;
@@ -92,6 +110,21 @@ protected:
         OlapScanKeys& _scan_keys;
     };
 
+    // the min and max values of runtime filters are in the layout of the slot,
+    // which is the value type of the range
+    class AddMinMaxVisitor : public boost::static_visitor<Status> {
+    public:
+        AddMinMaxVisitor(const void* min, const void* max) : _min(min), _max(max) { }
+        template<class T>
+        Status operator()(ColumnValueRange<T>& v) const {
+            RETURN_IF_ERROR(v.add_range(FILTER_LARGER_OR_EQUAL, *reinterpret_cast<const T*>(_min)));
+            return v.add_range(FILTER_LESS_OR_EQUAL, *reinterpret_cast<const T*>(_max));
+        }
+    private:
+        const void* _min;
+        const void* _max;
+    };
+
     typedef boost::variant<std::list<std::string>> string_list;
 
     class ToOlapFilterVisitor : public boost::static_visitor<std::string> {
@@ -134,7 +167,11 @@ protected:
 
     Status start_scan(RuntimeState* state);
     Status normalize_conjuncts();
+    // waits for the runtime filters and adds them to the value ranges
+    Status apply_runtime_filters(RuntimeState* state);
     Status build_olap_filters();
+    // collects the LIKE conjuncts the ngram indexes may answer, they stay conjuncts
+    Status normalize_like_predicates();
     Status select_scan_ranges();
     Status build_scan_key();
     Status split_scan_range();
@@ -153,11 +190,33 @@ protected:
     Status get_sub_scan_range(
         boost::shared_ptr<DorisScanRange> scan_range,
         std::vector<OlapScanRange>* sub_range);
-    void transfer_thread(RuntimeState* state);
     //void vectorized_scanner_thread(OlapScanner* scanner);
-    void scanner_thread(OlapScanner* scanner);
-
-    Status add_one_batch(RowBatchInterface* row_batch);
+    // 'submit_nanos' is when the task was offered to the thread pool
+    void scanner_thread(OlapScanner* scanner, int64_t submit_nanos);
+
+    // Takes the idle scanners which may run now out of _olap_scanners.
+    // _row_batches_lock must be held.
+    void _choose_scanners(std::vector<OlapScanner*>* scanners);
+    // offers the tasks running 'scanners' to the scanner thread pool
+    void _submit_scanners(const std::vector<OlapScanner*>& scanners);
+    // Takes a batch of the scanners in round robin, false if none is queued.
+    // Called by get_next() only.
+    bool _pop_batch(RowBatch** batch);
+    // Merges the scanners into one run in key order, for a sorted output. The
+    // scanners are read by the merger, not by scanner tasks.
+    Status _start_sorted_merge(RuntimeState* state);
+    // Supplies the next batch of a scanner to the merger, NULL at its end.
+    Status _get_sorted_run_batch(int run, RowBatch** batch);
+    Status _get_next_sorted(RuntimeState* state, RowBatch* row_batch, bool* eos);
+
+    // rows the scanners may still commit before the limit of this node is
+    // met, -1 if it has no limit
+    int64_t _scan_rows_left() {
+        if (_limit == -1) {
+            return -1;
+        }
+        return std::max<int64_t>(_limit - __sync_fetch_and_add(&_num_rows_produced, 0), 0);
+    }
 
     // Write debug string of this into out.
     virtual void debug_string(int indentation_level, std::stringstream* out) const;
@@ -195,49 +254,83 @@ private:
 
     std::vector<TCondition> _olap_filter;
 
+    // bloom filters of runtime filters passed to the storage layer, by column
+    std::vector<std::pair<std::string, std::shared_ptr<const BloomFilter>>> _bloom_filters;
+    // constant patterns of the LIKE conjuncts on columns, by column name
+    std::vector<std::pair<std::string, std::string>> _like_patterns;
+    // keep the min and max values of the value ranges
+    std::vector<std::shared_ptr<RuntimeFilter>> _runtime_filters;
+    // null if there is no top-n above to publish one
+    std::shared_ptr<TopNBoundary> _topn_boundary;
+
     // Order Result Flag
     bool _is_result_order;
 
+    // the rows are returned in the order of the key columns of the table, see
+    // TOlapScanNode.sorted_output
+    bool _sorted_output = false;
+    // slot refs of the longest prefix of the key columns which are materialized
+    std::vector<ExprContext*> _sort_key_ctxs;
+    // a scanner with the batch it fills for the merger
+    struct SortedRun {
+        OlapScanner* scanner;
+        std::unique_ptr<RowBatch> batch;
+        bool eos;
+    };
+    std::vector<SortedRun> _sorted_runs;
+    std::unique_ptr<SortedRunMerger> _merger;
+    // the runs are read by merge threads, which copy their rows
+    bool _parallel_sorted_merge = false;
+
     // Pool for storing allocated scanner objects.  We don't want to use the
     // runtime pool to ensure that the scanner objects are deleted before this
     // object is.
     boost::scoped_ptr<ObjectPool> _scanner_pool;
 
-    // Thread group for transfer thread
-    boost::thread_group _transfer_thread;
     // Keeps track of total splits and the number finished.
     ProgressUpdater _progress;
 
-    // Lock and condition variables protecting _materialized_row_batches.  Row batches are
-    // produced asynchronously by the scanner threads and consumed by the main thread in
-    // GetNext.  Row batches must be processed by the main thread in the order they are
-    // queued to avoid freeing attached resources prematurely (row batches will never depend
-    // on resources attached to earlier batches in the queue).
+    // Protects the scheduling of the scanners: _olap_scanners, _running_thread,
+    // _transfer_done and _scanner_done.
     // This lock cannot be taken together with any other locks except _lock.
     boost::mutex _row_batches_lock;
-    boost::condition_variable _row_batch_added_cv;
-    boost::condition_variable _row_batch_consumed_cv;
-
-    std::list<RowBatchInterface*> _materialized_row_batches;
-
-    boost::mutex _scan_batches_lock;
-    boost::condition_variable _scan_batch_added_cv;
-    int32_t _scanner_task_finish_count;
-
-    std::list<RowBatchInterface*> _scan_row_batches;
+    // signaled when no scanner task runs any more
+    boost::condition_variable _scanner_exit_cv;
+
+    // Row batches produced by each scanner, by OlapScanner::id(). The task running a
+    // scanner queues its batches as it reads them and get_next() takes them, without
+    // a lock. The batches of a scanner are returned in the order they are queued, as
+    // a batch may depend on resources attached to earlier batches of the scanner.
+    std::vector<std::unique_ptr<SpscQueue<RowBatch*>>> _scanner_batches;
+    // batches in _scanner_batches
+    std::atomic<int> _num_queued_batches{0};
+    // the queue _pop_batch() looks at first
+    size_t _next_scanner_batches = 0;
+    // notified when a batch is queued or _transfer_done is set by a scanner
+    EventCount _batch_added;
+    // batches returned by get_next(), filled again by the scanners
+    std::unique_ptr<RowBatchFreeList> _free_row_batches;
 
     std::list<OlapScanner*> _all_olap_scanners;
+    // idle scanners, which are not done
     std::list<OlapScanner*> _olap_scanners;
 
     int _max_materialized_row_batches;
+    // scanner tasks of this node which may run at the same time
+    int _max_scanner_tasks = 1;
+    // how many of them run, null if they are not adjusted
+    std::unique_ptr<ScannerConcurrencyController> _concurrency_controller;
+    // scanners are not started beyond 60% of it but one
+    int64_t _scanner_mem_limit = 0;
     bool _start;
     bool _scanner_done;
     bool _transfer_done;
     size_t _direct_conjunct_size;
 
-    boost::posix_time::time_duration _wait_duration;
-    int _total_assign_num;
-    int _nice;
+    // the scanner threads are shared by the queries in proportion to the
+    // shares of their resource groups, see FairShareThreadPool
+    uint64_t _scanner_group = 0;
+    int _scanner_weight = 0;
 
     // protect _status, for many thread may change _status
     boost::mutex _status_mutex;
@@ -252,6 +345,9 @@ private:
 
     int64_t _buffered_bytes;
     int64_t _running_thread;
+    // rows the scanners have committed to batches so far, they are not
+    // scanned on once these meet the limit of the node
+    int64_t _num_rows_produced = 0;
     EvalConjunctsFn _eval_conjuncts_fn;
 
     // Counters
@@ -259,13 +355,19 @@ private:
     RuntimeProfile::Counter* _read_compressed_counter = nullptr;
     RuntimeProfile::Counter* _decompressor_timer = nullptr;
     RuntimeProfile::Counter* _read_uncompressed_counter = nullptr;
+    RuntimeProfile::Counter* _data_page_cache_hit_counter = nullptr;
     RuntimeProfile::Counter* _raw_rows_counter = nullptr;
 
     RuntimeProfile::Counter* _rows_vec_cond_counter = nullptr;
     RuntimeProfile::Counter* _vec_cond_timer = nullptr;
+    RuntimeProfile::Counter* _lazy_read_skipped_counter = nullptr;
 
     RuntimeProfile::Counter* _stats_filtered_counter = nullptr;
     RuntimeProfile::Counter* _del_filtered_counter = nullptr;
+    RuntimeProfile::Counter* _replaced_filtered_counter = nullptr;
+    RuntimeProfile::Counter* _bitmap_index_filtered_counter = nullptr;
+    RuntimeProfile::Counter* _pre_aggregate_rows_counter = nullptr;
+    RuntimeProfile::Counter* _metadata_rows_counter = nullptr;
 
     RuntimeProfile::Counter* _block_seek_timer = nullptr;
     RuntimeProfile::Counter* _block_convert_timer = nullptr;
@@ -274,6 +376,15 @@ private:
     RuntimeProfile::Counter* _block_fetch_timer = nullptr;
 
     RuntimeProfile::Counter* _index_load_timer = nullptr;
+
+    RuntimeProfile::Counter* _runtime_filter_wait_timer = nullptr;
+    RuntimeProfile::Counter* _runtime_filter_counter = nullptr;
+    // scanners opened with the condition of the top-n boundary
+    RuntimeProfile::Counter* _topn_conditions_counter = nullptr;
+    RuntimeProfile::Counter* _topn_filtered_counter = nullptr;
+    // time the scanner tasks waited for a thread
+    RuntimeProfile::Counter* _scanner_queue_wait_timer = nullptr;
+    RuntimeProfile::HighWaterMarkCounter* _peak_scanner_tasks_counter = nullptr;
 };
 
 } // namespace doris
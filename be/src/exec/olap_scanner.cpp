@@ -15,6 +15,7 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <algorithm>
 #include <cstring>
 #include <string>
 
@@ -23,11 +24,13 @@
 #include "olap_scan_node.h"
 #include "olap_utils.h"
 #include "olap/field.h"
+#include "olap/row_block.h"
 #include "service/backend_options.h"
 #include "runtime/descriptors.h"
 #include "runtime/runtime_state.h"
 #include "runtime/mem_pool.h"
 #include "runtime/mem_tracker.h"
+#include "runtime/tracer.h"
 #include "util/mem_util.hpp"
 #include "util/network_util.h"
 #include "util/doris_metrics.h"
@@ -76,6 +79,9 @@ Status OlapScanner::_prepare(
         strtoul(scan_range->scan_range().schema_hash.c_str(), nullptr, 10);
     _version =
         strtoul(scan_range->scan_range().version.c_str(), nullptr, 10);
+    if (scan_range->scan_range().__isset.start_version) {
+        _start_version = strtoul(scan_range->scan_range().start_version.c_str(), nullptr, 10);
+    }
     VersionHash version_hash =
         strtoul(scan_range->scan_range().version_hash.c_str(), nullptr, 10);
     {
@@ -122,10 +128,16 @@ Status OlapScanner::_prepare(
 Status OlapScanner::open() {
     RETURN_IF_ERROR(_ctor_status);
     SCOPED_TIMER(_parent->_reader_init_timer);
+    _open_time_ns = Tracer::now_ns();
 
     if (_conjunct_ctxs.size() > _direct_conjunct_size) {
         _use_pushdown_conjuncts = true;
     }
+    if (!_conjunct_ctxs.empty()) {
+        // rows answered from metadata can not be filtered
+        _params.push_agg_op = TPushAggOp::NONE;
+    }
+    _init_topn_boundary();
 
     auto res = _reader->init(_params);
     if (res != OLAP_SUCCESS) {
@@ -147,7 +159,7 @@ Status OlapScanner::_init_params(
     _params.olap_table = _olap_table;
     _params.reader_type = READER_QUERY;
     _params.aggregation = _aggregation;
-    _params.version = Version(0, _version);
+    _params.version = Version(_start_version, _version);
 
     // Condition
     for (auto& filter : filters) {
@@ -156,6 +168,12 @@ Status OlapScanner::_init_params(
     for (auto& is_null_str : is_nulls) {
         _params.conditions.push_back(is_null_str);
     }
+    _params.bloom_filters = _parent->_bloom_filters;
+    _params.like_patterns = _parent->_like_patterns;
+    if (_parent->_olap_scan_node.__isset.push_agg_op) {
+        _params.push_agg_op = _parent->_olap_scan_node.push_agg_op;
+    }
+    _params.sorted_output = _parent->_sorted_output;
     // Range
     for (auto& key_range : key_ranges) {
         if (key_range.begin_scan_range.size() == 1 &&
@@ -174,7 +192,8 @@ Status OlapScanner::_init_params(
     _params.profile = _profile;
     _params.runtime_state = _runtime_state;
 
-    if (_aggregation) {
+    // the key columns the rows are merged on are read for a sorted output
+    if (_aggregation && !_params.sorted_output) {
         _params.return_columns = _return_columns;
     } else {
         for (size_t i = 0; i < _olap_table->num_key_fields(); ++i) {
@@ -224,6 +243,7 @@ Status OlapScanner::_init_return_columns() {
             _request_columns_size.push_back(_olap_table->tablet_schema()[index].length);
         }
         _query_slots.push_back(slot);
+        _convert_fns.push_back(_get_convert_field_fn(slot->type().type));
     }
     if (_return_columns.empty()) {
         return Status("failed to build storage scanner, no materialized slot!");
@@ -233,6 +253,14 @@ Status OlapScanner::_init_return_columns() {
 
 Status OlapScanner::get_batch(
         RuntimeState* state, RowBatch* batch, bool* eof) {
+    SCOPED_RAW_TIMER(&_scan_time_ns);
+    if (_topn_boundary != nullptr) {
+        _topn_boundary->refresh(&_topn_snapshot);
+    }
+    if (config::doris_scanner_convert_by_block && _reader->support_block_read()) {
+        return _get_batch_by_block(state, batch, eof);
+    }
+
     // 2. Allocate Row's Tuple buf
     uint8_t *tuple_buf = batch->tuple_data_pool()->allocate(
         state->batch_size() * _tuple_desc->byte_size());
@@ -240,6 +268,9 @@ Status OlapScanner::get_batch(
     Tuple *tuple = reinterpret_cast<Tuple*>(tuple_buf);
 
     int64_t raw_rows_threshold = raw_rows_read() + config::doris_scanner_row_num;
+    // the conjuncts are all evaluated here, the committed rows are the ones
+    // the node returns
+    int64_t rows_left = _parent->_scan_rows_left();
     {
         SCOPED_TIMER(_parent->_scan_timer);
         while (true) {
@@ -248,8 +279,17 @@ Status OlapScanner::get_batch(
                 _update_realtime_counter();
                 break;
             }
+            // The rows of the limit are committed, the next block is not read
+            if (rows_left != -1 && batch->num_rows() >= rows_left) {
+                *eof = true;
+                _update_realtime_counter();
+                break;
+            }
             // Read one row from reader
             auto res = _reader->next_row_with_aggregation(&_read_row_cursor, eof);
+            if (res == OLAP_ERR_READER_CANCELLED) {
+                return Status::CANCELLED;
+            }
             if (res != OLAP_SUCCESS) {
                 return Status("Internal Error: read storage fail.");
             }
@@ -271,75 +311,96 @@ Status OlapScanner::get_batch(
             TupleRow* row = batch->get_row(row_idx);
             row->set_tuple(_tuple_idx, tuple);
 
-            do {
-                // 3.5.1 Using direct conjuncts to filter data
-                if (_eval_conjuncts_fn != nullptr) {
-                    if (!_eval_conjuncts_fn(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
-                        // check direct conjuncts fail then clear tuple for reuse
-                        // make sure to reset null indicators since we're overwriting
-                        // the tuple assembled for the previous row
-                        tuple->init(_tuple_desc->byte_size());
-                        break;
-                    }
-                } else {
-                    if (!ExecNode::eval_conjuncts(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
-                        // check direct conjuncts fail then clear tuple for reuse
-                        // make sure to reset null indicators since we're overwriting
-                        // the tuple assembled for the previous row
-                        tuple->init(_tuple_desc->byte_size());
-                        break;
-                    }
-                }
-
-                // 3.5.2 Using pushdown conjuncts to filter data
-                if (_use_pushdown_conjuncts) {
-                    if (!ExecNode::eval_conjuncts(
-                            &_conjunct_ctxs[_direct_conjunct_size],
-                            _conjunct_ctxs.size() - _direct_conjunct_size, row)) {
-                        // check pushdown conjuncts fail then clear tuple for reuse
-                        // make sure to reset null indicators since we're overwriting
-                        // the tuple assembled for the previous row
-                        tuple->init(_tuple_desc->byte_size());
-                        _num_rows_pushed_cond_filtered++;
-                        break;
-                    }
-                }
-
-                // Copy string slot
-                for (auto desc : _string_slots) {
-                    StringValue* slot = tuple->get_string_slot(desc->tuple_offset());
-                    if (slot->len != 0) {
-                        uint8_t* v = batch->tuple_data_pool()->allocate(slot->len);
-                        memory_copy(v, slot->ptr, slot->len);
-                        slot->ptr = reinterpret_cast<char*>(v);
-                    }
-                }
-                if (VLOG_ROW_IS_ON) {
-                    VLOG_ROW << "OlapScanner output row: " << Tuple::to_string(tuple, *_tuple_desc);
-                }
-
+            if (_eval_conjuncts(row)) {
                 // check direct && pushdown conjuncts success then commit tuple
-                batch->commit_last_row();
+                _commit_row(batch, tuple);
                 char* new_tuple = reinterpret_cast<char*>(tuple);
                 new_tuple += _tuple_desc->byte_size();
                 tuple = reinterpret_cast<Tuple*>(new_tuple);
+            } else {
+                // check conjuncts fail then clear tuple for reuse
+                // make sure to reset null indicators since we're overwriting
+                // the tuple assembled for the previous row
+                tuple->init(_tuple_desc->byte_size());
+            }
+
+            if (raw_rows_read() >= raw_rows_threshold) {
+                break;
+            }
+        }
+    }
+
+    return Status::OK;
+}
+
+Status OlapScanner::_get_batch_by_block(RuntimeState* state, RowBatch* batch, bool* eof) {
+    size_t tuple_size = _tuple_desc->byte_size();
+    uint8_t* tuple_buf = batch->tuple_data_pool()->allocate(state->batch_size() * tuple_size);
+    Tuple* tuple = reinterpret_cast<Tuple*>(tuple_buf);
+
+    int64_t raw_rows_threshold = raw_rows_read() + config::doris_scanner_row_num;
+    // the conjuncts are all evaluated here, the committed rows are the ones
+    // the node returns
+    int64_t rows_left = _parent->_scan_rows_left();
+    {
+        SCOPED_TIMER(_parent->_scan_timer);
+        while (true) {
+            // Batch is full, break
+            if (batch->is_full()) {
+                _update_realtime_counter();
+                break;
+            }
+            // The rows of the limit are committed, the next block is not read
+            if (rows_left != -1 && batch->num_rows() >= rows_left) {
+                *eof = true;
+                _update_realtime_counter();
+                break;
+            }
+            if (_block_row_idx >= _block_rows.size()) {
+                auto res = _reader->next_block(&_block, &_block_rows, eof);
+                if (res == OLAP_ERR_READER_CANCELLED) {
+                    return Status::CANCELLED;
+                }
+                if (res != OLAP_SUCCESS) {
+                    return Status("Internal Error: read storage fail.");
+                }
+                // If we reach end of this scanner, break
+                if (UNLIKELY(*eof)) {
+                    _update_realtime_counter();
+                    break;
+                }
+                _block_row_idx = 0;
+                continue;
+            }
 
-                // compute pushdown conjuncts filter rate
-                if (_use_pushdown_conjuncts) {
-                    // check this rate after 
-                    if (_num_rows_read > 32768) {
-                        int32_t pushdown_return_rate
-                            = _num_rows_read * 100 / (_num_rows_read + _num_rows_pushed_cond_filtered);
-                        if (pushdown_return_rate > config::doris_max_pushdown_conjuncts_return_rate) {
-                            _use_pushdown_conjuncts = false;
-                            VLOG(2) << "Stop Using PushDown Conjuncts. "
-                                << "PushDownReturnRate: " << pushdown_return_rate << "%"
-                                << " MaxPushDownReturnRate: "
-                                << config::doris_max_pushdown_conjuncts_return_rate << "%";
-                        }
-                    }
+            // rows are converted into the free tuples of the batch, the ones
+            // passing the conjuncts are moved to the front of them
+            int num_rows = std::min<int>(_block_rows.size() - _block_row_idx,
+                                         batch->capacity() - batch->num_rows());
+            bzero(tuple, num_rows * tuple_size);
+            _convert_block_to_tuples(&_block_rows[_block_row_idx], num_rows, tuple);
+            _block_row_idx += num_rows;
+            _num_rows_read += num_rows;
+
+            char* next_tuple = reinterpret_cast<char*>(tuple);
+            for (int i = 0; i < num_rows; ++i) {
+                Tuple* input = reinterpret_cast<Tuple*>(next_tuple + i * tuple_size);
+                if (VLOG_ROW_IS_ON) {
+                    VLOG_ROW << "OlapScanner input row: " << Tuple::to_string(input, *_tuple_desc);
+                }
+                int row_idx = batch->add_row();
+                TupleRow* row = batch->get_row(row_idx);
+                row->set_tuple(_tuple_idx, input);
+                if (!_eval_conjuncts(row)) {
+                    continue;
+                }
+                if (input != tuple) {
+                    memcpy(tuple, input, tuple_size);
+                    row->set_tuple(_tuple_idx, tuple);
                 }
-            } while (false);
+                _commit_row(batch, tuple);
+                tuple = reinterpret_cast<Tuple*>(reinterpret_cast<char*>(tuple) + tuple_size);
+            }
 
             if (raw_rows_read() >= raw_rows_threshold) {
                 break;
@@ -350,6 +411,188 @@ Status OlapScanner::get_batch(
     return Status::OK;
 }
 
+bool OlapScanner::_eval_conjuncts(TupleRow* row) {
+    if (_topn_snapshot.value != nullptr) {
+        const SlotDescriptor* slot = _topn_boundary->slot();
+        Tuple* tuple = row->get_tuple(_tuple_idx);
+        const void* value = tuple->is_null(slot->null_indicator_offset())
+            ? nullptr : tuple->get_slot(slot->tuple_offset());
+        if (_topn_boundary->is_pruned(_topn_snapshot, value)) {
+            _num_rows_topn_filtered++;
+            return false;
+        }
+    }
+
+    // Using direct conjuncts to filter data
+    if (_eval_conjuncts_fn != nullptr) {
+        if (!_eval_conjuncts_fn(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
+            return false;
+        }
+    } else {
+        if (!ExecNode::eval_conjuncts(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
+            return false;
+        }
+    }
+
+    // Using pushdown conjuncts to filter data
+    if (_use_pushdown_conjuncts) {
+        if (!ExecNode::eval_conjuncts(
+                &_conjunct_ctxs[_direct_conjunct_size],
+                _conjunct_ctxs.size() - _direct_conjunct_size, row)) {
+            _num_rows_pushed_cond_filtered++;
+            return false;
+        }
+    }
+    return true;
+}
+
+void OlapScanner::_init_topn_boundary() {
+    const TopNBoundary* boundary = _parent->_topn_boundary.get();
+    if (boundary == nullptr) {
+        return;
+    }
+    int32_t index = _olap_table->get_field_index(boundary->slot()->col_name());
+    if (index < 0) {
+        return;
+    }
+    // Rows of the other tables are merged after the conditions are evaluated,
+    // the values of their rows are known to the scanner only if the reader
+    // merges them.
+    bool is_key = _olap_table->keys_type() == KeysType::DUP_KEYS
+        || _olap_table->tablet_schema()[index].is_key;
+    if (!is_key && _aggregation) {
+        return;
+    }
+    _topn_boundary = boundary;
+    TCondition condition;
+    if (is_key && boundary->to_olap_condition(&condition)) {
+        _params.conditions.push_back(condition);
+        COUNTER_UPDATE(_parent->_topn_conditions_counter, 1);
+    }
+}
+
+void OlapScanner::_commit_row(RowBatch* batch, Tuple* tuple) {
+    // Copy string slot
+    for (auto desc : _string_slots) {
+        StringValue* slot = tuple->get_string_slot(desc->tuple_offset());
+        if (slot->len != 0) {
+            uint8_t* v = batch->tuple_data_pool()->allocate(slot->len);
+            memory_copy(v, slot->ptr, slot->len);
+            slot->ptr = reinterpret_cast<char*>(v);
+        }
+    }
+    if (VLOG_ROW_IS_ON) {
+        VLOG_ROW << "OlapScanner output row: " << Tuple::to_string(tuple, *_tuple_desc);
+    }
+
+    batch->commit_last_row();
+
+    // compute pushdown conjuncts filter rate
+    if (_use_pushdown_conjuncts) {
+        // check this rate after 
+        if (_num_rows_read > 32768) {
+            int32_t pushdown_return_rate
+                = _num_rows_read * 100 / (_num_rows_read + _num_rows_pushed_cond_filtered);
+            if (pushdown_return_rate > config::doris_max_pushdown_conjuncts_return_rate) {
+                _use_pushdown_conjuncts = false;
+                VLOG(2) << "Stop Using PushDown Conjuncts. "
+                    << "PushDownReturnRate: " << pushdown_return_rate << "%"
+                    << " MaxPushDownReturnRate: "
+                    << config::doris_max_pushdown_conjuncts_return_rate << "%";
+            }
+        }
+    }
+}
+
+// Converts the field value at 'ptr', of 'len' bytes, to the slot of 'tuple' at
+// 'slot_offset'. Values which are no valid slot values are set null. Fixed length
+// values of the same layout in both are copied, by the INVALID_TYPE instance.
+template <PrimitiveType type>
+static inline void convert_field(char* ptr, size_t len, int slot_offset,
+                                 const NullIndicatorOffset& null_offset, Tuple* tuple) {
+    memory_copy(tuple->get_slot(slot_offset), ptr, len);
+}
+
+template <>
+inline void convert_field<TYPE_CHAR>(char* ptr, size_t len, int slot_offset,
+                                     const NullIndicatorOffset& null_offset, Tuple* tuple) {
+    Slice* slice = reinterpret_cast<Slice*>(ptr);
+    StringValue* slot = tuple->get_string_slot(slot_offset);
+    slot->ptr = slice->data;
+    slot->len = strnlen(slot->ptr, slice->size);
+}
+
+template <>
+inline void convert_field<TYPE_VARCHAR>(char* ptr, size_t len, int slot_offset,
+                                        const NullIndicatorOffset& null_offset, Tuple* tuple) {
+    Slice* slice = reinterpret_cast<Slice*>(ptr);
+    StringValue* slot = tuple->get_string_slot(slot_offset);
+    slot->ptr = slice->data;
+    slot->len = slice->size;
+}
+
+template <>
+inline void convert_field<TYPE_DECIMAL>(char* ptr, size_t len, int slot_offset,
+                                        const NullIndicatorOffset& null_offset, Tuple* tuple) {
+    // TODO(lingbin): should remove this assign, use set member function
+    int64_t int_value = *(int64_t*)(ptr);
+    int32_t frac_value = *(int32_t*)(ptr + sizeof(int64_t));
+    *tuple->get_decimal_slot(slot_offset) = DecimalValue(int_value, frac_value);
+}
+
+template <>
+inline void convert_field<TYPE_DECIMALV2>(char* ptr, size_t len, int slot_offset,
+                                          const NullIndicatorOffset& null_offset, Tuple* tuple) {
+    int64_t int_value = *(int64_t*)(ptr);
+    int32_t frac_value = *(int32_t*)(ptr + sizeof(int64_t));
+    if (!tuple->get_decimalv2_slot(slot_offset)->from_olap_decimal(int_value, frac_value)) {
+        tuple->set_null(null_offset);
+    }
+}
+
+template <>
+inline void convert_field<TYPE_DATETIME>(char* ptr, size_t len, int slot_offset,
+                                         const NullIndicatorOffset& null_offset, Tuple* tuple) {
+    uint64_t value = *reinterpret_cast<uint64_t*>(ptr);
+    if (!tuple->get_datetime_slot(slot_offset)->from_olap_datetime(value)) {
+        tuple->set_null(null_offset);
+    }
+}
+
+template <>
+inline void convert_field<TYPE_DATE>(char* ptr, size_t len, int slot_offset,
+                                     const NullIndicatorOffset& null_offset, Tuple* tuple) {
+    uint64_t value = 0;
+    value = *(unsigned char*)(ptr + 2);
+    value <<= 8;
+    value |= *(unsigned char*)(ptr + 1);
+    value <<= 8;
+    value |= *(unsigned char*)(ptr);
+    if (!tuple->get_datetime_slot(slot_offset)->from_olap_date(value)) {
+        tuple->set_null(null_offset);
+    }
+}
+
+OlapScanner::ConvertFieldFn OlapScanner::_get_convert_field_fn(PrimitiveType type) {
+    switch (type) {
+    case TYPE_CHAR:
+        return &convert_field<TYPE_CHAR>;
+    case TYPE_VARCHAR:
+    case TYPE_HLL:
+        return &convert_field<TYPE_VARCHAR>;
+    case TYPE_DECIMAL:
+        return &convert_field<TYPE_DECIMAL>;
+    case TYPE_DECIMALV2:
+        return &convert_field<TYPE_DECIMALV2>;
+    case TYPE_DATETIME:
+        return &convert_field<TYPE_DATETIME>;
+    case TYPE_DATE:
+        return &convert_field<TYPE_DATE>;
+    default:
+        return &convert_field<INVALID_TYPE>;
+    }
+}
+
 void OlapScanner::_convert_row_to_tuple(Tuple* tuple) {
     char* row = _read_row_cursor.get_buf();
     size_t slots_size = _query_slots.size();
@@ -360,70 +603,73 @@ void OlapScanner::_convert_row_to_tuple(Tuple* tuple) {
             tuple->set_null(slot_desc->null_indicator_offset());
             continue;
         }
-        char* ptr = (char*)field->get_ptr(row);
-        size_t len = field->size();
+        _convert_fns[i]((char*)field->get_ptr(row), field->size(), slot_desc->tuple_offset(),
+                        slot_desc->null_indicator_offset(), tuple);
+    }
+}
+
+// Converts a column of rows in a row block to tuple slots, null rows are set null in the tuple.
+// 'field' is the field of the column in the first row of the block.
+template <PrimitiveType type>
+static void convert_column(const char* field, size_t len, size_t row_bytes,
+                           const uint32_t* rows, int num_rows,
+                           char* tuples, size_t tuple_size, int slot_offset,
+                           const NullIndicatorOffset& null_offset) {
+    for (int i = 0; i < num_rows; ++i, tuples += tuple_size) {
+        // layout is nullbyte|Field
+        const char* ptr = field + rows[i] * row_bytes;
+        Tuple* tuple = reinterpret_cast<Tuple*>(tuples);
+        if (*ptr) {
+            tuple->set_null(null_offset);
+        } else {
+            convert_field<type>(const_cast<char*>(ptr + 1), len, slot_offset, null_offset, tuple);
+        }
+    }
+}
+
+void OlapScanner::_convert_block_to_tuples(const uint32_t* rows, int num_rows, Tuple* tuples) {
+    char* tuple_buf = reinterpret_cast<char*>(tuples);
+    size_t tuple_size = _tuple_desc->byte_size();
+    size_t row_bytes = _block->row_bytes();
+    size_t slots_size = _query_slots.size();
+    for (int i = 0; i < slots_size; ++i) {
+        SlotDescriptor* slot_desc = _query_slots[i];
+        const NullIndicatorOffset& null_offset = slot_desc->null_indicator_offset();
+        int slot_offset = slot_desc->tuple_offset();
+        const char* field = _block->field_ptr(0, _return_columns[i]);
+        size_t len = _query_fields[i]->size();
+        // the loop of each type is compiled with its conversion inlined
         switch (slot_desc->type().type) {
-        case TYPE_CHAR: {
-            Slice* slice = reinterpret_cast<Slice*>(ptr);
-            StringValue *slot = tuple->get_string_slot(slot_desc->tuple_offset());
-            slot->ptr = slice->data;
-            slot->len = strnlen(slot->ptr, slice->size);
+        case TYPE_CHAR:
+            convert_column<TYPE_CHAR>(field, len, row_bytes, rows, num_rows,
+                                      tuple_buf, tuple_size, slot_offset, null_offset);
             break;
-        }
         case TYPE_VARCHAR:
-        case TYPE_HLL: {
-            Slice* slice = reinterpret_cast<Slice*>(ptr);
-            StringValue *slot = tuple->get_string_slot(slot_desc->tuple_offset());
-            slot->ptr = slice->data;
-            slot->len = slice->size;
+        case TYPE_HLL:
+            convert_column<TYPE_VARCHAR>(field, len, row_bytes, rows, num_rows,
+                                         tuple_buf, tuple_size, slot_offset, null_offset);
             break;
-        }
-        case TYPE_DECIMAL: {
-            DecimalValue *slot = tuple->get_decimal_slot(slot_desc->tuple_offset());
-
-            // TODO(lingbin): should remove this assign, use set member function
-            int64_t int_value = *(int64_t*)(ptr);
-            int32_t frac_value = *(int32_t*)(ptr + sizeof(int64_t));
-            *slot = DecimalValue(int_value, frac_value);
+        case TYPE_DECIMAL:
+            convert_column<TYPE_DECIMAL>(field, len, row_bytes, rows, num_rows,
+                                         tuple_buf, tuple_size, slot_offset, null_offset);
             break;
-        }
-        case TYPE_DECIMALV2: {
-            DecimalV2Value *slot = tuple->get_decimalv2_slot(slot_desc->tuple_offset());
-
-            int64_t int_value = *(int64_t*)(ptr);
-            int32_t frac_value = *(int32_t*)(ptr + sizeof(int64_t));
-            if (!slot->from_olap_decimal(int_value, frac_value)) {
-                tuple->set_null(slot_desc->null_indicator_offset());
-            }
+        case TYPE_DECIMALV2:
+            convert_column<TYPE_DECIMALV2>(field, len, row_bytes, rows, num_rows,
+                                           tuple_buf, tuple_size, slot_offset, null_offset);
             break;
-        }
-        case TYPE_DATETIME: {
-            DateTimeValue *slot = tuple->get_datetime_slot(slot_desc->tuple_offset());
-            uint64_t value = *reinterpret_cast<uint64_t*>(ptr);
-            if (!slot->from_olap_datetime(value)) {
-                tuple->set_null(slot_desc->null_indicator_offset());
-            }
+        case TYPE_DATETIME:
+            convert_column<TYPE_DATETIME>(field, len, row_bytes, rows, num_rows,
+                                          tuple_buf, tuple_size, slot_offset, null_offset);
             break;
-        }
-        case TYPE_DATE: {
-            DateTimeValue *slot = tuple->get_datetime_slot(slot_desc->tuple_offset());
-            uint64_t value = 0;
-            value = *(unsigned char*)(ptr + 2);
-            value <<= 8;
-            value |= *(unsigned char*)(ptr + 1);
-            value <<= 8;
-            value |= *(unsigned char*)(ptr);
-            if (!slot->from_olap_date(value)) {
-                tuple->set_null(slot_desc->null_indicator_offset());
-            }
+        case TYPE_DATE:
+            convert_column<TYPE_DATE>(field, len, row_bytes, rows, num_rows,
+                                      tuple_buf, tuple_size, slot_offset, null_offset);
             break;
-        }
-        default: {
-            void *slot = tuple->get_slot(slot_desc->tuple_offset());
-            memory_copy(slot, ptr, len);
+        default:
+            convert_column<INVALID_TYPE>(field, len, row_bytes, rows, num_rows,
+                                      tuple_buf, tuple_size, slot_offset, null_offset);
             break;
         }
-        }
     }
 }
 
@@ -433,11 +679,13 @@ void OlapScanner::update_counter() {
     }
     COUNTER_UPDATE(_rows_read_counter, _num_rows_read);
     COUNTER_UPDATE(_rows_pushed_cond_filtered_counter, _num_rows_pushed_cond_filtered);
+    COUNTER_UPDATE(_parent->_topn_filtered_counter, _num_rows_topn_filtered);
 
     COUNTER_UPDATE(_parent->_io_timer, _reader->stats().io_ns);
     COUNTER_UPDATE(_parent->_read_compressed_counter, _reader->stats().compressed_bytes_read);
     COUNTER_UPDATE(_parent->_decompressor_timer, _reader->stats().decompress_ns);
     COUNTER_UPDATE(_parent->_read_uncompressed_counter, _reader->stats().uncompressed_bytes_read);
+    COUNTER_UPDATE(_parent->_data_page_cache_hit_counter, _reader->stats().data_page_cache_hits);
     COUNTER_UPDATE(_parent->bytes_read_counter(), _reader->stats().bytes_read);
 
     COUNTER_UPDATE(_parent->_block_load_timer, _reader->stats().block_load_ns);
@@ -451,18 +699,60 @@ void OlapScanner::update_counter() {
 
     COUNTER_UPDATE(_parent->_vec_cond_timer, _reader->stats().vec_cond_ns);
     COUNTER_UPDATE(_parent->_rows_vec_cond_counter, _reader->stats().rows_vec_cond_filtered);
+    COUNTER_UPDATE(_parent->_lazy_read_skipped_counter, _reader->stats().lazy_read_skipped_values);
 
     COUNTER_UPDATE(_parent->_stats_filtered_counter, _reader->stats().rows_stats_filtered);
     COUNTER_UPDATE(_parent->_del_filtered_counter, _reader->stats().rows_del_filtered);
+    COUNTER_UPDATE(_parent->_replaced_filtered_counter, _reader->stats().rows_replaced_filtered);
+    COUNTER_UPDATE(_parent->_bitmap_index_filtered_counter,
+                   _reader->stats().rows_bitmap_index_filtered);
+    COUNTER_UPDATE(_parent->_pre_aggregate_rows_counter,
+                   _reader->stats().pre_aggregate_rows_read);
+    COUNTER_UPDATE(_parent->_metadata_rows_counter,
+                   _reader->stats().metadata_rows_answered);
 
     COUNTER_UPDATE(_parent->_index_load_timer, _reader->stats().index_load_ns);
 
     DorisMetrics::query_scan_bytes.increment(_reader->stats().compressed_bytes_read);
     DorisMetrics::query_scan_rows.increment(_reader->stats().raw_rows_read);
+    if (_olap_table != nullptr) {
+        _olap_table->heat()->add_scan(_reader->stats().raw_rows_read,
+                                      _reader->stats().compressed_bytes_read,
+                                      _scan_time_ns / 1000);
+    }
+    _trace_scan();
 
     _has_update_counter = true;
 }
 
+void OlapScanner::_trace_scan() {
+    if (_open_time_ns == 0) {
+        return;
+    }
+    Span span(_runtime_state->trace_context(), "olap_scanner", _open_time_ns);
+    if (!span.sampled()) {
+        return;
+    }
+    const OlapReaderStatistics& stats = _reader->stats();
+    if (_olap_table != nullptr) {
+        span.add_attribute("tablet_id", _olap_table->tablet_id());
+    }
+    span.add_attribute("rows_returned", _num_rows_read);
+    span.add_attribute("raw_rows_read", stats.raw_rows_read);
+
+    Span read(span.context(), "segment_read", _open_time_ns);
+    read.add_attribute("compressed_bytes", stats.compressed_bytes_read);
+    read.end(_open_time_ns + stats.io_ns);
+
+    Span decompress(span.context(), "segment_decompress", _open_time_ns);
+    decompress.add_attribute("uncompressed_bytes", stats.uncompressed_bytes_read);
+    decompress.end(_open_time_ns + stats.decompress_ns);
+
+    Span decode(span.context(), "segment_decode", _open_time_ns);
+    decode.add_attribute("blocks", stats.blocks_load);
+    decode.end(_open_time_ns + stats.block_convert_ns);
+}
+
 void OlapScanner::_update_realtime_counter() {
     COUNTER_UPDATE(_parent->bytes_read_counter(), _reader->stats().bytes_read);
     _reader->mutable_stats()->bytes_read = 0;
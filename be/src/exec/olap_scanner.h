@@ -27,6 +27,7 @@
 #include "common/status.h"
 #include "exec/olap_common.h"
 #include "exec/exec_node.h"
+#include "exec/topn_boundary.h"
 #include "exprs/expr.h"
 #include "gen_cpp/PaloInternalService_types.h"
 #include "gen_cpp/PlanNodes_types.h"
@@ -78,6 +79,7 @@ public:
     void set_opened() { _is_open = true; }
 
     int64_t raw_rows_read() const { return _reader->stats().raw_rows_read; }
+    int64_t io_ns() const { return _reader->stats().io_ns; }
 
     void update_counter();
 private:
@@ -93,6 +95,31 @@ private:
     Status _init_return_columns();
     void _convert_row_to_tuple(Tuple* tuple);
 
+    // Converts a field value of a row cursor to a slot, specialized for the type of
+    // the slot so that rows are converted without switching on the types.
+    typedef void (*ConvertFieldFn)(char* ptr, size_t len, int slot_offset,
+                                   const NullIndicatorOffset& null_offset, Tuple* tuple);
+    static ConvertFieldFn _get_convert_field_fn(PrimitiveType type);
+
+    // Used when the reader supports block read, rows of blocks are converted
+    // column by column instead of one by one
+    Status _get_batch_by_block(RuntimeState* state, RowBatch* batch, bool* eof);
+    void _convert_block_to_tuples(const uint32_t* rows, int num_rows, Tuple* tuples);
+
+    // Evaluates direct and pushdown conjuncts on row
+    bool _eval_conjuncts(TupleRow* row);
+
+    // Records the span of the scanner from its open to now, with the time its reader
+    // spent reading, decompressing and decoding the segments as child spans. The
+    // children start with the scanner, their ends show how long each step took.
+    void _trace_scan();
+
+    // Takes the top-n boundary of the parent if the column can be filtered
+    // by it, adds its condition to _params if the storage can evaluate it.
+    void _init_topn_boundary();
+    // Copies string slots of tuple into batch and commits its row
+    void _commit_row(RowBatch* batch, Tuple* tuple);
+
     // Update profile that need to be reported in realtime.
     void _update_realtime_counter();
 
@@ -120,26 +147,44 @@ private:
 
     OLAPTablePtr _olap_table;
     int64_t _version;
+    // the first version scanned, 0 unless the older ones are cached
+    int64_t _start_version = 0;
 
     std::vector<uint32_t> _return_columns;
 
     RowCursor _read_row_cursor;
 
+    // block of the reader being converted, rows before _block_row_idx are done
+    RowBlock* _block = nullptr;
+    std::vector<uint32_t> _block_rows;
+    size_t _block_row_idx = 0;
+
     std::vector<uint32_t> _request_columns_size;
 
     std::vector<SlotDescriptor*> _query_slots;
     std::vector<const Field*> _query_fields;
+    // conversion of each of _query_slots, see _get_convert_field_fn()
+    std::vector<ConvertFieldFn> _convert_fns;
 
     // time costed and row returned statistics
     ExecNode::EvalConjunctsFn _eval_conjuncts_fn = nullptr;
 
     RuntimeProfile::Counter* _rows_read_counter = nullptr;
     int64_t _num_rows_read = 0;
+    // time spent in get_batch(), added to the heat of the tablet on close
+    int64_t _scan_time_ns = 0;
+    // wall time of open(), the start of the span of the scanner
+    int64_t _open_time_ns = 0;
 
     RuntimeProfile::Counter* _rows_pushed_cond_filtered_counter = nullptr;
     // number rows filtered by pushed condition
     int64_t _num_rows_pushed_cond_filtered = 0;
 
+    // null if rows are not filtered by a top-n boundary
+    const TopNBoundary* _topn_boundary = nullptr;
+    TopNBoundary::Snapshot _topn_snapshot;
+    int64_t _num_rows_topn_filtered = 0;
+
     bool _is_closed = false;
 };
 
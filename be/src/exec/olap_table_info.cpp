@@ -21,6 +21,7 @@
 #include "runtime/mem_tracker.h"
 #include "runtime/row_batch.h"
 #include "runtime/tuple_row.h"
+#include "util/bitmap.h"
 #include "util/string_parser.hpp"
 
 namespace doris {
@@ -242,6 +243,42 @@ bool OlapTablePartitionParam::find_tablet(Tuple* tuple,
     return false;
 }
 
+void OlapTablePartitionParam::find_tablets(RowBatch* batch, const Bitmap* filter,
+                                           std::vector<const OlapTablePartition*>* partitions,
+                                           std::vector<uint32_t>* dist_hashes) const {
+    int num_rows = batch->num_rows();
+    partitions->assign(num_rows, nullptr);
+    dist_hashes->assign(num_rows, 0);
+
+    OlapTablePartKeyComparator comparator(_partition_slot_desc);
+    OlapTablePartition* last = nullptr;
+    for (int i = 0; i < num_rows; ++i) {
+        if (filter != nullptr && filter->Get(i)) {
+            continue;
+        }
+        Tuple* tuple = batch->get_row(i)->get_tuple(0);
+        if (last != nullptr && comparator(tuple, last->end_key) && _part_contains(last, tuple)) {
+            (*partitions)[i] = last;
+            continue;
+        }
+        auto it = _partitions_map->upper_bound(tuple);
+        if (it != _partitions_map->end() && _part_contains(it->second, tuple)) {
+            last = it->second;
+            (*partitions)[i] = last;
+        }
+    }
+
+    // one distributed column of all rows after the other
+    for (auto slot_desc : _distributed_slot_descs) {
+        for (int i = 0; i < num_rows; ++i) {
+            if ((*partitions)[i] != nullptr) {
+                Tuple* tuple = batch->get_row(i)->get_tuple(0);
+                (*dist_hashes)[i] = _hash_slot(tuple, slot_desc, (*dist_hashes)[i]);
+            }
+        }
+    }
+}
+
 Status OlapTablePartitionParam::_create_partition_key(const TExprNode& t_expr, Tuple** part_key) {
     Tuple* tuple = (Tuple*)_mem_pool->allocate(_schema->tuple_desc()->byte_size());
     void* slot = tuple->get_slot(_partition_slot_desc->tuple_offset());
@@ -314,17 +351,21 @@ std::string OlapTablePartitionParam::debug_string() const {
 uint32_t OlapTablePartitionParam::_compute_dist_hash(Tuple* key) const {
     uint32_t hash_val = 0;
     for (auto slot_desc : _distributed_slot_descs) {
-        auto slot = key->get_slot(slot_desc->tuple_offset());
-        if (slot != nullptr) {
-            hash_val = RawValue::zlib_crc32(slot, slot_desc->type(), hash_val);
-        } else {
-            //NULL is treat as 0 when hash
-            static const int INT_VALUE = 0;
-            static const TypeDescriptor INT_TYPE(TYPE_INT);
-            hash_val = RawValue::zlib_crc32(&INT_VALUE, INT_TYPE, hash_val);
-        }
+        hash_val = _hash_slot(key, slot_desc, hash_val);
     }
     return hash_val;
 }
 
+uint32_t OlapTablePartitionParam::_hash_slot(Tuple* key, SlotDescriptor* slot_desc,
+                                             uint32_t seed) {
+    auto slot = key->get_slot(slot_desc->tuple_offset());
+    if (slot != nullptr) {
+        return RawValue::zlib_crc32(slot, slot_desc->type(), seed);
+    }
+    //NULL is treat as 0 when hash
+    static const int INT_VALUE = 0;
+    static const TypeDescriptor INT_TYPE(TYPE_INT);
+    return RawValue::zlib_crc32(&INT_VALUE, INT_TYPE, seed);
+}
+
 }
@@ -33,6 +33,7 @@
 
 namespace doris {
 
+class Bitmap;
 class MemPool;
 class MemTracker;
 class RowBatch;
@@ -145,6 +146,14 @@ public:
                      const OlapTablePartition** partitions,
                      uint32_t* dist_hash) const;
 
+    // find_tablet() for the tuples of all rows of 'batch' which are not set
+    // in 'filter'. a row without a partition, and a filtered one, gets a
+    // nullptr partition. rows following one of the same partition, as those
+    // of a load ordered by the partition column, are found without a search
+    void find_tablets(RowBatch* batch, const Bitmap* filter,
+                      std::vector<const OlapTablePartition*>* partitions,
+                      std::vector<uint32_t>* dist_hashes) const;
+
     const std::vector<OlapTablePartition*>& get_partitions() const {
         return _partitions;
     }
@@ -153,6 +162,7 @@ private:
     Status _create_partition_key(const TExprNode& t_expr, Tuple** part_key);
 
     uint32_t _compute_dist_hash(Tuple* key) const;
+    static uint32_t _hash_slot(Tuple* key, SlotDescriptor* slot_desc, uint32_t seed);
 
     // check if this partition contain this key
     bool _part_contains(OlapTablePartition* part, Tuple* key) const {
@@ -17,9 +17,12 @@
 
 #include "exec/olap_table_sink.h"
 
+#include <algorithm>
 #include <sstream>
 
+#include "common/config.h"
 #include "exprs/expr.h"
+#include "runtime/columnar_row_batch.h"
 #include "runtime/exec_env.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
@@ -45,12 +48,12 @@ NodeChannel::~NodeChannel() {
         }
         _open_closure = nullptr;
     }
-    if (_add_batch_closure != nullptr) {
-        if (_add_batch_closure->unref()) {
-            delete _add_batch_closure;
+    for (auto closure : _in_flight_closures) {
+        if (closure->unref()) {
+            delete closure;
         }
-        _add_batch_closure = nullptr;
     }
+    _in_flight_closures.clear();
     _add_batch_request.release_id();
 }
 
@@ -64,6 +67,10 @@ Status NodeChannel::init(RuntimeState* state) {
     }
     RowDescriptor row_desc(_tuple_desc, false);
     _batch.reset(new RowBatch(row_desc, state->batch_size(), _parent->_mem_tracker));
+    if (config::tablet_writer_columnar_batch) {
+        _columnar_batch.reset(new ColumnarRowBatch(*_tuple_desc));
+    }
+    _max_in_flight_packets = std::max(config::tablet_writer_max_in_flight_packets, 1);
 
     _stub = state->exec_env()->brpc_stub_cache()->get_stub(
         _node_info->host, _node_info->brpc_port);
@@ -77,6 +84,10 @@ Status NodeChannel::init(RuntimeState* state) {
     _add_batch_request.set_allocated_id(&_parent->_load_id);
     _add_batch_request.set_index_id(_index_id);
     _add_batch_request.set_sender_id(_parent->_sender_id);
+    // the receivers trace their writes as children of the fragment
+    if (state->trace_context().sampled) {
+        state->trace_context().to_proto(_add_batch_request.mutable_trace_context());
+    }
 
     return Status::OK;
 }
@@ -94,6 +105,15 @@ void NodeChannel::open() {
     }
     request.set_num_senders(_parent->_num_senders);
     request.set_need_gen_rollup(_parent->_need_gen_rollup);
+    for (auto& it : _forward_replicas) {
+        auto replica = request.add_forward_replicas();
+        replica->set_tablet_id(it.first);
+        replica->set_host(it.second->node_info()->host);
+        replica->set_brpc_port(it.second->node_info()->brpc_port);
+    }
+    if (_add_batch_request.has_trace_context()) {
+        request.mutable_trace_context()->CopyFrom(_add_batch_request.trace_context());
+    }
 
     _open_closure = new RefCountClosure<PTabletWriterOpenResult>();
     _open_closure->ref();
@@ -122,11 +142,6 @@ Status NodeChannel::open_wait() {
         delete _open_closure;
     }
     _open_closure = nullptr;
-
-    // add batch closure
-    _add_batch_closure = new RefCountClosure<PTabletWriterAddBatchResult>();
-    _add_batch_closure->ref();
-
     return status;
 }
 
@@ -144,6 +159,13 @@ Status NodeChannel::add_row(Tuple* input_tuple, int64_t tablet_id) {
     return Status::OK;
 }
 
+Status NodeChannel::flush() {
+    if (_batch->num_rows() > 0) {
+        RETURN_IF_ERROR(_send_cur_batch());
+    }
+    return _wait_in_flight_packets(0);
+}
+
 Status NodeChannel::close(RuntimeState* state) {
     auto st = _close(state);
     _batch.reset();
@@ -151,15 +173,16 @@ Status NodeChannel::close(RuntimeState* state) {
 }
 
 Status NodeChannel::_close(RuntimeState* state) {
-    RETURN_IF_ERROR(_wait_in_flight_packet());
+    // eos must be the last packet the receiver handles
+    RETURN_IF_ERROR(_wait_in_flight_packets(0));
     return _send_cur_batch(true);
 }
 
 Status NodeChannel::close_wait(RuntimeState* state) {
-    RETURN_IF_ERROR(_wait_in_flight_packet());
-    Status status(_add_batch_closure->result.status());
+    RETURN_IF_ERROR(_wait_in_flight_packets(0));
+    Status status(_add_batch_result.status());
     if (status.ok()) {
-        for (auto& tablet : _add_batch_closure->result.tablet_vec()) {
+        for (auto& tablet : _add_batch_result.tablet_vec()) {
             TTabletCommitInfo commit_info;
             commit_info.tabletId = tablet.tablet_id();
             commit_info.backendId = _node_id;
@@ -192,34 +215,51 @@ void NodeChannel::cancel() {
     _batch.reset();
 }
 
-Status NodeChannel::_wait_in_flight_packet() {
-    if (!_has_in_flight_packet) {
-        return Status::OK;
-    }
-    _add_batch_closure->join();
-    _has_in_flight_packet = false;
-    if (_add_batch_closure->cntl.Failed()) {
-        LOG(WARNING) << "failed to send batch, error="
-            << berror(_add_batch_closure->cntl.ErrorCode())
-            << ", error_text=" << _add_batch_closure->cntl.ErrorText();
-        return Status("failed to send batch");
+Status NodeChannel::_wait_in_flight_packets(size_t num) {
+    while (_in_flight_closures.size() > num) {
+        auto closure = _in_flight_closures.front();
+        _in_flight_closures.pop_front();
+        closure->join();
+        Status status;
+        if (closure->cntl.Failed()) {
+            LOG(WARNING) << "failed to send batch, error="
+                << berror(closure->cntl.ErrorCode())
+                << ", error_text=" << closure->cntl.ErrorText();
+            status = Status("failed to send batch");
+        } else {
+            _add_batch_result.Swap(&closure->result);
+            status = Status(_add_batch_result.status());
+        }
+        if (closure->unref()) {
+            delete closure;
+        }
+        RETURN_IF_ERROR(status);
     }
-    return {_add_batch_closure->result.status()};
+    return Status::OK;
 }
 
 Status NodeChannel::_send_cur_batch(bool eos) {
-    RETURN_IF_ERROR(_wait_in_flight_packet());
+    // the receiver holds packets sent ahead until the ones before them are
+    // written, a full window means it is slowed down by its memory limits
+    RETURN_IF_ERROR(_wait_in_flight_packets(_max_in_flight_packets - 1));
 
     // tablet_ids has already set when add row
     _add_batch_request.set_eos(eos);
     _add_batch_request.set_packet_seq(_next_packet_seq);
     if (_batch->num_rows() > 0) {
-        _batch->serialize(_add_batch_request.mutable_row_batch());
+        if (_columnar_batch != nullptr) {
+            _columnar_batch->serialize(_batch.get(),
+                                       _add_batch_request.mutable_columnar_batch());
+        } else {
+            _batch->serialize(_add_batch_request.mutable_row_batch());
+        }
     }
 
-    _add_batch_closure->ref();
-    _add_batch_closure->cntl.Reset();
-    _add_batch_closure->cntl.set_timeout_ms(_rpc_timeout_ms);
+    auto closure = new RefCountClosure<PTabletWriterAddBatchResult>();
+    closure->ref();
+    // This ref is for RPC's reference
+    closure->ref();
+    closure->cntl.set_timeout_ms(_rpc_timeout_ms);
 
     if (eos) {
         for (auto pid : _parent->_partition_ids) {
@@ -227,15 +267,16 @@ Status NodeChannel::_send_cur_batch(bool eos) {
         }
     }
 
-    _stub->tablet_writer_add_batch(&_add_batch_closure->cntl,
+    _stub->tablet_writer_add_batch(&closure->cntl,
                                    &_add_batch_request,
-                                   &_add_batch_closure->result,
-                                   _add_batch_closure);
+                                   &closure->result,
+                                   closure);
     _add_batch_request.clear_tablet_ids();
     _add_batch_request.clear_row_batch();
+    _add_batch_request.clear_columnar_batch();
     _add_batch_request.clear_partition_ids();
 
-    _has_in_flight_packet = true;
+    _in_flight_closures.push_back(closure);
     _next_packet_seq++;
 
     _batch->reset();
@@ -274,6 +315,14 @@ Status IndexChannel::init(RuntimeState* state,
     for (auto& it : _node_channels) {
         RETURN_IF_ERROR(it.second->init(state));
     }
+    if (config::tablet_writer_chain_replication) {
+        for (auto& it : _channels_by_tablet) {
+            auto& channels = it.second;
+            for (int i = 1; i < channels.size(); ++i) {
+                channels[0]->add_forward_replica(it.first, channels[i]);
+            }
+        }
+    }
     return Status::OK;
 }
 
@@ -301,6 +350,9 @@ Status IndexChannel::open() {
 Status IndexChannel::add_row(Tuple* tuple, int64_t tablet_id) {
     auto it = _channels_by_tablet.find(tablet_id);
     DCHECK(it != std::end(_channels_by_tablet)) << "unknown tablet, tablet_id=" << tablet_id;
+    // the primary replica forwards the rows to the others, unless it failed
+    // to open
+    bool forwarded = it->second.front()->is_primary() && !it->second.front()->already_failed();
     for (auto channel : it->second) {
         if (channel->already_failed()) {
             continue;
@@ -312,11 +364,15 @@ Status IndexChannel::add_row(Tuple* tuple, int64_t tablet_id) {
                 << ", node=" << channel->node_info()->host
                 << ":" << channel->node_info()->brpc_port
                 << ", errmsg=" << st.get_error_msg();
-            if (_handle_failed_node(channel)) {
+            // the replicas of a failed primary would miss some of its rows
+            if (_handle_failed_node(channel) || channel->is_primary()) {
                 LOG(WARNING) << "add row failed, load_id=" << _parent->_load_id;
                 return st;
             }
         }
+        if (forwarded) {
+            break;
+        }
     }
     return Status::OK;
 }
@@ -326,6 +382,26 @@ Status IndexChannel::close(RuntimeState* state) {
     need_wait_channels.reserve(_node_channels.size());
 
     Status close_status;
+    // a replica is closed only after the rows forwarded to it are written
+    if (config::tablet_writer_chain_replication) {
+        for (auto& it : _node_channels) {
+            auto channel = it.second;
+            if (channel->already_failed()) {
+                continue;
+            }
+            auto st = channel->flush();
+            if (!st.ok()) {
+                LOG(WARNING) << "flush node channel failed, load_id=" << _parent->_load_id
+                    << ", node=" << channel->node_info()->host
+                    << ":" << channel->node_info()->brpc_port
+                    << ", errmsg=" << st.get_error_msg();
+                if (_handle_failed_node(channel) || channel->is_primary()) {
+                    close_status = st;
+                    break;
+                }
+            }
+        }
+    }
     for (auto& it : _node_channels) {
         auto channel = it.second;
         if (channel->already_failed() || !close_status.ok()) {
@@ -552,17 +628,18 @@ Status OlapTableSink::send(RuntimeState* state, RowBatch* input_batch) {
         _number_filtered_rows += num_invalid_rows;
     }
     SCOPED_RAW_TIMER(&_send_data_ns);
+    _partition->find_tablets(batch, num_invalid_rows > 0 ? &_filter_bitmap : nullptr,
+                             &_row_partitions, &_row_tablet_indexes);
+    const OlapTablePartition* last_partition = nullptr;
     for (int i = 0; i < batch->num_rows(); ++i) {
-        Tuple* tuple = batch->get_row(i)->get_tuple(0);
         if (num_invalid_rows > 0 && _filter_bitmap.Get(i)) {
             continue;
         }
-        const OlapTablePartition* partition = nullptr;
-        uint32_t dist_hash = 0;
-        if (!_partition->find_tablet(tuple, &partition, &dist_hash)) {
+        const OlapTablePartition* partition = _row_partitions[i];
+        if (partition == nullptr) {
             std::stringstream ss;
             ss << "no partition for this tuple. tuple="
-                << Tuple::to_string(tuple, *_output_tuple_desc);
+                << Tuple::to_string(batch->get_row(i)->get_tuple(0), *_output_tuple_desc);
 #if BE_TEST
             LOG(INFO) << ss.str();
 #else
@@ -571,11 +648,24 @@ Status OlapTableSink::send(RuntimeState* state, RowBatch* input_batch) {
             _number_filtered_rows++;
             continue;
         }
-        _partition_ids.emplace(partition->id);
-        uint32_t tablet_index = dist_hash % partition->num_buckets;
-        for (int j = 0; j < partition->indexes.size(); ++j) {
-            int64_t tablet_id = partition->indexes[j].tablets[tablet_index];
-            RETURN_IF_ERROR(_channels[j]->add_row(tuple, tablet_id));
+        if (partition != last_partition) {
+            _partition_ids.emplace(partition->id);
+            last_partition = partition;
+        }
+        DCHECK_EQ(partition->indexes.size(), _channels.size());
+        _row_tablet_indexes[i] %= partition->num_buckets;
+    }
+
+    // rows go to the channels of one index after the other, a node channel
+    // still gets its rows in the order of the batch
+    for (int j = 0; j < _channels.size(); ++j) {
+        for (int i = 0; i < batch->num_rows(); ++i) {
+            const OlapTablePartition* partition = _row_partitions[i];
+            if (partition == nullptr) {
+                continue;
+            }
+            int64_t tablet_id = partition->indexes[j].tablets[_row_tablet_indexes[i]];
+            RETURN_IF_ERROR(_channels[j]->add_row(batch->get_row(i)->get_tuple(0), tablet_id));
             _number_output_rows++;
         }
     }
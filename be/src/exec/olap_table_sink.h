@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <set>
 #include <string>
@@ -38,6 +39,7 @@
 namespace doris {
 
 class Bitmap;
+class ColumnarRowBatch;
 class MemTracker;
 class RuntimeProfile;
 class RowDescriptor;
@@ -66,8 +68,17 @@ public:
     void open();
     Status open_wait();
 
+    // the rows of 'tablet_id' are forwarded to 'replica' by this node
+    void add_forward_replica(int64_t tablet_id, NodeChannel* replica) {
+        _forward_replicas.emplace_back(tablet_id, replica);
+    }
+    bool is_primary() const { return !_forward_replicas.empty(); }
+
     Status add_row(Tuple* tuple, int64_t tablet_id);
 
+    // sends the rows added so far and waits for all packets
+    Status flush();
+
     Status close(RuntimeState* state);
     Status close_wait(RuntimeState* state);
 
@@ -81,8 +92,9 @@ public:
 
 private:
     Status _send_cur_batch(bool eos = false);
-    // wait inflight packet finish, return error if inflight packet return failed
-    Status _wait_in_flight_packet();
+    // wait until at most 'num' packets are in flight, return error if one of
+    // the finished packets failed
+    Status _wait_in_flight_packets(size_t num);
 
     Status _close(RuntimeState* state);
 
@@ -96,16 +108,23 @@ private:
     const NodeInfo* _node_info = nullptr;
 
     bool _already_failed = false;
-    bool _has_in_flight_packet = false;
     int _rpc_timeout_ms = 50000;
+    // packets sent without waiting for the result of the ones before them
+    size_t _max_in_flight_packets = 1;
     int64_t _next_packet_seq = 0;
 
     std::unique_ptr<RowBatch> _batch;
+    // set if rows are sent column by column
+    std::unique_ptr<ColumnarRowBatch> _columnar_batch;
     palo::PInternalService_Stub* _stub = nullptr;
     RefCountClosure<PTabletWriterOpenResult>* _open_closure = nullptr;
-    RefCountClosure<PTabletWriterAddBatchResult>* _add_batch_closure = nullptr;
+    // oldest first
+    std::deque<RefCountClosure<PTabletWriterAddBatchResult>*> _in_flight_closures;
+    // result of the last finished packet
+    PTabletWriterAddBatchResult _add_batch_result;
 
     std::vector<TTabletWithPartition> _all_tablets;
+    std::vector<std::pair<int64_t, NodeChannel*>> _forward_replicas;
     PTabletWriterAddBatchRequest _add_batch_request;
 };
 
@@ -120,8 +139,17 @@ public:
     Status init(RuntimeState* state,
                 const std::vector<TTabletWithPartition>& tablets);
     Status open();
+    // the rows of 'tablet_id' are forwarded to 'replica' by this node
+    void add_forward_replica(int64_t tablet_id, NodeChannel* replica) {
+        _forward_replicas.emplace_back(tablet_id, replica);
+    }
+    bool is_primary() const { return !_forward_replicas.empty(); }
+
     Status add_row(Tuple* tuple, int64_t tablet_id);
 
+    // sends the rows added so far and waits for all packets
+    Status flush();
+
     Status close(RuntimeState* state);
 
     void cancel();
@@ -223,6 +251,11 @@ private:
 
     Bitmap _filter_bitmap;
 
+    // partition and then tablet index of every row of the batch being sent,
+    // reused by all batches
+    std::vector<const OlapTablePartition*> _row_partitions;
+    std::vector<uint32_t> _row_tablet_indexes;
+
     // index_channel
     std::vector<IndexChannel*> _channels;
 
@@ -0,0 +1,450 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/parquet_reader.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+#include <parquet/exception.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <parquet/schema.h>
+
+#include "common/logging.h"
+#include "exec/file_reader.h"
+#include "gutil/strings/numbers.h"
+#include "runtime/descriptors.h"
+
+namespace doris {
+
+// formatted numbers, dates and decimals are not longer than it
+static const size_t MAX_VALUE_SIZE = 64;
+
+arrow::Status ParquetFile::Read(int64_t nbytes, int64_t* bytes_read, void* out) {
+    ARROW_RETURN_NOT_OK(ReadAt(_pos, nbytes, bytes_read, out));
+    _pos += *bytes_read;
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer>* out) {
+    ARROW_RETURN_NOT_OK(ReadAt(_pos, nbytes, out));
+    _pos += (*out)->size();
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetFile::ReadAt(int64_t position, int64_t nbytes,
+                                  int64_t* bytes_read, void* out) {
+    Status st = _file->readat(position, nbytes, bytes_read, out);
+    if (!st.ok()) {
+        return arrow::Status::IOError(st.get_error_msg());
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetFile::ReadAt(int64_t position, int64_t nbytes,
+                                  std::shared_ptr<arrow::Buffer>* out) {
+    std::shared_ptr<arrow::ResizableBuffer> buffer;
+    ARROW_RETURN_NOT_OK(arrow::AllocateResizableBuffer(nbytes, &buffer));
+    int64_t bytes_read = 0;
+    ARROW_RETURN_NOT_OK(ReadAt(position, nbytes, &bytes_read, buffer->mutable_data()));
+    if (bytes_read < nbytes) {
+        ARROW_RETURN_NOT_OK(buffer->Resize(bytes_read));
+    }
+    *out = buffer;
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetFile::GetSize(int64_t* size) {
+    Status st = _file->size(size);
+    if (!st.ok()) {
+        return arrow::Status::IOError(st.get_error_msg());
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetFile::Seek(int64_t position) {
+    _pos = position;
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetFile::Tell(int64_t* position) const {
+    *position = _pos;
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetFile::Close() {
+    // the file is closed by ParquetReaderWrap
+    return arrow::Status::OK();
+}
+
+bool ParquetFile::closed() const {
+    return false;
+}
+
+ParquetReaderWrap::ParquetReaderWrap(FileReader* file) :
+        _file(file),
+        _parquet(new ParquetFile(file)),
+        _next_group(0),
+        _next_row(0) {
+}
+
+ParquetReaderWrap::~ParquetReaderWrap() {
+    close();
+}
+
+static std::string to_lower(const std::string& str) {
+    std::string lower(str);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
+}
+
+Status ParquetReaderWrap::init(const std::vector<SlotDescriptor*>& src_slots,
+                               int64_t start_offset, int64_t size) {
+    try {
+        _reader.reset(new parquet::arrow::FileReader(
+                arrow::default_memory_pool(), parquet::ParquetFileReader::Open(_parquet)));
+        std::shared_ptr<parquet::FileMetaData> metadata = _reader->parquet_reader()->metadata();
+
+        // find columns by name, the other columns are not read
+        const parquet::SchemaDescriptor* schema = metadata->schema();
+        std::map<std::string, int> column_of_name;
+        for (int i = 0; i < schema->num_columns(); ++i) {
+            column_of_name.emplace(to_lower(schema->Column(i)->name()), i);
+        }
+        std::vector<int> slot_indices;
+        for (auto slot : src_slots) {
+            auto it = column_of_name.find(to_lower(slot->col_name()));
+            if (it == column_of_name.end()) {
+                if (!slot->is_nullable()) {
+                    std::stringstream ss;
+                    ss << "Column " << slot->col_name() << " is not in parquet file";
+                    return Status(ss.str());
+                }
+                slot_indices.push_back(-1);
+                continue;
+            }
+            slot_indices.push_back(it->second);
+            _column_indices.push_back(it->second);
+        }
+        std::sort(_column_indices.begin(), _column_indices.end());
+        _column_indices.erase(std::unique(_column_indices.begin(), _column_indices.end()),
+                              _column_indices.end());
+        for (int index : slot_indices) {
+            if (index < 0) {
+                _slot_columns.push_back(-1);
+            } else {
+                _slot_columns.push_back(std::lower_bound(
+                        _column_indices.begin(), _column_indices.end(), index)
+                    - _column_indices.begin());
+            }
+        }
+        _columns.resize(src_slots.size());
+
+        // a row group belongs to the range where it starts
+        for (int i = 0; i < metadata->num_row_groups(); ++i) {
+            std::unique_ptr<parquet::RowGroupMetaData> group = metadata->RowGroup(i);
+            if (group->num_rows() == 0 || group->num_columns() == 0) {
+                continue;
+            }
+            std::unique_ptr<parquet::ColumnChunkMetaData> chunk = group->ColumnChunk(0);
+            int64_t group_start = chunk->data_page_offset();
+            if (chunk->has_dictionary_page() && chunk->dictionary_page_offset() > 0) {
+                group_start = std::min(group_start, chunk->dictionary_page_offset());
+            }
+            if (group_start < start_offset
+                    || (size >= 0 && group_start >= start_offset + size)) {
+                continue;
+            }
+            _row_groups.push_back(i);
+        }
+    } catch (parquet::ParquetException& e) {
+        std::stringstream ss;
+        ss << "Open parquet file failed: " << e.what();
+        LOG(WARNING) << ss.str();
+        return Status(ss.str());
+    }
+    return Status::OK;
+}
+
+Status ParquetReaderWrap::_next_row_group(bool* eof) {
+    _table.reset();
+    _next_row = 0;
+    if (_next_group >= _row_groups.size()) {
+        *eof = true;
+        return Status::OK;
+    }
+    int group = _row_groups[_next_group++];
+    arrow::Status st;
+    try {
+        st = _reader->ReadRowGroup(group, _column_indices, &_table);
+    } catch (parquet::ParquetException& e) {
+        st = arrow::Status::IOError(e.what());
+    }
+    if (!st.ok()) {
+        std::stringstream ss;
+        ss << "Read parquet row group failed, group=" << group << ", error=" << st.ToString();
+        LOG(WARNING) << ss.str();
+        return Status(ss.str());
+    }
+    *eof = false;
+    return Status::OK;
+}
+
+Status ParquetReaderWrap::next_rows(int max_rows, int* num_rows, bool* eof) {
+    *num_rows = 0;
+    *eof = false;
+    while (_table == nullptr || _next_row >= _table->num_rows()) {
+        RETURN_IF_ERROR(_next_row_group(eof));
+        if (*eof) {
+            return Status::OK;
+        }
+    }
+    int rows = std::min<int64_t>(max_rows, _table->num_rows() - _next_row);
+    for (int i = 0; i < _columns.size(); ++i) {
+        ParquetColumnValues* column = &_columns[i];
+        if (_slot_columns[i] < 0) {
+            column->values.assign(rows, Slice());
+            column->is_null.assign(rows, 1);
+            continue;
+        }
+        RETURN_IF_ERROR(_convert_column(*_table->column(_slot_columns[i])->data(),
+                                        _next_row, rows, column));
+    }
+    _next_row += rows;
+    *num_rows = rows;
+    return Status::OK;
+}
+
+static char* put_digits(int64_t value, int width, char* buf) {
+    for (int i = width - 1; i >= 0; --i) {
+        buf[i] = '0' + value % 10;
+        value /= 10;
+    }
+    return buf + width;
+}
+
+// 'seconds' since 1970-01-01 00:00:00 UTC
+static char* format_datetime(int64_t seconds, bool has_time, char* buf) {
+    int64_t days = seconds / 86400;
+    int64_t secs_of_day = seconds % 86400;
+    if (secs_of_day < 0) {
+        secs_of_day += 86400;
+        --days;
+    }
+    // civil date of days since epoch, in the proleptic gregorian calendar
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t day_of_era = days - era * 146097;
+    int64_t year_of_era =
+        (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t mp = (5 * day_of_year + 2) / 153;
+    int64_t day = day_of_year - (153 * mp + 2) / 5 + 1;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = year_of_era + era * 400 + (month <= 2);
+
+    if (year >= 0 && year <= 9999) {
+        buf = put_digits(year, 4, buf);
+    } else {
+        // not a valid date of doris, the load reports it
+        buf = FastInt64ToBufferLeft(year, buf);
+    }
+    *buf++ = '-';
+    buf = put_digits(month, 2, buf);
+    *buf++ = '-';
+    buf = put_digits(day, 2, buf);
+    if (has_time) {
+        *buf++ = ' ';
+        buf = put_digits(secs_of_day / 3600, 2, buf);
+        *buf++ = ':';
+        buf = put_digits(secs_of_day / 60 % 60, 2, buf);
+        *buf++ = ':';
+        buf = put_digits(secs_of_day % 60, 2, buf);
+    }
+    return buf;
+}
+
+// Formats the not null values of [offset, offset + n) of 'array' to 'buf'
+// by 'format', which returns the end of the value.
+template <typename FormatFunc>
+static void format_values(const arrow::Array& array, int64_t offset, int n,
+                          Slice* values, uint8_t* is_null, char** buf, FormatFunc format) {
+    for (int i = 0; i < n; ++i) {
+        if (array.IsNull(offset + i)) {
+            is_null[i] = 1;
+            continue;
+        }
+        char* end = format(offset + i, *buf);
+        values[i] = Slice(*buf, end - *buf);
+        *buf = end;
+    }
+}
+
+static int64_t floor_div(int64_t value, int64_t divisor) {
+    int64_t res = value / divisor;
+    return (value % divisor < 0) ? res - 1 : res;
+}
+
+static Status convert_array(const arrow::Array& array, int64_t offset, int n,
+                            Slice* values, uint8_t* is_null, char** buf) {
+    switch (array.type_id()) {
+    case arrow::Type::STRING:
+    case arrow::Type::BINARY: {
+        // strings are not copied
+        const auto& typed = static_cast<const arrow::BinaryArray&>(array);
+        for (int i = 0; i < n; ++i) {
+            if (typed.IsNull(offset + i)) {
+                is_null[i] = 1;
+                continue;
+            }
+            int32_t len = 0;
+            const uint8_t* ptr = typed.GetValue(offset + i, &len);
+            values[i] = Slice(ptr, len);
+        }
+        break;
+    }
+    case arrow::Type::FIXED_SIZE_BINARY: {
+        const auto& typed = static_cast<const arrow::FixedSizeBinaryArray&>(array);
+        for (int i = 0; i < n; ++i) {
+            if (typed.IsNull(offset + i)) {
+                is_null[i] = 1;
+                continue;
+            }
+            values[i] = Slice(typed.GetValue(offset + i), typed.byte_width());
+        }
+        break;
+    }
+    case arrow::Type::BOOL: {
+        const auto& typed = static_cast<const arrow::BooleanArray&>(array);
+        format_values(array, offset, n, values, is_null, buf, [&typed](int64_t i, char* p) {
+            *p = typed.Value(i) ? '1' : '0';
+            return p + 1;
+        });
+        break;
+    }
+#define FORMAT_INTEGERS(TYPE, ARRAY_TYPE, FORMAT_FUNC) \
+    case arrow::Type::TYPE: { \
+        const auto& typed = static_cast<const arrow::ARRAY_TYPE&>(array); \
+        format_values(array, offset, n, values, is_null, buf, [&typed](int64_t i, char* p) { \
+            return FORMAT_FUNC(typed.Value(i), p); \
+        }); \
+        break; \
+    }
+    FORMAT_INTEGERS(INT8, Int8Array, FastInt64ToBufferLeft)
+    FORMAT_INTEGERS(INT16, Int16Array, FastInt64ToBufferLeft)
+    FORMAT_INTEGERS(INT32, Int32Array, FastInt64ToBufferLeft)
+    FORMAT_INTEGERS(INT64, Int64Array, FastInt64ToBufferLeft)
+    FORMAT_INTEGERS(UINT8, UInt8Array, FastUInt64ToBufferLeft)
+    FORMAT_INTEGERS(UINT16, UInt16Array, FastUInt64ToBufferLeft)
+    FORMAT_INTEGERS(UINT32, UInt32Array, FastUInt64ToBufferLeft)
+    FORMAT_INTEGERS(UINT64, UInt64Array, FastUInt64ToBufferLeft)
+#undef FORMAT_INTEGERS
+    case arrow::Type::FLOAT: {
+        const auto& typed = static_cast<const arrow::FloatArray&>(array);
+        format_values(array, offset, n, values, is_null, buf, [&typed](int64_t i, char* p) {
+            return p + FloatToBuffer(typed.Value(i), kFloatToBufferSize, p);
+        });
+        break;
+    }
+    case arrow::Type::DOUBLE: {
+        const auto& typed = static_cast<const arrow::DoubleArray&>(array);
+        format_values(array, offset, n, values, is_null, buf, [&typed](int64_t i, char* p) {
+            return p + DoubleToBuffer(typed.Value(i), kDoubleToBufferSize, p);
+        });
+        break;
+    }
+    case arrow::Type::DATE32: {
+        const auto& typed = static_cast<const arrow::Date32Array&>(array);
+        format_values(array, offset, n, values, is_null, buf, [&typed](int64_t i, char* p) {
+            return format_datetime(static_cast<int64_t>(typed.Value(i)) * 86400, false, p);
+        });
+        break;
+    }
+    case arrow::Type::TIMESTAMP: {
+        const auto& typed = static_cast<const arrow::TimestampArray&>(array);
+        int64_t units_per_second = 1;
+        switch (static_cast<const arrow::TimestampType&>(*array.type()).unit()) {
+        case arrow::TimeUnit::SECOND: units_per_second = 1; break;
+        case arrow::TimeUnit::MILLI: units_per_second = 1000; break;
+        case arrow::TimeUnit::MICRO: units_per_second = 1000000; break;
+        case arrow::TimeUnit::NANO: units_per_second = 1000000000; break;
+        }
+        // datetime of doris has no fraction of second
+        format_values(array, offset, n, values, is_null, buf,
+                      [&typed, units_per_second](int64_t i, char* p) {
+            return format_datetime(floor_div(typed.Value(i), units_per_second), true, p);
+        });
+        break;
+    }
+    case arrow::Type::DECIMAL: {
+        const auto& typed = static_cast<const arrow::Decimal128Array&>(array);
+        format_values(array, offset, n, values, is_null, buf, [&typed](int64_t i, char* p) {
+            std::string value = typed.FormatValue(i);
+            memcpy(p, value.data(), value.size());
+            return p + value.size();
+        });
+        break;
+    }
+    default: {
+        std::stringstream ss;
+        ss << "Unsupported parquet type: " << array.type()->ToString();
+        return Status(ss.str());
+    }
+    }
+    return Status::OK;
+}
+
+Status ParquetReaderWrap::_convert_column(const arrow::ChunkedArray& data,
+                                          int64_t start, int num_rows,
+                                          ParquetColumnValues* column) {
+    column->values.resize(num_rows);
+    column->is_null.assign(num_rows, 0);
+    // values are not moved by appending, pointers to them are kept
+    column->buffer.resize(num_rows * MAX_VALUE_SIZE);
+    char* buf = &column->buffer[0];
+
+    int row = 0;
+    int64_t chunk_start = 0;
+    for (int i = 0; i < data.num_chunks() && row < num_rows; ++i) {
+        const arrow::Array& array = *data.chunk(i);
+        int64_t chunk_end = chunk_start + array.length();
+        if (chunk_end > start + row) {
+            int64_t offset = start + row - chunk_start;
+            int n = std::min<int64_t>(num_rows - row, array.length() - offset);
+            RETURN_IF_ERROR(convert_array(array, offset, n, &column->values[row],
+                                          &column->is_null[row], &buf));
+            row += n;
+        }
+        chunk_start = chunk_end;
+    }
+    DCHECK_EQ(row, num_rows);
+    return Status::OK;
+}
+
+void ParquetReaderWrap::close() {
+    _table.reset();
+    _reader.reset();
+    if (_file != nullptr) {
+        _file->close();
+    }
+}
+
+}
@@ -0,0 +1,121 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/interfaces.h>
+#include <parquet/arrow/reader.h>
+
+#include "common/status.h"
+#include "util/slice.h"
+
+namespace doris {
+
+class FileReader;
+class SlotDescriptor;
+
+// Lets parquet read a file through a FileReader, which must support readat.
+class ParquetFile : public arrow::io::RandomAccessFile {
+public:
+    ParquetFile(FileReader* file) : _file(file), _pos(0) { }
+    virtual ~ParquetFile() { }
+
+    arrow::Status Read(int64_t nbytes, int64_t* bytes_read, void* out) override;
+    arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer>* out) override;
+    arrow::Status ReadAt(int64_t position, int64_t nbytes,
+                         int64_t* bytes_read, void* out) override;
+    arrow::Status ReadAt(int64_t position, int64_t nbytes,
+                         std::shared_ptr<arrow::Buffer>* out) override;
+    arrow::Status GetSize(int64_t* size) override;
+    arrow::Status Seek(int64_t position) override;
+    arrow::Status Tell(int64_t* position) const override;
+    arrow::Status Close() override;
+    bool closed() const override;
+
+private:
+    FileReader* _file;
+    int64_t _pos;
+};
+
+// The values of rows of one column, as text.
+struct ParquetColumnValues {
+    std::vector<Slice> values;
+    std::vector<uint8_t> is_null;
+    // numbers, dates and decimals are formatted here, strings point into
+    // the row group read
+    std::string buffer;
+};
+
+// Reads a parquet file row group by row group, only the columns needed by
+// the load. Values are converted to text column by column because the
+// source slots of a load are strings.
+class ParquetReaderWrap {
+public:
+    // 'file' is owned by this reader
+    ParquetReaderWrap(FileReader* file);
+    ~ParquetReaderWrap();
+
+    // Open the file and find the columns of 'src_slots' by name. Only the
+    // row groups which start in [start_offset, start_offset + size) are
+    // read, so that a file can be split into several ranges. A size of -1
+    // means to the end of file.
+    Status init(const std::vector<SlotDescriptor*>& src_slots,
+                int64_t start_offset, int64_t size);
+
+    // Convert at most 'max_rows' rows to 'num_rows' values of every src
+    // slot, which stay valid until the next call. 'eof' is set when there
+    // are no more rows.
+    Status next_rows(int max_rows, int* num_rows, bool* eof);
+
+    const ParquetColumnValues& column(int slot_idx) const {
+        return _columns[slot_idx];
+    }
+
+    void close();
+
+private:
+    Status _next_row_group(bool* eof);
+
+    Status _convert_column(const arrow::ChunkedArray& data, int64_t start, int num_rows,
+                           ParquetColumnValues* column);
+
+    std::unique_ptr<FileReader> _file;
+    std::shared_ptr<ParquetFile> _parquet;
+    std::unique_ptr<parquet::arrow::FileReader> _reader;
+
+    // parquet columns to read, in the order of the file
+    std::vector<int> _column_indices;
+    // index in the table read of every src slot, -1 if file hasn't it
+    std::vector<int> _slot_columns;
+    std::vector<ParquetColumnValues> _columns;
+
+    // row groups in the range
+    std::vector<int> _row_groups;
+    size_t _next_group;
+
+    std::shared_ptr<arrow::Table> _table;
+    int64_t _next_row;
+};
+
+}
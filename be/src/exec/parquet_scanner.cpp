@@ -0,0 +1,161 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/parquet_scanner.h"
+
+#include <sstream>
+
+#include "exec/broker_reader.h"
+#include "exec/local_file_reader.h"
+#include "exec/parquet_reader.h"
+#include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+
+namespace doris {
+
+ParquetScanner::ParquetScanner(RuntimeState* state,
+                               RuntimeProfile* profile,
+                               const TBrokerScanRangeParams& params, 
+                               const std::vector<TBrokerRangeDesc>& ranges,
+                               const std::vector<TNetworkAddress>& broker_addresses,
+                               BrokerScanCounter* counter) : 
+        BaseScanner(state, profile, params, counter),
+        _ranges(ranges),
+        _broker_addresses(broker_addresses),
+        _cur_reader_eof(false),
+        _next_range(0),
+        _scanner_eof(false),
+        _num_rows(0),
+        _next_row(0) {
+}
+
+ParquetScanner::~ParquetScanner() {
+    close();
+}
+
+Status ParquetScanner::get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof) {
+    SCOPED_TIMER(_read_timer);
+    while (!_scanner_eof) {
+        if (_cur_reader == nullptr || _cur_reader_eof) {
+            RETURN_IF_ERROR(open_next_reader());
+            // If there isn't any more reader, break this
+            if (_scanner_eof) {
+                continue;
+            }
+        }
+        if (_next_row >= _num_rows) {
+            _next_row = 0;
+            RETURN_IF_ERROR(_cur_reader->next_rows(
+                    _state->batch_size(), &_num_rows, &_cur_reader_eof));
+            continue;
+        }
+        {
+            COUNTER_UPDATE(_rows_read_counter, 1);
+            SCOPED_TIMER(_materialize_timer);
+            _counter->num_rows_total++;
+            int row = _next_row++;
+            if (fill_src_tuple(row) && fill_dest_tuple(Slice(), tuple, tuple_pool)) {
+                break;
+            }
+        }
+    }
+    *eof = _scanner_eof;
+    return Status::OK;
+}
+
+Status ParquetScanner::open_next_reader() {
+    if (_next_range >= _ranges.size()) {
+        _scanner_eof = true;
+        return Status::OK;
+    }
+    if (_cur_reader != nullptr) {
+        _cur_reader->close();
+        _cur_reader.reset();
+    }
+
+    const TBrokerRangeDesc& range = _ranges[_next_range++];
+    FileReader* file_reader = nullptr;
+    switch (range.file_type) {
+    case TFileType::FILE_LOCAL: {
+        LocalFileReader* local_reader = new LocalFileReader(range.path, 0);
+        _cur_reader.reset(new ParquetReaderWrap(local_reader));
+        RETURN_IF_ERROR(local_reader->open());
+        file_reader = local_reader;
+        break;
+    }
+    case TFileType::FILE_BROKER: {
+        BrokerReader* broker_reader = new BrokerReader(
+            _state->exec_env(), _broker_addresses, _params.properties, range.path, 0,
+            range.__isset.file_size ? range.file_size : -1);
+        _cur_reader.reset(new ParquetReaderWrap(broker_reader));
+        RETURN_IF_ERROR(broker_reader->open());
+        file_reader = broker_reader;
+        break;
+    }
+    default: {
+        // parquet files are read from their footer, streams can't be read so
+        std::stringstream ss;
+        ss << "Unsupported file type of parquet file, type=" << range.file_type;
+        return Status(ss.str());
+    }
+    }
+    DCHECK(file_reader != nullptr);
+    RETURN_IF_ERROR(_cur_reader->init(_src_slot_descs, range.start_offset, range.size));
+    _cur_reader_eof = false;
+    _num_rows = 0;
+    _next_row = 0;
+    return Status::OK;
+}
+
+bool ParquetScanner::fill_src_tuple(int row) {
+    for (int i = 0; i < _src_slot_descs.size(); ++i) {
+        auto slot_desc = _src_slot_descs[i];
+        const ParquetColumnValues& column = _cur_reader->column(i);
+        if (column.is_null[row]) {
+            if (!slot_desc->is_nullable()) {
+                std::stringstream error_msg;
+                error_msg << "column(" << slot_desc->col_name() << ") value is null";
+                _state->append_error_msg_to_file(
+                    Tuple::to_string(_src_tuple, *_src_tuple_desc), error_msg.str());
+                _counter->num_rows_filtered++;
+                return false;
+            }
+            _src_tuple->set_null(slot_desc->null_indicator_offset());
+            continue;
+        }
+        _src_tuple->set_not_null(slot_desc->null_indicator_offset());
+        const Slice& value = column.values[row];
+        StringValue* str_slot = reinterpret_cast<StringValue*>(
+            _src_tuple->get_slot(slot_desc->tuple_offset()));
+        str_slot->ptr = value.data;
+        str_slot->len = value.size;
+    }
+    return true;
+}
+
+void ParquetScanner::close() {
+    if (_cur_reader != nullptr) {
+        _cur_reader->close();
+        _cur_reader.reset();
+    }
+    BaseScanner::close();
+}
+
+}
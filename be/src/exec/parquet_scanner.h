@@ -0,0 +1,71 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/status.h"
+#include "exec/base_scanner.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "gen_cpp/Types_types.h"
+
+namespace doris {
+
+class ParquetReaderWrap;
+
+// Scanner of parquet files, rows of a row group are converted to the source
+// tuple column by column.
+class ParquetScanner : public BaseScanner {
+public:
+    ParquetScanner(
+        RuntimeState* state,
+        RuntimeProfile* profile,
+        const TBrokerScanRangeParams& params, 
+        const std::vector<TBrokerRangeDesc>& ranges,
+        const std::vector<TNetworkAddress>& broker_addresses,
+        BrokerScanCounter* counter);
+    ~ParquetScanner();
+
+    // Get next tuple 
+    Status get_next(Tuple* tuple, MemPool* tuple_pool, bool* eof) override;
+
+    // Close this scanner
+    void close() override;
+
+private:
+    // Read next parquet file
+    Status open_next_reader();
+
+    // Put row 'row' of current rows in the source tuple
+    bool fill_src_tuple(int row);
+
+    const std::vector<TBrokerRangeDesc>& _ranges;
+    const std::vector<TNetworkAddress>& _broker_addresses;
+
+    std::unique_ptr<ParquetReaderWrap> _cur_reader;
+    bool _cur_reader_eof;
+    int _next_range;
+    bool _scanner_eof;
+
+    // rows converted by _cur_reader
+    int _num_rows;
+    int _next_row;
+};
+
+}
@@ -0,0 +1,350 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/parquet_writer.h"
+
+#include <sstream>
+
+#include "common/logging.h"
+#include "exec/file_writer.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "runtime/datetime_value.h"
+#include "runtime/decimal_value.h"
+#include "runtime/decimalv2_value.h"
+#include "runtime/row_batch.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple_row.h"
+#include "util/types.h"
+
+namespace doris {
+
+#define RETURN_IF_ARROW_ERROR(stmt) \
+    do { \
+        arrow::Status _arrow_status = (stmt); \
+        if (!_arrow_status.ok()) { \
+            return Status(_arrow_status.ToString()); \
+        } \
+    } while (false)
+
+arrow::Status ParquetOutputStream::Write(const void* data, int64_t nbytes) {
+    size_t written_len = 0;
+    Status st = _file->write(reinterpret_cast<const uint8_t*>(data), nbytes, &written_len);
+    if (!st.ok()) {
+        return arrow::Status::IOError(st.get_error_msg());
+    }
+    _pos += nbytes;
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetOutputStream::Tell(int64_t* position) const {
+    *position = _pos;
+    return arrow::Status::OK();
+}
+
+arrow::Status ParquetOutputStream::Close() {
+    if (!_closed) {
+        _file->close();
+        _closed = true;
+    }
+    return arrow::Status::OK();
+}
+
+ParquetBatchBuilder::ParquetBatchBuilder(const std::vector<ExprContext*>& output_expr_ctxs,
+                                         const std::vector<std::string>& column_names) :
+        _output_expr_ctxs(output_expr_ctxs),
+        _column_names(column_names),
+        _num_rows(0),
+        _buffered_bytes(0) {
+}
+
+ParquetBatchBuilder::~ParquetBatchBuilder() {
+}
+
+// days between 0000-01-01 and 1970-01-01
+static const int64_t UNIX_EPOCH_DAYNR = DateTimeValue::calc_daynr(1970, 1, 1);
+
+Status ParquetBatchBuilder::init() {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for (int i = 0; i < _output_expr_ctxs.size(); ++i) {
+        std::shared_ptr<arrow::DataType> type;
+        switch (_output_expr_ctxs[i]->root()->type().type) {
+        case TYPE_BOOLEAN:
+            type = arrow::boolean();
+            break;
+        case TYPE_TINYINT:
+            type = arrow::int8();
+            break;
+        case TYPE_SMALLINT:
+            type = arrow::int16();
+            break;
+        case TYPE_INT:
+            type = arrow::int32();
+            break;
+        case TYPE_BIGINT:
+            type = arrow::int64();
+            break;
+        case TYPE_FLOAT:
+            type = arrow::float32();
+            break;
+        case TYPE_DOUBLE:
+            type = arrow::float64();
+            break;
+        case TYPE_DATE:
+            type = arrow::date32();
+            break;
+        case TYPE_DATETIME:
+            type = arrow::timestamp(arrow::TimeUnit::MILLI);
+            break;
+        case TYPE_DECIMALV2:
+            type = arrow::decimal(27, 9);
+            break;
+        case TYPE_LARGEINT:
+        case TYPE_DECIMAL:
+        case TYPE_CHAR:
+        case TYPE_VARCHAR:
+            type = arrow::utf8();
+            break;
+        default: {
+            std::stringstream ss;
+            ss << "can't export this type to parquet. type = "
+                << _output_expr_ctxs[i]->root()->type();
+            return Status(ss.str());
+        }
+        }
+        std::string name = i < _column_names.size()
+            ? _column_names[i] : "col_" + std::to_string(i);
+        fields.push_back(arrow::field(name, type));
+
+        std::unique_ptr<arrow::ArrayBuilder> builder;
+        RETURN_IF_ARROW_ERROR(arrow::MakeBuilder(arrow::default_memory_pool(), type, &builder));
+        _builders.push_back(std::move(builder));
+    }
+    _schema = arrow::schema(fields);
+    return Status::OK;
+}
+
+Status ParquetBatchBuilder::add_batch(RowBatch* batch) {
+    for (int i = 0; i < _output_expr_ctxs.size(); ++i) {
+        RETURN_IF_ERROR(_add_column(i, batch));
+    }
+    _num_rows += batch->num_rows();
+    return Status::OK;
+}
+
+Status ParquetBatchBuilder::_add_column(int column, RowBatch* batch) {
+    ExprContext* ctx = _output_expr_ctxs[column];
+    arrow::ArrayBuilder* builder = _builders[column].get();
+    int num_rows = batch->num_rows();
+    PrimitiveType type = ctx->root()->type().type;
+    for (int i = 0; i < num_rows; ++i) {
+        void* item = ctx->get_value(batch->get_row(i));
+        if (item == nullptr) {
+            RETURN_IF_ARROW_ERROR(builder->AppendNull());
+            continue;
+        }
+        switch (type) {
+        case TYPE_BOOLEAN:
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::BooleanBuilder*>(builder)->Append(
+                    *static_cast<bool*>(item)));
+            _buffered_bytes += 1;
+            break;
+        case TYPE_TINYINT:
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::Int8Builder*>(builder)->Append(
+                    *static_cast<int8_t*>(item)));
+            _buffered_bytes += 1;
+            break;
+        case TYPE_SMALLINT:
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::Int16Builder*>(builder)->Append(
+                    *static_cast<int16_t*>(item)));
+            _buffered_bytes += 2;
+            break;
+        case TYPE_INT:
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::Int32Builder*>(builder)->Append(
+                    *static_cast<int32_t*>(item)));
+            _buffered_bytes += 4;
+            break;
+        case TYPE_BIGINT:
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::Int64Builder*>(builder)->Append(
+                    *static_cast<int64_t*>(item)));
+            _buffered_bytes += 8;
+            break;
+        case TYPE_FLOAT:
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::FloatBuilder*>(builder)->Append(
+                    *static_cast<float*>(item)));
+            _buffered_bytes += 4;
+            break;
+        case TYPE_DOUBLE:
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::DoubleBuilder*>(builder)->Append(
+                    *static_cast<double*>(item)));
+            _buffered_bytes += 8;
+            break;
+        case TYPE_DATE: {
+            const DateTimeValue* time_val = static_cast<const DateTimeValue*>(item);
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::Date32Builder*>(builder)->Append(
+                    time_val->daynr() - UNIX_EPOCH_DAYNR));
+            _buffered_bytes += 4;
+            break;
+        }
+        case TYPE_DATETIME: {
+            // the local time of the value, parquet timestamps have no time zone
+            const DateTimeValue* time_val = static_cast<const DateTimeValue*>(item);
+            int64_t seconds = (time_val->daynr() - UNIX_EPOCH_DAYNR) * 86400
+                + time_val->hour() * 3600 + time_val->minute() * 60 + time_val->second();
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::TimestampBuilder*>(builder)->Append(
+                    seconds * 1000 + time_val->microsecond() / 1000));
+            _buffered_bytes += 8;
+            break;
+        }
+        case TYPE_DECIMALV2: {
+            __int128 value = reinterpret_cast<const PackedInt128*>(item)->value;
+            arrow::Decimal128 decimal(static_cast<int64_t>(value >> 64),
+                                      static_cast<uint64_t>(value));
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::Decimal128Builder*>(builder)->Append(
+                    decimal));
+            _buffered_bytes += 16;
+            break;
+        }
+        case TYPE_LARGEINT: {
+            std::stringstream ss;
+            ss << reinterpret_cast<PackedInt128*>(item)->value;
+            const std::string& str = ss.str();
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::StringBuilder*>(builder)->Append(str));
+            _buffered_bytes += str.size();
+            break;
+        }
+        case TYPE_DECIMAL: {
+            const DecimalValue* decimal_val = reinterpret_cast<const DecimalValue*>(item);
+            int output_scale = ctx->root()->output_scale();
+            std::string str = output_scale > 0 && output_scale <= 30
+                ? decimal_val->to_string(output_scale) : decimal_val->to_string();
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::StringBuilder*>(builder)->Append(str));
+            _buffered_bytes += str.size();
+            break;
+        }
+        case TYPE_CHAR:
+        case TYPE_VARCHAR: {
+            const StringValue* string_val = static_cast<const StringValue*>(item);
+            RETURN_IF_ARROW_ERROR(static_cast<arrow::StringBuilder*>(builder)->Append(
+                    string_val->ptr, string_val->len));
+            _buffered_bytes += string_val->len;
+            break;
+        }
+        default:
+            DCHECK(false) << "unsupported type " << type;
+            break;
+        }
+    }
+    return Status::OK;
+}
+
+Status ParquetBatchBuilder::finish(std::shared_ptr<arrow::Table>* table) {
+    std::vector<std::shared_ptr<arrow::Array>> arrays(_builders.size());
+    for (int i = 0; i < _builders.size(); ++i) {
+        RETURN_IF_ARROW_ERROR(_builders[i]->Finish(&arrays[i]));
+    }
+    *table = arrow::Table::Make(_schema, arrays, _num_rows);
+    _num_rows = 0;
+    _buffered_bytes = 0;
+    return Status::OK;
+}
+
+ParquetWriterWrap::ParquetWriterWrap(FileWriter* file,
+                                     const std::shared_ptr<arrow::Schema>& schema,
+                                     const std::string& compression) :
+        _file(file),
+        _stream(new ParquetOutputStream(file)),
+        _schema(schema),
+        _compression(compression) {
+}
+
+ParquetWriterWrap::~ParquetWriterWrap() {
+    if (_writer != nullptr) {
+        close();
+    }
+}
+
+Status ParquetWriterWrap::open() {
+    parquet::Compression::type codec;
+    if (_compression.empty() || _compression == "snappy") {
+        codec = parquet::Compression::SNAPPY;
+    } else if (_compression == "gzip") {
+        codec = parquet::Compression::GZIP;
+    } else if (_compression == "lz4") {
+        codec = parquet::Compression::LZ4;
+    } else if (_compression == "zstd") {
+        codec = parquet::Compression::ZSTD;
+    } else if (_compression == "none") {
+        codec = parquet::Compression::UNCOMPRESSED;
+    } else {
+        return Status("unknown compression of parquet: " + _compression);
+    }
+    try {
+        std::shared_ptr<parquet::WriterProperties> properties =
+            parquet::WriterProperties::Builder().compression(codec)->build();
+        RETURN_IF_ARROW_ERROR(parquet::arrow::FileWriter::Open(
+                *_schema, arrow::default_memory_pool(), _stream, properties, &_writer));
+    } catch (parquet::ParquetException& e) {
+        std::stringstream ss;
+        ss << "Open parquet writer failed: " << e.what();
+        LOG(WARNING) << ss.str();
+        return Status(ss.str());
+    }
+    return Status::OK;
+}
+
+Status ParquetWriterWrap::write(const arrow::Table& table) {
+    try {
+        RETURN_IF_ARROW_ERROR(_writer->WriteTable(table, table.num_rows()));
+    } catch (parquet::ParquetException& e) {
+        std::stringstream ss;
+        ss << "Write parquet file failed: " << e.what();
+        LOG(WARNING) << ss.str();
+        return Status(ss.str());
+    }
+    return Status::OK;
+}
+
+int64_t ParquetWriterWrap::written_len() const {
+    int64_t position = 0;
+    _stream->Tell(&position);
+    return position;
+}
+
+Status ParquetWriterWrap::close() {
+    if (_writer == nullptr) {
+        _stream->Close();
+        return Status::OK;
+    }
+    Status status = Status::OK;
+    try {
+        arrow::Status st = _writer->Close();
+        if (!st.ok()) {
+            status = Status(st.ToString());
+        }
+    } catch (parquet::ParquetException& e) {
+        std::stringstream ss;
+        ss << "Close parquet file failed: " << e.what();
+        status = Status(ss.str());
+    }
+    _writer.reset();
+    _stream->Close();
+    return status;
+}
+
+}
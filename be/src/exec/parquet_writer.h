@@ -0,0 +1,126 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/api.h>
+#include <arrow/io/interfaces.h>
+#include <parquet/arrow/writer.h>
+
+#include "common/status.h"
+
+namespace doris {
+
+class ExprContext;
+class FileWriter;
+class RowBatch;
+
+// Lets parquet write a file through a FileWriter.
+class ParquetOutputStream : public arrow::io::OutputStream {
+public:
+    ParquetOutputStream(FileWriter* file) : _file(file), _pos(0), _closed(false) { }
+    virtual ~ParquetOutputStream() { }
+
+    arrow::Status Write(const void* data, int64_t nbytes) override;
+    arrow::Status Tell(int64_t* position) const override;
+    arrow::Status Close() override;
+    bool closed() const override {
+        return _closed;
+    }
+
+private:
+    FileWriter* _file;
+    int64_t _pos;
+    bool _closed;
+};
+
+// Converts the values of the output exprs of row batches to arrow arrays,
+// column by column. Strings, dates and decimals v2 keep their types, large
+// ints and decimals v1 become strings because parquet has no such types.
+class ParquetBatchBuilder {
+public:
+    // 'column_names' may be empty, columns are named col_<i> then
+    ParquetBatchBuilder(const std::vector<ExprContext*>& output_expr_ctxs,
+                        const std::vector<std::string>& column_names);
+    ~ParquetBatchBuilder();
+
+    Status init();
+
+    Status add_batch(RowBatch* batch);
+
+    int64_t num_rows() const {
+        return _num_rows;
+    }
+
+    // approximate size of the values added since the last finish()
+    int64_t buffered_bytes() const {
+        return _buffered_bytes;
+    }
+
+    // the rows added since the last call, the builders are reset
+    Status finish(std::shared_ptr<arrow::Table>* table);
+
+    const std::shared_ptr<arrow::Schema>& schema() const {
+        return _schema;
+    }
+
+private:
+    Status _add_column(int column, RowBatch* batch);
+
+    const std::vector<ExprContext*>& _output_expr_ctxs;
+    std::vector<std::string> _column_names;
+    std::shared_ptr<arrow::Schema> _schema;
+    std::vector<std::unique_ptr<arrow::ArrayBuilder>> _builders;
+    int64_t _num_rows;
+    int64_t _buffered_bytes;
+};
+
+// Writes a parquet file, every table written is one row group.
+class ParquetWriterWrap {
+public:
+    // 'file' is open and owned by this writer. 'compression' is one of
+    // snappy, gzip, lz4, zstd and none, snappy if empty
+    ParquetWriterWrap(FileWriter* file, const std::shared_ptr<arrow::Schema>& schema,
+                      const std::string& compression);
+    ~ParquetWriterWrap();
+
+    Status open();
+
+    Status write(const arrow::Table& table);
+
+    // bytes written to the file so far
+    int64_t written_len() const;
+
+    // writes the footer and closes the file
+    Status close();
+
+private:
+    std::unique_ptr<FileWriter> _file;
+    std::shared_ptr<ParquetOutputStream> _stream;
+    std::shared_ptr<arrow::Schema> _schema;
+    std::string _compression;
+    std::unique_ptr<parquet::arrow::FileWriter> _writer;
+};
+
+}
@@ -0,0 +1,911 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/partitioned_hash_join_node.h"
+
+#include <limits>
+#include <sstream>
+
+#include "exec/join_runtime_filters.h"
+#include "exec/partitioned_hash_table.inline.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "exprs/in_predicate.h"
+#include "runtime/buffered_tuple_stream2.inline.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple_row.h"
+#include "util/runtime_profile.h"
+
+namespace doris {
+
+PartitionedHashJoinNode::PartitionedHashJoinNode(
+        ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs) :
+        ExecNode(pool, tnode, descs),
+        _join_op(tnode.hash_join_node.join_op),
+        _is_push_down(false),
+        _state(NULL),
+        _block_mgr_client(NULL),
+        _partition_pool(new ObjectPool()),
+        _input_partition(NULL),
+        _phase(PROBING),
+        _eos(false),
+        _probe_batch_pos(0),
+        _probe_eos(false),
+        _current_probe_row(NULL),
+        _matched_probe(false),
+        _probe_tuple_row_size(0),
+        _build_tuple_row_size(0),
+        _build_timer(NULL),
+        _probe_timer(NULL),
+        _build_rows_counter(NULL),
+        _probe_rows_counter(NULL),
+        _num_hash_buckets(NULL),
+        _partitions_created(NULL),
+        _num_build_rows_repartitioned(NULL),
+        _num_probe_rows_repartitioned(NULL),
+        _num_repartitions(NULL),
+        _num_spilled_partitions(NULL),
+        _runtime_filter_timer(NULL) {
+    DCHECK_EQ(PARTITION_FANOUT, 1 << NUM_PARTITIONING_BITS);
+    _match_all_probe =
+        (_join_op == TJoinOp::LEFT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN);
+    _output_unmatched_build = (_join_op == TJoinOp::RIGHT_OUTER_JOIN
+        || _join_op == TJoinOp::FULL_OUTER_JOIN || _join_op == TJoinOp::RIGHT_ANTI_JOIN);
+}
+
+PartitionedHashJoinNode::~PartitionedHashJoinNode() {
+    // _probe_batch must be cleaned up in close() to ensure proper resource freeing.
+    DCHECK(_probe_batch == NULL);
+}
+
+Status PartitionedHashJoinNode::init(const TPlanNode& tnode, RuntimeState* state) {
+    RETURN_IF_ERROR(ExecNode::init(tnode, state));
+    DCHECK(tnode.__isset.hash_join_node);
+    const std::vector<TEqJoinCondition>& eq_join_conjuncts =
+        tnode.hash_join_node.eq_join_conjuncts;
+    for (int i = 0; i < eq_join_conjuncts.size(); ++i) {
+        ExprContext* ctx = NULL;
+        RETURN_IF_ERROR(Expr::create_expr_tree(_pool, eq_join_conjuncts[i].left, &ctx));
+        _probe_expr_ctxs.push_back(ctx);
+        RETURN_IF_ERROR(Expr::create_expr_tree(_pool, eq_join_conjuncts[i].right, &ctx));
+        _build_expr_ctxs.push_back(ctx);
+    }
+    RETURN_IF_ERROR(
+        Expr::create_expr_trees(_pool, tnode.hash_join_node.other_join_conjuncts,
+                                &_other_join_conjunct_ctxs));
+    _is_push_down = tnode.hash_join_node.__isset.is_push_down
+        && tnode.hash_join_node.is_push_down;
+    if (tnode.hash_join_node.__isset.runtime_filters) {
+        RETURN_IF_ERROR(JoinRuntimeFilters::check(tnode.hash_join_node.runtime_filters,
+                                                   _build_expr_ctxs.size()));
+        _runtime_filter_descs = tnode.hash_join_node.runtime_filters;
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::prepare(RuntimeState* state) {
+    SCOPED_TIMER(_runtime_profile->total_time_counter());
+    RETURN_IF_ERROR(ExecNode::prepare(state));
+    _state = state;
+
+    _build_timer = ADD_TIMER(runtime_profile(), "BuildTime");
+    _probe_timer = ADD_TIMER(runtime_profile(), "ProbeTime");
+    _build_rows_counter = ADD_COUNTER(runtime_profile(), "BuildRows", TUnit::UNIT);
+    _probe_rows_counter = ADD_COUNTER(runtime_profile(), "ProbeRows", TUnit::UNIT);
+    _num_hash_buckets = ADD_COUNTER(runtime_profile(), "HashBuckets", TUnit::UNIT);
+    _partitions_created = ADD_COUNTER(runtime_profile(), "PartitionsCreated", TUnit::UNIT);
+    _num_build_rows_repartitioned = ADD_COUNTER(
+            runtime_profile(), "BuildRowsRepartitioned", TUnit::UNIT);
+    _num_probe_rows_repartitioned = ADD_COUNTER(
+            runtime_profile(), "ProbeRowsRepartitioned", TUnit::UNIT);
+    _num_repartitions = ADD_COUNTER(runtime_profile(), "NumRepartitions", TUnit::UNIT);
+    _num_spilled_partitions = ADD_COUNTER(
+            runtime_profile(), "SpilledPartitions", TUnit::UNIT);
+    _runtime_filter_timer = ADD_TIMER(runtime_profile(), "RuntimeFilterTime");
+
+    // build and probe exprs are evaluated in the context of the rows produced by our
+    // right and left children, respectively
+    RETURN_IF_ERROR(Expr::prepare(
+            _build_expr_ctxs, state, child(1)->row_desc(), expr_mem_tracker()));
+    RETURN_IF_ERROR(Expr::prepare(
+            _probe_expr_ctxs, state, child(0)->row_desc(), expr_mem_tracker()));
+    // _other_join_conjuncts are evaluated in the context of the rows produced by this node
+    RETURN_IF_ERROR(Expr::prepare(
+            _other_join_conjunct_ctxs, state, _row_descriptor, expr_mem_tracker()));
+
+    int num_probe_tuples = child(0)->row_desc().tuple_descriptors().size();
+    int num_build_tuples = child(1)->row_desc().tuple_descriptors().size();
+    _probe_tuple_row_size = num_probe_tuples * sizeof(Tuple*);
+    _build_tuple_row_size = num_build_tuples * sizeof(Tuple*);
+
+    // build rows with null keys are kept for the joins returning unmatched build
+    // rows, they never match a probe row
+    _ht_ctx.reset(new PartitionedHashTableCtx(_build_expr_ctxs, _probe_expr_ctxs,
+                _output_unmatched_build, false, state->fragment_hash_seed(),
+                MAX_PARTITION_DEPTH, num_build_tuples));
+    RETURN_IF_ERROR(state->block_mgr2()->register_client(
+                min_required_buffers(), mem_tracker(), state, &_block_mgr_client));
+
+    _probe_batch.reset(new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::open(RuntimeState* state) {
+    SCOPED_TIMER(_runtime_profile->total_time_counter());
+    RETURN_IF_ERROR(ExecNode::open(state));
+    RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::OPEN));
+    RETURN_IF_CANCELLED(state);
+    RETURN_IF_ERROR(Expr::open(_build_expr_ctxs, state));
+    RETURN_IF_ERROR(Expr::open(_probe_expr_ctxs, state));
+    RETURN_IF_ERROR(Expr::open(_other_join_conjunct_ctxs, state));
+
+    RETURN_IF_ERROR(child(1)->open(state));
+    RETURN_IF_ERROR(process_build_input(state));
+    // the build rows are copied into the streams
+    child(1)->close(state);
+    // the probe child does not scan before it is opened
+    publish_runtime_filters(state);
+    RETURN_IF_ERROR(push_down_build_keys(state));
+
+    _phase = PROBING;
+    _eos = false;
+    _probe_batch_pos = 0;
+    _probe_eos = false;
+    _current_probe_row = NULL;
+    if (_build_rows_counter->value() == 0 && !_match_all_probe
+            && _join_op != TJoinOp::LEFT_ANTI_JOIN) {
+        // no probe row can be returned
+        _eos = true;
+    }
+    return child(0)->open(state);
+}
+
+Status PartitionedHashJoinNode::process_build_input(RuntimeState* state) {
+    RETURN_IF_ERROR(create_hash_partitions(0));
+    if (!_runtime_filter_descs.empty() && JoinRuntimeFilters::filters_probe(_join_op)) {
+        // only the filters the planner sized get a bloom filter here, the others
+        // keep the min and max values until the number of build rows is known
+        JoinRuntimeFilters::create(_runtime_filter_descs, _build_expr_ctxs,
+                                   std::numeric_limits<int64_t>::max(), &_runtime_filters);
+    }
+    RowBatch build_batch(child(1)->row_desc(), state->batch_size(), mem_tracker());
+    bool eos = false;
+    do {
+        RETURN_IF_CANCELLED(state);
+        RETURN_IF_ERROR(state->check_query_state());
+        RETURN_IF_ERROR(child(1)->get_next(state, &build_batch, &eos));
+        SCOPED_TIMER(_build_timer);
+        RETURN_IF_ERROR(process_build_batch(&build_batch));
+        COUNTER_UPDATE(_build_rows_counter, build_batch.num_rows());
+        build_batch.reset();
+    } while (!eos);
+
+    SCOPED_TIMER(_build_timer);
+    return build_hash_tables();
+}
+
+Status PartitionedHashJoinNode::process_build_batch(RowBatch* batch) {
+    for (int i = 0; i < batch->num_rows(); ++i) {
+        TupleRow* row = batch->get_row(i);
+        uint32_t hash = 0;
+        if (!_ht_ctx->eval_and_hash_build(row, &hash)) {
+            // a null key which never matches, and is not returned either
+            continue;
+        }
+        // the filters are published after level 0, before any repartitioning
+        for (int j = 0; j < _runtime_filters.size(); ++j) {
+            int expr_order = _runtime_filter_descs[j].expr_order;
+            if (_runtime_filters[j] != nullptr && !_ht_ctx->last_expr_value_null(expr_order)) {
+                _runtime_filters[j]->insert(_ht_ctx->last_expr_value(expr_order));
+            }
+        }
+        Partition* partition = _hash_partitions[hash >> (32 - NUM_PARTITIONING_BITS)];
+        RETURN_IF_ERROR(append_build_row(partition->build_rows.get(), row));
+    }
+    return Status::OK;
+}
+
+bool PartitionedHashJoinNode::has_spilled_partition() const {
+    for (Partition* partition : _hash_partitions) {
+        if (partition->is_spilled) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PartitionedHashJoinNode::publish_runtime_filters(RuntimeState* state) {
+    if (_runtime_filters.empty()) {
+        return;
+    }
+    SCOPED_TIMER(_runtime_filter_timer);
+    // The bloom filters of the filters the planner did not size are built from
+    // the hash tables now. The rows of spilled partitions are on disk, those
+    // filters are sent with their min and max values only then.
+    if (!has_spilled_partition()) {
+        std::vector<std::unique_ptr<RuntimeFilter>> filters;
+        JoinRuntimeFilters::create(_runtime_filter_descs, _build_expr_ctxs,
+                                   _build_rows_counter->value(), &filters);
+        for (int i = 0; i < filters.size(); ++i) {
+            if (_runtime_filter_descs[i].__isset.bloom_filter_entries) {
+                filters[i].reset();
+            }
+        }
+        for (Partition* partition : _hash_partitions) {
+            if (partition->is_closed || partition->hash_tbl.get() == NULL) {
+                continue;
+            }
+            PartitionedHashTable::Iterator iter = partition->hash_tbl->begin(_ht_ctx.get());
+            for (; !iter.at_end(); iter.next()) {
+                TupleRow* row = iter.get_row();
+                for (int i = 0; i < filters.size(); ++i) {
+                    if (filters[i] != nullptr) {
+                        int expr_order = _runtime_filter_descs[i].expr_order;
+                        filters[i]->insert(_build_expr_ctxs[expr_order]->get_value(row));
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < filters.size(); ++i) {
+            if (filters[i] != nullptr) {
+                _runtime_filters[i] = std::move(filters[i]);
+            }
+        }
+    }
+    JoinRuntimeFilters::publish(state, _runtime_filter_descs, _runtime_filters);
+    _runtime_filters.clear();
+}
+
+Status PartitionedHashJoinNode::push_down_build_keys(RuntimeState* state) {
+    // as HashJoinNode, only a few keys are worth testing by the probe side, and
+    // probe sides which are both exchanges do not filter their rows
+    if (!_is_push_down || !JoinRuntimeFilters::filters_probe(_join_op)
+            || _build_rows_counter->value() > 1024 || has_spilled_partition()
+            || (_children[0]->type() == TPlanNodeType::EXCHANGE_NODE
+                && _children[1]->type() == TPlanNodeType::EXCHANGE_NODE)) {
+        return Status::OK;
+    }
+    std::list<ExprContext*> push_down_expr_ctxs;
+    std::vector<InPredicate*> in_preds;
+    for (int i = 0; i < _probe_expr_ctxs.size(); ++i) {
+        ExprContext* ctx = nullptr;
+        RETURN_IF_ERROR(JoinRuntimeFilters::create_in_predicate(
+                _pool, state, _probe_expr_ctxs[i], &ctx));
+        push_down_expr_ctxs.push_back(ctx);
+        in_preds.push_back(static_cast<InPredicate*>(ctx->root()));
+    }
+    for (Partition* partition : _hash_partitions) {
+        if (partition->is_closed || partition->hash_tbl.get() == NULL) {
+            continue;
+        }
+        PartitionedHashTable::Iterator iter = partition->hash_tbl->begin(_ht_ctx.get());
+        for (; !iter.at_end(); iter.next()) {
+            TupleRow* row = iter.get_row();
+            for (int i = 0; i < _build_expr_ctxs.size(); ++i) {
+                in_preds[i]->insert(_build_expr_ctxs[i]->get_value(row));
+            }
+        }
+    }
+    push_down_predicate(state, &push_down_expr_ctxs);
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::append_build_row(BufferedTupleStream2* stream, TupleRow* row) {
+    while (!stream->add_row(row, &_process_batch_status)) {
+        // Adding fails iff either we hit an error or the stream needs a new buffer.
+        RETURN_IF_ERROR(_process_batch_status);
+        if (stream->using_small_buffers()) {
+            bool got_buffer = false;
+            RETURN_IF_ERROR(stream->switch_to_io_buffers(&got_buffer));
+            if (got_buffer) {
+                continue;
+            }
+        }
+        RETURN_IF_ERROR(spill_partition());
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::append_probe_row(BufferedTupleStream2* stream, TupleRow* row) {
+    DCHECK(!stream->is_pinned());
+    if (LIKELY(stream->add_row(row, &_process_batch_status))) {
+        return Status::OK;
+    }
+    RETURN_IF_ERROR(_process_batch_status);
+    bool got_buffer = false;
+    RETURN_IF_ERROR(stream->switch_to_io_buffers(&got_buffer));
+    if (!got_buffer) {
+        return _state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+    }
+    // Adding the row should succeed after the I/O buffer switch.
+    if (stream->add_row(row, &_process_batch_status)) {
+        return Status::OK;
+    }
+    DCHECK(!_process_batch_status.ok());
+    return _process_batch_status;
+}
+
+Status PartitionedHashJoinNode::build_hash_tables() {
+    for (Partition* partition : _hash_partitions) {
+        bool built = false;
+        while (!partition->is_spilled) {
+            RETURN_IF_ERROR(partition->build_hash_table(&built));
+            if (built) {
+                COUNTER_UPDATE(_num_hash_buckets, partition->hash_tbl->num_buckets());
+                break;
+            }
+            // There was not enough memory for the hash table. Spill a partition,
+            // maybe this one, and retry.
+            RETURN_IF_ERROR(spill_partition());
+        }
+    }
+    // the buffers of the spilled build rows are used to write the probe rows
+    for (Partition* partition : _hash_partitions) {
+        if (partition->is_spilled) {
+            RETURN_IF_ERROR(partition->build_rows->unpin_stream(true));
+            RETURN_IF_ERROR(partition->init_probe_stream());
+        }
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::create_hash_partitions(int level) {
+    if (level >= MAX_PARTITION_DEPTH) {
+        std::stringstream error_msg;
+        error_msg << "Cannot perform hash join at node with id " << _id << '.'
+            << " The input data was partitioned the maximum number of "
+            << MAX_PARTITION_DEPTH << " times."
+            << " This could mean there is significant skew in the data or the memory limit is"
+            << " set too low.";
+        return _state->set_mem_limit_exceeded(error_msg.str());
+    }
+    _ht_ctx->set_level(level);
+
+    DCHECK(_hash_partitions.empty());
+    for (int i = 0; i < PARTITION_FANOUT; ++i) {
+        Partition* new_partition = new Partition(this, level);
+        _hash_partitions.push_back(_partition_pool->add(new_partition));
+        RETURN_IF_ERROR(new_partition->init_streams());
+    }
+    COUNTER_UPDATE(_partitions_created, PARTITION_FANOUT);
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::spill_partition() {
+    int64_t max_freed_mem = 0;
+    int partition_idx = -1;
+    // Iterate over the partitions and pick the largest partition that is not spilled.
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (partition->is_closed || partition->is_spilled) {
+            continue;
+        }
+        int64_t mem = partition->build_rows->byte_size();
+        if (partition->hash_tbl.get() != NULL) {
+            mem += partition->hash_tbl->current_mem_size();
+        }
+        if (mem > max_freed_mem) {
+            max_freed_mem = mem;
+            partition_idx = i;
+        }
+    }
+    if (partition_idx == -1) {
+        // Could not find a partition to spill. This means the mem limit was just too low.
+        return _state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+    }
+    return _hash_partitions[partition_idx]->spill();
+}
+
+int64_t PartitionedHashJoinNode::largest_spilled_partition() const {
+    int64_t max_rows = 0;
+    for (Partition* partition : _hash_partitions) {
+        if (partition->is_closed || !partition->is_spilled) {
+            continue;
+        }
+        max_rows = std::max(max_rows, partition->build_rows->num_rows());
+    }
+    return max_rows;
+}
+
+Status PartitionedHashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eos) {
+    SCOPED_TIMER(_runtime_profile->total_time_counter());
+    RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::GETNEXT));
+    RETURN_IF_CANCELLED(state);
+    RETURN_IF_ERROR(state->check_query_state());
+
+    if (reached_limit() || _eos) {
+        *eos = true;
+        return Status::OK;
+    }
+
+    while (!_eos) {
+        if (_phase == PROBING) {
+            {
+                SCOPED_TIMER(_probe_timer);
+                RETURN_IF_ERROR(process_probe_batch(out_batch));
+            }
+            if (out_batch->is_full() || reached_limit()) {
+                break;
+            }
+            // pass on resources, out_batch might still need them
+            DCHECK(_current_probe_row == NULL);
+            _probe_batch->transfer_resource_ownership(out_batch);
+            _probe_batch_pos = 0;
+            if (!_probe_eos) {
+                if (out_batch->at_capacity()) {
+                    break;
+                }
+                RETURN_IF_ERROR(next_probe_batch(state));
+                continue;
+            }
+            RETURN_IF_ERROR(move_hash_partitions());
+            _phase = OUTPUTTING_BUILD;
+        }
+
+        RETURN_IF_ERROR(output_unmatched_build(out_batch));
+        if (!_output_build_partitions.empty() || reached_limit()) {
+            // out_batch is full
+            break;
+        }
+        // all the partitions of this level are done
+        if (_input_partition != NULL) {
+            _input_partition->close(out_batch);
+            _input_partition = NULL;
+        }
+        if (_spilled_partitions.empty()) {
+            _eos = true;
+            break;
+        }
+        if (out_batch->at_capacity()) {
+            // the next partition may need the blocks held by out_batch
+            break;
+        }
+        RETURN_IF_ERROR(prepare_next_partition(state));
+    }
+
+    COUNTER_SET(_rows_returned_counter, _num_rows_returned);
+    *eos = _eos || reached_limit();
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::next_probe_batch(RuntimeState* state) {
+    if (_input_partition == NULL) {
+        RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
+        COUNTER_UPDATE(_probe_rows_counter, _probe_batch->num_rows());
+    } else {
+        RETURN_IF_ERROR(_input_partition->probe_rows->get_next(_probe_batch.get(), &_probe_eos));
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::process_probe_batch(RowBatch* out_batch) {
+    ExprContext* const* other_conjunct_ctxs = &_other_join_conjunct_ctxs[0];
+    int num_other_conjunct_ctxs = _other_join_conjunct_ctxs.size();
+    ExprContext* const* conjunct_ctxs = &_conjunct_ctxs[0];
+    int num_conjunct_ctxs = _conjunct_ctxs.size();
+
+    while (true) {
+        if (_current_probe_row == NULL) {
+            if (_probe_batch_pos == _probe_batch->num_rows()) {
+                return Status::OK;
+            }
+            TupleRow* probe_row = _probe_batch->get_row(_probe_batch_pos++);
+            uint32_t hash = 0;
+            if (!_ht_ctx->eval_and_hash_probe(probe_row, &hash)) {
+                // a null key matches no build row
+                if (!_match_all_probe && _join_op != TJoinOp::LEFT_ANTI_JOIN) {
+                    continue;
+                }
+                _hash_tbl_iterator.set_at_end();
+            } else {
+                Partition* partition = _hash_partitions[hash >> (32 - NUM_PARTITIONING_BITS)];
+                if (partition->is_spilled) {
+                    // joined when the partition is processed
+                    RETURN_IF_ERROR(append_probe_row(partition->probe_rows.get(), probe_row));
+                    continue;
+                }
+                _hash_tbl_iterator = partition->hash_tbl->find(_ht_ctx.get(), hash);
+            }
+            _current_probe_row = probe_row;
+            _matched_probe = false;
+        }
+
+        while (!_hash_tbl_iterator.at_end()) {
+            if ((_join_op == TJoinOp::RIGHT_SEMI_JOIN || _join_op == TJoinOp::RIGHT_ANTI_JOIN)
+                    && _hash_tbl_iterator.is_matched()) {
+                // We have already matched this build row, continue to next match.
+                _hash_tbl_iterator.next_duplicate();
+                continue;
+            }
+            int row_idx = out_batch->add_row();
+            TupleRow* out_row = out_batch->get_row(row_idx);
+            create_output_row(out_row, _current_probe_row, _hash_tbl_iterator.get_row());
+            if (!eval_conjuncts(other_conjunct_ctxs, num_other_conjunct_ctxs, out_row)) {
+                _hash_tbl_iterator.next_duplicate();
+                continue;
+            }
+
+            // we have a match for the purpose of the (outer?) join as soon as we
+            // satisfy the JOIN clause conjuncts
+            _matched_probe = true;
+            if (_output_unmatched_build || _join_op == TJoinOp::RIGHT_SEMI_JOIN) {
+                _hash_tbl_iterator.set_matched();
+            }
+            if (_join_op == TJoinOp::RIGHT_ANTI_JOIN) {
+                _hash_tbl_iterator.next_duplicate();
+                continue;
+            }
+            if (_join_op == TJoinOp::LEFT_ANTI_JOIN || _join_op == TJoinOp::LEFT_SEMI_JOIN) {
+                // the probe row is decided by its first match
+                _hash_tbl_iterator.set_at_end();
+                if (_join_op == TJoinOp::LEFT_ANTI_JOIN) {
+                    continue;
+                }
+            } else {
+                _hash_tbl_iterator.next_duplicate();
+            }
+
+            if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+                out_batch->commit_last_row();
+                VLOG_ROW << "match row: " << out_row->to_string(row_desc());
+                ++_num_rows_returned;
+                if (out_batch->is_full() || reached_limit()) {
+                    return Status::OK;
+                }
+            }
+        }
+
+        TupleRow* probe_row = _current_probe_row;
+        _current_probe_row = NULL;
+        if (!_matched_probe && (_match_all_probe || _join_op == TJoinOp::LEFT_ANTI_JOIN)) {
+            int row_idx = out_batch->add_row();
+            TupleRow* out_row = out_batch->get_row(row_idx);
+            create_output_row(out_row, probe_row, NULL);
+            if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+                out_batch->commit_last_row();
+                VLOG_ROW << "match row: " << out_row->to_string(row_desc());
+                ++_num_rows_returned;
+                if (out_batch->is_full() || reached_limit()) {
+                    return Status::OK;
+                }
+            }
+        }
+    }
+}
+
+Status PartitionedHashJoinNode::move_hash_partitions() {
+    bool returns_unmatched_probe = _match_all_probe || _join_op == TJoinOp::LEFT_ANTI_JOIN;
+    for (Partition* partition : _hash_partitions) {
+        if (!partition->is_spilled) {
+            _output_build_partitions.push_back(partition);
+            continue;
+        }
+        if ((partition->build_rows->num_rows() == 0 && !returns_unmatched_probe)
+                || (partition->probe_rows->num_rows() == 0 && !_output_unmatched_build)) {
+            // nothing of it can be returned
+            partition->close(NULL);
+            continue;
+        }
+        RETURN_IF_ERROR(partition->probe_rows->unpin_stream(true));
+        // Push new created partitions at the front. This means a depth first walk
+        // (more finely partitioned partitions are processed first). This allows us
+        // to delete blocks earlier and bottom out the recursion earlier.
+        _spilled_partitions.push_front(partition);
+    }
+    _hash_partitions.clear();
+    begin_unmatched_build();
+    return Status::OK;
+}
+
+void PartitionedHashJoinNode::begin_unmatched_build() {
+    _build_iterator.set_at_end();
+    if (!_output_unmatched_build || _output_build_partitions.empty()) {
+        return;
+    }
+    PartitionedHashTable* hash_tbl = _output_build_partitions.front()->hash_tbl.get();
+    if (hash_tbl->size() > 0) {
+        _build_iterator = hash_tbl->first_unmatched(_ht_ctx.get());
+    }
+}
+
+Status PartitionedHashJoinNode::output_unmatched_build(RowBatch* out_batch) {
+    ExprContext* const* conjunct_ctxs = &_conjunct_ctxs[0];
+    int num_conjunct_ctxs = _conjunct_ctxs.size();
+    while (!_output_build_partitions.empty()) {
+        while (!_build_iterator.at_end()) {
+            if (out_batch->is_full() || reached_limit()) {
+                return Status::OK;
+            }
+            int row_idx = out_batch->add_row();
+            TupleRow* out_row = out_batch->get_row(row_idx);
+            create_output_row(out_row, NULL, _build_iterator.get_row());
+            _build_iterator.next_unmatched();
+            if (eval_conjuncts(conjunct_ctxs, num_conjunct_ctxs, out_row)) {
+                out_batch->commit_last_row();
+                VLOG_ROW << "match row: " << out_row->to_string(row_desc());
+                ++_num_rows_returned;
+            }
+        }
+        // rows returned before may point into the build rows
+        _output_build_partitions.front()->close(out_batch);
+        _output_build_partitions.pop_front();
+        begin_unmatched_build();
+    }
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::prepare_next_partition(RuntimeState* state) {
+    DCHECK(_hash_partitions.empty());
+    DCHECK(_input_partition == NULL);
+    _input_partition = _spilled_partitions.front();
+    _spilled_partitions.pop_front();
+    DCHECK(_input_partition->is_spilled);
+
+    // TODO: the partition may fit in memory now, it could be joined without
+    // repartitioning it.
+    RETURN_IF_ERROR(create_hash_partitions(_input_partition->level + 1));
+    COUNTER_UPDATE(_num_repartitions, 1);
+
+    BufferedTupleStream2* build_rows = _input_partition->build_rows.get();
+    int64_t num_input_rows = build_rows->num_rows();
+    if (num_input_rows > 0) {
+        while (true) {
+            bool got_buffer = false;
+            RETURN_IF_ERROR(build_rows->prepare_for_read(true, &got_buffer));
+            if (got_buffer) {
+                break;
+            }
+            // Did not have a buffer to read the input stream. Spill and try again.
+            RETURN_IF_ERROR(spill_partition());
+        }
+        RowBatch batch(child(1)->row_desc(), state->batch_size(), mem_tracker());
+        bool eos = false;
+        do {
+            RETURN_IF_CANCELLED(state);
+            RETURN_IF_ERROR(build_rows->get_next(&batch, &eos));
+            SCOPED_TIMER(_build_timer);
+            RETURN_IF_ERROR(process_build_batch(&batch));
+            batch.reset();
+        } while (!eos);
+    }
+    build_rows->close();
+    COUNTER_UPDATE(_num_build_rows_repartitioned, num_input_rows);
+    {
+        SCOPED_TIMER(_build_timer);
+        RETURN_IF_ERROR(build_hash_tables());
+    }
+
+    if (num_input_rows > 0 && largest_spilled_partition() == num_input_rows) {
+        Status status = Status::MEM_LIMIT_EXCEEDED;
+        std::stringstream error_msg;
+        error_msg << "Cannot perform hash join at node with id " << _id << ". "
+            << "Repartitioning did not reduce the size of a spilled partition. "
+            << "Repartitioning level " << _input_partition->level + 1
+            << ". Number of rows " << num_input_rows << " .";
+        status.add_error_msg(error_msg.str());
+        return status;
+    }
+
+    BufferedTupleStream2* probe_rows = _input_partition->probe_rows.get();
+    COUNTER_UPDATE(_num_probe_rows_repartitioned, probe_rows->num_rows());
+    _probe_eos = probe_rows->num_rows() == 0;
+    if (!_probe_eos) {
+        bool got_buffer = false;
+        RETURN_IF_ERROR(probe_rows->prepare_for_read(true, &got_buffer));
+        if (!got_buffer) {
+            return _state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+        }
+    }
+    _phase = PROBING;
+    return Status::OK;
+}
+
+void PartitionedHashJoinNode::close_partitions() {
+    for (Partition* partition : _hash_partitions) {
+        partition->close(NULL);
+    }
+    for (Partition* partition : _spilled_partitions) {
+        partition->close(NULL);
+    }
+    for (Partition* partition : _output_build_partitions) {
+        partition->close(NULL);
+    }
+    if (_input_partition != NULL) {
+        _input_partition->close(NULL);
+        _input_partition = NULL;
+    }
+    _hash_partitions.clear();
+    _spilled_partitions.clear();
+    _output_build_partitions.clear();
+    _partition_pool->clear();
+}
+
+Status PartitionedHashJoinNode::close(RuntimeState* state) {
+    if (is_closed()) {
+        return Status::OK;
+    }
+    RETURN_IF_ERROR(exec_debug_action(TExecNodePhase::CLOSE));
+    // Must reset _probe_batch in close() to release resources
+    _probe_batch.reset();
+    close_partitions();
+    if (_ht_ctx.get() != NULL) {
+        _ht_ctx->close();
+    }
+    if (_block_mgr_client != NULL) {
+        state->block_mgr2()->clear_reservations(_block_mgr_client);
+    }
+    Expr::close(_build_expr_ctxs, state);
+    Expr::close(_probe_expr_ctxs, state);
+    Expr::close(_other_join_conjunct_ctxs, state);
+    return ExecNode::close(state);
+}
+
+Status PartitionedHashJoinNode::Partition::init_streams() {
+    build_rows.reset(new BufferedTupleStream2(parent->_state, parent->child(1)->row_desc(),
+                parent->_state->block_mgr2(), parent->_block_mgr_client,
+                true /* use_initial_small_buffers */, false /* read_write */));
+    return build_rows->init(parent->id(), parent->runtime_profile(), true);
+}
+
+Status PartitionedHashJoinNode::Partition::init_probe_stream() {
+    DCHECK(is_spilled);
+    probe_rows.reset(new BufferedTupleStream2(parent->_state, parent->child(0)->row_desc(),
+                parent->_state->block_mgr2(), parent->_block_mgr_client,
+                true /* use_initial_small_buffers */, false /* read_write */));
+    // This stream is only used to spill, no need to ever have this pinned.
+    RETURN_IF_ERROR(probe_rows->init(parent->id(), parent->runtime_profile(), false));
+    DCHECK(probe_rows->has_write_block());
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::Partition::build_hash_table(bool* built) {
+    DCHECK(!is_spilled);
+    DCHECK(hash_tbl.get() == NULL);
+    *built = false;
+    PartitionedHashTableCtx* ctx = parent->_ht_ctx.get();
+    int64_t num_rows = build_rows->num_rows();
+    // We use the upper PARTITION_FANOUT num bits to pick the partition so only the
+    // remaining bits can be used for the hash table.
+    static const int64_t PHJ_DEFAULT_HASH_TABLE_SZ = 1024;
+    const int64_t max_num_buckets = 1L << (32 - NUM_PARTITIONING_BITS);
+    int64_t num_buckets = std::min(max_num_buckets, std::max(PHJ_DEFAULT_HASH_TABLE_SZ,
+                PartitionedHashTable::EstimateNumBuckets(num_rows)));
+    hash_tbl.reset(PartitionedHashTable::create(parent->_state, parent->_block_mgr_client,
+                parent->child(1)->row_desc().tuple_descriptors().size(), build_rows.get(),
+                max_num_buckets, num_buckets));
+    if (!hash_tbl->init()) {
+        hash_tbl->close();
+        hash_tbl.reset();
+        return Status::OK;
+    }
+
+    if (num_rows > 0) {
+        // the stream stays pinned, the hash table points into it
+        RETURN_IF_ERROR(build_rows->prepare_for_read(false));
+        RowBatch batch(parent->child(1)->row_desc(), parent->_state->batch_size(),
+                parent->mem_tracker());
+        std::vector<BufferedTupleStream2::RowIdx> indices;
+        bool eos = false;
+        while (!eos) {
+            RETURN_IF_ERROR(build_rows->get_next(&batch, &eos, &indices));
+            if (!hash_tbl->check_and_resize(batch.num_rows(), ctx)) {
+                hash_tbl->close();
+                hash_tbl.reset();
+                return Status::OK;
+            }
+            for (int i = 0; i < batch.num_rows(); ++i) {
+                TupleRow* row = batch.get_row(i);
+                uint32_t hash = 0;
+                if (!ctx->eval_and_hash_build(row, &hash)) {
+                    continue;
+                }
+                if (UNLIKELY(!hash_tbl->insert(ctx, indices[i], row, hash))) {
+                    hash_tbl->close();
+                    hash_tbl.reset();
+                    return Status::OK;
+                }
+            }
+            batch.reset();
+        }
+    }
+    *built = true;
+    return Status::OK;
+}
+
+Status PartitionedHashJoinNode::Partition::spill() {
+    DCHECK(!is_closed);
+    DCHECK(!is_spilled);
+    if (hash_tbl.get() != NULL) {
+        hash_tbl->close();
+        hash_tbl.reset();
+    }
+    is_spilled = true;
+
+    // Try to switch to IO-sized buffers to avoid allocating small buffers for the
+    // spilled partition.
+    bool got_buffer = true;
+    if (build_rows->using_small_buffers()) {
+        RETURN_IF_ERROR(build_rows->switch_to_io_buffers(&got_buffer));
+    }
+    if (!got_buffer) {
+        // We'll try again to get the buffer when the stream fills up the small buffers.
+        VLOG_QUERY << "Not enough memory to switch to IO-sized buffer for partition "
+            << this << " of join=" << parent->_id;
+    }
+    RETURN_IF_ERROR(build_rows->unpin_stream(false));
+
+    COUNTER_UPDATE(parent->_num_spilled_partitions, 1);
+    if (parent->_num_spilled_partitions->value() == 1) {
+        parent->add_runtime_exec_option("Spilled");
+    }
+    return Status::OK;
+}
+
+void PartitionedHashJoinNode::Partition::close(RowBatch* batch) {
+    if (is_closed) {
+        return;
+    }
+    is_closed = true;
+    if (hash_tbl.get() != NULL) {
+        hash_tbl->close();
+        hash_tbl.reset();
+    }
+    if (build_rows.get() != NULL) {
+        if (batch == NULL) {
+            build_rows->close();
+        } else {
+            batch->add_tuple_stream(build_rows.release());
+        }
+    }
+    if (probe_rows.get() != NULL) {
+        if (batch == NULL) {
+            probe_rows->close();
+        } else {
+            batch->add_tuple_stream(probe_rows.release());
+        }
+    }
+}
+
+void PartitionedHashJoinNode::create_output_row(TupleRow* out, TupleRow* probe, TupleRow* build) {
+    uint8_t* out_ptr = reinterpret_cast<uint8_t*>(out);
+    if (probe == NULL) {
+        memset(out_ptr, 0, _probe_tuple_row_size);
+    } else {
+        memcpy(out_ptr, probe, _probe_tuple_row_size);
+    }
+    if (build == NULL) {
+        memset(out_ptr + _probe_tuple_row_size, 0, _build_tuple_row_size);
+    } else {
+        memcpy(out_ptr + _probe_tuple_row_size, build, _build_tuple_row_size);
+    }
+}
+
+void PartitionedHashJoinNode::debug_string(int indentation_level, std::stringstream* out) const {
+    *out << std::string(indentation_level * 2, ' ');
+    *out << "PartitionedHashJoinNode(join_op=" << _join_op
+        << " eos=" << (_eos ? "true" : "false")
+        << " hash_partitions=" << _hash_partitions.size()
+        << " spilled_partitions=" << _spilled_partitions.size()
+        << " build_exprs=" << Expr::debug_string(_build_expr_ctxs)
+        << " probe_exprs=" << Expr::debug_string(_probe_expr_ctxs);
+    ExecNode::debug_string(indentation_level, out);
+    *out << ")";
+}
+
+}
@@ -0,0 +1,288 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_EXEC_PARTITIONED_HASH_JOIN_NODE_H
+#define DORIS_BE_SRC_EXEC_PARTITIONED_HASH_JOIN_NODE_H
+
+#include <list>
+#include <memory>
+#include <vector>
+#include <boost/scoped_ptr.hpp>
+
+#include "exec/exec_node.h"
+#include "exec/partitioned_hash_table.inline.h"
+#include "runtime/buffered_block_mgr2.h"
+#include "runtime/buffered_tuple_stream2.h"
+#include "runtime/runtime_filter.h"
+#include "gen_cpp/PlanNodes_types.h"
+
+namespace doris {
+
+class RowBatch;
+class RuntimeState;
+class TupleRow;
+
+// Hash join whose build side does not need to fit in memory.
+//
+// The build rows are hash partitioned into PARTITION_FANOUT partitions, each
+// one kept in a BufferedTupleStream2 of the block mgr. When the block mgr runs
+// out of buffers the largest partition is spilled: its stream is unpinned, so
+// the block mgr writes it to the scratch files of the TmpFileMgr. A hash table
+// is then built for every partition left in memory and the probe rows are
+// partitioned the same way: rows of an in-memory partition are joined right
+// away, rows of a spilled partition are appended to its probe stream.
+//
+// Once the probe input is consumed, every spilled partition is processed in
+// turn as if it was the input of a new join: its build rows and then its probe
+// rows are repartitioned at the next level with another hash seed, which goes
+// on until the partitions fit in memory or MAX_PARTITION_DEPTH is reached.
+//
+// Like HashJoinNode, the runtime filters of the node are built from the build
+// rows and published before the probe side is opened, and for is_push_down the
+// build keys are pushed to the probe side as IN predicates if there are few of
+// them. Unlike it, the build side is not built asynchronously.
+class PartitionedHashJoinNode : public ExecNode {
+public:
+    PartitionedHashJoinNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
+    virtual ~PartitionedHashJoinNode();
+
+    virtual Status init(const TPlanNode& tnode, RuntimeState* state = nullptr);
+    virtual Status prepare(RuntimeState* state);
+    virtual Status open(RuntimeState* state);
+    virtual Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
+    virtual Status close(RuntimeState* state);
+
+protected:
+    virtual void debug_string(int indentation_level, std::stringstream* out) const;
+
+private:
+    struct Partition;
+
+    // Number of initial partitions to create. Must be a power of two.
+    static const int PARTITION_FANOUT = 16;
+
+    // Needs to be the log(PARTITION_FANOUT)
+    static const int NUM_PARTITIONING_BITS = 4;
+
+    // Maximum number of times we will repartition. The maximum build table we
+    // can process is: MEM_LIMIT * (PARTITION_FANOUT ^ MAX_PARTITION_DEPTH).
+    static const int MAX_PARTITION_DEPTH = 16;
+
+    enum Phase {
+        // joining the probe rows of the current level
+        PROBING,
+        // returning the unmatched build rows of the in-memory partitions of
+        // the current level and closing them
+        OUTPUTTING_BUILD,
+    };
+
+    struct Partition {
+        Partition(PartitionedHashJoinNode* parent, int level) :
+                parent(parent), is_closed(false), is_spilled(false), level(level) {}
+
+        // Creates the pinned stream for the build rows.
+        Status init_streams();
+
+        // Creates the unpinned stream for the probe rows, once the partition
+        // is spilled and all its build rows are added.
+        Status init_probe_stream();
+
+        // Builds the hash table over the build rows. '*built' is false if
+        // there was not enough memory, the partition must be spilled then.
+        Status build_hash_table(bool* built);
+
+        // Frees the hash table and unpins the build rows, the write block is
+        // kept to append more build rows.
+        Status spill();
+
+        // Closes the streams, or hands them over to 'batch' if it is not NULL
+        // because rows of it may point into them.
+        void close(RowBatch* batch);
+
+        PartitionedHashJoinNode* parent;
+        bool is_closed;
+        bool is_spilled;
+
+        // level of repartitioning, 0 for the partitions of the child rows
+        const int level;
+
+        // NULL if it is spilled
+        boost::scoped_ptr<PartitionedHashTable> hash_tbl;
+
+        boost::scoped_ptr<BufferedTupleStream2> build_rows;
+        // only created if it is spilled
+        boost::scoped_ptr<BufferedTupleStream2> probe_rows;
+    };
+
+    // Reads the rows of child(1) into the partitions of level 0.
+    Status process_build_input(RuntimeState* state);
+
+    // Adds the rows of 'batch' to the build streams of _hash_partitions.
+    Status process_build_batch(RowBatch* batch);
+
+    // Builds the hash tables of the partitions in memory and gets the spilled
+    // ones ready to receive probe rows.
+    Status build_hash_tables();
+
+    // Completes and publishes _runtime_filters once the build rows of level 0 are
+    // in their partitions. Does nothing if the node has no filters.
+    void publish_runtime_filters(RuntimeState* state);
+
+    // Pushes IN predicates over the probe exprs with the build keys to the probe
+    // side, if is_push_down is set and all build rows are in memory.
+    Status push_down_build_keys(RuntimeState* state);
+
+    // Whether any partition of level 0 is spilled
+    bool has_spilled_partition() const;
+
+    // Adds 'row' to the build stream of a partition, partitions are spilled
+    // until it fits.
+    Status append_build_row(BufferedTupleStream2* stream, TupleRow* row);
+
+    // Adds 'row' to the probe stream of a spilled partition. Partitions are not
+    // spilled any more once probing started, their rows may be returned already.
+    Status append_probe_row(BufferedTupleStream2* stream, TupleRow* row);
+
+    // Joins the rows of _probe_batch until it is consumed or 'out_batch' is
+    // full. The probe row whose matches are returned is kept across calls.
+    Status process_probe_batch(RowBatch* out_batch);
+
+    // Fills _probe_batch from child(0) at level 0, from the probe stream of
+    // _input_partition otherwise.
+    Status next_probe_batch(RuntimeState* state);
+
+    // Moves _hash_partitions to _spilled_partitions or _output_build_partitions
+    // once all the probe rows of their level are joined.
+    Status move_hash_partitions();
+
+    // Returns the unmatched rows of _output_build_partitions for right outer,
+    // full outer and right anti joins, closes the partitions which are done.
+    Status output_unmatched_build(RowBatch* out_batch);
+
+    // Points _build_iterator to the first unmatched row of the front partition
+    // of _output_build_partitions, or to the end if none is to be returned.
+    void begin_unmatched_build();
+
+    // Takes the next spilled partition and repartitions its build rows at the
+    // next level, its probe rows become the probe input.
+    Status prepare_next_partition(RuntimeState* state);
+
+    // Initializes _hash_partitions at 'level' and sets the level of _ht_ctx.
+    Status create_hash_partitions(int level);
+
+    // Spills the largest partition of _hash_partitions which is in memory.
+    Status spill_partition();
+
+    // Number of build rows of the largest spilled partition of _hash_partitions.
+    int64_t largest_spilled_partition() const;
+
+    // Closes all partitions and clears the partition pool.
+    void close_partitions();
+
+    // Writes the tuples of 'probe' and 'build' to 'out', NULL sets them to NULL.
+    void create_output_row(TupleRow* out, TupleRow* probe, TupleRow* build);
+
+    // One buffer for the build and one for the probe stream of every
+    // partition, plus one to read the partition being repartitioned.
+    int min_required_buffers() const {
+        return 2 * PARTITION_FANOUT + 1;
+    }
+
+    TJoinOp::type _join_op;
+
+    // derived from _join_op
+    bool _match_all_probe;  // output all rows coming from the probe input
+    bool _output_unmatched_build;  // output the build rows which have not matched
+
+    // our equi-join predicates "<lhs> = <rhs>" are separated into
+    // _build_exprs (over child(1)) and _probe_exprs (over child(0))
+    std::vector<ExprContext*> _probe_expr_ctxs;
+    std::vector<ExprContext*> _build_expr_ctxs;
+
+    // non-equi-join conjuncts from the JOIN clause
+    std::vector<ExprContext*> _other_join_conjunct_ctxs;
+
+    bool _is_push_down;
+    std::vector<TRuntimeFilterDesc> _runtime_filter_descs;
+    // Filters of _runtime_filter_descs the build rows of level 0 are added to as
+    // they are partitioned, empty once they are published. Those the planner did
+    // not size have no bloom filter yet, the number of build rows is not known.
+    std::vector<std::unique_ptr<RuntimeFilter>> _runtime_filters;
+
+    RuntimeState* _state;
+    BufferedBlockMgr2::Client* _block_mgr_client;
+
+    // Used for hashing rows and comparing their keys, its level is the level of
+    // _hash_partitions.
+    boost::scoped_ptr<PartitionedHashTableCtx> _ht_ctx;
+
+    boost::scoped_ptr<ObjectPool> _partition_pool;
+
+    // partitions the rows of the current level are added to
+    std::vector<Partition*> _hash_partitions;
+
+    // Spilled partitions of all levels which wait to be processed. The deepest
+    // ones are in front so their blocks are freed early.
+    std::list<Partition*> _spilled_partitions;
+
+    // in-memory partitions of the current level whose probe rows are joined
+    std::list<Partition*> _output_build_partitions;
+
+    // spilled partition whose rows are repartitioned, NULL at level 0
+    Partition* _input_partition;
+
+    Phase _phase;
+    bool _eos;
+
+    // Status of the last append which failed, the streams report errors this way.
+    Status _process_batch_status;
+
+    boost::scoped_ptr<RowBatch> _probe_batch;
+    int _probe_batch_pos;
+    bool _probe_eos;
+
+    // probe row whose matches are being returned, NULL if the next one is to
+    // be taken from _probe_batch
+    TupleRow* _current_probe_row;
+    bool _matched_probe;
+    PartitionedHashTable::Iterator _hash_tbl_iterator;
+
+    // next unmatched row of the front partition of _output_build_partitions
+    PartitionedHashTable::Iterator _build_iterator;
+
+    // Size of the TupleRow (just the Tuple ptrs) from the build (right) and
+    // probe (left) sides.
+    int _probe_tuple_row_size;
+    int _build_tuple_row_size;
+
+    RuntimeProfile::Counter* _build_timer;
+    RuntimeProfile::Counter* _probe_timer;
+    RuntimeProfile::Counter* _build_rows_counter;
+    RuntimeProfile::Counter* _probe_rows_counter;
+    RuntimeProfile::Counter* _num_hash_buckets;
+    RuntimeProfile::Counter* _partitions_created;
+    RuntimeProfile::Counter* _num_build_rows_repartitioned;
+    RuntimeProfile::Counter* _num_probe_rows_repartitioned;
+    RuntimeProfile::Counter* _num_repartitions;
+    RuntimeProfile::Counter* _num_spilled_partitions;
+    RuntimeProfile::Counter* _runtime_filter_timer;
+};
+
+}
+
+#endif
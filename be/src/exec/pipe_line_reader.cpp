@@ -0,0 +1,94 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/pipe_line_reader.h"
+
+#include "runtime/stream_load/stream_load_pipe.h"
+
+namespace doris {
+
+PipeLineReader::PipeLineReader(RuntimeProfile* profile, StreamLoadPipe* pipe,
+                               uint8_t line_delimiter, uint8_t enclose) :
+        _pipe(pipe),
+        _tokenizer('\0', line_delimiter, enclose),
+        _pos(nullptr),
+        _limit(nullptr),
+        _eof(false) {
+    _bytes_read_counter = ADD_COUNTER(profile, "BytesRead", TUnit::BYTES);
+    _read_timer = ADD_TIMER(profile, "FileReadTime");
+}
+
+PipeLineReader::~PipeLineReader() {
+    close();
+}
+
+void PipeLineReader::close() {
+    _buf.reset();
+    _pos = _limit = nullptr;
+}
+
+Status PipeLineReader::read_line(const uint8_t** ptr, size_t* size, bool* eof) {
+    if (_eof) {
+        *size = 0;
+        *eof = true;
+        return Status::OK;
+    }
+    _line.clear();
+    bool in_quote = false;
+    while (true) {
+        if (_pos == _limit) {
+            {
+                SCOPED_TIMER(_read_timer);
+                RETURN_IF_ERROR(_pipe->read_buffer(&_buf));
+            }
+            if (_buf == nullptr) {
+                // the last line may have no delimiter
+                _eof = true;
+                _pos = _limit = nullptr;
+                *ptr = reinterpret_cast<const uint8_t*>(_line.data());
+                *size = _line.size();
+                *eof = _line.empty();
+                return Status::OK;
+            }
+            _pos = reinterpret_cast<const uint8_t*>(_buf->ptr + _buf->pos);
+            _limit = reinterpret_cast<const uint8_t*>(_buf->ptr + _buf->limit);
+            COUNTER_UPDATE(_bytes_read_counter, _limit - _pos);
+            continue;
+        }
+        const uint8_t* delimiter = _tokenizer.find_line_delimiter(
+            _pos, _limit - _pos, &in_quote);
+        if (delimiter == nullptr) {
+            // the buffer is released when the next one is taken
+            _line.append(reinterpret_cast<const char*>(_pos), _limit - _pos);
+            _pos = _limit;
+            continue;
+        }
+        if (_line.empty()) {
+            *ptr = _pos;
+            *size = delimiter - _pos;
+        } else {
+            _line.append(reinterpret_cast<const char*>(_pos), delimiter - _pos);
+            *ptr = reinterpret_cast<const uint8_t*>(_line.data());
+            *size = _line.size();
+        }
+        _pos = delimiter + 1;
+        *eof = false;
+        return Status::OK;
+    }
+}
+
+}
@@ -0,0 +1,63 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <string>
+
+#include "exec/csv_tokenizer.h"
+#include "exec/line_reader.h"
+#include "util/byte_buffer.h"
+#include "util/runtime_profile.h"
+
+namespace doris {
+
+class StreamLoadPipe;
+
+// Reads lines of an uncompressed stream load body from the buffers of its
+// pipe, without copying them into a buffer of its own as
+// PlainTextLineReader does. Only a line which is split between buffers is
+// copied, to join its parts.
+class PipeLineReader : public LineReader {
+public:
+    PipeLineReader(RuntimeProfile* profile, StreamLoadPipe* pipe,
+                   uint8_t line_delimiter, uint8_t enclose = 0);
+
+    virtual ~PipeLineReader();
+
+    // the line is valid until the next call
+    virtual Status read_line(const uint8_t** ptr, size_t* size, bool* eof) override;
+
+    virtual void close() override;
+
+private:
+    StreamLoadPipe* _pipe;
+    CsvTokenizer _tokenizer;
+
+    // buffer of the pipe being read, and the unread data in it
+    ByteBufferPtr _buf;
+    const uint8_t* _pos;
+    const uint8_t* _limit;
+    // parts of the line from the previous buffers
+    std::string _line;
+    bool _eof;
+
+    RuntimeProfile::Counter* _bytes_read_counter;
+    RuntimeProfile::Counter* _read_timer;
+};
+
+}
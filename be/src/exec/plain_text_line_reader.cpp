@@ -36,13 +36,14 @@ PlainTextLineReader::PlainTextLineReader(
         RuntimeProfile* profile,
         FileReader* file_reader,
         Decompressor* decompressor,
-        size_t length, uint8_t line_delimiter) :
+        size_t length, uint8_t line_delimiter, uint8_t enclose) :
             _profile(profile),
             _file_reader(file_reader),
             _decompressor(decompressor),
             _min_length(length),
             _total_read_bytes(0),
             _line_delimiter(line_delimiter),
+            _tokenizer('\0', line_delimiter, enclose),
             _input_buf(new uint8_t[INPUT_CHUNK]),
             _input_buf_size(INPUT_CHUNK),
             _input_buf_pos(0),
@@ -93,9 +94,8 @@ inline bool PlainTextLineReader::update_eof() {
 }
 
 uint8_t* PlainTextLineReader::update_field_pos_and_find_line_delimiter(
-        const uint8_t* start, size_t len) {
-    // TODO: meanwhile find and save field pos
-    return (uint8_t*) memmem(start, len, &_line_delimiter, 1);
+        const uint8_t* start, size_t len, bool* in_quote) {
+    return (uint8_t*) _tokenizer.find_line_delimiter(start, len, in_quote);
 }
 
 // extend input buf if necessary only when _more_input_bytes > 0
@@ -190,12 +190,14 @@ Status PlainTextLineReader::read_line(const uint8_t** ptr, size_t* size, bool* e
     }
     int found_line_delimiter = 0;
     size_t offset = 0;
+    bool in_quote = false;
     while (!done()) {
         // find line delimiter in current decompressed data
         uint8_t* cur_ptr = _output_buf + _output_buf_pos;
         uint8_t* pos = update_field_pos_and_find_line_delimiter(
                 cur_ptr + offset,
-                output_buf_read_remaining() - offset);
+                output_buf_read_remaining() - offset,
+                &in_quote);
 
         if (pos == nullptr) {
             // didn't find line delimiter, read more data from decompressor
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "exec/csv_tokenizer.h"
 #include "exec/line_reader.h"
 #include "util/runtime_profile.h"
 
@@ -30,7 +31,7 @@ class PlainTextLineReader : public LineReader {
 public:
     PlainTextLineReader(RuntimeProfile* profile, FileReader* file_reader, 
                         Decompressor* decompressor,
-                        size_t length, uint8_t line_delimiter);
+                        size_t length, uint8_t line_delimiter, uint8_t enclose = 0);
 
     virtual ~PlainTextLineReader();
 
@@ -55,9 +56,9 @@ private:
 
     // find line delimiter from 'start' to 'start' + len,
     // return line delimiter pos if found, otherwise return nullptr.
-    // TODO:
-    //  save to positions of field separator
-    uint8_t* update_field_pos_and_find_line_delimiter(const uint8_t* start, size_t len);
+    // 'in_quote' is the quote state of the line before 'start'.
+    uint8_t* update_field_pos_and_find_line_delimiter(const uint8_t* start, size_t len,
+                                                      bool* in_quote);
 
     void extend_input_buf();
     void extend_output_buf();
@@ -69,6 +70,8 @@ private:
     size_t _min_length;
     size_t _total_read_bytes;
     uint8_t _line_delimiter;
+    // the column separator is not used to find lines
+    CsvTokenizer _tokenizer;
 
     // save the data read from file reader
     uint8_t* _input_buf;
@@ -0,0 +1,72 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/scanner_concurrency_controller.h"
+
+#include <algorithm>
+
+namespace doris {
+
+const int ScannerConcurrencyController::WINDOW_SLICES;
+constexpr double ScannerConcurrencyController::HIGH_OCCUPANCY;
+constexpr double ScannerConcurrencyController::STARVED_RATIO;
+constexpr double ScannerConcurrencyController::IO_BOUND_RATIO;
+
+ScannerConcurrencyController::ScannerConcurrencyController(int max_tasks, int initial_tasks) :
+        _max_tasks(std::max(1, max_tasks)),
+        _target(std::min(std::max(1, initial_tasks), _max_tasks)) {
+}
+
+void ScannerConcurrencyController::on_batch_consumed(bool waited) {
+    ++_num_consumed;
+    if (waited) {
+        ++_num_waited;
+    }
+}
+
+void ScannerConcurrencyController::on_slice_done(int64_t wall_nanos, int64_t io_nanos,
+                                                 size_t queue_size, size_t queue_capacity) {
+    _wall_nanos += std::max<int64_t>(0, wall_nanos);
+    _io_nanos += std::max<int64_t>(0, io_nanos);
+    if (queue_capacity > 0) {
+        _occupancy_sum += std::min(1.0, static_cast<double>(queue_size) / queue_capacity);
+    }
+    if (++_num_slices >= WINDOW_SLICES) {
+        _adjust();
+    }
+}
+
+void ScannerConcurrencyController::_adjust() {
+    double occupancy = _occupancy_sum / _num_slices;
+    if (occupancy > HIGH_OCCUPANCY) {
+        _target = std::max(1, _target - 1);
+    } else if (_num_consumed > 0 && _num_waited > _num_consumed * STARVED_RATIO) {
+        double io_ratio = _wall_nanos > 0 ? static_cast<double>(_io_nanos) / _wall_nanos : 0;
+        if (io_ratio < IO_BOUND_RATIO) {
+            _target = std::min(_max_tasks, _target + 1);
+        }
+    }
+    _num_slices = 0;
+    _occupancy_sum = 0;
+    _wall_nanos = 0;
+    _io_nanos = 0;
+    _num_consumed = 0;
+    _num_waited = 0;
+}
+
+}
@@ -0,0 +1,76 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_EXEC_SCANNER_CONCURRENCY_CONTROLLER_H
+#define DORIS_BE_EXEC_SCANNER_CONCURRENCY_CONTROLLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace doris {
+
+// Decides how many scanner tasks of a scan node run at the same time from
+// what the node observes, every few scanner slices:
+//  - the queue of scanned batches filling up means the parent consumes them
+//    slower than they are scanned, a task is taken away to keep memory low;
+//  - the parent often finding the queue empty means it waits for the
+//    scanners, a task is added unless the scanners mostly wait for I/O, in
+//    which case more of them would only queue up on the same disks.
+// It is not thread safe.
+class ScannerConcurrencyController {
+public:
+    // the number of tasks stays in [1, max_tasks]
+    ScannerConcurrencyController(int max_tasks, int initial_tasks);
+
+    // number of tasks which should run now
+    int target() const { return _target; }
+
+    // The parent took a batch, 'waited' if it had to wait for it.
+    void on_batch_consumed(bool waited);
+
+    // A scanner task ended a slice which took 'wall_nanos', 'io_nanos' of it
+    // reading, with 'queue_size' of 'queue_capacity' batches queued.
+    void on_slice_done(int64_t wall_nanos, int64_t io_nanos,
+                       size_t queue_size, size_t queue_capacity);
+
+    // number of slices after which the target is revised
+    static const int WINDOW_SLICES = 8;
+    // a task is taken away above this average queue occupancy
+    static constexpr double HIGH_OCCUPANCY = 0.75;
+    // a task is added if the parent waited for more of its batches
+    static constexpr double STARVED_RATIO = 0.25;
+    // but not if more of the time of the slices was spent reading
+    static constexpr double IO_BOUND_RATIO = 0.8;
+
+private:
+    void _adjust();
+
+    int _max_tasks;
+    int _target;
+
+    int _num_slices = 0;
+    double _occupancy_sum = 0;
+    int64_t _wall_nanos = 0;
+    int64_t _io_nanos = 0;
+    int64_t _num_consumed = 0;
+    int64_t _num_waited = 0;
+};
+
+}
+
+#endif
@@ -27,15 +27,11 @@ namespace doris {
 SelectNode::SelectNode(
     ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs)
     : ExecNode(pool, tnode, descs),
-      _child_row_batch(NULL),
-      _child_row_idx(0),
       _child_eos(false) {
 }
 
 Status SelectNode::prepare(RuntimeState* state) {
     RETURN_IF_ERROR(ExecNode::prepare(state));
-    _child_row_batch.reset(
-        new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker()));
     return Status::OK;
 }
 
@@ -51,91 +47,46 @@ Status SelectNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eos)
     RETURN_IF_CANCELLED(state);
     SCOPED_TIMER(_runtime_profile->total_time_counter());
 
-    if (reached_limit() || (_child_row_idx == _child_row_batch->num_rows() && _child_eos)) {
-        // we're already done or we exhausted the last child batch and there won't be any
-        // new ones
-        _child_row_batch->transfer_resource_ownership(row_batch);
+    if (reached_limit() || _child_eos) {
+        // we're already done or the child returned its last batch
         *eos = true;
         return Status::OK;
     }
-    *eos = false;
 
-    // start (or continue) consuming row batches from child
     while (true) {
         RETURN_IF_CANCELLED(state);
-        if (_child_row_idx == _child_row_batch->num_rows()) {
-            // fetch next batch
-            _child_row_idx = 0;
-            _child_row_batch->transfer_resource_ownership(row_batch);
-            _child_row_batch->reset();
-            if (row_batch->at_capacity()) {
-                return Status::OK;
-            }
-            RETURN_IF_ERROR(child(0)->get_next(state, _child_row_batch.get(), &_child_eos));
+        DCHECK_EQ(row_batch->num_rows(), 0);
+        RETURN_IF_ERROR(child(0)->get_next(state, row_batch, &_child_eos));
+        RETURN_IF_ERROR(filter_batch(_conjunct_ctxs, row_batch, &_sel, &_conjunct_result));
+
+        _num_rows_returned += row_batch->num_rows();
+        if (reached_limit()) {
+            int num_rows_over = _num_rows_returned - _limit;
+            row_batch->set_num_rows(row_batch->num_rows() - num_rows_over);
+            _num_rows_returned -= num_rows_over;
         }
+        COUNTER_SET(_rows_returned_counter, _num_rows_returned);
 
-        if (copy_rows(row_batch)) {
-            *eos = reached_limit()
-                   || (_child_row_idx == _child_row_batch->num_rows() && _child_eos);
-            if (*eos) {
-                _child_row_batch->transfer_resource_ownership(row_batch);
+        if (VLOG_ROW_IS_ON) {
+            for (int i = 0; i < row_batch->num_rows(); ++i) {
+                TupleRow* row = row_batch->get_row(i);
+                VLOG_ROW << "SelectNode input row: " << row->to_string(row_desc());
             }
-            return Status::OK;
         }
 
-        if (_child_eos) {
-            // finished w/ last child row batch, and child eos is true
-            _child_row_batch->transfer_resource_ownership(row_batch);
-            *eos = true;
+        *eos = reached_limit() || _child_eos;
+        // the resources of the removed rows stay with the batch, they may hold
+        // rows returned before, so more rows are only added while it has room
+        if (*eos || row_batch->num_rows() > 0 || row_batch->at_capacity()) {
             return Status::OK;
         }
     }
-
-    return Status::OK;
-}
-
-bool SelectNode::copy_rows(RowBatch* output_batch) {
-    ExprContext** ctxs = &_conjunct_ctxs[0];
-    int num_ctxs = _conjunct_ctxs.size();
-
-    for (; _child_row_idx < _child_row_batch->num_rows(); ++_child_row_idx) {
-        // Add a new row to output_batch
-        int dst_row_idx = output_batch->add_row();
-
-        if (dst_row_idx == RowBatch::INVALID_ROW_INDEX) {
-            return true;
-        }
-
-        TupleRow* dst_row = output_batch->get_row(dst_row_idx);
-        TupleRow* src_row = _child_row_batch->get_row(_child_row_idx);
-
-        if (ExecNode::eval_conjuncts(ctxs, num_ctxs, src_row)) {
-            output_batch->copy_row(src_row, dst_row);
-            output_batch->commit_last_row();
-            ++_num_rows_returned;
-            COUNTER_SET(_rows_returned_counter, _num_rows_returned);
-
-            if (reached_limit()) {
-                return true;
-            }
-        }
-    }
-
-    if (VLOG_ROW_IS_ON) {
-        for (int i = 0; i < output_batch->num_rows(); ++i) {
-            TupleRow* row = output_batch->get_row(i);
-            VLOG_ROW << "SelectNode input row: " << row->to_string(row_desc());
-        }
-    }
-
-    return output_batch->is_full() || output_batch->at_resource_limit();
 }
 
 Status SelectNode::close(RuntimeState* state) {
     if (is_closed()) {
         return Status::OK;
     }
-    _child_row_batch.reset();
     return ExecNode::close(state);
 }
 
@@ -21,6 +21,7 @@
 #include <boost/scoped_ptr.hpp>
 
 #include "exec/exec_node.h"
+#include "exprs/expr_column.h"
 #include "runtime/mem_pool.h"
 
 namespace doris {
@@ -29,7 +30,8 @@ class Tuple;
 class TupleRow;
 
 // Node that evaluates conjuncts and enforces a limit but otherwise passes along
-// the rows pulled from its child unchanged.
+// the rows pulled from its child unchanged. The child fills the output batch, of
+// which the rows not passing the conjuncts are removed in place.
 class SelectNode : public ExecNode {
 public:
     SelectNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
@@ -40,19 +42,12 @@ public:
     virtual Status close(RuntimeState* state);
 
 private:
-    // current row batch of child
-    boost::scoped_ptr<RowBatch> _child_row_batch;
-
-    // index of current row in _child_row_batch
-    int _child_row_idx;
-
     // true if last get_next() call on child signalled eos
     bool _child_eos;
 
-    // Copy rows from _child_row_batch for which _conjuncts evaluate to true to
-    // output_batch, up to _limit.
-    // Return true if limit was hit or output_batch should be returned, otherwise false.
-    bool copy_rows(RowBatch* output_batch);
+    // scratch space of filter_batch()
+    std::vector<int> _sel;
+    ExprColumn _conjunct_result;
 };
 
 }
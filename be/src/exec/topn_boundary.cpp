@@ -0,0 +1,112 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/topn_boundary.h"
+
+#include "gen_cpp/PaloInternalService_types.h"
+#include "runtime/descriptors.h"
+
+namespace doris {
+
+TopNBoundary::TopNBoundary(const SlotDescriptor* slot, bool is_asc, bool nulls_first) :
+        _slot(slot),
+        _type(slot->type()),
+        _is_asc(is_asc),
+        _nulls_first(nulls_first),
+        _version(0) {
+}
+
+bool TopNBoundary::is_supported(PrimitiveType type) {
+    switch (type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_DECIMAL:
+    case TYPE_DECIMALV2:
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void TopNBoundary::update(const void* value) {
+    DCHECK(value != nullptr);
+    std::lock_guard<std::mutex> l(_lock);
+    if (_type.is_string_type()) {
+        const StringValue* str = reinterpret_cast<const StringValue*>(value);
+        _value.assign(str->ptr, str->len);
+    } else {
+        _value.assign(reinterpret_cast<const char*>(value), _type.get_slot_size());
+    }
+    _version.fetch_add(1, std::memory_order_release);
+}
+
+void TopNBoundary::refresh(Snapshot* snapshot) const {
+    if (snapshot->version == version()) {
+        return;
+    }
+    std::lock_guard<std::mutex> l(_lock);
+    snapshot->version = _version.load();
+    snapshot->buf = _value;
+    if (_type.is_string_type()) {
+        snapshot->str.ptr = const_cast<char*>(snapshot->buf.data());
+        snapshot->str.len = snapshot->buf.size();
+        snapshot->value = &snapshot->str;
+    } else {
+        snapshot->value = snapshot->buf.data();
+    }
+}
+
+bool TopNBoundary::to_olap_condition(TCondition* condition) const {
+    switch (_type.type) {
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_DECIMALV2:
+        // not printed as the storage parses them
+        return false;
+    default:
+        break;
+    }
+    // the storage orders nulls first and drops them by '>=' but not by '<='
+    if (!_is_asc && _nulls_first) {
+        return false;
+    }
+    Snapshot snapshot;
+    refresh(&snapshot);
+    if (snapshot.value == nullptr) {
+        return false;
+    }
+    std::string value;
+    RawValue::print_value(snapshot.value, _type, -1, &value);
+    condition->__set_column_name(_slot->col_name());
+    condition->__set_condition_op(_is_asc ? "<=" : ">=");
+    condition->condition_values.clear();
+    condition->condition_values.push_back(value);
+    condition->__isset.condition_values = true;
+    return true;
+}
+
+}
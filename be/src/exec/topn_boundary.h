@@ -0,0 +1,100 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_EXEC_TOPN_BOUNDARY_H
+#define DORIS_BE_EXEC_TOPN_BOUNDARY_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "runtime/raw_value.h"
+#include "runtime/string_value.h"
+#include "runtime/types.h"
+
+namespace doris {
+
+class SlotDescriptor;
+class TCondition;
+
+// The value of the first ordering column of the last row in the heap of a
+// full TopNNode. The node publishes it to the OlapScanNode below it while it
+// runs: rows whose column is ordered after it can not get into the heap any
+// more, so scanners opened afterwards read them with a condition, which lets
+// the zone maps skip blocks, and the running scanners drop them before they
+// are materialized. Rows equal to it may still get in by the other columns.
+class TopNBoundary {
+public:
+    // the value held by a scanner, which takes it again when it changes
+    struct Snapshot {
+        int64_t version = 0;
+        std::string buf;
+        StringValue str;
+        // nullptr until a boundary is published
+        const void* value = nullptr;
+    };
+
+    // 'slot' is the column of the scan the first ordering expr refers to
+    TopNBoundary(const SlotDescriptor* slot, bool is_asc, bool nulls_first);
+
+    // false if the column can't be filtered by a boundary
+    static bool is_supported(PrimitiveType type);
+
+    const SlotDescriptor* slot() const { return _slot; }
+
+    // 'value' is not null, it is copied
+    void update(const void* value);
+
+    // increases with every update, 0 if there is no boundary yet
+    int64_t version() const { return _version.load(std::memory_order_acquire); }
+
+    // copies the boundary into 'snapshot' if it is newer
+    void refresh(Snapshot* snapshot) const;
+
+    // Condition on the column keeping the rows which may still get into the
+    // heap, false if the storage can't evaluate it for this column.
+    bool to_olap_condition(TCondition* condition) const;
+
+    // true if a row whose column is 'value', nullptr for null, is ordered
+    // after 'snapshot'
+    bool is_pruned(const Snapshot& snapshot, const void* value) const {
+        if (snapshot.value == nullptr) {
+            return false;
+        }
+        if (value == nullptr) {
+            return !_nulls_first;
+        }
+        int cmp = RawValue::compare(value, snapshot.value, _type);
+        return _is_asc ? cmp > 0 : cmp < 0;
+    }
+
+private:
+    const SlotDescriptor* _slot;
+    TypeDescriptor _type;
+    bool _is_asc;
+    bool _nulls_first;
+
+    mutable std::mutex _lock;
+    // bytes of the value, strings without the StringValue header
+    std::string _value;
+    std::atomic<int64_t> _version;
+};
+
+}
+
+#endif
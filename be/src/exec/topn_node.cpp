@@ -19,7 +19,10 @@
 
 #include <sstream>
 
+#include "common/config.h"
+#include "exec/olap_scan_node.h"
 #include "exprs/expr.h"
+#include "exprs/slot_ref.h"
 #include "gen_cpp/Exprs_types.h"
 #include "gen_cpp/PlanNodes_types.h"
 #include "runtime/descriptors.h"
@@ -40,6 +43,7 @@ TopNNode::TopNNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl
         _offset(tnode.sort_node.__isset.offset ? tnode.sort_node.offset : 0),
         _materialized_tuple_desc(NULL),
         _tuple_row_less_than(NULL),
+        _tuple_size(0),
         _tuple_pool(NULL),
         _num_rows_skipped(0),
         _priority_queue(NULL) {
@@ -80,6 +84,15 @@ Status TopNNode::prepare(RuntimeState* state) {
     _abort_on_default_limit_exceeded = _abort_on_default_limit_exceeded &&
                                        state->abort_on_default_limit_exceeded();
     _materialized_tuple_desc = _row_descriptor.tuple_descriptors()[0];
+    _tuple_size = _materialized_tuple_desc->byte_size();
+    if (NormalizedSortKey::is_supported(_sort_exec_exprs.lhs_ordering_expr_ctxs())) {
+        _sort_key.reset(new NormalizedSortKey(
+                _sort_exec_exprs.lhs_ordering_expr_ctxs(), _is_asc_order, _nulls_first));
+        _tuple_size += _sort_key->size();
+    }
+    _tuple_less.reset(new TupleLess(_tuple_row_less_than.get(), _sort_key.get(),
+                                    _materialized_tuple_desc->byte_size()));
+    init_topn_boundary(state);
     return Status::OK;
 }
 
@@ -96,13 +109,11 @@ Status TopNNode::open(RuntimeState* state) {
     // regression. Why??
     if (_priority_queue.get() == NULL) {
         _priority_queue.reset(
-            new std::priority_queue<Tuple*, std::vector<Tuple*>, TupleRowComparator>(
-                *_tuple_row_less_than));
+            new std::priority_queue<Tuple*, std::vector<Tuple*>, TupleLess>(*_tuple_less));
     }
 
     // Allocate memory for a temporary tuple.
-    _tmp_tuple = reinterpret_cast<Tuple*>(
-            _tuple_pool->allocate(_materialized_tuple_desc->byte_size()));
+    _tmp_tuple = reinterpret_cast<Tuple*>(_tuple_pool->allocate(_tuple_size));
     RETURN_IF_ERROR(child(0)->open(state));
 
     // Limit of 0, no need to fetch anything from children.
@@ -121,6 +132,7 @@ Status TopNNode::open(RuntimeState* state) {
             for (int i = 0; i < batch.num_rows(); ++i) {
                 insert_tuple_row(batch.get_row(i));
             }
+            update_topn_boundary();
             RETURN_IF_CANCELLED(state);
             // RETURN_IF_LIMIT_EXCEEDED(state);
             RETURN_IF_ERROR(state->check_query_state());
@@ -197,20 +209,30 @@ void TopNNode::insert_tuple_row(TupleRow* input_row) {
     Tuple* insert_tuple = NULL;
 
     if (_priority_queue->size() < _offset + _limit) {
-        insert_tuple = reinterpret_cast<Tuple*>(
-                _tuple_pool->allocate(_materialized_tuple_desc->byte_size()));
+        insert_tuple = reinterpret_cast<Tuple*>(_tuple_pool->allocate(_tuple_size));
         insert_tuple->materialize_exprs<false>(input_row, *_materialized_tuple_desc,
                 _sort_exec_exprs.sort_tuple_slot_expr_ctxs(), _tuple_pool.get(), NULL, NULL);
+        if (_sort_key != nullptr) {
+            _sort_key->encode(reinterpret_cast<TupleRow*>(&insert_tuple),
+                              sort_key_of(insert_tuple));
+        }
     } else {
         DCHECK(!_priority_queue->empty());
         Tuple* top_tuple = _priority_queue->top();
         _tmp_tuple->materialize_exprs<false>(input_row, *_materialized_tuple_desc,
                 _sort_exec_exprs.sort_tuple_slot_expr_ctxs(), NULL, NULL, NULL);
+        if (_sort_key != nullptr) {
+            _sort_key->encode(reinterpret_cast<TupleRow*>(&_tmp_tuple),
+                              sort_key_of(_tmp_tuple));
+        }
 
-        if ((*_tuple_row_less_than)(_tmp_tuple, top_tuple)) {
+        if ((*_tuple_less)(_tmp_tuple, top_tuple)) {
             // TODO: DeepCopy will allocate new buffers for the string data.  This needs
             // to be fixed to use a freelist
             _tmp_tuple->deep_copy(top_tuple, *_materialized_tuple_desc, _tuple_pool.get());
+            if (_sort_key != nullptr) {
+                memcpy(sort_key_of(top_tuple), sort_key_of(_tmp_tuple), _sort_key->size());
+            }
             insert_tuple = top_tuple;
             _priority_queue->pop();
         }
@@ -236,6 +258,59 @@ void TopNNode::prepare_for_output() {
     _get_next_iter = _sorted_top_n.begin();
 }
 
+void TopNNode::init_topn_boundary(RuntimeState* state) {
+    if (!config::enable_topn_scan_pruning || _limit <= 0) {
+        return;
+    }
+    OlapScanNode* scan_node = dynamic_cast<OlapScanNode*>(child(0));
+    if (scan_node == nullptr) {
+        return;
+    }
+    // the first ordering expr is a slot of the sorted tuple, which must be
+    // materialized from a slot of the scan
+    SlotRef* ordering_ref = dynamic_cast<SlotRef*>(
+            _sort_exec_exprs.lhs_ordering_expr_ctxs()[0]->root());
+    if (ordering_ref == nullptr) {
+        return;
+    }
+    int expr_idx = 0;
+    SlotRef* input_ref = nullptr;
+    for (auto slot : _materialized_tuple_desc->slots()) {
+        if (!slot->is_materialized()) {
+            continue;
+        }
+        if (slot->id() == ordering_ref->slot_id()) {
+            input_ref = dynamic_cast<SlotRef*>(
+                    _sort_exec_exprs.sort_tuple_slot_expr_ctxs()[expr_idx]->root());
+            break;
+        }
+        ++expr_idx;
+    }
+    if (input_ref == nullptr) {
+        return;
+    }
+    SlotDescriptor* scan_slot = state->desc_tbl().get_slot_descriptor(input_ref->slot_id());
+    if (scan_slot == nullptr
+            || scan_slot->parent() != scan_node->row_desc().tuple_descriptors()[0]->id()
+            || !TopNBoundary::is_supported(scan_slot->type().type)) {
+        return;
+    }
+    _topn_boundary.reset(new TopNBoundary(scan_slot, _is_asc_order[0], _nulls_first[0]));
+    scan_node->set_topn_boundary(_topn_boundary);
+}
+
+void TopNNode::update_topn_boundary() {
+    if (_topn_boundary == nullptr || _priority_queue->size() < _offset + _limit) {
+        return;
+    }
+    Tuple* top_tuple = _priority_queue->top();
+    void* value = _sort_exec_exprs.lhs_ordering_expr_ctxs()[0]->get_value(
+            reinterpret_cast<TupleRow*>(&top_tuple));
+    if (value != nullptr) {
+        _topn_boundary->update(value);
+    }
+}
+
 void TopNNode::debug_string(int indentation_level, std::stringstream* out) const {
     *out << std::string(indentation_level * 2, ' ');
     *out << "TopNNode("
@@ -19,9 +19,12 @@
 #define DORIS_BE_SRC_QUERY_EXEC_TOPN_NODE_H
 
 #include <boost/scoped_ptr.hpp>
+#include <memory>
 #include <queue>
 
 #include "exec/exec_node.h"
+#include "exec/normalized_sort_key.h"
+#include "exec/topn_boundary.h"
 #include "runtime/descriptors.h"
 #include "util/tuple_row_compare.h"
 
@@ -35,6 +38,10 @@ class Tuple;
 // This handles the case where the result fits in memory.  This node will do a deep
 // copy of the tuples that are necessary for the output.
 // This is implemented by storing rows in a priority queue.
+// If the ordering exprs are of fixed width types the rows in the queue are
+// compared by their normalized keys. Once the queue is full and ordered by a
+// column of the OlapScanNode below, its last value is published to the scan,
+// which skips the rows which can't get into the queue any more.
 class TopNNode : public ExecNode {
 public:
     TopNNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
@@ -62,6 +69,40 @@ private:
     // Flatten and reverse the priority queue.
     void prepare_for_output();
 
+    // creates _topn_boundary if the scan below can use it
+    void init_topn_boundary(RuntimeState* state);
+
+    // publishes the last value of the full priority queue to the scan
+    void update_topn_boundary();
+
+    // normalized key stored after the materialized tuple
+    uint8_t* sort_key_of(Tuple* tuple) const {
+        return reinterpret_cast<uint8_t*>(tuple) + _materialized_tuple_desc->byte_size();
+    }
+
+    // Orders the tuples of the priority queue by their normalized keys if
+    // there are, otherwise by the ordering exprs.
+    class TupleLess {
+    public:
+        TupleLess(const TupleRowComparator* less, const NormalizedSortKey* sort_key,
+                  int key_offset) :
+                _less(less), _sort_key(sort_key), _key_offset(key_offset) {
+        }
+
+        bool operator()(Tuple* lhs, Tuple* rhs) const {
+            if (_sort_key != nullptr) {
+                return _sort_key->compare(reinterpret_cast<uint8_t*>(lhs) + _key_offset,
+                                          reinterpret_cast<uint8_t*>(rhs) + _key_offset) < 0;
+            }
+            return (*_less)(lhs, rhs);
+        }
+
+    private:
+        const TupleRowComparator* _less;
+        const NormalizedSortKey* _sort_key;
+        int _key_offset;
+    };
+
     // number rows to skipped
     int64_t _offset;
 
@@ -77,6 +118,15 @@ private:
     // Comparator for _priority_queue.
     boost::scoped_ptr<TupleRowComparator> _tuple_row_less_than;
 
+    // null if the ordering exprs can't be normalized
+    boost::scoped_ptr<NormalizedSortKey> _sort_key;
+    // bytes of the tuples in _priority_queue, including their keys
+    int _tuple_size;
+    boost::scoped_ptr<TupleLess> _tuple_less;
+
+    // null if nothing is published to the scan below
+    std::shared_ptr<TopNBoundary> _topn_boundary;
+
     // After computing the TopN in the priority_queue, pop them and put them in this vector
     std::vector<Tuple*> _sorted_top_n;
 
@@ -108,7 +158,7 @@ private:
     // of the queue is the last sorted element.
     boost::scoped_ptr<
         std::priority_queue<
-        Tuple*, std::vector<Tuple*>, TupleRowComparator> > _priority_queue;
+        Tuple*, std::vector<Tuple*>, TupleLess> > _priority_queue;
 
     // END: Members that must be Reset()
     /////////////////////////////////////////
@@ -0,0 +1,270 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exprs/agg_update_kernel.h"
+
+#include <string.h>
+
+#include "common/logging.h"
+#include "common/object_pool.h"
+#include "exprs/aggregate_functions.h"
+#include "exprs/slot_ref.h"
+#include "runtime/decimalv2_kernels.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+
+namespace doris {
+
+// slots of LARGEINT are not always aligned to 16 bytes
+template <typename T>
+static inline T LoadValue(const void* ptr) {
+  T value;
+  memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+template <typename T>
+static inline void StoreValue(void* ptr, T value) {
+  memcpy(ptr, &value, sizeof(T));
+}
+
+AggUpdateKernel::AggUpdateKernel(Expr* input, const SlotDescriptor& dst_slot_desc,
+    UpdateFn update_fn)
+  : input_(input),
+    dst_offset_(dst_slot_desc.tuple_offset()),
+    dst_null_indicator_offset_(dst_slot_desc.null_indicator_offset()),
+    update_fn_(update_fn) {
+}
+
+AggUpdateKernel* AggUpdateKernel::Create(const AggFn& agg_fn, ObjectPool* pool) {
+  if (agg_fn.is_merge() || !agg_fn.is_builtin()) return NULL;
+  PrimitiveType dst_type = agg_fn.intermediate_type().type;
+  if (agg_fn.is_count_star()) {
+    if (dst_type != TYPE_BIGINT) return NULL;
+    return pool->add(new AggUpdateKernel(NULL, agg_fn.intermediate_slot_desc(), CountStar));
+  }
+  if (agg_fn.get_num_children() != 1) return NULL;
+  Expr* input = agg_fn.get_child(0);
+  if (!input->is_slotref()) return NULL;
+  UpdateFn update_fn = GetUpdateFn(agg_fn.agg_op(), input->type().type, dst_type);
+  if (update_fn == NULL) return NULL;
+  return pool->add(new AggUpdateKernel(input, agg_fn.intermediate_slot_desc(), update_fn));
+}
+
+AggUpdateKernel::UpdateFn AggUpdateKernel::GetUpdateFn(AggFn::AggregationOp op,
+    PrimitiveType type, PrimitiveType dst_type) {
+  switch (op) {
+    case AggFn::COUNT:
+      return dst_type == TYPE_BIGINT ? Count : NULL;
+    case AggFn::SUM:
+      switch (type) {
+        case TYPE_TINYINT:
+          return dst_type == TYPE_BIGINT ? Sum<int8_t, int64_t> : NULL;
+        case TYPE_SMALLINT:
+          return dst_type == TYPE_BIGINT ? Sum<int16_t, int64_t> : NULL;
+        case TYPE_INT:
+          return dst_type == TYPE_BIGINT ? Sum<int32_t, int64_t> : NULL;
+        case TYPE_BIGINT:
+          return dst_type == TYPE_BIGINT ? Sum<int64_t, int64_t> : NULL;
+        case TYPE_LARGEINT:
+          return dst_type == TYPE_LARGEINT ? Sum<__int128, __int128> : NULL;
+        case TYPE_FLOAT:
+          return dst_type == TYPE_DOUBLE ? Sum<float, double> : NULL;
+        case TYPE_DOUBLE:
+          return dst_type == TYPE_DOUBLE ? Sum<double, double> : NULL;
+        case TYPE_DECIMALV2:
+          return dst_type == TYPE_DECIMALV2 ? SumDecimalV2 : NULL;
+        default:
+          return NULL;
+      }
+    case AggFn::MIN:
+    case AggFn::MAX: {
+      // the intermediate value has the type of the input
+      if (type != dst_type) return NULL;
+      bool is_min = op == AggFn::MIN;
+      switch (type) {
+        case TYPE_TINYINT:
+          return is_min ? MinMax<int8_t, true> : MinMax<int8_t, false>;
+        case TYPE_SMALLINT:
+          return is_min ? MinMax<int16_t, true> : MinMax<int16_t, false>;
+        case TYPE_INT:
+          return is_min ? MinMax<int32_t, true> : MinMax<int32_t, false>;
+        case TYPE_BIGINT:
+          return is_min ? MinMax<int64_t, true> : MinMax<int64_t, false>;
+        case TYPE_LARGEINT:
+          return is_min ? MinMax<__int128, true> : MinMax<__int128, false>;
+        case TYPE_FLOAT:
+          return is_min ? MinMax<float, true> : MinMax<float, false>;
+        case TYPE_DOUBLE:
+          return is_min ? MinMax<double, true> : MinMax<double, false>;
+        case TYPE_DECIMALV2:
+          // compared as their int128 values, as DecimalV2Value does
+          return is_min ? MinMax<__int128, true> : MinMax<__int128, false>;
+        default:
+          return NULL;
+      }
+    }
+    case AggFn::AVG:
+      // the AvgState of avg_update() or the DecimalV2AvgState of
+      // decimalv2_avg_update(), decimal and date states are left out
+      if (dst_type != TYPE_VARCHAR) return NULL;
+      switch (type) {
+        case TYPE_TINYINT:
+          return Avg<int8_t>;
+        case TYPE_SMALLINT:
+          return Avg<int16_t>;
+        case TYPE_INT:
+          return Avg<int32_t>;
+        case TYPE_BIGINT:
+          return Avg<int64_t>;
+        case TYPE_FLOAT:
+          return Avg<float>;
+        case TYPE_DOUBLE:
+          return Avg<double>;
+        case TYPE_DECIMALV2:
+          return AvgDecimalV2;
+        default:
+          return NULL;
+      }
+    default:
+      return NULL;
+  }
+}
+
+void AggUpdateKernel::CountStar(const AggUpdateKernel& k, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows) {
+  for (int i = 0; i < num_rows; ++i) {
+    int64_t* dst = reinterpret_cast<int64_t*>(tuples[i]->get_slot(k.dst_offset_));
+    ++*dst;
+  }
+}
+
+void AggUpdateKernel::Count(const AggUpdateKernel& k, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows) {
+  for (int i = 0; i < num_rows; ++i) {
+    int64_t* dst = reinterpret_cast<int64_t*>(tuples[i]->get_slot(k.dst_offset_));
+    *dst += SlotRef::get_value(k.input_, rows[i]) != NULL;
+  }
+}
+
+template <typename SRC, typename DST>
+void AggUpdateKernel::Sum(const AggUpdateKernel& k, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows) {
+  for (int i = 0; i < num_rows; ++i) {
+    const void* src = SlotRef::get_value(k.input_, rows[i]);
+    if (src == NULL) continue;
+    Tuple* tuple = tuples[i];
+    void* dst = tuple->get_slot(k.dst_offset_);
+    DST value = LoadValue<SRC>(src);
+    if (tuple->is_null(k.dst_null_indicator_offset_)) {
+      tuple->set_not_null(k.dst_null_indicator_offset_);
+    } else {
+      value += LoadValue<DST>(dst);
+    }
+    StoreValue<DST>(dst, value);
+  }
+}
+
+template <typename T, bool IS_MIN>
+void AggUpdateKernel::MinMax(const AggUpdateKernel& k, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows) {
+  for (int i = 0; i < num_rows; ++i) {
+    const void* src = SlotRef::get_value(k.input_, rows[i]);
+    if (src == NULL) continue;
+    // the initial value of floating point max() is not the lowest value, the NULL
+    // bit is checked as min() and max() of AggregateFunctions do
+    Tuple* tuple = tuples[i];
+    void* dst = tuple->get_slot(k.dst_offset_);
+    T value = LoadValue<T>(src);
+    if (tuple->is_null(k.dst_null_indicator_offset_)) {
+      tuple->set_not_null(k.dst_null_indicator_offset_);
+      StoreValue<T>(dst, value);
+    } else if (IS_MIN ? value < LoadValue<T>(dst) : value > LoadValue<T>(dst)) {
+      StoreValue<T>(dst, value);
+    }
+  }
+}
+
+template <typename SRC>
+void AggUpdateKernel::Avg(const AggUpdateKernel& k, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows) {
+  for (int i = 0; i < num_rows; ++i) {
+    const void* src = SlotRef::get_value(k.input_, rows[i]);
+    if (src == NULL) continue;
+    StringValue* dst = tuples[i]->get_string_slot(k.dst_offset_);
+    DCHECK_EQ(dst->len, static_cast<int>(sizeof(AvgState)));
+    AvgState* avg = reinterpret_cast<AvgState*>(dst->ptr);
+    avg->sum += LoadValue<SRC>(src);
+    ++avg->count;
+  }
+}
+
+// Calls flush(tuple, values, n) for the values of the consecutive rows which
+// update the same tuple, such as all rows without grouping, so that decimals
+// are summed with one overflow check per run.
+template <typename Flush>
+static void ForEachDecimalV2Run(Expr* input, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows, Flush flush) {
+  static const int MAX_RUN_SIZE = 256;
+  __int128 values[MAX_RUN_SIZE];
+  int run_size = 0;
+  Tuple* run_tuple = NULL;
+  for (int i = 0; i < num_rows; ++i) {
+    const void* src = SlotRef::get_value(input, rows[i]);
+    if (src == NULL) continue;
+    if (tuples[i] != run_tuple || run_size == MAX_RUN_SIZE) {
+      if (run_size > 0) flush(run_tuple, values, run_size);
+      run_tuple = tuples[i];
+      run_size = 0;
+    }
+    values[run_size++] = LoadValue<__int128>(src);
+  }
+  if (run_size > 0) flush(run_tuple, values, run_size);
+}
+
+void AggUpdateKernel::SumDecimalV2(const AggUpdateKernel& k, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows) {
+  ForEachDecimalV2Run(k.input_, rows, tuples, num_rows,
+      [&k](Tuple* tuple, const __int128* values, int n) {
+        void* dst = tuple->get_slot(k.dst_offset_);
+        // sum() starts from 0 as well
+        __int128 sum = 0;
+        if (tuple->is_null(k.dst_null_indicator_offset_)) {
+          tuple->set_not_null(k.dst_null_indicator_offset_);
+        } else {
+          sum = LoadValue<__int128>(dst);
+        }
+        DecimalV2Kernels::sum(values, n, &sum);
+        StoreValue<__int128>(dst, sum);
+      });
+}
+
+void AggUpdateKernel::AvgDecimalV2(const AggUpdateKernel& k, TupleRow* const* rows,
+    Tuple* const* tuples, int num_rows) {
+  ForEachDecimalV2Run(k.input_, rows, tuples, num_rows,
+      [&k](Tuple* tuple, const __int128* values, int n) {
+        StringValue* dst = tuple->get_string_slot(k.dst_offset_);
+        DCHECK_EQ(dst->len, static_cast<int>(sizeof(DecimalV2AvgState)));
+        DecimalV2AvgState* avg = reinterpret_cast<DecimalV2AvgState*>(dst->ptr);
+        DecimalV2Kernels::sum(values, n, &avg->sum.val);
+        avg->count += n;
+      });
+}
+
+}
@@ -0,0 +1,91 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_EXPRS_AGG_UPDATE_KERNEL_H
+#define DORIS_BE_SRC_EXPRS_AGG_UPDATE_KERNEL_H
+
+#include "exprs/agg_fn.h"
+#include "runtime/descriptors.h"
+
+namespace doris {
+
+class Expr;
+class ObjectPool;
+class Tuple;
+class TupleRow;
+
+/// Updates the intermediate values of a built-in aggregate function for many rows at a
+/// time. NewAggFnEvaluator::Add() converts the input and the intermediate value of every
+/// row to AnyVals and calls the update function through a pointer; a kernel is a loop
+/// specialized for the function and the input type, which reads the input slot and
+/// updates the intermediate slot in place.
+///
+/// Kernels exist for count(*), and for count(), sum(), min(), max() and avg() of a slot
+/// of a numeric or decimalv2 type, when the function is not merging. They give the same
+/// results as the update functions of AggregateFunctions, and expect the intermediate
+/// values to be initialized by the init functions of AggFn.
+class AggUpdateKernel {
+ public:
+  /// Returns the kernel of 'agg_fn', which must be prepared, or NULL if there is none.
+  /// The kernel lives in 'pool'.
+  static AggUpdateKernel* Create(const AggFn& agg_fn, ObjectPool* pool);
+
+  /// Updates the intermediate value in tuples[i] with rows[i], for i in [0, num_rows).
+  /// Several rows may update the same tuple.
+  void Update(TupleRow* const* rows, Tuple* const* tuples, int num_rows) const {
+    update_fn_(*this, rows, tuples, num_rows);
+  }
+
+ private:
+  typedef void (*UpdateFn)(const AggUpdateKernel&, TupleRow* const*, Tuple* const*, int);
+
+  AggUpdateKernel(Expr* input, const SlotDescriptor& dst_slot_desc, UpdateFn update_fn);
+
+  static void CountStar(const AggUpdateKernel& k, TupleRow* const* rows,
+      Tuple* const* tuples, int num_rows);
+  static void Count(const AggUpdateKernel& k, TupleRow* const* rows,
+      Tuple* const* tuples, int num_rows);
+  template <typename SRC, typename DST>
+  static void Sum(const AggUpdateKernel& k, TupleRow* const* rows,
+      Tuple* const* tuples, int num_rows);
+  template <typename T, bool IS_MIN>
+  static void MinMax(const AggUpdateKernel& k, TupleRow* const* rows,
+      Tuple* const* tuples, int num_rows);
+  template <typename SRC>
+  static void Avg(const AggUpdateKernel& k, TupleRow* const* rows,
+      Tuple* const* tuples, int num_rows);
+  static void SumDecimalV2(const AggUpdateKernel& k, TupleRow* const* rows,
+      Tuple* const* tuples, int num_rows);
+  static void AvgDecimalV2(const AggUpdateKernel& k, TupleRow* const* rows,
+      Tuple* const* tuples, int num_rows);
+
+  /// Returns the kernel of 'op' for inputs of 'type' or NULL. 'dst_type' is the type
+  /// of the intermediate value.
+  static UpdateFn GetUpdateFn(AggFn::AggregationOp op, PrimitiveType type,
+      PrimitiveType dst_type);
+
+  /// The SlotRef the function is applied to, NULL for count(*).
+  Expr* const input_;
+  const int dst_offset_;
+  const NullIndicatorOffset dst_null_indicator_offset_;
+  const UpdateFn update_fn_;
+};
+
+}
+
+#endif
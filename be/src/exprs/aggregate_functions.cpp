@@ -28,6 +28,7 @@
 #include "exprs/anyval_util.h"
 #include "exprs/hybird_set.h"
 #include "util/debug_util.h"
+#include "util/tdigest.h"
 
 // TODO: this file should be cross compiled and then all of the builtin
 // aggregate functions will have a codegen enabled path. Then we can remove
@@ -176,21 +177,11 @@ void AggregateFunctions::count_remove(
     }
 }
 
-struct AvgState {
-    double sum;
-    int64_t count;
-};
-
 struct DecimalAvgState {
     DecimalVal sum;
     int64_t count;
 };
 
-struct DecimalV2AvgState {
-    DecimalV2Val sum;
-    int64_t count;
-};
-
 void AggregateFunctions::avg_init(FunctionContext* ctx, StringVal* dst) {
     dst->is_null = false;
     dst->len = sizeof(AvgState);
@@ -1093,9 +1084,7 @@ void AggregateFunctions::hll_merge(FunctionContext* ctx, const StringVal& src,
     DCHECK_EQ(dst->len, std::pow(2, HLL_COLUMN_PRECISION));
     DCHECK_EQ(src.len, std::pow(2, HLL_COLUMN_PRECISION));
 
-    for (int i = 0; i < src.len; ++i) {
-        dst->ptr[i] = std::max(dst->ptr[i], src.ptr[i]);
-    }
+    HllSetHelper::merge_registers((char*)dst->ptr, (const char*)src.ptr, src.len);
 }
 
 StringVal AggregateFunctions::hll_finalize(FunctionContext* ctx, const StringVal& src) {
@@ -2122,6 +2111,81 @@ DoubleVal AggregateFunctions::knuth_stddev_pop_finalize(FunctionContext* ctx,
     return DoubleVal(variance);
 }
 
+struct PercentileApproxState {
+    TDigest digest;
+    // the quantile argument, -1 until a value is added
+    double quantile = -1;
+};
+
+void AggregateFunctions::percentile_approx_init(FunctionContext* ctx, StringVal* dst) {
+    dst->is_null = false;
+    dst->len = sizeof(PercentileApproxState);
+    dst->ptr = reinterpret_cast<uint8_t*>(new PercentileApproxState());
+}
+
+void AggregateFunctions::percentile_approx_update(FunctionContext* ctx, const DoubleVal& src,
+                                                  const DoubleVal& quantile, StringVal* dst) {
+    DCHECK(!dst->is_null);
+    if (src.is_null) {
+        return;
+    }
+    if (quantile.is_null || quantile.val < 0 || quantile.val > 1) {
+        ctx->set_error("quantile of percentile_approx must be in [0, 1]");
+        return;
+    }
+    PercentileApproxState* state = reinterpret_cast<PercentileApproxState*>(dst->ptr);
+    state->quantile = quantile.val;
+    state->digest.add(src.val);
+}
+
+// the serialized state is the quantile followed by the digest
+void AggregateFunctions::percentile_approx_merge(FunctionContext* ctx, const StringVal& src,
+                                                 StringVal* dst) {
+    DCHECK(!dst->is_null);
+    if (src.is_null) {
+        return;
+    }
+    double quantile = 0;
+    TDigest digest;
+    if (src.len < static_cast<int>(sizeof(quantile))
+            || !digest.deserialize(reinterpret_cast<const char*>(src.ptr) + sizeof(quantile),
+                                   src.len - sizeof(quantile))) {
+        ctx->set_error("invalid intermediate value of percentile_approx");
+        return;
+    }
+    memcpy(&quantile, src.ptr, sizeof(quantile));
+    PercentileApproxState* state = reinterpret_cast<PercentileApproxState*>(dst->ptr);
+    if (quantile >= 0) {
+        state->quantile = quantile;
+    }
+    state->digest.merge(digest);
+}
+
+StringVal AggregateFunctions::percentile_approx_serialize(FunctionContext* ctx,
+                                                          const StringVal& state_sv) {
+    DCHECK(!state_sv.is_null);
+    PercentileApproxState* state = reinterpret_cast<PercentileApproxState*>(state_sv.ptr);
+    StringVal result(ctx, sizeof(state->quantile) + state->digest.serialized_size());
+    if (!result.is_null) {
+        memcpy(result.ptr, &state->quantile, sizeof(state->quantile));
+        state->digest.serialize(reinterpret_cast<char*>(result.ptr) + sizeof(state->quantile));
+    }
+    delete state;
+    return result;
+}
+
+DoubleVal AggregateFunctions::percentile_approx_finalize(FunctionContext* ctx,
+                                                         const StringVal& state_sv) {
+    DCHECK(!state_sv.is_null);
+    PercentileApproxState* state = reinterpret_cast<PercentileApproxState*>(state_sv.ptr);
+    DoubleVal result = DoubleVal::null();
+    if (state->digest.total_weight() > 0) {
+        result = DoubleVal(state->digest.quantile(state->quantile));
+    }
+    delete state;
+    return result;
+}
+
 struct RankState {
     int64_t rank;
     int64_t count;
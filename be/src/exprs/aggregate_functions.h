@@ -28,6 +28,18 @@ namespace doris {
 class HllSetResolver;
 class HybirdSetBase;
 
+// The intermediate value of avg() on numbers, AggUpdateKernel updates it as well.
+struct AvgState {
+    double sum;
+    int64_t count;
+};
+
+// The intermediate value of avg() on decimalv2, updated by AggUpdateKernel as well.
+struct DecimalV2AvgState {
+    doris_udf::DecimalV2Val sum;
+    int64_t count;
+};
+
 // Collection of builtin aggregate functions. Aggregate functions implement
 // the various phases of the aggregation: Init(), Update(), Serialize(), Merge(),
 // and Finalize(). Not all functions need to implement all of the steps and
@@ -263,6 +275,16 @@ dst);
     /// Calculates the biased STDDEV, uses KnuthVar Init-Update-Merge functions
     static DoubleVal knuth_stddev_pop_finalize(FunctionContext* context, const StringVal& val);
 
+    /// percentile_approx(value, quantile) is estimated by a t-digest. The intermediate
+    /// value points to the digest until it is serialized or finalized.
+    static void percentile_approx_init(FunctionContext* ctx, StringVal* dst);
+    static void percentile_approx_update(FunctionContext* ctx, const DoubleVal& src,
+                                         const DoubleVal& quantile, StringVal* dst);
+    static void percentile_approx_merge(FunctionContext* ctx, const StringVal& src,
+                                        StringVal* dst);
+    static StringVal percentile_approx_serialize(FunctionContext* ctx, const StringVal& state_sv);
+    static DoubleVal percentile_approx_finalize(FunctionContext* ctx, const StringVal& state_sv);
+
     /// ----------------------------- Analytic Functions ---------------------------------
     /// Analytic functions implement the UDA interface (except Merge(), Serialize()) and are
     /// used internally by the AnalyticEvalNode. Some analytic functions store intermediate
@@ -19,6 +19,7 @@
 
 #include "codegen/llvm_codegen.h"
 #include "codegen/codegen_anyval.h"
+#include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 
 using llvm::BasicBlock;
@@ -59,6 +60,214 @@ Expr* ArithmeticExpr::from_thrift(const TExprNode& node) {
     return NULL;
 }
 
+struct AddOp {
+    template <typename T> static T apply(T a, T b) { return a + b; }
+};
+struct SubOp {
+    template <typename T> static T apply(T a, T b) { return a - b; }
+};
+struct MulOp {
+    template <typename T> static T apply(T a, T b) { return a * b; }
+};
+struct DivOp {
+    template <typename T> static T apply(T a, T b) { return a / b; }
+};
+struct ModOp {
+    template <typename T> static T apply(T a, T b) { return a % b; }
+};
+struct FmodOp {
+    template <typename T> static T apply(T a, T b) { return fmod(a, b); }
+};
+struct BitAndOp {
+    template <typename T> static T apply(T a, T b) { return a & b; }
+};
+struct BitOrOp {
+    template <typename T> static T apply(T a, T b) { return a | b; }
+};
+struct BitXorOp {
+    template <typename T> static T apply(T a, T b) { return a ^ b; }
+};
+
+// values of null rows are computed too, they are ignored
+template <typename T, typename OP>
+static void binary_op_batch(ExprColumn* lhs, ExprColumn* rhs,
+                            const int* sel, int n, ExprColumn* result) {
+    const T* v1 = lhs->values<T>();
+    const T* v2 = rhs->values<T>();
+    const uint8_t* nulls1 = lhs->nulls();
+    const uint8_t* nulls2 = rhs->nulls();
+    T* values = result->values<T>();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        nulls[i] = nulls1[i] | nulls2[i];
+        values[i] = OP::apply(v1[i], v2[i]);
+    });
+}
+
+// the result is null if the divisor is 0, as in BINARY_OP_CHECK_ZERO_FN
+template <typename T, typename OP>
+static void binary_op_check_zero_batch(ExprColumn* lhs, ExprColumn* rhs,
+                                       const int* sel, int n, ExprColumn* result) {
+    const T* v1 = lhs->values<T>();
+    const T* v2 = rhs->values<T>();
+    const uint8_t* nulls1 = lhs->nulls();
+    const uint8_t* nulls2 = rhs->nulls();
+    T* values = result->values<T>();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        if (nulls1[i] || nulls2[i] || v2[i] == 0) {
+            nulls[i] = 1;
+        } else {
+            values[i] = OP::apply(v1[i], v2[i]);
+        }
+    });
+}
+
+template <typename T>
+static void bit_not_batch(ExprColumn* input, const int* sel, int n, ExprColumn* result) {
+    const T* v = input->values<T>();
+    const uint8_t* input_nulls = input->nulls();
+    T* values = result->values<T>();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        nulls[i] = input_nulls[i];
+        values[i] = ~v[i];
+    });
+}
+
+template <typename T>
+static void int_op_batch(TExprOpcode::type op, ExprColumn* lhs, ExprColumn* rhs,
+                         const int* sel, int n, ExprColumn* result) {
+    switch (op) {
+    case TExprOpcode::ADD:
+        binary_op_batch<T, AddOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::SUBTRACT:
+        binary_op_batch<T, SubOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::MULTIPLY:
+        binary_op_batch<T, MulOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::DIVIDE:
+    case TExprOpcode::INT_DIVIDE:
+        binary_op_check_zero_batch<T, DivOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::MOD:
+        binary_op_check_zero_batch<T, ModOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::BITAND:
+        binary_op_batch<T, BitAndOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::BITOR:
+        binary_op_batch<T, BitOrOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::BITXOR:
+        binary_op_batch<T, BitXorOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::BITNOT:
+        bit_not_batch<T>(lhs, sel, n, result);
+        break;
+    default:
+        DCHECK(false) << "unknown arithmetic opcode " << op;
+        break;
+    }
+}
+
+template <typename T>
+static void float_op_batch(TExprOpcode::type op, ExprColumn* lhs, ExprColumn* rhs,
+                           const int* sel, int n, ExprColumn* result) {
+    switch (op) {
+    case TExprOpcode::ADD:
+        binary_op_batch<T, AddOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::SUBTRACT:
+        binary_op_batch<T, SubOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::MULTIPLY:
+        binary_op_batch<T, MulOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::DIVIDE:
+    case TExprOpcode::INT_DIVIDE:
+        binary_op_check_zero_batch<T, DivOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::MOD:
+        // fmod() of 0 is NaN, not null
+        binary_op_batch<T, FmodOp>(lhs, rhs, sel, n, result);
+        break;
+    default:
+        DCHECK(false) << "unknown arithmetic opcode " << op;
+        break;
+    }
+}
+
+void ArithmeticExpr::evaluate_batch(ExprContext* context, RowBatch* batch,
+                                    const int* sel, int n, ExprColumn* result) {
+    bool is_bit_op = _opcode == TExprOpcode::BITAND || _opcode == TExprOpcode::BITOR
+        || _opcode == TExprOpcode::BITXOR || _opcode == TExprOpcode::BITNOT;
+    bool supported = false;
+    switch (_type.type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+        supported = true;
+        break;
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+        supported = !is_bit_op;
+        break;
+    default:
+        break;
+    }
+    for (auto child : _children) {
+        supported = supported && child->type().type == _type.type;
+    }
+    if (!supported || _children.size() != (_opcode == TExprOpcode::BITNOT ? 1 : 2)) {
+        Expr::evaluate_batch(context, batch, sel, n, result);
+        return;
+    }
+
+    ExprColumn* lhs = context->acquire_column();
+    _children[0]->evaluate_batch(context, batch, sel, n, lhs);
+    ExprColumn* rhs = NULL;
+    if (_children.size() > 1) {
+        rhs = context->acquire_column();
+        _children[1]->evaluate_batch(context, batch, sel, n, rhs);
+    }
+    result->reset(_type.type, batch->num_rows());
+    switch (_type.type) {
+    case TYPE_TINYINT:
+        int_op_batch<int8_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_SMALLINT:
+        int_op_batch<int16_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_INT:
+        int_op_batch<int32_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_BIGINT:
+        int_op_batch<int64_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_LARGEINT:
+        int_op_batch<__int128>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_FLOAT:
+        float_op_batch<float>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_DOUBLE:
+        float_op_batch<double>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    default:
+        DCHECK(false);
+        break;
+    }
+    if (rhs != NULL) {
+        context->release_column(rhs);
+    }
+    context->release_column(lhs);
+}
+
 #define BINARY_OP_CHECK_ZERO_FN(TYPE, CLASS, FN, OP) \
     TYPE CLASS::FN(ExprContext* context, TupleRow* row) { \
         TYPE v1 = _children[0]->FN(context, row); \
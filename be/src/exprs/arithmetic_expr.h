@@ -42,6 +42,10 @@ protected:
     ArithmeticExpr(const TExprNode& node) : Expr(node) { }
     virtual ~ArithmeticExpr() { }
 
+    // evaluates the rows with a loop for each opcode and type
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
+
     Status codegen_binary_op(
         RuntimeState* state, llvm::Function** fn, BinaryOpType op_type);
 };
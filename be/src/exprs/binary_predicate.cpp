@@ -23,6 +23,7 @@
 #include "codegen/codegen_anyval.h"
 #include "util/debug_util.h"
 #include "gen_cpp/Exprs_types.h"
+#include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "runtime/string_value.h"
 #include "runtime/datetime_value.h"
@@ -246,6 +247,162 @@ std::string BinaryPredicate::debug_string() const {
     return out.str();
 }
 
+struct EqOp {
+    template <typename T> static bool apply(const T& a, const T& b) { return a == b; }
+};
+struct NeOp {
+    template <typename T> static bool apply(const T& a, const T& b) { return a != b; }
+};
+struct LtOp {
+    template <typename T> static bool apply(const T& a, const T& b) { return a < b; }
+};
+struct LeOp {
+    template <typename T> static bool apply(const T& a, const T& b) { return a <= b; }
+};
+struct GtOp {
+    template <typename T> static bool apply(const T& a, const T& b) { return a > b; }
+};
+struct GeOp {
+    template <typename T> static bool apply(const T& a, const T& b) { return a >= b; }
+};
+
+// null rows are skipped, their values may not be valid strings or decimals
+template <typename T, typename OP>
+static void compare_batch(ExprColumn* lhs, ExprColumn* rhs,
+                          const int* sel, int n, ExprColumn* result) {
+    const T* v1 = lhs->values<T>();
+    const T* v2 = rhs->values<T>();
+    const uint8_t* nulls1 = lhs->nulls();
+    const uint8_t* nulls2 = rhs->nulls();
+    bool* values = result->values<bool>();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        if (nulls1[i] || nulls2[i]) {
+            nulls[i] = 1;
+        } else {
+            values[i] = OP::apply(v1[i], v2[i]);
+        }
+    });
+}
+
+template <typename T>
+static void compare_batch(TExprOpcode::type op, ExprColumn* lhs, ExprColumn* rhs,
+                          const int* sel, int n, ExprColumn* result) {
+    switch (op) {
+    case TExprOpcode::EQ:
+        compare_batch<T, EqOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::NE:
+        compare_batch<T, NeOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::LT:
+        compare_batch<T, LtOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::LE:
+        compare_batch<T, LeOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::GT:
+        compare_batch<T, GtOp>(lhs, rhs, sel, n, result);
+        break;
+    case TExprOpcode::GE:
+        compare_batch<T, GeOp>(lhs, rhs, sel, n, result);
+        break;
+    default:
+        DCHECK(false) << "unknown binary predicate opcode " << op;
+        break;
+    }
+}
+
+// CHAR and VARCHAR, DATE and DATETIME have the same values
+static bool is_same_value_type(const TypeDescriptor& t1, const TypeDescriptor& t2) {
+    if (t1.is_string_type() || t1.is_date_type()) {
+        return t1.is_string_type() == t2.is_string_type()
+            && t1.is_date_type() == t2.is_date_type();
+    }
+    return t1.type == t2.type;
+}
+
+void BinaryPredicate::evaluate_batch(ExprContext* context, RowBatch* batch,
+                                     const int* sel, int n, ExprColumn* result) {
+    DCHECK_EQ(_children.size(), 2);
+    const TypeDescriptor& child_type = _children[0]->type();
+    if (!is_same_value_type(child_type, _children[1]->type())) {
+        Expr::evaluate_batch(context, batch, sel, n, result);
+        return;
+    }
+    switch (child_type.type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_DECIMAL:
+    case TYPE_DECIMALV2:
+        break;
+    default:
+        Expr::evaluate_batch(context, batch, sel, n, result);
+        return;
+    }
+
+    ExprColumn* lhs = context->acquire_column();
+    _children[0]->evaluate_batch(context, batch, sel, n, lhs);
+    ExprColumn* rhs = context->acquire_column();
+    _children[1]->evaluate_batch(context, batch, sel, n, rhs);
+    result->reset(TYPE_BOOLEAN, batch->num_rows());
+    switch (child_type.type) {
+    case TYPE_BOOLEAN:
+        compare_batch<bool>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_TINYINT:
+        compare_batch<int8_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_SMALLINT:
+        compare_batch<int16_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_INT:
+        compare_batch<int32_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_BIGINT:
+        compare_batch<int64_t>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_LARGEINT:
+        compare_batch<__int128>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_FLOAT:
+        compare_batch<float>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_DOUBLE:
+        compare_batch<double>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        compare_batch<StringValue>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        compare_batch<DateTimeValue>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_DECIMAL:
+        compare_batch<DecimalValue>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    case TYPE_DECIMALV2:
+        compare_batch<DecimalV2Value>(_opcode, lhs, rhs, sel, n, result);
+        break;
+    default:
+        DCHECK(false);
+        break;
+    }
+    context->release_column(rhs);
+    context->release_column(lhs);
+}
+
 // IR codegen for compound add predicates.  Compound predicate has non trivial
 // null handling as well as many branches so this is pretty complicated.  The IR
 // for x && y is:
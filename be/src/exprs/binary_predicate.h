@@ -35,6 +35,10 @@ public:
     BinaryPredicate(const TExprNode& node) : Predicate(node) { }
     virtual ~BinaryPredicate() { }
 
+    // evaluates the rows with a loop for each opcode and type of the children
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
+
 protected:
     friend class Expr;
 
@@ -0,0 +1,165 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/bitmap_function.h"
+
+#include "common/logging.h"
+#include "util/roaring_bitmap.h"
+#include "util/string_parser.hpp"
+
+namespace doris {
+
+using doris_udf::BigIntVal;
+using doris_udf::FunctionContext;
+using doris_udf::IntVal;
+using doris_udf::SmallIntVal;
+using doris_udf::StringVal;
+using doris_udf::TinyIntVal;
+
+void BitmapFunctions::init() {
+}
+
+bool BitmapFunctions::deserialize(FunctionContext* ctx, const StringVal& src,
+                                  RoaringBitmap* bitmap) {
+    if (src.len == 0) {
+        *bitmap = RoaringBitmap();
+        return true;
+    }
+    if (!bitmap->deserialize(reinterpret_cast<const char*>(src.ptr), src.len)) {
+        ctx->set_error("invalid bitmap");
+        return false;
+    }
+    return true;
+}
+
+StringVal BitmapFunctions::serialize(FunctionContext* ctx, const RoaringBitmap& bitmap) {
+    StringVal result(ctx, bitmap.serialized_size());
+    if (!result.is_null) {
+        bitmap.serialize(reinterpret_cast<char*>(result.ptr));
+    }
+    return result;
+}
+
+void BitmapFunctions::bitmap_init(FunctionContext* ctx, StringVal* dst) {
+    dst->is_null = false;
+    dst->len = sizeof(RoaringBitmap);
+    dst->ptr = reinterpret_cast<uint8_t*>(new RoaringBitmap());
+}
+
+template <typename T>
+void BitmapFunctions::bitmap_update_int(FunctionContext* ctx, const T& src, StringVal* dst) {
+    if (src.is_null) {
+        return;
+    }
+    int64_t value = src.val;
+    if (value < 0 || value > UINT32_MAX) {
+        ctx->set_error("bitmap value must be in [0, 4294967295]");
+        return;
+    }
+    reinterpret_cast<RoaringBitmap*>(dst->ptr)->add(value);
+}
+
+void BitmapFunctions::bitmap_union(FunctionContext* ctx, const StringVal& src, StringVal* dst) {
+    if (src.is_null || src.len == 0) {
+        return;
+    }
+    RoaringBitmap bitmap;
+    if (deserialize(ctx, src, &bitmap)) {
+        reinterpret_cast<RoaringBitmap*>(dst->ptr)->union_with(bitmap);
+    }
+}
+
+StringVal BitmapFunctions::bitmap_serialize(FunctionContext* ctx, const StringVal& src) {
+    DCHECK(!src.is_null);
+    RoaringBitmap* bitmap = reinterpret_cast<RoaringBitmap*>(src.ptr);
+    StringVal result = serialize(ctx, *bitmap);
+    delete bitmap;
+    return result;
+}
+
+BigIntVal BitmapFunctions::bitmap_finalize(FunctionContext* ctx, const StringVal& src) {
+    DCHECK(!src.is_null);
+    RoaringBitmap* bitmap = reinterpret_cast<RoaringBitmap*>(src.ptr);
+    BigIntVal result(bitmap->cardinality());
+    delete bitmap;
+    return result;
+}
+
+StringVal BitmapFunctions::to_bitmap(FunctionContext* ctx, const StringVal& src) {
+    RoaringBitmap bitmap;
+    if (!src.is_null) {
+        StringParser::ParseResult parse_result = StringParser::PARSE_SUCCESS;
+        int64_t value = StringParser::string_to_int<int64_t>(
+                reinterpret_cast<const char*>(src.ptr), src.len, &parse_result);
+        if (parse_result != StringParser::PARSE_SUCCESS || value < 0 || value > UINT32_MAX) {
+            ctx->set_error("to_bitmap only accepts integers in [0, 4294967295]");
+            return StringVal::null();
+        }
+        bitmap.add(value);
+    }
+    return serialize(ctx, bitmap);
+}
+
+BigIntVal BitmapFunctions::bitmap_count(FunctionContext* ctx, const StringVal& src) {
+    if (src.is_null) {
+        return BigIntVal(0);
+    }
+    RoaringBitmap bitmap;
+    if (!deserialize(ctx, src, &bitmap)) {
+        return BigIntVal::null();
+    }
+    return BigIntVal(bitmap.cardinality());
+}
+
+StringVal BitmapFunctions::bitmap_or(FunctionContext* ctx, const StringVal& lhs,
+                                     const StringVal& rhs) {
+    if (lhs.is_null || rhs.is_null) {
+        return StringVal::null();
+    }
+    RoaringBitmap bitmap;
+    RoaringBitmap other;
+    if (!deserialize(ctx, lhs, &bitmap) || !deserialize(ctx, rhs, &other)) {
+        return StringVal::null();
+    }
+    bitmap.union_with(other);
+    return serialize(ctx, bitmap);
+}
+
+StringVal BitmapFunctions::bitmap_and(FunctionContext* ctx, const StringVal& lhs,
+                                      const StringVal& rhs) {
+    if (lhs.is_null || rhs.is_null) {
+        return StringVal::null();
+    }
+    RoaringBitmap bitmap;
+    RoaringBitmap other;
+    if (!deserialize(ctx, lhs, &bitmap) || !deserialize(ctx, rhs, &other)) {
+        return StringVal::null();
+    }
+    bitmap.intersect_with(other);
+    return serialize(ctx, bitmap);
+}
+
+template void BitmapFunctions::bitmap_update_int<TinyIntVal>(
+    FunctionContext* ctx, const TinyIntVal& src, StringVal* dst);
+template void BitmapFunctions::bitmap_update_int<SmallIntVal>(
+    FunctionContext* ctx, const SmallIntVal& src, StringVal* dst);
+template void BitmapFunctions::bitmap_update_int<IntVal>(
+    FunctionContext* ctx, const IntVal& src, StringVal* dst);
+template void BitmapFunctions::bitmap_update_int<BigIntVal>(
+    FunctionContext* ctx, const BigIntVal& src, StringVal* dst);
+
+}
@@ -0,0 +1,71 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_EXPRS_BITMAP_FUNCTION_H
+#define DORIS_BE_SRC_EXPRS_BITMAP_FUNCTION_H
+
+#include "udf/udf.h"
+
+namespace doris {
+
+class RoaringBitmap;
+
+// Exact count distinct of 32 bits unsigned integers. A bitmap is stored as the
+// serialized RoaringBitmap in a VARCHAR, the empty string is the empty set.
+//
+// The intermediate value of the aggregate functions points to a RoaringBitmap
+// until it is serialized or finalized.
+class BitmapFunctions {
+public:
+    static void init();
+
+    static void bitmap_init(doris_udf::FunctionContext* ctx, doris_udf::StringVal* dst);
+    template <typename T>
+    static void bitmap_update_int(doris_udf::FunctionContext* ctx, const T& src,
+                                  doris_udf::StringVal* dst);
+    // update and merge function of serialized bitmaps
+    static void bitmap_union(doris_udf::FunctionContext* ctx, const doris_udf::StringVal& src,
+                             doris_udf::StringVal* dst);
+    static doris_udf::StringVal bitmap_serialize(doris_udf::FunctionContext* ctx,
+                                                 const doris_udf::StringVal& src);
+    static doris_udf::BigIntVal bitmap_finalize(doris_udf::FunctionContext* ctx,
+                                                const doris_udf::StringVal& src);
+
+    // the bitmap of a value in [0, 2^32) written in decimal, the empty bitmap if
+    // 'src' is null
+    static doris_udf::StringVal to_bitmap(doris_udf::FunctionContext* ctx,
+                                          const doris_udf::StringVal& src);
+    static doris_udf::BigIntVal bitmap_count(doris_udf::FunctionContext* ctx,
+                                             const doris_udf::StringVal& src);
+    static doris_udf::StringVal bitmap_or(doris_udf::FunctionContext* ctx,
+                                          const doris_udf::StringVal& lhs,
+                                          const doris_udf::StringVal& rhs);
+    static doris_udf::StringVal bitmap_and(doris_udf::FunctionContext* ctx,
+                                           const doris_udf::StringVal& lhs,
+                                           const doris_udf::StringVal& rhs);
+
+private:
+    // sets ctx's error if 'src' is not a serialized bitmap
+    static bool deserialize(doris_udf::FunctionContext* ctx, const doris_udf::StringVal& src,
+                            RoaringBitmap* bitmap);
+    static doris_udf::StringVal serialize(doris_udf::FunctionContext* ctx,
+                                          const RoaringBitmap& bitmap);
+};
+
+}
+
+#endif
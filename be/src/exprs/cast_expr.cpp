@@ -19,6 +19,7 @@
 
 #include "codegen/llvm_codegen.h"
 #include "codegen/codegen_anyval.h"
+#include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 
 using llvm::BasicBlock;
@@ -56,6 +57,111 @@ Expr* CastExpr::from_thrift(const TExprNode& node) {
     return NULL;
 }
 
+static bool is_numeric_type(PrimitiveType type) {
+    switch (type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// the conversion of CAST_FUNCTION
+template <typename FROM, typename TO>
+static void cast_batch(ExprColumn* input, const int* sel, int n, ExprColumn* result) {
+    const FROM* v = input->values<FROM>();
+    const uint8_t* input_nulls = input->nulls();
+    TO* values = result->values<TO>();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        nulls[i] = input_nulls[i];
+        values[i] = static_cast<TO>(v[i]);
+    });
+}
+
+template <typename FROM>
+static void cast_batch(PrimitiveType to, ExprColumn* input,
+                       const int* sel, int n, ExprColumn* result) {
+    switch (to) {
+    case TYPE_BOOLEAN:
+        cast_batch<FROM, bool>(input, sel, n, result);
+        break;
+    case TYPE_TINYINT:
+        cast_batch<FROM, int8_t>(input, sel, n, result);
+        break;
+    case TYPE_SMALLINT:
+        cast_batch<FROM, int16_t>(input, sel, n, result);
+        break;
+    case TYPE_INT:
+        cast_batch<FROM, int32_t>(input, sel, n, result);
+        break;
+    case TYPE_BIGINT:
+        cast_batch<FROM, int64_t>(input, sel, n, result);
+        break;
+    case TYPE_LARGEINT:
+        cast_batch<FROM, __int128>(input, sel, n, result);
+        break;
+    case TYPE_FLOAT:
+        cast_batch<FROM, float>(input, sel, n, result);
+        break;
+    case TYPE_DOUBLE:
+        cast_batch<FROM, double>(input, sel, n, result);
+        break;
+    default:
+        DCHECK(false);
+        break;
+    }
+}
+
+void CastExpr::evaluate_batch(ExprContext* context, RowBatch* batch,
+                              const int* sel, int n, ExprColumn* result) {
+    PrimitiveType from = _children[0]->type().type;
+    if (!is_numeric_type(from) || !is_numeric_type(_type.type)) {
+        Expr::evaluate_batch(context, batch, sel, n, result);
+        return;
+    }
+    ExprColumn* input = context->acquire_column();
+    _children[0]->evaluate_batch(context, batch, sel, n, input);
+    result->reset(_type.type, batch->num_rows());
+    switch (from) {
+    case TYPE_BOOLEAN:
+        cast_batch<bool>(_type.type, input, sel, n, result);
+        break;
+    case TYPE_TINYINT:
+        cast_batch<int8_t>(_type.type, input, sel, n, result);
+        break;
+    case TYPE_SMALLINT:
+        cast_batch<int16_t>(_type.type, input, sel, n, result);
+        break;
+    case TYPE_INT:
+        cast_batch<int32_t>(_type.type, input, sel, n, result);
+        break;
+    case TYPE_BIGINT:
+        cast_batch<int64_t>(_type.type, input, sel, n, result);
+        break;
+    case TYPE_LARGEINT:
+        cast_batch<__int128>(_type.type, input, sel, n, result);
+        break;
+    case TYPE_FLOAT:
+        cast_batch<float>(_type.type, input, sel, n, result);
+        break;
+    case TYPE_DOUBLE:
+        cast_batch<double>(_type.type, input, sel, n, result);
+        break;
+    default:
+        DCHECK(false);
+        break;
+    }
+    context->release_column(input);
+}
+
 #define CAST_SAME(CLASS, TYPE, FN) \
     TYPE CLASS::FN(ExprContext* context, TupleRow* row) { \
         return _children[0]->FN(context, row); \
@@ -28,6 +28,10 @@ public:
     CastExpr(const TExprNode& node) : Expr(node) { }
     virtual ~CastExpr() { }
     static Expr* from_thrift(const TExprNode& node);
+
+    // evaluates the rows with a loop for each source and target type
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
 protected:
     Status codegen_cast_fn(RuntimeState* state, llvm::Function** fn);
 };
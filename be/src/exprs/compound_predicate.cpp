@@ -18,10 +18,16 @@
 #include "exprs/compound_predicate.h"
 
 #include <sstream>
+#include <vector>
 
 #include "codegen/llvm_codegen.h"
 #include "codegen/codegen_anyval.h"
+#include "exprs/expr_column.h"
+#include "exprs/expr_context.h"
+#include "exprs/like_predicate.h"
+#include "exprs/slot_ref.h"
 #include "util/debug_util.h"
+#include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 
 using llvm::BasicBlock;
@@ -68,7 +74,92 @@ BooleanVal AndPredicate::get_boolean_val(ExprContext* context, TupleRow* row) {
     return BooleanVal(true);
 }
 
+// Chains of fewer predicates are faster with the substring searches of each one.
+static const size_t MIN_PATTERNS_CHAIN_SIZE = 3;
+// The DFA of a set matches nothing if it needs more memory than this, which large
+// sets of patterns with many wildcards hardly do.
+static const int64_t PATTERNS_MAX_MEM = 64L * 1024 * 1024;
+
+bool OrPredicate::collect_patterns(Expr* expr, Expr** value,
+                                   std::vector<std::string>* patterns,
+                                   std::vector<OrPredicate*>* chain) {
+    OrPredicate* or_pred = dynamic_cast<OrPredicate*>(expr);
+    if (or_pred != NULL) {
+        chain->push_back(or_pred);
+        return collect_patterns(expr->get_child(0), value, patterns, chain)
+            && collect_patterns(expr->get_child(1), value, patterns, chain);
+    }
+    if (expr->node_type() != TExprNodeType::FUNCTION_CALL || expr->get_num_children() != 2) {
+        return false;
+    }
+    const std::string& fn_name = expr->fn().name.function_name;
+    if (fn_name != "like" && fn_name != "regexp") {
+        return false;
+    }
+    Expr* slot = expr->get_child(0);
+    Expr* pattern = expr->get_child(1);
+    if (!slot->is_slotref() || pattern->node_type() != TExprNodeType::STRING_LITERAL) {
+        return false;
+    }
+    if (*value != NULL
+            && static_cast<SlotRef*>(*value)->slot_id() != static_cast<SlotRef*>(slot)->slot_id()) {
+        return false;
+    }
+    *value = slot;
+    StringVal pattern_val = pattern->get_string_val(NULL, NULL);
+    std::string re_pattern;
+    LikePredicate::to_partial_regex(
+        std::string(reinterpret_cast<const char*>(pattern_val.ptr), pattern_val.len),
+        fn_name == "like", &re_pattern);
+    patterns->push_back(re_pattern);
+    return true;
+}
+
+Status OrPredicate::prepare(RuntimeState* state, const RowDescriptor& row_desc,
+                            ExprContext* context) {
+    // the chain is found from its top, the ORs in it are prepared after
+    Expr* value = NULL;
+    std::vector<std::string> patterns;
+    std::vector<OrPredicate*> chain;
+    if (_patterns == NULL && !_in_patterns_chain
+            && collect_patterns(this, &value, &patterns, &chain)
+            && patterns.size() >= MIN_PATTERNS_CHAIN_SIZE) {
+        RE2::Options opts;
+        opts.set_never_nl(false);
+        opts.set_dot_nl(true);
+        opts.set_max_mem(PATTERNS_MAX_MEM);
+        std::shared_ptr<RE2::Set> set(new RE2::Set(opts, RE2::UNANCHORED));
+        bool valid = true;
+        for (auto& pattern : patterns) {
+            // invalid patterns fail the predicate of their own
+            if (set->Add(pattern, NULL) < 0) {
+                valid = false;
+                break;
+            }
+        }
+        if (valid && set->Compile()) {
+            _patterns = set;
+            _patterns_value = value;
+            for (auto or_pred : chain) {
+                if (or_pred != this) {
+                    or_pred->_in_patterns_chain = true;
+                }
+            }
+        }
+    }
+    return Expr::prepare(state, row_desc, context);
+}
+
 BooleanVal OrPredicate::get_boolean_val(ExprContext* context, TupleRow* row) {
+    if (_patterns != NULL) {
+        // the predicates are all null if the string is
+        StringVal val = _patterns_value->get_string_val(context, row);
+        if (val.is_null) {
+            return BooleanVal::null();
+        }
+        return BooleanVal(_patterns->Match(
+                re2::StringPiece(reinterpret_cast<const char*>(val.ptr), val.len), NULL));
+    }
     DCHECK_EQ(_children.size(), 2);
     BooleanVal val1 = _children[0]->get_boolean_val(context, row);
     if (!val1.is_null && val1.val) {
@@ -92,6 +183,94 @@ BooleanVal NotPredicate::get_boolean_val(ExprContext* context, TupleRow* row) {
     return BooleanVal(!val.val);
 }
 
+// The rhs is only evaluated for the rows whose value is not decided by the lhs,
+// they are false for AND and true for OR, like the short circuit of
+// get_boolean_val().
+void CompoundPredicate::evaluate_and_or_batch(bool is_and, ExprContext* context,
+                                              RowBatch* batch, const int* sel, int n,
+                                              ExprColumn* result) {
+    DCHECK_EQ(_children.size(), 2);
+    ExprColumn* lhs = context->acquire_column();
+    _children[0]->evaluate_batch(context, batch, sel, n, lhs);
+    const bool* v1 = lhs->values<bool>();
+    const uint8_t* nulls1 = lhs->nulls();
+
+    result->reset(TYPE_BOOLEAN, batch->num_rows());
+    bool* values = result->values<bool>();
+    uint8_t* nulls = result->nulls();
+    std::vector<int> undecided;
+    undecided.reserve(n);
+    for_each_selected_row(sel, n, [&](int i) {
+        if (nulls1[i] || v1[i] == is_and) {
+            undecided.push_back(i);
+        } else {
+            values[i] = !is_and;
+        }
+    });
+
+    if (!undecided.empty()) {
+        ExprColumn* rhs = context->acquire_column();
+        _children[1]->evaluate_batch(context, batch, undecided.data(), undecided.size(), rhs);
+        const bool* v2 = rhs->values<bool>();
+        const uint8_t* nulls2 = rhs->nulls();
+        for (int i : undecided) {
+            if (!nulls2[i] && v2[i] != is_and) {
+                values[i] = !is_and;
+            } else if (nulls1[i] || nulls2[i]) {
+                nulls[i] = 1;
+            } else {
+                values[i] = is_and;
+            }
+        }
+        context->release_column(rhs);
+    }
+    context->release_column(lhs);
+}
+
+void AndPredicate::evaluate_batch(ExprContext* context, RowBatch* batch,
+                                  const int* sel, int n, ExprColumn* result) {
+    evaluate_and_or_batch(true, context, batch, sel, n, result);
+}
+
+void OrPredicate::evaluate_batch(ExprContext* context, RowBatch* batch,
+                                 const int* sel, int n, ExprColumn* result) {
+    if (_patterns == NULL) {
+        evaluate_and_or_batch(false, context, batch, sel, n, result);
+        return;
+    }
+    ExprColumn* input = context->acquire_column();
+    _patterns_value->evaluate_batch(context, batch, sel, n, input);
+    const StringValue* strs = input->values<StringValue>();
+    const uint8_t* input_nulls = input->nulls();
+    result->reset(TYPE_BOOLEAN, batch->num_rows());
+    bool* values = result->values<bool>();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        if (input_nulls[i]) {
+            nulls[i] = 1;
+        } else {
+            values[i] = _patterns->Match(re2::StringPiece(strs[i].ptr, strs[i].len), NULL);
+        }
+    });
+    context->release_column(input);
+}
+
+void NotPredicate::evaluate_batch(ExprContext* context, RowBatch* batch,
+                                  const int* sel, int n, ExprColumn* result) {
+    ExprColumn* input = context->acquire_column();
+    _children[0]->evaluate_batch(context, batch, sel, n, input);
+    const bool* v = input->values<bool>();
+    const uint8_t* input_nulls = input->nulls();
+    result->reset(TYPE_BOOLEAN, batch->num_rows());
+    bool* values = result->values<bool>();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        nulls[i] = input_nulls[i];
+        values[i] = !v[i];
+    });
+    context->release_column(input);
+}
+
 std::string CompoundPredicate::debug_string() const {
     std::stringstream out;
     out << "CompoundPredicate(" << Expr::debug_string() << ")";
@@ -18,7 +18,11 @@
 #ifndef DORIS_BE_SRC_QUERY_EXPRS_COMPOUND_PREDICATE_H
 #define DORIS_BE_SRC_QUERY_EXPRS_COMPOUND_PREDICATE_H
 
+#include <memory>
 #include <string>
+#include <vector>
+
+#include <re2/set.h>
 
 #include "common/object_pool.h"
 #include "exprs/predicate.h"
@@ -41,6 +45,8 @@ protected:
     CompoundPredicate(const TExprNode& node);
 
     Status codegen_compute_fn(bool and_fn, RuntimeState* state, llvm::Function** fn);
+    void evaluate_and_or_batch(bool is_and, ExprContext* context, RowBatch* batch,
+                               const int* sel, int n, ExprColumn* result);
     // virtual Status prepare(RuntimeState* state, const RowDescriptor& desc);
     virtual std::string debug_string() const;
 
@@ -59,6 +65,8 @@ public:
         return pool->add(new AndPredicate(*this));
     }
     virtual doris_udf::BooleanVal get_boolean_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
 
     virtual Status get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) {
         return CompoundPredicate::codegen_compute_fn(true, state, fn);
@@ -79,12 +87,20 @@ private:
 };
 
 /// Expr for evaluating or (||) operators
+///
+/// A chain of ORs of LIKE and REGEXP predicates with constant patterns, which all match
+/// the same slot, is evaluated by matching the patterns at once with one RE2 set, so
+/// the string is scanned once instead of once per predicate.
 class OrPredicate: public CompoundPredicate {
 public:
     virtual Expr* clone(ObjectPool* pool) const override { 
         return pool->add(new OrPredicate(*this));
     }
+    virtual Status prepare(RuntimeState* state, const RowDescriptor& row_desc,
+                           ExprContext* context) override;
     virtual doris_udf::BooleanVal get_boolean_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
 
     virtual Status get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) {
         return CompoundPredicate::codegen_compute_fn(false, state, fn);
@@ -92,7 +108,8 @@ public:
 
 protected:
     friend class Expr;
-    OrPredicate(const TExprNode& node) : CompoundPredicate(node) { }
+    OrPredicate(const TExprNode& node) :
+            CompoundPredicate(node), _patterns_value(NULL), _in_patterns_chain(false) { }
 
     virtual std::string debug_string() const {
         std::stringstream out;
@@ -102,6 +119,21 @@ protected:
 
 private:
     friend class OpcodeRegistry;
+
+    /// Adds the partial regexes of the LIKE and REGEXP predicates of the OR chain
+    /// 'expr' to 'patterns' and its ORs to 'chain', sets 'value' to the slot they
+    /// match. Returns false if the chain has other predicates, patterns which are not
+    /// constant or predicates of other slots.
+    static bool collect_patterns(Expr* expr, Expr** value, std::vector<std::string>* patterns,
+                                 std::vector<OrPredicate*>* chain);
+
+    /// The patterns of the chain of this OR, NULL if it isn't such a chain or it is
+    /// matched by an OR above this one.
+    std::shared_ptr<re2::RE2::Set> _patterns;
+    /// The slot matched by _patterns.
+    Expr* _patterns_value;
+    /// True if this OR is in the chain of an OR above it.
+    bool _in_patterns_chain;
 };
 
 /// Expr for evaluating or (||) operators
@@ -111,6 +143,8 @@ public:
         return pool->add(new NotPredicate(*this));
     }
     virtual doris_udf::BooleanVal get_boolean_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
 
     virtual Status get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) {
         return get_codegend_compute_fn_wrapper(state, fn);
@@ -24,6 +24,8 @@
 #include "exprs/anyval_util.h"
 #include "exprs/case_expr.h"
 #include "exprs/expr.h"
+#include "exprs/expr_column.h"
+#include "runtime/decimalv2_kernels.h"
 #include "runtime/tuple_row.h"
 // #include "util/decimal_util.h"
 #include "util/string_parser.hpp"
@@ -184,5 +186,78 @@ DECIMAL_ARITHMETIC_OPS();
 
 BINARY_PREDICATE_NONNUMERIC_FNS();
 
+// The decimalv2 argument 'idx' of a batch function, from its column or its
+// constant value.
+class DecimalV2Arg {
+public:
+    DecimalV2Arg(FunctionContext* context, ExprColumn* const* args, int idx) :
+            _values(args[idx] == NULL ? NULL : args[idx]->values<int128_t>()), _constant(0) {
+        if (_values == NULL) {
+            _constant = reinterpret_cast<DecimalV2Val*>(context->get_constant_arg(idx))->val;
+        }
+    }
+
+    int128_t get(int row) const {
+        return _values == NULL ? _constant : _values[row];
+    }
+
+private:
+    const int128_t* _values;
+    int128_t _constant;
+};
+
+template <int128_t (*OP)(int128_t, int128_t)>
+static void decimalv2_op_batch(FunctionContext* context, ExprColumn* const* args,
+                               const int* sel, int n, ExprColumn* result) {
+    DecimalV2Arg lhs(context, args, 0);
+    DecimalV2Arg rhs(context, args, 1);
+    const uint8_t* nulls = result->nulls();
+    int128_t* values = result->values<int128_t>();
+    for_each_selected_row(sel, n, [&](int i) {
+        if (nulls[i] == 0) {
+            values[i] = OP(lhs.get(i), rhs.get(i));
+        }
+    });
+}
+
+void DecimalV2Operators::add_batch(FunctionContext* context, ExprColumn* const* args,
+                                   const int* sel, int n, ExprColumn* result) {
+    decimalv2_op_batch<DecimalV2Kernels::add>(context, args, sel, n, result);
+}
+
+void DecimalV2Operators::subtract_batch(FunctionContext* context, ExprColumn* const* args,
+                                        const int* sel, int n, ExprColumn* result) {
+    decimalv2_op_batch<DecimalV2Kernels::subtract>(context, args, sel, n, result);
+}
+
+void DecimalV2Operators::multiply_batch(FunctionContext* context, ExprColumn* const* args,
+                                        const int* sel, int n, ExprColumn* result) {
+    decimalv2_op_batch<DecimalV2Kernels::multiply>(context, args, sel, n, result);
 }
 
+void DecimalV2Operators::divide_batch(FunctionContext* context, ExprColumn* const* args,
+                                      const int* sel, int n, ExprColumn* result) {
+    decimalv2_op_batch<DecimalV2Kernels::divide>(context, args, sel, n, result);
+}
+
+DecimalV2Operators::BatchFn DecimalV2Operators::get_batch_fn(
+        const std::string& name, int num_args) {
+    if (num_args != 2) {
+        return NULL;
+    }
+    if (name == "add") {
+        return add_batch;
+    }
+    if (name == "subtract") {
+        return subtract_batch;
+    }
+    if (name == "multiply") {
+        return multiply_batch;
+    }
+    if (name == "divide") {
+        return divide_batch;
+    }
+    return NULL;
+}
+
+}
@@ -19,12 +19,14 @@
 #define DORIS_BE_SRC_EXPRS_DECIMAL_OPERATORS_H
 
 #include <stdint.h>
+#include <string>
 #include "runtime/decimalv2_value.h"
 #include "udf/udf.h"
 
 namespace doris {
 
 class Expr;
+class ExprColumn;
 struct ExprValue;
 class TupleRow;
 
@@ -78,6 +80,26 @@ public:
         FunctionContext*, const DecimalV2Val&, const DecimalV2Val&);
     static BooleanVal le_decimalv2_val_decimalv2_val(
         FunctionContext*, const DecimalV2Val&, const DecimalV2Val&);
+
+    /// Batch versions of add, subtract, multiply and divide for
+    /// ScalarFnCall::evaluate_batch(), with the conventions of
+    /// StringBatchFunctions: constant arguments have NULL columns, rows with a
+    /// null argument are set null by the caller and skipped.
+    typedef void (*BatchFn)(FunctionContext* context, ExprColumn* const* args,
+                            const int* sel, int n, ExprColumn* result);
+
+    /// Returns the batch function of the operator 'name' on two decimalv2
+    /// values, NULL if there is none.
+    static BatchFn get_batch_fn(const std::string& name, int num_args);
+
+    static void add_batch(FunctionContext* context, ExprColumn* const* args,
+                          const int* sel, int n, ExprColumn* result);
+    static void subtract_batch(FunctionContext* context, ExprColumn* const* args,
+                               const int* sel, int n, ExprColumn* result);
+    static void multiply_batch(FunctionContext* context, ExprColumn* const* args,
+                               const int* sel, int n, ExprColumn* result);
+    static void divide_batch(FunctionContext* context, ExprColumn* const* args,
+                             const int* sel, int n, ExprColumn* result);
 };
 
 }
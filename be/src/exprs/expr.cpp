@@ -18,6 +18,7 @@
 #include "exprs/expr.h"
 
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 #include <thrift/protocol/TDebugProtocol.h>
 #include <llvm/Support/InstIterator.h>
@@ -48,6 +49,7 @@
 #include "gen_cpp/Data_types.h"
 #include "runtime/runtime_state.h"
 #include "runtime/raw_value.h"
+#include "runtime/row_batch.h"
 #include "runtime/user_function_cache.h"
 #include "util/debug_util.h"
 
@@ -632,6 +634,19 @@ Status Expr::clone_if_not_exists(
     for (int i = 0; i < ctxs.size(); ++i) {
         RETURN_IF_ERROR(ctxs[i]->clone(state, &(*new_ctxs)[i]));
     }
+    // the clones of contexts sharing subexprs share them as well
+    std::unordered_map<SubexprCache*, std::shared_ptr<SubexprCache>> caches;
+    for (int i = 0; i < ctxs.size(); ++i) {
+        if (ctxs[i]->_subexpr_cache == nullptr) {
+            continue;
+        }
+        std::shared_ptr<SubexprCache>& cache = caches[ctxs[i]->_subexpr_cache.get()];
+        if (cache == nullptr) {
+            cache = (*new_ctxs)[i]->_subexpr_cache;
+        } else {
+            (*new_ctxs)[i]->_subexpr_cache = cache;
+        }
+    }
     return Status::OK;
 }
 
@@ -864,6 +879,34 @@ Status Expr::get_fn_context_error(ExprContext* ctx) {
     return Status::OK;
 }
 
+void Expr::evaluate_batch(ExprContext* context, RowBatch* batch,
+                          const int* sel, int n, ExprColumn* result) {
+    result->reset(_type.type, batch->num_rows());
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        void* value = context->get_value(this, batch->get_row(i));
+        if (value == NULL) {
+            nulls[i] = 1;
+        } else {
+            result->set_value(i, value);
+        }
+    });
+}
+
+void Expr::evaluate_constant_batch(ExprContext* context, RowBatch* batch,
+                                   const int* sel, int n, ExprColumn* result) {
+    result->reset(_type.type, batch->num_rows());
+    void* value = context->get_value(this, NULL);
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        if (value == NULL) {
+            nulls[i] = 1;
+        } else {
+            result->set_value(i, value);
+        }
+    });
+}
+
 llvm::Function* Expr::create_ir_function_prototype(
         LlvmCodeGen* codegen, const std::string& name, llvm::Value* (*args)[2]) {
     llvm::Type* return_type = CodegenAnyVal::get_lowered_type(codegen, type());
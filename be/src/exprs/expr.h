@@ -55,6 +55,7 @@ namespace doris {
 class Expr;
 class LlvmCodeGen;
 class ObjectPool;
+class RowBatch;
 class RowDescriptor;
 class RuntimeState;
 class TColumnValue;
@@ -125,6 +126,15 @@ public:
     virtual DecimalVal get_decimal_val(ExprContext* context, TupleRow*);
     virtual DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*);
 
+    /// Evaluates this expr for rows 'sel[0]', ..., 'sel[n - 1]' of 'batch' (rows 0 to
+    /// n - 1 if 'sel' is NULL) and stores their values in 'result', which is reset for
+    /// the rows of the batch. See ExprContext::evaluate(). The default implementation
+    /// calls the Get*Val() function of the type for each row, or once if this expr
+    /// is constant. Subclasses override it to evaluate the rows in a loop over the
+    /// columns of their children.
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result);
+
     // Get the number of digits after the decimal that should be displayed for this
     // value. Returns -1 if no scale has been specified (currently the scale is only set for
     // doubles set by RoundUpTo). get_value() must have already been called.
@@ -336,6 +346,7 @@ protected:
     friend class JsonFunctions;
     friend class Literal;
     friend class ExprContext;
+    friend class FoldedConstant;
     friend class CompoundPredicate;
     friend class ScalarFnCall;
     friend class HllHashFunction;
@@ -464,6 +475,11 @@ protected:
     /// functions (e.g. in ScalarFnCall() when codegen is disabled).
     llvm::Function* get_static_get_val_wrapper(const TypeDescriptor& type, LlvmCodeGen* codegen);
 
+    /// Evaluates this constant expr once and stores its value for the rows of 'batch',
+    /// used by evaluate_batch() of literals.
+    void evaluate_constant_batch(ExprContext* context, RowBatch* batch,
+                                 const int* sel, int n, ExprColumn* result);
+
     /// Simple debug string that provides no expr subclass-specific information
     std::string debug_string(const std::string& expr_name) const {
         std::stringstream out;
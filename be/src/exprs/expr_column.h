@@ -0,0 +1,149 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_EXPRS_EXPR_COLUMN_H
+#define DORIS_BE_SRC_EXPRS_EXPR_COLUMN_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "runtime/primitive_type.h"
+#include "runtime/string_value.h"
+
+namespace doris {
+
+// The values of an expr for the rows of a batch, produced by
+// ExprContext::evaluate(). Values have the in-memory layout of the type, as in
+// tuples (StringValue for strings, DateTimeValue for dates), the value of row
+// i of the batch is at index i, so exprs evaluated on a part of the rows can
+// be combined with the other parts. Values and nulls of rows which were not
+// evaluated are undefined.
+class ExprColumn {
+public:
+    ExprColumn() : _type(INVALID_TYPE), _value_size(0), _num_rows(0),
+            _string_block_size(0), _string_block_used(0), _string_blocks_size(0),
+            _owns_string_data(false) { }
+
+    // Prepares for 'num_rows' values of 'type', all rows are not null.
+    void reset(PrimitiveType type, int num_rows) {
+        _type = type;
+        _value_size = get_slot_size(type);
+        _num_rows = num_rows;
+        _data.resize(static_cast<size_t>(_value_size) * num_rows);
+        _nulls.assign(num_rows, 0);
+        _reset_string_data();
+    }
+
+    PrimitiveType type() const { return _type; }
+    int value_size() const { return _value_size; }
+    int num_rows() const { return _num_rows; }
+
+    uint8_t* data() { return _data.data(); }
+
+    template <typename T>
+    T* values() {
+        return reinterpret_cast<T*>(_data.data());
+    }
+
+    void* value(int row) {
+        return _data.data() + static_cast<size_t>(_value_size) * row;
+    }
+
+    // one byte per row, not 0 if the value is null
+    uint8_t* nulls() { return _nulls.data(); }
+
+    bool is_null(int row) const { return _nulls[row] != 0; }
+
+    void set_value(int row, const void* value) {
+        memcpy(this->value(row), value, _value_size);
+    }
+
+    // Returns 'len' bytes for the string values built by batch functions,
+    // they are kept until the next reset(), so rows are not allocated one by
+    // one.
+    char* allocate_string_data(size_t len) {
+        if (_string_blocks.empty() || _string_block_used + len > _string_block_size) {
+            _add_string_block(len);
+        }
+        char* ptr = _string_blocks.back().get() + _string_block_used;
+        _string_block_used += len;
+        _owns_string_data = true;
+        return ptr;
+    }
+
+    // True if string values may point into this column, then they must be
+    // copied to outlive it.
+    bool owns_string_data() const { return _owns_string_data; }
+
+private:
+    void _reset_string_data() {
+        if (_string_blocks.size() > 1) {
+            // the next batch likely needs as much, in one block
+            _string_blocks.clear();
+            _string_blocks.emplace_back(new char[_string_blocks_size]);
+            _string_block_size = _string_blocks_size;
+        }
+        _string_block_used = 0;
+        _owns_string_data = false;
+    }
+
+    void _add_string_block(size_t len) {
+        size_t size = std::max(len, std::max<size_t>(_string_block_size * 2, 4096));
+        _string_blocks.emplace_back(new char[size]);
+        _string_block_size = size;
+        _string_block_used = 0;
+        _string_blocks_size += size;
+    }
+
+    PrimitiveType _type;
+    int _value_size;
+    int _num_rows;
+    // allocated by operator new, aligned for all slot types
+    std::vector<uint8_t> _data;
+    std::vector<uint8_t> _nulls;
+
+    std::vector<std::unique_ptr<char[]>> _string_blocks;
+    // size of the last block and bytes used in it
+    size_t _string_block_size;
+    size_t _string_block_used;
+    size_t _string_blocks_size;
+    bool _owns_string_data;
+};
+
+// Calls 'fn' with the index of each row in 'sel[0]', ..., 'sel[n - 1]', or in
+// 0, ..., n - 1 if 'sel' is NULL, which are the rows given to evaluate().
+template <typename Fn>
+inline void for_each_selected_row(const int* sel, int n, Fn fn) {
+    if (sel == NULL) {
+        for (int i = 0; i < n; ++i) {
+            fn(i);
+        }
+    } else {
+        for (int k = 0; k < n; ++k) {
+            fn(sel[k]);
+        }
+    }
+}
+
+}
+
+#endif
@@ -20,7 +20,10 @@
 #include <sstream>
 #include <gperftools/profiler.h>
 
+#include "common/config.h"
 #include "exprs/expr.h"
+#include "exprs/folded_constant.h"
+#include "exprs/shared_subexpr.h"
 #include "exprs/slot_ref.h"
 #include "runtime/mem_pool.h"
 #include "runtime/mem_tracker.h"
@@ -37,6 +40,7 @@ const char* ExprContext::_s_llvm_class_name = "class.doris::ExprContext";
 ExprContext::ExprContext(Expr* root) :
         _fn_contexts_ptr(NULL),
         _root(root),
+        _num_used_columns(0),
         _is_clone(false),
         _prepared(false),
         _opened(false),
@@ -72,7 +76,240 @@ Status ExprContext::open(RuntimeState* state) {
     // original's fragment state and only need to have thread-local state initialized.
     FunctionContext::FunctionStateScope scope =
         _is_clone? FunctionContext::THREAD_LOCAL : FunctionContext::FRAGMENT_LOCAL;
-    return _root->open(state, this, scope);
+    RETURN_IF_ERROR(_root->open(state, this, scope));
+    // the tree is shared with the clones, which are made after this
+    if (!_is_clone && config::enable_expr_constant_folding) {
+        RETURN_IF_ERROR(fold_constants(state, _root));
+    }
+    return Status::OK;
+}
+
+// True if the value of 'expr' is determined by the values of its children. For a
+// constant 'expr' this means it can be computed without a row.
+static bool is_deterministic_node(const Expr* expr) {
+    switch (expr->node_type()) {
+    case TExprNodeType::BOOL_LITERAL:
+    case TExprNodeType::INT_LITERAL:
+    case TExprNodeType::LARGE_INT_LITERAL:
+    case TExprNodeType::FLOAT_LITERAL:
+    case TExprNodeType::DECIMAL_LITERAL:
+    case TExprNodeType::DATE_LITERAL:
+    case TExprNodeType::STRING_LITERAL:
+    case TExprNodeType::NULL_LITERAL:
+    case TExprNodeType::SLOT_REF:
+    case TExprNodeType::ARITHMETIC_EXPR:
+    case TExprNodeType::BINARY_PRED:
+    case TExprNodeType::COMPOUND_PRED:
+    case TExprNodeType::CAST_EXPR:
+    case TExprNodeType::CASE_EXPR:
+    case TExprNodeType::IN_PRED:
+    case TExprNodeType::INFO_FUNC:
+        return true;
+    case TExprNodeType::FUNCTION_CALL:
+    case TExprNodeType::COMPUTE_FUNCTION_CALL:
+        return expr->fn().binary_type == TFunctionBinaryType::BUILTIN
+            && expr->fn().name.function_name != "rand"
+            && expr->fn().name.function_name != "random";
+    default:
+        return false;
+    }
+}
+
+static bool is_deterministic_tree(const Expr* expr) {
+    if (!is_deterministic_node(expr)) {
+        return false;
+    }
+    for (const Expr* child : expr->children()) {
+        if (!is_deterministic_tree(child)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_literal(const Expr* expr) {
+    switch (expr->node_type()) {
+    case TExprNodeType::BOOL_LITERAL:
+    case TExprNodeType::INT_LITERAL:
+    case TExprNodeType::LARGE_INT_LITERAL:
+    case TExprNodeType::FLOAT_LITERAL:
+    case TExprNodeType::DECIMAL_LITERAL:
+    case TExprNodeType::DATE_LITERAL:
+    case TExprNodeType::STRING_LITERAL:
+    case TExprNodeType::NULL_LITERAL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool can_fold(const Expr* expr) {
+    // the types Expr::get_const_val() computes values of
+    switch (expr->type().type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+    case TYPE_HLL:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_DECIMAL:
+    case TYPE_DECIMALV2:
+        break;
+    default:
+        return false;
+    }
+    return !is_literal(expr)
+        && dynamic_cast<const FoldedConstant*>(expr) == nullptr
+        && is_deterministic_tree(expr);
+}
+
+Status ExprContext::fold_constants(RuntimeState* state, Expr* expr) {
+    // 'expr' itself is kept, code inspecting the roots of contexts expects the original
+    // nodes
+    for (int i = 0; i < expr->_children.size(); ++i) {
+        Expr* child = expr->_children[i];
+        if (!child->is_constant()) {
+            RETURN_IF_ERROR(fold_constants(state, child));
+        } else if (can_fold(child)) {
+            RETURN_IF_ERROR(FoldedConstant::create(
+                    state->obj_pool(), this, child, &expr->_children[i]));
+        }
+    }
+    return Status::OK;
+}
+
+bool ExprContext::subexpr_key(Expr* expr, std::string* key,
+                              std::unordered_map<Expr*, std::string>* keys) {
+    std::string expr_key = expr->type().debug_string();
+    bool has_key = is_deterministic_node(expr)
+        && expr->node_type() != TExprNodeType::CASE_EXPR
+        && expr->node_type() != TExprNodeType::INFO_FUNC;
+    if (expr->is_slotref()) {
+        expr_key.append(":s").append(std::to_string(static_cast<SlotRef*>(expr)->slot_id()));
+    } else if (is_literal(expr) || dynamic_cast<FoldedConstant*>(expr) != nullptr) {
+        // the bytes of equal values are equal, the other way round is not needed
+        void* value = get_value(expr, nullptr);
+        expr_key.append(":c");
+        if (value == nullptr) {
+            expr_key.append("n");
+        } else if (expr->type().is_string_type()) {
+            const StringValue* sv = reinterpret_cast<const StringValue*>(value);
+            expr_key.append(std::to_string(sv->len)).append(":").append(sv->ptr, sv->len);
+        } else {
+            expr_key.append(reinterpret_cast<const char*>(value),
+                            expr->type().get_slot_size());
+        }
+        has_key = true;
+    } else {
+        expr_key.append(":").append(std::to_string(expr->node_type()))
+            .append(":").append(std::to_string(expr->op()));
+        if (expr->node_type() == TExprNodeType::FUNCTION_CALL
+                || expr->node_type() == TExprNodeType::COMPUTE_FUNCTION_CALL) {
+            expr_key.append(":").append(expr->fn().name.function_name);
+            if (expr->fn().__isset.scalar_fn) {
+                expr_key.append(":").append(expr->fn().scalar_fn.symbol);
+            }
+        }
+        expr_key.append("(");
+        // the keys of all children are recorded, even if this node gets none
+        for (Expr* child : expr->children()) {
+            std::string child_key;
+            has_key &= subexpr_key(child, &child_key, keys);
+            expr_key.append(std::to_string(child_key.size())).append(":").append(child_key);
+        }
+        expr_key.append(")");
+    }
+    if (!has_key) {
+        return false;
+    }
+    key->append(expr_key);
+    (*keys)[expr] = std::move(expr_key);
+    return true;
+}
+
+void ExprContext::wrap_shared_subexprs(ObjectPool* pool, Expr* expr,
+                                       const std::unordered_map<Expr*, std::string>& keys,
+                                       const std::unordered_map<std::string, int>& counts,
+                                       std::unordered_map<std::string, int>* entries) {
+    for (int i = 0; i < expr->_children.size(); ++i) {
+        Expr* child = expr->_children[i];
+        auto key = keys.find(child);
+        if (key != keys.end() && counts.at(key->second) > 1) {
+            // the subexprs of a shared subexpr are computed once as well
+            int idx = entries->emplace(key->second, entries->size()).first->second;
+            expr->_children[i] = pool->add(new SharedSubexpr(child, idx));
+        } else {
+            wrap_shared_subexprs(pool, child, keys, counts, entries);
+        }
+    }
+}
+
+Status ExprContext::share_subexprs(RuntimeState* state, const std::vector<ExprContext*>& ctxs) {
+    if (!config::enable_expr_subexpr_sharing) {
+        return Status::OK;
+    }
+    for (ExprContext* ctx : ctxs) {
+        DCHECK(ctx->_opened);
+        // clones get the values of their group from Expr::clone_if_not_exists()
+        if (ctx->_is_clone || ctx->_subexpr_cache != nullptr) {
+            return Status::OK;
+        }
+    }
+    std::unordered_map<Expr*, std::string> keys;
+    for (ExprContext* ctx : ctxs) {
+        std::string key;
+        ctx->subexpr_key(ctx->_root, &key, &keys);
+        // the roots are evaluated by their contexts
+        keys.erase(ctx->_root);
+    }
+    std::unordered_map<std::string, int> counts;
+    for (auto it = keys.begin(); it != keys.end();) {
+        // slots and constants are as cheap as a shared value
+        if (it->first->is_slotref() || it->first->is_constant()) {
+            it = keys.erase(it);
+        } else {
+            ++counts[it->second];
+            ++it;
+        }
+    }
+    std::unordered_map<std::string, int> entries;
+    for (ExprContext* ctx : ctxs) {
+        ctx->wrap_shared_subexprs(state->obj_pool(), ctx->_root, keys, counts, &entries);
+    }
+    if (entries.empty()) {
+        return Status::OK;
+    }
+    std::shared_ptr<SubexprCache> cache = std::make_shared<SubexprCache>(entries.size());
+    for (ExprContext* ctx : ctxs) {
+        ctx->_subexpr_cache = cache;
+    }
+    return Status::OK;
+}
+
+ExprContext::SubexprScope::SubexprScope(ExprContext* ctx)
+        : _cache(ctx != nullptr ? ctx->_subexpr_cache.get() : nullptr) {
+    if (_cache != nullptr) {
+        _cache->enter_scope();
+    }
+}
+
+ExprContext::SubexprScope::~SubexprScope() {
+    if (_cache != nullptr) {
+        _cache->leave_scope();
+    }
+}
+
+inline void ExprContext::start_evaluation() {
+    if (_subexpr_cache != nullptr) {
+        _subexpr_cache->start_evaluation();
+    }
 }
 
 // TODO chenhao , replace ExprContext with ScalarExprEvaluator 
@@ -123,6 +360,11 @@ Status ExprContext::clone(RuntimeState* state, ExprContext** new_ctx) {
     }
     (*new_ctx)->_fn_contexts_ptr = &((*new_ctx)->_fn_contexts[0]);
 
+    if (_subexpr_cache != nullptr) {
+        (*new_ctx)->_subexpr_cache =
+            std::make_shared<SubexprCache>(_subexpr_cache->num_entries());
+    }
+
     (*new_ctx)->_is_clone = true;
     (*new_ctx)->_prepared = true;
     (*new_ctx)->_opened = true;
@@ -143,6 +385,11 @@ Status ExprContext::clone(RuntimeState* state, ExprContext** new_ctx, Expr* root
     }
     (*new_ctx)->_fn_contexts_ptr = &((*new_ctx)->_fn_contexts[0]);
 
+    if (_subexpr_cache != nullptr) {
+        (*new_ctx)->_subexpr_cache =
+            std::make_shared<SubexprCache>(_subexpr_cache->num_entries());
+    }
+
     (*new_ctx)->_is_clone = true;
     (*new_ctx)->_prepared = true;
     (*new_ctx)->_opened = true;
@@ -249,6 +496,7 @@ void ExprContext::get_value(TupleRow* row, bool as_ascii, TColumnValue* col_val)
 }
 
 void* ExprContext::get_value(TupleRow* row) {
+    start_evaluation();
     if (_root->is_slotref()) {
         return SlotRef::get_value(_root, row);
     }
@@ -262,6 +510,14 @@ bool ExprContext::is_nullable() {
     return false;
 }
 
+Status ExprContext::evaluate(RowBatch* batch, const int* sel, int n, ExprColumn* result) {
+    DCHECK(_opened);
+    DCHECK_EQ(_num_used_columns, 0);
+    start_evaluation();
+    _root->evaluate_batch(this, batch, sel, n, result);
+    return get_error(0, -1);
+}
+
 void* ExprContext::get_value(Expr* e, TupleRow* row) {
     switch (e->_type.type) {
     case TYPE_NULL: {
@@ -415,34 +671,42 @@ void ExprContext::print_value(TupleRow* row, std::stringstream* stream) {
 }
 
 BooleanVal ExprContext::get_boolean_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_boolean_val(this, row);
 }
 
 TinyIntVal ExprContext::get_tiny_int_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_tiny_int_val(this, row);
 }
 
 SmallIntVal ExprContext::get_small_int_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_small_int_val(this, row);
 }
 
 IntVal ExprContext::get_int_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_int_val(this, row);
 }
 
 BigIntVal ExprContext::get_big_int_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_big_int_val(this, row);
 }
 
 FloatVal ExprContext::get_float_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_float_val(this, row);
 }
 
 DoubleVal ExprContext::get_double_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_double_val(this, row);
 }
 
 StringVal ExprContext::get_string_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_string_val(this, row);
 }
 
@@ -452,14 +716,17 @@ StringVal ExprContext::get_string_val(TupleRow* row) {
 // }
 
 DateTimeVal ExprContext::get_datetime_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_datetime_val(this, row);
 }
 
 DecimalVal ExprContext::get_decimal_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_decimal_val(this, row);
 }
 
 DecimalV2Val ExprContext::get_decimalv2_val(TupleRow* row) {
+    start_evaluation();
     return _root->get_decimalv2_val(this, row);
 }
 
@@ -19,8 +19,12 @@
 #define DORIS_BE_SRC_QUERY_EXPRS_EXPR_CONTEXT_H
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "common/status.h"
+#include "exprs/expr_column.h"
 #include "exprs/expr_value.h"
 #include "udf/udf.h"
 #include "udf/udf_internal.h" // for ArrayVal
@@ -35,8 +39,11 @@ namespace doris {
 class Expr;
 class MemPool;
 class MemTracker;
+class ObjectPool;
 class RuntimeState;
+class RowBatch;
 class RowDescriptor;
+class SubexprCache;
 class TColumnValue;
 class TupleRow;
 
@@ -72,6 +79,25 @@ public:
 
     Status clone(RuntimeState* state, ExprContext** new_ctx, Expr* root);
 
+    /// Lets the expr trees of 'ctxs', which must be opened originals, compute the
+    /// subexprs which occur in several of them or several times in one once per row:
+    /// they are replaced by SharedSubexprs keeping the values. Clones of the contexts
+    /// made by Expr::clone_if_not_exists() share the values in the same way. All
+    /// contexts of a group must be evaluated by one thread.
+    static Status share_subexprs(RuntimeState* state, const std::vector<ExprContext*>& ctxs);
+
+    /// Evaluations of the contexts sharing subexprs with 'ctx' during the lifetime of a
+    /// SubexprScope share the values of one row, e.g. the conjuncts of a node evaluated
+    /// for a row. Without a scope every evaluation computes them anew.
+    class SubexprScope {
+    public:
+        explicit SubexprScope(ExprContext* ctx);
+        ~SubexprScope();
+
+    private:
+        SubexprCache* _cache;
+    };
+
     /// Closes all FunctionContexts. Must be called on every ExprContext, including clones.
     void close(RuntimeState* state);
 
@@ -96,6 +122,28 @@ public:
     /// requires timestamp in a string format.
     void get_value(TupleRow* row, bool as_ascii, TColumnValue* col_val);
 
+    /// Evaluates the expr tree for rows 'sel[0]', ..., 'sel[n - 1]' of 'batch' at once
+    /// and stores their values in 'result', see ExprColumn. If 'sel' is NULL rows 0 to
+    /// n - 1 are evaluated. Exprs without a batch implementation are evaluated row by
+    /// row, so this works for all expr trees. Strings in 'result' are valid as long as
+    /// the batch and the local allocations of this context.
+    Status evaluate(RowBatch* batch, const int* sel, int n, ExprColumn* result);
+
+    /// Columns for the values of children during evaluate(). They are released in the
+    /// reverse order of acquisition. This should only be called by Exprs.
+    ExprColumn* acquire_column() {
+        if (_num_used_columns == _columns.size()) {
+            _columns.emplace_back(new ExprColumn());
+        }
+        return _columns[_num_used_columns++].get();
+    }
+
+    void release_column(ExprColumn* column) {
+        DCHECK_GT(_num_used_columns, 0);
+        DCHECK_EQ(column, _columns[_num_used_columns - 1].get());
+        --_num_used_columns;
+    }
+
     /// Convenience functions: print value into 'str' or 'stream'.  NULL turns into "NULL".
     void print_value(TupleRow* row, std::string* str);
     void print_value(void* value, std::string* str);
@@ -119,6 +167,12 @@ public:
         return _fn_contexts[i];
     }
 
+    /// The values of the subexprs shared with other contexts, NULL if there are none.
+    /// This should only be called by Exprs.
+    SubexprCache* subexpr_cache() {
+        return _subexpr_cache.get();
+    }
+
     Expr* root() { 
         return _root; 
     }
@@ -197,6 +251,14 @@ private:
     /// void*.
     ExprValue _result;
 
+    /// Columns for the values of children during evaluate(), the first
+    /// '_num_used_columns' of them are in use.
+    std::vector<std::unique_ptr<ExprColumn>> _columns;
+    size_t _num_used_columns;
+
+    /// Values of the subexprs shared by the group of this context, see share_subexprs().
+    std::shared_ptr<SubexprCache> _subexpr_cache;
+
     /// True if this context came from a Clone() call. Used to manage FunctionStateScope.
     bool _is_clone;
 
@@ -208,6 +270,26 @@ private:
     /// Calls the appropriate Get*Val() function on 'e' and stores the result in result_.
     /// This is used by Exprs to call GetValue() on a child expr, rather than root_.
     void* get_value(Expr* e, TupleRow* row);
+
+    /// Called when an evaluation of the tree starts, the values of shared subexprs
+    /// computed so far are for other rows.
+    void start_evaluation();
+
+    /// Replaces the largest constant subtrees below 'expr' by FoldedConstants.
+    Status fold_constants(RuntimeState* state, Expr* expr);
+
+    /// Appends a key of 'expr' to 'key' and records the keys of all nodes of its tree
+    /// in 'keys', exprs with equal keys have the same value for a row. Returns false if
+    /// 'expr' gets no key.
+    bool subexpr_key(Expr* expr, std::string* key,
+                     std::unordered_map<Expr*, std::string>* keys);
+
+    /// Replaces the nodes below 'expr' whose key occurs more than once in 'counts' by
+    /// SharedSubexprs. 'entries' maps the keys to their entries in the SubexprCache.
+    void wrap_shared_subexprs(ObjectPool* pool, Expr* expr,
+                              const std::unordered_map<Expr*, std::string>& keys,
+                              const std::unordered_map<std::string, int>& counts,
+                              std::unordered_map<std::string, int>* entries);
 };
 
 }
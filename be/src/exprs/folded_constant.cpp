@@ -0,0 +1,109 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exprs/folded_constant.h"
+
+#include "exprs/expr_context.h"
+
+namespace doris {
+
+FoldedConstant::FoldedConstant(Expr* child) : Expr(*child) {
+    // the cache entry of a function is released by the child
+    _cache_entry = nullptr;
+    _ir_compute_fn = nullptr;
+    add_child(child);
+}
+
+Status FoldedConstant::create(ObjectPool* pool, ExprContext* ctx, Expr* child, Expr** expr) {
+    DCHECK(child->is_constant());
+    AnyVal* val = child->get_const_val(ctx);
+    RETURN_IF_ERROR(ctx->get_error(child->_fn_ctx_idx_start, child->_fn_ctx_idx_end));
+    FoldedConstant* folded = pool->add(new FoldedConstant(child));
+    if (child->type().is_string_type()) {
+        // the child's value lives in the local allocations of 'ctx'
+        StringVal* sv = new StringVal(*reinterpret_cast<StringVal*>(val));
+        folded->_constant_val.reset(sv);
+        if (!sv->is_null) {
+            folded->_string_data.reset(
+                new std::string(reinterpret_cast<const char*>(sv->ptr), sv->len));
+            sv->ptr = reinterpret_cast<uint8_t*>(&(*folded->_string_data)[0]);
+        }
+    } else {
+        folded->_constant_val = child->_constant_val;
+    }
+    *expr = folded;
+    return Status::OK;
+}
+
+Status FoldedConstant::get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) {
+    return _children[0]->get_codegend_compute_fn(state, fn);
+}
+
+BooleanVal FoldedConstant::get_boolean_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<BooleanVal*>(_constant_val.get());
+}
+
+TinyIntVal FoldedConstant::get_tiny_int_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<TinyIntVal*>(_constant_val.get());
+}
+
+SmallIntVal FoldedConstant::get_small_int_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<SmallIntVal*>(_constant_val.get());
+}
+
+IntVal FoldedConstant::get_int_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<IntVal*>(_constant_val.get());
+}
+
+BigIntVal FoldedConstant::get_big_int_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<BigIntVal*>(_constant_val.get());
+}
+
+LargeIntVal FoldedConstant::get_large_int_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<LargeIntVal*>(_constant_val.get());
+}
+
+FloatVal FoldedConstant::get_float_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<FloatVal*>(_constant_val.get());
+}
+
+DoubleVal FoldedConstant::get_double_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<DoubleVal*>(_constant_val.get());
+}
+
+StringVal FoldedConstant::get_string_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<StringVal*>(_constant_val.get());
+}
+
+DateTimeVal FoldedConstant::get_datetime_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<DateTimeVal*>(_constant_val.get());
+}
+
+DecimalVal FoldedConstant::get_decimal_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<DecimalVal*>(_constant_val.get());
+}
+
+DecimalV2Val FoldedConstant::get_decimalv2_val(ExprContext* context, TupleRow* row) {
+    return *reinterpret_cast<DecimalV2Val*>(_constant_val.get());
+}
+
+std::string FoldedConstant::debug_string() const {
+    return Expr::debug_string("FoldedConstant");
+}
+
+}
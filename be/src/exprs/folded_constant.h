@@ -0,0 +1,81 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_QUERY_EXPRS_FOLDED_CONSTANT_H
+#define DORIS_BE_SRC_QUERY_EXPRS_FOLDED_CONSTANT_H
+
+#include <memory>
+#include <string>
+
+#include "common/object_pool.h"
+#include "exprs/expr.h"
+
+namespace doris {
+
+// Replaces a constant subtree of an expr tree, whose value it computes once when the
+// tree is opened, see ExprContext::open(). The subtree stays the only child, so it is
+// still prepared, opened and closed with the tree. The node takes the node type and
+// opcode of the subtree, so code inspecting the tree, e.g. the push down of
+// predicates, sees no difference.
+class FoldedConstant : public Expr {
+public:
+    // Evaluates the constant 'child' with 'ctx', which must be opened, and returns the
+    // node replacing it in '*expr'.
+    static Status create(ObjectPool* pool, ExprContext* ctx, Expr* child, Expr** expr);
+
+    virtual Expr* clone(ObjectPool* pool) const override {
+        return pool->add(new FoldedConstant(*this));
+    }
+
+    virtual bool is_constant() const override {
+        return true;
+    }
+
+    virtual Status get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) override;
+
+    virtual BooleanVal get_boolean_val(ExprContext* context, TupleRow*) override;
+    virtual TinyIntVal get_tiny_int_val(ExprContext* context, TupleRow*) override;
+    virtual SmallIntVal get_small_int_val(ExprContext* context, TupleRow*) override;
+    virtual IntVal get_int_val(ExprContext* context, TupleRow*) override;
+    virtual BigIntVal get_big_int_val(ExprContext* context, TupleRow*) override;
+    virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*) override;
+    virtual FloatVal get_float_val(ExprContext* context, TupleRow*) override;
+    virtual DoubleVal get_double_val(ExprContext* context, TupleRow*) override;
+    virtual StringVal get_string_val(ExprContext* context, TupleRow*) override;
+    virtual DateTimeVal get_datetime_val(ExprContext* context, TupleRow*) override;
+    virtual DecimalVal get_decimal_val(ExprContext* context, TupleRow*) override;
+    virtual DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*) override;
+
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override {
+        evaluate_constant_batch(context, batch, sel, n, result);
+    }
+
+    virtual std::string debug_string() const override;
+
+private:
+    FoldedConstant(Expr* child);
+
+    // Bytes of a string value, '_constant_val' points to them. Shared by the clones
+    // like '_constant_val'.
+    std::shared_ptr<std::string> _string_data;
+};
+
+}
+
+#endif
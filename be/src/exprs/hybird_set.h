@@ -18,12 +18,18 @@
 #ifndef DORIS_BE_SRC_QUERY_EXPRS_HYBIRD_SET_H
 #define DORIS_BE_SRC_QUERY_EXPRS_HYBIRD_SET_H
 
+#include <algorithm>
 #include <cstring>
-#include <unordered_set>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "common/status.h"
 #include "common/object_pool.h"
+#include "exprs/expr_column.h"
 #include "runtime/primitive_type.h"
-#include "runtime/string_value.h"
+#include "runtime/string_value.hpp"
 #include "runtime/datetime_value.h"
 #include "runtime/decimal_value.h"
 #include "runtime/decimalv2_value.h"
@@ -43,6 +49,11 @@ public:
     virtual int size() = 0;
     virtual bool find(void* data) = 0;
 
+    // Sets results[i] to whether values[i] is in the set for the rows 'sel'
+    // of a batch, as for_each_selected_row(). 'values' are in the slot layout
+    // of the type, as in ExprColumn, the results of other rows are unchanged.
+    virtual void find_batch(const void* values, const int* sel, int n, bool* results) = 0;
+
     static HybirdSetBase* create_set(PrimitiveType type);
     class IteratorBase {
     public:
@@ -58,6 +69,105 @@ public:
     virtual IteratorBase* begin() = 0;
 };
 
+// Values of a set are kept in insertion order in one array. IN lists are
+// mostly short, up to LINEAR_SEARCH_SIZE values are compared all without
+// branches, which the compiler turns into SIMD compares for numbers. Larger
+// sets are indexed by an open addressing table with linear probing.
+template <class T, class Hash = std::hash<T>, class Equal = std::equal_to<T>>
+class FlatValueSet {
+public:
+    static const size_t LINEAR_SEARCH_SIZE = 16;
+
+    // Returns false if 'value' was in the set.
+    bool insert(const T& value) {
+        if (find(value)) {
+            return false;
+        }
+        _values.push_back(value);
+        if (_values.size() > LINEAR_SEARCH_SIZE) {
+            if (_values.size() * 2 > _table.size()) {
+                // at most half of the slots are used
+                _rehash(std::max<size_t>(_table.size() * 2, 4 * LINEAR_SEARCH_SIZE));
+            } else {
+                _insert_index(_values.size() - 1);
+            }
+        }
+        return true;
+    }
+
+    bool find(const T& value) const {
+        if (_table.empty()) {
+            bool found = false;
+            for (const T& v : _values) {
+                found |= Equal()(v, value);
+            }
+            return found;
+        }
+        size_t mask = _table.size() - 1;
+        for (size_t pos = _hash(value) & mask; ; pos = (pos + 1) & mask) {
+            int32_t index = _table[pos];
+            if (index == 0) {
+                return false;
+            }
+            if (Equal()(_values[index - 1], value)) {
+                return true;
+            }
+        }
+    }
+
+    void find_batch(const T* values, const int* sel, int n, bool* results) const {
+        if (_table.empty() && sel == NULL) {
+            // one pass over the rows for each value of the set, so the rows
+            // are compared several at a time
+            memset(results, 0, sizeof(bool) * n);
+            for (const T& v : _values) {
+                for (int i = 0; i < n; ++i) {
+                    results[i] |= Equal()(values[i], v);
+                }
+            }
+            return;
+        }
+        for_each_selected_row(sel, n, [&](int i) { results[i] = find(values[i]); });
+    }
+
+    size_t size() const { return _values.size(); }
+
+    const std::vector<T>& values() const { return _values; }
+
+private:
+    static size_t _hash(const T& value) {
+        // the finalizer of murmur3, std::hash of integers is the value itself
+        uint64_t h = Hash()(value);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    void _rehash(size_t capacity) {
+        _table.assign(capacity, 0);
+        for (size_t i = 0; i < _values.size(); ++i) {
+            _insert_index(i);
+        }
+    }
+
+    void _insert_index(size_t index) {
+        size_t mask = _table.size() - 1;
+        size_t pos = _hash(_values[index]) & mask;
+        while (_table[pos] != 0) {
+            pos = (pos + 1) & mask;
+        }
+        _table[pos] = index + 1;
+    }
+
+    std::vector<T> _values;
+    // index + 1 of the value in _values, 0 if the slot is empty, the size is
+    // a power of 2. Empty while the values are searched linearly.
+    std::vector<int32_t> _table;
+};
+
 template<class T>
 class HybirdSet : public HybirdSetBase {
 public:
@@ -80,30 +190,32 @@ public:
 
     virtual void insert(HybirdSetBase* set) {
         HybirdSet<T>* hybird_set = reinterpret_cast<HybirdSet<T>*>(set);
-        _set.insert(hybird_set->_set.begin(), hybird_set->_set.end());
+        for (const T& value : hybird_set->_set.values()) {
+            _set.insert(value);
+        }
     }
 
     virtual int size() {
         return _set.size();
     }
-    virtual bool find(void* data) {
-        typename std::unordered_set<T>::const_iterator it 
-                = _set.find(*reinterpret_cast<T*>(data));
 
-        if (it == _set.end()) {
-            return false;
-        } else {
-            return true;
+    virtual bool find(void* data) {
+        if (sizeof(T) >= 16) {
+            T value;
+            memcpy(&value, data, sizeof(T));
+            return _set.find(value);
         }
+        return _set.find(*reinterpret_cast<T*>(data));
+    }
 
-        return false;
+    virtual void find_batch(const void* values, const int* sel, int n, bool* results) {
+        _set.find_batch(reinterpret_cast<const T*>(values), sel, n, results);
     }
 
-    template <class _iT>
     class Iterator : public IteratorBase {
     public:
-        Iterator(typename std::unordered_set<_iT>::iterator begin,
-                 typename std::unordered_set<_iT>::iterator end)
+        Iterator(typename std::vector<T>::const_iterator begin,
+                 typename std::vector<T>::const_iterator end)
             : _begin(begin),
               _end(end) {
         }
@@ -113,26 +225,28 @@ public:
             return !(_begin == _end);
         }
         virtual const void* get_value() {
-            return _begin.operator->();
+            return &*_begin;
         }
         virtual void next() {
             ++_begin;
         }
     private:
-        typename std::unordered_set<_iT>::iterator _begin;
-        typename std::unordered_set<_iT>::iterator _end;
+        typename std::vector<T>::const_iterator _begin;
+        typename std::vector<T>::const_iterator _end;
     };
 
     IteratorBase* begin() {
-        return _pool.add(new(std::nothrow) Iterator<T>(_set.begin(), _set.end()));
+        return _pool.add(new(std::nothrow) Iterator(_set.values().begin(), _set.values().end()));
     }
 
 private:
  
-    std::unordered_set<T> _set;
+    FlatValueSet<T> _set;
     ObjectPool _pool;
 };
 
+// Strings are copied into the set, which keeps StringValues of the copies, so
+// they are found without building a std::string for every probe.
 class StringValueSet : public HybirdSetBase {
 public:
     StringValueSet() {
@@ -143,36 +257,38 @@ public:
 
     virtual void insert(void* data) {
         StringValue* value = reinterpret_cast<StringValue*>(data);
-        std::string str_value(value->ptr, value->len);
-        _set.insert(str_value);
+        if (_set.find(*value)) {
+            return;
+        }
+        // strings in a deque are not moved when it grows
+        _strings.emplace_back(value->ptr, value->len);
+        std::string& str = _strings.back();
+        _set.insert(StringValue(const_cast<char*>(str.data()), str.size()));
     }
 
     void insert(HybirdSetBase* set) {
         StringValueSet* string_set =  reinterpret_cast<StringValueSet*>(set);
-        _set.insert(string_set->_set.begin(), string_set->_set.end());
+        for (const StringValue& value : string_set->_set.values()) {
+            insert(const_cast<StringValue*>(&value));
+        }
     }
 
     virtual int size() {
         return _set.size();
     }
-    virtual bool find(void* data) {
-        StringValue* value = reinterpret_cast<StringValue*>(data);
-        std::string str_value(value->ptr, value->len);
-        typename std::unordered_set<std::string>::iterator it = _set.find(str_value);
 
-        if (it == _set.end()) {
-            return false;
-        } else {
-            return true;
-        }
+    virtual bool find(void* data) {
+        return _set.find(*reinterpret_cast<StringValue*>(data));
+    }
 
-        return false;
+    virtual void find_batch(const void* values, const int* sel, int n, bool* results) {
+        _set.find_batch(reinterpret_cast<const StringValue*>(values), sel, n, results);
     }
 
     class Iterator : public IteratorBase {
     public:
-        Iterator(std::unordered_set<std::string>::iterator begin,
-                 std::unordered_set<std::string>::iterator end)
+        Iterator(std::vector<StringValue>::const_iterator begin,
+                 std::vector<StringValue>::const_iterator end)
             : _begin(begin),
               _end(end) {
         }
@@ -182,26 +298,35 @@ public:
             return !(_begin == _end);
         }
         virtual const void* get_value() {
-            _value.ptr = const_cast<char*>(_begin->data());
-            _value.len = _begin->length();
-            return &_value;
+            return &*_begin;
         }
         virtual void next() {
             ++_begin;
         }
     private:
-        typename std::unordered_set<std::string>::iterator _begin;
-        typename std::unordered_set<std::string>::iterator _end;
-        StringValue _value;
+        std::vector<StringValue>::const_iterator _begin;
+        std::vector<StringValue>::const_iterator _end;
     };
 
     IteratorBase* begin() {
-        return _pool.add(new(std::nothrow) Iterator(_set.begin(), _set.end()));
+        return _pool.add(new(std::nothrow) Iterator(_set.values().begin(), _set.values().end()));
     }
 
 private:
+    struct Hash {
+        size_t operator()(const StringValue& value) const {
+            return HashUtil::hash(value.ptr, value.len, 0);
+        }
+    };
+
+    struct Equal {
+        bool operator()(const StringValue& a, const StringValue& b) const {
+            return a.eq(b);
+        }
+    };
 
-    std::unordered_set<std::string> _set;
+    FlatValueSet<StringValue, Hash, Equal> _set;
+    std::deque<std::string> _strings;
     ObjectPool _pool;
 };
 
@@ -18,11 +18,13 @@
 #include "exprs/in_predicate.h"
 
 #include <sstream>
+#include <vector>
 
 #include "exprs/anyval_util.h"
 #include "exprs/anyval_util.h"
 #include "codegen/llvm_codegen.h"
 #include "runtime/raw_value.h"
+#include "runtime/row_batch.h"
 #include "runtime/string_value.hpp"
 #include "runtime/runtime_state.h"
 
@@ -139,4 +141,41 @@ BooleanVal InPredicate::get_boolean_val(ExprContext* ctx, TupleRow* row) {
     return BooleanVal(_is_not_in);
 }
 
+void InPredicate::evaluate_batch(ExprContext* context, RowBatch* batch,
+                                 const int* sel, int n, ExprColumn* result) {
+    ExprColumn* values = context->acquire_column();
+    _children[0]->evaluate_batch(context, batch, sel, n, values);
+    result->reset(TYPE_BOOLEAN, batch->num_rows());
+    bool* found = result->values<bool>();
+    uint8_t* nulls = result->nulls();
+    if (_null_in_set) {
+        for_each_selected_row(sel, n, [&](int i) { nulls[i] = 1; });
+        context->release_column(values);
+        return;
+    }
+    // values of null rows are undefined, strings in them must not be read
+    const int* probe_sel = sel;
+    int num_probes = n;
+    std::vector<int> not_null_rows;
+    bool has_null = false;
+    for_each_selected_row(sel, n, [&](int i) { has_null |= values->is_null(i); });
+    if (has_null) {
+        not_null_rows.reserve(n);
+        for_each_selected_row(sel, n, [&](int i) {
+            if (values->is_null(i)) {
+                nulls[i] = 1;
+            } else {
+                not_null_rows.push_back(i);
+            }
+        });
+        probe_sel = not_null_rows.data();
+        num_probes = not_null_rows.size();
+    }
+    _hybird_set->find_batch(values->data(), probe_sel, num_probes, found);
+    if (_is_not_in) {
+        for_each_selected_row(probe_sel, num_probes, [&](int i) { found[i] = !found[i]; });
+    }
+    context->release_column(values);
+}
+
 }
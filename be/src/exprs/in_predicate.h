@@ -47,6 +47,10 @@ public:
 
     virtual BooleanVal get_boolean_val(ExprContext* context, TupleRow* row);
 
+    // looks up the values of the first child for all rows
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
+
     virtual Status get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) override {
         return get_codegend_compute_fn_wrapper(state, fn);
     }
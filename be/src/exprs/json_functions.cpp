@@ -18,6 +18,7 @@
 #include "exprs/json_functions.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 
 #include <sstream>
@@ -53,11 +54,10 @@ IntVal JsonFunctions::get_json_int(
     if (json_str.is_null || path.is_null) {
         return IntVal::null();
     }
-    std::string json_string((char*)json_str.ptr, json_str.len);
     std::string path_string((char*)path.ptr, path.len);
     rapidjson::Document document;
-    rapidjson::Value* root =
-        get_json_object(context, json_string, path_string, JSON_FUN_INT, &document);
+    rapidjson::Value* root = find_json_object(context, (char*)json_str.ptr, json_str.len,
+                                              path_string, JSON_FUN_INT, &document);
     if (root->IsInt()) {
         return IntVal(root->GetInt());
     } else {
@@ -71,11 +71,10 @@ StringVal JsonFunctions::get_json_string(
         return StringVal::null();
     }
 
-    std::string json_string((char*)json_str.ptr, json_str.len);
     std::string path_string((char*)path.ptr, path.len);
     rapidjson::Document document;
-    rapidjson::Value* root =
-        get_json_object(context, json_string, path_string, JSON_FUN_STRING, &document);
+    rapidjson::Value* root = find_json_object(context, (char*)json_str.ptr, json_str.len,
+                                              path_string, JSON_FUN_STRING, &document);
     if (root->IsNull()) {
         return StringVal::null();
     } else if (root->IsString()) {
@@ -93,11 +92,10 @@ DoubleVal JsonFunctions::get_json_double(
     if (json_str.is_null || path.is_null) {
         return DoubleVal::null();
     }
-    std::string json_string((char*)json_str.ptr, json_str.len);
     std::string path_string((char*)path.ptr, path.len);
     rapidjson::Document document;
-    rapidjson::Value* root =
-        get_json_object(context, json_string, path_string, JSON_FUN_DOUBLE, &document);
+    rapidjson::Value* root = find_json_object(context, (char*)json_str.ptr, json_str.len,
+                                              path_string, JSON_FUN_DOUBLE, &document);
     if (root->IsInt()) {
         return DoubleVal(static_cast<double>(root->GetInt()));
     } else if (root->IsDouble()) {
@@ -113,28 +111,9 @@ rapidjson::Value* JsonFunctions::get_json_object(
         const std::string& path_string,
         const JsonFunctionType& fntype,
         rapidjson::Document* document) {
-
-    // split path by ".", and escape quota by "\"
-    // eg:
-    //    '$.text#abc.xyz'  ->  [$, text#abc, xyz]
-    //    '$."text.abc".xyz'  ->  [$, text.abc, xyz]
-    //    '$."text.abc"[1].xyz'  ->  [$, text.abc[1], xyz]
-    std::vector<JsonPath>* parsed_paths;
     std::vector<JsonPath> tmp_parsed_paths;
-#ifndef BE_TEST
-    parsed_paths = reinterpret_cast<std::vector<JsonPath>*>(context->get_function_state(FunctionContext::FRAGMENT_LOCAL));
-    if (parsed_paths == nullptr) {
-        boost::tokenizer<boost::escaped_list_separator<char> > tok(path_string, boost::escaped_list_separator<char>("\\", ".", "\""));
-        std::vector<std::string> paths(tok.begin(), tok.end());
-        get_parsed_paths(paths, &tmp_parsed_paths);
-        parsed_paths = &tmp_parsed_paths;
-    }
-#else
-    boost::tokenizer<boost::escaped_list_separator<char> > tok(path_string, boost::escaped_list_separator<char>("\\", ".", "\""));
-    std::vector<std::string> paths(tok.begin(), tok.end());
-    get_parsed_paths(paths, &tmp_parsed_paths);
-    parsed_paths = &tmp_parsed_paths;
-#endif
+    const std::vector<JsonPath>* parsed_paths =
+        get_or_parse_paths(context, path_string, &tmp_parsed_paths);
 
     VLOG(10) << "first parsed path: " << (*parsed_paths)[0].debug_string();
 
@@ -172,7 +151,7 @@ rapidjson::Value* JsonFunctions::get_json_object(
             root->SetNull();
         }
 
-        std::string& col = (*parsed_paths)[i].key;
+        const std::string& col = (*parsed_paths)[i].key;
         int index = (*parsed_paths)[i].idx;
         if (LIKELY(!col.empty())) {
             if (root->IsArray()) {
@@ -236,6 +215,229 @@ rapidjson::Value* JsonFunctions::get_json_object(
      return root;
 }
 
+const std::vector<JsonPath>* JsonFunctions::get_or_parse_paths(
+        FunctionContext* context, const std::string& path_string,
+        std::vector<JsonPath>* tmp_parsed_paths) {
+    // split path by ".", and escape quota by "\"
+    // eg:
+    //    '$.text#abc.xyz'  ->  [$, text#abc, xyz]
+    //    '$."text.abc".xyz'  ->  [$, text.abc, xyz]
+    //    '$."text.abc"[1].xyz'  ->  [$, text.abc[1], xyz]
+#ifndef BE_TEST
+    std::vector<JsonPath>* parsed_paths = reinterpret_cast<std::vector<JsonPath>*>(
+        context->get_function_state(FunctionContext::FRAGMENT_LOCAL));
+    if (parsed_paths != nullptr) {
+        return parsed_paths;
+    }
+#endif
+    boost::tokenizer<boost::escaped_list_separator<char> > tok(path_string, boost::escaped_list_separator<char>("\\", ".", "\""));
+    std::vector<std::string> paths(tok.begin(), tok.end());
+    get_parsed_paths(paths, tmp_parsed_paths);
+    return tmp_parsed_paths;
+}
+
+enum JsonPathResult {
+    JSON_PATH_FOUND,
+    // the value is null, also if the JSON text is found to be invalid
+    JSON_PATH_NOT_FOUND,
+    // the path must be evaluated on a document
+    JSON_PATH_UNSUPPORTED
+};
+
+static const char* skip_json_space(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+// 'p' is at the opening quote, returns the position after the closing one, NULL if
+// the string is not closed.
+static const char* skip_json_string(const char* p, const char* end) {
+    for (++p; p < end; ++p) {
+        if (*p == '\\') {
+            ++p;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return NULL;
+}
+
+// Returns the position after the value at 'p', NULL if it is not closed. Objects
+// and arrays are skipped by counting their brackets, their values aren't checked.
+static const char* skip_json_value(const char* p, const char* end) {
+    if (p == end) {
+        return NULL;
+    }
+    if (*p == '"') {
+        return skip_json_string(p, end);
+    }
+    if (*p != '{' && *p != '[') {
+        const char* begin = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' '
+                && *p != '\t' && *p != '\n' && *p != '\r') {
+            ++p;
+        }
+        return p == begin ? NULL : p;
+    }
+    int depth = 0;
+    while (p < end) {
+        if (*p == '"') {
+            p = skip_json_string(p, end);
+            if (p == NULL) {
+                return NULL;
+            }
+            continue;
+        }
+        if (*p == '{' || *p == '[') {
+            ++depth;
+        } else if (*p == '}' || *p == ']') {
+            if (--depth == 0) {
+                return p + 1;
+            }
+        }
+        ++p;
+    }
+    return NULL;
+}
+
+// Moves 'p' from the object at it to the value of its first member named 'key'.
+static JsonPathResult find_json_member(const char** p, const char* end,
+                                       const std::string& key) {
+    const char* ptr = skip_json_space(*p + 1, end);
+    if (ptr < end && *ptr == '}') {
+        return JSON_PATH_NOT_FOUND;
+    }
+    while (ptr < end && *ptr == '"') {
+        const char* name = ptr + 1;
+        ptr = skip_json_string(ptr, end);
+        if (ptr == NULL) {
+            return JSON_PATH_NOT_FOUND;
+        }
+        size_t name_len = ptr - 1 - name;
+        if (memchr(name, '\\', name_len) != NULL) {
+            // names are compared unescaped
+            return JSON_PATH_UNSUPPORTED;
+        }
+        ptr = skip_json_space(ptr, end);
+        if (ptr == end || *ptr != ':') {
+            return JSON_PATH_NOT_FOUND;
+        }
+        ptr = skip_json_space(ptr + 1, end);
+        if (name_len == key.size() && memcmp(name, key.data(), name_len) == 0) {
+            *p = ptr;
+            return JSON_PATH_FOUND;
+        }
+        ptr = skip_json_value(ptr, end);
+        if (ptr == NULL) {
+            return JSON_PATH_NOT_FOUND;
+        }
+        ptr = skip_json_space(ptr, end);
+        if (ptr == end || *ptr != ',') {
+            return JSON_PATH_NOT_FOUND;
+        }
+        ptr = skip_json_space(ptr + 1, end);
+    }
+    return JSON_PATH_NOT_FOUND;
+}
+
+// Moves 'p' from the array at it to its element 'index'.
+static JsonPathResult find_json_element(const char** p, const char* end, int index) {
+    const char* ptr = skip_json_space(*p + 1, end);
+    if (ptr < end && *ptr == ']') {
+        return JSON_PATH_NOT_FOUND;
+    }
+    for (int i = 0; i < index; ++i) {
+        ptr = skip_json_value(ptr, end);
+        if (ptr == NULL) {
+            return JSON_PATH_NOT_FOUND;
+        }
+        ptr = skip_json_space(ptr, end);
+        if (ptr == end || *ptr != ',') {
+            return JSON_PATH_NOT_FOUND;
+        }
+        ptr = skip_json_space(ptr + 1, end);
+    }
+    *p = ptr;
+    return JSON_PATH_FOUND;
+}
+
+// Finds the value of the path in [p, end) like get_json_object() does on a document.
+static JsonPathResult read_json_path(const char* p, const char* end,
+                                     const std::vector<JsonPath>& parsed_paths,
+                                     const char** value, const char** value_end) {
+    p = skip_json_space(p, end);
+    for (size_t i = 1; i < parsed_paths.size(); i++) {
+        if (p == end || *p == 'n') {
+            return JSON_PATH_NOT_FOUND;
+        }
+        const JsonPath& path = parsed_paths[i];
+        if (!path.is_valid) {
+            return JSON_PATH_UNSUPPORTED;
+        }
+        if (LIKELY(!path.key.empty())) {
+            if (*p == '[') {
+                return JSON_PATH_UNSUPPORTED;
+            }
+            if (*p != '{') {
+                return JSON_PATH_NOT_FOUND;
+            }
+            JsonPathResult result = find_json_member(&p, end, path.key);
+            if (result != JSON_PATH_FOUND) {
+                return result;
+            }
+        }
+        if (UNLIKELY(path.idx != -1)) {
+            if (p == end || *p != '[') {
+                return JSON_PATH_NOT_FOUND;
+            }
+            JsonPathResult result = find_json_element(&p, end, path.idx);
+            if (result != JSON_PATH_FOUND) {
+                return result;
+            }
+        }
+    }
+    *value_end = skip_json_value(p, end);
+    if (*value_end == NULL) {
+        return JSON_PATH_NOT_FOUND;
+    }
+    *value = p;
+    return JSON_PATH_FOUND;
+}
+
+rapidjson::Value* JsonFunctions::find_json_object(
+        FunctionContext* context, const char* json, size_t json_len,
+        const std::string& path_string, const JsonFunctionType& fntype,
+        rapidjson::Document* document) {
+    std::vector<JsonPath> tmp_parsed_paths;
+    const std::vector<JsonPath>* parsed_paths =
+        get_or_parse_paths(context, path_string, &tmp_parsed_paths);
+    if (!(*parsed_paths)[0].is_valid) {
+        return document;
+    }
+    const char* value = NULL;
+    const char* value_end = NULL;
+    JsonPathResult result = JSON_PATH_UNSUPPORTED;
+    if (parsed_paths->size() > 1) {
+        result = read_json_path(json, json + json_len, *parsed_paths, &value, &value_end);
+    }
+    if (result == JSON_PATH_UNSUPPORTED) {
+        return get_json_object(context, std::string(json, json_len), path_string, fntype,
+                               document);
+    }
+    if (result == JSON_PATH_FOUND) {
+        document->Parse(value, value_end - value);
+        if (!document->HasParseError()) {
+            return document;
+        }
+        LOG(ERROR) << "Error at offset " << (value - json) + document->GetErrorOffset()
+            << ": " << GetParseError_En(document->GetParseError());
+    }
+    document->SetNull();
+    return document;
+}
+
 void JsonFunctions::json_path_prepare(
         doris_udf::FunctionContext* context,
         doris_udf::FunctionContext::FunctionStateScope scope) {
@@ -41,7 +41,7 @@ struct JsonPath {
 		idx(idx_),
 		is_valid(is_valid_) {}
 
-	std::string debug_string() {
+	std::string debug_string() const {
 		std::stringstream ss;
 		ss << "key: " << key << ", idx: " << idx << ", valid: " << is_valid;
 		return ss.str();
@@ -66,6 +66,16 @@ public:
             const std::string& json_string, const std::string& path_string,
             const JsonFunctionType& fntype, rapidjson::Document* document);
 
+    // Same as get_json_object(), but the JSON text is only read up to the value of the
+    // path, without building a document: skipped values are passed over by their
+    // brackets and only the value found is parsed into 'document'. Errors after the
+    // value are not noticed. Falls back to get_json_object() for paths which collect
+    // the members of the objects of an array.
+    static rapidjson::Value* find_json_object(
+            FunctionContext* context, const char* json, size_t json_len,
+            const std::string& path_string, const JsonFunctionType& fntype,
+            rapidjson::Document* document);
+
 	static void json_path_prepare(
 			doris_udf::FunctionContext*,
 			doris_udf::FunctionContext::FunctionStateScope);
@@ -75,6 +85,12 @@ public:
 			doris_udf::FunctionContext::FunctionStateScope);
 private:
 
+    // Returns the paths parsed by json_path_prepare(), or parses 'path_string' into
+    // 'tmp_parsed_paths' if the path is not constant.
+    static const std::vector<JsonPath>* get_or_parse_paths(
+            FunctionContext* context, const std::string& path_string,
+            std::vector<JsonPath>* tmp_parsed_paths);
+
 	static void get_parsed_paths(
 			const std::vector<std::string>& path_exprs,
 			std::vector<JsonPath>* parsed_paths);
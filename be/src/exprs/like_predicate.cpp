@@ -394,13 +394,34 @@ BooleanVal LikePredicate::regex_match(
     }
 }
 
+void LikePredicate::to_partial_regex(const std::string& pattern, bool is_like,
+                                     std::string* re_pattern) {
+    if (!is_like) {
+        *re_pattern = pattern;
+        return;
+    }
+    std::string full_pattern;
+    StringVal pattern_val(reinterpret_cast<uint8_t*>(const_cast<char*>(pattern.data())),
+                          pattern.size());
+    convert_like_pattern('\\', pattern_val, &full_pattern);
+    // ^ and $ only match at the beginning and the end of the text in RE2
+    *re_pattern = "^(?:" + full_pattern + ")$";
+}
+
 void LikePredicate::convert_like_pattern(
         FunctionContext* context, 
         const StringVal& pattern,
         std::string* re_pattern) {
-    re_pattern->clear();
     LikePredicateState* state = reinterpret_cast<LikePredicateState*>(
         context->get_function_state(FunctionContext::THREAD_LOCAL));
+    convert_like_pattern(state->escape_char, pattern, re_pattern);
+}
+
+void LikePredicate::convert_like_pattern(
+        char escape_char,
+        const StringVal& pattern,
+        std::string* re_pattern) {
+    re_pattern->clear();
     bool is_escaped = false;
     for (int i = 0; i < pattern.len; ++i) {
         if (!is_escaped && pattern.ptr[i] == '%') {
@@ -408,7 +429,7 @@ void LikePredicate::convert_like_pattern(
         } else if (!is_escaped && pattern.ptr[i] == '_') {
             re_pattern->append(".");
             // check for escape char before checking for regex special chars, they might overlap
-        } else if (!is_escaped && pattern.ptr[i] == state->escape_char) {
+        } else if (!is_escaped && pattern.ptr[i] == escape_char) {
             is_escaped = true;
         } else if (
             pattern.ptr[i] == '.'
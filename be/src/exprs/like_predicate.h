@@ -32,6 +32,12 @@ class LikePredicate {
 public:
     static void init();
 
+    /// Returns in 're_pattern' a regular expression which partially matches the same
+    /// strings as the constant 'pattern' of a LIKE predicate if 'is_like', of a REGEXP
+    /// predicate otherwise. Used to match the patterns of many predicates at once.
+    static void to_partial_regex(const std::string& pattern, bool is_like,
+                                 std::string* re_pattern);
+
 private:
     typedef doris_udf::BooleanVal (*LikePredicateFunction) (
         doris_udf::FunctionContext*, const doris_udf::StringVal&, const doris_udf::StringVal&);
@@ -170,6 +176,11 @@ private:
         const doris_udf::StringVal& pattern,
         std::string* re_pattern);
 
+    static void convert_like_pattern(
+        char escape_char,
+        const doris_udf::StringVal& pattern,
+        std::string* re_pattern);
+
     static void remove_escape_character(std::string* search_string);
 };
 
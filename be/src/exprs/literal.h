@@ -48,6 +48,11 @@ public:
     virtual DateTimeVal get_datetime_val(ExprContext* context, TupleRow*);
     virtual StringVal get_string_val(ExprContext* context, TupleRow* row);
 
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override {
+        evaluate_constant_batch(context, batch, sel, n, result);
+    }
+
 protected:
     friend class Expr;
     Literal(const TExprNode& node);
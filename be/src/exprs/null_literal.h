@@ -49,6 +49,11 @@ public:
     virtual doris_udf::DecimalVal get_decimal_val(ExprContext*, TupleRow*);
     virtual doris_udf::DecimalV2Val get_decimalv2_val(ExprContext*, TupleRow*);
 
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override {
+        evaluate_constant_batch(context, batch, sel, n, result);
+    }
+
 protected:
     friend class Expr;
 
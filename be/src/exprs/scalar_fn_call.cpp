@@ -17,6 +17,7 @@
 
 #include "exprs/scalar_fn_call.h"
 
+#include <cstddef>
 #include <vector>
 //#include <llvm/IR/Attributes.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
@@ -24,9 +25,12 @@
 #include "codegen/codegen_anyval.h"
 #include "codegen/llvm_codegen.h"
 #include "exprs/anyval_util.h"
+#include "exprs/decimalv2_operators.h"
 #include "exprs/expr_context.h"
+#include "runtime/row_batch.h"
 #include "runtime/user_function_cache.h"
 #include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
 #include "udf/udf_internal.h"
 #include "util/debug_util.h"
 #include "util/symbols_util.h"
@@ -44,7 +48,9 @@ ScalarFnCall::ScalarFnCall(const TExprNode& node) :
         _scalar_fn_wrapper(NULL),
         _prepare_fn(NULL),
         _close_fn(NULL),
-        _scalar_fn(NULL) {
+        _scalar_fn(NULL),
+        _batch_fn(NULL),
+        _udf_batch_fn(NULL) {
     DCHECK_NE(_fn.binary_type, TFunctionBinaryType::HIVE);
 }
 
@@ -155,6 +161,40 @@ Status ScalarFnCall::prepare(
         codegen->AddFunctionToJit(ir_udf_wrapper, &_scalar_fn_wrapper);
     }
 #endif
+    if (_fn.binary_type == TFunctionBinaryType::BUILTIN && _type.is_string_type()) {
+        bool batch_arg_types = true;
+        for (auto child : _children) {
+            batch_arg_types &= child->type().is_string_type() || child->type().type == TYPE_INT;
+        }
+        if (batch_arg_types) {
+            _batch_fn = StringBatchFunctions::get_batch_fn(
+                _fn.name.function_name, _children.size());
+        }
+    } else if (_fn.binary_type == TFunctionBinaryType::BUILTIN
+               && _type.type == TYPE_DECIMALV2) {
+        bool batch_arg_types = true;
+        for (auto child : _children) {
+            batch_arg_types &= child->type().type == TYPE_DECIMALV2;
+        }
+        if (batch_arg_types) {
+            _batch_fn = DecimalV2Operators::get_batch_fn(
+                _fn.name.function_name, _children.size());
+        }
+    }
+    if (status.ok() && _fn.binary_type == TFunctionBinaryType::NATIVE
+            && is_udf_batch_type(_type)) {
+        bool batch_arg_types = true;
+        for (auto child : _children) {
+            batch_arg_types &= is_udf_batch_type(child->type());
+        }
+        if (batch_arg_types) {
+            std::string batch_symbol =
+                SymbolsUtil::demangle_name_only(_fn.scalar_fn.symbol) + "_batch";
+            RETURN_IF_ERROR(UserFunctionCache::instance()->get_optional_function_ptr(
+                _fn.id, batch_symbol, _fn.hdfs_location, _fn.checksum,
+                reinterpret_cast<void**>(&_udf_batch_fn), &_cache_entry));
+        }
+    }
     if (_fn.scalar_fn.__isset.prepare_fn_symbol) {
         RETURN_IF_ERROR(get_function(state, _fn.scalar_fn.prepare_fn_symbol,
                                     reinterpret_cast<void**>(&_prepare_fn)));
@@ -237,6 +277,103 @@ void ScalarFnCall::close(
     Expr::close(state, context, scope);
 }
 
+void ScalarFnCall::evaluate_batch(ExprContext* context, RowBatch* batch,
+                                  const int* sel, int n, ExprColumn* result) {
+    if (_batch_fn != NULL) {
+        evaluate_builtin_batch(context, batch, sel, n, result);
+        return;
+    }
+    if (_udf_batch_fn != NULL) {
+        evaluate_udf_batch(context, batch, sel, n, result);
+        return;
+    }
+    const std::string& name = _fn.name.function_name;
+    bool is_null_pred = name == "is_null_pred";
+    if (_children.size() != 1 || (!is_null_pred && name != "is_not_null_pred")) {
+        Expr::evaluate_batch(context, batch, sel, n, result);
+        return;
+    }
+    ExprColumn* input = context->acquire_column();
+    _children[0]->evaluate_batch(context, batch, sel, n, input);
+    result->reset(TYPE_BOOLEAN, batch->num_rows());
+    const uint8_t* input_nulls = input->nulls();
+    bool* values = result->values<bool>();
+    for_each_selected_row(sel, n, [&](int i) {
+        values[i] = (input_nulls[i] != 0) == is_null_pred;
+    });
+    context->release_column(input);
+}
+
+void ScalarFnCall::evaluate_builtin_batch(ExprContext* context, RowBatch* batch,
+                                          const int* sel, int n, ExprColumn* result) {
+    FunctionContext* fn_ctx = context->fn_context(_fn_context_index);
+    result->reset(_type.type, batch->num_rows());
+    uint8_t* nulls = result->nulls();
+    // constant arguments were evaluated once by open()
+    std::vector<ExprColumn*> args(_children.size(), NULL);
+    for (int i = 0; i < _children.size(); ++i) {
+        AnyVal* constant_arg = fn_ctx->get_constant_arg(i);
+        if (constant_arg == NULL) {
+            args[i] = context->acquire_column();
+            _children[i]->evaluate_batch(context, batch, sel, n, args[i]);
+            const uint8_t* arg_nulls = args[i]->nulls();
+            for_each_selected_row(sel, n, [&](int row) { nulls[row] |= arg_nulls[row]; });
+        } else if (constant_arg->is_null) {
+            for_each_selected_row(sel, n, [&](int row) { nulls[row] = 1; });
+        }
+    }
+    _batch_fn(fn_ctx, args.data(), sel, n, result);
+    for (int i = _children.size() - 1; i >= 0; --i) {
+        if (args[i] != NULL) {
+            context->release_column(args[i]);
+        }
+    }
+}
+
+static_assert(sizeof(BatchStringVal) == sizeof(StringValue)
+              && offsetof(BatchStringVal, ptr) == offsetof(StringValue, ptr)
+              && offsetof(BatchStringVal, len) == offsetof(StringValue, len),
+              "BatchStringVal must have the layout of StringValue");
+
+bool ScalarFnCall::is_udf_batch_type(const TypeDescriptor& type) {
+    switch (type.type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ScalarFnCall::evaluate_udf_batch(ExprContext* context, RowBatch* batch,
+                                      const int* sel, int n, ExprColumn* result) {
+    FunctionContext* fn_ctx = context->fn_context(_fn_context_index);
+    std::vector<ExprColumn*> arg_columns(_children.size());
+    std::vector<BatchColumn> args(_children.size());
+    for (int i = 0; i < _children.size(); ++i) {
+        arg_columns[i] = context->acquire_column();
+        _children[i]->evaluate_batch(context, batch, sel, n, arg_columns[i]);
+        args[i].values = arg_columns[i]->data();
+        args[i].nulls = arg_columns[i]->nulls();
+    }
+    result->reset(_type.type, batch->num_rows());
+    BatchColumn result_column;
+    result_column.values = result->data();
+    result_column.nulls = result->nulls();
+    _udf_batch_fn(fn_ctx, args.size(), args.data(), sel, n, &result_column);
+    for (int i = _children.size() - 1; i >= 0; --i) {
+        context->release_column(arg_columns[i]);
+    }
+}
+
 bool ScalarFnCall::is_constant() const {
     if (_fn.name.function_name == "rand") {
         return false;
@@ -473,7 +610,7 @@ Status ScalarFnCall::get_udf(RuntimeState* state, Function** udf) {
         // Associate the dynamically loaded function pointer with the Function* we
         // defined. This tells LLVM where the compiled function definition is located in
         // memory.
-        codegen->execution_engine()->addGlobalMapping(*udf, fn_ptr);
+        codegen->add_global_mapping(*udf, fn_ptr);
     } else if (_fn.binary_type == TFunctionBinaryType::BUILTIN) {
         // In this path, we're running a builtin with the UDF interface. The IR is
         // in the llvm module.
@@ -22,6 +22,7 @@
 
 #include "common/object_pool.h"
 #include "exprs/expr.h"
+#include "exprs/string_batch_functions.h"
 #include "udf/udf.h"
 
 namespace doris {
@@ -82,6 +83,12 @@ protected:
     virtual doris_udf::DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*);
     // virtual doris_udf::ArrayVal GetArrayVal(ExprContext* context, TupleRow*);
 
+    // is_null_pred() and is_not_null_pred() only look at the nulls of their child,
+    // string builtins and native UDFs with a batch version run it, other functions
+    // are called for each row
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
+
 private:
     /// If this function has var args, children()[_vararg_start_idx] is the first vararg
     /// argument.
@@ -106,6 +113,12 @@ private:
     /// scalar function.
     void* _scalar_fn;
 
+    /// Batch version of a string or decimalv2 builtin, NULL if there is none.
+    StringBatchFunctions::BatchFn _batch_fn;
+
+    /// Batch version of a native UDF exported by its library, NULL if there is none.
+    UdfBatchFn _udf_batch_fn;
+
     /// Returns the number of non-vararg arguments
     int num_fixed_args() const {
         return _vararg_start_idx >= 0 ? _vararg_start_idx : _children.size();
@@ -119,6 +132,17 @@ private:
     /// has been JIT'd (i.e. after Prepare() has completed).
     Status get_function(RuntimeState* state, const std::string& symbol, void** fn);
 
+    /// Runs _batch_fn on the columns of the children which are not constant.
+    void evaluate_builtin_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result);
+
+    /// Runs _udf_batch_fn on the columns of all the children.
+    void evaluate_udf_batch(ExprContext* context, RowBatch* batch,
+                            const int* sel, int n, ExprColumn* result);
+
+    /// Returns true if values of this type can be passed to a batch UDF.
+    static bool is_udf_batch_type(const TypeDescriptor& type);
+
     /// Evaluates the children exprs and stores the results in input_vals. Used in the
     /// interpreted path.
     void evaluate_children(ExprContext* context, TupleRow* row,
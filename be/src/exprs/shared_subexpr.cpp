@@ -0,0 +1,133 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exprs/shared_subexpr.h"
+
+#include <sstream>
+
+#include "exprs/expr_context.h"
+
+namespace doris {
+
+SharedSubexpr::SharedSubexpr(Expr* child, int idx) : Expr(*child), _idx(idx) {
+    // the cache entry of a function is released by the child
+    _cache_entry = nullptr;
+    _ir_compute_fn = nullptr;
+    add_child(child);
+}
+
+template<typename T, typename GetValFn>
+T SharedSubexpr::get_val(ExprContext* context, TupleRow* row, GetValFn get_child_val) {
+    SubexprCache* cache = context->subexpr_cache();
+    // contexts created for the tree outside of the group evaluate the child directly
+    if (cache == nullptr || _idx >= cache->num_entries()) {
+        return get_child_val();
+    }
+    T val;
+    if (!cache->lookup(_idx, row, &val)) {
+        val = get_child_val();
+        cache->store(_idx, row, val);
+    }
+    return val;
+}
+
+Status SharedSubexpr::get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) {
+    return _children[0]->get_codegend_compute_fn(state, fn);
+}
+
+BooleanVal SharedSubexpr::get_boolean_val(ExprContext* context, TupleRow* row) {
+    return get_val<BooleanVal>(context, row, [&]() {
+        return _children[0]->get_boolean_val(context, row);
+    });
+}
+
+TinyIntVal SharedSubexpr::get_tiny_int_val(ExprContext* context, TupleRow* row) {
+    return get_val<TinyIntVal>(context, row, [&]() {
+        return _children[0]->get_tiny_int_val(context, row);
+    });
+}
+
+SmallIntVal SharedSubexpr::get_small_int_val(ExprContext* context, TupleRow* row) {
+    return get_val<SmallIntVal>(context, row, [&]() {
+        return _children[0]->get_small_int_val(context, row);
+    });
+}
+
+IntVal SharedSubexpr::get_int_val(ExprContext* context, TupleRow* row) {
+    return get_val<IntVal>(context, row, [&]() {
+        return _children[0]->get_int_val(context, row);
+    });
+}
+
+BigIntVal SharedSubexpr::get_big_int_val(ExprContext* context, TupleRow* row) {
+    return get_val<BigIntVal>(context, row, [&]() {
+        return _children[0]->get_big_int_val(context, row);
+    });
+}
+
+LargeIntVal SharedSubexpr::get_large_int_val(ExprContext* context, TupleRow* row) {
+    return get_val<LargeIntVal>(context, row, [&]() {
+        return _children[0]->get_large_int_val(context, row);
+    });
+}
+
+FloatVal SharedSubexpr::get_float_val(ExprContext* context, TupleRow* row) {
+    return get_val<FloatVal>(context, row, [&]() {
+        return _children[0]->get_float_val(context, row);
+    });
+}
+
+DoubleVal SharedSubexpr::get_double_val(ExprContext* context, TupleRow* row) {
+    return get_val<DoubleVal>(context, row, [&]() {
+        return _children[0]->get_double_val(context, row);
+    });
+}
+
+StringVal SharedSubexpr::get_string_val(ExprContext* context, TupleRow* row) {
+    // the string is in the local allocations of the context which computed it, they
+    // are freed only after all contexts of the group are done with the row
+    return get_val<StringVal>(context, row, [&]() {
+        return _children[0]->get_string_val(context, row);
+    });
+}
+
+DateTimeVal SharedSubexpr::get_datetime_val(ExprContext* context, TupleRow* row) {
+    return get_val<DateTimeVal>(context, row, [&]() {
+        return _children[0]->get_datetime_val(context, row);
+    });
+}
+
+DecimalVal SharedSubexpr::get_decimal_val(ExprContext* context, TupleRow* row) {
+    return get_val<DecimalVal>(context, row, [&]() {
+        return _children[0]->get_decimal_val(context, row);
+    });
+}
+
+DecimalV2Val SharedSubexpr::get_decimalv2_val(ExprContext* context, TupleRow* row) {
+    return get_val<DecimalV2Val>(context, row, [&]() {
+        return _children[0]->get_decimalv2_val(context, row);
+    });
+}
+
+std::string SharedSubexpr::debug_string() const {
+    std::stringstream out;
+    out << "SharedSubexpr(idx=" << _idx << Expr::debug_string() << ")";
+    return out.str();
+}
+
+}
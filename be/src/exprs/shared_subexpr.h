@@ -0,0 +1,143 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_QUERY_EXPRS_SHARED_SUBEXPR_H
+#define DORIS_BE_SRC_QUERY_EXPRS_SHARED_SUBEXPR_H
+
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exprs/expr.h"
+
+namespace doris {
+
+// The values of the subexprs shared by a group of ExprContexts, see
+// ExprContext::share_subexprs(). A value is valid for the row it was computed for
+// until the next evaluation of one of the contexts starts.
+class SubexprCache {
+public:
+    explicit SubexprCache(int num_entries) : _entries(num_entries) { }
+
+    int num_entries() const {
+        return _entries.size();
+    }
+
+    // Called when one of the contexts starts an evaluation. Evaluations within a scope
+    // share the values, so all of them must be for the same row.
+    void start_evaluation() {
+        if (_num_scopes == 0) {
+            ++_epoch;
+        }
+    }
+
+    void enter_scope() {
+        if (_num_scopes++ == 0) {
+            ++_epoch;
+        }
+    }
+
+    void leave_scope() {
+        DCHECK_GT(_num_scopes, 0);
+        --_num_scopes;
+    }
+
+    // Returns false if entry 'idx' holds no value for 'row' of the current evaluation.
+    template<typename T>
+    bool lookup(int idx, const TupleRow* row, T* val) const {
+        const Entry& entry = _entries[idx];
+        if (entry.epoch != _epoch || entry.row != row) {
+            return false;
+        }
+        *val = *reinterpret_cast<const T*>(&entry.value);
+        return true;
+    }
+
+    template<typename T>
+    void store(int idx, const TupleRow* row, const T& val) {
+        Entry& entry = _entries[idx];
+        entry.epoch = _epoch;
+        entry.row = row;
+        new (&entry.value) T(val);
+    }
+
+private:
+    struct Entry {
+        int64_t epoch = -1;
+        const TupleRow* row = nullptr;
+        std::aligned_union<0, BooleanVal, TinyIntVal, SmallIntVal, IntVal, BigIntVal,
+            LargeIntVal, FloatVal, DoubleVal, StringVal, DateTimeVal, DecimalVal,
+            DecimalV2Val>::type value;
+    };
+
+    std::vector<Entry> _entries;
+    int64_t _epoch = 0;
+    int _num_scopes = 0;
+};
+
+// Stands for a subexpr which occurs several times in the expr trees of a group of
+// ExprContexts. Its value for a row is computed by the first occurrence evaluated and
+// kept in the SubexprCache of the context for the others. The subexpr stays the only
+// child and the node takes its node type and opcode, like FoldedConstant.
+class SharedSubexpr : public Expr {
+public:
+    // 'idx' is the entry for the value of 'child' in the SubexprCache of the group.
+    SharedSubexpr(Expr* child, int idx);
+
+    virtual Expr* clone(ObjectPool* pool) const override {
+        return pool->add(new SharedSubexpr(*this));
+    }
+
+    virtual bool is_constant() const override {
+        return _children[0]->is_constant();
+    }
+
+    virtual Status get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn) override;
+
+    virtual BooleanVal get_boolean_val(ExprContext* context, TupleRow*) override;
+    virtual TinyIntVal get_tiny_int_val(ExprContext* context, TupleRow*) override;
+    virtual SmallIntVal get_small_int_val(ExprContext* context, TupleRow*) override;
+    virtual IntVal get_int_val(ExprContext* context, TupleRow*) override;
+    virtual BigIntVal get_big_int_val(ExprContext* context, TupleRow*) override;
+    virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*) override;
+    virtual FloatVal get_float_val(ExprContext* context, TupleRow*) override;
+    virtual DoubleVal get_double_val(ExprContext* context, TupleRow*) override;
+    virtual StringVal get_string_val(ExprContext* context, TupleRow*) override;
+    virtual DateTimeVal get_datetime_val(ExprContext* context, TupleRow*) override;
+    virtual DecimalVal get_decimal_val(ExprContext* context, TupleRow*) override;
+    virtual DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*) override;
+
+    // The rows of a batch are evaluated by the child, the values are not shared.
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override {
+        _children[0]->evaluate_batch(context, batch, sel, n, result);
+    }
+
+    virtual std::string debug_string() const override;
+
+private:
+    template<typename T, typename GetValFn>
+    T get_val(ExprContext* context, TupleRow* row, GetValFn get_child_val);
+
+    int _idx;
+};
+
+}
+
+#endif
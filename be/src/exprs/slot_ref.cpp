@@ -22,6 +22,7 @@
 #include "codegen/codegen_anyval.h"
 #include "codegen/llvm_codegen.h"
 #include "gen_cpp/Exprs_types.h"
+#include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "util/types.h"
 
@@ -413,6 +414,49 @@ Status SlotRef::get_codegend_compute_fn(RuntimeState* state, llvm::Function** fn
     return Status::OK;
 }
 
+// SIZE is the size of the slot, 0 if it is only known at runtime
+template <int SIZE>
+static void copy_slots(RowBatch* batch, int tuple_idx, int slot_offset,
+                       const NullIndicatorOffset& null_offset,
+                       const int* sel, int n, ExprColumn* result) {
+    const int size = SIZE > 0 ? SIZE : result->value_size();
+    uint8_t* values = result->data();
+    uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        Tuple* t = batch->get_row(i)->get_tuple(tuple_idx);
+        if (t == NULL || t->is_null(null_offset)) {
+            nulls[i] = 1;
+        } else {
+            memcpy(values + static_cast<size_t>(size) * i, t->get_slot(slot_offset), size);
+        }
+    });
+}
+
+void SlotRef::evaluate_batch(ExprContext* context, RowBatch* batch,
+                             const int* sel, int n, ExprColumn* result) {
+    result->reset(_type.type, batch->num_rows());
+    switch (result->value_size()) {
+    case 1:
+        copy_slots<1>(batch, _tuple_idx, _slot_offset, _null_indicator_offset, sel, n, result);
+        break;
+    case 2:
+        copy_slots<2>(batch, _tuple_idx, _slot_offset, _null_indicator_offset, sel, n, result);
+        break;
+    case 4:
+        copy_slots<4>(batch, _tuple_idx, _slot_offset, _null_indicator_offset, sel, n, result);
+        break;
+    case 8:
+        copy_slots<8>(batch, _tuple_idx, _slot_offset, _null_indicator_offset, sel, n, result);
+        break;
+    case 16:
+        copy_slots<16>(batch, _tuple_idx, _slot_offset, _null_indicator_offset, sel, n, result);
+        break;
+    default:
+        copy_slots<0>(batch, _tuple_idx, _slot_offset, _null_indicator_offset, sel, n, result);
+        break;
+    }
+}
+
 BooleanVal SlotRef::get_boolean_val(ExprContext* context, TupleRow* row) {
     DCHECK_EQ(_type.type, TYPE_BOOLEAN);
     Tuple* t = row->get_tuple(_tuple_idx);
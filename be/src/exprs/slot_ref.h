@@ -79,6 +79,9 @@ public:
     virtual doris_udf::DateTimeVal get_datetime_val(ExprContext* context, TupleRow*);
     virtual doris_udf::DecimalVal get_decimal_val(ExprContext* context, TupleRow*);
     virtual doris_udf::DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*);
+
+    virtual void evaluate_batch(ExprContext* context, RowBatch* batch,
+                                const int* sel, int n, ExprColumn* result) override;
     // virtual doris_udf::ArrayVal GetArrayVal(ExprContext* context, TupleRow*);
 
 private:
@@ -0,0 +1,382 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/string_batch_functions.h"
+
+#include <emmintrin.h>
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <re2/re2.h>
+
+#include "exprs/expr_column.h"
+#include "exprs/string_functions.h"
+#include "runtime/string_value.h"
+
+namespace doris {
+
+// The string argument 'idx' of a batch function, from its column or its
+// constant value.
+class StringArg {
+public:
+    StringArg(FunctionContext* context, ExprColumn* const* args, int idx) :
+            _values(args[idx] == NULL ? NULL : args[idx]->values<StringValue>()),
+            _owned(args[idx] != NULL && args[idx]->owns_string_data()) {
+        if (_values == NULL) {
+            _constant = StringValue::from_string_val(
+                    *reinterpret_cast<StringVal*>(context->get_constant_arg(idx)));
+        }
+    }
+
+    const StringValue& get(int row) const {
+        return _values == NULL ? _constant : _values[row];
+    }
+
+    // true if the values live in the argument column, which is released
+    // before the result
+    bool owned() const { return _owned; }
+
+private:
+    const StringValue* _values;
+    StringValue _constant;
+    bool _owned;
+};
+
+class IntArg {
+public:
+    IntArg(FunctionContext* context, ExprColumn* const* args, int idx) :
+            _values(args[idx] == NULL ? NULL : args[idx]->values<int32_t>()), _constant(0) {
+        if (_values == NULL) {
+            _constant = reinterpret_cast<IntVal*>(context->get_constant_arg(idx))->val;
+        }
+    }
+
+    int32_t get(int row) const {
+        return _values == NULL ? _constant : _values[row];
+    }
+
+private:
+    const int32_t* _values;
+    int32_t _constant;
+};
+
+// Calls 'fn' for the rows with no null argument.
+template <typename Fn>
+static void for_each_not_null_row(const int* sel, int n, ExprColumn* result, Fn fn) {
+    const uint8_t* nulls = result->nulls();
+    for_each_selected_row(sel, n, [&](int i) {
+        if (nulls[i] == 0) {
+            fn(i);
+        }
+    });
+}
+
+// Sets the result of 'row' to [ptr, ptr + len), a part of 'str', which is
+// copied if the argument it comes from is released before the result.
+static void set_sub_string(const StringArg& arg, const char* ptr, int len,
+                           int row, ExprColumn* result) {
+    StringValue* values = result->values<StringValue>();
+    if (arg.owned()) {
+        char* buf = result->allocate_string_data(len);
+        memcpy(buf, ptr, len);
+        ptr = buf;
+    }
+    values[row] = StringValue(const_cast<char*>(ptr), len);
+}
+
+template <char FIRST, char LAST>
+static void flip_ascii_case(const char* src, int len, char* dst) {
+    const __m128i first = _mm_set1_epi8(FIRST - 1);
+    const __m128i last = _mm_set1_epi8(LAST + 1);
+    const __m128i flip = _mm_set1_epi8(0x20);
+    int i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // bytes from 0x80 are negative and never in the range
+        __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(chars, first),
+                                         _mm_cmplt_epi8(chars, last));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_xor_si128(chars, _mm_and_si128(in_range, flip)));
+    }
+    for (; i < len; ++i) {
+        char c = src[i];
+        dst[i] = (c >= FIRST && c <= LAST) ? (c ^ 0x20) : c;
+    }
+}
+
+void StringBatchFunctions::to_lower_ascii(const char* src, int len, char* dst) {
+    flip_ascii_case<'A', 'Z'>(src, len, dst);
+}
+
+void StringBatchFunctions::to_upper_ascii(const char* src, int len, char* dst) {
+    flip_ascii_case<'a', 'z'>(src, len, dst);
+}
+
+int StringBatchFunctions::find_first_not_space(const char* str, int len) {
+    const __m128i spaces = _mm_set1_epi8(' ');
+    int i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+        int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(chars, spaces)) & 0xFFFF;
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    while (i < len && str[i] == ' ') {
+        ++i;
+    }
+    return i;
+}
+
+int StringBatchFunctions::find_end_not_space(const char* str, int len) {
+    const __m128i spaces = _mm_set1_epi8(' ');
+    int end = len;
+    for (; end >= 16; end -= 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + end - 16));
+        int mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(chars, spaces)) & 0xFFFF;
+        if (mask != 0) {
+            return end - 16 + (32 - __builtin_clz(mask));
+        }
+    }
+    while (end > 0 && str[end - 1] == ' ') {
+        --end;
+    }
+    return end;
+}
+
+template <void (*CONVERT)(const char*, int, char*)>
+static void convert_case(FunctionContext* context, ExprColumn* const* args,
+                         const int* sel, int n, ExprColumn* result) {
+    StringArg str(context, args, 0);
+    StringValue* values = result->values<StringValue>();
+    for_each_not_null_row(sel, n, result, [&](int i) {
+        const StringValue& value = str.get(i);
+        char* buf = result->allocate_string_data(value.len);
+        CONVERT(value.ptr, value.len, buf);
+        values[i] = StringValue(buf, value.len);
+    });
+}
+
+void StringBatchFunctions::lower(FunctionContext* context, ExprColumn* const* args,
+                                 const int* sel, int n, ExprColumn* result) {
+    convert_case<to_lower_ascii>(context, args, sel, n, result);
+}
+
+void StringBatchFunctions::upper(FunctionContext* context, ExprColumn* const* args,
+                                 const int* sel, int n, ExprColumn* result) {
+    convert_case<to_upper_ascii>(context, args, sel, n, result);
+}
+
+template <bool LEFT, bool RIGHT>
+static void trim_spaces(FunctionContext* context, ExprColumn* const* args,
+                        const int* sel, int n, ExprColumn* result) {
+    StringArg str(context, args, 0);
+    for_each_not_null_row(sel, n, result, [&](int i) {
+        const StringValue& value = str.get(i);
+        int begin = LEFT ? StringBatchFunctions::find_first_not_space(value.ptr, value.len) : 0;
+        int end = value.len;
+        if (RIGHT) {
+            end = begin + StringBatchFunctions::find_end_not_space(
+                    value.ptr + begin, value.len - begin);
+        }
+        set_sub_string(str, value.ptr + begin, end - begin, i, result);
+    });
+}
+
+void StringBatchFunctions::trim(FunctionContext* context, ExprColumn* const* args,
+                                const int* sel, int n, ExprColumn* result) {
+    trim_spaces<true, true>(context, args, sel, n, result);
+}
+
+void StringBatchFunctions::ltrim(FunctionContext* context, ExprColumn* const* args,
+                                 const int* sel, int n, ExprColumn* result) {
+    trim_spaces<true, false>(context, args, sel, n, result);
+}
+
+void StringBatchFunctions::rtrim(FunctionContext* context, ExprColumn* const* args,
+                                 const int* sel, int n, ExprColumn* result) {
+    trim_spaces<false, true>(context, args, sel, n, result);
+}
+
+// As StringFunctions::substring(): 1-indexed 'pos', from the end if it is
+// negative.
+static void set_substring(const StringArg& str, int row, int32_t pos, int32_t len,
+                          ExprColumn* result) {
+    const StringValue& value = str.get(row);
+    if (pos < 0) {
+        pos = value.len + pos + 1;
+    }
+    int max_len = value.len - pos + 1;
+    int fixed_len = std::min(len, max_len);
+    if (pos > 0 && pos <= value.len && fixed_len > 0) {
+        set_sub_string(str, value.ptr + pos - 1, fixed_len, row, result);
+    } else {
+        result->values<StringValue>()[row] = StringValue();
+    }
+}
+
+void StringBatchFunctions::substring(FunctionContext* context, ExprColumn* const* args,
+                                     const int* sel, int n, ExprColumn* result) {
+    StringArg str(context, args, 0);
+    IntArg pos(context, args, 1);
+    if (context->get_num_args() == 2) {
+        for_each_not_null_row(sel, n, result, [&](int i) {
+            set_substring(str, i, pos.get(i), INT_MAX, result);
+        });
+        return;
+    }
+    IntArg len(context, args, 2);
+    for_each_not_null_row(sel, n, result, [&](int i) {
+        set_substring(str, i, pos.get(i), len.get(i), result);
+    });
+}
+
+void StringBatchFunctions::left(FunctionContext* context, ExprColumn* const* args,
+                                const int* sel, int n, ExprColumn* result) {
+    StringArg str(context, args, 0);
+    IntArg len(context, args, 1);
+    for_each_not_null_row(sel, n, result, [&](int i) {
+        set_substring(str, i, 1, len.get(i), result);
+    });
+}
+
+void StringBatchFunctions::right(FunctionContext* context, ExprColumn* const* args,
+                                 const int* sel, int n, ExprColumn* result) {
+    StringArg str(context, args, 0);
+    IntArg len(context, args, 1);
+    for_each_not_null_row(sel, n, result, [&](int i) {
+        // do not index past the beginning of str
+        int32_t pos = std::max(-len.get(i), -str.get(i).len);
+        set_substring(str, i, pos, len.get(i), result);
+    });
+}
+
+void StringBatchFunctions::concat(FunctionContext* context, ExprColumn* const* args,
+                                  const int* sel, int n, ExprColumn* result) {
+    int num_args = context->get_num_args();
+    std::vector<StringArg> strs;
+    for (int k = 0; k < num_args; ++k) {
+        strs.emplace_back(context, args, k);
+    }
+    if (num_args == 1) {
+        for_each_not_null_row(sel, n, result, [&](int i) {
+            const StringValue& value = strs[0].get(i);
+            set_sub_string(strs[0], value.ptr, value.len, i, result);
+        });
+        return;
+    }
+    StringValue* values = result->values<StringValue>();
+    for_each_not_null_row(sel, n, result, [&](int i) {
+        int total_len = 0;
+        for (auto& str : strs) {
+            total_len += str.get(i).len;
+        }
+        char* buf = result->allocate_string_data(total_len);
+        char* ptr = buf;
+        for (auto& str : strs) {
+            const StringValue& value = str.get(i);
+            memcpy(ptr, value.ptr, value.len);
+            ptr += value.len;
+        }
+        values[i] = StringValue(buf, total_len);
+    });
+}
+
+void StringBatchFunctions::regexp_replace(FunctionContext* context, ExprColumn* const* args,
+                                          const int* sel, int n, ExprColumn* result) {
+    StringArg str(context, args, 0);
+    StringArg pattern(context, args, 1);
+    StringArg replace(context, args, 2);
+    StringValue* values = result->values<StringValue>();
+    // compiled by regexp_prepare() if the pattern is constant
+    re2::RE2* re = reinterpret_cast<re2::RE2*>(
+            context->get_function_state(FunctionContext::FRAGMENT_LOCAL));
+    if (re == NULL) {
+        uint8_t* nulls = result->nulls();
+        for_each_not_null_row(sel, n, result, [&](int i) {
+            StringVal value;
+            str.get(i).to_string_val(&value);
+            StringVal pattern_value;
+            pattern.get(i).to_string_val(&pattern_value);
+            StringVal replace_value;
+            replace.get(i).to_string_val(&replace_value);
+            StringVal res = StringFunctions::regexp_replace(
+                    context, value, pattern_value, replace_value);
+            if (res.is_null) {
+                nulls[i] = 1;
+                return;
+            }
+            char* buf = result->allocate_string_data(res.len);
+            memcpy(buf, res.ptr, res.len);
+            values[i] = StringValue(buf, res.len);
+        });
+        return;
+    }
+    std::string buffer;
+    for_each_not_null_row(sel, n, result, [&](int i) {
+        const StringValue& value = str.get(i);
+        const StringValue& replace_value = replace.get(i);
+        buffer.assign(value.ptr, value.len);
+        re2::RE2::GlobalReplace(&buffer, *re,
+                                re2::StringPiece(replace_value.ptr, replace_value.len));
+        char* buf = result->allocate_string_data(buffer.size());
+        memcpy(buf, buffer.data(), buffer.size());
+        values[i] = StringValue(buf, buffer.size());
+    });
+}
+
+StringBatchFunctions::BatchFn StringBatchFunctions::get_batch_fn(
+        const std::string& name, int num_args) {
+    if (num_args == 1) {
+        if (name == "lower" || name == "lcase") {
+            return lower;
+        }
+        if (name == "upper" || name == "ucase") {
+            return upper;
+        }
+        if (name == "trim") {
+            return trim;
+        }
+        if (name == "ltrim") {
+            return ltrim;
+        }
+        if (name == "rtrim") {
+            return rtrim;
+        }
+    }
+    if ((name == "substr" || name == "substring") && (num_args == 2 || num_args == 3)) {
+        return substring;
+    }
+    if (name == "left" && num_args == 2) {
+        return left;
+    }
+    if (name == "right" && num_args == 2) {
+        return right;
+    }
+    if (name == "concat" && num_args >= 1) {
+        return concat;
+    }
+    if (name == "regexp_replace" && num_args == 3) {
+        return regexp_replace;
+    }
+    return NULL;
+}
+
+}
@@ -0,0 +1,82 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_EXPRS_STRING_BATCH_FUNCTIONS_H
+#define DORIS_BE_SRC_EXPRS_STRING_BATCH_FUNCTIONS_H
+
+#include <string>
+
+#include "udf/udf.h"
+
+namespace doris {
+
+class ExprColumn;
+
+// Batch versions of string builtins for ScalarFnCall::evaluate_batch(). They
+// use the values of constant arguments from the FunctionContext, these
+// arguments are not evaluated for the batch and their columns are NULL.
+// 'result' is reset to the rows of the batch by the caller, which sets the
+// nulls of the rows with a null argument, these rows are skipped. The results
+// are views of the input where they can be, other strings are built in the
+// string data of 'result'.
+//
+// Kept apart from StringFunctions, which is compiled to IR as well.
+class StringBatchFunctions {
+public:
+    typedef void (*BatchFn)(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                            const int* sel, int n, ExprColumn* result);
+
+    // Returns the batch function of the string builtin 'name' with 'num_args'
+    // arguments, NULL if there is none.
+    static BatchFn get_batch_fn(const std::string& name, int num_args);
+
+    static void lower(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                      const int* sel, int n, ExprColumn* result);
+    static void upper(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                      const int* sel, int n, ExprColumn* result);
+    static void trim(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                     const int* sel, int n, ExprColumn* result);
+    static void ltrim(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                      const int* sel, int n, ExprColumn* result);
+    static void rtrim(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                      const int* sel, int n, ExprColumn* result);
+    // substring(str, pos) and substring(str, pos, len)
+    static void substring(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                          const int* sel, int n, ExprColumn* result);
+    static void left(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                     const int* sel, int n, ExprColumn* result);
+    static void right(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                      const int* sel, int n, ExprColumn* result);
+    static void concat(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                       const int* sel, int n, ExprColumn* result);
+    static void regexp_replace(doris_udf::FunctionContext* context, ExprColumn* const* args,
+                               const int* sel, int n, ExprColumn* result);
+
+    // 'A' to 'Z' to lower case and 'a' to 'z' to upper case, other bytes are
+    // kept as ::tolower() and ::toupper() do, 16 bytes at a time
+    static void to_lower_ascii(const char* src, int len, char* dst);
+    static void to_upper_ascii(const char* src, int len, char* dst);
+
+    // position of the first byte which is not a space, 'len' if there is none
+    static int find_first_not_space(const char* str, int len);
+    // position after the last byte which is not a space, 0 if there is none
+    static int find_end_not_space(const char* str, int len);
+};
+
+}
+
+#endif
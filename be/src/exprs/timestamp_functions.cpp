@@ -17,10 +17,7 @@
 
 #include "exprs/timestamp_functions.h"
 
-#include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/date_time/gregorian/gregorian.hpp>
-#include <boost/date_time/time_zone_base.hpp>
-#include <boost/date_time/local_time/local_time.hpp>
+#include <cstdlib>
 
 #include "exprs/expr.h"
 #include "exprs/anyval_util.h"
@@ -35,10 +32,8 @@
 
 namespace doris {
 
-boost::local_time::tz_database TimezoneDatabase::_s_tz_database;
-std::vector<std::string> TimezoneDatabase::_s_tz_region_list;
-
 void TimestampFunctions::init() {
+    TimezoneDatabase::init();
 }
 
 StringVal TimestampFunctions::from_unix(
@@ -409,7 +404,10 @@ StringVal TimestampFunctions::date_format(
         return StringVal::null();
     }
     DateTimeValue ts_value = DateTimeValue::from_datetime_val(ts_val);
-    if (ts_value.compute_format_len((const char*)format.ptr, format.len) >= 128) {
+    bool* too_long = reinterpret_cast<bool*>(
+        ctx->get_function_state(FunctionContext::FRAGMENT_LOCAL));
+    if (too_long != NULL ? *too_long
+            : ts_value.compute_format_len((const char*)format.ptr, format.len) >= 128) {
         return StringVal::null();
     }
     char buf[128];
@@ -419,6 +417,30 @@ StringVal TimestampFunctions::date_format(
     return AnyValUtil::from_string_temp(ctx, buf);
 }
 
+void TimestampFunctions::date_format_prepare(
+        FunctionContext* context, FunctionContext::FunctionStateScope scope) {
+    if (scope != FunctionContext::FRAGMENT_LOCAL || !context->is_arg_constant(1)) {
+        return;
+    }
+    StringVal* format = reinterpret_cast<StringVal*>(context->get_constant_arg(1));
+    if (format->is_null) {
+        return;
+    }
+    // the length only depends on the format
+    DateTimeValue ts_value;
+    bool* too_long = new bool(
+        ts_value.compute_format_len((const char*)format->ptr, format->len) >= 128);
+    context->set_function_state(scope, too_long);
+}
+
+void TimestampFunctions::date_format_close(
+        FunctionContext* context, FunctionContext::FunctionStateScope scope) {
+    if (scope != FunctionContext::FRAGMENT_LOCAL) {
+        return;
+    }
+    delete reinterpret_cast<bool*>(context->get_function_state(scope));
+}
+
 DateTimeVal TimestampFunctions::from_days(
         FunctionContext* ctx, const IntVal& days) {
     if (days.is_null) {
@@ -472,6 +494,91 @@ DateTimeVal TimestampFunctions::timestamp(
     return val;
 }
 
+// Timezones of convert_tz() which are constant, NULL if they are not known.
+struct ConvertTzState {
+    bool from_constant = false;
+    bool to_constant = false;
+    const Timezone* from = NULL;
+    const Timezone* to = NULL;
+    Timezone from_fixed;
+    Timezone to_fixed;
+};
+
+void TimestampFunctions::convert_tz_prepare(
+        FunctionContext* context, FunctionContext::FunctionStateScope scope) {
+    if (scope != FunctionContext::FRAGMENT_LOCAL) {
+        return;
+    }
+    ConvertTzState* state = new ConvertTzState();
+    if (context->is_arg_constant(1)) {
+        StringVal* tz = reinterpret_cast<StringVal*>(context->get_constant_arg(1));
+        state->from_constant = true;
+        if (!tz->is_null) {
+            state->from = TimezoneDatabase::parse_timezone(
+                AnyValUtil::to_string(*tz), &state->from_fixed);
+        }
+    }
+    if (context->is_arg_constant(2)) {
+        StringVal* tz = reinterpret_cast<StringVal*>(context->get_constant_arg(2));
+        state->to_constant = true;
+        if (!tz->is_null) {
+            state->to = TimezoneDatabase::parse_timezone(
+                AnyValUtil::to_string(*tz), &state->to_fixed);
+        }
+    }
+    context->set_function_state(scope, state);
+}
+
+void TimestampFunctions::convert_tz_close(
+        FunctionContext* context, FunctionContext::FunctionStateScope scope) {
+    if (scope != FunctionContext::FRAGMENT_LOCAL) {
+        return;
+    }
+    delete reinterpret_cast<ConvertTzState*>(context->get_function_state(scope));
+}
+
+DateTimeVal TimestampFunctions::convert_tz(
+        FunctionContext* ctx, const DateTimeVal& ts_val,
+        const StringVal& from_tz, const StringVal& to_tz) {
+    if (ts_val.is_null || from_tz.is_null || to_tz.is_null) {
+        return DateTimeVal::null();
+    }
+    ConvertTzState* state = reinterpret_cast<ConvertTzState*>(
+        ctx->get_function_state(FunctionContext::FRAGMENT_LOCAL));
+    Timezone from_fixed;
+    Timezone to_fixed;
+    const Timezone* from = NULL;
+    const Timezone* to = NULL;
+    if (state != NULL && state->from_constant) {
+        from = state->from;
+    } else {
+        from = TimezoneDatabase::parse_timezone(AnyValUtil::to_string(from_tz), &from_fixed);
+    }
+    if (state != NULL && state->to_constant) {
+        to = state->to;
+    } else {
+        to = TimezoneDatabase::parse_timezone(AnyValUtil::to_string(to_tz), &to_fixed);
+    }
+    if (from == NULL || to == NULL) {
+        return DateTimeVal::null();
+    }
+
+    DateTimeValue ts_value = DateTimeValue::from_datetime_val(ts_val);
+    int64_t local_seconds =
+        (static_cast<int64_t>(ts_value.daynr()) - DateTimeValue::calc_daynr(1970, 1, 1)) * 86400
+        + ts_value.hour() * 3600 + ts_value.minute() * 60 + ts_value.second();
+    int64_t utc_seconds = from->to_utc(local_seconds);
+    int64_t delta = to->from_utc(utc_seconds) - local_seconds;
+    ts_value.set_type(TIME_DATETIME);
+    if (delta != 0 && !ts_value.date_add_interval(
+            TimeInterval(SECOND, std::abs(delta), delta < 0), SECOND)) {
+        return DateTimeVal::null();
+    }
+    DateTimeVal result;
+    ts_value.to_datetime_val(&result);
+    return result;
+}
+
 void* TimestampFunctions::from_utc(Expr* e, TupleRow* row) {
     return NULL;
     // DCHECK_EQ(e->get_num_children(), 2);
@@ -535,74 +642,4 @@ void* TimestampFunctions::to_utc(Expr* e, TupleRow* row) {
     // return &e->_result.timestamp_val;
 }
 
-TimezoneDatabase::TimezoneDatabase() {
-    // Create a temporary file and write the timezone information.  The boost
-    // interface only loads this format from a file.  We don't want to raise
-    // an error here since this is done when the backend is created and this
-    // information might not actually get used by any queries.
-    char filestr[] = "/tmp/doris.tzdb.XXXXXXX";
-    FILE* file = NULL;
-    int fd = -1;
-
-    if ((fd = mkstemp(filestr)) == -1) {
-        LOG(ERROR) << "Could not create temporary timezone file: " << filestr;
-        return;
-    }
-
-    if ((file = fopen(filestr, "w")) == NULL) {
-        unlink(filestr);
-        close(fd);
-        LOG(ERROR) << "Could not open temporary timezone file: " << filestr;
-        return;
-    }
-
-    if (fputs(_s_timezone_database_str, file) == EOF) {
-        unlink(filestr);
-        close(fd);
-        fclose(file);
-        LOG(ERROR) << "Could not load temporary timezone file: " << filestr;
-        return;
-    }
-
-    fclose(file);
-    _s_tz_database.load_from_file(std::string(filestr));
-    _s_tz_region_list = _s_tz_database.region_list();
-    unlink(filestr);
-    close(fd);
-}
-
-TimezoneDatabase::~TimezoneDatabase() { }
-
-boost::local_time::time_zone_ptr TimezoneDatabase::find_timezone(const std::string& tz) {
-    // See if they specified a zone id
-    if (tz.find_first_of('/') != std::string::npos) {
-        return  _s_tz_database.time_zone_from_region(tz);
-    }
-
-    for (std::vector<std::string>::const_iterator iter = _s_tz_region_list.begin();
-            iter != _s_tz_region_list.end(); ++iter) {
-        boost::local_time::time_zone_ptr tzp = _s_tz_database.time_zone_from_region(*iter);
-        DCHECK(tzp != NULL);
-
-        if (tzp->dst_zone_abbrev() == tz) {
-            return tzp;
-        }
-
-        if (tzp->std_zone_abbrev() == tz) {
-            return tzp;
-        }
-
-        if (tzp->dst_zone_name() == tz) {
-            return tzp;
-        }
-
-        if (tzp->std_zone_name() == tz) {
-            return tzp;
-        }
-    }
-
-    return boost::local_time::time_zone_ptr();
-
-}
-
 }
@@ -18,10 +18,12 @@
 #ifndef DORIS_BE_SRC_QUERY_EXPRS_TIMESTAMP_FUNCTIONS_H
 #define DORIS_BE_SRC_QUERY_EXPRS_TIMESTAMP_FUNCTIONS_H
 
-#include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/date_time/gregorian/gregorian.hpp>
-#include <boost/date_time/time_zone_base.hpp>
-#include <boost/date_time/local_time/local_time.hpp>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <boost/thread/thread.hpp>
 #include "runtime/string_value.h"
 #include "runtime/datetime_value.h"
@@ -152,6 +154,24 @@ public:
     static doris_udf::DateTimeVal timestamp(
         doris_udf::FunctionContext* ctx, const doris_udf::DateTimeVal& val);
 
+    // Converts 'ts_val' from local time of 'from_tz' to local time of 'to_tz'.
+    // Timezones are names of the database or offsets like '+08:00', null if
+    // they are not known.
+    static doris_udf::DateTimeVal convert_tz(
+        doris_udf::FunctionContext* ctx, const doris_udf::DateTimeVal& ts_val,
+        const doris_udf::StringVal& from_tz, const doris_udf::StringVal& to_tz);
+    // Looks up constant timezones once.
+    static void convert_tz_prepare(
+        doris_udf::FunctionContext* context, doris_udf::FunctionContext::FunctionStateScope scope);
+    static void convert_tz_close(
+        doris_udf::FunctionContext* context, doris_udf::FunctionContext::FunctionStateScope scope);
+
+    // Checks the length of a constant format once.
+    static void date_format_prepare(
+        doris_udf::FunctionContext* context, doris_udf::FunctionContext::FunctionStateScope scope);
+    static void date_format_close(
+        doris_udf::FunctionContext* context, doris_udf::FunctionContext::FunctionStateScope scope);
+
     // Helper for add/sub functions on the time portion.
     template <TimeUnit unit>
     static doris_udf::DateTimeVal timestamp_time_op(
@@ -171,18 +191,73 @@ public:
 
 };
 
-// Functions to load and access the timestamp database.
+// A timezone of the database. It converts between UTC and local time by its
+// standard offset and its yearly DST rule, whose transitions are computed once
+// into a sorted table for the years most data is in.
+class Timezone {
+public:
+    // a timezone with a fixed offset from UTC
+    explicit Timezone(int offset_seconds = 0);
+
+    // Offset of local time from UTC in seconds at 'utc_seconds' since the epoch.
+    int utc_offset(int64_t utc_seconds) const;
+
+    // Seconds since the epoch of 'local_seconds', local time in seconds since
+    // 1970-01-01 00:00:00. Local times which happen twice when DST ends are
+    // taken as DST, times skipped when DST starts as standard time.
+    int64_t to_utc(int64_t local_seconds) const;
+
+    int64_t from_utc(int64_t utc_seconds) const {
+        return utc_seconds + utc_offset(utc_seconds);
+    }
+
+private:
+    friend class TimezoneDatabase;
+
+    // DST starts or ends on a weekday of a month, 'week' from 1, -1 is the last
+    // one, at 'seconds' of the day in local time before the transition
+    struct DstRule {
+        int week;
+        int weekday;
+        int month;
+        int seconds;
+    };
+
+    // UTC seconds of the start and end of DST in 'year'
+    void dst_transitions(int year, int64_t* start, int64_t* end) const;
+    bool is_dst(int64_t utc_seconds) const;
+
+    int _std_offset;
+    int _dst_adjustment;
+    bool _has_dst;
+    DstRule _dst_start;
+    DstRule _dst_end;
+    // UTC seconds of all transitions from FIRST_YEAR to LAST_YEAR, every other
+    // one starts DST
+    std::vector<int64_t> _transitions;
+    bool _first_transition_starts_dst;
+};
+
+// The timezones of the database in timezone_db.cpp, parsed once by init().
 class TimezoneDatabase {
 public:
-    TimezoneDatabase();
-    ~TimezoneDatabase();
+    static void init();
+
+    // 'tz' is a region like 'Asia/Shanghai' or the abbreviation or name of the
+    // standard or DST time of a region. Returns NULL if it is unknown.
+    static const Timezone* find_timezone(const std::string& tz);
+
+    // As find_timezone(), or 'UTC' or a fixed offset like '+08:00', which is
+    // stored in 'fixed'. Returns NULL if 'tz' is neither.
+    static const Timezone* parse_timezone(const std::string& tz, Timezone* fixed);
 
-    static boost::local_time::time_zone_ptr find_timezone(const std::string& tz);
+    static const int FIRST_YEAR = 1970;
+    static const int LAST_YEAR = 2100;
 
 private:
     static const char* _s_timezone_database_str;
-    static boost::local_time::tz_database _s_tz_database;
-    static std::vector<std::string> _s_tz_region_list;
+    static std::vector<Timezone> _s_timezones;
+    static std::unordered_map<std::string, int> _s_timezone_index;
 };
 
 }
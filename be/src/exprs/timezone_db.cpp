@@ -15,7 +15,15 @@
 // specific language governing permissions and limitations
 // under the License.
 
-#include "timestamp_functions.h"
+#include "exprs/timestamp_functions.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "common/logging.h"
 
 namespace doris {
 const char* TimezoneDatabase::_s_timezone_database_str =
@@ -405,4 +413,255 @@ const char* TimezoneDatabase::_s_timezone_database_str =
 \"Pacific/Yap\",\"YAPT\",\"YAPT\",\"\",\"\",\
 \"+10:00:00\",\"+00:00:00\",\"\",\"\",\"\",\"+00:00:00\"\n";
 
+
+std::vector<Timezone> TimezoneDatabase::_s_timezones;
+std::unordered_map<std::string, int> TimezoneDatabase::_s_timezone_index;
+
+static const int64_t SECONDS_PER_DAY = 86400;
+
+// days since 1970-01-01 of a date of the proleptic Gregorian calendar
+static int64_t days_from_civil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+static int year_from_days(int64_t days) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t day_of_era = days - era * 146097;
+    int64_t year_of_era =
+        (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t mp = (5 * day_of_year + 2) / 153;
+    int month = mp < 10 ? mp + 3 : mp - 9;
+    return year_of_era + era * 400 + (month <= 2);
+}
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+// 0 is Sunday
+static int weekday_of_days(int64_t days) {
+    return ((days + 4) % 7 + 7) % 7;
+}
+
+Timezone::Timezone(int offset_seconds) :
+        _std_offset(offset_seconds),
+        _dst_adjustment(0),
+        _has_dst(false),
+        _dst_start(),
+        _dst_end(),
+        _first_transition_starts_dst(true) {
+}
+
+static int64_t rule_day(int year, int week, int weekday, int month) {
+    if (week < 0) {
+        int64_t last = month == 12 ? days_from_civil(year + 1, 1, 1) - 1
+            : days_from_civil(year, month + 1, 1) - 1;
+        return last - (weekday_of_days(last) - weekday + 7) % 7;
+    }
+    int64_t first = days_from_civil(year, month, 1);
+    return first + (weekday - weekday_of_days(first) + 7) % 7 + (week - 1) * 7;
+}
+
+void Timezone::dst_transitions(int year, int64_t* start, int64_t* end) const {
+    *start = rule_day(year, _dst_start.week, _dst_start.weekday, _dst_start.month)
+        * SECONDS_PER_DAY + _dst_start.seconds - _std_offset;
+    *end = rule_day(year, _dst_end.week, _dst_end.weekday, _dst_end.month)
+        * SECONDS_PER_DAY + _dst_end.seconds - _std_offset - _dst_adjustment;
+}
+
+bool Timezone::is_dst(int64_t utc_seconds) const {
+    int year = year_from_days(floor_div(utc_seconds + _std_offset, SECONDS_PER_DAY));
+    int64_t start = 0;
+    int64_t end = 0;
+    dst_transitions(year, &start, &end);
+    if (start < end) {
+        return utc_seconds >= start && utc_seconds < end;
+    }
+    // DST over the turn of the year on the southern hemisphere
+    return utc_seconds >= start || utc_seconds < end;
+}
+
+int Timezone::utc_offset(int64_t utc_seconds) const {
+    if (!_has_dst) {
+        return _std_offset;
+    }
+    bool dst = false;
+    if (!_transitions.empty()
+            && utc_seconds >= _transitions.front() && utc_seconds < _transitions.back()) {
+        size_t index = std::upper_bound(_transitions.begin(), _transitions.end(), utc_seconds)
+            - _transitions.begin() - 1;
+        dst = (index % 2 == 0) == _first_transition_starts_dst;
+    } else {
+        dst = is_dst(utc_seconds);
+    }
+    return dst ? _std_offset + _dst_adjustment : _std_offset;
+}
+
+int64_t Timezone::to_utc(int64_t local_seconds) const {
+    if (_has_dst) {
+        int dst_offset = _std_offset + _dst_adjustment;
+        int64_t utc_seconds = local_seconds - dst_offset;
+        if (utc_offset(utc_seconds) == dst_offset) {
+            return utc_seconds;
+        }
+    }
+    return local_seconds - _std_offset;
+}
+
+// "+HH:MM:SS" of the database, or "+HH:MM" if 'with_seconds' is false
+static bool parse_offset(const std::string& str, bool with_seconds, int* seconds) {
+    if (str.size() < 2 || (str[0] != '+' && str[0] != '-')) {
+        return false;
+    }
+    const char* ptr = str.c_str() + 1;
+    char* end = NULL;
+    long hours = strtol(ptr, &end, 10);
+    if (end == ptr || end - ptr > 2 || *end != ':') {
+        return false;
+    }
+    ptr = end + 1;
+    long minutes = strtol(ptr, &end, 10);
+    if (end - ptr != 2 || minutes >= 60) {
+        return false;
+    }
+    long secs = 0;
+    if (with_seconds) {
+        if (*end != ':') {
+            return false;
+        }
+        ptr = end + 1;
+        secs = strtol(ptr, &end, 10);
+        if (end - ptr != 2 || secs >= 60) {
+            return false;
+        }
+    } else if (hours > 14) {
+        return false;
+    }
+    if (*end != '\0') {
+        return false;
+    }
+    *seconds = (hours * 3600 + minutes * 60 + secs) * (str[0] == '-' ? -1 : 1);
+    return true;
+}
+
+// "week;weekday;month"
+static bool parse_rule(const std::string& str, int* week, int* weekday, int* month) {
+    return sscanf(str.c_str(), "%d;%d;%d", week, weekday, month) == 3
+        && *week != 0 && *week >= -1 && *week <= 5
+        && *weekday >= 0 && *weekday < 7 && *month >= 1 && *month <= 12;
+}
+
+// the quoted fields of a line of the database
+static std::vector<std::string> split_fields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        if (line[pos] != '"') {
+            break;
+        }
+        size_t end = line.find('"', pos + 1);
+        if (end == std::string::npos) {
+            break;
+        }
+        fields.push_back(line.substr(pos + 1, end - pos - 1));
+        pos = end + 2;
+    }
+    return fields;
+}
+
+void TimezoneDatabase::init() {
+    if (!_s_timezones.empty()) {
+        return;
+    }
+    std::vector<std::vector<std::string>> rows;
+    const char* ptr = _s_timezone_database_str;
+    // the first line is the header
+    ptr = strchr(ptr, '\n') + 1;
+    while (*ptr != '\0') {
+        const char* end = strchr(ptr, '\n');
+        if (end == NULL) {
+            end = ptr + strlen(ptr);
+        }
+        std::vector<std::string> fields = split_fields(std::string(ptr, end));
+        ptr = *end == '\0' ? end : end + 1;
+
+        Timezone timezone;
+        if (fields.size() != 11
+                || !parse_offset(fields[5], true, &timezone._std_offset)
+                || !parse_offset(fields[6], true, &timezone._dst_adjustment)) {
+            LOG(WARNING) << "invalid timezone in database, fields=" << fields.size();
+            continue;
+        }
+        Timezone::DstRule* start = &timezone._dst_start;
+        Timezone::DstRule* end_rule = &timezone._dst_end;
+        if (!fields[7].empty() && timezone._dst_adjustment != 0) {
+            if (!parse_rule(fields[7], &start->week, &start->weekday, &start->month)
+                    || !parse_rule(fields[9], &end_rule->week, &end_rule->weekday,
+                                   &end_rule->month)
+                    || !parse_offset(fields[8], true, &start->seconds)
+                    || !parse_offset(fields[10], true, &end_rule->seconds)) {
+                LOG(WARNING) << "invalid DST rule of timezone " << fields[0];
+                continue;
+            }
+            timezone._has_dst = true;
+        }
+        if (timezone._has_dst) {
+            for (int year = FIRST_YEAR; year <= LAST_YEAR; ++year) {
+                int64_t dst_start = 0;
+                int64_t dst_end = 0;
+                timezone.dst_transitions(year, &dst_start, &dst_end);
+                if (year == FIRST_YEAR) {
+                    timezone._first_transition_starts_dst = dst_start < dst_end;
+                }
+                timezone._transitions.push_back(std::min(dst_start, dst_end));
+                timezone._transitions.push_back(std::max(dst_start, dst_end));
+            }
+        }
+
+        int index = _s_timezones.size();
+        _s_timezones.push_back(timezone);
+        _s_timezone_index[fields[0]] = index;
+        rows.push_back(std::move(fields));
+    }
+    // abbreviations and names refer to the first region which has them
+    for (size_t i = 0; i < rows.size(); ++i) {
+        for (int field : {3, 1, 4, 2}) {
+            if (!rows[i][field].empty()) {
+                _s_timezone_index.emplace(rows[i][field], i);
+            }
+        }
+    }
+    LOG(INFO) << "loaded " << _s_timezones.size() << " timezones";
+}
+
+const Timezone* TimezoneDatabase::find_timezone(const std::string& tz) {
+    auto it = _s_timezone_index.find(tz);
+    if (it == _s_timezone_index.end()) {
+        return NULL;
+    }
+    return &_s_timezones[it->second];
+}
+
+const Timezone* TimezoneDatabase::parse_timezone(const std::string& tz, Timezone* fixed) {
+    const Timezone* timezone = find_timezone(tz);
+    if (timezone != NULL) {
+        return timezone;
+    }
+    int offset = 0;
+    if (tz == "UTC") {
+        offset = 0;
+    } else if (!parse_offset(tz, false, &offset)) {
+        return NULL;
+    }
+    *fixed = Timezone(offset);
+    return fixed;
+}
+
 }
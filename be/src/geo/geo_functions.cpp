@@ -17,6 +17,7 @@
 
 #include "geo/geo_functions.h"
 
+#include <s2/s2cell_id.h>
 #include <s2/s2earth.h>
 #include <s2/s2debug.h>
 
@@ -66,6 +67,21 @@ doris_udf::StringVal GeoFunctions::st_point(doris_udf::FunctionContext* ctx,
     return result;
 }
 
+BigIntVal GeoFunctions::st_cell_id(doris_udf::FunctionContext* ctx,
+                                   const doris_udf::DoubleVal& x,
+                                   const doris_udf::DoubleVal& y) {
+    if (x.is_null || y.is_null) {
+        return BigIntVal::null();
+    }
+    S2LatLng lat_lng = S2LatLng::FromDegrees(y.val, x.val);
+    if (!lat_lng.is_valid()) {
+        return BigIntVal::null();
+    }
+    // ids of faces 4 and 5 are negative, the ids of a cell are contiguous all
+    // the same
+    return BigIntVal(static_cast<int64_t>(S2CellId(lat_lng).id()));
+}
+
 DoubleVal GeoFunctions::st_x(doris_udf::FunctionContext* ctx,
                              const doris_udf::StringVal& point_encoded) {
     if (point_encoded.is_null) {
@@ -238,6 +254,8 @@ struct StContainsState {
     }
     bool is_null;
     GeoShape* shapes[2];
+    // built if the first shape is a constant polygon
+    std::unique_ptr<GeoPolygonIndex> polygon_index;
 };
 
 void GeoFunctions::st_contains_prepare(doris_udf::FunctionContext* ctx,
@@ -262,6 +280,11 @@ void GeoFunctions::st_contains_prepare(doris_udf::FunctionContext* ctx,
             }
         }
     }
+    GeoShape* shape = contains_ctx->shapes[0];
+    if (shape != nullptr && shape->type() == GEO_SHAPE_POLYGON) {
+        contains_ctx->polygon_index.reset(
+            new GeoPolygonIndex(static_cast<GeoPolygon*>(shape)));
+    }
     ctx->set_function_state(scope, contains_ctx.release());
 }
 
@@ -286,6 +309,18 @@ doris_udf::BooleanVal GeoFunctions::st_contains(
     if (state != nullptr && state->is_null) {
         return BooleanVal::null();
     }
+    // points of rows against a constant shape, the point is decoded in place
+    if (state != nullptr && state->shapes[0] != nullptr && state->shapes[1] == nullptr
+            && rhs.len >= 2 && rhs.ptr[1] == GEO_SHAPE_POINT) {
+        GeoPoint point;
+        if (!point.decode_from(rhs.ptr, rhs.len)) {
+            return BooleanVal::null();
+        }
+        if (state->polygon_index != nullptr) {
+            return state->polygon_index->contains(point.point());
+        }
+        return state->shapes[0]->contains(&point);
+    }
     GeoShape* shapes[2] = {nullptr, nullptr};
     const StringVal* strs[2] = {&lhs, &rhs};
     // use this to delete new
@@ -37,6 +37,13 @@ public:
                                          const doris_udf::DoubleVal& x,
                                          const doris_udf::DoubleVal& y);
 
+    // id of the leaf S2 cell of a point. Cells are ranges of ids, a column of
+    // them sorts points near each other together and lets zone maps prune
+    // the blocks out of a covering of an area
+    static doris_udf::BigIntVal st_cell_id(doris_udf::FunctionContext* ctx,
+                                           const doris_udf::DoubleVal& x,
+                                           const doris_udf::DoubleVal& y);
+
     static doris_udf::DoubleVal st_x(doris_udf::FunctionContext* ctx,
                                      const doris_udf::StringVal& point);
     static doris_udf::DoubleVal st_y(doris_udf::FunctionContext* ctx,
@@ -24,6 +24,7 @@
 #include <s2/s2latlng.h>
 #include <s2/s2cell.h>
 #include <s2/s2earth.h>
+#include <s2/s2region_coverer.h>
 #include <s2/util/coding/coder.h>
 #include <s2/util/units/length-units.h>
 
@@ -278,6 +279,26 @@ bool GeoPolygon::decode(const void* data, size_t size) {
     return _polygon->Decode(&decoder);
 }
 
+GeoPolygonIndex::GeoPolygonIndex(const GeoPolygon* polygon, int max_cells)
+        : _polygon(polygon->polygon()) {
+    S2RegionCoverer::Options options;
+    options.set_max_cells(max_cells);
+    S2RegionCoverer coverer(options);
+    _interior = coverer.GetInteriorCovering(*_polygon);
+    _covering = coverer.GetCovering(*_polygon);
+}
+
+bool GeoPolygonIndex::contains(const S2Point& point) const {
+    S2CellId cell(point);
+    if (!_covering.Contains(cell)) {
+        return false;
+    }
+    if (_interior.Contains(cell)) {
+        return true;
+    }
+    return _polygon->Contains(point);
+}
+
 std::string GeoLine::as_wkt() const {
     std::stringstream ss;
     ss << "LINESTRING (";
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include <s2/s2cap.h>
+#include <s2/s2cell_union.h>
 #include <s2/s2point.h>
 #include <s2/s2polyline.h>
 #include <s2/s2polygon.h>
@@ -123,6 +124,22 @@ private:
     std::unique_ptr<S2Polygon> _polygon;
 };
 
+// Tests if many points are in one polygon. Cells of the interior covering are
+// entirely in the polygon and points out of the covering are out of it, only
+// the points of the cells crossed by its edges are tested exactly.
+class GeoPolygonIndex {
+public:
+    // 'polygon' must outlive the index
+    explicit GeoPolygonIndex(const GeoPolygon* polygon, int max_cells = 64);
+
+    bool contains(const S2Point& point) const;
+
+private:
+    const S2Polygon* _polygon;
+    S2CellUnion _interior;
+    S2CellUnion _covering;
+};
+
 class GeoCircle : public GeoShape {
 public:
     GeoCircle() { }
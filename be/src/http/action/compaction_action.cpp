@@ -0,0 +1,92 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "http/action/compaction_action.h"
+
+#include <string>
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "http/http_channel.h"
+#include "http/http_headers.h"
+#include "http/http_request.h"
+#include "http/http_status.h"
+#include "olap/olap_define.h"
+#include "olap/olap_engine.h"
+#include "olap/olap_table.h"
+#include "util/json_util.h"
+
+namespace doris {
+
+const static std::string HEADER_JSON = "application/json";
+
+Status CompactionScoreAction::_handle_score(HttpRequest *req, std::string* json_result) {
+    req->add_output_header(HttpHeaders::CONTENT_TYPE, HEADER_JSON.c_str());
+    std::string req_tablet_id = req->param(TABLET_ID_KEY);
+    std::string req_schema_hash = req->param(TABLET_SCHEMA_HASH_KEY);
+    if (req_tablet_id == "" || req_schema_hash == "") {
+        LOG(WARNING) << "invalid argument.tablet_id:" << req_tablet_id
+                << ", schema_hash:" << req_schema_hash;
+        return Status("invalid arguments");
+    }
+    uint64_t tablet_id = std::stoull(req_tablet_id);
+    uint32_t schema_hash = std::stoul(req_schema_hash);
+    OLAPTablePtr olap_table = OLAPEngine::get_instance()->get_table(tablet_id, schema_hash);
+    if (olap_table == nullptr) {
+        LOG(WARNING) << "no tablet for tablet_id:" << tablet_id << " schema hash:" << schema_hash;
+        return Status("no tablet exist");
+    }
+
+    rapidjson::Document root;
+    root.SetObject();
+    rapidjson::Document::AllocatorType& allocator = root.GetAllocator();
+    root.AddMember("tablet_id", tablet_id, allocator);
+    root.AddMember("schema_hash", schema_hash, allocator);
+    {
+        ReadLock rdlock(olap_table->get_header_lock_ptr());
+        root.AddMember("version_count", olap_table->file_delta_size(), allocator);
+        root.AddMember("cumulative_layer_point", olap_table->cumulative_layer_point(), allocator);
+        root.AddMember("cumulative_compaction_score",
+                       olap_table->get_cumulative_compaction_score(), allocator);
+        root.AddMember("base_compaction_score",
+                       olap_table->get_base_compaction_score(), allocator);
+    }
+    rapidjson::Value policy(config::cumulative_compaction_policy.c_str(), allocator);
+    root.AddMember("cumulative_compaction_policy", policy, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    root.Accept(writer);
+    *json_result = buffer.GetString();
+    return Status::OK;
+}
+
+void CompactionScoreAction::handle(HttpRequest *req) {
+    std::string json_result;
+    Status status = _handle_score(req, &json_result);
+    if (status.ok()) {
+        HttpChannel::send_reply(req, HttpStatus::OK, json_result);
+    } else {
+        HttpChannel::send_reply(req, HttpStatus::INTERNAL_SERVER_ERROR, to_json(status));
+    }
+}
+
+} // end namespace doris
@@ -37,6 +37,9 @@ public:
 private:
     void _visit_simple_metric(
         const std::string& name, const MetricLabels& labels, SimpleMetric* metric);
+    void _visit_histogram(
+        const std::string& name, const MetricLabels& labels, Histogram* histogram);
+    void _output_labels(const MetricLabels& labels, const std::string& le);
 private:
     std::stringstream _ss;
 };
@@ -91,6 +94,11 @@ void PrometheusMetricsVisitor::visit(const std::string& prefix,
             _visit_simple_metric(metric_name, it.first, (SimpleMetric*) it.second);
         }
         break;
+    case MetricType::HISTOGRAM:
+        for (auto& it : collector->metrics()) {
+            _visit_histogram(metric_name, it.first, (Histogram*) it.second);
+        }
+        break;
     default:
         break;
     }
@@ -99,19 +107,73 @@ void PrometheusMetricsVisitor::visit(const std::string& prefix,
 void PrometheusMetricsVisitor::_visit_simple_metric(
         const std::string& name, const MetricLabels& labels, SimpleMetric* metric) {
     _ss << name;
-    // labels
-    if (!labels.empty()) {
-        _ss << "{";
-        int i = 0;
-        for (auto& label : labels.labels) {
-            if (i++ > 0) {
-                _ss << ",";
-            }
-            _ss << label.name << "=\"" << label.value << "\"";
+    _output_labels(labels, "");
+    _ss << " " << metric->to_string() << "\n";
+}
+
+// eg:
+// palo_be_fragment_request_latency_us_bucket{le="1024"} 10
+// palo_be_fragment_request_latency_us_bucket{le="+Inf"} 12
+// palo_be_fragment_request_latency_us_sum 30800
+// palo_be_fragment_request_latency_us_count 12
+void PrometheusMetricsVisitor::_visit_histogram(
+        const std::string& name, const MetricLabels& labels, Histogram* histogram) {
+    std::vector<int64_t> buckets;
+    histogram->get_buckets(&buckets);
+    int last = Histogram::NUM_BUCKETS - 1;
+    while (last > 0 && buckets[last] == 0) {
+        --last;
+    }
+    // only the buckets ending at powers of two are output, up to the one
+    // holding the largest value
+    int64_t count = 0;
+    for (int i = 0; i < Histogram::NUM_BUCKETS - 1; ++i) {
+        count += buckets[i];
+        int64_t upper = Histogram::bucket_lower_bound(i + 1);
+        if ((upper & (upper - 1)) != 0) {
+            continue;
+        }
+        _ss << name << "_bucket";
+        _output_labels(labels, std::to_string(upper));
+        _ss << " " << count << "\n";
+        if (i >= last) {
+            break;
         }
-        _ss << "}";
     }
-    _ss << " " << metric->to_string() << "\n";
+    count = 0;
+    for (auto bucket : buckets) {
+        count += bucket;
+    }
+    _ss << name << "_bucket";
+    _output_labels(labels, "+Inf");
+    _ss << " " << count << "\n";
+    _ss << name << "_sum";
+    _output_labels(labels, "");
+    _ss << " " << histogram->sum() << "\n";
+    _ss << name << "_count";
+    _output_labels(labels, "");
+    _ss << " " << count << "\n";
+}
+
+void PrometheusMetricsVisitor::_output_labels(const MetricLabels& labels, const std::string& le) {
+    if (labels.empty() && le.empty()) {
+        return;
+    }
+    _ss << "{";
+    int i = 0;
+    for (auto& label : labels.labels) {
+        if (i++ > 0) {
+            _ss << ",";
+        }
+        _ss << label.name << "=\"" << label.value << "\"";
+    }
+    if (!le.empty()) {
+        if (i > 0) {
+            _ss << ",";
+        }
+        _ss << "le=\"" << le << "\"";
+    }
+    _ss << "}";
 }
 
 void SimpleCoreMetricsVisitor::visit(const std::string& prefix,
@@ -17,6 +17,7 @@
 
 #include "http/action/stream_load.h"
 
+#include <algorithm>
 #include <deque>
 #include <future>
 #include <sstream>
@@ -45,6 +46,7 @@
 #include "runtime/fragment_mgr.h"
 #include "runtime/load_path_mgr.h"
 #include "runtime/plan_fragment_executor.h"
+#include "runtime/stream_load/group_commit_mgr.h"
 #include "runtime/stream_load/stream_load_executor.h"
 #include "runtime/stream_load/stream_load_pipe.h"
 #include "runtime/stream_load/stream_load_context.h"
@@ -68,9 +70,14 @@ static IntGauge k_streaming_load_current_processing;
 TStreamLoadPutResult k_stream_load_put_result;
 #endif
 
+static const size_t MIN_CHUNK_BUFFER_SIZE = 4096;
+static const size_t MAX_CHUNK_BUFFER_SIZE = 1024 * 1024;
+
 static TFileFormatType::type parse_format(const std::string& format_str) {
     if (boost::iequals(format_str, "CSV")) {
         return TFileFormatType::FORMAT_CSV_PLAIN;
+    } else if (boost::iequals(format_str, "JSON")) {
+        return TFileFormatType::FORMAT_JSON;
     }
     return TFileFormatType::FORMAT_UNKNOWN;
 }
@@ -78,6 +85,7 @@ static TFileFormatType::type parse_format(const std::string& format_str) {
 static bool is_format_support_streaming(TFileFormatType::type format) {
     switch (format) {
     case TFileFormatType::FORMAT_CSV_PLAIN:
+    case TFileFormatType::FORMAT_JSON:
         return true;
     default:
         return false;
@@ -141,6 +149,10 @@ Status StreamLoadAction::_handle(StreamLoadContext* ctx) {
             << ", id=" << ctx->id;
         return Status("receive body dont't equal with body bytes");
     }
+    if (ctx->group_commit) {
+        return _exec_env->group_commit_mgr()->group_commit(
+                ctx, static_cast<StreamLoadPipe*>(ctx->body_sink.get()));
+    }
     if (!ctx->use_streaming) {
         // if we use non-streaming, we need to close file first,
         // then execute_plan_fragment here
@@ -236,7 +248,17 @@ Status StreamLoadAction::_on_header(HttpRequest* http_req, StreamLoadContext* ct
         }
     }
 
-    TNetworkAddress master_addr = _exec_env->master_info()->network_address;
+    // the body is kept in memory until it is appended to a group as a whole,
+    // the other loads are loaded on their own
+    if (http_req->header(HTTP_GROUP_COMMIT) == "true"
+            && ctx->format == TFileFormatType::FORMAT_CSV_PLAIN
+            && !http_req->header(HttpHeaders::CONTENT_LENGTH).empty()
+            && ctx->body_bytes <= static_cast<size_t>(config::group_commit_max_load_bytes)) {
+        ctx->group_commit = true;
+        _init_put_request(http_req, ctx, &ctx->put_request);
+        ctx->body_sink = std::make_shared<StreamLoadPipe>(ctx->body_bytes + 1);
+        return Status::OK;
+    }
 
     // begin transaction
     RETURN_IF_ERROR(_exec_env->stream_load_executor()->begin_txn(ctx));
@@ -255,11 +277,17 @@ void StreamLoadAction::on_chunk_data(HttpRequest* req) {
     auto evbuf = evhttp_request_get_input_buffer(ev_req);
 
     while (evbuffer_get_length(evbuf) > 0) {
-        auto bb = ByteBuffer::allocate(4096);
+        // lines are read in place from these buffers, so all received data
+        // is taken at once and fewer lines are split between buffers
+        size_t buf_size = std::min(MAX_CHUNK_BUFFER_SIZE,
+                                   std::max(MIN_CHUNK_BUFFER_SIZE, evbuffer_get_length(evbuf)));
+        auto bb = ByteBuffer::allocate(buf_size);
         auto remove_bytes = evbuffer_remove(evbuf, bb->ptr, bb->capacity);
         bb->pos = remove_bytes;
         bb->flip();
-        auto st = ctx->body_sink->append(bb);
+        // all data of the input buffer must be taken here, the connection
+        // is not read any more instead while the pipe is full
+        auto st = ctx->body_sink->append_nowait(bb);
         if (!st.ok()) {
             LOG(WARNING) << "append body content failed. errmsg=" << st.get_error_msg()
                     << ctx->brief();
@@ -268,6 +296,11 @@ void StreamLoadAction::on_chunk_data(HttpRequest* req) {
         }
         ctx->receive_bytes += remove_bytes;
     }
+    if (!ctx->body_sink->has_room()) {
+        req->pause_reading([ctx] () {
+            return !ctx->status.ok() || ctx->body_sink->has_room();
+        });
+    }
 }
 
 void StreamLoadAction::free_handler_ctx(void* param) {
@@ -284,17 +317,48 @@ void StreamLoadAction::free_handler_ctx(void* param) {
     }
 }
 
+void StreamLoadAction::_init_put_request(HttpRequest* http_req, StreamLoadContext* ctx,
+                                         TStreamLoadPutRequest* request) {
+    set_request_auth(request, ctx->auth);
+    request->db = ctx->db;
+    request->tbl = ctx->table;
+    request->formatType = ctx->format;
+    if (!http_req->header(HTTP_COLUMNS).empty()) {
+        request->__set_columns(http_req->header(HTTP_COLUMNS));
+    }
+    if (!http_req->header(HTTP_WHERE).empty()) {
+        request->__set_where(http_req->header(HTTP_WHERE));
+    }
+    if (!http_req->header(HTTP_COLUMN_SEPARATOR).empty()) {
+        request->__set_columnSeparator(http_req->header(HTTP_COLUMN_SEPARATOR));
+    }
+    if (!http_req->header(HTTP_JSONPATHS).empty()) {
+        request->__set_jsonpaths(http_req->header(HTTP_JSONPATHS));
+    }
+    if (!http_req->header(HTTP_PARTITIONS).empty()) {
+        request->__set_partitions(http_req->header(HTTP_PARTITIONS));
+    }
+    if (!http_req->header(HTTP_NEGATIVE).empty()
+            && http_req->header(HTTP_NEGATIVE) == "true") {
+            request->__set_negative(true);
+    } else {
+        request->__set_negative(false);
+    }
+#ifndef BE_TEST
+    if (!http_req->header(HTTP_MAX_FILTER_RATIO).empty()) {
+        ctx->max_filter_ratio = strtod(http_req->header(HTTP_MAX_FILTER_RATIO).c_str(), nullptr);
+    }
+#endif
+}
+
 Status StreamLoadAction::_process_put(HttpRequest* http_req, StreamLoadContext* ctx) {
     // Now we use stream
     ctx->use_streaming = is_format_support_streaming(ctx->format);
     
     // put request
     TStreamLoadPutRequest request;
-    set_request_auth(&request, ctx->auth);
-    request.db = ctx->db;
-    request.tbl = ctx->table;
+    _init_put_request(http_req, ctx, &request);
     request.txnId = ctx->txn_id;
-    request.formatType = ctx->format;
     request.__set_loadId(ctx->id.to_thrift());
     if (ctx->use_streaming) {
         auto pipe = std::make_shared<StreamLoadPipe>();
@@ -309,32 +373,10 @@ Status StreamLoadAction::_process_put(HttpRequest* http_req, StreamLoadContext*
         request.fileType = TFileType::FILE_LOCAL;
         ctx->body_sink = file_sink;
     }
-    if (!http_req->header(HTTP_COLUMNS).empty()) {
-        request.__set_columns(http_req->header(HTTP_COLUMNS));
-    }
-    if (!http_req->header(HTTP_WHERE).empty()) {
-        request.__set_where(http_req->header(HTTP_WHERE));
-    }
-    if (!http_req->header(HTTP_COLUMN_SEPARATOR).empty()) {
-        request.__set_columnSeparator(http_req->header(HTTP_COLUMN_SEPARATOR));
-    }
-    if (!http_req->header(HTTP_PARTITIONS).empty()) {
-        request.__set_partitions(http_req->header(HTTP_PARTITIONS));
-    }
-    if (!http_req->header(HTTP_NEGATIVE).empty()
-            && http_req->header(HTTP_NEGATIVE) == "true") {
-            request.__set_negative(true);
-    } else {
-        request.__set_negative(false);
-    }
 
     // plan this load
     TNetworkAddress master_addr = _exec_env->master_info()->network_address;
 #ifndef BE_TEST
-    if (!http_req->header(HTTP_MAX_FILTER_RATIO).empty()) {
-        ctx->max_filter_ratio = strtod(http_req->header(HTTP_MAX_FILTER_RATIO).c_str(), nullptr);
-    }
-
     RETURN_IF_ERROR(FrontendHelper::rpc(
                 master_addr.hostname, master_addr.port,
             [&request, ctx] (FrontendServiceConnection& client) {
@@ -29,6 +29,7 @@ namespace doris {
 class ExecEnv;
 class Status;
 class StreamLoadContext;
+class TStreamLoadPutRequest;
 
 class StreamLoadAction : public HttpHandler {
 public:
@@ -39,6 +40,9 @@ public:
 
     bool request_will_be_read_progressively() override { return true; }
 
+    // waits for the load to finish and commits it
+    bool handle_may_block() override { return true; }
+
     int on_header(HttpRequest* req) override;
 
     void on_chunk_data(HttpRequest* req) override;
@@ -50,6 +54,9 @@ private:
     Status _data_saved_path(HttpRequest* req, std::string* file_path);
     Status _execute_plan_fragment(StreamLoadContext* ctx);
     Status _process_put(HttpRequest* http_req, StreamLoadContext* ctx);
+    // sets the load parameters of the headers, without the transaction and the source
+    void _init_put_request(HttpRequest* http_req, StreamLoadContext* ctx,
+                           TStreamLoadPutRequest* request);
 
 private:
     ExecEnv* _exec_env;
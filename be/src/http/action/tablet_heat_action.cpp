@@ -0,0 +1,112 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "http/action/tablet_heat_action.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "http/http_channel.h"
+#include "http/http_headers.h"
+#include "http/http_request.h"
+#include "http/http_status.h"
+#include "olap/olap_engine.h"
+#include "util/json_util.h"
+
+namespace doris {
+
+const static std::string HEADER_JSON = "application/json";
+const static std::string LIMIT_KEY = "limit";
+const static std::string SORT_KEY = "sort";
+
+Status TabletHeatAction::_handle_heat(HttpRequest *req, std::string* json_result) {
+    req->add_output_header(HttpHeaders::CONTENT_TYPE, HEADER_JSON.c_str());
+    size_t limit = 100;
+    const std::string& req_limit = req->param(LIMIT_KEY);
+    if (!req_limit.empty()) {
+        try {
+            limit = std::stoull(req_limit);
+        } catch (const std::exception& e) {
+            LOG(WARNING) << "invalid argument. limit:" << req_limit;
+            return Status("invalid arguments");
+        }
+    }
+    bool sort_by_write = req->param(SORT_KEY) == "write";
+
+    typedef std::pair<TTabletId, TTabletHeat> TabletHeatItem;
+    std::vector<TabletHeatItem> heats;
+    OLAPEngine::get_instance()->get_tablet_heats(&heats);
+    auto hotter = [sort_by_write] (const TabletHeatItem& lhs, const TabletHeatItem& rhs) {
+        if (sort_by_write) {
+            return lhs.second.bytes_written > rhs.second.bytes_written;
+        }
+        return lhs.second.bytes_scanned > rhs.second.bytes_scanned;
+    };
+    if (heats.size() > limit) {
+        std::partial_sort(heats.begin(), heats.begin() + limit, heats.end(), hotter);
+        heats.resize(limit);
+    } else {
+        std::sort(heats.begin(), heats.end(), hotter);
+    }
+
+    rapidjson::Document root;
+    root.SetObject();
+    rapidjson::Document::AllocatorType& allocator = root.GetAllocator();
+    root.AddMember("half_life_sec", config::tablet_heat_half_life_sec, allocator);
+    rapidjson::Value tablets(rapidjson::kArrayType);
+    for (const auto& item : heats) {
+        const TTabletHeat& heat = item.second;
+        rapidjson::Value tablet(rapidjson::kObjectType);
+        tablet.AddMember("tablet_id", item.first, allocator);
+        tablet.AddMember("rows_scanned", heat.rows_scanned, allocator);
+        tablet.AddMember("bytes_scanned", heat.bytes_scanned, allocator);
+        tablet.AddMember("scan_count", heat.scan_count, allocator);
+        tablet.AddMember("avg_scan_time_us",
+                         heat.scan_count > 0 ? heat.scan_time_us / heat.scan_count : 0,
+                         allocator);
+        tablet.AddMember("rows_written", heat.rows_written, allocator);
+        tablet.AddMember("bytes_written", heat.bytes_written, allocator);
+        tablets.PushBack(tablet, allocator);
+    }
+    root.AddMember("tablets", tablets, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    root.Accept(writer);
+    *json_result = buffer.GetString();
+    return Status::OK;
+}
+
+void TabletHeatAction::handle(HttpRequest *req) {
+    std::string json_result;
+    Status status = _handle_heat(req, &json_result);
+    if (status.ok()) {
+        HttpChannel::send_reply(req, HttpStatus::OK, json_result);
+    } else {
+        HttpChannel::send_reply(req, HttpStatus::INTERNAL_SERVER_ERROR, to_json(status));
+    }
+}
+
+} // end namespace doris
@@ -0,0 +1,45 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_HTTP_ACTION_TABLET_HEAT_ACTION_H
+#define DORIS_BE_SRC_HTTP_ACTION_TABLET_HEAT_ACTION_H
+
+#include <string>
+
+#include "http/http_handler.h"
+#include "common/status.h"
+
+namespace doris {
+
+// Get the hottest tablets of this backend by their decayed scanned bytes,
+// or written bytes with sort=write. At most 'limit' tablets, 100 by default.
+class TabletHeatAction : public HttpHandler {
+public:
+    TabletHeatAction() {}
+
+    virtual ~TabletHeatAction() {}
+
+    void handle(HttpRequest *req) override;
+
+private:
+    Status _handle_heat(HttpRequest *req, std::string* json_result);
+};
+
+} // end namespace doris
+
+#endif // DORIS_BE_SRC_HTTP_ACTION_TABLET_HEAT_ACTION_H
@@ -19,9 +19,12 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
@@ -47,6 +50,7 @@ const std::string FILE_PARAMETER = "file";
 const std::string DB_PARAMETER = "db";
 const std::string LABEL_PARAMETER = "label";
 const std::string TOKEN_PARAMETER = "token";
+const std::string CHECKSUM_PARAMETER = "checksum";
 
 DownloadAction::DownloadAction(ExecEnv* exec_env, const std::vector<std::string>& allow_dirs) :
     _exec_env(exec_env),
@@ -176,25 +180,70 @@ void DownloadAction::do_file_response(const std::string& file_path, HttpRequest
     int64_t file_size = st.st_size;
 
     // TODO(lingbin): process "IF_MODIFIED_SINCE" header
-    // TODO(lingbin): process "RANGE" header
-    const std::string& range_header = req->header(HttpHeaders::RANGE);
-    if (!range_header.empty()) {
-        // analyse range header
-    }
+    int64_t range_start = 0;
+    int64_t range_end = file_size - 1;
+    bool is_range = parse_range(req->header(HttpHeaders::RANGE), file_size,
+                                &range_start, &range_end);
 
     req->add_output_header(HttpHeaders::CONTENT_TYPE, get_content_type(file_path).c_str());
+    req->add_output_header(HttpHeaders::ACCEPT_RANGES, "bytes");
 
     if (req->method() == HttpMethod::HEAD) {
         close(fd);
         req->add_output_header(HttpHeaders::CONTENT_LENGTH,
                                boost::lexical_cast<std::string>(file_size).c_str());
+        // clones compare the files they already have with the md5 in hex,
+        // which is only computed when it is asked for
+        std::string md5;
+        if (req->param(CHECKSUM_PARAMETER) == "md5"
+                && FileUtils::md5sum(file_path, &md5).ok()) {
+            req->add_output_header(HttpHeaders::CONTENT_MD5, md5.c_str());
+        }
         HttpChannel::send_reply(req);
         return;
     }
 
+    if (is_range) {
+        std::stringstream content_range;
+        content_range << "bytes " << range_start << "-" << range_end << "/" << file_size;
+        req->add_output_header(HttpHeaders::CONTENT_RANGE, content_range.str().c_str());
+        HttpChannel::send_file(req, fd, range_start, range_end - range_start + 1,
+                               HttpStatus::PARTIAL_CONTENT);
+        return;
+    }
     HttpChannel::send_file(req, fd, 0, file_size);
 }
 
+bool DownloadAction::parse_range(const std::string& range_header, int64_t file_size,
+                                 int64_t* start, int64_t* end) {
+    // only a single range "bytes=start-end" or "bytes=start-", the whole file
+    // is sent for others
+    static const std::string prefix = "bytes=";
+    if (range_header.compare(0, prefix.size(), prefix) != 0) {
+        return false;
+    }
+    const char* begin = range_header.c_str() + prefix.size();
+    char* pos = nullptr;
+    errno = 0;
+    int64_t range_start = strtoll(begin, &pos, 10);
+    if (errno != 0 || pos == begin || *pos != '-' || range_start < 0
+            || range_start >= file_size) {
+        return false;
+    }
+    int64_t range_end = file_size - 1;
+    if (*(++pos) != '\0') {
+        const char* end_begin = pos;
+        range_end = strtoll(end_begin, &pos, 10);
+        if (errno != 0 || pos == end_begin || *pos != '\0' || range_end < range_start) {
+            return false;
+        }
+        range_end = std::min(range_end, file_size - 1);
+    }
+    *start = range_start;
+    *end = range_end;
+    return true;
+}
+
 // If 'file_name' contains a dot but does not consist solely of one or to two dots,
 // returns the substring of file_name starting at the rightmost dot and ending at the path's end.
 // Otherwise, returns an empty string
@@ -43,6 +43,12 @@ public:
 
     void handle(HttpRequest *req) override;
 
+    // Returns true if 'range_header' asks for a range of a file of
+    // 'file_size' bytes, whose first and last bytes are set to 'start' and
+    // 'end'. Clones download large files in ranges.
+    static bool parse_range(const std::string& range_header, int64_t file_size,
+                            int64_t* start, int64_t* end);
+
 private:
     enum DOWNLOAD_TYPE {
         NORMAL = 1,
@@ -61,12 +67,6 @@ private:
     void do_file_response(const std::string& dir_path, HttpRequest *req);
     void do_dir_response(const std::string& dir_path, HttpRequest *req);
 
-    Status get_file_content(
-            FILE* fp, char* buffer, int32_t buffer_size,
-            int32_t* readed_size, bool* eos);
-
-    int64_t get_file_size(FILE* fp);
-
     std::string get_file_extension(const std::string& file_name);
 
     std::string get_content_type(const std::string& file_name);
@@ -17,7 +17,15 @@
 
 #include "http/ev_http_server.h"
 
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <sstream>
 
 #include <event2/buffer.h>
@@ -27,6 +35,7 @@
 #include <event2/http_struct.h>
 #include <event2/keyvalq_struct.h>
 
+#include "common/config.h"
 #include "common/logging.h"
 #include "service/brpc.h"
 #include "http/http_request.h"
@@ -34,9 +43,70 @@
 #include "http/http_headers.h"
 #include "http/http_channel.h"
 #include "util/debug_util.h"
+#include "util/thread_pool.hpp"
 
 namespace doris {
 
+// Runs the tasks posted by other threads in the thread of an event loop,
+// which is woken up by a pipe.
+class EventLoopTasks {
+public:
+    EventLoopTasks() { }
+    ~EventLoopTasks() {
+        if (_event != nullptr) {
+            event_free(_event);
+        }
+        for (int fd : _fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    bool init(event_base* base) {
+        if (pipe2(_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+            return false;
+        }
+        _event = event_new(base, _fds[0], EV_READ | EV_PERSIST, _on_notify, this);
+        return _event != nullptr && event_add(_event, nullptr) == 0;
+    }
+
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            _tasks.push_back(std::move(task));
+        }
+        char c = 0;
+        // the pipe being full means the loop is woken up already
+        while (write(_fds[1], &c, 1) < 0 && errno == EINTR) {
+        }
+    }
+
+private:
+    static void _on_notify(evutil_socket_t fd, short what, void* arg) {
+        EventLoopTasks* self = (EventLoopTasks*)arg;
+        char buf[64];
+        while (read(fd, buf, sizeof(buf)) > 0) {
+        }
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> l(self->_lock);
+            tasks.swap(self->_tasks);
+        }
+        for (auto& task : tasks) {
+            task();
+        }
+    }
+
+    int _fds[2] = {-1, -1};
+    event* _event = nullptr;
+    std::mutex _lock;
+    std::vector<std::function<void()>> _tasks;
+};
+
+// tasks of the event loop of the current worker
+static thread_local EventLoopTasks* s_loop_tasks = nullptr;
+
 static void on_chunked(struct evhttp_request* ev_req, void* param) {
     HttpRequest* request = (HttpRequest*)ev_req->on_free_cb_arg;
     request->handler()->on_chunk_data(request);
@@ -53,7 +123,8 @@ static void on_request(struct evhttp_request *ev_req, void *arg) {
         // In this case, request's on_header return -1
         return;
     }
-    request->handler()->handle(request);
+    EvHttpServer* server = (EvHttpServer*)arg;
+    server->on_request(request);
 }
 
 static int on_header(struct evhttp_request* ev_req, void* param) {
@@ -90,8 +161,12 @@ EvHttpServer::~EvHttpServer() {
 Status EvHttpServer::start() {
     // bind to 
     RETURN_IF_ERROR(_bind());
+    if (config::webserver_handler_threads > 0) {
+        _handler_pool.reset(new ThreadPool(config::webserver_handler_threads, 1024));
+    }
     for (int i = 0; i < _num_workers; ++i) {
-        auto worker = [this, i] () {
+        int server_fd = _server_fds[i % _server_fds.size()];
+        auto worker = [this, i, server_fd] () {
             LOG(INFO) << "EvHttpServer worker start, id=" << i;
             std::shared_ptr<event_base> base(
                 event_base_new(), [] (event_base* base) { event_base_free(base); });
@@ -99,6 +174,12 @@ Status EvHttpServer::start() {
                 LOG(WARNING) << "Couldn't create an event_base.";
                 return; 
             }
+            std::unique_ptr<EventLoopTasks> loop_tasks(new EventLoopTasks());
+            if (loop_tasks->init(base.get())) {
+                s_loop_tasks = loop_tasks.get();
+            } else {
+                LOG(WARNING) << "fail to init the tasks of event loop, handlers may block it";
+            }
             /* Create a new evhttp object to handle requests. */
             std::shared_ptr<evhttp> http(
                 evhttp_new(base.get()), [] (evhttp* http) { evhttp_free(http); });
@@ -106,7 +187,7 @@ Status EvHttpServer::start() {
                 LOG(WARNING) << "Couldn't create an evhttp.";
                 return; 
             }
-            auto res = evhttp_accept_socket(http.get(), _server_fd);
+            auto res = evhttp_accept_socket(http.get(), server_fd);
             if (res < 0) {
                 LOG(WARNING) << "evhttp accept socket failed";
                 return;
@@ -129,30 +210,66 @@ void EvHttpServer::stop() {
 void EvHttpServer::join() {
 }
 
-Status EvHttpServer::_bind() {
-    butil::EndPoint point;
-    auto res = butil::hostname2endpoint(_host.c_str(), _port, &point);
-    if (res < 0) {
-        std::stringstream ss;
-        ss << "convert address failed, host=" << _host << ", port=" << _port;
-        return Status(ss.str());
+// listens on a socket of its own bound by SO_REUSEPORT
+static Status listen_reuse_port(const butil::EndPoint& point, int* server_fd) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return Status("create socket failed");
     }
-    _server_fd = butil::tcp_listen(point, true);
-    if (_server_fd < 0) {
+    int on = 1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr = point.ip;
+    addr.sin_port = htons(point.port);
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0
+            || setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0
+            || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0
+            || listen(fd, SOMAXCONN) != 0) {
         char buf[64];
         std::stringstream ss;
-        ss << "tcp listen failed, errno=" << errno
+        ss << "tcp listen with SO_REUSEPORT failed, errno=" << errno
             << ", errmsg=" << strerror_r(errno, buf, sizeof(buf));
+        close(fd);
         return Status(ss.str());
     }
-    res = butil::make_non_blocking(_server_fd);
+    *server_fd = fd;
+    return Status::OK;
+}
+
+Status EvHttpServer::_bind() {
+    butil::EndPoint point;
+    auto res = butil::hostname2endpoint(_host.c_str(), _port, &point);
     if (res < 0) {
-        char buf[64];
         std::stringstream ss;
-        ss << "make socket to non_blocking failed, errno=" << errno
-            << ", errmsg=" << strerror_r(errno, buf, sizeof(buf));
+        ss << "convert address failed, host=" << _host << ", port=" << _port;
         return Status(ss.str());
     }
+    int num_sockets = config::webserver_reuse_port ? _num_workers : 1;
+    for (int i = 0; i < num_sockets; ++i) {
+        int server_fd = -1;
+        if (config::webserver_reuse_port) {
+            RETURN_IF_ERROR(listen_reuse_port(point, &server_fd));
+        } else {
+            server_fd = butil::tcp_listen(point, true);
+            if (server_fd < 0) {
+                char buf[64];
+                std::stringstream ss;
+                ss << "tcp listen failed, errno=" << errno
+                    << ", errmsg=" << strerror_r(errno, buf, sizeof(buf));
+                return Status(ss.str());
+            }
+        }
+        _server_fds.push_back(server_fd);
+        res = butil::make_non_blocking(server_fd);
+        if (res < 0) {
+            char buf[64];
+            std::stringstream ss;
+            ss << "make socket to non_blocking failed, errno=" << errno
+                << ", errmsg=" << strerror_r(errno, buf, sizeof(buf));
+            return Status(ss.str());
+        }
+    }
     return Status::OK;
 }
 
@@ -229,6 +346,28 @@ int EvHttpServer::on_header(struct evhttp_request* ev_req) {
     return 0;
 }
 
+void EvHttpServer::on_request(HttpRequest* request) {
+    HttpHandler* handler = request->handler();
+    EventLoopTasks* loop_tasks = s_loop_tasks;
+    if (_handler_pool == nullptr || loop_tasks == nullptr || !handler->handle_may_block()) {
+        handler->handle(request);
+        return;
+    }
+    // the request is not freed before its reply is sent, even if the
+    // connection is closed meanwhile. The reply is sent after handle()
+    // returned, which may use the handler context freed with the request.
+    request->set_reply_deferred();
+    _handler_pool->offer([handler, request, loop_tasks] () {
+        handler->handle(request);
+        loop_tasks->post([request] () {
+            auto reply = request->take_deferred_reply();
+            if (reply) {
+                reply();
+            }
+        });
+    });
+}
+
 HttpHandler* EvHttpServer::_find_handler(HttpRequest* req) {
     auto& path = req->raw_path();
 
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -29,6 +30,7 @@ namespace doris {
 
 class HttpHandler;
 class HttpRequest;
+class ThreadPool;
 
 class EvHttpServer {
 public:
@@ -45,6 +47,7 @@ public:
 
     // callback 
     int on_header(struct evhttp_request* ev_req);
+    void on_request(HttpRequest* request);
 
 private:
     Status _bind();
@@ -56,8 +59,12 @@ private:
     int _port;
     int _num_workers;
 
-    int _server_fd = -1;
+    // one socket shared by all workers, or one of each if they listen by
+    // SO_REUSEPORT
+    std::vector<int> _server_fds;
     std::vector<std::thread> _workers;
+    // runs the handlers which may block
+    std::unique_ptr<ThreadPool> _handler_pool;
 
     pthread_rwlock_t _rw_lock;
 
@@ -21,12 +21,14 @@
 #include <string>
 
 #include <event2/buffer.h>
+#include <event2/bufferevent.h>
 #include <event2/http.h>
 
 #include "http/http_request.h"
 #include "http/http_response.h"
 #include "http/http_headers.h"
 #include "http/http_status.h"
+#include "common/config.h"
 #include "common/logging.h"
 
 namespace doris {
@@ -41,28 +43,65 @@ void HttpChannel::send_basic_challenge(HttpRequest* req, const std::string& real
 }
 
 void HttpChannel::send_error(HttpRequest* request, HttpStatus status) {
+    if (request->defer_reply([request, status] () { send_error(request, status); })) {
+        return;
+    }
     evhttp_send_error(request->get_evhttp_request(), status, defalut_reason(status).c_str());
 }
 
 void HttpChannel::send_reply(HttpRequest* request, HttpStatus status) {
+    if (request->defer_reply([request, status] () { send_reply(request, status); })) {
+        return;
+    }
     evhttp_send_reply(request->get_evhttp_request(), status,
                       defalut_reason(status).c_str(), nullptr);
 }
 
 void HttpChannel::send_reply(
         HttpRequest* request, HttpStatus status, const std::string& content) {
+    if (request->defer_reply(
+            [request, status, content] () { send_reply(request, status, content); })) {
+        return;
+    }
     auto evb = evbuffer_new();
     evbuffer_add(evb, content.c_str(), content.size());
     evhttp_send_reply(request->get_evhttp_request(), status, defalut_reason(status).c_str(), evb);
     evbuffer_free(evb);
 }
 
-void HttpChannel::send_file(HttpRequest* request, int fd, size_t off, size_t size) {
+void HttpChannel::send_file(HttpRequest* request, int fd, size_t off, size_t size,
+                            HttpStatus status) {
+    if (request->defer_reply(
+            [request, fd, off, size, status] () { send_file(request, fd, off, size, status); })) {
+        return;
+    }
+    // bufferevents are rate limited per tick of one second, the buckets hold
+    // the bytes of one tick. The config must outlive the connections using it.
+    static ev_token_bucket_cfg* s_send_rate_cfg = [] () -> ev_token_bucket_cfg* {
+        if (config::download_max_send_mbps <= 0) {
+            return nullptr;
+        }
+        size_t rate = static_cast<size_t>(config::download_max_send_mbps) * 1024 * 1024;
+        return ev_token_bucket_cfg_new(rate, rate, rate, rate, nullptr);
+    }();
+    evhttp_request* evhttp_req = request->get_evhttp_request();
+    if (s_send_rate_cfg != nullptr) {
+        bufferevent* bev = evhttp_connection_get_bufferevent(
+            evhttp_request_get_connection(evhttp_req));
+        if (bev != nullptr && bufferevent_set_rate_limit(bev, s_send_rate_cfg) != 0) {
+            LOG(WARNING) << "fail to limit the rate of sending file";
+        }
+    }
+
     auto evb = evbuffer_new();
+    // the file is only sent by sendfile() from a buffer draining to a socket,
+    // it is read or mapped into memory otherwise. The chains of the file are
+    // moved to the output buffer of the connection, whose socket they drain to.
+    evbuffer_set_flags(evb, EVBUFFER_FLAG_DRAINS_TO_FD);
     evbuffer_add_file(evb, fd, off, size);
-    evhttp_send_reply(request->get_evhttp_request(),
-                      HttpStatus::OK,
-                      defalut_reason(HttpStatus::OK).c_str(), evb);
+    evhttp_send_reply(evhttp_req,
+                      status,
+                      defalut_reason(status).c_str(), evb);
     evbuffer_free(evb);
 }
 
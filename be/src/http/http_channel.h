@@ -45,7 +45,11 @@ public:
 
     static void send_reply(HttpRequest* request, HttpStatus status, const std::string& content);
 
-    static void send_file(HttpRequest* request, int fd, size_t off, size_t size);
+    // sends 'size' bytes of 'fd' from 'off' with 'status', 206 for a range.
+    // The bytes are sent by sendfile() within download_max_send_mbps, 'fd' is
+    // closed once they are sent.
+    static void send_file(HttpRequest* request, int fd, size_t off, size_t size,
+                          HttpStatus status = HttpStatus::OK);
 };
 
 }
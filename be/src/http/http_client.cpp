@@ -17,6 +17,18 @@
 
 #include "http/http_client.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "common/config.h"
+#include "util/defer_op.h"
+#include "util/rate_limiter.h"
+
 namespace doris {
 
 HttpClient::HttpClient() {
@@ -94,6 +106,23 @@ Status HttpClient::init(const std::string& url) {
         LOG(WARNING) << "fail to set CURLOPT_WRITEDATA, msg=" << _to_errmsg(code);
         return Status("fail to set CURLOPT_WRITEDATA");
     }
+    _response_headers.clear();
+    curl_write_callback header_callback = [] (char* buffer, size_t size, size_t nmemb,
+                                              void* param) {
+        HttpClient* client = (HttpClient*)param;
+        client->_on_response_header(buffer, size * nmemb);
+        return size * nmemb;
+    };
+    code = curl_easy_setopt(_curl, CURLOPT_HEADERFUNCTION, header_callback);
+    if (code != CURLE_OK) {
+        LOG(WARNING) << "fail to set CURLOPT_HEADERFUNCTION, msg=" << _to_errmsg(code);
+        return Status("fail to set CURLOPT_HEADERFUNCTION");
+    }
+    code = curl_easy_setopt(_curl, CURLOPT_HEADERDATA, (void*) this);
+    if (code != CURLE_OK) {
+        LOG(WARNING) << "fail to set CURLOPT_HEADERDATA, msg=" << _to_errmsg(code);
+        return Status("fail to set CURLOPT_HEADERDATA");
+    }
     // set url
     code = curl_easy_setopt(_curl, CURLOPT_URL, url.c_str());
     if (code != CURLE_OK) {
@@ -129,6 +158,34 @@ void HttpClient::set_method(HttpMethod method) {
     }
 }
 
+void HttpClient::_on_response_header(const char* data, size_t length) {
+    // one "Name: value\r\n" line at a time, the status line has no colon
+    std::string line(data, length);
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        return;
+    }
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    size_t begin = line.find_first_not_of(" \t", colon + 1);
+    size_t end = line.find_last_not_of(" \t\r\n");
+    if (begin == std::string::npos || end < begin) {
+        _response_headers[name] = "";
+    } else {
+        _response_headers[name] = line.substr(begin, end - begin + 1);
+    }
+}
+
+std::string HttpClient::get_response_header(const std::string& name) const {
+    std::string lower_name = name;
+    std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
+    auto it = _response_headers.find(lower_name);
+    if (it == _response_headers.end()) {
+        return std::string();
+    }
+    return it->second;
+}
+
 size_t HttpClient::on_response_data(const void* data, size_t length) {
     if (*_callback != nullptr) {
         bool is_continue = (*_callback)(data, length);
@@ -200,6 +257,61 @@ Status HttpClient::download(const std::string& local_path) {
     return status;
 }
 
+Status HttpClient::download_range(const std::string& local_path, int64_t offset, int64_t length,
+                                  RateLimiter* limiter, int64_t* downloaded) {
+    int fd = open(local_path.c_str(), O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        LOG(WARNING) << "open file failed, file=" << local_path << ", errno=" << errno;
+        return Status("open file failed");
+    }
+    DeferOp close_fd([fd] () { close(fd); });
+    if (*downloaded >= length) {
+        return Status::OK;
+    }
+
+    set_method(GET);
+    curl_easy_setopt(_curl, CURLOPT_LOW_SPEED_LIMIT,
+                     config::download_low_speed_limit_kbps * 1024);
+    curl_easy_setopt(_curl, CURLOPT_LOW_SPEED_TIME, config::download_low_speed_time);
+    curl_easy_setopt(_curl, CURLOPT_MAX_RECV_SPEED_LARGE,
+                     config::max_download_speed_kbps * 1024);
+    std::stringstream range;
+    range << offset + *downloaded << "-" << offset + length - 1;
+    std::string range_str = range.str();
+    curl_easy_setopt(_curl, CURLOPT_RANGE, range_str.c_str());
+
+    Status status;
+    bool is_first = true;
+    auto callback = [&] (const void* data, size_t size) {
+        if (is_first) {
+            is_first = false;
+            if (get_http_status() != HttpStatus::PARTIAL_CONTENT) {
+                if (offset != 0) {
+                    LOG(WARNING) << "server does not support ranges, file=" << local_path;
+                    status = Status("server does not support ranges");
+                    return false;
+                }
+                // the whole resource follows
+                *downloaded = 0;
+            }
+        }
+        if (limiter != nullptr) {
+            limiter->acquire(size);
+        }
+        ssize_t res = pwrite(fd, data, size, offset + *downloaded);
+        if (res != static_cast<ssize_t>(size)) {
+            LOG(WARNING) << "fail to write data to file, file=" << local_path
+                << ", errno=" << errno;
+            status = Status("fail to write data when download");
+            return false;
+        }
+        *downloaded += size;
+        return true;
+    };
+    RETURN_IF_ERROR(execute(callback));
+    return status;
+}
+
 Status HttpClient::execute(std::string* response) {
     auto callback = [response] (const void* data, size_t length) {
         response->append((char*)data, length);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdio>
+#include <map>
 #include <string>
 
 #include <curl/curl.h>
@@ -29,6 +30,8 @@
 #include "http/http_response.h"
 namespace doris {
 
+class RateLimiter;
+
 // Helper class to access HTTP resource
 class HttpClient {
 public:
@@ -80,6 +83,10 @@ public:
         return std::string();
     }
 
+    // Returns the value of the header 'name' of the last response, empty if
+    // it has none. Names are not case sensitive.
+    std::string get_response_header(const std::string& name) const;
+
     // Set the long gohead parameter to 1L to continue send authentication (user+password)
     // credentials when following locations, even when hostname changed. 
     void set_unrestricted_auth(int gohead) {
@@ -113,6 +120,17 @@ public:
     // a file to local_path 
     Status download(const std::string& local_path);
 
+    // Downloads bytes [offset, offset + length) of the resource to the same
+    // bytes of local_path, which is created if it does not exist. 'downloaded'
+    // is the number of bytes of the range already in the file, it is updated
+    // as bytes are written, so a retry resumes after them. The bytes are
+    // within the rate of 'limiter' if it is not nullptr.
+    // A server which does not support ranges sends the whole resource, which
+    // is only accepted if the range starts at 0; the whole resource is then
+    // written, so the range must be all of it.
+    Status download_range(const std::string& local_path, int64_t offset, int64_t length,
+                          RateLimiter* limiter, int64_t* downloaded);
+
     Status execute_post_request(const std::string& payload, std::string* response);
 
     Status execute_delete_request(const std::string& payload, std::string* response);
@@ -128,12 +146,16 @@ public:
 private:
     const char* _to_errmsg(CURLcode code);
 
+    void _on_response_header(const char* data, size_t length);
+
 private:
     CURL* _curl = nullptr;
     using HttpCallback = std::function<bool(const void* data, size_t length)>;
     const HttpCallback* _callback = nullptr;
     char _error_buf[CURL_ERROR_SIZE];
     curl_slist *_header_list = nullptr;
+    // by lower case names
+    std::map<std::string, std::string> _response_headers;
 };
 
 }
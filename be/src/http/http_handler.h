@@ -31,6 +31,11 @@ public:
 
     virtual bool request_will_be_read_progressively() { return false; }
 
+    // If true, handle() may be called by a handler thread of the server when
+    // the request is read, so that the event loops are not blocked. The
+    // reply is sent by the event loop after handle() returned then.
+    virtual bool handle_may_block() { return false; }
+
     // This funciton will called when all headers are recept.
     // return 0 if process successfully. otherwise return -1;
     // If return -1, on_header function should send_reply to HTTP client
@@ -25,6 +25,7 @@
 
 #include <event2/buffer.h>
 #include <event2/bufferevent.h>
+#include <event2/event.h>
 #include <event2/http.h>
 #include <event2/http_struct.h>
 #include <event2/keyvalq_struct.h>
@@ -38,11 +39,18 @@ namespace doris {
 
 static std::string s_empty = "";
 
+// interval to check whether a paused request may be read again
+static const int RESUME_CHECK_INTERVAL_US = 5 * 1000;
+
 HttpRequest::HttpRequest(evhttp_request* evhttp_request)
         : _ev_req(evhttp_request) {
 }
 
 HttpRequest::~HttpRequest() {
+    // the handler context may be used by _can_resume
+    if (_resume_event != nullptr) {
+        event_free(_resume_event);
+    }
     if (_handler != nullptr && _handler_ctx != nullptr) {
         _handler->free_handler_ctx(_handler_ctx);
     }
@@ -145,4 +153,53 @@ const char* HttpRequest::remote_host() const {
     return _ev_req->remote_host;
 }
 
+bool HttpRequest::defer_reply(std::function<void()> reply) {
+    if (!_reply_deferred) {
+        return false;
+    }
+    _deferred_reply = std::move(reply);
+    return true;
+}
+
+std::function<void()> HttpRequest::take_deferred_reply() {
+    _reply_deferred = false;
+    return std::move(_deferred_reply);
+}
+
+void HttpRequest::pause_reading(std::function<bool()> can_resume) {
+    auto evcon = evhttp_request_get_connection(_ev_req);
+    auto bev = evcon == nullptr ? nullptr : evhttp_connection_get_bufferevent(evcon);
+    if (bev == nullptr) {
+        return;
+    }
+    if (_resume_event == nullptr) {
+        _resume_event = evtimer_new(evhttp_connection_get_base(evcon), _on_resume, this);
+        if (_resume_event == nullptr) {
+            LOG(WARNING) << "fail to create the event to resume reading";
+            return;
+        }
+    }
+    _can_resume = std::move(can_resume);
+    bufferevent_disable(bev, EV_READ);
+    struct timeval tv = {0, RESUME_CHECK_INTERVAL_US};
+    evtimer_add(_resume_event, &tv);
+}
+
+void HttpRequest::_on_resume(int fd, short what, void* arg) {
+    HttpRequest* req = (HttpRequest*)arg;
+    if (!req->_can_resume()) {
+        struct timeval tv = {0, RESUME_CHECK_INTERVAL_US};
+        evtimer_add(req->_resume_event, &tv);
+        return;
+    }
+    req->_can_resume = nullptr;
+    auto bev = evhttp_connection_get_bufferevent(evhttp_request_get_connection(req->_ev_req));
+    bufferevent_enable(bev, EV_READ);
+    // the data read before the pause is not taken until more arrives, there
+    // may be none if the whole body was read already
+    if (evbuffer_get_length(bufferevent_get_input(bev)) > 0) {
+        bufferevent_trigger(bev, EV_READ, 0);
+    }
+}
+
 }
@@ -18,6 +18,7 @@
 #ifndef DORIS_BE_SRC_COMMON_UTIL_HTTP_REQUEST_H
 #define DORIS_BE_SRC_COMMON_UTIL_HTTP_REQUEST_H
 
+#include <functional>
 #include <map>
 #include <string>
 
@@ -30,6 +31,7 @@
 
 struct mg_connection;
 struct evhttp_request;
+struct event;
 
 namespace doris {
 
@@ -92,7 +94,23 @@ public:
 
     const char* remote_host() const;
 
+    // While the reply is deferred, which it is if handle() runs out of the
+    // event loop, HttpChannel keeps the reply here instead of sending it.
+    // Returns false if 'reply' should be sent now.
+    bool defer_reply(std::function<void()> reply);
+    void set_reply_deferred() { _reply_deferred = true; }
+    // Stops deferring and returns the reply kept, which may be empty.
+    std::function<void()> take_deferred_reply();
+
+    // Stops reading the body from the connection until 'can_resume' returns
+    // true, which is checked periodically in the event loop. Must be called
+    // in the event loop.
+    void pause_reading(std::function<bool()> can_resume);
+
 private:
+    // callback of _resume_event
+    static void _on_resume(int fd, short what, void* arg);
+
     HttpMethod _method;
     std::string _uri;
     std::string _raw_path;
@@ -106,6 +124,12 @@ private:
 
     void* _handler_ctx = nullptr;
     std::string _request_body;
+
+    bool _reply_deferred = false;
+    std::function<void()> _deferred_reply;
+
+    struct event* _resume_event = nullptr;
+    std::function<bool()> _can_resume;
 };
 
 }
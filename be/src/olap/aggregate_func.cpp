@@ -17,8 +17,87 @@
 
 #include "olap/aggregate_func.h"
 
+#include "common/logging.h"
+
 namespace doris {
 
+typedef AggregateFuncTraits<OLAP_FIELD_AGGREGATION_BITMAP_UNION, OLAP_FIELD_TYPE_VARCHAR>
+        BitmapUnionTraits;
+
+void BitmapUnionTraits::union_into(RoaringBitmap* bitmap, const char* right) {
+    if (*reinterpret_cast<const bool*>(right)) {
+        return;
+    }
+    const Slice* r_slice = reinterpret_cast<const Slice*>(right + 1);
+    if (r_slice->size == 0) {
+        return;
+    }
+    RoaringBitmap other;
+    if (!other.deserialize(r_slice->data, r_slice->size)) {
+        LOG(WARNING) << "invalid bitmap in BITMAP_UNION column, size=" << r_slice->size;
+        return;
+    }
+    bitmap->union_with(other);
+}
+
+void BitmapUnionTraits::write(char* left, const RoaringBitmap& bitmap, Arena* arena) {
+    size_t size = bitmap.serialized_size();
+    if (size > OLAP_BITMAP_MAX_BYTES) {
+        LOG(WARNING) << "bitmap of BITMAP_UNION column is too large, size=" << size;
+        return;
+    }
+    *reinterpret_cast<bool*>(left) = false;
+    Slice* l_slice = reinterpret_cast<Slice*>(left + 1);
+    // without an arena left is a row cursor with room for the longest value
+    if (arena != nullptr && size > l_slice->size) {
+        l_slice->data = arena->Allocate(size);
+    }
+    bitmap.serialize(l_slice->data);
+    l_slice->size = size;
+}
+
+void BitmapUnionTraits::aggregate(char* left, const char* right, Arena* arena) {
+    if (*reinterpret_cast<const bool*>(right)) {
+        return;
+    }
+    if (*reinterpret_cast<bool*>(left)) {
+        AggregateFuncTraits<OLAP_FIELD_AGGREGATION_REPLACE,
+                OLAP_FIELD_TYPE_CHAR>::aggregate(left, right, arena);
+        return;
+    }
+    RoaringBitmap bitmap;
+    const Slice* l_slice = reinterpret_cast<const Slice*>(left + 1);
+    if (l_slice->size > 0 && !bitmap.deserialize(l_slice->data, l_slice->size)) {
+        LOG(WARNING) << "invalid bitmap in BITMAP_UNION column, size=" << l_slice->size;
+        return;
+    }
+    union_into(&bitmap, right);
+    write(left, bitmap, arena);
+}
+
+void AggregateRunTraits<OLAP_FIELD_AGGREGATION_BITMAP_UNION, OLAP_FIELD_TYPE_VARCHAR>::aggregate_run(
+        char* left, const char* right, size_t stride, size_t num_rows, Arena* arena) {
+    RoaringBitmap bitmap;
+    bool has_value = false;
+    if (!*reinterpret_cast<bool*>(left)) {
+        const Slice* l_slice = reinterpret_cast<const Slice*>(left + 1);
+        if (l_slice->size > 0 && !bitmap.deserialize(l_slice->data, l_slice->size)) {
+            LOG(WARNING) << "invalid bitmap in BITMAP_UNION column, size=" << l_slice->size;
+            return;
+        }
+        has_value = true;
+    }
+    for (size_t i = 0; i < num_rows; ++i, right += stride) {
+        if (!*reinterpret_cast<const bool*>(right)) {
+            BitmapUnionTraits::union_into(&bitmap, right);
+            has_value = true;
+        }
+    }
+    if (has_value) {
+        BitmapUnionTraits::write(left, bitmap, arena);
+    }
+}
+
 struct AggregateFuncMapHash {
     size_t operator()(const std::pair<FieldAggregationMethod, FieldType>& pair) const {
         return (pair.first + 31) ^ pair.second;
@@ -48,10 +127,22 @@ public:
         }
     }
 
+    AggregateRunFunc get_aggregate_run_func(const FieldAggregationMethod agg_method,
+                                            const FieldType field_type) {
+        auto pair = _aggregate_run_mapping.find(std::make_pair(agg_method, field_type));
+        if (pair != _aggregate_run_mapping.end()) {
+            return pair->second;
+        } else {
+            return nullptr;
+        }
+    }
+
     template<FieldAggregationMethod agg_method, FieldType field_type>
     void add_aggregate_mapping() {
         _aggregate_mapping.insert(std::make_pair(std::make_pair(agg_method, field_type),
                          &AggregateFuncTraits<agg_method, field_type>::aggregate));
+        _aggregate_run_mapping.insert(std::make_pair(std::make_pair(agg_method, field_type),
+                         &AggregateRunTraits<agg_method, field_type>::aggregate_run));
     }
 
     template<FieldAggregationMethod agg_method, FieldType field_type>
@@ -63,6 +154,7 @@ private:
     typedef std::pair<FieldAggregationMethod, FieldType> key_t;
     std::unordered_map<key_t, AggregateFunc, AggregateFuncMapHash> _aggregate_mapping;
     std::unordered_map<key_t, FinalizeFunc, AggregateFuncMapHash> _finalize_mapping;
+    std::unordered_map<key_t, AggregateRunFunc, AggregateFuncMapHash> _aggregate_run_mapping;
 
     DISALLOW_COPY_AND_ASSIGN(AggregateFuncResolver);
 };
@@ -133,6 +225,9 @@ AggregateFuncResolver::AggregateFuncResolver() {
     // Hyperloglog Aggregate Function
     add_aggregate_mapping<OLAP_FIELD_AGGREGATION_HLL_UNION, OLAP_FIELD_TYPE_HLL>();
 
+    // Bitmap Aggregate Function
+    add_aggregate_mapping<OLAP_FIELD_AGGREGATION_BITMAP_UNION, OLAP_FIELD_TYPE_VARCHAR>();
+
 
     // Finalize Function for hyperloglog Function
     add_finalize_mapping<OLAP_FIELD_AGGREGATION_HLL_UNION, OLAP_FIELD_TYPE_HLL>();
@@ -150,4 +245,9 @@ FinalizeFunc get_finalize_func(const FieldAggregationMethod agg_method,
     return AggregateFuncResolver::get_instance()->get_finalize_func(agg_method, field_type);
 }
 
+AggregateRunFunc get_aggregate_run_func(const FieldAggregationMethod agg_method,
+                                        const FieldType field_type) {
+    return AggregateFuncResolver::get_instance()->get_aggregate_run_func(agg_method, field_type);
+}
+
 } // namespace doris
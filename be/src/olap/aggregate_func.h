@@ -18,15 +18,21 @@
 #ifndef DORIS_BE_SRC_OLAP_AGGREGATE_FUNC_H
 #define DORIS_BE_SRC_OLAP_AGGREGATE_FUNC_H
 
+#include <type_traits>
+
 #include "olap/field_info.h"
 #include "olap/hll.h"
 #include "olap/types.h"
 #include "util/arena.h"
+#include "util/roaring_bitmap.h"
 
 namespace doris {
 
 using AggregateFunc = void (*)(char* left, const char* right, Arena* arena);
 using FinalizeFunc = void (*)(char* data);
+// aggregate num_rows values into left, the i-th one is at right + i * stride
+using AggregateRunFunc = void (*)(char* left, const char* right, size_t stride,
+                                  size_t num_rows, Arena* arena);
 
 template<FieldAggregationMethod agg_method,
         FieldType field_type> struct AggregateFuncTraits {};
@@ -234,45 +240,126 @@ struct AggregateFuncTraits<OLAP_FIELD_AGGREGATION_HLL_UNION, OLAP_FIELD_TYPE_HLL
         Slice* slice = reinterpret_cast<Slice*>(data);
         size_t hll_ptr = *(size_t*)(slice->data - sizeof(HllContext*));
         HllContext* context = (reinterpret_cast<HllContext*>(hll_ptr));
-        std::map<int, uint8_t> index_to_value;
-        if (context->has_sparse_or_full ||
-                context->hash64_set->size() > HLL_EXPLICLIT_INT64_NUM) {
-            HllSetHelper::set_max_register(context->registers, HLL_REGISTERS_COUNT,
-                                           *(context->hash64_set));
-            for (int i = 0; i < HLL_REGISTERS_COUNT; i++) {
-                if (context->registers[i] != 0) {
-                    index_to_value[i] = context->registers[i];
-                }
-            }
-        }
-        int sparse_set_len = index_to_value.size() *
-            (sizeof(HllSetResolver::SparseIndexType)
-             + sizeof(HllSetResolver::SparseValueType))
-            + sizeof(HllSetResolver::SparseLengthValueType);
         int result_len = 0;
-
-        if (sparse_set_len >= HLL_COLUMN_DEFAULT_LEN) {
-            // full set
-            HllSetHelper::set_full(slice->data, context->registers,
-                                   HLL_REGISTERS_COUNT, result_len);
-        } else if (index_to_value.size() > 0) {
-            // sparse set
-            HllSetHelper::set_sparse(slice->data, index_to_value, result_len);
-        } else if (context->hash64_set->size() > 0) {
-            // expliclit set
-            HllSetHelper::set_explicit(slice->data, *(context->hash64_set), result_len);
-        }
+        HllSetHelper::set_hll(slice->data, context, result_len);
 
         slice->size = result_len & 0xffff;
 
         delete context->hash64_set;
     }
+    // both values hold a context, the one of right is freed
+    static void merge(char* left, const char* right) {
+        Slice* l_slice = reinterpret_cast<Slice*>(left + 1);
+        const Slice* r_slice = reinterpret_cast<const Slice*>(right + 1);
+        HllContext* l_context = *reinterpret_cast<HllContext**>(l_slice->data - sizeof(HllContext*));
+        HllContext* r_context = *reinterpret_cast<HllContext**>(r_slice->data - sizeof(HllContext*));
+        HllSetHelper::merge_context(l_context, *r_context);
+        delete r_context->hash64_set;
+        r_context->hash64_set = nullptr;
+    }
+};
+
+// Bitmaps are serialized RoaringBitmaps in VARCHAR columns, the empty string is
+// the empty set. The union may not grow beyond OLAP_BITMAP_MAX_BYTES, the space
+// a row cursor has for the column, the left value is kept then.
+template <>
+struct AggregateFuncTraits<OLAP_FIELD_AGGREGATION_BITMAP_UNION, OLAP_FIELD_TYPE_VARCHAR> {
+    static void aggregate(char* left, const char* right, Arena* arena);
+    // right is ignored if it is null or not a bitmap
+    static void union_into(RoaringBitmap* bitmap, const char* right);
+    static void write(char* left, const RoaringBitmap& bitmap, Arena* arena);
+};
+
+// Aggregates a run of rows of one row block. The loop calls the aggregate
+// function of the type directly, so it is inlined instead of being called
+// through a pointer once per row.
+template<FieldAggregationMethod agg_method, FieldType field_type>
+struct AggregateRunTraits {
+    static void aggregate_run(char* left, const char* right, size_t stride,
+                              size_t num_rows, Arena* arena) {
+        for (size_t i = 0; i < num_rows; ++i) {
+            AggregateFuncTraits<agg_method, field_type>::aggregate(left, right + i * stride, arena);
+        }
+    }
+};
+
+template<FieldType field_type>
+struct AggregateRunTraits<OLAP_FIELD_AGGREGATION_NONE, field_type> {
+    static void aggregate_run(char* left, const char* right, size_t stride,
+                              size_t num_rows, Arena* arena) {}
+};
+
+// only the last value of the run survives
+template<FieldType field_type>
+struct AggregateRunTraits<OLAP_FIELD_AGGREGATION_REPLACE, field_type> {
+    static void aggregate_run(char* left, const char* right, size_t stride,
+                              size_t num_rows, Arena* arena) {
+        if (num_rows > 0) {
+            AggregateFuncTraits<OLAP_FIELD_AGGREGATION_REPLACE, field_type>::aggregate(
+                left, right + (num_rows - 1) * stride, arena);
+        }
+    }
+};
+
+// left is deserialized and serialized once for the whole run
+template<>
+struct AggregateRunTraits<OLAP_FIELD_AGGREGATION_BITMAP_UNION, OLAP_FIELD_TYPE_VARCHAR> {
+    static void aggregate_run(char* left, const char* right, size_t stride,
+                              size_t num_rows, Arena* arena);
+};
+
+// Integers of a run are summed up in a register before they are added to left.
+// Floating point values are added one by one, the result must not depend on
+// how the rows were split into runs.
+template<FieldType field_type>
+struct AggregateRunTraits<OLAP_FIELD_AGGREGATION_SUM, field_type> {
+    typedef typename FieldTypeTraits<field_type>::CppType CppType;
+
+    static void aggregate_run(char* left, const char* right, size_t stride,
+                              size_t num_rows, Arena* arena) {
+        _aggregate_run(left, right, stride, num_rows, arena,
+                       std::integral_constant<bool, std::is_integral<CppType>::value
+                                && field_type != OLAP_FIELD_TYPE_LARGEINT>());
+    }
+
+private:
+    static void _aggregate_run(char* left, const char* right, size_t stride,
+                               size_t num_rows, Arena* arena, std::false_type) {
+        for (size_t i = 0; i < num_rows; ++i) {
+            AggregateFuncTraits<OLAP_FIELD_AGGREGATION_SUM, field_type>::aggregate(
+                left, right + i * stride, arena);
+        }
+    }
+
+    static void _aggregate_run(char* left, const char* right, size_t stride,
+                               size_t num_rows, Arena* arena, std::true_type) {
+        CppType sum = 0;
+        bool has_value = false;
+        for (size_t i = 0; i < num_rows; ++i, right += stride) {
+            if (!*reinterpret_cast<const bool*>(right)) {
+                sum += *reinterpret_cast<const CppType*>(right + 1);
+                has_value = true;
+            }
+        }
+        if (!has_value) {
+            return;
+        }
+        CppType* l_val = reinterpret_cast<CppType*>(left + 1);
+        if (*reinterpret_cast<bool*>(left)) {
+            *reinterpret_cast<bool*>(left) = false;
+            *l_val = sum;
+        } else {
+            *l_val += sum;
+        }
+    }
 };
 
 extern AggregateFunc get_aggregate_func(const FieldAggregationMethod agg_method,
                                         const FieldType field_type);
 extern FinalizeFunc get_finalize_func(const FieldAggregationMethod agg_method,
                                       const FieldType field_type);
+extern AggregateRunFunc get_aggregate_run_func(const FieldAggregationMethod agg_method,
+                                               const FieldType field_type);
 
 } // namespace doris
 
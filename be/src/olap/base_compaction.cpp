@@ -121,6 +121,7 @@ OLAPStatus BaseCompaction::run() {
             merge_bytes += i_data->segment_group()->data_size();
         }
         DorisMetrics::base_compaction_bytes_total.increment(merge_bytes);
+        _merged_bytes = merge_bytes;
     }
 
     // 保存生成base文件时候累积的行数
@@ -419,7 +420,8 @@ OLAPStatus BaseCompaction::_update_header(uint64_t row_count, vector<SegmentGrou
     // 由于在replace_data_sources中可能会发生很小概率的非事务性失败, 因此这里定位FATAL错误
     res = _table->replace_data_sources(&unused_versions,
                                        &_new_olap_indices,
-                                       unused_olap_indices);
+                                       unused_olap_indices,
+                                       true);
     if (res != OLAP_SUCCESS) {
         LOG(FATAL) << "fail to replace data sources. res" << res
                    << ", tablet=" << _table->full_name()
@@ -36,7 +36,8 @@ public:
     BaseCompaction() :
             _new_base_version(0, 0),
             _old_base_version(0, 0),
-            _base_compaction_locked(false) {}
+            _base_compaction_locked(false),
+            _merged_bytes(0) {}
 
     virtual ~BaseCompaction() {
         _release_base_compaction_lock();
@@ -64,6 +65,11 @@ public:
     // - 其它情况下，返回相应的错误码
     OLAPStatus run();
 
+    // 被合并的文件的数据量
+    int64_t merged_bytes() const {
+        return _merged_bytes;
+    }
+
 private:
     // 检验当前情况是否满足base compaction的触发策略
     //
@@ -177,6 +183,7 @@ private:
     std::vector<SegmentGroup*> _new_olap_indices;
 
     bool _base_compaction_locked;
+    int64_t _merged_bytes;
 
     DISALLOW_COPY_AND_ASSIGN(BaseCompaction);
 };
@@ -0,0 +1,205 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/bit_packed_integer_reader.h"
+
+#include <immintrin.h>
+
+#include <cstring>
+
+#include "common/compiler_util.h"
+#include "olap/serialize.h"
+#include "util/cpu_info.h"
+
+namespace doris {
+
+namespace {
+
+ALWAYS_INLINE inline uint64_t load_uint64(const char* p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+ALWAYS_INLINE inline uint64_t bit_mask(uint32_t bit_width) {
+    return bit_width == 64 ? ~0ULL : (1ULL << bit_width) - 1;
+}
+
+// Unpacks 'count' values of 'bit_width' bits. 'in' must be readable for 16
+// bytes past the last packed byte.
+void unpack_scalar(const char* in, uint32_t bit_width, uint32_t count, uint64_t* out) {
+    uint64_t mask = bit_mask(bit_width);
+    uint64_t bit = 0;
+    if (bit_width <= 56) {
+        // every value is in one unaligned 8 byte word
+        for (uint32_t i = 0; i < count; ++i, bit += bit_width) {
+            out[i] = (load_uint64(in + bit / 8) >> (bit & 7)) & mask;
+        }
+    } else {
+        for (uint32_t i = 0; i < count; ++i, bit += bit_width) {
+            const char* p = in + bit / 8;
+            uint32_t shift = bit & 7;
+            uint64_t high = static_cast<uint8_t>(p[8]);
+            // a shift of 64 is undefined, shifting 'high' twice gives 0 then
+            out[i] = ((load_uint64(p) >> shift) | (high << 1 << (63 - shift))) & mask;
+        }
+    }
+}
+
+// Four values at a time: gather the 8 byte words holding them and shift
+// each lane by its own bit offset. Only for bit widths up to 56.
+__attribute__((target("avx2")))
+void unpack_avx2(const char* in, uint32_t bit_width, uint32_t count, uint64_t* out) {
+    const __m256i mask = _mm256_set1_epi64x(bit_mask(bit_width));
+    const __m256i seven = _mm256_set1_epi64x(7);
+    const __m256i step = _mm256_set1_epi64x(4 * bit_width);
+    __m256i bits = _mm256_setr_epi64x(0, bit_width, 2 * bit_width, 3 * bit_width);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i offsets = _mm256_srli_epi64(bits, 3);
+        __m256i shifts = _mm256_and_si256(bits, seven);
+        __m256i words = _mm256_i64gather_epi64(
+                reinterpret_cast<const long long*>(in), offsets, 1);
+        words = _mm256_and_si256(_mm256_srlv_epi64(words, shifts), mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), words);
+        bits = _mm256_add_epi64(bits, step);
+    }
+    uint64_t bit = static_cast<uint64_t>(i) * bit_width;
+    uint64_t scalar_mask = bit_mask(bit_width);
+    for (; i < count; ++i, bit += bit_width) {
+        out[i] = (load_uint64(in + bit / 8) >> (bit & 7)) & scalar_mask;
+    }
+}
+
+void unpack(const char* in, uint32_t bit_width, uint32_t count, uint64_t* out) {
+    if (bit_width == 0) {
+        memset(out, 0, count * sizeof(uint64_t));
+    } else if (bit_width <= 56 && CpuInfo::is_supported(CpuInfo::AVX2)) {
+        unpack_avx2(in, bit_width, count, out);
+    } else {
+        unpack_scalar(in, bit_width, count, out);
+    }
+}
+
+}  // namespace
+
+BitPackedIntegerReader::BitPackedIntegerReader(ReadOnlyFileStream* input) :
+        _input(input),
+        _num_literals(0),
+        _used(0) {
+    memset(_packed, 0, sizeof(_packed));
+}
+
+OLAPStatus BitPackedIntegerReader::_read_values() {
+    _num_literals = 0;
+    _used = 0;
+
+    uint8_t head = 0;
+    uint8_t count_byte = 0;
+    OLAPStatus res = OLAP_SUCCESS;
+    if (OLAP_SUCCESS != (res = _input->read(reinterpret_cast<char*>(&head)))
+            || OLAP_SUCCESS != (res = _input->read(reinterpret_cast<char*>(&count_byte)))) {
+        return res;
+    }
+    bool is_delta = (head & 0x80) != 0;
+    uint32_t bit_width = head & 0x7f;
+    uint32_t count = static_cast<uint32_t>(count_byte) + 1;
+    if (bit_width > 64 || count > BitPackedIntegerWriter::MINI_BLOCK_SIZE) {
+        OLAP_LOG_WARNING("invalid mini block header. [bit_width=%u count=%u]", bit_width, count);
+        return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+    }
+
+    int64_t base = 0;
+    int64_t min_delta = 0;
+    if (OLAP_SUCCESS != (res = ser::read_var_signed(_input, &base))) {
+        return res;
+    }
+    if (is_delta && OLAP_SUCCESS != (res = ser::read_var_signed(_input, &min_delta))) {
+        return res;
+    }
+
+    uint32_t num_packed = is_delta ? count - 1 : count;
+    uint64_t packed_bytes = (static_cast<uint64_t>(num_packed) * bit_width + 7) / 8;
+    if (packed_bytes > 0) {
+        uint64_t read_bytes = packed_bytes;
+        res = _input->read(_packed, &read_bytes);
+        if (OLAP_SUCCESS != res || read_bytes != packed_bytes) {
+            OLAP_LOG_WARNING("fail to read packed values. [expect=%lu read=%lu]",
+                             packed_bytes, read_bytes);
+            return OLAP_SUCCESS != res ? res : OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+        }
+    }
+
+    // int64_t and uint64_t may alias each other
+    uint64_t* values = reinterpret_cast<uint64_t*>(_literals);
+    if (is_delta) {
+        unpack(_packed, bit_width, num_packed, values + 1);
+        values[0] = static_cast<uint64_t>(base);
+        for (uint32_t i = 1; i < count; ++i) {
+            values[i] += values[i - 1] + static_cast<uint64_t>(min_delta);
+        }
+    } else {
+        unpack(_packed, bit_width, num_packed, values);
+        for (uint32_t i = 0; i < count; ++i) {
+            values[i] += static_cast<uint64_t>(base);
+        }
+    }
+    _num_literals = count;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus BitPackedIntegerReader::seek(PositionProvider* position) {
+    OLAPStatus res = OLAP_SUCCESS;
+    if (OLAP_SUCCESS != (res = _input->seek(position))) {
+        return res;
+    }
+
+    // values written before a position are all in the mini block after it
+    uint32_t consumed = static_cast<uint32_t>(position->get_next());
+    _num_literals = 0;
+    _used = 0;
+    if (consumed != 0) {
+        if (OLAP_SUCCESS != (res = _read_values())) {
+            return res;
+        }
+        _used = consumed;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus BitPackedIntegerReader::skip(uint64_t num_values) {
+    OLAPStatus res = OLAP_SUCCESS;
+
+    while (num_values > 0) {
+        if (_used == _num_literals) {
+            res = _read_values();
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to read values.[res=%d]", res);
+                return res;
+            }
+        }
+
+        uint64_t consume = std::min(num_values, static_cast<uint64_t>(_num_literals - _used));
+        _used += consume;
+        num_values -= consume;
+    }
+
+    return res;
+}
+
+}  // namespace doris
@@ -0,0 +1,98 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_BIT_PACKED_INTEGER_READER_H
+#define DORIS_BE_SRC_OLAP_BIT_PACKED_INTEGER_READER_H
+
+#include <algorithm>
+
+#include "olap/bit_packed_integer_writer.h"
+#include "olap/file_stream.h"
+#include "olap/olap_define.h"
+#include "olap/stream_index_reader.h"
+
+namespace doris {
+
+class ReadOnlyFileStream;
+class PositionProvider;
+
+// Reads the mini blocks of BitPackedIntegerWriter. A whole mini block is
+// unpacked at once, with AVX2 gathers when CpuInfo reports AVX2.
+class BitPackedIntegerReader {
+public:
+    explicit BitPackedIntegerReader(ReadOnlyFileStream* input);
+    ~BitPackedIntegerReader() {}
+
+    inline bool has_next() const {
+        return _used != _num_literals || !_input->eof();
+    }
+
+    // 获取下一条数据, 如果没有更多的数据了, 返回OLAP_ERR_DATA_EOF
+    inline OLAPStatus next(int64_t* value) {
+        if (OLAP_UNLIKELY(_used == _num_literals)) {
+            OLAPStatus res = _read_values();
+            if (OLAP_SUCCESS != res) {
+                return res;
+            }
+        }
+        *value = _literals[_used++];
+        return OLAP_SUCCESS;
+    }
+
+    // Reads 'count' values into 'values', copying whole mini blocks
+    template<class T>
+    OLAPStatus next_batch(T* values, uint32_t count) {
+        while (count > 0) {
+            if (_used == _num_literals) {
+                OLAPStatus res = _read_values();
+                if (OLAP_SUCCESS != res) {
+                    return res;
+                }
+            }
+            uint32_t n = std::min(count, _num_literals - _used);
+            const int64_t* src = _literals + _used;
+            for (uint32_t i = 0; i < n; ++i) {
+                values[i] = src[i];
+            }
+            values += n;
+            count -= n;
+            _used += n;
+        }
+        return OLAP_SUCCESS;
+    }
+
+    OLAPStatus seek(PositionProvider* position);
+    OLAPStatus skip(uint64_t num_values);
+
+private:
+    OLAPStatus _read_values();
+
+    ReadOnlyFileStream* _input;
+    int64_t _literals[BitPackedIntegerWriter::MINI_BLOCK_SIZE];
+    // packed values of a mini block, with room for the unaligned 8 byte
+    // loads of the unpack kernels past its end
+    char _packed[BitPackedIntegerWriter::MINI_BLOCK_SIZE * sizeof(uint64_t) + 2 * sizeof(uint64_t)];
+    uint32_t _num_literals;
+    uint32_t _used;
+
+    DISALLOW_COPY_AND_ASSIGN(BitPackedIntegerReader);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_BIT_PACKED_INTEGER_READER_H
@@ -0,0 +1,139 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/bit_packed_integer_writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "olap/out_stream.h"
+#include "olap/serialize.h"
+
+namespace doris {
+
+namespace {
+
+inline uint32_t bits_required(uint64_t value) {
+    return value == 0 ? 0 : 64 - __builtin_clzll(value);
+}
+
+}  // namespace
+
+BitPackedIntegerWriter::BitPackedIntegerWriter(OutStream* output) :
+        _output(output),
+        _num_literals(0) {}
+
+OLAPStatus BitPackedIntegerWriter::_write_values() {
+    uint32_t count = _num_literals;
+    _num_literals = 0;
+    if (count == 0) {
+        return OLAP_SUCCESS;
+    }
+
+    int64_t min_value = *std::min_element(_literals, _literals + count);
+    uint64_t max_offset = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        max_offset |= static_cast<uint64_t>(_literals[i]) - static_cast<uint64_t>(min_value);
+    }
+    uint32_t bit_width = bits_required(max_offset);
+
+    // deltas fit in fewer bits for sorted or slowly changing values, like
+    // keys, timestamps and counters
+    int64_t min_delta = 0;
+    for (uint32_t i = 1; i < count; ++i) {
+        _packed[i - 1] = static_cast<uint64_t>(_literals[i]) - static_cast<uint64_t>(_literals[i - 1]);
+        int64_t delta = static_cast<int64_t>(_packed[i - 1]);
+        min_delta = i == 1 ? delta : std::min(min_delta, delta);
+    }
+    uint64_t max_delta_offset = 0;
+    for (uint32_t i = 0; i + 1 < count; ++i) {
+        _packed[i] -= static_cast<uint64_t>(min_delta);
+        max_delta_offset |= _packed[i];
+    }
+    uint32_t delta_bit_width = bits_required(max_delta_offset);
+    bool is_delta = count > 1 && delta_bit_width < bit_width;
+
+    uint32_t num_packed = count - 1;
+    if (is_delta) {
+        bit_width = delta_bit_width;
+    } else {
+        num_packed = count;
+        for (uint32_t i = 0; i < count; ++i) {
+            _packed[i] = static_cast<uint64_t>(_literals[i]) - static_cast<uint64_t>(min_value);
+        }
+    }
+
+    OLAPStatus res = OLAP_SUCCESS;
+    if (OLAP_SUCCESS != (res = _output->write(static_cast<char>((is_delta ? 0x80 : 0) | bit_width)))
+            || OLAP_SUCCESS != (res = _output->write(static_cast<char>(count - 1)))
+            || OLAP_SUCCESS != (res = ser::write_var_signed(
+                    _output, is_delta ? _literals[0] : min_value))) {
+        OLAP_LOG_WARNING("fail to write mini block header.");
+        return res;
+    }
+    if (is_delta && OLAP_SUCCESS != (res = ser::write_var_signed(_output, min_delta))) {
+        OLAP_LOG_WARNING("fail to write mini block delta.");
+        return res;
+    }
+    if (bit_width == 0) {
+        return OLAP_SUCCESS;
+    }
+
+    // pack into a byte buffer from the lowest bit, 64 bits at a time
+    char buf[MINI_BLOCK_SIZE * sizeof(uint64_t) + sizeof(uint64_t)];
+    memset(buf, 0, sizeof(buf));
+    for (uint32_t i = 0; i < num_packed; ++i) {
+        uint64_t bit = static_cast<uint64_t>(i) * bit_width;
+        uint32_t shift = bit & 7;
+        char* dest = buf + bit / 8;
+        uint64_t word = 0;
+        memcpy(&word, dest, sizeof(word));
+        word |= _packed[i] << shift;
+        memcpy(dest, &word, sizeof(word));
+        if (shift + bit_width > 64) {
+            dest[8] |= static_cast<char>(_packed[i] >> (64 - shift));
+        }
+    }
+    uint64_t packed_bytes = (static_cast<uint64_t>(num_packed) * bit_width + 7) / 8;
+    if (OLAP_SUCCESS != (res = _output->write(buf, packed_bytes))) {
+        OLAP_LOG_WARNING("fail to write packed values.");
+        return res;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus BitPackedIntegerWriter::flush() {
+    OLAPStatus res = _write_values();
+    if (OLAP_SUCCESS != res) {
+        OLAP_LOG_WARNING("fail to write values.");
+        return res;
+    }
+    return _output->flush();
+}
+
+void BitPackedIntegerWriter::get_position(PositionEntryWriter* index_entry, bool print) const {
+    _output->get_position(index_entry);
+    index_entry->add_position(_num_literals);
+
+    if (print) {
+        _output->print_position_debug_info();
+        VLOG(10) << "literals=" << _num_literals;
+    }
+}
+
+}  // namespace doris
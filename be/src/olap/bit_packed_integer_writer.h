@@ -0,0 +1,75 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_BIT_PACKED_INTEGER_WRITER_H
+#define DORIS_BE_SRC_OLAP_BIT_PACKED_INTEGER_WRITER_H
+
+#include "olap/olap_define.h"
+#include "olap/stream_index_writer.h"
+
+namespace doris {
+
+class OutStream;
+
+// Frame of reference encoding of integers in mini blocks of up to
+// MINI_BLOCK_SIZE values, written by IntegerColumnWriter for columns with
+// the BIT_PACKED encoding. Every mini block is
+//
+//   1 byte   bit 7: delta flag, bits 0-6: bit width of the packed values
+//   1 byte   number of values - 1
+//   varint   zigzag encoded base: the smallest value, or the first value
+//            if the block is delta encoded
+//   varint   zigzag encoded smallest delta, only if delta encoded
+//   blob     (value - base) or (delta - smallest delta) of every value
+//            (but the first if delta encoded), bit_width bits each,
+//            packed from the lowest bit of the first byte
+//
+// All arithmetic wraps around in 64 bits, so signed and unsigned values
+// are handled alike. A block is delta encoded if that needs fewer bits.
+class BitPackedIntegerWriter {
+public:
+    static const uint32_t MINI_BLOCK_SIZE = 128;
+
+    explicit BitPackedIntegerWriter(OutStream* output);
+    ~BitPackedIntegerWriter() {}
+
+    OLAPStatus write(int64_t value) {
+        _literals[_num_literals++] = value;
+        if (_num_literals == MINI_BLOCK_SIZE) {
+            return _write_values();
+        }
+        return OLAP_SUCCESS;
+    }
+
+    OLAPStatus flush();
+    void get_position(PositionEntryWriter* index_entry, bool print) const;
+
+private:
+    OLAPStatus _write_values();
+
+    OutStream* _output;
+    int64_t _literals[MINI_BLOCK_SIZE];
+    uint64_t _packed[MINI_BLOCK_SIZE];
+    uint32_t _num_literals;
+
+    DISALLOW_COPY_AND_ASSIGN(BitPackedIntegerWriter);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_BIT_PACKED_INTEGER_WRITER_H
@@ -0,0 +1,104 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/bitmap_index_reader.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "olap/utils.h"
+
+namespace doris {
+
+BitmapIndexReader::~BitmapIndexReader() {
+    if (!_is_using_cache) {
+        SAFE_DELETE_ARRAY(_buffer);
+    }
+}
+
+OLAPStatus BitmapIndexReader::init(char* buffer, size_t buffer_size, bool is_using_cache) {
+    _buffer = buffer;
+    _is_using_cache = is_using_cache;
+    _entries.clear();
+
+    const char* ptr = buffer;
+    const char* end = buffer + buffer_size;
+    // reads a size and the bytes after it
+    auto read_slice = [&ptr, end](Slice* slice) {
+        uint32_t size = 0;
+        if (end - ptr < static_cast<ptrdiff_t>(sizeof(size))) {
+            return false;
+        }
+        memcpy(&size, ptr, sizeof(size));
+        ptr += sizeof(size);
+        if (end - ptr < static_cast<ptrdiff_t>(size)) {
+            return false;
+        }
+        *slice = Slice(ptr, size);
+        ptr += size;
+        return true;
+    };
+
+    uint32_t num_values = 0;
+    if (buffer_size < sizeof(num_values)) {
+        OLAP_LOG_WARNING("invalid bitmap index. [buffer_size=%lu]", buffer_size);
+        return OLAP_ERR_FILE_FORMAT_ERROR;
+    }
+    memcpy(&num_values, ptr, sizeof(num_values));
+    ptr += sizeof(num_values);
+    if (!read_slice(&_null_bitmap)) {
+        OLAP_LOG_WARNING("invalid bitmap index. [buffer_size=%lu]", buffer_size);
+        return OLAP_ERR_FILE_FORMAT_ERROR;
+    }
+    _entries.resize(num_values);
+    for (auto& entry : _entries) {
+        if (!read_slice(&entry.value) || !read_slice(&entry.bitmap)) {
+            OLAP_LOG_WARNING("invalid bitmap index. [buffer_size=%lu num_values=%u]",
+                             buffer_size, num_values);
+            return OLAP_ERR_FILE_FORMAT_ERROR;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus BitmapIndexReader::_add_bitmap(const Slice& bitmap, RoaringBitmap* rows) {
+    RoaringBitmap value_rows;
+    if (!value_rows.deserialize(bitmap.data, bitmap.size)) {
+        OLAP_LOG_WARNING("invalid bitmap in bitmap index. [size=%lu]", bitmap.size);
+        return OLAP_ERR_FILE_FORMAT_ERROR;
+    }
+    rows->union_with(value_rows);
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus BitmapIndexReader::lookup(const char* value, size_t size, RoaringBitmap* rows) const {
+    Slice key(value, size);
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), key,
+            [](const Entry& entry, const Slice& key) { return entry.value.compare(key) < 0; });
+    if (it == _entries.end() || it->value.compare(key) != 0) {
+        return OLAP_SUCCESS;
+    }
+    return _add_bitmap(it->bitmap, rows);
+}
+
+OLAPStatus BitmapIndexReader::lookup_null(RoaringBitmap* rows) const {
+    return _add_bitmap(_null_bitmap, rows);
+}
+
+} // namespace doris
@@ -0,0 +1,66 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_BITMAP_INDEX_READER_H
+#define DORIS_BE_SRC_OLAP_BITMAP_INDEX_READER_H
+
+#include <vector>
+
+#include "olap/olap_define.h"
+#include "util/roaring_bitmap.h"
+#include "util/slice.h"
+
+namespace doris {
+
+// Reads the bitmap index of a column of one segment written by
+// BitmapIndexWriter. Bitmaps are only decoded when they are looked up.
+class BitmapIndexReader {
+public:
+    BitmapIndexReader() {}
+    ~BitmapIndexReader();
+
+    // 'buffer' is released by this reader unless it is cached
+    OLAPStatus init(char* buffer, size_t buffer_size, bool is_using_cache);
+
+    // Adds the rows holding 'value' to 'rows'
+    OLAPStatus lookup(const char* value, size_t size, RoaringBitmap* rows) const;
+
+    // Adds the null rows to 'rows'
+    OLAPStatus lookup_null(RoaringBitmap* rows) const;
+
+    size_t num_values() const {
+        return _entries.size();
+    }
+
+private:
+    struct Entry {
+        Slice value;
+        Slice bitmap;
+    };
+
+    static OLAPStatus _add_bitmap(const Slice& bitmap, RoaringBitmap* rows);
+
+    char* _buffer = nullptr;
+    bool _is_using_cache = false;
+    Slice _null_bitmap;
+    // in byte order of the values
+    std::vector<Entry> _entries;
+};
+
+} // namespace doris
+#endif // DORIS_BE_SRC_OLAP_BITMAP_INDEX_READER_H
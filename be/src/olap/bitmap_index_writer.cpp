@@ -0,0 +1,103 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/bitmap_index_writer.h"
+
+#include "olap/out_stream.h"
+#include "olap/utils.h"
+
+namespace doris {
+
+void BitmapIndexWriter::add(const char* value, size_t size, uint32_t row) {
+    if (_overflow) {
+        return;
+    }
+    std::string key(value, size);
+    auto it = _values.find(key);
+    if (it == _values.end()) {
+        if (_values.size() >= _max_values) {
+            _overflow = true;
+            _values.clear();
+            _null_rows = RoaringBitmap();
+            return;
+        }
+        _value_bytes += size;
+        it = _values.emplace(std::move(key), RoaringBitmap()).first;
+    }
+    it->second.add(row);
+}
+
+void BitmapIndexWriter::add_null(uint32_t row) {
+    if (!_overflow) {
+        _null_rows.add(row);
+    }
+}
+
+uint64_t BitmapIndexWriter::estimate_buffered_memory() const {
+    uint64_t size = 2 * sizeof(uint32_t) + _null_rows.serialized_size() + _value_bytes;
+    for (auto& it : _values) {
+        size += 2 * sizeof(uint32_t) + it.second.serialized_size();
+    }
+    return size;
+}
+
+OLAPStatus BitmapIndexWriter::write_to_buffer(std::string* buffer) {
+    if (_overflow) {
+        OLAP_LOG_WARNING("bitmap index has too many values");
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+    buffer->clear();
+    buffer->reserve(estimate_buffered_memory());
+    auto append_bitmap = [buffer](const RoaringBitmap& bitmap) {
+        uint32_t size = bitmap.serialized_size();
+        buffer->append(reinterpret_cast<const char*>(&size), sizeof(size));
+        size_t offset = buffer->size();
+        buffer->resize(offset + size);
+        bitmap.serialize(&(*buffer)[offset]);
+    };
+
+    uint32_t num_values = _values.size();
+    buffer->append(reinterpret_cast<const char*>(&num_values), sizeof(num_values));
+    append_bitmap(_null_rows);
+    for (auto& it : _values) {
+        uint32_t size = it.first.size();
+        buffer->append(reinterpret_cast<const char*>(&size), sizeof(size));
+        buffer->append(it.first);
+        append_bitmap(it.second);
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus BitmapIndexWriter::write_to_buffer(OutStream* out_stream) {
+    if (NULL == out_stream) {
+        OLAP_LOG_WARNING("out stream is NULL");
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+    std::string buffer;
+    OLAPStatus res = write_to_buffer(&buffer);
+    if (OLAP_SUCCESS != res) {
+        return res;
+    }
+    res = out_stream->write(buffer.data(), buffer.size());
+    if (OLAP_SUCCESS != res) {
+        OLAP_LOG_WARNING("write bitmap index fail");
+    }
+    return res;
+}
+
+} // namespace doris
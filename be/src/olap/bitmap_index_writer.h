@@ -0,0 +1,66 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_BITMAP_INDEX_WRITER_H
+#define DORIS_BE_SRC_OLAP_BITMAP_INDEX_WRITER_H
+
+#include <map>
+#include <string>
+
+#include "olap/olap_define.h"
+#include "util/roaring_bitmap.h"
+
+namespace doris {
+
+class OutStream;
+
+// Builds the bitmap index of a column of one segment: every distinct value with
+// the bitmap of the rows holding it, plus the bitmap of the null rows. Values
+// are the bytes the bloom filters are built on.
+//
+// The index is: the number of values (4 bytes), the size of the null bitmap
+// (4 bytes) and the null bitmap, then for each value in byte order its size
+// (4 bytes), its bytes, the size of its bitmap (4 bytes) and the bitmap.
+class BitmapIndexWriter {
+public:
+    // values past 'max_values' drop the index, see is_valid
+    explicit BitmapIndexWriter(uint32_t max_values) : _max_values(max_values) {}
+
+    // rows must be added in ascending order
+    void add(const char* value, size_t size, uint32_t row);
+    void add_null(uint32_t row);
+
+    // false if the column has too many values to be indexed
+    bool is_valid() const {
+        return !_overflow;
+    }
+
+    uint64_t estimate_buffered_memory() const;
+    OLAPStatus write_to_buffer(OutStream* out_stream);
+    OLAPStatus write_to_buffer(std::string* buffer);
+
+private:
+    uint32_t _max_values;
+    bool _overflow = false;
+    std::map<std::string, RoaringBitmap> _values;
+    RoaringBitmap _null_rows;
+    uint64_t _value_bytes = 0;
+};
+
+} // namespace doris
+#endif // DORIS_BE_SRC_OLAP_BITMAP_INDEX_WRITER_H
@@ -18,13 +18,16 @@
 #ifndef DORIS_BE_SRC_OLAP_COLUMN_FILE_BLOOM_FILTER_HPP
 #define DORIS_BE_SRC_OLAP_COLUMN_FILE_BLOOM_FILTER_HPP
 
+#include <immintrin.h>
 #include <math.h>
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
 #include "olap/olap_define.h"
 #include "olap/utils.h"
+#include "util/cpu_info.h"
 #include "util/hash_util.hpp"
 
 namespace doris {
@@ -32,6 +35,55 @@ namespace doris {
 static const uint64_t DEFAULT_SEED = 104729;
 static const uint64_t BLOOM_FILTER_NULL_HASHCODE = 2862933555777941757ULL;
 
+// The hash function number recorded for bloom filters of the blocked layout.
+// Readers before the layout test no bit for it, so they keep every row.
+static const uint32_t BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM = 0;
+// bits of a block of the blocked layout, and their 32 bits words
+static const uint32_t BLOOM_FILTER_BLOCK_BITS = 256;
+static const uint32_t BLOOM_FILTER_BLOCK_WORDS = 8;
+static const uint32_t BLOOM_FILTER_BLOCK_SALT[BLOOM_FILTER_BLOCK_WORDS] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+// Bit i of word i of the block of a key is picked by the low 32 bits of its
+// hash multiplied by the i-th salt.
+static inline void bloom_filter_block_set(uint32_t hash, uint32_t* block) {
+    for (uint32_t i = 0; i < BLOOM_FILTER_BLOCK_WORDS; ++i) {
+        block[i] |= 1U << ((hash * BLOOM_FILTER_BLOCK_SALT[i]) >> 27);
+    }
+}
+
+static inline bool bloom_filter_block_test(uint32_t hash, const uint32_t* block) {
+    for (uint32_t i = 0; i < BLOOM_FILTER_BLOCK_WORDS; ++i) {
+        if ((block[i] & (1U << ((hash * BLOOM_FILTER_BLOCK_SALT[i]) >> 27))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i bloom_filter_block_mask_avx2(uint32_t hash) {
+    const __m256i salt = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(BLOOM_FILTER_BLOCK_SALT));
+    __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(hash), salt), 27);
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+}
+
+__attribute__((target("avx2")))
+static inline void bloom_filter_block_set_avx2(uint32_t hash, uint32_t* block) {
+    __m256i* ptr = reinterpret_cast<__m256i*>(block);
+    _mm256_storeu_si256(ptr, _mm256_or_si256(_mm256_loadu_si256(ptr),
+                                             bloom_filter_block_mask_avx2(hash)));
+}
+
+__attribute__((target("avx2")))
+static inline bool bloom_filter_block_test_avx2(uint32_t hash, const uint32_t* block) {
+    // true if all the bits of the mask are set in the block
+    return _mm256_testc_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)),
+                              bloom_filter_block_mask_avx2(hash));
+}
+
 struct BloomFilterIndexHeader {
     uint64_t block_count;
     BloomFilterIndexHeader() :
@@ -133,20 +185,36 @@ private:
     uint32_t  _data_len;
 };
 
+// The classic layout sets hash_function_num bits anywhere in the bit set for
+// a key. The blocked layout cuts the bit set into blocks of 256 bits, and a key
+// sets one bit in each 32 bits word of the block picked by the high 32 bits of
+// its hash, so a probe reads one cache line and is a few SIMD instructions.
+// Filters of the blocked layout have BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM as
+// hash function number, which is how they are told apart once written.
 class BloomFilter {
 public:
     BloomFilter() : _bit_num(0), _hash_function_num(0) {}
     ~BloomFilter() {}
 
     // Create BloomFilter with given entry num and fpp, which is used for loading data
-    bool init(int64_t expected_entries, double fpp) {
+    bool init(int64_t expected_entries, double fpp, bool blocked = false) {
         uint32_t bit_num = _optimal_bit_num(expected_entries, fpp);
+        if (blocked) {
+            bit_num = std::max(bit_num + BLOOM_FILTER_BLOCK_BITS - 1, BLOOM_FILTER_BLOCK_BITS)
+                    / BLOOM_FILTER_BLOCK_BITS * BLOOM_FILTER_BLOCK_BITS;
+        }
         if (!_bit_set.init(bit_num)) {
             return false;
         }
 
         _bit_num = _bit_set.bit_num();
-        _hash_function_num = _optimal_hash_function_num(expected_entries, _bit_num);
+        if (blocked) {
+            _hash_function_num = BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM;
+            _init_blocked();
+        } else {
+            _hash_function_num = _optimal_hash_function_num(expected_entries, _bit_num);
+            _blocked = false;
+        }
         return true;
     }
 
@@ -155,23 +223,44 @@ public:
         return this->init(expected_entries, BLOOM_FILTER_DEFAULT_FPP);
     }
 
-    // Init BloomFilter with given buffer, which is used for query
+    // Init BloomFilter with given buffer, which is used for query. Returns false
+    // if the buffer does not hold whole blocks of the blocked layout.
     bool init(uint64_t* data, uint32_t len, uint32_t hash_function_num) {
         _bit_num = sizeof(uint64_t) * 8 * len;
         _hash_function_num = hash_function_num;
-        return _bit_set.init(data, len);
+        if (!_bit_set.init(data, len)) {
+            return false;
+        }
+        if (hash_function_num != BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM) {
+            _blocked = false;
+            return true;
+        }
+        _init_blocked();
+        return _bit_num > 0 && _bit_num % BLOOM_FILTER_BLOCK_BITS == 0;
+    }
+
+    static uint64_t hash_bytes(const char* buf, uint32_t len) {
+        return buf == nullptr ?
+                BLOOM_FILTER_NULL_HASHCODE : HashUtil::hash64(buf, len, DEFAULT_SEED);
     }
 
     // Compute hash value of given buffer and add to BloomFilter
     void add_bytes(const char* buf, uint32_t len) {
-        uint64_t hash = buf == nullptr ?
-                BLOOM_FILTER_NULL_HASHCODE : HashUtil::hash64(buf, len, DEFAULT_SEED);
-        add_hash(hash);
+        add_hash(hash_bytes(buf, len));
     }
 
     // Generate mutiple hash value according to following rule:
     //     new_hash_value = hash_high_part + (i * hash_low_part)
     void add_hash(uint64_t hash) {
+        if (_blocked) {
+            uint32_t* block = _block(hash);
+            if (_use_avx2) {
+                bloom_filter_block_set_avx2((uint32_t) hash, block);
+            } else {
+                bloom_filter_block_set((uint32_t) hash, block);
+            }
+            return;
+        }
         uint32_t hash1 = (uint32_t) hash;
         uint32_t hash2 = (uint32_t) (hash >> 32);
 
@@ -182,15 +271,24 @@ public:
         }
     }
 
+    void add_hashes(const uint64_t* hashes, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            add_hash(hashes[i]);
+        }
+    }
+
     // Compute hash value of given buffer and verify whether exist in BloomFilter
     bool test_bytes(const char* buf, uint32_t len) const {
-        uint64_t hash = buf == nullptr ?
-                BLOOM_FILTER_NULL_HASHCODE : HashUtil::hash64(buf, len, DEFAULT_SEED);
-        return test_hash(hash);
+        return test_hash(hash_bytes(buf, len));
     }
 
     // Verify whether hash value in BloomFilter
     bool test_hash(uint64_t hash) const {
+        if (_blocked) {
+            const uint32_t* block = _block(hash);
+            return _use_avx2 ? bloom_filter_block_test_avx2((uint32_t) hash, block)
+                    : bloom_filter_block_test((uint32_t) hash, block);
+        }
         uint32_t hash1 = (uint32_t) hash;
         uint32_t hash2 = (uint32_t) (hash >> 32);
 
@@ -205,6 +303,40 @@ public:
         return true;
     }
 
+    // Sets results[i] to whether hashes[i] may be in this filter. The blocks of
+    // a run of hashes are prefetched before they are tested, so their cache
+    // misses overlap.
+    void test_hashes(const uint64_t* hashes, size_t n, uint8_t* results) const {
+        if (!_blocked) {
+            for (size_t i = 0; i < n; ++i) {
+                results[i] = test_hash(hashes[i]);
+            }
+            return;
+        }
+        static const size_t RUN_SIZE = 32;
+        for (size_t start = 0; start < n; start += RUN_SIZE) {
+            size_t end = std::min(n, start + RUN_SIZE);
+            for (size_t i = start; i < end; ++i) {
+                __builtin_prefetch(_block(hashes[i]));
+            }
+            if (_use_avx2) {
+                for (size_t i = start; i < end; ++i) {
+                    results[i] = bloom_filter_block_test_avx2(
+                            (uint32_t) hashes[i], _block(hashes[i]));
+                }
+            } else {
+                for (size_t i = start; i < end; ++i) {
+                    results[i] = bloom_filter_block_test(
+                            (uint32_t) hashes[i], _block(hashes[i]));
+                }
+            }
+        }
+    }
+
+    bool is_blocked() const {
+        return _blocked;
+    }
+
     // Merge with another BloomFilter, return false when the length
     //     and hash function number is not equal
     bool merge(const BloomFilter& that) {
@@ -224,6 +356,7 @@ public:
     void reset() {
         _bit_num = 0;
         _hash_function_num = 0;
+        _blocked = false;
         _bit_set.reset();
     }
 
@@ -278,6 +411,18 @@ public:
     }
 
 private:
+    void _init_blocked() {
+        _blocked = true;
+        _num_blocks = _bit_num / BLOOM_FILTER_BLOCK_BITS;
+        _use_avx2 = CpuInfo::is_supported(CpuInfo::AVX2);
+    }
+
+    // the block is picked by the high bits of the hash, the bits in it by the low ones
+    uint32_t* _block(uint64_t hash) const {
+        uint64_t index = ((hash >> 32) * _num_blocks) >> 32;
+        return reinterpret_cast<uint32_t*>(_bit_set.data()) + index * BLOOM_FILTER_BLOCK_WORDS;
+    }
+
     // Compute the optimal bit number according to the following rule:
     //     m = -n * ln(fpp) / (ln(2) ^ 2)
     uint32_t _optimal_bit_num(int64_t n, double fpp) {
@@ -294,6 +439,9 @@ private:
     BitSet _bit_set;
     uint32_t _bit_num;
     uint32_t _hash_function_num;
+    bool _blocked = false;
+    uint64_t _num_blocks = 0;
+    bool _use_avx2 = false;
 };
 
 }  // namespace doris
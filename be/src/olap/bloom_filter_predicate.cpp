@@ -0,0 +1,89 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/bloom_filter_predicate.h"
+#include "olap/field.h"
+#include "runtime/string_value.hpp"
+#include "runtime/vectorized_row_batch.h"
+
+namespace doris {
+
+// the bytes hashed are the same as the ones of RuntimeFilter::insert()
+template<class type>
+static inline uint64_t hash_value(const type& value) {
+    return BloomFilter::hash_bytes(reinterpret_cast<const char*>(&value), sizeof(type));
+}
+
+template<>
+inline uint64_t hash_value(const StringValue& value) {
+    return BloomFilter::hash_bytes(value.len == 0 ? "" : value.ptr, value.len);
+}
+
+template<class type>
+BloomFilterPredicate<type>::BloomFilterPredicate(
+        int column_id, std::shared_ptr<const BloomFilter> bloom_filter)
+    : _column_id(column_id),
+      _bloom_filter(std::move(bloom_filter)) {}
+
+template<class type>
+void BloomFilterPredicate<type>::evaluate(VectorizedRowBatch* batch) const {
+    uint16_t n = batch->size();
+    if (n == 0) {
+        return;
+    }
+    const BloomFilter& bloom_filter = *_bloom_filter;
+    if (dict_evaluate((const type*)nullptr, batch, _column_id, &_dict_cache,
+            [&bloom_filter](const type& v) { return bloom_filter.test_hash(hash_value(v)); })) {
+        return;
+    }
+    uint16_t* sel = batch->selected();
+    bool selected_in_use = batch->selected_in_use();
+    const type* col_vector = reinterpret_cast<const type*>(batch->column(_column_id)->col_data());
+    const bool* is_null = batch->column(_column_id)->no_nulls()
+            ? nullptr : batch->column(_column_id)->is_null();
+
+    // all the rows are hashed first and probed at once, so the cache misses
+    // of the probes overlap
+    _hashes.resize(n);
+    _results.resize(n);
+    for (uint16_t j = 0; j != n; ++j) {
+        uint16_t i = selected_in_use ? sel[j] : j;
+        // the values of null rows are not set
+        _hashes[j] = (is_null != nullptr && is_null[i]) ? 0 : hash_value(col_vector[i]);
+    }
+    bloom_filter.test_hashes(_hashes.data(), n, _results.data());
+
+    uint16_t new_size = 0;
+    for (uint16_t j = 0; j != n; ++j) {
+        uint16_t i = selected_in_use ? sel[j] : j;
+        sel[new_size] = i;
+        new_size += (_results[j] && (is_null == nullptr || !is_null[i]));
+    }
+    if (new_size < n) {
+        batch->set_size(new_size);
+        batch->set_selected_in_use(true);
+    }
+}
+
+template class BloomFilterPredicate<int8_t>;
+template class BloomFilterPredicate<int16_t>;
+template class BloomFilterPredicate<int32_t>;
+template class BloomFilterPredicate<int64_t>;
+template class BloomFilterPredicate<int128_t>;
+template class BloomFilterPredicate<StringValue>;
+
+} //namespace doris
@@ -0,0 +1,53 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_BLOOM_FILTER_PREDICATE_H
+#define DORIS_BE_SRC_OLAP_BLOOM_FILTER_PREDICATE_H
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "olap/bloom_filter.hpp"
+#include "olap/column_predicate.h"
+#include "olap/dict_predicate.h"
+
+namespace doris {
+
+class VectorizedRowBatch;
+
+// Keeps the rows whose value may be in a bloom filter, which is built from the
+// build side of a hash join. Null rows are dropped as they join no row.
+template <class type>
+class BloomFilterPredicate : public ColumnPredicate {
+public:
+    BloomFilterPredicate(int column_id, std::shared_ptr<const BloomFilter> bloom_filter);
+    virtual ~BloomFilterPredicate() {}
+    virtual void evaluate(VectorizedRowBatch* batch) const override;
+    virtual int32_t column_id() const override { return _column_id; }
+private:
+    int32_t _column_id;
+    std::shared_ptr<const BloomFilter> _bloom_filter;
+    mutable DictMatchCache _dict_cache;
+    // hashes of the rows of a batch and whether they may be in the filter
+    mutable std::vector<uint64_t> _hashes;
+    mutable std::vector<uint8_t> _results;
+};
+
+} //namespace doris
+
+#endif //DORIS_BE_SRC_OLAP_BLOOM_FILTER_PREDICATE_H
@@ -50,6 +50,11 @@ OLAPStatus BloomFilterIndexReader::init(
                 buffer_size, bit_num, _entry_count, _start_offset);
         return OLAP_ERR_INPUT_PARAMETER_ERROR;
     }
+    if (hash_function_num == BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM
+            && (bit_num == 0 || bit_num % BLOOM_FILTER_BLOCK_BITS != 0)) {
+        OLAP_LOG_WARNING("invalid bit num of blocked bloom filter. [bit_num=%u]", bit_num);
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
 
     return res;
 }
@@ -134,7 +134,8 @@ StorageByteBuffer* StorageByteBuffer::mmap(FileHandler* handler, uint64_t offset
 
     size_t length = handler->length();
     int fd = handler->fd();
-    char* memory = (char*)::mmap(NULL, length, prot, flags, fd, offset);
+    // the members of packed files start at page boundaries
+    char* memory = (char*)::mmap(NULL, length, prot, flags, fd, offset + handler->base_offset());
 
     if (MAP_FAILED == memory) {
         OLAP_LOG_WARNING("fail to mmap. [errno='%d' errno_str='%s']", Errno::no(), Errno::str());
@@ -199,6 +199,11 @@ public:
         return _array;
     }
 
+    // 内存是否还被其他ByteBuffer引用, 例如通过reference_buffer创建的buffer
+    bool is_shared() const {
+        return _buf.use_count() > 1;
+    }
+
 private:
     // 自定义析构类,支持对new[]和mmap的内存进行析构
     // 默认使用delete进行释放
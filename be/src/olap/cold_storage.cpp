@@ -0,0 +1,344 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/cold_storage.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include <boost/filesystem.hpp>
+
+#include "olap/file_helper.h"
+#include "olap/utils.h"
+
+namespace doris {
+
+static const std::string COLD_STORAGE_FILE_SCHEME = "file://";
+
+OLAPStatus ColdStorage::create(const std::string& uri, std::unique_ptr<ColdStorage>* storage) {
+    if (uri.compare(0, COLD_STORAGE_FILE_SCHEME.size(), COLD_STORAGE_FILE_SCHEME) != 0
+            || uri.size() == COLD_STORAGE_FILE_SCHEME.size()) {
+        LOG(WARNING) << "unsupported cold storage. uri=" << uri;
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+    std::string root_path = uri.substr(COLD_STORAGE_FILE_SCHEME.size());
+    if (!check_dir_existed(root_path)) {
+        LOG(WARNING) << "cold storage directory does not exist. path=" << root_path;
+        return OLAP_ERR_FILE_NOT_EXIST;
+    }
+    storage->reset(new LocalColdStorage(root_path));
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus LocalColdStorage::upload(const std::string& path, const std::string& key) {
+    std::string to_path = _root_path + "/" + key;
+    std::string tmp_path = to_path + ".tmp";
+    try {
+        boost::filesystem::create_directories(boost::filesystem::path(to_path).parent_path());
+    } catch (const boost::filesystem::filesystem_error& e) {
+        LOG(WARNING) << "fail to create cold storage directory. path=" << to_path
+                     << ", error=" << e.what();
+        return OLAP_ERR_IO_ERROR;
+    }
+    // a file left by a failed upload would keep its tail
+    ::remove(tmp_path.c_str());
+    OLAPStatus res = copy_file(path, tmp_path);
+    if (res == OLAP_SUCCESS && rename(tmp_path.c_str(), to_path.c_str()) != 0) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to rename cold file. [err='" << strerror_r(errno, errmsg, 64)
+                     << "' path='" << to_path << "']";
+        res = OLAP_ERR_IO_ERROR;
+    }
+    if (res != OLAP_SUCCESS) {
+        ::remove(tmp_path.c_str());
+    }
+    return res;
+}
+
+OLAPStatus LocalColdStorage::download(const std::string& key, const std::string& path) {
+    return copy_file(_root_path + "/" + key, path);
+}
+
+OLAPStatus LocalColdStorage::remove(const std::string& key) {
+    std::string path = _root_path + "/" + key;
+    if (::remove(path.c_str()) != 0 && errno != ENOENT) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to remove cold file. [err='" << strerror_r(errno, errmsg, 64)
+                     << "' path='" << path << "']";
+        return OLAP_ERR_IO_ERROR;
+    }
+    return OLAP_SUCCESS;
+}
+
+std::string cold_marker_path(const std::string& path) {
+    return path + ".cold";
+}
+
+static void erase_cached_file_descriptor(const std::string& path) {
+    Cache* fd_cache = FileHandler::get_fd_cache();
+    if (fd_cache != nullptr) {
+        fd_cache->erase(CacheKey(path.c_str(), path.size()));
+    }
+}
+
+OLAPStatus ColdFileManager::init() {
+    try {
+        // the copies left are not accounted
+        boost::filesystem::remove_all(_cache_path);
+        boost::filesystem::create_directories(_cache_path);
+    } catch (const boost::filesystem::filesystem_error& e) {
+        LOG(WARNING) << "fail to create cold file cache. path=" << _cache_path
+                     << ", error=" << e.what();
+        return OLAP_ERR_INIT_FAILED;
+    }
+    return OLAP_SUCCESS;
+}
+
+static OLAPStatus write_sparse_file(const std::string& path, const char* header,
+                                    size_t header_size, off_t length) {
+    FileHandler file;
+    OLAPStatus res = file.open_with_mode(path, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
+    RETURN_NOT_OK(file.pwrite(header, header_size, 0));
+    if (ftruncate(file.fd(), length) != 0) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to extend sparse file. [err='" << strerror_r(errno, errmsg, 64)
+                     << "' path='" << path << "']";
+        return OLAP_ERR_IO_ERROR;
+    }
+    return file.close();
+}
+
+OLAPStatus ColdFileManager::offload(const std::string& path, const std::string& key,
+                                    size_t keep_bytes, int64_t* released_bytes) {
+    if (is_cold(path)) {
+        return OLAP_SUCCESS;
+    }
+    FileHandler file;
+    RETURN_NOT_OK(file.open(path, O_RDONLY));
+    off_t length = file.length();
+    if (length <= static_cast<off_t>(keep_bytes)) {
+        return file.close();
+    }
+    std::unique_ptr<char[]> header(new(std::nothrow) char[keep_bytes]);
+    if (header == nullptr) {
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+    RETURN_NOT_OK(file.pread(header.get(), keep_bytes, 0));
+    RETURN_NOT_OK(file.close());
+
+    OLAPStatus res = _storage->upload(path, key);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to upload file to cold storage. path=" << path << ", key=" << key;
+        return res;
+    }
+    // the file is replaced rather than punched, the readers which opened it
+    // before still read all of it
+    std::string sparse_path = path + ".sparse";
+    std::string marker_path = cold_marker_path(path);
+    bool marked = false;
+    res = write_sparse_file(sparse_path, header.get(), keep_bytes, length);
+    if (res == OLAP_SUCCESS) {
+        res = _write_marker(path, key);
+        marked = res == OLAP_SUCCESS;
+    }
+    if (res == OLAP_SUCCESS && rename(sparse_path.c_str(), path.c_str()) != 0) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to replace file by sparse file. [err='"
+                     << strerror_r(errno, errmsg, 64) << "' path='" << path << "']";
+        res = OLAP_ERR_IO_ERROR;
+    }
+    if (res != OLAP_SUCCESS) {
+        // the file is still whole
+        ::remove(sparse_path.c_str());
+        if (marked) {
+            ::remove(marker_path.c_str());
+        }
+        _storage->remove(key);
+        return res;
+    }
+    // the descriptor of the cache keeps the replaced file
+    erase_cached_file_descriptor(path);
+    *released_bytes += length - keep_bytes;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus ColdFileManager::open(const std::string& path, FileHandler* file_handler) {
+    std::string key;
+    OLAPStatus res = _read_marker(path, &key);
+    if (res == OLAP_ERR_FILE_NOT_EXIST) {
+        return file_handler->open_with_cache(path, O_RDONLY);
+    }
+    RETURN_NOT_OK(res);
+    return _open_cached_file(key, file_handler);
+}
+
+OLAPStatus ColdFileManager::restore(const std::string& path, const std::string& to_path) {
+    std::string key;
+    RETURN_NOT_OK(_read_marker(path, &key));
+    return _storage->download(key, to_path);
+}
+
+void ColdFileManager::release(const std::string& path) {
+    std::string marker_path = cold_marker_path(path);
+    struct stat stat_data;
+    if (stat(marker_path.c_str(), &stat_data) != 0) {
+        return;
+    }
+    std::string key;
+    if (stat_data.st_nlink == 1 && _read_marker(path, &key) == OLAP_SUCCESS) {
+        _erase_cached_file(key);
+        if (_storage->remove(key) != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to remove file from cold storage. key=" << key;
+        }
+    }
+    if (::remove(marker_path.c_str()) != 0) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to remove cold marker. [err='" << strerror_r(errno, errmsg, 64)
+                     << "' path='" << marker_path << "']";
+    }
+}
+
+bool ColdFileManager::is_cold(const std::string& path) const {
+    return access(cold_marker_path(path).c_str(), F_OK) == 0;
+}
+
+int64_t ColdFileManager::cache_size() {
+    std::lock_guard<std::mutex> l(_lock);
+    return _cache_size;
+}
+
+OLAPStatus ColdFileManager::_read_marker(const std::string& path, std::string* key) const {
+    std::string marker_path = cold_marker_path(path);
+    if (access(marker_path.c_str(), F_OK) != 0) {
+        return OLAP_ERR_FILE_NOT_EXIST;
+    }
+    FileHandler marker;
+    RETURN_NOT_OK(marker.open(marker_path, O_RDONLY));
+    key->resize(marker.length());
+    RETURN_NOT_OK(marker.pread(&(*key)[0], key->size(), 0));
+    return marker.close();
+}
+
+OLAPStatus ColdFileManager::_write_marker(const std::string& path, const std::string& key) const {
+    std::string marker_path = cold_marker_path(path);
+    std::string tmp_path = marker_path + ".tmp";
+    FileHandler marker;
+    OLAPStatus res = marker.open_with_mode(
+            tmp_path, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+    if (res == OLAP_SUCCESS) {
+        res = marker.write(key.data(), key.size());
+    }
+    if (res == OLAP_SUCCESS) {
+        res = marker.close();
+    }
+    if (res == OLAP_SUCCESS && rename(tmp_path.c_str(), marker_path.c_str()) != 0) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to write cold marker. [err='" << strerror_r(errno, errmsg, 64)
+                     << "' path='" << marker_path << "']";
+        res = OLAP_ERR_IO_ERROR;
+    }
+    if (res != OLAP_SUCCESS) {
+        ::remove(tmp_path.c_str());
+    }
+    return res;
+}
+
+std::string ColdFileManager::_cached_file_path(const std::string& key) const {
+    std::string name = key;
+    std::replace(name.begin(), name.end(), '/', '_');
+    return _cache_path + "/" + name;
+}
+
+OLAPStatus ColdFileManager::_open_cached_file(const std::string& key,
+                                              FileHandler* file_handler) {
+    std::string cached_path = _cached_file_path(key);
+    {
+        // opened under the lock, a copy being evicted is not opened
+        std::lock_guard<std::mutex> l(_lock);
+        auto it = _cached_files.find(key);
+        if (it != _cached_files.end()) {
+            _lru.splice(_lru.end(), _lru, it->second.lru_pos);
+            return file_handler->open_with_cache(cached_path, O_RDONLY);
+        }
+    }
+
+    std::string tmp_path = cached_path + ".tmp." + std::to_string(_next_download_id++);
+    OLAPStatus res = _storage->download(key, tmp_path);
+    struct stat stat_data;
+    if (res == OLAP_SUCCESS && stat(tmp_path.c_str(), &stat_data) != 0) {
+        res = OLAP_ERR_IO_ERROR;
+    }
+    if (res == OLAP_SUCCESS && rename(tmp_path.c_str(), cached_path.c_str()) != 0) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to add cold file to cache. [err='" << strerror_r(errno, errmsg, 64)
+                     << "' path='" << cached_path << "']";
+        res = OLAP_ERR_IO_ERROR;
+    }
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to download file from cold storage. key=" << key;
+        ::remove(tmp_path.c_str());
+        return res;
+    }
+
+    std::lock_guard<std::mutex> l(_lock);
+    // a concurrent download of the same file replaced the same copy
+    if (_cached_files.find(key) == _cached_files.end()) {
+        _lru.push_back(key);
+        _cached_files[key] = {stat_data.st_size, std::prev(_lru.end())};
+        _cache_size += stat_data.st_size;
+        _evict();
+    }
+    return file_handler->open_with_cache(cached_path, O_RDONLY);
+}
+
+void ColdFileManager::_erase_cached_file(const std::string& key) {
+    std::lock_guard<std::mutex> l(_lock);
+    auto it = _cached_files.find(key);
+    if (it == _cached_files.end()) {
+        return;
+    }
+    std::string cached_path = _cached_file_path(key);
+    ::remove(cached_path.c_str());
+    erase_cached_file_descriptor(cached_path);
+    _cache_size -= it->second.size;
+    _lru.erase(it->second.lru_pos);
+    _cached_files.erase(it);
+}
+
+void ColdFileManager::_evict() {
+    // the copy just read is kept whatever its size
+    while (_cache_size > _capacity && _lru.size() > 1) {
+        const std::string& key = _lru.front();
+        std::string cached_path = _cached_file_path(key);
+        ::remove(cached_path.c_str());
+        erase_cached_file_descriptor(cached_path);
+        auto it = _cached_files.find(key);
+        _cache_size -= it->second.size;
+        _cached_files.erase(it);
+        _lru.pop_front();
+    }
+}
+
+}  // namespace doris
@@ -0,0 +1,138 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_COLD_STORAGE_H
+#define DORIS_BE_SRC_OLAP_COLD_STORAGE_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "olap/olap_define.h"
+
+namespace doris {
+
+class FileHandler;
+
+// A storage outside of the stores for the data files of the cold versions,
+// holding them by key.
+class ColdStorage {
+public:
+    virtual ~ColdStorage() { }
+
+    virtual OLAPStatus upload(const std::string& path, const std::string& key) = 0;
+    virtual OLAPStatus download(const std::string& key, const std::string& path) = 0;
+    virtual OLAPStatus remove(const std::string& key) = 0;
+
+    // Creates the storage of 'uri'. Only file://<dir> is supported, e.g. the
+    // mount point of an object store.
+    static OLAPStatus create(const std::string& uri, std::unique_ptr<ColdStorage>* storage);
+};
+
+// Keeps the files of the keys under a local directory.
+class LocalColdStorage : public ColdStorage {
+public:
+    explicit LocalColdStorage(const std::string& root_path) : _root_path(root_path) { }
+
+    OLAPStatus upload(const std::string& path, const std::string& key) override;
+    OLAPStatus download(const std::string& key, const std::string& path) override;
+    OLAPStatus remove(const std::string& key) override;
+
+private:
+    std::string _root_path;
+};
+
+// Path of the marker of a data file moved to the cold storage, holding its key.
+std::string cold_marker_path(const std::string& path);
+
+// Moves the data files of the stores to a ColdStorage and reads them back.
+//
+// A moved file is replaced by a sparse file of the same length keeping only its
+// first 'keep_bytes', the file header, so that the segment groups are still
+// loaded and validated from the stores, and its marker is written next to it.
+// The replaced file stays whole for the readers which opened it before. The
+// others open a local copy from the cache directory, downloaded at the first
+// read and removed least recently used first beyond 'capacity' bytes.
+// The moved file is removed from the cold storage with the last link of its
+// marker, see release(). Only the data files of unpacked segment groups are
+// moved.
+class ColdFileManager {
+public:
+    ColdFileManager(ColdStorage* storage, const std::string& cache_path, int64_t capacity)
+            : _storage(storage), _cache_path(cache_path), _capacity(capacity) { }
+
+    // Creates the cache directory, the copies left in it are removed
+    OLAPStatus init();
+
+    // Moves the data of 'path' to the cold storage as 'key', adds the number of
+    // bytes released from the store to 'released_bytes'. Files already moved
+    // are left as they are.
+    OLAPStatus offload(const std::string& path, const std::string& key,
+                       size_t keep_bytes, int64_t* released_bytes);
+
+    // Opens 'path' with the fd cache, or its local copy if it was moved to the
+    // cold storage.
+    OLAPStatus open(const std::string& path, FileHandler* file_handler);
+
+    // Writes the whole content of 'path' to the new file 'to_path'.
+    OLAPStatus restore(const std::string& path, const std::string& to_path);
+
+    // Removes the marker of removed data file 'path', and its file from the cold
+    // storage and the cache if no other link of the marker is left.
+    void release(const std::string& path);
+
+    bool is_cold(const std::string& path) const;
+
+    int64_t cache_size();
+
+private:
+    struct CachedFile {
+        int64_t size;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    // returns OLAP_ERR_FILE_NOT_EXIST if 'path' was not moved
+    OLAPStatus _read_marker(const std::string& path, std::string* key) const;
+    OLAPStatus _write_marker(const std::string& path, const std::string& key) const;
+    std::string _cached_file_path(const std::string& key) const;
+    OLAPStatus _open_cached_file(const std::string& key, FileHandler* file_handler);
+    void _erase_cached_file(const std::string& key);
+    // removes the least recently read copies beyond the capacity, _lock held
+    void _evict();
+
+    ColdStorage* _storage;
+    std::string _cache_path;
+    int64_t _capacity;
+
+    std::mutex _lock;
+    // the keys of the cached copies, least recently read first
+    std::list<std::string> _lru;
+    std::unordered_map<std::string, CachedFile> _cached_files;
+    int64_t _cache_size = 0;
+    // names the downloads of the same file apart
+    std::atomic<int64_t> _next_download_id{0};
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_COLD_STORAGE_H
@@ -17,7 +17,12 @@
 
 #include "column_data.h"
 
+#include <string.h>
+
+#include <memory>
+
 #include "olap/segment_reader.h"
+#include "olap/stream_index_common.h"
 #include "olap/olap_cond.h"
 #include "olap/olap_table.h"
 #include "olap/row_block.h"
@@ -148,6 +153,7 @@ OLAPStatus ColumnData::_seek_to_block(const RowBlockPosition& block_pos, bool wi
         }
 
         _current_segment = block_pos.segment; 
+        _segment_reader->set_delete_bitmap(_delete_bitmap, _delete_bitmap_version);
         auto res = _segment_reader->init(_is_using_cache);
         if (OLAP_SUCCESS != res) {
             OLAP_LOG_WARNING("fail to init segment reader. [res=%d]", res);
@@ -578,6 +584,58 @@ int ColumnData::delete_pruning_filter() {
     return ret;
 }
 
+OLAPStatus ColumnData::get_min_max(RowCursor* min_row, RowCursor* max_row, bool* known) {
+    *known = false;
+    const std::vector<uint32_t>& columns = _return_columns;
+    std::vector<std::unique_ptr<ColumnStatistics>> stats;
+    for (uint32_t cid : columns) {
+        stats.emplace_back(new ColumnStatistics());
+        RETURN_NOT_OK(stats.back()->init(_table->tablet_schema()[cid].type, true));
+    }
+
+    for (uint32_t seg_id = 0; seg_id < _segment_group->num_segments(); ++seg_id) {
+        std::string file_name = segment_group()->construct_data_file_path(
+                segment_group()->segment_group_id(), seg_id);
+        SegmentReader segment_reader(
+                file_name, _table, segment_group(), seg_id,
+                _seek_columns, _load_bf_columns, _conditions,
+                _col_predicates, _delete_handler, _delete_status, _runtime_state, _stats);
+        auto res = segment_reader.init(_is_using_cache);
+        if (OLAP_SUCCESS != res) {
+            OLAP_LOG_WARNING("fail to init segment reader. [res=%d]", res);
+            return res;
+        }
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (!segment_reader.merge_column_statistics(columns[i], stats[i].get())) {
+                return OLAP_SUCCESS;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < columns.size(); ++i) {
+        uint32_t cid = columns[i];
+        const WrapperField* minimum = stats[i]->minimum();
+        const WrapperField* maximum = stats[i]->maximum();
+        if (maximum->is_null()) {
+            // all values are null, or there are no rows
+            min_row->set_null(cid);
+            max_row->set_null(cid);
+            continue;
+        }
+        if (minimum->is_null()) {
+            // null sorts first, the smallest value is not known
+            return OLAP_SUCCESS;
+        }
+        size_t size = min_row->get_field_by_index(cid)->size();
+        min_row->set_not_null(cid);
+        memcpy(min_row->get_field_content_ptr(cid), minimum->ptr(), size);
+        max_row->set_not_null(cid);
+        memcpy(max_row->get_field_content_ptr(cid), maximum->ptr(), size);
+    }
+    *known = true;
+    return OLAP_SUCCESS;
+}
+
 uint64_t ColumnData::get_filted_rows() {
     return _stats->rows_del_filtered;
 }
@@ -645,7 +703,12 @@ OLAPStatus ColumnData::_get_block_from_reader(
 
         if (!_segment_eof) {
             _current_block = _next_block;
-            auto res = _segment_reader->get_block(vec_batch, &_next_block, &_segment_eof);
+            // predicates are evaluated inside segment reader, so that it can skip
+            // decoding other columns for filtered rows. Rows must stay where they
+            // are in the block when looking for the end key, so are replaced rows.
+            auto res = _segment_reader->get_block(vec_batch, &_next_block, &_segment_eof,
+                                                  !without_filter && _need_eval_predicates,
+                                                  !without_filter);
             if (res != OLAP_SUCCESS) {
                 return res;
             }
@@ -674,15 +737,6 @@ OLAPStatus ColumnData::_get_block(bool without_filter, int rows_read) {
         if (res != OLAP_SUCCESS) {
             return res;
         }
-        // evaluate predicates
-        if (!without_filter && _need_eval_predicates) {
-            SCOPED_RAW_TIMER(&_stats->vec_cond_ns);
-            size_t old_size = vec_batch->size();
-            for (auto pred : *_col_predicates) {
-                pred->evaluate(vec_batch);
-            }
-            _stats->rows_vec_cond_filtered += old_size - vec_batch->size();
-        }
         // if vector is empty after predicate evaluate, get next block
         if (vec_batch->size() == 0) {
             continue;
@@ -97,10 +97,26 @@ public:
         _delete_handler = delete_handler;
     }
 
+    DelCondSatisfied delete_status() const {
+        return _delete_status;
+    }
+
+    // Sets the return columns of 'min_row' and 'max_row' to their minimum and
+    // maximum over all rows, from the statistics of the blocks without reading
+    // them. 'known' is false if the statistics can not tell, e.g. for strings or
+    // the minimum of a column with nulls.
+    OLAPStatus get_min_max(RowCursor* min_row, RowCursor* max_row, bool* known);
+
     void set_delete_status(const DelCondSatisfied delete_status) {
         _delete_status = delete_status;
     }
 
+    // Skip rows of merge-on-write tables replaced in 'version' or before
+    void set_delete_bitmap(std::shared_ptr<const DeleteBitmap> bitmap, int64_t version) {
+        _delete_bitmap = std::move(bitmap);
+        _delete_bitmap_version = version;
+    }
+
     // 开放接口查询_eof，让外界知道数据读取是否正常终止
     // 因为这个函数被频繁访问, 从性能考虑, 放在基类而不是虚函数
     bool eof() { return _eof; }
@@ -119,6 +135,9 @@ public:
     int64_t num_rows() const { return _segment_group->num_rows(); }
 
     const std::vector<uint32_t>& seek_columns() const { return _seek_columns; }
+
+    // Segment of the block returned last
+    uint32_t current_segment() const { return _current_segment; }
 private:
     DISALLOW_COPY_AND_ASSIGN(ColumnData);
 
@@ -195,6 +214,8 @@ private:
     // Record when last key is found
     uint32_t _current_block = 0;
     uint32_t _current_segment;
+    std::shared_ptr<const DeleteBitmap> _delete_bitmap;
+    int64_t _delete_bitmap_version = -1;
     uint32_t _next_block;
 
     uint32_t _end_segment;
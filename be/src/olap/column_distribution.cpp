@@ -0,0 +1,253 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/column_distribution.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/config.h"
+#include "exprs/aggregate_functions.h"
+#include "olap/field.h"
+#include "util/hash_util.hpp"
+#include "util/slice.h"
+
+namespace doris {
+
+// hashes collected before the explicit ones are folded into the registers
+static const size_t kMaxPendingHashes = 4096;
+
+bool has_column_distribution(const FieldInfo& field_info) {
+    switch (field_info.type) {
+    case OLAP_FIELD_TYPE_HLL:
+    case OLAP_FIELD_TYPE_STRUCT:
+    case OLAP_FIELD_TYPE_LIST:
+    case OLAP_FIELD_TYPE_MAP:
+    case OLAP_FIELD_TYPE_UNKNOWN:
+    case OLAP_FIELD_TYPE_NONE:
+        return false;
+    default:
+        return true;
+    }
+}
+
+static bool is_hll_explicit(const HllContext& hll) {
+    return !hll.has_sparse_or_full && hll.hash64_set->size() <= HLL_EXPLICLIT_INT64_NUM;
+}
+
+// Encodes 'hll' into 'output' and returns the number of distinct hashes.
+static int64_t finish_hll(HllContext* hll, std::string* output) {
+    std::string buf(HLL_COLUMN_DEFAULT_LEN, '\0');
+    int len = 0;
+    // sorts and dedups the explicit hashes, or else folds them into the registers
+    HllSetHelper::set_hll(&buf[0], hll, len);
+    if (len > 0) {
+        output->assign(buf.data(), len);
+    }
+    if (is_hll_explicit(*hll)) {
+        return hll->hash64_set->size();
+    }
+    return AggregateFunctions::hll_algorithm(
+            reinterpret_cast<uint8_t*>(hll->registers), HLL_REGISTERS_COUNT);
+}
+
+ColumnDistributionCollector::ColumnDistributionCollector(const FieldInfo& field_info)
+        : _field_info(field_info),
+          _is_string_type(field_info.type == OLAP_FIELD_TYPE_CHAR
+                          || field_info.type == OLAP_FIELD_TYPE_VARCHAR),
+          _max_sample_size(std::max(config::column_distribution_sample_size, 2)) {
+    std::unique_ptr<Field> field(Field::create(field_info));
+    _value_size = field == nullptr ? 0 : field->size();
+    HllSetHelper::init_context(&_hll);
+}
+
+ColumnDistributionCollector::~ColumnDistributionCollector() {
+    delete _hll.hash64_set;
+}
+
+void ColumnDistributionCollector::add(char* cell) {
+    ++_num_rows;
+    if (*reinterpret_cast<bool*>(cell)) {
+        ++_null_count;
+        return;
+    }
+    const char* value = cell + 1;
+    uint64_t hash = 0;
+    if (_is_string_type) {
+        const Slice* slice = reinterpret_cast<const Slice*>(value);
+        hash = HashUtil::murmur_hash64A(slice->data, slice->size, HashUtil::MURMUR_SEED);
+    } else {
+        hash = HashUtil::murmur_hash64A(value, _value_size, HashUtil::MURMUR_SEED);
+    }
+    _hll.hash64_set->push_back(hash);
+    if (_hll.hash64_set->size() >= kMaxPendingHashes) {
+        _fold_hashes();
+    }
+
+    int64_t pos = _num_rows - _null_count - 1;
+    if (pos % _stride != 0) {
+        return;
+    }
+    if (_sample.size() == _max_sample_size) {
+        // keep the values at the multiples of the doubled stride
+        size_t kept = 0;
+        for (size_t i = 0; i < _sample.size(); i += 2) {
+            _sample[kept++] = std::move(_sample[i]);
+        }
+        _sample.resize(kept);
+        _stride *= 2;
+        if (pos % _stride != 0) {
+            return;
+        }
+    }
+    WrapperField* field = WrapperField::create(_field_info);
+    if (field == nullptr) {
+        return;
+    }
+    field->copy(cell);
+    _sample.emplace_back(field);
+}
+
+void ColumnDistributionCollector::_fold_hashes() {
+    std::vector<uint64_t>* hashes = _hll.hash64_set;
+    std::sort(hashes->begin(), hashes->end());
+    hashes->erase(std::unique(hashes->begin(), hashes->end()), hashes->end());
+    if (hashes->size() > HLL_EXPLICLIT_INT64_NUM) {
+        HllSetHelper::set_max_register(_hll.registers, HLL_REGISTERS_COUNT, *hashes);
+        hashes->clear();
+        _hll.has_sparse_or_full = true;
+    }
+}
+
+void ColumnDistributionCollector::finish(ColumnDistribution* distribution) {
+    distribution->set_column_unique_id(_field_info.unique_id);
+    distribution->set_num_rows(_num_rows);
+    distribution->set_null_count(_null_count);
+    int64_t num_values = _num_rows - _null_count;
+    if (num_values == 0) {
+        return;
+    }
+    finish_hll(&_hll, distribution->mutable_hll());
+
+    if (_sample.empty()) {
+        return;
+    }
+    std::sort(_sample.begin(), _sample.end(),
+              [](const std::unique_ptr<WrapperField>& lhs, const std::unique_ptr<WrapperField>& rhs) {
+                  return lhs->cmp(rhs.get()) < 0;
+              });
+    int64_t num_samples = _sample.size();
+    int64_t num_buckets = std::min<int64_t>(
+            std::max(config::column_histogram_buckets, 1), num_samples);
+    int64_t prev_rows = 0;
+    const WrapperField* prev_bound = nullptr;
+    for (int64_t bucket = 1; bucket <= num_buckets; ++bucket) {
+        int64_t idx = (bucket * num_samples + num_buckets - 1) / num_buckets - 1;
+        int64_t rows = bucket == num_buckets
+            ? num_values
+            : std::llround(static_cast<double>(idx + 1) * num_values / num_samples);
+        const WrapperField* bound = _sample[idx].get();
+        if (prev_bound != nullptr && prev_bound->cmp(bound) == 0) {
+            // a frequent value spanning buckets makes one bucket of its own
+            int last = distribution->histogram_count_size() - 1;
+            distribution->set_histogram_count(
+                    last, distribution->histogram_count(last) + rows - prev_rows);
+        } else {
+            distribution->add_histogram_bound(bound->to_string());
+            distribution->add_histogram_count(rows - prev_rows);
+        }
+        prev_rows = rows;
+        prev_bound = bound;
+    }
+}
+
+ColumnDistributionMerger::ColumnDistributionMerger(const FieldInfo& field_info)
+        : _field_info(field_info) {
+    HllSetHelper::init_context(&_hll);
+}
+
+ColumnDistributionMerger::~ColumnDistributionMerger() {
+    delete _hll.hash64_set;
+}
+
+void ColumnDistributionMerger::merge(const ColumnDistribution& distribution) {
+    _num_rows += distribution.num_rows();
+    _null_count += distribution.null_count();
+    if (!distribution.hll().empty()) {
+        Slice slice(distribution.hll());
+        HllSetHelper::fill_set(reinterpret_cast<const char*>(&slice), &_hll);
+    }
+    int num_buckets = std::min(distribution.histogram_bound_size(),
+                               distribution.histogram_count_size());
+    for (int i = 0; i < num_buckets; ++i) {
+        std::unique_ptr<WrapperField> bound(WrapperField::create(_field_info));
+        if (bound == nullptr || bound->from_string(distribution.histogram_bound(i)) != OLAP_SUCCESS) {
+            continue;
+        }
+        bound->set_not_null();
+        _buckets.emplace_back(std::move(bound), distribution.histogram_count(i));
+    }
+}
+
+void ColumnDistributionMerger::finish(TColumnDistribution* distribution) {
+    distribution->__set_column_name(_field_info.name);
+    distribution->__set_num_rows(_num_rows);
+    distribution->__set_null_count(_null_count);
+    if (_num_rows == _null_count) {
+        distribution->__set_ndv(0);
+        return;
+    }
+    std::string hll;
+    distribution->__set_ndv(finish_hll(&_hll, &hll));
+    distribution->__set_hll(hll);
+
+    if (_buckets.empty()) {
+        return;
+    }
+    // the buckets of all the segment groups, sorted by their bounds, are cut
+    // again into buckets of equal depth
+    std::sort(_buckets.begin(), _buckets.end(),
+              [](const std::pair<std::unique_ptr<WrapperField>, int64_t>& lhs,
+                 const std::pair<std::unique_ptr<WrapperField>, int64_t>& rhs) {
+                  return lhs.first->cmp(rhs.first.get()) < 0;
+              });
+    int64_t total_rows = 0;
+    for (auto& bucket : _buckets) {
+        total_rows += bucket.second;
+    }
+    int num_buckets = std::max(config::column_histogram_buckets, 1);
+    double depth = static_cast<double>(total_rows) / num_buckets;
+    std::vector<std::string> bounds;
+    std::vector<int64_t> counts;
+    int64_t rows = 0;
+    int64_t bucket_rows = 0;
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        rows += _buckets[i].second;
+        bucket_rows += _buckets[i].second;
+        bool last = i + 1 == _buckets.size();
+        if (last || (rows >= depth * (counts.size() + 1)
+                     && _buckets[i].first->cmp(_buckets[i + 1].first.get()) != 0)) {
+            bounds.push_back(_buckets[i].first->to_string());
+            counts.push_back(bucket_rows);
+            bucket_rows = 0;
+        }
+    }
+    distribution->__set_histogram_bounds(bounds);
+    distribution->__set_histogram_counts(counts);
+}
+
+}  // namespace doris
@@ -0,0 +1,88 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_COLUMN_DISTRIBUTION_H
+#define DORIS_BE_SRC_OLAP_COLUMN_DISTRIBUTION_H
+
+#include <memory>
+#include <vector>
+
+#include "gen_cpp/MasterService_types.h"
+#include "gen_cpp/olap_file.pb.h"
+#include "olap/field_info.h"
+#include "olap/hll.h"
+#include "olap/wrapper_field.h"
+
+namespace doris {
+
+// The value distribution of a column of a segment group is collected by the
+// writer from the rows it writes anyway, and kept in the header beside the
+// segment group: the null count, an hll of the hashes of the values and an
+// equi-depth histogram built from a sample of the values. The distributions
+// of the versions of a tablet are merged into the tablet reports, so the FE
+// knows the number of distinct values and the skew of the columns.
+
+// Returns false for the types without a distribution, i.e. HLL and the nested types.
+bool has_column_distribution(const FieldInfo& field_info);
+
+class ColumnDistributionCollector {
+public:
+    explicit ColumnDistributionCollector(const FieldInfo& field_info);
+    ~ColumnDistributionCollector();
+
+    // 'cell' points to the null byte of the value, as from Field::get_field_ptr()
+    void add(char* cell);
+
+    void finish(ColumnDistribution* distribution);
+
+private:
+    void _fold_hashes();
+
+    const FieldInfo& _field_info;
+    bool _is_string_type;
+    size_t _value_size;
+    int64_t _num_rows = 0;
+    int64_t _null_count = 0;
+    HllContext _hll;
+
+    // every _stride-th value, doubled when the sample is full
+    std::vector<std::unique_ptr<WrapperField>> _sample;
+    size_t _max_sample_size;
+    int64_t _stride = 1;
+};
+
+// Merges the distributions of a column over several segment groups.
+class ColumnDistributionMerger {
+public:
+    explicit ColumnDistributionMerger(const FieldInfo& field_info);
+    ~ColumnDistributionMerger();
+
+    void merge(const ColumnDistribution& distribution);
+
+    void finish(TColumnDistribution* distribution);
+
+private:
+    const FieldInfo& _field_info;
+    int64_t _num_rows = 0;
+    int64_t _null_count = 0;
+    HllContext _hll;
+    std::vector<std::pair<std::unique_ptr<WrapperField>, int64_t>> _buckets;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_COLUMN_DISTRIBUTION_H
@@ -18,6 +18,8 @@
 #ifndef DORIS_BE_SRC_OLAP_COLUMN_PREDICATE_H
 #define DORIS_BE_SRC_OLAP_COLUMN_PREDICATE_H
 
+#include <stdint.h>
+
 namespace doris {
 
 class VectorizedRowBatch;
@@ -28,6 +30,9 @@ public:
 
     //evaluate predicate on VectorizedRowBatch
     virtual void evaluate(VectorizedRowBatch* batch) const = 0;
+
+    // column id in tablet schema that this predicate is evaluated on
+    virtual int32_t column_id() const = 0;
 };
 
 } //namespace doris
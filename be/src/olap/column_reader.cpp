@@ -15,26 +15,31 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 
 #include "olap/bit_field_reader.h"
 #include "olap/column_reader.h"
 #include "olap/file_stream.h"
 #include "olap/olap_define.h"
+#include "util/defer_op.h"
 
 namespace doris {
 IntegerColumnReader::IntegerColumnReader(uint32_t column_unique_id): 
         _eof(false),
         _column_unique_id(column_unique_id),
-        _data_reader(NULL) {
+        _data_reader(NULL),
+        _bit_packed_reader(NULL) {
 }
 
 IntegerColumnReader::~IntegerColumnReader() {
     SAFE_DELETE(_data_reader);
+    SAFE_DELETE(_bit_packed_reader);
 }
 
 OLAPStatus IntegerColumnReader::init(
-        std::map<StreamName, ReadOnlyFileStream*>* streams, bool is_sign) {
+        std::map<StreamName, ReadOnlyFileStream*>* streams, bool is_sign, bool bit_packed) {
     if (NULL == streams) {
         OLAP_LOG_WARNING("input streams is NULL");
         return OLAP_ERR_INPUT_PARAMETER_ERROR;
@@ -50,6 +55,15 @@ OLAPStatus IntegerColumnReader::init(
         return OLAP_ERR_COLUMN_STREAM_NOT_EXIST;
     }
 
+    if (bit_packed) {
+        _bit_packed_reader = new(std::nothrow) BitPackedIntegerReader(data_stream);
+        if (NULL == _bit_packed_reader) {
+            OLAP_LOG_WARNING("fail to malloc BitPackedIntegerReader");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+        return OLAP_SUCCESS;
+    }
+
     _data_reader = new(std::nothrow) RunLengthIntegerReader(data_stream, is_sign);
 
     if (NULL == _data_reader) {
@@ -62,14 +76,23 @@ OLAPStatus IntegerColumnReader::init(
 }
 
 OLAPStatus IntegerColumnReader::seek(PositionProvider* position) {
+    if (_bit_packed_reader != NULL) {
+        return _bit_packed_reader->seek(position);
+    }
     return _data_reader->seek(position);
 }
 
 OLAPStatus IntegerColumnReader::skip(uint64_t row_count) {
+    if (_bit_packed_reader != NULL) {
+        return _bit_packed_reader->skip(row_count);
+    }
     return _data_reader->skip(row_count);
 }
 
 OLAPStatus IntegerColumnReader::next(int64_t* value) {
+    if (_bit_packed_reader != NULL) {
+        return _bit_packed_reader->next(value);
+    }
     return _data_reader->next(value);
 }
 
@@ -278,6 +301,8 @@ StringColumnDictionaryReader::StringColumnDictionaryReader(
         //_offset_dictionary(NULL),
         //_dictionary_data_buffer(NULL),
         _read_buffer(NULL),
+        _codes(NULL),
+        _dictionary_id(-1),
         _data_reader(NULL) {
 
 }
@@ -487,6 +512,17 @@ OLAPStatus StringColumnDictionaryReader::init(
         _dictionary.push_back(dictionary_item);
     }
 
+    static std::atomic<int64_t> s_next_dictionary_id(0);
+    _dictionary_id = s_next_dictionary_id.fetch_add(1);
+    _dictionary_slices.reserve(_dictionary.size());
+    for (auto& item : _dictionary) {
+        _dictionary_slices.emplace_back(item.data(), item.size());
+    }
+    _codes = reinterpret_cast<int32_t*>(mem_pool->allocate(size * sizeof(int32_t)));
+    _decoded.assign(_dictionary.size(), false);
+    _decoded_values.resize(_dictionary.size());
+    _distinct_codes.reserve(std::min<size_t>(size, _dictionary.size()));
+
     // 建立数据流读取器
     ReadOnlyFileStream* data_stream = extract_stream(_column_unique_id,
                                       StreamInfoMessage::DATA,
@@ -548,66 +584,62 @@ OLAPStatus StringColumnDictionaryReader::next_vector(
             MemPool* mem_pool,
             int64_t* read_bytes) {
 
-    int64_t index[size];
+    // the entries used by this batch, each one is copied once and all rows
+    // of its code point to the copy
+    _distinct_codes.clear();
+    // the flags of the entries must be cleared for the next batch however this
+    // one ends
+    DeferOp clear_decoded([this] {
+        for (int32_t code : _distinct_codes) {
+            _decoded[code] = false;
+        }
+    });
     int64_t buffer_size = 0;
     OLAPStatus res = OLAP_SUCCESS;
 
     column_vector->set_col_data(_values);
-    if (column_vector->no_nulls()) {
-        for (int i = 0; i < size; ++i) {
-            res = _data_reader->next(&index[i]);
-            if (OLAP_SUCCESS != res) {
-                return res;
-            }
-            if (index[i] >= static_cast<int64_t>(_dictionary.size())) {
-                OLAP_LOG_WARNING("value may indicated an invalid dictionary entry. "
-                                 "[index = %lu, dictionary_size = %lu]",
-                                 index[i], _dictionary.size());
-                return OLAP_ERR_BUFFER_OVERFLOW;
-            }
-            _values[i].size = _dictionary[index[i]].size();
-            buffer_size += _values[i].size;
+    bool* is_null = column_vector->no_nulls() ? nullptr : column_vector->is_null();
+    for (int i = 0; i < size; ++i) {
+        if (is_null != nullptr && is_null[i]) {
+            // keep codes of null rows valid, so they can be looked up without a branch
+            _codes[i] = 0;
+            continue;
         }
-
-        char* string_buffer = reinterpret_cast<char*>(mem_pool->allocate(buffer_size));
-        for (int i = 0; i < size; ++i) {
-            memory_copy(string_buffer,
-                        _dictionary[index[i]].c_str(),
-                        _values[i].size);
-            _values[i].data = string_buffer;
-            string_buffer += _values[i].size;
+        int64_t index = 0;
+        res = _data_reader->next(&index);
+        if (OLAP_SUCCESS != res) {
+            return res;
         }
-    } else {
-        bool* is_null = column_vector->is_null();
-        for (int i = 0; i < size; ++i) {
-            if (!is_null[i]) {
-                res = _data_reader->next(&index[i]);
-                if (OLAP_SUCCESS != res) {
-                    return res;
-                }
-                if (index[i] >= static_cast<int64_t>(_dictionary.size())) {
-                    OLAP_LOG_WARNING("value may indicated an invalid dictionary entry. "
-                                     "[index = %lu, dictionary_size = %lu]",
-                                     index[i], _dictionary.size());
-                    return OLAP_ERR_BUFFER_OVERFLOW;
-                }
-                _values[i].size = _dictionary[index[i]].size();
-                buffer_size += _values[i].size;
-            }
+        if (index < 0 || index >= static_cast<int64_t>(_dictionary.size())) {
+            OLAP_LOG_WARNING("value may indicated an invalid dictionary entry. "
+                             "[index = %ld, dictionary_size = %lu]",
+                             index, _dictionary.size());
+            return OLAP_ERR_BUFFER_OVERFLOW;
+        }
+        _codes[i] = index;
+        _values[i].size = _dictionary[index].size();
+        *read_bytes += _values[i].size;
+        if (!_decoded[index]) {
+            _decoded[index] = true;
+            _distinct_codes.push_back(index);
+            buffer_size += _values[i].size;
         }
+    }
 
-        char* string_buffer = reinterpret_cast<char*>(mem_pool->allocate(buffer_size));
-        for (int i = 0; i < size; ++i) {
-            if (!is_null[i]) {
-                memory_copy(string_buffer,
-                            _dictionary[index[i]].c_str(),
-                            _values[i].size);
-                _values[i].data = string_buffer;
-                string_buffer += _values[i].size;
-            }
+    char* string_buffer = reinterpret_cast<char*>(mem_pool->allocate(buffer_size));
+    for (int32_t code : _distinct_codes) {
+        const std::string& item = _dictionary[code];
+        memory_copy(string_buffer, item.c_str(), item.size());
+        _decoded_values[code] = string_buffer;
+        string_buffer += item.size();
+    }
+    for (int i = 0; i < size; ++i) {
+        if (is_null == nullptr || !is_null[i]) {
+            _values[i].data = _decoded_values[_codes[i]];
         }
     }
-    *read_bytes += buffer_size;
+    column_vector->set_dict(_codes, _dictionary_slices.data(),
+                            _dictionary_slices.size(), _dictionary_id);
 
     return res;
 }
@@ -664,6 +696,8 @@ ColumnReader* ColumnReader::create(uint32_t column_id,
         encode_kind = (*it).second.kind();
         dictionary_size = (*it).second.dictionary_size();
     }
+    bool bit_packed = ColumnEncodingMessage::BIT_PACKED == encode_kind;
+    bool use_xor = ColumnEncodingMessage::XOR == encode_kind;
 
     switch (field_info.type) {
     case OLAP_FIELD_TYPE_TINYINT:
@@ -674,52 +708,53 @@ ColumnReader* ColumnReader::create(uint32_t column_id,
 
     case OLAP_FIELD_TYPE_SMALLINT: {
         reader = new(std::nothrow) IntegerColumnReaderWrapper<int16_t, true>(
-                column_id, column_unique_id);
+                column_id, column_unique_id, bit_packed);
         break;
     }
 
     case OLAP_FIELD_TYPE_UNSIGNED_SMALLINT: {
         reader = new(std::nothrow) IntegerColumnReaderWrapper<uint16_t, false>(
-                column_id, column_unique_id);
+                column_id, column_unique_id, bit_packed);
         break;
     }
 
     case OLAP_FIELD_TYPE_INT: {
         reader = new(std::nothrow) IntegerColumnReaderWrapper<int32_t, true>(
-                column_id, column_unique_id);
+                column_id, column_unique_id, bit_packed);
         break;
     }
 
     case OLAP_FIELD_TYPE_UNSIGNED_INT: {
         reader = new(std::nothrow) IntegerColumnReaderWrapper<uint32_t, false>(
-                column_id, column_unique_id);
+                column_id, column_unique_id, bit_packed);
         break;
     }
 
     case OLAP_FIELD_TYPE_BIGINT: {
         reader = new(std::nothrow) IntegerColumnReaderWrapper<int64_t, true>(
-                column_id, column_unique_id);
+                column_id, column_unique_id, bit_packed);
         break;
     }
 
     case OLAP_FIELD_TYPE_UNSIGNED_BIGINT: {
         reader = new(std::nothrow) IntegerColumnReaderWrapper<uint64_t, false>(
-                column_id, column_unique_id);
+                column_id, column_unique_id, bit_packed);
         break;
     }
 
     case OLAP_FIELD_TYPE_FLOAT: {
-        reader = new(std::nothrow) FloatColumnReader(column_id, column_unique_id);
+        reader = new(std::nothrow) FloatColumnReader(column_id, column_unique_id, use_xor);
         break;
     }
 
     case OLAP_FIELD_TYPE_DOUBLE: {
-        reader = new(std::nothrow) DoubleColumnReader(column_id, column_unique_id);
+        reader = new(std::nothrow) DoubleColumnReader(column_id, column_unique_id, use_xor);
         break;
     }
 
     case OLAP_FIELD_TYPE_DISCRETE_DOUBLE: {
-        reader = new(std::nothrow) DiscreteDoubleColumnReader(column_id, column_unique_id);
+        reader = new(std::nothrow) DiscreteDoubleColumnReader(
+                column_id, column_unique_id, bit_packed);
         break;
     }
 
@@ -741,12 +776,12 @@ ColumnReader* ColumnReader::create(uint32_t column_id,
     }
 
     case OLAP_FIELD_TYPE_DATETIME: {
-        reader = new(std::nothrow) DateTimeColumnReader(column_id, column_unique_id);
+        reader = new(std::nothrow) DateTimeColumnReader(column_id, column_unique_id, bit_packed);
         break;
     }
 
     case OLAP_FIELD_TYPE_DATE: {
-        reader = new(std::nothrow) DateColumnReader(column_id, column_unique_id);
+        reader = new(std::nothrow) DateColumnReader(column_id, column_unique_id, bit_packed);
 
         break;
     }
@@ -18,6 +18,7 @@
 #ifndef DORIS_BE_SRC_OLAP_COLUMN_FILE_COLUMN_READER_H
 #define DORIS_BE_SRC_OLAP_COLUMN_FILE_COLUMN_READER_H
 
+#include "olap/bit_packed_integer_reader.h"
 #include "olap/byte_buffer.h"
 #include "olap/file_stream.h"
 #include "olap/run_length_byte_reader.h"
@@ -27,6 +28,7 @@
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/row_cursor.h"
+#include "olap/xor_float_reader.h"
 #include "runtime/vectorized_row_batch.h"
 #include "util/date_func.h"
 
@@ -80,13 +82,29 @@ public:
      * @return         [description]
      */
     OLAPStatus init(std::map<StreamName, ReadOnlyFileStream*>* streams,
-                    bool is_sign);
+                    bool is_sign, bool bit_packed = false);
     // 将内部指针定位到positions
     OLAPStatus seek(PositionProvider* positions);
     // 将内部指针向后移动row_count行
     OLAPStatus skip(uint64_t row_count);
     // 返回当前行的数据，通过将内部指针移向下一行
     OLAPStatus next(int64_t* value);
+    // 返回接下来count行的数据
+    template<class T>
+    OLAPStatus next_batch(T* values, uint32_t count) {
+        if (_bit_packed_reader != NULL) {
+            return _bit_packed_reader->next_batch(values, count);
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            int64_t value = 0;
+            OLAPStatus res = _data_reader->next(&value);
+            if (OLAP_SUCCESS != res) {
+                return res;
+            }
+            values[i] = value;
+        }
+        return OLAP_SUCCESS;
+    }
     bool eof() {
         return _eof;
     }
@@ -94,6 +112,8 @@ private:
     bool _eof;
     uint32_t _column_unique_id;
     RunLengthIntegerReader* _data_reader;
+    // not NULL if the column is BIT_PACKED encoded, _data_reader is NULL then
+    BitPackedIntegerReader* _bit_packed_reader;
 };
 
 // 对于使用Direct方式编码的字符串列的读取器
@@ -164,6 +184,16 @@ private:
     //uint64_t* _offset_dictionary;   // 用来查找响应数据的数字对应的offset
     //StorageByteBuffer* _dictionary_data_buffer;   // 保存dict数据
     std::vector<std::string> _dictionary;
+    // _dictionary as slices, and the code of every row of last next_vector,
+    // handed to ColumnVector for predicates evaluated on codes
+    std::vector<Slice> _dictionary_slices;
+    int32_t* _codes;
+    // entries already copied by the running next_vector, their copies, and
+    // the codes of the entries it copied
+    std::vector<bool> _decoded;
+    std::vector<char*> _decoded_values;
+    std::vector<int32_t> _distinct_codes;
+    int64_t _dictionary_id;
     RunLengthIntegerReader* _data_reader;   // 用来读实际的数据（用一个integer表示）
 };
 
@@ -466,10 +496,11 @@ private:
 template<class T, bool is_sign>
 class IntegerColumnReaderWrapper : public ColumnReader {
 public:
-    IntegerColumnReaderWrapper(uint32_t column_id, uint32_t column_unique_id) :
+    IntegerColumnReaderWrapper(uint32_t column_id, uint32_t column_unique_id,
+                               bool bit_packed = false) :
         ColumnReader(column_id, column_unique_id),
         _reader(column_unique_id), _values(NULL),
-        _eof(false) {
+        _eof(false), _bit_packed(bit_packed) {
     }
 
     virtual ~IntegerColumnReaderWrapper() {}
@@ -480,7 +511,7 @@ public:
         OLAPStatus res = ColumnReader::init(streams, size, mem_pool, stats);
 
         if (OLAP_SUCCESS == res) {
-            res = _reader.init(streams, is_sign);
+            res = _reader.init(streams, is_sign, _bit_packed);
         }
 
         _values = reinterpret_cast<T*>(mem_pool->allocate(size * sizeof(T)));
@@ -527,14 +558,7 @@ public:
 
         column_vector->set_col_data(_values);
         if (column_vector->no_nulls()) {
-            for (uint32_t i = 0; i < size; ++i) {
-                int64_t value = 0;
-                res = _reader.next(&value);
-                if (OLAP_SUCCESS != res) {
-                    break;
-                }
-                _values[i] = value;
-            }
+            res = _reader.next_batch(_values, size);
         } else {
             bool* is_null = column_vector->is_null();
             for (uint32_t i = 0; i < size; ++i) {
@@ -557,13 +581,14 @@ public:
     }
 
     virtual size_t get_buffer_size() {
-        return sizeof(RunLengthIntegerReader);
+        return _bit_packed ? sizeof(BitPackedIntegerReader) : sizeof(RunLengthIntegerReader);
     }
 
 private:
     IntegerColumnReader _reader;  // 被包裹的真实读取器
     T* _values;
     bool _eof;
+    bool _bit_packed;
 };
 
 // OLAP Engine中有两类字符串，定长字符串和变长字符串，分别使用两个Wrapper
@@ -728,13 +753,18 @@ private:
 template <typename FLOAT_TYPE>
 class FloatintPointColumnReader : public ColumnReader {
 public:
-    FloatintPointColumnReader(uint32_t column_id, uint32_t column_unique_id) :
+    FloatintPointColumnReader(uint32_t column_id, uint32_t column_unique_id,
+                              bool use_xor = false) :
             ColumnReader(column_id, column_unique_id),
             _eof(false),
+            _use_xor(use_xor),
             _data_stream(NULL),
+            _xor_reader(NULL),
             _values(NULL) {}
 
-    virtual ~FloatintPointColumnReader() {}
+    virtual ~FloatintPointColumnReader() {
+        SAFE_DELETE(_xor_reader);
+    }
 
     virtual OLAPStatus init(std::map<StreamName, ReadOnlyFileStream*>* streams,
                             int size, MemPool* mem_pool,
@@ -755,6 +785,15 @@ public:
             return OLAP_ERR_COLUMN_STREAM_NOT_EXIST;
         }
 
+        if (_use_xor) {
+            SAFE_DELETE(_xor_reader);
+            _xor_reader = new(std::nothrow) XorFloatReader(_data_stream);
+            if (NULL == _xor_reader) {
+                OLAP_LOG_WARNING("fail to malloc XorFloatReader");
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+        }
+
         _values = reinterpret_cast<FLOAT_TYPE*>(mem_pool->allocate(size * sizeof(FLOAT_TYPE)));
 
         return OLAP_SUCCESS;
@@ -772,7 +811,7 @@ public:
 
         OLAPStatus res;
         if (NULL == _present_reader) {
-            res = _data_stream->seek(position);
+            res = _seek_data(position);
             if (OLAP_SUCCESS != res) {
                 return res;
             }
@@ -782,7 +821,7 @@ public:
             if (OLAP_SUCCESS != res) {
                 return res;
             }
-            res = _data_stream->seek(position);
+            res = _seek_data(position);
             if (OLAP_SUCCESS != res && OLAP_ERR_COLUMN_STREAM_EOF != res) {
                 OLAP_LOG_WARNING("fail to seek float stream. [res=%d]", res);
                 return res;
@@ -798,6 +837,9 @@ public:
         }
 
         uint64_t skip_values_count = _count_none_nulls(row_count);
+        if (_xor_reader != NULL) {
+            return _xor_reader->skip(skip_values_count);
+        }
         return _data_stream->skip(skip_values_count * sizeof(FLOAT_TYPE));
     }
 
@@ -820,16 +862,39 @@ public:
         }
 
         bool* is_null = column_vector->is_null();
+        // releases the chunk referenced by the last batch, so the stream
+        // need not replace it before reading the next chunk
         column_vector->set_col_data(_values);
         size_t length = sizeof(FLOAT_TYPE);
-        if (column_vector->no_nulls()) {
-            for (uint32_t i = 0; i < size; ++i) {
-                FLOAT_TYPE value = 0.0;
-                res = _data_stream->read(reinterpret_cast<char*>(&value), &length);
-                if (OLAP_SUCCESS != res) {
-                    break;
+        if (_xor_reader != NULL) {
+            if (column_vector->no_nulls()) {
+                res = _xor_reader->next_batch(_values, size);
+            } else {
+                for (uint32_t i = 0; i < size; ++i) {
+                    _values[i] = 0.0;
+                    if (!is_null[i]) {
+                        res = _xor_reader->next(&_values[i]);
+                        if (OLAP_SUCCESS != res) {
+                            break;
+                        }
+                    }
                 }
-                _values[i] = value;
+            }
+        } else if (column_vector->no_nulls()) {
+            // values are stored plainly, the batch refers to the decompressed
+            // chunk directly unless it spans chunks
+            uint64_t batch_length = sizeof(FLOAT_TYPE) * size;
+            StorageByteBuffer* buffer = NULL;
+            res = _data_stream->read_reference(batch_length, &buffer);
+            if (buffer != NULL) {
+                if (reinterpret_cast<uintptr_t>(buffer->array()) % alignof(FLOAT_TYPE) == 0) {
+                    column_vector->set_col_data(buffer->array(), buffer);
+                } else {
+                    memcpy(_values, buffer->array(), batch_length);
+                    delete buffer;
+                }
+            } else if (OLAP_SUCCESS == res) {
+                res = _data_stream->read(reinterpret_cast<char*>(_values), &batch_length);
             }
         } else {
             for (uint32_t i = 0; i < size; ++i) {
@@ -853,8 +918,17 @@ public:
     }
 
 protected:
+    OLAPStatus _seek_data(PositionProvider* position) {
+        if (_xor_reader != NULL) {
+            return _xor_reader->seek(position);
+        }
+        return _data_stream->seek(position);
+    }
+
     bool _eof;
+    bool _use_xor;
     ReadOnlyFileStream* _data_stream;
+    XorFloatReader* _xor_reader;
     FLOAT_TYPE* _values;
 };
 
@@ -163,12 +163,19 @@ ColumnWriter::ColumnWriter(
         _index_stream(NULL),
         _is_found_nulls(false),
         _bf(NULL),
+        _bitmap_index(NULL),
+        _bitmap_index_stream(NULL),
+        _ngram_index(NULL),
+        _ngram_index_stream(NULL),
+        _num_rows(0),
         _num_rows_per_row_block(num_rows_per_row_block),
         _bf_fpp(bf_fpp) {}
 
 ColumnWriter::~ColumnWriter() {
     SAFE_DELETE(_is_present);
     SAFE_DELETE(_bf);
+    SAFE_DELETE(_bitmap_index);
+    SAFE_DELETE(_ngram_index);
 
     for (std::vector<ColumnWriter*>::iterator it = _sub_writers.begin();
             it != _sub_writers.end(); ++it) {
@@ -236,13 +243,49 @@ OLAPStatus ColumnWriter::init() {
             return OLAP_ERR_MALLOC_ERROR;
         }
 
-        if (!_bf->init(_num_rows_per_row_block, _bf_fpp)) {
+        if (!_bf->init(_num_rows_per_row_block, _bf_fpp, config::bloom_filter_blocked_layout)) {
             OLAP_LOG_WARNING("fail to init bloom filter. num rows: %u, fpp: %g", 
                              _num_rows_per_row_block, _bf_fpp);
             return OLAP_ERR_INIT_FAILED;
         }
     }
 
+    // bitmap index
+    if (_field_info.has_bitmap_index) {
+        _bitmap_index_stream = _stream_factory->create_stream(
+                unique_column_id(), StreamInfoMessage::BITMAP_INDEX);
+        if (NULL == _bitmap_index_stream) {
+            OLAP_LOG_WARNING("fail to allocate bitmap index stream");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+
+        _bitmap_index = new(std::nothrow) BitmapIndexWriter(
+                config::bitmap_index_max_values_per_segment);
+        if (NULL == _bitmap_index) {
+            OLAP_LOG_WARNING("fail to allocate bitmap index");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+    }
+
+    // ngram index, only strings are split into grams
+    if (_field_info.has_ngram_index
+            && (_field_info.type == OLAP_FIELD_TYPE_CHAR
+                || _field_info.type == OLAP_FIELD_TYPE_VARCHAR)) {
+        _ngram_index_stream = _stream_factory->create_stream(
+                unique_column_id(), StreamInfoMessage::NGRAM_INDEX);
+        if (NULL == _ngram_index_stream) {
+            OLAP_LOG_WARNING("fail to allocate ngram index stream");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+
+        _ngram_index = new(std::nothrow) NgramIndexWriter(
+                config::ngram_index_max_grams_per_segment);
+        if (NULL == _ngram_index) {
+            OLAP_LOG_WARNING("fail to allocate ngram index");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+    }
+
     return OLAP_SUCCESS;
 }
 
@@ -276,6 +319,25 @@ OLAPStatus ColumnWriter::write(RowCursor* row_cursor) {
         }
     }
 
+    if (has_bitmap_index()) {
+        if (is_null) {
+            _bitmap_index->add_null(_num_rows);
+        } else if (_field_info.type == OLAP_FIELD_TYPE_CHAR ||
+                   _field_info.type == OLAP_FIELD_TYPE_VARCHAR ||
+                   _field_info.type == OLAP_FIELD_TYPE_HLL) {
+            Slice* slice = reinterpret_cast<Slice*>(buf);
+            _bitmap_index->add(slice->data, slice->size, _num_rows);
+        } else {
+            _bitmap_index->add(buf, field->size(), _num_rows);
+        }
+    }
+
+    if (has_ngram_index() && !is_null) {
+        Slice* slice = reinterpret_cast<Slice*>(buf);
+        _ngram_index->add(slice->data, slice->size, _num_rows);
+    }
+    ++_num_rows;
+
     return res;
 }
 
@@ -301,7 +363,7 @@ OLAPStatus ColumnWriter::create_row_index_entry() {
             return OLAP_ERR_MALLOC_ERROR;
         }
 
-        if (!_bf->init(_num_rows_per_row_block, _bf_fpp)) {
+        if (!_bf->init(_num_rows_per_row_block, _bf_fpp, config::bloom_filter_blocked_layout)) {
             OLAP_LOG_WARNING("fail to init bloom filter. num rows: %u, fpp: %g", 
                              _num_rows_per_row_block, _bf_fpp);
             return OLAP_ERR_INIT_FAILED;
@@ -327,6 +389,14 @@ uint64_t ColumnWriter::estimate_buffered_memory() {
         result += _bf_index.estimate_buffered_memory();
     }
 
+    if (has_bitmap_index()) {
+        result += _bitmap_index->estimate_buffered_memory();
+    }
+
+    if (has_ngram_index()) {
+        result += _ngram_index->estimate_buffered_memory();
+    }
+
     for (std::vector<ColumnWriter*>::iterator it = _sub_writers.begin();
             it != _sub_writers.end(); ++it) {
         result += (*it)->estimate_buffered_memory();
@@ -403,6 +473,44 @@ OLAPStatus ColumnWriter::finalize(ColumnDataHeaderMessage* header) {
         }
     }
 
+    // write bitmap index, columns with too many values have none in this segment
+    if (has_bitmap_index()) {
+        if (_bitmap_index->is_valid()) {
+            res = _bitmap_index->write_to_buffer(_bitmap_index_stream);
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to write bitmap index stream");
+                OLAP_GOTO(FINALIZE_EXIT);
+            }
+
+            res = _bitmap_index_stream->flush();
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to flush bitmap index stream");
+                OLAP_GOTO(FINALIZE_EXIT);
+            }
+        } else {
+            _bitmap_index_stream->suppress();
+        }
+    }
+
+    // write ngram index, columns with too many grams have none in this segment
+    if (has_ngram_index()) {
+        if (_ngram_index->is_valid()) {
+            res = _ngram_index->write_to_buffer(_ngram_index_stream);
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to write ngram index stream");
+                OLAP_GOTO(FINALIZE_EXIT);
+            }
+
+            res = _ngram_index_stream->flush();
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to flush ngram index stream");
+                OLAP_GOTO(FINALIZE_EXIT);
+            }
+        } else {
+            _ngram_index_stream->suppress();
+        }
+    }
+
     // 在Segment头中记录一份Schema信息
     // 这样使得修改表的Schema后不影响对已存在的Segment中的数据读取
     column = header->add_column();
@@ -416,6 +524,8 @@ OLAPStatus ColumnWriter::finalize(ColumnDataHeaderMessage* header) {
     column->set_frac(_field_info.frac);
     column->set_unique_id(_field_info.unique_id);
     column->set_is_bf_column(is_bf_column());
+    column->set_has_bitmap_index(has_bitmap_index() && _bitmap_index->is_valid());
+    column->set_has_ngram_index(has_ngram_index() && _ngram_index->is_valid());
 
     save_encoding(header->add_column_encoding());
     //segment_statistics()->save(header->add_column_statistics());
@@ -522,26 +632,107 @@ IntegerColumnWriter::IntegerColumnWriter(
         uint32_t column_id,
         uint32_t unique_column_id,
         OutStreamFactory* stream_factory,
-        bool is_singed) : 
+        bool is_singed,
+        bool bit_packed,
+        bool adaptive) : 
         _column_id(column_id),
         _unique_column_id(unique_column_id),
         _stream_factory(stream_factory),
+        _stream(NULL),
         _writer(NULL),
-        _is_signed(is_singed) {}
+        _bit_packed_writer(NULL),
+        _is_signed(is_singed),
+        _bit_packed(bit_packed),
+        _adaptive(adaptive),
+        _sample_bits_per_value(0),
+        _sample_decode_ns_per_value(0) {}
 
 IntegerColumnWriter::~IntegerColumnWriter() {
     SAFE_DELETE(_writer);
+    SAFE_DELETE(_bit_packed_writer);
 }
 
 OLAPStatus IntegerColumnWriter::init() {
-    OutStream* stream = _stream_factory->create_stream(
+    _stream = _stream_factory->create_stream(
             _unique_column_id, StreamInfoMessage::DATA);
 
-    if (NULL == stream) {
+    if (NULL == _stream) {
         OLAP_LOG_WARNING("fail to allocate DATA STERAM");
         return OLAP_ERR_MALLOC_ERROR;
     }
 
+    if (_adaptive) {
+        // the writer is created by choose_encoding
+        return OLAP_SUCCESS;
+    }
+    return _create_writer();
+}
+
+// Estimated cost of scanning encoded integers, in nanoseconds: every byte is
+// read and decompressed, and every value decoded. Bit packed mini blocks are
+// unpacked a block at a time with simd kernels, run length runs are decoded
+// value by value.
+static const double SCAN_NS_PER_BYTE = 0.5;
+static const double RLE_DECODE_NS_PER_VALUE = 2.5;
+static const double BIT_PACKED_DECODE_NS_PER_VALUE = 0.8;
+
+template<class Writer>
+static OLAPStatus encoded_size(Writer* writer, OutStream* stream,
+                               const int64_t* values, size_t count, uint64_t* size) {
+    for (size_t i = 0; i < count; ++i) {
+        RETURN_NOT_OK(writer->write(values[i]));
+    }
+    RETURN_NOT_OK(writer->flush());
+    *size = stream->get_stream_length();
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus IntegerColumnWriter::choose_encoding(const int64_t* values, size_t count) {
+    if (encoding_chosen()) {
+        return OLAP_SUCCESS;
+    }
+
+    _bit_packed = false;
+    if (count > 0) {
+        // encode the sample with each candidate into scratch streams
+        uint64_t rle_size = 0;
+        uint64_t bit_packed_size = 0;
+        {
+            OutStream stream(OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE, NULL);
+            RunLengthIntegerWriter writer(&stream, _is_signed);
+            RETURN_NOT_OK(encoded_size(&writer, &stream, values, count, &rle_size));
+        }
+        {
+            OutStream stream(OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE, NULL);
+            BitPackedIntegerWriter writer(&stream);
+            RETURN_NOT_OK(encoded_size(&writer, &stream, values, count, &bit_packed_size));
+        }
+
+        double rle_cost = rle_size * SCAN_NS_PER_BYTE + count * RLE_DECODE_NS_PER_VALUE;
+        double bit_packed_cost = bit_packed_size * SCAN_NS_PER_BYTE
+                + count * BIT_PACKED_DECODE_NS_PER_VALUE;
+        _bit_packed = bit_packed_cost < rle_cost;
+        _sample_bits_per_value = (_bit_packed ? bit_packed_size : rle_size) * 8.0 / count;
+        _sample_decode_ns_per_value = (_bit_packed ? bit_packed_cost : rle_cost) / count;
+        VLOG(3) << "choose integer encoding. column_id=" << _column_id
+                << ", sample_rows=" << count
+                << ", rle_size=" << rle_size << ", bit_packed_size=" << bit_packed_size
+                << ", bit_packed=" << _bit_packed;
+    }
+    return _create_writer();
+}
+
+OLAPStatus IntegerColumnWriter::_create_writer() {
+    OutStream* stream = _stream;
+    if (_bit_packed) {
+        _bit_packed_writer = new(std::nothrow) BitPackedIntegerWriter(stream);
+        if (NULL == _bit_packed_writer) {
+            OLAP_LOG_WARNING("fail to allocate BitPackedIntegerWriter");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+        return OLAP_SUCCESS;
+    }
+
     _writer = new(std::nothrow) RunLengthIntegerWriter(stream, _is_signed);
 
     if (NULL == _writer) {
@@ -581,9 +772,9 @@ OLAPStatus VarStringColumnWriter::init() {
     }
 
     _dict_stream = stream_factory()->create_stream(
-            unique_column_id(), StreamInfoMessage::DICTIONARY_DATA);
+            unique_column_id(), StreamInfoMessage::DICTIONARY_DATA, true);
     _data_stream = stream_factory()->create_stream(
-            unique_column_id(), StreamInfoMessage::DATA);
+            unique_column_id(), StreamInfoMessage::DATA, true);
     OutStream* length_stream = stream_factory()->create_stream(
             unique_column_id(), StreamInfoMessage::LENGTH);
 
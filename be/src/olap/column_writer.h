@@ -21,7 +21,12 @@
 #include <gen_cpp/column_data_file.pb.h>
 
 #include <map>
+#include <vector>
 
+#include "common/config.h"
+#include "olap/bit_packed_integer_writer.h"
+#include "olap/bitmap_index_writer.h"
+#include "olap/ngram_index_writer.h"
 #include "olap/bloom_filter.hpp"
 #include "olap/bloom_filter_writer.h"
 #include "olap/out_stream.h"
@@ -33,6 +38,7 @@
 #include "olap/olap_define.h"
 #include "olap/row_block.h"
 #include "olap/row_cursor.h"
+#include "olap/xor_float_writer.h"
 
 namespace doris {
 
@@ -125,6 +131,14 @@ private:
         return _field_info.is_bf_column;
     }
 
+    bool has_bitmap_index() {
+        return _bitmap_index != NULL;
+    }
+
+    bool has_ngram_index() {
+        return _ngram_index != NULL;
+    }
+
     uint32_t _column_id;
     const FieldInfo& _field_info;
     OutStreamFactory* _stream_factory; // 该对象由外部调用者所有
@@ -138,6 +152,12 @@ private:
     BloomFilter* _bf;
     BloomFilterIndexWriter _bf_index;
     OutStream* _bf_index_stream;
+    BitmapIndexWriter* _bitmap_index;
+    OutStream* _bitmap_index_stream;
+    NgramIndexWriter* _ngram_index;
+    OutStream* _ngram_index_stream;
+    // rows written to this segment, the ordinal of the next row
+    uint32_t _num_rows;
     size_t _num_rows_per_row_block;
     double _bf_fpp;
 
@@ -196,28 +216,76 @@ public:
             uint32_t column_id,
             uint32_t unique_column_id,
             OutStreamFactory* stream_factory,
-            bool is_singed);
+            bool is_singed,
+            bool bit_packed = false,
+            bool adaptive = false);
     ~IntegerColumnWriter();
     OLAPStatus init();
+    // With adaptive, picks the encoding whose scan of 'values' is estimated
+    // to be the cheapest and creates its writer. Must be called before the
+    // first value is written, run length encoding is used if 'count' is 0.
+    OLAPStatus choose_encoding(const int64_t* values, size_t count);
+    bool encoding_chosen() const {
+        return _writer != NULL || _bit_packed_writer != NULL;
+    }
     OLAPStatus write(int64_t data) {
+        if (_bit_packed_writer != NULL) {
+            return _bit_packed_writer->write(data);
+        }
         return _writer->write(data);
     }
     OLAPStatus finalize(ColumnDataHeaderMessage* header) {
-        return _writer->flush();
+        return flush();
     }
     void record_position(PositionEntryWriter* index_entry) {
-        _writer->get_position(index_entry, false);
+        if (_bit_packed_writer != NULL) {
+            _bit_packed_writer->get_position(index_entry, false);
+        } else if (_writer != NULL) {
+            _writer->get_position(index_entry, false);
+        } else {
+            // nothing is written yet, the stream position and no buffered
+            // values, the same for all encodings
+            _stream->get_position(index_entry);
+            index_entry->add_position(0);
+        }
     }
     OLAPStatus flush() {
+        if (!encoding_chosen()) {
+            RETURN_NOT_OK(choose_encoding(NULL, 0));
+        }
+        if (_bit_packed_writer != NULL) {
+            return _bit_packed_writer->flush();
+        }
         return _writer->flush();
     }
+    bool bit_packed() const {
+        return _bit_packed;
+    }
+    bool adaptive() const {
+        return _adaptive;
+    }
+    // stats of the sample the adaptive encoding was chosen on
+    double sample_bits_per_value() const {
+        return _sample_bits_per_value;
+    }
+    double sample_decode_ns_per_value() const {
+        return _sample_decode_ns_per_value;
+    }
 
 private:
+    OLAPStatus _create_writer();
+
     uint32_t _column_id;
     uint32_t _unique_column_id;
     OutStreamFactory* _stream_factory;
+    OutStream* _stream;
     RunLengthIntegerWriter* _writer;
+    BitPackedIntegerWriter* _bit_packed_writer;
     bool _is_signed;
+    bool _bit_packed;
+    bool _adaptive;
+    double _sample_bits_per_value;
+    double _sample_decode_ns_per_value;
 
     DISALLOW_COPY_AND_ASSIGN(IntegerColumnWriter);
 };
@@ -232,7 +300,9 @@ public:
             size_t num_rows_per_row_block,
             double bf_fpp) : 
             ColumnWriter(column_id, stream_factory, field_info, num_rows_per_row_block, bf_fpp),
-            _writer(column_id, field_info.unique_id, stream_factory, is_singed) {}
+            _writer(column_id, field_info.unique_id, stream_factory, is_singed,
+                    config::enable_bit_packed_integer_encoding,
+                    config::enable_adaptive_integer_encoding) {}
 
     virtual ~IntegerColumnWriterWrapper() {}
 
@@ -270,6 +340,10 @@ public:
             _block_statistics.add(buf);
             if (!is_null) {
                 T value = *reinterpret_cast<T*>(buf + 1);
+                if (OLAP_UNLIKELY(!_writer.encoding_chosen())) {
+                    _sample.push_back(static_cast<int64_t>(value));
+                    continue;
+                }
                 res =  _writer.write(static_cast<int64_t>(value));
                 if (res != OLAP_SUCCESS) {
                     LOG(WARNING) << "fail to write integer, res=" << res;
@@ -277,6 +351,15 @@ public:
                 }
             }
         }
+        // the encoding is chosen on the values of the first block that has
+        // any, positions of the blocks before are at the start of the stream
+        if (!_sample.empty()) {
+            OLAPStatus res = _write_sample();
+            if (res != OLAP_SUCCESS) {
+                LOG(WARNING) << "fail to write integer sample, res=" << res;
+                return res;
+            }
+        }
         return OLAP_SUCCESS;
     }
 
@@ -313,8 +396,28 @@ public:
         ColumnWriter::record_position();
         _writer.record_position(index_entry());
     }
+
+    virtual void save_encoding(ColumnEncodingMessage* encoding) {
+        encoding->set_kind(_writer.bit_packed()
+                ? ColumnEncodingMessage::BIT_PACKED : ColumnEncodingMessage::DIRECT);
+        if (_writer.adaptive() && _writer.sample_bits_per_value() > 0) {
+            encoding->set_sample_bits_per_value(_writer.sample_bits_per_value());
+            encoding->set_sample_decode_ns_per_value(_writer.sample_decode_ns_per_value());
+        }
+    }
 private:
+    OLAPStatus _write_sample() {
+        RETURN_NOT_OK(_writer.choose_encoding(_sample.data(), _sample.size()));
+        for (int64_t value : _sample) {
+            RETURN_NOT_OK(_writer.write(value));
+        }
+        std::vector<int64_t>().swap(_sample);
+        return OLAP_SUCCESS;
+    }
+
     IntegerColumnWriter _writer;
+    // values of the first block, until the encoding is chosen
+    std::vector<int64_t> _sample;
 
     DISALLOW_COPY_AND_ASSIGN(IntegerColumnWriterWrapper);
 };
@@ -329,9 +432,12 @@ public:
             size_t num_rows_per_row_block,
             double bf_fpp) : 
             ColumnWriter(column_id, stream_factory, field_info, num_rows_per_row_block, bf_fpp),
-            _stream(NULL) {}
+            _stream(NULL),
+            _xor_writer(NULL) {}
 
-    virtual ~DoubleColumnWriterBase() {}
+    virtual ~DoubleColumnWriterBase() {
+        SAFE_DELETE(_xor_writer);
+    }
 
     virtual OLAPStatus init() {
         OLAPStatus res = OLAP_SUCCESS;
@@ -350,6 +456,14 @@ public:
             return OLAP_ERR_MALLOC_ERROR;
         }
 
+        if (config::enable_xor_float_encoding) {
+            _xor_writer = new(std::nothrow) XorFloatWriter(_stream);
+            if (NULL == _xor_writer) {
+                OLAP_LOG_WARNING("fail to allocate XorFloatWriter");
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+        }
+
         record_position();
         return OLAP_SUCCESS;
     }
@@ -374,7 +488,11 @@ public:
             _block_statistics.add(buf);
             if (!is_null) {
                 T* value = reinterpret_cast<T*>(buf + 1);
-                res = _stream->write(reinterpret_cast<char*>(value), sizeof(T));
+                if (_xor_writer != NULL) {
+                    res = _xor_writer->write(*value);
+                } else {
+                    res = _stream->write(reinterpret_cast<char*>(value), sizeof(T));
+                }
                 if (res != OLAP_SUCCESS) {
                     LOG(WARNING) << "fail to write double, res=" << res;
                     return res;
@@ -393,7 +511,7 @@ public:
             return res;
         }
 
-        res = _stream->flush();
+        res = _xor_writer != NULL ? _xor_writer->flush() : _stream->flush();
         if (OLAP_SUCCESS != res) {
             OLAP_LOG_WARNING("fail to flush. [res=%d]", res);
             return res;
@@ -404,11 +522,21 @@ public:
 
     virtual void record_position() {
         ColumnWriter::record_position();
-        _stream->get_position(index_entry());
+        if (_xor_writer != NULL) {
+            _xor_writer->get_position(index_entry(), false);
+        } else {
+            _stream->get_position(index_entry());
+        }
+    }
+
+    virtual void save_encoding(ColumnEncodingMessage* encoding) {
+        encoding->set_kind(_xor_writer != NULL
+                ? ColumnEncodingMessage::XOR : ColumnEncodingMessage::DIRECT);
     }
 
 private:
     OutStream* _stream;
+    XorFloatWriter* _xor_writer;
 
     DISALLOW_COPY_AND_ASSIGN(DoubleColumnWriterBase);
 };
@@ -0,0 +1,98 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/column_writer_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "common/config.h"
+
+namespace doris {
+
+namespace {
+
+// Tasks of one run, threads take the next task until none is left. Threads
+// getting to it after the run returned find no task, so the group is shared
+// with them while the tasks themselves may refer to the caller's stack.
+struct TaskGroup {
+    explicit TaskGroup(std::vector<ColumnWriterPool::Task> tasks_) :
+            tasks(std::move(tasks_)),
+            results(tasks.size(), OLAP_SUCCESS),
+            next(0),
+            finished(0) {}
+
+    void run_tasks() {
+        size_t i = 0;
+        while ((i = next.fetch_add(1)) < tasks.size()) {
+            results[i] = tasks[i]();
+            std::lock_guard<std::mutex> l(lock);
+            if (++finished == tasks.size()) {
+                cv.notify_all();
+            }
+        }
+    }
+
+    std::vector<ColumnWriterPool::Task> tasks;
+    std::vector<OLAPStatus> results;
+    std::atomic<size_t> next;
+
+    std::mutex lock;
+    std::condition_variable cv;
+    size_t finished;
+};
+
+}  // namespace
+
+ColumnWriterPool* ColumnWriterPool::instance() {
+    static ColumnWriterPool* pool = config::segment_writer_threads > 0
+            ? new ColumnWriterPool(config::segment_writer_threads) : NULL;
+    return pool;
+}
+
+ColumnWriterPool::ColumnWriterPool(uint32_t num_threads) :
+        _num_threads(num_threads),
+        _pool(num_threads, num_threads * 64) {}
+
+OLAPStatus ColumnWriterPool::run(std::vector<Task> tasks) {
+    if (tasks.empty()) {
+        return OLAP_SUCCESS;
+    }
+
+    std::shared_ptr<TaskGroup> group = std::make_shared<TaskGroup>(std::move(tasks));
+    size_t num_helpers = std::min<size_t>(_num_threads, group->tasks.size() - 1);
+    for (size_t i = 0; i < num_helpers; ++i) {
+        _pool.offer([group]() { group->run_tasks(); });
+    }
+    group->run_tasks();
+    {
+        std::unique_lock<std::mutex> l(group->lock);
+        group->cv.wait(l, [&group]() { return group->finished == group->tasks.size(); });
+    }
+
+    for (OLAPStatus res : group->results) {
+        if (res != OLAP_SUCCESS) {
+            return res;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+}  // namespace doris
@@ -0,0 +1,56 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_COLUMN_WRITER_POOL_H
+#define DORIS_BE_SRC_OLAP_COLUMN_WRITER_POOL_H
+
+#include <functional>
+#include <vector>
+
+#include "olap/olap_define.h"
+#include "util/thread_pool.hpp"
+
+namespace doris {
+
+// Threads shared by all segment writers to encode and compress their columns
+// in parallel. A column is always written by one task at a time, so its
+// streams come out the same as if all columns were written on one thread.
+class ColumnWriterPool {
+public:
+    typedef std::function<OLAPStatus()> Task;
+
+    // The process wide pool of config::segment_writer_threads threads,
+    // NULL if columns are written on the calling thread
+    static ColumnWriterPool* instance();
+
+    explicit ColumnWriterPool(uint32_t num_threads);
+
+    // Runs all tasks and waits for them. The calling thread runs tasks too, so
+    // it goes on even if all threads are busy with other writers.
+    // Returns the error of the first failed task in the order of 'tasks'.
+    OLAPStatus run(std::vector<Task> tasks);
+
+private:
+    const uint32_t _num_threads;
+    ThreadPool _pool;
+
+    DISALLOW_COPY_AND_ASSIGN(ColumnWriterPool);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_COLUMN_WRITER_POOL_H
@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/compaction_scheduler.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "olap/store.h"
+#include "util/doris_metrics.h"
+#include "util/time.h"
+
+namespace doris {
+
+// a waiting thread checks the queries and the budget at least this often
+static const int64_t MAX_WAIT_US = 1000000;
+
+bool CompactionScheduler::is_paused_for_queries() {
+    int64_t limit = config::compaction_pause_query_scan_mbytes_per_sec;
+    return limit > 0
+            && DorisMetrics::query_scan_bytes_per_second.value() > limit * 1024 * 1024;
+}
+
+CompactionScheduler::Budget* CompactionScheduler::_refill(OlapStore* store,
+                                                          int64_t bytes_per_second) {
+    Budget* budget = &_budgets[store->path_hash()];
+    int64_t now = MonotonicMicros();
+    // at most one second of budget is saved up by an idle store
+    if (budget->last_refill_us > 0) {
+        int64_t elapsed_us = std::min<int64_t>(now - budget->last_refill_us, 1000000);
+        budget->available_bytes += elapsed_us * bytes_per_second / 1000000;
+    }
+    budget->available_bytes = std::min(budget->available_bytes, bytes_per_second);
+    budget->last_refill_us = now;
+    return budget;
+}
+
+void CompactionScheduler::wait(OlapStore* store) {
+    while (true) {
+        int64_t wait_us = 0;
+        if (is_paused_for_queries()) {
+            wait_us = MAX_WAIT_US;
+        } else {
+            int64_t bytes_per_second =
+                    config::compaction_io_budget_mbytes_per_sec_per_disk * 1024 * 1024;
+            if (bytes_per_second <= 0) {
+                return;
+            }
+            std::lock_guard<std::mutex> l(_lock);
+            Budget* budget = _refill(store, bytes_per_second);
+            if (budget->available_bytes >= 0) {
+                return;
+            }
+            wait_us = std::min(-budget->available_bytes * 1000000 / bytes_per_second,
+                               MAX_WAIT_US);
+        }
+        usleep(std::max<int64_t>(wait_us, 1000));
+    }
+}
+
+void CompactionScheduler::consume(OlapStore* store, int64_t bytes) {
+    int64_t bytes_per_second = config::compaction_io_budget_mbytes_per_sec_per_disk * 1024 * 1024;
+    if (bytes_per_second <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> l(_lock);
+    Budget* budget = _refill(store, bytes_per_second);
+    budget->available_bytes -= bytes;
+}
+
+}  // namespace doris
@@ -0,0 +1,74 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_COMPACTION_SCHEDULER_H
+#define DORIS_BE_SRC_OLAP_COMPACTION_SCHEDULER_H
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+
+#include "olap/olap_define.h"
+
+namespace doris {
+
+class OlapStore;
+
+// Decides when the base and cumulative compaction threads of all stores may
+// start their next compaction.
+//
+// Every store has an I/O budget of compaction_io_budget_mbytes_per_sec_per_disk.
+// A finished compaction charges the bytes it read and wrote to the budget of
+// its store, and the next compaction of that store waits until the budget is
+// paid back, however many threads the store has. While queries scan more than
+// compaction_pause_query_scan_mbytes_per_sec all compactions wait.
+class CompactionScheduler {
+public:
+    CompactionScheduler() {}
+
+    // Blocks until a compaction may start on 'store'
+    void wait(OlapStore* store);
+
+    // Charges 'bytes' of a compaction to the budget of 'store'
+    void consume(OlapStore* store, int64_t bytes);
+
+    // true if compactions wait for the queries
+    static bool is_paused_for_queries();
+
+private:
+    struct Budget {
+        Budget() : available_bytes(0), last_refill_us(0) {}
+
+        // may be negative after a large compaction
+        int64_t available_bytes;
+        int64_t last_refill_us;
+    };
+
+    // _lock must be held
+    Budget* _refill(OlapStore* store, int64_t bytes_per_second);
+
+    std::mutex _lock;
+    // by path hash of the store
+    std::map<int64_t, Budget> _budgets;
+
+    DISALLOW_COPY_AND_ASSIGN(CompactionScheduler);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_COMPACTION_SCHEDULER_H
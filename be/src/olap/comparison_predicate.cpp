@@ -17,6 +17,7 @@
 
 #include "olap/comparison_predicate.h"
 #include "olap/field.h"
+#include "olap/simd_predicate.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
 
@@ -52,13 +53,21 @@ COMPARISON_PRED_CONSTRUCTOR_STRING(LessEqualPredicate)
 COMPARISON_PRED_CONSTRUCTOR_STRING(GreaterPredicate)
 COMPARISON_PRED_CONSTRUCTOR_STRING(GreaterEqualPredicate)
 
-#define COMPARISON_PRED_EVALUATE(CLASS, OP) \
+// String columns read from a dictionary are filtered by dictionary code.
+// Dense batches go through the SIMD kernels in simd_predicate.h when the
+// column type has one, sparse batches and the remaining types use the
+// scalar loops.
+#define COMPARISON_PRED_EVALUATE(CLASS, OP, SIMD_OP) \
     template<class type> \
     void CLASS<type>::evaluate(VectorizedRowBatch* batch) const { \
         uint16_t n = batch->size(); \
         if (n == 0) { \
             return; \
         } \
+        if (dict_evaluate((const type*)nullptr, batch, _column_id, &_dict_cache, \
+                [this](const type& v) { return v OP _value; })) { \
+            return; \
+        } \
         uint16_t* sel = batch->selected(); \
         const type* col_vector = reinterpret_cast<const type*>(batch->column(_column_id)->col_data()); \
         uint16_t new_size = 0; \
@@ -71,9 +80,12 @@ COMPARISON_PRED_CONSTRUCTOR_STRING(GreaterEqualPredicate)
                 } \
                 batch->set_size(new_size); \
             } else { \
-                for (uint16_t i = 0; i !=n; ++i) { \
-                    sel[new_size] = i; \
-                    new_size += (col_vector[i] OP _value); \
+                if (!simd_predicate::compare_and_select(simd_predicate::SIMD_OP, col_vector, \
+                        (const bool*)nullptr, n, _value, sel, &new_size)) { \
+                    for (uint16_t i = 0; i !=n; ++i) { \
+                        sel[new_size] = i; \
+                        new_size += (col_vector[i] OP _value); \
+                    } \
                 } \
                 if (new_size < n) { \
                     batch->set_size(new_size); \
@@ -90,9 +102,12 @@ COMPARISON_PRED_CONSTRUCTOR_STRING(GreaterEqualPredicate)
                 } \
                 batch->set_size(new_size); \
             } else { \
-                for (uint16_t i = 0; i !=n; ++i) { \
-                    sel[new_size] = i; \
-                    new_size += (!is_null[i] && (col_vector[i] OP _value)); \
+                if (!simd_predicate::compare_and_select(simd_predicate::SIMD_OP, col_vector, \
+                        (const bool*)is_null, n, _value, sel, &new_size)) { \
+                    for (uint16_t i = 0; i !=n; ++i) { \
+                        sel[new_size] = i; \
+                        new_size += (!is_null[i] && (col_vector[i] OP _value)); \
+                    } \
                 } \
                 if (new_size < n) { \
                     batch->set_size(new_size); \
@@ -103,12 +118,12 @@ COMPARISON_PRED_CONSTRUCTOR_STRING(GreaterEqualPredicate)
     } \
 
 
-COMPARISON_PRED_EVALUATE(EqualPredicate, ==)
-COMPARISON_PRED_EVALUATE(NotEqualPredicate, !=)
-COMPARISON_PRED_EVALUATE(LessPredicate, <)
-COMPARISON_PRED_EVALUATE(LessEqualPredicate, <=)
-COMPARISON_PRED_EVALUATE(GreaterPredicate, >)
-COMPARISON_PRED_EVALUATE(GreaterEqualPredicate, >=)
+COMPARISON_PRED_EVALUATE(EqualPredicate, ==, EQ)
+COMPARISON_PRED_EVALUATE(NotEqualPredicate, !=, NE)
+COMPARISON_PRED_EVALUATE(LessPredicate, <, LT)
+COMPARISON_PRED_EVALUATE(LessEqualPredicate, <=, LE)
+COMPARISON_PRED_EVALUATE(GreaterPredicate, >, GT)
+COMPARISON_PRED_EVALUATE(GreaterEqualPredicate, >=, GE)
 
 #define COMPARISON_PRED_CONSTRUCTOR_DECLARATION(CLASS) \
     template CLASS<int8_t>::CLASS(int column_id, const int8_t& value); \
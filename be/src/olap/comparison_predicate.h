@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 #include "olap/column_predicate.h"
+#include "olap/dict_predicate.h"
 
 namespace doris {
 
@@ -32,9 +33,11 @@ class VectorizedRowBatch;
         CLASS(int column_id, const type& value); \
         virtual ~CLASS() { }  \
         virtual void evaluate(VectorizedRowBatch* batch) const override; \
+        virtual int32_t column_id() const override { return _column_id; } \
     private: \
         int32_t _column_id; \
         type _value; \
+        mutable DictMatchCache _dict_cache; \
     }; \
 
 COMPARISON_PRED_CLASS_DEFINE(EqualPredicate)
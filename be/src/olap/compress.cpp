@@ -17,6 +17,10 @@
 
 #include "compress.h"
 
+#include <zdict.h>
+#include <zstd.h>
+#include <zstd_errors.h>
+
 #include "olap/byte_buffer.h"
 #include "olap/utils.h"
 
@@ -98,4 +102,148 @@ OLAPStatus lz4_decompress(StorageByteBuffer* in, StorageByteBuffer* out) {
     return res;
 }
 
+// zstd suggests about 100 times the dictionary size of samples
+static const uint64_t ZSTD_DICTIONARY_SAMPLE_FACTOR = 100;
+
+ZstdCompressor::ZstdCompressor(int32_t level, uint32_t dictionary_size) :
+        _level(level),
+        _dictionary_size(dictionary_size),
+        _ctx(NULL),
+        _cdict(NULL),
+        _training_done(dictionary_size == 0) {}
+
+ZstdCompressor::~ZstdCompressor() {
+    ZSTD_freeCDict(_cdict);
+    ZSTD_freeCCtx(_ctx);
+}
+
+OLAPStatus ZstdCompressor::compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller) {
+    return _compress(in, out, smaller, NULL);
+}
+
+OLAPStatus ZstdCompressor::compress_with_dictionary(
+        StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller) {
+    if (!_training_done) {
+        _samples.append(&(in->array()[in->position()]), in->remaining());
+        _sample_sizes.push_back(in->remaining());
+        if (_samples.size() >= _dictionary_size * ZSTD_DICTIONARY_SAMPLE_FACTOR) {
+            _train_dictionary();
+        }
+    }
+    return _compress(in, out, smaller, _cdict);
+}
+
+OLAPStatus ZstdCompressor::_compress(StorageByteBuffer* in, StorageByteBuffer* out,
+                                     bool* smaller, const ZSTD_CDict* cdict) {
+    *smaller = false;
+    if (NULL == _ctx) {
+        _ctx = ZSTD_createCCtx();
+        if (NULL == _ctx) {
+            OLAP_LOG_WARNING("fail to create zstd compress context.");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+    }
+
+    const char* src = &(in->array()[in->position()]);
+    char* dst = &(out->array()[out->position()]);
+    size_t out_length = 0;
+    if (NULL != cdict) {
+        out_length = ZSTD_compress_usingCDict(
+                _ctx, dst, out->remaining(), src, in->remaining(), cdict);
+    } else {
+        out_length = ZSTD_compressCCtx(
+                _ctx, dst, out->remaining(), src, in->remaining(), _level);
+    }
+
+    if (ZSTD_isError(out_length)) {
+        // the output is larger than the input, which is then stored uncompressed
+        if (ZSTD_getErrorCode(out_length) == ZSTD_error_dstSize_tooSmall) {
+            return OLAP_SUCCESS;
+        }
+        LOG(WARNING) << "fail to compress with zstd. error=" << ZSTD_getErrorName(out_length);
+        return OLAP_ERR_COMPRESS_ERROR;
+    }
+
+    if (out_length < in->remaining()) {
+        *smaller = true;
+        out->set_position(out->position() + out_length);
+    }
+    return OLAP_SUCCESS;
+}
+
+void ZstdCompressor::_train_dictionary() {
+    _training_done = true;
+
+    std::string dictionary(_dictionary_size, '\0');
+    size_t dictionary_length = ZDICT_trainFromBuffer(&dictionary[0], dictionary.size(),
+            _samples.data(), _sample_sizes.data(), _sample_sizes.size());
+    if (ZDICT_isError(dictionary_length)) {
+        // too few or too similar samples, the streams go on without dictionary
+        VLOG(3) << "fail to train zstd dictionary. samples=" << _sample_sizes.size()
+                << ", error=" << ZDICT_getErrorName(dictionary_length);
+    } else {
+        dictionary.resize(dictionary_length);
+        _cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), _level);
+        if (NULL != _cdict) {
+            _dictionary.swap(dictionary);
+        }
+    }
+
+    std::string().swap(_samples);
+    std::vector<size_t>().swap(_sample_sizes);
+}
+
+ZstdDecompressor::ZstdDecompressor() :
+        _ctx(NULL),
+        _ddict(NULL),
+        _dictionary_id(0) {}
+
+ZstdDecompressor::~ZstdDecompressor() {
+    ZSTD_freeDDict(_ddict);
+    ZSTD_freeDCtx(_ctx);
+}
+
+OLAPStatus ZstdDecompressor::init(const std::string& dictionary) {
+    _ctx = ZSTD_createDCtx();
+    if (NULL == _ctx) {
+        OLAP_LOG_WARNING("fail to create zstd decompress context.");
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+
+    if (!dictionary.empty()) {
+        _ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+        if (NULL == _ddict) {
+            OLAP_LOG_WARNING("fail to create zstd dictionary.");
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+        _dictionary_id = ZSTD_getDictID_fromDDict(_ddict);
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus ZstdDecompressor::decompress(StorageByteBuffer* in, StorageByteBuffer* out) {
+    const char* src = &(in->array()[in->position()]);
+    char* dst = &(out->array()[out->position()]);
+    size_t out_length = 0;
+
+    uint32_t dictionary_id = ZSTD_getDictID_fromFrame(src, in->remaining());
+    if (0 == dictionary_id) {
+        out_length = ZSTD_decompressDCtx(_ctx, dst, out->remaining(), src, in->remaining());
+    } else if (dictionary_id == _dictionary_id) {
+        out_length = ZSTD_decompress_usingDDict(
+                _ctx, dst, out->remaining(), src, in->remaining(), _ddict);
+    } else {
+        LOG(WARNING) << "unknown zstd dictionary. dictionary_id=" << dictionary_id
+                     << ", segment_dictionary_id=" << _dictionary_id;
+        return OLAP_ERR_DECOMPRESS_ERROR;
+    }
+
+    if (ZSTD_isError(out_length)) {
+        LOG(WARNING) << "fail to decompress with zstd. error=" << ZSTD_getErrorName(out_length);
+        return OLAP_ERR_DECOMPRESS_ERROR;
+    }
+    out->set_limit(out_length);
+    return OLAP_SUCCESS;
+}
+
 }  // namespace doris
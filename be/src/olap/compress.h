@@ -18,8 +18,17 @@
 #ifndef DORIS_BE_SRC_OLAP_COLUMN_FILE_COMPRESS_H
 #define DORIS_BE_SRC_OLAP_COLUMN_FILE_COMPRESS_H
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "olap/olap_define.h"
 
+struct ZSTD_CCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_DDict_s;
+
 namespace doris {
 
 class StorageByteBuffer;
@@ -32,7 +41,8 @@ class StorageByteBuffer;
 // Returns:
 //     OLAP_ERR_BUFFER_OVERFLOW - out中的剩余空间不足
 //     OLAP_ERR_COMPRESS_ERROR - 压缩错误
-typedef OLAPStatus(*Compressor)(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller);
+typedef std::function<OLAPStatus(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller)>
+    Compressor;
 
 // 定义解压缩函数,将in中剩余的内存解压缩,并保存到out中剩余的空间
 // Inputs:
@@ -41,7 +51,7 @@ typedef OLAPStatus(*Compressor)(StorageByteBuffer* in, StorageByteBuffer* out, b
 // Returns:
 //     OLAP_ERR_BUFFER_OVERFLOW - out中的剩余空间不足
 //     OLAP_ERR_DECOMPRESS_ERROR - 解压缩错误
-typedef OLAPStatus(*Decompressor)(StorageByteBuffer* in, StorageByteBuffer* out);
+typedef std::function<OLAPStatus(StorageByteBuffer* in, StorageByteBuffer* out)> Decompressor;
 
 OLAPStatus lzo_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller);
 OLAPStatus lzo_decompress(StorageByteBuffer* in, StorageByteBuffer* out);
@@ -49,5 +59,66 @@ OLAPStatus lzo_decompress(StorageByteBuffer* in, StorageByteBuffer* out);
 OLAPStatus lz4_compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller);
 OLAPStatus lz4_decompress(StorageByteBuffer* in, StorageByteBuffer* out);
 
+// Compresses the streams of one segment into zstd frames. Streams created
+// with a dictionary first feed their chunks to the dictionary trainer; once
+// enough samples are collected a dictionary is trained and used for all
+// later chunks of those streams. It is then saved in the segment header, so
+// the stream chunks, which are only a few KB, share the context of the
+// whole segment. Not thread safe, a segment is written by one thread.
+class ZstdCompressor {
+public:
+    // level - zstd compression level, 0 means zstd's default
+    // dictionary_size - size of the trained dictionary, 0 disables training
+    ZstdCompressor(int32_t level, uint32_t dictionary_size);
+    ~ZstdCompressor();
+
+    OLAPStatus compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller);
+    OLAPStatus compress_with_dictionary(
+            StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller);
+
+    // the trained dictionary, empty if none was trained
+    const std::string& dictionary() const {
+        return _dictionary;
+    }
+
+private:
+    OLAPStatus _compress(StorageByteBuffer* in, StorageByteBuffer* out, bool* smaller,
+                         const ZSTD_CDict_s* cdict);
+    void _train_dictionary();
+
+    int32_t _level;
+    uint32_t _dictionary_size;
+    ZSTD_CCtx_s* _ctx;
+    ZSTD_CDict_s* _cdict;
+    std::string _dictionary;
+    // chunks collected for training, cleared once training was tried
+    std::string _samples;
+    std::vector<size_t> _sample_sizes;
+    bool _training_done;
+
+    DISALLOW_COPY_AND_ASSIGN(ZstdCompressor);
+};
+
+// Decompresses zstd frames of a segment. Frames compressed with the
+// dictionary of the segment are recognized by the dictionary id in their
+// frame header. Not thread safe, like the segment reader owning it.
+class ZstdDecompressor {
+public:
+    ZstdDecompressor();
+    ~ZstdDecompressor();
+
+    // dictionary - the dictionary saved in the segment header, may be empty
+    OLAPStatus init(const std::string& dictionary);
+
+    OLAPStatus decompress(StorageByteBuffer* in, StorageByteBuffer* out);
+
+private:
+    ZSTD_DCtx_s* _ctx;
+    ZSTD_DDict_s* _ddict;
+    uint32_t _dictionary_id;
+
+    DISALLOW_COPY_AND_ASSIGN(ZstdDecompressor);
+};
+
 }  // namespace doris
 #endif // DORIS_BE_SRC_OLAP_COLUMN_FILE_COMPRESS_H
@@ -21,6 +21,7 @@
 #include <list>
 #include <vector>
 
+#include "olap/cumulative_compaction_policy.h"
 #include "olap/olap_engine.h"
 #include "util/doris_metrics.h"
 
@@ -47,6 +48,12 @@ OLAPStatus CumulativeCompaction::init(OLAPTablePtr table) {
 
     _table = table;
     _max_delta_file_size = config::cumulative_compaction_budgeted_bytes;
+    _policy.reset(CumulativeCompactionPolicy::create(config::cumulative_compaction_policy));
+    if (_policy == nullptr) {
+        LOG(WARNING) << "unknown cumulative compaction policy, use budgeted. policy="
+                     << config::cumulative_compaction_policy;
+        _policy.reset(new BudgetedCumulativeCompactionPolicy(_max_delta_file_size));
+    }
 
     if (!_table->try_cumulative_lock()) {
         OLAP_LOG_WARNING("another cumulative is running. [table=%s]",
@@ -130,6 +137,7 @@ OLAPStatus CumulativeCompaction::run() {
             merge_bytes += i_data->segment_group()->data_size();
         }
         DorisMetrics::cumulative_compaction_bytes_total.increment(merge_bytes);
+        _merged_bytes = merge_bytes;
     }
 
     do {
@@ -186,100 +194,19 @@ OLAPStatus CumulativeCompaction::_calculate_need_merged_versions() {
         return res;
     }
 
-    // 此处减1，是为了确保最新版本的delta不会合入到cumulative里
-    // 因为push可能会重复导入最新版本的delta
-    uint32_t delta_number = delta_versions.size() - 1;
-    uint32_t index = 0;
-    // 在delta文件中寻找可合并的delta文件
-    // 这些delta文件可能被delete或较大的delta文件(>= max_delta_file_size)分割为多个区间, 比如：
-    // v1, v2, v3, D, v4, v5, D, v6, v7
-    // 我们分区间进行查找直至找到合适的可合并delta文件
-    while (index < delta_number) {
-        Versions need_merged_versions;
-        size_t total_size = 0;
-
-        // 在其中1个区间里查找可以合并的delta文件
-        for (; index < delta_number; ++index) {
-            // 如果已找到的可合并delta文件大小大于等于_max_delta_file_size，我们认为可以执行合并了
-            // 停止查找过程
-            if (total_size >= _max_delta_file_size) {
-                break;
-            }
-
-            Version delta = delta_versions[index];
-            size_t delta_size = _table->get_version_data_size(delta);
-            // 如果遇到大的delta文件，或delete版本文件，则：
-            if (delta_size >= _max_delta_file_size
-                    || _table->is_delete_data_version(delta)
-                    || _table->is_load_delete_version(delta)) {
-                // 1) 如果need_merged_versions为空，表示这2类文件在区间的开头，直接跳过
-                if (need_merged_versions.empty()) {
-                    continue;
-                } else {
-                    // 2) 如果need_merged_versions不为空，则已经找到区间的末尾，跳出循环
-                    break;
-                }
-            }
-
-            need_merged_versions.push_back(delta);
-            total_size += delta_size;
-        }
-
-        // 该区间没有可以合并的delta文件，进行下一轮循环，继续查找下一个区间
-        if (need_merged_versions.empty()) {
-            continue;
-        }
-
-        // 如果该区间中只有一个delta，或者该区间的delta都是空的delta，则我们查看能否与区间末尾的
-        // 大delta合并，或者与区间的开头的前一个版本合并
-        if (need_merged_versions.size() == 1 || total_size == 0) {
-            // 如果区间末尾是较大的delta版, 则与它合并
-            if (index < delta_number
-                    && _table->get_version_data_size(delta_versions[index]) >=
-                           _max_delta_file_size) {
-                need_merged_versions.push_back(delta_versions[index]);
-                ++index;
-            }
-            // 如果区间前一个版本可以合并, 则将其加入到可合并版本中
-            Version delta_before_interval;
-            if (_find_previous_version(need_merged_versions[0], &delta_before_interval)) {
-                need_merged_versions.insert(need_merged_versions.begin(),
-                                            delta_before_interval); 
-            }
-
-            // 如果还是只有1个待合并的delta，则跳过，不进行合并
-            if (need_merged_versions.size() == 1) {
-                continue;
-            }
-
-            _need_merged_versions.swap(need_merged_versions);
-            _new_cumulative_layer_point = delta_versions[index].first;
-            return OLAP_SUCCESS;
-        }
-
-        // 如果有多个可合并文件，则可以进行cumulative compaction的合并过程
-        // 如果只有只有一个可合并的文件，为了效率，不触发cumulative compaction的合并过程
-        if (need_merged_versions.size() != 1) {
-            // 如果在可合并区间开头之前的一个版本的大小没有达到delta文件的最大值，
-            // 则将可合并区间的文件合并到之前那个版本上
-            Version delta;
-            if (_find_previous_version(need_merged_versions[0], &delta)) {
-                need_merged_versions.insert(need_merged_versions.begin(), delta); 
-            }
-
-            _need_merged_versions.swap(need_merged_versions);
-            _new_cumulative_layer_point = delta_versions[index].first;
-            return OLAP_SUCCESS;
-        }
+    res = _policy->pick_versions(_table.get(), delta_versions, &_need_merged_versions,
+                                 &_new_cumulative_layer_point);
+    if (res == OLAP_SUCCESS) {
+        return OLAP_SUCCESS;
     }
     
     // 没有找到可以合并的delta文件，无法执行合并过程，但我们仍然需要设置新的cumulative_layer_point
     // 如果不设置新的cumulative_layer_point, 则下次执行cumulative compaction时，扫描的文件和这次
     // 扫描的文件相同，依然找不到可以合并的delta文件, 无法执行合并过程。
     // 依此类推，就进入了死循环状态，永远不会进行cumulative compaction
-    _table->set_cumulative_layer_point(delta_versions[index].first);
+    _table->set_cumulative_layer_point(_new_cumulative_layer_point);
     _table->save_header();
-    return OLAP_ERR_CUMULATIVE_NO_SUITABLE_VERSIONS;
+    return res;
 }
 
 static bool version_comparator(const Version& lhs, const Version& rhs) {
@@ -330,43 +257,6 @@ OLAPStatus CumulativeCompaction::_get_delta_versions(Versions* delta_versions) {
     return OLAP_SUCCESS;
 }
 
-bool CumulativeCompaction::_find_previous_version(const Version current_version,
-                                               Version* previous_version) {
-    Versions all_versions;
-    if (OLAP_SUCCESS != _table->select_versions_to_span(Version(0, current_version.second),
-                                                        &all_versions)) {
-        OLAP_LOG_WARNING("fail to select shortest version path. [start=%d; end=%d]",
-                         0, current_version.second);
-        return  false;
-    }
-
-    // previous_version.second应该等于current_version.first - 1
-    for (Versions::const_iterator version = all_versions.begin();
-            version != all_versions.end(); ++version) {
-        // Skip base version
-        if (version->first == 0) {
-            continue;
-        }
-
-        if (version->second == current_version.first - 1) {
-            if (_table->is_delete_data_version(*version)
-                    || _table->is_load_delete_version(*version)) {
-                return false;
-            }
-
-            size_t data_size = _table->get_version_data_size(*version);
-            if (data_size >= _max_delta_file_size) {
-                return false;
-            }
-
-            *previous_version = *version;
-            return true;
-        }
-    }
-
-    return false;
-}
-
 OLAPStatus CumulativeCompaction::_do_cumulative_compaction() {
     OLAPStatus res = OLAP_SUCCESS;
     OlapStopWatch watch;
@@ -467,7 +357,7 @@ OLAPStatus CumulativeCompaction::_update_header(vector<SegmentGroup*>* unused_in
     new_indices.push_back(_new_segment_group);
 
     OLAPStatus res = OLAP_SUCCESS;
-    res = _table->replace_data_sources(&_need_merged_versions, &new_indices, unused_indices);
+    res = _table->replace_data_sources(&_need_merged_versions, &new_indices, unused_indices, true);
     if (res != OLAP_SUCCESS) {
         LOG(FATAL) << "failed to replace data sources. res=" << res
                    << ", tablet=" << _table->full_name();
@@ -20,6 +20,7 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,7 @@
 
 namespace doris {
 
+class CumulativeCompactionPolicy;
 class SegmentGroup;
 
 class CumulativeCompaction {
@@ -40,7 +42,8 @@ public:
             _old_cumulative_layer_point(0),
             _new_cumulative_layer_point(0),
             _max_delta_file_size(0),
-            _new_segment_group(NULL) {}
+            _new_segment_group(NULL),
+            _merged_bytes(0) {}
 
     ~CumulativeCompaction() {}
     
@@ -62,6 +65,11 @@ public:
     // - 如果执行成功，返回OLAP_SUCCESS
     // - 如果执行失败，返回相应错误码
     OLAPStatus run();
+
+    // 被合并的delta文件的数据量
+    int64_t merged_bytes() const {
+        return _merged_bytes;
+    }
     
 private:
 
@@ -82,19 +90,6 @@ private:
     // - 如果不成功，返回相应错误码
     OLAPStatus _get_delta_versions(Versions* delta_versions);
 
-    // 找出某一版本文件的前一个版本文件, 即 current_version.first = previous_version.second + 1
-    //
-    // 输入参数：
-    // - current_version: 某一指定版本
-    //
-    // 输出参数：
-    // - previous_version: 待查找的指定版本的前一个版本
-    //
-    // 返回值：
-    // - 如果查找成功，返回true
-    // - 如果查找失败，返回false
-    bool _find_previous_version(const Version current_version, Version* previous_version);
-
     // 执行cumulative compaction合并过程
     //
     // 返回值：
@@ -175,6 +170,9 @@ private:
     std::vector<ColumnData*> _data_source;
     // 可合并的delta文件的版本
     std::vector<Version> _need_merged_versions;
+    // 挑选可合并delta文件的策略
+    std::unique_ptr<CumulativeCompactionPolicy> _policy;
+    int64_t _merged_bytes;
 
     DISALLOW_COPY_AND_ASSIGN(CumulativeCompaction);
 };
@@ -0,0 +1,261 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/cumulative_compaction_policy.h"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "common/config.h"
+#include "olap/olap_table.h"
+
+namespace doris {
+
+const size_t SizeTieredCumulativeCompactionPolicy::MIN_SCORED_BYTES;
+
+CumulativeCompactionPolicy* CumulativeCompactionPolicy::create(const std::string& name) {
+    size_t max_delta_file_size = config::cumulative_compaction_budgeted_bytes;
+    if (strcasecmp(name.c_str(), "budgeted") == 0) {
+        return new BudgetedCumulativeCompactionPolicy(max_delta_file_size);
+    } else if (strcasecmp(name.c_str(), "size_tiered") == 0) {
+        return new SizeTieredCumulativeCompactionPolicy(
+                max_delta_file_size,
+                std::max(config::cumulative_compaction_size_tiered_ratio, 1.0),
+                std::max<int64_t>(config::cumulative_compaction_size_tiered_max_deltas, 2));
+    }
+    return NULL;
+}
+
+bool CumulativeCompactionPolicy::_find_previous_version(OLAPTable* table,
+                                                        const Version& current_version,
+                                                        size_t max_size,
+                                                        Version* previous_version) {
+    Versions all_versions;
+    if (OLAP_SUCCESS != table->select_versions_to_span(Version(0, current_version.second),
+                                                       &all_versions)) {
+        OLAP_LOG_WARNING("fail to select shortest version path. [start=%d; end=%d]",
+                         0, current_version.second);
+        return  false;
+    }
+
+    // previous_version.second应该等于current_version.first - 1
+    for (Versions::const_iterator version = all_versions.begin();
+            version != all_versions.end(); ++version) {
+        // Skip base version
+        if (version->first == 0) {
+            continue;
+        }
+
+        if (version->second == current_version.first - 1) {
+            if (table->is_delete_data_version(*version)
+                    || table->is_load_delete_version(*version)) {
+                return false;
+            }
+
+            size_t data_size = table->get_version_data_size(*version);
+            if (data_size >= max_size) {
+                return false;
+            }
+
+            *previous_version = *version;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+OLAPStatus BudgetedCumulativeCompactionPolicy::pick_versions(
+        OLAPTable* table, const Versions& delta_versions,
+        Versions* need_merged_versions_out, int32_t* new_cumulative_layer_point) {
+    // 此处减1，是为了确保最新版本的delta不会合入到cumulative里
+    // 因为push可能会重复导入最新版本的delta
+    uint32_t delta_number = delta_versions.size() - 1;
+    uint32_t index = 0;
+    // 在delta文件中寻找可合并的delta文件
+    // 这些delta文件可能被delete或较大的delta文件(>= max_delta_file_size)分割为多个区间, 比如：
+    // v1, v2, v3, D, v4, v5, D, v6, v7
+    // 我们分区间进行查找直至找到合适的可合并delta文件
+    while (index < delta_number) {
+        Versions need_merged_versions;
+        size_t total_size = 0;
+
+        // 在其中1个区间里查找可以合并的delta文件
+        for (; index < delta_number; ++index) {
+            // 如果已找到的可合并delta文件大小大于等于_max_delta_file_size，我们认为可以执行合并了
+            // 停止查找过程
+            if (total_size >= _max_delta_file_size) {
+                break;
+            }
+
+            Version delta = delta_versions[index];
+            size_t delta_size = table->get_version_data_size(delta);
+            // 如果遇到大的delta文件，或delete版本文件，则：
+            if (delta_size >= _max_delta_file_size
+                    || table->is_delete_data_version(delta)
+                    || table->is_load_delete_version(delta)) {
+                // 1) 如果need_merged_versions为空，表示这2类文件在区间的开头，直接跳过
+                if (need_merged_versions.empty()) {
+                    continue;
+                } else {
+                    // 2) 如果need_merged_versions不为空，则已经找到区间的末尾，跳出循环
+                    break;
+                }
+            }
+
+            need_merged_versions.push_back(delta);
+            total_size += delta_size;
+        }
+
+        // 该区间没有可以合并的delta文件，进行下一轮循环，继续查找下一个区间
+        if (need_merged_versions.empty()) {
+            continue;
+        }
+
+        // 如果该区间中只有一个delta，或者该区间的delta都是空的delta，则我们查看能否与区间末尾的
+        // 大delta合并，或者与区间的开头的前一个版本合并
+        if (need_merged_versions.size() == 1 || total_size == 0) {
+            // 如果区间末尾是较大的delta版, 则与它合并
+            if (index < delta_number
+                    && table->get_version_data_size(delta_versions[index]) >=
+                           _max_delta_file_size) {
+                need_merged_versions.push_back(delta_versions[index]);
+                ++index;
+            }
+            // 如果区间前一个版本可以合并, 则将其加入到可合并版本中
+            Version delta_before_interval;
+            if (_find_previous_version(table, need_merged_versions[0], _max_delta_file_size,
+                                       &delta_before_interval)) {
+                need_merged_versions.insert(need_merged_versions.begin(),
+                                            delta_before_interval); 
+            }
+
+            // 如果还是只有1个待合并的delta，则跳过，不进行合并
+            if (need_merged_versions.size() == 1) {
+                continue;
+            }
+
+            need_merged_versions_out->swap(need_merged_versions);
+            *new_cumulative_layer_point = delta_versions[index].first;
+            return OLAP_SUCCESS;
+        }
+
+        // 如果有多个可合并文件，则可以进行cumulative compaction的合并过程
+        // 如果只有只有一个可合并的文件，为了效率，不触发cumulative compaction的合并过程
+        if (need_merged_versions.size() != 1) {
+            // 如果在可合并区间开头之前的一个版本的大小没有达到delta文件的最大值，
+            // 则将可合并区间的文件合并到之前那个版本上
+            Version delta;
+            if (_find_previous_version(table, need_merged_versions[0], _max_delta_file_size,
+                                       &delta)) {
+                need_merged_versions.insert(need_merged_versions.begin(), delta); 
+            }
+
+            need_merged_versions_out->swap(need_merged_versions);
+            *new_cumulative_layer_point = delta_versions[index].first;
+            return OLAP_SUCCESS;
+        }
+    }
+
+    *new_cumulative_layer_point = delta_versions[index].first;
+    return OLAP_ERR_CUMULATIVE_NO_SUITABLE_VERSIONS;
+}
+
+OLAPStatus SizeTieredCumulativeCompactionPolicy::pick_versions(
+        OLAPTable* table, const Versions& delta_versions,
+        Versions* need_merged_versions, int32_t* new_cumulative_layer_point) {
+    // 最新版本的delta不合入cumulative, 理由同budgeted策略
+    size_t delta_number = delta_versions.size() - 1;
+    std::vector<size_t> sizes(delta_number);
+    std::vector<bool> mergeable(delta_number);
+    for (size_t i = 0; i < delta_number; ++i) {
+        const Version& delta = delta_versions[i];
+        sizes[i] = table->get_version_data_size(delta);
+        mergeable[i] = sizes[i] < _max_delta_file_size
+                && !table->is_delete_data_version(delta)
+                && !table->is_load_delete_version(delta);
+    }
+
+    // 区间[begin, end]合并后, 读时少合并end - begin个版本, 代价是重写其中所有的数据
+    double best_score = 0;
+    size_t best_begin = 0;
+    size_t best_end = 0;
+    for (size_t begin = 0; begin < delta_number; ++begin) {
+        if (!mergeable[begin]) {
+            continue;
+        }
+        size_t total_size = sizes[begin];
+        size_t max_size = sizes[begin];
+        for (size_t end = begin + 1; end < delta_number && end - begin < _max_deltas; ++end) {
+            // delete版本, 大delta文件以及版本空洞都会分割区间
+            if (!mergeable[end] || delta_versions[end].first != delta_versions[end - 1].second + 1) {
+                break;
+            }
+            total_size += sizes[end];
+            if (total_size > _max_delta_file_size) {
+                break;
+            }
+            max_size = std::max(max_size, sizes[end]);
+            if (max_size > MIN_SCORED_BYTES
+                    && max_size > _size_ratio * (total_size - max_size)) {
+                continue;
+            }
+            double score = (end - begin)
+                    / static_cast<double>(std::max(total_size, MIN_SCORED_BYTES));
+            if (score > best_score) {
+                best_score = score;
+                best_begin = begin;
+                best_end = end;
+            }
+        }
+    }
+
+    if (best_score == 0) {
+        *new_cumulative_layer_point = delta_versions[delta_number].first;
+        return OLAP_ERR_CUMULATIVE_NO_SUITABLE_VERSIONS;
+    }
+
+    size_t total_size = 0;
+    need_merged_versions->clear();
+    for (size_t i = best_begin; i <= best_end; ++i) {
+        need_merged_versions->push_back(delta_versions[i]);
+        total_size += sizes[i];
+    }
+    // 区间之前的cumulative版本和区间大小相近时, 一起合并
+    Version previous_version;
+    size_t max_previous_size = std::min(
+            _max_delta_file_size - total_size,
+            static_cast<size_t>(_size_ratio * std::max(total_size, MIN_SCORED_BYTES)));
+    if (_find_previous_version(table, delta_versions[best_begin], max_previous_size,
+                               &previous_version)) {
+        need_merged_versions->insert(need_merged_versions->begin(), previous_version);
+    }
+
+    // 区间之前还有可合并的delta时, cumulative层标识点保持不动, 以后还可以合并它们
+    *new_cumulative_layer_point = delta_versions[best_end + 1].first;
+    for (size_t i = 0; i < best_begin; ++i) {
+        if (mergeable[i]) {
+            *new_cumulative_layer_point = delta_versions[0].first;
+            break;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+}  // namespace doris
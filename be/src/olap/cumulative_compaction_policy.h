@@ -0,0 +1,112 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_CUMULATIVE_COMPACTION_POLICY_H
+#define DORIS_BE_SRC_OLAP_CUMULATIVE_COMPACTION_POLICY_H
+
+#include <stdint.h>
+
+#include <string>
+
+#include "olap/olap_common.h"
+#include "olap/olap_define.h"
+
+namespace doris {
+
+class OLAPTable;
+
+// 挑选cumulative compaction待合并delta文件的策略
+class CumulativeCompactionPolicy {
+public:
+    virtual ~CumulativeCompactionPolicy() {}
+
+    // 按名字创建策略, 目前支持"budgeted"和"size_tiered"
+    // 名字不认识时返回NULL
+    static CumulativeCompactionPolicy* create(const std::string& name);
+
+    virtual const char* name() const = 0;
+
+    // 计算可以合并的delta文件，以及新的cumulative层标识点
+    //
+    // 输入参数：
+    // - table: 调用者已对header加写锁
+    // - delta_versions: cumulative层标识点之后的delta文件, 按版本排序, 最新的delta不会被合并
+    //
+    // 输出参数：
+    // - need_merged_versions: 可合并的版本，可能包含区间之前的一个cumulative版本
+    // - new_cumulative_layer_point: 新的cumulative层标识点, 没有可合并的版本时也会被设置
+    //
+    // 返回值：
+    // - 如果找到可合并的版本，返回OLAP_SUCCESS
+    // - 否则，返回OLAP_ERR_CUMULATIVE_NO_SUITABLE_VERSIONS
+    virtual OLAPStatus pick_versions(OLAPTable* table, const Versions& delta_versions,
+                                     Versions* need_merged_versions,
+                                     int32_t* new_cumulative_layer_point) = 0;
+
+protected:
+    // 找出某一版本文件的前一个版本文件, 即 current_version.first = previous_version.second + 1
+    // base版本, delete版本以及大小不小于max_size的版本不会被返回
+    static bool _find_previous_version(OLAPTable* table, const Version& current_version,
+                                       size_t max_size, Version* previous_version);
+};
+
+// 从cumulative层标识点开始, 合并被delete版本或大delta文件分割出的第一个区间,
+// 直到待合并的数据量达到max_delta_file_size
+class BudgetedCumulativeCompactionPolicy : public CumulativeCompactionPolicy {
+public:
+    explicit BudgetedCumulativeCompactionPolicy(size_t max_delta_file_size)
+            : _max_delta_file_size(max_delta_file_size) {}
+
+    const char* name() const override { return "budgeted"; }
+
+    OLAPStatus pick_versions(OLAPTable* table, const Versions& delta_versions,
+                             Versions* need_merged_versions,
+                             int32_t* new_cumulative_layer_point) override;
+
+private:
+    size_t _max_delta_file_size;
+};
+
+// 在所有连续的小delta区间中, 选择每写一个字节能让读少合并最多版本的区间.
+// 高频导入产生的大量小delta会先被合并, 而不必等前面的区间凑够数据量.
+// 只有大小相差不超过size_ratio倍的文件才会被合并到一起, 避免为了很小的delta重写大文件
+class SizeTieredCumulativeCompactionPolicy : public CumulativeCompactionPolicy {
+public:
+    SizeTieredCumulativeCompactionPolicy(size_t max_delta_file_size, double size_ratio,
+                                         size_t max_deltas)
+            : _max_delta_file_size(max_delta_file_size),
+            _size_ratio(size_ratio),
+            _max_deltas(max_deltas) {}
+
+    const char* name() const override { return "size_tiered"; }
+
+    OLAPStatus pick_versions(OLAPTable* table, const Versions& delta_versions,
+                             Versions* need_merged_versions,
+                             int32_t* new_cumulative_layer_point) override;
+
+    // 小于该大小的文件按该大小估计写入量, 空delta也有打开和合并的代价
+    static const size_t MIN_SCORED_BYTES = 1024 * 1024;
+
+private:
+    size_t _max_delta_file_size;
+    double _size_ratio;
+    size_t _max_deltas;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_CUMULATIVE_COMPACTION_POLICY_H
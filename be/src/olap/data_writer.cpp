@@ -19,6 +19,8 @@
 
 #include <math.h>
 
+#include "olap/column_distribution.h"
+#include "olap/pre_aggregate.h"
 #include "olap/segment_writer.h"
 #include "olap/segment_group.h"
 #include "olap/row_block.h"
@@ -60,6 +62,10 @@ ColumnDataWriter::ColumnDataWriter(OLAPTablePtr table, SegmentGroup* segment_gro
 }
 
 ColumnDataWriter::~ColumnDataWriter() {
+    if (_pre_aggregate_writer != nullptr) {
+        // not finalized, the segment group is given up
+        _pre_aggregate_writer->abandon();
+    }
     for (size_t i = 0; i < _column_statistics.size(); ++i) {
         SAFE_DELETE(_column_statistics[i].first);
         SAFE_DELETE(_column_statistics[i].second);
@@ -110,9 +116,77 @@ OLAPStatus ColumnDataWriter::init() {
         OLAP_LOG_WARNING("fail to initiate row block. [res=%d]", res);
         return res;
     }
+
+    _init_pre_aggregate();
+    _init_column_distributions();
     return OLAP_SUCCESS;
 }
 
+void ColumnDataWriter::_init_column_distributions() {
+    if (!config::enable_column_distribution) {
+        return;
+    }
+    for (const FieldInfo& field_info : _table->tablet_schema()) {
+        if (has_column_distribution(field_info)) {
+            _distribution_collectors.emplace_back(new ColumnDistributionCollector(field_info));
+        } else {
+            _distribution_collectors.emplace_back();
+        }
+    }
+}
+
+void ColumnDataWriter::_add_column_distribution_rows() {
+    if (_distribution_collectors.empty()) {
+        return;
+    }
+    for (uint32_t i = 0; i < _row_index; ++i) {
+        _row_block->get_row(i, &_cursor);
+        for (size_t cid = 0; cid < _distribution_collectors.size(); ++cid) {
+            if (_distribution_collectors[cid] != nullptr) {
+                _distribution_collectors[cid]->add(
+                        _cursor.get_field_by_index(cid)->get_field_ptr(_cursor.get_buf()));
+            }
+        }
+    }
+}
+
+void ColumnDataWriter::_init_pre_aggregate() {
+    std::vector<uint32_t> key_cids;
+    std::vector<uint32_t> value_cids;
+    if (!get_pre_aggregate_columns(_table->tablet_schema(), _table->pre_aggregate_key_num(),
+                                   &key_cids, &value_cids)) {
+        return;
+    }
+    _pre_aggregate_writer.reset(
+            new PreAggregateWriter(_table->tablet_schema(), key_cids, value_cids));
+    OLAPStatus res = _pre_aggregate_writer->open(
+            _segment_group->construct_pre_aggregate_file_path());
+    if (res != OLAP_SUCCESS) {
+        // the segment group is read from its segments then
+        LOG(WARNING) << "fail to open pre-aggregate file. res=" << res
+                     << ", table=" << _table->full_name();
+        _pre_aggregate_writer->abandon();
+        _pre_aggregate_writer.reset();
+    }
+}
+
+void ColumnDataWriter::_add_pre_aggregate_rows() {
+    if (_pre_aggregate_writer == nullptr) {
+        return;
+    }
+    for (uint32_t i = 0; i < _row_index; ++i) {
+        _row_block->get_row(i, &_cursor);
+        OLAPStatus res = _pre_aggregate_writer->add(_cursor);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to write pre-aggregates. res=" << res
+                         << ", table=" << _table->full_name();
+            _pre_aggregate_writer->abandon();
+            _pre_aggregate_writer.reset();
+            return;
+        }
+    }
+}
+
 OLAPStatus ColumnDataWriter::_init_segment() {
     OLAPStatus res = _add_segment();
     if (OLAP_SUCCESS != res) {
@@ -208,6 +282,28 @@ OLAPStatus ColumnDataWriter::finalize() {
         return res;
     }
 
+    if (!_distribution_collectors.empty()) {
+        std::vector<ColumnDistribution> column_distributions;
+        for (auto& collector : _distribution_collectors) {
+            if (collector != nullptr) {
+                column_distributions.emplace_back();
+                collector->finish(&column_distributions.back());
+            }
+        }
+        _segment_group->set_column_distributions(std::move(column_distributions));
+        _distribution_collectors.clear();
+    }
+
+    if (_pre_aggregate_writer != nullptr) {
+        res = _pre_aggregate_writer->close();
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to close pre-aggregate file. res=" << res
+                         << ", table=" << _table->full_name();
+            _pre_aggregate_writer->abandon();
+        }
+        _pre_aggregate_writer.reset();
+    }
+
     return OLAP_SUCCESS;
 }
 
@@ -239,6 +335,9 @@ OLAPStatus ColumnDataWriter::_flush_row_block(bool finalize) {
         return OLAP_ERR_WRITER_INDEX_WRITE_ERROR;
     }
 
+    _add_pre_aggregate_rows();
+    _add_column_distribution_rows();
+
     // In order to reuse row_block, clear the row_block after finalize
     _row_block->clear();
     _num_rows += _row_index;
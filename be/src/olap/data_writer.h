@@ -18,12 +18,16 @@
 #ifndef DORIS_BE_SRC_OLAP_COLUMN_FILE_DATA_WRITER_H
 #define DORIS_BE_SRC_OLAP_COLUMN_FILE_DATA_WRITER_H
 
+#include <memory>
+
 #include "olap/olap_table.h"
 #include "olap/row_block.h"
 #include "olap/schema.h"
 #include "olap/wrapper_field.h"
 
 namespace doris {
+class ColumnDistributionCollector;
+class PreAggregateWriter;
 class RowBlock;
 class SegmentWriter;
 
@@ -48,6 +52,10 @@ private:
     OLAPStatus _finalize_segment();
     OLAPStatus _flush_row_block(bool finalize);
     OLAPStatus _init_segment();
+    void _init_pre_aggregate();
+    void _add_pre_aggregate_rows();
+    void _init_column_distributions();
+    void _add_column_distribution_rows();
 
     bool _is_push_write;
     OLAPTablePtr _table;
@@ -65,6 +73,11 @@ private:
     uint32_t _segment;
     int64_t _all_num_rows;
     bool _new_segment_created;
+    // null if the table keeps no pre-aggregates or writing them failed
+    std::unique_ptr<PreAggregateWriter> _pre_aggregate_writer;
+    // one per column, null for the columns without a distribution,
+    // empty if enable_column_distribution is off
+    std::vector<std::unique_ptr<ColumnDistributionCollector>> _distribution_collectors;
 };
 
 }  // namespace doris
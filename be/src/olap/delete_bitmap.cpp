@@ -0,0 +1,90 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/delete_bitmap.h"
+
+#include <algorithm>
+
+#include "runtime/vectorized_row_batch.h"
+
+namespace doris {
+
+void DeleteBitmap::add(uint32_t segment, uint32_t row, int64_t version) {
+    auto res = _rows[segment].insert(std::make_pair(row, version));
+    if (!res.second) {
+        res.first->second = std::min(res.first->second, version);
+    }
+    _max_version = std::max(_max_version, version);
+}
+
+void DeleteBitmap::merge(const DeleteBitmap& other) {
+    for (auto& segment : other._rows) {
+        for (auto& row : segment.second) {
+            add(segment.first, row.first, row.second);
+        }
+    }
+}
+
+int64_t DeleteBitmap::get(uint32_t segment, uint32_t row) const {
+    auto seg_it = _rows.find(segment);
+    if (seg_it == _rows.end()) {
+        return -1;
+    }
+    auto it = seg_it->second.find(row);
+    return it == seg_it->second.end() ? -1 : it->second;
+}
+
+uint32_t DeleteBitmap::filter(uint32_t segment, uint32_t first_row, int64_t version,
+                              VectorizedRowBatch* batch) const {
+    uint16_t size = batch->size();
+    auto seg_it = _rows.find(segment);
+    if (size == 0 || seg_it == _rows.end()) {
+        return 0;
+    }
+    const std::map<uint32_t, int64_t>& rows = seg_it->second;
+    uint16_t* selected = batch->selected();
+    bool selected_in_use = batch->selected_in_use();
+    uint32_t end_row = first_row + (selected_in_use ? selected[size - 1] + 1 : size);
+
+    // most blocks have no replaced row, leave their selection alone
+    auto begin = rows.lower_bound(first_row);
+    auto it = begin;
+    while (it != rows.end() && it->first < end_row && it->second > version) {
+        ++it;
+    }
+    if (it == rows.end() || it->first >= end_row) {
+        return 0;
+    }
+
+    it = begin;
+    uint16_t new_size = 0;
+    for (uint16_t j = 0; j < size; ++j) {
+        uint16_t i = selected_in_use ? selected[j] : j;
+        uint32_t row = first_row + i;
+        while (it != rows.end() && it->first < row) {
+            ++it;
+        }
+        bool replaced = it != rows.end() && it->first == row && it->second <= version;
+        selected[new_size] = i;
+        new_size += !replaced;
+    }
+    batch->set_selected_in_use(true);
+    batch->set_size(new_size);
+    return size - new_size;
+}
+
+}  // namespace doris
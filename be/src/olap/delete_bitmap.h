@@ -0,0 +1,63 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_DELETE_BITMAP_H
+#define DORIS_BE_SRC_OLAP_DELETE_BITMAP_H
+
+#include <stdint.h>
+
+#include <map>
+
+namespace doris {
+
+class VectorizedRowBatch;
+
+// Rows of one segment group of a merge-on-write UNIQUE_KEYS table that a
+// newer row of the same key replaced. A row is hidden from reads of the
+// version it was replaced in and of all later versions.
+class DeleteBitmap {
+public:
+    // Marks 'row' of 'segment' as replaced in 'version'. If the row is marked
+    // already, the earlier version is kept.
+    void add(uint32_t segment, uint32_t row, int64_t version);
+
+    // Adds all rows marked in 'other'
+    void merge(const DeleteBitmap& other);
+
+    // Returns the version 'row' of 'segment' was replaced in, -1 if it is not
+    int64_t get(uint32_t segment, uint32_t row) const;
+
+    // Returns the newest version any row was replaced in, -1 if there is none
+    int64_t max_version() const { return _max_version; }
+
+    // Removes the rows replaced in 'version' or before from the selection of
+    // 'batch', row i of the batch being row 'first_row' + i of 'segment'.
+    // Returns the number of rows removed.
+    uint32_t filter(uint32_t segment, uint32_t first_row, int64_t version,
+                    VectorizedRowBatch* batch) const;
+
+    bool empty() const { return _rows.empty(); }
+
+private:
+    // segment -> row -> version the row was replaced in
+    std::map<uint32_t, std::map<uint32_t, int64_t>> _rows;
+    int64_t _max_version = -1;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_DELETE_BITMAP_H
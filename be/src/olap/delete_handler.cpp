@@ -385,6 +385,7 @@ OLAPStatus DeleteHandler::init(OLAPTablePtr olap_table, int32_t version) {
                 OLAP_LOG_WARNING("fail to append condition.[res=%d]", res);
                 return res;
             }
+            temp.sub_conditions.push_back(condition);
         }
 
         _del_conds.push_back(temp);
@@ -414,6 +415,39 @@ bool DeleteHandler::is_filter_data(const int32_t data_version,
     return false;
 }
 
+void DeleteHandler::init_column_predicates(
+        OLAPTablePtr olap_table,
+        const std::function<ColumnPredicate*(const TCondition&)>& convert) {
+    for (auto& del_cond : _del_conds) {
+        std::vector<ColumnPredicate*> predicates;
+        bool vectorized = !del_cond.sub_conditions.empty();
+        for (auto& condition : del_cond.sub_conditions) {
+            int32_t index = olap_table->get_field_index(condition.column_name);
+            if (index < 0) {
+                vectorized = false;
+                break;
+            }
+            if (!olap_table->tablet_schema()[index].is_key) {
+                continue;
+            }
+            ColumnPredicate* predicate = convert(condition);
+            if (predicate == nullptr) {
+                vectorized = false;
+                break;
+            }
+            predicates.push_back(predicate);
+        }
+        if (!vectorized) {
+            for (auto predicate : predicates) {
+                delete predicate;
+            }
+            continue;
+        }
+        del_cond.vectorized = true;
+        del_cond.col_predicates = std::move(predicates);
+    }
+}
+
 vector<int32_t> DeleteHandler::get_conds_version() {
     vector<int32_t> conds_version;
     vector<DeleteConditions>::const_iterator cond_iter = _del_conds.begin();
@@ -435,6 +469,9 @@ void DeleteHandler::finalize() {
     for (; it != _del_conds.end(); ++it) {
         it->del_cond->finalize();
         delete it->del_cond;
+        for (auto predicate : it->col_predicates) {
+            delete predicate;
+        }
     }
 
     _del_conds.clear();
@@ -18,11 +18,13 @@
 #ifndef DORIS_BE_SRC_OLAP_DELETE_HANDLER_H
 #define DORIS_BE_SRC_OLAP_DELETE_HANDLER_H
 
+#include <functional>
 #include <string>
 #include <vector>
 
 #include "gen_cpp/AgentService_types.h"
 #include "gen_cpp/olap_file.pb.h"
+#include "olap/column_predicate.h"
 #include "olap/field.h"
 #include "olap/olap_cond.h"
 #include "olap/olap_define.h"
@@ -116,6 +118,11 @@ struct DeleteConditions {
 
     int32_t filter_version; // 删除条件版本号
     Conditions* del_cond;   // 删除条件
+    std::vector<TCondition> sub_conditions;
+    // the sub conditions of key columns as predicates of vectorized batches,
+    // only set if all of them could be converted
+    bool vectorized = false;
+    std::vector<ColumnPredicate*> col_predicates;
 };
 
 // 这个类主要用于判定一条数据(RowCursor)是否符合删除条件。这个类的使用流程如下：
@@ -166,6 +173,14 @@ public:
     //     * false: 数据不符合删除条件
     bool is_filter_data(const int32_t data_version, const RowCursor& row) const;
 
+    // Converts the sub conditions of the delete conditions into predicates of
+    // vectorized batches by 'convert', which returns nullptr for the ones it
+    // can not convert. Like is_filter_data, only the sub conditions of key
+    // columns are evaluated.
+    void init_column_predicates(
+            OLAPTablePtr olap_table,
+            const std::function<ColumnPredicate*(const TCondition&)>& convert);
+
     // 返回handler中有存有多少条删除条件
     cond_num_t conditions_num() const{
         return _del_conds.size();
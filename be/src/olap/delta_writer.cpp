@@ -19,6 +19,7 @@
 
 #include "olap/schema.h"
 #include "olap/segment_group.h"
+#include "olap/store.h"
 
 namespace doris {
 
@@ -28,13 +29,16 @@ OLAPStatus DeltaWriter::open(WriteRequest* req, DeltaWriter** writer) {
 }
 
 DeltaWriter::DeltaWriter(WriteRequest* req)
-    : _req(*req), _table(nullptr),
+    : _lock(RWMutex::Priority::PREFER_WRITING), _req(*req), _table(nullptr),
       _cur_segment_group(nullptr), _new_table(nullptr),
       _writer(nullptr), _mem_table(nullptr),
       _schema(nullptr), _field_infos(nullptr),
+      _max_mem_table_size(config::write_buffer_size),
       _segment_group_id(-1), _delta_written_success(false) {}
 
 DeltaWriter::~DeltaWriter() {
+    // the flushes still write into segment groups of this writer
+    _flush_handler.wait();
     if (!_delta_written_success) {
         _garbage_collection();
     }
@@ -138,50 +142,152 @@ OLAPStatus DeltaWriter::_init() {
     _field_infos = &(_table->tablet_schema());
     _schema = new Schema(*_field_infos),
     _mem_table = new MemTable(_schema, _field_infos, &_col_ids,
-                              _req.tuple_desc, _table->keys_type());
+                              _req.tuple_desc, _table->keys_type(), config::memtable_partitions,
+                              config::memtable_sort_on_flush,
+                              config::memtable_pre_aggregate_rows);
     _is_init = true;
     return OLAP_SUCCESS;
 }
 
-OLAPStatus DeltaWriter::write(Tuple* tuple) {
+OLAPStatus DeltaWriter::write(Tuple* tuple, int sender_id) {
+    bool inserted = false;
+    {
+        ReadLock rdlock(&_lock);
+        if (_is_init) {
+            _mem_table->insert(tuple, sender_id);
+            if (!_is_mem_table_full()) {
+                return OLAP_SUCCESS;
+            }
+            inserted = true;
+        }
+    }
+
+    WriteLock wrlock(&_lock);
     if (!_is_init) {
         auto st = init();
         if (st != OLAP_SUCCESS) {
             return st;
         }
     }
+    if (!inserted) {
+        _mem_table->insert(tuple, sender_id);
+    }
+    // another sender may have flushed in the meantime
+    if (_is_mem_table_full()) {
+        RETURN_NOT_OK(_flush_mem_table());
+    }
+    return OLAP_SUCCESS;
+}
 
-    _mem_table->insert(tuple);
-    if (_mem_table->memory_usage() >= config::write_buffer_size) {
-        RETURN_NOT_OK(_mem_table->flush(_writer));
+OLAPStatus DeltaWriter::write_batch(const std::vector<Tuple*>& tuples, int sender_id) {
+    bool inserted = false;
+    {
+        ReadLock rdlock(&_lock);
+        if (_is_init) {
+            _mem_table->insert_batch(tuples, sender_id);
+            if (!_is_mem_table_full()) {
+                return OLAP_SUCCESS;
+            }
+            inserted = true;
+        }
+    }
 
-        ++_segment_group_id;
-        _cur_segment_group = new SegmentGroup(_table.get(), false, _segment_group_id, 0, true,
-                                   _req.partition_id, _req.transaction_id);
-        DCHECK(_cur_segment_group != nullptr) << "failed to malloc SegmentGroup";
-        _cur_segment_group->acquire();
-        _cur_segment_group->set_load_id(_req.load_id);
-        _segment_group_vec.push_back(_cur_segment_group);
+    WriteLock wrlock(&_lock);
+    if (!_is_init) {
+        auto st = init();
+        if (st != OLAP_SUCCESS) {
+            return st;
+        }
+    }
+    if (!inserted) {
+        _mem_table->insert_batch(tuples, sender_id);
+    }
+    if (_is_mem_table_full()) {
+        RETURN_NOT_OK(_flush_mem_table());
+    }
+    return OLAP_SUCCESS;
+}
 
-        SAFE_DELETE(_writer);
-        _writer = ColumnDataWriter::create(_table, _cur_segment_group, true);
-        DCHECK(_writer != nullptr) << "memory error occur when creating writer";
+bool DeltaWriter::_is_mem_table_full() {
+    int64_t usage = _mem_table->memory_usage();
+    _mem_usage.store(usage, std::memory_order_relaxed);
+    return usage >= _max_mem_table_size.load(std::memory_order_relaxed);
+}
 
+OLAPStatus DeltaWriter::flush_mem_table() {
+    WriteLock wrlock(&_lock);
+    // the last memtable is written by close()
+    if (!_is_init || _closed || _mem_usage.load(std::memory_order_relaxed) == 0) {
+        return OLAP_SUCCESS;
+    }
+    OLAPStatus st = _flush_mem_table();
+    if (st != OLAP_SUCCESS) {
+        // fail the load when the writer is closed, the caller is not the load
+        _flush_handler.on_submit();
+        _flush_handler.on_flushed(st);
+    }
+    return st;
+}
+
+OLAPStatus DeltaWriter::_flush_mem_table() {
+    // a memtable flushed before failed, the load can not succeed anymore
+    RETURN_NOT_OK(_flush_handler.status());
+
+    MemTableFlushExecutor* flush_executor =
+            _table->store() != nullptr ? _table->store()->flush_executor() : nullptr;
+    if (flush_executor == nullptr) {
+        Span span(_req.trace_context, "memtable_flush");
+        span.add_attribute("bytes", _mem_table->memory_usage());
+        OLAPStatus res = _mem_table->flush(_writer);
+        if (res != OLAP_SUCCESS) {
+            span.set_status(Status("fail to flush memtable"));
+            return res;
+        }
+        SAFE_DELETE(_writer);
         SAFE_DELETE(_mem_table);
-        _mem_table = new MemTable(_schema, _field_infos, &_col_ids,
-                                  _req.tuple_desc, _table->keys_type());
+    } else {
+        MemTracker* mem_tracker = OLAPEngine::get_instance()->memtable_flush_mem_tracker();
+        flush_executor->submit(&_flush_handler, _mem_table, _writer, mem_tracker,
+                               _req.trace_context);
+        _writer = nullptr;
+        _mem_table = nullptr;
+        // too many memtables wait for being written, slow down the load by
+        // waiting for the ones of this writer
+        if (mem_tracker != nullptr && mem_tracker->limit_exceeded()) {
+            RETURN_NOT_OK(_flush_handler.wait());
+        }
     }
+
+    ++_segment_group_id;
+    _cur_segment_group = new SegmentGroup(_table.get(), false, _segment_group_id, 0, true,
+                           _req.partition_id, _req.transaction_id);
+    DCHECK(_cur_segment_group != nullptr) << "failed to malloc SegmentGroup";
+    _cur_segment_group->acquire();
+    _cur_segment_group->set_load_id(_req.load_id);
+    _segment_group_vec.push_back(_cur_segment_group);
+
+    _writer = ColumnDataWriter::create(_table, _cur_segment_group, true);
+    DCHECK(_writer != nullptr) << "memory error occur when creating writer";
+
+    _mem_table = new MemTable(_schema, _field_infos, &_col_ids,
+                              _req.tuple_desc, _table->keys_type(),
+                              config::memtable_partitions, config::memtable_sort_on_flush,
+                              config::memtable_pre_aggregate_rows);
+    _mem_usage.store(0, std::memory_order_relaxed);
     return OLAP_SUCCESS;
 }
 
 OLAPStatus DeltaWriter::close(google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
+    WriteLock wrlock(&_lock);
     if (!_is_init) {
         auto st = init();
         if (st != OLAP_SUCCESS) {
             return st;
         }
     }
+    _closed = true;
     RETURN_NOT_OK(_mem_table->close(_writer));
+    RETURN_NOT_OK(_flush_handler.wait());
 
     OLAPStatus res = _table->add_pending_version(_req.partition_id, _req.transaction_id, nullptr);
     if (res != OLAP_SUCCESS && res != OLAP_ERR_PUSH_TRANSACTION_ALREADY_EXIST) {
@@ -189,6 +295,9 @@ OLAPStatus DeltaWriter::close(google::protobuf::RepeatedPtrField<PTabletInfo>* t
     }
     //add pending data to tablet
     for (SegmentGroup* segment_group : _segment_group_vec) {
+        if (config::enable_packed_segment_group) {
+            RETURN_NOT_OK(segment_group->pack(config::packed_segment_group_max_bytes));
+        }
         RETURN_NOT_OK(_table->add_pending_segment_group(segment_group));
         RETURN_NOT_OK(segment_group->load());
     }
@@ -216,6 +325,9 @@ OLAPStatus DeltaWriter::close(google::protobuf::RepeatedPtrField<PTabletInfo>* t
             return res;
         }
         for (SegmentGroup* segment_group : _new_segment_group_vec) {
+            if (config::enable_packed_segment_group) {
+                RETURN_NOT_OK(segment_group->pack(config::packed_segment_group_max_bytes));
+            }
             RETURN_NOT_OK(_new_table->add_pending_segment_group(segment_group));
             RETURN_NOT_OK(segment_group->load());
         }
@@ -232,12 +344,22 @@ OLAPStatus DeltaWriter::close(google::protobuf::RepeatedPtrField<PTabletInfo>* t
     }
 #endif
 
+    int64_t rows_written = 0;
+    int64_t bytes_written = 0;
+    for (SegmentGroup* segment_group : _segment_group_vec) {
+        rows_written += segment_group->num_rows();
+        bytes_written += segment_group->data_size();
+    }
+    _table->heat()->add_write(rows_written, bytes_written);
+
     _delta_written_success = true;
     return OLAP_SUCCESS;
 }
 
 OLAPStatus DeltaWriter::cancel() {
+    WriteLock wrlock(&_lock);
     DCHECK(!_is_init);
+    _closed = true;
     return OLAP_SUCCESS;
 }
 
@@ -18,12 +18,16 @@
 #ifndef DORIS_BE_SRC_DELTA_WRITER_H
 #define DORIS_BE_SRC_DELTA_WRITER_H
 
+#include <atomic>
+
 #include "olap/memtable.h"
+#include "olap/memtable_flush_executor.h"
 #include "olap/olap_engine.h"
 #include "olap/olap_table.h"
 #include "olap/schema_change.h"
 #include "olap/data_writer.h"
 #include "runtime/descriptors.h"
+#include "runtime/tracer.h"
 #include "runtime/tuple.h"
 #include "gen_cpp/internal_service.pb.h"
 
@@ -46,6 +50,8 @@ struct WriteRequest {
     PUniqueId load_id;
     bool need_gen_rollup;
     TupleDescriptor* tuple_desc;
+    // the parent of the spans of the flushes, not sampled if the load is not traced
+    TraceContext trace_context;
 };
 
 class DeltaWriter {
@@ -54,16 +60,38 @@ public:
     OLAPStatus init();
     DeltaWriter(WriteRequest* req);
     ~DeltaWriter();
-    OLAPStatus write(Tuple* tuple);
+    // Thread safe, writes of different senders run in parallel if
+    // memtable_partitions > 1
+    OLAPStatus write(Tuple* tuple, int sender_id = 0);
+    // same as writing the tuples one by one, but the lock is taken and the
+    // memtable is checked for flush once for all of them
+    OLAPStatus write_batch(const std::vector<Tuple*>& tuples, int sender_id = 0);
     OLAPStatus close(google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec);
 
     OLAPStatus cancel();
 
+    // Flushes the current memtable if it has rows, to free its memory before
+    // it is full. Does nothing once the writer is closed.
+    OLAPStatus flush_mem_table();
+
+    // memory of the current memtable, as of the last write
+    int64_t mem_usage() const { return _mem_usage.load(std::memory_order_relaxed); }
+    // the memtable is flushed once it uses 'size' bytes
+    void set_max_mem_table_size(int64_t size) {
+        _max_mem_table_size.store(size, std::memory_order_relaxed);
+    }
+
     int64_t partition_id() const { return _req.partition_id; }
+    int64_t tablet_id() const { return _req.tablet_id; }
 private:
     void _garbage_collection();
     OLAPStatus _init();
+    OLAPStatus _flush_mem_table();
+    // updates _mem_usage
+    bool _is_mem_table_full();
     
+    // 写入memtable时持有读锁, 初始化和flush时持有写锁
+    RWMutex _lock;
     bool _is_init = false;
     WriteRequest _req;
     OLAPTablePtr _table;
@@ -76,6 +104,12 @@ private:
     Schema* _schema;
     std::vector<FieldInfo>* _field_infos;
     std::vector<uint32_t> _col_ids;
+    // memtables of this writer flushed by the flush executor of the store
+    FlushHandler _flush_handler;
+    // read by TabletWriterMgr without the lock of this writer
+    std::atomic<int64_t> _mem_usage{0};
+    std::atomic<int64_t> _max_mem_table_size{0};
+    bool _closed = false;
 
     int32_t _segment_group_id;
     bool _delta_written_success;
@@ -0,0 +1,123 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_DICT_PREDICATE_H
+#define DORIS_BE_SRC_OLAP_DICT_PREDICATE_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include "runtime/string_value.h"
+#include "runtime/vectorized_row_batch.h"
+
+namespace doris {
+
+// Result of one string predicate on every entry of the dictionary it last saw.
+// A segment reader reads each row block of a dictionary encoded column with the
+// same dictionary, so the predicate is evaluated once per distinct value of the
+// segment and every row is filtered by looking its code up.
+class DictMatchCache {
+public:
+    template<class Pred>
+    const uint8_t* get(const ColumnVector& col, Pred pred) {
+        if (col.dict_id() != _dict_id) {
+            // null rows use code 0, so keep at least one entry
+            _match.assign(std::max<uint32_t>(col.dict_size(), 1), 0);
+            const Slice* values = col.dict_values();
+            for (uint32_t code = 0; code < col.dict_size(); ++code) {
+                _match[code] = pred(StringValue(values[code].data, values[code].size));
+            }
+            _dict_id = col.dict_id();
+        }
+        return _match.data();
+    }
+
+private:
+    int64_t _dict_id = -1;
+    std::vector<uint8_t> _match;
+};
+
+// Evaluate 'pred' on column 'column_id' of 'batch' through its dictionary codes.
+// Returns false without touching 'batch' when the column type is not a string or
+// the column was not read from a dictionary, the caller then evaluates row by row.
+template<class T, class Pred>
+inline bool dict_evaluate(const T*, VectorizedRowBatch* batch, int32_t column_id,
+                          DictMatchCache* cache, Pred pred) {
+    return false;
+}
+
+template<class Pred>
+inline bool dict_evaluate(const StringValue*, VectorizedRowBatch* batch, int32_t column_id,
+                          DictMatchCache* cache, Pred pred) {
+    ColumnVector* col = batch->column(column_id);
+    const int32_t* codes = col->dict_codes();
+    if (codes == nullptr) {
+        return false;
+    }
+    uint16_t n = batch->size();
+    if (n == 0) {
+        return true;
+    }
+    const uint8_t* match = cache->get(*col, pred);
+    uint16_t* sel = batch->selected();
+    uint16_t new_size = 0;
+    if (col->no_nulls()) {
+        if (batch->selected_in_use()) {
+            for (uint16_t j = 0; j != n; ++j) {
+                uint16_t i = sel[j];
+                sel[new_size] = i;
+                new_size += match[codes[i]];
+            }
+            batch->set_size(new_size);
+        } else {
+            for (uint16_t i = 0; i != n; ++i) {
+                sel[new_size] = i;
+                new_size += match[codes[i]];
+            }
+            if (new_size < n) {
+                batch->set_size(new_size);
+                batch->set_selected_in_use(true);
+            }
+        }
+    } else {
+        const bool* is_null = col->is_null();
+        if (batch->selected_in_use()) {
+            for (uint16_t j = 0; j != n; ++j) {
+                uint16_t i = sel[j];
+                sel[new_size] = i;
+                new_size += (!is_null[i] & match[codes[i]]);
+            }
+            batch->set_size(new_size);
+        } else {
+            for (uint16_t i = 0; i != n; ++i) {
+                sel[new_size] = i;
+                new_size += (!is_null[i] & match[codes[i]]);
+            }
+            if (new_size < n) {
+                batch->set_size(new_size);
+                batch->set_selected_in_use(true);
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_DICT_PREDICATE_H
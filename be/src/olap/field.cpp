@@ -69,6 +69,7 @@ Field::Field(const FieldInfo& field_info)
     }
     _index_size = field_info.index_length;
     _aggregate_func = get_aggregate_func(field_info.aggregation, field_info.type);
+    _aggregate_run_func = get_aggregate_run_func(field_info.aggregation, field_info.type);
     _finalize_func = get_finalize_func(field_info.aggregation, field_info.type);
 }
 
@@ -81,6 +81,8 @@ public:
     inline bool equal(char* left, char* right);
 
     inline void aggregate(char* dest, char* src);
+    // aggregate num_rows values of src, each stride bytes after the previous one
+    inline void aggregate_run(char* dest, const char* src, size_t stride, size_t num_rows);
     inline void finalize(char* data);
 
     inline void copy_with_pool(char* dest, const char* src, MemPool* mem_pool);
@@ -117,6 +119,7 @@ private:
     TypeInfo* _type_info;
 
     AggregateFunc _aggregate_func;
+    AggregateRunFunc _aggregate_run_func;
     FinalizeFunc _finalize_func;
 };
 
@@ -203,6 +206,10 @@ inline void Field::aggregate(char* dest, char* src) {
     _aggregate_func(dest, src, nullptr);
 }
 
+inline void Field::aggregate_run(char* dest, const char* src, size_t stride, size_t num_rows) {
+    _aggregate_run_func(dest, src, stride, num_rows, nullptr);
+}
+
 inline void Field::finalize(char* data) {
     if (OLAP_UNLIKELY(_type == OLAP_FIELD_TYPE_HLL)) {
         // hyperloglog type use this function
@@ -310,6 +310,10 @@ public:
 
     // is bloom filter column
     bool is_bf_column;
+    // segments write a bitmap index of the column unless it has too many values
+    bool has_bitmap_index = false;
+    // segments of a string column write an ngram index unless it has too many grams
+    bool has_ngram_index = false;
 public:
     static std::string get_string_by_field_type(FieldType type);
     static std::string get_string_by_aggregation_type(FieldAggregationMethod aggregation_type);
@@ -18,6 +18,7 @@
 #include "olap/file_helper.h"
 
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 #include <string>
@@ -25,6 +26,7 @@
 
 #include <errno.h>
 
+#include "olap/byte_buffer.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/utils.h"
@@ -36,12 +38,20 @@ namespace doris {
 
 Cache* FileHandler::_s_fd_cache;
 
+FileDescriptor::~FileDescriptor() {
+    // buffers still referencing the mapping keep it alive
+    SAFE_DELETE(mapping);
+    ::close(fd);
+}
+
 FileHandler::FileHandler() :
         _fd(-1),
         _wr_length(0),
         _file_name(""),
         _is_using_cache(false),
-        _cache_handle(NULL) {
+        _cache_handle(NULL),
+        _base_offset(0),
+        _range_length(-1) {
 }
 
 FileHandler::~FileHandler() {
@@ -49,7 +59,7 @@ FileHandler::~FileHandler() {
 }
 
 OLAPStatus FileHandler::open(const string& file_name, int flag) {
-    if (_fd != -1 && _file_name == file_name) {
+    if (_fd != -1 && _file_name == file_name && _range_length < 0) {
         return OLAP_SUCCESS;
     }
 
@@ -77,7 +87,7 @@ OLAPStatus FileHandler::open(const string& file_name, int flag) {
 }
 
 OLAPStatus FileHandler::open_with_cache(const string& file_name, int flag) {
-    if (_fd != -1 && _file_name == file_name) {
+    if (_fd != -1 && _file_name == file_name && _range_length < 0) {
         return OLAP_SUCCESS;
     }
 
@@ -118,8 +128,19 @@ OLAPStatus FileHandler::open_with_cache(const string& file_name, int flag) {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus FileHandler::open_range_with_cache(const string& file_name, int flag,
+                                              off_t offset, off_t length) {
+    OLAPStatus res = open_with_cache(file_name, flag);
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
+    _base_offset = offset;
+    _range_length = length;
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus FileHandler::open_with_mode(const string& file_name, int flag, int mode) {
-    if (_fd != -1 && _file_name == file_name) {
+    if (_fd != -1 && _file_name == file_name && _range_length < 0) {
         return OLAP_SUCCESS;
     }
 
@@ -184,6 +205,8 @@ OLAPStatus FileHandler::close() {
     _fd = -1;
     _file_name = "";
     _wr_length = 0;
+    _base_offset = 0;
+    _range_length = -1;
     return OLAP_SUCCESS;
 }
 
@@ -191,7 +214,7 @@ OLAPStatus FileHandler::pread(void* buf, size_t size, size_t offset) {
     char* ptr = reinterpret_cast<char*>(buf);
 
     while (size > 0) {
-        ssize_t rd_size = ::pread(_fd, ptr, size, offset);
+        ssize_t rd_size = ::pread(_fd, ptr, size, offset + _base_offset);
 
         if (rd_size < 0) {
             char errmsg[64];
@@ -215,6 +238,26 @@ OLAPStatus FileHandler::pread(void* buf, size_t size, size_t offset) {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus FileHandler::pread_batch(BatchReadRequest* requests, size_t num_requests,
+                                    bool use_io_uring) {
+    if (use_io_uring) {
+        IoUring* ring = IoUring::get();
+        if (ring != NULL) {
+            return ring->read(requests, num_requests);
+        }
+    }
+
+    OLAPStatus res = OLAP_SUCCESS;
+    for (size_t i = 0; i < num_requests; ++i) {
+        BatchReadRequest& request = requests[i];
+        request.status = request.file->pread(request.buf, request.size, request.offset);
+        if (request.status != OLAP_SUCCESS && res == OLAP_SUCCESS) {
+            res = request.status;
+        }
+    }
+    return res;
+}
+
 OLAPStatus FileHandler::write(const void* buf, size_t buf_size) {
 
     size_t org_buf_size = buf_size;
@@ -280,7 +323,49 @@ OLAPStatus FileHandler::pwrite(const void* buf, size_t buf_size, size_t offset)
     return OLAP_SUCCESS;
 }
 
+OLAPStatus FileHandler::mmap_with_cache(StorageByteBuffer** buffer) {
+    *buffer = NULL;
+    if (!_is_using_cache || _cache_handle == NULL) {
+        LOG(WARNING) << "file is not opened with cache. [file_name='" << _file_name << "']";
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+
+    FileDescriptor* file_desc =
+        reinterpret_cast<FileDescriptor*>(get_fd_cache()->value(_cache_handle));
+    {
+        std::lock_guard<std::mutex> l(file_desc->mapping_lock);
+        if (file_desc->mapping == NULL) {
+            struct stat stat_data;
+            if (fstat(_fd, &stat_data) < 0 || stat_data.st_size == 0) {
+                LOG(WARNING) << "fail to get length of file to map. [file_name='"
+                             << _file_name << "' fd=" << _fd << "]";
+                return OLAP_ERR_IO_ERROR;
+            }
+            file_desc->mapping = StorageByteBuffer::mmap(
+                    NULL, stat_data.st_size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            if (file_desc->mapping == NULL) {
+                return OLAP_ERR_IO_ERROR;
+            }
+            madvise(file_desc->mapping->array(), stat_data.st_size, MADV_WILLNEED);
+        }
+    }
+
+    uint64_t length = _range_length >= 0
+        ? _range_length : file_desc->mapping->capacity() - _base_offset;
+    *buffer = StorageByteBuffer::reference_buffer(file_desc->mapping, _base_offset, length);
+    if (*buffer == NULL) {
+        LOG(WARNING) << "fail to reference file mapping. [file_name='" << _file_name
+                     << "' offset=" << _base_offset << " length=" << length << "]";
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+    return OLAP_SUCCESS;
+}
+
 off_t FileHandler::length() const {
+    if (_range_length >= 0) {
+        return _range_length;
+    }
+
     struct stat stat_data;
 
     if (fstat(_fd, &stat_data) < 0) {
@@ -22,9 +22,11 @@
 #include <sys/stat.h>
  
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "olap/io_uring.h"
 #include "olap/lru_cache.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
@@ -33,12 +35,15 @@
 
 namespace doris {
 
+class StorageByteBuffer;
+
 typedef struct FileDescriptor {
     int fd;
-    FileDescriptor(int fd) : fd(fd) {}
-    ~FileDescriptor() {
-        ::close(fd);
-    }
+    // read-only mapping of the whole file made by FileHandler::mmap_with_cache()
+    StorageByteBuffer* mapping;
+    std::mutex mapping_lock;
+    FileDescriptor(int fd) : fd(fd), mapping(NULL) {}
+    ~FileDescriptor();
 } FileDescriptor;
 
 class FileHandler {
@@ -48,15 +53,32 @@ public:
 
     OLAPStatus open(const std::string& file_name, int flag);
     OLAPStatus open_with_cache(const std::string& file_name, int flag);
+    // Opens the 'length' bytes at 'offset' of the file as if they were a file of
+    // their own: pread() and length() are relative to them. Used for the members
+    // of packed files.
+    OLAPStatus open_range_with_cache(const std::string& file_name, int flag,
+                                     off_t offset, off_t length);
     // The argument mode specifies the permissions to use in case a new file is created.
     OLAPStatus open_with_mode(const std::string& file_name, int flag, int mode);
     OLAPStatus close();
     OLAPStatus release();
 
     OLAPStatus pread(void* buf, size_t size, size_t offset);
+    // Reads all 'requests', with one io_uring submission if 'use_io_uring' is set
+    // and the kernel supports it, otherwise with one pread each.
+    // Returns the first error, the status of every request is set.
+    static OLAPStatus pread_batch(BatchReadRequest* requests, size_t num_requests,
+                                  bool use_io_uring);
     OLAPStatus write(const void* buf, size_t buf_size);
     OLAPStatus pwrite(const void* buf, size_t buf_size, size_t offset);
 
+    // Returns in 'buffer' the opened file, or range of it, in a read-only mapping
+    // of the whole file. The mapping is made once per descriptor of the fd cache,
+    // prefetched with MADV_WILLNEED, and unmapped when the descriptor leaves the
+    // cache and the last buffer referencing it is deleted. The caller owns
+    // 'buffer'. The file must be opened with cache.
+    OLAPStatus mmap_with_cache(StorageByteBuffer** buffer);
+
     int32_t sync() {
         return 0;
     }
@@ -96,6 +118,11 @@ public:
         return _fd;
     }
 
+    // the offset in fd() of the range opened by open_range_with_cache(), 0 otherwise
+    off_t base_offset() const {
+        return _base_offset;
+    }
+
     static void _delete_cache_file_descriptor(const CacheKey& key, void* value) {
         FileDescriptor* file_desc = reinterpret_cast<FileDescriptor*>(value);
         SAFE_DELETE(file_desc);
@@ -117,6 +144,9 @@ private:
     std::string _file_name;
     bool _is_using_cache;
     Cache::Handle* _cache_handle;
+    off_t _base_offset;
+    // -1 if the whole file is opened
+    off_t _range_length;
 };
 
 class FileHandlerWithBuf {
@@ -19,6 +19,7 @@
 
 #include "olap/byte_buffer.h"
 #include "olap/out_stream.h"
+#include "runtime/mem_tracker.h"
 
 namespace doris {
 
@@ -29,13 +30,20 @@ ReadOnlyFileStream::ReadOnlyFileStream(
         uint32_t compress_buffer_size,
         OlapReaderStatistics* stats)
             : _file_cursor(handler, 0, 0),
+            _read_ahead(NULL),
             _compressed_helper(NULL),
             _uncompressed(NULL),
             _shared_buffer(shared_buffer),
             _decompressor(decompressor),
             _compress_buffer_size(compress_buffer_size + sizeof(StreamHead)),
             _current_compress_position(std::numeric_limits<uint64_t>::max()),
-            _stats(stats) {
+            _stats(stats),
+            _page_cache(NULL),
+            _page_cache_mem_tracker(NULL),
+            _cache_decompressed(false),
+            _cached_page(NULL),
+            _mapping(NULL),
+            _mapped_chunk(NULL) {
 }
 
 ReadOnlyFileStream::ReadOnlyFileStream(
@@ -47,13 +55,36 @@ ReadOnlyFileStream::ReadOnlyFileStream(
         uint32_t compress_buffer_size,
         OlapReaderStatistics* stats)
             : _file_cursor(handler, offset, length),
+            _read_ahead(NULL),
             _compressed_helper(NULL),
             _uncompressed(NULL),
             _shared_buffer(shared_buffer),
             _decompressor(decompressor),
             _compress_buffer_size(compress_buffer_size + sizeof(StreamHead)),
             _current_compress_position(std::numeric_limits<uint64_t>::max()),
-            _stats(stats) {
+            _stats(stats),
+            _page_cache(NULL),
+            _page_cache_mem_tracker(NULL),
+            _cache_decompressed(false),
+            _cached_page(NULL),
+            _mapping(NULL),
+            _mapped_chunk(NULL) {
+}
+
+OLAPStatus ReadOnlyFileStream::init_read_ahead(ReadAheadQueue* queue, uint32_t chunks) {
+    size_t window_size = std::min(static_cast<size_t>(chunks) * _compress_buffer_size,
+                                  _file_cursor.length());
+    if (window_size == 0) {
+        return OLAP_SUCCESS;
+    }
+
+    _read_ahead = new(std::nothrow) StreamReadAhead(queue, _file_cursor.file_handler(), window_size);
+    if (NULL == _read_ahead) {
+        OLAP_LOG_WARNING("fail to create read ahead");
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+    _file_cursor.set_read_ahead(_read_ahead);
+    return OLAP_SUCCESS;
 }
 
 OLAPStatus ReadOnlyFileStream::_assure_data() {
@@ -69,7 +100,25 @@ OLAPStatus ReadOnlyFileStream::_assure_data() {
     StreamHead header;
     size_t file_cursor_used = _file_cursor.position();
     OLAPStatus res = OLAP_SUCCESS;
-    {
+    bool hit = false;
+    // the mapped file needs no cache of compressed pages
+    if (_page_cache != NULL && (_cache_decompressed || _mapping == NULL)) {
+        res = _read_cached_page(file_cursor_used, &header, &hit);
+        if (OLAP_UNLIKELY(OLAP_SUCCESS != res)) {
+            return res;
+        }
+        if (hit && _cache_decompressed) {
+            return OLAP_SUCCESS;
+        }
+    }
+
+    if (!hit && _mapping != NULL) {
+        res = _read_mapped(&header);
+        if (OLAP_UNLIKELY(OLAP_SUCCESS != res)) {
+            return res;
+        }
+        _stats->compressed_bytes_read += sizeof(header) + header.length;
+    } else if (!hit) {
         SCOPED_RAW_TIMER(&_stats->io_ns);
         res = _file_cursor.read(reinterpret_cast<char*>(&header), sizeof(header));
         if (OLAP_UNLIKELY(OLAP_SUCCESS != res)) {
@@ -82,18 +131,36 @@ OLAPStatus ReadOnlyFileStream::_assure_data() {
             return res;
         }
         _stats->compressed_bytes_read += sizeof(header) + header.length;
+
+        if (_page_cache != NULL && !_cache_decompressed) {
+            StorageByteBuffer* page = StorageByteBuffer::create(sizeof(header) + header.length);
+            if (page != NULL) {
+                memcpy(page->array(), &header, sizeof(header));
+                memcpy(page->array() + sizeof(header), (*_shared_buffer)->array(), header.length);
+                _insert_page(file_cursor_used, page, sizeof(header) + header.length);
+            }
+        }
     }
 
-    if (header.type == StreamHead::UNCOMPRESSED) {
+    if (_mapped_chunk != NULL && header.type == StreamHead::UNCOMPRESSED) {
+        _uncompressed = _mapped_chunk;
+        _current_compress_position = file_cursor_used;
+        return OLAP_SUCCESS;
+    } else if (header.type == StreamHead::UNCOMPRESSED) {
         StorageByteBuffer* tmp = _compressed_helper;
         _compressed_helper = *_shared_buffer;
         *_shared_buffer = tmp;
     } else {
+        res = _detach_buffer(&_compressed_helper);
+        if (OLAP_SUCCESS != res) {
+            return res;
+        }
         _compressed_helper->set_position(0);
         _compressed_helper->set_limit(_compress_buffer_size);
         {
             SCOPED_RAW_TIMER(&_stats->decompress_ns);
-            res = _decompressor(*_shared_buffer, _compressed_helper);
+            res = _decompressor(_mapped_chunk != NULL ? _mapped_chunk : *_shared_buffer,
+                                _compressed_helper);
             if (OLAP_SUCCESS != res) {
                 OLAP_LOG_WARNING("fail to decompress err=%d", res);
                 return res;
@@ -104,9 +171,113 @@ OLAPStatus ReadOnlyFileStream::_assure_data() {
 
     _uncompressed = _compressed_helper;
     _current_compress_position = file_cursor_used;
+
+    if (_page_cache != NULL && _cache_decompressed && _uncompressed->limit() > 0) {
+        StorageByteBuffer* page = StorageByteBuffer::create(_uncompressed->limit());
+        if (page != NULL) {
+            memcpy(page->array(), _uncompressed->array(), _uncompressed->limit());
+            _insert_page(file_cursor_used, page, sizeof(header) + header.length);
+        }
+    }
+    return res;
+}
+
+CacheKey ReadOnlyFileStream::_page_cache_key(char* buf, size_t len, size_t file_cursor_used) {
+    char* current = buf;
+    size_t remain_len = len;
+    // members of a packed file share its name, their offsets in it tell them apart
+    uint64_t offset = _file_cursor.file_handler()->base_offset()
+            + _file_cursor.offset() + file_cursor_used;
+    OLAP_CACHE_STRING_TO_BUF(current, _file_cursor.file_name(), remain_len);
+    OLAP_CACHE_NUMERIC_TO_BUF(current, offset, remain_len);
+    OLAP_CACHE_NUMERIC_TO_BUF(current, _cache_decompressed, remain_len);
+    return CacheKey(buf, len - remain_len);
+}
+
+OLAPStatus ReadOnlyFileStream::_read_cached_page(
+        size_t file_cursor_used, StreamHead* header, bool* hit) {
+    char key_buf[OLAP_LRU_CACHE_MAX_KEY_LENTH];
+    CacheKey key = _page_cache_key(key_buf, sizeof(key_buf), file_cursor_used);
+    Cache::Handle* handle = _page_cache->lookup(key);
+    if (handle == NULL) {
+        *hit = false;
+        return OLAP_SUCCESS;
+    }
+
+    const CachedPage* page = reinterpret_cast<CachedPage*>(_page_cache->value(handle));
+    OLAPStatus res = OLAP_SUCCESS;
+    if (_cache_decompressed) {
+        // 引用缓存中的数据, 即使被淘汰, 内存在引用释放前也不会被释放
+        SAFE_DELETE(_cached_page);
+        _cached_page = StorageByteBuffer::reference_buffer(
+                page->buffer, 0, page->buffer->limit());
+        if (_cached_page == NULL) {
+            OLAP_LOG_WARNING("fail to reference cached page");
+            res = OLAP_ERR_MALLOC_ERROR;
+        } else {
+            _uncompressed = _cached_page;
+            _current_compress_position = file_cursor_used;
+        }
+    } else {
+        memcpy(header, page->buffer->array(), sizeof(*header));
+        if (header->length > _compress_buffer_size) {
+            LOG(WARNING) << "overflow when read cached page."
+                         << ", length=" << header->length
+                         << ", compress_size" << _compress_buffer_size;
+            res = OLAP_ERR_OUT_OF_BOUND;
+        } else {
+            res = _detach_buffer(_shared_buffer);
+        }
+        if (res == OLAP_SUCCESS) {
+            memcpy((*_shared_buffer)->array(), page->buffer->array() + sizeof(*header),
+                   header->length);
+            (*_shared_buffer)->set_position(0);
+            (*_shared_buffer)->set_limit(header->length);
+        }
+    }
+
+    if (res == OLAP_SUCCESS) {
+        res = _file_cursor.seek(file_cursor_used + page->file_length);
+        ++_stats->data_page_cache_hits;
+        *hit = true;
+    }
+    _page_cache->release(handle);
     return res;
 }
 
+void ReadOnlyFileStream::_insert_page(
+        size_t file_cursor_used, StorageByteBuffer* buffer, uint64_t file_length) {
+    if (_page_cache_mem_tracker->any_limit_exceeded()) {
+        delete buffer;
+        return;
+    }
+
+    CachedPage* page = new(std::nothrow) CachedPage;
+    if (page == NULL) {
+        delete buffer;
+        return;
+    }
+    page->buffer = buffer;
+    page->file_length = file_length;
+    page->mem_tracker = _page_cache_mem_tracker;
+    page->mem_tracker->consume(buffer->capacity());
+
+    char key_buf[OLAP_LRU_CACHE_MAX_KEY_LENTH];
+    CacheKey key = _page_cache_key(key_buf, sizeof(key_buf), file_cursor_used);
+    Cache::Handle* handle = _page_cache->insert(
+            key, page, buffer->capacity(), &_delete_cached_page);
+    if (handle != NULL) {
+        _page_cache->release(handle);
+    }
+}
+
+void ReadOnlyFileStream::_delete_cached_page(const CacheKey& key, void* value) {
+    CachedPage* page = reinterpret_cast<CachedPage*>(value);
+    page->mem_tracker->release(page->buffer->capacity());
+    delete page->buffer;
+    delete page;
+}
+
 // 设置读取的位置
 OLAPStatus ReadOnlyFileStream::seek(PositionProvider* position) {
     OLAPStatus res = OLAP_SUCCESS;
@@ -183,7 +354,12 @@ OLAPStatus ReadOnlyFileStream::_fill_compressed(size_t length) {
         return OLAP_ERR_OUT_OF_BOUND;
     }
 
-    OLAPStatus res = _file_cursor.read((*_shared_buffer)->array(), length);
+    OLAPStatus res = _detach_buffer(_shared_buffer);
+    if (OLAP_SUCCESS != res) {
+        return res;
+    }
+
+    res = _file_cursor.read((*_shared_buffer)->array(), length);
     if (OLAP_SUCCESS != res) {
         OLAP_LOG_WARNING("fail to fill compressed buffer.");
         return res;
@@ -194,6 +370,72 @@ OLAPStatus ReadOnlyFileStream::_fill_compressed(size_t length) {
     return res;
 }
 
+OLAPStatus ReadOnlyFileStream::_read_mapped(StreamHead* header) {
+    size_t position = _file_cursor.position();
+    if (position + sizeof(*header) > _file_cursor.length()) {
+        return OLAP_ERR_COLUMN_STREAM_EOF;
+    }
+    uint64_t offset = _file_cursor.offset() + position;
+    if (offset + sizeof(*header) > _mapping->capacity()) {
+        LOG(WARNING) << "stream out of mapped file. [offset=" << offset
+                     << " mapped=" << _mapping->capacity() << "]";
+        return OLAP_ERR_OUT_OF_BOUND;
+    }
+    memcpy(header, _mapping->array() + offset, sizeof(*header));
+    if (header->length > _compress_buffer_size) {
+        LOG(WARNING) << "overflow when read mapped chunk."
+                     << ", length=" << header->length
+                     << ", compress_size" << _compress_buffer_size;
+        return OLAP_ERR_OUT_OF_BOUND;
+    }
+    OLAPStatus res = _file_cursor.seek(position + sizeof(*header) + header->length);
+    if (OLAP_SUCCESS != res) {
+        return OLAP_ERR_COLUMN_STREAM_EOF;
+    }
+
+    if (_uncompressed == _mapped_chunk) {
+        _uncompressed = NULL;
+    }
+    SAFE_DELETE(_mapped_chunk);
+    if (header->length == 0) {
+        // an empty chunk is read as usual from the empty _shared_buffer
+        res = _detach_buffer(_shared_buffer);
+        if (OLAP_SUCCESS != res) {
+            return res;
+        }
+        (*_shared_buffer)->set_position(0);
+        (*_shared_buffer)->set_limit(0);
+        return OLAP_SUCCESS;
+    }
+    _mapped_chunk = StorageByteBuffer::reference_buffer(
+            _mapping, offset + sizeof(*header), header->length);
+    if (_mapped_chunk == NULL) {
+        LOG(WARNING) << "fail to reference mapped chunk. [offset=" << offset
+                     << " length=" << header->length << "]";
+        return OLAP_ERR_OUT_OF_BOUND;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus ReadOnlyFileStream::_detach_buffer(StorageByteBuffer** buffer) {
+    if (OLAP_LIKELY(!(*buffer)->is_shared())) {
+        return OLAP_SUCCESS;
+    }
+
+    // 旧的内存由引用它的buffer释放
+    StorageByteBuffer* detached = StorageByteBuffer::create((*buffer)->capacity());
+    if (NULL == detached) {
+        OLAP_LOG_WARNING("fail to create buffer to replace referenced one");
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+    if (_uncompressed == *buffer) {
+        _uncompressed = NULL;
+    }
+    delete *buffer;
+    *buffer = detached;
+    return OLAP_SUCCESS;
+}
+
 uint64_t ReadOnlyFileStream::available() {
     return _file_cursor.remain();
 }
@@ -29,11 +29,16 @@
 #include "olap/compress.h"
 #include "olap/stream_index_reader.h"
 #include "olap/file_helper.h"
+#include "olap/lru_cache.h"
 #include "olap/olap_common.h"
+#include "olap/read_ahead.h"
 #include "util/runtime_profile.h"
 
 namespace doris {
 
+class MemTracker;
+struct StreamHead;
+
 // 定义输入数据流接口
 class ReadOnlyFileStream {
 public:
@@ -67,6 +72,9 @@ public:
             OlapReaderStatistics* stats);
 
     ~ReadOnlyFileStream() {
+        SAFE_DELETE(_read_ahead);
+        SAFE_DELETE(_cached_page);
+        SAFE_DELETE(_mapped_chunk);
         SAFE_DELETE(_compressed_helper);
     }
 
@@ -81,6 +89,39 @@ public:
         return OLAP_SUCCESS;
     }
 
+    // 通过queue预读后续chunks个压缩块, 需要在init之后调用
+    // queue为NULL时只有一个窗口, 由pread或者prepare_batch_read的批量读取填充
+    OLAPStatus init_read_ahead(ReadAheadQueue* queue, uint32_t chunks);
+
+    // 通过多个流共享的page cache读取压缩块, decompressed为true时缓存解压后的数据,
+    // 否则缓存从文件中读到的压缩数据. 缓存的数据使用mem_tracker计数
+    void set_page_cache(Cache* cache, MemTracker* mem_tracker, bool decompressed) {
+        _page_cache = cache;
+        _page_cache_mem_tracker = mem_tracker;
+        _cache_decompressed = decompressed;
+    }
+
+    // 从mapping中读取压缩块而不是pread, mapping是整个文件的映射, 由调用者持有.
+    // 解压直接以映射的内存为输入, 未压缩的块不拷贝. 此时不再缓存压缩的数据
+    void set_mapping(StorageByteBuffer* mapping) {
+        _mapping = mapping;
+    }
+
+    // 如果下一个压缩块还不在预读窗口中, 生成读取它的请求, 请求完成后调用finish_batch_read
+    bool prepare_batch_read(BatchReadRequest* request) {
+        if (_read_ahead == NULL) {
+            return false;
+        }
+        return _read_ahead->prepare_batch_read(_file_cursor.offset() + _file_cursor.position(),
+                                               _compress_buffer_size,
+                                               _file_cursor.offset() + _file_cursor.length(),
+                                               request);
+    }
+
+    void finish_batch_read(OLAPStatus status) {
+        _read_ahead->finish_batch_read(status);
+    }
+
     inline void reset(uint64_t offset, uint64_t length) {
         _file_cursor.reset(offset, length);
     }
@@ -96,6 +137,13 @@ public:
     // 如果数据流结束, 返回OLAP_ERR_COLUMN_STREAM_EOF
     inline OLAPStatus read(char* buffer, uint64_t* buf_size);
 
+    // 不拷贝地读取length字节的数据, 内部指针后移
+    // 如果当前块剩余的数据足够, buffer返回引用这段数据的StorageByteBuffer,
+    // 调用者获得所有权; 否则buffer返回NULL, 位置不变, 调用者应该使用read读取.
+    // 被引用的内存在引用释放前不会被覆盖
+    // 如果数据流结束, 返回OLAP_ERR_COLUMN_STREAM_EOF
+    inline OLAPStatus read_reference(uint64_t length, StorageByteBuffer** buffer);
+
     inline OLAPStatus read_all(char* buffer, uint64_t* buf_size);
     // 设置读取的位置
     OLAPStatus seek(PositionProvider* position);
@@ -120,6 +168,9 @@ public:
     uint64_t available();
 
     size_t get_buffer_size() {
+        if (_read_ahead != NULL) {
+            return _compress_buffer_size + _read_ahead->buffer_size();
+        }
         return _compress_buffer_size;
     }
 
@@ -156,6 +207,7 @@ private:
                 size_t offset,
                 size_t length) :
                 _file_handler(file_handler),
+                _read_ahead(NULL),
                 _offset(offset),
                 _length(length),
                 _used(0) {
@@ -169,11 +221,18 @@ private:
             _used = 0;
         }
 
+        void set_read_ahead(StreamReadAhead* read_ahead) {
+            _read_ahead = read_ahead;
+        }
+
         OLAPStatus read(char* out_buffer, size_t length) {
             if (_used + length <= _length) {
-                OLAPStatus res = _file_handler->pread(out_buffer,
-                             length,
-                             _used + _offset);
+                OLAPStatus res = OLAP_SUCCESS;
+                if (_read_ahead != NULL) {
+                    res = _read_ahead->read(out_buffer, length, _used + _offset, _offset + _length);
+                } else {
+                    res = _file_handler->pread(out_buffer, length, _used + _offset);
+                }
                 if (OLAP_SUCCESS != res) {
                     OLAP_LOG_WARNING("fail to read from file. [res=%d]", res);
                     return res;
@@ -214,19 +273,43 @@ private:
 
         const std::string& file_name() const { return _file_handler->file_name(); }
 
+        FileHandler* file_handler() const { return _file_handler; }
+
         size_t offset() const { return _offset; }
 
     private:
         FileHandler* _file_handler;
+        StreamReadAhead* _read_ahead;
         size_t _offset; // start from where
         size_t _length; // length limit
         size_t _used;
     };
 
+    // data page cache中的一项, 包括一个压缩块解压后或者解压前的数据
+    struct CachedPage {
+        StorageByteBuffer* buffer;
+        // 压缩块在文件中的长度, 包括StreamHead
+        uint64_t file_length;
+        MemTracker* mem_tracker;
+    };
+
     OLAPStatus _assure_data();
     OLAPStatus _fill_compressed(size_t length);
+    // 从_mapping中读取当前位置的压缩块, 数据由_mapped_chunk引用
+    OLAPStatus _read_mapped(StreamHead* header);
+    // 写入buffer前调用, 如果它的内存还被read_reference的结果引用, 换成新的内存
+    OLAPStatus _detach_buffer(StorageByteBuffer** buffer);
+
+    CacheKey _page_cache_key(char* buf, size_t len, size_t file_cursor_used);
+    // 如果压缩块在page cache中, 解压后的数据设置到_uncompressed中,
+    // 压缩的数据读入header和_shared_buffer中
+    OLAPStatus _read_cached_page(size_t file_cursor_used, StreamHead* header, bool* hit);
+    // 把buffer放入page cache, 获得buffer的所有权
+    void _insert_page(size_t file_cursor_used, StorageByteBuffer* buffer, uint64_t file_length);
+    static void _delete_cached_page(const CacheKey& key, void* value);
 
     FileCursor _file_cursor;
+    StreamReadAhead* _read_ahead;
     StorageByteBuffer* _compressed_helper;
     StorageByteBuffer* _uncompressed;
     StorageByteBuffer** _shared_buffer;
@@ -237,6 +320,15 @@ private:
 
     OlapReaderStatistics* _stats;
 
+    Cache* _page_cache;
+    MemTracker* _page_cache_mem_tracker;
+    bool _cache_decompressed;
+    // 引用page cache中的解压后的数据, 命中缓存时作为_uncompressed
+    StorageByteBuffer* _cached_page;
+    StorageByteBuffer* _mapping;
+    // 引用_mapping中当前压缩块的数据
+    StorageByteBuffer* _mapped_chunk;
+
     DISALLOW_COPY_AND_ASSIGN(ReadOnlyFileStream);
 };
 
@@ -276,6 +368,26 @@ inline OLAPStatus ReadOnlyFileStream::read(char* buffer, uint64_t* buf_size) {
     return res;
 }
 
+inline OLAPStatus ReadOnlyFileStream::read_reference(uint64_t length,
+                                                     StorageByteBuffer** buffer) {
+    *buffer = NULL;
+    OLAPStatus res = _assure_data();
+    if (OLAP_SUCCESS != res) {
+        return res;
+    }
+
+    if (_uncompressed->remaining() < length) {
+        return OLAP_SUCCESS;
+    }
+
+    uint64_t position = _uncompressed->position();
+    *buffer = StorageByteBuffer::reference_buffer(_uncompressed, position, length);
+    if (*buffer != NULL) {
+        _uncompressed->set_position(position + length);
+    }
+    return OLAP_SUCCESS;
+}
+
 inline OLAPStatus ReadOnlyFileStream::read_all(char* buffer, uint64_t* buffer_size) {
     OLAPStatus res;
     uint64_t read_length = 0;
@@ -17,11 +17,15 @@
 
 #include "olap/hll.h"
 
+#include <immintrin.h>
+#include <string.h>
+
 #include <algorithm>
 #include <map>
 #include <sstream>
 #include <string>
 
+#include "util/cpu_info.h"
 #include "util/slice.h"
 
 using std::map;
@@ -35,7 +39,6 @@ void HllSetResolver::parse() {
     // skip LengthValueType
     char*  pdata = _buf_ref;
     _set_type = (HllDataType)pdata[0];
-    char* sparse_data = NULL;
     switch (_set_type) {
         case HLL_DATA_EXPLICIT:
             // first byte : type
@@ -50,14 +53,7 @@ void HllSetResolver::parse() {
             // second ～（2^HLL_COLUMN_PRECISION)/8 byte : bitmap mark which is not zero
             // 2^HLL_COLUMN_PRECISION)/8 ＋ 1以后value
             _sparse_count = (SparseLengthValueType*)(pdata + sizeof (SetTypeValueType));
-            sparse_data = pdata + sizeof(SetTypeValueType) + sizeof(SparseLengthValueType);
-            for (int i = 0; i < *_sparse_count; i++) {
-                SparseIndexType* index = (SparseIndexType*)sparse_data;
-                sparse_data += sizeof(SparseIndexType);
-                SparseValueType* value = (SparseValueType*)sparse_data;
-                _sparse_map[*index] = *value;
-                sparse_data += sizeof(SetTypeValueType);
-            }
+            _sparse_data = pdata + sizeof(SetTypeValueType) + sizeof(SparseLengthValueType);
             break;
         case HLL_DATA_FULL:
             // first byte : type
@@ -79,68 +75,25 @@ void HllSetResolver::fill_registers(char* registers, int len) {
             registers[idx] = std::max((uint8_t)registers[idx], first_one_bit);
         }
     } else if (_set_type == HLL_DATA_SPRASE) {
-        std::map<SparseIndexType, SparseValueType>& sparse_map = get_sparse_map();
-        for (std::map<SparseIndexType, SparseValueType>::iterator iter = sparse_map.begin();
-                iter != sparse_map.end(); iter++) {
-            registers[iter->first] =
-                std::max((uint8_t)registers[iter->first], (uint8_t)iter->second);
+        const char* sparse_data = _sparse_data;
+        for (int i = 0; i < *_sparse_count; ++i) {
+            SparseIndexType index;
+            memcpy(&index, sparse_data, sizeof(index));
+            uint8_t value = sparse_data[sizeof(SparseIndexType)];
+            registers[index] = std::max((uint8_t)registers[index], value);
+            sparse_data += sizeof(SparseIndexType) + sizeof(SparseValueType);
         }
     } else if (_set_type == HLL_DATA_FULL) {
-        char* full_value = get_full_value();
-        for (int i = 0; i < len; i++) {
-            registers[i] = std::max((uint8_t)registers[i], (uint8_t)full_value[i]);
-        }
-
+        HllSetHelper::merge_registers(registers, get_full_value(), len);
     } else {
         // HLL_DATA_EMPTY
     }
 }
 
-void HllSetResolver::fill_index_to_value_map(std::map<int, uint8_t>* index_to_value, int len) {
+void HllSetResolver::fill_hash64_set(std::vector<uint64_t>* hash_set) {
     if (_set_type == HLL_DATA_EXPLICIT) {
         for (int i = 0; i < get_explicit_count(); ++i) {
-            uint64_t hash_value = get_explicit_value(i);
-            int idx = hash_value % len;
-            uint8_t first_one_bit = __builtin_ctzl(hash_value >> HLL_COLUMN_PRECISION) + 1;
-            if (index_to_value->find(idx) != index_to_value->end()) {
-                (*index_to_value)[idx] =
-                    (*index_to_value)[idx] < first_one_bit ? first_one_bit : (*index_to_value)[idx];
-            } else {
-                (*index_to_value)[idx] = first_one_bit;
-            }
-        }
-    } else if (_set_type == HLL_DATA_SPRASE) {
-        std::map<SparseIndexType, SparseValueType>& sparse_map = get_sparse_map();
-        for (std::map<SparseIndexType, SparseValueType>::iterator iter = sparse_map.begin();
-                iter != sparse_map.end(); iter++) {
-            if (index_to_value->find(iter->first) != index_to_value->end()) {
-                (*index_to_value)[iter->first] =
-                    (*index_to_value)[iter->first]
-                        < iter->second ? iter->second : (*index_to_value)[iter->first];
-            } else {
-                (*index_to_value)[iter->first] = iter->second;
-            }
-        }
-    } else if (_set_type == HLL_DATA_FULL) {
-        char* registers = get_full_value();
-        for (int i = 0; i < len; i++) {
-            if (registers[i] != 0) {
-                if (index_to_value->find(i) != index_to_value->end()) {
-                    (*index_to_value)[i] =
-                        (*index_to_value)[i] < registers[i] ? registers[i]  : (*index_to_value)[i];
-                } else {
-                    (*index_to_value)[i] = registers[i];
-                }
-            }
-        }
-    }
-}
-
-void HllSetResolver::fill_hash64_set(std::set<uint64_t>* hash_set) {
-    if (_set_type == HLL_DATA_EXPLICIT) {
-        for (int i = 0; i < get_explicit_count(); ++i) {
-            uint64_t hash_value = get_explicit_value(i);
-            hash_set->insert(hash_value);
+            hash_set->push_back(get_explicit_value(i));
         }
     }
 }
@@ -163,6 +116,34 @@ void HllSetHelper::set_sparse(
     *(int*)(result + 1) = registers_count;
 }
 
+void HllSetHelper::set_sparse(char* result, const char* registers, int registers_len, int& len) {
+    result[0] = HLL_DATA_SPRASE;
+    len = sizeof(HllSetResolver::SetTypeValueType) + sizeof(HllSetResolver::SparseLengthValueType);
+    char* write_value_pos = result + len;
+    int registers_count = 0;
+    for (int i = 0; i < registers_len; ++i) {
+        if (registers[i] != 0) {
+            write_value_pos[0] = (char)(i & 0xff);
+            write_value_pos[1] = (char)(i >> 8 & 0xff);
+            write_value_pos[2] = registers[i];
+            write_value_pos += 3;
+            ++registers_count;
+        }
+    }
+    len += registers_count * (sizeof(HllSetResolver::SparseIndexType)
+            + sizeof(HllSetResolver::SparseValueType));
+    *(int*)(result + 1) = registers_count;
+}
+
+void HllSetHelper::set_explicit(char* result, const std::vector<uint64_t>& hash_values, int& len) {
+    result[0] = HLL_DATA_EXPLICIT;
+    result[1] = (HllSetResolver::ExpliclitLengthValueType)(hash_values.size());
+    len = sizeof(HllSetResolver::SetTypeValueType)
+        + sizeof(HllSetResolver::ExpliclitLengthValueType);
+    memcpy(result + len, hash_values.data(), sizeof(uint64_t) * hash_values.size());
+    len += sizeof(uint64_t) * hash_values.size();
+}
+
 void HllSetHelper::set_explicit(char* result, const std::set<uint64_t>& hash_value_set, int& len) {
     result[0] = HLL_DATA_EXPLICIT;
     result[1] = (HllSetResolver::ExpliclitLengthValueType)(hash_value_set.size());
@@ -197,16 +178,87 @@ void HllSetHelper::set_full(char* result,
 }
 
 void HllSetHelper::set_max_register(char* registers, int registers_len,
-        const std::set<uint64_t>& hash_set) {
-    for (std::set<uint64_t>::const_iterator iter = hash_set.begin();
-            iter != hash_set.end(); iter++) {
-        uint64_t hash_value = *iter;
+        const std::vector<uint64_t>& hash_set) {
+    for (uint64_t hash_value : hash_set) {
         int idx = hash_value % registers_len;
         uint8_t first_one_bit = __builtin_ctzl(hash_value >> HLL_COLUMN_PRECISION) + 1;
         registers[idx] = std::max((uint8_t)registers[idx], first_one_bit);
     }
 }
 
+static void merge_registers_sse2(uint8_t* registers, const uint8_t* other, int num_blocks) {
+    for (int i = 0; i < num_blocks; ++i) {
+        __m128i* dst = reinterpret_cast<__m128i*>(registers) + i;
+        __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(other) + i);
+        _mm_storeu_si128(dst, _mm_max_epu8(_mm_loadu_si128(dst), src));
+    }
+}
+
+__attribute__((target("avx2")))
+static void merge_registers_avx2(uint8_t* registers, const uint8_t* other, int num_blocks) {
+    for (int i = 0; i < num_blocks; ++i) {
+        __m256i* dst = reinterpret_cast<__m256i*>(registers) + i;
+        __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other) + i);
+        _mm256_storeu_si256(dst, _mm256_max_epu8(_mm256_loadu_si256(dst), src));
+    }
+}
+
+void HllSetHelper::merge_registers(char* registers, const char* other, int registers_len) {
+    uint8_t* dst = reinterpret_cast<uint8_t*>(registers);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(other);
+    int merged = 0;
+    if (CpuInfo::is_supported(CpuInfo::AVX2)) {
+        merge_registers_avx2(dst, src, registers_len / 32);
+        merged = registers_len / 32 * 32;
+    } else {
+        merge_registers_sse2(dst, src, registers_len / 16);
+        merged = registers_len / 16 * 16;
+    }
+    for (int i = merged; i < registers_len; ++i) {
+        dst[i] = std::max(dst[i], src[i]);
+    }
+}
+
+static void sort_and_unique(std::vector<uint64_t>* hash_set) {
+    std::sort(hash_set->begin(), hash_set->end());
+    hash_set->erase(std::unique(hash_set->begin(), hash_set->end()), hash_set->end());
+}
+
+void HllSetHelper::set_hll(char* result, HllContext* context, int& len) {
+    sort_and_unique(context->hash64_set);
+    len = 0;
+    if (context->has_sparse_or_full
+            || context->hash64_set->size() > HLL_EXPLICLIT_INT64_NUM) {
+        set_max_register(context->registers, HLL_REGISTERS_COUNT, *(context->hash64_set));
+        int num_registers = HLL_REGISTERS_COUNT
+            - std::count(context->registers, context->registers + HLL_REGISTERS_COUNT, 0);
+        int sparse_set_len = num_registers *
+            (sizeof(HllSetResolver::SparseIndexType) + sizeof(HllSetResolver::SparseValueType))
+            + sizeof(HllSetResolver::SparseLengthValueType);
+        if (sparse_set_len >= HLL_COLUMN_DEFAULT_LEN) {
+            set_full(result, context->registers, HLL_REGISTERS_COUNT, len);
+        } else if (num_registers > 0) {
+            set_sparse(result, context->registers, HLL_REGISTERS_COUNT, len);
+        }
+    } else if (context->hash64_set->size() > 0) {
+        set_explicit(result, *(context->hash64_set), len);
+    }
+}
+
+// bounds the duplicated hashes of many merged sets, the set which is too large
+// to be explicit anyway is kept in the registers
+static void fold_hash64_set(HllContext* context) {
+    std::vector<uint64_t>* hash_set = context->hash64_set;
+    if (hash_set->size() > 2 * HLL_EXPLICLIT_INT64_NUM) {
+        sort_and_unique(hash_set);
+        if (hash_set->size() > HLL_EXPLICLIT_INT64_NUM) {
+            HllSetHelper::set_max_register(context->registers, HLL_REGISTERS_COUNT, *hash_set);
+            hash_set->clear();
+            context->has_sparse_or_full = true;
+        }
+    }
+}
+
 void HllSetHelper::fill_set(const char* data, HllContext* context) {
     HllSetResolver resolver;
     const Slice* slice = reinterpret_cast<const Slice*>(data);
@@ -218,6 +270,7 @@ void HllSetHelper::fill_set(const char* data, HllContext* context) {
     if (resolver.get_hll_data_type() == HLL_DATA_EXPLICIT) {
         // expliclit set
         resolver.fill_hash64_set(context->hash64_set);
+        fold_hash64_set(context);
     } else if (resolver.get_hll_data_type() != HLL_DATA_EMPTY) {
         // full or sparse
         context->has_sparse_or_full = true;
@@ -225,9 +278,20 @@ void HllSetHelper::fill_set(const char* data, HllContext* context) {
     }
 }
 
+void HllSetHelper::merge_context(HllContext* context, const HllContext& other) {
+    if (other.has_sparse_or_full) {
+        merge_registers(context->registers, other.registers, HLL_REGISTERS_COUNT);
+        context->has_sparse_or_full = true;
+    }
+    context->hash64_set->insert(context->hash64_set->end(),
+                                other.hash64_set->begin(), other.hash64_set->end());
+    fold_hash64_set(context);
+    context->has_value = context->has_value || other.has_value;
+}
+
 void HllSetHelper::init_context(HllContext* context) {
     memset(context->registers, 0, HLL_REGISTERS_COUNT);
-    context->hash64_set = new std::set<uint64_t>();
+    context->hash64_set = new std::vector<uint64_t>();
     context->has_value = false;
     context->has_sparse_or_full = false;
 }
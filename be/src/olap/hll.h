@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <set>
 #include <map>
+#include <vector>
 
 // #include "olap/field_info.h"
 #include "olap/olap_common.h"
@@ -39,7 +40,9 @@ struct HllContext {
     bool has_value;
     bool has_sparse_or_full;
     char registers[HLL_REGISTERS_COUNT];
-    std::set<uint64_t>* hash64_set = nullptr;
+    // hashes of explicit sets, sorted and deduplicated by HllSetHelper::fill_set()
+    // when they grow, folded into the registers past HLL_EXPLICLIT_INT64_NUM
+    std::vector<uint64_t>* hash64_set = nullptr;
 };
 
 // help parse hll set
@@ -50,7 +53,9 @@ public:
                        _set_type(HLL_DATA_EMPTY),
                        _full_value_position(nullptr),
                        _explicit_value(nullptr),
-                       _explicit_num(0) {}
+                       _explicit_num(0),
+                       _sparse_data(nullptr),
+                       _sparse_count(nullptr) {}
 
     ~HllSetResolver() {}
 
@@ -99,22 +104,14 @@ public:
         return (int)*_sparse_count;
     };
 
-    // get (index, value) map
-    std::map<SparseIndexType, SparseValueType>& get_sparse_map() {
-        return _sparse_map;
-    };
-
     // parse set , call after copy() or init()
     void parse();
 
     // fill registers with set
     void fill_registers(char* registers, int len);
 
-    // fill map with set
-    void fill_index_to_value_map(std::map<int, uint8_t>* index_to_value, int len);
-
-    // fill hash map
-    void fill_hash64_set(std::set<uint64_t>* hash_set);
+    // append the hash values of an explicit set
+    void fill_hash64_set(std::vector<uint64_t>* hash_set);
 
 private :
     char* _buf_ref;    // set
@@ -123,7 +120,8 @@ private :
     char* _full_value_position;
     uint64_t* _explicit_value;
     ExpliclitLengthValueType _explicit_num;
-    std::map<SparseIndexType, SparseValueType> _sparse_map;
+    // (index, value) pairs of a sparse set, read in place
+    char* _sparse_data;
     SparseLengthValueType* _sparse_count;
 };
 
@@ -139,14 +137,24 @@ private :
 class HllSetHelper {
 public:
     static void set_sparse(char *result, const std::map<int, uint8_t>& index_to_value, int& len);
+    // sparse set of the registers which are not 0
+    static void set_sparse(char* result, const char* registers, int registers_len, int& len);
     static void set_explicit(char* result, const std::set<uint64_t>& hash_value_set, int& len);
+    // 'hash_values' must be sorted and unique
+    static void set_explicit(char* result, const std::vector<uint64_t>& hash_values, int& len);
     static void set_full(char* result, const char* registers, const int set_len, int& len);
     static void set_full(char* result, const std::map<int, uint8_t>& index_to_value,
                          const int set_len, int& len);
     static void set_max_register(char *registers,
                                  int registers_len,
-                                 const std::set<uint64_t>& hash_set);
+                                 const std::vector<uint64_t>& hash_set);
+    // registers[i] = max(registers[i], other[i]), 16 or 32 registers at a time
+    static void merge_registers(char* registers, const char* other, int registers_len);
+    // the smallest of the encodings of the set of 'context'
+    static void set_hll(char* result, HllContext* context, int& len);
     static void fill_set(const char* data, HllContext* context);
+    // unions the set of 'other' into the one of 'context' without serializing it
+    static void merge_context(HllContext* context, const HllContext& other);
     static void init_context(HllContext* context);
 };
 
@@ -38,6 +38,10 @@ void CLASS<type>::evaluate(VectorizedRowBatch* batch) const { \
     if (n == 0) { \
         return; \
     } \
+    if (dict_evaluate((const type*)nullptr, batch, _column_id, &_dict_cache, \
+            [this](const type& v) { return _values.find(v) OP _values.end(); })) { \
+        return; \
+    } \
     uint16_t* sel = batch->selected(); \
     const type* col_vector = reinterpret_cast<const type*>(batch->column(_column_id)->col_data()); \
     uint16_t new_size = 0; \
@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include <set>
 #include "olap/column_predicate.h"
+#include "olap/dict_predicate.h"
 
 namespace doris {
 
@@ -33,9 +34,11 @@ public: \
     CLASS(int column_id, std::set<type>&& values); \
     virtual ~CLASS() {} \
     virtual void evaluate(VectorizedRowBatch* batch) const override; \
+    virtual int32_t column_id() const override { return _column_id; } \
 private: \
     int32_t _column_id; \
     std::set<type> _values; \
+    mutable DictMatchCache _dict_cache; \
 }; \
 
 IN_LIST_PRED_CLASS_DEFINE(InListPredicate)
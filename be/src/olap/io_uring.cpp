@@ -0,0 +1,251 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/io_uring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "olap/file_helper.h"
+
+#if defined(IORING_OFF_SQ_RING) && defined(__NR_io_uring_setup)
+#define DORIS_HAVE_IO_URING 1
+#endif
+
+namespace doris {
+
+IoUring::IoUring()
+        : _ring_fd(-1),
+        _entries(0),
+        _sq_ring(MAP_FAILED),
+        _sq_ring_size(0),
+        _cq_ring(MAP_FAILED),
+        _cq_ring_size(0),
+        _sqes(MAP_FAILED),
+        _sqes_size(0),
+        _sq_tail(nullptr),
+        _sq_mask(nullptr),
+        _sq_array(nullptr),
+        _cq_head(nullptr),
+        _cq_tail(nullptr),
+        _cq_mask(nullptr),
+        _cqes(nullptr) {
+}
+
+IoUring::~IoUring() {
+    if (_sqes != MAP_FAILED) {
+        munmap(_sqes, _sqes_size);
+    }
+    if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring) {
+        munmap(_cq_ring, _cq_ring_size);
+    }
+    if (_sq_ring != MAP_FAILED) {
+        munmap(_sq_ring, _sq_ring_size);
+    }
+    if (_ring_fd >= 0) {
+        close(_ring_fd);
+    }
+}
+
+IoUring* IoUring::get() {
+#ifdef DORIS_HAVE_IO_URING
+    // set once a ring could not be created, the kernel is not going to change
+    static std::atomic<bool> s_unsupported(false);
+    static thread_local std::unique_ptr<IoUring> s_ring;
+    if (s_ring != nullptr) {
+        return s_ring.get();
+    }
+    if (s_unsupported.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring());
+    if (!ring->_init(std::max(config::io_uring_queue_depth, 1))) {
+        s_unsupported = true;
+        return nullptr;
+    }
+    s_ring = std::move(ring);
+    return s_ring.get();
+#else
+    return nullptr;
+#endif
+}
+
+#ifdef DORIS_HAVE_IO_URING
+
+bool IoUring::_init(uint32_t entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    _ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (_ring_fd < 0) {
+        char errmsg[64];
+        LOG(WARNING) << "io_uring is not available, fall back to pread. [err="
+                     << strerror_r(errno, errmsg, 64) << "]";
+        return false;
+    }
+    _entries = params.sq_entries;
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        _sq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+        _cq_ring_size = _sq_ring_size;
+    }
+    _sq_ring = mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+    if (_sq_ring == MAP_FAILED) {
+        LOG(WARNING) << "fail to map io_uring submission ring";
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        _cq_ring = _sq_ring;
+    } else {
+        _cq_ring = mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_CQ_RING);
+        if (_cq_ring == MAP_FAILED) {
+            LOG(WARNING) << "fail to map io_uring completion ring";
+            return false;
+        }
+    }
+    _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    _sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+    if (_sqes == MAP_FAILED) {
+        LOG(WARNING) << "fail to map io_uring submission entries";
+        return false;
+    }
+
+    char* sq = reinterpret_cast<char*>(_sq_ring);
+    char* cq = reinterpret_cast<char*>(_cq_ring);
+    _sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    _sq_mask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    _sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    _cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    _cq_mask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    _cqes = cq + params.cq_off.cqes;
+    _iovecs.resize(_entries);
+    return true;
+}
+
+OLAPStatus IoUring::_read_some(BatchReadRequest* requests, size_t num_requests) {
+    struct io_uring_sqe* sqes = reinterpret_cast<struct io_uring_sqe*>(_sqes);
+    struct io_uring_cqe* cqes = reinterpret_cast<struct io_uring_cqe*>(_cqes);
+
+    // the kernel consumes submissions in order, we are the only producer
+    uint32_t tail = *_sq_tail;
+    for (size_t i = 0; i < num_requests; ++i) {
+        uint32_t index = tail & *_sq_mask;
+        struct io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        _iovecs[i].iov_base = requests[i].buf;
+        _iovecs[i].iov_len = requests[i].size;
+        // READV instead of READ keeps the ring usable on 5.1 kernels
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = requests[i].file->fd();
+        sqe->off = requests[i].offset + requests[i].file->base_offset();
+        sqe->addr = reinterpret_cast<uint64_t>(&_iovecs[i]);
+        sqe->len = 1;
+        sqe->user_data = i;
+        _sq_array[index] = index;
+        ++tail;
+    }
+    __atomic_store_n(_sq_tail, tail, __ATOMIC_RELEASE);
+
+    OLAPStatus res = OLAP_SUCCESS;
+    size_t to_submit = num_requests;
+    size_t completed = 0;
+    while (completed < num_requests) {
+        int ret = syscall(__NR_io_uring_enter, _ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS,
+                          nullptr, 0);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            // requests submitted before may still be running, the buffers
+            // must not be reused, so there is nothing to fall back to
+            char errmsg[64];
+            LOG(FATAL) << "fail to enter io_uring. [err=" << strerror_r(errno, errmsg, 64) << "]";
+            return OLAP_ERR_IO_ERROR;
+        }
+        to_submit -= std::min<size_t>(ret, to_submit);
+
+        uint32_t head = *_cq_head;
+        uint32_t cq_tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != cq_tail; ++head) {
+            const struct io_uring_cqe& cqe = cqes[head & *_cq_mask];
+            BatchReadRequest& request = requests[cqe.user_data];
+            if (cqe.res < 0) {
+                LOG(WARNING) << "failed to read from file through io_uring. [err="
+                             << strerror(-cqe.res) << " file_name='" << request.file->file_name() << "'"
+                             << " size=" << request.size << " offset=" << request.offset << "]";
+                request.status = OLAP_ERR_IO_ERROR;
+            } else if (static_cast<size_t>(cqe.res) < request.size) {
+                request.status = request.file->pread(request.buf + cqe.res,
+                                                     request.size - cqe.res,
+                                                     request.offset + cqe.res);
+            } else {
+                request.status = OLAP_SUCCESS;
+            }
+            if (request.status != OLAP_SUCCESS && res == OLAP_SUCCESS) {
+                res = request.status;
+            }
+            ++completed;
+        }
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+    }
+    return res;
+}
+
+#else
+
+bool IoUring::_init(uint32_t entries) {
+    return false;
+}
+
+OLAPStatus IoUring::_read_some(BatchReadRequest* requests, size_t num_requests) {
+    return OLAP_ERR_FUNC_NOT_IMPLEMENTED;
+}
+
+#endif // DORIS_HAVE_IO_URING
+
+OLAPStatus IoUring::read(BatchReadRequest* requests, size_t num_requests) {
+    OLAPStatus res = OLAP_SUCCESS;
+    for (size_t i = 0; i < num_requests; i += _entries) {
+        OLAPStatus st = _read_some(requests + i, std::min<size_t>(_entries, num_requests - i));
+        if (st != OLAP_SUCCESS && res == OLAP_SUCCESS) {
+            res = st;
+        }
+    }
+    return res;
+}
+
+}  // namespace doris
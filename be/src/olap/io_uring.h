@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_IO_URING_H
+#define DORIS_BE_SRC_OLAP_IO_URING_H
+
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <vector>
+
+#include "olap/olap_define.h"
+
+namespace doris {
+
+class FileHandler;
+
+// One read of FileHandler::pread_batch
+struct BatchReadRequest {
+    FileHandler* file;
+    char* buf;
+    size_t size;
+    size_t offset;
+    OLAPStatus status;
+};
+
+// Minimal io_uring ring used to submit a batch of reads with one system call.
+// A ring is not thread safe, every thread reading through io_uring gets its
+// own from get().
+class IoUring {
+public:
+    ~IoUring();
+
+    // Returns the ring of the calling thread, or NULL if the kernel (or the
+    // headers the BE was built with) has no io_uring support.
+    static IoUring* get();
+
+    // Reads all 'requests' and sets their status. Short reads are finished
+    // with FileHandler::pread. Returns the first error.
+    OLAPStatus read(BatchReadRequest* requests, size_t num_requests);
+
+private:
+    IoUring();
+
+    bool _init(uint32_t entries);
+    OLAPStatus _read_some(BatchReadRequest* requests, size_t num_requests);
+
+    int _ring_fd;
+    uint32_t _entries;
+
+    void* _sq_ring;
+    size_t _sq_ring_size;
+    void* _cq_ring;
+    size_t _cq_ring_size;
+    void* _sqes;
+    size_t _sqes_size;
+
+    uint32_t* _sq_tail;
+    uint32_t* _sq_mask;
+    uint32_t* _sq_array;
+    uint32_t* _cq_head;
+    uint32_t* _cq_tail;
+    uint32_t* _cq_mask;
+    void* _cqes;
+
+    std::vector<struct iovec> _iovecs;
+
+    DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_IO_URING_H
@@ -0,0 +1,121 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_LOSER_TREE_H
+#define DORIS_BE_SRC_OLAP_LOSER_TREE_H
+
+#include <utility>
+#include <vector>
+
+namespace doris {
+
+// Loser tree over the current elements of 'n' sorted inputs, it finds the input
+// with the smallest element in log(n) comparisons after the previous winner
+// advanced. 'Less(a, b)' returns true if the current element of input a goes
+// before the one of input b, inputs that reached their end must go after all
+// others. Inputs with equal elements are ordered by their index, so the winner
+// does not depend on the shape of the tree.
+template <typename Less>
+class LoserTree {
+public:
+    explicit LoserTree(Less less) : _less(less) { }
+
+    // Builds the tree from the current elements of inputs [0, num_inputs)
+    void build(int num_inputs) {
+        _num_inputs = num_inputs;
+        if (num_inputs == 0) {
+            _tree.clear();
+            return;
+        }
+        // winners of the subtrees, internal nodes first and then the leaves
+        std::vector<int> winners(num_inputs * 2);
+        for (int i = 0; i < num_inputs; ++i) {
+            winners[num_inputs + i] = i;
+        }
+        _tree.assign(num_inputs, -1);
+        for (int node = num_inputs - 1; node > 0; --node) {
+            int left = winners[node * 2];
+            int right = winners[node * 2 + 1];
+            if (before(right, left)) {
+                std::swap(left, right);
+            }
+            winners[node] = left;
+            _tree[node] = right;
+        }
+        _tree[0] = winners[1];
+    }
+
+    bool empty() const {
+        return _tree.empty();
+    }
+
+    int winner() const {
+        return _tree[0];
+    }
+
+    // Replays the matches from the leaf of the winner up to the root after its
+    // current element changed
+    void adjust() {
+        int winner = _tree[0];
+        for (int node = (_num_inputs + _tree[0]) / 2; node > 0; node /= 2) {
+            if (before(_tree[node], winner)) {
+                std::swap(_tree[node], winner);
+            }
+        }
+        _tree[0] = winner;
+    }
+
+    // The input that lost to the winner on its way up and goes before the other
+    // losers, which is the smallest of all other inputs. -1 if there is only one.
+    int runner_up() const {
+        int runner_up = -1;
+        for (int node = (_num_inputs + _tree[0]) / 2; node > 0; node /= 2) {
+            if (runner_up < 0 || before(_tree[node], runner_up)) {
+                runner_up = _tree[node];
+            }
+        }
+        return runner_up;
+    }
+
+    // The order of the tree: by the current elements, then by the input index
+    bool before(int a, int b) const {
+        if (_less(a, b)) {
+            return true;
+        }
+        if (_less(b, a)) {
+            return false;
+        }
+        return a < b;
+    }
+
+    void clear() {
+        _tree.clear();
+        _num_inputs = 0;
+    }
+
+private:
+    Less _less;
+    int _num_inputs = 0;
+    // _tree[0] is the winner and the other nodes hold the loser of their match.
+    // Leaves are not stored, the leaf of input i is node _num_inputs + i.
+    std::vector<int> _tree;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_LOSER_TREE_H
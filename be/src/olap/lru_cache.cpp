@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <strings.h>
 
 #include <sstream>
 #include <string>
@@ -17,6 +18,7 @@
 #include "olap/olap_index.h"
 #include "olap/row_block.h"
 #include "olap/utils.h"
+#include "util/lock_stats.h"
 
 using std::string;
 using std::stringstream;
@@ -161,50 +163,46 @@ bool HandleTable::_resize() {
     return true;
 }
 
-LRUCache::LRUCache() : _usage(0), _last_id(0), _lookup_count(0),
-    _hit_count(0) {
+LRUCache::LRUCache() : _capacity(0), _protected_capacity(0), _policy(CACHE_POLICY_LRU),
+    _mutex(RWMutex::Priority::PREFER_WRITING), _usage(0), _last_id(0), _num_entries(0),
+    _protected_usage(0), _lookup_count(0), _hit_count(0), _evict_count(0),
+    _hit_counter(NULL), _miss_counter(NULL), _evict_counter(NULL) {
+        static LockStats* lock_stats = LockStats::get("lru_cache");
+        _mutex.set_stats(lock_stats);
         // Make empty circular linked list
         _lru.next = &_lru;
         _lru.prev = &_lru;
-        _in_use.next = &_in_use;
-        _in_use.prev = &_in_use;
+        _protected.next = &_protected;
+        _protected.prev = &_protected;
     }
 
 LRUCache::~LRUCache() {
-    assert(_in_use.next == &_in_use);  // Error if caller has an unreleased handle
-    for (LRUHandle* e = _lru.next; e != &_lru;) {
-        LRUHandle* next = e->next;
-        assert(e->in_cache);
-        e->in_cache = false;
-        assert(e->refs == 1);  // Invariant of _lru list.
-        _unref(e);
-        e = next;
-    }
-}
-
-void LRUCache::_ref(LRUHandle* e) {
-    if (e->refs == 1 && e->in_cache) {  // If on _lru list, move to _in_use list.
-        _lru_remove(e);
-        _lru_append(&_in_use, e);
+    for (LRUHandle* list : {&_lru, &_protected}) {
+        for (LRUHandle* e = list->next; e != list;) {
+            LRUHandle* next = e->next;
+            assert(e->in_cache);
+            e->in_cache = false;
+            assert(e->refs == 1);  // Error if caller has an unreleased handle
+            _unref(e);
+            e = next;
+        }
     }
-    e->refs++;
 }
 
+// May run without the lock: once an entry has left the cache nobody can find
+// it any more, and whoever drops the last reference frees it.
 void LRUCache::_unref(LRUHandle* e) {
+    uint32_t refs = __atomic_sub_fetch(&e->refs, 1, __ATOMIC_ACQ_REL);
     // assert(e->refs > 0);
-    if (e->refs <= 0) {
+    if (refs + 1 == 0) {
         LOG(FATAL) << "e->refs > 0, i do not know why, anyway, is something wrong."
-                   << "e->refs=" << e->refs;
+                   << "e->refs=" << refs + 1;
         return;
     }
-    e->refs--;
-    if (e->refs == 0) { // Deallocate.
+    if (refs == 0) { // Deallocate.
         assert(!e->in_cache);
         (*e->deleter)(e->key(), e->value);
         free(e);
-    } else if (e->in_cache && e->refs == 1) {  // No longer in use; move to lru_ list.
-        _lru_remove(e);
-        _lru_append(&_lru, e);
     }
 }
 
@@ -221,29 +219,98 @@ void LRUCache::_lru_append(LRUHandle* list, LRUHandle* e) {
     e->next->prev = e;
 }
 
+// Moves an entry hit while on probation to the protected segment, and
+// the oldest protected entries back to probation if the segment is full.
+// Requires mutex_ held exclusively.
+void LRUCache::_promote(LRUHandle* e) {
+    _lru_remove(e);
+    e->in_protected = true;
+    _protected_usage += e->charge;
+    _lru_append(&_protected, e);
+
+    while (_protected_usage > _protected_capacity && _protected.next != e) {
+        LRUHandle* old = _protected.next;
+        _lru_remove(old);
+        old->in_protected = false;
+        // has to be hit again to come back
+        __atomic_store_n(&old->clock_hits, 0, __ATOMIC_RELAXED);
+        _protected_usage -= old->charge;
+        _lru_append(&_lru, old);
+    }
+}
+
+// Evicts the oldest entry of 'list' that is neither in use nor has hits left.
+// Entries passed over lose a hit and go to the back of their list, probationary
+// ones with hits to the protected segment. Returns false if no entry could be
+// evicted. Requires mutex_ held exclusively.
+bool LRUCache::_evict_from(LRUHandle* list) {
+    // an entry can be passed over once per hit, and once more if it is in use
+    for (size_t visits = (kMaxClockHits + 2) * _num_entries;
+            visits > 0 && list->next != list; --visits) {
+        LRUHandle* e = list->next;
+        uint8_t hits = __atomic_load_n(&e->clock_hits, __ATOMIC_RELAXED);
+        if (hits > 0) {
+            // a concurrent hit may get lost, that is fine
+            __atomic_store_n(&e->clock_hits, hits - 1, __ATOMIC_RELAXED);
+        }
+        if (__atomic_load_n(&e->refs, __ATOMIC_RELAXED) > 1) {
+            _lru_remove(e);
+            _lru_append(list, e);
+            continue;
+        }
+        if (hits > 0) {
+            if (_policy == CACHE_POLICY_SEGMENTED_LRU && !e->in_protected) {
+                _promote(e);
+            } else {
+                _lru_remove(e);
+                _lru_append(list, e);
+            }
+            continue;
+        }
+
+        bool erased = _finish_erase(_table.remove(e->key(), e->hash));
+        if (!erased) {  // to avoid unused variable when compiled NDEBUG
+            assert(erased);
+        }
+        ++_evict_count;
+        if (_evict_counter != NULL) {
+            _evict_counter->increment(1);
+        }
+        return true;
+    }
+    return false;
+}
+
 Cache::Handle* LRUCache::lookup(const CacheKey& key, uint32_t hash) {
-    MutexLock l(&_mutex);
-    ++_lookup_count;
+    ReadLock l(&_mutex);
+    __atomic_fetch_add(&_lookup_count, 1, __ATOMIC_RELAXED);
     LRUHandle* e = _table.lookup(key, hash);
 
     if (e != NULL) {
-        ++_hit_count;
-        _ref(e);
+        __atomic_fetch_add(&_hit_count, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&e->refs, 1, __ATOMIC_RELAXED);
+        // racing hits may count as one, and hot entries are not written again
+        uint8_t hits = __atomic_load_n(&e->clock_hits, __ATOMIC_RELAXED);
+        if (hits < kMaxClockHits) {
+            __atomic_store_n(&e->clock_hits, hits + 1, __ATOMIC_RELAXED);
+        }
+        if (_hit_counter != NULL) {
+            _hit_counter->increment(1);
+        }
+    } else if (_miss_counter != NULL) {
+        _miss_counter->increment(1);
     }
 
     return reinterpret_cast<Cache::Handle*>(e);
 }
 
 void LRUCache::release(Cache::Handle* handle) {
-    MutexLock l(&_mutex);
     _unref(reinterpret_cast<LRUHandle*>(handle));
 }
 
 Cache::Handle* LRUCache::insert(
         const CacheKey& key, uint32_t hash, void* value, size_t charge,
         void (*deleter)(const CacheKey& key, void* value)) {
-    MutexLock l(&_mutex);
-
     LRUHandle* e = reinterpret_cast<LRUHandle*>(
             malloc(sizeof(LRUHandle)-1 + key.size()));
     e->value = value;
@@ -252,23 +319,25 @@ Cache::Handle* LRUCache::insert(
     e->key_length = key.size();
     e->hash = hash;
     e->in_cache = false;
+    e->in_protected = false;
+    e->clock_hits = 0;
     e->refs = 1;  // for the returned handle.
     memcpy(e->key_data, key.data(), key.size());
 
+    WriteLock l(&_mutex);
     if (_capacity > 0) {
         e->refs++;  // for the cache's reference.
         e->in_cache = true;
-        _lru_append(&_in_use, e);
+        _lru_append(&_lru, e);
         _usage += charge;
+        ++_num_entries;
         _finish_erase(_table.insert(e));
     } // else don't cache.  (Tests use capacity_==0 to turn off caching.)
 
-    while (_usage > _capacity && _lru.next != &_lru) {
-        LRUHandle* old = _lru.next;
-        assert(old->refs == 1);
-        bool erased = _finish_erase(_table.remove(old->key(), old->hash));
-        if (!erased) {  // to avoid unused variable when compiled NDEBUG
-            assert(erased);
+    // probationary entries go first, protected ones only if nothing else is left
+    while (_usage > _capacity) {
+        if (!_evict_from(&_lru) && !_evict_from(&_protected)) {
+            break;
         }
     }
 
@@ -276,34 +345,43 @@ Cache::Handle* LRUCache::insert(
 }
 
 // If e != NULL, finish removing *e from the cache; it has already been removed
-// from the hash table.  Return whether e != NULL.  Requires mutex_ held.
+// from the hash table.  Return whether e != NULL.  Requires mutex_ held exclusively.
 bool LRUCache::_finish_erase(LRUHandle* e) {
     if (e != NULL) {
         assert(e->in_cache);
         _lru_remove(e);
         e->in_cache = false;
         _usage -= e->charge;
+        --_num_entries;
+        if (e->in_protected) {
+            e->in_protected = false;
+            _protected_usage -= e->charge;
+        }
         _unref(e);
     }
     return e != NULL;
 }
 
 void LRUCache::erase(const CacheKey& key, uint32_t hash) {
-    MutexLock l(&_mutex);
+    WriteLock l(&_mutex);
     _finish_erase(_table.remove(key, hash));
 }
 
 int LRUCache::prune() {
-    MutexLock l(&_mutex);
+    WriteLock l(&_mutex);
     int num_prune = 0;
-    while (_lru.next != &_lru) {
-        LRUHandle* e = _lru.next;
-        assert(e->refs == 1);
-        bool erased = _finish_erase(_table.remove(e->key(), e->hash));
-        if (!erased) {  // to avoid unused variable when compiled NDEBUG
-            assert(erased);
+    for (LRUHandle* list : {&_lru, &_protected}) {
+        for (LRUHandle* e = list->next; e != list;) {
+            LRUHandle* next = e->next;
+            if (__atomic_load_n(&e->refs, __ATOMIC_RELAXED) == 1) {
+                bool erased = _finish_erase(_table.remove(e->key(), e->hash));
+                if (!erased) {  // to avoid unused variable when compiled NDEBUG
+                    assert(erased);
+                }
+                num_prune++;
+            }
+            e = next;
         }
-        num_prune++;
     }
     return num_prune;
 }
@@ -316,12 +394,14 @@ uint32_t ShardedLRUCache::_shard(uint32_t hash) {
     return hash >> (32 - kNumShardBits);
 }
 
-ShardedLRUCache::ShardedLRUCache(size_t capacity)
+ShardedLRUCache::ShardedLRUCache(size_t capacity, CachePolicy policy)
     : _last_id(0) {
         const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
 
         for (int s = 0; s < kNumShards; s++) {
             _shards[s].set_capacity(per_shard);
+            _shards[s].set_policy(policy);
+            _shards[s].set_metrics(&_hit_counter, &_miss_counter, &_evict_counter);
         }
     }
 
@@ -404,13 +484,38 @@ void ShardedLRUCache::get_cache_status(rapidjson::Document* document) {
         }
 
         shard_info.AddMember("hit_ratio", hit_ratio, document->GetAllocator());
+        shard_info.AddMember("evict_count", static_cast<double>(_shards[i].get_evict_count()),
+                             document->GetAllocator());
         document->PushBack(shard_info, document->GetAllocator());
     }
 
 }
 
-Cache* new_lru_cache(size_t capacity) {
-    return new ShardedLRUCache(capacity);
+void ShardedLRUCache::register_metrics(MetricRegistry* registry, const std::string& name) {
+    registry->register_metric("cache_requests_total",
+                              MetricLabels().add("name", name).add("type", "hit"),
+                              &_hit_counter);
+    registry->register_metric("cache_requests_total",
+                              MetricLabels().add("name", name).add("type", "miss"),
+                              &_miss_counter);
+    registry->register_metric("cache_evictions_total",
+                              MetricLabels().add("name", name),
+                              &_evict_counter);
+}
+
+Cache* new_lru_cache(size_t capacity, CachePolicy policy) {
+    return new ShardedLRUCache(capacity, policy);
+}
+
+bool parse_cache_policy(const std::string& str, CachePolicy* policy) {
+    if (strcasecmp(str.c_str(), "lru") == 0) {
+        *policy = CACHE_POLICY_LRU;
+    } else if (strcasecmp(str.c_str(), "segmented_lru") == 0) {
+        *policy = CACHE_POLICY_SEGMENTED_LRU;
+    } else {
+        return false;
+    }
+    return true;
 }
 
 }  // namespace doris
@@ -14,6 +14,7 @@
 
 #include "olap/olap_common.h"
 #include "olap/utils.h"
+#include "util/metrics.h"
 
 namespace doris {
 
@@ -44,9 +45,23 @@ namespace doris {
     class Cache;
     class CacheKey;
 
+    // 淘汰策略
+    enum CachePolicy {
+        // 淘汰最久未访问的元素
+        CACHE_POLICY_LRU = 0,
+        // 元素先进入试用段, 再次命中后才进入保护段. 只访问一次的元素
+        // (例如大查询或compaction扫过的数据) 从试用段淘汰, 不会挤掉
+        // 被反复访问的元素
+        CACHE_POLICY_SEGMENTED_LRU = 1,
+    };
+
     // Create a new cache with a fixed size capacity.  This implementation
-    // of Cache uses a least-recently-used eviction policy.
-    extern Cache* new_lru_cache(size_t capacity);
+    // of Cache evicts entries according to 'policy', least-recently-used
+    // by default.
+    extern Cache* new_lru_cache(size_t capacity, CachePolicy policy = CACHE_POLICY_LRU);
+
+    // Parses "lru" or "segmented_lru", returns false for anything else
+    extern bool parse_cache_policy(const std::string& str, CachePolicy* policy);
 
     class CacheKey {
         public:
@@ -213,6 +228,9 @@ namespace doris {
             // cache命中率统计
             virtual void get_cache_status(rapidjson::Document* document) = 0;
 
+            // 将命中, 未命中和淘汰次数注册到registry, 以name区分不同的cache
+            virtual void register_metrics(MetricRegistry* registry, const std::string& name) {}
+
         private:
             void _lru_remove(Handle* e);
             void _lru_append(Handle* e);
@@ -222,7 +240,8 @@ namespace doris {
     };
 
     // An entry is a variable length heap-allocated structure.  Entries
-    // are kept in a circular doubly linked list ordered by access time.
+    // are kept in a circular doubly linked list ordered by insertion time,
+    // hits are only counted on the entry.
     typedef struct LRUHandle {
         void* value;
         void (*deleter)(const CacheKey&, void* value);
@@ -232,7 +251,9 @@ namespace doris {
         size_t charge;
         size_t key_length;
         bool in_cache;      // Whether entry is in the cache.
-        uint32_t refs;
+        bool in_protected;  // Whether entry is in the protected segment.
+        uint8_t clock_hits; // Hits not yet consumed by eviction passing over it. Atomic.
+        uint32_t refs;      // Atomic, hits take references under the shared lock
         uint32_t hash;      // Hash of key(); used for fast sharding and comparisons
         char key_data[1];   // Beginning of key
 
@@ -284,6 +305,13 @@ namespace doris {
     };
 
     // A single shard of sharded cache.
+    //
+    // Hits take the shard lock in shared mode only: they take a reference and
+    // count the hit on the entry with atomic operations and leave the lists
+    // alone, so concurrent hits do not serialize. Inserts and erases take the
+    // lock exclusively. Instead of moving entries on every hit, eviction moves
+    // entries with hits back to the end of the list and consumes one of them
+    // (GCLOCK), so entries hit often outlive those hit once.
     class LRUCache {
         public:
             LRUCache();
@@ -292,6 +320,19 @@ namespace doris {
             // Separate from constructor so caller can easily make an array of LRUCache
             void set_capacity(size_t capacity) {
                 _capacity = capacity;
+                _protected_capacity = capacity * kProtectedPercent / 100;
+            }
+
+            void set_policy(CachePolicy policy) {
+                _policy = policy;
+            }
+
+            // 命中, 未命中和淘汰次数同时计入这些counter, 可以为NULL
+            void set_metrics(IntCounter* hit_counter, IntCounter* miss_counter,
+                             IntCounter* evict_counter) {
+                _hit_counter = hit_counter;
+                _miss_counter = miss_counter;
+                _evict_counter = evict_counter;
             }
 
             // Like Cache methods, but with an extra "hash" parameter.
@@ -307,10 +348,13 @@ namespace doris {
             int prune();
 
             uint64_t get_lookup_count() {
-                return _lookup_count;
+                return __atomic_load_n(&_lookup_count, __ATOMIC_RELAXED);
             }
             uint64_t get_hit_count() {
-                return _hit_count;
+                return __atomic_load_n(&_hit_count, __ATOMIC_RELAXED);
+            }
+            uint64_t get_evict_count() {
+                return _evict_count;
             }
             size_t get_usage() {
                 return _usage;
@@ -322,31 +366,52 @@ namespace doris {
         private:
             void _lru_remove(LRUHandle* e);
             void _lru_append(LRUHandle* list, LRUHandle* e);
-            void _ref(LRUHandle* e);
             void _unref(LRUHandle* e);
             bool _finish_erase(LRUHandle* e);
+            bool _evict_from(LRUHandle* list);
+            void _promote(LRUHandle* e);
+
+            // 保护段最多占用的容量百分比
+            static const size_t kProtectedPercent = 80;
+            // 淘汰扫描跳过一个元素的最多次数
+            static const uint8_t kMaxClockHits = 3;
 
             // Initialized before use.
             size_t _capacity;
+            size_t _protected_capacity;
+            CachePolicy _policy;
 
-            // _mutex protects the following state.
-            Mutex _mutex;
+            // Shared by hits, exclusive for everything that changes the table
+            // or the lists. Writers are preferred so inserts are not starved by
+            // a steady stream of hits.
+            RWMutex _mutex;
             size_t _usage;
             uint64_t _last_id;
+            // Number of entries in the cache, bounds the eviction scan
+            size_t _num_entries;
 
             // Dummy head of LRU list.
             // lru.prev is newest entry, lru.next is oldest entry.
-            // Entries have refs==1 and in_cache==true.
+            // Entries have in_cache==true, in use or not. With
+            // CACHE_POLICY_SEGMENTED_LRU these are the probationary entries.
             LRUHandle _lru;
 
-            // Dummy head of in-use list.
-            // Entries are in use by clients, and have refs >= 2 and in_cache==true.
-            LRUHandle _in_use;
+            // Dummy head of protected list, used by CACHE_POLICY_SEGMENTED_LRU.
+            // Entries were hit while on probation and have
+            // in_cache==true and in_protected==true.
+            LRUHandle _protected;
+            // Charge of all entries with in_protected==true
+            size_t _protected_usage;
 
             HandleTable _table;
 
-            uint64_t _lookup_count;    // cache查找总次数
-            uint64_t _hit_count;       // 命中cache的总次数
+            uint64_t _lookup_count;    // cache查找总次数, atomic
+            uint64_t _hit_count;       // 命中cache的总次数, atomic
+            uint64_t _evict_count;     // 因容量不足被淘汰的总次数
+
+            IntCounter* _hit_counter;
+            IntCounter* _miss_counter;
+            IntCounter* _evict_counter;
     };
 
     static const int kNumShardBits = 4;
@@ -354,7 +419,7 @@ namespace doris {
 
     class ShardedLRUCache : public Cache {
         public:
-            explicit ShardedLRUCache(size_t capacity);
+            ShardedLRUCache(size_t capacity, CachePolicy policy);
             // TODO(fdy): 析构时清除所有cache元素
             virtual ~ShardedLRUCache() {}
             virtual Handle* insert(
@@ -370,6 +435,7 @@ namespace doris {
             virtual void prune();
             virtual size_t get_memory_usage();
             virtual void get_cache_status(rapidjson::Document* document);
+            virtual void register_metrics(MetricRegistry* registry, const std::string& name);
 
         private:
             static inline uint32_t _hash_slice(const CacheKey& s);
@@ -378,6 +444,10 @@ namespace doris {
             LRUCache _shards[kNumShards];
             Mutex _id_mutex;
             uint64_t _last_id;
+
+            IntCounter _hit_counter;
+            IntCounter _miss_counter;
+            IntCounter _evict_counter;
     };
 
 }  // namespace doris
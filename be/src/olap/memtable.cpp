@@ -17,30 +17,72 @@
 
 #include "olap/memtable.h"
 
+#include <algorithm>
+
 #include "olap/hll.h"
 #include "olap/data_writer.h"
 #include "olap/row_cursor.h"
 #include "util/runtime_profile.h"
 #include "util/debug_util.h"
+#include "util/doris_metrics.h"
+#include "util/time.h"
 
 namespace doris {
 
 MemTable::MemTable(Schema* schema, std::vector<FieldInfo>* field_infos,
                    std::vector<uint32_t>* col_ids, TupleDescriptor* tuple_desc,
-                   KeysType keys_type)
+                   KeysType keys_type, size_t num_partitions, bool sort_on_flush,
+                   size_t pre_aggregate_rows)
     : _schema(schema),
       _field_infos(field_infos),
       _tuple_desc(tuple_desc),
       _col_ids(col_ids),
       _keys_type(keys_type),
-      _row_comparator(_schema) {
+      _row_comparator(_schema),
+      _sort_on_flush(sort_on_flush),
+      _pre_aggregate_rows(pre_aggregate_rows),
+      _has_hll(false) {
+    for (const FieldInfo& field_info : *_field_infos) {
+        if (field_info.type == OLAP_FIELD_TYPE_HLL) {
+            _has_hll = true;
+            _sort_on_flush = false;
+            _pre_aggregate_rows = 0;
+        }
+    }
+    if (_sort_on_flush || _keys_type != KeysType::AGG_KEYS) {
+        _pre_aggregate_rows = 0;
+    }
+    // at most half of the slots are used, probes stay short
+    size_t pre_aggregate_slots = 0;
+    if (_pre_aggregate_rows > 0) {
+        pre_aggregate_slots = 1;
+        while (pre_aggregate_slots < _pre_aggregate_rows * 2) {
+            pre_aggregate_slots <<= 1;
+        }
+    }
     _schema_size = _schema->schema_size();
-    _tuple_buf = _arena.Allocate(_schema_size);
-    _skip_list = new Table(_row_comparator, &_arena);
+    for (size_t i = 0; i < std::max<size_t>(num_partitions, 1); ++i) {
+        _partitions.emplace_back(new Partition(_row_comparator, _schema_size, _sort_on_flush,
+                                               pre_aggregate_slots));
+    }
 }
 
 MemTable::~MemTable() {
-    delete _skip_list;
+}
+
+MemTable::Partition::Partition(const RowCursorComparator& comparator, size_t schema_size,
+                               bool sort_on_flush, size_t pre_aggregate_slots)
+        : skip_list(NULL), rows_usage(0), pre_agg_slots(pre_aggregate_slots, nullptr),
+          num_pre_agg_rows(0) {
+    tuple_buf = arena.Allocate(schema_size);
+    if (!sort_on_flush) {
+        skip_list = new Table(comparator, &arena);
+    }
+    rows_usage.store(pre_agg_slots.capacity() * sizeof(char*), std::memory_order_relaxed);
+}
+
+MemTable::Partition::~Partition() {
+    delete skip_list;
 }
 
 MemTable::RowCursorComparator::RowCursorComparator(const Schema* schema)
@@ -52,114 +94,379 @@ int MemTable::RowCursorComparator::operator()
 }
 
 size_t MemTable::memory_usage() {
-    return _arena.MemoryUsage();
+    size_t usage = 0;
+    for (auto& partition : _partitions) {
+        usage += partition->arena.MemoryUsage();
+        usage += partition->rows_usage.load(std::memory_order_relaxed);
+    }
+    return usage;
+}
+
+void MemTable::insert(Tuple* tuple, uint32_t partition) {
+    Partition* p = _partitions[partition % _partitions.size()].get();
+    std::lock_guard<std::mutex> l(p->lock);
+    _insert(p, tuple);
+}
+
+void MemTable::insert_batch(const std::vector<Tuple*>& tuples, uint32_t partition) {
+    Partition* p = _partitions[partition % _partitions.size()].get();
+    std::lock_guard<std::mutex> l(p->lock);
+    if (_has_hll) {
+        for (Tuple* tuple : tuples) {
+            _insert(p, tuple);
+        }
+        return;
+    }
+    _insert_batch(p, tuples);
+}
+
+void MemTable::_insert(Partition* p, Tuple* tuple) {
+    const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+    for (size_t i = 0; i < _col_ids->size(); ++i) {
+        _convert_column(p, i, slots[(*_col_ids)[i]], tuple, p->tuple_buf);
+    }
+    if (_add_row(p, p->tuple_buf)) {
+        p->tuple_buf = _new_row(p);
+    }
 }
 
-void MemTable::insert(Tuple* tuple) {
+void MemTable::_insert_batch(Partition* p, const std::vector<Tuple*>& tuples) {
+    if (tuples.empty()) {
+        return;
+    }
+    std::vector<char*> rows(tuples.size());
+    rows[0] = p->tuple_buf;
+    for (size_t j = 1; j < rows.size(); ++j) {
+        rows[j] = _new_row(p);
+    }
     const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
-    size_t offset = 0;
     for (size_t i = 0; i < _col_ids->size(); ++i) {
         const SlotDescriptor* slot = slots[(*_col_ids)[i]];
-        _schema->set_not_null(i, _tuple_buf);
-        if (tuple->is_null(slot->null_indicator_offset())) {
-            _schema->set_null(i, _tuple_buf);
-            offset += _schema->get_col_size(i) + 1;
-            continue;
-        }
-        offset += 1;
-        TypeDescriptor type = slot->type();
-        switch (type.type) {
-            case TYPE_CHAR: {
-                const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
-                Slice* dest = (Slice*)(_tuple_buf + offset);
-                dest->size = (*_field_infos)[i].length;
-                dest->data = _arena.Allocate(dest->size);
-                memcpy(dest->data, src->ptr, src->len);
-                memset(dest->data + src->len, 0, dest->size - src->len);
-                break;
-            }
-            case TYPE_VARCHAR: {
-                const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
-                Slice* dest = (Slice*)(_tuple_buf + offset);
-                dest->size = src->len;
-                dest->data = _arena.Allocate(dest->size);
-                memcpy(dest->data, src->ptr, dest->size);
-                break;
-            }
-            case TYPE_HLL: {
-                const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
-                Slice* dest = (Slice*)(_tuple_buf + offset);
-                dest->size = src->len;
-                bool exist = _skip_list->Contains(_tuple_buf);
-                if (exist) {
-                    dest->data = _arena.Allocate(dest->size);
-                    memcpy(dest->data, src->ptr, dest->size);
-                } else {
-                    dest->data = src->ptr;
-                    char* mem = _arena.Allocate(sizeof(HllContext));
-                    HllContext* context = new (mem) HllContext;
-                    HllSetHelper::init_context(context);
-                    HllSetHelper::fill_set(reinterpret_cast<char*>(dest), context);
-                    context->has_value = true;
-                    char* variable_ptr = _arena.Allocate(sizeof(HllContext*) + HLL_COLUMN_DEFAULT_LEN);
-                    *(size_t*)(variable_ptr) = (size_t)(context);
-                    variable_ptr += sizeof(HllContext*);
-                    dest->data = variable_ptr;
-                    dest->size = HLL_COLUMN_DEFAULT_LEN;
-                }
-                break;
-            }
-            case TYPE_DECIMAL: {
-                DecimalValue* decimal_value = tuple->get_decimal_slot(slot->tuple_offset());
-                decimal12_t* storage_decimal_value = reinterpret_cast<decimal12_t*>(_tuple_buf + offset);
-                storage_decimal_value->integer = decimal_value->int_value();
-                storage_decimal_value->fraction = decimal_value->frac_value();
-                break;
-            }
-            case TYPE_DECIMALV2: {
-                DecimalV2Value* decimal_value = tuple->get_decimalv2_slot(slot->tuple_offset());
-                decimal12_t* storage_decimal_value = reinterpret_cast<decimal12_t*>(_tuple_buf + offset);
-                storage_decimal_value->integer = decimal_value->int_value();
-                storage_decimal_value->fraction = decimal_value->frac_value();
-                break;
-            }
-            case TYPE_DATETIME: {
-                DateTimeValue* datetime_value = tuple->get_datetime_slot(slot->tuple_offset());
-                uint64_t* storage_datetime_value = reinterpret_cast<uint64_t*>(_tuple_buf + offset);
-                *storage_datetime_value = datetime_value->to_olap_datetime();
-                break;
-            }
-            case TYPE_DATE: {
-                DateTimeValue* date_value = tuple->get_datetime_slot(slot->tuple_offset());
-                uint24_t* storage_date_value = reinterpret_cast<uint24_t*>(_tuple_buf + offset);
-                *storage_date_value = static_cast<int64_t>(date_value->to_olap_date());
-                break;
-            }
-            default: {
-                memcpy(_tuple_buf + offset, tuple->get_slot(slot->tuple_offset()), _schema->get_col_size(i));
-                break;
+        for (size_t j = 0; j < rows.size(); ++j) {
+            _convert_column(p, i, slot, tuples[j], rows[j]);
+        }
+    }
+    for (char* row : rows) {
+        if (!_add_row(p, row)) {
+            p->free_rows.push_back(row);
+        }
+    }
+    p->tuple_buf = _new_row(p);
+}
+
+char* MemTable::_new_row(Partition* p) {
+    if (p->free_rows.empty()) {
+        return p->arena.Allocate(_schema_size);
+    }
+    char* row = p->free_rows.back();
+    p->free_rows.pop_back();
+    return row;
+}
+
+void MemTable::_convert_column(Partition* p, size_t i, const SlotDescriptor* slot,
+                               Tuple* tuple, char* row) {
+    _schema->set_not_null(i, row);
+    if (tuple->is_null(slot->null_indicator_offset())) {
+        _schema->set_null(i, row);
+        return;
+    }
+    size_t offset = _schema->get_col_offset(i) + 1;
+    TypeDescriptor type = slot->type();
+    switch (type.type) {
+        case TYPE_CHAR: {
+            const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
+            Slice* dest = (Slice*)(row + offset);
+            dest->size = (*_field_infos)[i].length;
+            dest->data = p->arena.Allocate(dest->size);
+            memcpy(dest->data, src->ptr, src->len);
+            memset(dest->data + src->len, 0, dest->size - src->len);
+            break;
+        }
+        case TYPE_VARCHAR: {
+            const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
+            Slice* dest = (Slice*)(row + offset);
+            dest->size = src->len;
+            dest->data = p->arena.Allocate(dest->size);
+            memcpy(dest->data, src->ptr, dest->size);
+            break;
+        }
+        case TYPE_HLL: {
+            const StringValue* src = tuple->get_string_slot(slot->tuple_offset());
+            Slice* dest = (Slice*)(row + offset);
+            dest->size = src->len;
+            bool exist = p->skip_list->Contains(row);
+            if (exist) {
+                // only parsed into the context of the row in the skiplist while the
+                // tuple is inserted, it does not need to be copied
+                dest->data = src->ptr;
+            } else {
+                dest->data = src->ptr;
+                char* mem = p->arena.Allocate(sizeof(HllContext));
+                HllContext* context = new (mem) HllContext;
+                HllSetHelper::init_context(context);
+                HllSetHelper::fill_set(reinterpret_cast<char*>(dest), context);
+                context->has_value = true;
+                char* variable_ptr = p->arena.Allocate(sizeof(HllContext*) + HLL_COLUMN_DEFAULT_LEN);
+                *(size_t*)(variable_ptr) = (size_t)(context);
+                variable_ptr += sizeof(HllContext*);
+                dest->data = variable_ptr;
+                dest->size = HLL_COLUMN_DEFAULT_LEN;
             }
+            break;
+        }
+        case TYPE_DECIMAL: {
+            DecimalValue* decimal_value = tuple->get_decimal_slot(slot->tuple_offset());
+            decimal12_t* storage_decimal_value = reinterpret_cast<decimal12_t*>(row + offset);
+            storage_decimal_value->integer = decimal_value->int_value();
+            storage_decimal_value->fraction = decimal_value->frac_value();
+            break;
+        }
+        case TYPE_DECIMALV2: {
+            DecimalV2Value* decimal_value = tuple->get_decimalv2_slot(slot->tuple_offset());
+            decimal12_t* storage_decimal_value = reinterpret_cast<decimal12_t*>(row + offset);
+            storage_decimal_value->integer = decimal_value->int_value();
+            storage_decimal_value->fraction = decimal_value->frac_value();
+            break;
+        }
+        case TYPE_DATETIME: {
+            DateTimeValue* datetime_value = tuple->get_datetime_slot(slot->tuple_offset());
+            uint64_t* storage_datetime_value = reinterpret_cast<uint64_t*>(row + offset);
+            *storage_datetime_value = datetime_value->to_olap_datetime();
+            break;
+        }
+        case TYPE_DATE: {
+            DateTimeValue* date_value = tuple->get_datetime_slot(slot->tuple_offset());
+            uint24_t* storage_date_value = reinterpret_cast<uint24_t*>(row + offset);
+            *storage_date_value = static_cast<int64_t>(date_value->to_olap_date());
+            break;
+        }
+        default: {
+            memcpy(row + offset, tuple->get_slot(slot->tuple_offset()), _schema->get_col_size(i));
+            break;
         }
-        offset = offset + _schema->get_col_size(i);
+    }
+}
+
+bool MemTable::_add_row(Partition* p, char* row) {
+    if (_sort_on_flush) {
+        p->rows.push_back(row);
+        p->rows_usage.store(p->rows.capacity() * sizeof(char*), std::memory_order_relaxed);
+        return true;
+    }
+
+    if (!p->pre_agg_slots.empty()) {
+        return _pre_aggregate(p, row);
     }
 
     bool overwritten = false;
-    _skip_list->Insert(_tuple_buf, &overwritten, _keys_type);
-    if (!overwritten) {
-        _tuple_buf = _arena.Allocate(_schema_size);
+    p->skip_list->Insert(row, &overwritten, _keys_type);
+    return !overwritten;
+}
+
+bool MemTable::_pre_aggregate(Partition* p, char* row) {
+    size_t mask = p->pre_agg_slots.size() - 1;
+    size_t slot = _schema->hash_key(row) & mask;
+    while (p->pre_agg_slots[slot] != nullptr) {
+        char* buffered = p->pre_agg_slots[slot];
+        if (_schema->compare(buffered, row) == 0) {
+            // the buffered row is the older one, as it is in the skiplist
+            _schema->aggregate(buffered, row, &p->arena);
+            return false;
+        }
+        slot = (slot + 1) & mask;
+    }
+    p->pre_agg_slots[slot] = row;
+    if (++p->num_pre_agg_rows >= _pre_aggregate_rows) {
+        _flush_pre_aggregated(p);
+    }
+    return true;
+}
+
+void MemTable::_flush_pre_aggregated(Partition* p) {
+    if (p->num_pre_agg_rows == 0) {
+        return;
+    }
+    // the buffered keys are distinct, the order they are inserted in does not
+    // matter. a row aggregated into one of the skiplist is reused
+    for (char*& row : p->pre_agg_slots) {
+        if (row != nullptr) {
+            bool overwritten = false;
+            p->skip_list->Insert(row, &overwritten, _keys_type);
+            if (overwritten) {
+                p->free_rows.push_back(row);
+            }
+            row = nullptr;
+        }
     }
+    p->num_pre_agg_rows = 0;
 }
 
 OLAPStatus MemTable::flush(ColumnDataWriter* writer) {
-    Table::Iterator it(_skip_list);
-    for (it.SeekToFirst(); it.Valid(); it.Next()) {
-        const char* row = it.key();
+    int64_t start_us = MonotonicMicros();
+    for (auto& partition : _partitions) {
+        std::lock_guard<std::mutex> l(partition->lock);
+        _flush_pre_aggregated(partition.get());
+    }
+    if (_sort_on_flush) {
+        RETURN_NOT_OK(_sort_and_flush(writer));
+    } else if (_partitions.size() > 1) {
+        RETURN_NOT_OK(_merge_partitions(writer));
+    } else {
+        Table::Iterator it(_partitions[0]->skip_list);
+        for (it.SeekToFirst(); it.Valid(); it.Next()) {
+            const char* row = it.key();
+            _schema->finalize(row);
+            RETURN_NOT_OK(writer->write(row));
+            writer->next(row, _schema);
+        }
+    }
+
+    RETURN_NOT_OK(writer->finalize());
+    DorisMetrics::memtable_flush_duration_us.add(MonotonicMicros() - start_us);
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus MemTable::_merge_partitions(ColumnDataWriter* writer) {
+    std::vector<Table::Iterator> iters;
+    for (auto& partition : _partitions) {
+        iters.emplace_back(partition->skip_list);
+        iters.back().SeekToFirst();
+    }
+
+    while (true) {
+        int min = -1;
+        for (int i = 0; i < iters.size(); ++i) {
+            if (iters[i].Valid()
+                    && (min < 0 || _schema->compare(iters[i].key(), iters[min].key()) < 0)) {
+                min = i;
+            }
+        }
+        if (min < 0) {
+            break;
+        }
+        char* row = iters[min].key();
+        iters[min].Next();
+
+#ifndef BE_TEST
+        // keys are unique inside a partition, but not across partitions
+        if (_keys_type != KeysType::DUP_KEYS) {
+            for (int i = 0; i < iters.size(); ++i) {
+                if (iters[i].Valid() && _schema->compare(iters[i].key(), row) == 0) {
+                    // hll columns of both rows hold a context, they are merged
+                    // as they are
+                    _schema->merge(row, iters[i].key(), &_partitions[min]->arena);
+                    iters[i].Next();
+                }
+            }
+        }
+#endif
+
         _schema->finalize(row);
         RETURN_NOT_OK(writer->write(row));
         writer->next(row, _schema);
     }
+    return OLAP_SUCCESS;
+}
 
-    RETURN_NOT_OK(writer->finalize());
+uint64_t MemTable::_sort_prefix(const char* row) const {
+    // nulls sort first, a value mapped to 0 as well is ordered by compare()
+    int offset = _schema->get_col_offset(0);
+    if (_schema->is_null(0, row)) {
+        return 0;
+    }
+    const char* value = row + offset + 1;
+    // signed values are shifted so that they compare as unsigned ones
+    switch ((*_field_infos)[0].type) {
+    case OLAP_FIELD_TYPE_TINYINT:
+        return static_cast<uint64_t>(*reinterpret_cast<const int8_t*>(value)) ^ (1ULL << 63);
+    case OLAP_FIELD_TYPE_SMALLINT:
+        return static_cast<uint64_t>(
+                static_cast<int64_t>(*reinterpret_cast<const int16_t*>(value))) ^ (1ULL << 63);
+    case OLAP_FIELD_TYPE_INT:
+        return static_cast<uint64_t>(
+                static_cast<int64_t>(*reinterpret_cast<const int32_t*>(value))) ^ (1ULL << 63);
+    case OLAP_FIELD_TYPE_BIGINT: {
+        int64_t v = 0;
+        memcpy(&v, value, sizeof(v));
+        return static_cast<uint64_t>(v) ^ (1ULL << 63);
+    }
+    case OLAP_FIELD_TYPE_UNSIGNED_TINYINT:
+        return *reinterpret_cast<const uint8_t*>(value);
+    case OLAP_FIELD_TYPE_UNSIGNED_SMALLINT:
+        return *reinterpret_cast<const uint16_t*>(value);
+    case OLAP_FIELD_TYPE_UNSIGNED_INT:
+        return *reinterpret_cast<const uint32_t*>(value);
+    case OLAP_FIELD_TYPE_UNSIGNED_BIGINT:
+    case OLAP_FIELD_TYPE_DATETIME: {
+        uint64_t v = 0;
+        memcpy(&v, value, sizeof(v));
+        return v;
+    }
+    case OLAP_FIELD_TYPE_DATE:
+        return static_cast<uint32_t>(static_cast<int>(*reinterpret_cast<const uint24_t*>(value)));
+    case OLAP_FIELD_TYPE_CHAR:
+    case OLAP_FIELD_TYPE_VARCHAR: {
+        // the first 8 bytes as a big endian number, shorter strings padded
+        // with zeros sort before longer ones with the same bytes
+        const Slice* slice = reinterpret_cast<const Slice*>(value);
+        uint64_t v = 0;
+        for (size_t i = 0; i < sizeof(v); ++i) {
+            v <<= 8;
+            if (i < slice->size) {
+                v |= static_cast<uint8_t>(slice->data[i]);
+            }
+        }
+        return v;
+    }
+    default:
+        return 1;
+    }
+}
+
+OLAPStatus MemTable::_sort_and_flush(ColumnDataWriter* writer) {
+    std::vector<SortEntry> entries;
+    size_t num_rows = 0;
+    for (auto& partition : _partitions) {
+        num_rows += partition->rows.size();
+    }
+    entries.reserve(num_rows);
+    for (auto& partition : _partitions) {
+        for (char* row : partition->rows) {
+            SortEntry entry = {_sort_prefix(row), row, static_cast<uint32_t>(entries.size())};
+            entries.push_back(entry);
+        }
+    }
+
+    // rows of one partition keep their insertion order among equal keys
+    std::sort(entries.begin(), entries.end(),
+              [this](const SortEntry& left, const SortEntry& right) {
+        if (left.prefix != right.prefix) {
+            return left.prefix < right.prefix;
+        }
+        int res = _schema->compare(left.row, right.row);
+        if (res != 0) {
+            return res < 0;
+        }
+        return left.seq < right.seq;
+    });
+
+    Arena* arena = &_partitions[0]->arena;
+    for (size_t i = 0; i < entries.size();) {
+        char* row = entries[i].row;
+        ++i;
+#ifndef BE_TEST
+        if (_keys_type != KeysType::DUP_KEYS) {
+            for (; i < entries.size() && entries[i].prefix == entries[i - 1].prefix
+                    && _schema->compare(entries[i].row, row) == 0; ++i) {
+                _schema->aggregate(row, entries[i].row, arena);
+            }
+        }
+#endif
+
+        _schema->finalize(row);
+        RETURN_NOT_OK(writer->write(row));
+        writer->next(row, _schema);
+    }
     return OLAP_SUCCESS;
 }
 
@@ -18,7 +18,10 @@
 #ifndef DORIS_BE_SRC_OLAP_MEMTABLE_H
 #define DORIS_BE_SRC_OLAP_MEMTABLE_H
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "olap/schema.h"
 #include "olap/skiplist.h"
@@ -29,14 +32,36 @@ namespace doris {
 class ColumnDataWriter;
 class RowCursor;
 
+// Rows are inserted into one of 'num_partitions' skiplists, each with its own
+// lock and arena, so several threads can insert into the same tablet at the
+// same time. The partitions are merged when the memtable is flushed, rows with
+// equal keys from different partitions are aggregated then.
+//
+// With 'sort_on_flush' rows are only appended to a vector of each partition,
+// and all of them are sorted once and aggregated in one pass when flushed.
+// Tables with HLL columns always use the skiplist, an HLL row has to know
+// whether its key was seen before when it is inserted.
+//
+// With 'pre_aggregate_rows' rows of an AGG_KEYS table are first put into a
+// small hash table of each partition, where rows with equal keys are
+// aggregated without searching the skiplist. The distinct rows are inserted
+// into the skiplist once there are 'pre_aggregate_rows' of them, and before
+// the memtable is flushed.
 class MemTable {
 public:
     MemTable(Schema* schema, std::vector<FieldInfo>* field_infos,
              std::vector<uint32_t>* col_ids, TupleDescriptor* tuple_desc,
-             KeysType keys_type);
+             KeysType keys_type, size_t num_partitions = 1, bool sort_on_flush = false,
+             size_t pre_aggregate_rows = 0);
     ~MemTable();
     size_t memory_usage();
-    void insert(Tuple* tuple);
+    // Thread safe. Rows inserted into the same partition keep their order,
+    // which matters for REPLACE columns.
+    void insert(Tuple* tuple, uint32_t partition = 0);
+    // Same as inserting the tuples one by one, but the partition is locked
+    // once and the tuples are converted one column after the other. Tables
+    // with HLL columns still convert them one by one.
+    void insert_batch(const std::vector<Tuple*>& tuples, uint32_t partition = 0);
     OLAPStatus flush(ColumnDataWriter* writer);
     OLAPStatus close(ColumnDataWriter* writer);
 private:
@@ -53,12 +78,57 @@ private:
     };
 
     RowCursorComparator _row_comparator;
-    Arena _arena;
 
     typedef SkipList<char*, RowCursorComparator> Table;
-    char* _tuple_buf;
+
+    struct Partition {
+        Partition(const RowCursorComparator& comparator, size_t schema_size,
+                  bool sort_on_flush, size_t pre_aggregate_slots);
+        ~Partition();
+
+        std::mutex lock;
+        Arena arena;
+        // NULL with sort_on_flush
+        Table* skip_list;
+        // rows in insertion order, only used with sort_on_flush
+        std::vector<char*> rows;
+        // memory held by 'rows', read by memory_usage() of other threads
+        std::atomic<size_t> rows_usage;
+        // open addressing hash table of rows not yet in the skiplist, its
+        // size is a power of two, empty without pre aggregation
+        std::vector<char*> pre_agg_slots;
+        size_t num_pre_agg_rows;
+        // rows aggregated into others, reused for the next ones
+        std::vector<char*> free_rows;
+        char* tuple_buf;
+    };
+
+    // A row to be sorted on flush, 'prefix' orders rows by the first key
+    // column without touching the row as far as it can
+    struct SortEntry {
+        uint64_t prefix;
+        char* row;
+        uint32_t seq;
+    };
+
+    void _insert(Partition* partition, Tuple* tuple);
+    void _insert_batch(Partition* partition, const std::vector<Tuple*>& tuples);
+    char* _new_row(Partition* partition);
+    void _convert_column(Partition* partition, size_t index, const SlotDescriptor* slot,
+                         Tuple* tuple, char* row);
+    // returns false if 'row' was aggregated into another row and can be reused
+    bool _add_row(Partition* partition, char* row);
+    bool _pre_aggregate(Partition* partition, char* row);
+    void _flush_pre_aggregated(Partition* partition);
+    OLAPStatus _merge_partitions(ColumnDataWriter* writer);
+    OLAPStatus _sort_and_flush(ColumnDataWriter* writer);
+    uint64_t _sort_prefix(const char* row) const;
+
+    bool _sort_on_flush;
+    size_t _pre_aggregate_rows;
+    bool _has_hll;
     size_t _schema_size;
-    Table* _skip_list;
+    std::vector<std::unique_ptr<Partition>> _partitions;
 }; // class MemTable
 
 } // namespace doris
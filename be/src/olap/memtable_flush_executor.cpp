@@ -0,0 +1,104 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/memtable_flush_executor.h"
+
+#include <boost/bind.hpp>
+
+#include "common/logging.h"
+#include "olap/data_writer.h"
+#include "olap/memtable.h"
+#include "runtime/mem_tracker.h"
+
+namespace doris {
+
+void FlushHandler::on_submit() {
+    std::lock_guard<std::mutex> l(_lock);
+    ++_pending;
+}
+
+void FlushHandler::on_flushed(OLAPStatus status) {
+    std::lock_guard<std::mutex> l(_lock);
+    if (status != OLAP_SUCCESS && _status == OLAP_SUCCESS) {
+        _status = status;
+    }
+    if (--_pending == 0) {
+        _cv.notify_all();
+    }
+}
+
+OLAPStatus FlushHandler::wait() {
+    std::unique_lock<std::mutex> l(_lock);
+    while (_pending > 0) {
+        _cv.wait(l);
+    }
+    return _status;
+}
+
+OLAPStatus FlushHandler::status() {
+    std::lock_guard<std::mutex> l(_lock);
+    return _status;
+}
+
+MemTableFlushExecutor::MemTableFlushExecutor(uint32_t num_threads, uint32_t queue_size)
+        : _pool(num_threads, queue_size) {
+}
+
+MemTableFlushExecutor::~MemTableFlushExecutor() {
+    _pool.drain_and_shutdown();
+}
+
+void MemTableFlushExecutor::submit(FlushHandler* handler, MemTable* mem_table,
+                                   ColumnDataWriter* writer, MemTracker* mem_tracker,
+                                   const TraceContext& trace_context) {
+    int64_t bytes = mem_table->memory_usage();
+    if (mem_tracker != nullptr) {
+        mem_tracker->consume(bytes);
+    }
+    handler->on_submit();
+    int64_t submit_ns = trace_context.sampled ? Tracer::now_ns() : 0;
+    if (!_pool.offer(boost::bind<void>(&MemTableFlushExecutor::_flush, this,
+                                       handler, mem_table, writer, mem_tracker, bytes,
+                                       trace_context, submit_ns))) {
+        // the pool is shutting down
+        _flush(handler, mem_table, writer, mem_tracker, bytes, trace_context, submit_ns);
+    }
+}
+
+void MemTableFlushExecutor::_flush(FlushHandler* handler, MemTable* mem_table,
+                                   ColumnDataWriter* writer, MemTracker* mem_tracker,
+                                   int64_t bytes, TraceContext trace_context,
+                                   int64_t submit_ns) {
+    Span span(trace_context, "memtable_flush", submit_ns);
+    span.add_attribute("bytes", bytes);
+    if (span.sampled()) {
+        span.add_attribute("queue_wait_us", (Tracer::now_ns() - submit_ns) / 1000);
+    }
+    OLAPStatus res = mem_table->flush(writer);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to flush memtable. res=" << res;
+        span.set_status(Status("fail to flush memtable"));
+    }
+    delete writer;
+    delete mem_table;
+    if (mem_tracker != nullptr) {
+        mem_tracker->release(bytes);
+    }
+    handler->on_flushed(res);
+}
+
+}  // namespace doris
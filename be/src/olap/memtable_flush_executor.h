@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_MEMTABLE_FLUSH_EXECUTOR_H
+#define DORIS_BE_SRC_OLAP_MEMTABLE_FLUSH_EXECUTOR_H
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+
+#include "olap/olap_define.h"
+#include "runtime/tracer.h"
+#include "util/thread_pool.hpp"
+
+namespace doris {
+
+class ColumnDataWriter;
+class MemTable;
+class MemTracker;
+
+// The flushes of the memtables of one DeltaWriter. Counts the flushes that
+// are submitted and not finished yet and keeps the first error.
+class FlushHandler {
+public:
+    FlushHandler() : _pending(0), _status(OLAP_SUCCESS) {}
+
+    void on_submit();
+    void on_flushed(OLAPStatus status);
+
+    // Waits for all submitted flushes, returns the first error
+    OLAPStatus wait();
+
+    // The first error of the flushes finished so far
+    OLAPStatus status();
+
+private:
+    std::mutex _lock;
+    std::condition_variable _cv;
+    int _pending;
+    OLAPStatus _status;
+
+    DISALLOW_COPY_AND_ASSIGN(FlushHandler);
+};
+
+// Threads writing full memtables of one store into segment groups, so a
+// DeltaWriter can go on with a new memtable while the old one is encoded,
+// compressed and written. At most 'queue_size' memtables wait for a thread,
+// submit() blocks once the queue is full.
+class MemTableFlushExecutor {
+public:
+    MemTableFlushExecutor(uint32_t num_threads, uint32_t queue_size);
+    ~MemTableFlushExecutor();
+
+    // Flushes 'mem_table' through 'writer' and deletes both. The memory of the
+    // memtable is consumed from 'mem_tracker' until it is written. The flush is
+    // traced as a child of 'trace_context' from its submit.
+    void submit(FlushHandler* handler, MemTable* mem_table, ColumnDataWriter* writer,
+                MemTracker* mem_tracker, const TraceContext& trace_context = TraceContext());
+
+private:
+    void _flush(FlushHandler* handler, MemTable* mem_table, ColumnDataWriter* writer,
+                MemTracker* mem_tracker, int64_t bytes, TraceContext trace_context,
+                int64_t submit_ns);
+
+    ThreadPool _pool;
+
+    DISALLOW_COPY_AND_ASSIGN(MemTableFlushExecutor);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_MEMTABLE_FLUSH_EXECUTOR_H
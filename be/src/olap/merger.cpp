@@ -17,10 +17,20 @@
 
 #include "olap/merger.h"
 
+#include <fcntl.h>
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <algorithm>
 #include <memory>
+#include <sstream>
+#include <string>
 #include <vector>
 
+#include "common/config.h"
 #include "olap/column_data.h"
+#include "olap/file_helper.h"
 #include "olap/olap_define.h"
 #include "olap/segment_group.h"
 #include "olap/olap_table.h"
@@ -43,6 +53,15 @@ Merger::Merger(OLAPTablePtr table, SegmentGroup* segment_group, ReaderType type)
 
 OLAPStatus Merger::merge(const vector<ColumnData*>& olap_data_arr,
                          uint64_t* merged_rows, uint64_t* filted_rows) {
+    vector<vector<uint32_t>> column_groups;
+    if (_split_column_groups(&column_groups)) {
+        return _merge_vertically(olap_data_arr, merged_rows, filted_rows);
+    }
+    return _merge_rows(olap_data_arr, merged_rows, filted_rows);
+}
+
+OLAPStatus Merger::_merge_rows(const vector<ColumnData*>& olap_data_arr,
+                               uint64_t* merged_rows, uint64_t* filted_rows) {
     // Create and initiate reader for scanning and multi-merging specified
     // OLAPDatas.
     Reader reader;
@@ -125,4 +144,278 @@ OLAPStatus Merger::merge(const vector<ColumnData*>& olap_data_arr,
     return has_error ? OLAP_ERR_OTHER_ERROR : OLAP_SUCCESS;
 }
 
+namespace {
+
+// 列组合并中一组列的合并结果, 按合并后的行序保存在临时文件里.
+// 每列依次为null标记和值, 字符串类型的值为4字节长度加内容
+class ColumnGroupFile {
+public:
+    ColumnGroupFile(const std::string& path, const vector<FieldInfo>& tablet_schema,
+                    const vector<uint32_t>& columns)
+            : _path(path), _tablet_schema(tablet_schema), _columns(columns),
+            _num_rows(0), _buf_pos(0), _buf_len(0), _file_offset(0), _opened(false) {}
+
+    ~ColumnGroupFile() {
+        if (_opened) {
+            _file.close();
+            remove(_path.c_str());
+        }
+    }
+
+    OLAPStatus open() {
+        OLAPStatus res = _file.open_with_mode(_path, O_CREAT | O_TRUNC | O_RDWR,
+                                              S_IRUSR | S_IWUSR);
+        if (res == OLAP_SUCCESS) {
+            _opened = true;
+        }
+        return res;
+    }
+
+    OLAPStatus append(const RowCursor& row) {
+        for (uint32_t cid : _columns) {
+            bool is_null = row.is_null(cid);
+            _buf.append(reinterpret_cast<const char*>(&is_null), sizeof(is_null));
+            if (is_null) {
+                continue;
+            }
+            const char* content = row.get_field_content_ptr(cid);
+            if (_is_slice(cid)) {
+                const Slice* slice = reinterpret_cast<const Slice*>(content);
+                uint32_t size = slice->size;
+                _buf.append(reinterpret_cast<const char*>(&size), sizeof(size));
+                _buf.append(slice->data, size);
+            } else {
+                _buf.append(content, row.get_field_by_index(cid)->size());
+            }
+        }
+        ++_num_rows;
+        if (_buf.size() >= BUFFER_SIZE) {
+            return _flush();
+        }
+        return OLAP_SUCCESS;
+    }
+
+    // 写完之后调用, 之后可以从头读
+    OLAPStatus finish() {
+        RETURN_NOT_OK(_flush());
+        _file_offset = 0;
+        return OLAP_SUCCESS;
+    }
+
+    // 读下一行的各列到row, 字符串的内容拷贝到mem_pool中
+    OLAPStatus read(RowCursor* row, MemPool* mem_pool) {
+        for (uint32_t cid : _columns) {
+            bool is_null = false;
+            RETURN_NOT_OK(_read(reinterpret_cast<char*>(&is_null), sizeof(is_null)));
+            if (is_null) {
+                row->set_null(cid);
+                continue;
+            }
+            row->set_not_null(cid);
+            if (_is_slice(cid)) {
+                uint32_t size = 0;
+                RETURN_NOT_OK(_read(reinterpret_cast<char*>(&size), sizeof(size)));
+                _value.resize(size);
+                RETURN_NOT_OK(_read(&_value[0], size));
+                Slice slice(_value.data(), size);
+                row->set_field_content(cid, reinterpret_cast<const char*>(&slice), mem_pool);
+            } else {
+                size_t size = row->get_field_by_index(cid)->size();
+                _value.resize(size);
+                RETURN_NOT_OK(_read(&_value[0], size));
+                row->set_field_content(cid, _value.data(), mem_pool);
+            }
+        }
+        return OLAP_SUCCESS;
+    }
+
+    uint64_t num_rows() const {
+        return _num_rows;
+    }
+
+private:
+    static const size_t BUFFER_SIZE = 1024 * 1024;
+
+    bool _is_slice(uint32_t cid) const {
+        FieldType type = _tablet_schema[cid].type;
+        return type == OLAP_FIELD_TYPE_CHAR || type == OLAP_FIELD_TYPE_VARCHAR
+                || type == OLAP_FIELD_TYPE_HLL;
+    }
+
+    OLAPStatus _flush() {
+        if (!_buf.empty()) {
+            RETURN_NOT_OK(_file.write(_buf.data(), _buf.size()));
+            _file_offset += _buf.size();
+            _buf.clear();
+        }
+        return OLAP_SUCCESS;
+    }
+
+    OLAPStatus _read(char* dest, size_t size) {
+        while (size > 0) {
+            if (_buf_pos == _buf_len) {
+                _buf.resize(BUFFER_SIZE);
+                size_t length = std::min(BUFFER_SIZE,
+                                         static_cast<size_t>(_file.length()) - _file_offset);
+                if (length == 0) {
+                    OLAP_LOG_WARNING("column group file ends early. [file='%s']", _path.c_str());
+                    return OLAP_ERR_IO_ERROR;
+                }
+                RETURN_NOT_OK(_file.pread(&_buf[0], length, _file_offset));
+                _file_offset += length;
+                _buf_pos = 0;
+                _buf_len = length;
+            }
+            size_t copy_size = std::min(size, _buf_len - _buf_pos);
+            memcpy(dest, _buf.data() + _buf_pos, copy_size);
+            _buf_pos += copy_size;
+            dest += copy_size;
+            size -= copy_size;
+        }
+        return OLAP_SUCCESS;
+    }
+
+    std::string _path;
+    const vector<FieldInfo>& _tablet_schema;
+    vector<uint32_t> _columns;
+    uint64_t _num_rows;
+
+    FileHandler _file;
+    std::string _buf;
+    size_t _buf_pos;
+    size_t _buf_len;
+    size_t _file_offset;
+    std::string _value;
+    bool _opened;
+};
+
+}  // namespace
+
+bool Merger::_split_column_groups(vector<vector<uint32_t>>* column_groups) const {
+    const vector<FieldInfo>& tablet_schema = _table->tablet_schema();
+    if (config::vertical_compaction_min_columns <= 0
+            || tablet_schema.size() < static_cast<size_t>(config::vertical_compaction_min_columns)) {
+        return false;
+    }
+    size_t columns_per_group = std::max(config::vertical_compaction_columns_per_group, 1);
+    column_groups->clear();
+    for (uint32_t cid = 0; cid < tablet_schema.size(); ++cid) {
+        if (tablet_schema[cid].is_key) {
+            continue;
+        }
+        if (column_groups->empty() || column_groups->back().size() == columns_per_group) {
+            column_groups->emplace_back();
+        }
+        column_groups->back().push_back(cid);
+    }
+    return column_groups->size() > 1;
+}
+
+OLAPStatus Merger::_merge_vertically(const vector<ColumnData*>& olap_data_arr,
+                                     uint64_t* merged_rows, uint64_t* filted_rows) {
+    const vector<FieldInfo>& tablet_schema = _table->tablet_schema();
+    vector<vector<uint32_t>> column_groups;
+    _split_column_groups(&column_groups);
+    vector<uint32_t> key_columns;
+    for (uint32_t cid = 0; cid < tablet_schema.size(); ++cid) {
+        if (tablet_schema[cid].is_key) {
+            key_columns.push_back(cid);
+        }
+    }
+    LOG(INFO) << "merge vertically. table=" << _table->full_name()
+              << ", column_groups=" << column_groups.size();
+
+    // 1. 依次合并每组列, 第一组同时保存key列
+    vector<unique_ptr<ColumnGroupFile>> group_files;
+    for (size_t i = 0; i < column_groups.size(); ++i) {
+        Reader reader;
+        ReaderParams reader_params;
+        reader_params.olap_table = _table;
+        reader_params.reader_type = _reader_type;
+        reader_params.olap_data_arr = olap_data_arr;
+        reader_params.return_columns = key_columns;
+        reader_params.return_columns.insert(reader_params.return_columns.end(),
+                                            column_groups[i].begin(), column_groups[i].end());
+        if (_reader_type == READER_BASE_COMPACTION) {
+            reader_params.version = _segment_group->version();
+        }
+        if (OLAP_SUCCESS != reader.init(reader_params)) {
+            OLAP_LOG_WARNING("fail to initiate reader. [table='%s']",
+                    _table->full_name().c_str());
+            return OLAP_ERR_INIT_FAILED;
+        }
+
+        // 读出的行包含reader所有的返回列, 比如delete条件用到的列
+        RowCursor row_cursor;
+        if (OLAP_SUCCESS != row_cursor.init(tablet_schema, reader.return_columns())
+                || OLAP_SUCCESS != row_cursor.allocate_memory_for_string_type(tablet_schema)) {
+            OLAP_LOG_WARNING("fail to init row cursor.");
+            return OLAP_ERR_INIT_FAILED;
+        }
+
+        vector<uint32_t> columns = i == 0 ? reader_params.return_columns : column_groups[i];
+        std::stringstream path;
+        path << _table->tablet_path() << "/vertical_compaction_"
+             << _segment_group->version().first << "_" << _segment_group->version().second
+             << "_" << i << ".tmp";
+        group_files.emplace_back(new ColumnGroupFile(path.str(), tablet_schema, columns));
+        ColumnGroupFile* group_file = group_files.back().get();
+        RETURN_NOT_OK(group_file->open());
+
+        while (true) {
+            bool eof = false;
+            OLAPStatus res = reader.next_row_with_aggregation(&row_cursor, &eof);
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("reader read failed.");
+                return OLAP_ERR_OTHER_ERROR;
+            } else if (eof) {
+                break;
+            }
+            RETURN_NOT_OK(group_file->append(row_cursor));
+        }
+        RETURN_NOT_OK(group_file->finish());
+
+        if (group_file->num_rows() != group_files[0]->num_rows()) {
+            LOG(WARNING) << "column groups have different rows. group_0=" << group_files[0]->num_rows()
+                         << ", group_" << i << "=" << group_file->num_rows();
+            return OLAP_ERR_CHECK_LINES_ERROR;
+        }
+        if (i == 0) {
+            *merged_rows = reader.merged_rows();
+            *filted_rows = reader.filted_rows();
+        }
+    }
+
+    // 2. 从各组的临时文件拼出完整的行
+    unique_ptr<ColumnDataWriter> writer(ColumnDataWriter::create(_table, _segment_group, false));
+    if (NULL == writer) {
+        OLAP_LOG_WARNING("fail to allocate writer.");
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+    RowCursor row_cursor;
+    if (OLAP_SUCCESS != row_cursor.init(tablet_schema)) {
+        OLAP_LOG_WARNING("fail to init row cursor.");
+        return OLAP_ERR_INIT_FAILED;
+    }
+    for (uint64_t row = 0; row < group_files[0]->num_rows(); ++row) {
+        if (OLAP_SUCCESS != writer->attached_by(&row_cursor)) {
+            OLAP_LOG_WARNING("attach row failed. [table='%s']",
+                    _table->full_name().c_str());
+            return OLAP_ERR_OTHER_ERROR;
+        }
+        for (auto& group_file : group_files) {
+            RETURN_NOT_OK(group_file->read(&row_cursor, writer->mem_pool()));
+        }
+        writer->next(row_cursor);
+        ++_row_count;
+    }
+
+    if (OLAP_SUCCESS != writer->finalize()) {
+        OLAP_LOG_WARNING("fail to finalize writer. [table='%s']",
+                _table->full_name().c_str());
+        return OLAP_ERR_OTHER_ERROR;
+    }
+    return OLAP_SUCCESS;
+}
+
 }  // namespace doris
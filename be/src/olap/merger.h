@@ -44,6 +44,19 @@ public:
         return _row_count;
     }
 private:
+    // 一次读出并写入完整的行
+    OLAPStatus _merge_rows(const std::vector<ColumnData*>& olap_data_arr,
+                           uint64_t* merged_rows, uint64_t* filted_rows);
+
+    // 宽表按列组合并: 每次只读key列和一组value列, 合并结果按行序存入临时文件,
+    // 最后再从各组的临时文件拼出完整的行写入新的segment group.
+    // 每次合并的key相同, 所以各组合并出的行序也相同
+    OLAPStatus _merge_vertically(const std::vector<ColumnData*>& olap_data_arr,
+                                 uint64_t* merged_rows, uint64_t* filted_rows);
+
+    // 需要按列组合并时返回true, column_groups为每组要读的value列
+    bool _split_column_groups(std::vector<std::vector<uint32_t>>* column_groups) const;
+
     OLAPTablePtr _table;
     SegmentGroup* _segment_group;
     ReaderType _reader_type;
@@ -0,0 +1,137 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/ngram_index_reader.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <set>
+
+#include "olap/ngram_index_writer.h"
+#include "olap/utils.h"
+
+namespace doris {
+
+NgramIndexReader::~NgramIndexReader() {
+    if (!_is_using_cache) {
+        SAFE_DELETE_ARRAY(_buffer);
+    }
+}
+
+OLAPStatus NgramIndexReader::init(char* buffer, size_t buffer_size, bool is_using_cache) {
+    _buffer = buffer;
+    _is_using_cache = is_using_cache;
+    _entries.clear();
+
+    const char* ptr = buffer;
+    const char* end = buffer + buffer_size;
+    uint32_t num_grams = 0;
+    if (buffer_size < sizeof(num_grams)) {
+        OLAP_LOG_WARNING("invalid ngram index. [buffer_size=%lu]", buffer_size);
+        return OLAP_ERR_FILE_FORMAT_ERROR;
+    }
+    memcpy(&num_grams, ptr, sizeof(num_grams));
+    ptr += sizeof(num_grams);
+
+    _entries.resize(num_grams);
+    for (auto& entry : _entries) {
+        uint32_t size = 0;
+        if (end - ptr < static_cast<ptrdiff_t>(sizeof(entry.gram) + sizeof(size))) {
+            OLAP_LOG_WARNING("invalid ngram index. [buffer_size=%lu num_grams=%u]",
+                             buffer_size, num_grams);
+            return OLAP_ERR_FILE_FORMAT_ERROR;
+        }
+        memcpy(&entry.gram, ptr, sizeof(entry.gram));
+        ptr += sizeof(entry.gram);
+        memcpy(&size, ptr, sizeof(size));
+        ptr += sizeof(size);
+        if (end - ptr < static_cast<ptrdiff_t>(size)) {
+            OLAP_LOG_WARNING("invalid ngram index. [buffer_size=%lu num_grams=%u]",
+                             buffer_size, num_grams);
+            return OLAP_ERR_FILE_FORMAT_ERROR;
+        }
+        entry.bitmap = Slice(ptr, size);
+        ptr += size;
+    }
+    return OLAP_SUCCESS;
+}
+
+void NgramIndexReader::like_literals(const std::string& pattern,
+                                     std::vector<std::string>* literals) {
+    literals->clear();
+    std::string literal;
+    bool is_escaped = false;
+    for (char c : pattern) {
+        if (!is_escaped && (c == '%' || c == '_')) {
+            if (!literal.empty()) {
+                literals->push_back(std::move(literal));
+                literal.clear();
+            }
+        } else if (!is_escaped && c == '\\') {
+            is_escaped = true;
+        } else {
+            literal.push_back(c);
+            is_escaped = false;
+        }
+    }
+    if (!literal.empty()) {
+        literals->push_back(std::move(literal));
+    }
+}
+
+bool NgramIndexReader::match_like(const std::string& pattern, RoaringBitmap* rows) const {
+    std::vector<std::string> literals;
+    like_literals(pattern, &literals);
+    std::set<uint32_t> grams;
+    for (auto& literal : literals) {
+        for (size_t i = 0; i + NgramIndexWriter::GRAM_SIZE <= literal.size(); ++i) {
+            grams.insert(NgramIndexWriter::gram_of(literal.data() + i));
+        }
+    }
+    if (grams.empty()) {
+        return false;
+    }
+
+    RoaringBitmap result;
+    bool first = true;
+    for (uint32_t gram : grams) {
+        auto it = std::lower_bound(_entries.begin(), _entries.end(), gram,
+                [](const Entry& entry, uint32_t gram) { return entry.gram < gram; });
+        if (it == _entries.end() || it->gram != gram) {
+            // no row holds this gram
+            *rows = RoaringBitmap();
+            return true;
+        }
+        RoaringBitmap gram_rows;
+        if (!gram_rows.deserialize(it->bitmap.data, it->bitmap.size)) {
+            OLAP_LOG_WARNING("invalid bitmap in ngram index. [size=%lu]", it->bitmap.size);
+            return false;
+        }
+        if (first) {
+            result = std::move(gram_rows);
+            first = false;
+        } else {
+            result.intersect_with(gram_rows);
+        }
+    }
+    *rows = std::move(result);
+    return true;
+}
+
+} // namespace doris
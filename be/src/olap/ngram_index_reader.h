@@ -0,0 +1,67 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_NGRAM_INDEX_READER_H
+#define DORIS_BE_SRC_OLAP_NGRAM_INDEX_READER_H
+
+#include <string>
+#include <vector>
+
+#include "olap/olap_define.h"
+#include "util/roaring_bitmap.h"
+#include "util/slice.h"
+
+namespace doris {
+
+// Reads the ngram index of a string column of one segment written by
+// NgramIndexWriter. Bitmaps are only decoded when they are looked up.
+class NgramIndexReader {
+public:
+    NgramIndexReader() {}
+    ~NgramIndexReader();
+
+    // 'buffer' is released by this reader unless it is cached
+    OLAPStatus init(char* buffer, size_t buffer_size, bool is_using_cache);
+
+    // Sets 'rows' to the rows which may match the LIKE 'pattern', the ones
+    // holding all the grams of its literal parts. Returns false if the index
+    // can not tell, when no literal part is as long as a gram.
+    bool match_like(const std::string& pattern, RoaringBitmap* rows) const;
+
+    size_t num_grams() const {
+        return _entries.size();
+    }
+
+    // Splits a LIKE pattern into its literal parts, between the wildcards '%'
+    // and '_', with the escapes by '\' removed.
+    static void like_literals(const std::string& pattern, std::vector<std::string>* literals);
+
+private:
+    struct Entry {
+        uint32_t gram;
+        Slice bitmap;
+    };
+
+    char* _buffer = nullptr;
+    bool _is_using_cache = false;
+    // in ascending order of the grams
+    std::vector<Entry> _entries;
+};
+
+} // namespace doris
+#endif // DORIS_BE_SRC_OLAP_NGRAM_INDEX_READER_H
@@ -0,0 +1,92 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/ngram_index_writer.h"
+
+#include "olap/out_stream.h"
+#include "olap/utils.h"
+
+namespace doris {
+
+void NgramIndexWriter::add(const char* value, size_t size, uint32_t row) {
+    if (_overflow) {
+        return;
+    }
+    for (size_t i = 0; i + GRAM_SIZE <= size; ++i) {
+        uint32_t gram = gram_of(value + i);
+        auto it = _grams.find(gram);
+        if (it == _grams.end()) {
+            if (_grams.size() >= _max_grams) {
+                _overflow = true;
+                _grams.clear();
+                return;
+            }
+            it = _grams.emplace(gram, RoaringBitmap()).first;
+        }
+        // a gram repeated in the value adds the row again, which changes nothing
+        it->second.add(row);
+    }
+}
+
+uint64_t NgramIndexWriter::estimate_buffered_memory() const {
+    uint64_t size = sizeof(uint32_t);
+    for (auto& it : _grams) {
+        size += 2 * sizeof(uint32_t) + it.second.serialized_size();
+    }
+    return size;
+}
+
+OLAPStatus NgramIndexWriter::write_to_buffer(std::string* buffer) {
+    if (_overflow) {
+        OLAP_LOG_WARNING("ngram index has too many grams");
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+    buffer->clear();
+    buffer->reserve(estimate_buffered_memory());
+
+    uint32_t num_grams = _grams.size();
+    buffer->append(reinterpret_cast<const char*>(&num_grams), sizeof(num_grams));
+    for (auto& it : _grams) {
+        buffer->append(reinterpret_cast<const char*>(&it.first), sizeof(it.first));
+        uint32_t size = it.second.serialized_size();
+        buffer->append(reinterpret_cast<const char*>(&size), sizeof(size));
+        size_t offset = buffer->size();
+        buffer->resize(offset + size);
+        it.second.serialize(&(*buffer)[offset]);
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus NgramIndexWriter::write_to_buffer(OutStream* out_stream) {
+    if (NULL == out_stream) {
+        OLAP_LOG_WARNING("out stream is NULL");
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+    std::string buffer;
+    OLAPStatus res = write_to_buffer(&buffer);
+    if (OLAP_SUCCESS != res) {
+        return res;
+    }
+    res = out_stream->write(buffer.data(), buffer.size());
+    if (OLAP_SUCCESS != res) {
+        OLAP_LOG_WARNING("write ngram index fail");
+    }
+    return res;
+}
+
+} // namespace doris
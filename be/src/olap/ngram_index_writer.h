@@ -0,0 +1,72 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_NGRAM_INDEX_WRITER_H
+#define DORIS_BE_SRC_OLAP_NGRAM_INDEX_WRITER_H
+
+#include <map>
+#include <string>
+
+#include "olap/olap_define.h"
+#include "util/roaring_bitmap.h"
+
+namespace doris {
+
+class OutStream;
+
+// Builds the ngram index of a string column of one segment: every sequence of
+// GRAM_SIZE bytes found in the values with the bitmap of the rows holding it.
+// A row holding a string holds all its grams, so a LIKE pattern can only match
+// the rows holding all the grams of its literal parts, see NgramIndexReader.
+//
+// The index is: the number of grams (4 bytes), then for each gram in ascending
+// order the gram (4 bytes, its bytes from the high ones down), the size of its
+// bitmap (4 bytes) and the bitmap.
+class NgramIndexWriter {
+public:
+    static const size_t GRAM_SIZE = 3;
+
+    // grams past 'max_grams' drop the index, see is_valid
+    explicit NgramIndexWriter(uint32_t max_grams) : _max_grams(max_grams) {}
+
+    // rows must be added in ascending order, null rows are not added
+    void add(const char* value, size_t size, uint32_t row);
+
+    // false if the column has too many grams to be indexed
+    bool is_valid() const {
+        return !_overflow;
+    }
+
+    uint64_t estimate_buffered_memory() const;
+    OLAPStatus write_to_buffer(OutStream* out_stream);
+    OLAPStatus write_to_buffer(std::string* buffer);
+
+    static uint32_t gram_of(const char* data) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+        return (static_cast<uint32_t>(bytes[0]) << 16)
+                | (static_cast<uint32_t>(bytes[1]) << 8) | bytes[2];
+    }
+
+private:
+    uint32_t _max_grams;
+    bool _overflow = false;
+    std::map<uint32_t, RoaringBitmap> _grams;
+};
+
+} // namespace doris
+#endif // DORIS_BE_SRC_OLAP_NGRAM_INDEX_WRITER_H
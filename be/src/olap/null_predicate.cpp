@@ -17,6 +17,7 @@
 
 #include "olap/field.h"
 #include "olap/null_predicate.h"
+#include "olap/simd_predicate.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
 
@@ -49,9 +50,11 @@ void NullPredicate::evaluate(VectorizedRowBatch* batch) const {
         }
         batch->set_size(new_size);
     } else {
-        for (uint16_t i = 0; i != n; ++i) {
-            sel[new_size] = i;
-            new_size += (null_array[i] == _is_null);
+        if (!simd_predicate::null_select(null_array, _is_null, n, sel, &new_size)) {
+            for (uint16_t i = 0; i != n; ++i) {
+                sel[new_size] = i;
+                new_size += (null_array[i] == _is_null);
+            }
         }
         if (new_size < n) {
             batch->set_size(new_size);
@@ -31,6 +31,7 @@ public:
     virtual ~NullPredicate();
 
     virtual void evaluate(VectorizedRowBatch* batch) const override;
+    virtual int32_t column_id() const override { return _column_id; }
 private:
     int32_t _column_id;
     bool _is_null; //true for null, false for not null
@@ -117,7 +117,8 @@ enum FieldAggregationMethod {
     OLAP_FIELD_AGGREGATION_MAX = 3,
     OLAP_FIELD_AGGREGATION_REPLACE = 4,
     OLAP_FIELD_AGGREGATION_HLL_UNION = 5,
-    OLAP_FIELD_AGGREGATION_UNKNOWN = 6
+    OLAP_FIELD_AGGREGATION_UNKNOWN = 6,
+    OLAP_FIELD_AGGREGATION_BITMAP_UNION = 7
 };
 
 // 压缩算法类型
@@ -179,9 +180,10 @@ using KeyRange = std::pair<WrapperField*, WrapperField*>;
 struct SegmentGroupEntity {
     SegmentGroupEntity(int32_t segment_group_id, int32_t num_segments,
                 int64_t num_rows, size_t data_size, size_t index_size,
-                bool empty, const std::vector<KeyRange>* column_statistics)
+                bool empty, const std::vector<KeyRange>* column_statistics,
+                bool packed = false)
         : segment_group_id(segment_group_id), num_segments(num_segments), num_rows(num_rows),
-          data_size(data_size), index_size(index_size), empty(empty)
+          data_size(data_size), index_size(index_size), empty(empty), packed(packed)
     {
         if (column_statistics != nullptr) {
             key_ranges = *column_statistics;
@@ -194,6 +196,8 @@ struct SegmentGroupEntity {
     size_t data_size;
     size_t index_size;
     bool empty;
+    // the segments are in one packed file
+    bool packed;
     std::vector<KeyRange> key_ranges;
 };
 
@@ -216,6 +220,8 @@ struct OlapReaderStatistics {
 
     int64_t decompress_ns = 0;
     int64_t uncompressed_bytes_read = 0;
+    // data stream chunks served by the data page cache
+    int64_t data_page_cache_hits = 0;
 
     int64_t bytes_read = 0;
 
@@ -229,9 +235,19 @@ struct OlapReaderStatistics {
 
     int64_t rows_vec_cond_filtered = 0;
     int64_t vec_cond_ns = 0;
+    // column values left undecoded because no later row of the block passed predicates
+    int64_t lazy_read_skipped_values = 0;
 
     int64_t rows_stats_filtered = 0;
     int64_t rows_del_filtered = 0;
+    // rows of merge-on-write tables replaced by newer rows of their keys
+    int64_t rows_replaced_filtered = 0;
+    // rows of blocks read which the bitmap or ngram indexes tell fail the conditions
+    int64_t rows_bitmap_index_filtered = 0;
+    // rows read from the pre-aggregates of segment groups in place of their segments
+    int64_t pre_aggregate_rows_read = 0;
+    // rows of data sources whose pushed aggregate is answered from their metadata
+    int64_t metadata_rows_answered = 0;
 
     int64_t index_load_ns = 0;
 };
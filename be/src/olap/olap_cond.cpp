@@ -22,6 +22,7 @@
 #include <utility>
 #include <thrift/protocol/TDebugProtocol.h>
 
+#include "olap/bitmap_index_reader.h"
 #include "olap/olap_define.h"
 #include "olap/utils.h"
 #include "olap/wrapper_field.h"
@@ -465,6 +466,46 @@ bool Cond::eval(const BloomFilter& bf) const {
     return false;
 }
 
+static bool lookup_field(const BitmapIndexReader& index, const WrapperField* field,
+                         RoaringBitmap* rows) {
+    if (field->is_string_type()) {
+        Slice* slice = (Slice*)(field->ptr());
+        return index.lookup(slice->data, slice->size, rows) == OLAP_SUCCESS;
+    }
+    return index.lookup(field->ptr(), field->size(), rows) == OLAP_SUCCESS;
+}
+
+bool Cond::eval(const BitmapIndexReader& index, RoaringBitmap* rows) const {
+    RoaringBitmap result;
+    switch (op) {
+    case OP_EQ: {
+        if (!lookup_field(index, operand_field, &result)) {
+            return false;
+        }
+        break;
+    }
+    case OP_IN: {
+        for (const WrapperField* field : operand_set) {
+            if (!lookup_field(index, field, &result)) {
+                return false;
+            }
+        }
+        break;
+    }
+    case OP_IS: {
+        // IS NOT NULL holds for most rows, the index is not worth reading
+        if (!operand_field->is_null() || index.lookup_null(&result) != OLAP_SUCCESS) {
+            return false;
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+    *rows = std::move(result);
+    return true;
+}
+
 CondColumn::~CondColumn() {
     for (auto& it : _conds) {
         delete it;
@@ -554,6 +595,23 @@ bool CondColumn::eval(const BloomFilter& bf) const {
     return true;
 }
 
+bool CondColumn::eval(const BitmapIndexReader& index, RoaringBitmap* rows) const {
+    bool evaluated = false;
+    for (auto& each_cond : _conds) {
+        RoaringBitmap cond_rows;
+        if (!each_cond->eval(index, &cond_rows)) {
+            continue;
+        }
+        if (evaluated) {
+            rows->intersect_with(cond_rows);
+        } else {
+            *rows = std::move(cond_rows);
+            evaluated = true;
+        }
+    }
+    return evaluated;
+}
+
 OLAPStatus Conditions::append_condition(const TCondition& tcond) {
     int32_t index = _table->get_field_index(tcond.column_name);
     if (index < 0) {
@@ -581,6 +639,21 @@ OLAPStatus Conditions::append_condition(const TCondition& tcond) {
     return cond_col->add_cond(tcond, fi);
 }
 
+void Conditions::append_like_pattern(const std::string& column_name,
+                                     const std::string& pattern) {
+    int32_t index = _table->get_field_index(column_name);
+    if (index < 0) {
+        OLAP_LOG_WARNING("fail to get field index, name is invalid. [field_name=%s]",
+                         column_name.c_str());
+        return;
+    }
+    const FieldInfo& fi = _table->tablet_schema()[index];
+    if (fi.type != OLAP_FIELD_TYPE_CHAR && fi.type != OLAP_FIELD_TYPE_VARCHAR) {
+        return;
+    }
+    _like_patterns[index].push_back(pattern);
+}
+
 bool Conditions::delete_conditions_eval(const RowCursor& row) const {
     //通过所有列上的删除条件对rowcursor进行过滤
     if (_columns.empty()) {
@@ -33,6 +33,8 @@
 
 namespace doris {
 
+class BitmapIndexReader;
+class RoaringBitmap;
 class WrapperField;
 
 enum CondOp {
@@ -77,6 +79,11 @@ public:
     int del_eval(const std::pair<WrapperField*, WrapperField*>& stat) const;
 
     bool eval(const BloomFilter& bf) const;
+
+    // Sets 'rows' to the rows of a segment satisfying this condition, by the
+    // bitmap index of the column. Returns false if the index can not tell
+    // them, e.g. for ranges.
+    bool eval(const BitmapIndexReader& index, RoaringBitmap* rows) const;
     
     CondOp op;
     // valid when op is not OP_IN
@@ -108,6 +115,10 @@ public:
 
     bool eval(const BloomFilter& bf) const;
 
+    // Sets 'rows' to the rows satisfying all conditions the bitmap index can
+    // tell, returns false if it can tell none of them.
+    bool eval(const BitmapIndexReader& index, RoaringBitmap* rows) const;
+
     inline bool is_key() const {
         return _is_key;
     }
@@ -129,6 +140,9 @@ public:
     // Key: field index of condition's column
     // Value: CondColumn object
     typedef std::map<int32_t, CondColumn*> CondColumns;
+    // Key: field index of a string column
+    // Value: LIKE patterns the column matches
+    typedef std::map<int32_t, std::vector<std::string>> LikePatterns;
 
     Conditions() {}
 
@@ -137,6 +151,7 @@ public:
             delete it.second;
         }
         _columns.clear();
+        _like_patterns.clear();
     }
 
     void set_table(OLAPTablePtr table) {
@@ -163,9 +178,19 @@ public:
         return _columns;
     }
 
+    // LIKE patterns only skip the rows the ngram indexes tell do not match,
+    // the predicates are still evaluated on the rows read. Patterns of columns
+    // which are not strings are ignored.
+    void append_like_pattern(const std::string& column_name, const std::string& pattern);
+
+    const LikePatterns& like_patterns() const {
+        return _like_patterns;
+    }
+
 private:
     OLAPTablePtr _table;     // ref to OLAPTable to access schema
     CondColumns _columns;   // list of condition column
+    LikePatterns _like_patterns;
 };
 
 }  // namespace doris
@@ -51,6 +51,9 @@ static constexpr uint32_t OLAP_COMPACTION_DEFAULT_CANDIDATE_SIZE = 10;
 // the max length supported for string type
 static const uint16_t OLAP_STRING_MAX_LENGTH = 65535;
 
+// BITMAP_UNION columns are VARCHAR of the max length of the FE, 65533
+static const uint16_t OLAP_BITMAP_MAX_BYTES = 65533;
+
 // the max bytes for stored string length
 using StringOffsetType = uint32_t;
 using StringLengthType = uint16_t;
@@ -204,6 +207,7 @@ enum OLAPStatus {
     OLAP_ERR_READER_GET_ITERATOR_ERROR = -701,
     OLAP_ERR_READER_ACQUIRE_DATA_ERROR = -702,
     OLAP_ERR_READER_READING_ERROR = -703,
+    OLAP_ERR_READER_CANCELLED = -704,
 
     // BaseCompaction
     // [-800, -900)
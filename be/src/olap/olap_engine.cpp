@@ -17,14 +17,19 @@
 
 #include "olap/olap_engine.h"
 
+#include <fcntl.h>
 #include <signal.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <map>
 #include <new>
 #include <queue>
 #include <set>
 #include <random>
+#include <thread>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string.hpp>
@@ -34,6 +39,7 @@
 #include <thrift/protocol/TDebugProtocol.h>
 
 #include "olap/base_compaction.h"
+#include "olap/column_data.h"
 #include "olap/cumulative_compaction.h"
 #include "olap/lru_cache.h"
 #include "olap/olap_header.h"
@@ -41,11 +47,14 @@
 #include "olap/push_handler.h"
 #include "olap/reader.h"
 #include "olap/schema_change.h"
+#include "olap/segment_group.h"
+#include "olap/segment_group_builder.h"
 #include "olap/store.h"
 #include "olap/utils.h"
 #include "olap/data_writer.h"
 #include "util/time.h"
 #include "util/doris_metrics.h"
+#include "util/lock_stats.h"
 #include "util/pretty_printer.h"
 
 using apache::thrift::ThriftDebugString;
@@ -113,10 +122,20 @@ OLAPEngine::OLAPEngine(const EngineOptions& options)
         _is_drop_tables(false),
         _global_table_id(0),
         _index_stream_lru_cache(NULL),
+        _data_page_cache(NULL),
+        _short_key_index_cache(NULL),
         _tablet_stat_cache_update_time_ms(0),
         _snapshot_base_id(0),
         _is_report_disk_state_already(false),
         _is_report_olap_table_already(false) {
+    LockStats* tablet_map_lock_stats = LockStats::get("tablet_map");
+    for (auto& shard : _tablet_map_shards) {
+        shard.lock.set_stats(tablet_map_lock_stats);
+    }
+    LockStats* txn_map_lock_stats = LockStats::get("txn_map");
+    for (auto& shard : _txn_map_shards) {
+        shard.lock.set_stats(txn_map_lock_stats);
+    }
     if (_s_instance == nullptr) {
         _s_instance = this;
     }
@@ -413,19 +432,64 @@ OLAPStatus OLAPEngine::open() {
     auto cache = new_lru_cache(config::file_descriptor_cache_capacity);
     if (cache == nullptr) {
         OLAP_LOG_WARNING("failed to init file descriptor LRUCache");
-        _tablet_map.clear();
         return OLAP_ERR_INIT_FAILED;
     }
     FileHandler::set_fd_cache(cache);
 
+    CachePolicy index_stream_cache_policy = CACHE_POLICY_LRU;
+    if (!parse_cache_policy(config::index_stream_cache_policy, &index_stream_cache_policy)) {
+        LOG(WARNING) << "unknown index stream cache policy, use lru instead. policy="
+                     << config::index_stream_cache_policy;
+    }
+    CachePolicy data_page_cache_policy = CACHE_POLICY_LRU;
+    if (!parse_cache_policy(config::data_page_cache_policy, &data_page_cache_policy)) {
+        LOG(WARNING) << "unknown data page cache policy, use lru instead. policy="
+                     << config::data_page_cache_policy;
+    }
+    MetricRegistry* metrics = DorisMetrics::metrics();
+    if (metrics != nullptr) {
+        cache->register_metrics(metrics, "file_descriptor");
+    }
+
     // 初始化LRUCache
     // cache大小可通过配置文件配置
-    _index_stream_lru_cache = new_lru_cache(config::index_stream_cache_capacity);
+    _index_stream_lru_cache = new_lru_cache(config::index_stream_cache_capacity,
+                                            index_stream_cache_policy);
     if (_index_stream_lru_cache == NULL) {
         OLAP_LOG_WARNING("failed to init index stream LRUCache");
-        _tablet_map.clear();
         return OLAP_ERR_INIT_FAILED;
     }
+    if (metrics != nullptr) {
+        _index_stream_lru_cache->register_metrics(metrics, "index_stream");
+    }
+
+    if (config::data_page_cache_capacity > 0) {
+        _data_page_cache = new_lru_cache(config::data_page_cache_capacity,
+                                         data_page_cache_policy);
+        if (_data_page_cache == NULL) {
+            OLAP_LOG_WARNING("failed to init data page LRUCache");
+            return OLAP_ERR_INIT_FAILED;
+        }
+        _data_page_cache_mem_tracker.reset(
+                new MemTracker(config::data_page_cache_capacity, "DataPageCache"));
+        if (metrics != nullptr) {
+            _data_page_cache->register_metrics(metrics, "data_page");
+        }
+    }
+    _memtable_flush_mem_tracker.reset(
+            new MemTracker(config::memtable_flush_memory_limit, "MemTableFlush"));
+
+    _short_key_index_mem_tracker.reset(new MemTracker(-1, "ShortKeyIndex"));
+    if (config::short_key_index_cache_capacity > 0) {
+        _short_key_index_cache = new_lru_cache(config::short_key_index_cache_capacity);
+        if (_short_key_index_cache == NULL) {
+            OLAP_LOG_WARNING("failed to init short key index LRUCache");
+            return OLAP_ERR_INIT_FAILED;
+        }
+        if (metrics != nullptr) {
+            _short_key_index_cache->register_metrics(metrics, "short_key_index");
+        }
+    }
 
     // 初始化CE调度器
     int32_t cumulative_compaction_num_threads = config::cumulative_compaction_num_threads;
@@ -434,6 +498,22 @@ OLAPStatus OLAPEngine::open() {
     _max_cumulative_compaction_task_per_disk = (cumulative_compaction_num_threads + file_system_num - 1) / file_system_num;
     _max_base_compaction_task_per_disk = (base_compaction_num_threads + file_system_num - 1) / file_system_num;
 
+    // before the tablets are loaded, their segment groups may open cold files
+    if (!config::cold_storage_uri.empty()) {
+        res = ColdStorage::create(config::cold_storage_uri, &_cold_storage);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to create cold storage. uri=" << config::cold_storage_uri;
+            return res;
+        }
+        _cold_file_manager.reset(new ColdFileManager(
+                _cold_storage.get(), config::cold_file_cache_path,
+                config::cold_file_cache_capacity_bytes));
+        res = _cold_file_manager->init();
+        if (res != OLAP_SUCCESS) {
+            return res;
+        }
+    }
+
     auto stores = get_stores();
     check_none_row_oriented_table(stores);
     load_stores(stores);
@@ -553,22 +633,23 @@ OLAPStatus OLAPEngine::get_all_root_path_info(vector<RootPathInfo>* root_paths_i
 
     // for each tablet, get it's data size, and accumulate the path 'data_used_capacity'
     // which the tablet belongs to.
-    _tablet_map_lock.rdlock();
-    for (auto& entry : _tablet_map) {
-        TableInstances& instance = entry.second;
-        for (auto& tablet : instance.table_arr) {
-            ++tablet_counter;
-            int64_t data_size = tablet->get_data_size();
-            auto find = path_map.find(tablet->storage_root_path_name()); 
-            if (find == path_map.end()) {
-                continue;
-            }
-            if (find->second.is_used) {
-                find->second.data_used_capacity += data_size;
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (auto& entry : shard.tablet_map) {
+            TableInstances& instance = entry.second;
+            for (auto& tablet : instance.table_arr) {
+                ++tablet_counter;
+                int64_t data_size = tablet->get_data_size();
+                auto find = path_map.find(tablet->storage_root_path_name());
+                if (find == path_map.end()) {
+                    continue;
+                }
+                if (find->second.is_used) {
+                    find->second.data_used_capacity += data_size;
+                }
             }
-        } 
+        }
     }
-    _tablet_map_lock.unlock();
 
     // add path info to root_paths_info
     for (auto& entry : path_map) {
@@ -759,9 +840,18 @@ OLAPStatus OLAPEngine::clear() {
     delete FileHandler::get_fd_cache();
     FileHandler::set_fd_cache(nullptr);
     SAFE_DELETE(_index_stream_lru_cache);
+    SAFE_DELETE(_data_page_cache);
 
-    _tablet_map.clear();
-    _transaction_tablet_map.clear();
+    for (auto& shard : _tablet_map_shards) {
+        WriteLock wrlock(&shard.lock);
+        shard.tablet_map.clear();
+    }
+    // segment groups of the tables hold handles of the short key index cache
+    SAFE_DELETE(_short_key_index_cache);
+    for (auto& shard : _txn_map_shards) {
+        WriteLock wrlock(&shard.lock);
+        shard.txn_tablet_map.clear();
+    }
     _global_table_id = 0;
 
     return OLAP_SUCCESS;
@@ -769,8 +859,9 @@ OLAPStatus OLAPEngine::clear() {
 
 OLAPTablePtr OLAPEngine::_get_table_with_no_lock(TTabletId tablet_id, SchemaHash schema_hash) {
     VLOG(3) << "begin to get olap table. tablet_id=" << tablet_id;
-    tablet_map_t::iterator it = _tablet_map.find(tablet_id);
-    if (it != _tablet_map.end()) {
+    tablet_map_t& tablet_map = _tablet_map_shard(tablet_id).tablet_map;
+    tablet_map_t::iterator it = tablet_map.find(tablet_id);
+    if (it != tablet_map.end()) {
         for (OLAPTablePtr table : it->second.table_arr) {
             if (table->equal(tablet_id, schema_hash)) {
                 VLOG(3) << "get olap table success. tablet_id=" << tablet_id;
@@ -786,10 +877,11 @@ OLAPTablePtr OLAPEngine::_get_table_with_no_lock(TTabletId tablet_id, SchemaHash
 }
 
 OLAPTablePtr OLAPEngine::get_table(TTabletId tablet_id, SchemaHash schema_hash, bool load_table, std::string* err) {
-    _tablet_map_lock.rdlock();
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.rdlock();
     OLAPTablePtr olap_table;
     olap_table = _get_table_with_no_lock(tablet_id, schema_hash);
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
 
     if (olap_table.get() != NULL) {
         if (!olap_table->is_used()) {
@@ -817,14 +909,15 @@ OLAPStatus OLAPEngine::get_tables_by_id(
     OLAPStatus res = OLAP_SUCCESS;
     VLOG(3) << "begin to get tables by id. tablet_id=" << tablet_id;
 
-    _tablet_map_lock.rdlock();
-    tablet_map_t::iterator it = _tablet_map.find(tablet_id);
-    if (it != _tablet_map.end()) {
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.rdlock();
+    tablet_map_t::iterator it = shard.tablet_map.find(tablet_id);
+    if (it != shard.tablet_map.end()) {
         for (OLAPTablePtr olap_table : it->second.table_arr) {
             table_list->push_back(olap_table);
         }
     }
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
 
     if (table_list->size() == 0) {
         OLAP_LOG_WARNING("there is no tablet with specified id. [table=%ld]", tablet_id);
@@ -854,14 +947,15 @@ OLAPStatus OLAPEngine::get_tables_by_id(
 
 bool OLAPEngine::check_tablet_id_exist(TTabletId tablet_id) {
     bool is_exist = false;
-    _tablet_map_lock.rdlock();
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.rdlock();
 
-    tablet_map_t::iterator it = _tablet_map.find(tablet_id);
-    if (it != _tablet_map.end() && it->second.table_arr.size() != 0) {
+    tablet_map_t::iterator it = shard.tablet_map.find(tablet_id);
+    if (it != shard.tablet_map.end() && it->second.table_arr.size() != 0) {
         is_exist = true;
     }
 
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
     return is_exist;
 }
 
@@ -871,12 +965,13 @@ OLAPStatus OLAPEngine::add_table(TTabletId tablet_id, SchemaHash schema_hash,
     VLOG(3) << "begin to add olap table to OLAPEngine. "
             << "tablet_id=" << tablet_id << ", schema_hash=" << schema_hash
             << ", force=" << force;
-    _tablet_map_lock.wrlock();
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.wrlock();
 
     table->set_id(_global_table_id++);
 
     OLAPTablePtr table_item;
-    for (OLAPTablePtr item : _tablet_map[tablet_id].table_arr) {
+    for (OLAPTablePtr item : shard.tablet_map[tablet_id].table_arr) {
         if (item->equal(tablet_id, schema_hash)) {
             table_item = item;
             break;
@@ -884,13 +979,13 @@ OLAPStatus OLAPEngine::add_table(TTabletId tablet_id, SchemaHash schema_hash,
     }
 
     if (table_item.get() == NULL) {
-        _tablet_map[tablet_id].table_arr.push_back(table);
-        _tablet_map[tablet_id].table_arr.sort(_sort_table_by_create_time);
-        _tablet_map_lock.unlock();
+        shard.tablet_map[tablet_id].table_arr.push_back(table);
+        shard.tablet_map[tablet_id].table_arr.sort(_sort_table_by_create_time);
+        shard.lock.unlock();
 
         return res;
     }
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
 
     if (!force) {
         if (table_item->tablet_path() == table->tablet_path()) {
@@ -920,10 +1015,10 @@ OLAPStatus OLAPEngine::add_table(TTabletId tablet_id, SchemaHash schema_hash,
     if (force || (new_version > old_version
             || (new_version == old_version && new_time > old_time))) {
         drop_table(tablet_id, schema_hash, keep_files);
-        _tablet_map_lock.wrlock();
-        _tablet_map[tablet_id].table_arr.push_back(table);
-        _tablet_map[tablet_id].table_arr.sort(_sort_table_by_create_time);
-        _tablet_map_lock.unlock();
+        shard.lock.wrlock();
+        shard.tablet_map[tablet_id].table_arr.push_back(table);
+        shard.tablet_map[tablet_id].table_arr.sort(_sort_table_by_create_time);
+        shard.lock.unlock();
     } else {
         table->mark_dropped();
         res = OLAP_ERR_ENGINE_INSERT_EXISTS_TABLE;
@@ -944,9 +1039,10 @@ OLAPStatus OLAPEngine::add_transaction(
 
     pair<int64_t, int64_t> key(partition_id, transaction_id);
     TabletInfo tablet_info(tablet_id, schema_hash);
-    WriteLock wrlock(&_transaction_tablet_map_lock);
-    auto it = _transaction_tablet_map.find(key);
-    if (it != _transaction_tablet_map.end()) {
+    TxnMapShard& shard = _txn_map_shard(transaction_id);
+    WriteLock wrlock(&shard.lock);
+    auto it = shard.txn_tablet_map.find(key);
+    if (it != shard.txn_tablet_map.end()) {
         auto load_info = it->second.find(tablet_info);
         if (load_info != it->second.end()) {
             for (PUniqueId& pid : load_info->second) {
@@ -961,7 +1057,7 @@ OLAPStatus OLAPEngine::add_transaction(
         }
     }
 
-    _transaction_tablet_map[key][tablet_info].push_back(load_id);
+    shard.txn_tablet_map[key][tablet_info].push_back(load_id);
     VLOG(3) << "add transaction to engine successfully."
             << "partition_id: " << key.first
             << ", transaction_id: " << key.second
@@ -975,17 +1071,18 @@ void OLAPEngine::delete_transaction(
 
     pair<int64_t, int64_t> key(partition_id, transaction_id);
     TabletInfo tablet_info(tablet_id, schema_hash);
-    WriteLock wrlock(&_transaction_tablet_map_lock);
+    TxnMapShard& shard = _txn_map_shard(transaction_id);
+    WriteLock wrlock(&shard.lock);
 
-    auto it = _transaction_tablet_map.find(key);
-    if (it != _transaction_tablet_map.end()) {
+    auto it = shard.txn_tablet_map.find(key);
+    if (it != shard.txn_tablet_map.end()) {
         VLOG(3) << "delete transaction to engine successfully."
                 << ",partition_id: " << key.first
                 << ", transaction_id: " << key.second
                 << ", table: " << tablet_info.to_string();
         it->second.erase(tablet_info);
         if (it->second.empty()) {
-            _transaction_tablet_map.erase(it);
+            shard.txn_tablet_map.erase(it);
         }
 
         // delete transaction from tablet
@@ -1006,15 +1103,17 @@ void OLAPEngine::get_transactions_by_tablet(OLAPTablePtr tablet, int64_t* partit
     }
 
     TabletInfo tablet_info(tablet->tablet_id(), tablet->schema_hash());
-    ReadLock rdlock(&_transaction_tablet_map_lock);
-    for (auto& it : _transaction_tablet_map) {
-        if (it.second.find(tablet_info) != it.second.end()) {
-            *partition_id = it.first.first;
-            transaction_ids->insert(it.first.second);
-            VLOG(3) << "find transaction on tablet."
-                    << "partition_id: " << it.first.first
-                    << ", transaction_id: " << it.first.second
-                    << ", table: " << tablet_info.to_string();
+    for (auto& shard : _txn_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (auto& it : shard.txn_tablet_map) {
+            if (it.second.find(tablet_info) != it.second.end()) {
+                *partition_id = it.first.first;
+                transaction_ids->insert(it.first.second);
+                VLOG(3) << "find transaction on tablet."
+                        << "partition_id: " << it.first.first
+                        << ", transaction_id: " << it.first.second
+                        << ", table: " << tablet_info.to_string();
+            }
         }
     }
 }
@@ -1024,15 +1123,197 @@ bool OLAPEngine::has_transaction(TPartitionId partition_id, TTransactionId trans
     pair<int64_t, int64_t> key(partition_id, transaction_id);
     TabletInfo tablet_info(tablet_id, schema_hash);
 
-    _transaction_tablet_map_lock.rdlock();
-    auto it = _transaction_tablet_map.find(key);
-    bool found = it != _transaction_tablet_map.end()
+    TxnMapShard& shard = _txn_map_shard(transaction_id);
+    shard.lock.rdlock();
+    auto it = shard.txn_tablet_map.find(key);
+    bool found = it != shard.txn_tablet_map.end()
                  && it->second.find(tablet_info) != it->second.end();
-    _transaction_tablet_map_lock.unlock();
+    shard.lock.unlock();
 
     return found;
 }
 
+OLAPStatus OLAPEngine::ingest_segment_groups(
+        TTabletId tablet_id, SchemaHash schema_hash, TPartitionId partition_id,
+        TTransactionId transaction_id, const PUniqueId& load_id, const string& dir) {
+    OLAPTablePtr table = get_table(tablet_id, schema_hash);
+    if (table.get() == nullptr) {
+        LOG(WARNING) << "table not found when ingest segment groups. tablet_id=" << tablet_id
+                     << ", schema_hash=" << schema_hash;
+        return OLAP_ERR_TABLE_NOT_FOUND;
+    }
+
+    // the files of a segment group must be converted for the new table, which
+    // is left to normal loads
+    TTabletId new_tablet_id;
+    TSchemaHash new_schema_hash;
+    table->obtain_header_rdlock();
+    bool is_schema_changing =
+            table->get_schema_change_request(&new_tablet_id, &new_schema_hash, nullptr, nullptr);
+    table->release_header_lock();
+    if (is_schema_changing) {
+        LOG(WARNING) << "can not ingest segment groups when schema changing. table="
+                     << table->full_name();
+        return OLAP_ERR_PUSH_INIT_ERROR;
+    }
+
+    // meta files are named '<transaction_id>_<segment_group_id>.meta'
+    set<string> files;
+    RETURN_NOT_OK(dir_walk(dir, nullptr, &files));
+    string meta_prefix = std::to_string(transaction_id) + "_";
+    vector<PPendingSegmentGroup> metas;
+    for (const string& file : files) {
+        if (!boost::algorithm::starts_with(file, meta_prefix)
+                || !boost::algorithm::ends_with(file, SegmentGroupBuilder::META_FILE_SUFFIX)) {
+            continue;
+        }
+        string meta_path = dir + "/" + file;
+        FileHandler meta_file;
+        RETURN_NOT_OK(meta_file.open(meta_path, O_RDONLY));
+        string meta_buf(meta_file.length(), '\0');
+        OLAPStatus res = meta_file.pread(&meta_buf[0], meta_buf.size(), 0);
+        meta_file.close();
+        if (res != OLAP_SUCCESS) {
+            return res;
+        }
+        metas.emplace_back();
+        if (!metas.back().ParseFromString(meta_buf)) {
+            LOG(WARNING) << "fail to parse segment group meta. path=" << meta_path;
+            return OLAP_ERR_PARSE_PROTOBUF_ERROR;
+        }
+    }
+    if (metas.empty()) {
+        LOG(WARNING) << "no segment group to ingest. dir=" << dir
+                     << ", transaction_id=" << transaction_id;
+        return OLAP_ERR_FILE_NOT_EXIST;
+    }
+
+    OLAPStatus lock_status = table->try_migration_rdlock();
+    if (lock_status != OLAP_SUCCESS) {
+        return lock_status;
+    }
+    OLAPStatus res = _ingest_segment_groups(table, partition_id, transaction_id, load_id,
+                                            dir, metas);
+    table->release_migration_lock();
+    return res;
+}
+
+OLAPStatus OLAPEngine::_ingest_segment_groups(
+        OLAPTablePtr table, TPartitionId partition_id, TTransactionId transaction_id,
+        const PUniqueId& load_id, const string& dir,
+        const vector<PPendingSegmentGroup>& metas) {
+    int32_t segment_group_id = 0;
+    {
+        MutexLock push_lock(table->get_push_lock());
+        RETURN_NOT_OK(add_transaction(partition_id, transaction_id,
+                                      table->tablet_id(), table->schema_hash(), load_id));
+        string dir_path = table->construct_pending_data_dir_path();
+        if (!check_dir_existed(dir_path) && create_dirs(dir_path) != OLAP_SUCCESS) {
+            delete_transaction(partition_id, transaction_id,
+                               table->tablet_id(), table->schema_hash());
+            return OLAP_ERR_CANNOT_CREATE_DIR;
+        }
+        // other loads of the transaction may have added segment groups already
+        segment_group_id = table->current_pending_segment_group_id(transaction_id) + 1;
+    }
+
+    OLAPStatus res = OLAP_SUCCESS;
+    vector<SegmentGroup*> segment_groups;
+    for (const PPendingSegmentGroup& meta : metas) {
+        SegmentGroup* segment_group = new SegmentGroup(
+                table.get(), false, segment_group_id++, meta.num_segments(), true,
+                partition_id, transaction_id);
+        segment_group->acquire();
+        segment_group->set_load_id(load_id);
+        if (meta.has_empty()) {
+            segment_group->set_empty(meta.empty());
+        }
+        segment_groups.push_back(segment_group);
+
+        for (int32_t seg_id = 0; seg_id < meta.num_segments() && res == OLAP_SUCCESS; ++seg_id) {
+            std::stringstream prefix;
+            prefix << dir << "/" << transaction_id << "_"
+                   << meta.pending_segment_group_id() << "_" << seg_id;
+            string files[][2] = {
+                {prefix.str() + ".idx",
+                 segment_group->construct_index_file_path(segment_group->segment_group_id(), seg_id)},
+                {prefix.str() + ".dat",
+                 segment_group->construct_data_file_path(segment_group->segment_group_id(), seg_id)}};
+            for (auto& file : files) {
+                if (link(file[0].c_str(), file[1].c_str()) == 0) {
+                    continue;
+                }
+                if (errno != EXDEV || (res = copy_file(file[0], file[1])) != OLAP_SUCCESS) {
+                    LOG(WARNING) << "fail to link or copy file of segment group. from="
+                                 << file[0] << ", to=" << file[1] << ", errno=" << errno;
+                    res = OLAP_ERR_OS_ERROR;
+                    break;
+                }
+            }
+        }
+        if (res != OLAP_SUCCESS || (res = segment_group->validate()) != OLAP_SUCCESS) {
+            break;
+        }
+
+        if (meta.column_pruning_size() != 0) {
+            size_t num_key_fields = table->num_key_fields();
+            if (static_cast<int>(num_key_fields) != meta.column_pruning_size()) {
+                LOG(WARNING) << "column pruning size is error when ingest segment group."
+                             << "column_pruning_size=" << meta.column_pruning_size() << ", "
+                             << "num_key_fields=" << num_key_fields;
+                res = OLAP_ERR_PUSH_INPUT_DATA_ERROR;
+                break;
+            }
+            vector<pair<string, string>> column_statistics_string(num_key_fields);
+            vector<bool> null_vec(num_key_fields);
+            for (size_t j = 0; j < num_key_fields; ++j) {
+                const ColumnPruning& column_pruning = meta.column_pruning(j);
+                column_statistics_string[j].first = column_pruning.min();
+                column_statistics_string[j].second = column_pruning.max();
+                null_vec[j] = column_pruning.has_null_flag() && column_pruning.null_flag();
+            }
+            res = segment_group->add_column_statistics(column_statistics_string, null_vec);
+            if (res != OLAP_SUCCESS) {
+                LOG(WARNING) << "fail to set column statistics when ingest segment group";
+                break;
+            }
+        }
+
+        // checks the index and the data files match the schema of the table
+        if ((res = segment_group->load()) != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to load ingested segment group. table=" << table->full_name()
+                         << ", transaction_id=" << transaction_id << ", res=" << res;
+            break;
+        }
+    }
+
+    if (res == OLAP_SUCCESS) {
+        res = table->add_pending_version(partition_id, transaction_id, nullptr);
+        if (res == OLAP_ERR_PUSH_TRANSACTION_ALREADY_EXIST) {
+            res = OLAP_SUCCESS;
+        }
+    }
+    for (size_t i = 0; i < segment_groups.size() && res == OLAP_SUCCESS; ++i) {
+        res = table->add_pending_segment_group(segment_groups[i]);
+    }
+
+    if (res != OLAP_SUCCESS) {
+        delete_transaction(partition_id, transaction_id, table->tablet_id(), table->schema_hash());
+        for (SegmentGroup* segment_group : segment_groups) {
+            add_unused_index(segment_group);
+        }
+    } else {
+        LOG(INFO) << "ingest segment groups successfully. table=" << table->full_name()
+                  << ", partition_id=" << partition_id
+                  << ", transaction_id=" << transaction_id
+                  << ", num_segment_groups=" << segment_groups.size();
+    }
+    for (SegmentGroup* segment_group : segment_groups) {
+        segment_group->release();
+    }
+    return res;
+}
+
 OLAPStatus OLAPEngine::publish_version(const TPublishVersionRequest& publish_version_req,
                                  vector<TTabletId>* error_tablet_ids) {
     LOG(INFO) << "begin to process publish version. transaction_id="
@@ -1047,77 +1328,123 @@ OLAPStatus OLAPEngine::publish_version(const TPublishVersionRequest& publish_ver
 
         int64_t partition_id = partitionVersionInfo.partition_id;
         pair<int64_t, int64_t> key(partition_id, transaction_id);
+        TxnMapShard& txn_shard = _txn_map_shard(transaction_id);
 
-        _transaction_tablet_map_lock.rdlock();
-        auto it = _transaction_tablet_map.find(key);
-        if (it == _transaction_tablet_map.end()) {
+        txn_shard.lock.rdlock();
+        auto it = txn_shard.txn_tablet_map.find(key);
+        if (it == txn_shard.txn_tablet_map.end()) {
             OLAP_LOG_WARNING("no tablet to publish version. [partition_id=%ld transaction_id=%ld]",
                              partition_id, transaction_id);
-            _transaction_tablet_map_lock.unlock();
+            txn_shard.lock.unlock();
             continue;
         }
         std::map<TabletInfo, std::vector<PUniqueId>> load_info_map = it->second;
-        _transaction_tablet_map_lock.unlock();
+        txn_shard.lock.unlock();
 
         Version version(partitionVersionInfo.version, partitionVersionInfo.version);
         VersionHash version_hash = partitionVersionInfo.version_hash;
 
-        // each tablet
+        // get all the tablets first, the ones of a data dir are not published
+        // one after another, for their headers to be written together
+        std::vector<OLAPTablePtr> found_tablets;
+        found_tablets.reserve(load_info_map.size());
         for (auto& load_info : load_info_map) {
             const TabletInfo& tablet_info = load_info.first;
-            VLOG(3) << "begin to publish version on tablet. "
-                    << "tablet_id=" << tablet_info.tablet_id
-                    << ", schema_hash=" << tablet_info.schema_hash
-                    << ", version=" << version.first
-                    << ", version_hash=" << version_hash
-                    << ", transaction_id=" << transaction_id;
-            OLAPTablePtr tablet = get_table(tablet_info.tablet_id, tablet_info.schema_hash);
+            TabletMapShard& shard = _tablet_map_shard(tablet_info.tablet_id);
+            ReadLock rdlock(&shard.lock);
+            found_tablets.push_back(_get_table_with_no_lock(tablet_info.tablet_id,
+                                                            tablet_info.schema_hash));
+        }
 
-            if (tablet.get() == NULL) {
+        std::map<OlapStore*, std::vector<OLAPTablePtr>> store_tablets;
+        size_t num_tablets = 0;
+        auto found_it = found_tablets.begin();
+        for (auto& load_info : load_info_map) {
+            const TabletInfo& tablet_info = load_info.first;
+            OLAPTablePtr& tablet = *found_it++;
+            if (tablet.get() == NULL || !tablet->is_used()
+                    || (!tablet->is_loaded() && tablet->load() != OLAP_SUCCESS)) {
                 OLAP_LOG_WARNING("can't get table when publish version. [tablet_id=%ld schema_hash=%d]",
                                  tablet_info.tablet_id, tablet_info.schema_hash);
                 error_tablet_ids->push_back(tablet_info.tablet_id);
                 res = OLAP_ERR_PUSH_TABLE_NOT_EXIST;
                 continue;
             }
+            store_tablets[tablet->store()].push_back(tablet);
+            ++num_tablets;
+        }
+        std::vector<OLAPTablePtr> tablets;
+        tablets.reserve(num_tablets);
+        for (size_t i = 0; tablets.size() < num_tablets; ++i) {
+            for (auto& it : store_tablets) {
+                if (i < it.second.size()) {
+                    tablets.push_back(it.second[i]);
+                }
+            }
+        }
 
-
-            // publish version
-            OLAPStatus publish_status = tablet->publish_version(
-                transaction_id, version, version_hash);
-
-            // if data existed, delete transaction from engine and tablet
-            if (publish_status == OLAP_ERR_PUSH_VERSION_ALREADY_EXIST) {
-                OLAP_LOG_WARNING("can't publish version on tablet since data existed. "
-                                 "[table=%s transaction_id=%ld version=%d]",
-                                 tablet->full_name().c_str(), transaction_id, version.first);
-                delete_transaction(partition_id, transaction_id,
-                                   tablet->tablet_id(), tablet->schema_hash());
-
-            // if publish successfully, delete transaction from engine
-            } else if (publish_status == OLAP_SUCCESS) {
-                LOG(INFO) << "publish version successfully on tablet. tablet=" << tablet->full_name()
-                          << ", transaction_id=" << transaction_id << ", version=" << version.first;
-                _transaction_tablet_map_lock.wrlock();
-                auto it2 = _transaction_tablet_map.find(key);
-                if (it2 != _transaction_tablet_map.end()) {
-                    VLOG(3) << "delete transaction from engine. table=" << tablet->full_name()
-                        << "transaction_id: " << transaction_id;
-                    it2->second.erase(tablet_info);
-                    if (it2->second.empty()) {
-                        _transaction_tablet_map.erase(it2);
+        // each tablet, by several threads. Concurrent writes to the meta of a
+        // data dir are committed by RocksDB with one sync of its log.
+        std::mutex result_lock;
+        std::atomic<size_t> next_tablet(0);
+        auto publish_tablets = [&] () {
+            for (size_t i = next_tablet++; i < tablets.size(); i = next_tablet++) {
+                OLAPTablePtr& tablet = tablets[i];
+                VLOG(3) << "begin to publish version on tablet. "
+                        << "tablet=" << tablet->full_name()
+                        << ", version=" << version.first
+                        << ", version_hash=" << version_hash
+                        << ", transaction_id=" << transaction_id;
+
+                // publish version
+                OLAPStatus publish_status = tablet->publish_version(
+                    transaction_id, version, version_hash);
+                TabletInfo tablet_info(tablet->tablet_id(), tablet->schema_hash());
+
+                // if data existed, delete transaction from engine and tablet
+                if (publish_status == OLAP_ERR_PUSH_VERSION_ALREADY_EXIST) {
+                    OLAP_LOG_WARNING("can't publish version on tablet since data existed. "
+                                     "[table=%s transaction_id=%ld version=%d]",
+                                     tablet->full_name().c_str(), transaction_id, version.first);
+                    delete_transaction(partition_id, transaction_id,
+                                       tablet->tablet_id(), tablet->schema_hash());
+
+                // if publish successfully, delete transaction from engine
+                } else if (publish_status == OLAP_SUCCESS) {
+                    LOG(INFO) << "publish version successfully on tablet. tablet=" << tablet->full_name()
+                              << ", transaction_id=" << transaction_id << ", version=" << version.first;
+                    txn_shard.lock.wrlock();
+                    auto it2 = txn_shard.txn_tablet_map.find(key);
+                    if (it2 != txn_shard.txn_tablet_map.end()) {
+                        VLOG(3) << "delete transaction from engine. table=" << tablet->full_name()
+                            << "transaction_id: " << transaction_id;
+                        it2->second.erase(tablet_info);
+                        if (it2->second.empty()) {
+                            txn_shard.txn_tablet_map.erase(it2);
+                        }
                     }
-                }
-                _transaction_tablet_map_lock.unlock();
+                    txn_shard.lock.unlock();
 
-            } else {
-                OLAP_LOG_WARNING("fail to publish version on tablet. "
-                                 "[table=%s transaction_id=%ld version=%d res=%d]",
-                                 tablet->full_name().c_str(), transaction_id,
-                                 version.first, publish_status);
-                error_tablet_ids->push_back(tablet->tablet_id());
-                res = publish_status;
+                } else {
+                    OLAP_LOG_WARNING("fail to publish version on tablet. "
+                                     "[table=%s transaction_id=%ld version=%d res=%d]",
+                                     tablet->full_name().c_str(), transaction_id,
+                                     version.first, publish_status);
+                    std::lock_guard<std::mutex> l(result_lock);
+                    error_tablet_ids->push_back(tablet->tablet_id());
+                    res = publish_status;
+                }
             }
+        };
+        size_t num_threads = std::min<size_t>(
+            std::max(config::publish_version_tablet_threads, 1), tablets.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < num_threads; ++i) {
+            threads.emplace_back(publish_tablets);
+        }
+        publish_tablets();
+        for (auto& thread : threads) {
+            thread.join();
         }
     }
 
@@ -1136,17 +1463,18 @@ void OLAPEngine::clear_transaction_task(const TTransactionId transaction_id,
 
         // get tablets in this transaction
         pair<int64_t, int64_t> key(partition_id, transaction_id);
+        TxnMapShard& shard = _txn_map_shard(transaction_id);
 
-        _transaction_tablet_map_lock.rdlock();
-        auto it = _transaction_tablet_map.find(key);
-        if (it == _transaction_tablet_map.end()) {
+        shard.lock.rdlock();
+        auto it = shard.txn_tablet_map.find(key);
+        if (it == shard.txn_tablet_map.end()) {
             OLAP_LOG_WARNING("no tablet to clear transaction. [partition_id=%ld transaction_id=%ld]",
                              partition_id, transaction_id);
-            _transaction_tablet_map_lock.unlock();
+            shard.lock.unlock();
             continue;
         }
         std::map<TabletInfo, std::vector<PUniqueId>> load_info_map = it->second;
-        _transaction_tablet_map_lock.unlock();
+        shard.lock.unlock();
 
         // each tablet
         for (auto& load_info : load_info_map) {
@@ -1325,9 +1653,10 @@ OLAPStatus OLAPEngine::drop_table(
     OLAPStatus res = OLAP_SUCCESS;
 
     // Get table which need to be droped
-    _tablet_map_lock.rdlock();
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.rdlock();
     OLAPTablePtr dropped_table = _get_table_with_no_lock(tablet_id, schema_hash);
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
     if (dropped_table.get() == NULL) {
         OLAP_LOG_WARNING("fail to drop not existed table. [tablet_id=%ld schema_hash=%d]",
                          tablet_id, schema_hash);
@@ -1356,10 +1685,11 @@ OLAPStatus OLAPEngine::drop_table(
     }
 
     bool is_drop_base_table = false;
-    _tablet_map_lock.rdlock();
+    TabletMapShard& related_shard = _tablet_map_shard(related_tablet_id);
+    related_shard.lock.rdlock();
     OLAPTablePtr related_table = _get_table_with_no_lock(
             related_tablet_id, related_schema_hash);
-    _tablet_map_lock.unlock();
+    related_shard.lock.unlock();
     if (related_table.get() == NULL) {
         OLAP_LOG_WARNING("drop table directly when related table not found. "
                          "[tablet_id=%ld schema_hash=%d]",
@@ -1378,7 +1708,7 @@ OLAPStatus OLAPEngine::drop_table(
     }
 
     // Drop specified table and clear schema change info
-    _tablet_map_lock.wrlock();
+    shard.lock.wrlock();
     related_table->obtain_header_wrlock();
     related_table->clear_schema_change_request();
     res = related_table->save_header();
@@ -1389,7 +1719,7 @@ OLAPStatus OLAPEngine::drop_table(
 
     res = _drop_table_directly_unlocked(tablet_id, schema_hash, keep_files);
     related_table->release_header_lock();
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
     if (res != OLAP_SUCCESS) {
         OLAP_LOG_WARNING("fail to drop table which in schema change. [table=%s]",
                          dropped_table->full_name().c_str());
@@ -1402,9 +1732,10 @@ OLAPStatus OLAPEngine::drop_table(
 
 OLAPStatus OLAPEngine::_drop_table_directly(
         TTabletId tablet_id, SchemaHash schema_hash, bool keep_files) {
-    _tablet_map_lock.wrlock();
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.wrlock();
     OLAPStatus res = _drop_table_directly_unlocked(tablet_id, schema_hash, keep_files);
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
     return res;
 }
 
@@ -1419,20 +1750,21 @@ OLAPStatus OLAPEngine::_drop_table_directly_unlocked(
         return OLAP_ERR_TABLE_NOT_FOUND;
     }
 
-    for (list<OLAPTablePtr>::iterator it = _tablet_map[tablet_id].table_arr.begin();
-            it != _tablet_map[tablet_id].table_arr.end();) {
+    tablet_map_t& tablet_map = _tablet_map_shard(tablet_id).tablet_map;
+    for (list<OLAPTablePtr>::iterator it = tablet_map[tablet_id].table_arr.begin();
+            it != tablet_map[tablet_id].table_arr.end();) {
         if ((*it)->equal(tablet_id, schema_hash)) {
             if (!keep_files) {
                 (*it)->mark_dropped();
             }
-            it = _tablet_map[tablet_id].table_arr.erase(it);
+            it = tablet_map[tablet_id].table_arr.erase(it);
         } else {
             ++it;
         }
     }
 
-    if (_tablet_map[tablet_id].table_arr.empty()) {
-        _tablet_map.erase(tablet_id);
+    if (tablet_map[tablet_id].table_arr.empty()) {
+        tablet_map.erase(tablet_id);
     }
 
     res = dropped_table->store()->deregister_table(dropped_table.get());
@@ -1448,36 +1780,35 @@ OLAPStatus OLAPEngine::drop_tables_on_error_root_path(
         const vector<TabletInfo>& tablet_info_vec) {
     OLAPStatus res = OLAP_SUCCESS;
 
-    _tablet_map_lock.wrlock();
-
     for (const TabletInfo& tablet_info : tablet_info_vec) {
         TTabletId tablet_id = tablet_info.tablet_id;
         TSchemaHash schema_hash = tablet_info.schema_hash;
         VLOG(3) << "drop_table begin. tablet_id=" << tablet_id
                 << ", schema_hash=" << schema_hash;
+        TabletMapShard& shard = _tablet_map_shard(tablet_id);
+        WriteLock wrlock(&shard.lock);
         OLAPTablePtr dropped_table = _get_table_with_no_lock(tablet_id, schema_hash);
         if (dropped_table.get() == NULL) {
             OLAP_LOG_WARNING("dropping table not exist. [table=%ld schema_hash=%d]",
                              tablet_id, schema_hash);
             continue;
         } else {
-            for (list<OLAPTablePtr>::iterator it = _tablet_map[tablet_id].table_arr.begin();
-                    it != _tablet_map[tablet_id].table_arr.end();) {
+            tablet_map_t& tablet_map = shard.tablet_map;
+            for (list<OLAPTablePtr>::iterator it = tablet_map[tablet_id].table_arr.begin();
+                    it != tablet_map[tablet_id].table_arr.end();) {
                 if ((*it)->equal(tablet_id, schema_hash)) {
-                    it = _tablet_map[tablet_id].table_arr.erase(it);
+                    it = tablet_map[tablet_id].table_arr.erase(it);
                 } else {
                     ++it;
                 }
             }
 
-            if (_tablet_map[tablet_id].table_arr.empty()) {
-                _tablet_map.erase(tablet_id);
+            if (tablet_map[tablet_id].table_arr.empty()) {
+                tablet_map.erase(tablet_id);
             }
         }
     }
 
-    _tablet_map_lock.unlock();
-
     return res;
 }
 
@@ -1615,32 +1946,34 @@ OLAPStatus OLAPEngine::create_init_version(TTabletId tablet_id, SchemaHash schem
 bool OLAPEngine::try_schema_change_lock(TTabletId tablet_id) {
     bool res = false;
     VLOG(3) << "try_schema_change_lock begin. table_id=" << tablet_id;
-    _tablet_map_lock.rdlock();
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.rdlock();
 
-    tablet_map_t::iterator it = _tablet_map.find(tablet_id);
-    if (it == _tablet_map.end()) {
+    tablet_map_t::iterator it = shard.tablet_map.find(tablet_id);
+    if (it == shard.tablet_map.end()) {
         OLAP_LOG_WARNING("tablet does not exists. [table=%ld]", tablet_id);
     } else {
         res = (it->second.schema_change_lock.trylock() == OLAP_SUCCESS);
     }
 
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
     VLOG(3) << "try_schema_change_lock end. table_id=" <<  tablet_id;
     return res;
 }
 
 void OLAPEngine::release_schema_change_lock(TTabletId tablet_id) {
     VLOG(3) << "release_schema_change_lock begin. tablet_id=" << tablet_id;
-    _tablet_map_lock.rdlock();
+    TabletMapShard& shard = _tablet_map_shard(tablet_id);
+    shard.lock.rdlock();
 
-    tablet_map_t::iterator it = _tablet_map.find(tablet_id);
-    if (it == _tablet_map.end()) {
+    tablet_map_t::iterator it = shard.tablet_map.find(tablet_id);
+    if (it == shard.tablet_map.end()) {
         OLAP_LOG_WARNING("tablet does not exists. [table=%ld]", tablet_id);
     } else {
         it->second.schema_change_lock.unlock();
     }
 
-    _tablet_map_lock.unlock();
+    shard.lock.unlock();
     VLOG(3) << "release_schema_change_lock end. tablet_id=" << tablet_id;
 }
 
@@ -1699,7 +2032,8 @@ OLAPStatus OLAPEngine::report_tablet_info(TTabletInfo* tablet_info) {
     return res;
 }
 
-OLAPStatus OLAPEngine::report_all_tablets_info(std::map<TTabletId, TTablet>* tablets_info) {
+OLAPStatus OLAPEngine::report_all_tablets_info(std::map<TTabletId, TTablet>* tablets_info,
+                                               const std::set<TTabletId>* changed_tablet_ids) {
     LOG(INFO) << "begin to process report all tablets info.";
     DorisMetrics::report_all_tablets_requests_total.increment(1);
 
@@ -1707,45 +2041,82 @@ OLAPStatus OLAPEngine::report_all_tablets_info(std::map<TTabletId, TTablet>* tab
         return OLAP_ERR_INPUT_PARAMETER_ERROR;
     }
 
-    _tablet_map_lock.rdlock();
-    for (const auto& item : _tablet_map) {
-        if (item.second.table_arr.size() == 0) {
-            continue;
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (const auto& item : shard.tablet_map) {
+            TTablet tablet;
+            bool changed = changed_tablet_ids != nullptr
+                && changed_tablet_ids->find(item.first) != changed_tablet_ids->end();
+            _build_tablet_report(item.second, &tablet, changed);
+            if (tablet.tablet_infos.size() != 0) {
+                tablets_info->insert(
+                        pair<TTabletId, TTablet>(tablet.tablet_infos[0].tablet_id, tablet));
+            }
         }
+    }
+
+    LOG(INFO) << "success to process report all tablets info. tablet_num=" << tablets_info->size();
+    return OLAP_SUCCESS;
+}
 
+OLAPStatus OLAPEngine::report_tablets_info(const std::set<TTabletId>& tablet_ids,
+                                           std::map<TTabletId, TTablet>* tablets_info) {
+    DorisMetrics::report_all_tablets_requests_total.increment(1);
+    for (TTabletId tablet_id : tablet_ids) {
+        TabletMapShard& shard = _tablet_map_shard(tablet_id);
+        ReadLock rdlock(&shard.lock);
+        auto it = shard.tablet_map.find(tablet_id);
+        if (it == shard.tablet_map.end()) {
+            // dropped tablets are found by the next full report
+            continue;
+        }
         TTablet tablet;
-        for (OLAPTablePtr olap_table : item.second.table_arr) {
-            if (olap_table.get() == NULL) {
-                continue;
-            }
+        _build_tablet_report(it->second, &tablet, true);
+        if (tablet.tablet_infos.size() != 0) {
+            tablets_info->insert(pair<TTabletId, TTablet>(tablet_id, tablet));
+        }
+    }
 
-            TTabletInfo tablet_info;
-            _build_tablet_info(olap_table, &tablet_info);
+    LOG(INFO) << "success to process report changed tablets info. tablet_num="
+        << tablets_info->size();
+    return OLAP_SUCCESS;
+}
 
-            // report expire transaction
-            vector<int64_t> transaction_ids;
-            olap_table->get_expire_pending_data(&transaction_ids);
-            tablet_info.__set_transaction_ids(transaction_ids);
+void OLAPEngine::_build_tablet_report(const TableInstances& instances, TTablet* tablet,
+                                      bool with_column_distributions) {
+    for (OLAPTablePtr olap_table : instances.table_arr) {
+        if (olap_table.get() == NULL) {
+            continue;
+        }
 
-            if (_available_storage_medium_type_count > 1) {
-                tablet_info.__set_storage_medium(olap_table->store()->storage_medium());
-            }
+        TTabletInfo tablet_info;
+        _build_tablet_info(olap_table, &tablet_info);
 
-            tablet_info.__set_version_count(olap_table->file_delta_size());
-            tablet_info.__set_path_hash(olap_table->store()->path_hash());
-            tablet_info.__set_used(olap_table->is_used());
+        // report expire transaction
+        vector<int64_t> transaction_ids;
+        olap_table->get_expire_pending_data(&transaction_ids);
+        tablet_info.__set_transaction_ids(transaction_ids);
 
-            tablet.tablet_infos.push_back(tablet_info);
+        if (_available_storage_medium_type_count > 1) {
+            tablet_info.__set_storage_medium(olap_table->store()->storage_medium());
         }
 
-        if (tablet.tablet_infos.size() != 0) {
-            tablets_info->insert(pair<TTabletId, TTablet>(tablet.tablet_infos[0].tablet_id, tablet));
+        tablet_info.__set_version_count(olap_table->file_delta_size());
+        tablet_info.__set_path_hash(olap_table->store()->path_hash());
+        tablet_info.__set_used(olap_table->is_used());
+        TTabletHeat heat;
+        olap_table->heat()->get(UnixMillis(), &heat);
+        tablet_info.__set_heat(heat);
+        if (with_column_distributions && config::enable_column_distribution) {
+            std::vector<TColumnDistribution> column_distributions;
+            olap_table->get_column_distributions(&column_distributions);
+            if (!column_distributions.empty()) {
+                tablet_info.__set_column_distributions(column_distributions);
+            }
         }
-    }
-    _tablet_map_lock.unlock();
 
-    LOG(INFO) << "success to process report all tablets info. tablet_num=" << tablets_info->size();
-    return OLAP_SUCCESS;
+        tablet->tablet_infos.push_back(tablet_info);
+    }
 }
 
 void OLAPEngine::get_tablet_stat(TTabletStatResult& result) {
@@ -1770,35 +2141,55 @@ void OLAPEngine::get_tablet_stat(TTabletStatResult& result) {
 void OLAPEngine::_build_tablet_stat() {
     _tablet_stat_cache.clear();
 
-    _tablet_map_lock.rdlock();
-    for (const auto& item : _tablet_map) {
-        if (item.second.table_arr.size() == 0) {
-            continue;
-        }
-
-        TTabletStat stat;
-        stat.tablet_id = item.first;
-        for (OLAPTablePtr olap_table : item.second.table_arr) {
-            if (olap_table.get() == NULL) {
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (const auto& item : shard.tablet_map) {
+            if (item.second.table_arr.size() == 0) {
                 continue;
             }
-                
-            // we only get base tablet's stat
-            stat.__set_data_size(olap_table->get_data_size());
-            stat.__set_row_num(olap_table->get_num_rows());
-            VLOG(3) << "tablet_id=" << item.first 
-                    << ", data_size=" << olap_table->get_data_size()
-                    << ", row_num:" << olap_table->get_num_rows();
-            break;
-        }
 
-        _tablet_stat_cache.emplace(item.first, stat);
+            TTabletStat stat;
+            stat.tablet_id = item.first;
+            for (OLAPTablePtr olap_table : item.second.table_arr) {
+                if (olap_table.get() == NULL) {
+                    continue;
+                }
+
+                // we only get base tablet's stat
+                stat.__set_data_size(olap_table->get_data_size());
+                stat.__set_row_num(olap_table->get_num_rows());
+                VLOG(3) << "tablet_id=" << item.first
+                        << ", data_size=" << olap_table->get_data_size()
+                        << ", row_num:" << olap_table->get_num_rows();
+                break;
+            }
+
+            _tablet_stat_cache.emplace(item.first, stat);
+        }
     }
-    _tablet_map_lock.unlock();
 
     _tablet_stat_cache_update_time_ms = UnixMillis();
 }
 
+void OLAPEngine::get_tablet_heats(std::vector<std::pair<TTabletId, TTabletHeat>>* heats) {
+    int64_t now_ms = UnixMillis();
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (const auto& item : shard.tablet_map) {
+            for (OLAPTablePtr olap_table : item.second.table_arr) {
+                if (olap_table.get() == NULL) {
+                    continue;
+                }
+                // like the tablet stat, only the base tablet
+                TTabletHeat heat;
+                olap_table->heat()->get(now_ms, &heat);
+                heats->emplace_back(item.first, heat);
+                break;
+            }
+        }
+    }
+}
+
 bool OLAPEngine::_can_do_compaction(OLAPTablePtr table) {
     // 如果table正在做schema change，则通过选路判断数据是否转换完成
     // 如果选路成功，则转换完成，可以进行BE
@@ -1854,7 +2245,13 @@ void OLAPEngine::perform_cumulative_compaction(OlapStore* store) {
         return;
     }
 
+    int64_t start_ms = MonotonicMillis();
     res = cumulative_compaction.run();
+    DorisMetrics::cumulative_compaction_duration_ms.add(MonotonicMillis() - start_ms);
+    // the merged deltas are read and about as many bytes are written
+    if (_compaction_scheduler != nullptr) {
+        _compaction_scheduler->consume(store, 2 * cumulative_compaction.merged_bytes());
+    }
     if (res != OLAP_SUCCESS) {
         DorisMetrics::cumulative_compaction_request_failed.increment(1);
         best_table->set_last_compaction_failure_time(UnixMillis());
@@ -1884,7 +2281,12 @@ void OLAPEngine::perform_base_compaction(OlapStore* store) {
         return;
     }
 
+    int64_t start_ms = MonotonicMillis();
     res = base_compaction.run();
+    DorisMetrics::base_compaction_duration_ms.add(MonotonicMillis() - start_ms);
+    if (_compaction_scheduler != nullptr) {
+        _compaction_scheduler->consume(store, 2 * base_compaction.merged_bytes());
+    }
     if (res != OLAP_SUCCESS) {
         DorisMetrics::base_compaction_request_failed.increment(1);
         best_table->set_last_compaction_failure_time(UnixMillis());
@@ -1897,49 +2299,51 @@ void OLAPEngine::perform_base_compaction(OlapStore* store) {
 }
 
 OLAPTablePtr OLAPEngine::_find_best_tablet_to_compaction(CompactionType compaction_type, OlapStore* store) {
-    ReadLock tablet_map_rdlock(&_tablet_map_lock);
     uint32_t highest_score = 0;
     OLAPTablePtr best_table;
     int64_t now = UnixMillis();
-    for (tablet_map_t::value_type& table_ins : _tablet_map){
-        for (OLAPTablePtr& table_ptr : table_ins.second.table_arr) {
-            if (table_ptr->store()->path_hash() != store->path_hash() 
-                || !table_ptr->is_used() || !table_ptr->is_loaded() || !_can_do_compaction(table_ptr)) {
-                continue;
-            }
-          
-            if (now - table_ptr->last_compaction_failure_time() <= config::min_compaction_failure_interval_sec * 1000) {
-                LOG(INFO) << "tablet last compaction failure time is: " << table_ptr->last_compaction_failure_time()
-                        << ", tablet: " << table_ptr->tablet_id() << ", skip it.";
-                continue;
-            }
-
-            if (compaction_type == CompactionType::CUMULATIVE_COMPACTION) {
-                if (!table_ptr->try_cumulative_lock()) {
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock tablet_map_rdlock(&shard.lock);
+        for (tablet_map_t::value_type& table_ins : shard.tablet_map) {
+            for (OLAPTablePtr& table_ptr : table_ins.second.table_arr) {
+                if (table_ptr->store()->path_hash() != store->path_hash()
+                    || !table_ptr->is_used() || !table_ptr->is_loaded() || !_can_do_compaction(table_ptr)) {
                     continue;
-                } else {
-                    table_ptr->release_cumulative_lock();
                 }
-            }
 
-            if (compaction_type == CompactionType::BASE_COMPACTION) {
-                if (!table_ptr->try_base_compaction_lock()) {
+                if (now - table_ptr->last_compaction_failure_time() <= config::min_compaction_failure_interval_sec * 1000) {
+                    LOG(INFO) << "tablet last compaction failure time is: " << table_ptr->last_compaction_failure_time()
+                            << ", tablet: " << table_ptr->tablet_id() << ", skip it.";
                     continue;
-                } else {
-                    table_ptr->release_base_compaction_lock();
                 }
-            } 
-
-            ReadLock rdlock(table_ptr->get_header_lock_ptr());
-            uint32_t table_score = 0;
-            if (compaction_type == CompactionType::BASE_COMPACTION) {
-                table_score = table_ptr->get_base_compaction_score();
-            } else if (compaction_type == CompactionType::CUMULATIVE_COMPACTION) {
-                table_score = table_ptr->get_cumulative_compaction_score();
-            }
-            if (table_score > highest_score) {
-                highest_score = table_score;
-                best_table = table_ptr;
+
+                if (compaction_type == CompactionType::CUMULATIVE_COMPACTION) {
+                    if (!table_ptr->try_cumulative_lock()) {
+                        continue;
+                    } else {
+                        table_ptr->release_cumulative_lock();
+                    }
+                }
+
+                if (compaction_type == CompactionType::BASE_COMPACTION) {
+                    if (!table_ptr->try_base_compaction_lock()) {
+                        continue;
+                    } else {
+                        table_ptr->release_base_compaction_lock();
+                    }
+                }
+
+                ReadLock rdlock(table_ptr->get_header_lock_ptr());
+                uint32_t table_score = 0;
+                if (compaction_type == CompactionType::BASE_COMPACTION) {
+                    table_score = table_ptr->get_base_compaction_score();
+                } else if (compaction_type == CompactionType::CUMULATIVE_COMPACTION) {
+                    table_score = table_ptr->get_cumulative_compaction_score();
+                }
+                if (table_score > highest_score) {
+                    highest_score = table_score;
+                    best_table = table_ptr;
+                }
             }
         }
     }
@@ -2007,18 +2411,19 @@ OLAPStatus OLAPEngine::start_trash_sweep(double* usage) {
 
     // clear expire incremental segment_group
     std::vector<OLAPTablePtr> tablets;
-    _tablet_map_lock.rdlock();
-    for (const auto& item : _tablet_map) {
-        for (OLAPTablePtr olap_table : item.second.table_arr) {
-            if (olap_table == nullptr) {
-                continue;
-            }
-            if (olap_table->has_expired_incremental_data()) {
-                tablets.push_back(olap_table);
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (const auto& item : shard.tablet_map) {
+            for (OLAPTablePtr olap_table : item.second.table_arr) {
+                if (olap_table == nullptr) {
+                    continue;
+                }
+                if (olap_table->has_expired_incremental_data()) {
+                    tablets.push_back(olap_table);
+                }
             }
         }
     }
-    _tablet_map_lock.unlock();
 
     for (auto& tablet : tablets) {
         tablet->delete_expired_incremental_data();
@@ -2050,6 +2455,19 @@ OLAPStatus OLAPEngine::_do_sweep(
                 continue;
             }
             if (difftime(local_now, mktime(&local_tm_create)) >= expire) {
+                // the files of the expired dir are removed at a limited rate
+                // first, the dirs left after them
+                vector<string> files;
+                if (boost::filesystem::is_directory(item->status())) {
+                    recursive_directory_iterator file_item(item->path());
+                    recursive_directory_iterator file_end;
+                    for (; file_item != file_end; ++file_item) {
+                        if (!boost::filesystem::is_directory(file_item->status())) {
+                            files.push_back(file_item->path().string());
+                        }
+                    }
+                }
+                _remove_files_throttled(files, [](const string& file) { return true; });
                 if (remove_all_dir(path_name) != OLAP_SUCCESS) {
                     OLAP_LOG_WARNING("fail to remove file or directory. [path=%s]",
                             path_name.c_str());
@@ -2099,6 +2517,32 @@ OLAPStatus OLAPEngine::_create_new_table_header(
     // set basic information
     header->set_num_short_key_fields(request.tablet_schema.short_key_column_count);
     header->set_compress_kind(COMPRESS_LZ4);
+    if (request.tablet_schema.__isset.compress_kind) {
+        switch (request.tablet_schema.compress_kind) {
+        case TStorageCompressKind::NONE:
+            header->set_compress_kind(COMPRESS_NONE);
+            break;
+        case TStorageCompressKind::LZO:
+            header->set_compress_kind(COMPRESS_LZO);
+            break;
+        case TStorageCompressKind::ZSTD:
+            header->set_compress_kind(COMPRESS_ZSTD);
+            break;
+        default:
+            break;
+        }
+    }
+    if (request.tablet_schema.__isset.compress_level) {
+        header->set_compress_level(request.tablet_schema.compress_level);
+    }
+    if (request.tablet_schema.__isset.compress_dictionary) {
+        header->set_compress_dictionary(request.tablet_schema.compress_dictionary);
+    }
+    if (request.tablet_schema.__isset.pre_aggregate_key_num
+            && request.tablet_schema.keys_type == TKeysType::AGG_KEYS
+            && request.tablet_schema.pre_aggregate_key_num > 0) {
+        header->set_pre_aggregate_key_num(request.tablet_schema.pre_aggregate_key_num);
+    }
     if (request.tablet_schema.keys_type == TKeysType::DUP_KEYS) {
         header->set_keys_type(KeysType::DUP_KEYS);
     } else if (request.tablet_schema.keys_type == TKeysType::UNIQUE_KEYS) {
@@ -2212,6 +2656,12 @@ OLAPStatus OLAPEngine::_create_new_table_header(
             header->mutable_column(i)->set_is_bf_column(column.is_bloom_filter_column);
             has_bf_columns = true;
         }
+        if (column.__isset.has_bitmap_index) {
+            header->mutable_column(i)->set_has_bitmap_index(column.has_bitmap_index);
+        }
+        if (column.__isset.has_ngram_index) {
+            header->mutable_column(i)->set_has_ngram_index(column.has_ngram_index);
+        }
         ++i;
     }
     if (is_schema_change_table){
@@ -2261,34 +2711,36 @@ void OLAPEngine::_cancel_unfinished_schema_change() {
     vector<Version> schema_change_versions;
     AlterTabletType type;
 
-    for (const auto& tablet_instance : _tablet_map) {
-        for (OLAPTablePtr olap_table : tablet_instance.second.table_arr) {
-            if (olap_table.get() == NULL) {
-                OLAP_LOG_WARNING("get empty OLAPTablePtr. [tablet_id=%ld]", tablet_instance.first);
-                continue;
-            }
+    for (auto& shard : _tablet_map_shards) {
+        for (const auto& tablet_instance : shard.tablet_map) {
+            for (OLAPTablePtr olap_table : tablet_instance.second.table_arr) {
+                if (olap_table.get() == NULL) {
+                    OLAP_LOG_WARNING("get empty OLAPTablePtr. [tablet_id=%ld]", tablet_instance.first);
+                    continue;
+                }
 
-            bool ret = olap_table->get_schema_change_request(
-                    &tablet_id, &schema_hash, &schema_change_versions, &type);
-            if (!ret) {
-                continue;
-            }
+                bool ret = olap_table->get_schema_change_request(
+                        &tablet_id, &schema_hash, &schema_change_versions, &type);
+                if (!ret) {
+                    continue;
+                }
 
-            OLAPTablePtr new_olap_table = get_table(tablet_id, schema_hash, false);
-            if (new_olap_table.get() == NULL) {
-                OLAP_LOG_WARNING("the table referenced by schema change cannot be found. "
-                                 "schema change cancelled. [tablet='%s']",
-                                 olap_table->full_name().c_str());
-                continue;
-            }
+                OLAPTablePtr new_olap_table = get_table(tablet_id, schema_hash, false);
+                if (new_olap_table.get() == NULL) {
+                    OLAP_LOG_WARNING("the table referenced by schema change cannot be found. "
+                                     "schema change cancelled. [tablet='%s']",
+                                     olap_table->full_name().c_str());
+                    continue;
+                }
 
-            // DORIS-3741. Upon restart, it should not clear schema change request.
-            new_olap_table->set_schema_change_status(
-                    ALTER_TABLE_FAILED, new_olap_table->schema_hash(), -1);
-            olap_table->set_schema_change_status(
-                    ALTER_TABLE_FAILED, olap_table->schema_hash(), -1);
-            VLOG(3) << "cancel unfinished schema change. tablet=" << olap_table->full_name();
-            ++canceled_num;
+                // DORIS-3741. Upon restart, it should not clear schema change request.
+                new_olap_table->set_schema_change_status(
+                        ALTER_TABLE_FAILED, new_olap_table->schema_hash(), -1);
+                olap_table->set_schema_change_status(
+                        ALTER_TABLE_FAILED, olap_table->schema_hash(), -1);
+                VLOG(3) << "cancel unfinished schema change. tablet=" << olap_table->full_name();
+                ++canceled_num;
+            }
         }
     }
 
@@ -2296,20 +2748,164 @@ void OLAPEngine::_cancel_unfinished_schema_change() {
 }
 
 void OLAPEngine::start_delete_unused_index() {
+    // files are removed without holding the lock, not to block the
+    // compactions adding their unused segment groups
+    vector<SegmentGroup*> unused_segment_groups;
+    vector<string> files;
     _gc_mutex.lock();
-
     for (auto it = _gc_files.begin(); it != _gc_files.end();) {
         if (it->first->is_in_use()) {
             ++it;
         } else {
-            delete it->first;
-            vector<string> files = it->second;
-            remove_files(files);
+            unused_segment_groups.push_back(it->first);
+            for (auto& file : it->second) {
+                files.push_back(file);
+                _gc_removing_files.insert(file);
+            }
             it = _gc_files.erase(it);
         }
     }
-
     _gc_mutex.unlock();
+
+    for (SegmentGroup* segment_group : unused_segment_groups) {
+        delete segment_group;
+    }
+    _remove_files_throttled(files, [this](const string& file) {
+        MutexLock l(&_gc_mutex);
+        return _gc_removing_files.erase(file) != 0;
+    });
+}
+
+void OLAPEngine::start_storage_cooldown() {
+    if (config::storage_cooldown_idle_second > 0) {
+        _migrate_cold_tablets();
+    }
+    if (_cold_file_manager != nullptr) {
+        _offload_cold_versions();
+    }
+}
+
+void OLAPEngine::_migrate_cold_tablets() {
+    if (available_storage_medium_type_count() <= 1) {
+        return;
+    }
+    int64_t deadline = UnixMillis() - config::storage_cooldown_idle_second * 1000;
+    std::vector<OLAPTablePtr> cold_tablets;
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (const auto& item : shard.tablet_map) {
+            for (const OLAPTablePtr& table : item.second.table_arr) {
+                if (table->store()->storage_medium() == TStorageMedium::SSD
+                        && table->is_used() && table->last_query_time() < deadline) {
+                    cold_tablets.push_back(table);
+                }
+            }
+        }
+    }
+
+    // they are moved one after another by this thread, not to fill the disks
+    // with the copies of the migrations
+    size_t num_migrated = 0;
+    for (const OLAPTablePtr& table : cold_tablets) {
+        OLAPStatus res = storage_medium_migrate(
+                table->tablet_id(), table->schema_hash(), TStorageMedium::HDD);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to cool down tablet. tablet=" << table->full_name()
+                << ", res=" << res;
+            continue;
+        }
+        ++num_migrated;
+    }
+    if (!cold_tablets.empty()) {
+        LOG(INFO) << "finish to cool down tablets. cold_tablets=" << cold_tablets.size()
+            << ", migrated=" << num_migrated;
+    }
+}
+
+void OLAPEngine::_offload_cold_versions() {
+    int64_t deadline = UnixMillis() - config::cold_storage_idle_second * 1000;
+    std::vector<OLAPTablePtr> idle_tablets;
+    for (auto& shard : _tablet_map_shards) {
+        ReadLock rdlock(&shard.lock);
+        for (const auto& item : shard.tablet_map) {
+            for (const OLAPTablePtr& table : item.second.table_arr) {
+                if (table->is_used() && table->last_query_time() < deadline) {
+                    idle_tablets.push_back(table);
+                }
+            }
+        }
+    }
+
+    // creation times are in seconds
+    int64_t created_before = time(NULL) - config::cold_storage_version_age_second;
+    int64_t released_bytes = 0;
+    for (const OLAPTablePtr& table : idle_tablets) {
+        OLAPStatus res = table->offload_cold_versions(
+                _cold_file_manager.get(), created_before, &released_bytes);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to move cold versions to cold storage. tablet="
+                << table->full_name() << ", res=" << res;
+        }
+    }
+    if (released_bytes > 0) {
+        LOG(INFO) << "finish to move cold versions to cold storage. idle_tablets="
+            << idle_tablets.size() << ", released_bytes=" << released_bytes;
+    }
+}
+
+size_t OLAPEngine::_remove_files_throttled(
+        const vector<string>& files, const std::function<bool(const string&)>& may_remove) {
+    vector<string> store_paths;
+    for (OlapStore* store : get_stores()) {
+        store_paths.push_back(store->path());
+    }
+    map<string, vector<const string*>> disk_files;
+    for (const string& file : files) {
+        string disk;
+        for (const string& store_path : store_paths) {
+            if (file.compare(0, store_path.size(), store_path) == 0) {
+                disk = store_path;
+                break;
+            }
+        }
+        disk_files[disk].push_back(&file);
+    }
+
+    size_t num_failed = 0;
+    size_t limit = config::gc_max_files_removed_per_second_per_disk;
+    if (limit == 0) {
+        limit = files.size();
+    }
+    size_t offset = 0;
+    bool has_more = true;
+    while (has_more) {
+        has_more = false;
+        int64_t start_ms = UnixMillis();
+        for (auto& it : disk_files) {
+            size_t end = std::min(offset + limit, it.second.size());
+            for (size_t i = offset; i < end; ++i) {
+                const string& file = *it.second[i];
+                if (!may_remove(file)) {
+                    continue;
+                }
+                boost::system::error_code ec;
+                if (!boost::filesystem::remove(file, ec)) {
+                    LOG(WARNING) << "failed to remove file. file=" << file
+                        << ", error=" << ec.message();
+                    ++num_failed;
+                } else if (_cold_file_manager != nullptr) {
+                    _cold_file_manager->release(file);
+                }
+            }
+            has_more |= end < it.second.size();
+        }
+        offset += limit;
+        int64_t elapsed_ms = UnixMillis() - start_ms;
+        if (has_more && elapsed_ms < 1000) {
+            SleepForMs(1000 - elapsed_ms);
+        }
+    }
+    return num_failed;
 }
 
 void OLAPEngine::add_unused_index(SegmentGroup* segment_group) {
@@ -2319,7 +2915,11 @@ void OLAPEngine::add_unused_index(SegmentGroup* segment_group) {
     if (it == _gc_files.end()) {
         vector<string> files;
         int32_t segment_group_id = segment_group->segment_group_id();
-        for (size_t seg_id = 0; seg_id < segment_group->num_segments(); ++seg_id) {
+        if (segment_group->packed()) {
+            files.push_back(segment_group->construct_packed_file_path());
+        }
+        for (size_t seg_id = 0; !segment_group->packed() && seg_id < segment_group->num_segments();
+                ++seg_id) {
             string index_file = segment_group->construct_index_file_path(segment_group_id, seg_id);
             files.push_back(index_file);
 
@@ -2350,6 +2950,10 @@ void OLAPEngine::revoke_files_from_gc(const std::vector<std::string>& files_to_c
                     break;
                 }
             }
+            if (!found && _gc_removing_files.erase(file) != 0) {
+                LOG(INFO) << "file:" << file << " is being removed by gc. revoke it";
+                found = true;
+            }
             if (!found) {
                 LOG(INFO) << "file:" << file << " does not exist in unused files";
             }
@@ -2607,6 +3211,14 @@ OLAPStatus OLAPEngine::compute_checksum(
         }
     }
 
+    // the rows of a duplicate key tablet are not merged, so the sum of their
+    // hashes over the versions is that over the rows read
+    if (config::consistency_checksum_from_segments
+            && tablet->keys_type() == KeysType::DUP_KEYS
+            && tablet->delete_data_conditions_size() == 0) {
+        return _compute_checksum_from_segments(tablet, version, checksum);
+    }
+
     Reader reader;
     ReaderParams reader_params;
     reader_params.olap_table = tablet;
@@ -2657,6 +3269,132 @@ OLAPStatus OLAPEngine::compute_checksum(
     return OLAP_SUCCESS;
 }
 
+OLAPStatus OLAPEngine::_compute_checksum_from_segments(
+        OLAPTablePtr tablet, TVersion version, uint32_t* checksum) {
+    std::vector<Version> span_versions;
+    std::vector<ColumnData*> olap_data_sources;
+    {
+        ReadLock rdlock(tablet->get_header_lock_ptr());
+        OLAPStatus res = tablet->select_versions_to_span(Version(0, version), &span_versions);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to select versions to span. res=" << res
+                         << ", tablet=" << tablet->full_name() << ", version=" << version;
+            return res;
+        }
+        tablet->acquire_data_sources_by_versions(span_versions, &olap_data_sources);
+        if (olap_data_sources.empty()) {
+            LOG(WARNING) << "fail to acquire data sources. tablet=" << tablet->full_name()
+                         << ", version=" << version;
+            return OLAP_ERR_VERSION_NOT_EXIST;
+        }
+    }
+
+    // root columns of the tablet, which the segments must have been written with
+    std::vector<const FieldInfo*> root_columns;
+    for (const FieldInfo& field_info : tablet->tablet_schema()) {
+        if (field_info.is_root_column) {
+            root_columns.push_back(&field_info);
+        }
+    }
+
+    // versions whose segments all carry a checksum of the current schema
+    std::map<Version, uint64_t> stored_sums;
+    std::set<Version> unstored_versions;
+    for (ColumnData* olap_data : olap_data_sources) {
+        SegmentGroup* segment_group = olap_data->segment_group();
+        Version data_version = segment_group->version();
+        uint64_t sum = 0;
+        bool stored = segment_group->empty() || segment_group->index_loaded();
+        for (int32_t seg_id = 0; stored && !segment_group->empty()
+                && seg_id < segment_group->num_segments(); ++seg_id) {
+            const ColumnDataHeaderMessage& header = segment_group->get_seg_pb(seg_id)->message();
+            stored = header.has_row_checksum() && static_cast<size_t>(header.column_size()) == root_columns.size();
+            for (int i = 0; stored && i < header.column_size(); ++i) {
+                const ColumnMessage& column = header.column(i);
+                const FieldInfo* field_info = root_columns[i];
+                stored = column.unique_id() == field_info->unique_id
+                    && column.type() == FieldInfo::get_string_by_field_type(field_info->type)
+                    && column.length() == field_info->length;
+            }
+            sum += header.row_checksum();
+        }
+        if (stored) {
+            stored_sums[data_version] += sum;
+        } else {
+            unstored_versions.insert(data_version);
+        }
+    }
+    tablet->release_data_sources(&olap_data_sources);
+
+    uint64_t row_checksum = 0;
+    for (auto& it : stored_sums) {
+        if (unstored_versions.count(it.first) == 0) {
+            row_checksum += it.second;
+        }
+    }
+    for (const Version& unstored_version : unstored_versions) {
+        uint64_t sum = 0;
+        OLAPStatus res = _sum_row_hashes(tablet, unstored_version, &sum);
+        if (res != OLAP_SUCCESS) {
+            return res;
+        }
+        row_checksum += sum;
+    }
+
+    LOG(INFO) << "success to finish compute checksum from segments. checksum=" << row_checksum
+              << ", versions=" << span_versions.size()
+              << ", read versions=" << unstored_versions.size();
+    *checksum = static_cast<uint32_t>(row_checksum) ^ static_cast<uint32_t>(row_checksum >> 32);
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus OLAPEngine::_sum_row_hashes(OLAPTablePtr tablet, const Version& version, uint64_t* sum) {
+    Reader reader;
+    ReaderParams reader_params;
+    reader_params.olap_table = tablet;
+    reader_params.reader_type = READER_CHECKSUM;
+    reader_params.version = version;
+
+    // the same columns as SegmentWriter hashes
+    for (size_t i = 0; i < tablet->tablet_schema().size(); ++i) {
+        FieldType type = tablet->get_field_type_by_index(i);
+        if (type == OLAP_FIELD_TYPE_FLOAT || type == OLAP_FIELD_TYPE_DOUBLE) {
+            continue;
+        }
+
+        reader_params.return_columns.push_back(i);
+    }
+
+    OLAPStatus res = reader.init(reader_params);
+    if (res != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("initiate reader fail. [res=%d]", res);
+        return res;
+    }
+
+    RowCursor row;
+    res = row.init(tablet->tablet_schema(), reader_params.return_columns);
+    if (res != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("failed to init row cursor. [res=%d]", res);
+        return res;
+    }
+    row.allocate_memory_for_string_type(tablet->tablet_schema());
+
+    bool eof = false;
+    *sum = 0;
+    while (true) {
+        res = reader.next_row_with_aggregation(&row, &eof);
+        if (res == OLAP_SUCCESS && eof) {
+            break;
+        } else if (res != OLAP_SUCCESS) {
+            OLAP_LOG_WARNING("fail to read in reader. [res=%d]", res);
+            return res;
+        }
+
+        *sum += row.hash_code(0);
+    }
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus OLAPEngine::cancel_delete(const TCancelDeleteDataReq& request) {
     LOG(INFO) << "begin to process cancel delete."
               << "tablet=" << request.tablet_id
@@ -18,7 +18,9 @@
 #ifndef DORIS_BE_SRC_OLAP_OLAP_ENGINE_H
 #define DORIS_BE_SRC_OLAP_OLAP_ENGINE_H
 
+#include <atomic>
 #include <ctime>
+#include <functional>
 #include <list>
 #include <map>
 #include <mutex>
@@ -27,6 +29,8 @@
 #include <string>
 #include <vector>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <rapidjson/document.h>
 #include <pthread.h>
@@ -37,12 +41,15 @@
 #include "gen_cpp/BackendService_types.h"
 #include "gen_cpp/MasterService_types.h"
 #include "olap/atomic.h"
+#include "olap/cold_storage.h"
+#include "olap/compaction_scheduler.h"
 #include "olap/lru_cache.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/olap_table.h"
 #include "olap/olap_meta.h"
 #include "olap/options.h"
+#include "runtime/mem_tracker.h"
 
 namespace doris {
 
@@ -129,6 +136,13 @@ public:
     bool has_transaction(TPartitionId partition_id, TTransactionId transaction_id,
                          TTabletId tablet_id, SchemaHash schema_hash);
 
+    // Attaches the segment groups written into 'dir' by SegmentGroupBuilder to
+    // the transaction of the tablet, they are visible once it is published.
+    // The files are hard linked, or copied if 'dir' is on another disk.
+    OLAPStatus ingest_segment_groups(TTabletId tablet_id, SchemaHash schema_hash,
+                                     TPartitionId partition_id, TTransactionId transaction_id,
+                                     const PUniqueId& load_id, const std::string& dir);
+
     OLAPStatus publish_version(const TPublishVersionRequest& publish_version_req,
                          std::vector<TTabletId>* error_tablet_ids);
 
@@ -170,10 +184,38 @@ public:
     // Return OLAP_SUCCESS, if run ok
     //        OLAP_ERR_INPUT_PARAMETER_ERROR, if tables is null
     OLAPStatus report_tablet_info(TTabletInfo* tablet_info);
-    OLAPStatus report_all_tablets_info(std::map<TTabletId, TTablet>* tablets_info);
+    // the value distributions of the columns are only reported for the tablets of
+    // 'changed_tablet_ids', i.e. after they change, since they are large
+    OLAPStatus report_all_tablets_info(std::map<TTabletId, TTablet>* tablets_info,
+                                       const std::set<TTabletId>* changed_tablet_ids = nullptr);
+    // reports the tablets of 'tablet_ids' which exist, for incremental tablet reports
+    OLAPStatus report_tablets_info(const std::set<TTabletId>& tablet_ids,
+                                   std::map<TTabletId, TTablet>* tablets_info);
+
+    // Tablets are changed for the tablet reports when their headers are saved.
+    void mark_tablet_changed(TTabletId tablet_id) {
+        std::lock_guard<std::mutex> l(_changed_tablets_lock);
+        _changed_tablets.insert(tablet_id);
+    }
+
+    // moves the tablets changed since the last call into 'tablet_ids'
+    void take_changed_tablets(std::set<TTabletId>* tablet_ids) {
+        std::lock_guard<std::mutex> l(_changed_tablets_lock);
+        tablet_ids->swap(_changed_tablets);
+        _changed_tablets.clear();
+    }
+
+    // changes again the tablets taken for a report which failed
+    void restore_changed_tablets(const std::set<TTabletId>& tablet_ids) {
+        std::lock_guard<std::mutex> l(_changed_tablets_lock);
+        _changed_tablets.insert(tablet_ids.begin(), tablet_ids.end());
+    }
 
     void get_tablet_stat(TTabletStatResult& result);
 
+    // the heats of the base tables of all tablets, decayed to now
+    void get_tablet_heats(std::vector<std::pair<TTabletId, TTabletHeat>>* heats);
+
     // Instance should be inited from create_instance
     // MUST NOT be called in other circumstances.
     OLAPStatus open();
@@ -208,6 +250,35 @@ public:
         return _index_stream_lru_cache;
     }
 
+    // NULL if data_page_cache_capacity is 0
+    Cache* data_page_cache() {
+        return _data_page_cache;
+    }
+
+    MemTracker* data_page_cache_mem_tracker() {
+        return _data_page_cache_mem_tracker.get();
+    }
+
+    // NULL if short_key_index_cache_capacity is 0
+    Cache* short_key_index_cache() {
+        return _short_key_index_cache;
+    }
+
+    // memory of the short key index entries, cached or not
+    MemTracker* short_key_index_mem_tracker() {
+        return _short_key_index_mem_tracker.get();
+    }
+
+    // NULL if cold_storage_uri is empty
+    ColdFileManager* cold_file_manager() {
+        return _cold_file_manager.get();
+    }
+
+    // memory of the memtables waiting for or being flushed in the background
+    MemTracker* memtable_flush_mem_tracker() {
+        return _memtable_flush_mem_tracker.get();
+    }
+
     // 清理trash和snapshot文件，返回清理后的磁盘使用量
     OLAPStatus start_trash_sweep(double *usage);
 
@@ -270,6 +341,11 @@ public:
 
     void start_delete_unused_index();
 
+    // moves the tablets on SSD not queried for storage_cooldown_idle_second
+    // to HDD, and the old versions of the tablets not queried for
+    // cold_storage_idle_second to the cold storage
+    void start_storage_cooldown();
+
     void add_unused_index(SegmentGroup* olap_index);
 
     // check whether files are in gc's unused files
@@ -467,10 +543,23 @@ private:
 
     OLAPStatus _create_hard_link(const std::string& from_path, const std::string& to_path);
 
+    OLAPStatus _ingest_segment_groups(OLAPTablePtr table, TPartitionId partition_id,
+                                      TTransactionId transaction_id, const PUniqueId& load_id,
+                                      const std::string& dir,
+                                      const std::vector<PPendingSegmentGroup>& metas);
+
     OLAPStatus _start_bg_worker();
 
     OLAPStatus _create_init_version(OLAPTablePtr olap_table, const TCreateTabletReq& request);
 
+    // Sums the row checksums stored in the segments of versions [0, version],
+    // the versions written without them are read.
+    OLAPStatus _compute_checksum_from_segments(OLAPTablePtr tablet, TVersion version,
+                                               uint32_t* checksum);
+
+    // Sums the hashes of the rows of the version by reading them.
+    OLAPStatus _sum_row_hashes(OLAPTablePtr tablet, const Version& version, uint64_t* sum);
+
 private:
     struct TableInstances {
         Mutex schema_change_lock;
@@ -510,9 +599,42 @@ private:
         bool is_used;
     };
 
-    typedef std::map<int64_t, TableInstances> tablet_map_t;
+    // Tablets are spread over shards by tablet id, each shard has its own
+    // lock, so reports and GC walking the tablets shard by shard only block
+    // the lookups of the shard they are in.
+    static const int TABLET_MAP_SHARD_NUM = 128;
+    typedef std::unordered_map<int64_t, TableInstances> tablet_map_t;
+    struct TabletMapShard {
+        RWMutex lock;
+        tablet_map_t tablet_map;
+    };
+
+    using TxnKey = std::pair<int64_t, int64_t>; // partition_id, transaction_id;
+    struct TxnKeyHash {
+        size_t operator()(const TxnKey& key) const {
+            return std::hash<int64_t>()(key.first) * 31 + std::hash<int64_t>()(key.second);
+        }
+    };
+    typedef std::unordered_map<TxnKey, std::map<TabletInfo, std::vector<PUniqueId>>,
+                               TxnKeyHash> txn_tablet_map_t;
+    // transactions are looked up by their id, so they are sharded by it
+    static const int TXN_MAP_SHARD_NUM = 64;
+    struct TxnMapShard {
+        RWMutex lock;
+        txn_tablet_map_t txn_tablet_map;
+    };
+
     typedef std::map<std::string, uint32_t> file_system_task_count_t;
 
+    TabletMapShard& _tablet_map_shard(TTabletId tablet_id) {
+        return _tablet_map_shards[static_cast<uint64_t>(tablet_id) % TABLET_MAP_SHARD_NUM];
+    }
+
+    TxnMapShard& _txn_map_shard(TTransactionId transaction_id) {
+        return _txn_map_shards[static_cast<uint64_t>(transaction_id) % TXN_MAP_SHARD_NUM];
+    }
+
+    // the shard lock of tablet_id must be held
     OLAPTablePtr _get_table_with_no_lock(TTabletId tablet_id, SchemaHash schema_hash);
 
     // 遍历root所指定目录, 通过dirs返回此目录下所有有文件夹的名字, files返回所有文件的名字
@@ -539,7 +661,17 @@ private:
     OLAPStatus _do_sweep(
             const std::string& scan_root, const time_t& local_tm_now, const uint32_t expire);
 
+    // Removes the files for which may_remove returns true, at most
+    // gc_max_files_removed_per_second_per_disk a second on every disk, which
+    // are taken in turn, not to slow down the reads of the disks. Returns the
+    // count of files failed to be removed.
+    size_t _remove_files_throttled(const std::vector<std::string>& files,
+                                   const std::function<bool(const std::string&)>& may_remove);
+
     void _build_tablet_info(OLAPTablePtr olap_table, TTabletInfo* tablet_info);
+    // builds the report of all the tables of a tablet, the lock of its shard must be held
+    void _build_tablet_report(const TableInstances& instances, TTablet* tablet,
+                              bool with_column_distributions);
     void _build_tablet_stat();
 
     EngineOptions _options;
@@ -554,14 +686,18 @@ private:
     // 错误磁盘所在百分比，超过设定的值，则engine需要退出运行
     uint32_t _min_percentage_of_error_disk;
 
-    RWMutex _tablet_map_lock;
-    tablet_map_t _tablet_map;
-    RWMutex _transaction_tablet_map_lock;
-    using TxnKey = std::pair<int64_t, int64_t>; // partition_id, transaction_id;
-    std::map<TxnKey, std::map<TabletInfo, std::vector<PUniqueId>>> _transaction_tablet_map;
-    size_t _global_table_id;
+    TabletMapShard _tablet_map_shards[TABLET_MAP_SHARD_NUM];
+    TxnMapShard _txn_map_shards[TXN_MAP_SHARD_NUM];
+    std::atomic<size_t> _global_table_id;
     Cache* _file_descriptor_lru_cache;
     Cache* _index_stream_lru_cache;
+    Cache* _data_page_cache;
+    std::unique_ptr<MemTracker> _data_page_cache_mem_tracker;
+    Cache* _short_key_index_cache;
+    std::unique_ptr<MemTracker> _short_key_index_mem_tracker;
+    std::unique_ptr<MemTracker> _memtable_flush_mem_tracker;
+    std::unique_ptr<ColdStorage> _cold_storage;
+    std::unique_ptr<ColdFileManager> _cold_file_manager;
     uint32_t _max_base_compaction_task_per_disk;
     uint32_t _max_cumulative_compaction_task_per_disk;
 
@@ -573,20 +709,29 @@ private:
     // TODO(cmy): for now, this is a naive implementation
     std::map<int64_t, TTabletStat> _tablet_stat_cache;
     std::mutex _tablet_stat_mutex;
+
+    std::mutex _changed_tablets_lock;
+    // tablets changed since the last tablet report
+    std::set<TTabletId> _changed_tablets;
     // last update time of tablet stat cache
     int64_t _tablet_stat_cache_update_time_ms;
 
     static OLAPEngine* _s_instance;
 
-    // snapshot
-    Mutex _snapshot_mutex;
-    uint64_t _snapshot_base_id;
+    // suffix of the next snapshot path, snapshots are made concurrently
+    std::atomic<uint64_t> _snapshot_base_id;
 
     std::unordered_map<SegmentGroup*, std::vector<std::string>> _gc_files;
+    // files of the unused segment groups taken out of _gc_files which are
+    // being removed, they may still be revoked until they are
+    std::unordered_set<std::string> _gc_removing_files;
     Mutex _gc_mutex;
 
     // Thread functions
 
+    // decides when the compaction threads may start a compaction
+    std::unique_ptr<CompactionScheduler> _compaction_scheduler;
+
     // base compaction thread process function
     void* _base_compaction_thread_callback(void* arg, OlapStore* store);
 
@@ -605,6 +750,12 @@ private:
     // clean file descriptors cache
     void* _fd_cache_clean_callback(void* arg);
 
+    // move the tablets not queried for long from SSD to HDD
+    void* _storage_cooldown_thread_callback(void* arg);
+
+    void _migrate_cold_tablets();
+    void _offload_cold_versions();
+
     // thread to monitor snapshot expiry
     std::thread _garbage_sweeper_thread;
 
@@ -614,6 +765,9 @@ private:
     // thread to monitor unused index
     std::thread _unused_index_thread;
 
+    // thread to cool down the tablets on SSD
+    std::thread _storage_cooldown_thread;
+
     // thread to run base compaction
     std::vector<std::thread> _base_compaction_threads;
 
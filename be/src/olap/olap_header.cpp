@@ -215,7 +215,8 @@ OLAPStatus OLAPHeader::save(const string& file_path) {
 OLAPStatus OLAPHeader::add_version(Version version, VersionHash version_hash,
                 int32_t segment_group_id, int32_t num_segments,
                 int64_t index_size, int64_t data_size, int64_t num_rows,
-                bool empty, const std::vector<KeyRange>* column_statistics) {
+                bool empty, const std::vector<KeyRange>* column_statistics,
+                const std::vector<ColumnDistribution>* column_distributions, bool packed) {
     // Check whether version is valid.
     if (version.first > version.second) {
         LOG(WARNING) << "the version is not valid."
@@ -263,6 +264,7 @@ OLAPStatus OLAPHeader::add_version(Version version, VersionHash version_hash,
         new_segment_group->set_data_size(data_size);
         new_segment_group->set_num_rows(num_rows);
         new_segment_group->set_empty(empty);
+        new_segment_group->set_packed(packed);
         if (NULL != column_statistics) {
             for (size_t i = 0; i < column_statistics->size(); ++i) {
                 ColumnPruning *column_pruning =
@@ -272,6 +274,11 @@ OLAPStatus OLAPHeader::add_version(Version version, VersionHash version_hash,
                 column_pruning->set_null_flag(column_statistics->at(i).first->is_null());
             }
         }
+        if (column_distributions != nullptr) {
+            for (const ColumnDistribution& column_distribution : *column_distributions) {
+                *new_segment_group->add_column_distribution() = column_distribution;
+            }
+        }
     } catch (...) {
         OLAP_LOG_WARNING("add file version to protobf error");
         return OLAP_ERR_HEADER_ADD_VERSION;
@@ -325,7 +332,8 @@ OLAPStatus OLAPHeader::add_pending_version(
 OLAPStatus OLAPHeader::add_pending_segment_group(
         int64_t transaction_id, int32_t num_segments,
         int32_t pending_segment_group_id, const PUniqueId& load_id,
-        bool empty, const std::vector<KeyRange>* column_statistics) {
+        bool empty, const std::vector<KeyRange>* column_statistics,
+        const std::vector<ColumnDistribution>* column_distributions, bool packed) {
 
     int32_t delta_id = 0;
     for (int32_t i = 0; i < pending_delta_size(); ++i) {
@@ -352,6 +360,7 @@ OLAPStatus OLAPHeader::add_pending_segment_group(
         new_pending_segment_group->mutable_load_id()->set_hi(load_id.hi());
         new_pending_segment_group->mutable_load_id()->set_lo(load_id.lo());
         new_pending_segment_group->set_empty(empty);
+        new_pending_segment_group->set_packed(packed);
         if (NULL != column_statistics) {
             for (size_t i = 0; i < column_statistics->size(); ++i) {
                 ColumnPruning *column_pruning =
@@ -361,6 +370,11 @@ OLAPStatus OLAPHeader::add_pending_segment_group(
                 column_pruning->set_null_flag(column_statistics->at(i).first->is_null());
             }
         }
+        if (column_distributions != nullptr) {
+            for (const ColumnDistribution& column_distribution : *column_distributions) {
+                *new_pending_segment_group->add_column_distribution() = column_distribution;
+            }
+        }
     } catch (...) {
         OLAP_LOG_WARNING("fail to add pending segment_group to protobf");
         return OLAP_ERR_HEADER_ADD_PENDING_DELTA;
@@ -372,7 +386,7 @@ OLAPStatus OLAPHeader::add_pending_segment_group(
 OLAPStatus OLAPHeader::add_incremental_version(Version version, VersionHash version_hash,
                 int32_t segment_group_id, int32_t num_segments,
                 int64_t index_size, int64_t data_size, int64_t num_rows,
-                bool empty, const std::vector<KeyRange>* column_statistics) {
+                bool empty, const std::vector<KeyRange>* column_statistics, bool packed) {
     // Check whether version is valid.
     if (version.first != version.second) {
         OLAP_LOG_WARNING("the incremental version is not valid. [version=%d]", version.first);
@@ -416,6 +430,7 @@ OLAPStatus OLAPHeader::add_incremental_version(Version version, VersionHash vers
         new_incremental_segment_group->set_data_size(data_size);
         new_incremental_segment_group->set_num_rows(num_rows);
         new_incremental_segment_group->set_empty(empty);
+        new_incremental_segment_group->set_packed(packed);
         if (NULL != column_statistics) {
             for (size_t i = 0; i < column_statistics->size(); ++i) {
                 ColumnPruning *column_pruning =
@@ -864,6 +879,8 @@ const uint32_t OLAPHeader::get_base_compaction_score() const{
             base_version_exists = true;
         }
     }
+    // 每个delete条件在读时都要被执行, 直到base compaction把它合并掉
+    score += delete_data_conditions_size();
     score = score < config::base_compaction_num_cumulative_deltas ? 0 : score;
 
     // base不存在可能是tablet正在做alter table，先不选它，设score=0
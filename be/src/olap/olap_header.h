@@ -19,6 +19,7 @@
 #define DORIS_BE_SRC_OLAP_OLAP_HEADER_H
 
 #include <list>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -64,19 +65,24 @@ public:
     OLAPStatus add_version(Version version, VersionHash version_hash,
                            int32_t segment_group_id, int32_t num_segments,
                            int64_t index_size, int64_t data_size, int64_t num_rows,
-                           bool empty, const std::vector<KeyRange>* column_statistics);
+                           bool empty, const std::vector<KeyRange>* column_statistics,
+                           const std::vector<ColumnDistribution>* column_distributions = nullptr,
+                           bool packed = false);
 
     OLAPStatus add_pending_version(int64_t partition_id, int64_t transaction_id,
                                  const std::vector<std::string>* delete_conditions);
     OLAPStatus add_pending_segment_group(int64_t transaction_id, int32_t num_segments,
                                   int32_t pending_segment_group_id, const PUniqueId& load_id,
-                                  bool empty, const std::vector<KeyRange>* column_statistics);
+                                  bool empty, const std::vector<KeyRange>* column_statistics,
+                                  const std::vector<ColumnDistribution>* column_distributions = nullptr,
+                                  bool packed = false);
 
     // add incremental segment_group into header like "9-9" "10-10", for incremental cloning
     OLAPStatus add_incremental_version(Version version, VersionHash version_hash,
                                        int32_t segment_group_id, int32_t num_segments,
                                        int64_t index_size, int64_t data_size, int64_t num_rows,
-                                       bool empty, const std::vector<KeyRange>* column_statistics);
+                                       bool empty, const std::vector<KeyRange>* column_statistics,
+                                       bool packed = false);
 
     void add_delete_condition(const DeleteConditionMessage& delete_condition, int64_t version);
     void delete_cond_by_version(const Version& version);
@@ -124,7 +130,23 @@ public:
         return delta_size();
     }
     void change_file_version_to_delta();
+
+    // what tells whether a delta saved as a record of its own was changed
+    struct DeltaRecordStat {
+        int64_t version_hash;
+        int64_t creation_time;
+        int segment_group_size;
+
+        bool operator==(const DeltaRecordStat& other) const {
+            return version_hash == other.version_hash
+                && creation_time == other.creation_time
+                && segment_group_size == other.segment_group_size;
+        }
+    };
+
 private:
+    friend class OlapHeaderManager;
+
     // Compute schema hash(all fields name and type, index name and its field
     // names) using lzo_adler32 function.
     OLAPStatus _compute_schema_hash(SchemaHash* schema_hash);
@@ -150,7 +172,13 @@ private:
     // vertex value --> vertex_index of _version_graph
     // It is easy to find vertex index according to vertex value.
     std::unordered_map<int, int> _vertex_helper_map;
-    
+
+    // the deltas of this header saved in the meta as records of their own,
+    // kept by OlapHeaderManager to only write the ones changed at every save
+    mutable std::map<Version, DeltaRecordStat> _delta_records;
+    // false until the records in the meta are known
+    mutable bool _delta_records_loaded = false;
+
     DISALLOW_COPY_AND_ASSIGN(OLAPHeader);
 };
 
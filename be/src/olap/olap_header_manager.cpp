@@ -17,12 +17,17 @@
 
 #include "olap/olap_header_manager.h"
 
+#include <set>
 #include <vector>
 #include <sstream>
 #include <string>
 #include <fstream>
 #include <boost/algorithm/string/trim.hpp>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/wire_format_lite.h>
 
+#include "common/config.h"
 #include "olap/olap_define.h"
 #include "olap/olap_engine.h"
 #include "olap/olap_meta.h"
@@ -45,13 +50,84 @@ using rocksdb::kDefaultColumnFamilyName;
 namespace doris {
 
 const std::string HEADER_PREFIX = "hdr_";
+// The deltas of a header may be saved as records of their own, under
+// "hdrd_" + tablet_id + "_" + schema_hash + "_" + start and end version in
+// hex, so they follow each other by version. A record holds the delta encoded
+// as the delta field of OLAPHeaderMessage, so appending the records to the
+// rest of the header gives the whole header.
+const std::string HEADER_DELTA_PREFIX = "hdrd_";
+
+static std::string header_key(TTabletId tablet_id, TSchemaHash schema_hash) {
+    std::stringstream key_stream;
+    key_stream << HEADER_PREFIX << tablet_id << "_" << schema_hash;
+    return key_stream.str();
+}
+
+static std::string delta_record_prefix(TTabletId tablet_id, TSchemaHash schema_hash) {
+    std::stringstream key_stream;
+    key_stream << HEADER_DELTA_PREFIX << tablet_id << "_" << schema_hash << "_";
+    return key_stream.str();
+}
+
+static std::string delta_record_key(const std::string& prefix, const Version& version) {
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%016lx%016lx", version.first, version.second);
+    return prefix + buf;
+}
+
+static bool parse_delta_record_key(const std::string& prefix, const std::string& key,
+                                   Version* version) {
+    if (key.size() != prefix.size() + 32) {
+        return false;
+    }
+    version->first = strtoll(key.substr(prefix.size(), 16).c_str(), nullptr, 16);
+    version->second = strtoll(key.substr(prefix.size() + 16).c_str(), nullptr, 16);
+    return true;
+}
+
+static void encode_delta_record(const PDelta& delta, std::string* value) {
+    using google::protobuf::internal::WireFormatLite;
+    value->clear();
+    google::protobuf::io::StringOutputStream string_stream(value);
+    google::protobuf::io::CodedOutputStream output(&string_stream);
+    output.WriteTag(WireFormatLite::MakeTag(OLAPHeaderMessage::kDeltaFieldNumber,
+                                            WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+    output.WriteVarint32(delta.ByteSize());
+    delta.SerializeWithCachedSizes(&output);
+}
+
+// appends the delta records of the tablet to 'value', the versions of the
+// records to 'versions' if it is not null
+static OLAPStatus append_delta_records(OlapMeta* meta, TTabletId tablet_id,
+        TSchemaHash schema_hash, std::string* value, std::set<Version>* versions) {
+    std::string prefix = delta_record_prefix(tablet_id, schema_hash);
+    auto append_func = [&](const std::string& key, const std::string& record) -> bool {
+        Version version;
+        if (!parse_delta_record_key(prefix, key, &version)) {
+            LOG(WARNING) << "invalid header delta key:" << key;
+            return true;
+        }
+        value->append(record);
+        if (versions != nullptr) {
+            versions->insert(version);
+        }
+        return true;
+    };
+    return meta->iterate(META_COLUMN_FAMILY_INDEX, prefix, append_func);
+}
+
+static OLAPHeader::DeltaRecordStat delta_record_stat(const PDelta& delta) {
+    OLAPHeader::DeltaRecordStat stat;
+    stat.version_hash = delta.version_hash();
+    stat.creation_time = delta.creation_time();
+    stat.segment_group_size = delta.segment_group_size();
+    return stat;
+}
 
 OLAPStatus OlapHeaderManager::get_header(OlapStore* store,
         TTabletId tablet_id, TSchemaHash schema_hash, OLAPHeader* header) {
     OlapMeta* meta = store->get_meta();
-    std::stringstream key_stream;
-    key_stream << HEADER_PREFIX << tablet_id << "_" << schema_hash;
-    std::string key = key_stream.str();
+    std::string key = header_key(tablet_id, schema_hash);
     std::string value;
     OLAPStatus s = meta->get(META_COLUMN_FAMILY_INDEX, key, value);
     if (s == OLAP_ERR_META_KEY_NOT_FOUND) {
@@ -61,7 +137,22 @@ OLAPStatus OlapHeaderManager::get_header(OlapStore* store,
         LOG(WARNING) << "load tablet_id:" << tablet_id << ", schema_hash:" << schema_hash << " failed.";
         return s;
     }
+    std::set<Version> record_versions;
+    s = append_delta_records(meta, tablet_id, schema_hash, &value, &record_versions);
+    if (s != OLAP_SUCCESS) {
+        LOG(WARNING) << "load delta records of tablet_id:" << tablet_id
+            << ", schema_hash:" << schema_hash << " failed.";
+        return s;
+    }
     header->ParseFromString(value);
+    header->_delta_records.clear();
+    for (const PDelta& delta : header->delta()) {
+        Version version(delta.start_version(), delta.end_version());
+        if (record_versions.count(version) != 0) {
+            header->_delta_records[version] = delta_record_stat(delta);
+        }
+    }
+    header->_delta_records_loaded = true;
     return header->init();
 }
 
@@ -79,25 +170,97 @@ OLAPStatus OlapHeaderManager::get_json_header(OlapStore* store,
 }
 
 
+OLAPStatus OlapHeaderManager::_load_delta_records(OlapMeta* meta,
+        TTabletId tablet_id, TSchemaHash schema_hash, const OLAPHeader* header) {
+    std::string prefix = delta_record_prefix(tablet_id, schema_hash);
+    header->_delta_records.clear();
+    auto load_func = [&](const std::string& key, const std::string& record) -> bool {
+        Version version;
+        OLAPHeaderMessage message;
+        if (!parse_delta_record_key(prefix, key, &version)
+                || !message.ParsePartialFromString(record) || message.delta_size() != 1) {
+            LOG(WARNING) << "invalid header delta record, key:" << key;
+            return true;
+        }
+        header->_delta_records[version] = delta_record_stat(message.delta(0));
+        return true;
+    };
+    OLAPStatus s = meta->iterate(META_COLUMN_FAMILY_INDEX, prefix, load_func);
+    if (s != OLAP_SUCCESS) {
+        return s;
+    }
+    header->_delta_records_loaded = true;
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus OlapHeaderManager::save(OlapStore* store,
         TTabletId tablet_id, TSchemaHash schema_hash, const OLAPHeader* header) {
-    std::stringstream key_stream;
-    key_stream << HEADER_PREFIX << tablet_id << "_" << schema_hash;
-    std::string key = key_stream.str();
-    std::string value;
-    header->SerializeToString(&value);
     OlapMeta* meta = store->get_meta();
-    OLAPStatus s = meta->put(META_COLUMN_FAMILY_INDEX, key, value);
+    if (!header->_delta_records_loaded) {
+        // the header was not read from this meta, records of a header saved
+        // before under the same key may be there
+        OLAPStatus s = _load_delta_records(meta, tablet_id, schema_hash, header);
+        if (s != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to load delta records, tablet_id:" << tablet_id
+                << ", schema_hash:" << schema_hash;
+            return s;
+        }
+    }
+
+    std::string prefix = delta_record_prefix(tablet_id, schema_hash);
+    std::vector<std::pair<std::string, std::string>> puts;
+    std::vector<std::string> removes;
+    std::map<Version, OLAPHeader::DeltaRecordStat> records;
+    std::string value;
+    if (config::save_header_delta_records) {
+        for (const PDelta& delta : header->delta()) {
+            Version version(delta.start_version(), delta.end_version());
+            OLAPHeader::DeltaRecordStat stat = delta_record_stat(delta);
+            records[version] = stat;
+            auto it = header->_delta_records.find(version);
+            if (it != header->_delta_records.end() && it->second == stat) {
+                continue;
+            }
+            std::string record;
+            encode_delta_record(delta, &record);
+            puts.emplace_back(delta_record_key(prefix, version), std::move(record));
+        }
+        OLAPHeaderMessage base;
+        base.CopyFrom(*header);
+        base.clear_delta();
+        base.SerializeToString(&value);
+    } else {
+        header->SerializeToString(&value);
+    }
+    for (auto& it : header->_delta_records) {
+        if (records.count(it.first) == 0) {
+            removes.push_back(delta_record_key(prefix, it.first));
+        }
+    }
+    puts.emplace_back(header_key(tablet_id, schema_hash), std::move(value));
+
+    OLAPStatus s = meta->write_batch(META_COLUMN_FAMILY_INDEX, puts, removes);
+    if (s == OLAP_SUCCESS) {
+        header->_delta_records.swap(records);
+    }
     return s;
 }
 
 OLAPStatus OlapHeaderManager::remove(OlapStore* store, TTabletId tablet_id, TSchemaHash schema_hash) {
-    std::stringstream key_stream;
-    key_stream << HEADER_PREFIX << tablet_id << "_" << schema_hash;
-    std::string key = key_stream.str();
+    std::string key = header_key(tablet_id, schema_hash);
     OlapMeta* meta = store->get_meta();
     LOG(INFO) << "start to remove header, key:" << key;
-    OLAPStatus res = meta->remove(META_COLUMN_FAMILY_INDEX, key);
+    std::string prefix = delta_record_prefix(tablet_id, schema_hash);
+    std::vector<std::string> removes;
+    OLAPStatus res = meta->iterate(META_COLUMN_FAMILY_INDEX, prefix,
+            [&removes](const std::string& record_key, const std::string& record) -> bool {
+                removes.push_back(record_key);
+                return true;
+            });
+    if (res == OLAP_SUCCESS) {
+        removes.push_back(key);
+        res = meta->write_batch(META_COLUMN_FAMILY_INDEX, {}, removes);
+    }
     LOG(INFO) << "remove header, key:" << key << ", res:" << res;
     return res;
 }
@@ -127,7 +290,7 @@ OLAPStatus OlapHeaderManager::set_converted_flag(OlapStore* store) {
 
 OLAPStatus OlapHeaderManager::traverse_headers(OlapMeta* meta,
         std::function<bool(long, long, const std::string&)> const& func) {
-    auto traverse_header_func = [&func](const std::string& key, const std::string& value) -> bool {
+    auto traverse_header_func = [meta, &func](const std::string& key, const std::string& value) -> bool {
         std::vector<std::string> parts;
         // key format: "hdr_" + tablet_id + "_" + schema_hash
         split_string<char>(key, '_', &parts);
@@ -137,7 +300,12 @@ OLAPStatus OlapHeaderManager::traverse_headers(OlapMeta* meta,
         }
         TTabletId tablet_id = std::stol(parts[1].c_str(), NULL, 10);
         TSchemaHash schema_hash = std::stol(parts[2].c_str(), NULL, 10);
-        return func(tablet_id, schema_hash, value);
+        std::string header = value;
+        if (append_delta_records(meta, tablet_id, schema_hash, &header, nullptr) != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to load delta records of header key:" << key;
+            return true;
+        }
+        return func(tablet_id, schema_hash, header);
     };
     OLAPStatus status = meta->iterate(META_COLUMN_FAMILY_INDEX, HEADER_PREFIX, traverse_header_func);
     return status;
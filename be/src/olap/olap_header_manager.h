@@ -49,6 +49,12 @@ public:
 
     static OLAPStatus dump_header(OlapStore* store, TTabletId tablet_id,
             TSchemaHash schema_hash, const std::string& path);
+
+private:
+    // finds the delta records of the tablet in the meta for the next save of
+    // 'header'
+    static OLAPStatus _load_delta_records(OlapMeta* meta, TTabletId tablet_id,
+            TSchemaHash schema_hash, const OLAPHeader* header);
 };
 
 }
@@ -35,6 +35,118 @@ using std::vector;
 
 namespace doris {
 
+namespace {
+
+// Writes the short key columns of an entry or a search key into 8 bytes
+// which compare with memcmp the way Field::index_cmp compares the columns.
+// Every column starts with a byte which is 0 for NULL and 1 otherwise.
+// Encoding stops after a column whose values may be longer than what
+// remains, or whose type has no such encoding.
+class KeyPrefixEncoder {
+public:
+    // Returns false if no more columns may follow
+    bool append(const FieldInfo& field, bool is_null, const char* content) {
+        if (!_put(is_null ? 0 : 1)) {
+            return false;
+        }
+        if (is_null) {
+            return true;
+        }
+        switch (field.type) {
+        case OLAP_FIELD_TYPE_TINYINT:
+            return _put_signed<int8_t>(content);
+        case OLAP_FIELD_TYPE_SMALLINT:
+            return _put_signed<int16_t>(content);
+        case OLAP_FIELD_TYPE_INT:
+            return _put_signed<int32_t>(content);
+        case OLAP_FIELD_TYPE_BIGINT:
+        case OLAP_FIELD_TYPE_DATETIME:
+            return _put_signed<int64_t>(content);
+        case OLAP_FIELD_TYPE_LARGEINT:
+            // the high half already fills the prefix
+            _put_signed<int64_t>(content + sizeof(int64_t));
+            return false;
+        case OLAP_FIELD_TYPE_DATE:
+            // uint24_t, little endian
+            return _put(content[2]) && _put(content[1]) && _put(content[0]);
+        case OLAP_FIELD_TYPE_CHAR: {
+            const Slice* slice = reinterpret_cast<const Slice*>(content);
+            size_t size = std::min(slice->size, static_cast<size_t>(field.index_length));
+            for (size_t i = 0; i < size && _put(slice->data[i]); ++i) {}
+            return false;
+        }
+        case OLAP_FIELD_TYPE_VARCHAR: {
+            // index_cmp compares long values with strncmp, which ends at '\0'
+            const Slice* slice = reinterpret_cast<const Slice*>(content);
+            size_t size = std::min(slice->size,
+                                   static_cast<size_t>(field.index_length - OLAP_STRING_MAX_BYTES));
+            for (size_t i = 0; i < size && slice->data[i] != '\0' && _put(slice->data[i]); ++i) {}
+            return false;
+        }
+        default:
+            return false;
+        }
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    uint64_t value() const {
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(_buf); ++i) {
+            value = (value << 8) | _buf[i];
+        }
+        return value;
+    }
+
+private:
+    bool _put(uint8_t byte) {
+        if (_size == sizeof(_buf)) {
+            return false;
+        }
+        _buf[_size++] = byte;
+        return true;
+    }
+
+    // big endian with the sign bit flipped
+    template<typename T>
+    bool _put_signed(const char* content) {
+        T value;
+        memcpy(&value, content, sizeof(T));
+        uint64_t bits = static_cast<uint64_t>(value) ^ (1ULL << (sizeof(T) * 8 - 1));
+        for (int i = sizeof(T) - 1; i >= 0; --i) {
+            if (!_put(bits >> (i * 8))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint8_t _buf[8] = {0};
+    size_t _size = 0;
+};
+
+// Number of prefixes less than 'key' (or not greater, if 'or_equal'),
+// without branches on the compared values
+size_t prefix_bound(const uint64_t* prefixes, size_t count,
+                    uint64_t key, uint64_t mask, bool or_equal) {
+    if (count == 0) {
+        return 0;
+    }
+    const uint64_t* base = prefixes;
+    while (count > 1) {
+        size_t half = count / 2;
+        uint64_t value = base[half] & mask;
+        base += (value < key || (or_equal && value == key)) ? half : 0;
+        count -= half;
+    }
+    uint64_t value = *base & mask;
+    return (base - prefixes) + (value < key || (or_equal && value == key));
+}
+
+}  // namespace
+
 MemIndex::MemIndex()
     : _key_length(0),
       _num_entries(0),
@@ -54,7 +166,9 @@ MemIndex::~MemIndex() {
     }
 }
 
-OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per_row_block) {
+OLAPStatus MemIndex::load_segment(FileHandler* file_handler,
+                                  size_t *current_num_rows_per_row_block,
+                                  bool load_entries) {
     OLAPStatus res = OLAP_SUCCESS;
 
     SegmentMetaInfo meta;
@@ -62,23 +176,19 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
     uint32_t adler_checksum = 0;
     uint32_t num_entries = 0;
 
-    if (file == NULL) {
+    if (file_handler == NULL) {
         res = OLAP_ERR_INPUT_PARAMETER_ERROR;
-        OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
+        OLAP_LOG_WARNING("load segment for loading index error. [res=%d]", res);
         return res;
     }
+    // kept for the messages, the handler forgets the name when closed
+    std::string file_name = file_handler->file_name();
+    const char* file = file_name.c_str();
 
-    FileHandler file_handler;
-    if ((res = file_handler.open_with_cache(file, O_RDONLY)) != OLAP_SUCCESS) {
-        OLAP_LOG_WARNING("fail to open index file. [file='%s']", file);
-        OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        return res;
-    }
-
-    if ((res = meta.file_header.unserialize(&file_handler)) != OLAP_SUCCESS) {
+    if ((res = meta.file_header.unserialize(file_handler)) != OLAP_SUCCESS) {
         OLAP_LOG_WARNING("fail to read index file header. [file='%s']", file);
         OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
+        file_handler->close();
         return res;
     }
 
@@ -105,7 +215,7 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
         res = OLAP_ERR_INDEX_LOAD_ERROR;
         OLAP_LOG_WARNING("fail to load_segment, buffer length is not correct.");
         OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
+        file_handler->close();
         return res;
     }
 
@@ -124,12 +234,14 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
     meta.range.last = meta.range.first + num_entries;
     _num_entries = meta.range.last;
     _meta.push_back(meta);
+    // an empty segment takes the prefix of the one before, to keep them sorted
+    _segment_prefixes.push_back(_segment_prefixes.empty() ? 0 : _segment_prefixes.back());
 
     (current_num_rows_per_row_block == NULL
      || (*current_num_rows_per_row_block = meta.file_header.message().num_rows_per_block()));
 
-    if (OLAP_UNLIKELY(num_entries == 0)) {
-        file_handler.close();
+    if (OLAP_UNLIKELY(num_entries == 0) || !load_entries) {
+        file_handler->close();
         return OLAP_SUCCESS;
     }
 
@@ -140,18 +252,18 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
     if (storage_data == nullptr) {
         res = OLAP_ERR_MALLOC_ERROR;
         OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
+        file_handler->close();
         return res;
     }
 
     // 读取索引内容
     // 为了启动加速，此处可使用mmap方式。
-    if (file_handler.pread(storage_data,
-                           storage_length,
-                           meta.file_header.size()) != OLAP_SUCCESS) {
+    if (file_handler->pread(storage_data,
+                            storage_length,
+                            meta.file_header.size()) != OLAP_SUCCESS) {
         res = OLAP_ERR_IO_ERROR;
         OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
+        file_handler->close();
         free(storage_data);
         return res;
     }
@@ -162,7 +274,7 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
         res = OLAP_ERR_INDEX_CHECKSUM_ERROR;
         OLAP_LOG_WARNING("checksum validation error.");
         OLAP_LOG_WARNING("load segment for loading index error. [file=%s; res=%d]", file, res);
-        file_handler.close();
+        file_handler->close();
         free(storage_data);
         return res;
     }
@@ -266,12 +378,28 @@ OLAPStatus MemIndex::load_segment(const char* file, size_t *current_num_rows_per
     _meta.back().buffer.length = num_entries * mem_row_bytes;
     free(storage_data);
 
-    file_handler.close();
+    std::vector<uint64_t>& key_prefixes = _meta.back().key_prefixes;
+    key_prefixes.resize(num_entries);
+    for (size_t j = 0; j < num_entries; ++j) {
+        key_prefixes[j] = _entry_prefix(mem_buf + j * mem_row_bytes);
+    }
+    _segment_prefixes.back() = key_prefixes[0];
+
+    file_handler->close();
     return OLAP_SUCCESS;
 }
 
+size_t MemIndex::memory_usage() const {
+    size_t usage = _mem_pool->total_reserved_bytes()
+            + _segment_prefixes.capacity() * sizeof(uint64_t);
+    for (const SegmentMetaInfo& meta : _meta) {
+        usage += meta.buffer.length + meta.key_prefixes.capacity() * sizeof(uint64_t);
+    }
+    return usage;
+}
+
 OLAPStatus MemIndex::init(size_t short_key_len, size_t new_short_key_len,
-                          size_t short_key_num, RowFields* fields) {
+                          size_t short_key_num, const RowFields* fields) {
     if (fields == NULL) {
         OLAP_LOG_WARNING("fail to init MemIndex, NULL short key fields.");
         return OLAP_ERR_INDEX_LOAD_ERROR;
@@ -282,9 +410,49 @@ OLAPStatus MemIndex::init(size_t short_key_len, size_t new_short_key_len,
     _key_num = short_key_num;
     _fields = fields;
 
+    size_t offset = 0;
+    _field_offsets.clear();
+    for (size_t i = 0; i < short_key_num; ++i) {
+        _field_offsets.push_back(offset);
+        if ((*fields)[i].type == OLAP_FIELD_TYPE_VARCHAR
+                || (*fields)[i].type == OLAP_FIELD_TYPE_CHAR) {
+            offset += sizeof(Slice) + 1;
+        } else {
+            offset += (*fields)[i].index_length + 1;
+        }
+    }
+
     return OLAP_SUCCESS;
 }
 
+uint64_t MemIndex::_entry_prefix(const char* entry) const {
+    KeyPrefixEncoder encoder;
+    for (size_t i = 0; i < _key_num; ++i) {
+        const char* field = entry + _field_offsets[i];
+        if (!encoder.append((*_fields)[i], *reinterpret_cast<const bool*>(field), field + 1)) {
+            break;
+        }
+    }
+    return encoder.value();
+}
+
+uint64_t MemIndex::_key_prefix(const RowCursor& key, uint64_t* mask) const {
+    // index_cmp skips the columns 'key' does not have, so does the mask
+    KeyPrefixEncoder encoder;
+    bool has_more = true;
+    size_t num_columns = std::min(_key_num, key.key_column_num());
+    size_t i = 0;
+    for (; i < num_columns && key.get_field_by_index(i) != NULL && has_more; ++i) {
+        has_more = encoder.append((*_fields)[i], key.is_null(i), key.get_field_content_ptr(i));
+    }
+    if (has_more) {
+        *mask = encoder.size() == 0 ? 0 : ~0ULL << (64 - 8 * encoder.size());
+    } else {
+        *mask = ~0ULL;
+    }
+    return encoder.value() & *mask;
+}
+
 // Find and return the IndexOffset of the element prior to the first element which
 // is key's lower_bound, or upper_bound if key exists, or return the last element in MemIndex
 // This process is consists of two phases of binary search.
@@ -306,10 +474,17 @@ const OLAPIndexOffset MemIndex::find(const RowCursor& k,
         return begin();
     }
 
+    // Entries with a prefix different from the key's are ordered by the
+    // prefix alone, index_cmp only runs on the entries with the same one.
+    uint64_t mask = 0;
+    uint64_t key_prefix = _key_prefix(k, &mask);
+
     OLAPIndexOffset offset;
     BinarySearchIterator it;
-    BinarySearchIterator seg_beg(0);
-    BinarySearchIterator seg_fin(segment_count());
+    BinarySearchIterator seg_beg(prefix_bound(
+            _segment_prefixes.data(), segment_count(), key_prefix, mask, false));
+    BinarySearchIterator seg_fin(prefix_bound(
+            _segment_prefixes.data(), segment_count(), key_prefix, mask, true));
 
     try {
         SegmentComparator seg_comparator(this, helper_cursor);
@@ -330,8 +505,11 @@ const OLAPIndexOffset MemIndex::find(const RowCursor& k,
         offset.segment = off;
         IndexComparator index_comparator(this, helper_cursor);
         // second step, binary search index item in given segment
-        BinarySearchIterator index_beg(0);
-        BinarySearchIterator index_fin(_meta[off].count());
+        const std::vector<uint64_t>& key_prefixes = _meta[off].key_prefixes;
+        BinarySearchIterator index_beg(prefix_bound(
+                key_prefixes.data(), key_prefixes.size(), key_prefix, mask, false));
+        BinarySearchIterator index_fin(prefix_bound(
+                key_prefixes.data(), key_prefixes.size(), key_prefix, mask, true));
 
         if (index_comparator.set_segment_id(off) != OLAP_SUCCESS) {
             throw "index of of range";
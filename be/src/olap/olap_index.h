@@ -162,6 +162,8 @@ struct SegmentMetaInfo {
     IDRange     range;
     EntrySlice       buffer;
     FileHeader<OLAPIndexHeaderMessage, OLAPIndexFixedHeader>  file_header;
+    // normalized key prefix of every entry, see MemIndex::find
+    std::vector<uint64_t> key_prefixes;
 };
 
 // In memory index structure, all index hold here
@@ -176,10 +178,17 @@ public:
 
     // 初始化MemIndex, 传入short_key的总长度和对应的Field数组
     OLAPStatus init(size_t short_key_len, size_t new_short_key_len,
-                    size_t short_key_num, RowFields* fields);
+                    size_t short_key_num, const RowFields* fields);
 
     // 加载一个segment到内存
-    OLAPStatus load_segment(const char* file, size_t *current_num_rows_per_row_block);
+    // 'file_handler' is the opened index file of the segment, it is closed.
+    // If 'load_entries' is false only the file header is read, the index can
+    // then tell the counts and sizes of the segments but not find keys.
+    OLAPStatus load_segment(FileHandler* file_handler, size_t *current_num_rows_per_row_block,
+                            bool load_entries = true);
+
+    // Bytes held by the loaded entries
+    size_t memory_usage() const;
 
     // Return the IndexOffset of the first element, physically, it's (0, 0)
     const OLAPIndexOffset begin() const {
@@ -323,7 +332,18 @@ public:
     }
 
 private:
+    // Entries are first searched by 8 byte prefixes of their short keys, which
+    // compare as unsigned integers in the order RowCursor::index_cmp compares
+    // the keys. Only entries with the same prefix as the key are compared with
+    // index_cmp. The mask keeps the bytes of the columns 'key' has.
+    uint64_t _key_prefix(const RowCursor& key, uint64_t* mask) const;
+    uint64_t _entry_prefix(const char* entry) const;
+
     std::vector<SegmentMetaInfo> _meta;
+    // prefix of the first entry of every segment
+    std::vector<uint64_t> _segment_prefixes;
+    // offset of every short key field in an entry
+    std::vector<size_t> _field_offsets;
     size_t _key_length;
     size_t _new_key_length;
     size_t _key_num;
@@ -331,7 +351,7 @@ private:
     size_t _index_size;
     size_t _data_size;
     size_t _num_rows;
-    RowFields*  _fields;
+    const RowFields*  _fields;
 
     std::unique_ptr<MemTracker> _tracker;
     std::unique_ptr<MemPool> _mem_pool;
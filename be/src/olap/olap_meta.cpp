@@ -25,6 +25,7 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/write_batch.h"
 #include "common/logging.h"
 #include "util/doris_metrics.h"
 #include "util/runtime_profile.h"
@@ -144,6 +145,35 @@ OLAPStatus OlapMeta::remove(const int column_family_index, const std::string& ke
     return OLAP_SUCCESS;
 }
 
+OLAPStatus OlapMeta::write_batch(const int column_family_index,
+        const std::vector<std::pair<std::string, std::string>>& puts,
+        const std::vector<std::string>& removes) {
+    DorisMetrics::meta_write_request_total.increment(1);
+    rocksdb::ColumnFamilyHandle* handle = _handles[column_family_index];
+    rocksdb::WriteBatch batch;
+    for (auto& put : puts) {
+        batch.Put(handle, Slice(put.first), Slice(put.second));
+    }
+    for (auto& key : removes) {
+        batch.Delete(handle, Slice(key));
+    }
+    Status s = Status::OK();
+    int64_t duration_ns = 0;
+    {
+        SCOPED_RAW_TIMER(&duration_ns);
+        WriteOptions write_options;
+        write_options.sync = config::sync_tablet_meta;
+        s = _db->Write(write_options, &batch);
+    }
+    DorisMetrics::meta_write_request_duration_us.increment(duration_ns / 1000);
+    if (!s.ok()) {
+        LOG(WARNING) << "rocks db write batch failed, put_num=" << puts.size()
+            << ", remove_num=" << removes.size() << ", reason:" << s.ToString();
+        return OLAP_ERR_META_PUT;
+    }
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus OlapMeta::iterate(const int column_family_index, const std::string& prefix,
         std::function<bool(const std::string&, const std::string&)> const& func) {
     rocksdb::ColumnFamilyHandle* handle = _handles[column_family_index];
@@ -21,6 +21,7 @@
 #include <string>
 #include <map>
 #include <functional>
+#include <vector>
 
 #include "olap/olap_header.h"
 #include "olap/olap_define.h"
@@ -42,6 +43,11 @@ public:
 
     OLAPStatus remove(const int column_family_index, const std::string& key);
 
+    // puts and removes the keys atomically
+    OLAPStatus write_batch(const int column_family_index,
+            const std::vector<std::pair<std::string, std::string>>& puts,
+            const std::vector<std::string>& removes);
+
     OLAPStatus iterate(const int column_family_index, const std::string& prefix,
             std::function<bool(const std::string&, const std::string&)> const& func);
 
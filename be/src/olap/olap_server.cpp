@@ -63,6 +63,7 @@ OLAPStatus OLAPEngine::_start_bg_worker() {
         store_vec.push_back(tmp_store.second);
     }
     int32_t store_num = store_vec.size();
+    _compaction_scheduler.reset(new CompactionScheduler());
     // start be and ce threads for merge data
     int32_t base_compaction_num_threads = config::base_compaction_num_threads_per_disk * store_num;
     _base_compaction_threads.reserve(base_compaction_num_threads);
@@ -87,6 +88,13 @@ OLAPStatus OLAPEngine::_start_bg_worker() {
             _fd_cache_clean_callback(nullptr);
         });
 
+    if (config::storage_cooldown_idle_second > 0 || _cold_file_manager != nullptr) {
+        _storage_cooldown_thread = std::thread(
+            [this] {
+                _storage_cooldown_thread_callback(nullptr);
+            });
+    }
+
     VLOG(10) << "init finished.";
     return OLAP_SUCCESS;
 }
@@ -109,6 +117,24 @@ void* OLAPEngine::_fd_cache_clean_callback(void* arg) {
     return NULL;
 }
 
+void* OLAPEngine::_storage_cooldown_thread_callback(void* arg) {
+#ifdef GOOGLE_PROFILER
+    ProfilerRegisterThread();
+#endif
+    uint32_t interval = config::storage_cooldown_check_interval_second;
+    if (interval <= 0) {
+        OLAP_LOG_WARNING("storage cooldown check interval config is illegal: [%d], "
+                         "force set to 600", interval);
+        interval = 600;
+    }
+    while (true) {
+        sleep(interval);
+        start_storage_cooldown();
+    }
+
+    return NULL;
+}
+
 void* OLAPEngine::_base_compaction_thread_callback(void* arg, OlapStore* store) {
 #ifdef GOOGLE_PROFILER
     ProfilerRegisterThread();
@@ -127,6 +153,7 @@ void* OLAPEngine::_base_compaction_thread_callback(void* arg, OlapStore* store)
         // cgroup is not initialized at this time
         // add tid to cgroup
         CgroupsMgr::apply_system_cgroup();
+        _compaction_scheduler->wait(store);
         perform_base_compaction(store);
 
         usleep(interval * 1000000);
@@ -240,6 +267,7 @@ void* OLAPEngine::_cumulative_compaction_thread_callback(void* arg, OlapStore* s
         // cgroup is not initialized at this time
         // add tid to cgroup
         CgroupsMgr::apply_system_cgroup();
+        _compaction_scheduler->wait(store);
         perform_cumulative_compaction(store);
         usleep(interval * 1000000);
     }
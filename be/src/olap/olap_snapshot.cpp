@@ -37,6 +37,7 @@
 #include "olap/olap_define.h"
 #include "olap/olap_table.h"
 #include "olap/olap_header_manager.h"
+#include "olap/packed_file.h"
 #include "olap/push_handler.h"
 #include "olap/store.h"
 #include "util/file_utils.h"
@@ -130,7 +131,6 @@ OLAPStatus OLAPEngine::_calc_snapshot_id_path(
     }
 
     stringstream snapshot_id_path_stream;
-    MutexLock auto_lock(&_snapshot_mutex); // will automatically unlock when function return.
     snapshot_id_path_stream << olap_table->storage_root_path_name() << SNAPSHOT_PREFIX
                             << "/" << time_str << "." << _snapshot_base_id++;
     *out_path = snapshot_id_path_stream.str();
@@ -176,7 +176,8 @@ void OLAPEngine::_update_header_file_info(
             }
             header->add_version(version, v_hash, segment_group_id, segment_group_entity.num_segments,
                     segment_group_entity.index_size, segment_group_entity.data_size,
-                    segment_group_entity.num_rows, segment_group_entity.empty, column_statistics);
+                    segment_group_entity.num_rows, segment_group_entity.empty, column_statistics,
+                    nullptr, segment_group_entity.packed);
         }
     }
 }
@@ -195,6 +196,20 @@ OLAPStatus OLAPEngine::_link_index_and_data_files(
         VersionHash v_hash = entity.version_hash;
         for (SegmentGroupEntity segment_group_entity : entity.segment_group_vec) {
             int32_t segment_group_id = segment_group_entity.segment_group_id;
+            if (segment_group_entity.packed) {
+                std::string packed_path = packed_file_path(_construct_data_file_path(
+                        tablet_path_prefix, version, v_hash, segment_group_id, 0));
+                std::string ref_table_packed_path = packed_file_path(
+                        ref_olap_table->construct_data_file_path(version, v_hash, segment_group_id, 0));
+                res = _create_hard_link(ref_table_packed_path, packed_path);
+                if (res != OLAP_SUCCESS) {
+                    LOG(WARNING) << "fail to create hard link."
+                        << "tablet_path_prefix=" << tablet_path_prefix
+                        << ", from_path=" << ref_table_packed_path << ", to_path=" << packed_path;
+                    return res;
+                }
+                continue;
+            }
             for (int seg_id = 0; seg_id < segment_group_entity.num_segments; ++seg_id) {
                 std::string index_path =
                     _construct_index_file_path(tablet_path_prefix, version, v_hash, segment_group_id, seg_id);
@@ -239,6 +254,20 @@ OLAPStatus OLAPEngine::_copy_index_and_data_files(
         VersionHash v_hash = entity.version_hash;
         for (SegmentGroupEntity segment_group_entity : entity.segment_group_vec) {
             int32_t segment_group_id = segment_group_entity.segment_group_id;
+            if (segment_group_entity.packed) {
+                string packed_path = packed_file_path(_construct_data_file_path(
+                        tablet_path_prefix, version, v_hash, segment_group_id, 0));
+                string ref_table_packed_path = packed_file_path(
+                        ref_olap_table->construct_data_file_path(version, v_hash, segment_group_id, 0));
+                Status res = FileUtils::copy_file(ref_table_packed_path, packed_path);
+                if (!res.ok()) {
+                    LOG(WARNING) << "fail to copy packed file."
+                                 << "dest=" << packed_path
+                                 << ", src=" << ref_table_packed_path;
+                    return OLAP_ERR_COPY_FILE_ERROR;
+                }
+                continue;
+            }
             for (int seg_id = 0; seg_id < segment_group_entity.num_segments; ++seg_id) {
                 string index_path =
                     _construct_index_file_path(tablet_path_prefix, version, v_hash, segment_group_id, seg_id);
@@ -256,6 +285,18 @@ OLAPStatus OLAPEngine::_copy_index_and_data_files(
                     _construct_data_file_path(tablet_path_prefix, version, v_hash, segment_group_id, seg_id);
                 string ref_table_data_path = ref_olap_table->construct_data_file_path(
                     version, v_hash, segment_group_id, seg_id);
+                // the copy is moved to another store, with the whole of a cold file
+                if (_cold_file_manager != nullptr
+                        && _cold_file_manager->is_cold(ref_table_data_path)) {
+                    if (_cold_file_manager->restore(ref_table_data_path, data_path)
+                            != OLAP_SUCCESS) {
+                        LOG(WARNING) << "fail to restore cold data file."
+                                     << "dest=" << data_path
+                                     << ", src=" << ref_table_data_path;
+                        return OLAP_ERR_COPY_FILE_ERROR;
+                    }
+                    continue;
+                }
                 res = FileUtils::copy_file(ref_table_data_path, data_path);
                 if (!res.ok()) {
                     LOG(WARNING) << "fail to copy data file."
@@ -497,7 +538,16 @@ OLAPStatus OLAPEngine::_create_incremental_snapshot_files(
                         << ", schema_hash=" << request.schema_hash
                         << ", version=" << missing_version;
                 // link files
-                for (uint32_t i = 0; i < incremental_delta->segment_group(0).num_segments(); i++) {
+                if (incremental_delta->segment_group(0).packed()) {
+                    string from = packed_file_path(ref_olap_table->construct_incremental_data_file_path(
+                                Version(missing_version, missing_version),
+                                incremental_delta->version_hash(),
+                                incremental_delta->segment_group(0).segment_group_id(), 0));
+                    string to = schema_full_path + '/' + basename(from.c_str());
+                    res = _create_hard_link(from, to);
+                }
+                for (uint32_t i = 0; !incremental_delta->segment_group(0).packed()
+                        && i < incremental_delta->segment_group(0).num_segments(); i++) {
                     int32_t segment_group_id = incremental_delta->segment_group(0).segment_group_id();
                     string from = ref_olap_table->construct_incremental_index_file_path(
                                 Version(missing_version, missing_version),
@@ -614,6 +664,10 @@ string OLAPEngine::_construct_data_file_path(
 }
 
 OLAPStatus OLAPEngine::_create_hard_link(const string& from_path, const string& to_path) {
+    // snapshots are read by other backends, they hold the whole of the cold files
+    if (_cold_file_manager != nullptr && _cold_file_manager->is_cold(from_path)) {
+        return _cold_file_manager->restore(from_path, to_path);
+    }
     if (link(from_path.c_str(), to_path.c_str()) == 0) {
         VLOG(10) << "success to create hard link from_path=" << from_path
                  << ", to_path=" << to_path;
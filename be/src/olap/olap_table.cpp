@@ -29,14 +29,20 @@
 
 #include "olap/field.h"
 #include "olap/column_data.h"
+#include "olap/column_distribution.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/olap_engine.h"
 #include "olap/olap_index.h"
+#include "olap/packed_file.h"
+#include "olap/pre_aggregate.h"
+#include "olap/primary_key_index.h"
 #include "olap/reader.h"
 #include "olap/store.h"
 #include "olap/row_cursor.h"
 #include "util/defer_op.h"
+#include "util/lock_stats.h"
+#include "util/time.h"
 #include "olap/olap_header_manager.h"
 #include "olap/olap_engine.h"
 #include "olap/utils.h"
@@ -150,7 +156,10 @@ OLAPTable::OLAPTable(OLAPHeader* header, OlapStore* store) :
         _store(store),
         _is_loaded(false),
         _is_bad(false),
-        _last_compaction_failure_time(0) {
+        _last_compaction_failure_time(0),
+        _last_query_time(UnixMillis()) {
+    static LockStats* header_lock_stats = LockStats::get("tablet_header");
+    _header_lock.set_stats(header_lock_stats);
     if (header == NULL) {
         return;  // for convenience of mock test.
     }
@@ -211,6 +220,8 @@ OLAPTable::OLAPTable(OLAPHeader* header, OlapStore* store) :
         }
 
         field_info.is_bf_column = header->column(i).is_bf_column();
+        field_info.has_bitmap_index = header->column(i).has_bitmap_index();
+        field_info.has_ngram_index = header->column(i).has_ngram_index();
 
         _tablet_schema.push_back(field_info);
         // field name --> field position in full row.
@@ -378,6 +389,7 @@ OLAPStatus OLAPTable::load_indices() {
             if (psegment_group.has_empty()) {
                 segment_group->set_empty(psegment_group.empty());
             }
+            segment_group->set_packed(psegment_group.packed());
             // 在校验和加载索引前把segment_group放到data-source，以防止加载索引失败造成内存泄露
             _data_sources[version].push_back(segment_group);
 
@@ -442,6 +454,8 @@ OLAPStatus OLAPTable::save_header() {
     OLAPStatus res = OlapHeaderManager::save(_store, _tablet_id, _schema_hash, _header);
     if (res != OLAP_SUCCESS) {
        LOG(WARNING) << "fail to save header. [res=" << res << " root=" << _storage_root_path << "]";
+    } else if (OLAPEngine::get_instance() != nullptr) {
+        OLAPEngine::get_instance()->mark_tablet_changed(_tablet_id);
     }
 
     return res;
@@ -542,14 +556,21 @@ OLAPStatus OLAPTable::register_data_source(const std::vector<SegmentGroup*>& ind
         if (segment_group->has_column_statistics()) {
             column_statistics = &segment_group->get_column_statistics();
         }
+        const std::vector<ColumnDistribution>* column_distributions = nullptr;
+        if (segment_group->has_column_distributions()) {
+            column_distributions = &segment_group->get_column_distributions();
+        }
         res = _header->add_version(version, segment_group->version_hash(), segment_group->segment_group_id(),
                                    segment_group->num_segments(), segment_group->index_size(), segment_group->data_size(),
-                                   segment_group->num_rows(), segment_group->empty(), column_statistics);
+                                   segment_group->num_rows(), segment_group->empty(), column_statistics,
+                                   column_distributions, segment_group->packed());
         if (res != OLAP_SUCCESS) {
             LOG(WARNING) << "fail to add version to olap header. table=" << full_name() << ", "
                          << "version=" << version.first << "-" << version.second;
             return res;
         }
+        // the header keeps them from now on
+        segment_group->set_column_distributions(std::vector<ColumnDistribution>());
 
         // put the new segment_group into _data_sources.
         // 由于对header的操作可能失败，因此对_data_sources要放在这里
@@ -561,6 +582,57 @@ OLAPStatus OLAPTable::register_data_source(const std::vector<SegmentGroup*>& ind
                 << "num_segments=" << segment_group->num_segments();
     }
 
+    _add_to_primary_key_index(index_vec);
+    return OLAP_SUCCESS;
+}
+
+void OLAPTable::_add_to_primary_key_index(const std::vector<SegmentGroup*>& segment_groups) {
+    if (_primary_key_index == nullptr) {
+        return;
+    }
+    bool can_add = is_merge_on_write();
+    for (SegmentGroup* segment_group : segment_groups) {
+        can_add = can_add && _primary_key_index->can_add(segment_group->version());
+    }
+    if (can_add && _primary_key_index->add(segment_groups) == OLAP_SUCCESS) {
+        return;
+    }
+    // the next query builds the index again from all data sources
+    LOG(INFO) << "drop primary key index. table=" << full_name();
+    _primary_key_index.reset();
+}
+
+bool OLAPTable::is_merge_on_write() const {
+    return keys_type() == KeysType::UNIQUE_KEYS && config::enable_unique_key_merge_on_write;
+}
+
+OLAPStatus OLAPTable::prepare_merge_on_write_read() {
+    MutexLock l(&_primary_key_index_lock);
+    if (_primary_key_index != nullptr) {
+        return OLAP_SUCCESS;
+    }
+
+    std::vector<SegmentGroup*> segment_groups;
+    for (auto& it : _data_sources) {
+        for (SegmentGroup* segment_group : it.second) {
+            // bitmaps are made again together with the index
+            segment_group->set_delete_bitmap(nullptr);
+            segment_groups.push_back(segment_group);
+        }
+    }
+    OlapStopWatch watch;
+    std::unique_ptr<PrimaryKeyIndex> primary_key_index(new PrimaryKeyIndex(this));
+    OLAPStatus res = primary_key_index->add(segment_groups);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to build primary key index. res=" << res
+                     << ", table=" << full_name();
+        return res;
+    }
+    LOG(INFO) << "build primary key index. table=" << full_name()
+              << ", segment_groups=" << segment_groups.size()
+              << ", keys=" << primary_key_index->num_keys()
+              << ", time_us=" << watch.get_elapse_time_us();
+    _primary_key_index = std::move(primary_key_index);
     return OLAP_SUCCESS;
 }
 
@@ -582,6 +654,7 @@ OLAPStatus OLAPTable::unregister_data_source(const Version& version, std::vector
 
     *segment_group_vec = it->second;
     _data_sources.erase(it);
+    _primary_key_index.reset();
     return OLAP_SUCCESS;
 }
 
@@ -620,9 +693,14 @@ OLAPStatus OLAPTable::add_pending_segment_group(SegmentGroup* segment_group) {
     if (segment_group->has_column_statistics()) {
         column_statistics = &(segment_group->get_column_statistics());
     }
+    const std::vector<ColumnDistribution>* column_distributions = nullptr;
+    if (segment_group->has_column_distributions()) {
+        column_distributions = &segment_group->get_column_distributions();
+    }
     res = _header->add_pending_segment_group(transaction_id, segment_group->num_segments(),
                                       segment_group->segment_group_id(), segment_group->load_id(),
-                                      segment_group->empty(), column_statistics);
+                                      segment_group->empty(), column_statistics, column_distributions,
+                                      segment_group->packed());
     if (res != OLAP_SUCCESS) {
         LOG(WARNING) << "fail to add pending segment_group to header. [table=" << full_name()
                      << " transaction_id=" << transaction_id << "]";
@@ -705,9 +783,14 @@ OLAPStatus OLAPTable::add_pending_data(SegmentGroup* segment_group, const std::v
     if (segment_group->has_column_statistics()) {
         column_statistics = &(segment_group->get_column_statistics());
     }
+    const std::vector<ColumnDistribution>* column_distributions = nullptr;
+    if (segment_group->has_column_distributions()) {
+        column_distributions = &segment_group->get_column_distributions();
+    }
     res = _header->add_pending_segment_group(transaction_id, segment_group->num_segments(),
                                       segment_group->segment_group_id(), segment_group->load_id(),
-                                      segment_group->empty(), column_statistics);
+                                      segment_group->empty(), column_statistics, column_distributions,
+                                      segment_group->packed());
     if (res != OLAP_SUCCESS) {
         LOG(WARNING) << "fail to add pending segment_group to header. [table=" << full_name()
                      << " transaction_id=" << transaction_id << "]";
@@ -789,6 +872,44 @@ void OLAPTable::get_expire_pending_data(vector<int64_t>* transaction_ids) {
     }
 }
 
+void OLAPTable::get_column_distributions(std::vector<TColumnDistribution>* distributions) {
+    const std::vector<FieldInfo>& schema = tablet_schema();
+    std::vector<std::unique_ptr<ColumnDistributionMerger>> mergers(schema.size());
+    std::unordered_map<uint32_t, size_t> cid_by_unique_id;
+    for (size_t cid = 0; cid < schema.size(); ++cid) {
+        if (has_column_distribution(schema[cid])) {
+            cid_by_unique_id[schema[cid].unique_id] = cid;
+        }
+    }
+
+    {
+        ReadLock rdlock(&_header_lock);
+        for (const PDelta& delta : _header->delta()) {
+            for (const PSegmentGroup& segment_group : delta.segment_group()) {
+                for (const ColumnDistribution& distribution : segment_group.column_distribution()) {
+                    auto it = cid_by_unique_id.find(distribution.column_unique_id());
+                    if (it == cid_by_unique_id.end()) {
+                        // a column dropped by schema change
+                        continue;
+                    }
+                    std::unique_ptr<ColumnDistributionMerger>& merger = mergers[it->second];
+                    if (merger == nullptr) {
+                        merger.reset(new ColumnDistributionMerger(schema[it->second]));
+                    }
+                    merger->merge(distribution);
+                }
+            }
+        }
+    }
+
+    for (auto& merger : mergers) {
+        if (merger != nullptr) {
+            distributions->emplace_back();
+            merger->finish(&distributions->back());
+        }
+    }
+}
+
 void OLAPTable::load_pending_data() {
     LOG(INFO) << "begin to load pending_data. table=" << full_name() << ", "
               << "pending_delta size=" << _header->pending_delta_size();
@@ -825,6 +946,11 @@ void OLAPTable::load_pending_data() {
             if (pending_segment_group.has_empty()) {
                 segment_group->set_empty(pending_segment_group.empty());
             }
+            segment_group->set_packed(pending_segment_group.packed());
+            // kept until the publish adds the segment group to the versions
+            segment_group->set_column_distributions(std::vector<ColumnDistribution>(
+                    pending_segment_group.column_distribution().begin(),
+                    pending_segment_group.column_distribution().end()));
             _pending_data_sources[segment_group->transaction_id()].push_back(segment_group);
 
             if (segment_group->validate() != OLAP_SUCCESS) {
@@ -918,7 +1044,15 @@ OLAPStatus OLAPTable::_publish_version(int64_t transaction_id, Version version,
     OLAPStatus res = OLAP_SUCCESS;
     for (SegmentGroup* segment_group : _pending_data_sources[transaction_id]) {
         int32_t segment_group_id = segment_group->segment_group_id();
-        for (int32_t seg_id = 0; seg_id < segment_group->num_segments(); ++seg_id) {
+        if (segment_group->packed()) {
+            std::string packed_path = packed_file_path(
+                    construct_data_file_path(version, version_hash, segment_group_id, 0));
+            res = _create_hard_link(segment_group->construct_packed_file_path(), packed_path,
+                                    &linked_files);
+            if (res != OLAP_SUCCESS) { remove_files(linked_files); return res; }
+        }
+        for (int32_t seg_id = 0; !segment_group->packed() && seg_id < segment_group->num_segments();
+                ++seg_id) {
             std::string pending_index_path = segment_group->construct_index_file_path(segment_group_id, seg_id);
             std::string index_path = construct_index_file_path(version, version_hash, segment_group_id, seg_id);
             res = _create_hard_link(pending_index_path, index_path, &linked_files);
@@ -930,6 +1064,14 @@ OLAPStatus OLAPTable::_publish_version(int64_t transaction_id, Version version,
             if (res != OLAP_SUCCESS) { remove_files(linked_files); return res; }
         }
 
+        std::string pending_pre_aggregate_path = segment_group->construct_pre_aggregate_file_path();
+        if (check_dir_existed(pending_pre_aggregate_path)) {
+            std::string pre_aggregate_path = pre_aggregate_file_path(
+                    construct_data_file_path(version, version_hash, segment_group_id, 0));
+            res = _create_hard_link(pending_pre_aggregate_path, pre_aggregate_path, &linked_files);
+            if (res != OLAP_SUCCESS) { remove_files(linked_files); return res; }
+        }
+
         segment_group->publish_version(version, version_hash);
         index_vec.push_back(segment_group);
     }
@@ -950,15 +1092,8 @@ OLAPStatus OLAPTable::_publish_version(int64_t transaction_id, Version version,
             << "transaction_id=" << transaction_id << ", "
             << "version=" << version.first << "-" << version.second;
 
-    // save header
-    res = save_header();
-    if (res != OLAP_SUCCESS) {
-        LOG(FATAL) << "fail to save header when publish version. res=" << res << ", "
-                   << "table=" << full_name() << ", "
-                   << "transaction_id=" << transaction_id;
-        return res;
-    }
-
+    // the new version and the removal of the pending delta are saved at once,
+    // the pending files are only deleted after that
     _header->delete_pending_delta(transaction_id);
     res = save_header();
     if (res != OLAP_SUCCESS) {
@@ -1070,7 +1205,15 @@ OLAPStatus OLAPTable::_add_incremental_data(std::vector<SegmentGroup*>& index_ve
     }
     std::vector<std::string> linked_files;
     for (SegmentGroup* segment_group : index_vec) {
-        for (int32_t seg_id = 0; seg_id < segment_group->num_segments(); ++seg_id) {
+        if (segment_group->packed()) {
+            std::string incremental_packed_path = packed_file_path(construct_incremental_data_file_path(
+                    version, version_hash, segment_group->segment_group_id(), 0));
+            res = _create_hard_link(segment_group->construct_packed_file_path(),
+                                    incremental_packed_path, &linked_files);
+            if (res != OLAP_SUCCESS) { remove_files(linked_files); return res; }
+        }
+        for (int32_t seg_id = 0; !segment_group->packed() && seg_id < segment_group->num_segments();
+                ++seg_id) {
             int32_t segment_group_id = segment_group->segment_group_id();
             std::string index_path = segment_group->construct_index_file_path(segment_group_id, seg_id);
             std::string incremental_index_path =
@@ -1093,7 +1236,8 @@ OLAPStatus OLAPTable::_add_incremental_data(std::vector<SegmentGroup*>& index_ve
                 segment_group->version(), segment_group->version_hash(),
                 segment_group->segment_group_id(), segment_group->num_segments(),
                 segment_group->index_size(), segment_group->data_size(),
-                segment_group->num_rows(), segment_group->empty(), column_statistics);
+                segment_group->num_rows(), segment_group->empty(), column_statistics,
+                segment_group->packed());
         if (res != OLAP_SUCCESS) {
             LOG(WARNING) << "fail to add incremental data. res=" << res << ", "
                          << "table=" << full_name() << ", "
@@ -1159,7 +1303,12 @@ void OLAPTable::_delete_incremental_data(const Version& version,
     vector<string> files_to_delete;
     for (const PSegmentGroup& psegment_group : incremental_delta->segment_group()) {
         int32_t segment_group_id = psegment_group.segment_group_id();
-        for (int seg_id = 0; seg_id < psegment_group.num_segments(); seg_id++) {
+        if (psegment_group.packed()) {
+            files_to_remove->emplace_back(packed_file_path(construct_incremental_data_file_path(
+                    version, version_hash, segment_group_id, 0)));
+        }
+        for (int seg_id = 0; !psegment_group.packed() && seg_id < psegment_group.num_segments();
+                seg_id++) {
             std::string incremental_index_path =
                 construct_incremental_index_file_path(version, version_hash, segment_group_id, seg_id);
             files_to_remove->emplace_back(incremental_index_path);
@@ -1265,6 +1414,7 @@ SegmentGroup* OLAPTable::_construct_segment_group_from_version(const PDelta* del
     if (psegment_group->has_empty()) {
         segment_group->set_empty(psegment_group->empty());
     }
+    segment_group->set_packed(psegment_group->packed());
     DCHECK(segment_group != nullptr) << "malloc error when construct segment_group."
             << "table=" << full_name() << ", "
             << "version=" << version.first << "-" << version.second << ", "
@@ -1395,7 +1545,8 @@ OLAPStatus OLAPTable::clone_data(const OLAPHeader& clone_header,
                                                    tmp_segment_group->data_size(),
                                                    tmp_segment_group->num_rows(),
                                                    tmp_segment_group->empty(),
-                                                   column_statistics);
+                                                   column_statistics, nullptr,
+                                                   tmp_segment_group->packed());
                 if (res != OLAP_SUCCESS) {
                     LOG(WARNING) << "fail to add version to new local header when clone."
                                  << "res=" << res << ", "
@@ -1485,7 +1636,8 @@ OLAPStatus OLAPTable::clone_data(const OLAPHeader& clone_header,
 
 OLAPStatus OLAPTable::replace_data_sources(const vector<Version>* old_versions,
                                        const vector<SegmentGroup*>* new_data_sources,
-                                       vector<SegmentGroup*>* old_data_sources) {
+                                       vector<SegmentGroup*>* old_data_sources,
+                                       bool merged) {
     OLAPStatus res = OLAP_SUCCESS;
 
     if (old_versions == NULL || new_data_sources == NULL) {
@@ -1494,6 +1646,8 @@ OLAPStatus OLAPTable::replace_data_sources(const vector<Version>* old_versions,
     }
 
     old_data_sources->clear();
+    // dropped unless all data sources are replaced
+    std::unique_ptr<PrimaryKeyIndex> primary_key_index = std::move(_primary_key_index);
 
     // check old version existed
     for (vector<Version>::const_iterator it = old_versions->begin();
@@ -1560,21 +1714,35 @@ OLAPStatus OLAPTable::replace_data_sources(const vector<Version>* old_versions,
         if ((*it)->has_column_statistics()) {
             column_statistics = &((*it)->get_column_statistics());
         }
+        const std::vector<ColumnDistribution>* column_distributions = nullptr;
+        if ((*it)->has_column_distributions()) {
+            column_distributions = &(*it)->get_column_distributions();
+        }
         res = _header->add_version((*it)->version(), (*it)->version_hash(),
                                    (*it)->segment_group_id(), (*it)->num_segments(),
                                    (*it)->index_size(), (*it)->data_size(),
-                                   (*it)->num_rows(), (*it)->empty(), column_statistics);
+                                   (*it)->num_rows(), (*it)->empty(), column_statistics,
+                                   column_distributions, (*it)->packed());
 
         if (res != OLAP_SUCCESS) {
             LOG(WARNING) << "fail to add version to olap header.[version='" << (*it)->version().first
                          << "-" << (*it)->version().second << "' table='" << full_name() << "']";
             return res;
         }
+        (*it)->set_column_distributions(std::vector<ColumnDistribution>());
 
         VLOG(3) << "add version to olap header. table=" << full_name() << ", "
                 << "version=" << (*it)->version().first << "-" << (*it)->version().second;
     }
 
+    if (primary_key_index != nullptr && merged && new_data_sources->size() == 1
+            && is_merge_on_write()) {
+        if (primary_key_index->replace(*old_data_sources, (*new_data_sources)[0]) == OLAP_SUCCESS) {
+            _primary_key_index = std::move(primary_key_index);
+        } else {
+            LOG(INFO) << "drop primary key index. table=" << full_name();
+        }
+    }
     return OLAP_SUCCESS;
 }
 
@@ -1638,7 +1806,8 @@ OLAPStatus OLAPTable::merge_header(const OLAPHeader& hdr, int to_version) {
             const PSegmentGroup& psegment_group = delta->segment_group(j);
             st = _header->add_version(version, v_hash, psegment_group.segment_group_id(),
                                        psegment_group.num_segments(), psegment_group.index_size(), psegment_group.data_size(),
-                                       psegment_group.num_rows(), psegment_group.empty(), nullptr);
+                                       psegment_group.num_rows(), psegment_group.empty(), nullptr,
+                                       nullptr, psegment_group.packed());
             if (st != OLAP_SUCCESS) {
                 LOG(WARNING) << "failed to add version to header" << ", "
                     << "version=" << version.first << "-" << version.second;
@@ -1677,6 +1846,15 @@ SegmentGroup* OLAPTable::_get_largest_index() {
     return largest_index;
 }
 
+// A segment group weighing the ranges split_range cuts
+struct SplitSource {
+    SegmentGroup* segment_group;
+    // the row block of the start key of the split
+    RowBlockPosition start_pos;
+    // average data bytes of its row blocks
+    double block_bytes;
+};
+
 OLAPStatus OLAPTable::split_range(
         const OlapTuple& start_key_strings,
         const OlapTuple& end_key_strings,
@@ -1754,6 +1932,9 @@ OLAPStatus OLAPTable::split_range(
         ranges->emplace_back(end_key.to_tuple());
         return OLAP_SUCCESS;
     }
+    // keeps the short key index entries from being evicted while they are used
+    base_index->acquire();
+    DeferOp release_index(std::bind<void>(&SegmentGroup::release, base_index));
 
     uint64_t expected_rows = request_block_row_count
             / base_index->current_num_rows_per_row_block();
@@ -1784,6 +1965,69 @@ OLAPStatus OLAPTable::split_range(
 
     VLOG(3) << "end_pos=" << end_pos.segment << ", " << end_pos.index_offset;
 
+    // The ranges are cut at the row blocks of the largest segment group, but
+    // they are of equal cost to read from all segment groups of the tablet:
+    // a range costs the data bytes of the row blocks every segment group has
+    // in it, so the ranges over keys many versions pile up in come out short.
+    std::vector<SplitSource> sources;
+    DeferOp release_sources([&sources] {
+        for (auto& source : sources) {
+            source.segment_group->release();
+        }
+    });
+    double total_cost = 0;
+    uint64_t total_rows = 0;
+    for (auto& it : _data_sources) {
+        for (SegmentGroup* segment_group : it.second) {
+            if (segment_group->empty() || segment_group->zero_num_rows()) {
+                continue;
+            }
+            segment_group->acquire();
+            sources.emplace_back();
+            SplitSource& source = sources.back();
+            source.segment_group = segment_group;
+            RowBlockPosition source_end_pos;
+            if (segment_group->find_short_key(
+                        start_key, &helper_cursor, false, &source.start_pos) != OLAP_SUCCESS
+                    && segment_group->find_first_row_block(&source.start_pos) != OLAP_SUCCESS) {
+                OLAP_LOG_WARNING("fail to get first block pos");
+                return OLAP_ERR_TABLE_INDEX_FIND_ERROR;
+            }
+            if (segment_group->find_short_key(
+                        end_key, &helper_cursor, false, &source_end_pos) != OLAP_SUCCESS
+                    && segment_group->find_last_row_block(&source_end_pos) != OLAP_SUCCESS) {
+                OLAP_LOG_WARNING("fail find last row block.");
+                return OLAP_ERR_TABLE_INDEX_FIND_ERROR;
+            }
+            source.block_bytes = std::max(1.0, static_cast<double>(segment_group->data_size())
+                    / std::max<uint64_t>(segment_group->num_index_entries(), 1));
+            // the block of the end key is read as well
+            uint64_t num_blocks = segment_group->compute_distance(
+                    source.start_pos, source_end_pos) + 1;
+            total_cost += num_blocks * source.block_bytes;
+            total_rows += num_blocks * segment_group->current_num_rows_per_row_block();
+        }
+    }
+    uint64_t num_ranges = std::max<uint64_t>(total_rows / request_block_row_count, 1);
+    double range_cost = total_cost / num_ranges;
+    // a range is cut at one of some candidate blocks, which are a sixteenth
+    // of its blocks in the largest segment group apart
+    uint64_t step_blocks = std::max<uint64_t>(
+            base_index->compute_distance(start_pos, end_pos) / (num_ranges * 16), 1);
+    // cost of the ranges before 'key'
+    auto cost_before = [&sources, &helper_cursor] (const RowCursor& key) {
+        double cost = 0;
+        for (auto& source : sources) {
+            RowBlockPosition pos;
+            if (source.segment_group->find_short_key(
+                        key, &helper_cursor, false, &pos) == OLAP_SUCCESS) {
+                cost += source.segment_group->compute_distance(source.start_pos, pos)
+                        * source.block_bytes;
+            }
+        }
+        return cost;
+    };
+
     //get rows between first and last
     OLAPStatus res = OLAP_SUCCESS;
     RowCursor cur_start_key;
@@ -1806,8 +2050,9 @@ OLAPStatus OLAPTable::split_range(
     // start_key是last start_key, 但返回的实际上是查询层给出的key
     ranges->emplace_back(start_key.to_tuple());
 
+    double next_cut_cost = range_cost;
     while (end_pos > step_pos) {
-        res = base_index->advance_row_block(expected_rows, &step_pos);
+        res = base_index->advance_row_block(step_blocks, &step_pos);
         if (res == OLAP_ERR_INDEX_EOF || !(end_pos > step_pos)) {
             break;
         } else if (res != OLAP_SUCCESS) {
@@ -1821,11 +2066,17 @@ OLAPStatus OLAPTable::split_range(
         }
         cur_start_key.attach(entry.data);
 
-        if (cur_start_key.cmp(last_start_key) != 0) {
-            ranges->emplace_back(cur_start_key.to_tuple()); // end of last section
-            ranges->emplace_back(cur_start_key.to_tuple()); // start a new section
-            last_start_key.copy_without_pool(cur_start_key);
+        if (cur_start_key.cmp(last_start_key) == 0) {
+            continue;
+        }
+        double cost = cost_before(cur_start_key);
+        if (cost < next_cut_cost) {
+            continue;
         }
+        ranges->emplace_back(cur_start_key.to_tuple()); // end of last section
+        ranges->emplace_back(cur_start_key.to_tuple()); // start a new section
+        last_start_key.copy_without_pool(cur_start_key);
+        next_cut_cost = cost + range_cost;
     }
 
     ranges->emplace_back(end_key.to_tuple());
@@ -1855,6 +2106,16 @@ void OLAPTable::_list_files_with_suffix(const string& file_suffix, set<string>*
     for (auto& it : _data_sources) {
         // every data segment has its file name.
         for (SegmentGroup* segment_group : it.second) {
+            if (segment_group->packed()) {
+                // listed with the data files, it holds them
+                if (file_suffix == "dat") {
+                    file_names->insert(basename(packed_file_path(construct_file_path(
+                            tablet_path_prefix, segment_group->version(),
+                            segment_group->version_hash(), segment_group->segment_group_id(),
+                            0, file_suffix)).c_str()));
+                }
+                continue;
+            }
             for (int32_t seg_id = 0; seg_id < segment_group->num_segments(); ++seg_id) {
                 file_names->insert(basename(construct_file_path(tablet_path_prefix,
                                                                 segment_group->version(),
@@ -1906,7 +2167,8 @@ void OLAPTable::list_version_entities(vector<VersionEntity>* version_entities) c
             }
             SegmentGroupEntity segment_group_entity(segment_group->segment_group_id(), segment_group->num_segments(),
                               segment_group->num_rows(), segment_group->data_size(),
-                              segment_group->index_size(), segment_group->empty(), column_statistics);
+                              segment_group->index_size(), segment_group->empty(), column_statistics,
+                              segment_group->packed());
             version_entity.add_segment_group_entity(segment_group_entity);
         }
         version_entities->push_back(version_entity);
@@ -2236,6 +2498,42 @@ bool OLAPTable::is_used() {
     return !_is_bad && _store->is_used();
 }
 
+OLAPStatus OLAPTable::offload_cold_versions(ColdFileManager* manager, int64_t created_before,
+                                            int64_t* released_bytes) {
+    // the files are moved without holding the lock, the segment groups are
+    // acquired not to be removed meanwhile
+    vector<SegmentGroup*> segment_groups;
+    {
+        ReadLock rdlock(&_header_lock);
+        const PDelta* lastest_delta = lastest_version();
+        for (auto& it : _data_sources) {
+            if (lastest_delta != nullptr && it.first.second >= lastest_delta->end_version()) {
+                continue;
+            }
+            int64_t creation_time = 0;
+            if (version_creation_time(it.first, &creation_time) != OLAP_SUCCESS
+                    || creation_time >= created_before) {
+                continue;
+            }
+            for (SegmentGroup* segment_group : it.second) {
+                if (!segment_group->packed() && !segment_group->empty()) {
+                    segment_group->acquire();
+                    segment_groups.push_back(segment_group);
+                }
+            }
+        }
+    }
+
+    OLAPStatus res = OLAP_SUCCESS;
+    for (SegmentGroup* segment_group : segment_groups) {
+        if (res == OLAP_SUCCESS) {
+            res = segment_group->offload_data_files(manager, released_bytes);
+        }
+        segment_group->release();
+    }
+    return res;
+}
+
 VersionEntity OLAPTable::get_version_entity_by_version(const Version& version) {
     std::vector<SegmentGroup*>& index_vec = _data_sources[version];
     VersionEntity version_entity(version, index_vec[0]->version_hash());
@@ -2246,7 +2544,8 @@ VersionEntity OLAPTable::get_version_entity_by_version(const Version& version) {
         }
         SegmentGroupEntity segment_group_entity(segment_group->segment_group_id(), segment_group->num_segments(),
                           segment_group->num_rows(), segment_group->data_size(),
-                          segment_group->index_size(), segment_group->empty(), column_statistics);
+                          segment_group->index_size(), segment_group->empty(), column_statistics,
+                          segment_group->packed());
         version_entity.add_segment_group_entity(segment_group_entity);
     }
     return version_entity;
@@ -32,6 +32,7 @@
 #include "olap/olap_header.h"
 #include "olap/tuple.h"
 #include "olap/row_cursor.h"
+#include "olap/tablet_heat.h"
 #include "olap/utils.h"
 
 namespace doris {
@@ -39,9 +40,12 @@ class FieldInfo;
 class ColumnData;
 class OLAPHeader;
 class SegmentGroup;
+class ColdFileManager;
 class OLAPTable;
 class RowBlockPosition;
 class OlapStore;
+class PrimaryKeyIndex;
+class TColumnDistribution;
 
 // Define OLAPTable's shared_ptr. It is used for
 typedef std::shared_ptr<OLAPTable> OLAPTablePtr;
@@ -183,6 +187,11 @@ public:
     // check the pending data that still not publish version
     void get_expire_pending_data(std::vector<int64_t>* transaction_ids);
 
+    // Merges the value distributions of the columns over the segment groups of
+    // the versions. Columns without any, e.g. of versions written before they
+    // were collected, are left out.
+    void get_column_distributions(std::vector<TColumnDistribution>* distributions);
+
     bool has_expired_incremental_data();
     void delete_expired_incremental_data();
 
@@ -210,10 +219,21 @@ public:
                           const std::vector<Version>& versions_to_delete);
 
     // Atomically replaces one set of data sources with another. Returns
-    // true on success.
+    // true on success. 'merged' tells that the new data sources hold the rows
+    // of the old ones merged by a compaction.
     OLAPStatus replace_data_sources(const std::vector<Version>* old_versions,
                                 const std::vector<SegmentGroup*>* new_data_sources,
-                                std::vector<SegmentGroup*>* old_data_sources);
+                                std::vector<SegmentGroup*>* old_data_sources,
+                                bool merged = false);
+
+    // UNIQUE_KEYS tables which find the rows replaced by a version when it is
+    // published, instead of merging all versions at read time
+    bool is_merge_on_write() const;
+
+    // Builds the primary key index of a merge-on-write table if needed, so the
+    // delete bitmaps of all segment groups are complete.
+    // need to obtain header rdlock outside
+    OLAPStatus prepare_merge_on_write_read();
 
     // Computes the cumulative hash for given versions.
     // Only use Base file and Delta files to compute for simplicity and
@@ -502,6 +522,24 @@ public:
         return _compress_kind;
     }
 
+    int32_t compress_level() const {
+        return _header->compress_level();
+    }
+
+    bool compress_dictionary() const {
+        return _header->compress_dictionary();
+    }
+
+    // number of leading keys the pre-aggregates of segment groups are grouped by,
+    // 0 if they are not written
+    size_t pre_aggregate_key_num() const {
+        if (keys_type() != KeysType::AGG_KEYS
+                || _header->pre_aggregate_key_num() >= num_key_fields()) {
+            return 0;
+        }
+        return _header->pre_aggregate_key_num();
+    }
+
     int delete_data_conditions_size() const {
         return _header->delete_data_conditions_size();
     }
@@ -632,6 +670,22 @@ public:
         _last_compaction_failure_time = time;
     }
 
+    // timestamp of the last query reading this table, or of its creation
+    int64_t last_query_time() { return _last_query_time; }
+
+    void set_last_query_time(int64_t time) {
+        _last_query_time = time;
+    }
+
+    // Moves the data files of the versions created before 'created_before', in
+    // seconds, to the cold storage of 'manager'. The latest version is kept on
+    // the store, it is the one merged by the next cumulative compaction.
+    OLAPStatus offload_cold_versions(ColdFileManager* manager, int64_t created_before,
+                                     int64_t* released_bytes);
+
+    // decayed reads and writes of this table, see TabletHeat
+    TabletHeat* heat() { return &_heat; }
+
     // 得到当前table的root path路径，路径末尾不带斜杠(/)
     std::string storage_root_path_name() {
         return _storage_root_path;
@@ -718,6 +772,10 @@ private:
     OLAPStatus _create_hard_link(const std::string& from, const std::string& to,
                                  std::vector<std::string>* linked_success_files);
 
+    // Indexes segment groups added to _data_sources, or drops the primary key
+    // index if it can not follow. need to obtain header wrlock outside
+    void _add_to_primary_key_index(const std::vector<SegmentGroup*>& segment_groups);
+
     TTabletId _tablet_id;
     TSchemaHash _schema_hash;
     OLAPHeader* _header;
@@ -761,6 +819,13 @@ private:
     bool _table_for_check;
     std::atomic<bool> _is_bad;   // if this tablet is broken, set to true. default is false
     std::atomic<int64_t> _last_compaction_failure_time; // timestamp of last compaction failure
+    std::atomic<int64_t> _last_query_time;
+    TabletHeat _heat;
+
+    // Only built for merge-on-write tables, changed under the header wrlock or
+    // built under the header rdlock and _primary_key_index_lock
+    std::unique_ptr<PrimaryKeyIndex> _primary_key_index;
+    Mutex _primary_key_index_lock;
 
     DISALLOW_COPY_AND_ASSIGN(OLAPTable);
 };
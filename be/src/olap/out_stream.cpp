@@ -24,8 +24,10 @@
 
 namespace doris {
 
-OutStreamFactory::OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size) : 
+OutStreamFactory::OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size,
+                                   int32_t compress_level, uint32_t dictionary_size) : 
         _compress_kind(compress_kind),
+        _zstd_compressor(NULL),
         _stream_buffer_size(stream_buffer_size) {
     switch (compress_kind) {
     case COMPRESS_NONE:
@@ -40,6 +42,15 @@ OutStreamFactory::OutStreamFactory(CompressKind compress_kind, uint32_t stream_b
         _compressor = lz4_compress;
         break;
 
+    case COMPRESS_ZSTD:
+        _zstd_compressor = new ZstdCompressor(compress_level, dictionary_size);
+        _compressor = std::bind(&ZstdCompressor::compress, _zstd_compressor,
+                std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+        _dictionary_compressor = std::bind(&ZstdCompressor::compress_with_dictionary,
+                _zstd_compressor,
+                std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+        break;
+
     default:
         LOG(FATAL) << "unknown compress kind. kind=" << compress_kind;
     }
@@ -50,14 +61,17 @@ OutStreamFactory::~OutStreamFactory() {
             it != _streams.end(); ++it) {
         SAFE_DELETE(it->second);
     }
+    SAFE_DELETE(_zstd_compressor);
 }
 
 OutStream* OutStreamFactory::create_stream(
-        uint32_t column_unique_id, StreamInfoMessage::Kind kind) {
+        uint32_t column_unique_id, StreamInfoMessage::Kind kind, bool use_dictionary) {
     OutStream* stream = NULL;
 
     if (StreamInfoMessage::ROW_INDEX == kind || StreamInfoMessage::BLOOM_FILTER == kind) {
         stream = new(std::nothrow) OutStream(_stream_buffer_size, NULL);
+    } else if (use_dictionary && _dictionary_compressor != nullptr) {
+        stream = new(std::nothrow) OutStream(_stream_buffer_size, _dictionary_compressor);
     } else {
         stream = new(std::nothrow) OutStream(_stream_buffer_size, _compressor);
     }
@@ -72,6 +86,11 @@ OutStream* OutStreamFactory::create_stream(
     return stream;
 }
 
+const std::string& OutStreamFactory::compress_dictionary() const {
+    static const std::string empty_dictionary;
+    return _zstd_compressor != NULL ? _zstd_compressor->dictionary() : empty_dictionary;
+}
+
 OutStream::OutStream(uint32_t buffer_size, Compressor compressor) : 
         _buffer_size(buffer_size),
         _compressor(compressor),
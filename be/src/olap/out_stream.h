@@ -144,20 +144,39 @@ private:
 // 将所有的输出流托管,同时封装了诸如压缩算法,是否启用Index,block大小等信息
 class OutStreamFactory {
 public:
-    explicit OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size);
+    // compress_level - zstd level, 0 means zstd's default
+    // dictionary_size - size of the zstd dictionary trained for the streams
+    //                   created with use_dictionary, 0 to train none
+    explicit OutStreamFactory(CompressKind compress_kind, uint32_t stream_buffer_size,
+                              int32_t compress_level = 0, uint32_t dictionary_size = 0);
 
     ~OutStreamFactory();
 
     // 创建后的stream的生命期依旧由OutStreamFactory管理
-    OutStream* create_stream(uint32_t column_unique_id, StreamInfoMessage::Kind kind);
+    // use_dictionary - compress the stream with the zstd dictionary of the
+    //                  segment, for streams holding string bytes
+    OutStream* create_stream(uint32_t column_unique_id, StreamInfoMessage::Kind kind,
+                             bool use_dictionary = false);
 
     const std::map<StreamName, OutStream*>& streams() const {
         return _streams;
     }
+
+    // zstd dictionary used by the streams, empty if none was trained.
+    // Valid after all streams are flushed.
+    const std::string& compress_dictionary() const;
+
+    // True if streams can be written on different threads, the zstd
+    // compressor keeps its context and dictionary samples for all streams
+    bool thread_safe() const {
+        return _zstd_compressor == NULL;
+    }
 private:
     std::map<StreamName, OutStream*> _streams; // 所有创建过的流
     CompressKind _compress_kind;
     Compressor _compressor;
+    Compressor _dictionary_compressor;
+    ZstdCompressor* _zstd_compressor;
     uint32_t _stream_buffer_size;
 
     DISALLOW_COPY_AND_ASSIGN(OutStreamFactory);
@@ -0,0 +1,147 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/packed_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "gen_cpp/olap_file.pb.h"
+#include "olap/file_helper.h"
+
+namespace doris {
+
+// the members start at multiples of this from the end of the header
+static const off_t PACKED_FILE_ALIGNMENT = 4096;
+static const size_t PACKED_FILE_COPY_BUFFER_SIZE = 1024 * 1024;
+
+static off_t align_packed_offset(off_t offset) {
+    return (offset + PACKED_FILE_ALIGNMENT - 1) / PACKED_FILE_ALIGNMENT * PACKED_FILE_ALIGNMENT;
+}
+
+std::string packed_file_path(const std::string& data_file_path) {
+    size_t pos = data_file_path.rfind('.');
+    return data_file_path.substr(0, pos) + ".pack";
+}
+
+std::string packed_member_name(int32_t segment, const std::string& suffix) {
+    return std::to_string(segment) + "." + suffix;
+}
+
+static OLAPStatus copy_packed_member(const std::string& path, off_t length,
+                                     off_t offset, char* buf, FileHandler* packed_file) {
+    FileHandler file;
+    OLAPStatus res = file.open(path, O_RDONLY);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to open file to pack. file=" << path;
+        return res;
+    }
+    for (off_t pos = 0; pos < length; ) {
+        size_t size = std::min<off_t>(PACKED_FILE_COPY_BUFFER_SIZE, length - pos);
+        RETURN_NOT_OK(file.pread(buf, size, pos));
+        RETURN_NOT_OK(packed_file->pwrite(buf, size, offset + pos));
+        pos += size;
+    }
+    return file.close();
+}
+
+OLAPStatus write_packed_file(const std::vector<std::string>& names,
+                             const std::vector<std::string>& paths,
+                             const std::string& packed_path) {
+    DCHECK_EQ(names.size(), paths.size());
+    FileHeader<PackedFileHeaderMessage> file_header;
+    std::vector<off_t> lengths;
+    off_t end = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        struct stat stat_data;
+        if (stat(paths[i].c_str(), &stat_data) != 0) {
+            char errmsg[64];
+            LOG(WARNING) << "fail to stat file to pack. [err=" << strerror_r(errno, errmsg, 64)
+                         << " file='" << paths[i] << "']";
+            return OLAP_ERR_IO_ERROR;
+        }
+        PackedFileMember* member = file_header.mutable_message()->add_member();
+        member->set_name(names[i]);
+        member->set_offset(align_packed_offset(end));
+        member->set_length(stat_data.st_size);
+        lengths.push_back(stat_data.st_size);
+        end = member->offset() + member->length();
+    }
+
+    FileHandler packed_file;
+    OLAPStatus res = packed_file.open_with_mode(
+            packed_path, O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to create packed file. file=" << packed_path;
+        return res;
+    }
+    RETURN_NOT_OK(file_header.prepare(&packed_file));
+    off_t data_offset = align_packed_offset(file_header.size());
+    file_header.set_file_length(data_offset + end);
+
+    std::unique_ptr<char[]> buf(new(std::nothrow) char[PACKED_FILE_COPY_BUFFER_SIZE]);
+    if (buf == nullptr) {
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+    for (size_t i = 0; i < paths.size(); ++i) {
+        off_t offset = data_offset + file_header.message().member(i).offset();
+        res = copy_packed_member(paths[i], lengths[i], offset, buf.get(), &packed_file);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to pack file. file=" << paths[i] << ", packed_file=" << packed_path;
+            return res;
+        }
+    }
+    RETURN_NOT_OK(file_header.serialize(&packed_file));
+    return packed_file.close();
+}
+
+OLAPStatus read_packed_file_directory(const std::string& packed_path,
+                                      PackedFileDirectory* directory) {
+    FileHandler packed_file;
+    // the members are opened through the cache right after
+    OLAPStatus res = packed_file.open_with_cache(packed_path, O_RDONLY);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to open packed file. file=" << packed_path;
+        return res;
+    }
+    FileHeader<PackedFileHeaderMessage> file_header;
+    res = file_header.unserialize(&packed_file);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to read packed file header. file=" << packed_path;
+        return res;
+    }
+
+    off_t data_offset = align_packed_offset(file_header.size());
+    directory->clear();
+    for (const PackedFileMember& member : file_header.message().member()) {
+        off_t offset = data_offset + member.offset();
+        if (offset + static_cast<off_t>(member.length())
+                > static_cast<off_t>(file_header.file_length())) {
+            LOG(WARNING) << "packed file member out of range. file=" << packed_path
+                         << ", member=" << member.name();
+            return OLAP_ERR_FILE_DATA_ERROR;
+        }
+        (*directory)[member.name()] = {offset, static_cast<off_t>(member.length())};
+    }
+    return OLAP_SUCCESS;
+}
+
+}  // namespace doris
@@ -0,0 +1,66 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_PACKED_FILE_H
+#define DORIS_BE_SRC_OLAP_PACKED_FILE_H
+
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "olap/olap_define.h"
+
+namespace doris {
+
+// A packed segment group keeps the index and data files of all its segments in
+// one file, so that reading it takes one descriptor of the fd cache instead of
+// two per segment, and one inode. The members follow a
+// FileHeader<PackedFileHeaderMessage> listing them, each starting at a page
+// boundary so that they can still be mmap-ed. Every member is exactly the file
+// it replaces, readers open it through FileHandler::open_range_with_cache().
+
+struct PackedFileRange {
+    off_t offset;
+    off_t length;
+};
+
+// the ranges of the members of a packed file, by name
+typedef std::map<std::string, PackedFileRange> PackedFileDirectory;
+
+// Path of the packed file of the segment group of the given first data file.
+std::string packed_file_path(const std::string& data_file_path);
+
+// Name of the member of a packed file holding the file of 'segment' with the
+// given suffix, "idx" or "dat".
+std::string packed_member_name(int32_t segment, const std::string& suffix);
+
+// Writes the files of 'paths' into a new packed file at 'packed_path', as the
+// members named by 'names'. The files are left in place.
+OLAPStatus write_packed_file(const std::vector<std::string>& names,
+                             const std::vector<std::string>& paths,
+                             const std::string& packed_path);
+
+// Reads the members of the packed file at 'packed_path'.
+OLAPStatus read_packed_file_directory(const std::string& packed_path,
+                                      PackedFileDirectory* directory);
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_PACKED_FILE_H
@@ -0,0 +1,136 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/pre_aggregate.h"
+
+#include <stdio.h>
+
+#include "common/config.h"
+
+namespace doris {
+
+static bool is_pre_aggregate_value(const FieldInfo& column) {
+    if (column.type == OLAP_FIELD_TYPE_CHAR || column.type == OLAP_FIELD_TYPE_VARCHAR
+            || column.type == OLAP_FIELD_TYPE_HLL) {
+        return false;
+    }
+    return column.aggregation == OLAP_FIELD_AGGREGATION_SUM
+            || column.aggregation == OLAP_FIELD_AGGREGATION_MIN
+            || column.aggregation == OLAP_FIELD_AGGREGATION_MAX;
+}
+
+bool get_pre_aggregate_columns(const std::vector<FieldInfo>& tablet_schema, size_t key_num,
+                               std::vector<uint32_t>* key_cids,
+                               std::vector<uint32_t>* value_cids) {
+    key_cids->clear();
+    value_cids->clear();
+    if (key_num == 0) {
+        return false;
+    }
+    for (uint32_t cid = 0; cid < tablet_schema.size(); ++cid) {
+        if (tablet_schema[cid].is_key) {
+            if (cid < key_num) {
+                key_cids->push_back(cid);
+            }
+        } else if (is_pre_aggregate_value(tablet_schema[cid])) {
+            value_cids->push_back(cid);
+        }
+    }
+    return key_cids->size() == key_num;
+}
+
+std::string pre_aggregate_file_path(const std::string& data_file_path) {
+    size_t pos = data_file_path.rfind('.');
+    return data_file_path.substr(0, pos) + ".pagg";
+}
+
+int pre_aggregate_key_cmp(const std::vector<uint32_t>& key_cids,
+                          const RowCursor& lhs, const RowCursor& rhs) {
+    for (uint32_t cid : key_cids) {
+        int res = lhs.get_field_by_index(cid)->cmp(lhs.get_field_ptr(cid),
+                                                   rhs.get_field_ptr(cid));
+        if (res != 0) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+static std::vector<uint32_t> merge_columns(const std::vector<uint32_t>& key_cids,
+                                           const std::vector<uint32_t>& value_cids) {
+    std::vector<uint32_t> columns(key_cids);
+    columns.insert(columns.end(), value_cids.begin(), value_cids.end());
+    return columns;
+}
+
+PreAggregateWriter::PreAggregateWriter(const std::vector<FieldInfo>& tablet_schema,
+                                       const std::vector<uint32_t>& key_cids,
+                                       const std::vector<uint32_t>& value_cids) :
+        _key_cids(key_cids),
+        _value_cids(value_cids),
+        _columns(merge_columns(key_cids, value_cids)),
+        _has_row(false),
+        _tracker(new MemTracker(-1)),
+        _mem_pool(new MemPool(_tracker.get())),
+        _writer(tablet_schema, _columns, config::pre_aggregate_buffer_kbytes * 1024L) {
+    _row.init(tablet_schema, _columns);
+}
+
+OLAPStatus PreAggregateWriter::open(const std::string& file_name) {
+    _file_name = file_name;
+    _has_row = false;
+    return _writer.open(file_name);
+}
+
+OLAPStatus PreAggregateWriter::add(const RowCursor& row) {
+    if (_has_row) {
+        int res = pre_aggregate_key_cmp(_key_cids, _row, row);
+        if (res == 0) {
+            RowCursor::aggregate(_value_cids, &_row, &row);
+            return OLAP_SUCCESS;
+        }
+        if (res > 0) {
+            LOG(WARNING) << "rows of pre-aggregates are out of order. file=" << _file_name;
+            return OLAP_ERR_INPUT_PARAMETER_ERROR;
+        }
+        RETURN_NOT_OK(_writer.append(_row));
+        // strings of the keys written out are not needed any more
+        _mem_pool->clear();
+    }
+    _row.copy(row, _mem_pool.get());
+    _has_row = true;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus PreAggregateWriter::close() {
+    if (_has_row) {
+        RETURN_NOT_OK(_writer.append(_row));
+        _has_row = false;
+    }
+    return _writer.close();
+}
+
+void PreAggregateWriter::abandon() {
+    _has_row = false;
+    _writer.close();
+    if (!_file_name.empty() && remove(_file_name.c_str()) != 0) {
+        LOG(WARNING) << "fail to remove pre-aggregates. file=" << _file_name;
+    }
+}
+
+}  // namespace doris
@@ -0,0 +1,94 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_PRE_AGGREGATE_H
+#define DORIS_BE_SRC_OLAP_PRE_AGGREGATE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "olap/field.h"
+#include "olap/olap_define.h"
+#include "olap/row_cursor.h"
+#include "olap/sorted_run_file.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+
+namespace doris {
+
+// Pre-aggregates of a segment group are its rows aggregated by the first
+// pre_aggregate_key_num keys of an AGG_KEYS table, like a rollup of those keys
+// kept by the segment group itself. Only the value columns whose aggregation
+// gives the same result in any order are kept, i.e. SUM, MIN and MAX of types
+// other than strings. They are a sorted run of the kept columns beside the
+// first segment, so a query reading no other column may read them in place of
+// the segments. Segment groups written before or linked by schema change have
+// none, they are read as usual.
+
+// Gets the columns kept in the pre-aggregates of a table whose segment groups
+// are aggregated by 'key_num' keys. Returns false if none are kept.
+bool get_pre_aggregate_columns(const std::vector<FieldInfo>& tablet_schema, size_t key_num,
+                               std::vector<uint32_t>* key_cids,
+                               std::vector<uint32_t>* value_cids);
+
+// Path of the pre-aggregates of the segment group of the given first data file.
+std::string pre_aggregate_file_path(const std::string& data_file_path);
+
+// Compares the 'key_cids' columns of two rows.
+int pre_aggregate_key_cmp(const std::vector<uint32_t>& key_cids,
+                          const RowCursor& lhs, const RowCursor& rhs);
+
+class PreAggregateWriter {
+public:
+    PreAggregateWriter(const std::vector<FieldInfo>& tablet_schema,
+                       const std::vector<uint32_t>& key_cids,
+                       const std::vector<uint32_t>& value_cids);
+    ~PreAggregateWriter() {}
+
+    OLAPStatus open(const std::string& file_name);
+
+    // Rows are added in the order of the keys, or else an error is returned
+    // and the writer has to be abandoned.
+    OLAPStatus add(const RowCursor& row);
+
+    // writes out the last row and closes the file
+    OLAPStatus close();
+
+    // closes and removes the file, the segment group is left without pre-aggregates
+    void abandon();
+
+    uint64_t num_rows() const { return _writer.num_rows(); }
+
+private:
+    std::vector<uint32_t> _key_cids;
+    std::vector<uint32_t> _value_cids;
+    std::vector<uint32_t> _columns;
+    std::string _file_name;
+    RowCursor _row;
+    bool _has_row;
+    std::unique_ptr<MemTracker> _tracker;
+    std::unique_ptr<MemPool> _mem_pool;
+    SortedRunWriter _writer;
+
+    DISALLOW_COPY_AND_ASSIGN(PreAggregateWriter);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_PRE_AGGREGATE_H
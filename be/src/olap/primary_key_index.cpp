@@ -0,0 +1,238 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/primary_key_index.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_set>
+
+#include "olap/column_data.h"
+#include "olap/column_predicate.h"
+#include "olap/delete_bitmap.h"
+#include "olap/olap_cond.h"
+#include "olap/olap_table.h"
+#include "olap/row_block.h"
+#include "olap/row_cursor.h"
+#include "olap/segment_group.h"
+
+namespace doris {
+
+uint32_t PrimaryKeyIndex::_add_group(SegmentGroup* segment_group) {
+    uint32_t group_id = _groups.size();
+    _groups.push_back(segment_group);
+    _group_ids[segment_group] = group_id;
+    return group_id;
+}
+
+OLAPStatus PrimaryKeyIndex::add(const std::vector<SegmentGroup*>& segment_groups) {
+    // rows of a newer version replace the older ones, segment groups of one
+    // version are written in the order of their ids
+    std::vector<SegmentGroup*> groups(segment_groups);
+    std::sort(groups.begin(), groups.end(), [](const SegmentGroup* a, const SegmentGroup* b) {
+        if (a->version().first != b->version().first) {
+            return a->version().first < b->version().first;
+        }
+        return a->segment_group_id() < b->segment_group_id();
+    });
+
+    for (SegmentGroup* segment_group : groups) {
+        Version version = segment_group->version();
+        if (!can_add(version) || _group_ids.count(segment_group) != 0) {
+            LOG(WARNING) << "segment group is older than the primary key index. "
+                         << "table=" << _table->full_name()
+                         << ", version=" << version.first << "-" << version.second
+                         << ", index_version=" << _max_version.first << "-" << _max_version.second;
+            return OLAP_ERR_INPUT_PARAMETER_ERROR;
+        }
+        uint32_t group_id = _add_group(segment_group);
+        _max_version = version;
+        if (segment_group->empty() || segment_group->zero_num_rows()) {
+            continue;
+        }
+
+        // rows are marked as replaced by the version they are replaced in,
+        // rows of a delete version delete their keys at once
+        std::map<uint32_t, DeleteBitmap> replaced;
+        bool delete_flag = segment_group->delete_flag();
+        auto res = _scan_keys(segment_group,
+                [&](const std::string& key, uint32_t segment, uint32_t row) {
+            RowLocation location = {group_id, segment, row};
+            auto it = _index.find(key);
+            if (it == _index.end()) {
+                _index.emplace(key, location);
+            } else {
+                const RowLocation& old = it->second;
+                if (_groups[old.group] != nullptr) {
+                    replaced[old.group].add(old.segment, old.row, version.second);
+                }
+                it->second = location;
+            }
+            if (delete_flag) {
+                replaced[group_id].add(segment, row, version.second);
+            }
+        });
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to index keys of segment group. res=" << res
+                         << ", table=" << _table->full_name()
+                         << ", version=" << version.first << "-" << version.second;
+            return res;
+        }
+        for (auto& it : replaced) {
+            _groups[it.first]->add_replaced_rows(it.second);
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus PrimaryKeyIndex::replace(const std::vector<SegmentGroup*>& inputs,
+                                    SegmentGroup* output) {
+    int64_t output_version = output->version().second;
+    std::unordered_set<uint32_t> input_ids;
+    for (SegmentGroup* input : inputs) {
+        auto it = _group_ids.find(input);
+        if (it == _group_ids.end()) {
+            LOG(WARNING) << "compaction input is not in the primary key index. "
+                         << "table=" << _table->full_name()
+                         << ", version=" << input->version().first
+                         << "-" << input->version().second;
+            return OLAP_ERR_INPUT_PARAMETER_ERROR;
+        }
+        input_ids.insert(it->second);
+    }
+
+    // The newest row of a key in the inputs may be replaced by a version
+    // published while the compaction ran. Its mark goes to the row of the key
+    // in the output, all older marks are of rows the compaction dropped.
+    std::unordered_map<std::string, int64_t> replaced_later;
+    for (SegmentGroup* input : inputs) {
+        std::shared_ptr<const DeleteBitmap> bitmap = input->delete_bitmap();
+        if (bitmap == nullptr || bitmap->max_version() <= output_version) {
+            continue;
+        }
+        auto res = _scan_keys(input, [&](const std::string& key, uint32_t segment, uint32_t row) {
+            int64_t version = bitmap->get(segment, row);
+            if (version > output_version) {
+                replaced_later[key] = version;
+            }
+        });
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to scan keys of compaction input. res=" << res
+                         << ", table=" << _table->full_name();
+            return res;
+        }
+    }
+
+    uint32_t output_id = _add_group(output);
+    DeleteBitmap replaced;
+    if (!output->empty() && !output->zero_num_rows()) {
+        auto res = _scan_keys(output, [&](const std::string& key, uint32_t segment, uint32_t row) {
+            RowLocation location = {output_id, segment, row};
+            auto it = _index.find(key);
+            if (it == _index.end()) {
+                _index.emplace(key, location);
+            } else if (_groups[it->second.group] == nullptr
+                    || input_ids.count(it->second.group) != 0) {
+                it->second = location;
+            }
+            auto later = replaced_later.find(key);
+            if (later != replaced_later.end()) {
+                replaced.add(segment, row, later->second);
+            }
+        });
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to index keys of compaction output. res=" << res
+                         << ", table=" << _table->full_name();
+            return res;
+        }
+    }
+    if (!replaced.empty()) {
+        output->set_delete_bitmap(std::make_shared<const DeleteBitmap>(std::move(replaced)));
+    }
+
+    for (uint32_t input_id : input_ids) {
+        _group_ids.erase(_groups[input_id]);
+        _groups[input_id] = nullptr;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus PrimaryKeyIndex::_scan_keys(SegmentGroup* segment_group, const KeyVisitor& visitor) {
+    std::vector<uint32_t> key_cids;
+    for (uint32_t cid = 0; cid < _table->num_key_fields(); ++cid) {
+        key_cids.push_back(cid);
+    }
+    RowCursor cursor;
+    RETURN_NOT_OK(cursor.init(_table->tablet_schema(), key_cids));
+
+    std::unique_ptr<ColumnData> data(ColumnData::create(segment_group));
+    if (data == nullptr) {
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+    RETURN_NOT_OK(data->init());
+    OlapReaderStatistics stats;
+    Conditions conditions;
+    std::vector<ColumnPredicate*> col_predicates;
+    data->set_stats(&stats);
+    data->set_read_params(key_cids, key_cids, std::set<uint32_t>(), conditions,
+                          col_predicates, false, nullptr);
+
+    // nothing is filtered, so rows of a segment come one after another
+    RowBlock* block = nullptr;
+    OLAPStatus res = data->prepare_block_read(nullptr, false, nullptr, false, &block);
+    uint32_t segment = 0;
+    uint32_t row = 0;
+    std::string key;
+    while (res == OLAP_SUCCESS && block != nullptr) {
+        if (data->current_segment() != segment) {
+            segment = data->current_segment();
+            row = 0;
+        }
+        for (size_t i = block->pos(); i < block->limit(); ++i) {
+            block->get_row(i, &cursor);
+            _encode_key(cursor, &key);
+            visitor(key, segment, row++);
+        }
+        res = data->get_next_block(&block);
+    }
+    return res == OLAP_ERR_DATA_EOF ? OLAP_SUCCESS : res;
+}
+
+void PrimaryKeyIndex::_encode_key(const RowCursor& row, std::string* key) const {
+    key->clear();
+    for (uint32_t cid = 0; cid < _table->num_key_fields(); ++cid) {
+        bool is_null = row.is_null(cid);
+        key->push_back(is_null);
+        if (is_null) {
+            continue;
+        }
+        const char* content = row.get_field_content_ptr(cid);
+        FieldType type = _table->tablet_schema()[cid].type;
+        if (type == OLAP_FIELD_TYPE_CHAR || type == OLAP_FIELD_TYPE_VARCHAR) {
+            const Slice* slice = reinterpret_cast<const Slice*>(content);
+            uint32_t size = slice->size;
+            key->append(reinterpret_cast<const char*>(&size), sizeof(size));
+            key->append(slice->data, size);
+        } else {
+            key->append(content, row.get_field_by_index(cid)->size());
+        }
+    }
+}
+
+}  // namespace doris
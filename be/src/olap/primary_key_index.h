@@ -0,0 +1,95 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_PRIMARY_KEY_INDEX_H
+#define DORIS_BE_SRC_OLAP_PRIMARY_KEY_INDEX_H
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "olap/olap_common.h"
+#include "olap/olap_define.h"
+
+namespace doris {
+
+class OLAPTable;
+class RowCursor;
+class SegmentGroup;
+
+// Location of the newest row of every key of a merge-on-write UNIQUE_KEYS
+// table. When a version is published its keys are looked up, and the rows
+// they replace are marked in the delete bitmaps of their segment groups, so
+// queries read the segment groups like DUP_KEYS data instead of merging them.
+//
+// The index is only kept in memory. It is built from the key columns of all
+// segment groups by the first query after the BE starts or after a change of
+// the data sources it can not follow, see OLAPTable::prepare_merge_on_write_read.
+class PrimaryKeyIndex {
+public:
+    explicit PrimaryKeyIndex(OLAPTable* table) : _table(table) {}
+
+    // Indexes the keys of 'segment_groups', which must be newer than all
+    // segment groups indexed before. The index must be dropped if this fails.
+    OLAPStatus add(const std::vector<SegmentGroup*>& segment_groups);
+
+    // Points the keys of the compaction 'inputs' to their rows in 'output'.
+    // Marks of the inputs made by versions newer than 'output' are moved to
+    // the output rows. The index must be dropped if this fails.
+    OLAPStatus replace(const std::vector<SegmentGroup*>& inputs, SegmentGroup* output);
+
+    // Returns true if segment groups of 'version' may be added
+    bool can_add(const Version& version) const {
+        return version == _max_version || version.first > _max_version.second;
+    }
+
+    size_t num_keys() const { return _index.size(); }
+
+private:
+    struct RowLocation {
+        uint32_t group;
+        uint32_t segment;
+        uint32_t row;
+    };
+
+    typedef std::function<void(const std::string& key, uint32_t segment, uint32_t row)>
+        KeyVisitor;
+
+    // Calls 'visitor' for every row of 'segment_group' in storage order
+    OLAPStatus _scan_keys(SegmentGroup* segment_group, const KeyVisitor& visitor);
+
+    void _encode_key(const RowCursor& row, std::string* key) const;
+
+    uint32_t _add_group(SegmentGroup* segment_group);
+
+    OLAPTable* _table;
+
+    // Indexed segment groups, an entry is set to nullptr when a compaction
+    // removes it. Keys still pointing to such an entry are treated as absent.
+    std::vector<SegmentGroup*> _groups;
+    std::unordered_map<const SegmentGroup*, uint32_t> _group_ids;
+
+    std::unordered_map<std::string, RowLocation> _index;
+    Version _max_version = {-1, -1};
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_PRIMARY_KEY_INDEX_H
@@ -17,6 +17,8 @@
 
 #include "olap/push_handler.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <iostream>
 #include <sstream>
@@ -955,10 +957,16 @@ IBinaryReader* IBinaryReader::create(bool need_decompress) {
     return reader;
 }
 
+// rows are read from the file in blocks of this size and parsed in place
+static const size_t BINARY_READER_BUF_SIZE = 1024 * 1024;
+
 BinaryReader::BinaryReader()
     : IBinaryReader(),
       _row_buf(NULL),
-      _row_buf_size(0) {
+      _row_buf_size(0),
+      _buf_len(0),
+      _buf_pos(0),
+      _read_len(0) {
 }
 
 OLAPStatus BinaryReader::init(
@@ -969,10 +977,11 @@ OLAPStatus BinaryReader::init(
     do {
         _file = file;
         _content_len = _file->file_length() - _file->header_size();
-        _row_buf_size = table->get_row_size();
+        // a whole row must fit in the buffer to be parsed in place
+        _row_buf_size = std::max(BINARY_READER_BUF_SIZE, table->get_row_size());
 
         if (NULL == (_row_buf = new(std::nothrow) char[_row_buf_size])) {
-            OLAP_LOG_WARNING("fail to malloc one row buf. [size=%zu]", _row_buf_size);
+            OLAP_LOG_WARNING("fail to malloc rows buf. [size=%zu]", _row_buf_size);
             res = OLAP_ERR_MALLOC_ERROR;
             break;
         }
@@ -983,6 +992,9 @@ OLAPStatus BinaryReader::init(
             break;
         }
 
+        _buf_len = 0;
+        _buf_pos = 0;
+        _read_len = 0;
         _table = table;
         _ready = true;
     } while (0);
@@ -999,6 +1011,30 @@ OLAPStatus BinaryReader::finalize() {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus BinaryReader::_fill_buf(size_t size) {
+    size_t remain = _buf_len - _buf_pos;
+    if (remain >= size || _read_len >= _content_len) {
+        return OLAP_SUCCESS;
+    }
+
+    // move the unparsed tail to the front, the buffer is refilled behind it
+    if (remain > 0 && _buf_pos > 0) {
+        memmove(_row_buf, _row_buf + _buf_pos, remain);
+    }
+    _buf_pos = 0;
+    _buf_len = remain;
+
+    size_t read_size = std::min(_row_buf_size - remain, _content_len - _read_len);
+    OLAPStatus res = _file->read(_row_buf + remain, read_size);
+    if (OLAP_SUCCESS != res) {
+        OLAP_LOG_WARNING("read file for rows fail. [res=%d]", res);
+        return res;
+    }
+    _buf_len += read_size;
+    _read_len += read_size;
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus BinaryReader::next(RowCursor* row, MemPool* mem_pool) {
     OLAPStatus res = OLAP_SUCCESS;
 
@@ -1007,14 +1043,22 @@ OLAPStatus BinaryReader::next(RowCursor* row, MemPool* mem_pool) {
         return OLAP_ERR_INPUT_PARAMETER_ERROR;
     }
 
+    // get_row_size() is the longest a row can be, so the row is in the buffer
+    // unless the file is truncated
+    if (OLAP_SUCCESS != (res = _fill_buf(_table->get_row_size()))) {
+        return res;
+    }
+    char* row_buf = _row_buf + _buf_pos;
+    size_t buf_len = _buf_len - _buf_pos;
+
     const vector<FieldInfo>& schema = _table->tablet_schema();
     size_t offset = 0;
     size_t field_size = 0;
     size_t num_null_bytes = (_table->num_null_fields() + 7) / 8;
 
-    if (OLAP_SUCCESS != (res = _file->read(_row_buf + offset, num_null_bytes))) {
-        OLAP_LOG_WARNING("read file for one row fail. [res=%d]", res);
-        return res;
+    if (num_null_bytes > buf_len) {
+        OLAP_LOG_WARNING("read file for one row fail. [res=%d]", OLAP_ERR_READ_UNENOUGH);
+        return OLAP_ERR_READ_UNENOUGH;
     }
 
     size_t p  = 0;
@@ -1022,7 +1066,7 @@ OLAPStatus BinaryReader::next(RowCursor* row, MemPool* mem_pool) {
         row->set_not_null(i);
         if (schema[i].is_allow_null) {
             bool is_null = false;
-            is_null = (_row_buf[p/8] >> ((num_null_bytes * 8 - p - 1) % 8)) & 1;
+            is_null = (row_buf[p/8] >> ((num_null_bytes * 8 - p - 1) % 8)) & 1;
             if (is_null) {
                 row->set_null(i);
             }
@@ -1037,14 +1081,13 @@ OLAPStatus BinaryReader::next(RowCursor* row, MemPool* mem_pool) {
         }
         if (schema[i].type == OLAP_FIELD_TYPE_VARCHAR || schema[i].type == OLAP_FIELD_TYPE_HLL) {
             // Read varchar length buffer first
-            if (OLAP_SUCCESS != (res = _file->read(_row_buf + offset,
-                        sizeof(StringLengthType)))) {
-                OLAP_LOG_WARNING("read file for one row fail. [res=%d]", res);
-                return res;
+            if (offset + sizeof(StringLengthType) > buf_len) {
+                OLAP_LOG_WARNING("read file for one row fail. [res=%d]", OLAP_ERR_READ_UNENOUGH);
+                return OLAP_ERR_READ_UNENOUGH;
             }
 
             // Get varchar field size
-            field_size = *reinterpret_cast<StringLengthType*>(_row_buf + offset);
+            field_size = *reinterpret_cast<StringLengthType*>(row_buf + offset);
             offset += sizeof(StringLengthType);
             if (field_size > schema[i].length - sizeof(StringLengthType)) {
                 OLAP_LOG_WARNING("invalid data length for VARCHAR! [max_len=%d real_len=%d]",
@@ -1056,26 +1099,26 @@ OLAPStatus BinaryReader::next(RowCursor* row, MemPool* mem_pool) {
             field_size = schema[i].length;
         }
 
-        // Read field content according to field size
-        if (OLAP_SUCCESS != (res = _file->read(_row_buf + offset, field_size))) {
-            OLAP_LOG_WARNING("read file for one row fail. [res=%d]", res);
-            return res;
+        if (offset + field_size > buf_len) {
+            OLAP_LOG_WARNING("read file for one row fail. [res=%d]", OLAP_ERR_READ_UNENOUGH);
+            return OLAP_ERR_READ_UNENOUGH;
         }
 
         if (schema[i].type == OLAP_FIELD_TYPE_CHAR
                 || schema[i].type == OLAP_FIELD_TYPE_VARCHAR
                 || schema[i].type == OLAP_FIELD_TYPE_HLL) {
-            Slice slice(_row_buf + offset, field_size);
+            Slice slice(row_buf + offset, field_size);
             row->set_field_content(i, reinterpret_cast<char*>(&slice), mem_pool);
         } else {
-            row->set_field_content(i, _row_buf + offset, mem_pool);
+            row->set_field_content(i, row_buf + offset, mem_pool);
         }
         offset += field_size;
     }
+    _buf_pos += offset;
     _curr += offset;
 
     // Calculate checksum for validate when push finished.
-    _adler_checksum = olap_adler32(_adler_checksum, _row_buf, offset);
+    _adler_checksum = olap_adler32(_adler_checksum, row_buf, offset);
     return res;
 }
 
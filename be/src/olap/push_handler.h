@@ -249,8 +249,18 @@ public:
     }
 
 private:
+    // makes at least 'size' unparsed bytes available in _row_buf, less only
+    // if the file ends before
+    OLAPStatus _fill_buf(size_t size);
+
     char* _row_buf;
     size_t _row_buf_size;
+    // valid bytes in _row_buf
+    size_t _buf_len;
+    // start of the next row in _row_buf
+    size_t _buf_pos;
+    // content bytes read from the file
+    size_t _read_len;
 };
 
 class LzoBinaryReader: public IBinaryReader {
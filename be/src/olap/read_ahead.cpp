@@ -0,0 +1,260 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/read_ahead.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
+#include "olap/file_helper.h"
+
+namespace doris {
+
+ReadAheadBuffer::ReadAheadBuffer(size_t capacity)
+        : _state(IDLE),
+        _handler(nullptr),
+        _offset(0),
+        _length(0),
+        _status(OLAP_SUCCESS),
+        _data(new char[capacity]),
+        _capacity(capacity) {
+}
+
+ReadAheadBuffer::~ReadAheadBuffer() {
+    delete[] _data;
+}
+
+void ReadAheadBuffer::start(FileHandler* handler, size_t offset, size_t length) {
+    DCHECK(!is_busy());
+    DCHECK_LE(length, _capacity);
+    _handler = handler;
+    _offset = offset;
+    _length = length;
+    _status = OLAP_SUCCESS;
+    _state = QUEUED;
+}
+
+void ReadAheadBuffer::_read() {
+    _status = _handler->pread(_data, _length, _offset);
+    std::lock_guard<std::mutex> l(_lock);
+    _state = DONE;
+    _cv.notify_all();
+}
+
+void ReadAheadBuffer::run() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (_state != QUEUED) {
+            return;
+        }
+        _state = RUNNING;
+    }
+    _read();
+}
+
+void ReadAheadBuffer::finish(OLAPStatus status) {
+    std::lock_guard<std::mutex> l(_lock);
+    DCHECK(_state == QUEUED);
+    _status = status;
+    _state = (status == OLAP_SUCCESS) ? DONE : IDLE;
+    _cv.notify_all();
+}
+
+OLAPStatus ReadAheadBuffer::wait() {
+    std::unique_lock<std::mutex> l(_lock);
+    if (_state == QUEUED) {
+        _state = RUNNING;
+        l.unlock();
+        _read();
+        l.lock();
+    }
+    while (_state == RUNNING) {
+        _cv.wait(l);
+    }
+    return _status;
+}
+
+void ReadAheadBuffer::cancel() {
+    std::unique_lock<std::mutex> l(_lock);
+    while (_state == RUNNING) {
+        _cv.wait(l);
+    }
+    _state = IDLE;
+}
+
+static __thread uint64_t s_thread_group = 0;
+static __thread int s_thread_weight = 1;
+
+ReadAheadQueue::ReadAheadQueue(uint32_t num_threads, uint32_t queue_depth)
+        : _queue_depth(queue_depth),
+        _in_flight(0),
+        _pool(num_threads, queue_depth) {
+}
+
+void ReadAheadQueue::set_thread_group(uint64_t group, int weight) {
+    s_thread_group = group;
+    s_thread_weight = weight;
+}
+
+ReadAheadQueue::~ReadAheadQueue() {
+    _pool.shutdown();
+    _pool.join();
+}
+
+bool ReadAheadQueue::submit(const std::shared_ptr<ReadAheadBuffer>& buffer,
+                            FileHandler* handler, size_t offset, size_t length) {
+    uint64_t group = s_thread_group;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (_in_flight >= _queue_depth) {
+            return false;
+        }
+        auto it = _group_in_flight.find(group);
+        // a group alone still leaves half of the depth to the next one
+        size_t num_groups = _group_in_flight.size() + (it == _group_in_flight.end() ? 1 : 0);
+        uint32_t share = std::max<uint32_t>(1, _queue_depth / std::max<size_t>(2, num_groups));
+        if (it != _group_in_flight.end() && it->second >= share) {
+            return false;
+        }
+        ++_group_in_flight[group];
+        ++_in_flight;
+    }
+
+    buffer->start(handler, offset, length);
+    if (!_pool.offer(group, s_thread_weight,
+                     boost::bind<void>(&ReadAheadQueue::_run, this, group, buffer))) {
+        buffer->cancel();
+        _run(group, nullptr);
+        return false;
+    }
+    return true;
+}
+
+void ReadAheadQueue::_run(uint64_t group, std::shared_ptr<ReadAheadBuffer> buffer) {
+    if (buffer != nullptr) {
+        buffer->run();
+    }
+    std::lock_guard<std::mutex> l(_lock);
+    --_in_flight;
+    auto it = _group_in_flight.find(group);
+    if (--it->second == 0) {
+        _group_in_flight.erase(it);
+    }
+}
+
+StreamReadAhead::StreamReadAhead(ReadAheadQueue* queue, FileHandler* handler, size_t window_size)
+        : _queue(queue),
+        _handler(handler) {
+    _windows[0].reset(new ReadAheadBuffer(window_size));
+    _windows[1].reset(new ReadAheadBuffer(queue != nullptr ? window_size : 0));
+}
+
+StreamReadAhead::~StreamReadAhead() {
+    // workers may still hold the windows, but must not read through the
+    // handler once the stream is gone
+    _windows[0]->cancel();
+    _windows[1]->cancel();
+}
+
+void StreamReadAhead::_schedule(const std::shared_ptr<ReadAheadBuffer>& window,
+                                size_t offset, size_t end) {
+    if (_queue == nullptr || offset >= end) {
+        return;
+    }
+    window->cancel();
+    _queue->submit(window, _handler, offset, std::min(window->capacity(), end - offset));
+}
+
+OLAPStatus StreamReadAhead::read(char* buf, size_t length, size_t offset, size_t end) {
+    while (length > 0) {
+        int idx = _windows[0]->covers(offset) ? 0 : (_windows[1]->covers(offset) ? 1 : -1);
+        if (idx < 0 && _queue == nullptr && length <= _windows[0]->capacity()) {
+            // one pread of a whole window usually brings the next chunk with it
+            const std::shared_ptr<ReadAheadBuffer>& window = _windows[0];
+            window->cancel();
+            window->start(_handler, offset, std::min(window->capacity(), end - offset));
+            OLAPStatus res = window->wait();
+            if (OLAP_SUCCESS != res) {
+                window->cancel();
+                return res;
+            }
+            continue;
+        } else if (idx < 0) {
+            // first read or a seek, read synchronously and start reading ahead
+            // from where this read stops
+            OLAPStatus res = _handler->pread(buf, length, offset);
+            if (OLAP_SUCCESS != res) {
+                return res;
+            }
+            for (auto& window : _windows) {
+                if (!window->is_busy()) {
+                    _schedule(window, offset + length, end);
+                    break;
+                }
+            }
+            return OLAP_SUCCESS;
+        }
+
+        const std::shared_ptr<ReadAheadBuffer>& window = _windows[idx];
+        const std::shared_ptr<ReadAheadBuffer>& next = _windows[1 - idx];
+        if (!next->covers(window->end())) {
+            _schedule(next, window->end(), end);
+        }
+
+        if (OLAP_SUCCESS != window->wait()) {
+            // leave the error to the synchronous read of this range
+            window->cancel();
+            continue;
+        }
+        size_t copy_length = std::min(length, window->end() - offset);
+        memcpy(buf, window->data() + (offset - window->offset()), copy_length);
+        buf += copy_length;
+        offset += copy_length;
+        length -= copy_length;
+    }
+    return OLAP_SUCCESS;
+}
+
+bool StreamReadAhead::prepare_batch_read(size_t offset, size_t length, size_t end,
+                                         BatchReadRequest* request) {
+    if (_queue != nullptr || offset >= end) {
+        return false;
+    }
+    length = std::min(length, end - offset);
+    const std::shared_ptr<ReadAheadBuffer>& window = _windows[0];
+    if (window->covers(offset) && window->end() >= offset + length) {
+        return false;
+    }
+
+    window->cancel();
+    window->start(_handler, offset, std::min(window->capacity(), end - offset));
+    request->file = _handler;
+    request->buf = window->mutable_data();
+    request->size = window->end() - window->offset();
+    request->offset = window->offset();
+    request->status = OLAP_SUCCESS;
+    return true;
+}
+
+void StreamReadAhead::finish_batch_read(OLAPStatus status) {
+    _windows[0]->finish(status);
+}
+
+}  // namespace doris
@@ -0,0 +1,180 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_READ_AHEAD_H
+#define DORIS_BE_SRC_OLAP_READ_AHEAD_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "olap/io_uring.h"
+#include "olap/olap_define.h"
+#include "util/fair_share_thread_pool.h"
+
+namespace doris {
+
+class FileHandler;
+
+// A range of a file read by a ReadAheadQueue worker while the scanner thread
+// decodes the data before it.
+class ReadAheadBuffer {
+public:
+    explicit ReadAheadBuffer(size_t capacity);
+    ~ReadAheadBuffer();
+
+    // Marks the buffer as queued for [offset, offset + length) of 'handler'.
+    // 'length' must not exceed the capacity and the buffer must not be busy.
+    void start(FileHandler* handler, size_t offset, size_t length);
+
+    // Called by the worker. Does nothing if the read was taken over by wait()
+    // or dropped by cancel() in the meantime.
+    void run();
+
+    // Completes a queued read that was done by the owner of the buffer itself,
+    // e.g. in a batch. A failed read leaves the buffer idle.
+    void finish(OLAPStatus status);
+
+    // Waits for the read to finish and returns its status. A read that is still
+    // queued is done on the calling thread instead of waiting for a worker.
+    OLAPStatus wait();
+
+    // Drops the range. Waits if the read is running, so 'handler' can be closed
+    // as soon as this returns.
+    void cancel();
+
+    // Returns true if the buffer holds or is reading the byte at 'offset'
+    bool covers(size_t offset) const {
+        return _state != IDLE && offset >= _offset && offset < _offset + _length;
+    }
+
+    bool is_busy() const {
+        return _state == QUEUED || _state == RUNNING;
+    }
+
+    size_t offset() const { return _offset; }
+    size_t end() const { return _offset + _length; }
+    size_t capacity() const { return _capacity; }
+    const char* data() const { return _data; }
+    char* mutable_data() { return _data; }
+
+private:
+    enum State {
+        IDLE,
+        QUEUED,
+        RUNNING,
+        DONE,
+    };
+
+    void _read();
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::atomic<State> _state;
+
+    FileHandler* _handler;
+    size_t _offset;
+    size_t _length;
+    OLAPStatus _status;
+
+    char* _data;
+    size_t _capacity;
+
+    DISALLOW_COPY_AND_ASSIGN(ReadAheadBuffer);
+};
+
+// Workers reading ahead for the column streams of one store. At most
+// 'queue_depth' reads are queued or running at a time, so one large scan
+// can not flood the disk with requests nobody is waiting for yet.
+//
+// Reads belong to the group of the thread submitting them, the query of a
+// scanner thread. The groups share the workers like the scanners share their
+// pool, and a group may only have its share of the queue depth in flight, at
+// most half of it, so a query reading ahead on all disks leaves room for the
+// others.
+class ReadAheadQueue {
+public:
+    ReadAheadQueue(uint32_t num_threads, uint32_t queue_depth);
+    ~ReadAheadQueue();
+
+    // Schedules a read of [offset, offset + length) into 'buffer'. Returns false
+    // and leaves 'buffer' idle if the queue or the share of the group is full.
+    bool submit(const std::shared_ptr<ReadAheadBuffer>& buffer,
+                FileHandler* handler, size_t offset, size_t length);
+
+    // Sets the group and weight of the reads submitted by this thread, group
+    // 0 for reads of no query, e.g. by compactions.
+    static void set_thread_group(uint64_t group, int weight);
+
+private:
+    void _run(uint64_t group, std::shared_ptr<ReadAheadBuffer> buffer);
+
+    const uint32_t _queue_depth;
+    std::mutex _lock;
+    uint32_t _in_flight;
+    // reads queued or running by group, only groups with some are kept
+    std::unordered_map<uint64_t, uint32_t> _group_in_flight;
+    FairShareThreadPool _pool;
+
+    DISALLOW_COPY_AND_ASSIGN(ReadAheadQueue);
+};
+
+// Reads one stream of a segment through two windows of 'window_size' bytes.
+// When the reader enters a window the next one is submitted, so reading the
+// next chunks overlaps with decompressing and decoding the current ones.
+//
+// Without a queue there is a single window. It is filled by one pread when
+// the reader leaves it, or by a batch the segment reader builds from
+// prepare_batch_read() of all streams of a row block.
+class StreamReadAhead {
+public:
+    StreamReadAhead(ReadAheadQueue* queue, FileHandler* handler, size_t window_size);
+    ~StreamReadAhead();
+
+    // Copies [offset, offset + length) of the file into 'buf'. 'end' is the end
+    // of the stream in the file, no window is read past it.
+    OLAPStatus read(char* buf, size_t length, size_t offset, size_t end);
+
+    // Returns true and fills 'request' to read a window starting at 'offset'
+    // if [offset, offset + length) is not held yet. finish_batch_read() must be
+    // called once the request is done. Always false with a queue.
+    bool prepare_batch_read(size_t offset, size_t length, size_t end,
+                            BatchReadRequest* request);
+    void finish_batch_read(OLAPStatus status);
+
+    // Memory held by the windows
+    size_t buffer_size() const {
+        return _windows[0]->capacity() + _windows[1]->capacity();
+    }
+
+private:
+    void _schedule(const std::shared_ptr<ReadAheadBuffer>& window, size_t offset, size_t end);
+
+    ReadAheadQueue* _queue;
+    FileHandler* _handler;
+    std::shared_ptr<ReadAheadBuffer> _windows[2];
+
+    DISALLOW_COPY_AND_ASSIGN(StreamReadAhead);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_READ_AHEAD_H
@@ -17,16 +17,27 @@
 
 #include "olap/reader.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
 #include "olap/column_data.h"
+#include "olap/loser_tree.h"
 #include "olap/olap_table.h"
+#include "olap/pre_aggregate.h"
 #include "olap/row_block.h"
 #include "olap/row_cursor.h"
+#include "olap/sorted_run_file.h"
+#include "olap/utils.h"
 #include "util/date_func.h"
 #include "util/mem_util.hpp"
+#include "util/time.h"
 #include "runtime/mem_tracker.h"
 #include "runtime/mem_pool.h"
 #include <sstream>
 
+#include "olap/bloom_filter_predicate.h"
 #include "olap/comparison_predicate.h"
 #include "olap/in_list_predicate.h"
 #include "olap/null_predicate.h"
@@ -39,6 +50,7 @@ namespace doris {
 
 class CollectIterator {
 public:
+    CollectIterator() : _tree(ChildLess(this)) { }
     ~CollectIterator();
 
     // Hold reader point to get reader params, 
@@ -47,7 +59,7 @@ public:
 
     OLAPStatus add_child(ColumnData* data, RowBlock* block);
 
-    // Get top row of the heap, NULL if reach end.
+    // Get the smallest row of all children, NULL if reach end.
     const RowCursor* current_row(bool* delete_flag) const {
         if (_cur_child != nullptr) {
             return _cur_child->current_row(delete_flag);
@@ -55,10 +67,30 @@ public:
         return nullptr;
     }
 
-    // Pop the top element and rebuild the heap to 
-    // get the next row cursor.
+    // Advance the child of the smallest row and replay its matches in the
+    // loser tree to get the next row cursor.
     inline OLAPStatus next(const RowCursor** row, bool* delete_flag);
 
+    // Aggregates the rows after the current row that are in the same row block and
+    // have the same key as 'row_cursor' into it, at most 'max_rows' of them.
+    // They all sort before the other children, so the loser tree stays valid.
+    // Returns the number of rows aggregated.
+    size_t aggregate_equal_run(RowCursor* row_cursor, size_t max_rows) {
+        if (_cur_child == nullptr) {
+            return 0;
+        }
+        return _cur_child->aggregate_equal_run(row_cursor, max_rows);
+    }
+
+    // Returns the rest of the block of the current row, without the deleted rows.
+    // Only used when rows need not be merged, the block is taken from its child
+    // when asked for the next one, so it stays valid until then.
+    inline OLAPStatus next_block(RowBlock** block, std::vector<uint32_t>* rows);
+
+    bool need_merge() const {
+        return _merge;
+    }
+
     // Clear the MergeSet element and reset state.
     void clear();
 
@@ -95,6 +127,33 @@ private:
             return _current_row;
         }
 
+        // Aggregates the rows after the current one in the row block that have the
+        // same key as 'dest' into it and makes the last of them the current row.
+        size_t aggregate_equal_run(RowCursor* dest, size_t max_rows) {
+            if (_current_row == nullptr || max_rows == 0
+                    || _row_block->block_status() == DEL_PARTIAL_SATISFIED) {
+                return 0;
+            }
+            size_t pos = _row_block->pos();
+            size_t end = std::min(_row_block->limit(), pos + 1 + max_rows);
+            size_t run_end = pos + 1;
+            for (; run_end < end; ++run_end) {
+                _row_block->get_row(run_end, &_row_cursor);
+                if (!RowCursor::equal(_reader->_key_cids, dest, &_row_cursor)) {
+                    break;
+                }
+            }
+            size_t num_rows = run_end - pos - 1;
+            if (num_rows > 0) {
+                _row_block->get_row(pos + 1, &_row_cursor);
+                RowCursor::aggregate_run(_reader->_value_cids, dest, &_row_cursor,
+                                         _row_block->row_bytes(), num_rows);
+                _row_block->set_pos(run_end - 1);
+            }
+            _row_block->get_row(_row_block->pos(), &_row_cursor);
+            return num_rows;
+        }
+
         int32_t version() const {
             return _data->version().second;
         }
@@ -107,6 +166,34 @@ private:
             return res;
         }
 
+        OLAPStatus next_block(RowBlock** block, std::vector<uint32_t>* rows) {
+            if (_current_row == nullptr) {
+                return OLAP_ERR_DATA_EOF;
+            }
+            if (!_row_block->has_remaining()) {
+                // rows of the last block are all taken
+                RETURN_NOT_OK(_refresh_current_row());
+            }
+            // the current row is checked against delete conditions already
+            rows->clear();
+            rows->push_back(_row_block->pos());
+            bool check_delete = _row_block->block_status() == DEL_PARTIAL_SATISFIED;
+            for (size_t pos = _row_block->pos() + 1; pos < _row_block->limit(); ++pos) {
+                if (check_delete) {
+                    _row_block->get_row(pos, &_row_cursor);
+                    if (_reader->_delete_handler.is_filter_data(_data->version().second,
+                                                                _row_cursor)) {
+                        _reader->_stats.rows_del_filtered++;
+                        continue;
+                    }
+                }
+                rows->push_back(pos);
+            }
+            _row_block->set_pos(_row_block->limit());
+            *block = _row_block;
+            return OLAP_SUCCESS;
+        }
+
     private:
         // refresh _current_row, 
         OLAPStatus _refresh_current_row() {
@@ -144,11 +231,20 @@ private:
         RowBlock* _row_block = nullptr;
     };
 
-    // Compare row cursors between multiple merge elements,
-    // if row cursors equal, compare data version.
-    class ChildCtxComparator {
+    // Returns true if the current row of child a goes before the one of child b.
+    // Row cursors are compared first, if they are equal the data version and then
+    // the index of the children, segment groups of a delta share its version.
+    // A child that reached its end goes after all others.
+    inline bool _less(int a, int b) const;
+
+    class ChildLess {
     public:
-        bool operator()(const ChildCtx* a, const ChildCtx* b);
+        explicit ChildLess(const CollectIterator* iter) : _iter(iter) { }
+        bool operator()(int a, int b) const {
+            return _iter->_less(a, b);
+        }
+    private:
+        const CollectIterator* _iter;
     };
 
     inline OLAPStatus _merge_next(const RowCursor** row, bool* delete_flag);
@@ -157,11 +253,16 @@ private:
     // If _merge is true, result row must be ordered
     bool _merge = true;
 
-    typedef std::priority_queue<ChildCtx*, std::vector<ChildCtx*>, ChildCtxComparator> MergeHeap;
-    MergeHeap _heap;
+    // Loser tree over _children, built on the first next()
+    LoserTree<ChildLess> _tree;
+    bool _tree_built = false;
+    // child all rows of the winner are compared with until one of them is not
+    // smaller, -1 if it is not known
+    int _runner_up = -1;
 
     std::vector<ChildCtx*> _children;
     ChildCtx* _cur_child = nullptr;
+    int _cur_idx = -1;
     // Used when _merge is false
     int _child_idx = 0;
 
@@ -180,8 +281,9 @@ OLAPStatus CollectIterator::init(Reader* reader) {
     _reader = reader;
     // when aggregate is enabled or key_type is DUP_KEYS, we don't merge
     // multiple data to aggregate for performance in user fetch
-    if (_reader->_reader_type == READER_QUERY &&
+    if (_reader->_reader_type == READER_QUERY && !_reader->_sorted_output &&
             (_reader->_aggregation ||
+             _reader->_merge_on_write ||
              _reader->_olap_table->keys_type() == KeysType::DUP_KEYS)) {
         _merge = false;
     }
@@ -198,8 +300,13 @@ OLAPStatus CollectIterator::add_child(ColumnData* data, RowBlock* block) {
     ChildCtx* child_ptr = child.release();
     _children.push_back(child_ptr);
     if (_merge) {
-        _heap.push(child_ptr);
-        _cur_child = _heap.top();
+        // the tree is built on the first next(), the current row must be right before
+        int idx = _children.size() - 1;
+        if (_cur_child == nullptr || _less(idx, _cur_idx)) {
+            _cur_idx = idx;
+            _cur_child = child_ptr;
+        }
+        _tree_built = false;
     } else {
         if (_cur_child == nullptr) {
             _cur_child = _children[_child_idx];
@@ -217,23 +324,62 @@ inline OLAPStatus CollectIterator::next(const RowCursor** row, bool* delete_flag
     }
 }
 
+inline bool CollectIterator::_less(int a, int b) const {
+    const RowCursor* first = _children[a]->current_row();
+    const RowCursor* second = _children[b]->current_row();
+    if (first == nullptr || second == nullptr) {
+        return second == nullptr && first != nullptr;
+    }
+    int cmp_res = first->full_key_cmp(*second);
+    if (cmp_res != 0) {
+        return cmp_res < 0;
+    }
+    // if row cursors equal, compare data version.
+    int32_t first_version = _children[a]->version();
+    int32_t second_version = _children[b]->version();
+    if (first_version != second_version) {
+        return first_version < second_version;
+    }
+    return a < b;
+}
+
 inline OLAPStatus CollectIterator::_merge_next(const RowCursor** row, bool* delete_flag) {
-    _heap.pop();
+    if (!_tree_built) {
+        _tree.build(_children.size());
+        _tree_built = true;
+        _runner_up = -1;
+        // the child add_child picked is the winner of the tree, as _less orders
+        // all children
+        DCHECK_EQ(_cur_idx, _tree.winner());
+        _cur_idx = _tree.winner();
+        _cur_child = _children[_cur_idx];
+    }
+    int winner = _tree.winner();
     auto res = _cur_child->next(row, delete_flag);
-    if (res == OLAP_SUCCESS) {
-        _heap.push(_cur_child);
-        _cur_child = _heap.top();
-    } else if (res == OLAP_ERR_DATA_EOF) {
-        if (_heap.size() > 0) {
-            _cur_child = _heap.top();
-        } else {
-            _cur_child = nullptr;
-            return OLAP_ERR_DATA_EOF;
-        }
-    } else {
+    if (res != OLAP_SUCCESS && res != OLAP_ERR_DATA_EOF) {
         LOG(WARNING) << "failed to get next from child, res=" << res;
         return res;
     }
+    if (res == OLAP_SUCCESS && (_children.size() == 1
+            || (_runner_up >= 0 && _tree.before(winner, _runner_up)))) {
+        // the winner holds a run of rows smaller than all other children,
+        // it keeps winning without replaying its matches
+        return OLAP_SUCCESS;
+    }
+
+    _tree.adjust();
+    if (_tree.winner() == winner && res == OLAP_SUCCESS) {
+        // won twice in a row, the next rows are likely from the same child too
+        _runner_up = _tree.runner_up();
+    } else {
+        _runner_up = -1;
+    }
+    _cur_idx = _tree.winner();
+    _cur_child = _children[_cur_idx];
+    if (_cur_child->current_row() == nullptr) {
+        _cur_child = nullptr;
+        return OLAP_ERR_DATA_EOF;
+    }
     *row = _cur_child->current_row(delete_flag);
     return OLAP_SUCCESS;
 }
@@ -259,28 +405,34 @@ inline OLAPStatus CollectIterator::_normal_next(const RowCursor** row, bool* del
     }
 }
 
-bool CollectIterator::ChildCtxComparator::operator()(const ChildCtx* a, const ChildCtx* b) {
-    // First compare row cursor.
-    const RowCursor* first = a->current_row();
-    const RowCursor* second = b->current_row();
-    int cmp_res = first->full_key_cmp(*second);
-    if (cmp_res != 0) {
-        return cmp_res > 0;
+inline OLAPStatus CollectIterator::next_block(RowBlock** block, std::vector<uint32_t>* rows) {
+    DCHECK(!_merge);
+    while (_cur_child != nullptr) {
+        auto res = _cur_child->next_block(block, rows);
+        if (LIKELY(res == OLAP_SUCCESS)) {
+            return OLAP_SUCCESS;
+        } else if (res != OLAP_ERR_DATA_EOF) {
+            LOG(WARNING) << "failed to get next block from child, res=" << res;
+            return res;
+        }
+        // this child has been read, to read next
+        _child_idx++;
+        _cur_child = _child_idx < _children.size() ? _children[_child_idx] : nullptr;
     }
-    // if row cursors equal, compare data version.
-    return a->version() > b->version();
+    return OLAP_ERR_DATA_EOF;
 }
 
 void CollectIterator::clear() {
-    while (_heap.size() > 0) {
-        _heap.pop();
-    }
+    _tree.clear();
+    _tree_built = false;
+    _runner_up = -1;
     for (auto child : _children) {
         delete child;
     }
     // _children.swap(std::vector<ChildCtx*>());
     _children.clear();
     _cur_child = nullptr;
+    _cur_idx = -1;
     _child_idx = 0;
 }
 
@@ -319,6 +471,17 @@ OLAPStatus Reader::init(const ReaderParams& read_params) {
         i_data->set_stats(&_stats);
     }
 
+    res = _init_metadata_rows(read_params);
+    if (res != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("fail to init reader when init metadata rows.[res=%d]", res);
+        return res;
+    }
+
+    if (_init_pre_aggregates(read_params)) {
+        _next_row_func = &Reader::_pre_aggregate_next_row;
+        return OLAP_SUCCESS;
+    }
+
     bool eof = false;
     if (OLAP_SUCCESS != (res = _attach_data_to_merge_set(true, &eof))) {
         OLAP_LOG_WARNING("failed to attaching data to merge set. [res=%d]", res);
@@ -330,7 +493,11 @@ OLAPStatus Reader::init(const ReaderParams& read_params) {
         _next_row_func = &Reader::_dup_key_next_row;
         break;
     case KeysType::UNIQUE_KEYS:
-        _next_row_func = &Reader::_unique_key_next_row;
+        if (_merge_on_write) {
+            _next_row_func = &Reader::_dup_key_next_row;
+        } else {
+            _next_row_func = &Reader::_unique_key_next_row;
+        }
         break;
     case KeysType::AGG_KEYS:
         _next_row_func = &Reader::_agg_key_next_row;
@@ -340,10 +507,33 @@ OLAPStatus Reader::init(const ReaderParams& read_params) {
     }
     DCHECK(_next_row_func != nullptr) << "No next row function for type:"
         << _olap_table->keys_type();
+    _support_block_read = _next_row_func == &Reader::_dup_key_next_row
+            && !_collect_iter->need_merge();
+
+    if (_metadata_count > 0 || !_metadata_rows.empty()) {
+        _read_next_row_func = _next_row_func;
+        _next_row_func = &Reader::_metadata_next_row;
+        _support_block_read = false;
+    }
 
     return OLAP_SUCCESS;
 }
 
+OLAPStatus Reader::_metadata_next_row(RowCursor* row_cursor, bool* eof) {
+    if (_metadata_count > 0) {
+        --_metadata_count;
+        row_cursor->copy_without_pool(*_metadata_count_row);
+        *eof = false;
+        return OLAP_SUCCESS;
+    }
+    if (_next_metadata_row < _metadata_rows.size()) {
+        row_cursor->copy_without_pool(*_metadata_rows[_next_metadata_row++]);
+        *eof = false;
+        return OLAP_SUCCESS;
+    }
+    return (this->*_read_next_row_func)(row_cursor, eof);
+}
+
 OLAPStatus Reader::_dup_key_next_row(RowCursor* row_cursor, bool* eof) {
     *eof = false;
     if (_next_key == nullptr) {
@@ -366,6 +556,31 @@ OLAPStatus Reader::_dup_key_next_row(RowCursor* row_cursor, bool* eof) {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus Reader::next_block(RowBlock** block, std::vector<uint32_t>* rows, bool* eof) {
+    DCHECK(_support_block_read);
+    *eof = false;
+    while (true) {
+        if (_next_key == nullptr) {
+            auto res = _attach_data_to_merge_set(false, eof);
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("failed to attach data to merge set.");
+                return res;
+            }
+            if (*eof) {
+                return OLAP_SUCCESS;
+            }
+        }
+        auto res = _collect_iter->next_block(block, rows);
+        if (res == OLAP_SUCCESS) {
+            return OLAP_SUCCESS;
+        } else if (res != OLAP_ERR_DATA_EOF) {
+            return res;
+        }
+        // all data of this key range has been read
+        _next_key = nullptr;
+    }
+}
+
 OLAPStatus Reader::_agg_key_next_row(RowCursor* row_cursor, bool* eof) {
     *eof = false;
 
@@ -380,7 +595,7 @@ OLAPStatus Reader::_agg_key_next_row(RowCursor* row_cursor, bool* eof) {
         }
     }
     row_cursor->agg_init(*_next_key);
-    int64_t merged_count = 0;
+    int64_t merged_count = _collect_iter->aggregate_equal_run(row_cursor, _max_run_rows(0));
     do {
         auto res = _collect_iter->next(&_next_key, &_next_delete_flag);
         if (res != OLAP_SUCCESS) {
@@ -400,12 +615,22 @@ OLAPStatus Reader::_agg_key_next_row(RowCursor* row_cursor, bool* eof) {
 
         RowCursor::aggregate(_value_cids, row_cursor, _next_key);
         ++merged_count;
+        merged_count += _collect_iter->aggregate_equal_run(row_cursor,
+                                                           _max_run_rows(merged_count));
     } while (true);
     _merged_rows += merged_count;
     row_cursor->finalize_one_merge(_value_cids);
     return OLAP_SUCCESS;
 }
 
+size_t Reader::_max_run_rows(int64_t merged_count) const {
+    if (!_aggregation) {
+        return std::numeric_limits<size_t>::max();
+    }
+    // the loops stop after merging doris_scanner_row_num rows
+    return std::max<int64_t>(config::doris_scanner_row_num + 1 - merged_count, 0);
+}
+
 OLAPStatus Reader::_unique_key_next_row(RowCursor* row_cursor, bool* eof) {
     *eof = false;
     bool cur_delete_flag = false;
@@ -425,6 +650,9 @@ OLAPStatus Reader::_unique_key_next_row(RowCursor* row_cursor, bool* eof) {
         row_cursor->agg_init(*_next_key);
 
         int64_t merged_count = 0;
+        if (_olap_table->keys_type() != KeysType::DUP_KEYS) {
+            merged_count = _collect_iter->aggregate_equal_run(row_cursor, _max_run_rows(0));
+        }
         while (NULL != _next_key) {
             auto res = _collect_iter->next(&_next_key, &_next_delete_flag);
             if (res != OLAP_SUCCESS) {
@@ -451,6 +679,8 @@ OLAPStatus Reader::_unique_key_next_row(RowCursor* row_cursor, bool* eof) {
             cur_delete_flag = _next_delete_flag;
             RowCursor::aggregate(_value_cids, row_cursor, _next_key);
             ++merged_count;
+            merged_count += _collect_iter->aggregate_equal_run(row_cursor,
+                                                               _max_run_rows(merged_count));
         }
     
         _merged_rows += merged_count;
@@ -465,6 +695,101 @@ OLAPStatus Reader::_unique_key_next_row(RowCursor* row_cursor, bool* eof) {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus Reader::_pre_aggregate_next_row(RowCursor* row_cursor, bool* eof) {
+    *eof = false;
+    while (true) {
+        for (SortedRunReader* reader : _pre_aggregate_current) {
+            RETURN_NOT_OK(reader->next());
+        }
+        _pre_aggregate_current.clear();
+
+        // a prefix is at most once in the pre-aggregates of a data source,
+        // the smallest one is aggregated over the data sources having it
+        for (auto& reader : _pre_aggregate_readers) {
+            if (reader->eof()) {
+                continue;
+            }
+            if (!_pre_aggregate_current.empty()) {
+                int res = pre_aggregate_key_cmp(_pre_aggregate_key_cids, *reader->current(),
+                                                *_pre_aggregate_current[0]->current());
+                if (res > 0) {
+                    continue;
+                } else if (res < 0) {
+                    _pre_aggregate_current.clear();
+                }
+            }
+            _pre_aggregate_current.push_back(reader.get());
+        }
+        if (_pre_aggregate_current.empty()) {
+            *eof = true;
+            return OLAP_SUCCESS;
+        }
+        _stats.raw_rows_read += _pre_aggregate_current.size();
+        _stats.pre_aggregate_rows_read += _pre_aggregate_current.size();
+
+        const RowCursor* row = _pre_aggregate_current[0]->current();
+        int in_range = _pre_aggregate_key_range(*row);
+        if (in_range < 0) {
+            _pre_aggregate_current.clear();
+            *eof = true;
+            return OLAP_SUCCESS;
+        } else if (in_range == 0) {
+            continue;
+        }
+        // the conditions are on prefix keys, which all rows aggregated share
+        bool passed = true;
+        for (auto& it : _conditions.columns()) {
+            if (!it.second->eval(*row)) {
+                passed = false;
+                break;
+            }
+        }
+        if (!passed) {
+            continue;
+        }
+
+        row_cursor->agg_init(*row);
+        for (size_t i = 1; i < _pre_aggregate_current.size(); ++i) {
+            RowCursor::aggregate(_value_cids, row_cursor, _pre_aggregate_current[i]->current());
+        }
+        _merged_rows += _pre_aggregate_current.size() - 1;
+        row_cursor->finalize_one_merge(_value_cids);
+        return OLAP_SUCCESS;
+    }
+}
+
+int Reader::_pre_aggregate_key_range(const RowCursor& row) {
+    if (_keys_param.start_keys.empty()) {
+        return 1;
+    }
+    // rows and key ranges are both in order, ranges the rows have passed are done
+    while (_next_key_index < _keys_param.start_keys.size()) {
+        const RowCursor* start_key = _keys_param.start_keys[_next_key_index];
+        const RowCursor* end_key = nullptr;
+        bool end_included = false;
+        if (_keys_param.range == "eq") {
+            end_key = start_key;
+            end_included = true;
+        } else if (!_keys_param.end_keys.empty()) {
+            end_key = _keys_param.end_keys[_next_key_index];
+            end_included = _keys_param.end_range == "le";
+        }
+        if (end_key != nullptr) {
+            int res = row.cmp(*end_key);
+            if (res > 0 || (res == 0 && !end_included)) {
+                ++_next_key_index;
+                continue;
+            }
+        }
+        int res = row.cmp(*start_key);
+        if (res < 0 || (res == 0 && _keys_param.range == "gt")) {
+            return 0;
+        }
+        return 1;
+    }
+    return -1;
+}
+
 void Reader::close() {
     VLOG(3) << "merged rows:" << _merged_rows;
     _conditions.finalize();
@@ -486,7 +811,21 @@ OLAPStatus Reader::_acquire_data_sources(const ReaderParams& read_params) {
         data_sources = &read_params.olap_data_arr;
     } else {
         _olap_table->obtain_header_rdlock();
+        if (_merge_on_write) {
+            OLAPStatus res = _olap_table->prepare_merge_on_write_read();
+            if (res != OLAP_SUCCESS) {
+                _olap_table->release_header_lock();
+                return res;
+            }
+        }
         _olap_table->acquire_data_sources(_version, &_own_data_sources);
+        if (_merge_on_write) {
+            // bitmaps are taken under the same lock as the data sources
+            for (ColumnData* i_data : _own_data_sources) {
+                i_data->set_delete_bitmap(i_data->segment_group()->delete_bitmap(),
+                                          _version.second);
+            }
+        }
         _olap_table->release_header_lock();
 
         if (_own_data_sources.size() < 1) {
@@ -550,7 +889,12 @@ OLAPStatus Reader::_init_params(const ReaderParams& read_params) {
     _reader_type = read_params.reader_type;
     _olap_table = read_params.olap_table;
     _version = read_params.version;
-    
+    _merge_on_write = _reader_type == READER_QUERY && _olap_table->is_merge_on_write();
+    _sorted_output = read_params.sorted_output;
+    if (_reader_type == READER_QUERY) {
+        _olap_table->set_last_query_time(UnixMillis());
+    }
+
     res = _init_conditions_param(read_params);
     if (res != OLAP_SUCCESS) {
         OLAP_LOG_WARNING("fail to init conditions param. [res=%d]", res);
@@ -624,6 +968,24 @@ OLAPStatus Reader::_init_return_columns(const ReaderParams& read_params) {
             }
         }
         VLOG(3) << "return column is empty, using full column as defaut.";
+    } else if (read_params.reader_type == READER_BASE_COMPACTION
+            || read_params.reader_type == READER_CUMULATIVE_COMPACTION) {
+        // 按列组合并时只读部分列, delete条件用到的列也要读出来做过滤
+        set<uint32_t> column_set(read_params.return_columns.begin(),
+                                 read_params.return_columns.end());
+        for (auto conds : _delete_handler.get_delete_conditions()) {
+            for (auto cond_column : conds.del_cond->columns()) {
+                column_set.insert(cond_column.first);
+            }
+        }
+        _return_columns.assign(column_set.begin(), column_set.end());
+        for (auto id : _return_columns) {
+            if (_olap_table->tablet_schema()[id].is_key) {
+                _key_cids.push_back(id);
+            } else {
+                _value_cids.push_back(id);
+            }
+        }
     } else if (read_params.reader_type == READER_CHECKSUM) {
         _return_columns = read_params.return_columns;
         for (auto id : read_params.return_columns) {
@@ -770,6 +1132,165 @@ OLAPStatus Reader::_attach_data_to_merge_set(bool first, bool *eof) {
     return res;
 }
 
+OLAPStatus Reader::_init_metadata_rows(const ReaderParams& read_params) {
+    // Rows of DUP_KEYS tables are returned as they are stored, other tables merge
+    // rows of versions. Conditions on keys are told by the key statistics of
+    // segment groups, and the key ranges of a query are made of its conditions.
+    if (read_params.push_agg_op == TPushAggOp::NONE || _reader_type != READER_QUERY
+            || _olap_table->keys_type() != KeysType::DUP_KEYS
+            || !read_params.bloom_filters.empty()
+            || (!_keys_param.start_keys.empty() && _conditions.columns().empty())) {
+        return OLAP_SUCCESS;
+    }
+    for (auto& it : _conditions.columns()) {
+        if (static_cast<size_t>(it.first) >= _olap_table->num_key_fields()) {
+            return OLAP_SUCCESS;
+        }
+    }
+    if (read_params.push_agg_op == TPushAggOp::MINMAX) {
+        for (uint32_t cid : _return_columns) {
+            FieldType type = _olap_table->tablet_schema()[cid].type;
+            if (type == OLAP_FIELD_TYPE_CHAR || type == OLAP_FIELD_TYPE_VARCHAR
+                    || type == OLAP_FIELD_TYPE_HLL) {
+                return OLAP_SUCCESS;
+            }
+        }
+    }
+
+    std::vector<ColumnData*> data_sources;
+    for (ColumnData* i_data : _data_sources) {
+        bool answered = false;
+        RETURN_NOT_OK(_add_metadata_rows(i_data, read_params.push_agg_op, &answered));
+        if (!answered) {
+            data_sources.push_back(i_data);
+        }
+    }
+    VLOG(3) << "answer " << _data_sources.size() - data_sources.size() << " of "
+            << _data_sources.size() << " data sources from metadata. table="
+            << _olap_table->full_name();
+    _data_sources.swap(data_sources);
+
+    if (_metadata_count > 0) {
+        // the values of the rows counted are not used
+        _metadata_count_row.reset(new RowCursor());
+        RETURN_NOT_OK(_metadata_count_row->init(_olap_table->tablet_schema(), _return_columns));
+        memset(_metadata_count_row->get_buf(), 0, _metadata_count_row->get_fixed_len());
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus Reader::_add_metadata_rows(ColumnData* data, TPushAggOp::type push_agg_op,
+                                      bool* answered) {
+    *answered = false;
+    // blocks of a data source that delete conditions or the conditions of the
+    // query may filter have to be read
+    if (data->delete_status() != DEL_NOT_SATISFIED) {
+        return OLAP_SUCCESS;
+    }
+    if (!_conditions.columns().empty()) {
+        if (!data->segment_group()->has_column_statistics()) {
+            return OLAP_SUCCESS;
+        }
+        const std::vector<KeyRange>& statistics = data->segment_group()->get_column_statistics();
+        for (auto& it : _conditions.columns()) {
+            if (it.second->del_eval(statistics[it.first]) != DEL_SATISFIED) {
+                return OLAP_SUCCESS;
+            }
+        }
+    }
+
+    if (push_agg_op == TPushAggOp::COUNT) {
+        _metadata_count += data->num_rows();
+        _stats.metadata_rows_answered += data->num_rows();
+        *answered = true;
+        return OLAP_SUCCESS;
+    }
+
+    std::unique_ptr<RowCursor> min_row(new RowCursor());
+    RETURN_NOT_OK(min_row->init(_olap_table->tablet_schema(), _return_columns));
+    std::unique_ptr<RowCursor> max_row(new RowCursor());
+    RETURN_NOT_OK(max_row->init(_olap_table->tablet_schema(), _return_columns));
+    bool known = false;
+    RETURN_NOT_OK(data->get_min_max(min_row.get(), max_row.get(), &known));
+    if (!known) {
+        return OLAP_SUCCESS;
+    }
+    _metadata_rows.push_back(std::move(min_row));
+    _metadata_rows.push_back(std::move(max_row));
+    _stats.metadata_rows_answered += data->num_rows();
+    *answered = true;
+    return OLAP_SUCCESS;
+}
+
+bool Reader::_init_pre_aggregates(const ReaderParams& read_params) {
+    // Pre-aggregates agree with the rows returned only if these are aggregated
+    // anyway, and no delete condition may remove some of the rows aggregated.
+    // Queries of count(*) are not aggregated by the storage, they need all keys.
+    if (!config::enable_pre_aggregate_read || _reader_type != READER_QUERY || !_aggregation
+            || _olap_table->keys_type() != KeysType::AGG_KEYS
+            || _delete_handler.conditions_num() != 0
+            || !read_params.bloom_filters.empty()
+            || _data_sources.empty()) {
+        return false;
+    }
+    std::vector<uint32_t> value_cids;
+    if (!get_pre_aggregate_columns(_olap_table->tablet_schema(),
+                                   _olap_table->pre_aggregate_key_num(),
+                                   &_pre_aggregate_key_cids, &value_cids)) {
+        return false;
+    }
+    // the columns returned, of the conditions and of the key ranges are all kept
+    std::vector<uint32_t> columns(_pre_aggregate_key_cids);
+    columns.insert(columns.end(), value_cids.begin(), value_cids.end());
+    std::unordered_set<uint32_t> column_set(columns.begin(), columns.end());
+    for (uint32_t cid : _seek_columns) {
+        if (column_set.find(cid) == column_set.end()) {
+            return false;
+        }
+    }
+    // conditions on values filter the rows before they are aggregated
+    for (auto& it : _conditions.columns()) {
+        if (static_cast<size_t>(it.first) >= _pre_aggregate_key_cids.size()) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < _keys_param.start_keys.size(); ++i) {
+        if (_keys_param.range != "gt" && _keys_param.range != "ge"
+                && _keys_param.range != "eq") {
+            return false;
+        }
+        if (!_keys_param.end_keys.empty() && _keys_param.end_range != "lt"
+                && _keys_param.end_range != "le") {
+            return false;
+        }
+        if (i > 0 && _keys_param.start_keys[i]->cmp(*_keys_param.start_keys[i - 1]) <= 0) {
+            return false;
+        }
+    }
+
+    size_t buffer_size = config::pre_aggregate_buffer_kbytes * 1024L;
+    for (ColumnData* i_data : _data_sources) {
+        std::string file_name = i_data->segment_group()->construct_pre_aggregate_file_path();
+        if (!check_dir_existed(file_name)) {
+            _pre_aggregate_readers.clear();
+            return false;
+        }
+        std::unique_ptr<SortedRunReader> reader(
+                new SortedRunReader(_olap_table->tablet_schema(), columns, buffer_size));
+        OLAPStatus res = reader->open(file_name);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to open pre-aggregates, read segments instead. res=" << res
+                         << ", file=" << file_name;
+            _pre_aggregate_readers.clear();
+            return false;
+        }
+        _pre_aggregate_readers.push_back(std::move(reader));
+    }
+    VLOG(3) << "read pre-aggregates of " << _pre_aggregate_readers.size()
+            << " data sources. table=" << _olap_table->full_name();
+    return true;
+}
+
 OLAPStatus Reader::_init_keys_param(const ReaderParams& read_params) {
     OLAPStatus res = OLAP_SUCCESS;
 
@@ -842,10 +1363,47 @@ OLAPStatus Reader::_init_conditions_param(const ReaderParams& read_params) {
             _col_predicates.push_back(predicate);
         }
     }
+    for (auto& like_pattern : read_params.like_patterns) {
+        _conditions.append_like_pattern(like_pattern.first, like_pattern.second);
+    }
+    for (auto& bloom_filter : read_params.bloom_filters) {
+        ColumnPredicate* predicate = _new_bloom_filter_pred(bloom_filter.first, bloom_filter.second);
+        if (predicate != NULL) {
+            _col_predicates.push_back(predicate);
+        }
+    }
 
     return res;
 }
 
+ColumnPredicate* Reader::_new_bloom_filter_pred(
+        const std::string& column_name, const std::shared_ptr<const BloomFilter>& bloom_filter) {
+    int index = _olap_table->get_field_index(column_name);
+    if (index < 0) {
+        return nullptr;
+    }
+    const FieldInfo& fi = _olap_table->tablet_schema()[index];
+    if (fi.aggregation != FieldAggregationMethod::OLAP_FIELD_AGGREGATION_NONE) {
+        return nullptr;
+    }
+    switch (fi.type) {
+    case OLAP_FIELD_TYPE_TINYINT:
+        return new BloomFilterPredicate<int8_t>(index, bloom_filter);
+    case OLAP_FIELD_TYPE_SMALLINT:
+        return new BloomFilterPredicate<int16_t>(index, bloom_filter);
+    case OLAP_FIELD_TYPE_INT:
+        return new BloomFilterPredicate<int32_t>(index, bloom_filter);
+    case OLAP_FIELD_TYPE_BIGINT:
+        return new BloomFilterPredicate<int64_t>(index, bloom_filter);
+    case OLAP_FIELD_TYPE_LARGEINT:
+        return new BloomFilterPredicate<int128_t>(index, bloom_filter);
+    case OLAP_FIELD_TYPE_VARCHAR:
+        return new BloomFilterPredicate<StringValue>(index, bloom_filter);
+    default:
+        return nullptr;
+    }
+}
+
 #define COMPARISON_PREDICATE_CONDITION_VALUE(NAME, PREDICATE) \
 ColumnPredicate* Reader::_new_##NAME##_pred(FieldInfo& fi, int index, const std::string& cond) { \
     ColumnPredicate* predicate = NULL; \
@@ -1151,8 +1709,31 @@ OLAPStatus Reader::_init_delete_condition(const ReaderParams& read_params) {
         _olap_table->obtain_header_rdlock();
         OLAPStatus ret = _delete_handler.init(_olap_table, read_params.version.second);
         _olap_table->release_header_lock();
+        if (ret != OLAP_SUCCESS) {
+            return ret;
+        }
 
-        return ret;
+        // partially deleted blocks are then filtered on their vectorized batches
+        _delete_handler.init_column_predicates(
+                _olap_table, [this] (const TCondition& condition) -> ColumnPredicate* {
+            if (condition.condition_values.size() != 1) {
+                return nullptr;
+            }
+            if (condition.condition_op == "!=") {
+                int index = _olap_table->get_field_index(condition.column_name);
+                FieldInfo fi = _olap_table->tablet_schema()[index];
+                return _new_ne_pred(fi, index, condition.condition_values[0]);
+            }
+            // the predicates take "*=" for equality
+            TCondition predicate_condition = condition;
+            if (condition.condition_op == "=") {
+                predicate_condition.condition_op = "*=";
+            } else if (condition.condition_op == "*=" || condition.condition_op == "IS") {
+                return nullptr;
+            }
+            return _parse_to_predicate(predicate_condition);
+        });
+        return OLAP_SUCCESS;
     } else {
         return OLAP_SUCCESS;
     }
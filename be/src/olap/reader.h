@@ -19,6 +19,7 @@
 #define DORIS_BE_SRC_OLAP_READER_H
 
 #include <gen_cpp/PaloInternalService_types.h>
+#include <gen_cpp/PlanNodes_types.h>
 #include <list>
 #include <memory>
 #include <queue>
@@ -39,11 +40,13 @@
 
 namespace doris {
 
+class BloomFilter;
 class OLAPTable;
 class RowCursor;
 class RowBlock;
 class CollectIterator;
 class RuntimeState;
+class SortedRunReader;
 
 // Params for Reader,
 // mainly include tablet, data version and fetch range.
@@ -57,15 +60,27 @@ struct ReaderParams {
     std::vector<OlapTuple> start_key;
     std::vector<OlapTuple> end_key;
     std::vector<TCondition> conditions;
+    // bloom filters of runtime filters by column name, which only filter rows
+    std::vector<std::pair<std::string, std::shared_ptr<const BloomFilter>>> bloom_filters;
+    // LIKE patterns by column name, which only skip rows by ngram indexes
+    std::vector<std::pair<std::string, std::string>> like_patterns;
     // The ColumnData will be set when using Merger, eg Cumulative, BE.
     std::vector<ColumnData*> olap_data_arr;
     std::vector<uint32_t> return_columns;
+    // aggregates of a query with no predicates but the conditions, which data
+    // sources may answer from their metadata
+    TPushAggOp::type push_agg_op;
+    // rows of a query are returned in key order, the data sources are merged
+    // even where the query could do without
+    bool sorted_output;
     RuntimeProfile* profile;
     RuntimeState* runtime_state;
 
     ReaderParams() :
             reader_type(READER_QUERY),
             aggregation(true),
+            push_agg_op(TPushAggOp::NONE),
+            sorted_output(false),
             profile(NULL),
             runtime_state(NULL) {
         start_key.clear();
@@ -115,10 +130,26 @@ public:
         return (this->*_next_row_func)(row_cursor, eof);
     }
 
+    // True if rows are returned as they are read without merging or aggregating
+    // them, e.g. for queries of DUP_KEYS tables. Then next_block can be used in
+    // place of next_row_with_aggregation, but not together with it.
+    bool support_block_read() const {
+        return _support_block_read;
+    }
+
+    // Returns the rows of the next block at once, 'rows' holds the indexes of the
+    // rows in 'block' that are not deleted. The block is valid until next call.
+    OLAPStatus next_block(RowBlock** block, std::vector<uint32_t>* rows, bool* eof);
+
     uint64_t merged_rows() const {
         return _merged_rows;
     }
 
+    // Columns of the rows returned, including the ones only needed by delete conditions
+    const std::vector<uint32_t>& return_columns() const {
+        return _return_columns;
+    }
+
     uint64_t filted_rows() const {
         return _stats.rows_del_filtered;
     }
@@ -179,6 +210,9 @@ private:
 
     ColumnPredicate* _parse_to_predicate(const TCondition& condition);
 
+    ColumnPredicate* _new_bloom_filter_pred(const std::string& column_name,
+                                            const std::shared_ptr<const BloomFilter>& bloom_filter);
+
     OLAPStatus _init_delete_condition(const ReaderParams& read_params);
 
     OLAPStatus _init_return_columns(const ReaderParams& read_params);
@@ -187,10 +221,28 @@ private:
     OLAPStatus _init_load_bf_columns(const ReaderParams& read_params);
 
     OLAPStatus _attach_data_to_merge_set(bool first, bool *eof);
+
+    // Answers the pushed aggregate of the data sources that can from their metadata,
+    // and leaves only the others to be read.
+    OLAPStatus _init_metadata_rows(const ReaderParams& read_params);
+    OLAPStatus _add_metadata_rows(ColumnData* data, TPushAggOp::type push_agg_op,
+                                  bool* answered);
+
+    // Opens the pre-aggregates of all data sources if they can be read in place
+    // of the segments, returns false if the segments are read.
+    bool _init_pre_aggregates(const ReaderParams& read_params);
+    // 1 if the row is in the current key range, 0 if it is before it,
+    // -1 if it is after all of them
+    int _pre_aggregate_key_range(const RowCursor& row);
     
     OLAPStatus _dup_key_next_row(RowCursor* row_cursor, bool* eof);
     OLAPStatus _agg_key_next_row(RowCursor* row_cursor, bool* eof);
     OLAPStatus _unique_key_next_row(RowCursor* row_cursor, bool* eof);
+    OLAPStatus _pre_aggregate_next_row(RowCursor* row_cursor, bool* eof);
+    // returns the rows answered from metadata, then the rows read
+    OLAPStatus _metadata_next_row(RowCursor* row_cursor, bool* eof);
+    // rows the next rows functions may still aggregate as one run
+    size_t _max_run_rows(int64_t merged_count) const;
 
 private:
     std::unique_ptr<MemTracker> _tracker;
@@ -219,6 +271,11 @@ private:
     OLAPStatus (Reader::*_next_row_func)(RowCursor* row_cursor, bool* eof) = nullptr;
 
     bool _aggregation;
+    bool _support_block_read = false;
+    // queries of merge-on-write tables read versions without merging them,
+    // rows replaced by newer versions are skipped by the delete bitmaps
+    bool _merge_on_write = false;
+    bool _sorted_output = false;
     bool _version_locked;
     ReaderType _reader_type;
     bool _next_delete_flag;
@@ -227,6 +284,20 @@ private:
     std::vector<uint32_t> _key_cids;
     std::vector<uint32_t> _value_cids;
 
+    // pre-aggregates of the data sources when they are read instead of them
+    std::vector<std::unique_ptr<SortedRunReader>> _pre_aggregate_readers;
+    std::vector<uint32_t> _pre_aggregate_key_cids;
+    // the readers of the row returned last, which advance on the next call
+    std::vector<SortedRunReader*> _pre_aggregate_current;
+
+    // rows of the data sources answered from their metadata, the count row is
+    // returned _metadata_count times
+    std::unique_ptr<RowCursor> _metadata_count_row;
+    int64_t _metadata_count = 0;
+    std::vector<std::unique_ptr<RowCursor>> _metadata_rows;
+    size_t _next_metadata_row = 0;
+    OLAPStatus (Reader::*_read_next_row_func)(RowCursor* row_cursor, bool* eof) = nullptr;
+
     uint64_t _merged_rows;
 
     OlapReaderStatistics _stats;
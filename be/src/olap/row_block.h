@@ -95,6 +95,9 @@ public:
 
     size_t capacity() const { return _capacity; }
 
+    // bytes between two rows in the block
+    size_t row_bytes() const { return _mem_row_bytes; }
+
     // Return field pointer, this pointer point to the nullbyte before the field
     // layout is nullbyte|Field
     inline char* field_ptr(size_t row, size_t col) const {
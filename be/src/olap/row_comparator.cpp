@@ -0,0 +1,147 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/row_comparator.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace doris {
+
+// the types the first two key columns are compared as inline
+#define APPLY_FOR_INLINE_KEY_TYPES(M) \
+    M(OLAP_FIELD_TYPE_TINYINT) \
+    M(OLAP_FIELD_TYPE_SMALLINT) \
+    M(OLAP_FIELD_TYPE_INT) \
+    M(OLAP_FIELD_TYPE_BIGINT) \
+    M(OLAP_FIELD_TYPE_LARGEINT) \
+    M(OLAP_FIELD_TYPE_DECIMAL) \
+    M(OLAP_FIELD_TYPE_DATE) \
+    M(OLAP_FIELD_TYPE_DATETIME) \
+    M(OLAP_FIELD_TYPE_CHAR) \
+    M(OLAP_FIELD_TYPE_VARCHAR)
+
+const RowComparator* RowComparator::get(const std::vector<Column>& columns) {
+    static std::mutex lock;
+    static std::map<std::vector<std::pair<int, size_t>>,
+                    std::unique_ptr<RowComparator>> comparators;
+    std::vector<std::pair<int, size_t>> layout;
+    for (auto& column : columns) {
+        layout.emplace_back(column.type, column.offset);
+    }
+    std::lock_guard<std::mutex> l(lock);
+    auto& comparator = comparators[layout];
+    if (comparator == nullptr) {
+        comparator.reset(new RowComparator(columns));
+    }
+    return comparator.get();
+}
+
+RowComparator::RowComparator(const std::vector<Column>& columns) {
+    for (auto& column : columns) {
+        _offsets.push_back(column.offset);
+        _type_infos.push_back(get_type_info(column.type));
+    }
+    _compare_func = _resolve(columns);
+}
+
+int RowComparator::_compare_from(size_t begin, const char* left, const char* right) const {
+    for (size_t i = begin; i < _offsets.size(); ++i) {
+        const char* l = left + _offsets[i];
+        const char* r = right + _offsets[i];
+        bool l_null = *reinterpret_cast<const bool*>(l);
+        bool r_null = *reinterpret_cast<const bool*>(r);
+        if (l_null != r_null) {
+            return l_null ? -1 : 1;
+        } else if (l_null) {
+            continue;
+        }
+        int res = _type_infos[i]->cmp(l + 1, r + 1);
+        if (res != 0) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+int RowComparator::_compare_generic(const RowComparator* comparator,
+                                    const char* left, const char* right) {
+    return comparator->_compare_from(0, left, right);
+}
+
+template<FieldType first_type>
+int RowComparator::_compare_one(const RowComparator* comparator,
+                                const char* left, const char* right) {
+    size_t offset = comparator->_offsets[0];
+    int res = _compare_column<first_type>(left + offset, right + offset);
+    if (res != 0) {
+        return res;
+    }
+    return comparator->_compare_from(1, left, right);
+}
+
+template<FieldType first_type, FieldType second_type>
+int RowComparator::_compare_two(const RowComparator* comparator,
+                                const char* left, const char* right) {
+    size_t offset = comparator->_offsets[0];
+    int res = _compare_column<first_type>(left + offset, right + offset);
+    if (res != 0) {
+        return res;
+    }
+    offset = comparator->_offsets[1];
+    res = _compare_column<second_type>(left + offset, right + offset);
+    if (res != 0) {
+        return res;
+    }
+    return comparator->_compare_from(2, left, right);
+}
+
+template<FieldType first_type>
+RowComparator::CompareFunc RowComparator::_resolve_second(const std::vector<Column>& columns) {
+    if (columns.size() < 2) {
+        return &RowComparator::_compare_one<first_type>;
+    }
+    switch (columns[1].type) {
+#define M(type) \
+    case type: \
+        return &RowComparator::_compare_two<first_type, type>;
+    APPLY_FOR_INLINE_KEY_TYPES(M)
+#undef M
+    default:
+        return &RowComparator::_compare_one<first_type>;
+    }
+}
+
+RowComparator::CompareFunc RowComparator::_resolve(const std::vector<Column>& columns) {
+    if (columns.empty()) {
+        return &RowComparator::_compare_generic;
+    }
+    switch (columns[0].type) {
+#define M(type) \
+    case type: \
+        return _resolve_second<type>(columns);
+    APPLY_FOR_INLINE_KEY_TYPES(M)
+#undef M
+    default:
+        return &RowComparator::_compare_generic;
+    }
+}
+
+#undef APPLY_FOR_INLINE_KEY_TYPES
+
+} // namespace doris
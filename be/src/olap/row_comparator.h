@@ -0,0 +1,98 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_ROW_COMPARATOR_H
+#define DORIS_BE_SRC_OLAP_ROW_COMPARATOR_H
+
+#include <vector>
+
+#include "olap/olap_common.h"
+#include "olap/olap_define.h"
+#include "olap/types.h"
+
+namespace doris {
+
+// Compares the key columns of two rows laid out as a RowCursor or a Schema
+// lays them out, every column being a null byte followed by its value.
+//
+// Field::cmp calls through TypeInfo for every column of every row compared,
+// in the memtable skiplist and in the merges of Merger and Reader. The first
+// two key columns are compared here by code generated for their types if
+// they are of the usual key types, the columns after them through TypeInfo.
+class RowComparator {
+public:
+    struct Column {
+        FieldType type;
+        // offset of the null byte of the column in the row
+        size_t offset;
+    };
+
+    // The comparator of rows with the key columns 'columns'. One is made for
+    // every layout of key columns and kept for the lifetime of the process,
+    // so rows with the same layout get the same comparator.
+    static const RowComparator* get(const std::vector<Column>& columns);
+
+    // Returns -1, 0 or 1 as the keys of 'left' are less than, equal to or
+    // greater than the ones of 'right', nulls being the smallest values
+    int compare(const char* left, const char* right) const {
+        return _compare_func(this, left, right);
+    }
+
+private:
+    typedef int (*CompareFunc)(const RowComparator*, const char*, const char*);
+
+    explicit RowComparator(const std::vector<Column>& columns);
+
+    template<FieldType type>
+    static int _compare_column(const char* left, const char* right) {
+        bool l_null = *reinterpret_cast<const bool*>(left);
+        bool r_null = *reinterpret_cast<const bool*>(right);
+        if (l_null != r_null) {
+            return l_null ? -1 : 1;
+        }
+        return l_null ? 0 : FieldTypeTraits<type>::cmp(left + 1, right + 1);
+    }
+
+    // compares the columns from 'begin' on through their TypeInfo
+    int _compare_from(size_t begin, const char* left, const char* right) const;
+
+    static int _compare_generic(const RowComparator* comparator,
+                                const char* left, const char* right);
+
+    template<FieldType first_type>
+    static int _compare_one(const RowComparator* comparator,
+                            const char* left, const char* right);
+
+    template<FieldType first_type, FieldType second_type>
+    static int _compare_two(const RowComparator* comparator,
+                            const char* left, const char* right);
+
+    template<FieldType first_type>
+    static CompareFunc _resolve_second(const std::vector<Column>& columns);
+
+    static CompareFunc _resolve(const std::vector<Column>& columns);
+
+    std::vector<size_t> _offsets;
+    std::vector<TypeInfo*> _type_infos;
+    CompareFunc _compare_func;
+
+    DISALLOW_COPY_AND_ASSIGN(RowComparator);
+};
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_ROW_COMPARATOR_H
@@ -115,6 +115,18 @@ OLAPStatus RowCursor::_init(const std::vector<FieldInfo>& tablet_schema,
         }
     }
 
+    _key_comparator = nullptr;
+    std::vector<RowComparator::Column> key_columns;
+    for (size_t cid = 0; cid < _key_column_num; ++cid) {
+        if (_field_array[cid] == nullptr) {
+            break;
+        }
+        key_columns.push_back({tablet_schema[cid].type, _field_offsets[cid]});
+    }
+    if (key_columns.size() == _key_column_num) {
+        _key_comparator = RowComparator::get(key_columns);
+    }
+
     return OLAP_SUCCESS;
 }
 
@@ -266,6 +278,9 @@ OLAPStatus RowCursor::allocate_memory_for_string_type(
 }
 
 int RowCursor::full_key_cmp(const RowCursor& other) const {
+    if (_key_comparator != nullptr && _key_comparator == other._key_comparator) {
+        return _key_comparator->compare(_fixed_buf, other._fixed_buf);
+    }
     // 只有key column才会参与比较
     int res = 0;
     for (size_t i = 0; i < _key_column_num; ++i) {
@@ -281,6 +296,9 @@ int RowCursor::full_key_cmp(const RowCursor& other) const {
 }
 
 int RowCursor::cmp(const RowCursor& other) const {
+    if (_key_comparator != nullptr && _key_comparator == other._key_comparator) {
+        return _key_comparator->compare(_fixed_buf, other._fixed_buf);
+    }
     int res = 0;
     // 两个cursor有可能field个数不同，只比较共同部分
     size_t common_prefix_count = min(_key_column_num, other._key_column_num);
@@ -24,6 +24,7 @@
 #include "olap/field.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
+#include "olap/row_comparator.h"
 #include "olap/tuple.h"
 
 namespace doris {
@@ -54,6 +55,17 @@ public:
         }
     }
 
+    // lhs += num_rows rows of a row block starting at the row rhs is attached to,
+    // 'stride' is the size of a row in the block
+    static inline void aggregate_run(const std::vector<uint32_t>& cids, RowCursor* lhs,
+                                     const RowCursor* rhs, size_t stride, size_t num_rows) {
+        for (auto cid : cids) {
+            char* dest = lhs->get_field_ptr(cid);
+            const char* src = rhs->get_field_ptr(cid);
+            lhs->_field_array[cid]->aggregate_run(dest, src, stride, num_rows);
+        }
+    }
+
     RowCursor();
     
     // 遍历销毁field指针
@@ -130,6 +142,10 @@ public:
         return _columns.size();
     }
 
+    size_t key_column_num() const {
+        return _key_column_num;
+    }
+
     // 以string格式输出rowcursor内容，仅供log及debug使用
     std::string to_string() const;
     std::string to_string(std::string sep) const;
@@ -186,6 +202,9 @@ private:
     std::vector<size_t> _field_offsets;  // field offset in _fixed_buf
 
     size_t _key_column_num;              // key num in row_cursor
+    // compares the keys with the ones of cursors of the same layout, null if
+    // the cursor does not have all the key columns
+    const RowComparator* _key_comparator = nullptr;
 
     std::vector<uint32_t> _columns;      // column_id in schema
     std::vector<uint32_t> _string_columns;      // column_id in schema
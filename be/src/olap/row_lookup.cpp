@@ -0,0 +1,123 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/row_lookup.h"
+
+#include <algorithm>
+
+#include "olap/reader.h"
+#include "olap/row_cursor.h"
+
+namespace doris {
+
+OLAPStatus RowLookup::lookup(OLAPTablePtr table, int64_t version, const OlapTuple& key,
+                             const std::vector<std::string>& columns, size_t max_rows,
+                             std::vector<OlapTuple>* rows) {
+    rows->clear();
+    if (key.size() != table->num_key_fields()) {
+        LOG(WARNING) << "key of lookup is not a full key. tablet=" << table->full_name()
+            << ", key_size=" << key.size() << ", num_key_fields=" << table->num_key_fields();
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+
+    ReaderParams params;
+    params.olap_table = table;
+    params.reader_type = READER_QUERY;
+    // rows of a key are merged unless the keys are duplicate
+    params.aggregation = table->keys_type() != KeysType::DUP_KEYS;
+    params.version = Version(0, version);
+    params.range = "ge";
+    params.end_range = "le";
+    params.start_key.push_back(key);
+    params.end_key.push_back(key);
+    std::vector<uint32_t> indexes;
+    if (columns.empty()) {
+        for (size_t i = 0; i < table->tablet_schema().size(); ++i) {
+            indexes.push_back(i);
+        }
+    } else {
+        for (auto& column : columns) {
+            int32_t index = table->get_field_index(column);
+            if (index < 0) {
+                LOG(WARNING) << "unknown column of lookup. tablet=" << table->full_name()
+                    << ", column=" << column;
+                return OLAP_ERR_INPUT_PARAMETER_ERROR;
+            }
+            indexes.push_back(index);
+        }
+    }
+    if (params.aggregation) {
+        params.return_columns = indexes;
+    } else {
+        // the reader merges the rows of the versions by all the key columns,
+        // like in OlapScanner
+        for (size_t i = 0; i < table->num_key_fields(); ++i) {
+            params.return_columns.push_back(i);
+        }
+        for (auto index : indexes) {
+            if (!table->tablet_schema()[index].is_key) {
+                params.return_columns.push_back(index);
+            }
+        }
+    }
+    // positions of the wanted columns in the rows read
+    std::vector<size_t> positions;
+    for (auto index : indexes) {
+        positions.push_back(std::find(params.return_columns.begin(), params.return_columns.end(),
+                                      index) - params.return_columns.begin());
+    }
+
+    RowCursor row;
+    OLAPStatus res = row.init(table->tablet_schema(), params.return_columns);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to init row cursor. tablet=" << table->full_name()
+            << ", res=" << res;
+        return res;
+    }
+    row.allocate_memory_for_string_type(table->tablet_schema());
+
+    Reader reader;
+    res = reader.init(params);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to init reader of lookup. tablet=" << table->full_name()
+            << ", version=" << version << ", res=" << res;
+        return res;
+    }
+    while (rows->size() < max_rows) {
+        bool eof = false;
+        res = reader.next_row_with_aggregation(&row, &eof);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to read row of lookup. tablet=" << table->full_name()
+                << ", res=" << res;
+            return res;
+        }
+        if (eof) {
+            break;
+        }
+        OlapTuple values = row.to_tuple();
+        OlapTuple result;
+        result.reserve(positions.size());
+        for (auto pos : positions) {
+            result.add_value(values.get_value(pos), values.is_null(pos));
+        }
+        rows->push_back(std::move(result));
+    }
+    return OLAP_SUCCESS;
+}
+
+}  // namespace doris
@@ -0,0 +1,51 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_ROW_LOOKUP_H
+#define DORIS_BE_SRC_OLAP_ROW_LOOKUP_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "olap/olap_define.h"
+#include "olap/olap_table.h"
+#include "olap/tuple.h"
+
+namespace doris {
+
+// Reads the rows of one full key of a tablet without a query plan, for
+// serving lookups by key. The reader seeks the key in the short key index of
+// every version and merges the rows like a scan of the key range would, but
+// in the calling thread and without scanner threads, row batches or sinks.
+class RowLookup {
+public:
+    // Sets 'rows' to the values of 'columns' of the rows of 'key' in
+    // 'version' of 'table', all columns in schema order if 'columns' is
+    // empty. 'key' must have a value for every key column. 'rows' is empty if
+    // there is no such key, a tablet has several rows for a key only if it
+    // has duplicate keys, at most 'max_rows' of them are returned.
+    static OLAPStatus lookup(OLAPTablePtr table, int64_t version, const OlapTuple& key,
+                             const std::vector<std::string>& columns, size_t max_rows,
+                             std::vector<OlapTuple>* rows);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_ROW_LOOKUP_H
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "olap/aggregate_func.h"
+#include "olap/row_comparator.h"
 #include "olap/types.h"
 #include "runtime/descriptors.h"
 
@@ -29,6 +30,7 @@ namespace doris {
 class ColumnSchema {
 public:
     ColumnSchema(const FieldAggregationMethod& agg, const FieldType& type) {
+        _type = type;
         _type_info = get_type_info(type);
         _aggregate_func = get_aggregate_func(agg, type);
         _finalize_func = get_finalize_func(agg, type);
@@ -67,10 +69,28 @@ public:
         }
     }
 
+    uint32_t hash_code(const char* row, uint32_t seed) const {
+        bool is_null = *reinterpret_cast<const bool*>(row + _col_offset);
+        if (is_null) {
+            return HashUtil::hash(&is_null, sizeof(is_null), seed);
+        }
+        return _type_info->hash_code(const_cast<char*>(row + _col_offset + 1), seed);
+    }
+
     void aggregate(char* left, const char* right, Arena* arena) const {
         _aggregate_func(left + _col_offset, right + _col_offset, arena);
     }
 
+    // like aggregate(), but hll values of both rows are unserialized contexts
+    void merge(char* left, const char* right, Arena* arena) const {
+        if (_type == OLAP_FIELD_TYPE_HLL) {
+            AggregateFuncTraits<OLAP_FIELD_AGGREGATION_HLL_UNION, OLAP_FIELD_TYPE_HLL>::merge(
+                left + _col_offset, right + _col_offset);
+        } else {
+            aggregate(left, right, arena);
+        }
+    }
+
     void finalize(char* data) const {
         // data of Hyperloglog type will call this function.
         _finalize_func(data + _col_offset + 1);
@@ -106,16 +126,25 @@ public:
             }
             _cols.push_back(col_schema);
         }
+        std::vector<RowComparator::Column> key_columns;
+        for (size_t i = 0; i < _num_key_columns; ++i) {
+            key_columns.push_back({field_infos[i].type,
+                                   static_cast<size_t>(_cols[i].get_col_offset())});
+        }
+        _key_comparator = RowComparator::get(key_columns);
     }
 
     int compare(const char* left , const char* right) const {
+        return _key_comparator->compare(left, right);
+    }
+
+    // rows equal by compare() have the same hash
+    uint32_t hash_key(const char* row) const {
+        uint32_t seed = 0;
         for (size_t i = 0; i < _num_key_columns; ++i) {
-            int comp = _cols[i].compare(left, right);
-            if (comp != 0) {
-                return comp;
-            }
+            seed = _cols[i].hash_code(row, seed);
         }
-        return 0;
+        return seed;
     }
 
     void aggregate(const char* left, const char* right, Arena* arena) const {
@@ -124,6 +153,14 @@ public:
         }
     }
 
+    // aggregates right into left while both are in memory, their hll values are
+    // merged without serializing the one of right first
+    void merge(const char* left, const char* right, Arena* arena) const {
+        for (size_t i = _num_key_columns; i < _cols.size(); ++i) {
+            _cols[i].merge(const_cast<char*>(left), right, arena);
+        }
+    }
+
     void finalize(const char* data) const {
         for (int col_id : _hll_col_ids) {
             _cols[col_id].finalize(const_cast<char*>(data));
@@ -159,6 +196,7 @@ public:
 private:
     std::vector<ColumnSchema> _cols;
     size_t _num_key_columns;
+    const RowComparator* _key_comparator;
     std::vector<int> _hll_col_ids;
 };
 
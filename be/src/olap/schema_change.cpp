@@ -31,7 +31,11 @@
 #include "olap/row_block.h"
 #include "olap/row_cursor.h"
 #include "olap/data_writer.h"
+#include "olap/sorted_run_file.h"
+#include "olap/store.h"
 #include "olap/wrapper_field.h"
+#include "util/count_down_latch.hpp"
+#include "util/thread_pool.hpp"
 #include "common/resource_tls.h"
 #include "agent/cgroups_mgr.h"
 
@@ -604,12 +608,7 @@ bool RowBlockMerger::merge(
     return true;
 
 MERGE_ERR:
-    while (_heap.size() > 0) {
-        MergeElement element = _heap.top();
-        _heap.pop();
-        SAFE_DELETE(element.row_cursor);
-    }
-
+    _clear_heap();
     return false;
 }
 
@@ -655,6 +654,155 @@ bool RowBlockMerger::_pop_heap() {
     return true;
 }
 
+bool RowBlockMerger::merge(
+        const vector<RowBlock*>& row_block_arr,
+        SortedRunWriter* writer,
+        uint64_t* merged_rows) {
+    uint64_t tmp_merged_rows = 0;
+    RowCursor row_cursor;
+    if (row_cursor.init(_olap_table->tablet_schema()) != OLAP_SUCCESS
+            || row_cursor.allocate_memory_for_string_type(
+                _olap_table->tablet_schema()) != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("fail to init row cursor.");
+        return false;
+    }
+
+    if (!_make_heap(row_block_arr)) {
+        goto MERGE_ERR;
+    }
+
+    while (_heap.size() > 0) {
+        if (KeysType::DUP_KEYS == _olap_table->keys_type()) {
+            if (writer->append(*(_heap.top().row_cursor)) != OLAP_SUCCESS
+                    || !_pop_heap()) {
+                goto MERGE_ERR;
+            }
+            continue;
+        }
+
+        row_cursor.agg_init(*(_heap.top().row_cursor));
+        if (!_pop_heap()) {
+            goto MERGE_ERR;
+        }
+        while (!_heap.empty() && row_cursor.full_key_cmp(*(_heap.top().row_cursor)) == 0) {
+            row_cursor.aggregate(*(_heap.top().row_cursor));
+            ++tmp_merged_rows;
+            if (!_pop_heap()) {
+                goto MERGE_ERR;
+            }
+        }
+        row_cursor.finalize_one_merge();
+        if (writer->append(row_cursor) != OLAP_SUCCESS) {
+            goto MERGE_ERR;
+        }
+    }
+
+    *merged_rows = tmp_merged_rows;
+    return true;
+
+MERGE_ERR:
+    _clear_heap();
+    return false;
+}
+
+void RowBlockMerger::_clear_heap() {
+    while (_heap.size() > 0) {
+        MergeElement element = _heap.top();
+        _heap.pop();
+        SAFE_DELETE(element.row_cursor);
+    }
+}
+
+SortedRunMerger::SortedRunMerger(OLAPTablePtr olap_table) : _olap_table(olap_table) {}
+
+bool SortedRunMerger::merge(
+        const vector<SortedRunReader*>& runs,
+        ColumnDataWriter* writer,
+        uint64_t* merged_rows) {
+    uint64_t tmp_merged_rows = 0;
+    RowCursor row_cursor;
+    if (row_cursor.init(_olap_table->tablet_schema()) != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("fail to init row cursor.");
+        return false;
+    }
+
+    _make_heap(runs);
+
+    while (_heap.size() > 0) {
+        if (writer->attached_by(&row_cursor) != OLAP_SUCCESS) {
+            OLAP_LOG_WARNING("writer error.");
+            return false;
+        }
+        row_cursor.allocate_memory_for_string_type(_olap_table->tablet_schema(), writer->mem_pool());
+
+        row_cursor.agg_init(*(_heap.top().run->current()));
+
+        if (!_pop_heap()) {
+            return false;
+        }
+
+        if (KeysType::DUP_KEYS == _olap_table->keys_type()) {
+            writer->next(row_cursor);
+            continue;
+        }
+
+        while (!_heap.empty() && row_cursor.full_key_cmp(*(_heap.top().run->current())) == 0) {
+            row_cursor.aggregate(*(_heap.top().run->current()));
+            ++tmp_merged_rows;
+            if (!_pop_heap()) {
+                return false;
+            }
+        }
+        row_cursor.finalize_one_merge();
+        writer->next(row_cursor);
+    }
+    if (writer->finalize() != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("failed to finalizing writer.");
+        return false;
+    }
+
+    *merged_rows = tmp_merged_rows;
+    return true;
+}
+
+bool SortedRunMerger::merge(const vector<SortedRunReader*>& runs, SortedRunWriter* writer) {
+    _make_heap(runs);
+
+    // rows of the same key are aggregated in the last merge
+    while (_heap.size() > 0) {
+        if (writer->append(*(_heap.top().run->current())) != OLAP_SUCCESS) {
+            return false;
+        }
+        if (!_pop_heap()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SortedRunMerger::_make_heap(const vector<SortedRunReader*>& runs) {
+    _heap = std::priority_queue<MergeElement>();
+    for (SortedRunReader* run : runs) {
+        if (!run->eof()) {
+            _heap.push({run});
+        }
+    }
+}
+
+bool SortedRunMerger::_pop_heap() {
+    MergeElement element = _heap.top();
+    _heap.pop();
+
+    if (element.run->next() != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("fail to read sorted run.");
+        return false;
+    }
+    if (!element.run->eof()) {
+        _heap.push(element);
+    }
+    return true;
+}
+
 LinkedSchemaChange::LinkedSchemaChange(
         OLAPTablePtr base_olap_table, OLAPTablePtr new_olap_table,
         const RowBlockChanger& row_block_changer) :
@@ -695,7 +843,21 @@ bool SchemaChangeDirectly::_write_row_block(ColumnDataWriter* writer, RowBlock*
 }
 
 bool LinkedSchemaChange::process(ColumnData* olap_data, SegmentGroup* new_segment_group) {
-    for (size_t i = 0; i < olap_data->segment_group()->num_segments(); ++i) {
+    bool packed = olap_data->segment_group()->packed();
+    if (packed) {
+        string packed_path = new_segment_group->construct_packed_file_path();
+        string base_table_packed_path = olap_data->segment_group()->construct_packed_file_path();
+        if (link(base_table_packed_path.c_str(), packed_path.c_str()) == 0) {
+            VLOG(3) << "success to create hard link. from_path=" << base_table_packed_path
+                    << ", to_path=" << packed_path;
+        } else {
+            LOG(WARNING) << "fail to create hard link. [from_path=" << base_table_packed_path
+                         << " to_path=" << packed_path
+                         << " errno=" << Errno::no() << " errno_str=" << Errno::str() << "]";
+            return false;
+        }
+    }
+    for (size_t i = 0; !packed && i < olap_data->segment_group()->num_segments(); ++i) {
         string index_path = new_segment_group->construct_index_file_path(new_segment_group->segment_group_id(), i);
         string base_table_index_path = olap_data->segment_group()->construct_index_file_path(olap_data->segment_group()->segment_group_id(), i);
         if (link(base_table_index_path.c_str(), index_path.c_str()) == 0) {
@@ -719,9 +881,20 @@ bool LinkedSchemaChange::process(ColumnData* olap_data, SegmentGroup* new_segmen
                          << " errno=" << Errno::no() << " errno_str=" << Errno::str() << "]";
             return false;
         }
+        // the file in the cold storage is shared as the sparse file is
+        ColdFileManager* cold_file_manager = OLAPEngine::get_instance()->cold_file_manager();
+        if (cold_file_manager != nullptr && cold_file_manager->is_cold(base_table_data_path)
+                && link(cold_marker_path(base_table_data_path).c_str(),
+                        cold_marker_path(data_path).c_str()) != 0) {
+            LOG(WARNING) << "fail to create hard link of cold marker. [from_path="
+                         << base_table_data_path << " to_path=" << data_path
+                         << " errno=" << Errno::no() << " errno_str=" << Errno::str() << "]";
+            return false;
+        }
     }
 
     new_segment_group->set_empty(olap_data->empty());
+    new_segment_group->set_packed(packed);
     new_segment_group->set_num_segments(olap_data->segment_group()->num_segments());
     new_segment_group->add_column_statistics_for_linked_schema_change(olap_data->segment_group()->get_column_statistics(),
                                                                       _row_block_changer.get__schema_mapping() );
@@ -911,18 +1084,14 @@ SchemaChangeWithSorting::SchemaChangeWithSorting(OLAPTablePtr olap_table,
         _olap_table(olap_table),
         _row_block_changer(row_block_changer),
         _memory_limitation(memory_limitation),
-        _row_block_allocator(NULL) {
-    // 每次SchemaChange做外排的时候，会写一些临时版本（比如999,1000,1001），为避免Cache冲突，临时
-    // 版本进行2个处理：
-    // 1. 随机值作为VersionHash
-    // 2. 版本号取一个BIG NUMBER加上当前正在进行SchemaChange的版本号
-    _temp_delta_versions.first = (1 << 28);
-    _temp_delta_versions.second = (1 << 28);
-    // TODO(zyh): remove the magic number
+        _row_block_allocator(NULL),
+        _next_run_id(0) {
+    _run_buffer_size = std::max(config::schema_change_sorted_run_buffer_mbytes, 1) * 1024L * 1024L;
 }
 
 SchemaChangeWithSorting::~SchemaChangeWithSorting() {
     VLOG(3) << "~SchemaChangeWithSorting()";
+    _remove_runs();
     SAFE_DELETE(_row_block_allocator);
 }
 
@@ -977,10 +1146,12 @@ bool SchemaChangeWithSorting::process(ColumnData* olap_data, SegmentGroup* new_s
     RowBlock* new_row_block = NULL;
     vector<RowBlock*> row_block_arr;
 
-    // for external sorting
-    vector<SegmentGroup*> olap_segment_groups;
-
-    _temp_delta_versions.first = _temp_delta_versions.second;
+    // 内存放不下的时候, 排好序的行块作为有序的run写到新表的目录下, 最后多路归并到新版本
+    stringstream run_file_prefix;
+    run_file_prefix << _olap_table->tablet_path() << "/schema_change_"
+                    << new_segment_group->version().first << "_"
+                    << new_segment_group->version().second << "_";
+    _run_file_prefix = run_file_prefix.str();
 
     // Reset filted_rows and merged_rows statistic
     reset_merged_rows();
@@ -1004,28 +1175,18 @@ bool SchemaChangeWithSorting::process(ColumnData* olap_data, SegmentGroup* new_s
             }
 
             // enter here while memory limitation is reached.
-            SegmentGroup* segment_group = NULL;
-
-            if (!_internal_sorting(row_block_arr,
-                                   Version(_temp_delta_versions.second,
-                                           _temp_delta_versions.second),
-                                   &segment_group)) {
-                OLAP_LOG_WARNING("failed to sorting internally.");
+            if (!_spill_run(row_block_arr)) {
+                OLAP_LOG_WARNING("failed to spill sorted run.");
                 result = false;
                 goto SORTING_PROCESS_ERR;
             }
 
-            olap_segment_groups.push_back(segment_group);
-
             for (vector<RowBlock*>::iterator it = row_block_arr.begin();
                     it != row_block_arr.end(); ++it) {
                 _row_block_allocator->release(*it);
             }
 
             row_block_arr.clear();
-
-            // increase temp version
-            ++_temp_delta_versions.second;
             continue;
         }
 
@@ -1058,36 +1219,34 @@ bool SchemaChangeWithSorting::process(ColumnData* olap_data, SegmentGroup* new_s
         olap_data->get_next_row_block(&ref_row_block);
     }
 
-    if (!row_block_arr.empty()) {
-        // enter here while memory limitation is reached.
-        SegmentGroup* segment_group = NULL;
-
-        if (!_internal_sorting(row_block_arr,
-                               Version(_temp_delta_versions.second, _temp_delta_versions.second),
-                               &segment_group)) {
+    if (_run_files.empty()) {
+        // all rows are in memory, no need to go through disk
+        if (!_internal_sorting(row_block_arr, new_segment_group)) {
             OLAP_LOG_WARNING("failed to sorting internally.");
             result = false;
             goto SORTING_PROCESS_ERR;
         }
+    } else {
+        if (!row_block_arr.empty()) {
+            if (!_spill_run(row_block_arr)) {
+                OLAP_LOG_WARNING("failed to spill sorted run.");
+                result = false;
+                goto SORTING_PROCESS_ERR;
+            }
 
-        olap_segment_groups.push_back(segment_group);
+            for (vector<RowBlock*>::iterator it = row_block_arr.begin();
+                    it != row_block_arr.end(); ++it) {
+                _row_block_allocator->release(*it);
+            }
 
-        for (vector<RowBlock*>::iterator it = row_block_arr.begin();
-                it != row_block_arr.end(); ++it) {
-            _row_block_allocator->release(*it);
+            row_block_arr.clear();
         }
 
-        row_block_arr.clear();
-
-        // increase temp version
-        ++_temp_delta_versions.second;
-    }
-
-    // TODO(zyh): 如果_temp_delta_versions只有一个，不需要再外排
-    if (!_external_sorting(olap_segment_groups, new_segment_group)) {
-        OLAP_LOG_WARNING("failed to sorting externally.");
-        result = false;
-        goto SORTING_PROCESS_ERR;
+        if (!_external_sorting(new_segment_group)) {
+            OLAP_LOG_WARNING("failed to sorting externally.");
+            result = false;
+            goto SORTING_PROCESS_ERR;
+        }
     }
 
     add_filted_rows(olap_data->get_filted_rows());
@@ -1110,11 +1269,7 @@ bool SchemaChangeWithSorting::process(ColumnData* olap_data, SegmentGroup* new_s
     }
 
 SORTING_PROCESS_ERR:
-    for (vector<SegmentGroup*>::iterator it = olap_segment_groups.begin();
-            it != olap_segment_groups.end(); ++it) {
-        (*it)->delete_all_files();
-        SAFE_DELETE(*it);
-    }
+    _remove_runs();
 
     for (vector<RowBlock*>::iterator it = row_block_arr.begin();
             it != row_block_arr.end(); ++it) {
@@ -1126,25 +1281,14 @@ SORTING_PROCESS_ERR:
 }
 
 bool SchemaChangeWithSorting::_internal_sorting(const vector<RowBlock*>& row_block_arr,
-                                                const Version& temp_delta_versions,
-                                                SegmentGroup** temp_segment_group) {
+                                                SegmentGroup* segment_group) {
     ColumnDataWriter* writer = NULL;
     uint64_t merged_rows = 0;
     RowBlockMerger merger(_olap_table);
 
-    (*temp_segment_group) = new(nothrow) SegmentGroup(_olap_table.get(),
-                                                temp_delta_versions,
-                                                rand(),
-                                                false,
-                                                0, 0);
-    if (NULL == (*temp_segment_group)) {
-        OLAP_LOG_WARNING("failed to malloc SegmentGroup. [size=%ld]", sizeof(SegmentGroup));
-        goto INTERNAL_SORTING_ERR;
-    }
-
     VLOG(3) << "init writer. tablet=" << _olap_table->full_name()
             << ", block_row_size=" << _olap_table->num_rows_per_row_block();
-    writer = ColumnDataWriter::create(_olap_table, *temp_segment_group, false);
+    writer = ColumnDataWriter::create(_olap_table, segment_group, false);
     if (NULL == writer) {
         OLAP_LOG_WARNING("failed to create writer.");
         goto INTERNAL_SORTING_ERR;
@@ -1156,7 +1300,7 @@ bool SchemaChangeWithSorting::_internal_sorting(const vector<RowBlock*>& row_blo
     }
     add_merged_rows(merged_rows);
 
-    if (OLAP_SUCCESS != (*temp_segment_group)->load()) {
+    if (OLAP_SUCCESS != segment_group->load()) {
         OLAP_LOG_WARNING("failed to reload olap index.");
         goto INTERNAL_SORTING_ERR;
     }
@@ -1167,48 +1311,82 @@ bool SchemaChangeWithSorting::_internal_sorting(const vector<RowBlock*>& row_blo
 INTERNAL_SORTING_ERR:
     SAFE_DELETE(writer);
 
-    (*temp_segment_group)->delete_all_files();
-    SAFE_DELETE(*temp_segment_group);
+    segment_group->delete_all_files();
     return false;
 }
 
-bool SchemaChangeWithSorting::_external_sorting(
-        vector<SegmentGroup*>& src_segment_groups,
-        SegmentGroup* dest_segment_group) {
-    Merger merger(_olap_table, dest_segment_group, READER_ALTER_TABLE);
-
+bool SchemaChangeWithSorting::_spill_run(const vector<RowBlock*>& row_block_arr) {
     uint64_t merged_rows = 0;
-    uint64_t filted_rows = 0;
-    vector<ColumnData*> olap_data_arr;
+    RowBlockMerger merger(_olap_table);
+    SortedRunWriter writer(_olap_table->tablet_schema(), _run_buffer_size);
 
-    for (vector<SegmentGroup*>::iterator it = src_segment_groups.begin();
-            it != src_segment_groups.end(); ++it) {
-        ColumnData* olap_data = ColumnData::create(*it);
-        if (NULL == olap_data) {
-            OLAP_LOG_WARNING("fail to create ColumnData.");
-            goto EXTERNAL_SORTING_ERR;
-        }
+    string run_file = _next_run_file();
+    _run_files.push_back(run_file);
+    if (OLAP_SUCCESS != writer.open(run_file)) {
+        OLAP_LOG_WARNING("failed to open sorted run. [file='%s']", run_file.c_str());
+        return false;
+    }
+    if (!merger.merge(row_block_arr, &writer, &merged_rows)
+            || OLAP_SUCCESS != writer.close()) {
+        OLAP_LOG_WARNING("failed to write sorted run. [file='%s']", run_file.c_str());
+        return false;
+    }
+    add_merged_rows(merged_rows);
 
-        olap_data_arr.push_back(olap_data);
+    VLOG(3) << "spill sorted run. tablet=" << _olap_table->full_name()
+            << ", file=" << run_file << ", num_rows=" << writer.num_rows();
+    return true;
+}
 
-        if (OLAP_SUCCESS != olap_data->init()) {
-            OLAP_LOG_WARNING("fail to initial olap data. [version='%d-%d' table='%s']",
-                             (*it)->version().first,
-                             (*it)->version().second,
-                             (*it)->table()->full_name().c_str());
+bool SchemaChangeWithSorting::_external_sorting(SegmentGroup* dest_segment_group) {
+    SortedRunMerger merger(_olap_table);
+    ColumnDataWriter* writer = NULL;
+    uint64_t merged_rows = 0;
+    vector<SortedRunReader*> runs;
+
+    // 每个run读的时候占一个buffer, run多于内存限制下能同时读的个数时, 先分批合并成更长的run
+    size_t max_runs = std::max(_memory_limitation / _run_buffer_size, static_cast<size_t>(2));
+    while (_run_files.size() > max_runs) {
+        vector<string> run_files(_run_files.begin(), _run_files.begin() + max_runs);
+        SortedRunWriter run_writer(_olap_table->tablet_schema(), _run_buffer_size);
+        string run_file = _next_run_file();
+        _run_files.push_back(run_file);
+        if (!_open_runs(run_files, &runs)
+                || OLAP_SUCCESS != run_writer.open(run_file)
+                || !merger.merge(runs, &run_writer)
+                || OLAP_SUCCESS != run_writer.close()) {
+            OLAP_LOG_WARNING("fail to merge sorted runs. [table='%s' file='%s']",
+                             _olap_table->full_name().c_str(), run_file.c_str());
             goto EXTERNAL_SORTING_ERR;
         }
+        for (vector<SortedRunReader*>::iterator it = runs.begin(); it != runs.end(); ++it) {
+            SAFE_DELETE(*it);
+        }
+        runs.clear();
+        for (const string& file : run_files) {
+            remove(file.c_str());
+        }
+        _run_files.erase(_run_files.begin(), _run_files.begin() + max_runs);
+    }
+
+    if (!_open_runs(_run_files, &runs)) {
+        goto EXTERNAL_SORTING_ERR;
+    }
+
+    writer = ColumnDataWriter::create(_olap_table, dest_segment_group, false);
+    if (NULL == writer) {
+        OLAP_LOG_WARNING("failed to create writer.");
+        goto EXTERNAL_SORTING_ERR;
     }
 
-    if (OLAP_SUCCESS != merger.merge(olap_data_arr, &merged_rows, &filted_rows)) {
-        OLAP_LOG_WARNING("fail to merge deltas. [table='%s' version='%d-%d']",
+    if (!merger.merge(runs, writer, &merged_rows)) {
+        OLAP_LOG_WARNING("fail to merge sorted runs. [table='%s' version='%d-%d']",
                          _olap_table->full_name().c_str(),
                          dest_segment_group->version().first,
                          dest_segment_group->version().second);
         goto EXTERNAL_SORTING_ERR;
     }
     add_merged_rows(merged_rows);
-    add_filted_rows(filted_rows);
 
     if (OLAP_SUCCESS != dest_segment_group->load()) {
         OLAP_LOG_WARNING("fail to reload index. [table='%s' version='%d-%d']",
@@ -1218,16 +1396,16 @@ bool SchemaChangeWithSorting::_external_sorting(
         goto EXTERNAL_SORTING_ERR;
     }
 
-    for (vector<ColumnData*>::iterator it = olap_data_arr.begin();
-            it != olap_data_arr.end(); ++it) {
+    SAFE_DELETE(writer);
+    for (vector<SortedRunReader*>::iterator it = runs.begin(); it != runs.end(); ++it) {
         SAFE_DELETE(*it);
     }
 
     return true;
 
 EXTERNAL_SORTING_ERR:
-    for (vector<ColumnData*>::iterator it = olap_data_arr.begin();
-            it != olap_data_arr.end(); ++it) {
+    SAFE_DELETE(writer);
+    for (vector<SortedRunReader*>::iterator it = runs.begin(); it != runs.end(); ++it) {
         SAFE_DELETE(*it);
     }
 
@@ -1235,6 +1413,38 @@ EXTERNAL_SORTING_ERR:
     return false;
 }
 
+bool SchemaChangeWithSorting::_open_runs(const vector<string>& run_files,
+                                         vector<SortedRunReader*>* runs) {
+    for (const string& run_file : run_files) {
+        SortedRunReader* run = new(nothrow) SortedRunReader(
+                _olap_table->tablet_schema(), _run_buffer_size);
+        if (NULL == run) {
+            OLAP_LOG_WARNING("fail to malloc SortedRunReader. [size=%ld]",
+                             sizeof(SortedRunReader));
+            return false;
+        }
+        runs->push_back(run);
+        if (OLAP_SUCCESS != run->open(run_file)) {
+            OLAP_LOG_WARNING("fail to open sorted run. [file='%s']", run_file.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+string SchemaChangeWithSorting::_next_run_file() {
+    stringstream path;
+    path << _run_file_prefix << _next_run_id++ << ".run";
+    return path.str();
+}
+
+void SchemaChangeWithSorting::_remove_runs() {
+    for (const string& run_file : _run_files) {
+        remove(run_file.c_str());
+    }
+    _run_files.clear();
+}
+
 OLAPStatus SchemaChangeHandler::clear_schema_change_single_info(
         TTabletId tablet_id,
         SchemaHash schema_hash,
@@ -1969,6 +2179,117 @@ OLAPStatus SchemaChangeHandler::_save_schema_change_info(
 }
 
 // @static
+OLAPStatus SchemaChangeHandler::_convert_version(SchemaChangeParams* sc_params,
+                                                 SchemaChange* sc_procedure,
+                                                 ColumnData* olap_data,
+                                                 SegmentGroup** result) {
+    VLOG(10) << "begin to convert a history delta. "
+             << "version=" << olap_data->version().first << "-" << olap_data->version().second;
+
+    // we create a new delta with the same version as the ColumnData processing currently.
+    SegmentGroup* new_segment_group = new(nothrow) SegmentGroup(
+                                        sc_params->new_olap_table.get(),
+                                        olap_data->version(),
+                                        olap_data->version_hash(),
+                                        olap_data->delete_flag(),
+                                        olap_data->segment_group()->segment_group_id(), 0);
+
+    if (new_segment_group == NULL) {
+        OLAP_LOG_WARNING("failed to malloc SegmentGroup. [size=%ld]", sizeof(SegmentGroup));
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+
+    olap_data->set_delete_handler(sc_params->delete_handler);
+    int del_ret = olap_data->delete_pruning_filter();
+    if (DEL_SATISFIED == del_ret) {
+        VLOG(3) << "filter delta in schema change:"
+                << olap_data->version().first << "-" << olap_data->version().second;
+        OLAPStatus res = sc_procedure->create_init_version(
+                new_segment_group->table()->tablet_id(),
+                new_segment_group->table()->schema_hash(),
+                new_segment_group->version(),
+                new_segment_group->version_hash(),
+                new_segment_group);
+        sc_procedure->add_filted_rows(olap_data->num_rows());
+        if (res != OLAP_SUCCESS) {
+            OLAP_LOG_WARNING("fail to create init version. [res=%d]", res);
+            SAFE_DELETE(new_segment_group);
+            return OLAP_ERR_INPUT_PARAMETER_ERROR;
+        }
+    } else if (DEL_PARTIAL_SATISFIED == del_ret) {
+        VLOG(3) << "filter delta partially in schema change:"
+                << olap_data->version().first << "-" << olap_data->version().second;
+        olap_data->set_delete_status(DEL_PARTIAL_SATISFIED);
+    } else {
+        VLOG(3) << "not filter delta in schema change:"
+                << olap_data->version().first << "-" << olap_data->version().second;
+        olap_data->set_delete_status(DEL_NOT_SATISFIED);
+    }
+
+    if (DEL_SATISFIED != del_ret && !sc_procedure->process(olap_data, new_segment_group)) {
+        //if del_ret is DEL_SATISFIED, the new delta version has already been created in new_olap_table
+        OLAP_LOG_WARNING("failed to process the version. [version='%d-%d']",
+                         olap_data->version().first, olap_data->version().second);
+        new_segment_group->delete_all_files();
+        SAFE_DELETE(new_segment_group);
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+
+    *result = new_segment_group;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SchemaChangeHandler::_convert_versions(
+        SchemaChangeParams* sc_params,
+        SchemaChange* sc_procedure,
+        const std::function<SchemaChange*()>& create_sc_procedure,
+        vector<SegmentGroup*>* new_segment_groups) {
+    const vector<ColumnData*>& olap_data_arr = sc_params->ref_olap_data_arr;
+    new_segment_groups->assign(olap_data_arr.size(), NULL);
+
+    OlapStore* store = sc_params->new_olap_table->store();
+    ThreadPool* pool = store != NULL ? store->schema_change_pool() : NULL;
+    if (pool == NULL || olap_data_arr.size() < 2) {
+        for (int i = olap_data_arr.size() - 1; i >= 0; --i) {
+            RETURN_NOT_OK(_convert_version(sc_params, sc_procedure, olap_data_arr[i],
+                                           &(*new_segment_groups)[i]));
+        }
+        return OLAP_SUCCESS;
+    }
+
+    // the versions are independent, every one is converted by a procedure
+    // of its own on the pool of the store shared by all alter jobs on it
+    vector<OLAPStatus> results(olap_data_arr.size(), OLAP_SUCCESS);
+    CountDownLatch latch(olap_data_arr.size());
+    for (int i = olap_data_arr.size() - 1; i >= 0; --i) {
+        bool offered = pool->offer([&, i]() {
+            std::unique_ptr<SchemaChange> procedure(create_sc_procedure());
+            if (procedure == nullptr) {
+                results[i] = OLAP_ERR_MALLOC_ERROR;
+            } else {
+                results[i] = _convert_version(sc_params, procedure.get(), olap_data_arr[i],
+                                              &(*new_segment_groups)[i]);
+            }
+            latch.count_down();
+        });
+        if (!offered) {
+            results[i] = OLAP_ERR_OTHER_ERROR;
+            latch.count_down();
+        }
+    }
+    latch.await();
+
+    for (int i = olap_data_arr.size() - 1; i >= 0; --i) {
+        if (results[i] != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to convert version. res=" << results[i]
+                << ", version=" << olap_data_arr[i]->version().first
+                << "-" << olap_data_arr[i]->version().second;
+            return results[i];
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus SchemaChangeHandler::_alter_table(SchemaChangeParams* sc_params) {
     OLAPStatus res = OLAP_SUCCESS;
     LOG(INFO) << "begin to process alter table job. "
@@ -1992,6 +2313,22 @@ OLAPStatus SchemaChangeHandler::_alter_table(SchemaChangeParams* sc_params) {
     bool sc_sorting = false;
     bool sc_directly = false;
     SchemaChange* sc_procedure = NULL;
+    // the converted versions, in the order of ref_olap_data_arr, owned
+    // here until they are registered to the new table
+    vector<SegmentGroup*> new_segment_groups;
+    auto create_sc_procedure = [&]() -> SchemaChange* {
+        if (sc_sorting) {
+            size_t memory_limitation = config::memory_limitation_per_thread_for_schema_change;
+            return new(nothrow) SchemaChangeWithSorting(
+                    sc_params->new_olap_table,
+                    rb_changer,
+                    memory_limitation * 1024 * 1024 * 1024);
+        } else if (sc_directly) {
+            return new(nothrow) SchemaChangeDirectly(sc_params->new_olap_table, rb_changer);
+        }
+        return new(nothrow) LinkedSchemaChange(
+                sc_params->ref_olap_table, sc_params->new_olap_table, rb_changer);
+    };
 
     // a. 解析Alter请求，转换成内部的表示形式
     res = _parse_request(sc_params->ref_olap_table,
@@ -2006,23 +2343,13 @@ OLAPStatus SchemaChangeHandler::_alter_table(SchemaChangeParams* sc_params) {
 
     // b. 生成历史数据转换器
     if (true == sc_sorting) {
-        size_t memory_limitation = config::memory_limitation_per_thread_for_schema_change;
         LOG(INFO) << "doing schema change with sorting.";
-        sc_procedure = new(nothrow) SchemaChangeWithSorting(
-                               sc_params->new_olap_table,
-                               rb_changer,
-                               memory_limitation * 1024 * 1024 * 1024);
     } else if (true == sc_directly) {
         LOG(INFO) << "doing schema change directly.";
-        sc_procedure = new(nothrow) SchemaChangeDirectly(
-                sc_params->new_olap_table, rb_changer);
     } else {
         LOG(INFO) << "doing linked schema change.";
-        sc_procedure = new(nothrow) LinkedSchemaChange(
-                                sc_params->ref_olap_table,
-                                sc_params->new_olap_table,
-                                rb_changer);
     }
+    sc_procedure = create_sc_procedure();
 
     if (NULL == sc_procedure) {
         OLAP_LOG_WARNING("failed to malloc SchemaChange. [size=%ld]",
@@ -2032,74 +2359,33 @@ OLAPStatus SchemaChangeHandler::_alter_table(SchemaChangeParams* sc_params) {
     }
 
     // c. 转换历史数据
+    sc_params->ref_olap_table->set_schema_change_status(
+            ALTER_TABLE_RUNNING,
+            sc_params->new_olap_table->schema_hash(),
+            -1);
+    sc_params->new_olap_table->set_schema_change_status(
+            ALTER_TABLE_RUNNING,
+            sc_params->ref_olap_table->schema_hash(),
+            end_version);
+    res = _convert_versions(sc_params, sc_procedure, create_sc_procedure, &new_segment_groups);
+    if (res != OLAP_SUCCESS) {
+        goto PROCESS_ALTER_EXIT;
+    }
+
+    // the versions are registered one by one from the latest, as they were
+    // when they were converted one by one
     for (vector<ColumnData*>::iterator it = sc_params->ref_olap_data_arr.end() - 1;
             it >= sc_params->ref_olap_data_arr.begin(); --it) {
-        VLOG(10) << "begin to convert a history delta. "
-                 << "version=" << (*it)->version().first << "-" << (*it)->version().second;
+        size_t index = it - sc_params->ref_olap_data_arr.begin();
+        SegmentGroup* new_segment_group = new_segment_groups[index];
+        new_segment_groups.erase(new_segment_groups.begin() + index);
 
         // set status for monitor
-        // 只要有一个new_table为running，ref table就设置为running
-        // NOTE 如果第一个sub_table先fail，这里会继续按正常走
-        sc_params->ref_olap_table->set_schema_change_status(
-                ALTER_TABLE_RUNNING,
-                sc_params->new_olap_table->schema_hash(),
-                -1);
         sc_params->new_olap_table->set_schema_change_status(
                 ALTER_TABLE_RUNNING,
                 sc_params->ref_olap_table->schema_hash(),
                 (*it)->version().second);
 
-        // we create a new delta with the same version as the ColumnData processing currently.
-        SegmentGroup* new_segment_group = new(nothrow) SegmentGroup(
-                                            sc_params->new_olap_table.get(),
-                                            (*it)->version(),
-                                            (*it)->version_hash(),
-                                            (*it)->delete_flag(),
-                                            (*it)->segment_group()->segment_group_id(), 0);
-
-        if (new_segment_group == NULL) {
-            OLAP_LOG_WARNING("failed to malloc SegmentGroup. [size=%ld]", sizeof(SegmentGroup));
-            res = OLAP_ERR_MALLOC_ERROR;
-            goto PROCESS_ALTER_EXIT;
-        }
-
-        (*it)->set_delete_handler(sc_params->delete_handler);
-        int del_ret = (*it)->delete_pruning_filter();
-        if (DEL_SATISFIED == del_ret) {
-            VLOG(3) << "filter delta in schema change:"
-                    << (*it)->version().first << "-" << (*it)->version().second;
-            res = sc_procedure->create_init_version(new_segment_group->table()->tablet_id(),
-                                                    new_segment_group->table()->schema_hash(),
-                                                    new_segment_group->version(),
-                                                    new_segment_group->version_hash(),
-                                                    new_segment_group);
-            sc_procedure->add_filted_rows((*it)->num_rows());
-            if (res != OLAP_SUCCESS) {
-                OLAP_LOG_WARNING("fail to create init version. [res=%d]", res);
-                res = OLAP_ERR_INPUT_PARAMETER_ERROR;
-                OLAP_GOTO(PROCESS_ALTER_EXIT);
-            }
-        } else if (DEL_PARTIAL_SATISFIED == del_ret) {
-            VLOG(3) << "filter delta partially in schema change:"
-                    << (*it)->version().first << "-" << (*it)->version().second;
-            (*it)->set_delete_status(DEL_PARTIAL_SATISFIED);
-        } else {
-            VLOG(3) << "not filter delta in schema change:"
-                    << (*it)->version().first << "-" << (*it)->version().second;
-            (*it)->set_delete_status(DEL_NOT_SATISFIED);
-        }
-
-        if (DEL_SATISFIED != del_ret && !sc_procedure->process(*it, new_segment_group)) {
-            //if del_ret is DEL_SATISFIED, the new delta version has already been created in new_olap_table
-            OLAP_LOG_WARNING("failed to process the version. [version='%d-%d']",
-                             (*it)->version().first, (*it)->version().second);
-            new_segment_group->delete_all_files();
-            SAFE_DELETE(new_segment_group);
-
-            res = OLAP_ERR_INPUT_PARAMETER_ERROR;
-            goto PROCESS_ALTER_EXIT;
-        }
-
         // 将新版本的数据加入header
         // 为了防止死锁的出现，一定要先锁住旧表，再锁住新表
         sc_params->new_olap_table->obtain_push_lock();
@@ -2179,6 +2465,13 @@ OLAPStatus SchemaChangeHandler::_alter_table(SchemaChangeParams* sc_params) {
     // XXX: 此时应该不取消SchemaChange状态，因为新Delta还要转换成新旧Schema的版本
 
 PROCESS_ALTER_EXIT:
+    for (SegmentGroup* new_segment_group : new_segment_groups) {
+        if (new_segment_group != NULL) {
+            new_segment_group->delete_all_files();
+            SAFE_DELETE(new_segment_group);
+        }
+    }
+
     if (res == OLAP_SUCCESS) {
         Version test_version(0, end_version);
         res = sc_params->new_olap_table->test_version(test_version);
@@ -2228,6 +2521,30 @@ PROCESS_ALTER_EXIT:
 
 // @static
 // 分析column的mapping以及filter key的mapping
+// 加宽value列时已有的数据不用重写: 整数流里的值与宽度无关, 按更宽的同符号类型读就行,
+// VARCHAR只是长度上限变大. 索引中的统计信息和bloom filter仍按原类型, 读的时候不用它们过滤
+bool SchemaChangeHandler::_can_read_widened(const FieldInfo& ref_column, const FieldInfo& column) {
+    if (ref_column.is_key || column.is_key) {
+        return false;
+    }
+
+    switch (ref_column.type) {
+    case OLAP_FIELD_TYPE_SMALLINT:
+        return column.type == OLAP_FIELD_TYPE_INT || column.type == OLAP_FIELD_TYPE_BIGINT;
+    case OLAP_FIELD_TYPE_INT:
+        return column.type == OLAP_FIELD_TYPE_BIGINT;
+    case OLAP_FIELD_TYPE_UNSIGNED_SMALLINT:
+        return column.type == OLAP_FIELD_TYPE_UNSIGNED_INT
+                || column.type == OLAP_FIELD_TYPE_UNSIGNED_BIGINT;
+    case OLAP_FIELD_TYPE_UNSIGNED_INT:
+        return column.type == OLAP_FIELD_TYPE_UNSIGNED_BIGINT;
+    case OLAP_FIELD_TYPE_VARCHAR:
+        return column.type == OLAP_FIELD_TYPE_VARCHAR && column.length >= ref_column.length;
+    default:
+        return false;
+    }
+}
+
 OLAPStatus SchemaChangeHandler::_parse_request(OLAPTablePtr ref_olap_table,
                                                OLAPTablePtr new_olap_table,
                                                RowBlockChanger* rb_changer,
@@ -2337,17 +2654,15 @@ OLAPStatus SchemaChangeHandler::_parse_request(OLAPTablePtr ref_olap_table,
         if (column_mapping->ref_column < 0) {
             continue;
         } else {
-            if (new_table_schema[i].type != ref_table_schema[column_mapping->ref_column].type) {
-                *sc_directly = true;
-                return OLAP_SUCCESS;
-            } else if (
-                (new_table_schema[i].type == ref_table_schema[column_mapping->ref_column].type)
-                    && (new_table_schema[i].length 
-                        != ref_table_schema[column_mapping->ref_column].length)) {
+            const FieldInfo& ref_column_schema = ref_table_schema[column_mapping->ref_column];
+            if (new_table_schema[i].is_bf_column != ref_column_schema.is_bf_column
+                    || new_table_schema[i].has_bitmap_index != ref_column_schema.has_bitmap_index
+                    || new_table_schema[i].has_ngram_index != ref_column_schema.has_ngram_index) {
                 *sc_directly = true;
                 return OLAP_SUCCESS;
-
-            } else if (new_table_schema[i].is_bf_column != ref_table_schema[i].is_bf_column) {
+            } else if ((new_table_schema[i].type != ref_column_schema.type
+                        || new_table_schema[i].length != ref_column_schema.length)
+                    && !_can_read_widened(ref_column_schema, new_table_schema[i])) {
                 *sc_directly = true;
                 return OLAP_SUCCESS;
             }
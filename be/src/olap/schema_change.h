@@ -19,7 +19,9 @@
 #define DORIS_BE_SRC_OLAP_SCHEMA_CHANGE_H
 
 #include <deque>
+#include <functional>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "gen_cpp/AgentService_types.h"
@@ -40,6 +42,9 @@ class RowBlock;
 class RowCursor;
 // defined in 'writer.h'
 class ColumnDataWriter;
+// defined in 'sorted_run_file.h'
+class SortedRunReader;
+class SortedRunWriter;
 
 class RowBlockChanger {
 public:
@@ -120,6 +125,12 @@ public:
             ColumnDataWriter* writer,
             uint64_t* merged_rows);
 
+    // merges the sorted row blocks into a sorted run on disk
+    bool merge(
+            const std::vector<RowBlock*>& row_block_arr,
+            SortedRunWriter* writer,
+            uint64_t* merged_rows);
+
 private:
     struct MergeElement {
         bool operator<(const MergeElement& other) const {
@@ -133,6 +144,40 @@ private:
 
     bool _make_heap(const std::vector<RowBlock*>& row_block_arr);
     bool _pop_heap();
+    void _clear_heap();
+
+    OLAPTablePtr _olap_table;
+    std::priority_queue<MergeElement> _heap;
+};
+
+// k-way merge of the sorted runs spilled by SchemaChangeWithSorting
+class SortedRunMerger {
+public:
+    explicit SortedRunMerger(OLAPTablePtr olap_table);
+
+    // rows of the same key are aggregated unless the table is DUP_KEYS
+    bool merge(
+            const std::vector<SortedRunReader*>& runs,
+            ColumnDataWriter* writer,
+            uint64_t* merged_rows);
+
+    // merges the runs into a longer one, when there are more runs than can be
+    // read at a time
+    bool merge(
+            const std::vector<SortedRunReader*>& runs,
+            SortedRunWriter* writer);
+
+private:
+    struct MergeElement {
+        bool operator<(const MergeElement& other) const {
+            return run->current()->full_key_cmp(*(other.run->current())) > 0;
+        }
+
+        SortedRunReader* run;
+    };
+
+    void _make_heap(const std::vector<SortedRunReader*>& runs);
+    bool _pop_heap();
 
     OLAPTablePtr _olap_table;
     std::priority_queue<MergeElement> _heap;
@@ -233,20 +278,31 @@ public:
     virtual bool process(ColumnData* olap_data, SegmentGroup* new_segment_group);
 
 private:
+    // merges the row blocks into the new segment group, if all rows fit in memory
     bool _internal_sorting(
             const std::vector<RowBlock*>& row_block_arr,
-            const Version& temp_delta_versions,
-            SegmentGroup** temp_segment_group);
-
-    bool _external_sorting(
-            std::vector<SegmentGroup*>& src_segment_group_arr,
             SegmentGroup* segment_group);
 
+    // spills the row blocks as a sorted run
+    bool _spill_run(const std::vector<RowBlock*>& row_block_arr);
+
+    // merges the spilled runs into the new segment group
+    bool _external_sorting(SegmentGroup* segment_group);
+
+    bool _open_runs(const std::vector<std::string>& run_files,
+                    std::vector<SortedRunReader*>* runs);
+    std::string _next_run_file();
+    void _remove_runs();
+
     OLAPTablePtr _olap_table;
     const RowBlockChanger& _row_block_changer;
     size_t _memory_limitation;
-    Version _temp_delta_versions;
     RowBlockAllocator* _row_block_allocator;
+    // buffer of each sorted run while it is written or merged
+    size_t _run_buffer_size;
+    std::string _run_file_prefix;
+    uint32_t _next_run_id;
+    std::vector<std::string> _run_files;
 
     DISALLOW_COPY_AND_ASSIGN(SchemaChangeWithSorting);
 };
@@ -336,12 +392,31 @@ private:
 
     static OLAPStatus _alter_table(SchemaChangeParams* sc_params);
 
+    // converts 'olap_data' to a new segment group of the new table
+    static OLAPStatus _convert_version(SchemaChangeParams* sc_params,
+                                       SchemaChange* sc_procedure,
+                                       ColumnData* olap_data,
+                                       SegmentGroup** result);
+
+    // converts all of ref_olap_data_arr, on the schema change pool of the new
+    // table's store if it has one. 'create_sc_procedure' makes the procedure
+    // of every pool thread. The new segment groups are returned in the order
+    // of ref_olap_data_arr, the ones converted are returned on failure too
+    static OLAPStatus _convert_versions(
+            SchemaChangeParams* sc_params,
+            SchemaChange* sc_procedure,
+            const std::function<SchemaChange*()>& create_sc_procedure,
+            std::vector<SegmentGroup*>* new_segment_groups);
+
     static OLAPStatus _parse_request(OLAPTablePtr ref_olap_table,
                                      OLAPTablePtr new_olap_table,
                                      RowBlockChanger* rb_changer,
                                      bool* sc_sorting, 
                                      bool* sc_directly);
 
+    // 已有的数据能否不经转换, 直接按加宽后的类型读
+    static bool _can_read_widened(const FieldInfo& ref_column, const FieldInfo& column);
+
     // 需要新建default_value时的初始化设置
     static OLAPStatus _init_column_mapping(ColumnMapping* column_mapping,
                                            const FieldInfo& column_schema,
@@ -17,13 +17,21 @@
 
 #include "olap/segment_group.h"
 
+#include <sys/stat.h>
+
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <fstream>
 
+#include <boost/filesystem.hpp>
+
+#include "olap/cold_storage.h"
 #include "olap/column_data.h"
+#include "olap/olap_engine.h"
 #include "olap/olap_table.h"
+#include "olap/packed_file.h"
+#include "olap/pre_aggregate.h"
 #include "olap/row_block.h"
 #include "olap/row_cursor.h"
 #include "olap/utils.h"
@@ -80,6 +88,12 @@ SegmentGroup::SegmentGroup(OLAPTable* table, Version version, VersionHash versio
     _file_created = false;
     _new_segment_created = false;
     _empty = false;
+    _packed = false;
+    _index_cache = nullptr;
+    _index_cache_id = 0;
+    _index_handle = nullptr;
+    _index_mem_tracker = nullptr;
+    _index_mem_usage = 0;
 
     const RowFields& tablet_schema = _table->tablet_schema();
     for (size_t i = 0; i < _table->num_short_key_fields(); ++i) {
@@ -114,6 +128,12 @@ SegmentGroup::SegmentGroup(OLAPTable* table, bool delete_flag,
     _file_created = false;
     _new_segment_created = false;
     _empty = false;
+    _packed = false;
+    _index_cache = nullptr;
+    _index_cache_id = 0;
+    _index_handle = nullptr;
+    _index_mem_tracker = nullptr;
+    _index_mem_usage = 0;
 
     const RowFields& tablet_schema = _table->tablet_schema();
     for (size_t i = 0; i < _table->num_short_key_fields(); ++i) {
@@ -129,6 +149,18 @@ SegmentGroup::SegmentGroup(OLAPTable* table, bool delete_flag,
 }
 
 SegmentGroup::~SegmentGroup() {
+    if (_index_cache != nullptr) {
+        if (_index_handle != nullptr) {
+            _index_cache->release(_index_handle);
+            _index_handle = nullptr;
+        }
+        // nobody else uses the key, free the entries now
+        _index_cache->erase(CacheKey(reinterpret_cast<const char*>(&_index_cache_id),
+                                     sizeof(_index_cache_id)));
+    }
+    if (_index_mem_tracker != nullptr) {
+        _index_mem_tracker->release(_index_mem_usage);
+    }
     delete [] _short_key_buf;
     _current_file_handler.close();
 
@@ -155,11 +187,31 @@ string SegmentGroup::construct_data_file_path(int32_t segment_group_id, int32_t
     }
 }
 
+string SegmentGroup::construct_pre_aggregate_file_path() const {
+    return pre_aggregate_file_path(construct_data_file_path(_segment_group_id, 0));
+}
+
+string SegmentGroup::construct_packed_file_path() const {
+    return packed_file_path(construct_data_file_path(_segment_group_id, 0));
+}
+
 void SegmentGroup::publish_version(Version version, VersionHash version_hash) {
     _version = version;
     _version_hash = version_hash;
 }
 
+void SegmentGroup::add_replaced_rows(const DeleteBitmap& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    std::shared_ptr<DeleteBitmap> bitmap(new DeleteBitmap());
+    if (_delete_bitmap != nullptr) {
+        *bitmap = *_delete_bitmap;
+    }
+    bitmap->merge(rows);
+    _delete_bitmap = std::move(bitmap);
+}
+
 void SegmentGroup::acquire() {
     atomic_inc(&_ref_count);
 }
@@ -169,17 +221,33 @@ int64_t SegmentGroup::ref_count() {
 }
 
 void SegmentGroup::release() {
-    atomic_dec(&_ref_count);
+    if (atomic_dec_return(&_ref_count) == 0 && _index_cache != nullptr) {
+        _unpin_index();
+    }
 }
 
 bool SegmentGroup::is_in_use() {
     return _ref_count > 0;
 }
 
+// NULL if there is no cold storage
+static ColdFileManager* cold_file_manager() {
+    OLAPEngine* engine = OLAPEngine::get_instance();
+    return engine != nullptr ? engine->cold_file_manager() : nullptr;
+}
+
 // you can not use SegmentGroup after delete_all_files(), or else unknown behavior occurs.
 void SegmentGroup::delete_all_files() {
     if (!_file_created) { return; }
-    for (uint32_t seg_id = 0; seg_id < _num_segments; ++seg_id) {
+    if (_packed) {
+        string packed_path = construct_packed_file_path();
+        if (remove(packed_path.c_str()) != 0) {
+            char errmsg[64];
+            LOG(WARNING) << "fail to delete packed file. [err='" << strerror_r(errno, errmsg, 64)
+                         << "' path='" << packed_path << "']";
+        }
+    }
+    for (uint32_t seg_id = 0; !_packed && seg_id < _num_segments; ++seg_id) {
         // get full path for one segment
         string index_path = construct_index_file_path(_segment_group_id, seg_id);
         string data_path = construct_data_file_path(_segment_group_id, seg_id);
@@ -194,8 +262,17 @@ void SegmentGroup::delete_all_files() {
             char errmsg[64];
             LOG(WARNING) << "fail to delete data file. [err='" << strerror_r(errno, errmsg, 64)
                          << "' path='" << data_path << "']";
+        } else if (cold_file_manager() != nullptr) {
+            cold_file_manager()->release(data_path);
         }
     }
+
+    string pre_aggregate_path = construct_pre_aggregate_file_path();
+    if (remove(pre_aggregate_path.c_str()) != 0 && errno != ENOENT) {
+        char errmsg[64];
+        LOG(WARNING) << "fail to delete pre-aggregate file. [err='" << strerror_r(errno, errmsg, 64)
+                     << "' path='" << pre_aggregate_path << "']";
+    }
 }
 
 
@@ -289,33 +366,37 @@ OLAPStatus SegmentGroup::load() {
         return res;
     }
 
-    if (_index.init(_short_key_length, _new_short_key_length,
-                    _table->num_short_key_fields(), &_short_key_info_list) != OLAP_SUCCESS) {
-        OLAP_LOG_WARNING("fail to create MemIndex. [num_segment=%d]", _num_segments);
+    if (OLAP_SUCCESS != (res = _load_packed_directory())) {
         return res;
     }
 
-    // for each segment
-    for (uint32_t seg_id = 0; seg_id < _num_segments; ++seg_id) {
-        if (COLUMN_ORIENTED_FILE == _table->data_file_type()) {
-            string seg_path = construct_data_file_path(_segment_group_id, seg_id);
-            if (OLAP_SUCCESS != (res = load_pb(seg_path.c_str(), seg_id))) {
-                LOG(WARNING) << "failed to load pb structures. [seg_path='" << seg_path << "']";
+    if (COLUMN_ORIENTED_FILE == _table->data_file_type()) {
+        for (uint32_t seg_id = 0; seg_id < _num_segments; ++seg_id) {
+            if (OLAP_SUCCESS != (res = load_pb(seg_id))) {
+                LOG(WARNING) << "failed to load pb structures. [seg_path='"
+                             << construct_data_file_path(_segment_group_id, seg_id) << "']";
                 _check_io_error(res);
                 return res;
             }
         }
+    }
 
-        // get full path for one segment
-        string path = construct_index_file_path(_segment_group_id, seg_id);
-        if ((res = _index.load_segment(path.c_str(), &_current_num_rows_per_row_block))
-                != OLAP_SUCCESS) {
-            LOG(WARNING) << "fail to load segment. [path='" << path << "']";
-            _check_io_error(res);
-            return res;
-        }
+    OLAPEngine* engine = OLAPEngine::get_instance();
+    Cache* index_cache = engine != nullptr ? engine->short_key_index_cache() : nullptr;
+    MemTracker* mem_tracker = engine != nullptr ? engine->short_key_index_mem_tracker() : nullptr;
+    res = _load_index(&_index, index_cache == nullptr, &_current_num_rows_per_row_block);
+    if (res != OLAP_SUCCESS) {
+        return res;
     }
 
+    if (index_cache != nullptr) {
+        _index_cache = index_cache;
+        _index_cache_id = index_cache->new_id();
+    } else if (mem_tracker != nullptr) {
+        _index_mem_tracker = mem_tracker;
+        _index_mem_usage = _index.memory_usage();
+        _index_mem_tracker->consume(_index_mem_usage);
+    }
     _delete_flag = _index.delete_flag();
     _index_loaded = true;
     _file_created = true;
@@ -323,21 +404,99 @@ OLAPStatus SegmentGroup::load() {
     return OLAP_SUCCESS;
 }
 
-OLAPStatus SegmentGroup::load_pb(const char* file, uint32_t seg_id) {
+OLAPStatus SegmentGroup::_load_index(MemIndex* index, bool load_entries,
+                                     size_t* num_rows_per_row_block) const {
+    OLAPStatus res = OLAP_ERR_INDEX_LOAD_ERROR;
+    if (index->init(_short_key_length, _new_short_key_length,
+                    _table->num_short_key_fields(), &_short_key_info_list) != OLAP_SUCCESS) {
+        OLAP_LOG_WARNING("fail to create MemIndex. [num_segment=%d]", _num_segments);
+        return res;
+    }
+
+    // for each segment
+    for (uint32_t seg_id = 0; seg_id < _num_segments; ++seg_id) {
+        FileHandler file_handler;
+        res = open_index_file(seg_id, &file_handler);
+        if (res == OLAP_SUCCESS) {
+            res = index->load_segment(&file_handler, num_rows_per_row_block, load_entries);
+        }
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to load segment. [path='"
+                         << construct_index_file_path(_segment_group_id, seg_id) << "']";
+            _check_io_error(res);
+            return res;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SegmentGroup::_get_index(const MemIndex** index) const {
+    if (_index_cache == nullptr) {
+        *index = &_index;
+        return OLAP_SUCCESS;
+    }
+
+    boost::lock_guard<boost::mutex> guard(_index_load_lock);
+    if (_index_handle == nullptr) {
+        CacheKey key(reinterpret_cast<const char*>(&_index_cache_id), sizeof(_index_cache_id));
+        _index_handle = _index_cache->lookup(key);
+    }
+    if (_index_handle == nullptr) {
+        std::unique_ptr<MemIndex> loaded(new(std::nothrow) MemIndex());
+        std::unique_ptr<CachedIndex> cached(new(std::nothrow) CachedIndex());
+        if (loaded == nullptr || cached == nullptr) {
+            return OLAP_ERR_MALLOC_ERROR;
+        }
+        RETURN_NOT_OK(_load_index(loaded.get(), true, nullptr));
+
+        cached->charge = loaded->memory_usage();
+        cached->mem_tracker = OLAPEngine::get_instance()->short_key_index_mem_tracker();
+        cached->mem_tracker->consume(cached->charge);
+        cached->index = loaded.release();
+        CacheKey key(reinterpret_cast<const char*>(&_index_cache_id), sizeof(_index_cache_id));
+        size_t charge = cached->charge;
+        _index_handle = _index_cache->insert(key, cached.release(), charge,
+                                             &_delete_cached_index);
+        VLOG(3) << "load short key index. table=" << _table->full_name()
+                << ", version=" << _version.first << "-" << _version.second
+                << ", segment_group_id=" << _segment_group_id << ", bytes=" << charge;
+    }
+    *index = reinterpret_cast<CachedIndex*>(_index_cache->value(_index_handle))->index;
+    return OLAP_SUCCESS;
+}
+
+void SegmentGroup::_unpin_index() const {
+    boost::lock_guard<boost::mutex> guard(_index_load_lock);
+    // a reader may have acquired the segment group again since
+    if (_index_handle != nullptr && _ref_count == 0) {
+        _index_cache->release(_index_handle);
+        _index_handle = nullptr;
+    }
+}
+
+void SegmentGroup::_delete_cached_index(const CacheKey& key, void* value) {
+    CachedIndex* cached = reinterpret_cast<CachedIndex*>(value);
+    cached->mem_tracker->release(cached->charge);
+    delete cached->index;
+    delete cached;
+}
+
+OLAPStatus SegmentGroup::load_pb(uint32_t seg_id) {
     OLAPStatus res = OLAP_SUCCESS;
 
     FileHeader<ColumnDataHeaderMessage> seg_file_header;
     FileHandler seg_file_handler;
-    res = seg_file_handler.open(file, O_RDONLY);
+    res = _open_data_file_header(seg_id, &seg_file_handler);
     if (OLAP_SUCCESS != res) {
-        OLAP_LOG_WARNING("failed to open segment file. [err=%d, file=%s]", res, file);
+        LOG(WARNING) << "failed to open segment file. [err=" << res << ", segment=" << seg_id << "]";
         return res;
     }
 
     res = seg_file_header.unserialize(&seg_file_handler);
     if (OLAP_SUCCESS != res) {
+        LOG(WARNING) << "fail to unserialize header. [err=" << res
+                     << ", path='" << seg_file_handler.file_name() << "']";
         seg_file_handler.close();
-        OLAP_LOG_WARNING("fail to unserialize header. [err=%d, path='%s']", res, file);
         return res;
     }
 
@@ -355,7 +514,10 @@ OLAPStatus SegmentGroup::validate() {
         return OLAP_SUCCESS;
     }
 
-    OLAPStatus res = OLAP_SUCCESS;
+    OLAPStatus res = _load_packed_directory();
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
     for (uint32_t seg_id = 0; seg_id < _num_segments; ++seg_id) {
         FileHeader<OLAPIndexHeaderMessage, OLAPIndexFixedHeader> index_file_header;
         FileHeader<OLAPDataHeaderMessage> data_file_header;
@@ -365,14 +527,33 @@ OLAPStatus SegmentGroup::validate() {
         string data_path = construct_data_file_path(_segment_group_id, seg_id);
 
         // 检查index文件头
-        if ((res = index_file_header.validate(index_path)) != OLAP_SUCCESS) {
+        if (_packed) {
+            FileHandler file_handler;
+            res = open_index_file(seg_id, &file_handler);
+            if (res == OLAP_SUCCESS) {
+                res = index_file_header.unserialize(&file_handler);
+            }
+        } else {
+            res = index_file_header.validate(index_path);
+        }
+        if (res != OLAP_SUCCESS) {
             LOG(WARNING) << "validate index file error. [file='" << index_path << "']";
             _check_io_error(res);
             return res;
         }
 
         // 检查data文件头
-        if ((res = data_file_header.validate(data_path)) != OLAP_SUCCESS) {
+        if (_packed || (cold_file_manager() != nullptr && cold_file_manager()->is_cold(data_path))) {
+            // the checksum of a file moved to the cold storage was checked before
+            FileHandler file_handler;
+            res = _open_data_file_header(seg_id, &file_handler);
+            if (res == OLAP_SUCCESS) {
+                res = data_file_header.unserialize(&file_handler);
+            }
+        } else {
+            res = data_file_header.validate(data_path);
+        }
+        if (res != OLAP_SUCCESS) {
             LOG(WARNING) << "validate data file error. [file='" << data_path << "']";
             _check_io_error(res);
             return res;
@@ -382,15 +563,149 @@ OLAPStatus SegmentGroup::validate() {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus SegmentGroup::pack(size_t max_bytes) {
+    if (_packed || _empty || _num_segments == 0) {
+        return OLAP_SUCCESS;
+    }
+
+    std::vector<string> names;
+    std::vector<string> paths;
+    size_t bytes = 0;
+    for (int32_t seg_id = 0; seg_id < _num_segments; ++seg_id) {
+        names.push_back(packed_member_name(seg_id, "idx"));
+        paths.push_back(construct_index_file_path(_segment_group_id, seg_id));
+        names.push_back(packed_member_name(seg_id, "dat"));
+        paths.push_back(construct_data_file_path(_segment_group_id, seg_id));
+    }
+    for (const string& path : paths) {
+        // only the header of a file moved to the cold storage is on the store
+        if (cold_file_manager() != nullptr && cold_file_manager()->is_cold(path)) {
+            return OLAP_SUCCESS;
+        }
+        struct stat stat_data;
+        if (stat(path.c_str(), &stat_data) != 0) {
+            char errmsg[64];
+            LOG(WARNING) << "fail to stat segment file. [err=" << strerror_r(errno, errmsg, 64)
+                         << " path='" << path << "']";
+            return OLAP_ERR_IO_ERROR;
+        }
+        bytes += stat_data.st_size;
+    }
+    if (bytes > max_bytes) {
+        return OLAP_SUCCESS;
+    }
+
+    string packed_path = construct_packed_file_path();
+    OLAPStatus res = write_packed_file(names, paths, packed_path);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to pack segment group, keep its files. [path='" << packed_path << "']";
+        remove(packed_path.c_str());
+        _check_io_error(res);
+        return res;
+    }
+    _packed = true;
+    for (const string& path : paths) {
+        if (remove(path.c_str()) != 0) {
+            char errmsg[64];
+            LOG(WARNING) << "fail to delete packed segment file. [err='"
+                         << strerror_r(errno, errmsg, 64) << "' path='" << path << "']";
+        }
+    }
+    // the segment group may be read already
+    RETURN_NOT_OK(_load_packed_directory());
+    VLOG(3) << "pack segment group. path=" << packed_path
+            << ", num_segments=" << _num_segments << ", bytes=" << bytes;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SegmentGroup::_load_packed_directory() {
+    if (!_packed || !_packed_directory.empty()) {
+        return OLAP_SUCCESS;
+    }
+    OLAPStatus res = read_packed_file_directory(construct_packed_file_path(), &_packed_directory);
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to load packed file directory. [path='"
+                     << construct_packed_file_path() << "']";
+        _packed_directory.clear();
+        _check_io_error(res);
+    }
+    return res;
+}
+
+OLAPStatus SegmentGroup::open_index_file(int32_t segment, FileHandler* file_handler) const {
+    return _open_segment_file(segment, "idx", file_handler);
+}
+
+OLAPStatus SegmentGroup::open_data_file(int32_t segment, FileHandler* file_handler) const {
+    return _open_segment_file(segment, "dat", file_handler);
+}
+
+OLAPStatus SegmentGroup::offload_data_files(ColdFileManager* manager, int64_t* released_bytes) {
+    if (_packed || _empty || COLUMN_ORIENTED_FILE != _table->data_file_type()) {
+        return OLAP_SUCCESS;
+    }
+    for (uint32_t seg_id = 0; seg_id < _num_segments; ++seg_id) {
+        auto it = _seg_pb_map.find(seg_id);
+        if (it == _seg_pb_map.end()) {
+            // not loaded, the size of the header is not known
+            return OLAP_SUCCESS;
+        }
+        string data_path = construct_data_file_path(_segment_group_id, seg_id);
+        string key = std::to_string(_table->tablet_id()) + "/"
+                + std::to_string(_table->schema_hash()) + "/"
+                + boost::filesystem::path(data_path).filename().string();
+        OLAPStatus res = manager->offload(data_path, key, it->second.size(), released_bytes);
+        if (res != OLAP_SUCCESS) {
+            LOG(WARNING) << "fail to move data file to cold storage. [path='" << data_path << "']";
+            _check_io_error(res);
+            return res;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SegmentGroup::_open_data_file_header(int32_t segment,
+                                                FileHandler* file_handler) const {
+    if (_packed) {
+        return open_data_file(segment, file_handler);
+    }
+    return file_handler->open_with_cache(
+            construct_data_file_path(_segment_group_id, segment), O_RDONLY);
+}
+
+OLAPStatus SegmentGroup::_open_segment_file(int32_t segment, const string& suffix,
+                                            FileHandler* file_handler) const {
+    if (!_packed && suffix == "dat" && cold_file_manager() != nullptr) {
+        return cold_file_manager()->open(
+                construct_data_file_path(_segment_group_id, segment), file_handler);
+    }
+    if (!_packed) {
+        string path = suffix == "idx" ? construct_index_file_path(_segment_group_id, segment)
+                                      : construct_data_file_path(_segment_group_id, segment);
+        return file_handler->open_with_cache(path, O_RDONLY);
+    }
+    auto it = _packed_directory.find(packed_member_name(segment, suffix));
+    if (it == _packed_directory.end()) {
+        LOG(WARNING) << "segment file not found in packed file. [path='"
+                     << construct_packed_file_path() << "' segment=" << segment
+                     << " suffix=" << suffix << "]";
+        return OLAP_ERR_FILE_NOT_EXIST;
+    }
+    return file_handler->open_range_with_cache(construct_packed_file_path(), O_RDONLY,
+                                               it->second.offset, it->second.length);
+}
+
 OLAPStatus SegmentGroup::find_row_block(const RowCursor& key,
                                  RowCursor* helper_cursor,
                                  bool find_last,
                                  RowBlockPosition* pos) const {
     TABLE_PARAM_VALIDATE();
     POS_PARAM_VALIDATE(pos);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
 
     // 将这部分逻辑从memindex移出来，这样可以复用find。
-    OLAPIndexOffset offset = _index.find(key, helper_cursor, find_last);
+    OLAPIndexOffset offset = index->find(key, helper_cursor, find_last);
     if (offset.offset > 0) {
         offset.offset = offset.offset - 1;
     } else {
@@ -398,13 +713,13 @@ OLAPStatus SegmentGroup::find_row_block(const RowCursor& key,
     }
 
     if (find_last) {
-        OLAPIndexOffset next_offset = _index.next(offset);
-        if (!(next_offset == _index.end())) {
+        OLAPIndexOffset next_offset = index->next(offset);
+        if (!(next_offset == index->end())) {
             offset = next_offset;
         }
     }
 
-    return _index.get_row_block_position(offset, pos);
+    return index->get_row_block_position(offset, pos);
 }
 
 OLAPStatus SegmentGroup::find_short_key(const RowCursor& key,
@@ -413,59 +728,69 @@ OLAPStatus SegmentGroup::find_short_key(const RowCursor& key,
                                  RowBlockPosition* pos) const {
     TABLE_PARAM_VALIDATE();
     POS_PARAM_VALIDATE(pos);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
 
     // 由于find会从前一个segment找起，如果前一个segment中恰好没有该key，
     // 就用前移后移来移动segment的位置.
-    OLAPIndexOffset offset = _index.find(key, helper_cursor, find_last);
+    OLAPIndexOffset offset = index->find(key, helper_cursor, find_last);
     if (offset.offset > 0) {
         offset.offset = offset.offset - 1;
 
-        OLAPIndexOffset next_offset = _index.next(offset);
-        if (!(next_offset == _index.end())) {
+        OLAPIndexOffset next_offset = index->next(offset);
+        if (!(next_offset == index->end())) {
             offset = next_offset;
         }
     }
 
     VLOG(3) << "seg=" << offset.segment << ", offset=" << offset.offset;
-    return _index.get_row_block_position(offset, pos);
+    return index->get_row_block_position(offset, pos);
 }
 
 OLAPStatus SegmentGroup::get_row_block_entry(const RowBlockPosition& pos, EntrySlice* entry) const {
     TABLE_PARAM_VALIDATE();
     SLICE_PARAM_VALIDATE(entry);
-    
-    return _index.get_entry(_index.get_offset(pos), entry);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
+
+    return index->get_entry(index->get_offset(pos), entry);
 }
 
 OLAPStatus SegmentGroup::find_first_row_block(RowBlockPosition* position) const {
     TABLE_PARAM_VALIDATE();
     POS_PARAM_VALIDATE(position);
-    
-    return _index.get_row_block_position(_index.find_first(), position);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
+
+    return index->get_row_block_position(index->find_first(), position);
 }
 
 OLAPStatus SegmentGroup::find_last_row_block(RowBlockPosition* position) const {
     TABLE_PARAM_VALIDATE();
     POS_PARAM_VALIDATE(position);
-    
-    return _index.get_row_block_position(_index.find_last(), position);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
+
+    return index->get_row_block_position(index->find_last(), position);
 }
 
 OLAPStatus SegmentGroup::find_next_row_block(RowBlockPosition* pos, bool* eof) const {
     TABLE_PARAM_VALIDATE();
     POS_PARAM_VALIDATE(pos);
     POS_PARAM_VALIDATE(eof);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
 
-    OLAPIndexOffset current = _index.get_offset(*pos);
+    OLAPIndexOffset current = index->get_offset(*pos);
     *eof = false;
 
-    OLAPIndexOffset next = _index.next(current);
-    if (next == _index.end()) {
+    OLAPIndexOffset next = index->next(current);
+    if (next == index->end()) {
         *eof = true;
         return OLAP_ERR_INDEX_EOF;
     }
 
-    return _index.get_row_block_position(next, pos);
+    return index->get_row_block_position(next, pos);
 }
 
 OLAPStatus SegmentGroup::find_mid_point(const RowBlockPosition& low,
@@ -487,34 +812,49 @@ OLAPStatus SegmentGroup::find_mid_point(const RowBlockPosition& low,
 
 OLAPStatus SegmentGroup::find_prev_point(
         const RowBlockPosition& current, RowBlockPosition* prev) const {
-    OLAPIndexOffset current_offset = _index.get_offset(current);
-    OLAPIndexOffset prev_offset = _index.prev(current_offset);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
+    OLAPIndexOffset current_offset = index->get_offset(current);
+    OLAPIndexOffset prev_offset = index->prev(current_offset);
 
-    return _index.get_row_block_position(prev_offset, prev);
+    return index->get_row_block_position(prev_offset, prev);
 }
 
 OLAPStatus SegmentGroup::advance_row_block(int64_t num_row_blocks, RowBlockPosition* position) const {
     TABLE_PARAM_VALIDATE();
     POS_PARAM_VALIDATE(position);
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
 
-    OLAPIndexOffset off = _index.get_offset(*position);
-    iterator_offset_t absolute_offset = _index.get_absolute_offset(off) + num_row_blocks;
-    if (absolute_offset >= _index.count()) {
+    OLAPIndexOffset off = index->get_offset(*position);
+    iterator_offset_t absolute_offset = index->get_absolute_offset(off) + num_row_blocks;
+    if (absolute_offset >= index->count()) {
         return OLAP_ERR_INDEX_EOF;
     }
 
-    return _index.get_row_block_position(_index.get_relative_offset(absolute_offset), position);
+    return index->get_row_block_position(index->get_relative_offset(absolute_offset), position);
 }
 
 // PRECONDITION position1 < position2
 uint32_t SegmentGroup::compute_distance(const RowBlockPosition& position1,
                                      const RowBlockPosition& position2) const {
-    iterator_offset_t offset1 = _index.get_absolute_offset(_index.get_offset(position1));
-    iterator_offset_t offset2 = _index.get_absolute_offset(_index.get_offset(position2));
+    const MemIndex* index = nullptr;
+    if (_get_index(&index) != OLAP_SUCCESS) {
+        return 0;
+    }
+    iterator_offset_t offset1 = index->get_absolute_offset(index->get_offset(position1));
+    iterator_offset_t offset2 = index->get_absolute_offset(index->get_offset(position2));
 
     return offset2 > offset1 ? offset2 - offset1 : 0;
 }
 
+OLAPStatus SegmentGroup::get_row_block_position(const OLAPIndexOffset& pos,
+                                                RowBlockPosition* rbp) const {
+    const MemIndex* index = nullptr;
+    RETURN_NOT_OK(_get_index(&index));
+    return index->get_row_block_position(pos, rbp);
+}
+
 OLAPStatus SegmentGroup::add_segment() {
     // 打开文件
     ++_num_segments;
@@ -661,7 +1001,7 @@ void SegmentGroup::sync() {
     }
 }
 
-void SegmentGroup::_check_io_error(OLAPStatus res) {
+void SegmentGroup::_check_io_error(OLAPStatus res) const {
     if (is_io_error(res)) {
         _table->set_io_error();
     }
@@ -20,6 +20,7 @@
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -28,18 +29,23 @@
 #include "gen_cpp/olap_file.pb.h"
 #include "gen_cpp/column_data_file.pb.h"
 #include "olap/atomic.h"
+#include "olap/delete_bitmap.h"
 #include "olap/field.h"
 #include "olap/file_helper.h"
+#include "olap/lru_cache.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
 #include "olap/olap_table.h"
 #include "olap/row_cursor.h"
 #include "olap/olap_index.h"
+#include "olap/packed_file.h"
 #include "olap/utils.h"
 #include "olap/column_mapping.h"
 
 namespace doris {
 
+class ColdFileManager;
+
 // Class for segments management
 // For fast key lookup, we maintain a sparse index for every data file. The
 // index is sparse because we only have one pointer per row block. Each
@@ -59,10 +65,13 @@ public:
 
     virtual ~SegmentGroup();
 
-    // Load the index into memory.
+    // Load the index into memory. If short_key_index_cache_capacity is not 0
+    // only the index file headers are read, the entries are loaded by the
+    // first lookup and kept in OLAPEngine::short_key_index_cache() until the
+    // segment group is no longer acquired.
     OLAPStatus load();
     bool index_loaded();
-    OLAPStatus load_pb(const char* file, uint32_t seg_id);
+    OLAPStatus load_pb(uint32_t seg_id);
 
     bool has_column_statistics() {
         return _column_statistics.size() != 0;
@@ -83,9 +92,41 @@ public:
         return _column_statistics;
     }
 
+    // Value distributions of the columns, set by the writer or from a pending or
+    // cloned header, and kept until the segment group is added to the header.
+    bool has_column_distributions() const {
+        return !_column_distributions.empty();
+    }
+
+    void set_column_distributions(std::vector<ColumnDistribution> column_distributions) {
+        _column_distributions = std::move(column_distributions);
+    }
+
+    const std::vector<ColumnDistribution>& get_column_distributions() const {
+        return _column_distributions;
+    }
+
     // 检查index文件和data文件的有效性
     OLAPStatus validate();
 
+    // Whether the index and data files of the segments are in one packed file.
+    bool packed() const { return _packed; }
+    void set_packed(bool packed) { _packed = packed; }
+
+    // Packs the index and data files of the segments, which must be finalized,
+    // into one file and removes them, unless they take more than 'max_bytes'.
+    OLAPStatus pack(size_t max_bytes);
+
+    // Open the index or data file of a segment through the fd cache, as a
+    // member of the packed file if the segment group is packed, from the cold
+    // file cache if the data file was moved to the cold storage.
+    OLAPStatus open_index_file(int32_t segment, FileHandler* file_handler) const;
+    OLAPStatus open_data_file(int32_t segment, FileHandler* file_handler) const;
+
+    // Moves the data files of the segments to the cold storage of 'manager',
+    // see ColdFileManager. Packed segment groups are left on the stores.
+    OLAPStatus offload_data_files(ColdFileManager* manager, int64_t* released_bytes);
+
     // Finds position of the first (or last if find_last is set) row
     // block that may contain the smallest key equal to or greater than
     // 'key'. Returns true on success. If find_last is set, note that
@@ -171,6 +212,15 @@ public:
 
     inline bool delete_flag() const { return _delete_flag; }
 
+    // Rows replaced by newer rows of their keys, only kept for merge-on-write
+    // tables. The bitmap is changed under the header wrlock of the table and
+    // never in place, so readers keep using the one they got under the rdlock.
+    std::shared_ptr<const DeleteBitmap> delete_bitmap() const { return _delete_bitmap; }
+    void set_delete_bitmap(std::shared_ptr<const DeleteBitmap> bitmap) {
+        _delete_bitmap = std::move(bitmap);
+    }
+    void add_replaced_rows(const DeleteBitmap& rows);
+
     inline int32_t segment_group_id() const { return _segment_group_id; }
     inline void set_segment_group_id(int32_t segment_group_id) { _segment_group_id = segment_group_id; }
 
@@ -225,9 +275,7 @@ public:
         return _current_num_rows_per_row_block;
     }
 
-    OLAPStatus get_row_block_position(const OLAPIndexOffset& pos, RowBlockPosition* rbp) const {
-        return _index.get_row_block_position(pos, rbp);
-    }
+    OLAPStatus get_row_block_position(const OLAPIndexOffset& pos, RowBlockPosition* rbp) const;
 
     inline const FileHeader<ColumnDataHeaderMessage>* get_seg_pb(uint32_t seg_id) const {
         return &(_seg_pb_map.at(seg_id));
@@ -239,15 +287,43 @@ public:
 
     std::string construct_index_file_path(int32_t segment_group_id, int32_t segment) const;
     std::string construct_data_file_path(int32_t segment_group_id, int32_t segment) const;
+    // the pre-aggregates of the segment group, which need not exist
+    std::string construct_pre_aggregate_file_path() const;
+    // the file of all the segments of a packed segment group
+    std::string construct_packed_file_path() const;
     void publish_version(Version version, VersionHash version_hash);
 
 private:
-    void _check_io_error(OLAPStatus res);
+    // an index with entries in the short key index cache
+    struct CachedIndex {
+        MemIndex* index;
+        size_t charge;
+        MemTracker* mem_tracker;
+    };
+
+    void _check_io_error(OLAPStatus res) const;
+
+    OLAPStatus _load_packed_directory();
+    OLAPStatus _open_segment_file(int32_t segment, const std::string& suffix,
+                                  FileHandler* file_handler) const;
+    // opens the data file of 'segment' to read its header, which is kept on
+    // the store by the files moved to the cold storage
+    OLAPStatus _open_data_file_header(int32_t segment, FileHandler* file_handler) const;
+
+    OLAPStatus _load_index(MemIndex* index, bool load_entries,
+                           size_t* num_rows_per_row_block) const;
+    // Returns the index with its entries loaded, loads them if they were
+    // evicted. They stay in the cache at least until release() drops the
+    // last reference.
+    OLAPStatus _get_index(const MemIndex** index) const;
+    void _unpin_index() const;
+    static void _delete_cached_index(const CacheKey& key, void* value);
 
     OLAPTable* _table;                 // table definition for this segmentgroup
     Version _version;                  // version of associated data file
     VersionHash _version_hash;         // version hash for this segmentgroup
     bool _delete_flag;
+    std::shared_ptr<const DeleteBitmap> _delete_bitmap;
     int32_t _segment_group_id;         // segmentgroup id of segmentgroup
     PUniqueId _load_id;                // load id for segmentgroup
     int32_t _num_segments;             // number of segments in this segmentgroup
@@ -280,12 +356,25 @@ private:
 
     bool _empty;
 
+    bool _packed;
+    // the members of the packed file, read by validate() or load()
+    PackedFileDirectory _packed_directory;
+
     // Lock held while loading the index.
     mutable boost::mutex _index_load_lock;
 
+    // NULL if the entries are in _index, otherwise _index only has the headers
+    Cache* _index_cache;
+    uint64_t _index_cache_id;
+    mutable Cache::Handle* _index_handle;
+    // memory of the entries loaded into _index
+    MemTracker* _index_mem_tracker;
+    size_t _index_mem_usage;
+
     size_t _current_num_rows_per_row_block;
 
     std::vector<std::pair<WrapperField*, WrapperField*>> _column_statistics;
+    std::vector<ColumnDistribution> _column_distributions;
     std::unordered_map<uint32_t, FileHeader<ColumnDataHeaderMessage> > _seg_pb_map;
 
     DISALLOW_COPY_AND_ASSIGN(SegmentGroup);
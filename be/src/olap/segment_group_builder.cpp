@@ -0,0 +1,169 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/segment_group_builder.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <sstream>
+
+#include "olap/data_writer.h"
+#include "olap/file_helper.h"
+#include "olap/olap_header.h"
+#include "olap/olap_table.h"
+#include "olap/segment_group.h"
+#include "olap/store.h"
+#include "olap/utils.h"
+
+namespace doris {
+
+const std::string SegmentGroupBuilder::META_FILE_SUFFIX = ".meta";
+
+SegmentGroupBuilder::SegmentGroupBuilder(
+        const OLAPHeaderMessage& header, const std::string& root_path,
+        TPartitionId partition_id, TTransactionId transaction_id,
+        int32_t segment_group_id)
+    : _header(header), _root_path(root_path), _partition_id(partition_id),
+      _transaction_id(transaction_id), _segment_group_id(segment_group_id),
+      _segment_group(nullptr), _writer(nullptr), _num_rows(0), _finalized(false) {
+}
+
+SegmentGroupBuilder::~SegmentGroupBuilder() {
+    SAFE_DELETE(_writer);
+    if (_segment_group != nullptr) {
+        if (!_finalized) {
+            _segment_group->delete_all_files();
+        }
+        _segment_group->release();
+        SAFE_DELETE(_segment_group);
+    }
+}
+
+OLAPStatus SegmentGroupBuilder::init() {
+    OLAPHeader* header = new OLAPHeader();
+    header->CopyFrom(_header);
+    OLAPStatus res = header->init();
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to init tablet header. tablet_id=" << _header.tablet_id()
+                     << ", res=" << res;
+        delete header;
+        return res;
+    }
+
+    // the store is only used for the path of the tablet, it is not loaded
+    _store.reset(new OlapStore(_root_path));
+    _table = OLAPTable::create_from_header(header, _store.get());
+    if (_table == nullptr) {
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+
+    _dir_path = _table->construct_pending_data_dir_path();
+    if (!check_dir_existed(_dir_path)) {
+        RETURN_NOT_OK(create_dirs(_dir_path));
+    }
+
+    _segment_group = new SegmentGroup(_table.get(), false, _segment_group_id, 0, true,
+                                      _partition_id, _transaction_id);
+    _segment_group->acquire();
+    _writer = ColumnDataWriter::create(_table, _segment_group, true);
+    if (_writer == nullptr) {
+        LOG(WARNING) << "fail to create writer. table=" << _table->full_name();
+        return OLAP_ERR_MALLOC_ERROR;
+    }
+
+    RETURN_NOT_OK(_cursor.init(_table->tablet_schema()));
+    RETURN_NOT_OK(_last_row.init(_table->tablet_schema()));
+    _tracker.reset(new MemTracker(-1));
+    _last_row_pool.reset(new MemPool(_tracker.get()));
+    return OLAP_SUCCESS;
+}
+
+const std::vector<FieldInfo>& SegmentGroupBuilder::tablet_schema() const {
+    return _table->tablet_schema();
+}
+
+OLAPStatus SegmentGroupBuilder::add_row(const RowCursor& row) {
+    // the index of the segment group is only right for sorted rows
+    if (_num_rows > 0 && row.full_key_cmp(_last_row) < 0) {
+        LOG(WARNING) << "rows are not in key order. table=" << _table->full_name()
+                     << ", row=" << _num_rows;
+        return OLAP_ERR_PUSH_INPUT_DATA_ERROR;
+    }
+
+    RETURN_NOT_OK(_writer->attached_by(&_cursor));
+    _cursor.copy(row, _writer->mem_pool());
+    _writer->next(_cursor);
+
+    _last_row_pool->clear();
+    _last_row.copy(row, _last_row_pool.get());
+    ++_num_rows;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SegmentGroupBuilder::finalize() {
+    OLAPStatus res = _writer->finalize();
+    if (res != OLAP_SUCCESS) {
+        LOG(WARNING) << "fail to finalize writer. table=" << _table->full_name()
+                     << ", res=" << res;
+        return res;
+    }
+
+    PPendingSegmentGroup meta;
+    meta.set_pending_segment_group_id(_segment_group_id);
+    meta.set_num_segments(_segment_group->num_segments());
+    // the id of the load is set when the segment group is ingested
+    meta.mutable_load_id()->set_hi(0);
+    meta.mutable_load_id()->set_lo(0);
+    meta.set_empty(_segment_group->empty());
+    if (_segment_group->has_column_statistics()) {
+        for (auto& column_statistic : _segment_group->get_column_statistics()) {
+            ColumnPruning* column_pruning = meta.add_column_pruning();
+            column_pruning->set_min(column_statistic.first->to_string());
+            column_pruning->set_max(column_statistic.second->to_string());
+            column_pruning->set_null_flag(column_statistic.first->is_null());
+        }
+    }
+
+    std::string meta_buf;
+    if (!meta.SerializeToString(&meta_buf)) {
+        LOG(WARNING) << "fail to serialize segment group meta. table=" << _table->full_name();
+        return OLAP_ERR_SERIALIZE_PROTOBUF_ERROR;
+    }
+    std::stringstream meta_path;
+    meta_path << _dir_path << "/" << _transaction_id << "_" << _segment_group_id
+              << META_FILE_SUFFIX;
+    FileHandler file;
+    RETURN_NOT_OK(file.open_with_mode(meta_path.str(), O_CREAT | O_TRUNC | O_WRONLY,
+                                      S_IRUSR | S_IWUSR));
+    res = file.write(meta_buf.data(), meta_buf.size());
+    file.close();
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
+
+    _finalized = true;
+    LOG(INFO) << "finish to build segment group. table=" << _table->full_name()
+              << ", transaction_id=" << _transaction_id
+              << ", segment_group_id=" << _segment_group_id
+              << ", num_segments=" << _segment_group->num_segments()
+              << ", num_rows=" << _num_rows;
+    return OLAP_SUCCESS;
+}
+
+}  // namespace doris
@@ -0,0 +1,102 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_SEGMENT_GROUP_BUILDER_H
+#define DORIS_BE_SRC_OLAP_SEGMENT_GROUP_BUILDER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gen_cpp/olap_file.pb.h"
+#include "olap/field_info.h"
+#include "olap/olap_common.h"
+#include "olap/olap_define.h"
+#include "olap/row_cursor.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+
+namespace doris {
+
+class ColumnDataWriter;
+class OLAPTable;
+class OlapStore;
+class SegmentGroup;
+
+// Builds the files of one pending segment group of a tablet out of the BE, for
+// jobs which already sort and partition the data by themselves. It writes the
+// same files as a load does, through ColumnDataWriter, and needs only the
+// tablet header, so it works without an OLAPEngine; jobs link the Olap library.
+//
+// The files are written into dir_path() under 'root_path', together with the
+// meta of the segment group in '<transaction_id>_<segment_group_id>.meta'.
+// Once the directory is on the disks of a BE, OLAPEngine::ingest_segment_groups()
+// attaches the segment groups to the transaction of the tablet, they are
+// visible when it is published like after any other load.
+class SegmentGroupBuilder {
+public:
+    // 'header' is the header of the tablet the rows are loaded into, e.g. the
+    // json returned by the meta http action of a BE
+    SegmentGroupBuilder(const OLAPHeaderMessage& header, const std::string& root_path,
+                        TPartitionId partition_id, TTransactionId transaction_id,
+                        int32_t segment_group_id);
+    ~SegmentGroupBuilder();
+
+    OLAPStatus init();
+
+    // columns of the rows passed to add_row()
+    const std::vector<FieldInfo>& tablet_schema() const;
+
+    // Rows must come in key order, one out of order fails the build. Rows with
+    // equal keys are kept, they are merged when the tablet is read.
+    OLAPStatus add_row(const RowCursor& row);
+
+    // flushes the last segment and writes the meta file
+    OLAPStatus finalize();
+
+    const std::string& dir_path() const { return _dir_path; }
+    int64_t num_rows() const { return _num_rows; }
+
+    // suffix of the meta file of a segment group
+    static const std::string META_FILE_SUFFIX;
+
+private:
+    OLAPHeaderMessage _header;
+    std::string _root_path;
+    TPartitionId _partition_id;
+    TTransactionId _transaction_id;
+    int32_t _segment_group_id;
+
+    std::unique_ptr<OlapStore> _store;
+    std::shared_ptr<OLAPTable> _table;
+    SegmentGroup* _segment_group;
+    ColumnDataWriter* _writer;
+    std::string _dir_path;
+
+    RowCursor _cursor;
+    // the key of the last row to check the order
+    RowCursor _last_row;
+    std::unique_ptr<MemTracker> _tracker;
+    std::unique_ptr<MemPool> _last_row_pool;
+    int64_t _num_rows;
+    bool _finalized;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_SEGMENT_GROUP_BUILDER_H
@@ -21,12 +21,14 @@
 
 #include <istream>
 
+#include "common/config.h"
 #include "olap/file_stream.h"
 #include "olap/in_stream.h"
 #include "olap/out_stream.h"
 #include "olap/olap_cond.h"
 #include "olap/row_block.h"
 #include "olap/segment_group.h"
+#include "olap/store.h"
 
 namespace doris {
 
@@ -50,6 +52,7 @@ SegmentReader::SegmentReader(
         _segment_group(segment_group),
         _segment_id(segment_id),
         _conditions(conditions),
+        _col_predicates(col_predicates),
         _delete_handler(delete_handler),
         _delete_status(delete_status),
         _eof(false),
@@ -72,6 +75,11 @@ SegmentReader::SegmentReader(
     _lru_cache = OLAPEngine::get_instance()->index_stream_lru_cache();
     _tracker.reset(new MemTracker(-1));
     _mem_pool.reset(new MemPool(_tracker.get()));
+    if (_col_predicates != nullptr) {
+        for (auto pred : *_col_predicates) {
+            _predicate_columns.insert(pred->column_id());
+        }
+    }
 }
 
 SegmentReader::~SegmentReader() {
@@ -86,6 +94,14 @@ SegmentReader::~SegmentReader() {
         SAFE_DELETE(bf_it.second);
     }
 
+    for (auto& bitmap_it : _bitmap_indexes) {
+        SAFE_DELETE(bitmap_it.second);
+    }
+
+    for (auto& ngram_it : _ngram_indexes) {
+        SAFE_DELETE(ngram_it.second);
+    }
+
     for (auto handle : _cache_handle) {
         if (handle != nullptr) {
             _lru_cache->release(handle);
@@ -93,16 +109,18 @@ SegmentReader::~SegmentReader() {
     }
 
     _lru_cache = NULL;
+
+    // streams wait for their read ahead, so delete them before closing the file
+    for (auto& it : _streams) {
+        delete it.second;
+    }
+
     _file_handler.close();
 
     if (_is_data_loaded && _runtime_state != NULL) {
         MemTracker::update_limits(_buffer_size * -1, _runtime_state->mem_trackers()); 
     }
 
-    for (auto& it : _streams) {
-        delete it.second;
-    }
-
     for (auto reader : _column_readers) {
         delete reader;
     }
@@ -131,7 +149,7 @@ OLAPStatus SegmentReader::_check_file_version() {
 OLAPStatus SegmentReader::_load_segment_file() {
     OLAPStatus res = OLAP_SUCCESS;
 
-    res = _file_handler.open_with_cache(_file_name, O_RDONLY);
+    res = _segment_group->open_data_file(_segment_id, &_file_handler);
     if (OLAP_SUCCESS != res) {
         LOG(WARNING) << "fail to open segment file. [file='" << _file_name << "']";
         return res;
@@ -149,13 +167,16 @@ OLAPStatus SegmentReader::_load_segment_file() {
         return res;
     }
 
-    // 如果需要mmap，则进行映射
+    // 小文件使用fd cache中的映射读取, 失败时退回pread
+    if (!_is_using_mmap && config::segment_mmap_max_size > 0
+            && _file_handler.length() <= config::segment_mmap_max_size) {
+        _is_using_mmap = true;
+    }
     if (_is_using_mmap) {
-        _mmap_buffer = StorageByteBuffer::mmap(&_file_handler, 0, PROT_READ, MAP_PRIVATE);
-
-        if (NULL == _mmap_buffer) {
-            OLAP_LOG_WARNING("fail to call mmap, using default mode");
-            return OLAP_ERR_MALLOC_ERROR;
+        res = _file_handler.mmap_with_cache(&_mmap_buffer);
+        if (OLAP_SUCCESS != res) {
+            LOG(WARNING) << "fail to map segment file, using pread. [file='" << _file_name << "']";
+            _is_using_mmap = false;
         }
     }
 
@@ -176,6 +197,17 @@ OLAPStatus SegmentReader::_set_decompressor() {
         _decompressor = lz4_decompress;
         break;
     }
+    case COMPRESS_ZSTD: {
+        _zstd_decompressor.reset(new ZstdDecompressor());
+        OLAPStatus res = _zstd_decompressor->init(_header_message().compress_dictionary());
+        if (OLAP_SUCCESS != res) {
+            OLAP_LOG_WARNING("fail to init zstd decompressor.");
+            return res;
+        }
+        _decompressor = std::bind(&ZstdDecompressor::decompress, _zstd_decompressor.get(),
+                std::placeholders::_1, std::placeholders::_2);
+        break;
+    }
     default: {
         OLAP_LOG_WARNING("unknown decompressor");
         return OLAP_ERR_PARSE_PROTOBUF_ERROR;
@@ -227,6 +259,7 @@ OLAPStatus SegmentReader::init(bool is_using_cache) {
         OLAP_LOG_WARNING("fail to pick columns");
         return res;
     }
+    _init_delete_predicates();
 
     res = _load_index(is_using_cache);
     if (OLAP_SUCCESS != res) {
@@ -244,6 +277,10 @@ OLAPStatus SegmentReader::seek_to_block(
     OLAPStatus res = OLAP_SUCCESS;
 
     if (!_is_data_loaded) {
+        // the streams of a cancelled query are not read any more
+        if (_runtime_state != NULL && _runtime_state->is_cancelled()) {
+            return OLAP_ERR_READER_CANCELLED;
+        }
         _reset_readers();
         res = _read_all_data_streams(&_buffer_size);
         if (res != OLAP_SUCCESS) {
@@ -294,11 +331,16 @@ OLAPStatus SegmentReader::seek_to_block(
 }
 
 OLAPStatus SegmentReader::get_block(
-        VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof) {
+        VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof,
+        bool eval_predicates, bool filter_deleted_rows) {
     if (_eof) {
         *eof = true;
         return OLAP_SUCCESS;
     }
+    // a cancelled query stops at the next block instead of at the end of the scan
+    if (_runtime_state != NULL && _runtime_state->is_cancelled()) {
+        return OLAP_ERR_READER_CANCELLED;
+    }
 
     // lazy seek
     _seek_to_block_directly(_next_block_id, batch->columns());
@@ -310,11 +352,22 @@ OLAPStatus SegmentReader::get_block(
         num_rows_load = std::min(num_rows_load, num_rows_left);
     }
 
-    auto res = _load_to_vectorized_row_batch(batch, num_rows_load);
+    OLAPStatus res = OLAP_SUCCESS;
+    bool filter_replaced_rows = filter_deleted_rows && _delete_bitmap != nullptr;
+    if (eval_predicates && !_predicate_columns.empty()) {
+        res = _load_to_vectorized_row_batch_lazily(batch, num_rows_load, filter_replaced_rows);
+    } else {
+        res = _load_to_vectorized_row_batch(batch, num_rows_load, filter_replaced_rows);
+    }
     if (res != OLAP_SUCCESS) {
         OLAP_LOG_WARNING("fail to load block to vectorized_row_batch. [res=%d]", res);
         return res;
     }
+    if (filter_deleted_rows && _vectorized_delete
+            && batch->block_status() == DEL_PARTIAL_SATISFIED) {
+        SCOPED_RAW_TIMER(&_stats->vec_cond_ns);
+        _filter_deleted_rows(batch);
+    }
 
     _seek_to_block(_next_block_id + 1, _without_filter);
 
@@ -328,6 +381,7 @@ void SegmentReader::_set_column_map() {
     _table_id_to_unique_id_map.clear();
     _unique_id_to_table_id_map.clear();
     _unique_id_to_segment_id_map.clear();
+    _widened_columns.clear();
 
     for (ColumnId table_column_id : _used_columns) {
         ColumnId unique_column_id = tablet_schema()[table_column_id].unique_id;
@@ -351,6 +405,14 @@ void SegmentReader::_set_column_map() {
             // encoding 应该和segment schema序一致。
             _encodings_map[unique_column_id] =
                 _header_message().column_encoding(segment_column_id);
+
+            const ColumnMessage& column = _header_message().column(segment_column_id);
+            const FieldInfo& field_info =
+                tablet_schema()[_unique_id_to_table_id_map[unique_column_id]];
+            if (FieldInfo::get_field_type_by_string(column.type()) != field_info.type
+                    || column.length() != field_info.length) {
+                _widened_columns.insert(unique_column_id);
+            }
         }
     }
 }
@@ -366,9 +428,105 @@ OLAPStatus SegmentReader::_pick_columns() {
         _include_bf_columns.insert(unique_column_id);
     }
 
+    if (NULL != _conditions) {
+        for (auto& it : _conditions->columns()) {
+            auto unique_it = _table_id_to_unique_id_map.find(it.first);
+            if (unique_it == _table_id_to_unique_id_map.end()
+                    || !_can_filter_by_statistics(it.first)) {
+                continue;
+            }
+            ColumnId unique_column_id = unique_it->second;
+            auto segment_it = _unique_id_to_segment_id_map.find(unique_column_id);
+            if (segment_it == _unique_id_to_segment_id_map.end()
+                    || _is_column_widened(unique_column_id)
+                    || !_header_message().column(segment_it->second).has_bitmap_index()) {
+                continue;
+            }
+            _include_bitmap_columns.insert(unique_column_id);
+        }
+
+        for (auto& it : _conditions->like_patterns()) {
+            auto unique_it = _table_id_to_unique_id_map.find(it.first);
+            if (unique_it == _table_id_to_unique_id_map.end()
+                    || !_can_filter_by_statistics(it.first)) {
+                continue;
+            }
+            ColumnId unique_column_id = unique_it->second;
+            auto segment_it = _unique_id_to_segment_id_map.find(unique_column_id);
+            if (segment_it == _unique_id_to_segment_id_map.end()
+                    || _is_column_widened(unique_column_id)
+                    || !_header_message().column(segment_it->second).has_ngram_index()) {
+                continue;
+            }
+            _include_ngram_columns.insert(unique_column_id);
+        }
+    }
+
     return OLAP_SUCCESS;
 }
 
+void SegmentReader::_init_delete_predicates() {
+    if (_delete_handler.empty() || DEL_NOT_SATISFIED == _delete_status) {
+        return;
+    }
+    std::set<uint32_t> columns(_used_columns.begin(), _used_columns.end());
+    for (auto& delete_condition : _delete_handler.get_delete_conditions()) {
+        // the versions DeleteHandler::is_filter_data applies the condition to
+        if (_segment_group->version().second > delete_condition.filter_version) {
+            continue;
+        }
+        if (!delete_condition.vectorized) {
+            _delete_predicates.clear();
+            return;
+        }
+        for (auto predicate : delete_condition.col_predicates) {
+            if (columns.count(predicate->column_id()) == 0) {
+                _delete_predicates.clear();
+                return;
+            }
+        }
+        _delete_predicates.push_back(&delete_condition.col_predicates);
+    }
+    _vectorized_delete = true;
+}
+
+void SegmentReader::_filter_deleted_rows(VectorizedRowBatch* batch) {
+    uint16_t size = batch->size();
+    uint16_t* selected = batch->selected();
+    _undeleted_rows.resize(size);
+    for (uint16_t j = 0; j < size; ++j) {
+        _undeleted_rows[j] = batch->selected_in_use() ? selected[j] : j;
+    }
+    uint16_t num_rows = size;
+    for (auto predicates : _delete_predicates) {
+        if (num_rows == 0) {
+            break;
+        }
+        memcpy(selected, _undeleted_rows.data(), num_rows * sizeof(uint16_t));
+        batch->set_selected_in_use(true);
+        batch->set_size(num_rows);
+        for (auto predicate : *predicates) {
+            predicate->evaluate(batch);
+        }
+        // the rows still selected meet the condition, both lists are ascending
+        uint16_t num_deleted = batch->size();
+        uint16_t new_num_rows = 0;
+        for (uint16_t j = 0, k = 0; j < num_rows; ++j) {
+            if (k < num_deleted && selected[k] == _undeleted_rows[j]) {
+                ++k;
+                continue;
+            }
+            _undeleted_rows[new_num_rows++] = _undeleted_rows[j];
+        }
+        num_rows = new_num_rows;
+    }
+    memcpy(selected, _undeleted_rows.data(), num_rows * sizeof(uint16_t));
+    batch->set_selected_in_use(true);
+    batch->set_size(num_rows);
+    batch->set_block_status(DEL_NOT_SATISFIED);
+    _stats->rows_del_filtered += size - num_rows;
+}
+
 OLAPStatus SegmentReader::_pick_delete_row_groups(uint32_t first_block, uint32_t last_block) {
     VLOG(3) << "pick for " << first_block << " to " << last_block << " for delete_condition";
 
@@ -387,7 +545,7 @@ OLAPStatus SegmentReader::_pick_delete_row_groups(uint32_t first_block, uint32_t
         }
 
         for (int64_t j = first_block; j <= last_block; ++j) {
-            if (DEL_SATISFIED == _include_blocks[j]) {
+            if (DEL_SATISFIED == _block_filter[j]) {
                 //if state is DEL_SATISFIED, continue
                 continue;
             }
@@ -400,6 +558,10 @@ OLAPStatus SegmentReader::_pick_delete_row_groups(uint32_t first_block, uint32_t
                 if (0 == _unique_id_to_segment_id_map.count(unique_column_id)) {
                     continue;
                 }
+                if (_is_column_widened(unique_column_id)) {
+                    del_partial_satisfied = true;
+                    continue;
+                }
                 StreamIndexReader* index_reader = _indices[unique_column_id];
                 int del_ret = i.second->del_eval(
                     index_reader->entry(j).column_statistic().pair());
@@ -416,24 +578,18 @@ OLAPStatus SegmentReader::_pick_delete_row_groups(uint32_t first_block, uint32_t
             if (true == del_not_satisfied || 0 == delete_condition.del_cond->columns().size()) {
                 //if state is DEL_PARTIAL_SATISFIED last_time, cannot be set as DEL_NOT_SATISFIED
                 //it is special for for delete condition
-                if (DEL_PARTIAL_SATISFIED == _include_blocks[j]) {
+                if (DEL_PARTIAL_SATISFIED == _block_filter[j]) {
                     continue;
                 } else {
-                    _include_blocks[j] = DEL_NOT_SATISFIED;
+                    _block_filter[j] = DEL_NOT_SATISFIED;
                 }
             } else if (true == del_partial_satisfied) {
-                _include_blocks[j] = DEL_PARTIAL_SATISFIED;
+                _block_filter[j] = DEL_PARTIAL_SATISFIED;
                 VLOG(3) << "filter block partially: " << j;
             } else {
-                _include_blocks[j] = DEL_SATISFIED;
-                --_remain_block;
+                _block_filter[j] = DEL_SATISFIED;
+                _block_filtered_by_delete[j] = true;
                 VLOG(3) << "filter block: " << j;
-                if (j < _block_count - 1) {
-                    _stats->rows_del_filtered += _num_rows_in_block;
-                } else {
-                    _stats->rows_del_filtered +=
-                        _header_message().number_of_rows() - j * _num_rows_in_block;
-                }
             }
 
         }
@@ -458,105 +614,200 @@ OLAPStatus SegmentReader::_init_include_blocks(uint32_t first_block, uint32_t la
     return OLAP_SUCCESS;
 }
 
-OLAPStatus SegmentReader::_pick_row_groups(uint32_t first_block, uint32_t last_block) {
-    VLOG(3) << "pick from " << first_block << " to " << last_block;
-
-    if (first_block > last_block) {
-        OLAP_LOG_WARNING("invalid block offset. [first_block=%u last_block=%u]",
-                         first_block, last_block);
-        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+bool SegmentReader::merge_column_statistics(uint32_t table_column_id, ColumnStatistics* stats) {
+    if (!_can_filter_by_statistics(table_column_id)) {
+        return false;
     }
-
-    OLAPStatus res = _init_include_blocks(first_block, last_block);
-    if (OLAP_SUCCESS != res) {
-        return res;
+    ColumnId unique_column_id = _table_id_to_unique_id_map[table_column_id];
+    auto it = _indices.find(unique_column_id);
+    if (0 == _unique_id_to_segment_id_map.count(unique_column_id)
+            || _is_column_widened(unique_column_id) || it == _indices.end()) {
+        return false;
     }
+    StreamIndexReader* index_reader = it->second;
+    for (size_t j = 0; j < index_reader->entry_count(); ++j) {
+        stats->merge(&index_reader->entry(j).column_statistic());
+    }
+    return !stats->ignored();
+}
 
-    _pick_delete_row_groups(first_block, last_block);
+bool SegmentReader::_can_filter_by_statistics(ColumnId table_column_id) {
+    FieldAggregationMethod aggregation = _table->get_aggregation_by_index(table_column_id);
+    return aggregation == OLAP_FIELD_AGGREGATION_NONE
+            || (aggregation == OLAP_FIELD_AGGREGATION_REPLACE
+            && _segment_group->version().first == 0);
+}
 
-    if (NULL == _conditions || _conditions->columns().size() == 0) {
+OLAPStatus SegmentReader::_init_block_filter() {
+    if (_block_filter_inited) {
         return OLAP_SUCCESS;
     }
 
     OlapStopWatch timer;
     timer.reset();
 
-    for (auto& i : _conditions->columns()) {
-        FieldAggregationMethod aggregation = _table->get_aggregation_by_index(i.first);
-        bool is_continue = (aggregation == OLAP_FIELD_AGGREGATION_NONE
-                || (aggregation == OLAP_FIELD_AGGREGATION_REPLACE
-                && _segment_group->version().first == 0));
-        if (!is_continue) {
-            continue;
-        }
+    _block_filter.assign(_block_count, DEL_NOT_SATISFIED);
+    _block_filtered_by_delete.assign(_block_count, false);
+    if (_block_count == 0) {
+        _block_filter_inited = true;
+        return OLAP_SUCCESS;
+    }
+    uint32_t last_block = _block_count - 1;
 
-        ColumnId table_column_id = i.first;
-        ColumnId unique_column_id = _table_id_to_unique_id_map[table_column_id];
-        if (0 == _unique_id_to_segment_id_map.count(unique_column_id)) {
-            continue;
-        }
-        StreamIndexReader* index_reader = _indices[unique_column_id];
-        for (int64_t j = first_block; j <= last_block; ++j) {
-            if (_include_blocks[j] == DEL_SATISFIED) {
+    _pick_delete_row_groups(0, last_block);
+
+    uint32_t remain_block = 0;
+    if (NULL != _conditions && _conditions->columns().size() != 0) {
+        for (auto& i : _conditions->columns()) {
+            ColumnId table_column_id = i.first;
+            if (!_can_filter_by_statistics(table_column_id)) {
+                continue;
+            }
+            ColumnId unique_column_id = _table_id_to_unique_id_map[table_column_id];
+            if (0 == _unique_id_to_segment_id_map.count(unique_column_id)
+                    || _is_column_widened(unique_column_id)) {
                 continue;
             }
+            StreamIndexReader* index_reader = _indices[unique_column_id];
+            for (int64_t j = 0; j <= last_block; ++j) {
+                if (_block_filter[j] == DEL_SATISFIED) {
+                    continue;
+                }
+                if (!i.second->eval(index_reader->entry(j).column_statistic().pair())) {
+                    _block_filter[j] = DEL_SATISFIED;
+                }
+            }
+        }
 
-            if (!i.second->eval(index_reader->entry(j).column_statistic().pair())) {
-                _include_blocks[j] = DEL_SATISFIED;
-                --_remain_block;
+        for (int64_t j = 0; j <= last_block; ++j) {
+            remain_block += (_block_filter[j] != DEL_SATISFIED);
+        }
 
-                if (j < _block_count - 1) {
-                    _stats->rows_stats_filtered += _num_rows_in_block; 
-                } else {
-                    _stats->rows_stats_filtered +=
-                        _header_message().number_of_rows() - j * _num_rows_in_block;
+        if (remain_block >= MIN_FILTER_BLOCK_NUM) {
+            for (uint32_t i : _load_bf_columns) {
+                if (!_can_filter_by_statistics(i)) {
+                    continue;
+                }
+                ColumnId unique_column_id = _table_id_to_unique_id_map[i];
+                if (0 == _unique_id_to_segment_id_map.count(unique_column_id)
+                        || _is_column_widened(unique_column_id)) {
+                    continue;
+                }
+                BloomFilterIndexReader* bf_reader = _bloom_filters[unique_column_id];
+                for (int64_t j = 0; j <= last_block; ++j) {
+                    if (_block_filter[j] == DEL_SATISFIED) {
+                        continue;
+                    }
+                    if (!_conditions->columns().at(i)->eval(bf_reader->entry(j))) {
+                        _block_filter[j] = DEL_SATISFIED;
+                        --remain_block;
+                    }
                 }
             }
+        } else {
+            VLOG(3) << "bloom filter is ignored for too few block remained. "
+                    << "remain_block=" << remain_block;
         }
     }
 
-    if (_remain_block < MIN_FILTER_BLOCK_NUM) {
-        VLOG(3) << "bloom filter is ignored for too few block remained. "
-                << "remain_block=" << _remain_block
-                << ", const_time=" << timer.get_elapse_time_us();
-        return OLAP_SUCCESS;
+    if (NULL != _conditions) {
+        _init_bitmap_index_rows();
+        if (_bitmap_index_rows != nullptr) {
+            for (int64_t j = 0; j <= last_block; ++j) {
+                if (_block_filter[j] != DEL_SATISFIED
+                        && !_bitmap_index_rows->intersects(
+                            j * _num_rows_in_block, (j + 1) * _num_rows_in_block)) {
+                    _block_filter[j] = DEL_SATISFIED;
+                }
+            }
+        }
     }
 
-    for (uint32_t i : _load_bf_columns) {
-        FieldAggregationMethod aggregation = _table->get_aggregation_by_index(i);
-        bool is_continue = (aggregation == OLAP_FIELD_AGGREGATION_NONE
-                || (aggregation == OLAP_FIELD_AGGREGATION_REPLACE
-                && _segment_group->version().first == 0));
-        if (!is_continue) {
+    _block_filter_inited = true;
+    VLOG(3) << "init block filter finished. block_count=" << _block_count
+            << ", const_time=" << timer.get_elapse_time_us();
+    return OLAP_SUCCESS;
+}
+
+void SegmentReader::_init_bitmap_index_rows() {
+    for (auto& it : _bitmap_indexes) {
+        ColumnId table_column_id = _unique_id_to_table_id_map[it.first];
+        auto cond_it = _conditions->columns().find(table_column_id);
+        if (cond_it == _conditions->columns().end()) {
             continue;
         }
+        RoaringBitmap rows;
+        if (!cond_it->second->eval(*it.second, &rows)) {
+            continue;
+        }
+        if (_bitmap_index_rows == nullptr) {
+            _bitmap_index_rows.reset(new RoaringBitmap(std::move(rows)));
+        } else {
+            _bitmap_index_rows->intersect_with(rows);
+        }
+    }
 
-        ColumnId table_column_id = i;
-        ColumnId unique_column_id = _table_id_to_unique_id_map[table_column_id];
-        if (0 == _unique_id_to_segment_id_map.count(unique_column_id)) {
+    for (auto& it : _ngram_indexes) {
+        ColumnId table_column_id = _unique_id_to_table_id_map[it.first];
+        auto like_it = _conditions->like_patterns().find(table_column_id);
+        if (like_it == _conditions->like_patterns().end()) {
             continue;
         }
-        BloomFilterIndexReader* bf_reader = _bloom_filters[unique_column_id];
-        for (int64_t j = first_block; j <= last_block; ++j) {
-            if (_include_blocks[j] == DEL_SATISFIED) {
+        for (auto& pattern : like_it->second) {
+            RoaringBitmap rows;
+            if (!it.second->match_like(pattern, &rows)) {
                 continue;
             }
-
-            if (!_conditions->columns().at(i)->eval(bf_reader->entry(j))) {
-                _include_blocks[j] = DEL_SATISFIED;
-                --_remain_block;
-                if (j < _block_count - 1) {
-                    _stats->rows_stats_filtered += _num_rows_in_block; 
-                } else {
-                    _stats->rows_stats_filtered +=
-                        _header_message().number_of_rows() - j * _num_rows_in_block;
-                }
+            if (_bitmap_index_rows == nullptr) {
+                _bitmap_index_rows.reset(new RoaringBitmap(std::move(rows)));
+            } else {
+                _bitmap_index_rows->intersect_with(rows);
             }
         }
     }
+}
 
-    VLOG(3) << "pick row groups finished. remain_block=" << _remain_block
-            << ", const_time=" << timer.get_elapse_time_us();
+OLAPStatus SegmentReader::_pick_row_groups(uint32_t first_block, uint32_t last_block) {
+    VLOG(3) << "pick from " << first_block << " to " << last_block;
+
+    if (first_block > last_block) {
+        OLAP_LOG_WARNING("invalid block offset. [first_block=%u last_block=%u]",
+                         first_block, last_block);
+        return OLAP_ERR_INPUT_PARAMETER_ERROR;
+    }
+
+    OLAPStatus res = _init_include_blocks(first_block, last_block);
+    if (OLAP_SUCCESS != res) {
+        return res;
+    }
+
+    // Filter result of the whole segment is computed once and shared by all
+    // seek_to_block calls, each call only takes its own range out of it.
+    res = _init_block_filter();
+    if (OLAP_SUCCESS != res) {
+        return res;
+    }
+
+    int64_t end_block = std::min<int64_t>(last_block, _block_count - 1);
+    for (int64_t j = first_block; j <= end_block; ++j) {
+        _include_blocks[j] = _block_filter[j];
+        if (_block_filter[j] != DEL_SATISFIED) {
+            continue;
+        }
+
+        --_remain_block;
+        int64_t rows = _num_rows_in_block;
+        if (j == _block_count - 1) {
+            rows = _header_message().number_of_rows() - j * _num_rows_in_block;
+        }
+        if (_block_filtered_by_delete[j]) {
+            _stats->rows_del_filtered += rows;
+        } else {
+            _stats->rows_stats_filtered += rows;
+        }
+    }
+
+    VLOG(3) << "pick row groups finished. remain_block=" << _remain_block;
     return OLAP_SUCCESS;
 }
 
@@ -594,6 +845,9 @@ OLAPStatus SegmentReader::_load_index(bool is_using_cache) {
         OLAP_LOG_WARNING("fail to init stream. [res=%d]", res);
         return res;
     }
+    if (_is_using_mmap) {
+        stream.set_mapping(_mmap_buffer);
+    }
 
     _indices.clear();
     _bloom_filters.clear();
@@ -618,19 +872,24 @@ OLAPStatus SegmentReader::_load_index(bool is_using_cache) {
         if ((_is_column_included(unique_column_id)
                 && message.kind() == StreamInfoMessage::ROW_INDEX)
                 || (_is_bf_column_included(unique_column_id)
-                && message.kind() == StreamInfoMessage::BLOOM_FILTER)) {
+                && message.kind() == StreamInfoMessage::BLOOM_FILTER)
+                || (_is_bitmap_column_included(unique_column_id)
+                && message.kind() == StreamInfoMessage::BITMAP_INDEX)
+                || (_is_ngram_column_included(unique_column_id)
+                && message.kind() == StreamInfoMessage::NGRAM_INDEX)) {
         } else {
             continue;
         }
 
-        ColumnId table_column_id = _unique_id_to_table_id_map[unique_column_id];
-        FieldType type = _table->get_field_type_by_index(table_column_id);
+        // 索引按segment中记录的类型解析
+        FieldType type = FieldInfo::get_field_type_by_string(_header_message().column(
+                    _unique_id_to_segment_id_map[unique_column_id]).type());
 
         char* stream_buffer = NULL;
         char key_buf[OLAP_LRU_CACHE_MAX_KEY_LENTH];
         CacheKey key = _construct_index_stream_key(key_buf,
                        sizeof(key_buf),
-                       _file_handler.file_name(),
+                       _file_name,
                        unique_column_id,
                        message.kind());
         _cache_handle[cache_handle_index] = _lru_cache->lookup(key);
@@ -670,6 +929,41 @@ OLAPStatus SegmentReader::_load_index(bool is_using_cache) {
         }
         cache_handle_index++;
 
+        if (message.kind() == StreamInfoMessage::BITMAP_INDEX) {
+            BitmapIndexReader* bitmap_index = new(std::nothrow) BitmapIndexReader;
+            if (bitmap_index == NULL) {
+                OLAP_LOG_WARNING("fail to malloc memory. [size=%lu]", sizeof(BitmapIndexReader));
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+
+            // owned by the reader before init, so it is released if init fails
+            _bitmap_indexes[unique_column_id] = bitmap_index;
+            res = bitmap_index->init(stream_buffer, stream_length, is_using_cache);
+            if (res != OLAP_SUCCESS) {
+                OLAP_LOG_WARNING("fail to init bitmap index reader. [res=%d]", res);
+                return res;
+            }
+            // the bitmap index has no entry per block
+            continue;
+        }
+
+        if (message.kind() == StreamInfoMessage::NGRAM_INDEX) {
+            NgramIndexReader* ngram_index = new(std::nothrow) NgramIndexReader;
+            if (ngram_index == NULL) {
+                OLAP_LOG_WARNING("fail to malloc memory. [size=%lu]", sizeof(NgramIndexReader));
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+
+            // owned by the reader before init, so it is released if init fails
+            _ngram_indexes[unique_column_id] = ngram_index;
+            res = ngram_index->init(stream_buffer, stream_length, is_using_cache);
+            if (res != OLAP_SUCCESS) {
+                OLAP_LOG_WARNING("fail to init ngram index reader. [res=%d]", res);
+                return res;
+            }
+            continue;
+        }
+
         if (message.kind() == StreamInfoMessage::ROW_INDEX) {
             StreamIndexReader* index_message = new(std::nothrow) StreamIndexReader;
             if (index_message == NULL) {
@@ -753,6 +1047,26 @@ int32_t SegmentReader::_get_index_position(ColumnEncodingMessage::Kind encoding_
 OLAPStatus SegmentReader::_read_all_data_streams(size_t* buffer_size) {
     int64_t stream_offset = _header_length;
     uint64_t stream_length = 0;
+    // io_uring stores read one window of a chunk per stream, filled in batches,
+    // HDD stores read ahead storage_read_ahead_chunks with the store's threads
+    ReadAheadQueue* read_ahead_queue = nullptr;
+    uint32_t read_ahead_chunks = 0;
+    OlapStore* store = _table->store();
+    if (_is_using_mmap) {
+        // the mapped streams read no window
+    } else if (store != nullptr && store->use_io_uring()) {
+        _use_io_uring = true;
+        read_ahead_chunks = 1;
+    } else if (store != nullptr && store->read_ahead_queue() != nullptr
+            && config::storage_read_ahead_chunks > 0) {
+        read_ahead_queue = store->read_ahead_queue();
+        read_ahead_chunks = config::storage_read_ahead_chunks;
+    }
+    // small segment groups, e.g. of dimension tables, keep decompressed chunks
+    Cache* page_cache = OLAPEngine::get_instance()->data_page_cache();
+    bool cache_decompressed =
+        static_cast<int64_t>(_segment_group->data_size())
+            <= config::data_page_cache_decompressed_max_size;
 
     // 每条流就一块整的
     for (int64_t stream_index = 0; stream_index < _header_message().stream_info_size();
@@ -794,6 +1108,24 @@ OLAPStatus SegmentReader::_read_all_data_streams(size_t* buffer_size) {
             return res;
         }
 
+        if (_is_using_mmap) {
+            stream->set_mapping(_mmap_buffer);
+        }
+
+        if (read_ahead_chunks > 0) {
+            res = stream->init_read_ahead(read_ahead_queue, read_ahead_chunks);
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to init stream read ahead");
+                return res;
+            }
+        }
+
+        if (page_cache != nullptr) {
+            stream->set_page_cache(page_cache,
+                                   OLAPEngine::get_instance()->data_page_cache_mem_tracker(),
+                                   cache_decompressed);
+        }
+
         *buffer_size += stream->get_buffer_size();
         _streams[name] = stream.release();
     }
@@ -806,7 +1138,7 @@ OLAPStatus SegmentReader::_create_reader(size_t* buffer_size) {
     _column_indices.resize(_table->tablet_schema().size(), nullptr);
     for (auto table_column_id : _used_columns) {
         ColumnId unique_column_id = _table_id_to_unique_id_map[table_column_id];
-        // 当前是不会出现table和segment的schema不一致的情况的
+        // 加宽过的列也按table的类型读, 整数流和变长字符串流的格式与宽度无关
         std::unique_ptr<ColumnReader> reader(ColumnReader::create(table_column_id,
                                _table->tablet_schema(),
                                _unique_id_to_table_id_map,
@@ -825,6 +1157,16 @@ OLAPStatus SegmentReader::_create_reader(size_t* buffer_size) {
 
         *buffer_size += reader->get_buffer_size();
         _column_readers[table_column_id] = reader.release();
+        if (_use_io_uring) {
+            if (_column_streams.size() <= table_column_id) {
+                _column_streams.resize(table_column_id + 1);
+            }
+            for (auto& it : _streams) {
+                if (it.first.unique_column_id() == unique_column_id) {
+                    _column_streams[table_column_id].push_back(it.second);
+                }
+            }
+        }
         if (_indices.count(unique_column_id) != 0) {
             _column_indices[table_column_id] = _indices[unique_column_id];
         }
@@ -895,6 +1237,7 @@ OLAPStatus SegmentReader::_reset_readers() {
     }
 
     _column_readers.clear();
+    _column_streams.clear();
     _eof = false;
     return OLAP_SUCCESS;
 }
@@ -911,11 +1254,43 @@ void SegmentReader::_seek_to_block(int64_t block_id, bool without_filter) {
     _next_block_id = block_id;
 }
 
-OLAPStatus SegmentReader::_load_to_vectorized_row_batch(
-        VectorizedRowBatch* batch, size_t size) {
-    SCOPED_RAW_TIMER(&_stats->block_load_ns);
+void SegmentReader::_batch_read_streams(const std::vector<uint32_t>& cids) {
+    _batch_requests.clear();
+    _batch_streams.clear();
+    for (auto cid : cids) {
+        if (cid >= _column_streams.size()) {
+            continue;
+        }
+        for (auto stream : _column_streams[cid]) {
+            BatchReadRequest request;
+            if (stream->prepare_batch_read(&request)) {
+                _batch_requests.push_back(request);
+                _batch_streams.push_back(stream);
+            }
+        }
+    }
+    if (_batch_requests.empty()) {
+        return;
+    }
+
+    {
+        SCOPED_RAW_TIMER(&_stats->io_ns);
+        // a failed request leaves its window empty, and the stream reports the
+        // error when it reads the range again by itself
+        FileHandler::pread_batch(_batch_requests.data(), _batch_requests.size(), true);
+    }
+    for (size_t i = 0; i < _batch_streams.size(); ++i) {
+        _batch_streams[i]->finish_batch_read(_batch_requests[i].status);
+    }
+}
+
+OLAPStatus SegmentReader::_load_columns(
+        VectorizedRowBatch* batch, const std::vector<uint32_t>& cids, size_t size) {
+    if (_use_io_uring) {
+        _batch_read_streams(cids);
+    }
     MemPool* mem_pool = batch->mem_pool();
-    for (auto cid : batch->columns()) {
+    for (auto cid : cids) {
         auto reader = _column_readers[cid];
         auto res = reader->next_vector(batch->column(cid), size, mem_pool);
         if (res != OLAP_SUCCESS) {
@@ -925,7 +1300,109 @@ OLAPStatus SegmentReader::_load_to_vectorized_row_batch(
             return res;
         }
     }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SegmentReader::_load_to_vectorized_row_batch(
+        VectorizedRowBatch* batch, size_t size, bool filter_replaced_rows) {
+    SCOPED_RAW_TIMER(&_stats->block_load_ns);
+    auto res = _load_columns(batch, batch->columns(), size);
+    if (res != OLAP_SUCCESS) {
+        return res;
+    }
     batch->set_size(size);
+    if (filter_replaced_rows) {
+        _filter_replaced_rows(batch);
+    }
+    if (_bitmap_index_rows != nullptr && !_without_filter) {
+        _filter_by_bitmap_index(batch);
+    }
+    _finish_block_load(batch, size, true);
+    return OLAP_SUCCESS;
+}
+
+void SegmentReader::_filter_replaced_rows(VectorizedRowBatch* batch) {
+    // every block is loaded from its start, see _seek_to_block_directly
+    _stats->rows_replaced_filtered += _delete_bitmap->filter(
+            _segment_id, _current_block_id * _num_rows_in_block, _delete_bitmap_version, batch);
+}
+
+void SegmentReader::_filter_by_bitmap_index(VectorizedRowBatch* batch) {
+    uint16_t size = batch->size();
+    uint16_t* selected = batch->selected();
+    bool selected_in_use = batch->selected_in_use();
+    // every block is loaded from its start, see _seek_to_block_directly
+    uint32_t first_row = _current_block_id * _num_rows_in_block;
+    uint16_t new_size = 0;
+    for (uint16_t j = 0; j < size; ++j) {
+        uint16_t i = selected_in_use ? selected[j] : j;
+        selected[new_size] = i;
+        new_size += _bitmap_index_rows->contains(first_row + i);
+    }
+    if (new_size != size) {
+        batch->set_selected_in_use(true);
+        batch->set_size(new_size);
+        _stats->rows_bitmap_index_filtered += size - new_size;
+    }
+}
+
+OLAPStatus SegmentReader::_load_to_vectorized_row_batch_lazily(
+        VectorizedRowBatch* batch, size_t size, bool filter_replaced_rows) {
+    std::vector<uint32_t> pred_cids;
+    std::vector<uint32_t> lazy_cids;
+    for (auto cid : batch->columns()) {
+        if (_predicate_columns.count(cid) != 0) {
+            pred_cids.push_back(cid);
+        } else {
+            lazy_cids.push_back(cid);
+        }
+    }
+
+    {
+        SCOPED_RAW_TIMER(&_stats->block_load_ns);
+        auto res = _load_columns(batch, pred_cids, size);
+        if (res != OLAP_SUCCESS) {
+            return res;
+        }
+    }
+    batch->set_size(size);
+    if (filter_replaced_rows) {
+        _filter_replaced_rows(batch);
+    }
+    if (_bitmap_index_rows != nullptr && !_without_filter) {
+        _filter_by_bitmap_index(batch);
+    }
+    {
+        SCOPED_RAW_TIMER(&_stats->vec_cond_ns);
+        uint16_t num_rows = batch->size();
+        for (auto pred : *_col_predicates) {
+            pred->evaluate(batch);
+        }
+        _stats->rows_vec_cond_filtered += num_rows - batch->size();
+    }
+
+    // Selection vector is in ascending order, so rows after the last selected
+    // one are never looked at.
+    size_t lazy_size = 0;
+    if (batch->size() > 0) {
+        lazy_size = batch->selected_in_use() ? batch->selected()[batch->size() - 1] + 1 : size;
+    }
+    if (lazy_size > 0 && !lazy_cids.empty()) {
+        SCOPED_RAW_TIMER(&_stats->block_load_ns);
+        auto res = _load_columns(batch, lazy_cids, lazy_size);
+        if (res != OLAP_SUCCESS) {
+            return res;
+        }
+    }
+    if (lazy_size < size) {
+        _stats->lazy_read_skipped_values += (size - lazy_size) * lazy_cids.size();
+    }
+    _finish_block_load(batch, size, lazy_cids.empty() || lazy_size == size);
+    return OLAP_SUCCESS;
+}
+
+void SegmentReader::_finish_block_load(
+        VectorizedRowBatch* batch, size_t size, bool all_columns_read) {
     if (_include_blocks != nullptr) {
         batch->set_block_status(_include_blocks[_current_block_id]);
     } else {
@@ -938,11 +1415,13 @@ OLAPStatus SegmentReader::_load_to_vectorized_row_batch(
     } else {
         _at_block_start = false;
     }
+    // Streams of lazily read columns stopped in the middle of the block
+    if (!all_columns_read) {
+        _at_block_start = false;
+    }
 
     _stats->blocks_load++;
     _stats->raw_rows_read += size;
-
-    return OLAP_SUCCESS;
 }
 
 }  //unamespace doris
@@ -23,11 +23,15 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 
+#include "olap/bitmap_index_reader.h"
 #include "olap/bloom_filter_reader.h"
 #include "olap/column_reader.h"
 #include "olap/compress.h"
+#include "olap/delete_bitmap.h"
+#include "olap/ngram_index_reader.h"
 #include "olap/file_stream.h"
 #include "olap/in_stream.h"
 #include "olap/stream_index_reader.h"
@@ -100,8 +104,29 @@ public:
     // next_block_id: 
     //      block with next_block_id would read if get_block called again.
     //      this field is used to set batch's limit when client found logical end is reach
+    // eval_predicates: 
+    //      if true, column predicates are evaluated on this block. Predicate columns are
+    //      decoded first, other columns are only decoded up to the last row that passes
+    //      the predicates, and not at all when no row passes.
+    // filter_deleted_rows:
+    //      if true, rows marked in the delete bitmap given by set_delete_bitmap are
+    //      removed from the selection of the batch. So are the rows of partially
+    //      deleted blocks meeting the delete conditions if these are all vectorized,
+    //      the block status of the batch is DEL_NOT_SATISFIED then.
     // ATTN: If you change batch to contain more columns, you must call seek_to_block again.
-    OLAPStatus get_block(VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof);
+    OLAPStatus get_block(VectorizedRowBatch* batch, uint32_t* next_block_id, bool* eof,
+                         bool eval_predicates, bool filter_deleted_rows);
+
+    // Merges the statistics of all blocks of a return column into 'stats'.
+    // Returns false if the segment has none for the column, e.g. for strings or
+    // columns added or widened by schema change.
+    bool merge_column_statistics(uint32_t table_column_id, ColumnStatistics* stats);
+
+    // Rows of 'bitmap' replaced in 'version' or before are not returned by get_block
+    void set_delete_bitmap(std::shared_ptr<const DeleteBitmap> bitmap, int64_t version) {
+        _delete_bitmap = std::move(bitmap);
+        _delete_bitmap_version = version;
+    }
 
     bool eof() const {
         return _eof;
@@ -162,6 +187,20 @@ private:
         return _include_bf_columns.count(column_unique_id) != 0;
     }
 
+    inline bool _is_bitmap_column_included(ColumnId column_unique_id) {
+        return _include_bitmap_columns.count(column_unique_id) != 0;
+    }
+
+    inline bool _is_ngram_column_included(ColumnId column_unique_id) {
+        return _include_ngram_columns.count(column_unique_id) != 0;
+    }
+
+    // 列在linked schema change中被加宽过(比如INT改为BIGINT), 数据按新类型读, 但索引中的
+    // 统计信息和bloom filter还是按segment中记录的类型写的, 不能用来过滤
+    inline bool _is_column_widened(ColumnId column_unique_id) {
+        return _widened_columns.count(column_unique_id) != 0;
+    }
+
     // 加载文件和必要的文件信息
     OLAPStatus _load_segment_file();
 
@@ -190,6 +229,22 @@ private:
     OLAPStatus _pick_row_groups(uint32_t first_block, uint32_t last_block);
     OLAPStatus _pick_delete_row_groups(uint32_t first_block, uint32_t last_block);
 
+    // Evaluate delete conditions, column statistics and bloom filters on every
+    // block of this segment and save the result in _block_filter. Only done on
+    // the first call, later calls return immediately.
+    OLAPStatus _init_block_filter();
+
+    // Whether block statistics of this column can be used to filter blocks.
+    // Value columns of aggregate tables can't, because their stored values are
+    // not the final ones.
+    bool _can_filter_by_statistics(ColumnId table_column_id);
+
+    // Intersect the rows satisfying the conditions of every column with a
+    // bitmap index, and the rows which may match the LIKE patterns of every
+    // column with an ngram index, into _bitmap_index_rows, left null if no
+    // index can tell.
+    void _init_bitmap_index_rows();
+
     // 加载索引，将需要的列的索引读入内存
     OLAPStatus _load_index(bool is_using_cache);
 
@@ -253,7 +308,11 @@ private:
             if ((_is_column_included(unique_column_id)
                     && message.kind() == StreamInfoMessage::ROW_INDEX)
                     || (_is_bf_column_included(unique_column_id)
-                    && message.kind() == StreamInfoMessage::BLOOM_FILTER)) {
+                    && message.kind() == StreamInfoMessage::BLOOM_FILTER)
+                    || (_is_bitmap_column_included(unique_column_id)
+                    && message.kind() == StreamInfoMessage::BITMAP_INDEX)
+                    || (_is_ngram_column_included(unique_column_id)
+                    && message.kind() == StreamInfoMessage::NGRAM_INDEX)) {
                 ++included_row_index_stream_num;
             }
         }
@@ -261,7 +320,37 @@ private:
     }
 
     OLAPStatus _load_to_vectorized_row_batch(
-        VectorizedRowBatch* batch, size_t size);
+        VectorizedRowBatch* batch, size_t size, bool filter_replaced_rows);
+
+    // Two phase version of _load_to_vectorized_row_batch: decode predicate columns,
+    // evaluate _col_predicates, then decode the other columns only as far as needed.
+    OLAPStatus _load_to_vectorized_row_batch_lazily(
+        VectorizedRowBatch* batch, size_t size, bool filter_replaced_rows);
+
+    // Remove rows of the current block marked in _delete_bitmap from the selection
+    void _filter_replaced_rows(VectorizedRowBatch* batch);
+
+    // Remove rows of the current block not in _bitmap_index_rows from the selection
+    void _filter_by_bitmap_index(VectorizedRowBatch* batch);
+
+    // Finds the predicates of the delete conditions applying to this segment,
+    // sets _vectorized_delete if they can replace the conditions
+    void _init_delete_predicates();
+
+    // Remove rows meeting the delete conditions from the selection
+    void _filter_deleted_rows(VectorizedRowBatch* batch);
+
+    OLAPStatus _load_columns(VectorizedRowBatch* batch, const std::vector<uint32_t>& cids,
+                             size_t size);
+
+    // Read the next chunk of every stream of 'cids' that does not hold it yet
+    // with one FileHandler::pread_batch, only if the store uses io_uring.
+    void _batch_read_streams(const std::vector<uint32_t>& cids);
+
+    // Update block status and read position after 'size' rows of current block are
+    // loaded. If 'all_columns_read' is false, some column streams are left inside
+    // the block, and the next get_block must seek them again.
+    void _finish_block_load(VectorizedRowBatch* batch, size_t size, bool all_columns_read);
 
 private:
     static const int32_t BYTE_STREAM_POSITIONS = 1;
@@ -282,8 +371,17 @@ private:
     uint32_t _segment_id;
 
     const Conditions* _conditions;         // 列过滤条件
+    const std::vector<ColumnPredicate*>* _col_predicates;
+    // table column ids that _col_predicates are evaluated on
+    std::set<uint32_t> _predicate_columns;
     DeleteHandler _delete_handler;
     DelCondSatisfied _delete_status;
+    // the predicates of every delete condition applying to this segment, a
+    // row is deleted if it meets all predicates of one of them
+    std::vector<const std::vector<ColumnPredicate*>*> _delete_predicates;
+    bool _vectorized_delete = false;
+    // rows left by _filter_deleted_rows
+    std::vector<uint16_t> _undeleted_rows;
 
     bool _eof;                             // eof标志
 
@@ -317,15 +415,31 @@ private:
     UniqueIdSet _include_columns;           // 用于判断该列是不是被包含
     UniqueIdSet _load_bf_columns;
     UniqueIdSet _include_bf_columns;
+    // columns with conditions and a bitmap index in this segment
+    UniqueIdSet _include_bitmap_columns;
+    // string columns with LIKE patterns and an ngram index in this segment
+    UniqueIdSet _include_ngram_columns;
     UniqueIdToColumnIdMap _table_id_to_unique_id_map; // table id到unique id的映射
     UniqueIdToColumnIdMap _unique_id_to_table_id_map; // unique id到table id的映射
     UniqueIdToColumnIdMap _unique_id_to_segment_id_map; // uniqid到segment id的映射
+    UniqueIdSet _widened_columns;          // 类型和segment中记录的不一致的列
 
     std::map<ColumnId, StreamIndexReader*> _indices;
     std::map<StreamName, ReadOnlyFileStream*> _streams;      //需要读取的流
+    // streams of every table column, only filled if _use_io_uring
+    std::vector<std::vector<ReadOnlyFileStream*>> _column_streams;
+    bool _use_io_uring = false;
+    std::vector<BatchReadRequest> _batch_requests;
+    std::vector<ReadOnlyFileStream*> _batch_streams;
     UniqueIdEncodingMap _encodings_map;            // 保存encoding
     std::map<ColumnId, BloomFilterIndexReader*> _bloom_filters;
+    std::map<ColumnId, BitmapIndexReader*> _bitmap_indexes;
+    std::map<ColumnId, NgramIndexReader*> _ngram_indexes;
+    // rows of this segment which may satisfy the conditions, null if all may
+    std::unique_ptr<RoaringBitmap> _bitmap_index_rows;
     Decompressor _decompressor;                    //根据压缩格式，设置的解压器
+    // context of _decompressor for COMPRESS_ZSTD segments
+    std::unique_ptr<ZstdDecompressor> _zstd_decompressor;
     StorageByteBuffer* _mmap_buffer;
 
     /*
@@ -338,6 +452,13 @@ private:
      * DEL_PARTIAL_SATISFIED is for block can't be filtered by the delete condition in block level.
     */
     uint8_t* _include_blocks;
+    // Same states as _include_blocks but for every block in this segment. It does
+    // not depend on the range being read, so it is kept across seek_to_block calls.
+    std::vector<uint8_t> _block_filter;
+    // Whether a DEL_SATISFIED block in _block_filter is removed by delete conditions
+    // rather than by query conditions, only used for statistics.
+    std::vector<bool> _block_filtered_by_delete;
+    bool _block_filter_inited = false;
     uint32_t _remain_block;
     bool _need_block_filter;   //与include blocks组合使用，如果全不中，就不再读
     bool _is_using_mmap;                     // 这个标记为true时，使用mmap来读取文件
@@ -357,6 +478,9 @@ private:
     // Set when seek_to_block is called, valid until next seek_to_block is called.
     bool _without_filter = false;
 
+    std::shared_ptr<const DeleteBitmap> _delete_bitmap;
+    int64_t _delete_bitmap_version = -1;
+
     OlapReaderStatistics* _stats;
 
     DISALLOW_COPY_AND_ASSIGN(SegmentReader);
@@ -17,7 +17,9 @@
 
 #include "olap/segment_writer.h"
 
+#include "common/config.h"
 #include "olap/column_writer.h"
+#include "olap/column_writer_pool.h"
 #include "olap/out_stream.h"
 #include "olap/file_helper.h"
 #include "olap/utils.h"
@@ -33,8 +35,10 @@ SegmentWriter::SegmentWriter(
         _table(table),
         _stream_buffer_size(stream_buffer_size),
         _stream_factory(NULL),
+        _pool(NULL),
         _row_count(0),
-        _block_count(0) {}
+        _block_count(0),
+        _row_checksum(0) {}
 
 SegmentWriter::~SegmentWriter() {
     SAFE_DELETE(_stream_factory);
@@ -48,8 +52,9 @@ SegmentWriter::~SegmentWriter() {
 OLAPStatus SegmentWriter::init(uint32_t write_mbytes_per_sec) {
     OLAPStatus res = OLAP_SUCCESS;
     // 创建factory
-    _stream_factory = 
-        new(std::nothrow) OutStreamFactory(_table->compress_kind(), _stream_buffer_size);
+    uint32_t dictionary_size = _table->compress_dictionary() ? config::zstd_dictionary_size : 0;
+    _stream_factory = new(std::nothrow) OutStreamFactory(_table->compress_kind(),
+            _stream_buffer_size, _table->compress_level(), dictionary_size);
 
     if (NULL == _stream_factory) {
         OLAP_LOG_WARNING("fail to allocate out stream factory");
@@ -79,28 +84,89 @@ OLAPStatus SegmentWriter::init(uint32_t write_mbytes_per_sec) {
         }
     }
 
+    for (uint32_t i = 0; i < _table->tablet_schema().size(); i++) {
+        FieldType type = _table->tablet_schema()[i].type;
+        if (type != OLAP_FIELD_TYPE_FLOAT && type != OLAP_FIELD_TYPE_DOUBLE) {
+            _checksum_columns.push_back(i);
+        }
+    }
+
+    // columns are independent of each other except through the compressor
+    if (_root_writers.size() > 1 && _stream_factory->thread_safe()) {
+        _pool = ColumnWriterPool::instance();
+    }
+    if (_pool != NULL) {
+        for (size_t i = 0; i < _root_writers.size(); ++i) {
+            std::unique_ptr<RowCursor> cursor(new(std::nothrow) RowCursor());
+            if (cursor == nullptr) {
+                OLAP_LOG_WARNING("fail to malloc row cursor");
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+            res = cursor->init(_table->tablet_schema());
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to initialize row cursor. [res=%d]", res);
+                return res;
+            }
+            _cursors.push_back(std::move(cursor));
+        }
+    }
+
     _write_mbytes_per_sec = write_mbytes_per_sec;
 
     return OLAP_SUCCESS;
 }
 
+OLAPStatus SegmentWriter::_write_column(ColumnWriter* writer, RowBlock* block, RowCursor* cursor) {
+    OLAPStatus res = writer->write_batch(block, cursor);
+    if (OLAP_UNLIKELY(res != OLAP_SUCCESS)) {
+        OLAP_LOG_WARNING("fail to write row. [res=%d]", res);
+        return res;
+    }
+    res = writer->create_row_index_entry();
+    if (OLAP_UNLIKELY(res != OLAP_SUCCESS)) {
+        OLAP_LOG_WARNING("fail to create row index. [res=%d]", res);
+        return res;
+    }
+    return res;
+}
+
 OLAPStatus SegmentWriter::write_batch(RowBlock* block, RowCursor* cursor, bool is_finalize) {
     DCHECK(block->row_block_info().row_num == _table->num_rows_per_row_block() || is_finalize)
         << "write block not empty, num_rows=" << block->row_block_info().row_num
         << ", table_num_rows=" << _table->num_rows_per_row_block();
     OLAPStatus res = OLAP_SUCCESS;
-    for (auto col_writer : _root_writers) {
-        res = col_writer->write_batch(block, cursor);
-        if (OLAP_UNLIKELY(res != OLAP_SUCCESS)) {
-            OLAP_LOG_WARNING("fail to write row. [res=%d]", res);
-            return res;
+    if (_pool != NULL) {
+        std::vector<ColumnWriterPool::Task> tasks;
+        for (size_t i = 0; i < _root_writers.size(); ++i) {
+            ColumnWriter* writer = _root_writers[i];
+            RowCursor* column_cursor = _cursors[i].get();
+            tasks.push_back([this, writer, block, column_cursor]() {
+                return _write_column(writer, block, column_cursor);
+            });
         }
-        res = col_writer->create_row_index_entry();
-        if (OLAP_UNLIKELY(res != OLAP_SUCCESS)) {
-            OLAP_LOG_WARNING("fail to create row index. [res=%d]", res);
-            return res;
+        res = _pool->run(std::move(tasks));
+    } else {
+        for (auto col_writer : _root_writers) {
+            res = _write_column(col_writer, block, cursor);
+            if (OLAP_UNLIKELY(res != OLAP_SUCCESS)) {
+                break;
+            }
         }
     }
+    if (OLAP_UNLIKELY(res != OLAP_SUCCESS)) {
+        return res;
+    }
+    // the sum does not depend on the order of the rows, so that it is the same
+    // however the rows of a version are spread over segments
+    for (uint32_t i = 0; i < block->row_block_info().row_num; ++i) {
+        block->get_row(i, cursor);
+        uint32_t hash = 0;
+        for (uint32_t cid : _checksum_columns) {
+            const Field* field = cursor->get_field_by_index(cid);
+            hash = field->hash_code(field->get_field_ptr(cursor->get_buf()), hash);
+        }
+        _row_checksum += hash;
+    }
     _row_count += block->row_block_info().row_num;
     ++_block_count;
     return res;
@@ -131,6 +197,7 @@ OLAPStatus SegmentWriter::_make_file_header(ColumnDataHeaderMessage* file_header
     file_header->set_magic_string("COLUMN DATA");
     file_header->set_version(1);
     file_header->set_num_rows_per_block(_table->num_rows_per_row_block());
+    file_header->set_row_checksum(_row_checksum);
 
     // check if has bloom filter columns
     bool has_bf_column = false;
@@ -161,6 +228,11 @@ OLAPStatus SegmentWriter::_make_file_header(ColumnDataHeaderMessage* file_header
         }
     }
 
+    res = _flush_streams();
+    if (OLAP_UNLIKELY(OLAP_SUCCESS != res)) {
+        return res;
+    }
+
     uint64_t index_length = 0;
     uint64_t data_length = 0;
 
@@ -168,14 +240,8 @@ OLAPStatus SegmentWriter::_make_file_header(ColumnDataHeaderMessage* file_header
             it != _stream_factory->streams().end(); ++it) {
         OutStream* stream = it->second;
 
-        // 如果这个流没有被终止，flush
-        if (!stream->is_suppressed()) {
-            if (OLAP_SUCCESS != (res = stream->flush())) {
-                OLAP_LOG_WARNING("fail to flush out stream. [res=%d]", res);
-                return res;
-            }
-        } else {
-            //如果被suspend，目前也就是present流，不写入信息
+        //如果被suspend，目前也就是present流，不写入信息
+        if (stream->is_suppressed()) {
             continue;
         }
 
@@ -196,11 +262,42 @@ OLAPStatus SegmentWriter::_make_file_header(ColumnDataHeaderMessage* file_header
                 << ", length=" << stream->get_stream_length();
     }
 
+    // the dictionary is complete once all streams are flushed
+    if (!_stream_factory->compress_dictionary().empty()) {
+        file_header->set_compress_dictionary(_stream_factory->compress_dictionary());
+    }
+
     file_header->set_index_length(index_length);
     file_header->set_data_length(data_length);
     return res;
 }
 
+OLAPStatus SegmentWriter::_flush_streams() {
+    std::vector<ColumnWriterPool::Task> tasks;
+    for (std::map<StreamName, OutStream*>::const_iterator it = _stream_factory->streams().begin();
+            it != _stream_factory->streams().end(); ++it) {
+        OutStream* stream = it->second;
+        // 如果这个流没有被终止，flush
+        if (!stream->is_suppressed()) {
+            tasks.push_back([stream]() {
+                OLAPStatus res = stream->flush();
+                if (OLAP_SUCCESS != res) {
+                    OLAP_LOG_WARNING("fail to flush out stream. [res=%d]", res);
+                }
+                return res;
+            });
+        }
+    }
+
+    if (_pool != NULL) {
+        return _pool->run(std::move(tasks));
+    }
+    for (auto& task : tasks) {
+        RETURN_NOT_OK(task());
+    }
+    return OLAP_SUCCESS;
+}
+
 // 之前所有的数据都缓存在内存里, 现在创建文件, 写入数据
 OLAPStatus SegmentWriter::finalize(uint32_t* segment_file_size) {
     OLAPStatus res = OLAP_SUCCESS;
@@ -18,12 +18,15 @@
 #ifndef DORIS_BE_SRC_OLAP_COLUMN_FILE_SEGMENT_WRITER_H
 #define DORIS_BE_SRC_OLAP_COLUMN_FILE_SEGMENT_WRITER_H
 
+#include <memory>
+
 #include "olap/olap_define.h"
 #include "olap/data_writer.h"
 
 namespace doris {
 
 class ColumnWriter;
+class ColumnWriterPool;
 class OutStreamFactory;
 class ColumnDataHeaderMessage;
 
@@ -43,14 +46,24 @@ public:
 private:
     // Helper: 生成最终的PB文件头
     OLAPStatus _make_file_header(ColumnDataHeaderMessage* file_header);
+    OLAPStatus _write_column(ColumnWriter* writer, RowBlock* block, RowCursor* cursor);
+    // Flushes all streams that are not suppressed
+    OLAPStatus _flush_streams();
 
     std::string _file_name;
     OLAPTablePtr _table;
     uint32_t _stream_buffer_size; // 输出缓冲区大小
     std::vector<ColumnWriter*> _root_writers;
     OutStreamFactory* _stream_factory;
+    // columns are written on the pool if not NULL, each with its own cursor
+    ColumnWriterPool* _pool;
+    std::vector<std::unique_ptr<RowCursor>> _cursors;
     uint64_t _row_count;    // 已经写入的行总数
     uint64_t _block_count;  // 已经写入的block个数
+    // columns hashed into _row_checksum, float and double are left out as in
+    // OLAPEngine::compute_checksum
+    std::vector<uint32_t> _checksum_columns;
+    uint64_t _row_checksum;
 
     // write limit
     uint32_t _write_mbytes_per_sec;
@@ -0,0 +1,437 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/simd_predicate.h"
+
+#include <immintrin.h>
+
+#include "common/compiler_util.h"
+#include "util/cpu_info.h"
+
+namespace doris {
+namespace simd_predicate {
+
+namespace {
+
+// Positions of the set bits of every 8-bit match mask, padded with zeros.
+// Appending a chunk of 8 rows to the selection vector is then one unaligned
+// 128-bit store, whatever the number of matches is.
+struct SelectionTable {
+    SelectionTable() {
+        for (int mask = 0; mask < 256; ++mask) {
+            int k = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (mask & (1 << bit)) {
+                    index[mask][k++] = bit;
+                }
+            }
+            count[mask] = k;
+            for (; k < 8; ++k) {
+                index[mask][k] = 0;
+            }
+        }
+    }
+
+    uint16_t index[256][8] __attribute__((aligned(16)));
+    uint8_t count[256];
+};
+
+static const SelectionTable s_selection_table;
+
+// Writes 'base + i' for every bit i set in 'mask' to sel[*new_size...].
+// Always stores 8 entries, so the caller must guarantee that
+// *new_size + 8 <= capacity, which holds because *new_size <= base and
+// base + 8 <= n.
+ALWAYS_INLINE inline void append_selected(uint32_t mask, uint16_t base,
+                                          uint16_t* sel, uint16_t* new_size) {
+    __m128i idx = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(s_selection_table.index[mask]));
+    idx = _mm_add_epi16(idx, _mm_set1_epi16(base));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sel + *new_size), idx);
+    *new_size += s_selection_table.count[mask];
+}
+
+ALWAYS_INLINE inline __m128i load_64(const void* p) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+}
+
+ALWAYS_INLINE inline __m128i load_128(const void* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// bit i is set iff !is_null[i], for 8 consecutive rows
+ALWAYS_INLINE inline uint32_t not_null_mask8(const bool* is_null) {
+    __m128i v = _mm_cmpeq_epi8(load_64(is_null), _mm_setzero_si128());
+    return _mm_movemask_epi8(v) & 0xFF;
+}
+
+template<CompareOp OP, class T>
+ALWAYS_INLINE inline bool scalar_compare(const T& a, const T& b) {
+    switch (OP) {
+    case EQ: return a == b;
+    case NE: return a != b;
+    case LT: return a < b;
+    case LE: return a <= b;
+    case GT: return a > b;
+    case GE: return a >= b;
+    }
+    return false;
+}
+
+// Rows that do not fill a whole chunk of 8
+template<CompareOp OP, bool HAS_NULL, class T>
+ALWAYS_INLINE inline uint16_t scalar_tail(const T* data, const bool* is_null,
+                                          uint16_t begin, uint16_t n, const T& value,
+                                          uint16_t* sel, uint16_t new_size) {
+    for (uint16_t i = begin; i < n; ++i) {
+        sel[new_size] = i;
+        if (HAS_NULL) {
+            new_size += (!is_null[i] && scalar_compare<OP>(data[i], value));
+        } else {
+            new_size += scalar_compare<OP>(data[i], value);
+        }
+    }
+    return new_size;
+}
+
+// Integer comparisons only come as == and > in SSE/AVX2, the other four
+// operators are derived from them.
+template<CompareOp OP, class Ops>
+ALWAYS_INLINE inline typename Ops::Vec int_compare(const typename Ops::Vec& a,
+                                                   const typename Ops::Vec& b) {
+    switch (OP) {
+    case EQ: return Ops::eq(a, b);
+    case NE: return Ops::negate(Ops::eq(a, b));
+    case LT: return Ops::gt(b, a);
+    case LE: return Ops::negate(Ops::gt(a, b));
+    case GT: return Ops::gt(a, b);
+    case GE: return Ops::negate(Ops::gt(b, a));
+    }
+    return Ops::eq(a, b);
+}
+
+// Same as int_compare(), a function compiled for AVX2 can only inline
+// callees built for the same target.
+template<CompareOp OP, class Ops>
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+typename Ops::Vec avx2_int_compare(const typename Ops::Vec& a, const typename Ops::Vec& b) {
+    switch (OP) {
+    case EQ: return Ops::eq(a, b);
+    case NE: return Ops::negate(Ops::eq(a, b));
+    case LT: return Ops::gt(b, a);
+    case LE: return Ops::negate(Ops::gt(a, b));
+    case GT: return Ops::gt(a, b);
+    case GE: return Ops::negate(Ops::gt(b, a));
+    }
+    return Ops::eq(a, b);
+}
+
+#define SSE_INT_OPS(NAME, BITS) \
+    struct NAME { \
+        typedef __m128i Vec; \
+        static ALWAYS_INLINE inline Vec eq(const Vec& a, const Vec& b) { \
+            return _mm_cmpeq_epi##BITS(a, b); \
+        } \
+        static ALWAYS_INLINE inline Vec gt(const Vec& a, const Vec& b) { \
+            return _mm_cmpgt_epi##BITS(a, b); \
+        } \
+        static ALWAYS_INLINE inline Vec negate(const Vec& a) { \
+            return _mm_xor_si128(a, _mm_set1_epi32(-1)); \
+        } \
+    };
+
+SSE_INT_OPS(SseEpi8, 8)
+SSE_INT_OPS(SseEpi16, 16)
+SSE_INT_OPS(SseEpi32, 32)
+SSE_INT_OPS(SseEpi64, 64)
+
+#define AVX2_INT_OPS(NAME, BITS) \
+    struct NAME { \
+        typedef __m256i Vec; \
+        static __attribute__((target("avx2"))) ALWAYS_INLINE inline \
+        Vec eq(const Vec& a, const Vec& b) { \
+            return _mm256_cmpeq_epi##BITS(a, b); \
+        } \
+        static __attribute__((target("avx2"))) ALWAYS_INLINE inline \
+        Vec gt(const Vec& a, const Vec& b) { \
+            return _mm256_cmpgt_epi##BITS(a, b); \
+        } \
+        static __attribute__((target("avx2"))) ALWAYS_INLINE inline \
+        Vec negate(const Vec& a) { \
+            return _mm256_xor_si256(a, _mm256_set1_epi32(-1)); \
+        } \
+    };
+
+AVX2_INT_OPS(Avx2Epi32, 32)
+AVX2_INT_OPS(Avx2Epi64, 64)
+
+template<CompareOp OP>
+ALWAYS_INLINE inline __m128 sse_compare_ps(const __m128& a, const __m128& b) {
+    switch (OP) {
+    case EQ: return _mm_cmpeq_ps(a, b);
+    case NE: return _mm_cmpneq_ps(a, b);
+    case LT: return _mm_cmplt_ps(a, b);
+    case LE: return _mm_cmple_ps(a, b);
+    case GT: return _mm_cmpgt_ps(a, b);
+    case GE: return _mm_cmpge_ps(a, b);
+    }
+    return _mm_cmpeq_ps(a, b);
+}
+
+template<CompareOp OP>
+ALWAYS_INLINE inline __m128d sse_compare_pd(const __m128d& a, const __m128d& b) {
+    switch (OP) {
+    case EQ: return _mm_cmpeq_pd(a, b);
+    case NE: return _mm_cmpneq_pd(a, b);
+    case LT: return _mm_cmplt_pd(a, b);
+    case LE: return _mm_cmple_pd(a, b);
+    case GT: return _mm_cmpgt_pd(a, b);
+    case GE: return _mm_cmpge_pd(a, b);
+    }
+    return _mm_cmpeq_pd(a, b);
+}
+
+// Predicates of the AVX compare instruction. NE is unordered so that NaN
+// behaves like the scalar '!=' does.
+template<CompareOp OP>
+struct AvxCmpImm {
+    static const int value =
+        OP == EQ ? _CMP_EQ_OQ :
+        OP == NE ? _CMP_NEQ_UQ :
+        OP == LT ? _CMP_LT_OQ :
+        OP == LE ? _CMP_LE_OQ :
+        OP == GT ? _CMP_GT_OQ : _CMP_GE_OQ;
+};
+
+// Match masks of 8 consecutive rows, one overload per column type.
+
+template<CompareOp OP>
+ALWAYS_INLINE inline uint32_t sse_mask8(const int8_t* p, const __m128i& v) {
+    __m128i r = int_compare<OP, SseEpi8>(load_64(p), v);
+    return _mm_movemask_epi8(r) & 0xFF;
+}
+
+template<CompareOp OP>
+ALWAYS_INLINE inline uint32_t sse_mask8(const int16_t* p, const __m128i& v) {
+    __m128i r = int_compare<OP, SseEpi16>(load_128(p), v);
+    return _mm_movemask_epi8(_mm_packs_epi16(r, _mm_setzero_si128())) & 0xFF;
+}
+
+template<CompareOp OP>
+ALWAYS_INLINE inline uint32_t sse_mask8(const int32_t* p, const __m128i& v) {
+    __m128i r0 = int_compare<OP, SseEpi32>(load_128(p), v);
+    __m128i r1 = int_compare<OP, SseEpi32>(load_128(p + 4), v);
+    return _mm_movemask_ps(_mm_castsi128_ps(r0))
+        | (_mm_movemask_ps(_mm_castsi128_ps(r1)) << 4);
+}
+
+template<CompareOp OP>
+ALWAYS_INLINE inline uint32_t sse_mask8(const int64_t* p, const __m128i& v) {
+    uint32_t mask = 0;
+    for (int k = 0; k < 4; ++k) {
+        __m128i r = int_compare<OP, SseEpi64>(load_128(p + 2 * k), v);
+        mask |= _mm_movemask_pd(_mm_castsi128_pd(r)) << (2 * k);
+    }
+    return mask;
+}
+
+template<CompareOp OP>
+ALWAYS_INLINE inline uint32_t sse_mask8(const float* p, const __m128& v) {
+    __m128 r0 = sse_compare_ps<OP>(_mm_loadu_ps(p), v);
+    __m128 r1 = sse_compare_ps<OP>(_mm_loadu_ps(p + 4), v);
+    return _mm_movemask_ps(r0) | (_mm_movemask_ps(r1) << 4);
+}
+
+template<CompareOp OP>
+ALWAYS_INLINE inline uint32_t sse_mask8(const double* p, const __m128d& v) {
+    uint32_t mask = 0;
+    for (int k = 0; k < 4; ++k) {
+        __m128d r = sse_compare_pd<OP>(_mm_loadu_pd(p + 2 * k), v);
+        mask |= _mm_movemask_pd(r) << (2 * k);
+    }
+    return mask;
+}
+
+template<CompareOp OP>
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+uint32_t avx2_mask8(const int32_t* p, const __m256i& v) {
+    __m256i r = avx2_int_compare<OP, Avx2Epi32>(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), v);
+    return _mm256_movemask_ps(_mm256_castsi256_ps(r));
+}
+
+template<CompareOp OP>
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+uint32_t avx2_mask8(const int64_t* p, const __m256i& v) {
+    __m256i r0 = avx2_int_compare<OP, Avx2Epi64>(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), v);
+    __m256i r1 = avx2_int_compare<OP, Avx2Epi64>(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 4)), v);
+    return _mm256_movemask_pd(_mm256_castsi256_pd(r0))
+        | (_mm256_movemask_pd(_mm256_castsi256_pd(r1)) << 4);
+}
+
+template<CompareOp OP>
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+uint32_t avx2_mask8(const float* p, const __m256& v) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p), v, AvxCmpImm<OP>::value));
+}
+
+template<CompareOp OP>
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+uint32_t avx2_mask8(const double* p, const __m256d& v) {
+    __m256d r0 = _mm256_cmp_pd(_mm256_loadu_pd(p), v, AvxCmpImm<OP>::value);
+    __m256d r1 = _mm256_cmp_pd(_mm256_loadu_pd(p + 4), v, AvxCmpImm<OP>::value);
+    return _mm256_movemask_pd(r0) | (_mm256_movemask_pd(r1) << 4);
+}
+
+ALWAYS_INLINE inline __m128i sse_broadcast(int8_t v) { return _mm_set1_epi8(v); }
+ALWAYS_INLINE inline __m128i sse_broadcast(int16_t v) { return _mm_set1_epi16(v); }
+ALWAYS_INLINE inline __m128i sse_broadcast(int32_t v) { return _mm_set1_epi32(v); }
+ALWAYS_INLINE inline __m128i sse_broadcast(int64_t v) { return _mm_set1_epi64x(v); }
+ALWAYS_INLINE inline __m128 sse_broadcast(float v) { return _mm_set1_ps(v); }
+ALWAYS_INLINE inline __m128d sse_broadcast(double v) { return _mm_set1_pd(v); }
+
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+__m256i avx2_broadcast(int32_t v) { return _mm256_set1_epi32(v); }
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+__m256i avx2_broadcast(int64_t v) { return _mm256_set1_epi64x(v); }
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+__m256 avx2_broadcast(float v) { return _mm256_set1_ps(v); }
+__attribute__((target("avx2"))) ALWAYS_INLINE inline
+__m256d avx2_broadcast(double v) { return _mm256_set1_pd(v); }
+
+template<class T, CompareOp OP, bool HAS_NULL>
+struct SseLoop {
+    static uint16_t run(const T* data, const bool* is_null, uint16_t n,
+                        const T& value, uint16_t* sel) {
+        auto v = sse_broadcast(value);
+        uint16_t new_size = 0;
+        uint16_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint32_t mask = sse_mask8<OP>(data + i, v);
+            if (HAS_NULL) {
+                mask &= not_null_mask8(is_null + i);
+            }
+            append_selected(mask, i, sel, &new_size);
+        }
+        return scalar_tail<OP, HAS_NULL>(data, is_null, i, n, value, sel, new_size);
+    }
+};
+
+template<class T, CompareOp OP, bool HAS_NULL>
+struct Avx2Loop {
+    static __attribute__((target("avx2")))
+    uint16_t run(const T* data, const bool* is_null, uint16_t n,
+                 const T& value, uint16_t* sel) {
+        auto v = avx2_broadcast(value);
+        uint16_t new_size = 0;
+        uint16_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint32_t mask = avx2_mask8<OP>(data + i, v);
+            if (HAS_NULL) {
+                mask &= not_null_mask8(is_null + i);
+            }
+            append_selected(mask, i, sel, &new_size);
+        }
+        return scalar_tail<OP, HAS_NULL>(data, is_null, i, n, value, sel, new_size);
+    }
+};
+
+template<template<class, CompareOp, bool> class Loop, class T, bool HAS_NULL>
+uint16_t run_op(CompareOp op, const T* data, const bool* is_null, uint16_t n,
+                const T& value, uint16_t* sel) {
+    switch (op) {
+    case EQ: return Loop<T, EQ, HAS_NULL>::run(data, is_null, n, value, sel);
+    case NE: return Loop<T, NE, HAS_NULL>::run(data, is_null, n, value, sel);
+    case LT: return Loop<T, LT, HAS_NULL>::run(data, is_null, n, value, sel);
+    case LE: return Loop<T, LE, HAS_NULL>::run(data, is_null, n, value, sel);
+    case GT: return Loop<T, GT, HAS_NULL>::run(data, is_null, n, value, sel);
+    case GE: return Loop<T, GE, HAS_NULL>::run(data, is_null, n, value, sel);
+    }
+    return 0;
+}
+
+template<template<class, CompareOp, bool> class Loop, class T>
+uint16_t run(CompareOp op, const T* data, const bool* is_null, uint16_t n,
+             const T& value, uint16_t* sel) {
+    if (is_null == nullptr) {
+        return run_op<Loop, T, false>(op, data, is_null, n, value, sel);
+    }
+    return run_op<Loop, T, true>(op, data, is_null, n, value, sel);
+}
+
+} // namespace
+
+#define SSE_COMPARE_AND_SELECT(TYPE) \
+    template<> \
+    bool compare_and_select<TYPE>(CompareOp op, const TYPE* data, const bool* is_null, \
+            uint16_t n, const TYPE& value, uint16_t* sel, uint16_t* new_size) { \
+        if (!CpuInfo::is_supported(CpuInfo::SSE4_2)) { \
+            return false; \
+        } \
+        *new_size = run<SseLoop>(op, data, is_null, n, value, sel); \
+        return true; \
+    }
+
+#define AVX2_COMPARE_AND_SELECT(TYPE) \
+    template<> \
+    bool compare_and_select<TYPE>(CompareOp op, const TYPE* data, const bool* is_null, \
+            uint16_t n, const TYPE& value, uint16_t* sel, uint16_t* new_size) { \
+        if (CpuInfo::is_supported(CpuInfo::AVX2)) { \
+            *new_size = run<Avx2Loop>(op, data, is_null, n, value, sel); \
+            return true; \
+        } \
+        if (!CpuInfo::is_supported(CpuInfo::SSE4_2)) { \
+            return false; \
+        } \
+        *new_size = run<SseLoop>(op, data, is_null, n, value, sel); \
+        return true; \
+    }
+
+// 8 rows of one and two byte columns fit in a single SSE register, AVX2
+// would not shorten those loops.
+SSE_COMPARE_AND_SELECT(int8_t)
+SSE_COMPARE_AND_SELECT(int16_t)
+AVX2_COMPARE_AND_SELECT(int32_t)
+AVX2_COMPARE_AND_SELECT(int64_t)
+AVX2_COMPARE_AND_SELECT(float)
+AVX2_COMPARE_AND_SELECT(double)
+
+bool null_select(const bool* null_array, bool is_null, uint16_t n,
+                 uint16_t* sel, uint16_t* new_size) {
+    if (!CpuInfo::is_supported(CpuInfo::SSE4_2)) {
+        return false;
+    }
+    __m128i v = _mm_set1_epi8(is_null ? 1 : 0);
+    uint16_t size = 0;
+    uint16_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(load_64(null_array + i), v)) & 0xFF;
+        append_selected(mask, i, sel, &size);
+    }
+    for (; i < n; ++i) {
+        sel[size] = i;
+        size += (null_array[i] == is_null);
+    }
+    *new_size = size;
+    return true;
+}
+
+} // namespace simd_predicate
+} // namespace doris
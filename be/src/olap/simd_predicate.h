@@ -0,0 +1,73 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_SIMD_PREDICATE_H
+#define DORIS_BE_SRC_OLAP_SIMD_PREDICATE_H
+
+#include <stdint.h>
+
+namespace doris {
+
+// SIMD kernels used by ColumnPredicate::evaluate() on dense batches
+// (selected_in_use() == false). Each kernel compares a whole ColumnVector
+// against one constant and builds the selection vector without a branch per
+// row. AVX2 is used when CpuInfo reports it, otherwise SSE4.2.
+namespace simd_predicate {
+
+enum CompareOp {
+    EQ = 0,
+    NE,
+    LT,
+    LE,
+    GT,
+    GE
+};
+
+// Returns false if no SIMD kernel exists for 'T' or the CPU lacks SSE4.2;
+// the caller should fall back to its scalar loop in that case. Otherwise
+// writes the indexes of matching rows in [0, n) to 'sel', stores their
+// count in 'new_size' and returns true. 'is_null' may be nullptr when the
+// column has no nulls; null rows never match.
+template<class T>
+inline bool compare_and_select(CompareOp op, const T* data, const bool* is_null,
+                               uint16_t n, const T& value, uint16_t* sel, uint16_t* new_size) {
+    return false;
+}
+
+template<> bool compare_and_select<int8_t>(CompareOp op, const int8_t* data, const bool* is_null,
+        uint16_t n, const int8_t& value, uint16_t* sel, uint16_t* new_size);
+template<> bool compare_and_select<int16_t>(CompareOp op, const int16_t* data, const bool* is_null,
+        uint16_t n, const int16_t& value, uint16_t* sel, uint16_t* new_size);
+template<> bool compare_and_select<int32_t>(CompareOp op, const int32_t* data, const bool* is_null,
+        uint16_t n, const int32_t& value, uint16_t* sel, uint16_t* new_size);
+template<> bool compare_and_select<int64_t>(CompareOp op, const int64_t* data, const bool* is_null,
+        uint16_t n, const int64_t& value, uint16_t* sel, uint16_t* new_size);
+template<> bool compare_and_select<float>(CompareOp op, const float* data, const bool* is_null,
+        uint16_t n, const float& value, uint16_t* sel, uint16_t* new_size);
+template<> bool compare_and_select<double>(CompareOp op, const double* data, const bool* is_null,
+        uint16_t n, const double& value, uint16_t* sel, uint16_t* new_size);
+
+// Select rows whose null flag equals 'is_null'. Same contract as above.
+bool null_select(const bool* null_array, bool is_null, uint16_t n,
+                 uint16_t* sel, uint16_t* new_size);
+
+} // namespace simd_predicate
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_SIMD_PREDICATE_H
@@ -0,0 +1,221 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/sorted_run_file.h"
+
+#include <fcntl.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "util/slice.h"
+
+namespace doris {
+
+static bool is_slice_type(FieldType type) {
+    return type == OLAP_FIELD_TYPE_CHAR || type == OLAP_FIELD_TYPE_VARCHAR
+            || type == OLAP_FIELD_TYPE_HLL;
+}
+
+static std::vector<uint32_t> all_columns(const std::vector<FieldInfo>& tablet_schema) {
+    std::vector<uint32_t> columns(tablet_schema.size());
+    for (uint32_t cid = 0; cid < columns.size(); ++cid) {
+        columns[cid] = cid;
+    }
+    return columns;
+}
+
+SortedRunWriter::SortedRunWriter(const std::vector<FieldInfo>& tablet_schema,
+                                 size_t buffer_size) :
+        SortedRunWriter(tablet_schema, all_columns(tablet_schema), buffer_size) {}
+
+SortedRunWriter::SortedRunWriter(const std::vector<FieldInfo>& tablet_schema,
+                                 const std::vector<uint32_t>& columns,
+                                 size_t buffer_size) :
+        _tablet_schema(tablet_schema),
+        _columns(columns),
+        _buffer_size(buffer_size),
+        _buf_len(0),
+        _num_rows(0) {}
+
+OLAPStatus SortedRunWriter::open(const std::string& file_name) {
+    _buf.resize(_buffer_size);
+    _buf_len = 0;
+    _num_rows = 0;
+    return _file.open_with_mode(file_name, O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+}
+
+OLAPStatus SortedRunWriter::append(const RowCursor& row) {
+    uint32_t row_size = sizeof(uint32_t);
+    for (uint32_t cid : _columns) {
+        row_size += sizeof(bool);
+        if (row.is_null(cid)) {
+            continue;
+        }
+        if (is_slice_type(_tablet_schema[cid].type)) {
+            const Slice* slice = reinterpret_cast<const Slice*>(row.get_field_content_ptr(cid));
+            row_size += sizeof(uint32_t) + slice->size;
+        } else {
+            row_size += row.get_field_by_index(cid)->size();
+        }
+    }
+
+    if (_buf_len + row_size > _buf.size()) {
+        RETURN_NOT_OK(_flush());
+        if (row_size > _buf.size()) {
+            _buf.resize(row_size);
+        }
+    }
+
+    char* ptr = _buf.data() + _buf_len;
+    memcpy(ptr, &row_size, sizeof(row_size));
+    ptr += sizeof(row_size);
+    for (uint32_t cid : _columns) {
+        bool is_null = row.is_null(cid);
+        *ptr++ = is_null;
+        if (is_null) {
+            continue;
+        }
+        const char* content = row.get_field_content_ptr(cid);
+        if (is_slice_type(_tablet_schema[cid].type)) {
+            const Slice* slice = reinterpret_cast<const Slice*>(content);
+            uint32_t size = slice->size;
+            memcpy(ptr, &size, sizeof(size));
+            memcpy(ptr + sizeof(size), slice->data, size);
+            ptr += sizeof(size) + size;
+        } else {
+            size_t size = row.get_field_by_index(cid)->size();
+            memcpy(ptr, content, size);
+            ptr += size;
+        }
+    }
+    _buf_len += row_size;
+    ++_num_rows;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SortedRunWriter::close() {
+    RETURN_NOT_OK(_flush());
+    // the buffer is not needed until the run is read
+    std::vector<char>().swap(_buf);
+    return _file.close();
+}
+
+OLAPStatus SortedRunWriter::_flush() {
+    if (_buf_len > 0) {
+        RETURN_NOT_OK(_file.write(_buf.data(), _buf_len));
+        _buf_len = 0;
+    }
+    return OLAP_SUCCESS;
+}
+
+SortedRunReader::SortedRunReader(const std::vector<FieldInfo>& tablet_schema,
+                                 size_t buffer_size) :
+        SortedRunReader(tablet_schema, all_columns(tablet_schema), buffer_size) {}
+
+SortedRunReader::SortedRunReader(const std::vector<FieldInfo>& tablet_schema,
+                                 const std::vector<uint32_t>& columns,
+                                 size_t buffer_size) :
+        _tablet_schema(tablet_schema),
+        _columns(columns),
+        _buffer_size(buffer_size),
+        _buf_pos(0),
+        _buf_len(0),
+        _file_offset(0),
+        _file_length(0),
+        _eof(false) {}
+
+OLAPStatus SortedRunReader::open(const std::string& file_name) {
+    RETURN_NOT_OK(_row.init(_tablet_schema, _columns));
+    RETURN_NOT_OK(_file.open_with_mode(file_name, O_RDONLY, S_IRUSR | S_IWUSR));
+    off_t length = _file.length();
+    if (length < 0) {
+        OLAP_LOG_WARNING("fail to get length of sorted run. [file='%s']", file_name.c_str());
+        return OLAP_ERR_IO_ERROR;
+    }
+    _buf.resize(_buffer_size);
+    _buf_pos = 0;
+    _buf_len = 0;
+    _file_offset = 0;
+    _file_length = length;
+    _eof = false;
+    return next();
+}
+
+OLAPStatus SortedRunReader::next() {
+    if (_buf_pos == _buf_len && _file_offset == _file_length) {
+        _eof = true;
+        return OLAP_SUCCESS;
+    }
+
+    uint32_t row_size = 0;
+    RETURN_NOT_OK(_fill(sizeof(row_size)));
+    memcpy(&row_size, _buf.data() + _buf_pos, sizeof(row_size));
+    RETURN_NOT_OK(_fill(row_size));
+
+    const char* ptr = _buf.data() + _buf_pos + sizeof(row_size);
+    for (uint32_t cid : _columns) {
+        bool is_null = *ptr++;
+        if (is_null) {
+            _row.set_null(cid);
+            continue;
+        }
+        _row.set_not_null(cid);
+        char* content = _row.get_field_content_ptr(cid);
+        if (is_slice_type(_tablet_schema[cid].type)) {
+            uint32_t size = 0;
+            memcpy(&size, ptr, sizeof(size));
+            Slice* slice = reinterpret_cast<Slice*>(content);
+            slice->data = const_cast<char*>(ptr + sizeof(size));
+            slice->size = size;
+            ptr += sizeof(size) + size;
+        } else {
+            size_t size = _row.get_field_by_index(cid)->size();
+            memcpy(content, ptr, size);
+            ptr += size;
+        }
+    }
+    _buf_pos += row_size;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus SortedRunReader::_fill(size_t size) {
+    size_t remain = _buf_len - _buf_pos;
+    if (remain >= size) {
+        return OLAP_SUCCESS;
+    }
+
+    // the rest of the buffer is moved to the front, rows before it are done
+    memmove(_buf.data(), _buf.data() + _buf_pos, remain);
+    _buf_pos = 0;
+    _buf_len = remain;
+    if (size > _buf.size()) {
+        _buf.resize(size);
+    }
+    size_t length = std::min(_buf.size() - _buf_len, _file_length - _file_offset);
+    if (_buf_len + length < size) {
+        OLAP_LOG_WARNING("sorted run ends early. [file='%s' offset=%lu]",
+                         _file.file_name().c_str(), _file_offset);
+        return OLAP_ERR_IO_ERROR;
+    }
+    RETURN_NOT_OK(_file.pread(_buf.data() + _buf_len, length, _file_offset));
+    _file_offset += length;
+    _buf_len += length;
+    return OLAP_SUCCESS;
+}
+
+}  // namespace doris
@@ -0,0 +1,105 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_SORTED_RUN_FILE_H
+#define DORIS_BE_SRC_OLAP_SORTED_RUN_FILE_H
+
+#include <string>
+#include <vector>
+
+#include "olap/field.h"
+#include "olap/file_helper.h"
+#include "olap/olap_define.h"
+#include "olap/row_cursor.h"
+
+namespace doris {
+
+// A run of rows spilled by an external sort, kept in the order they are
+// appended. Files are written and read strictly sequentially through a large
+// buffer, so a merge of many runs reads every one of them at disk speed.
+//
+// A row is its length in 4 bytes followed by its columns, a column is the
+// null flag and the value, values of string types are 4 bytes of length and
+// the content. Runs of only some columns of the schema keep just those.
+class SortedRunWriter {
+public:
+    SortedRunWriter(const std::vector<FieldInfo>& tablet_schema, size_t buffer_size);
+    SortedRunWriter(const std::vector<FieldInfo>& tablet_schema,
+                    const std::vector<uint32_t>& columns, size_t buffer_size);
+    ~SortedRunWriter() {}
+
+    OLAPStatus open(const std::string& file_name);
+    OLAPStatus append(const RowCursor& row);
+    // writes out the buffered rows and closes the file
+    OLAPStatus close();
+
+    uint64_t num_rows() const { return _num_rows; }
+
+private:
+    OLAPStatus _flush();
+
+    const std::vector<FieldInfo>& _tablet_schema;
+    std::vector<uint32_t> _columns;
+    size_t _buffer_size;
+    std::vector<char> _buf;
+    size_t _buf_len;
+    uint64_t _num_rows;
+    FileHandler _file;
+
+    DISALLOW_COPY_AND_ASSIGN(SortedRunWriter);
+};
+
+class SortedRunReader {
+public:
+    SortedRunReader(const std::vector<FieldInfo>& tablet_schema, size_t buffer_size);
+    SortedRunReader(const std::vector<FieldInfo>& tablet_schema,
+                    const std::vector<uint32_t>& columns, size_t buffer_size);
+    ~SortedRunReader() {}
+
+    // opens the file and reads the first row
+    OLAPStatus open(const std::string& file_name);
+
+    bool eof() const { return _eof; }
+
+    // The current row. Strings of the row point into the read buffer, so the
+    // row is valid until next() is called.
+    const RowCursor* current() const { return &_row; }
+
+    OLAPStatus next();
+
+private:
+    // makes sure 'size' bytes from _buf_pos are in the buffer
+    OLAPStatus _fill(size_t size);
+
+    const std::vector<FieldInfo>& _tablet_schema;
+    std::vector<uint32_t> _columns;
+    size_t _buffer_size;
+    std::vector<char> _buf;
+    size_t _buf_pos;
+    size_t _buf_len;
+    size_t _file_offset;
+    size_t _file_length;
+    RowCursor _row;
+    FileHandler _file;
+    bool _eof;
+
+    DISALLOW_COPY_AND_ASSIGN(SortedRunReader);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_SORTED_RUN_FILE_H
@@ -26,6 +26,8 @@
 #include <sys/statfs.h>
 #include <utime.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <sstream>
 
@@ -36,12 +38,17 @@
 #include <boost/filesystem.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
 
+#include "common/config.h"
 #include "olap/file_helper.h"
+#include "olap/memtable_flush_executor.h"
 #include "olap/olap_define.h"
+#include "olap/read_ahead.h"
 #include "olap/utils.h" // for check_dir_existed
 #include "service/backend_options.h"
+#include "util/doris_metrics.h"
 #include "util/file_utils.h"
 #include "util/string_util.h"
+#include "util/thread_pool.hpp"
 #include "olap/olap_header_manager.h"
 
 namespace doris {
@@ -60,7 +67,8 @@ OlapStore::OlapStore(const std::string& path, int64_t capacity_bytes)
         _to_be_deleted(false),
         _test_file_read_buf(nullptr),
         _test_file_write_buf(nullptr),
-        _meta((nullptr)) {
+        _meta((nullptr)),
+        _use_io_uring(false) {
 }
 
 OlapStore::~OlapStore() {
@@ -97,6 +105,34 @@ Status OlapStore::load() {
     RETURN_IF_ERROR(_init_file_system());
     RETURN_IF_ERROR(_init_meta());
 
+    std::vector<std::string> io_uring_media;
+    boost::split(io_uring_media, config::storage_io_uring_media, boost::is_any_of(","));
+    for (auto& medium : io_uring_media) {
+        boost::trim(medium);
+        if (boost::iequals(medium, is_ssd_disk() ? "SSD" : "HDD")) {
+            _use_io_uring = true;
+        }
+    }
+
+    if (!_use_io_uring && !is_ssd_disk() && config::storage_read_ahead_chunks > 0) {
+        _read_ahead_queue.reset(new ReadAheadQueue(
+                config::storage_read_ahead_threads_per_store,
+                config::storage_read_ahead_queue_depth_per_store));
+    }
+
+    if (config::memtable_flush_threads_per_store > 0) {
+        _flush_executor.reset(new MemTableFlushExecutor(
+                config::memtable_flush_threads_per_store,
+                std::max(config::memtable_flush_queue_size_per_store, 1)));
+    }
+
+    if (config::schema_change_threads_per_store > 1) {
+        // offering the versions of a job blocks while the queue is full
+        _schema_change_pool.reset(new ThreadPool(
+                config::schema_change_threads_per_store,
+                config::schema_change_threads_per_store * 16));
+    }
+
     _is_used = true;
     return Status::OK;
 }
@@ -586,16 +622,34 @@ OLAPStatus OlapStore::_load_table_from_header(OLAPEngine* engine, TTabletId tabl
 }
 
 OLAPStatus OlapStore::load_tables(OLAPEngine* engine) {
-    auto load_table_func = [this, engine](long tablet_id,
+    // headers are read from the meta while the tablets of the ones read
+    // before are created by the pool, whose queue bounds the headers held
+    int num_threads = std::max(config::load_tablet_threads_per_store, 1);
+    ThreadPool pool(num_threads, num_threads * 16);
+    std::atomic<int64_t> num_loaded(0);
+    std::atomic<int64_t> num_failed(0);
+    auto load_table_func = [this, engine, &pool, &num_loaded, &num_failed](long tablet_id,
             long schema_hash, const std::string& value) -> bool {
-        OLAPStatus status = _load_table_from_header(engine, tablet_id, schema_hash, value);
-        if (status != OLAP_SUCCESS) {
-            LOG(WARNING) << "load table from header failed. status:" << status
-                << "tablet=" << tablet_id << "." << schema_hash;
-        };
+        pool.offer([this, engine, tablet_id, schema_hash, value, &num_loaded, &num_failed] {
+            OLAPStatus status = _load_table_from_header(engine, tablet_id, schema_hash, value);
+            if (status != OLAP_SUCCESS) {
+                LOG(WARNING) << "load table from header failed. status:" << status
+                    << "tablet=" << tablet_id << "." << schema_hash;
+                ++num_failed;
+                DorisMetrics::tablets_load_failed_total.increment(1);
+                return;
+            }
+            DorisMetrics::tablets_loaded_total.increment(1);
+            if (++num_loaded % 10000 == 0) {
+                LOG(INFO) << "loaded " << num_loaded << " tablets from store " << path();
+            }
+        });
         return true;
     };
     OLAPStatus status = OlapHeaderManager::traverse_headers(_meta, load_table_func);
+    pool.drain_and_shutdown();
+    LOG(INFO) << "finish to load tablets from store " << path()
+        << ", loaded=" << num_loaded << ", failed=" << num_failed;
     return status;
 }
 
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <set>
 #include <string>
 #include <mutex>
@@ -31,6 +32,9 @@ namespace doris {
 
 class OLAPRootPath;
 class OLAPEngine;
+class MemTableFlushExecutor;
+class ReadAheadQueue;
+class ThreadPool;
 
 // A OlapStore used to manange data in same path.
 // Now, After OlapStore was created, it will never be deleted for easy implementation.
@@ -62,6 +66,16 @@ public:
 
     OlapMeta* get_meta();
 
+    // nullptr if streams of this store are not read ahead
+    ReadAheadQueue* read_ahead_queue() const { return _read_ahead_queue.get(); }
+    // nullptr if memtables of this store are flushed by the writing thread
+    MemTableFlushExecutor* flush_executor() const { return _flush_executor.get(); }
+    // threads converting the versions of the tablets altered on this store,
+    // nullptr if each alter job converts its versions by itself
+    ThreadPool* schema_change_pool() const { return _schema_change_pool.get(); }
+    // true if row blocks of this store are read with batched io_uring submissions
+    bool use_io_uring() const { return _use_io_uring; }
+
     bool is_ssd_disk() const {
         return _storage_medium == TStorageMedium::SSD;
     }
@@ -132,6 +146,10 @@ private:
     char* _test_file_read_buf;
     char* _test_file_write_buf;
     OlapMeta* _meta;
+    std::unique_ptr<ReadAheadQueue> _read_ahead_queue;
+    std::unique_ptr<MemTableFlushExecutor> _flush_executor;
+    std::unique_ptr<ThreadPool> _schema_change_pool;
+    bool _use_io_uring;
 };
 
 }
@@ -63,7 +63,7 @@ void ColumnStatistics::reset() {
     }
 }
 
-void ColumnStatistics::merge(ColumnStatistics* other) {
+void ColumnStatistics::merge(const ColumnStatistics* other) {
     if (_ignored || other->ignored()) {
         return;
     }
@@ -66,7 +66,7 @@ public:
         }
     }
     // 合并，将另一个统计信息和入当前统计中
-    void merge(ColumnStatistics* other);
+    void merge(const ColumnStatistics* other);
     // 返回最大最小值“输出时”占用的内存，而“不是?
     // ??当前结构占用的内存大小
     size_t size() const;
@@ -0,0 +1,61 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/tablet_heat.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/config.h"
+#include "util/time.h"
+
+namespace doris {
+
+TabletHeat::TabletHeat() : _last_decay_ms(UnixMillis()) {
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        _sums[i] = 0;
+    }
+}
+
+void TabletHeat::get(int64_t now_ms, TTabletHeat* heat) {
+    std::lock_guard<std::mutex> l(_lock);
+    if (now_ms > _last_decay_ms) {
+        double half_life_ms = std::max(config::tablet_heat_half_life_sec, 1) * 1000.0;
+        double factor = std::exp2(-(now_ms - _last_decay_ms) / half_life_ms);
+        for (int i = 0; i < NUM_COUNTERS; ++i) {
+            _sums[i] *= factor;
+        }
+        _last_decay_ms = now_ms;
+    }
+    // what was added since the last read counts as happened now
+    _sums[ROWS_SCANNED] += _pending_rows_scanned.exchange(0, std::memory_order_relaxed);
+    _sums[BYTES_SCANNED] += _pending_bytes_scanned.exchange(0, std::memory_order_relaxed);
+    _sums[SCAN_COUNT] += _pending_scan_count.exchange(0, std::memory_order_relaxed);
+    _sums[SCAN_TIME_US] += _pending_scan_time_us.exchange(0, std::memory_order_relaxed);
+    _sums[ROWS_WRITTEN] += _pending_rows_written.exchange(0, std::memory_order_relaxed);
+    _sums[BYTES_WRITTEN] += _pending_bytes_written.exchange(0, std::memory_order_relaxed);
+
+    heat->__set_rows_scanned(std::llround(_sums[ROWS_SCANNED]));
+    heat->__set_bytes_scanned(std::llround(_sums[BYTES_SCANNED]));
+    heat->__set_scan_count(std::llround(_sums[SCAN_COUNT]));
+    heat->__set_scan_time_us(std::llround(_sums[SCAN_TIME_US]));
+    heat->__set_rows_written(std::llround(_sums[ROWS_WRITTEN]));
+    heat->__set_bytes_written(std::llround(_sums[BYTES_WRITTEN]));
+}
+
+}  // namespace doris
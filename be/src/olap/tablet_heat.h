@@ -0,0 +1,79 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_TABLET_HEAT_H
+#define DORIS_BE_SRC_OLAP_TABLET_HEAT_H
+
+#include <atomic>
+#include <mutex>
+
+#include "gen_cpp/MasterService_types.h"
+
+namespace doris {
+
+// The reads and writes of a tablet, kept as sums which lose half their weight
+// every config::tablet_heat_half_life_sec, so the FE can tell the hot tablets
+// from the big ones. A scan or a load only adds to atomic pending values once
+// when it finishes; they are folded into the decayed sums when the heat is read.
+class TabletHeat {
+public:
+    TabletHeat();
+
+    // a query scan of the tablet has finished
+    void add_scan(int64_t rows, int64_t bytes, int64_t time_us) {
+        _pending_rows_scanned.fetch_add(rows, std::memory_order_relaxed);
+        _pending_bytes_scanned.fetch_add(bytes, std::memory_order_relaxed);
+        _pending_scan_count.fetch_add(1, std::memory_order_relaxed);
+        _pending_scan_time_us.fetch_add(time_us, std::memory_order_relaxed);
+    }
+
+    // a load has written a delta of the tablet
+    void add_write(int64_t rows, int64_t bytes) {
+        _pending_rows_written.fetch_add(rows, std::memory_order_relaxed);
+        _pending_bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    // decays the sums to now_ms and returns them
+    void get(int64_t now_ms, TTabletHeat* heat);
+
+private:
+    enum Counter {
+        ROWS_SCANNED = 0,
+        BYTES_SCANNED,
+        SCAN_COUNT,
+        SCAN_TIME_US,
+        ROWS_WRITTEN,
+        BYTES_WRITTEN,
+        NUM_COUNTERS
+    };
+
+    std::atomic<int64_t> _pending_rows_scanned{0};
+    std::atomic<int64_t> _pending_bytes_scanned{0};
+    std::atomic<int64_t> _pending_scan_count{0};
+    std::atomic<int64_t> _pending_scan_time_us{0};
+    std::atomic<int64_t> _pending_rows_written{0};
+    std::atomic<int64_t> _pending_bytes_written{0};
+
+    std::mutex _lock;
+    int64_t _last_decay_ms;
+    double _sums[NUM_COUNTERS];
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_TABLET_HEAT_H
@@ -38,6 +38,8 @@
 #include "olap/new_status.h"
 #include "olap/olap_common.h"
 #include "olap/olap_define.h"
+#include "util/lock_stats.h"
+#include "util/time.h"
 
 using std::string;
 using std::set;
@@ -1148,7 +1150,17 @@ RWMutex::~RWMutex() {
 }
 
 OLAPStatus RWMutex::rdlock() {
-    PTHREAD_RWLOCK_RDLOCK_WITH_LOG(&_lock);
+    if (_stats == nullptr) {
+        PTHREAD_RWLOCK_RDLOCK_WITH_LOG(&_lock);
+        return OLAP_SUCCESS;
+    }
+    if (0 != pthread_rwlock_tryrdlock(&_lock)) {
+        int64_t start = MonotonicNanos();
+        PTHREAD_RWLOCK_RDLOCK_WITH_LOG(&_lock);
+        _stats->on_contended(MonotonicNanos() - start);
+    }
+    // readers share the lock, its hold time is not measured
+    _stats->on_acquired();
     return OLAP_SUCCESS;
 }
 
@@ -1157,6 +1169,9 @@ OLAPStatus RWMutex::tryrdlock() {
         VLOG(3) << "failed to got the rwlock rdlock. err=" << strerror(errno);
         return OLAP_ERR_RWLOCK_ERROR;
     }
+    if (_stats != nullptr) {
+        _stats->on_acquired();
+    }
 
     return OLAP_SUCCESS;
 }
@@ -1166,16 +1181,33 @@ OLAPStatus RWMutex::trywrlock() {
         VLOG(3) << "failed to got the rwlock rdlock. err=" << strerror(errno);
         return OLAP_ERR_RWLOCK_ERROR;
     }
+    if (_stats != nullptr) {
+        _write_acquired_ns = _stats->on_acquired();
+    }
 
     return OLAP_SUCCESS;
 }
 
 OLAPStatus RWMutex::wrlock() {
-    PTHREAD_RWLOCK_WRLOCK_WITH_LOG(&_lock);
+    if (_stats == nullptr) {
+        PTHREAD_RWLOCK_WRLOCK_WITH_LOG(&_lock);
+        return OLAP_SUCCESS;
+    }
+    if (0 != pthread_rwlock_trywrlock(&_lock)) {
+        int64_t start = MonotonicNanos();
+        PTHREAD_RWLOCK_WRLOCK_WITH_LOG(&_lock);
+        _stats->on_contended(MonotonicNanos() - start);
+    }
+    _write_acquired_ns = _stats->on_acquired();
     return OLAP_SUCCESS;
 }
 
 OLAPStatus RWMutex::unlock() {
+    if (_stats != nullptr && _write_acquired_ns != 0) {
+        // only the writer sets it, readers always see 0
+        _stats->on_released(_write_acquired_ns);
+        _write_acquired_ns = 0;
+    }
     PTHREAD_RWLOCK_UNLOCK_WITH_LOG(&_lock);
     return OLAP_SUCCESS;
 }
@@ -1560,12 +1592,13 @@ OLAPStatus remove_unused_files(const string& schema_hash_root,
     different_set.erase(header);
     // 遍历所有没有使用的文件
     for (set<string>::const_iterator it = different_set.begin(); it != different_set.end(); ++it) {
-        if (ENDSWITH(*it, ".hdr") || ENDSWITH(*it, ".idx") || ENDSWITH(*it, ".dat")) {
+        if (ENDSWITH(*it, ".hdr") || ENDSWITH(*it, ".idx") || ENDSWITH(*it, ".dat")
+                || ENDSWITH(*it, ".pack")) {
             LOG(INFO) << "delete unused file. [file='" << schema_hash_root + "/" + *it << "']";
             move_to_trash(boost::filesystem::path(schema_hash_root),
                           boost::filesystem::path(schema_hash_root + "/" + *it));
         } else {
-            // 除了.hdr, .idx, .dat其他文件均忽略
+            // 除了.hdr, .idx, .dat, .pack其他文件均忽略
             continue;
         }
     }
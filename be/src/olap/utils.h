@@ -196,6 +196,8 @@ OLAPStatus gen_timestamp_string(std::string* out_string);
 OLAPStatus move_to_trash(const boost::filesystem::path& schema_hash_root,
                          const boost::filesystem::path& file_path);
 
+class LockStats;
+
 // encapsulation of pthread_mutex to lock the critical sources.
 class Mutex {
 public:
@@ -269,8 +271,16 @@ public:
     // unlock
     OLAPStatus unlock();
 
+    // record the contention of this lock in 'stats', before it is used
+    void set_stats(LockStats* stats) {
+        _stats = stats;
+    }
+
 private:
     pthread_rwlock_t _lock;
+    LockStats* _stats = nullptr;
+    // when the write lock was acquired, only set while it is held
+    int64_t _write_acquired_ns = 0;
 };
 
 //
@@ -0,0 +1,182 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/xor_float_reader.h"
+
+#include <cstring>
+
+namespace doris {
+
+namespace {
+
+class BitReader {
+public:
+    BitReader(const uint64_t* words, uint64_t num_bits) :
+            _words(words), _num_bits(num_bits), _pos(0) {}
+
+    // false if the mini block has less than 'num_bits' bits left
+    bool get(uint32_t num_bits, uint64_t* value) {
+        if (_pos + num_bits > _num_bits) {
+            return false;
+        }
+        uint32_t offset = _pos & 63;
+        const uint64_t* word = _words + _pos / 64;
+        uint64_t v = *word >> offset;
+        if (offset + num_bits > 64) {
+            v |= word[1] << (64 - offset);
+        }
+        *value = num_bits == 64 ? v : v & ((1ULL << num_bits) - 1);
+        _pos += num_bits;
+        return true;
+    }
+
+private:
+    const uint64_t* _words;
+    uint64_t _num_bits;
+    uint64_t _pos;
+};
+
+}  // namespace
+
+XorFloatReader::XorFloatReader(ReadOnlyFileStream* input) :
+        _input(input),
+        _num_literals(0),
+        _used(0) {}
+
+OLAPStatus XorFloatReader::_read_values() {
+    _num_literals = 0;
+    _used = 0;
+
+    uint8_t head[3];
+    OLAPStatus res = OLAP_SUCCESS;
+    for (int i = 0; i < 3; ++i) {
+        if (OLAP_SUCCESS != (res = _input->read(reinterpret_cast<char*>(head + i)))) {
+            return res;
+        }
+    }
+    uint32_t count = static_cast<uint32_t>(head[0]) + 1;
+    uint64_t num_bytes = head[1] | (static_cast<uint64_t>(head[2]) << 8);
+    if (count > XorFloatWriter::MINI_BLOCK_SIZE
+            || num_bytes > XorFloatWriter::MAX_BLOCK_WORDS * sizeof(uint64_t)) {
+        OLAP_LOG_WARNING("invalid mini block header. [count=%u bytes=%lu]", count, num_bytes);
+        return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+    }
+
+    memset(_words, 0, sizeof(_words));
+    uint64_t read_bytes = num_bytes;
+    res = _input->read(reinterpret_cast<char*>(_words), &read_bytes);
+    if (OLAP_SUCCESS != res || read_bytes != num_bytes) {
+        OLAP_LOG_WARNING("fail to read xor'ed values. [expect=%lu read=%lu]",
+                         num_bytes, read_bytes);
+        return OLAP_SUCCESS != res ? res : OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+    }
+
+    BitReader bits(_words, num_bytes * 8);
+    uint64_t value = 0;
+    if (!bits.get(64, &value)) {
+        OLAP_LOG_WARNING("mini block is truncated.");
+        return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+    }
+    _literals[0] = value;
+    uint64_t window_leading = 0;
+    uint64_t window_trailing = 0;
+    bool has_window = false;
+    for (uint32_t i = 1; i < count; ++i) {
+        uint64_t control = 0;
+        if (!bits.get(1, &control)) {
+            OLAP_LOG_WARNING("mini block is truncated.");
+            return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+        }
+        if (control == 0) {
+            _literals[i] = value;
+            continue;
+        }
+        if (!bits.get(1, &control)) {
+            OLAP_LOG_WARNING("mini block is truncated.");
+            return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+        }
+        if (control == 1) {
+            uint64_t significant = 0;
+            if (!bits.get(5, &window_leading) || !bits.get(6, &significant)) {
+                OLAP_LOG_WARNING("mini block is truncated.");
+                return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+            }
+            significant += 1;
+            if (window_leading + significant > 64) {
+                OLAP_LOG_WARNING("invalid xor window. [leading=%lu significant=%lu]",
+                                 window_leading, significant);
+                return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+            }
+            window_trailing = 64 - window_leading - significant;
+            has_window = true;
+        } else if (!has_window) {
+            OLAP_LOG_WARNING("xor window is used before it is set.");
+            return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+        }
+        uint64_t x = 0;
+        if (!bits.get(64 - window_leading - window_trailing, &x)) {
+            OLAP_LOG_WARNING("mini block is truncated.");
+            return OLAP_ERR_COLUMN_DATA_READ_VAR_INT;
+        }
+        value ^= x << window_trailing;
+        _literals[i] = value;
+    }
+    _num_literals = count;
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus XorFloatReader::seek(PositionProvider* position) {
+    OLAPStatus res = OLAP_SUCCESS;
+    if (OLAP_SUCCESS != (res = _input->seek(position))) {
+        return res;
+    }
+
+    // values written before a position are all in the mini block after it
+    uint32_t consumed = static_cast<uint32_t>(position->get_next());
+    _num_literals = 0;
+    _used = 0;
+    if (consumed != 0) {
+        if (OLAP_SUCCESS != (res = _read_values())) {
+            return res;
+        }
+        _used = consumed;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus XorFloatReader::skip(uint64_t num_values) {
+    OLAPStatus res = OLAP_SUCCESS;
+
+    while (num_values > 0) {
+        if (_used == _num_literals) {
+            res = _read_values();
+            if (OLAP_SUCCESS != res) {
+                OLAP_LOG_WARNING("fail to read values.[res=%d]", res);
+                return res;
+            }
+        }
+
+        uint64_t consume = std::min(num_values, static_cast<uint64_t>(_num_literals - _used));
+        _used += consume;
+        num_values -= consume;
+    }
+
+    return res;
+}
+
+}  // namespace doris
@@ -0,0 +1,97 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_XOR_FLOAT_READER_H
+#define DORIS_BE_SRC_OLAP_XOR_FLOAT_READER_H
+
+#include <algorithm>
+
+#include "olap/file_stream.h"
+#include "olap/olap_define.h"
+#include "olap/stream_index_reader.h"
+#include "olap/xor_float_writer.h"
+
+namespace doris {
+
+class ReadOnlyFileStream;
+class PositionProvider;
+
+// Reads the mini blocks of XorFloatWriter, a whole mini block at a time.
+class XorFloatReader {
+public:
+    explicit XorFloatReader(ReadOnlyFileStream* input);
+    ~XorFloatReader() {}
+
+    inline bool has_next() const {
+        return _used != _num_literals || !_input->eof();
+    }
+
+    // 获取下一条数据, 如果没有更多的数据了, 返回OLAP_ERR_DATA_EOF
+    template<class T>
+    inline OLAPStatus next(T* value) {
+        if (OLAP_UNLIKELY(_used == _num_literals)) {
+            OLAPStatus res = _read_values();
+            if (OLAP_SUCCESS != res) {
+                return res;
+            }
+        }
+        XorFloatWriter::from_bits(_literals[_used++], value);
+        return OLAP_SUCCESS;
+    }
+
+    // Reads 'count' values into 'values', copying whole mini blocks
+    template<class T>
+    OLAPStatus next_batch(T* values, uint32_t count) {
+        while (count > 0) {
+            if (_used == _num_literals) {
+                OLAPStatus res = _read_values();
+                if (OLAP_SUCCESS != res) {
+                    return res;
+                }
+            }
+            uint32_t n = std::min(count, _num_literals - _used);
+            const uint64_t* src = _literals + _used;
+            for (uint32_t i = 0; i < n; ++i) {
+                XorFloatWriter::from_bits(src[i], values + i);
+            }
+            values += n;
+            count -= n;
+            _used += n;
+        }
+        return OLAP_SUCCESS;
+    }
+
+    OLAPStatus seek(PositionProvider* position);
+    OLAPStatus skip(uint64_t num_values);
+
+private:
+    OLAPStatus _read_values();
+
+    ReadOnlyFileStream* _input;
+    uint64_t _literals[XorFloatWriter::MINI_BLOCK_SIZE];
+    // bits of a mini block, with a word of room for reads past its end
+    uint64_t _words[XorFloatWriter::MAX_BLOCK_WORDS + 1];
+    uint32_t _num_literals;
+    uint32_t _used;
+
+    DISALLOW_COPY_AND_ASSIGN(XorFloatReader);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_XOR_FLOAT_READER_H
@@ -0,0 +1,129 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/xor_float_writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "olap/out_stream.h"
+
+namespace doris {
+
+namespace {
+
+class BitWriter {
+public:
+    explicit BitWriter(uint64_t* words) : _words(words), _num_bits(0) {}
+
+    // 'value' has no bits set above the lowest 'num_bits'
+    void put(uint64_t value, uint32_t num_bits) {
+        uint32_t offset = _num_bits & 63;
+        uint64_t* word = _words + _num_bits / 64;
+        *word |= value << offset;
+        if (offset + num_bits > 64) {
+            word[1] |= value >> (64 - offset);
+        }
+        _num_bits += num_bits;
+    }
+
+    uint64_t num_bytes() const { return (_num_bits + 7) / 8; }
+
+private:
+    uint64_t* _words;
+    uint64_t _num_bits;
+};
+
+}  // namespace
+
+XorFloatWriter::XorFloatWriter(OutStream* output) :
+        _output(output),
+        _num_literals(0) {}
+
+OLAPStatus XorFloatWriter::_write_values() {
+    uint32_t count = _num_literals;
+    _num_literals = 0;
+    if (count == 0) {
+        return OLAP_SUCCESS;
+    }
+
+    uint64_t words[MAX_BLOCK_WORDS + 1];
+    memset(words, 0, sizeof(words));
+    BitWriter bits(words);
+    bits.put(_literals[0], 64);
+    // no window before the first '11'
+    uint32_t window_leading = 64;
+    uint32_t window_trailing = 64;
+    for (uint32_t i = 1; i < count; ++i) {
+        uint64_t x = _literals[i] ^ _literals[i - 1];
+        if (x == 0) {
+            bits.put(0, 1);
+            continue;
+        }
+        // at most 31 leading zeros fit the 5 bits
+        uint32_t leading = std::min(__builtin_clzll(x), 31);
+        uint32_t trailing = __builtin_ctzll(x);
+        if (leading >= window_leading && trailing >= window_trailing) {
+            uint32_t significant = 64 - window_leading - window_trailing;
+            bits.put(1, 2);
+            bits.put(x >> window_trailing, significant);
+            continue;
+        }
+        uint32_t significant = 64 - leading - trailing;
+        bits.put(3, 2);
+        bits.put(leading, 5);
+        bits.put(significant - 1, 6);
+        bits.put(x >> trailing, significant);
+        window_leading = leading;
+        window_trailing = trailing;
+    }
+
+    uint16_t num_bytes = static_cast<uint16_t>(bits.num_bytes());
+    OLAPStatus res = OLAP_SUCCESS;
+    if (OLAP_SUCCESS != (res = _output->write(static_cast<char>(count - 1)))
+            || OLAP_SUCCESS != (res = _output->write(static_cast<char>(num_bytes & 0xff)))
+            || OLAP_SUCCESS != (res = _output->write(static_cast<char>(num_bytes >> 8)))) {
+        OLAP_LOG_WARNING("fail to write mini block header.");
+        return res;
+    }
+    if (OLAP_SUCCESS != (res = _output->write(reinterpret_cast<char*>(words), num_bytes))) {
+        OLAP_LOG_WARNING("fail to write xor'ed values.");
+        return res;
+    }
+    return OLAP_SUCCESS;
+}
+
+OLAPStatus XorFloatWriter::flush() {
+    OLAPStatus res = _write_values();
+    if (OLAP_SUCCESS != res) {
+        OLAP_LOG_WARNING("fail to write values.");
+        return res;
+    }
+    return _output->flush();
+}
+
+void XorFloatWriter::get_position(PositionEntryWriter* index_entry, bool print) const {
+    _output->get_position(index_entry);
+    index_entry->add_position(_num_literals);
+    if (print) {
+        _output->print_position_debug_info();
+        VLOG(10) << "literals=" << _num_literals;
+    }
+}
+
+}  // namespace doris
@@ -0,0 +1,103 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_OLAP_XOR_FLOAT_WRITER_H
+#define DORIS_BE_SRC_OLAP_XOR_FLOAT_WRITER_H
+
+#include <string.h>
+
+#include "olap/olap_define.h"
+#include "olap/stream_index_writer.h"
+
+namespace doris {
+
+class OutStream;
+
+// Floats and doubles XOR'ed with their predecessor, as in Facebook's
+// Gorilla, written by DoubleColumnWriterBase for columns with the XOR
+// encoding. Values are handled as 64 bit words, floats in the upper half,
+// so their sign, exponent and high mantissa bits lead either way. Every
+// mini block of up to MINI_BLOCK_SIZE values is
+//
+//   1 byte   number of values - 1
+//   2 bytes  little endian number of bytes of the bits below
+//   bits     the first value, 64 bits, then for every other value
+//              '0'   equal to its predecessor
+//              '10'  the XOR within the window of the last '11', its
+//                    significant bits
+//              '11'  5 bits leading zeros, 6 bits number of significant
+//                    bits - 1, then the significant bits of the XOR
+//
+// packed from the lowest bit of the first byte. Slowly changing metrics
+// share most of their leading bits, and often all of their trailing ones.
+class XorFloatWriter {
+public:
+    static const uint32_t MINI_BLOCK_SIZE = 128;
+    // the bits of a mini block of values none of which fits the window
+    static const uint32_t MAX_BLOCK_WORDS =
+            (64 + (MINI_BLOCK_SIZE - 1) * (2 + 5 + 6 + 64) + 63) / 64;
+
+    explicit XorFloatWriter(OutStream* output);
+    ~XorFloatWriter() {}
+
+    template<class T>
+    OLAPStatus write(T value) {
+        _literals[_num_literals++] = to_bits(value);
+        if (_num_literals == MINI_BLOCK_SIZE) {
+            return _write_values();
+        }
+        return OLAP_SUCCESS;
+    }
+
+    OLAPStatus flush();
+    void get_position(PositionEntryWriter* index_entry, bool print) const;
+
+    static uint64_t to_bits(double value) {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(value));
+        return bits;
+    }
+
+    static uint64_t to_bits(float value) {
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(value));
+        return static_cast<uint64_t>(bits) << 32;
+    }
+
+    static void from_bits(uint64_t bits, double* value) {
+        memcpy(value, &bits, sizeof(*value));
+    }
+
+    static void from_bits(uint64_t bits, float* value) {
+        uint32_t high = static_cast<uint32_t>(bits >> 32);
+        memcpy(value, &high, sizeof(*value));
+    }
+
+private:
+    OLAPStatus _write_values();
+
+    OutStream* _output;
+    uint64_t _literals[MINI_BLOCK_SIZE];
+    uint32_t _num_literals;
+
+    DISALLOW_COPY_AND_ASSIGN(XorFloatWriter);
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_XOR_FLOAT_WRITER_H
@@ -0,0 +1,178 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/admission_controller.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "runtime/exec_env.h"
+#include "runtime/mem_tracker.h"
+#include "util/cpu_info.h"
+#include "util/fair_share_thread_pool.h"
+#include "util/time.h"
+
+namespace doris {
+
+AdmissionController::AdmissionController(ExecEnv* exec_env) :
+        _exec_env(exec_env),
+        _thread(std::bind<void>(&AdmissionController::_admit_thread, this)) {
+}
+
+AdmissionController::~AdmissionController() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+}
+
+bool AdmissionController::admit(const std::string& group, int weight, AdmitFunction admit_func) {
+    std::lock_guard<std::mutex> l(_lock);
+    if (_num_queued == 0 && (_num_running == 0 || !_overloaded())) {
+        ++_num_running;
+        return true;
+    }
+    Group& g = _groups[group];
+    if (g.fragments.empty() && g.vtime < _min_vtime) {
+        // an idle group can not save up its share
+        g.vtime = _min_vtime;
+    }
+    g.weight = std::max(1, weight);
+    g.fragments.push_back({MonotonicNanos(), std::move(admit_func)});
+    ++_num_queued;
+    VLOG_QUERY << "queue fragment of group " << group << ", queued=" << _num_queued
+        << ", running=" << _num_running;
+    return false;
+}
+
+void AdmissionController::release() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        --_num_running;
+    }
+    _cv.notify_one();
+}
+
+int AdmissionController::num_queued() {
+    std::lock_guard<std::mutex> l(_lock);
+    return _num_queued;
+}
+
+bool AdmissionController::_overloaded() {
+    if (_exec_env == nullptr) {
+        return false;
+    }
+    MemTracker* process_tracker = _exec_env->process_mem_tracker();
+    if (config::fragment_admission_mem_ratio > 0 && process_tracker != nullptr
+            && process_tracker->has_limit()
+            && process_tracker->consumption()
+                > process_tracker->limit() * config::fragment_admission_mem_ratio) {
+        return true;
+    }
+    if (config::fragment_admission_max_runnable_per_core > 0
+            && _runnable_per_core() > config::fragment_admission_max_runnable_per_core) {
+        return true;
+    }
+    FairShareThreadPool* scanner_pool = _exec_env->thread_pool();
+    if (config::fragment_admission_max_scanner_queue > 0 && scanner_pool != nullptr
+            && scanner_pool->get_queue_size() > config::fragment_admission_max_scanner_queue) {
+        return true;
+    }
+    return false;
+}
+
+double AdmissionController::_runnable_per_core() {
+    int64_t now = MonotonicNanos();
+    if (now - _runnable_check_ns < config::fragment_admission_check_interval_ms * 1000000L) {
+        return _runnable_per_core_value;
+    }
+    _runnable_check_ns = now;
+
+    // e.g. "0.20 0.18 0.12 3/214 12345", the fourth field is runnable/total
+    std::ifstream loadavg("/proc/loadavg");
+    double load = 0;
+    int64_t runnable = 0;
+    if (!(loadavg >> load >> load >> load >> runnable)) {
+        LOG(WARNING) << "failed to read /proc/loadavg";
+        _runnable_per_core_value = 0;
+        return _runnable_per_core_value;
+    }
+    _runnable_per_core_value = static_cast<double>(runnable) / CpuInfo::num_cores();
+    return _runnable_per_core_value;
+}
+
+bool AdmissionController::_take_next(bool only_waited, Fragment* fragment) {
+    if (_num_queued == 0) {
+        return false;
+    }
+    // the fragment which waited the longest, if it waited too long
+    int64_t now = MonotonicNanos();
+    auto next = _groups.end();
+    for (auto it = _groups.begin(); it != _groups.end(); ++it) {
+        int64_t enqueue_ns = it->second.fragments.front().enqueue_ns;
+        if (now - enqueue_ns > config::fragment_admission_max_wait_ms * 1000000L
+                && (next == _groups.end()
+                    || enqueue_ns < next->second.fragments.front().enqueue_ns)) {
+            next = it;
+        }
+    }
+    if (next == _groups.end()) {
+        if (only_waited || (_num_running > 0 && _overloaded())) {
+            return false;
+        }
+        for (auto it = _groups.begin(); it != _groups.end(); ++it) {
+            if (next == _groups.end() || it->second.vtime < next->second.vtime) {
+                next = it;
+            }
+        }
+        _min_vtime = next->second.vtime;
+    }
+
+    Group& g = next->second;
+    *fragment = std::move(g.fragments.front());
+    g.fragments.pop_front();
+    g.vtime += 1.0 / g.weight;
+    if (g.fragments.empty()) {
+        _groups.erase(next);
+    }
+    --_num_queued;
+    ++_num_running;
+    return true;
+}
+
+void AdmissionController::_admit_thread() {
+    std::unique_lock<std::mutex> l(_lock);
+    while (!_stop) {
+        _cv.wait_for(l, std::chrono::milliseconds(config::fragment_admission_check_interval_ms));
+        // Start one fragment a check, so its memory and threads show up before
+        // the next one is started, and all the ones which waited too long.
+        bool started = false;
+        Fragment fragment;
+        while (!_stop && _take_next(started, &fragment)) {
+            started = true;
+            l.unlock();
+            fragment.admit_func(MonotonicNanos() - fragment.enqueue_ns);
+            l.lock();
+        }
+    }
+}
+
+}
@@ -0,0 +1,105 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_ADMISSION_CONTROLLER_H
+#define DORIS_BE_RUNTIME_ADMISSION_CONTROLLER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace doris {
+
+class ExecEnv;
+
+// Starts plan fragments when the BE has the resources to run them. While the
+// process memory, the runnable threads per core or the scanner queue are above
+// their thresholds, see config::fragment_admission_*, fragments are queued and
+// started one at a time as the load goes down.
+//
+// Queued fragments are started by the share of their resource group, the same
+// share the scanner pool uses: a group with twice the share of another one
+// starts twice as many fragments while both have fragments queued. A fragment
+// is started anyway once it waited fragment_admission_max_wait_ms, or when no
+// fragment is running, as the running ones may be waiting for it.
+class AdmissionController {
+public:
+    // 'queue_time_ns' is the time the fragment waited in the queue.
+    typedef std::function<void (int64_t queue_time_ns)> AdmitFunction;
+
+    // 'exec_env' may be nullptr, then fragments are always started at once.
+    AdmissionController(ExecEnv* exec_env);
+
+    // Queued fragments are dropped.
+    ~AdmissionController();
+
+    // Returns true if the fragment may start at once, 'admit_func' is not called
+    // then. Else queues it in 'group' whose share is 'weight' and returns false,
+    // 'admit_func' is called by another thread when the fragment may start.
+    bool admit(const std::string& group, int weight, AdmitFunction admit_func);
+
+    // Must be called when a fragment admitted by admit() finished or failed to start.
+    void release();
+
+    int num_queued();
+
+private:
+    struct Fragment {
+        int64_t enqueue_ns;
+        AdmitFunction admit_func;
+    };
+
+    struct Group {
+        int weight = 1;
+        // fragments started divided by the weight
+        double vtime = 0;
+        std::deque<Fragment> fragments;
+    };
+
+    bool _overloaded();
+    // Runnable threads divided by the cores, read from /proc/loadavg at most
+    // every fragment_admission_check_interval_ms.
+    double _runnable_per_core();
+    // Takes the next fragment to start, false if none may start now. Only one
+    // which waited too long if 'only_waited'.
+    bool _take_next(bool only_waited, Fragment* fragment);
+    void _admit_thread();
+
+    ExecEnv* _exec_env;
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+    bool _stop = false;
+    int _num_running = 0;
+    int _num_queued = 0;
+    std::map<std::string, Group> _groups;
+    // smallest vtime of the groups with fragments queued
+    double _min_vtime = 0;
+
+    int64_t _runnable_check_ns = 0;
+    double _runnable_per_core_value = 0;
+
+    std::thread _thread;
+};
+
+}
+
+#endif // DORIS_BE_RUNTIME_ADMISSION_CONTROLLER_H
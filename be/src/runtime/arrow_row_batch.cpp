@@ -0,0 +1,246 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/arrow_row_batch.h"
+
+#include <sstream>
+
+#include <arrow/api.h>
+#include <arrow/io/memory.h>
+#include <arrow/ipc/writer.h>
+
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "runtime/datetime_value.h"
+#include "runtime/decimal_value.h"
+#include "runtime/large_int_value.h"
+#include "runtime/row_batch.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple_row.h"
+#include "util/types.h"
+
+namespace doris {
+
+static Status to_doris_status(const arrow::Status& status, const char* msg) {
+    std::stringstream ss;
+    ss << msg << ", error=" << status.ToString();
+    LOG(WARNING) << ss.str();
+    return Status(ss.str());
+}
+
+static std::shared_ptr<arrow::DataType> arrow_type_of(PrimitiveType type) {
+    switch (type) {
+    case TYPE_BOOLEAN:
+        return arrow::boolean();
+    case TYPE_TINYINT:
+        return arrow::int8();
+    case TYPE_SMALLINT:
+        return arrow::int16();
+    case TYPE_INT:
+        return arrow::int32();
+    case TYPE_BIGINT:
+        return arrow::int64();
+    case TYPE_FLOAT:
+        return arrow::float32();
+    case TYPE_DOUBLE:
+        return arrow::float64();
+    case TYPE_DECIMALV2:
+        return arrow::decimal(27, 9);
+    default:
+        return arrow::utf8();
+    }
+}
+
+Status convert_to_arrow_schema(const std::vector<ExprContext*>& output_expr_ctxs,
+                               std::shared_ptr<arrow::Schema>* result) {
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for (int i = 0; i < output_expr_ctxs.size(); ++i) {
+        const TypeDescriptor& type = output_expr_ctxs[i]->root()->type();
+        fields.push_back(arrow::field("c" + std::to_string(i), arrow_type_of(type.type)));
+    }
+    *result = arrow::schema(fields);
+    return Status::OK;
+}
+
+// Appends the value of each row, 'append(builder, item)' appends a value
+// which is not NULL.
+template <typename BuilderType, typename AppendFunc>
+static arrow::Status append_column(ExprContext* ctx, RowBatch* batch, BuilderType* builder,
+                                   AppendFunc append) {
+    int num_rows = batch->num_rows();
+    ARROW_RETURN_NOT_OK(builder->Reserve(num_rows));
+    for (int i = 0; i < num_rows; ++i) {
+        void* item = ctx->get_value(batch->get_row(i));
+        if (item == NULL) {
+            ARROW_RETURN_NOT_OK(builder->AppendNull());
+        } else {
+            ARROW_RETURN_NOT_OK(append(builder, item));
+        }
+    }
+    return arrow::Status::OK();
+}
+
+template <typename BuilderType, typename T>
+static arrow::Status append_numbers(ExprContext* ctx, RowBatch* batch, BuilderType* builder) {
+    return append_column(ctx, batch, builder, [](BuilderType* builder, void* item) {
+        return builder->Append(*static_cast<T*>(item));
+    });
+}
+
+static arrow::Status append_strings(ExprContext* ctx, RowBatch* batch,
+                                    arrow::StringBuilder* builder) {
+    PrimitiveType type = ctx->root()->type().type;
+    int output_scale = ctx->root()->output_scale();
+    return append_column(ctx, batch, builder,
+                         [type, output_scale](arrow::StringBuilder* builder, void* item) {
+        switch (type) {
+        case TYPE_VARCHAR:
+        case TYPE_HLL:
+        case TYPE_CHAR: {
+            const StringValue* value = static_cast<const StringValue*>(item);
+            return builder->Append(value->ptr, value->len);
+        }
+        case TYPE_DATE:
+        case TYPE_DATETIME: {
+            char buf[64];
+            char* end = static_cast<const DateTimeValue*>(item)->to_string(buf);
+            return builder->Append(buf, end - buf - 1);
+        }
+        case TYPE_LARGEINT: {
+            char buf[48];
+            int len = 48;
+            char* v = LargeIntValue::to_string(
+                reinterpret_cast<const PackedInt128*>(item)->value, buf, &len);
+            return builder->Append(v, len);
+        }
+        case TYPE_DECIMAL: {
+            const DecimalValue* value = static_cast<const DecimalValue*>(item);
+            if (output_scale > 0 && output_scale <= 30) {
+                return builder->Append(value->to_string(output_scale));
+            }
+            return builder->Append(value->to_string());
+        }
+        default:
+            return arrow::Status::NotImplemented("unsupported type");
+        }
+    });
+}
+
+static arrow::Status convert_column(ExprContext* ctx, RowBatch* batch,
+                                    const std::shared_ptr<arrow::DataType>& arrow_type,
+                                    arrow::MemoryPool* pool,
+                                    std::shared_ptr<arrow::Array>* result) {
+    switch (ctx->root()->type().type) {
+    case TYPE_BOOLEAN: {
+        arrow::BooleanBuilder builder(pool);
+        ARROW_RETURN_NOT_OK((append_numbers<arrow::BooleanBuilder, bool>(ctx, batch, &builder)));
+        return builder.Finish(result);
+    }
+    case TYPE_TINYINT: {
+        arrow::Int8Builder builder(pool);
+        ARROW_RETURN_NOT_OK((append_numbers<arrow::Int8Builder, int8_t>(ctx, batch, &builder)));
+        return builder.Finish(result);
+    }
+    case TYPE_SMALLINT: {
+        arrow::Int16Builder builder(pool);
+        ARROW_RETURN_NOT_OK((append_numbers<arrow::Int16Builder, int16_t>(ctx, batch, &builder)));
+        return builder.Finish(result);
+    }
+    case TYPE_INT: {
+        arrow::Int32Builder builder(pool);
+        ARROW_RETURN_NOT_OK((append_numbers<arrow::Int32Builder, int32_t>(ctx, batch, &builder)));
+        return builder.Finish(result);
+    }
+    case TYPE_BIGINT: {
+        arrow::Int64Builder builder(pool);
+        ARROW_RETURN_NOT_OK((append_numbers<arrow::Int64Builder, int64_t>(ctx, batch, &builder)));
+        return builder.Finish(result);
+    }
+    case TYPE_FLOAT: {
+        arrow::FloatBuilder builder(pool);
+        ARROW_RETURN_NOT_OK((append_numbers<arrow::FloatBuilder, float>(ctx, batch, &builder)));
+        return builder.Finish(result);
+    }
+    case TYPE_DOUBLE: {
+        arrow::DoubleBuilder builder(pool);
+        ARROW_RETURN_NOT_OK((append_numbers<arrow::DoubleBuilder, double>(ctx, batch, &builder)));
+        return builder.Finish(result);
+    }
+    case TYPE_DECIMALV2: {
+        arrow::Decimal128Builder builder(arrow_type, pool);
+        ARROW_RETURN_NOT_OK(append_column(ctx, batch, &builder,
+                                          [](arrow::Decimal128Builder* builder, void* item) {
+            // the values of DECIMALV2 are already scaled by 10^9
+            __int128 value = reinterpret_cast<const PackedInt128*>(item)->value;
+            return builder->Append(arrow::Decimal128(static_cast<int64_t>(value >> 64),
+                                                     static_cast<uint64_t>(value)));
+        }));
+        return builder.Finish(result);
+    }
+    default: {
+        arrow::StringBuilder builder(pool);
+        ARROW_RETURN_NOT_OK(append_strings(ctx, batch, &builder));
+        return builder.Finish(result);
+    }
+    }
+}
+
+Status convert_to_arrow_batch(const std::vector<ExprContext*>& output_expr_ctxs,
+                              RowBatch* batch,
+                              const std::shared_ptr<arrow::Schema>& schema,
+                              arrow::MemoryPool* pool,
+                              std::shared_ptr<arrow::RecordBatch>* result) {
+    DCHECK_EQ(output_expr_ctxs.size(), schema->num_fields());
+    std::vector<std::shared_ptr<arrow::Array>> arrays(output_expr_ctxs.size());
+    for (int i = 0; i < output_expr_ctxs.size(); ++i) {
+        arrow::Status status = convert_column(
+            output_expr_ctxs[i], batch, schema->field(i)->type(), pool, &arrays[i]);
+        if (!status.ok()) {
+            return to_doris_status(status, "fail to convert column to arrow");
+        }
+    }
+    *result = arrow::RecordBatch::Make(schema, batch->num_rows(), arrays);
+    return Status::OK;
+}
+
+Status serialize_record_batch(const arrow::RecordBatch& batch, std::string* result) {
+    std::shared_ptr<arrow::io::BufferOutputStream> sink;
+    arrow::Status status = arrow::io::BufferOutputStream::Create(
+        1024 * 1024, arrow::default_memory_pool(), &sink);
+    if (!status.ok()) {
+        return to_doris_status(status, "fail to create arrow output stream");
+    }
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+    status = arrow::ipc::RecordBatchStreamWriter::Open(sink.get(), batch.schema(), &writer);
+    if (status.ok()) {
+        status = writer->WriteRecordBatch(batch);
+    }
+    if (status.ok()) {
+        status = writer->Close();
+    }
+    std::shared_ptr<arrow::Buffer> buffer;
+    if (status.ok()) {
+        status = sink->Finish(&buffer);
+    }
+    if (!status.ok()) {
+        return to_doris_status(status, "fail to serialize arrow record batch");
+    }
+    result->assign(reinterpret_cast<const char*>(buffer->data()), buffer->size());
+    return Status::OK;
+}
+
+}
@@ -0,0 +1,65 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_ARROW_ROW_BATCH_H
+#define DORIS_BE_RUNTIME_ARROW_ROW_BATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/status.h"
+
+namespace arrow {
+
+class MemoryPool;
+class RecordBatch;
+class Schema;
+
+}
+
+namespace doris {
+
+class ExprContext;
+class RowBatch;
+
+// Conversion of query results to Arrow record batches, for clients which
+// read large results as columns instead of MySQL rows. Each column is built
+// by one Arrow builder over all rows of the batch.
+//
+// Integers, floats and booleans keep their types, DECIMALV2 is a decimal of
+// precision 27 and scale 9, other types are strings formatted as in the
+// MySQL protocol.
+
+// Makes the schema of the results of 'output_expr_ctxs', the columns are
+// named by their position.
+Status convert_to_arrow_schema(const std::vector<ExprContext*>& output_expr_ctxs,
+                               std::shared_ptr<arrow::Schema>* result);
+
+Status convert_to_arrow_batch(const std::vector<ExprContext*>& output_expr_ctxs,
+                              RowBatch* batch,
+                              const std::shared_ptr<arrow::Schema>& schema,
+                              arrow::MemoryPool* pool,
+                              std::shared_ptr<arrow::RecordBatch>* result);
+
+// Writes 'batch' as an Arrow IPC stream holding the schema and the batch, so
+// it can be read without any other message.
+Status serialize_record_batch(const arrow::RecordBatch& batch, std::string* result);
+
+}
+
+#endif
@@ -17,6 +17,11 @@
 
 #include "runtime/buffered_block_mgr2.h"
 
+#include <algorithm>
+
+#include <lz4/lz4.h>
+
+#include "common/config.h"
 #include "runtime/exec_env.h"
 #include "runtime/runtime_state.h"
 #include "runtime/mem_tracker.h"
@@ -132,6 +137,7 @@ BufferedBlockMgr2::Block::Block(BufferedBlockMgr2* block_mgr) :
         _write_range(NULL),
         _tmp_file(NULL),
         _valid_data_len(0),
+        _compressed_len(0),
         _num_rows(0) {
 }
 
@@ -153,6 +159,7 @@ void BufferedBlockMgr2::Block::init() {
     _in_write = false;
     _is_deleted = false;
     _valid_data_len = 0;
+    _compressed_len = 0;
     _client = NULL;
     _num_rows = 0;
 }
@@ -219,6 +226,8 @@ BufferedBlockMgr2::BufferedBlockMgr2(RuntimeState* state, TmpFileMgr* tmp_file_m
     _non_local_outstanding_writes(0),
     _io_mgr(state->exec_env()->disk_io_mgr()),
     _is_cancelled(false),
+    _mem_arbitrator(state->exec_env()->mem_arbitrator()),
+    _mem_arbitrator_id(-1),
     _writes_issued(0) {
 }
 
@@ -407,6 +416,55 @@ void BufferedBlockMgr2::release_memory(Client* client, int64_t size) {
     client->_tracker->release_local(size, client->_query_tracker);
 }
 
+int64_t BufferedBlockMgr2::revocable_memory() {
+    unique_lock<mutex> lock(_lock, boost::try_to_lock);
+    if (!lock.owns_lock() || _is_cancelled) {
+        return 0;
+    }
+    int64_t num_buffers = _free_io_buffers.size();
+    if (!_disable_spill) {
+        num_buffers += _unpinned_blocks.size();
+    }
+    return num_buffers * _max_block_size;
+}
+
+int64_t BufferedBlockMgr2::revoke_memory(int64_t bytes) {
+    unique_lock<mutex> lock(_lock, boost::try_to_lock);
+    if (!lock.owns_lock() || _is_cancelled) {
+        return 0;
+    }
+    int64_t freed = 0;
+    while (freed < bytes && !_free_io_buffers.empty()) {
+        BufferDescriptor* buffer_desc = _free_io_buffers.dequeue();
+        _all_io_buffers.erase(buffer_desc->all_buffers_it);
+        if (buffer_desc->block != NULL) {
+            buffer_desc->block->_buffer_desc = NULL;
+        }
+        freed += buffer_desc->len;
+        _mem_tracker->release(buffer_desc->len);
+        delete[] buffer_desc->buffer;
+    }
+    if (_disable_spill) {
+        return freed;
+    }
+    // The buffers of these blocks are returned to _free_io_buffers by write_complete().
+    int64_t to_write = bytes - freed;
+    while (to_write > 0 && !_unpinned_blocks.empty()) {
+        Block* write_block = _unpinned_blocks.pop_back();
+        write_block->_client_local = false;
+        Status status = write_unpinned_block(write_block);
+        if (!status.ok()) {
+            LOG(WARNING) << "Query: " << _query_id << " failed to spill revoked block: "
+                << status.get_error_msg();
+            _unpinned_blocks.enqueue(write_block);
+            break;
+        }
+        ++_non_local_outstanding_writes;
+        to_write -= _max_block_size;
+    }
+    return freed;
+}
+
 void BufferedBlockMgr2::cancel() {
     {
         lock_guard<mutex> lock(_lock);
@@ -548,6 +606,9 @@ Status BufferedBlockMgr2::transfer_buffer(Block* dst, Block* src, bool unpin) {
 }
 
 BufferedBlockMgr2::~BufferedBlockMgr2() {
+    if (_mem_arbitrator_id >= 0) {
+        _mem_arbitrator->unregister_consumer(_mem_arbitrator_id);
+    }
     {
         lock_guard<SpinLock> lock(_s_block_mgrs_lock);
         BlockMgrsMap::iterator it = _s_query_to_block_mgrs.find(_query_id);
@@ -584,6 +645,7 @@ BufferedBlockMgr2::~BufferedBlockMgr2() {
         file.remove();
     }
     _tmp_files.clear();
+    _tmp_file_rotation.clear();
 
     // Free memory resources.
     BOOST_FOREACH(BufferDescriptor* buffer, _all_io_buffers) {
@@ -688,19 +750,35 @@ Status BufferedBlockMgr2::pin_block(Block* block, bool* pinned, Block* release_b
     vector<DiskIoMgr::ScanRange*> ranges(1, scan_range);
     RETURN_IF_ERROR(_io_mgr->add_scan_ranges(_io_request_context, ranges, true));
 
-    // Read from the io mgr buffer into the block's assigned buffer.
+    // Read from the io mgr buffer into the block's assigned buffer, or into a buffer of
+    // its own if the block was written compressed.
+    scoped_array<char> compressed;
+    uint8_t* read_buffer = block->buffer();
+    if (block->_compressed_len > 0) {
+        compressed.reset(new char[block->_compressed_len]);
+        read_buffer = reinterpret_cast<uint8_t*>(compressed.get());
+    }
     int64_t offset = 0;
     bool buffer_eosr = false;
     do {
         DiskIoMgr::BufferDescriptor* io_mgr_buffer;
         RETURN_IF_ERROR(scan_range->get_next(&io_mgr_buffer));
-        memcpy(block->buffer() + offset, io_mgr_buffer->buffer(), io_mgr_buffer->len());
+        memcpy(read_buffer + offset, io_mgr_buffer->buffer(), io_mgr_buffer->len());
         offset += io_mgr_buffer->len();
         buffer_eosr = io_mgr_buffer->eosr();
         io_mgr_buffer->return_buffer();
     } while (!buffer_eosr);
     DCHECK_EQ(offset, block->_write_range->len());
 
+    if (block->_compressed_len > 0) {
+        SCOPED_TIMER(_compression_timer);
+        int len = LZ4_decompress_safe(compressed.get(), reinterpret_cast<char*>(block->buffer()),
+                                      block->_compressed_len, _max_block_size);
+        if (len != block->_valid_data_len) {
+            return Status("Failed to decompress spilled block.");
+        }
+    }
+
     return delete_or_unpin_block(release_block, unpin);
 }
 
@@ -782,17 +860,34 @@ Status BufferedBlockMgr2::write_unpinned_block(Block* block) {
         block->_tmp_file = tmp_file;
     }
 
-    uint8_t* outbuf = NULL;
-    outbuf = block->buffer();
+    uint8_t* outbuf = block->buffer();
+    int64_t outlen = block->_valid_data_len;
+    block->_compressed_len = 0;
+    if (config::spill_compression) {
+        SCOPED_TIMER(_compression_timer);
+        int bound = LZ4_compressBound(block->_valid_data_len);
+        block->_compressed_buffer.reset(new char[bound]);
+        int len = LZ4_compress_default(reinterpret_cast<const char*>(outbuf),
+                                       block->_compressed_buffer.get(),
+                                       block->_valid_data_len, bound);
+        // Blocks which do not get smaller are written as they are.
+        if (len > 0 && len < block->_valid_data_len) {
+            block->_compressed_len = len;
+            outbuf = reinterpret_cast<uint8_t*>(block->_compressed_buffer.get());
+            outlen = len;
+        } else {
+            block->_compressed_buffer.reset();
+        }
+    }
 
-    block->_write_range->set_data(outbuf, block->_valid_data_len);
+    block->_write_range->set_data(outbuf, outlen);
 
     // Issue write through DiskIoMgr.
     RETURN_IF_ERROR(_io_mgr->add_write_range(_io_request_context, block->_write_range));
     block->_in_write = true;
     DCHECK(block->validate()) << endl << block->debug_string();
     _outstanding_writes_counter->update(1);
-    _bytes_written_counter->update(block->_valid_data_len);
+    _bytes_written_counter->update(outlen);
     ++_writes_issued;
     if (_writes_issued == 1) {
 #if 0
@@ -809,9 +904,9 @@ Status BufferedBlockMgr2::allocate_scratch_space(int64_t block_size,
     // Assumes block manager lock is already taken.
     vector<Status> errs;
     // Find the next physical file in round-robin order and create a write range for it.
-    for (int attempt = 0; attempt < _tmp_files.size(); ++attempt) {
-        *tmp_file = &_tmp_files[_next_block_index];
-        _next_block_index = (_next_block_index + 1) % _tmp_files.size();
+    for (int attempt = 0; attempt < _tmp_file_rotation.size(); ++attempt) {
+        *tmp_file = &_tmp_files[_tmp_file_rotation[_next_block_index]];
+        _next_block_index = (_next_block_index + 1) % _tmp_file_rotation.size();
         if ((*tmp_file)->is_blacklisted()) {
             continue;
         }
@@ -845,6 +940,7 @@ void BufferedBlockMgr2::write_complete(Block* block, const Status& write_status)
         --_non_local_outstanding_writes;
     }
     block->_in_write = false;
+    block->_compressed_buffer.reset();
 
     // Explicitly release our temporarily allocated buffer here so that it doesn't
     // hang around needlessly.
@@ -1283,6 +1379,7 @@ void BufferedBlockMgr2::init(
     _disk_read_timer = ADD_TIMER(_profile.get(), "TotalReadBlockTime");
     _buffer_wait_timer = ADD_TIMER(_profile.get(), "TotalBufferWaitTime");
     _encryption_timer = ADD_TIMER(_profile.get(), "TotalEncryptionTime");
+    _compression_timer = ADD_TIMER(_profile.get(), "TotalCompressionTime");
     _integrity_check_timer = ADD_TIMER(_profile.get(), "TotalIntegrityCheckTime");
 
     // Create a new mem_tracker and allocate buffers.
@@ -1290,6 +1387,12 @@ void BufferedBlockMgr2::init(
     //             profile(), mem_limit, -1, "Block Manager", parent_tracker));
     _mem_tracker.reset(new MemTracker(mem_limit, "Block Manager", parent_tracker));
 
+    if (_mem_arbitrator != NULL) {
+        _mem_arbitrator_id = _mem_arbitrator->register_consumer(0,
+                [this]() { return revocable_memory(); },
+                [this](int64_t bytes) { return revoke_memory(bytes); });
+    }
+
     _initialized = true;
 }
 
@@ -1300,6 +1403,7 @@ Status BufferedBlockMgr2::init_tmp_files() {
     vector<TmpFileMgr::DeviceId> tmp_devices = _tmp_file_mgr->active_tmp_devices();
     // Initialize the tmp files and the initial file to use.
     _tmp_files.reserve(tmp_devices.size());
+    vector<int> weights;
     for (int i = 0; i < tmp_devices.size(); ++i) {
         TmpFileMgr::File* tmp_file;
         TmpFileMgr::DeviceId tmp_device_id = tmp_devices[i];
@@ -1308,13 +1412,26 @@ Status BufferedBlockMgr2::init_tmp_files() {
         Status status = _tmp_file_mgr->get_file(tmp_device_id, _query_id, &tmp_file);
         if (status.ok()) {
             _tmp_files.push_back(tmp_file);
+            int disk_id = DiskInfo::disk_id(
+                    _tmp_file_mgr->get_tmp_dir_path(tmp_device_id).c_str());
+            bool is_ssd = disk_id >= 0 && !DiskInfo::is_rotational(disk_id);
+            weights.push_back(is_ssd ? std::max(config::scratch_ssd_weight, 1) : 1);
         }
     }
     if (_tmp_files.empty()) {
         return Status("No spilling directories configured. Cannot spill. Set --scratch_dirs"
                 " or see log for previous errors that prevented use of provided directories");
     }
-    _next_block_index = rand() % _tmp_files.size();
+    // Interleave the files, a file with weight w appears in the first w rounds.
+    int max_weight = *std::max_element(weights.begin(), weights.end());
+    for (int round = 0; round < max_weight; ++round) {
+        for (int i = 0; i < weights.size(); ++i) {
+            if (weights[i] > round) {
+                _tmp_file_rotation.push_back(i);
+            }
+        }
+    }
+    _next_block_index = rand() % _tmp_file_rotation.size();
     return Status::OK;
 }
 
@@ -28,6 +28,7 @@
 
 namespace doris {
 
+class MemArbitrator;
 class RuntimeState;
 
 // The BufferedBlockMgr2 is used to allocate and manage blocks of data using a fixed memory
@@ -260,6 +261,12 @@ public:
         // Length of valid (i.e. allocated) data within the block.
         int64_t _valid_data_len;
 
+        // Length of the block on disk if it was written compressed, 0 otherwise.
+        int64_t _compressed_len;
+
+        // The compressed data while the block is being written.
+        boost::scoped_array<char> _compressed_buffer;
+
         // Number of rows in this block.
         int _num_rows;
 
@@ -367,6 +374,15 @@ public:
     // release_memory() call.
     void release_memory(Client* client, int64_t size);
 
+    // Called by the MemArbitrator when the process runs out of memory. Frees the buffers
+    // of blocks which are not pinned and starts writing unpinned blocks, whose buffers
+    // are freed by a later call once written. Returns the bytes freed, 0 if the block
+    // mgr is busy: it never waits for _lock.
+    int64_t revoke_memory(int64_t bytes);
+
+    // The bytes revoke_memory() could free eventually, 0 if the block mgr is busy.
+    int64_t revocable_memory();
+
     // The number of buffers available for client. That is, if all other clients were
     // stopped, the number of buffers this client could get.
     int64_t available_buffers(Client* client) const;
@@ -578,8 +594,12 @@ private:
     // Blocks are round-robined across these files.
     boost::ptr_vector<TmpFileMgr::File> _tmp_files;
 
-    // Index into _tmp_files denoting the file to which the next block to be persisted will
-    // be written.
+    // Indexes into _tmp_files in the order blocks are written to them. A file on an SSD
+    // appears config::scratch_ssd_weight times.
+    std::vector<int> _tmp_file_rotation;
+
+    // Index into _tmp_file_rotation denoting the file to which the next block to be
+    // persisted will be written.
     int _next_block_index;
 
     // DiskIoMgr handles to read and write blocks.
@@ -591,6 +611,10 @@ private:
     // write_complete() needed to reissue the write and that failed.
     bool _is_cancelled;
 
+    // Not null if the buffers may be revoked by the process, see revoke_memory().
+    MemArbitrator* _mem_arbitrator;
+    int64_t _mem_arbitrator_id;
+
     // Counters and timers to track behavior.
     boost::scoped_ptr<RuntimeProfile> _profile;
 
@@ -622,6 +646,9 @@ private:
     // Time spent in disk spill encryption and decryption.
     RuntimeProfile::Counter* _encryption_timer;
 
+    // Time spent compressing and decompressing spilled blocks.
+    RuntimeProfile::Counter* _compression_timer;
+
     // Time spent in disk spill integrity generation and checking.
     RuntimeProfile::Counter* _integrity_check_timer;
 
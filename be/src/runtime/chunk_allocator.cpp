@@ -0,0 +1,157 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/chunk_allocator.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <mutex>
+
+#include "common/compiler_util.h"
+#include "common/config.h"
+#include "common/logging.h"
+#include "util/bit_util.h"
+#include "util/cpu_info.h"
+#include "util/doris_metrics.h"
+#include "util/spinlock.h"
+
+namespace doris {
+
+const size_t ChunkAllocator::MIN_CHUNK_SIZE;
+const size_t ChunkAllocator::MAX_CHUNK_SIZE;
+
+// 4KB, 8KB, ... 1MB
+static const int NUM_SIZE_CLASSES = 9;
+
+// Free chunks of one core.
+class ChunkArena {
+public:
+    ~ChunkArena() {
+        for (auto& free_list : _free_lists) {
+            for (auto data : free_list) {
+                ::free(data);
+            }
+        }
+    }
+
+    bool pop_free_chunk(int size_class, uint8_t** data) {
+        std::lock_guard<SpinLock> l(_lock);
+        std::vector<uint8_t*>& free_list = _free_lists[size_class];
+        if (free_list.empty()) {
+            return false;
+        }
+        *data = free_list.back();
+        free_list.pop_back();
+        return true;
+    }
+
+    void push_free_chunk(int size_class, uint8_t* data) {
+        std::lock_guard<SpinLock> l(_lock);
+        _free_lists[size_class].push_back(data);
+    }
+
+private:
+    SpinLock _lock;
+    std::vector<uint8_t*> _free_lists[NUM_SIZE_CLASSES];
+};
+
+ChunkAllocator* ChunkAllocator::instance() {
+    // never destroyed, pools may free their chunks at exit
+    static ChunkAllocator* s_instance = new ChunkAllocator(config::chunk_reserved_bytes_limit);
+    return s_instance;
+}
+
+ChunkAllocator::ChunkAllocator(size_t reserve_limit)
+        : _reserve_bytes_limit(reserve_limit),
+        _reserved_bytes(0) {
+    // a single arena if CpuInfo is not initialized, as in some tests
+    int num_arenas = std::max(CpuInfo::get_max_num_cores(), 1);
+    for (int i = 0; i < num_arenas; ++i) {
+        _arenas.emplace_back(new ChunkArena());
+    }
+}
+
+ChunkAllocator::~ChunkAllocator() {
+}
+
+int ChunkAllocator::_size_class(size_t size) {
+    if (size < MIN_CHUNK_SIZE || size > MAX_CHUNK_SIZE || !BitUtil::IsPowerOf2(size)) {
+        return -1;
+    }
+    return BitUtil::Log2Floor64(size / MIN_CHUNK_SIZE);
+}
+
+bool ChunkAllocator::allocate(size_t size, Chunk* chunk) {
+    int core_id = CpuInfo::get_current_core() % _arenas.size();
+    chunk->size = size;
+    chunk->core_id = core_id;
+
+    int size_class = _size_class(size);
+    if (size_class >= 0) {
+        if (_arenas[core_id]->pop_free_chunk(size_class, &chunk->data)) {
+            _reserved_bytes.fetch_sub(size);
+            DorisMetrics::chunk_pool_reserved_bytes.increment(-static_cast<int64_t>(size));
+            DorisMetrics::chunk_pool_local_core_alloc_count.increment(1);
+            return true;
+        }
+        // chunks of the other NUMA nodes are not taken, new memory of this node
+        // is better for the rest of the query
+        if (CpuInfo::get_max_num_cores() > 0) {
+            for (int other : CpuInfo::get_cores_of_same_numa_node(core_id)) {
+                if (other == core_id || other >= _arenas.size()) {
+                    continue;
+                }
+                if (_arenas[other]->pop_free_chunk(size_class, &chunk->data)) {
+                    chunk->core_id = other;
+                    _reserved_bytes.fetch_sub(size);
+                    DorisMetrics::chunk_pool_reserved_bytes.increment(-static_cast<int64_t>(size));
+                    DorisMetrics::chunk_pool_other_core_alloc_count.increment(1);
+                    return true;
+                }
+            }
+        }
+    }
+
+    chunk->data = reinterpret_cast<uint8_t*>(malloc(size));
+    if (UNLIKELY(chunk->data == nullptr)) {
+        return false;
+    }
+    DorisMetrics::chunk_pool_system_alloc_count.increment(1);
+    return true;
+}
+
+void ChunkAllocator::free(const Chunk& chunk) {
+    int size_class = _size_class(chunk.size);
+    if (size_class >= 0) {
+        DCHECK_GE(chunk.core_id, 0);
+        DCHECK_LT(chunk.core_id, _arenas.size());
+        size_t reserved = _reserved_bytes.fetch_add(chunk.size);
+        if (reserved + chunk.size <= _reserve_bytes_limit) {
+            // back to the core which allocated it, its pages are on that node
+            _arenas[chunk.core_id]->push_free_chunk(size_class, chunk.data);
+            DorisMetrics::chunk_pool_reserved_bytes.increment(chunk.size);
+            return;
+        }
+        _reserved_bytes.fetch_sub(chunk.size);
+    }
+    ::free(chunk.data);
+    DorisMetrics::chunk_pool_system_free_count.increment(1);
+}
+
+}
@@ -0,0 +1,78 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_RUNTIME_CHUNK_ALLOCATOR_H
+#define DORIS_BE_RUNTIME_CHUNK_ALLOCATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace doris {
+
+class ChunkArena;
+
+// Memory of a mem pool, 'core_id' is the core which allocated it.
+struct Chunk {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    int core_id = -1;
+};
+
+// Keeps the chunks freed by mem pools to give them to the next pools, so
+// short queries do not pay again for large allocations and page faults.
+// Chunks of a power of two size from 4KB to 1MB are kept in free lists of
+// the core which allocated them, up to 'chunk_reserved_bytes_limit' bytes
+// for the process. A chunk is taken from the current core, else from the
+// cores of the same NUMA node, whose memory is as close, else it is
+// allocated from the system.
+//
+// This class is thread-safe.
+class ChunkAllocator {
+public:
+    static const size_t MIN_CHUNK_SIZE = 4 * 1024;
+    static const size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+    static ChunkAllocator* instance();
+
+    explicit ChunkAllocator(size_t reserve_limit);
+    ~ChunkAllocator();
+
+    // Returns false if the system is out of memory.
+    bool allocate(size_t size, Chunk* chunk);
+
+    void free(const Chunk& chunk);
+
+    size_t reserved_bytes() const { return _reserved_bytes.load(); }
+
+private:
+    // index of the free lists of 'size', -1 if chunks of it are not kept
+    static int _size_class(size_t size);
+
+    size_t _reserve_bytes_limit;
+    std::atomic<size_t> _reserved_bytes;
+    // one per core
+    std::vector<std::unique_ptr<ChunkArena>> _arenas;
+};
+
+}
+
+#endif
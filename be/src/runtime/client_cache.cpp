@@ -26,9 +26,11 @@
 
 #include <boost/foreach.hpp>
 
+#include "common/config.h"
 #include "common/logging.h"
 #include "util/container_util.hpp"
 #include "util/network_util.h"
+#include "util/time.h"
 #include "util/thrift_util.h"
 #include "gen_cpp/FrontendService.h"
 
@@ -43,69 +45,97 @@ ClientCacheHelper::~ClientCacheHelper() {
 Status ClientCacheHelper::get_client(
         const TNetworkAddress& hostport,
         client_factory factory_method, void** client_key, int timeout_ms) {
-    boost::lock_guard<boost::mutex> lock(_lock);
-    //VLOG_RPC << "get_client(" << hostport << ")";
-    ClientCacheMap::iterator cache_entry = _client_cache.find(hostport);
+    {
+        boost::lock_guard<boost::mutex> lock(_lock);
+        //VLOG_RPC << "get_client(" << hostport << ")";
+        ClientCacheMap::iterator cache_entry = _client_cache.find(hostport);
 
-    if (cache_entry == _client_cache.end()) {
-        cache_entry =
-            _client_cache.insert(std::make_pair(hostport, std::list<void*>())).first;
-        DCHECK(cache_entry != _client_cache.end());
-    }
+        if (cache_entry == _client_cache.end()) {
+            cache_entry =
+                _client_cache.insert(std::make_pair(hostport, std::list<void*>())).first;
+            DCHECK(cache_entry != _client_cache.end());
+        }
 
-    std::list<void*>& info_list = cache_entry->second;
+        std::list<void*>& info_list = cache_entry->second;
+
+        if (!info_list.empty()) {
+            *client_key = info_list.front();
+            VLOG_RPC << "get_client(): cached client for " << hostport;
+            info_list.pop_front();
+            _client_map[*client_key]->set_send_timeout(timeout_ms);
+            _client_map[*client_key]->set_recv_timeout(timeout_ms);
+            if (_metrics_enabled) {
+                _used_clients->increment(1);
+            }
+            return Status::OK;
+        }
 
-    if (!info_list.empty()) {
-        *client_key = info_list.front();
-        VLOG_RPC << "get_client(): cached client for " << hostport;
-        info_list.pop_front();
-    } else {
-        RETURN_IF_ERROR(create_client(hostport, factory_method, client_key, timeout_ms));
+        // callers fail fast instead of all waiting for the connect timeout
+        // of a host which is down
+        auto failed = _open_failed_ms.find(hostport);
+        if (failed != _open_failed_ms.end()
+                && MonotonicMillis() - failed->second < config::thrift_client_open_backoff_ms) {
+            std::stringstream ss;
+            ss << "connecting to " << hostport << " failed recently";
+            return Status(TStatusCode::THRIFT_RPC_ERROR, ss.str());
+        }
     }
 
-    _client_map[*client_key]->set_send_timeout(timeout_ms);
-    _client_map[*client_key]->set_recv_timeout(timeout_ms);
-
+    RETURN_IF_ERROR(create_client(hostport, factory_method, client_key, timeout_ms));
     if (_metrics_enabled) {
         _used_clients->increment(1);
     }
-
     return Status::OK;
 }
 
 Status ClientCacheHelper::reopen_client(client_factory factory_method, void** client_key,
                                        int timeout_ms) {
-    boost::lock_guard<boost::mutex> lock(_lock);
-    ClientMap::iterator i = _client_map.find(*client_key);
-    DCHECK(i != _client_map.end());
-    ThriftClientImpl* info = i->second;
+    ThriftClientImpl* info = nullptr;
+    // the idle clients of the host are most likely as broken as this one,
+    // e.g. if the host restarted, they are closed instead of failing one by one
+    std::vector<ThriftClientImpl*> idle_clients;
+    {
+        boost::lock_guard<boost::mutex> lock(_lock);
+        ClientMap::iterator i = _client_map.find(*client_key);
+        DCHECK(i != _client_map.end());
+        info = i->second;
+        _client_map.erase(i);
+
+        auto cache_entry = _client_cache.find(make_network_address(info->ipaddress(), info->port()));
+        if (cache_entry != _client_cache.end()) {
+            for (void* key : cache_entry->second) {
+                idle_clients.push_back(_client_map[key]);
+                _client_map.erase(key);
+            }
+            cache_entry->second.clear();
+        }
+        if (_metrics_enabled) {
+            _opened_clients->increment(-static_cast<int64_t>(1 + idle_clients.size()));
+        }
+    }
     const std::string ipaddress = info->ipaddress();
     int port = info->port();
+    *client_key = NULL;
 
     // We don't expect Close() to fail. Even if it fails, we should continue on to delete
     // the transport and remove it from the map.
     Status status = info->close();
     DCHECK(status.ok());
-
     // TODO: Thrift TBufferedTransport cannot be re-opened after Close() because it does
     // not clean up internal buffers it reopens. To work around this issue, create a new
     // client instead.
-    _client_map.erase(*client_key);
     delete info;
-    *client_key = NULL;
-
-    if (_metrics_enabled) {
-        _opened_clients->increment(-1);
+    for (auto idle_client : idle_clients) {
+        idle_client->close();
+        delete idle_client;
     }
 
-    RETURN_IF_ERROR(create_client(make_network_address(
-        ipaddress, port), factory_method, client_key, timeout_ms));
-
-    _client_map[*client_key]->set_send_timeout(timeout_ms);
-    _client_map[*client_key]->set_recv_timeout(timeout_ms);
-    return Status::OK;
+    return create_client(make_network_address(ipaddress, port), factory_method,
+                         client_key, timeout_ms);
 }
 
+// connects without holding _lock, so that the connect timeout of one host
+// does not block the calls to the others
 Status ClientCacheHelper::create_client(
         const TNetworkAddress& hostport,
         client_factory factory_method, void** client_key, int timeout_ms) {
@@ -117,11 +147,16 @@ Status ClientCacheHelper::create_client(
 
     Status status = client_impl->open();
 
+    boost::lock_guard<boost::mutex> lock(_lock);
     if (!status.ok()) {
+        _open_failed_ms[hostport] = MonotonicMillis();
         *client_key = NULL;
         return status;
     }
+    _open_failed_ms.erase(hostport);
 
+    client_impl->set_send_timeout(timeout_ms);
+    client_impl->set_recv_timeout(timeout_ms);
     // Because the client starts life 'checked out', we don't add it to the cache map
     _client_map[*client_key] = client_impl.release();
 
@@ -179,6 +214,11 @@ void ClientCacheHelper::close_connections(const TNetworkAddress& hostport) {
         _client_map.erase(client_key);
         delete info;
     }
+    if (_metrics_enabled) {
+        _opened_clients->increment(-static_cast<int64_t>(cache_entry->second.size()));
+    }
+    // the keys must not be handed out again
+    cache_entry->second.clear();
 }
 
 std::string ClientCacheHelper::debug_string() {
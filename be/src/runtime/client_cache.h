@@ -51,8 +51,6 @@ namespace doris {
 // to list (or change to lock-free list)
 // TODO: reduce locking overhead and by adding per-address client caches, each with its
 // own lock.
-// TODO: More graceful handling of clients that have failed (maybe better
-// handled by a smart-wrapper of the interface object).
 // TODO: limits on total number of clients, and clients per-backend
 class ClientCacheHelper {
 public:
@@ -109,6 +107,9 @@ private:
     typedef boost::unordered_map<void*, ThriftClientImpl*> ClientMap;
     ClientMap _client_map;
 
+    // when opening a client to a host failed last, it is erased once one is opened
+    boost::unordered_map<TNetworkAddress, int64_t> _open_failed_ms;
+
     // MetricRegistry
     bool _metrics_enabled;
 
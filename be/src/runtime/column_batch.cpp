@@ -0,0 +1,332 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/column_batch.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <lz4/lz4.h>
+
+#include "common/config.h"
+#include "gen_cpp/data.pb.h"
+#include "runtime/mem_pool.h"
+#include "runtime/row_batch.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+
+namespace doris {
+
+ColumnBatch::ColumnBatch(const RowDescriptor& row_desc)
+        : _row_desc(row_desc),
+        _num_rows(0),
+        _has_selection(false) {
+    const std::vector<TupleDescriptor*>& tuple_descs = row_desc.tuple_descriptors();
+    for (int i = 0; i < tuple_descs.size(); ++i) {
+        for (auto slot : tuple_descs[i]->slots()) {
+            if (slot->is_materialized()) {
+                _slots.push_back(slot);
+                _slot_tuple_idx.push_back(i);
+            }
+        }
+    }
+    _columns.resize(_slots.size());
+    _tuple_nulls.resize(tuple_descs.size());
+}
+
+void ColumnBatch::reset(int num_rows) {
+    _num_rows = num_rows;
+    _has_selection = false;
+    for (int i = 0; i < _slots.size(); ++i) {
+        _columns[i].reset(_slots[i]->type().type, num_rows);
+    }
+    for (auto& nulls : _tuple_nulls) {
+        nulls.assign(num_rows, 0);
+    }
+}
+
+int ColumnBatch::column_index(SlotId id) const {
+    for (int i = 0; i < _slots.size(); ++i) {
+        if (_slots[i]->id() == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ColumnBatch::from_row_batch(RowBatch* batch) {
+    reset(batch->num_rows());
+    for (int t = 0; t < _tuple_nulls.size(); ++t) {
+        for (int i = 0; i < _num_rows; ++i) {
+            _tuple_nulls[t][i] = batch->get_row(i)->get_tuple(t) == NULL;
+        }
+    }
+    for (int c = 0; c < _slots.size(); ++c) {
+        const SlotDescriptor* slot = _slots[c];
+        ExprColumn* column = &_columns[c];
+        uint8_t* nulls = column->nulls();
+        int tuple_idx = _slot_tuple_idx[c];
+        for (int i = 0; i < _num_rows; ++i) {
+            Tuple* tuple = batch->get_row(i)->get_tuple(tuple_idx);
+            if (tuple == NULL || tuple->is_null(slot->null_indicator_offset())) {
+                nulls[i] = 1;
+            } else {
+                column->set_value(i, tuple->get_slot(slot->tuple_offset()));
+            }
+        }
+    }
+}
+
+void ColumnBatch::to_row_batch(RowBatch* batch) {
+    int n = num_selected();
+    if (n == 0) {
+        return;
+    }
+    int row_idx = batch->add_rows(n);
+    DCHECK_NE(row_idx, RowBatch::INVALID_ROW_INDEX);
+    const int* sel = selection();
+    MemPool* pool = batch->tuple_data_pool();
+
+    // tuples of all rows at once, all slots are not null in zeroed tuples
+    const std::vector<TupleDescriptor*>& tuple_descs = _row_desc.tuple_descriptors();
+    for (int t = 0; t < tuple_descs.size(); ++t) {
+        size_t tuple_size = tuple_descs[t]->byte_size();
+        uint8_t* tuple_buf = pool->allocate(tuple_size * n);
+        memset(tuple_buf, 0, tuple_size * n);
+        const uint8_t* tuple_nulls = _tuple_nulls[t].data();
+        int k = 0;
+        for_each_selected_row(sel, n, [&] (int row) {
+            Tuple* tuple = tuple_nulls[row] ? NULL
+                : reinterpret_cast<Tuple*>(tuple_buf + tuple_size * k);
+            batch->get_row(row_idx + k)->set_tuple(t, tuple);
+            ++k;
+        });
+    }
+
+    for (int c = 0; c < _slots.size(); ++c) {
+        const SlotDescriptor* slot = _slots[c];
+        ExprColumn* column = &_columns[c];
+        int tuple_idx = _slot_tuple_idx[c];
+        const NullIndicatorOffset& null_offset = slot->null_indicator_offset();
+        bool is_string = slot->type().is_string_type();
+        char* string_data = NULL;
+        if (is_string) {
+            // contents of all rows in one allocation
+            int64_t len = 0;
+            for_each_selected_row(sel, n, [&] (int row) {
+                if (!column->is_null(row)) {
+                    len += reinterpret_cast<StringValue*>(column->value(row))->len;
+                }
+            });
+            string_data = reinterpret_cast<char*>(pool->allocate(len));
+        }
+        int k = 0;
+        for_each_selected_row(sel, n, [&] (int row) {
+            Tuple* tuple = batch->get_row(row_idx + k++)->get_tuple(tuple_idx);
+            if (tuple == NULL) {
+                return;
+            }
+            if (column->is_null(row)) {
+                DCHECK(slot->is_nullable());
+                tuple->set_null(null_offset);
+            } else if (is_string) {
+                const StringValue* src = reinterpret_cast<StringValue*>(column->value(row));
+                StringValue* dst = tuple->get_string_slot(slot->tuple_offset());
+                memcpy(string_data, src->ptr, src->len);
+                dst->ptr = string_data;
+                dst->len = src->len;
+                string_data += src->len;
+            } else {
+                memcpy(tuple->get_slot(slot->tuple_offset()), column->value(row),
+                       slot->slot_size());
+            }
+        });
+    }
+    batch->commit_rows(n);
+}
+
+void ColumnBatch::serialize(PColumnarRowBatch* output) {
+    int n = num_selected();
+    const int* sel = selection();
+    output->set_num_rows(n);
+    output->clear_uncompressed_size();
+
+    size_t size = 0;
+    for (int t = 0; t < _tuple_nulls.size(); ++t) {
+        if (_row_desc.tuple_is_nullable(t)) {
+            size += n;
+        }
+    }
+    for (int c = 0; c < _slots.size(); ++c) {
+        ExprColumn* column = &_columns[c];
+        if (_slots[c]->is_nullable()) {
+            size += n;
+        }
+        if (!_slots[c]->type().is_string_type()) {
+            size += static_cast<size_t>(column->value_size()) * n;
+            continue;
+        }
+        size += sizeof(int32_t) * n;
+        for_each_selected_row(sel, n, [&] (int row) {
+            if (!column->is_null(row)) {
+                size += reinterpret_cast<StringValue*>(column->value(row))->len;
+            }
+        });
+    }
+
+    std::string* data = output->mutable_data();
+    data->resize(size);
+    char* ptr = &(*data)[0];
+    for (int t = 0; t < _tuple_nulls.size(); ++t) {
+        if (_row_desc.tuple_is_nullable(t)) {
+            const uint8_t* tuple_nulls = _tuple_nulls[t].data();
+            for_each_selected_row(sel, n, [&] (int row) { *ptr++ = tuple_nulls[row]; });
+        }
+    }
+    for (int c = 0; c < _slots.size(); ++c) {
+        ExprColumn* column = &_columns[c];
+        if (_slots[c]->is_nullable()) {
+            for_each_selected_row(sel, n, [&] (int row) { *ptr++ = column->is_null(row); });
+        }
+        if (_slots[c]->type().is_string_type()) {
+            // lengths first, contents of all rows after them
+            char* content = ptr + sizeof(int32_t) * n;
+            for_each_selected_row(sel, n, [&] (int row) {
+                int32_t len = 0;
+                if (!column->is_null(row)) {
+                    const StringValue* value = reinterpret_cast<StringValue*>(column->value(row));
+                    len = value->len;
+                    memcpy(content, value->ptr, len);
+                    content += len;
+                }
+                memcpy(ptr, &len, sizeof(len));
+                ptr += sizeof(len);
+            });
+            ptr = content;
+        } else {
+            int value_size = column->value_size();
+            for_each_selected_row(sel, n, [&] (int row) {
+                if (column->is_null(row)) {
+                    memset(ptr, 0, value_size);
+                } else {
+                    memcpy(ptr, column->value(row), value_size);
+                }
+                ptr += value_size;
+            });
+        }
+    }
+    DCHECK_EQ(ptr, data->data() + size);
+
+    if (config::compress_rowbatches && size > 0) {
+        int max_compressed_size = LZ4_compressBound(size);
+        if (_compression_scratch.size() < max_compressed_size) {
+            _compression_scratch.resize(max_compressed_size);
+        }
+        int compressed_size = LZ4_compress_default(
+                data->data(), &_compression_scratch[0], size, max_compressed_size);
+        if (LIKELY(compressed_size > 0 && compressed_size < size)) {
+            _compression_scratch.resize(compressed_size);
+            data->swap(_compression_scratch);
+            output->set_uncompressed_size(size);
+        }
+    }
+}
+
+Status ColumnBatch::deserialize(const PColumnarRowBatch& input) {
+    int n = std::max(input.num_rows(), 0);
+    reset(n);
+    if (n == 0) {
+        return Status::OK;
+    }
+
+    const char* data = input.data().data();
+    size_t size = input.data().size();
+    if (input.has_uncompressed_size()) {
+        _uncompressed_data.resize(input.uncompressed_size());
+        int res = LZ4_decompress_safe(data, &_uncompressed_data[0], size,
+                                      input.uncompressed_size());
+        if (res != input.uncompressed_size()) {
+            LOG(WARNING) << "fail to decompress column batch, res=" << res
+                << ", uncompressed_size=" << input.uncompressed_size();
+            return Status("fail to decompress column batch");
+        }
+        data = _uncompressed_data.data();
+        size = _uncompressed_data.size();
+    }
+
+    const char* ptr = data;
+    const char* end = data + size;
+    for (int t = 0; t < _tuple_nulls.size(); ++t) {
+        if (_row_desc.tuple_is_nullable(t)) {
+            if (end - ptr < n) {
+                return Status("column batch is truncated");
+            }
+            memcpy(_tuple_nulls[t].data(), ptr, n);
+            ptr += n;
+        }
+    }
+    for (int c = 0; c < _slots.size(); ++c) {
+        ExprColumn* column = &_columns[c];
+        uint8_t* nulls = column->nulls();
+        if (_slots[c]->is_nullable()) {
+            if (end - ptr < n) {
+                return Status("column batch is truncated");
+            }
+            memcpy(nulls, ptr, n);
+            ptr += n;
+        }
+        const uint8_t* tuple_nulls = _tuple_nulls[_slot_tuple_idx[c]].data();
+        for (int i = 0; i < n; ++i) {
+            nulls[i] |= tuple_nulls[i];
+        }
+        if (_slots[c]->type().is_string_type()) {
+            if (end - ptr < static_cast<int64_t>(sizeof(int32_t)) * n) {
+                return Status("column batch is truncated");
+            }
+            const char* content = ptr + sizeof(int32_t) * n;
+            StringValue* values = column->values<StringValue>();
+            for (int i = 0; i < n; ++i) {
+                int32_t len = 0;
+                memcpy(&len, ptr, sizeof(len));
+                ptr += sizeof(len);
+                if (len < 0 || end - content < len) {
+                    return Status("column batch is truncated");
+                }
+                values[i].ptr = const_cast<char*>(content);
+                values[i].len = len;
+                content += len;
+            }
+            ptr = content;
+        } else {
+            size_t values_size = static_cast<size_t>(column->value_size()) * n;
+            if (end - ptr < static_cast<int64_t>(values_size)) {
+                return Status("column batch is truncated");
+            }
+            memcpy(column->data(), ptr, values_size);
+            ptr += values_size;
+        }
+    }
+    if (ptr != end) {
+        return Status("column batch has unknown data");
+    }
+    return Status::OK;
+}
+
+}
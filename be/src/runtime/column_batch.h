@@ -0,0 +1,124 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_RUNTIME_COLUMN_BATCH_H
+#define DORIS_BE_RUNTIME_COLUMN_BATCH_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "common/status.h"
+#include "exprs/expr_column.h"
+#include "runtime/descriptors.h"
+
+namespace doris {
+
+class PColumnarRowBatch;
+class RowBatch;
+
+// Rows of a RowDescriptor stored column by column, for operators which work
+// on the values of many rows at once. Every materialized slot of the tuples
+// of the row has a nullable ExprColumn, whose string values point into the
+// source of the batch or into the string data of the column. A selection
+// vector tells which rows are passed on, so filters need not move values.
+//
+// Operators which keep working on RowBatch are joined to columnar ones by
+// from_row_batch() and to_row_batch().
+class ColumnBatch {
+public:
+    explicit ColumnBatch(const RowDescriptor& row_desc);
+
+    const RowDescriptor& row_desc() const { return _row_desc; }
+
+    // Prepares for 'num_rows' rows, all selected and with no NULL tuple. The
+    // columns keep their memory.
+    void reset(int num_rows);
+
+    int num_rows() const { return _num_rows; }
+
+    // The selected rows in increasing order, NULL if all rows are selected.
+    // Can be passed to ExprContext::evaluate().
+    const int* selection() const {
+        return _has_selection ? _selection.data() : NULL;
+    }
+
+    int num_selected() const {
+        return _has_selection ? _selection.size() : _num_rows;
+    }
+
+    // Selects rows 'sel[0]', ..., 'sel[n - 1]', which increase.
+    void select(const int* sel, int n) {
+        _selection.assign(sel, sel + n);
+        _has_selection = true;
+    }
+
+    void select_all() { _has_selection = false; }
+
+    int num_columns() const { return _slots.size(); }
+
+    const SlotDescriptor* slot(int i) const { return _slots[i]; }
+
+    ExprColumn* column(int i) { return &_columns[i]; }
+
+    // index of the column of the slot, -1 if it is not materialized
+    int column_index(SlotId id) const;
+
+    // A byte per row, not 0 if tuple 'tuple_idx' of the row is NULL. Slots of
+    // NULL tuples are null.
+    uint8_t* tuple_nulls(int tuple_idx) { return _tuple_nulls[tuple_idx].data(); }
+
+    // Takes all rows of 'batch', strings point into it.
+    void from_row_batch(RowBatch* batch);
+
+    // Appends the selected rows to 'batch', which must have room for them.
+    // Tuples and strings are copied into its tuple data pool.
+    void to_row_batch(RowBatch* batch);
+
+    // Encodes the selected rows. For every tuple there is a NULL flag byte per
+    // row if the tuple is nullable, then every materialized slot is stored as
+    // by ColumnarRowBatch. Compressed by LZ4 if config::compress_rowbatches is
+    // true and the data gets smaller.
+    void serialize(PColumnarRowBatch* output);
+
+    // Strings point into 'input' or into this batch, so they are valid as long
+    // as both are.
+    Status deserialize(const PColumnarRowBatch& input);
+
+private:
+    const RowDescriptor& _row_desc;
+    int _num_rows;
+
+    std::vector<int> _selection;
+    bool _has_selection;
+
+    // materialized slots of all tuples, in the order of the tuple descriptors
+    std::vector<const SlotDescriptor*> _slots;
+    // index of the tuple of each slot in the row
+    std::vector<int> _slot_tuple_idx;
+    std::vector<ExprColumn> _columns;
+    std::vector<std::vector<uint8_t>> _tuple_nulls;
+
+    std::string _compression_scratch;
+    std::string _uncompressed_data;
+};
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/columnar_row_batch.h"
+
+#include <string.h>
+
+#include <lz4/lz4.h>
+
+#include "common/config.h"
+#include "gen_cpp/data.pb.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_pool.h"
+#include "runtime/row_batch.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+
+namespace doris {
+
+void ColumnarRowBatch::serialize(RowBatch* batch, PColumnarRowBatch* output) {
+    int num_rows = batch->num_rows();
+    output->set_num_rows(num_rows);
+    output->clear_uncompressed_size();
+
+    size_t size = 0;
+    for (auto slot : _desc.slots()) {
+        if (!slot->is_materialized()) {
+            continue;
+        }
+        if (slot->is_nullable()) {
+            size += num_rows;
+        }
+        if (!slot->type().is_string_type()) {
+            size += static_cast<size_t>(slot->slot_size()) * num_rows;
+            continue;
+        }
+        size += sizeof(int32_t) * num_rows;
+        for (int i = 0; i < num_rows; ++i) {
+            Tuple* tuple = batch->get_row(i)->get_tuple(0);
+            if (!tuple->is_null(slot->null_indicator_offset())) {
+                size += tuple->get_string_slot(slot->tuple_offset())->len;
+            }
+        }
+    }
+
+    std::string* data = output->mutable_data();
+    data->resize(size);
+    char* ptr = &(*data)[0];
+    for (auto slot : _desc.slots()) {
+        if (!slot->is_materialized()) {
+            continue;
+        }
+        const NullIndicatorOffset& null_offset = slot->null_indicator_offset();
+        if (slot->is_nullable()) {
+            for (int i = 0; i < num_rows; ++i) {
+                *ptr++ = batch->get_row(i)->get_tuple(0)->is_null(null_offset);
+            }
+        }
+        if (slot->type().is_string_type()) {
+            // lengths first, contents of all rows after them
+            char* content = ptr + sizeof(int32_t) * num_rows;
+            for (int i = 0; i < num_rows; ++i) {
+                Tuple* tuple = batch->get_row(i)->get_tuple(0);
+                int32_t len = 0;
+                if (!tuple->is_null(null_offset)) {
+                    const StringValue* value = tuple->get_string_slot(slot->tuple_offset());
+                    len = value->len;
+                    memcpy(content, value->ptr, len);
+                    content += len;
+                }
+                memcpy(ptr, &len, sizeof(len));
+                ptr += sizeof(len);
+            }
+            ptr = content;
+        } else {
+            int slot_size = slot->slot_size();
+            for (int i = 0; i < num_rows; ++i) {
+                Tuple* tuple = batch->get_row(i)->get_tuple(0);
+                if (tuple->is_null(null_offset)) {
+                    memset(ptr, 0, slot_size);
+                } else {
+                    memcpy(ptr, tuple->get_slot(slot->tuple_offset()), slot_size);
+                }
+                ptr += slot_size;
+            }
+        }
+    }
+    DCHECK_EQ(ptr, data->data() + size);
+
+    if (config::compress_rowbatches && size > 0) {
+        int max_compressed_size = LZ4_compressBound(size);
+        if (_compression_scratch.size() < max_compressed_size) {
+            _compression_scratch.resize(max_compressed_size);
+        }
+        int compressed_size = LZ4_compress_default(
+                data->data(), &_compression_scratch[0], size, max_compressed_size);
+        if (LIKELY(compressed_size > 0 && compressed_size < size)) {
+            _compression_scratch.resize(compressed_size);
+            data->swap(_compression_scratch);
+            output->set_uncompressed_size(size);
+        }
+    }
+}
+
+Status ColumnarRowBatch::deserialize(const PColumnarRowBatch& input, MemPool* pool,
+                                     std::vector<Tuple*>* tuples) {
+    int num_rows = input.num_rows();
+    tuples->clear();
+    if (num_rows <= 0) {
+        return Status::OK;
+    }
+
+    const char* data = input.data().data();
+    size_t size = input.data().size();
+    if (input.has_uncompressed_size()) {
+        char* buf = reinterpret_cast<char*>(pool->allocate(input.uncompressed_size()));
+        int res = LZ4_decompress_safe(data, buf, size, input.uncompressed_size());
+        if (res != input.uncompressed_size()) {
+            LOG(WARNING) << "fail to decompress columnar row batch, res=" << res
+                << ", uncompressed_size=" << input.uncompressed_size();
+            return Status("fail to decompress columnar row batch");
+        }
+        data = buf;
+        size = input.uncompressed_size();
+    }
+
+    int tuple_size = _desc.byte_size();
+    uint8_t* tuple_buf = pool->allocate(static_cast<int64_t>(tuple_size) * num_rows);
+    // all slots are not null in zeroed tuples
+    memset(tuple_buf, 0, static_cast<size_t>(tuple_size) * num_rows);
+    tuples->resize(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+        (*tuples)[i] = reinterpret_cast<Tuple*>(tuple_buf + static_cast<size_t>(tuple_size) * i);
+    }
+
+    const char* ptr = data;
+    const char* end = data + size;
+    for (auto slot : _desc.slots()) {
+        if (!slot->is_materialized()) {
+            continue;
+        }
+        const NullIndicatorOffset& null_offset = slot->null_indicator_offset();
+        if (slot->is_nullable()) {
+            if (end - ptr < num_rows) {
+                return Status("columnar row batch is truncated");
+            }
+            for (int i = 0; i < num_rows; ++i) {
+                if (ptr[i]) {
+                    (*tuples)[i]->set_null(null_offset);
+                }
+            }
+            ptr += num_rows;
+        }
+        if (slot->type().is_string_type()) {
+            if (end - ptr < static_cast<int64_t>(sizeof(int32_t)) * num_rows) {
+                return Status("columnar row batch is truncated");
+            }
+            const char* content = ptr + sizeof(int32_t) * num_rows;
+            for (int i = 0; i < num_rows; ++i) {
+                int32_t len = 0;
+                memcpy(&len, ptr, sizeof(len));
+                ptr += sizeof(len);
+                if (len < 0 || end - content < len) {
+                    return Status("columnar row batch is truncated");
+                }
+                StringValue* value = (*tuples)[i]->get_string_slot(slot->tuple_offset());
+                value->ptr = const_cast<char*>(content);
+                value->len = len;
+                content += len;
+            }
+            ptr = content;
+        } else {
+            int slot_size = slot->slot_size();
+            if (end - ptr < static_cast<int64_t>(slot_size) * num_rows) {
+                return Status("columnar row batch is truncated");
+            }
+            for (int i = 0; i < num_rows; ++i) {
+                memcpy((*tuples)[i]->get_slot(slot->tuple_offset()), ptr, slot_size);
+                ptr += slot_size;
+            }
+        }
+    }
+    if (ptr != end) {
+        return Status("columnar row batch has unknown data");
+    }
+    return Status::OK;
+}
+
+}  // namespace doris
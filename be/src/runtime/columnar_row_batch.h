@@ -0,0 +1,62 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_COLUMNAR_ROW_BATCH_H
+#define DORIS_BE_RUNTIME_COLUMNAR_ROW_BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "common/status.h"
+
+namespace doris {
+
+class MemPool;
+class PColumnarRowBatch;
+class RowBatch;
+class Tuple;
+class TupleDescriptor;
+
+// Encodes rows made of one tuple column by column, which is much smaller than
+// a serialized RowBatch once compressed: values of a column are alike, and
+// null or padding bytes of tuples are not sent.
+//
+// Every materialized slot is stored in the order of the tuple descriptor:
+// a null flag byte per row if the slot is nullable, then either the values
+// of all rows, slot_size bytes each, or for strings 4 bytes of length of
+// every row followed by the content of all rows.
+class ColumnarRowBatch {
+public:
+    ColumnarRowBatch(const TupleDescriptor& desc) : _desc(desc) { }
+
+    // compressed by LZ4 if config::compress_rowbatches is true and the data
+    // gets smaller
+    void serialize(RowBatch* batch, PColumnarRowBatch* output);
+
+    // Tuples are allocated from 'pool', their strings point into 'pool' or
+    // 'input', so they are valid as long as both are.
+    Status deserialize(const PColumnarRowBatch& input, MemPool* pool,
+                       std::vector<Tuple*>* tuples);
+
+private:
+    const TupleDescriptor& _desc;
+    std::string _compression_scratch;
+};
+
+}  // namespace doris
+
+#endif // DORIS_BE_RUNTIME_COLUMNAR_ROW_BATCH_H
@@ -93,7 +93,9 @@ shared_ptr<DataStreamRecvr> DataStreamMgr::find_recvr(
     return shared_ptr<DataStreamRecvr>();
 }
 
-Status DataStreamMgr::transmit_data(const PTransmitDataParams* request, ::google::protobuf::Closure** done) {
+Status DataStreamMgr::transmit_data(const PTransmitDataParams* request,
+                                    ::google::protobuf::Closure** done,
+                                    const butil::IOBuf* attachment) {
     const PUniqueId& finst_id = request->finst_id();
     TUniqueId t_finst_id;
     t_finst_id.hi = finst_id.hi();
@@ -120,7 +122,10 @@ Status DataStreamMgr::transmit_data(const PTransmitDataParams* request, ::google
 
     bool eos = request->eos();
     if (request->has_row_batch()) {
-        recvr->add_batch(request->row_batch(), request->sender_id(), 
+        recvr->add_batch(request->row_batch(), attachment, request->sender_id(),
+                request->be_number(), request->packet_seq(), eos ? nullptr : done);
+    } else if (request->has_columnar_batch()) {
+        recvr->add_columnar_batch(request->columnar_batch(), request->sender_id(),
                 request->be_number(), request->packet_seq(), eos ? nullptr : done);
     }
 
@@ -130,6 +135,26 @@ Status DataStreamMgr::transmit_data(const PTransmitDataParams* request, ::google
     return Status::OK;
 }
 
+Status DataStreamMgr::transmit_local_data(
+        const TUniqueId& fragment_instance_id, PlanNodeId node_id, int sender_id,
+        int be_number, RowBatch* batch, bool eos, const PQueryStatistics* statistics) {
+    shared_ptr<DataStreamRecvr> recvr = find_recvr(fragment_instance_id, node_id);
+    if (recvr == nullptr) {
+        // the receiver is gone, see transmit_data()
+        return Status::OK;
+    }
+    if (statistics != nullptr) {
+        recvr->add_sub_plan_statistics(*statistics, sender_id);
+    }
+    if (batch != nullptr && batch->num_rows() > 0) {
+        recvr->add_local_batch(batch, sender_id);
+    }
+    if (eos) {
+        recvr->remove_sender(sender_id, be_number);
+    }
+    return Status::OK;
+}
+
 Status DataStreamMgr::deregister_recvr(
         const TUniqueId& fragment_instance_id, PlanNodeId node_id) {
     VLOG_QUERY << "deregister_recvr(): fragment_instance_id=" << fragment_instance_id
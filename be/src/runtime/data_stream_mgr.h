@@ -41,6 +41,10 @@ class Closure;
 }
 }
 
+namespace butil {
+class IOBuf;
+}
+
 namespace doris {
 
 class DescriptorTbl;
@@ -49,6 +53,7 @@ class RowBatch;
 class RuntimeState;
 class PRowBatch;
 class PUniqueId;
+class PQueryStatistics;
 
 // Singleton class which manages all incoming data streams at a backend node. It
 // provides both producer and consumer functionality for each data stream.
@@ -80,7 +85,16 @@ public:
             int num_senders, int buffer_size, RuntimeProfile* profile,
             bool is_merging, std::shared_ptr<QueryStatisticsRecvr> sub_plan_query_statistics_recvr);
 
-    Status transmit_data(const PTransmitDataParams* request, ::google::protobuf::Closure** done);
+    // 'attachment' is the attachment of the RPC, it may hold the tuple data
+    Status transmit_data(const PTransmitDataParams* request, ::google::protobuf::Closure** done,
+                         const butil::IOBuf* attachment = nullptr);
+
+    // Like transmit_data() for a sender in this process: the rows of 'batch' are
+    // copied to the receiver, 'batch' may be nullptr, 'statistics' is attached if
+    // it is not nullptr. Blocks while the buffer of the receiver is full.
+    Status transmit_local_data(const TUniqueId& fragment_instance_id, PlanNodeId node_id,
+                               int sender_id, int be_number, RowBatch* batch, bool eos,
+                               const PQueryStatistics* statistics);
 
     // Closes all receivers registered for fragment_instance_id immediately.
     void cancel(const TUniqueId& fragment_instance_id);
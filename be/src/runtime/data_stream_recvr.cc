@@ -17,6 +17,8 @@
 
 #include "runtime/data_stream_recvr.h"
 
+#include <algorithm>
+#include <functional>
 #include <unordered_set>
 #include <unordered_map>
 #include <deque>
@@ -25,7 +27,9 @@
 #include <boost/thread/mutex.hpp>
 #include <google/protobuf/stubs/common.h>
 
+#include "common/config.h"
 #include "gen_cpp/data.pb.h"
+#include "runtime/column_batch.h"
 #include "runtime/data_stream_mgr.h"
 #include "runtime/row_batch.h"
 #include "runtime/sorted_run_merger.h"
@@ -71,17 +75,28 @@ public:
     // If the total size of the batches in this queue would exceed the allowed buffer size,
     // the queue is considered full and the call blocks until a batch is dequeued.
     void add_batch(
-        const PRowBatch& pb_batch,
+        const PRowBatch& pb_batch, const butil::IOBuf* attachment,
         int be_number, int64_t packet_seq,
         ::google::protobuf::Closure** done);
 
+    // Same as add_batch() for a batch encoded by column.
+    void add_columnar_batch(
+        const PColumnarRowBatch& pb_batch,
+        int be_number, int64_t packet_seq,
+        ::google::protobuf::Closure** done);
+
+    // Adds a deep copy of a row batch of a sender in this process. Blocks while the
+    // buffer limit is exceeded and this queue is not empty, as the rpc path withholds
+    // the ack of the batch then.
+    void add_local_batch(RowBatch* batch);
+
     // Decrement the number of remaining senders for this queue and signal eos ("new data")
     // if the count drops to 0. The number of senders will be 1 for a merging
     // DataStreamRecvr.
     void decrement_senders(int sender_id);
 
-    // Set cancellation flag and signal cancellation to receiver and sender. Subsequent
-    // incoming batches will be dropped.
+    // Set cancellation flag and signal cancellation to receiver and sender. The queued
+    // batches are freed and subsequent incoming batches will be dropped.
     void cancel();
 
     // Must be called once to cleanup any queued resources.
@@ -93,6 +108,13 @@ public:
     }
 
 private:
+    // Enqueues the batch made by 'create_batch' under _lock, which may return
+    // NULL to drop it.
+    void _add_batch(
+        int batch_size, const std::function<RowBatch*()>& create_batch,
+        int be_number, int64_t packet_seq,
+        ::google::protobuf::Closure** done);
+
     // Receiver of which this queue is a member.
     DataStreamRecvr* _recvr;
 
@@ -112,11 +134,25 @@ private:
     // signal removal of data by stream consumer
     condition_variable _data_removal_cv;
 
-    // queue of (batch length, batch) pairs.  The SenderQueue block owns memory to
+    struct BufferedBatch {
+        int size;
+        // sender of the batch, -1 for the senders in this process
+        int be_number;
+        RowBatch* batch;
+    };
+
+    // Acks the pending closures of the senders which are within their share of the
+    // buffer again, all of them once the queue is empty so that the stream goes on.
+    void _release_closures();
+
+    // queue of the batches received.  The SenderQueue block owns memory to
     // these batches. They are handed off to the caller via get_batch.
-    typedef list<pair<int, RowBatch*> > RowBatchQueue;
+    typedef list<BufferedBatch> RowBatchQueue;
     RowBatchQueue _batch_queue;
 
+    // be_number => bytes of the batches of the sender in _batch_queue
+    std::unordered_map<int, int64_t> _sender_buffered_bytes;
+
     // The batch that was most recently returned via get_batch(), i.e. the current batch
     // from this queue being processed by a consumer. Is destroyed when the next batch
     // is retrieved.
@@ -128,7 +164,8 @@ private:
     std::unordered_set<int> _sender_eos_set; // sender_id
     std::unordered_map<int, int64_t> _packet_seq_map; // be_number => packet_seq
 
-    std::deque<google::protobuf::Closure*> _pending_closures;
+    // (be_number, closure) of the senders whose last batch is not acked yet
+    std::deque<std::pair<int, google::protobuf::Closure*>> _pending_closures;
 };
 
 DataStreamRecvr::SenderQueue::SenderQueue(
@@ -168,25 +205,53 @@ Status DataStreamRecvr::SenderQueue::get_batch(RowBatch** next_batch) {
     _received_first_batch = true;
 
     DCHECK(!_batch_queue.empty());
-    RowBatch* result = _batch_queue.front().second;
-    _recvr->_num_buffered_bytes -= _batch_queue.front().first;
+    const BufferedBatch& front = _batch_queue.front();
+    RowBatch* result = front.batch;
+    _recvr->_num_buffered_bytes -= front.size;
+    _sender_buffered_bytes[front.be_number] -= front.size;
     VLOG_ROW << "fetched #rows=" << result->num_rows();
     _batch_queue.pop_front();
-    // _data_removal_cv.notify_one();
+    _data_removal_cv.notify_one();
     _current_batch.reset(result);
     *next_batch = _current_batch.get();
 
-    if (!_pending_closures.empty()) {
-        auto done = _pending_closures.front();
-        done->Run();
-        _pending_closures.pop_front();
-    }
+    _release_closures();
 
     return Status::OK;
 }
 
 void DataStreamRecvr::SenderQueue::add_batch(
-        const PRowBatch& pb_batch,
+        const PRowBatch& pb_batch, const butil::IOBuf* attachment,
+        int be_number, int64_t packet_seq,
+        ::google::protobuf::Closure** done) {
+    _add_batch(RowBatch::get_batch_size(pb_batch, attachment), [this, &pb_batch, attachment]() {
+            return new RowBatch(_recvr->row_desc(), pb_batch, _recvr->mem_tracker(), attachment);
+        }, be_number, packet_seq, done);
+}
+
+void DataStreamRecvr::SenderQueue::add_columnar_batch(
+        const PColumnarRowBatch& pb_batch,
+        int be_number, int64_t packet_seq,
+        ::google::protobuf::Closure** done) {
+    int batch_size = pb_batch.has_uncompressed_size()
+        ? pb_batch.uncompressed_size() : pb_batch.data().size();
+    _add_batch(batch_size, [this, &pb_batch]() -> RowBatch* {
+            ColumnBatch columns(_recvr->row_desc());
+            Status status = columns.deserialize(pb_batch);
+            if (!status.ok()) {
+                LOG(WARNING) << "fail to deserialize columnar batch, drop it: "
+                    << status.get_error_msg();
+                return NULL;
+            }
+            RowBatch* batch = new RowBatch(_recvr->row_desc(),
+                    std::max(columns.num_rows(), 1), _recvr->mem_tracker());
+            columns.to_row_batch(batch);
+            return batch;
+        }, be_number, packet_seq, done);
+}
+
+void DataStreamRecvr::SenderQueue::_add_batch(
+        int batch_size, const std::function<RowBatch*()>& create_batch,
         int be_number, int64_t packet_seq,
         ::google::protobuf::Closure** done) {
     unique_lock<mutex> l(_lock);
@@ -205,7 +270,6 @@ void DataStreamRecvr::SenderQueue::add_batch(
         _packet_seq_map.emplace(be_number, packet_seq);
     }
 
-    int batch_size = RowBatch::get_batch_size(pb_batch);
     COUNTER_UPDATE(_recvr->_bytes_received_counter, batch_size);
 
     // Following situation will match the following condition.
@@ -240,22 +304,59 @@ void DataStreamRecvr::SenderQueue::add_batch(
         // Note: if this function makes a row batch, the batch *must* be added
         // to _batch_queue. It is not valid to create the row batch and destroy
         // it in this thread.
-        batch = new RowBatch(_recvr->row_desc(), pb_batch, _recvr->mem_tracker());
+        batch = create_batch();
+    }
+    if (batch == NULL) {
+        return;
     }
    
     VLOG_ROW << "added #rows=" << batch->num_rows()
         << " batch_size=" << batch_size << "\n";
-    _batch_queue.emplace_back(batch_size, batch);
+    _batch_queue.push_back({batch_size, be_number, batch});
+    int64_t& sender_bytes = _sender_buffered_bytes[be_number];
+    sender_bytes += batch_size;
     // if done is nullptr, this function can't delay this response
-    if (done != nullptr && _recvr->exceeds_limit(batch_size)) {
+    if (done != nullptr && _recvr->withholds_ack(batch_size, sender_bytes)) {
         DCHECK(*done != nullptr);
-        _pending_closures.push_back(*done);
+        _pending_closures.emplace_back(be_number, *done);
         *done = nullptr;
     }
     _recvr->_num_buffered_bytes += batch_size;
     _data_arrival_cv.notify_one();
 }
 
+void DataStreamRecvr::SenderQueue::_release_closures() {
+    for (auto it = _pending_closures.begin(); it != _pending_closures.end();) {
+        if (_batch_queue.empty()
+                || !_recvr->withholds_ack(0, _sender_buffered_bytes[it->first])) {
+            it->second->Run();
+            it = _pending_closures.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DataStreamRecvr::SenderQueue::add_local_batch(RowBatch* batch) {
+    unique_lock<mutex> l(_lock);
+    while (!_is_cancelled && !_batch_queue.empty() && _recvr->exceeds_limit(0)) {
+        _data_removal_cv.wait(l);
+    }
+    if (_is_cancelled || _num_remaining_senders <= 0) {
+        return;
+    }
+
+    RowBatch* copy = new RowBatch(_recvr->row_desc(), batch->num_rows(), _recvr->mem_tracker());
+    batch->deep_copy_to(copy);
+    int batch_size = copy->total_byte_size();
+    COUNTER_UPDATE(_recvr->_bytes_received_counter, batch_size);
+    VLOG_ROW << "added local #rows=" << copy->num_rows() << " batch_size=" << batch_size;
+    _batch_queue.push_back({batch_size, -1, copy});
+    _sender_buffered_bytes[-1] += batch_size;
+    _recvr->_num_buffered_bytes += batch_size;
+    _data_arrival_cv.notify_one();
+}
+
 void DataStreamRecvr::SenderQueue::decrement_senders(int be_number) {
     lock_guard<mutex> l(_lock);
     if (_sender_eos_set.end() != _sender_eos_set.find(be_number)) {
@@ -287,16 +388,25 @@ void DataStreamRecvr::SenderQueue::cancel() {
     // Wake up all threads waiting to produce/consume batches.  They will all
     // notice that the stream is cancelled and handle it.
     _data_arrival_cv.notify_all();
-    // _data_removal_cv.notify_all();
+    _data_removal_cv.notify_all();
     // PeriodicCounterUpdater::StopTimeSeriesCounter(
     //         _recvr->_bytes_received_time_series_counter);
 
     {
         boost::lock_guard<boost::mutex> l(_lock);
-        for (auto done : _pending_closures) {
-            done->Run();
+        for (auto& done : _pending_closures) {
+            done.second->Run();
         }
         _pending_closures.clear();
+
+        // the queued batches are never returned once cancelled, give back their
+        // memory now instead of when the fragment is closed
+        for (auto& buffered : _batch_queue) {
+            _recvr->_num_buffered_bytes -= buffered.size;
+            _sender_buffered_bytes[buffered.be_number] -= buffered.size;
+            delete buffered.batch;
+        }
+        _batch_queue.clear();
     }
 }
 
@@ -308,22 +418,24 @@ void DataStreamRecvr::SenderQueue::close() {
         boost::lock_guard<boost::mutex> l(_lock);
         _is_cancelled = true;
 
-        for (auto done : _pending_closures) {
-            done->Run();
+        for (auto& done : _pending_closures) {
+            done.second->Run();
         }
         _pending_closures.clear();
     }
+    _data_removal_cv.notify_all();
 
     // Delete any batches queued in _batch_queue
     for (RowBatchQueue::iterator it = _batch_queue.begin();
             it != _batch_queue.end(); ++it) {
-        delete it->second;
+        delete it->batch;
     }
 
     _current_batch.reset();
 }
 
-Status DataStreamRecvr::create_merger(const TupleRowComparator& less_than) {
+Status DataStreamRecvr::create_merger(const TupleRowComparator& less_than,
+                                      RuntimeState* state) {
     DCHECK(_is_merging);
     vector<SortedRunMerger::RunBatchSupplier> input_batch_suppliers;
     input_batch_suppliers.reserve(_sender_queues.size());
@@ -335,7 +447,12 @@ Status DataStreamRecvr::create_merger(const TupleRowComparator& less_than) {
         input_batch_suppliers.push_back(
                 bind(mem_fn(&SenderQueue::get_batch), _sender_queues[i], _1));
     }
-    RETURN_IF_ERROR(_merger->prepare(input_batch_suppliers));
+    if (state != NULL && config::exchg_node_merge_threads > 1) {
+        RETURN_IF_ERROR(_merger->prepare_parallel(input_batch_suppliers,
+                    config::exchg_node_merge_threads, state, _mem_tracker.get()));
+    } else {
+        RETURN_IF_ERROR(_merger->prepare(input_batch_suppliers));
+    }
     return Status::OK;
 }
 
@@ -345,6 +462,7 @@ void DataStreamRecvr::transfer_all_resources(RowBatch* transfer_batch) {
             sender_queue->current_batch()->transfer_resource_ownership(transfer_batch);
         }
     }
+    _merger->transfer_all_resources(transfer_batch);
 }
 
 DataStreamRecvr::DataStreamRecvr(
@@ -357,6 +475,7 @@ DataStreamRecvr::DataStreamRecvr(
             _fragment_instance_id(fragment_instance_id),
             _dest_node_id(dest_node_id),
             _total_buffer_limit(total_buffer_limit),
+            _sender_buffer_limit(total_buffer_limit / std::max(num_senders, 1)),
             _row_desc(row_desc),
             _is_merging(is_merging),
             _num_buffered_bytes(0),
@@ -393,12 +512,25 @@ Status DataStreamRecvr::get_next(RowBatch* output_batch, bool* eos) {
 }
 
 void DataStreamRecvr::add_batch(
-        const PRowBatch& batch, int sender_id,
+        const PRowBatch& batch, const butil::IOBuf* attachment, int sender_id,
         int be_number, int64_t packet_seq,
         ::google::protobuf::Closure** done) {
     int use_sender_id = _is_merging ? sender_id : 0;
     // Add all batches to the same queue if _is_merging is false.
-    _sender_queues[use_sender_id]->add_batch(batch, be_number, packet_seq, done);
+    _sender_queues[use_sender_id]->add_batch(batch, attachment, be_number, packet_seq, done);
+}
+
+void DataStreamRecvr::add_columnar_batch(
+        const PColumnarRowBatch& batch, int sender_id,
+        int be_number, int64_t packet_seq,
+        ::google::protobuf::Closure** done) {
+    int use_sender_id = _is_merging ? sender_id : 0;
+    _sender_queues[use_sender_id]->add_columnar_batch(batch, be_number, packet_seq, done);
+}
+
+void DataStreamRecvr::add_local_batch(RowBatch* batch, int sender_id) {
+    int use_sender_id = _is_merging ? sender_id : 0;
+    _sender_queues[use_sender_id]->add_local_batch(batch);
 }
 
 void DataStreamRecvr::remove_sender(int sender_id, int be_number) {
@@ -413,6 +545,12 @@ void DataStreamRecvr::cancel_stream() {
 }
 
 void DataStreamRecvr::close() {
+    if (_merger != NULL) {
+        // The merge threads may wait for batches of the senders, they are woken up
+        // and stopped before the queues are closed.
+        cancel_stream();
+        _merger.reset();
+    }
     for (int i = 0; i < _sender_queues.size(); ++i) {
         _sender_queues[i]->close();
     }
@@ -34,6 +34,10 @@ class Closure;
 }
 }
 
+namespace butil {
+class IOBuf;
+}
+
 namespace doris {
 
 class DataStreamMgr;
@@ -41,7 +45,9 @@ class SortedRunMerger;
 class MemTracker;
 class RowBatch;
 class RuntimeProfile;
+class RuntimeState;
 class PRowBatch;
+class PColumnarRowBatch;
 
 // Single receiver of an m:n data stream.
 // DataStreamRecvr maintains one or more queues of row batches received by a
@@ -85,7 +91,9 @@ public:
     // Create a SortedRunMerger instance to merge rows from multiple sender according to the
     // specified row comparator. Fetches the first batches from the individual sender
     // queues. The exprs used in less_than must have already been prepared and opened.
-    Status create_merger(const TupleRowComparator& less_than);
+    // If 'state' is given the senders may be merged by several threads, see
+    // config::exchg_node_merge_threads.
+    Status create_merger(const TupleRowComparator& less_than, RuntimeState* state = NULL);
 
     // Fill output_batch with the next batch of rows obtained by merging the per-sender
     // input streams. Must only be called if _is_merging is true.
@@ -114,11 +122,20 @@ private:
             int total_buffer_limit, RuntimeProfile* profile, 
             std::shared_ptr<QueryStatisticsRecvr> sub_plan_query_statistics_recvr);
 
-    // If receive queue is full, done is enqueue pending, and return with *done is nullptr
-    void add_batch(const PRowBatch& batch, int sender_id,
+    // If receive queue is full, done is enqueue pending, and return with *done is nullptr.
+    // 'attachment' is the attachment of the RPC, see RowBatch.
+    void add_batch(const PRowBatch& batch, const butil::IOBuf* attachment, int sender_id,
+                   int be_number, int64_t packet_seq,
+                   ::google::protobuf::Closure** done);
+
+    // Same as add_batch() for a batch encoded by column.
+    void add_columnar_batch(const PColumnarRowBatch& batch, int sender_id,
                    int be_number, int64_t packet_seq,
                    ::google::protobuf::Closure** done);
 
+    // Adds a copy of 'batch' of a sender in this process, without serialization.
+    void add_local_batch(RowBatch* batch, int sender_id);
+
     // Indicate that a particular sender is done. Delegated to the appropriate
     // sender queue. Called from DataStreamMgr.
     void remove_sender(int sender_id, int be_number);
@@ -132,6 +149,15 @@ private:
         return _num_buffered_bytes + batch_size > _total_buffer_limit;
     }
 
+    // Return true if the batches of a sender which buffers 'sender_bytes' may not be
+    // acked yet: the total buffer limit or the share of the sender of it would be
+    // exceeded, or the memory of the query is used up.
+    bool withholds_ack(int batch_size, int64_t sender_bytes) {
+        return exceeds_limit(batch_size)
+            || sender_bytes > _sender_buffer_limit
+            || _mem_tracker->spare_capacity() < batch_size;
+    }
+
     // DataStreamMgr instance used to create this recvr. (Not owned)
     DataStreamMgr* _mgr;
 
@@ -144,6 +170,10 @@ private:
     // exceeds this value
     int _total_buffer_limit;
 
+    // share of _total_buffer_limit of every sender, so that fast senders do not
+    // take all of the buffer under skew
+    int64_t _sender_buffer_limit;
+
     // Row schema, copied from the caller of CreateRecvr().
     RowDescriptor _row_desc;
 
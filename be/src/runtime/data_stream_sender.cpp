@@ -22,8 +22,10 @@
 #include <boost/thread/thread.hpp>
 #include <thrift/protocol/TDebugProtocol.h>
 
+#include "common/config.h"
 #include "common/logging.h"
 #include "exprs/expr.h"
+#include "runtime/column_batch.h"
 #include "runtime/descriptors.h"
 #include "runtime/exec_env.h"
 #include "runtime/tuple_row.h"
@@ -33,7 +35,9 @@
 #include "runtime/client_cache.h"
 #include "runtime/dpp_sink_internal.h"
 #include "runtime/mem_tracker.h"
+#include "runtime/tracer.h"
 #include "util/debug_util.h"
+#include "util/stopwatch.hpp"
 #include "util/network_util.h"
 #include "util/thrift_client.h"
 #include "util/thrift_util.h"
@@ -46,6 +50,7 @@
 
 #include <arpa/inet.h>
 
+#include "service/backend_options.h"
 #include "service/brpc.h"
 
 #include "util/thrift_util.h"
@@ -105,16 +110,33 @@ public:
     // Returns error status if any of the preceding rpcs failed, OK otherwise.
     Status add_row(TupleRow* row);
 
+    // Copies the rows of 'batch' at 'rows' like add_row().
+    Status add_rows(RowBatch* batch, const std::vector<int>& rows);
+
+    // Copies the rows of 'batch' to the receiver of a local channel, 'batch' may be
+    // nullptr, see DataStreamMgr::transmit_local_data().
+    Status send_local_batch(RowBatch* batch, bool eos = false);
+
+    // true if the receiver is in this process
+    bool is_local() const { return _is_local; }
+
     // Asynchronously sends a row batch.
     // Returns the status of the most recently finished transmit_data
     // rpc (or OK if there wasn't one that hasn't been reported yet).
     // if batch is nullptr, send the eof packet
     Status send_batch(PRowBatch* batch, bool eos = false);
 
+    // Sends a row batch encoded by column like send_batch().
+    Status send_columnar_batch(PColumnarRowBatch* batch, bool eos = false);
+
     // Flush buffered rows and close channel.
     // Returns error status if any of the preceding rpcs failed, OK otherwise.
     void close(RuntimeState* state);
 
+    // Cancels the rpc in flight and drops the buffered rows instead of sending
+    // them, for a cancelled fragment. No eos is sent.
+    void cancel();
+
     int64_t num_data_bytes_sent() const {
         return _num_data_bytes_sent;
     }
@@ -123,16 +145,27 @@ public:
         return &_pb_batch;
     }
 
+    ExchangeCompressionPolicy* compression_policy() {
+        return _compression_policy.get();
+    }
+
 private:
     inline Status _wait_last_brpc() {
         auto cntl = &_closure->cntl;
         brpc::Join(cntl->call_id());
+        Status status = Status::OK;
         if (cntl->Failed()) {
             LOG(WARNING) << "failed to send brpc batch, error=" << berror(cntl->ErrorCode())
                 << ", error_text=" << cntl->ErrorText();
-            return Status(TStatusCode::THRIFT_RPC_ERROR, "failed to send batch");
+            status = Status(TStatusCode::THRIFT_RPC_ERROR, "failed to send batch");
         }
-        return Status::OK;
+        if (_send_span != nullptr) {
+            // the rpc may have finished long before it is waited for
+            _send_span->set_status(status);
+            _send_span->end(_send_start_ns + cntl->latency_us() * 1000);
+            _send_span.reset();
+        }
+        return status;
     }
 
 
@@ -140,6 +173,11 @@ private:
     // Serialize _batch into _thrift_batch and send via send_batch().
     // Returns send_batch() status.
     Status send_current_batch(bool eos = false);
+
+    // Waits for the last rpc and fills the request but for the batch.
+    Status _prepare_request(bool eos);
+    // Sends the request.
+    void _transmit();
     Status close_internal();
 
     DataStreamSender* _parent;
@@ -171,10 +209,26 @@ private:
     // whether the dest can be treated as query statistics transfer chain.
     bool _is_transfer_chain;
     bool _send_query_statistics_with_every_batch;
+
+    bool _is_local = false;
+    DataStreamMgr* _stream_mgr = nullptr;
+
+    // set if the exchange compression is ADAPTIVE
+    std::unique_ptr<ExchangeCompressionPolicy> _compression_policy;
+
+    // set if rows are sent column by column
+    std::unique_ptr<ColumnBatch> _column_batch;
+    PColumnarRowBatch _columnar_pb_batch;
+
+    TraceContext _trace_context;
+    // the span of the rpc in flight, set if the query is traced
+    std::unique_ptr<Span> _send_span;
+    int64_t _send_start_ns = 0;
 };
 
 Status DataStreamSender::Channel::init(RuntimeState* state) {
     _be_number = state->be_number();
+    _trace_context = state->trace_context();
 
     // TODO: figure out how to size _batch
     int capacity = std::max(1, _buffer_size / std::max(_row_desc.get_row_size(), 1));
@@ -197,11 +251,56 @@ Status DataStreamSender::Channel::init(RuntimeState* state) {
     _brpc_timeout_ms = std::min(3600, state->query_options().query_timeout) * 1000;
     _brpc_stub = state->exec_env()->brpc_stub_cache()->get_stub(_brpc_dest_addr);
 
+    _is_local = config::enable_local_exchange
+            && _brpc_dest_addr.hostname == BackendOptions::get_localhost()
+            && _brpc_dest_addr.port == config::brpc_port;
+    _stream_mgr = state->exec_env()->stream_mgr();
+    if (_parent->_compression == TExchangeCompression::ADAPTIVE) {
+        _compression_policy.reset(new ExchangeCompressionPolicy(
+                config::exchange_network_mb_per_second * 1024 * 1024));
+    }
+    if (config::exchange_columnar_batch) {
+        _column_batch.reset(new ColumnBatch(_row_desc));
+    }
+
     _need_close = true;
     return Status::OK;
 }
 
 Status DataStreamSender::Channel::send_batch(PRowBatch* batch, bool eos) {
+    RETURN_IF_ERROR(_prepare_request(eos));
+    // the batch may be sent to other channels as well, its tuple data is
+    // only moved out while the request is serialized
+    std::string tuple_data;
+    bool in_attachment = batch != nullptr && config::exchange_tuple_data_in_attachment;
+    if (in_attachment) {
+        _closure->cntl.request_attachment().append(batch->tuple_data());
+        batch->mutable_tuple_data()->swap(tuple_data);
+        batch->set_tuple_data_in_attachment(true);
+    }
+    if (batch != nullptr) {
+        _brpc_request.set_allocated_row_batch(batch);
+    }
+    _transmit();
+    if (batch != nullptr) {
+        _brpc_request.release_row_batch();
+    }
+    if (in_attachment) {
+        batch->mutable_tuple_data()->swap(tuple_data);
+        batch->clear_tuple_data_in_attachment();
+    }
+    return Status::OK;
+}
+
+Status DataStreamSender::Channel::send_columnar_batch(PColumnarRowBatch* batch, bool eos) {
+    RETURN_IF_ERROR(_prepare_request(eos));
+    _brpc_request.set_allocated_columnar_batch(batch);
+    _transmit();
+    _brpc_request.release_columnar_batch();
+    return Status::OK;
+}
+
+Status DataStreamSender::Channel::_prepare_request(bool eos) {
     if (_closure == nullptr) {
         _closure = new RefCountClosure<PTransmitDataResult>();
         _closure->ref();
@@ -217,18 +316,22 @@ Status DataStreamSender::Channel::send_batch(PRowBatch* batch, bool eos) {
     }
 
     _brpc_request.set_eos(eos);
-    if (batch != nullptr) {
-        _brpc_request.set_allocated_row_batch(batch);
-    }
     _brpc_request.set_packet_seq(_packet_seq++);
+    return Status::OK;
+}
 
+void DataStreamSender::Channel::_transmit() {
+    if (_trace_context.sampled) {
+        _send_start_ns = Tracer::now_ns();
+        _send_span.reset(new Span(_trace_context, "exchange_send", _send_start_ns));
+        _send_span->add_attribute("dest_node_id", _dest_node_id);
+        _send_span->add_attribute("packet_seq", _brpc_request.packet_seq());
+        // the receiver's span is a child of this one
+        _send_span->context().to_proto(_brpc_request.mutable_trace_context());
+    }
     _closure->ref();
     _closure->cntl.set_timeout_ms(_brpc_timeout_ms);
     _brpc_stub->transmit_data(&_closure->cntl, &_brpc_request, &_closure->result, _closure);
-    if (batch != nullptr) {
-        _brpc_request.release_row_batch();
-    }
-    return Status::OK;
 }
 
 Status DataStreamSender::Channel::add_row(TupleRow* row) {
@@ -259,13 +362,42 @@ Status DataStreamSender::Channel::add_row(TupleRow* row) {
     return Status::OK;
 }
 
+Status DataStreamSender::Channel::add_rows(RowBatch* batch, const std::vector<int>& rows) {
+    for (int row : rows) {
+        RETURN_IF_ERROR(add_row(batch->get_row(row)));
+    }
+    return Status::OK;
+}
+
+Status DataStreamSender::Channel::send_local_batch(RowBatch* batch, bool eos) {
+    PQueryStatistics statistics;
+    PQueryStatistics* statistics_ptr = nullptr;
+    if (_is_transfer_chain && (_send_query_statistics_with_every_batch || eos)) {
+        _parent->_query_statistics->to_pb(&statistics);
+        statistics_ptr = &statistics;
+    }
+    if (batch != nullptr) {
+        COUNTER_UPDATE(_parent->_local_bytes_sent_counter, batch->total_byte_size());
+    }
+    return _stream_mgr->transmit_local_data(_fragment_instance_id, _dest_node_id,
+                                            _parent->_sender_id, _be_number, batch, eos,
+                                            statistics_ptr);
+}
+
 Status DataStreamSender::Channel::send_current_batch(bool eos) {
-    {
-        SCOPED_TIMER(_parent->_serialize_batch_timer);
-        int uncompressed_bytes = _batch->serialize(&_pb_batch);
-        COUNTER_UPDATE(_parent->_bytes_sent_counter, RowBatch::get_batch_size(_pb_batch));
-        COUNTER_UPDATE(_parent->_uncompressed_bytes_counter, uncompressed_bytes);
+    if (_is_local) {
+        RETURN_IF_ERROR(send_local_batch(_batch.get(), eos));
+        _batch->reset();
+        return Status::OK;
+    }
+    if (_column_batch != nullptr) {
+        RETURN_IF_ERROR(_parent->serialize_columnar_batch(
+                _batch.get(), _column_batch.get(), &_columnar_pb_batch));
+        _batch->reset();
+        return send_columnar_batch(&_columnar_pb_batch, eos);
     }
+    RETURN_IF_ERROR(_parent->serialize_batch(_batch.get(), &_pb_batch, 1,
+                                             _compression_policy.get()));
     _batch->reset();
     RETURN_IF_ERROR(send_batch(&_pb_batch, eos));
     return Status::OK;
@@ -278,6 +410,12 @@ Status DataStreamSender::Channel::close_internal() {
     VLOG_RPC << "Channel::close() instance_id=" << _fragment_instance_id
              << " dest_node=" << _dest_node_id
              << " #rows= " << ((_batch == nullptr) ? 0 : _batch->num_rows());
+    if (_is_local) {
+        RETURN_IF_ERROR(send_local_batch(
+                _batch != nullptr && _batch->num_rows() > 0 ? _batch.get() : nullptr, true));
+        _need_close = false;
+        return Status::OK;
+    }
     if (_batch != NULL && _batch->num_rows() > 0) {
         RETURN_IF_ERROR(send_current_batch(true));
     } else {
@@ -293,6 +431,18 @@ void DataStreamSender::Channel::close(RuntimeState* state) {
     _batch.reset();
 }
 
+void DataStreamSender::Channel::cancel() {
+    if (_closure != nullptr) {
+        brpc::StartCancel(_closure->cntl.call_id());
+        brpc::Join(_closure->cntl.call_id());
+        // releases the tuple data kept in the attachment of the request
+        _closure->cntl.Reset();
+    }
+    _need_close = false;
+    _batch.reset();
+    _pb_batch.Clear();
+}
+
 DataStreamSender::DataStreamSender(
             ObjectPool* pool, int sender_id,
             const RowDescriptor& row_desc, const TDataStreamSink& sink,
@@ -310,6 +460,7 @@ DataStreamSender::DataStreamSender(
         _serialize_batch_timer(NULL),
         _thrift_transmit_timer(NULL),
         _bytes_sent_counter(NULL),
+        _local_bytes_sent_counter(NULL),
         _dest_node_id(sink.dest_node_id) {
     DCHECK_GT(destinations.size(), 0);
     DCHECK(sink.output_partition.type == TPartitionType::UNPARTITIONED
@@ -376,6 +527,18 @@ Status DataStreamSender::prepare(RuntimeState* state) {
     _mem_tracker.reset(
             new MemTracker(-1, "DataStreamSender", state->instance_mem_tracker()));
 
+    if (state->query_options().__isset.exchange_compression) {
+        _compression = state->query_options().exchange_compression;
+    } else if (config::compress_rowbatches) {
+        _compression = TExchangeCompression::SNAPPY;
+    }
+    if (_compression == TExchangeCompression::ADAPTIVE) {
+        _broadcast_compression_policy.reset(new ExchangeCompressionPolicy(
+                config::exchange_network_mb_per_second * 1024 * 1024));
+    }
+    _profile->add_info_string("ExchangeCompression",
+                              _TExchangeCompression_VALUES_TO_NAMES.find(_compression)->second);
+
     if (_part_type == TPartitionType::UNPARTITIONED 
             || _part_type == TPartitionType::RANDOM) {
         // Randomize the order we open/transmit to channels to avoid thundering herd problems.
@@ -396,6 +559,8 @@ Status DataStreamSender::prepare(RuntimeState* state) {
         ADD_COUNTER(profile(), "BytesSent", TUnit::BYTES);
     _uncompressed_bytes_counter =
         ADD_COUNTER(profile(), "UncompressedRowBatchSize", TUnit::BYTES);
+    _local_bytes_sent_counter =
+        ADD_COUNTER(profile(), "LocalBytesSent", TUnit::BYTES);
     _ignore_rows =
         ADD_COUNTER(profile(), "IgnoreRows", TUnit::UNIT);
     _serialize_batch_timer =
@@ -436,36 +601,65 @@ Status DataStreamSender::send(RuntimeState* state, RowBatch* batch) {
 
     // Unpartition or _channel size
     if (_part_type == TPartitionType::UNPARTITIONED || _channels.size() == 1) {
-        RETURN_IF_ERROR(serialize_batch(batch, _current_pb_batch, _channels.size()));
+        // the batch is serialized once for all remote channels
+        int num_remote_channels = 0;
         for (auto channel : _channels) {
-            RETURN_IF_ERROR(channel->send_batch(_current_pb_batch));
+            if (channel->is_local()) {
+                RETURN_IF_ERROR(channel->send_local_batch(batch));
+            } else {
+                ++num_remote_channels;
+            }
+        }
+        if (num_remote_channels > 0) {
+            RETURN_IF_ERROR(serialize_batch(batch, _current_pb_batch, num_remote_channels,
+                                            _broadcast_compression_policy.get()));
+            for (auto channel : _channels) {
+                if (!channel->is_local()) {
+                    RETURN_IF_ERROR(channel->send_batch(_current_pb_batch));
+                }
+            }
+            _current_pb_batch = (_current_pb_batch == &_pb_batch1 ? &_pb_batch2 : &_pb_batch1);
         }
-        _current_pb_batch = (_current_pb_batch == &_pb_batch1 ? &_pb_batch2 : &_pb_batch1);
     } else if (_part_type == TPartitionType::RANDOM) {
         // Round-robin batches among channels. Wait for the current channel to finish its
         // rpc before overwriting its batch.
         Channel* current_channel = _channels[_current_channel_idx];
-        RETURN_IF_ERROR(serialize_batch(batch, current_channel->pb_batch()));
-        RETURN_IF_ERROR(current_channel->send_batch(current_channel->pb_batch()));
+        if (current_channel->is_local()) {
+            RETURN_IF_ERROR(current_channel->send_local_batch(batch));
+        } else {
+            RETURN_IF_ERROR(serialize_batch(batch, current_channel->pb_batch(), 1,
+                                            current_channel->compression_policy()));
+            RETURN_IF_ERROR(current_channel->send_batch(current_channel->pb_batch()));
+        }
         _current_channel_idx = (_current_channel_idx + 1) % _channels.size();
     } else if (_part_type == TPartitionType::HASH_PARTITIONED) {
-        // hash-partition batch's rows across channels
+        // hash-partition batch's rows across channels. Each partition expr is
+        // evaluated over the whole batch before the next one, then the rows are
+        // scattered channel by channel.
         int num_channels = _channels.size();
-
-        for (int i = 0; i < batch->num_rows(); ++i) {
-            TupleRow* row = batch->get_row(i);
-            size_t hash_val = 0;
-
-            for (auto ctx : _partition_expr_ctxs) {
-                void* partition_val = ctx->get_value(row);
+        int num_rows = batch->num_rows();
+        _hash_vals.assign(num_rows, 0);
+        for (auto ctx : _partition_expr_ctxs) {
+            PrimitiveType type = ctx->root()->type().type;
+            for (int i = 0; i < num_rows; ++i) {
+                void* partition_val = ctx->get_value(batch->get_row(i));
                 // We can't use the crc hash function here because it does not result
                 // in uncorrelated hashes with different seeds.  Instead we must use
                 // fvn hash.
                 // TODO: fix crc hash/GetHashValue()
-                hash_val = RawValue::get_hash_value_fvn(
-                    partition_val, ctx->root()->type(), hash_val);
+                _hash_vals[i] = RawValue::get_hash_value_fvn(partition_val, type, _hash_vals[i]);
             }
-            RETURN_IF_ERROR(_channels[hash_val % num_channels]->add_row(row));
+        }
+
+        _channel_rows.resize(num_channels);
+        for (auto& rows : _channel_rows) {
+            rows.clear();
+        }
+        for (int i = 0; i < num_rows; ++i) {
+            _channel_rows[_hash_vals[i] % num_channels].push_back(i);
+        }
+        for (int i = 0; i < num_channels; ++i) {
+            RETURN_IF_ERROR(_channels[i]->add_rows(batch, _channel_rows[i]));
         }
     } else {
         // Range partition
@@ -590,9 +784,17 @@ Status DataStreamSender::compute_range_part_code(
 }
 
 Status DataStreamSender::close(RuntimeState* state, Status exec_status) {
-    // TODO: only close channels that didn't have any errors
-    for (int i = 0; i < _channels.size(); ++i) {
-        _channels[i]->close(state);
+    // the receivers of a cancelled fragment are cancelled as well, the buffered
+    // rows are released at once instead of being flushed to them
+    if (state->is_cancelled()) {
+        for (int i = 0; i < _channels.size(); ++i) {
+            _channels[i]->cancel();
+        }
+    } else {
+        // TODO: only close channels that didn't have any errors
+        for (int i = 0; i < _channels.size(); ++i) {
+            _channels[i]->close(state);
+        }
     }
     for (auto iter : _partition_infos) {
         RETURN_IF_ERROR(iter->close(state));
@@ -603,7 +805,8 @@ Status DataStreamSender::close(RuntimeState* state, Status exec_status) {
 }
 
 template<typename T>
-Status DataStreamSender::serialize_batch(RowBatch* src, T* dest, int num_receivers) {
+Status DataStreamSender::serialize_batch(RowBatch* src, T* dest, int num_receivers,
+                                         ExchangeCompressionPolicy* policy) {
     VLOG_ROW << "serializing " << src->num_rows() << " rows";
     {
         // TODO(zc)
@@ -611,7 +814,24 @@ Status DataStreamSender::serialize_batch(RowBatch* src, T* dest, int num_receive
         SCOPED_TIMER(_serialize_batch_timer);
         // TODO(zc)
         // RETURN_IF_ERROR(src->serialize(dest));
-        int uncompressed_bytes = src->serialize(dest);
+        int uncompressed_bytes = 0;
+        if (policy != nullptr) {
+            MonotonicStopWatch watch;
+            watch.start();
+            ExchangeCompressionPolicy::Codec codec = policy->next_codec();
+            uncompressed_bytes = src->serialize(
+                    dest, codec != ExchangeCompressionPolicy::NONE,
+                    codec == ExchangeCompressionPolicy::ZSTD ? ROW_BATCH_ZSTD : ROW_BATCH_LZ4);
+            policy->update(uncompressed_bytes, RowBatch::get_batch_size(*dest),
+                           watch.elapsed_time());
+        } else if (_compression == TExchangeCompression::LZ4) {
+            uncompressed_bytes = src->serialize(dest, true, ROW_BATCH_LZ4);
+        } else if (_compression == TExchangeCompression::ZSTD) {
+            uncompressed_bytes = src->serialize(dest, true, ROW_BATCH_ZSTD);
+        } else {
+            uncompressed_bytes = src->serialize(
+                    dest, _compression == TExchangeCompression::SNAPPY, ROW_BATCH_SNAPPY);
+        }
         int bytes = RowBatch::get_batch_size(*dest);
         // TODO(zc)
         // int uncompressed_bytes = bytes - dest->tuple_data.size() + dest->uncompressed_size;
@@ -624,6 +844,19 @@ Status DataStreamSender::serialize_batch(RowBatch* src, T* dest, int num_receive
     return Status::OK;
 }
 
+Status DataStreamSender::serialize_columnar_batch(RowBatch* src, ColumnBatch* columns,
+                                                  PColumnarRowBatch* dest) {
+    VLOG_ROW << "serializing " << src->num_rows() << " rows by column";
+    SCOPED_TIMER(_serialize_batch_timer);
+    columns->from_row_batch(src);
+    columns->serialize(dest);
+    int64_t bytes = dest->data().size();
+    COUNTER_UPDATE(_bytes_sent_counter, bytes);
+    COUNTER_UPDATE(_uncompressed_bytes_counter,
+                   dest->has_uncompressed_size() ? dest->uncompressed_size() : bytes);
+    return Status::OK;
+}
+
 int64_t DataStreamSender::get_num_data_bytes_sent() const {
     // TODO: do we need synchronization here or are reads & writes to 8-byte ints
     // atomic?
@@ -18,6 +18,7 @@
 #ifndef DORIS_BE_RUNTIME_DATA_STREAM_SENDER_H
 #define DORIS_BE_RUNTIME_DATA_STREAM_SENDER_H
 
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -27,9 +28,12 @@
 #include "common/status.h"
 #include "util/runtime_profile.h"
 #include "gen_cpp/data.pb.h"  // for PRowBatch
+#include "gen_cpp/PaloInternalService_types.h"
+#include "runtime/exchange_compression_policy.h"
 
 namespace doris {
 
+class ColumnBatch;
 class ExprContext;
 class RowBatch;
 class RowDescriptor;
@@ -85,9 +89,16 @@ public:
 
     /// Serializes the src batch into the dest thrift batch. Maintains metrics.
     /// num_receivers is the number of receivers this batch will be sent to. Only
-    /// used to maintain metrics.
+    /// used to maintain metrics. 'policy' chooses the codec if the exchange
+    /// compression is ADAPTIVE.
     template<class T>
-    Status serialize_batch(RowBatch* src, T* dest, int num_receivers = 1);
+    Status serialize_batch(RowBatch* src, T* dest, int num_receivers = 1,
+                           ExchangeCompressionPolicy* policy = nullptr);
+
+    /// Serializes the src batch column by column through 'columns' into 'dest', like
+    /// serialize_batch().
+    Status serialize_columnar_batch(RowBatch* src, ColumnBatch* columns,
+                                    PColumnarRowBatch* dest);
 
     // Return total number of bytes sent in TRowBatch.data. If batches are
     // broadcast to multiple receivers, they are counted once per receiver.
@@ -136,8 +147,18 @@ private:
     PRowBatch _pb_batch2;
     PRowBatch* _current_pb_batch = nullptr;
 
+    // exchange_compression of the query, see prepare()
+    TExchangeCompression::type _compression = TExchangeCompression::NONE;
+    // codec of the batches broadcast to the remote channels
+    std::unique_ptr<ExchangeCompressionPolicy> _broadcast_compression_policy;
+
     std::vector<ExprContext*> _partition_expr_ctxs;  // compute per-row partition values
 
+    // hash values of the rows of the batch being hash partitioned
+    std::vector<uint32_t> _hash_vals;
+    // for each channel, the indexes of the rows of the batch sent to it
+    std::vector<std::vector<int>> _channel_rows;
+
     std::vector<Channel*> _channels;
     std::vector<std::shared_ptr<Channel>> _channel_shared_ptrs;
 
@@ -150,6 +171,8 @@ private:
     RuntimeProfile::Counter* _thrift_transmit_timer;
     RuntimeProfile::Counter* _bytes_sent_counter;
     RuntimeProfile::Counter* _uncompressed_bytes_counter;
+    // bytes of the row batches copied to receivers on this backend
+    RuntimeProfile::Counter* _local_bytes_sent_counter;
     RuntimeProfile::Counter* _ignore_rows;
 
     std::unique_ptr<MemTracker> _mem_tracker;
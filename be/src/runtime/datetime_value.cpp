@@ -101,6 +101,90 @@ bool DateTimeValue::check_date() const {
     return false;
 }
 
+// "00", "01", ..., "99"
+static const char s_two_digits[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// 'value' is less than 100 in valid values, it is not read beyond the table
+// from the others
+static inline char* append_two_digits(char* to, uint32_t value) {
+    memcpy(to, s_two_digits + 2 * (value % 100), 2);
+    return to + 2;
+}
+
+// Checks the 8 bytes of 'word' at once: the bytes in 'digit_mask' must be
+// '0' to '9' and the others must equal those of 'separators'.
+static inline bool match_digits(uint64_t word, uint64_t digit_mask, uint64_t separators) {
+    const uint64_t zeros = 0x3030303030303030ULL;
+    const uint64_t high_nibbles = 0xF0F0F0F0F0F0F0F0ULL;
+    uint64_t digits = (word & digit_mask) | (zeros & ~digit_mask);
+    // the high nibble of a digit is 3, and it still is after adding 6
+    uint64_t nibbles = (digits & high_nibbles)
+        | (((digits + 0x0606060606060606ULL) & high_nibbles) >> 4);
+    return nibbles == 0x3333333333333333ULL && (word & ~digit_mask) == separators;
+}
+
+static inline uint32_t two_digits(const char* str) {
+    return (str[0] - '0') * 10 + (str[1] - '0');
+}
+
+// 'YYYY-MM-DD' and 'YYYY-MM-DD HH:MM:SS', which almost all loaded and cast
+// values are, without scanning them field by field.
+bool DateTimeValue::from_fixed_date_str(const char* date_str, int len) {
+    // "YYYY-MM-", bytes are in little endian order
+    const uint64_t date_digits = 0x00FFFF00FFFFFFFFULL;
+    const uint64_t date_separators = 0x2D00002D00000000ULL;
+    // "DD HH:MM"
+    const uint64_t time_digits = 0xFFFF00FFFF00FFFFULL;
+    const uint64_t time_separators = 0x00003A0000200000ULL;
+
+    uint64_t word = 0;
+    memcpy(&word, date_str, sizeof(word));
+    if (!match_digits(word, date_digits, date_separators)) {
+        return false;
+    }
+    if (len == 10) {
+        if (!isdigit(date_str[8]) || !isdigit(date_str[9])) {
+            return false;
+        }
+        _type = TIME_DATE;
+        _hour = 0;
+        _minute = 0;
+        _second = 0;
+    } else {
+        memcpy(&word, date_str + 8, sizeof(word));
+        if (!match_digits(word, time_digits, time_separators)
+                || date_str[16] != ':' || !isdigit(date_str[17]) || !isdigit(date_str[18])) {
+            return false;
+        }
+        _type = TIME_DATETIME;
+        _hour = two_digits(date_str + 11);
+        _minute = two_digits(date_str + 14);
+        _second = two_digits(date_str + 17);
+    }
+    _neg = false;
+    _year = two_digits(date_str) * 100 + two_digits(date_str + 2);
+    _month = two_digits(date_str + 5);
+    _day = two_digits(date_str + 8);
+    _microsecond = 0;
+    return true;
+}
+
+int DateTimeValue::from_date_strs(const doris_udf::StringVal* strs, int num,
+                                  DateTimeValue* values, bool* valid) {
+    int num_valid = 0;
+    for (int i = 0; i < num; ++i) {
+        valid[i] = !strs[i].is_null && values[i].from_date_str(
+            reinterpret_cast<const char*>(strs[i].ptr), strs[i].len);
+        num_valid += valid[i];
+    }
+    return num_valid;
+}
+
 // The interval format is that with no delimiters
 // YYYY-MM-DD HH-MM-DD.FFFFFF AM in default format
 // 0    1  2  3  4  5  6      7
@@ -113,6 +197,10 @@ bool DateTimeValue::from_date_str(const char* date_str, int len) {
     uint32_t date_val[MAX_DATE_PARTS];
     int32_t date_len[MAX_DATE_PARTS];
 
+    if ((len == 10 || len == 19) && from_fixed_date_str(date_str, len)) {
+        return !check_range() && !check_date();
+    }
+
     _neg = false;
     // Skip space character
     while (ptr < end && isspace(*ptr)) {
@@ -379,23 +467,12 @@ bool DateTimeValue::from_time_int64(int64_t value) {
 }
 
 char* DateTimeValue::append_date_string(char *to) const {
-    uint32_t temp;
-    // Year
-    temp = _year / 100;
-    *to++ = (char) ('0' + (temp / 10));
-    *to++ = (char) ('0' + (temp % 10));
-    temp = _year % 100;
-    *to++ = (char) ('0' + (temp / 10));
-    *to++ = (char) ('0' + (temp % 10));
+    to = append_two_digits(to, _year / 100);
+    to = append_two_digits(to, _year % 100);
     *to++ = '-';
-    // Month
-    *to++ = (char) ('0' + (_month / 10));
-    *to++ = (char) ('0' + (_month % 10));
+    to = append_two_digits(to, _month);
     *to++ = '-';
-    // Day
-    *to++ = (char) ('0' + (_day / 10));
-    *to++ = (char) ('0' + (_day % 10));
-    return to;
+    return append_two_digits(to, _day);
 }
 
 char* DateTimeValue::append_time_string(char *to) const {
@@ -408,27 +485,16 @@ char* DateTimeValue::append_time_string(char *to) const {
         *to++ = (char) ('0' + (temp / 100));
         temp %= 100;
     }
-    *to++ = (char) ('0' + (temp / 10));
-    *to++ = (char) ('0' + (temp % 10));
+    to = append_two_digits(to, temp);
     *to++ = ':';
-    // Minute
-    *to++ = (char) ('0' + (_minute / 10));
-    *to++ = (char) ('0' + (_minute % 10));
+    to = append_two_digits(to, _minute);
     *to++ = ':';
-    /* Second */
-    *to++ = (char) ('0' + (_second / 10));
-    *to++ = (char) ('0' + (_second % 10));
+    to = append_two_digits(to, _second);
     if (_microsecond > 0) {
         *to++ = '.';
-        uint32_t first = _microsecond / 10000;
-        uint32_t second = (_microsecond % 10000) / 100;
-        uint32_t third = _microsecond % 100;
-        *to++ = (char) ('0' + first / 10);
-        *to++ = (char) ('0' + first % 10);
-        *to++ = (char) ('0' + second / 10);
-        *to++ = (char) ('0' + second % 10);
-        *to++ = (char) ('0' + third / 10);
-        *to++ = (char) ('0' + third % 10);
+        to = append_two_digits(to, _microsecond / 10000);
+        to = append_two_digits(to, (_microsecond % 10000) / 100);
+        to = append_two_digits(to, _microsecond % 100);
     }
     return to;
 }
@@ -219,6 +219,12 @@ public:
     // 'YYYYMMDDTHHMMSS'
     bool from_date_str(const char* str, int len);
 
+    // Parses 'num' strings as from_date_str() does into 'values'. 'valid[i]'
+    // is false if the i-th one is NULL or not a date. Returns the number of
+    // valid ones.
+    static int from_date_strs(const doris_udf::StringVal* strs, int num,
+                              DateTimeValue* values, bool* valid);
+
     // Construct Date/Datetime type value from int64_t value.
     // Return true if convert success. Otherwise return false.
     bool from_date_int64(int64_t value);
@@ -270,6 +276,9 @@ public:
     int second() const {
         return _second;
     }
+    int microsecond() const {
+        return _microsecond;
+    }
 
     void cast_to_date() {
         _hour = 0;
@@ -515,6 +524,10 @@ private:
                               const char* value, int value_len, 
                               const char** sub_val_end);
 
+    // Fast path of from_date_str() for 'YYYY-MM-DD' and 'YYYY-MM-DD HH:MM:SS',
+    // returns false without changing this value if 'str' is not one of them.
+    // Ranges are not checked.
+    bool from_fixed_date_str(const char* str, int len);
 
     // 1 bits for neg. 3 bits for type. 12bit for hour
     uint16_t _neg:1;        // Used for time value.
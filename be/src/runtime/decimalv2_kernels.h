@@ -0,0 +1,145 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_DECIMALV2_KERNELS_H
+#define DORIS_BE_RUNTIME_DECIMALV2_KERNELS_H
+
+#include <stdint.h>
+
+#include "runtime/decimalv2_value.h"
+
+namespace doris {
+
+// Arithmetic on the int128 values of DecimalV2Value, which all have the same
+// scale, for loops over many values. The results are those of the operators
+// of DecimalV2Value, which are implemented with these: sums saturate at
+// +-MAX_DECIMAL_VALUE, products and quotients are rounded half up.
+class DecimalV2Kernels {
+public:
+    static const int128_t MAX_VALUE = DecimalV2Value::MAX_DECIMAL_VALUE;
+
+    static int128_t add(int128_t x, int128_t y) {
+        if (x > 0 && y > 0) {
+            return MAX_VALUE - x >= y ? x + y : MAX_VALUE;
+        }
+        if (x < 0 && y < 0) {
+            return MAX_VALUE + x >= -y ? x + y : -MAX_VALUE;
+        }
+        return x + y;
+    }
+
+    static int128_t subtract(int128_t x, int128_t y) {
+        return add(x, -y);
+    }
+
+    // 0 if one of them is 0
+    static int128_t multiply(int128_t x, int128_t y) {
+        if (x == 0 || y == 0) {
+            return 0;
+        }
+        int128_t result = multiply_positive(x < 0 ? -x : x, y < 0 ? -y : y);
+        return (x < 0) != (y < 0) ? -result : result;
+    }
+
+    // 0 if one of them is 0
+    static int128_t divide(int128_t x, int128_t y) {
+        if (x == 0 || y == 0) {
+            return 0;
+        }
+        int128_t result = divide_positive(x < 0 ? -x : x, y < 0 ? -y : y);
+        return (x < 0) != (y < 0) ? -result : result;
+    }
+
+    // Adds values[0], ..., values[n - 1] to '*sum' one after the other with
+    // add(). The values are summed without checks first. They are added one
+    // by one only if a partial sum may have been saturated, which is the
+    // case if |*sum| + n * max |values[i]| exceeds MAX_VALUE.
+    static void sum(const int128_t* values, int n, int128_t* sum) {
+        // unsigned, a sum which wraps is not used
+        unsigned __int128 total = 0;
+        unsigned __int128 max_abs = 0;
+        for (int i = 0; i < n; ++i) {
+            unsigned __int128 value = values[i];
+            total += value;
+            unsigned __int128 abs = values[i] < 0 ? -value : value;
+            max_abs = abs > max_abs ? abs : max_abs;
+        }
+        unsigned __int128 sum_abs = *sum < 0 ? -static_cast<unsigned __int128>(*sum) : *sum;
+        if (n > 0 && sum_abs <= MAX_VALUE && max_abs <= MAX_VALUE
+                && max_abs <= (MAX_VALUE - sum_abs) / n) {
+            *sum = static_cast<int128_t>(static_cast<unsigned __int128>(*sum) + total);
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            *sum = add(*sum, values[i]);
+        }
+    }
+
+private:
+    static const uint32_t ONE_BILLION = DecimalV2Value::ONE_BILLION;
+
+    // x > 0 && y > 0
+    static int128_t multiply_positive(int128_t x, int128_t y) {
+        int128_t product = 0;
+        if (__builtin_mul_overflow(x, y, &product)) {
+            return MAX_VALUE;
+        }
+        int128_t result = 0;
+        uint32_t remainder = 0;
+        if (product <= UINT64_MAX) {
+            // a 64 bits division instead of a call of __divti3
+            uint64_t low = static_cast<uint64_t>(product);
+            result = low / ONE_BILLION;
+            remainder = low % ONE_BILLION;
+        } else {
+            result = product / ONE_BILLION;
+            if (result > MAX_VALUE) {
+                return MAX_VALUE;
+            }
+            remainder = product % ONE_BILLION;
+        }
+        if (remainder >= (ONE_BILLION >> 1)) {
+            ++result;
+        }
+        return result;
+    }
+
+    // x > 0 && y > 0
+    static int128_t divide_positive(int128_t x, int128_t y) {
+        // the scaled dividend wraps if the quotient would overflow
+        int128_t dividend = static_cast<int128_t>(static_cast<unsigned __int128>(x) * ONE_BILLION);
+        int128_t result = 0;
+        int128_t remainder = 0;
+        if (dividend > 0 && dividend <= UINT64_MAX && y <= UINT64_MAX) {
+            uint64_t low = static_cast<uint64_t>(dividend);
+            uint64_t divisor = static_cast<uint64_t>(y);
+            result = low / divisor;
+            remainder = low % divisor;
+        } else {
+            result = dividend / y;
+            remainder = dividend % y;
+        }
+        if (remainder != 0 && remainder >= (y >> 1)) {
+            ++result;
+        }
+        return result;
+    }
+};
+
+}
+
+#endif
@@ -16,6 +16,7 @@
 // under the License.
 
 #include "runtime/decimalv2_value.h"
+#include "runtime/decimalv2_kernels.h"
 #include "util/string_parser.hpp"
 
 #include <algorithm>
@@ -28,88 +29,6 @@ const char* DecimalV2Value::_s_llvm_class_name = "class.doris::DecimalV2Value";
 
 static inline int128_t abs(const int128_t& x) { return (x < 0) ? -x : x; }
 
-// x>=0 && y>=0
-static int do_add(int128_t x, int128_t y, int128_t* result) {
-    int error = E_DEC_OK;
-    if (DecimalV2Value::MAX_DECIMAL_VALUE - x >= y) {
-        *result = x + y;
-    } else {
-        *result = DecimalV2Value::MAX_DECIMAL_VALUE;
-        error = E_DEC_OVERFLOW;
-    }
-    return error;
-}
-
-// x>=0 && y>=0
-static int do_sub(int128_t x, int128_t y, int128_t* result) {
-    int error = E_DEC_OK;
-    *result = x - y;
-    return error;
-}
-
-// clear leading zero for __int128
-static int clz128(unsigned __int128 v) {
-    if (v == 0) return sizeof(__int128);
-    unsigned __int128 shifted = v >> 64;
-    if (shifted != 0) {
-        return __builtin_clzll(shifted);
-    } else {
-        return __builtin_clzll(v) + 64;
-    }
-}
-
-// x>0 && y>0
-static int do_mul(int128_t x, int128_t y, int128_t* result) {
-    int error = E_DEC_OK;
-    int128_t max128 = ~(static_cast<int128_t>(1ll) << 127);
-
-    int leading_zero_bits = clz128(x) + clz128(y); 
-    if (leading_zero_bits < sizeof(int128_t) || max128 / x < y) {
-        *result = DecimalV2Value::MAX_DECIMAL_VALUE;
-        error = E_DEC_OVERFLOW;
-        return error;
-    }
-
-    int128_t product = x * y;
-    *result = product / DecimalV2Value::ONE_BILLION;
-
-    // overflow
-    if (*result > DecimalV2Value::MAX_DECIMAL_VALUE) {
-        *result = DecimalV2Value::MAX_DECIMAL_VALUE;
-        error = E_DEC_OVERFLOW;
-        return error;
-    }
-
-    // truncate with round
-    int128_t remainder = product % DecimalV2Value::ONE_BILLION;
-    if (remainder != 0) {
-        error = E_DEC_TRUNCATED;
-        if (remainder >= (DecimalV2Value::ONE_BILLION >> 1)) {
-            *result += 1;
-        }
-    }
-
-    return error;
-}
-
-// x>0 && y>0
-static int do_div(int128_t x, int128_t y, int128_t* result) {
-    int error = E_DEC_OK;
-    int128_t dividend = x * DecimalV2Value::ONE_BILLION;
-    *result = dividend / y;
-
-    // overflow
-    int128_t remainder = dividend % y;
-    if (remainder != 0) {
-        error = E_DEC_TRUNCATED;
-        if (remainder >= (y >> 1)) {
-            *result += 1;
-        }
-    }
-
-    return error;
-}
-
 // x>0 && y>0
 static int do_mod(int128_t x, int128_t y, int128_t* result) {
     int error = E_DEC_OK;
@@ -118,87 +37,20 @@ static int do_mod(int128_t x, int128_t y, int128_t* result) {
 }
 
 DecimalV2Value operator+(const DecimalV2Value& v1, const DecimalV2Value& v2) {
-    int128_t result;
-    int128_t x = v1.value();
-    int128_t y = v2.value();
-    if (x == 0) {
-       result = y;
-    } else if (y == 0) {
-       result = x;
-    } else if (x > 0) {
-        if (y > 0) {
-            do_add(x, y, &result);
-        } else {
-            do_sub(x, -y, &result);
-        }
-    } else { // x < 0
-        if (y > 0) {
-            do_sub(y, -x, &result);
-        } else {
-            do_add(-x, -y, &result);
-            result = -result;
-        }
-    }
-
-    return DecimalV2Value(result);
+    return DecimalV2Value(DecimalV2Kernels::add(v1.value(), v2.value()));
 }
 
 DecimalV2Value operator-(const DecimalV2Value& v1, const DecimalV2Value& v2) {
-    int128_t result;
-    int128_t x = v1.value();
-    int128_t y = v2.value();
-    if (x == 0) {
-       result = -y;
-    } else if (y == 0) {
-       result = x;
-    } else if (x > 0) {
-        if (y > 0) {
-            do_sub(x, y, &result);
-        } else {
-            do_add(x, -y, &result);
-        }
-    } else { // x < 0
-        if (y > 0) {
-            do_add(-x, y, &result);
-            result = -result;
-        } else {
-            do_sub(-x, -y, &result);
-            result = -result;
-        }
-    }
-
-    return DecimalV2Value(result);
+    return DecimalV2Value(DecimalV2Kernels::subtract(v1.value(), v2.value()));
 }
 
 DecimalV2Value operator*(const DecimalV2Value& v1, const DecimalV2Value& v2){
-    int128_t result;
-    int128_t x = v1.value();
-    int128_t y = v2.value();
-
-    if (x == 0 || y == 0) return DecimalV2Value(0);
-
-    bool is_positive = (x > 0 && y > 0) || (x < 0 && y < 0);
-
-    do_mul(abs(x), abs(y), &result);
-
-    if (!is_positive) result = -result;
-
-    return DecimalV2Value(result);
+    return DecimalV2Value(DecimalV2Kernels::multiply(v1.value(), v2.value()));
 }
 
 DecimalV2Value operator/(const DecimalV2Value& v1, const DecimalV2Value& v2){
-    int128_t result;
-    int128_t x = v1.value();
-    int128_t y = v2.value();
-
     //todo: return 0 for divide zero 
-    if (x == 0 || y == 0) return DecimalV2Value(0);
-    bool is_positive = (x > 0 && y > 0) || (x < 0 && y < 0);
-    do_div(abs(x), abs(y), &result);
-
-    if (!is_positive) result = -result;
-
-    return DecimalV2Value(result);
+    return DecimalV2Value(DecimalV2Kernels::divide(v1.value(), v2.value()));
 }
 
 DecimalV2Value operator%(const DecimalV2Value& v1, const DecimalV2Value& v2){
@@ -0,0 +1,78 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/descriptor_tbl_cache.h"
+
+#include <string.h>
+
+#include "common/object_pool.h"
+#include "gen_cpp/Descriptors_types.h"
+#include "olap/lru_cache.h"
+#include "runtime/descriptors.h"
+
+namespace doris {
+
+// The hash and the number of descriptors, which tells apart the tables of
+// colliding hashes but for the most unlucky ones.
+struct DescriptorTblKey {
+    int64_t hash;
+    int64_t num_tables;
+    int64_t num_tuples;
+    int64_t num_slots;
+};
+
+static void delete_tbl(const CacheKey& key, void* value) {
+    delete reinterpret_cast<std::shared_ptr<const DescriptorTbl>*>(value);
+}
+
+DescriptorTblCache::DescriptorTblCache(int64_t capacity)
+        : _cache(new_lru_cache(capacity)) {
+}
+
+DescriptorTblCache::~DescriptorTblCache() {
+}
+
+Status DescriptorTblCache::get(int64_t hash, const TDescriptorTable& thrift_tbl,
+                               std::shared_ptr<const DescriptorTbl>* tbl) {
+    DescriptorTblKey key_data;
+    memset(&key_data, 0, sizeof(key_data));
+    key_data.hash = hash;
+    key_data.num_tables = thrift_tbl.tableDescriptors.size();
+    key_data.num_tuples = thrift_tbl.tupleDescriptors.size();
+    key_data.num_slots = thrift_tbl.slotDescriptors.size();
+    CacheKey key(reinterpret_cast<const char*>(&key_data), sizeof(key_data));
+
+    Cache::Handle* handle = _cache->lookup(key);
+    if (handle != nullptr) {
+        *tbl = *reinterpret_cast<std::shared_ptr<const DescriptorTbl>*>(_cache->value(handle));
+        _cache->release(handle);
+        return Status::OK;
+    }
+
+    // the pool of the descriptors is kept by the shared pointers to the table
+    std::shared_ptr<ObjectPool> pool(new ObjectPool());
+    DescriptorTbl* desc_tbl = nullptr;
+    RETURN_IF_ERROR(DescriptorTbl::create(pool.get(), thrift_tbl, &desc_tbl));
+    *tbl = std::shared_ptr<const DescriptorTbl>(pool, desc_tbl);
+
+    handle = _cache->insert(key, new std::shared_ptr<const DescriptorTbl>(*tbl), 1, delete_tbl);
+    _cache->release(handle);
+    return Status::OK;
+}
+
+}
@@ -0,0 +1,59 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_RUNTIME_DESCRIPTOR_TBL_CACHE_H
+#define DORIS_BE_RUNTIME_DESCRIPTOR_TBL_CACHE_H
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "common/status.h"
+
+namespace doris {
+
+class Cache;
+class DescriptorTbl;
+class TDescriptorTable;
+
+// Descriptor tables created for fragment instances, kept for the next
+// instances of the same query and of repeated queries. The frontend sends the
+// hash of the table with each instance, instances of the same hash share one
+// table instead of creating all the descriptors again, which is much of the
+// setup of short queries.
+//
+// Descriptors are not changed once created but for the llvm types which are
+// generated into them, so they are only shared by instances without codegen.
+class DescriptorTblCache {
+public:
+    // 'capacity' is the number of tables kept
+    explicit DescriptorTblCache(int64_t capacity);
+    ~DescriptorTblCache();
+
+    // Returns the table of 'hash', created from 'thrift_tbl' if it is not
+    // cached. It is destroyed when it is evicted and no one holds it.
+    Status get(int64_t hash, const TDescriptorTable& thrift_tbl,
+               std::shared_ptr<const DescriptorTbl>* tbl);
+
+private:
+    std::unique_ptr<Cache> _cache;
+};
+
+}
+
+#endif // DORIS_BE_RUNTIME_DESCRIPTOR_TBL_CACHE_H
@@ -1030,6 +1030,14 @@ void DiskIoMgr::work_loop(DiskQueue* disk_queue) {
     //      re-enqueues the request.
     //   3. Perform the read or write as specified.
     // Cancellation checking needs to happen in both steps 1 and 3.
+    if (config::numa_aware && disk_queue->disk_id < num_local_disks()
+            && disk_queue->disk_id < DiskInfo::num_disks()) {
+        // the buffers are filled by the node the disk controller writes to
+        int numa_node = DiskInfo::numa_node(disk_queue->disk_id);
+        if (numa_node >= 0 && numa_node < CpuInfo::get_max_num_numa_nodes()) {
+            CpuInfo::bind_thread_to_numa_node(numa_node);
+        }
+    }
     while (true) {
         RequestContext* worker_context = NULL;;
         RequestRange* range = NULL;
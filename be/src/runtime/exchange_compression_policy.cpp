@@ -0,0 +1,93 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/exchange_compression_policy.h"
+
+namespace doris {
+
+// weight of the last batch in the moving averages
+static const double SMOOTHING = 0.25;
+// one batch in this many tries a codec which is not the best
+static const int64_t PROBE_INTERVAL = 32;
+
+ExchangeCompressionPolicy::ExchangeCompressionPolicy(int64_t bandwidth) :
+        _nanos_per_sent_byte(1e9 / (bandwidth > 0 ? bandwidth : 1)) {
+}
+
+ExchangeCompressionPolicy::Codec ExchangeCompressionPolicy::next_codec() {
+    // every codec is tried once first
+    for (int i = 0; i < NUM_CODECS; ++i) {
+        if (_stats[i].num_batches == 0) {
+            _current = static_cast<Codec>(i);
+            return _current;
+        }
+    }
+    _current = _best;
+    if (++_num_batches % PROBE_INTERVAL == 0) {
+        // the others in turn
+        _next_probe = (_next_probe + 1) % NUM_CODECS;
+        if (_next_probe == _best) {
+            _next_probe = (_next_probe + 1) % NUM_CODECS;
+        }
+        _current = static_cast<Codec>(_next_probe);
+    }
+    return _current;
+}
+
+void ExchangeCompressionPolicy::update(int64_t uncompressed_bytes, int64_t compressed_bytes,
+                                       int64_t nanos) {
+    if (uncompressed_bytes <= 0) {
+        return;
+    }
+    double ratio = static_cast<double>(compressed_bytes) / uncompressed_bytes;
+    double nanos_per_byte = static_cast<double>(nanos) / uncompressed_bytes;
+    CodecStats& stats = _stats[_current];
+    if (stats.num_batches == 0) {
+        stats.ratio = ratio;
+        stats.nanos_per_byte = nanos_per_byte;
+    } else {
+        stats.ratio += SMOOTHING * (ratio - stats.ratio);
+        stats.nanos_per_byte += SMOOTHING * (nanos_per_byte - stats.nanos_per_byte);
+    }
+    ++stats.num_batches;
+    _choose_best();
+}
+
+double ExchangeCompressionPolicy::cost(Codec codec) const {
+    const CodecStats& stats = _stats[codec];
+    if (stats.num_batches == 0) {
+        return 0;
+    }
+    return stats.nanos_per_byte + stats.ratio * _nanos_per_sent_byte;
+}
+
+void ExchangeCompressionPolicy::_choose_best() {
+    double best_cost = -1;
+    for (int i = 0; i < NUM_CODECS; ++i) {
+        if (_stats[i].num_batches == 0) {
+            continue;
+        }
+        double codec_cost = cost(static_cast<Codec>(i));
+        if (best_cost < 0 || codec_cost < best_cost) {
+            best_cost = codec_cost;
+            _best = static_cast<Codec>(i);
+        }
+    }
+}
+
+}
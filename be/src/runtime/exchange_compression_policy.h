@@ -0,0 +1,77 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_RUNTIME_EXCHANGE_COMPRESSION_POLICY_H
+#define DORIS_BE_RUNTIME_EXCHANGE_COMPRESSION_POLICY_H
+
+#include <stdint.h>
+
+namespace doris {
+
+// Chooses the codec of the row batches an exchange channel sends. The cost
+// of sending one uncompressed byte with a codec is estimated as the time to
+// serialize it plus the time to transmit the compressed byte at 'bandwidth',
+// from moving averages of the batches sent with the codec. The cheapest one
+// is used, the others are tried again from time to time since the data and
+// the load of the host change.
+class ExchangeCompressionPolicy {
+public:
+    enum Codec {
+        NONE = 0,
+        LZ4,
+        ZSTD,
+        NUM_CODECS
+    };
+
+    // 'bandwidth' in bytes per second
+    explicit ExchangeCompressionPolicy(int64_t bandwidth);
+
+    // codec of the next batch
+    Codec next_codec();
+
+    // Reports the batch serialized with the codec returned by the last
+    // next_codec(), 'nanos' is the time of the serialization.
+    void update(int64_t uncompressed_bytes, int64_t compressed_bytes, int64_t nanos);
+
+    // estimated nanos to send one uncompressed byte, 0 if not known yet
+    double cost(Codec codec) const;
+
+    Codec best_codec() const { return _best; }
+
+private:
+    struct CodecStats {
+        int num_batches = 0;
+        // compressed bytes per uncompressed byte
+        double ratio = 1;
+        // serialization nanos per uncompressed byte
+        double nanos_per_byte = 0;
+    };
+
+    void _choose_best();
+
+    double _nanos_per_sent_byte;
+    CodecStats _stats[NUM_CODECS];
+    Codec _best = NONE;
+    Codec _current = NONE;
+    int64_t _num_batches = 0;
+    int _next_probe = 0;
+};
+
+}
+
+#endif
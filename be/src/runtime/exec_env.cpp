@@ -18,6 +18,7 @@
 #include "runtime/exec_env.h"
 
 #include "gen_cpp/HeartbeatService_types.h"
+#include "util/cpu_info.h"
 
 namespace doris {
 
@@ -27,6 +28,13 @@ ExecEnv::ExecEnv() {
 ExecEnv::~ExecEnv() {
 }
 
+FairShareThreadPool* ExecEnv::thread_pool() {
+    if (_numa_thread_pools.empty()) {
+        return _thread_pool;
+    }
+    return _numa_thread_pools[CpuInfo::get_current_numa_node()];
+}
+
 const std::string& ExecEnv::token() const {
     return _master_info->token;
 }
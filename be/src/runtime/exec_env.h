@@ -29,20 +29,26 @@ class BrpcStubCache;
 class BufferPool;
 class CgroupsMgr;
 class DataStreamMgr;
+class DescriptorTblCache;
 class DiskIoMgr;
 class EtlJobMgr;
 class EvHttpServer;
+class FairShareThreadPool;
 class FragmentMgr;
+class FragmentResultCache;
+class GroupCommitMgr;
 class LoadPathMgr;
 class LoadStreamMgr;
+class MemArbitrator;
 class MemTracker;
 class MetricRegistry;
 class OLAPEngine;
 class PoolMemTrackerRegistry;
-class PriorityThreadPool;
 class PullLoadTaskMgr;
 class ReservationTracker;
 class ResultBufferMgr;
+class RuntimeFilterMgr;
+class SharedHashTableMgr;
 class TMasterInfo;
 class TabletWriterMgr;
 class TestExecEnv;
@@ -93,9 +99,14 @@ public:
     ClientCache<TPaloBrokerServiceClient>* broker_client_cache() { return _broker_client_cache; }
     ClientCache<TExtDataSourceServiceClient>* extdatasource_client_cache() { return _extdatasource_client_cache; }
     MemTracker* process_mem_tracker() { return _mem_tracker; }
+    // frees memory of spilling operators when the process limit is reached
+    MemArbitrator* mem_arbitrator() { return _mem_arbitrator; }
     PoolMemTrackerRegistry* pool_mem_trackers() { return _pool_mem_trackers; }
     ThreadResourceMgr* thread_mgr() { return _thread_mgr; }
-    PriorityThreadPool* thread_pool() { return _thread_pool; }
+    // runs the scanners of all queries, see OlapScanNode
+    // With numa_aware, there is one per NUMA node and this is the one of the
+    // node the current thread runs on.
+    FairShareThreadPool* thread_pool();
     ThreadPool* etl_thread_pool() { return _etl_thread_pool; }
     CgroupsMgr* cgroups_mgr() { return _cgroups_mgr; }
     FragmentMgr* fragment_mgr() { return _fragment_mgr; }
@@ -112,6 +123,12 @@ public:
     BufferPool* buffer_pool() { return _buffer_pool; }
     TabletWriterMgr* tablet_writer_mgr() { return _tablet_writer_mgr; }
     LoadStreamMgr* load_stream_mgr() { return _load_stream_mgr; }
+    RuntimeFilterMgr* runtime_filter_mgr() { return _runtime_filter_mgr; }
+    SharedHashTableMgr* shared_hash_table_mgr() { return _shared_hash_table_mgr; }
+    // nullptr if fragment_result_cache_capacity is 0
+    FragmentResultCache* fragment_result_cache() { return _fragment_result_cache; }
+    // nullptr if descriptor_tbl_cache_capacity is 0
+    DescriptorTblCache* descriptor_tbl_cache() { return _descriptor_tbl_cache; }
 
     const std::vector<StorePath>& store_paths() const { return _store_paths; }
     void set_store_paths(const std::vector<StorePath>& paths) { _store_paths = paths; }
@@ -119,9 +136,13 @@ public:
     void set_olap_engine(OLAPEngine* olap_engine) { _olap_engine = olap_engine; }
 
     StreamLoadExecutor* stream_load_executor() { return _stream_load_executor; }
+    GroupCommitMgr* group_commit_mgr() { return _group_commit_mgr; }
     RoutineLoadTaskExecutor* routine_load_task_executor() { return _routine_load_task_executor; }
 
 private:
+    // sets up the members the queries of the tests need
+    friend class TestEnv;
+
     Status _init(const std::vector<StorePath>& store_paths);
     void _destory();
 
@@ -141,9 +162,12 @@ private:
     ClientCache<TPaloBrokerServiceClient>* _broker_client_cache = nullptr;
     ClientCache<TExtDataSourceServiceClient>* _extdatasource_client_cache = nullptr;
     MemTracker* _mem_tracker = nullptr;
+    MemArbitrator* _mem_arbitrator = nullptr;
     PoolMemTrackerRegistry* _pool_mem_trackers = nullptr;
     ThreadResourceMgr* _thread_mgr = nullptr;
-    PriorityThreadPool* _thread_pool = nullptr;
+    FairShareThreadPool* _thread_pool = nullptr;
+    // one per NUMA node with numa_aware, else empty
+    std::vector<FairShareThreadPool*> _numa_thread_pools;
     ThreadPool* _etl_thread_pool = nullptr;
     CgroupsMgr* _cgroups_mgr = nullptr;
     FragmentMgr* _fragment_mgr = nullptr;
@@ -158,6 +182,10 @@ private:
     BrokerMgr* _broker_mgr = nullptr;
     TabletWriterMgr* _tablet_writer_mgr = nullptr;
     LoadStreamMgr* _load_stream_mgr = nullptr;
+    RuntimeFilterMgr* _runtime_filter_mgr = nullptr;
+    SharedHashTableMgr* _shared_hash_table_mgr = nullptr;
+    FragmentResultCache* _fragment_result_cache = nullptr;
+    DescriptorTblCache* _descriptor_tbl_cache = nullptr;
     BrpcStubCache* _brpc_stub_cache = nullptr;
 
     ReservationTracker* _buffer_reservation = nullptr;
@@ -166,6 +194,7 @@ private:
     OLAPEngine* _olap_engine = nullptr;
 
     StreamLoadExecutor* _stream_load_executor = nullptr;
+    GroupCommitMgr* _group_commit_mgr = nullptr;
     RoutineLoadTaskExecutor* _routine_load_task_executor = nullptr;
 };
 
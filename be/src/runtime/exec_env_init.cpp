@@ -27,6 +27,11 @@
 #include "runtime/data_stream_mgr.h"
 #include "runtime/disk_io_mgr.h"
 #include "runtime/result_buffer_mgr.h"
+#include "runtime/runtime_filter_mgr.h"
+#include "runtime/shared_hash_table_mgr.h"
+#include "runtime/fragment_result_cache.h"
+#include "runtime/descriptor_tbl_cache.h"
+#include "runtime/mem_arbitrator.h"
 #include "runtime/mem_tracker.h"
 #include "runtime/thread_resource_mgr.h"
 #include "runtime/fragment_mgr.h"
@@ -37,6 +42,7 @@
 #include "util/network_util.h"
 #include "util/parse_util.h"
 #include "util/mem_info.h"
+#include "util/cpu_info.h"
 #include "util/debug_util.h"
 #include "olap/olap_engine.h"
 #include "util/network_util.h"
@@ -45,12 +51,14 @@
 #include "runtime/load_path_mgr.h"
 #include "runtime/pull_load_task_mgr.h"
 #include "runtime/routine_load/routine_load_task_executor.h"
+#include "runtime/stream_load/group_commit_mgr.h"
+#include "runtime/tracer.h"
 #include "runtime/stream_load/load_stream_mgr.h"
 #include "runtime/stream_load/stream_load_executor.h"
 #include "util/pretty_printer.h"
 #include "util/doris_metrics.h"
 #include "util/brpc_stub_cache.h"
-#include "util/priority_thread_pool.hpp"
+#include "util/fair_share_thread_pool.h"
 #include "agent/cgroups_mgr.h"
 #include "util/thread_pool.hpp"
 #include "gen_cpp/BackendService.h"
@@ -76,11 +84,21 @@ Status ExecEnv::_init(const std::vector<StorePath>& store_paths) {
     _broker_client_cache = new BrokerServiceClientCache(config::max_client_cache_size_per_host);
     _extdatasource_client_cache = new ExtDataSourceServiceClientCache(config::max_client_cache_size_per_host);
     _mem_tracker = nullptr;
+    _mem_arbitrator = new MemArbitrator();
     _pool_mem_trackers = new PoolMemTrackerRegistry();
     _thread_mgr = new ThreadResourceMgr();
-    _thread_pool = new PriorityThreadPool(
-        config::doris_scanner_thread_pool_thread_num,
-        config::doris_scanner_thread_pool_queue_size);
+    int num_numa_nodes = CpuInfo::get_max_num_numa_nodes();
+    if (config::numa_aware && num_numa_nodes > 1) {
+        for (int node = 0; node < num_numa_nodes; ++node) {
+            _numa_thread_pools.push_back(new FairShareThreadPool(
+                std::max(1, config::doris_scanner_thread_pool_thread_num / num_numa_nodes),
+                config::doris_scanner_thread_pool_queue_size, node));
+        }
+    } else {
+        _thread_pool = new FairShareThreadPool(
+            config::doris_scanner_thread_pool_thread_num,
+            config::doris_scanner_thread_pool_queue_size);
+    }
     _etl_thread_pool = new ThreadPool(
         config::etl_thread_pool_size,
         config::etl_thread_pool_queue_size);
@@ -96,8 +114,14 @@ Status ExecEnv::_init(const std::vector<StorePath>& store_paths) {
     _broker_mgr = new BrokerMgr(this);
     _tablet_writer_mgr = new TabletWriterMgr(this);
     _load_stream_mgr = new LoadStreamMgr();
+    _runtime_filter_mgr = new RuntimeFilterMgr();
+    _shared_hash_table_mgr = new SharedHashTableMgr();
+    if (config::descriptor_tbl_cache_capacity > 0) {
+        _descriptor_tbl_cache = new DescriptorTblCache(config::descriptor_tbl_cache_capacity);
+    }
     _brpc_stub_cache = new BrpcStubCache();
     _stream_load_executor = new StreamLoadExecutor(this);
+    _group_commit_mgr = new GroupCommitMgr(this);
     _routine_load_task_executor = new RoutineLoadTaskExecutor(this);
 
     _backend_client_cache->init_metrics(DorisMetrics::metrics(), "backend");
@@ -119,7 +143,13 @@ Status ExecEnv::_init(const std::vector<StorePath>& store_paths) {
     }
     _broker_mgr->init();
     _init_mem_tracker();
+    if (config::fragment_result_cache_capacity > 0) {
+        _fragment_result_cache = new FragmentResultCache(
+            config::fragment_result_cache_capacity, _mem_tracker);
+    }
     RETURN_IF_ERROR(_tablet_writer_mgr->start_bg_worker());
+    RETURN_IF_ERROR(_group_commit_mgr->start_bg_worker());
+    RETURN_IF_ERROR(Tracer::instance()->start_bg_worker());
     return Status::OK;
 }
 
@@ -162,6 +192,9 @@ Status ExecEnv::_init_mem_tracker() {
     // Limit of 0 means no memory limit.
     if (bytes_limit > 0) {
         _mem_tracker = new MemTracker(bytes_limit);
+        _mem_tracker->AddGcFunction([this](int64_t bytes_to_free) {
+            _mem_arbitrator->revoke(bytes_to_free);
+        });
     }
 
     if (bytes_limit > MemInfo::physical_mem()) {
@@ -188,7 +221,15 @@ void ExecEnv::_init_buffer_pool(int64_t min_page_size,
 }
 
 void ExecEnv::_destory() {
+    // commits the open groups, before what their loads use is gone
+    delete _group_commit_mgr;
+    // exports the spans which have ended
+    Tracer::instance()->stop();
     delete _brpc_stub_cache;
+    delete _shared_hash_table_mgr;
+    delete _fragment_result_cache;
+    delete _descriptor_tbl_cache;
+    delete _runtime_filter_mgr;
     delete _load_stream_mgr;
     delete _tablet_writer_mgr;
     delete _broker_mgr;
@@ -203,9 +244,13 @@ void ExecEnv::_destory() {
     delete _cgroups_mgr;
     delete _etl_thread_pool;
     delete _thread_pool;
+    for (auto pool : _numa_thread_pools) {
+        delete pool;
+    }
     delete _thread_mgr;
     delete _pool_mem_trackers;
     delete _mem_tracker;
+    delete _mem_arbitrator;
     delete _broker_client_cache;
     delete _extdatasource_client_cache;
     delete _frontend_client_cache;
@@ -16,7 +16,9 @@
 // under the License.
 
 #include "runtime/export_sink.h"
+#include <algorithm>
 #include <sstream>
+#include <thread>
 
 #include "exprs/expr.h"
 #include "runtime/runtime_state.h"
@@ -28,22 +30,182 @@
 #include "util/types.h"
 #include "exec/local_file_writer.h"
 #include "exec/broker_writer.h"
+#include "exec/parquet_writer.h"
+#include "common/config.h"
+#include "util/blocking_queue.hpp"
 #include <thrift/protocol/TDebugProtocol.h>
 
 namespace doris {
 
+// csv text or one row group of parquet
+struct ExportSink::ExportChunk {
+    std::string text;
+    std::shared_ptr<arrow::Table> table;
+};
+
+// Writes chunks into a sequence of files on its own thread.
+class ExportSink::ExportWriter {
+public:
+    ExportWriter(ExportSink* sink, int index) :
+            _sink(sink),
+            _index(index),
+            _num_files(0),
+            _file_len(0),
+            _queue(4) {
+    }
+
+    ~ExportWriter() {
+        finish();
+    }
+
+    void start() {
+        _thread = std::thread(&ExportWriter::_run, this);
+    }
+
+    // waits while the queue is full, the error of the writer if it failed
+    Status add(const std::shared_ptr<ExportChunk>& chunk) {
+        RETURN_IF_ERROR(status());
+        _queue.blocking_put(chunk);
+        return Status::OK;
+    }
+
+    Status status() {
+        std::lock_guard<std::mutex> l(_lock);
+        return _status;
+    }
+
+    // writes the queued chunks and closes the file
+    Status finish() {
+        _queue.shutdown();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+        return status();
+    }
+
+private:
+    void _run() {
+        std::shared_ptr<ExportChunk> chunk;
+        while (_queue.blocking_get(&chunk)) {
+            if (!status().ok()) {
+                // drained without writing, not to block the sink
+                continue;
+            }
+            _set_status(_write(*chunk));
+        }
+        // an export without rows still has its file
+        if (_index == 0 && _num_files == 0 && status().ok()) {
+            _set_status(_open_file());
+        }
+        _set_status(_close_file());
+    }
+
+    void _set_status(const Status& st) {
+        if (!st.ok()) {
+            std::lock_guard<std::mutex> l(_lock);
+            if (_status.ok()) {
+                _status = st;
+            }
+        }
+    }
+
+    Status _write(const ExportChunk& chunk) {
+        SCOPED_TIMER(_sink->_write_timer);
+        if (_file_writer == nullptr && _parquet_writer == nullptr) {
+            RETURN_IF_ERROR(_open_file());
+        }
+        int64_t written = 0;
+        if (_parquet_writer != nullptr) {
+            int64_t file_len = _parquet_writer->written_len();
+            RETURN_IF_ERROR(_parquet_writer->write(*chunk.table));
+            _file_len = _parquet_writer->written_len();
+            written = _file_len - file_len;
+        } else {
+            size_t written_len = 0;
+            RETURN_IF_ERROR(_file_writer->write(
+                    reinterpret_cast<const uint8_t*>(chunk.text.data()), chunk.text.size(),
+                    &written_len));
+            written = chunk.text.size();
+            _file_len += written;
+        }
+        COUNTER_UPDATE(_sink->_bytes_written_counter, written);
+
+        int64_t max_file_size = _sink->_t_export_sink.__isset.max_file_size
+            ? _sink->_t_export_sink.max_file_size : 0;
+        if (max_file_size > 0 && _file_len >= max_file_size) {
+            RETURN_IF_ERROR(_close_file());
+        }
+        return Status::OK;
+    }
+
+    Status _open_file() {
+        std::stringstream file_name;
+        file_name << _sink->_file_name;
+        // the name of the only file is kept as before
+        if (_sink->_writers.size() > 1 || _sink->_t_export_sink.__isset.max_file_size) {
+            file_name << "_" << _index << "_" << _num_files;
+        }
+        if (_sink->is_parquet()) {
+            file_name << ".parquet";
+        }
+        ++_num_files;
+        _file_len = 0;
+
+        std::unique_ptr<FileWriter> file_writer;
+        RETURN_IF_ERROR(_sink->open_file_writer(file_name.str(), &file_writer));
+        if (_sink->is_parquet()) {
+            _parquet_writer.reset(new ParquetWriterWrap(
+                    file_writer.release(), _sink->_parquet_builder->schema(),
+                    _sink->_t_export_sink.__isset.compression
+                        ? _sink->_t_export_sink.compression : ""));
+            RETURN_IF_ERROR(_parquet_writer->open());
+        } else {
+            _file_writer = std::move(file_writer);
+        }
+        return Status::OK;
+    }
+
+    Status _close_file() {
+        if (_parquet_writer != nullptr) {
+            Status st = _parquet_writer->close();
+            _parquet_writer.reset();
+            return st;
+        }
+        if (_file_writer != nullptr) {
+            _file_writer->close();
+            _file_writer.reset();
+        }
+        return Status::OK;
+    }
+
+    ExportSink* _sink;
+    int _index;
+    int _num_files;
+    int64_t _file_len;
+    std::unique_ptr<FileWriter> _file_writer;
+    std::unique_ptr<ParquetWriterWrap> _parquet_writer;
+
+    BlockingQueue<std::shared_ptr<ExportChunk>> _queue;
+    std::thread _thread;
+    std::mutex _lock;
+    Status _status;
+};
+
 ExportSink::ExportSink(ObjectPool* pool,
                        const RowDescriptor& row_desc,
                        const std::vector<TExpr>& t_exprs) :
         _pool(pool),
         _row_desc(row_desc),
         _t_output_expr(t_exprs),
+        _next_writer(0),
         _bytes_written_counter(nullptr),
         _rows_written_counter(nullptr),
         _write_timer(nullptr) {
 }
 
 ExportSink::~ExportSink() {
+    // writers refer to this sink, they are stopped before it goes away
+    _writers.clear();
 }
 
 Status ExportSink::init(const TDataSink& t_sink) {
@@ -82,35 +244,72 @@ Status ExportSink::prepare(RuntimeState* state) {
 Status ExportSink::open(RuntimeState* state) {
     // Prepare the exprs to run.
     RETURN_IF_ERROR(Expr::open(_output_expr_ctxs, state));
-    // open broker
-    RETURN_IF_ERROR(open_file_writer());
+    if (is_parquet()) {
+        std::vector<std::string> column_names;
+        if (_t_export_sink.__isset.column_names) {
+            column_names = _t_export_sink.column_names;
+        }
+        _parquet_builder.reset(new ParquetBatchBuilder(_output_expr_ctxs, column_names));
+        RETURN_IF_ERROR(_parquet_builder->init());
+    } else if (_t_export_sink.__isset.format
+               && _t_export_sink.format != TFileFormatType::FORMAT_CSV_PLAIN) {
+        std::stringstream ss;
+        ss << "Unsupported export format, format=" << _t_export_sink.format;
+        return Status(ss.str());
+    }
+
+    // files are opened by the writers when they get their first data
+    _file_name = gen_file_name();
+    int num_writers = std::max(1, config::export_sink_parallel_files);
+    for (int i = 0; i < num_writers; ++i) {
+        _writers.emplace_back(new ExportWriter(this, i));
+    }
+    for (auto& writer : _writers) {
+        writer->start();
+    }
     return Status::OK;
 }
 
+bool ExportSink::is_parquet() const {
+    return _t_export_sink.__isset.format
+        && _t_export_sink.format == TFileFormatType::FORMAT_PARQUET;
+}
+
+Status ExportSink::add_chunk(const std::shared_ptr<ExportChunk>& chunk) {
+    ExportWriter* writer = _writers[_next_writer].get();
+    _next_writer = (_next_writer + 1) % _writers.size();
+    return writer->add(chunk);
+}
+
+Status ExportSink::flush_row_group() {
+    std::shared_ptr<ExportChunk> chunk(new ExportChunk());
+    RETURN_IF_ERROR(_parquet_builder->finish(&chunk->table));
+    return add_chunk(chunk);
+}
+
 Status ExportSink::send(RuntimeState* state, RowBatch* batch) {
     VLOG_ROW << "debug: export_sink send batch: " << batch->to_string();
     SCOPED_TIMER(_profile->total_time_counter());
     int num_rows = batch->num_rows();
-    // we send at most 1024 rows at a time
-    int batch_send_rows = num_rows > 1024 ? 1024 : num_rows;
-    std::stringstream ss;
-    for (int i = 0; i < num_rows;) {
-        ss.str("");
-        for (int j = 0; j < batch_send_rows && i < num_rows; ++j, ++i) {
-            RETURN_IF_ERROR(gen_row_buffer(batch->get_row(i), &ss));
+    if (_parquet_builder != nullptr) {
+        RETURN_IF_ERROR(_parquet_builder->add_batch(batch));
+        if (_parquet_builder->buffered_bytes()
+                >= config::export_parquet_row_group_mbytes * 1024L * 1024L) {
+            RETURN_IF_ERROR(flush_row_group());
         }
+        COUNTER_UPDATE(_rows_written_counter, num_rows);
+        return Status::OK;
+    }
 
-        VLOG_ROW << "debug: export_sink send row: " << ss.str();
-        const std::string& buf = ss.str();
-        size_t written_len = 0;
-
-        SCOPED_TIMER(_write_timer);
-        // TODO(lingbin): for broker writer, we should not send rpc each row.
-        RETURN_IF_ERROR(_file_writer->write(reinterpret_cast<const uint8_t*>(buf.c_str()),
-                buf.size(),
-                &written_len));
-        COUNTER_UPDATE(_bytes_written_counter, buf.size());
+    // the whole batch is written by one call, not to send an rpc per row
+    std::stringstream ss;
+    for (int i = 0; i < num_rows; ++i) {
+        RETURN_IF_ERROR(gen_row_buffer(batch->get_row(i), &ss));
     }
+    VLOG_ROW << "debug: export_sink send row: " << ss.str();
+    std::shared_ptr<ExportChunk> chunk(new ExportChunk());
+    chunk->text = ss.str();
+    RETURN_IF_ERROR(add_chunk(chunk));
     COUNTER_UPDATE(_rows_written_counter, num_rows);
     return Status::OK;
 }
@@ -212,28 +411,36 @@ Status ExportSink::gen_row_buffer(TupleRow* row, std::stringstream* ss) {
 }
 
 Status ExportSink::close(RuntimeState* state, Status exec_status) {
-    Expr::close(_output_expr_ctxs, state);
-    if (_file_writer != nullptr) {
-        _file_writer->close();
-        _file_writer = nullptr;
+    Status status = Status::OK;
+    if (exec_status.ok() && _parquet_builder != nullptr && _parquet_builder->num_rows() > 0) {
+        status = flush_row_group();
     }
-    return Status::OK;
-}
-
-Status ExportSink::open_file_writer() {
-    if (_file_writer != nullptr) {
-        return Status::OK;
+    for (auto& writer : _writers) {
+        Status st = writer->finish();
+        if (status.ok() && !st.ok()) {
+            status = st;
+        }
     }
+    _writers.clear();
+    Expr::close(_output_expr_ctxs, state);
 
-    std::string file_name = gen_file_name();
+    std::lock_guard<std::mutex> l(_files_lock);
+    for (auto& file : _files) {
+        _state->add_export_output_file(file);
+    }
+    _files.clear();
+    return status;
+}
 
+Status ExportSink::open_file_writer(const std::string& file_name,
+                                    std::unique_ptr<FileWriter>* file_writer) {
     // TODO(lingbin): gen file path
     switch (_t_export_sink.file_type) {
     case TFileType::FILE_LOCAL: {
-        LocalFileWriter* file_writer
+        LocalFileWriter* local_writer
                 = new LocalFileWriter(_t_export_sink.export_path + "/" + file_name, 0);
-        RETURN_IF_ERROR(file_writer->open());
-        _file_writer.reset(file_writer);
+        file_writer->reset(local_writer);
+        RETURN_IF_ERROR(local_writer->open());
         break;
     }
     case TFileType::FILE_BROKER: {
@@ -242,8 +449,8 @@ Status ExportSink::open_file_writer() {
                                                        _t_export_sink.properties,
                                                        _t_export_sink.export_path + "/" + file_name,
                                                        0 /* offset */);
+        file_writer->reset(broker_writer);
         RETURN_IF_ERROR(broker_writer->open());
-        _file_writer.reset(broker_writer);
         break;
     }
     default: {
@@ -253,7 +460,8 @@ Status ExportSink::open_file_writer() {
     }
     }
 
-    _state->add_export_output_file(_t_export_sink.export_path + "/" + file_name);
+    std::lock_guard<std::mutex> l(_files_lock);
+    _files.push_back(_t_export_sink.export_path + "/" + file_name);
     return Status::OK;
 }
 
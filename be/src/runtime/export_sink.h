@@ -18,6 +18,9 @@
 #ifndef DORIS_BE_SRC_RUNTIME_EXPORT_SINK_H
 #define DORIS_BE_SRC_RUNTIME_EXPORT_SINK_H
 
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include "common/status.h"
@@ -33,9 +36,16 @@ class RuntimeProfile;
 class ExprContext;
 class MemTracker;
 class FileWriter;
+class ParquetBatchBuilder;
 class TupleRow;
 
 // This class is a sinker, which put export data to external storage by broker.
+//
+// Rows are formatted as text, or converted to arrow arrays column by column
+// for parquet, on the calling thread. The data is written by
+// export_sink_parallel_files writers, each on its own thread and into its own
+// file, which are closed and followed by new files once they reach
+// max_file_size.
 class ExportSink : public DataSink {
 public:
     ExportSink(ObjectPool* pool,
@@ -61,9 +71,19 @@ public:
     }
 
 private:
-    Status open_file_writer();
+    class ExportWriter;
+    struct ExportChunk;
+
+    // opens the file 'file_name' of the export path
+    Status open_file_writer(const std::string& file_name,
+                            std::unique_ptr<FileWriter>* file_writer);
     Status gen_row_buffer(TupleRow* row, std::stringstream* ss);
     std::string gen_file_name();
+    // queues the data to the next writer, round robin
+    Status add_chunk(const std::shared_ptr<ExportChunk>& chunk);
+    // the parquet rows converted so far become one row group
+    Status flush_row_group();
+    bool is_parquet() const;
 
     RuntimeState* _state;
 
@@ -75,7 +95,15 @@ private:
     std::vector<ExprContext*> _output_expr_ctxs;
 
     TExportSink _t_export_sink;
-    std::unique_ptr<FileWriter> _file_writer;
+    // prefix of the names of the files of this sink
+    std::string _file_name;
+    std::vector<std::unique_ptr<ExportWriter>> _writers;
+    int _next_writer;
+    std::unique_ptr<ParquetBatchBuilder> _parquet_builder;
+
+    // files opened by the writers
+    std::mutex _files_lock;
+    std::vector<std::string> _files;
 
     RuntimeProfile* _profile;
 
@@ -29,10 +29,17 @@
 #include "runtime/plan_fragment_executor.h"
 #include "runtime/exec_env.h"
 #include "runtime/datetime_value.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tracer.h"
+#include "util/cpu_info.h"
 #include "util/stopwatch.hpp"
 #include "util/debug_util.h"
 #include "util/doris_metrics.h"
+#include "util/pretty_printer.h"
+#include "util/runtime_profile.h"
 #include "util/thrift_util.h"
+#include "util/uid_util.h"
 #include "runtime/client_cache.h"
 #include "gen_cpp/PaloInternalService_types.h"
 #include "gen_cpp/Types_types.h"
@@ -82,6 +89,10 @@ public:
 
     Status cancel();
 
+    // Cancels a fragment which failed to start and reports 'status' to the
+    // coordinator, for a queued fragment whose rpc has returned already.
+    void report_start_failure(const Status& status);
+
     TUniqueId fragment_instance_id() const {
         return _fragment_instance_id;
     }
@@ -109,6 +120,10 @@ public:
         _group = info.group;
     }
 
+    bool has_group() const { return _set_rsc_info; }
+    const std::string& user() const { return _user; }
+    const std::string& group() const { return _group; }
+
     bool is_timeout(const DateTimeValue& now) const {
         if (_timeout_second <= 0) {
             return false;
@@ -143,6 +158,9 @@ private:
 
     int _timeout_second;
 
+    // from the prepare to the end of the execution
+    std::unique_ptr<Span> _span;
+
     std::unique_ptr<std::thread> _exec_thread;
 };
 
@@ -176,7 +194,17 @@ Status FragmentExecState::prepare(const TExecPlanFragmentParams& params) {
         set_group(params.resource_info);
     }
 
-    return _executor.prepare(params);
+    // a coordinator which traces the query passes its span, otherwise the trace of
+    // the query is sampled here
+    TraceContext parent = params.__isset.trace_context
+        ? TraceContext::from_thrift(params.trace_context)
+        : Tracer::instance()->trace_context(params.params.query_id);
+    _span.reset(new Span(parent, "exec_plan_fragment"));
+    _span->add_attribute("fragment_instance_id", print_id(_fragment_instance_id));
+    _span->add_attribute("backend_num", _backend_num);
+    Status status = _executor.prepare(params, _span->context());
+    _span->set_status(status);
+    return status;
 }
 
 static void register_cgroups(const std::string& user, const std::string& group) {
@@ -201,11 +229,13 @@ Status FragmentExecState::execute() {
             CgroupsMgr::apply_system_cgroup();
         }
 
-        _executor.open();
+        _span->set_status(_executor.open());
         _executor.close();
     }
+    _span->end();
     DorisMetrics::fragment_requests_total.increment(1);
     DorisMetrics::fragment_request_duration_us.increment(duration_ns / 1000);
+    DorisMetrics::fragment_request_latency_us.add(duration_ns / 1000);
     return Status::OK;
 }
 
@@ -216,6 +246,13 @@ Status FragmentExecState::cancel() {
     return Status::OK;
 }
 
+void FragmentExecState::report_start_failure(const Status& status) {
+    cancel();
+    _span->set_status(status);
+    _span->end();
+    coordinator_callback(status, _executor.runtime_state()->runtime_profile(), true);
+}
+
 void FragmentExecState::callback(const Status& status, RuntimeProfile* profile, bool done) {
 }
 
@@ -342,13 +379,16 @@ FragmentMgr::FragmentMgr(ExecEnv* exec_env) :
         _cancel_thread(std::bind<void>(&FragmentMgr::cancel_worker, this)),
         // TODO(zc): we need a better thread-pool
         // now one user can use all the thread pool, others have no resource.
-        _thread_pool(config::fragment_pool_thread_num, config::fragment_pool_queue_size) {
+        _thread_pool(config::fragment_pool_thread_num, config::fragment_pool_queue_size),
+        _admission_controller(new AdmissionController(exec_env)) {
 }
 
 FragmentMgr::~FragmentMgr() {
     // stop thread
     _stop = true;
     _cancel_thread.join();
+    // Queued fragments are dropped
+    _admission_controller.reset();
     // Stop all the worker
     _thread_pool.drain_and_shutdown();
 
@@ -359,13 +399,19 @@ FragmentMgr::~FragmentMgr() {
     }
 }
 
+// the share of fragments without a resource group, as for their scanners
+static const int DEFAULT_FRAGMENT_WEIGHT = 400;
+
 static void empty_function(PlanFragmentExecutor* exec) {
 }
 
 void FragmentMgr::exec_actual(
         std::shared_ptr<FragmentExecState> exec_state,
         FinishCallback cb) {
+    int numa_node = bind_numa_node();
     exec_state->execute();
+    unbind_numa_node(numa_node);
+    _admission_controller->release();
 
     {
         std::lock_guard<std::mutex> lock(_lock);
@@ -383,6 +429,38 @@ void FragmentMgr::exec_actual(
     // NOTE: 'exec_state' is desconstructed here without lock
 }
 
+int FragmentMgr::bind_numa_node() {
+    int num_numa_nodes = CpuInfo::get_max_num_numa_nodes();
+    if (!config::numa_aware || num_numa_nodes <= 1) {
+        return -1;
+    }
+    int numa_node = 0;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_numa_node_fragments.empty()) {
+            _numa_node_fragments.resize(num_numa_nodes, 0);
+        }
+        for (int i = 1; i < num_numa_nodes; ++i) {
+            if (_numa_node_fragments[i] < _numa_node_fragments[numa_node]) {
+                numa_node = i;
+            }
+        }
+        ++_numa_node_fragments[numa_node];
+    }
+    // its scanners are run by the pool of the node too, see ExecEnv::thread_pool()
+    CpuInfo::bind_thread_to_numa_node(numa_node);
+    return numa_node;
+}
+
+void FragmentMgr::unbind_numa_node(int numa_node) {
+    if (numa_node < 0) {
+        return;
+    }
+    CpuInfo::unbind_thread();
+    std::lock_guard<std::mutex> lock(_lock);
+    --_numa_node_fragments[numa_node];
+}
+
 Status FragmentMgr::exec_plan_fragment(
         const TExecPlanFragmentParams& params) {
     return exec_plan_fragment(params, std::bind<void>(&empty_function, std::placeholders::_1));
@@ -415,7 +493,6 @@ Status FragmentMgr::exec_plan_fragment(
             _exec_env,
             params.coord));
     RETURN_IF_ERROR(exec_state->prepare(params));
-    bool use_pool = true;
     {
         std::lock_guard<std::mutex> lock(_lock);
         auto iter = _fragment_map.find(fragment_instance_id);
@@ -425,7 +502,47 @@ Status FragmentMgr::exec_plan_fragment(
         }
         // register exec_state before starting exec thread
         _fragment_map.insert(std::make_pair(fragment_instance_id, exec_state));
+    }
 
+    // the fragments of a resource group are started by its share, like its scanners
+    std::string group;
+    int weight = DEFAULT_FRAGMENT_WEIGHT;
+    if (exec_state->has_group()) {
+        group = exec_state->user() + "." + exec_state->group();
+        if (_exec_env != nullptr && _exec_env->cgroups_mgr() != nullptr) {
+            weight = _exec_env->cgroups_mgr()->get_level_share(
+                exec_state->user(), exec_state->group(), DEFAULT_FRAGMENT_WEIGHT);
+        }
+    }
+    bool admitted = _admission_controller->admit(group, weight,
+            [this, exec_state, cb](int64_t queue_time_ns) {
+        Status status = start_fragment(exec_state, cb, queue_time_ns);
+        if (!status.ok()) {
+            LOG(WARNING) << "failed to start queued fragment, instance_id="
+                << print_id(exec_state->fragment_instance_id())
+                << ", error=" << status.get_error_msg();
+            exec_state->report_start_failure(status);
+        }
+    });
+    if (!admitted) {
+        return Status::OK;
+    }
+    return start_fragment(exec_state, cb, 0);
+}
+
+Status FragmentMgr::start_fragment(
+        std::shared_ptr<FragmentExecState> exec_state,
+        FinishCallback cb,
+        int64_t queue_time_ns) {
+    const TUniqueId& fragment_instance_id = exec_state->fragment_instance_id();
+    RuntimeState* runtime_state = exec_state->executor()->runtime_state();
+    if (runtime_state != nullptr) {
+        ADD_TIMER(runtime_state->runtime_profile(), "AdmissionQueueTime")->set(queue_time_ns);
+    }
+
+    bool use_pool = true;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
         // Now, we the fragement is
         if (_fragment_map.size() >= config::fragment_pool_thread_num) {
             use_pool = false;
@@ -440,6 +557,7 @@ Status FragmentMgr::exec_plan_fragment(
                 std::lock_guard<std::mutex> lock(_lock);
                 _fragment_map.erase(fragment_instance_id);
             }
+            _admission_controller->release();
             return Status("Put planfragment to failed.");
         }
     } else {
@@ -454,6 +572,11 @@ Status FragmentMgr::exec_plan_fragment(
             err_msg.append(strerror(ret));
             err_msg.append(",");
             err_msg.append(std::to_string(ret));
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _fragment_map.erase(fragment_instance_id);
+            }
+            _admission_controller->release();
             return Status(err_msg);
         }
         pthread_detach(id);
@@ -529,6 +652,39 @@ Status FragmentMgr::trigger_profile_report(const PTriggerProfileReportRequest* r
 }
 
 
+void FragmentMgr::print_running_profiles(const std::string& query_id, std::stringstream* ss) {
+    // profiles are printed without the lock, the states are kept by the
+    // references taken here
+    std::vector<std::shared_ptr<FragmentExecState>> exec_states;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        for (auto& it : _fragment_map) {
+            if (query_id.empty()
+                    || print_id(it.second->executor()->runtime_state()->query_id()) == query_id) {
+                exec_states.push_back(it.second);
+            }
+        }
+    }
+
+    DateTimeValue now = DateTimeValue::local_time();
+    for (auto& exec_state : exec_states) {
+        RuntimeState* state = exec_state->executor()->runtime_state();
+        MemTracker* mem_tracker = state->instance_mem_tracker();
+        *ss << "Query " << print_id(state->query_id())
+            << ", instance " << print_id(exec_state->fragment_instance_id())
+            << ", start_time=" << exec_state->start_time().debug_string()
+            << ", execute_time(s)=" << now.second_diff(exec_state->start_time());
+        if (mem_tracker != nullptr) {
+            *ss << ", memory=" << PrettyPrinter::print(mem_tracker->consumption(), TUnit::BYTES)
+                << ", peak_memory="
+                << PrettyPrinter::print(mem_tracker->peak_consumption(), TUnit::BYTES);
+        }
+        *ss << "\n";
+        exec_state->executor()->profile()->pretty_print(ss, "  ");
+        *ss << "\n";
+    }
+}
+
 void FragmentMgr::debug(std::stringstream& ss) {
     // Keep things simple
     std::lock_guard<std::mutex> lock(_lock);
@@ -21,10 +21,12 @@
 #include <mutex>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include <functional>
 #include <thread>
 
 #include "common/status.h"
+#include "runtime/admission_controller.h"
 #include "gen_cpp/Types_types.h"
 #include "gen_cpp/internal_service.pb.h"
 #include "util/thread_pool.hpp"
@@ -62,10 +64,25 @@ public:
 
     Status trigger_profile_report(const PTriggerProfileReportRequest* request);
 
+    // Prints the current profiles of the running fragment instances, only the
+    // ones of the query if query_id is not empty, with their execution time
+    // and memory.
+    void print_running_profiles(const std::string& query_id, std::stringstream* ss);
+
 private:
     void exec_actual(std::shared_ptr<FragmentExecState> exec_state,
                      FinishCallback cb);
 
+    // Binds the current thread to the NUMA node running the fewest fragments,
+    // returns it, -1 if not numa_aware.
+    int bind_numa_node();
+    void unbind_numa_node(int numa_node);
+
+    // Runs the fragment admitted by _admission_controller after it waited
+    // 'queue_time_ns' in its queue.
+    Status start_fragment(std::shared_ptr<FragmentExecState> exec_state,
+                          FinishCallback cb, int64_t queue_time_ns);
+
     // This is input params
     ExecEnv* _exec_env;
 
@@ -73,12 +90,16 @@ private:
 
     // Make sure that remove this before no data reference FragmentExecState
     std::unordered_map<TUniqueId, std::shared_ptr<FragmentExecState>> _fragment_map;
+    // running fragments of each NUMA node, empty if not numa_aware
+    std::vector<int> _numa_node_fragments;
 
     // Cancel thread
     bool _stop;
     std::thread _cancel_thread;
     // every job is a pool
     ThreadPool _thread_pool;
+    // Reset before _thread_pool is shut down
+    std::unique_ptr<AdmissionController> _admission_controller;
 
 };
 
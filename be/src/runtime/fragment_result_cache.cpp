@@ -0,0 +1,235 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/fragment_result_cache.h"
+
+#include <stdlib.h>
+
+#include "common/config.h"
+#include "gen_cpp/PaloInternalService_types.h"
+#include "olap/lru_cache.h"
+#include "olap/olap_engine.h"
+#include "olap/olap_table.h"
+#include "runtime/mem_tracker.h"
+#include "util/doris_metrics.h"
+#include "util/thrift_util.h"
+
+namespace doris {
+
+// Functions whose results change between identical queries. Plans in which
+// they appear anywhere, even in a column name, are not cached: that only
+// costs a cache miss.
+static const char* NON_DETERMINISTIC_FUNCTIONS[] = {
+    "now", "curdate", "curtime", "current_", "localtime", "unix_timestamp",
+    "utc_timestamp", "rand", "uuid", "sleep",
+};
+
+struct FragmentResultCacheValue {
+    std::shared_ptr<const FragmentResultCache::Entry> entry;
+    MemTracker* mem_tracker;
+};
+
+static void delete_value(const CacheKey& key, void* value) {
+    FragmentResultCacheValue* cache_value = reinterpret_cast<FragmentResultCacheValue*>(value);
+    cache_value->mem_tracker->release(cache_value->entry->bytes);
+    delete cache_value;
+}
+
+FragmentResultCache::FragmentResultCache(int64_t capacity, MemTracker* parent)
+        : _mem_tracker(new MemTracker(-1, "fragment result cache", parent)),
+          _cache(new_lru_cache(capacity)) {
+}
+
+FragmentResultCache::~FragmentResultCache() {
+}
+
+bool FragmentResultCache::make_key(const TExecPlanFragmentParams& params, std::string* key,
+                                   std::map<int64_t, int64_t>* versions, bool* is_mergeable) {
+    const TPlanFragment& fragment = params.fragment;
+    if (!fragment.__isset.plan || fragment.plan.nodes.empty()
+            || !fragment.__isset.output_sink || !params.__isset.desc_tbl) {
+        return false;
+    }
+    TDataSinkType::type sink_type = fragment.output_sink.type;
+    if (sink_type != TDataSinkType::DATA_STREAM_SINK && sink_type != TDataSinkType::RESULT_SINK) {
+        return false;
+    }
+    bool has_aggregation = false;
+    bool has_limit = false;
+    for (auto& node : fragment.plan.nodes) {
+        switch (node.node_type) {
+        case TPlanNodeType::AGGREGATION_NODE:
+            has_aggregation = true;
+            break;
+        case TPlanNodeType::SELECT_NODE:
+            break;
+        case TPlanNodeType::OLAP_SCAN_NODE:
+            // runtime filters come from joins of other fragments
+            if (node.olap_scan_node.__isset.runtime_filters
+                    && !node.olap_scan_node.runtime_filters.empty()) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+        has_limit |= node.limit >= 0;
+    }
+    // the results of scans alone are as large as the tablets
+    if (!has_aggregation) {
+        return false;
+    }
+    // partial aggregates of several scans add up in the merging aggregation
+    const TPlanNode& root = fragment.plan.nodes[0];
+    *is_mergeable = sink_type == TDataSinkType::DATA_STREAM_SINK
+        && root.node_type == TPlanNodeType::AGGREGATION_NODE
+        && !root.agg_node.need_finalize && !has_limit;
+
+    ThriftSerializer serializer(true, 4096);
+    std::string buf;
+    if (!serializer.serialize(&fragment.plan, &buf).ok()) {
+        return false;
+    }
+    for (const char* function : NON_DETERMINISTIC_FUNCTIONS) {
+        if (buf.find(function) != std::string::npos) {
+            return false;
+        }
+    }
+    key->assign(buf);
+
+    if (!serializer.serialize(&params.desc_tbl, &buf).ok()) {
+        return false;
+    }
+    key->append(buf);
+
+    // the tablets, not their versions or the replicas they are read from
+    versions->clear();
+    for (auto& it : params.params.per_node_scan_ranges) {
+        for (auto& range_params : it.second) {
+            if (!range_params.scan_range.__isset.palo_scan_range) {
+                return false;
+            }
+            TPaloScanRange range = range_params.scan_range.palo_scan_range;
+            (*versions)[range.tablet_id] = strtoll(range.version.c_str(), nullptr, 10);
+            range.hosts.clear();
+            range.version.clear();
+            range.version_hash.clear();
+            if (!serializer.serialize(&range, &buf).ok()) {
+                return false;
+            }
+            key->append(buf);
+        }
+    }
+    return true;
+}
+
+bool FragmentResultCache::only_adds_rows(const TPaloScanRange& range, int64_t version) {
+    SchemaHash schema_hash = strtoul(range.schema_hash.c_str(), nullptr, 10);
+    OLAPTablePtr table = OLAPEngine::get_instance()->get_table(range.tablet_id, schema_hash);
+    // new rows of other keys replace or aggregate with the old ones
+    if (table.get() == nullptr || table->keys_type() != KeysType::DUP_KEYS) {
+        return false;
+    }
+    // deletes remove old rows
+    ReadLock rdlock(table->get_header_lock_ptr());
+    for (auto& condition : table->delete_data_conditions()) {
+        if (condition.version() > version) {
+            return false;
+        }
+    }
+    // the new versions can not be read alone once compactions merged them
+    // with the old ones
+    std::vector<Version> span_versions;
+    Version new_versions(version + 1, strtoll(range.version.c_str(), nullptr, 10));
+    return table->select_versions_to_span(new_versions, &span_versions) == OLAP_SUCCESS;
+}
+
+void FragmentResultCache::lookup(const TExecPlanFragmentParams& params, Lookup* lookup) {
+    if (!make_key(params, &lookup->key, &lookup->versions, &lookup->is_mergeable)) {
+        lookup->key.clear();
+        return;
+    }
+    std::shared_ptr<const Entry> entry = this->lookup(lookup->key);
+    if (entry == nullptr) {
+        return;
+    }
+    if (entry->versions == lookup->versions) {
+        lookup->entry = entry;
+        return;
+    }
+    if (!lookup->is_mergeable) {
+        return;
+    }
+    for (auto& it : params.params.per_node_scan_ranges) {
+        for (auto& range_params : it.second) {
+            const TPaloScanRange& range = range_params.scan_range.palo_scan_range;
+            auto cached = entry->versions.find(range.tablet_id);
+            if (cached == entry->versions.end()) {
+                return;
+            }
+            int64_t version = lookup->versions[range.tablet_id];
+            // results of newer versions can not be taken back
+            if (cached->second > version) {
+                return;
+            }
+            if (cached->second < version && !only_adds_rows(range, cached->second)) {
+                return;
+            }
+        }
+    }
+    lookup->entry = entry;
+    lookup->is_incremental = true;
+}
+
+std::shared_ptr<const FragmentResultCache::Entry> FragmentResultCache::lookup(
+        const std::string& key) {
+    Cache::Handle* handle = _cache->lookup(CacheKey(key));
+    if (handle == nullptr) {
+        DorisMetrics::fragment_result_cache_misses_total.increment(1);
+        return nullptr;
+    }
+    DorisMetrics::fragment_result_cache_hits_total.increment(1);
+    std::shared_ptr<const Entry> entry =
+        reinterpret_cast<FragmentResultCacheValue*>(_cache->value(handle))->entry;
+    _cache->release(handle);
+    return entry;
+}
+
+void FragmentResultCache::insert(const Lookup& lookup, const Batches& batches, int64_t bytes) {
+    DCHECK(!lookup.key.empty());
+    std::shared_ptr<Entry> entry(new Entry());
+    entry->versions = lookup.versions;
+    entry->bytes = bytes + lookup.key.size();
+    if (lookup.is_incremental) {
+        entry->batches = lookup.entry->batches;
+        entry->bytes += lookup.entry->bytes - lookup.key.size();
+    }
+    if (entry->bytes > config::fragment_result_cache_max_entry_bytes) {
+        _cache->erase(CacheKey(lookup.key));
+        return;
+    }
+    entry->batches.insert(entry->batches.end(), batches.begin(), batches.end());
+
+    FragmentResultCacheValue* value = new FragmentResultCacheValue();
+    value->entry = entry;
+    value->mem_tracker = _mem_tracker.get();
+    _mem_tracker->consume(entry->bytes);
+    Cache::Handle* handle = _cache->insert(CacheKey(lookup.key), value, entry->bytes, delete_value);
+    _cache->release(handle);
+}
+
+}
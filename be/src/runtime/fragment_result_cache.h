@@ -0,0 +1,116 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_FRAGMENT_RESULT_CACHE_H
+#define DORIS_BE_RUNTIME_FRAGMENT_RESULT_CACHE_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gen_cpp/data.pb.h"
+
+namespace doris {
+
+class Cache;
+class MemTracker;
+class TExecPlanFragmentParams;
+class TPaloScanRange;
+
+// Output batches of fragment instances which aggregate the rows of tablets,
+// kept between queries. Dashboards run the same aggregations over the same
+// versions again and again, they get the batches from here instead of
+// scanning the tablets.
+//
+// An entry is keyed by the plan and descriptors of the fragment and by the
+// tablets it scans, and holds the results of given versions of them. Queries
+// of other versions do not use it but for one case: if the fragment sends
+// partial aggregates and the tablets have duplicate keys, rows of new
+// versions can only add to the results. Then only the new versions are
+// scanned and their partial aggregates are sent after the cached ones, the
+// merging aggregation receiving them combines both. Real time dashboards
+// over small frequent loads scan the last loads only.
+//
+// Entries are evicted as the least recently used ones. The memory of the
+// entries is tracked by the tracker of the cache below the process one.
+class FragmentResultCache {
+public:
+    typedef std::vector<std::shared_ptr<const PRowBatch>> Batches;
+
+    struct Entry {
+        // for every tablet, the version the results are of
+        std::map<int64_t, int64_t> versions;
+        Batches batches;
+        int64_t bytes = 0;
+    };
+
+    // The cached results of a fragment instance.
+    struct Lookup {
+        // empty if the results can not be cached
+        std::string key;
+        // versions of the tablets scanned by the instance
+        std::map<int64_t, int64_t> versions;
+        // true if the results are partial aggregates of duplicate key
+        // tablets, see above
+        bool is_mergeable = false;
+        // nullptr if nothing can be used
+        std::shared_ptr<const Entry> entry;
+        // if true 'entry' is of older versions: only the versions after
+        // entry->versions are scanned and added to its batches. Else it has
+        // all the results.
+        bool is_incremental = false;
+    };
+
+    FragmentResultCache(int64_t capacity, MemTracker* parent);
+    ~FragmentResultCache();
+
+    // Sets 'key' to the key of the results of the fragment instance of
+    // 'params' and 'versions' to the versions of the scanned tablets.
+    // Returns false if they can not be cached: only scans of olap tablets
+    // without runtime filters, aggregations and selects sending to a stream
+    // or result sink are, if no expression depends on the time or on
+    // randomness.
+    static bool make_key(const TExecPlanFragmentParams& params, std::string* key,
+                         std::map<int64_t, int64_t>* versions, bool* is_mergeable);
+
+    // Finds what of the results of the instance of 'params' is cached.
+    void lookup(const TExecPlanFragmentParams& params, Lookup* lookup);
+
+    // Caches the results of 'lookup': its cached batches if it is
+    // incremental, followed by 'batches' of 'bytes' in all. If they are too
+    // large the entry of the key is removed, so the next query scans all
+    // versions again instead of more and more new ones.
+    void insert(const Lookup& lookup, const Batches& batches, int64_t bytes);
+
+    // Returns the batches of 'key', nullptr if they are not cached.
+    std::shared_ptr<const Entry> lookup(const std::string& key);
+
+private:
+    // Returns true if the rows of 'range' after 'version' only add to the
+    // results of the rows up to it and can be scanned alone.
+    static bool only_adds_rows(const TPaloScanRange& range, int64_t version);
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    // after the tracker, which the entries are released from when they are
+    // destroyed
+    std::unique_ptr<Cache> _cache;
+};
+
+}
+
+#endif // DORIS_BE_RUNTIME_FRAGMENT_RESULT_CACHE_H
@@ -0,0 +1,85 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/mem_arbitrator.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "runtime/mem_tracker.h"
+
+namespace doris {
+
+int64_t MemArbitrator::register_consumer(int priority, RevocableFunction revocable,
+                                         RevokeFunction revoke) {
+    std::lock_guard<std::mutex> l(_lock);
+    int64_t id = _next_id++;
+    _consumers.push_back({id, priority, std::move(revocable), std::move(revoke)});
+    return id;
+}
+
+void MemArbitrator::unregister_consumer(int64_t id) {
+    std::lock_guard<std::mutex> l(_lock);
+    for (auto it = _consumers.begin(); it != _consumers.end(); ++it) {
+        if (it->id == id) {
+            _consumers.erase(it);
+            return;
+        }
+    }
+}
+
+int64_t MemArbitrator::revoke(int64_t bytes) {
+    std::lock_guard<std::mutex> l(_lock);
+    // (priority, -revocable bytes, index)
+    std::vector<std::tuple<int, int64_t, size_t>> order;
+    for (size_t i = 0; i < _consumers.size(); ++i) {
+        int64_t revocable = _consumers[i].revocable();
+        if (revocable > 0) {
+            order.emplace_back(_consumers[i].priority, -revocable, i);
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    int64_t freed = 0;
+    for (auto& entry : order) {
+        if (freed >= bytes) {
+            break;
+        }
+        freed += _consumers[std::get<2>(entry)].revoke(bytes - freed);
+    }
+    if (!order.empty()) {
+        VLOG_QUERY << "revoked memory of spilling operators, requested=" << bytes
+            << ", freed=" << freed << ", consumers=" << order.size();
+    }
+    return freed;
+}
+
+void MemArbitrator::maintain(MemTracker* process_tracker) {
+    if (process_tracker == nullptr || !process_tracker->has_limit()) {
+        return;
+    }
+    int64_t target = process_tracker->limit() * config::mem_arbitrator_revoke_ratio;
+    int64_t consumption = process_tracker->consumption();
+    if (consumption > target) {
+        revoke(consumption - target);
+    }
+}
+
+}
@@ -0,0 +1,76 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_MEM_ARBITRATOR_H
+#define DORIS_BE_RUNTIME_MEM_ARBITRATOR_H
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace doris {
+
+class MemTracker;
+
+// Frees memory held by operators which can spill, when the process runs out
+// of it, before allocations fail and queries are cancelled. It is called by the
+// process tracker when an allocation would exceed its limit, and periodically
+// once the consumption passes config::mem_arbitrator_revoke_ratio of the limit.
+//
+// Consumers are asked in the order of their priority, lower first, and among
+// the same priority the one which can free the most first. They are called
+// with the gc lock of the process tracker held: they must not block and may
+// only release memory. A consumer busy with its own allocations is skipped.
+class MemArbitrator {
+public:
+    // Returns the bytes the consumer could free now.
+    typedef std::function<int64_t()> RevocableFunction;
+    // Frees up to the given bytes and returns the bytes freed. It may also
+    // start spilling, the memory is freed by a later call then.
+    typedef std::function<int64_t(int64_t)> RevokeFunction;
+
+    MemArbitrator() : _next_id(0) { }
+
+    // Returns the id to unregister the consumer with. The functions are not
+    // called any more once unregister_consumer() returns.
+    int64_t register_consumer(int priority, RevocableFunction revocable,
+                              RevokeFunction revoke);
+    void unregister_consumer(int64_t id);
+
+    // Asks the consumers to free 'bytes', returns the bytes they freed.
+    int64_t revoke(int64_t bytes);
+
+    // Revokes memory down to config::mem_arbitrator_revoke_ratio of the limit
+    // of 'process_tracker', if it has one.
+    void maintain(MemTracker* process_tracker);
+
+private:
+    struct Consumer {
+        int64_t id;
+        int priority;
+        RevocableFunction revocable;
+        RevokeFunction revoke;
+    };
+
+    std::mutex _lock;
+    int64_t _next_id;
+    std::vector<Consumer> _consumers;
+};
+
+}
+
+#endif // DORIS_BE_RUNTIME_MEM_ARBITRATOR_H
@@ -27,6 +27,7 @@
 
 #include "common/logging.h"
 #include "gutil/dynamic_annotations.h"
+#include "runtime/chunk_allocator.h"
 #include "util/bit_util.h"
 
 namespace doris {
@@ -42,6 +43,8 @@ class MemTracker;
 /// against that tracker and all of its ancestors. If chunks get moved between pools
 /// during AcquireData() calls, the respective MemTrackers are updated accordingly.
 /// Chunks freed up in the d'tor are subtracted from the registered trackers.
+/// Chunks are taken from the process wide ChunkAllocator and given back to it, so
+/// that their memory is reused by the next pools.
 //
 /// An Allocate() call will attempt to allocate memory from the chunk that was most
 /// recently added; if that chunk doesn't have enough memory to
@@ -183,18 +186,24 @@ class MemPool {
   struct ChunkInfo {
     uint8_t* data; // Owned by the ChunkInfo.
     int64_t size;  // in bytes
+    /// core which allocated the chunk, see ChunkAllocator
+    int core_id;
 
     /// bytes allocated via Allocate() in this chunk
     int64_t allocated_bytes;
 
-    explicit ChunkInfo(int64_t size, uint8_t* buf);
+    explicit ChunkInfo(const Chunk& chunk);
 
     ChunkInfo()
       : data(NULL),
         size(0),
+        core_id(-1),
         allocated_bytes(0) {}
   };
 
+  /// Gives the memory of 'info' back to the ChunkAllocator.
+  static void free_chunk(const ChunkInfo& info);
+
   /// A static field used as non-NULL pointer for zero length allocations. NULL is
   /// reserved for allocation failures. It must be as aligned as max_align_t for
   /// TryAllocateAligned().
@@ -24,6 +24,7 @@
 //#include <boost/shared_ptr.hpp>
 //include <boost/weak_ptr.hpp>
 
+#include "common/config.h"
 #include "gutil/strings/substitute.h"
 #include "runtime/exec_env.h"
 #include "runtime/runtime_state.h"
@@ -44,6 +45,8 @@ namespace doris {
 
 const std::string MemTracker::COUNTER_NAME = "PeakMemoryUsage";
 
+std::mutex MemTracker::_s_batch_budget_lock;
+
 // Name for request pool MemTrackers. '$0' is replaced with the pool name.
 const std::string REQUEST_POOL_MEM_TRACKER_LABEL_FORMAT = "RequestPool=$0";
 
@@ -108,10 +111,55 @@ void MemTracker::Init() {
     }
     DCHECK_GT(_all_trackers.size(), 0);
     DCHECK_EQ(_all_trackers[0], this);
+
+    // the pending bytes of all cores of all trackers below a limit must stay a
+    // small part of it, the batch is taken from the budget of every limit above
+    _batch_bytes = 0;
+    _batch_budget = _limit >= 0 ? _limit / 64 : 0;
+    _batch_budget_taken = 0;
+    if (_parent != NULL && config::mem_tracker_consume_batch_bytes > 0) {
+        int64_t num_cores = CoreLocalValueController<int64_t>::instance()->size();
+        int64_t batch_bytes = config::mem_tracker_consume_batch_bytes;
+        std::lock_guard<std::mutex> l(_s_batch_budget_lock);
+        for (auto tracker : _limit_trackers) {
+            if (tracker != this) {
+                batch_bytes = std::min(batch_bytes, tracker->_batch_budget / num_cores);
+            }
+        }
+        if (batch_bytes > 0) {
+            _batch_bytes = batch_bytes;
+            _batch_budget_taken = batch_bytes * num_cores;
+            for (auto tracker : _limit_trackers) {
+                if (tracker != this) {
+                    tracker->_batch_budget -= _batch_budget_taken;
+                }
+            }
+        }
+    }
+    if (_batch_bytes > 0) {
+        _pending_ancestor_bytes.reset(new CoreLocalValue<int64_t>(0));
+    }
+}
+
+void MemTracker::flush_batched_consumption() {
+    if (_pending_ancestor_bytes == nullptr) {
+        return;
+    }
+    int64_t value = 0;
+    for (size_t i = 0; i < _pending_ancestor_bytes->size(); ++i) {
+        value += __sync_lock_test_and_set(_pending_ancestor_bytes->access_at_core(i), 0);
+    }
+    if (value == 0) {
+        return;
+    }
+    for (int i = 1; i < _all_trackers.size(); ++i) {
+        _all_trackers[i]->_consumption->add(value);
+    }
 }
 
 // TODO chenhao , set MemTracker close state
 void MemTracker::close() {
+    flush_batched_consumption();
 }
 
 void MemTracker::enable_reservation_reporting(const ReservationTrackerCounters& counters) {
@@ -182,6 +230,15 @@ MemTracker* MemTracker::CreateQueryMemTracker(const TUniqueId& id,
 }
 
 MemTracker::~MemTracker() {
+    flush_batched_consumption();
+    if (_batch_budget_taken > 0) {
+        std::lock_guard<std::mutex> l(_s_batch_budget_lock);
+        for (auto tracker : _limit_trackers) {
+            if (tracker != this) {
+                tracker->_batch_budget += _batch_budget_taken;
+            }
+        }
+    }
     DCHECK_EQ(_consumption->current_value(), 0) << _label << "\n"
         << get_stack_trace() << "\n"
         << LogUsage("");
@@ -25,6 +25,7 @@
 #include <unordered_map>
 
 #include "gen_cpp/Types_types.h"
+#include "util/core_local.h"
 #include "util/metrics.h"
 #include "util/runtime_profile.h"
 #include "util/spinlock.h"
@@ -133,6 +134,12 @@ public:
             RefreshConsumptionFromMetric();
             return;
         }
+        if (_batch_bytes > 0) {
+            // may be below zero for a while, see add_to_ancestors_batched()
+            _consumption->add(bytes);
+            add_to_ancestors_batched(bytes);
+            return;
+        }
         for (std::vector<MemTracker*>::iterator tracker = _all_trackers.begin();
              tracker != _all_trackers.end(); ++tracker) {
             (*tracker)->_consumption->add(bytes);
@@ -216,6 +223,11 @@ public:
             RefreshConsumptionFromMetric();
             return;
         }
+        if (_batch_bytes > 0) {
+            _consumption->add(-bytes);
+            add_to_ancestors_batched(-bytes);
+            return;
+        }
         for (std::vector<MemTracker*>::iterator tracker = _all_trackers.begin();
              tracker != _all_trackers.end(); ++tracker) {
             (*tracker)->_consumption->add(-bytes);
@@ -395,6 +407,24 @@ private:
     // Walks the MemTracker hierarchy and populates _all_trackers and _limit_trackers
     void Init();
 
+    /// Adds 'bytes' to the consumption of the ancestors which is pending on the
+    /// current core, and the pending bytes to the ancestors once they reach
+    /// _batch_bytes either way. The ancestors, and so a batched tracker which is
+    /// the ancestor of others, may go below zero for a while if memory is released
+    /// on another core than it is consumed.
+    void add_to_ancestors_batched(int64_t bytes) {
+        int64_t* pending = _pending_ancestor_bytes->access();
+        int64_t value = __sync_add_and_fetch(pending, bytes);
+        if (LIKELY(value < _batch_bytes && value > -_batch_bytes)) return;
+        value = __sync_lock_test_and_set(pending, 0);
+        for (int i = 1; i < _all_trackers.size(); ++i) {
+            _all_trackers[i]->_consumption->add(value);
+        }
+    }
+
+    /// Adds the pending consumption of all cores to the ancestors.
+    void flush_batched_consumption();
+
     // Adds tracker to _child_trackers
     void add_child_tracker(MemTracker* tracker) {
         std::lock_guard<std::mutex> l(_child_trackers_lock);
@@ -451,6 +481,27 @@ private:
     std::vector<MemTracker*> _all_trackers;  // this tracker plus all of its ancestors
     std::vector<MemTracker*> _limit_trackers;  // _all_trackers with valid limits
 
+    /// Consumption of this tracker is added to the ancestors in batches of up to this
+    /// many bytes per core. 0 if it is added at once, always for the root.
+    int64_t _batch_bytes;
+
+    /// Consumption not yet added to the ancestors on each core. Only set if
+    /// _batch_bytes > 0.
+    std::unique_ptr<CoreLocalValue<int64_t>> _pending_ancestor_bytes;
+
+    /// How far the consumption of the trackers below this one may still lag behind,
+    /// 1/64 of the limit at first. Each batched tracker below takes _batch_bytes per
+    /// core of it, so the lag stays bounded however many trackers there are. Only
+    /// used if this tracker has a limit.
+    int64_t _batch_budget;
+
+    /// What this tracker took from the _batch_budget of each ancestor with a limit,
+    /// given back by the destructor.
+    int64_t _batch_budget_taken;
+
+    /// Protects _batch_budget of all trackers.
+    static std::mutex _s_batch_budget_lock;
+
     // All the child trackers of this tracker. Used for error reporting only.
     // i.e., Updating a parent tracker does not update the children.
     mutable std::mutex _child_trackers_lock;
@@ -30,6 +30,15 @@ public:
     virtual Status append(const ByteBufferPtr& buf) {
         return append(buf->ptr, buf->remaining());
     }
+    // Like append(), but never waits for the consumer. Producers which must
+    // not block, like the event loops of the HTTP server, append this way
+    // and stop appending while has_room() returns false.
+    virtual Status append_nowait(const ByteBufferPtr& buf) {
+        return append(buf);
+    }
+    virtual bool has_room() {
+        return true;
+    }
     // called when all data has been append
     virtual Status finish() {
         return Status::OK;
@@ -32,6 +32,7 @@
 #include "exprs/expr.h"
 #include "runtime/exec_env.h"
 #include "runtime/descriptors.h"
+#include "runtime/descriptor_tbl_cache.h"
 #include "runtime/data_stream_mgr.h"
 #include "runtime/result_buffer_mgr.h"
 #include "runtime/row_batch.h"
@@ -66,7 +67,8 @@ PlanFragmentExecutor::~PlanFragmentExecutor() {
     DCHECK(!_report_thread_active);
 }
 
-Status PlanFragmentExecutor::prepare(const TExecPlanFragmentParams& request) {
+Status PlanFragmentExecutor::prepare(const TExecPlanFragmentParams& request,
+                                     const TraceContext& trace_context) {
     const TPlanFragmentExecParams& params = request.params;
     _query_id = params.query_id;
 
@@ -79,6 +81,7 @@ Status PlanFragmentExecutor::prepare(const TExecPlanFragmentParams& request) {
             request, request.query_options, request.query_globals.now_string, _exec_env));
 
     RETURN_IF_ERROR(_runtime_state->init_mem_trackers(_query_id));
+    _runtime_state->set_trace_context(trace_context);
     _runtime_state->set_be_number(request.backend_num);
     if (request.__isset.import_label) {
         _runtime_state->set_import_label(request.import_label);
@@ -133,10 +136,23 @@ Status PlanFragmentExecutor::prepare(const TExecPlanFragmentParams& request) {
 
     RETURN_IF_ERROR(_runtime_state->create_block_mgr());
 
-    // set up desc tbl
-    DescriptorTbl* desc_tbl = NULL;
+    // set up desc tbl, shared with other instances if llvm types are not
+    // generated into it
+    const DescriptorTbl* desc_tbl = NULL;
     DCHECK(request.__isset.desc_tbl);
-    RETURN_IF_ERROR(DescriptorTbl::create(obj_pool(), request.desc_tbl, &desc_tbl));
+    if (_exec_env->descriptor_tbl_cache() != nullptr && request.__isset.desc_tbl_hash
+            && !_runtime_state->codegen_enabled()) {
+        // held by the pool, like the descriptors created in it
+        std::shared_ptr<const DescriptorTbl>* shared_desc_tbl =
+            obj_pool()->add(new std::shared_ptr<const DescriptorTbl>());
+        RETURN_IF_ERROR(_exec_env->descriptor_tbl_cache()->get(
+                request.desc_tbl_hash, request.desc_tbl, shared_desc_tbl));
+        desc_tbl = shared_desc_tbl->get();
+    } else {
+        DescriptorTbl* created_desc_tbl = NULL;
+        RETURN_IF_ERROR(DescriptorTbl::create(obj_pool(), request.desc_tbl, &created_desc_tbl));
+        desc_tbl = created_desc_tbl;
+    }
     _runtime_state->set_desc_tbl(desc_tbl);
 
     // set up plan
@@ -165,17 +181,30 @@ Status PlanFragmentExecutor::prepare(const TExecPlanFragmentParams& request) {
 
  
     RETURN_IF_ERROR(_plan->prepare(_runtime_state.get()));
+
+    // the scan ranges are cut to the new versions if the results of the old
+    // ones are cached
+    const PerNodeScanRanges* per_node_scan_ranges = &params.per_node_scan_ranges;
+    PerNodeScanRanges incremental_scan_ranges;
+    if (_exec_env->fragment_result_cache() != nullptr && request.fragment.__isset.output_sink) {
+        _exec_env->fragment_result_cache()->lookup(request, &_result_cache_lookup);
+        if (_result_cache_lookup.is_incremental) {
+            get_incremental_scan_ranges(params.per_node_scan_ranges, &incremental_scan_ranges);
+            per_node_scan_ranges = &incremental_scan_ranges;
+        }
+    }
+
     // set scan ranges
     std::vector<ExecNode*> scan_nodes;
     std::vector<TScanRangeParams> no_scan_ranges;
     _plan->collect_scan_nodes(&scan_nodes);
     VLOG(1) << "scan_nodes.size()=" << scan_nodes.size();
-    VLOG(1) << "params.per_node_scan_ranges.size()=" << params.per_node_scan_ranges.size();
+    VLOG(1) << "params.per_node_scan_ranges.size()=" << per_node_scan_ranges->size();
 
     for (int i = 0; i < scan_nodes.size(); ++i) {
         ScanNode* scan_node = static_cast<ScanNode*>(scan_nodes[i]);
         const std::vector<TScanRangeParams>& scan_ranges =
-            find_with_default(params.per_node_scan_ranges, scan_node->id(), no_scan_ranges);
+            find_with_default(*per_node_scan_ranges, scan_node->id(), no_scan_ranges);
         scan_node->set_scan_ranges(scan_ranges);
         VLOG(1) << "scan_node_Id=" << scan_node->id() << " size=" << scan_ranges.size();
     }
@@ -244,6 +273,10 @@ void PlanFragmentExecutor::optimize_llvm_module() {
     Status status = _runtime_state->get_codegen(&codegen, /* initalize */ false);
     DCHECK(status.ok());
     DCHECK(codegen != NULL);
+    if (config::codegen_compile_threshold_rows > 0) {
+        codegen->finalize_module_after_rows(config::codegen_compile_threshold_rows);
+        return;
+    }
     status = codegen->finalize_module();
     if (!status.ok()) {
         std::stringstream ss;
@@ -253,6 +286,24 @@ void PlanFragmentExecutor::optimize_llvm_module() {
 }
 
 
+void PlanFragmentExecutor::get_incremental_scan_ranges(
+        const PerNodeScanRanges& per_node_scan_ranges, PerNodeScanRanges* incremental_scan_ranges) {
+    const std::map<int64_t, int64_t>& cached_versions = _result_cache_lookup.entry->versions;
+    for (auto& it : per_node_scan_ranges) {
+        std::vector<TScanRangeParams>& scan_ranges = (*incremental_scan_ranges)[it.first];
+        for (auto& range_params : it.second) {
+            const TPaloScanRange& range = range_params.scan_range.palo_scan_range;
+            int64_t cached_version = cached_versions.at(range.tablet_id);
+            if (cached_version == _result_cache_lookup.versions[range.tablet_id]) {
+                continue;
+            }
+            scan_ranges.push_back(range_params);
+            scan_ranges.back().scan_range.palo_scan_range.__set_start_version(
+                std::to_string(cached_version + 1));
+        }
+    }
+}
+
 void PlanFragmentExecutor::print_volume_ids(
     const PerNodeScanRanges& per_node_scan_ranges) {
     if (per_node_scan_ranges.empty()) {
@@ -292,7 +343,15 @@ Status PlanFragmentExecutor::open() {
 }
 
 Status PlanFragmentExecutor::open_internal() {
-    {
+    const FragmentResultCache::Lookup& lookup = _result_cache_lookup;
+    // all the results are cached, the plan is not opened
+    bool is_cached = lookup.entry != nullptr && !lookup.is_incremental;
+    if (!lookup.key.empty()) {
+        profile()->add_info_string("FragmentResultCache",
+            is_cached ? "hit" : (lookup.is_incremental ? "incremental" : "miss"));
+    }
+
+    if (!is_cached) {
         SCOPED_TIMER(profile()->total_time_counter());
         RETURN_IF_ERROR(_plan->open(_runtime_state.get()));
     }
@@ -302,11 +361,27 @@ Status PlanFragmentExecutor::open_internal() {
     }
     RETURN_IF_ERROR(_sink->open(runtime_state()));
 
+    if (lookup.entry != nullptr) {
+        // the batches go to the sink as they were made by the plan, those
+        // of new versions follow if it is incremental
+        SCOPED_TIMER(profile()->total_time_counter());
+        for (auto& pb_batch : lookup.entry->batches) {
+            RowBatch batch(row_desc(), *pb_batch, _runtime_state->instance_mem_tracker());
+            COUNTER_UPDATE(_rows_produced_counter, batch.num_rows());
+            RETURN_IF_ERROR(_sink->send(runtime_state(), &batch));
+        }
+    }
+
+    // the results to cache, dropped if they are too large
+    bool cache_results = !lookup.key.empty() && !is_cached;
+    FragmentResultCache::Batches results;
+    int64_t results_bytes = 0;
+
     // If there is a sink, do all the work of driving it here, so that
     // when this returns the query has actually finished
     RowBatch* batch = NULL;
 
-    while (true) {
+    while (!is_cached) {
         RETURN_IF_ERROR(get_next_internal(&batch));
 
         if (batch == NULL) {
@@ -328,9 +403,23 @@ Status PlanFragmentExecutor::open_internal() {
         if (_collect_query_statistics_with_every_batch) {
             collect_query_statistics();
         }
+        if (cache_results && results_bytes <= config::fragment_result_cache_max_entry_bytes) {
+            PRowBatch* pb_batch = new PRowBatch();
+            results.emplace_back(pb_batch);
+            batch->serialize(pb_batch);
+            results_bytes += pb_batch->ByteSize();
+            if (results_bytes > config::fragment_result_cache_max_entry_bytes) {
+                results.clear();
+            }
+        }
         RETURN_IF_ERROR(_sink->send(runtime_state(), batch));
     }
 
+    if (cache_results) {
+        // too large results remove the entry in insert()
+        _exec_env->fragment_result_cache()->insert(lookup, results, results_bytes);
+    }
+
     // Close the sink *before* stopping the report thread. Close may
     // need to add some important information to the last report that
     // gets sent. (e.g. table sinks record the files they have written
@@ -547,6 +636,11 @@ void PlanFragmentExecutor::close() {
     // Prepare may not have been called, which sets _runtime_state
     if (_runtime_state.get() != NULL) {
         
+        // the jitted functions are set into the exec nodes
+        if (_runtime_state->codegen_created()) {
+            _runtime_state->codegen()->wait_for_async_compile();
+        }
+
         // _runtime_state init failed
         if (_plan != nullptr) {
             _plan->close(_runtime_state.get());
@@ -18,12 +18,14 @@
 #ifndef DORIS_BE_RUNTIME_PLAN_FRAGMENT_EXECUTOR_H
 #define DORIS_BE_RUNTIME_PLAN_FRAGMENT_EXECUTOR_H
 
+#include <string>
 #include <vector>
 #include <boost/scoped_ptr.hpp>
 #include <boost/function.hpp>
 
 #include "common/status.h"
 #include "common/object_pool.h"
+#include "runtime/fragment_result_cache.h"
 #include "runtime/query_statistics.h"
 #include "runtime/runtime_state.h"
 
@@ -90,7 +92,9 @@ public:
     // If request.query_options.mem_limit > 0, it is used as an approximate limit on the
     // number of bytes this query can consume at runtime.
     // The query will be aborted (MEM_LIMIT_EXCEEDED) if it goes over that limit.
-    Status prepare(const TExecPlanFragmentParams& request);
+    // The spans of the fragment are children of 'trace_context'.
+    Status prepare(const TExecPlanFragmentParams& request,
+                   const TraceContext& trace_context = TraceContext());
 
     // Start execution. Call this prior to get_next().
     // If this fragment has a sink, open() will send all rows produced
@@ -211,6 +215,10 @@ private:
     std::shared_ptr<QueryStatistics> _query_statistics;
     bool _collect_query_statistics_with_every_batch;    
 
+    // the results of this instance in ExecEnv::fragment_result_cache(), its
+    // key is empty if they are not cached
+    FragmentResultCache::Lookup _result_cache_lookup;
+
     ObjectPool* obj_pool() {
         return _runtime_state->obj_pool();
     }
@@ -260,6 +268,11 @@ private:
     void print_volume_ids(const TPlanExecParams& params);
     void print_volume_ids(const PerNodeScanRanges& per_node_scan_ranges);
 
+    // Sets 'incremental_scan_ranges' to the ranges of tablets changed since
+    // the cached results, only of the versions after them.
+    void get_incremental_scan_ranges(const PerNodeScanRanges& per_node_scan_ranges,
+                                     PerNodeScanRanges* incremental_scan_ranges);
+
     const DescriptorTbl& desc_tbl() {
         return _runtime_state->desc_tbl();
     }
@@ -34,6 +34,7 @@ ResultSink::ResultSink(const RowDescriptor& row_desc, const std::vector<TExpr>&
                        const TResultSink& sink, int buffer_size)
     : _row_desc(row_desc),
       _t_output_expr(t_output_expr),
+      _format(sink.__isset.format ? sink.format : TResultSinkFormat::MYSQL_TEXT),
       _buf_size(buffer_size) {
 }
 
@@ -62,7 +63,8 @@ Status ResultSink::prepare(RuntimeState* state) {
     RETURN_IF_ERROR(state->exec_env()->result_mgr()->create_sender(
                         state->fragment_instance_id(), _buf_size, &_sender));
     // create writer
-    _writer.reset(new(std::nothrow) ResultWriter(_sender.get(), _output_expr_ctxs));
+    _writer.reset(new(std::nothrow) ResultWriter(_sender.get(), _output_expr_ctxs,
+                                                   _format));
     RETURN_IF_ERROR(_writer->init(state));
 
     return Status::OK;
@@ -69,6 +69,8 @@ private:
     const std::vector<TExpr>& _t_output_expr;
     std::vector<ExprContext*> _output_expr_ctxs;
 
+    TResultSinkFormat::type _format;
+
     boost::shared_ptr<BufferControlBlock> _sender;
     boost::shared_ptr<ResultWriter> _writer;
     RuntimeProfile* _profile; // Allocated from _pool
@@ -17,10 +17,14 @@
 
 #include "result_writer.h"
 
+#include <arrow/api.h>
+
 #include "exprs/expr.h"
+#include "runtime/arrow_row_batch.h"
 #include "runtime/primitive_type.h"
 #include "runtime/row_batch.h"
 #include "runtime/tuple_row.h"
+#include "runtime/datetime_value.h"
 #include "runtime/result_buffer_mgr.h"
 #include "runtime/buffer_control_block.h"
 #include "util/mysql_row_buffer.h"
@@ -30,11 +34,17 @@
 
 namespace doris {
 
+// returned by the push functions of push_column() if the value is NULL
+static const int PUSH_NULL = 1;
+
 ResultWriter::ResultWriter(
         BufferControlBlock* sinker,
-        const std::vector<ExprContext*>& output_expr_ctxs) : 
+        const std::vector<ExprContext*>& output_expr_ctxs,
+        TResultSinkFormat::type format) : 
             _sinker(sinker),
             _output_expr_ctxs(output_expr_ctxs),
+            _format(format),
+            _is_binary_row(format == TResultSinkFormat::MYSQL_BINARY),
             _row_buffer(NULL) {
 }
 
@@ -52,92 +62,125 @@ Status ResultWriter::init(RuntimeState* state) {
     if (NULL == _row_buffer) {
         return Status("no memory to alloc.");
     }
+    _row_buffer->set_binary_format(_is_binary_row);
+
+    if (_format == TResultSinkFormat::ARROW) {
+        RETURN_IF_ERROR(convert_to_arrow_schema(_output_expr_ctxs, &_arrow_schema));
+    }
 
     return Status::OK;
 }
 
-Status ResultWriter::add_one_row(TupleRow* row) {
-    _row_buffer->reset();
-    int num_columns = _output_expr_ctxs.size();
-    int buf_ret = 0;
-
-    for (int i = 0; 0 == buf_ret && i < num_columns; ++i) {
-        void* item = _output_expr_ctxs[i]->get_value(row);
-
-        if (NULL == item) {
+template <typename PushFunc>
+int ResultWriter::push_column(int column, RowBatch* batch, std::vector<std::string>* rows,
+                              PushFunc push) {
+    ExprContext* ctx = _output_expr_ctxs[column];
+    int num_rows = batch->num_rows();
+    for (int i = 0; i < num_rows; ++i) {
+        void* item = ctx->get_value(batch->get_row(i));
+        std::string& row = (*rows)[i];
+        _row_buffer->reset();
+        int buf_ret = (NULL == item) ? PUSH_NULL : push(item);
+
+        if (PUSH_NULL == buf_ret) {
+            if (_is_binary_row) {
+                MysqlRowBuffer::set_binary_null(column, &row);
+                continue;
+            }
             buf_ret = _row_buffer->push_null();
-            continue;
         }
+        if (0 != buf_ret) {
+            return buf_ret;
+        }
+        row.append(_row_buffer->buf(), _row_buffer->length());
+    }
+    return 0;
+}
 
-        switch (_output_expr_ctxs[i]->root()->type().type) {
-        case TYPE_BOOLEAN:
-        case TYPE_TINYINT:
-            buf_ret = _row_buffer->push_tinyint(*static_cast<int8_t*>(item));
-            break;
-
-        case TYPE_SMALLINT:
-            buf_ret = _row_buffer->push_smallint(*static_cast<int16_t*>(item));
-            break;
-
-        case TYPE_INT:
-            buf_ret = _row_buffer->push_int(*static_cast<int32_t*>(item));
-            break;
-
-        case TYPE_BIGINT:
-            buf_ret = _row_buffer->push_bigint(*static_cast<int64_t*>(item));
-            break;
+Status ResultWriter::add_one_column(int column, RowBatch* batch,
+                                    std::vector<std::string>* rows) {
+    MysqlRowBuffer* buffer = _row_buffer;
+    Expr* root = _output_expr_ctxs[column]->root();
+    int buf_ret = 0;
 
-        case TYPE_LARGEINT: {
+    switch (root->type().type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
+            return buffer->push_tinyint(*static_cast<int8_t*>(item));
+        });
+        break;
+
+    case TYPE_SMALLINT:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
+            return buffer->push_smallint(*static_cast<int16_t*>(item));
+        });
+        break;
+
+    case TYPE_INT:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
+            return buffer->push_int(*static_cast<int32_t*>(item));
+        });
+        break;
+
+    case TYPE_BIGINT:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
+            return buffer->push_bigint(*static_cast<int64_t*>(item));
+        });
+        break;
+
+    case TYPE_LARGEINT:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
             char buf[48];
             int len = 48;
             char* v = LargeIntValue::to_string(
                 reinterpret_cast<const PackedInt128*>(item)->value, buf, &len);
-            buf_ret = _row_buffer->push_string(v, len);
-            break;
-        }
-
-        case TYPE_FLOAT:
-            buf_ret = _row_buffer->push_float(*static_cast<float*>(item));
-            break;
-
-        case TYPE_DOUBLE:
-            buf_ret = _row_buffer->push_double(*static_cast<double*>(item));
-            break;
-
-        case TYPE_DATE:
-        case TYPE_DATETIME: {
-            char buf[64];
-            const DateTimeValue* time_val = (const DateTimeValue*)(item);
-            // TODO(zhaochun), this function has core risk
-            char* pos = time_val->to_string(buf);
-            buf_ret = _row_buffer->push_string(buf, pos - buf - 1);
-            break;
-        }
-
-        case TYPE_VARCHAR:
-        case TYPE_HLL:
-        case TYPE_CHAR: {
+            return buffer->push_string(v, len);
+        });
+        break;
+
+    case TYPE_FLOAT:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
+            return buffer->push_float(*static_cast<float*>(item));
+        });
+        break;
+
+    case TYPE_DOUBLE:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
+            return buffer->push_double(*static_cast<double*>(item));
+        });
+        break;
+
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
+            return buffer->push_datetime(*static_cast<const DateTimeValue*>(item));
+        });
+        break;
+
+    case TYPE_VARCHAR:
+    case TYPE_HLL:
+    case TYPE_CHAR:
+        buf_ret = push_column(column, batch, rows, [buffer](void* item) {
             const StringValue* string_val = (const StringValue*)(item);
 
             if (string_val->ptr == NULL) {
                 if (string_val->len == 0) {
                     // 0x01 is a magic num, not usefull actually, just for present ""
                     char* tmp_val = reinterpret_cast<char*>(0x01);
-                    buf_ret = _row_buffer->push_string(tmp_val, string_val->len);
-                } else {
-                    buf_ret = _row_buffer->push_null();
+                    return buffer->push_string(tmp_val, string_val->len);
                 }
-            } else {
-                buf_ret = _row_buffer->push_string(string_val->ptr, string_val->len);
+                return PUSH_NULL;
             }
+            return buffer->push_string(string_val->ptr, string_val->len);
+        });
+        break;
 
-            break;
-        }
-
-        case TYPE_DECIMAL: {
+    case TYPE_DECIMAL: {
+        int output_scale = root->output_scale();
+        buf_ret = push_column(column, batch, rows, [buffer, output_scale](void* item) {
             const DecimalValue* decimal_val = reinterpret_cast<const DecimalValue*>(item);
             std::string decimal_str;
-            int output_scale = _output_expr_ctxs[i]->root()->output_scale();
 
             if (output_scale > 0 && output_scale <= 30) {
                 decimal_str = decimal_val->to_string(output_scale);
@@ -145,14 +188,16 @@ Status ResultWriter::add_one_row(TupleRow* row) {
                 decimal_str = decimal_val->to_string();
             }
 
-            buf_ret = _row_buffer->push_string(decimal_str.c_str(), decimal_str.length());
-            break;
-        }
+            return buffer->push_string(decimal_str.c_str(), decimal_str.length());
+        });
+        break;
+    }
 
-        case TYPE_DECIMALV2: {
+    case TYPE_DECIMALV2: {
+        int output_scale = root->output_scale();
+        buf_ret = push_column(column, batch, rows, [buffer, output_scale](void* item) {
             DecimalV2Value decimal_val(reinterpret_cast<const PackedInt128*>(item)->value);
             std::string decimal_str;
-            int output_scale = _output_expr_ctxs[i]->root()->output_scale();
 
             if (output_scale > 0 && output_scale <= 30) {
                 decimal_str = decimal_val.to_string(output_scale);
@@ -160,16 +205,15 @@ Status ResultWriter::add_one_row(TupleRow* row) {
                 decimal_str = decimal_val.to_string();
             }
 
-            buf_ret = _row_buffer->push_string(decimal_str.c_str(), decimal_str.length());
-            break;
-        }
+            return buffer->push_string(decimal_str.c_str(), decimal_str.length());
+        });
+        break;
+    }
 
-        default:
-            LOG(WARNING) << "can't convert this type to mysql type. type = " <<
-                         _output_expr_ctxs[i]->root()->type();
-            buf_ret = -1;
-            break;
-        }
+    default:
+        LOG(WARNING) << "can't convert this type to mysql type. type = " << root->type();
+        buf_ret = -1;
+        break;
     }
 
     if (0 != buf_ret) {
@@ -179,6 +223,14 @@ Status ResultWriter::add_one_row(TupleRow* row) {
     return Status::OK;
 }
 
+Status ResultWriter::add_arrow_batch(RowBatch* batch, TFetchDataResult* result) {
+    std::shared_ptr<arrow::RecordBatch> record_batch;
+    RETURN_IF_ERROR(convert_to_arrow_batch(_output_expr_ctxs, batch, _arrow_schema,
+                                           arrow::default_memory_pool(), &record_batch));
+    result->result_batch.rows.resize(1);
+    return serialize_record_batch(*record_batch, &result->result_batch.rows[0]);
+}
+
 Status ResultWriter::append_row_batch(RowBatch* batch) {
     if (NULL == batch || 0 == batch->num_rows()) {
         return Status::OK;
@@ -188,17 +240,26 @@ Status ResultWriter::append_row_batch(RowBatch* batch) {
     // convert one batch
     TFetchDataResult* result = new(std::nothrow) TFetchDataResult();
     int num_rows = batch->num_rows();
-    result->result_batch.rows.resize(num_rows);
+    int num_columns = _output_expr_ctxs.size();
+    std::vector<std::string>& rows = result->result_batch.rows;
+
+    if (_format == TResultSinkFormat::ARROW) {
+        status = add_arrow_batch(batch, result);
+    } else {
+        rows.resize(num_rows);
+        if (_is_binary_row) {
+            for (int i = 0; i < num_rows; ++i) {
+                MysqlRowBuffer::init_binary_row(num_columns, &rows[i]);
+            }
+        }
 
-    for (int i = 0; status.ok() && i < num_rows; ++i) {
-        TupleRow* row = batch->get_row(i);
-        status = add_one_row(row);
+        for (int i = 0; i < num_columns; ++i) {
+            status = add_one_column(i, batch, &rows);
 
-        if (status.ok()) {
-            result->result_batch.rows[i].assign(_row_buffer->buf(), _row_buffer->length());
-        } else {
-            LOG(WARNING) << "convert row to mysql result failed.";
-            break;
+            if (!status.ok()) {
+                LOG(WARNING) << "convert row to mysql result failed.";
+                break;
+            }
         }
     }
 
@@ -18,9 +18,12 @@
 #ifndef DORIS_BE_RUNTIME_RESULT_WRITER_H
 #define  DORIS_BE_RUNTIME_RESULT_WRITER_H
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "common/status.h"
+#include "gen_cpp/DataSinks_types.h"
 
 namespace doris {
 
@@ -29,12 +32,22 @@ class RowBatch;
 class ExprContext;
 class MysqlRowBuffer;
 class BufferControlBlock;
+class TFetchDataResult;
 class RuntimeState;
 
+namespace arrow {
+class Schema;
+}
+
 //convert the row batch to mysql protol row
+// A batch is converted a column at a time: the expression of a column is
+// evaluated on all rows and the values are appended to the rows, so the
+// type of the column is looked at once per batch. In the ARROW format a
+// batch becomes one Arrow record batch instead of rows.
 class ResultWriter {
 public:
-    ResultWriter(BufferControlBlock* sinker, const std::vector<ExprContext*>& output_expr_ctxs);
+    ResultWriter(BufferControlBlock* sinker, const std::vector<ExprContext*>& output_expr_ctxs,
+                 TResultSinkFormat::type format = TResultSinkFormat::MYSQL_TEXT);
     ~ResultWriter();
 
     Status init(RuntimeState* state);
@@ -43,13 +56,26 @@ public:
     Status append_row_batch(RowBatch* batch);
 
 private:
-    // convert one tuple row
-    Status add_one_row(TupleRow* row);
+    // converts the batch to an Arrow IPC stream, the only row of 'result'
+    Status add_arrow_batch(RowBatch* batch, TFetchDataResult* result);
+
+    // appends the values of one column to 'rows'
+    Status add_one_column(int column, RowBatch* batch, std::vector<std::string>* rows);
+
+    // Appends the value of each row, written to _row_buffer by 'push(item)'
+    // which may return PUSH_NULL to append a NULL instead.
+    template <typename PushFunc>
+    int push_column(int column, RowBatch* batch, std::vector<std::string>* rows,
+                    PushFunc push);
 
     // The expressions that are run to create tuples to be written to hbase.
     BufferControlBlock* _sinker;
     const std::vector<ExprContext*>& _output_expr_ctxs;
+    TResultSinkFormat::type _format;
+    bool _is_binary_row;
     MysqlRowBuffer* _row_buffer;
+    // for the ARROW format
+    std::shared_ptr<arrow::Schema> _arrow_schema;
 };
 
 }
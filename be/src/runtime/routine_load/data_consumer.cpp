@@ -19,9 +19,11 @@
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "common/config.h"
 #include "common/status.h"
 #include "service/backend_options.h"
 #include "util/defer_op.h"
@@ -134,7 +136,7 @@ Status KafkaDataConsumer::assign_topic_partitions(
 }
 
 Status KafkaDataConsumer::group_consume(
-        BlockingQueue<RdKafka::Message*>* queue,
+        BlockingQueue<KafkaMessageBatch*>* queue,
         int64_t max_running_time_ms) {
     _last_visit_time = time(nullptr);
     int64_t left_time = max_running_time_ms;
@@ -143,38 +145,58 @@ Status KafkaDataConsumer::group_consume(
 
     int64_t received_rows = 0;
     int64_t put_rows = 0;
+    int64_t put_batches = 0;
     Status st = Status::OK;
     MonotonicStopWatch consumer_watch;
     MonotonicStopWatch watch;
     watch.start();
+    std::unique_ptr<KafkaMessageBatch> batch(new KafkaMessageBatch());
+    // returns false if queue is shutdown
+    auto put_batch = [&] () {
+        if (batch->msgs.empty()) {
+            return true;
+        }
+        size_t num_msgs = batch->msgs.size();
+        if (!queue->blocking_put(batch.get())) {
+            return false;
+        }
+        // release the ownership, msgs will be deleted after being processed
+        batch.release();
+        batch.reset(new KafkaMessageBatch());
+        put_rows += num_msgs;
+        ++put_batches;
+        return true;
+    };
     while (true) {
         {
             std::unique_lock<std::mutex> l(_lock);
             if (_cancelled) { break; }
         }
 
-        if (left_time <= 0) { break; }
+        if (left_time <= 0) {
+            put_batch();
+            break;
+        }
 
         bool done = false;
-        // consume 1 message at a time
+        // wait for the first msg of a batch, the following msgs are only
+        // taken if they are already fetched, so that a batch is not delayed
         consumer_watch.start();
-        std::unique_ptr<RdKafka::Message> msg(_k_consumer->consume(1000 /* timeout, ms */));
+        std::unique_ptr<RdKafka::Message> msg(_k_consumer->consume(
+                batch->msgs.empty() ? 1000 /* timeout, ms */ : 0));
         consumer_watch.stop();
-        switch (msg->err()) {
+        RdKafka::ErrorCode err = msg->err();
+        switch (err) {
             case RdKafka::ERR_NO_ERROR:
-                if (!queue->blocking_put(msg.get())) {
-                    // queue is shutdown
-                    done = true;
-                } else {
-                    ++put_rows;
-                    msg.release(); // release the ownership, msg will be deleted after being processed
-                }
+                batch->msgs.push_back(msg.release());
                 ++received_rows;
                 break;
             case RdKafka::ERR__TIMED_OUT:
                 // leave the status as OK, because this may happend
                 // if there is no data in kafka.
-                LOG(WARNING) << "kafka consume timeout: " << _id;
+                if (batch->msgs.empty()) {
+                    LOG(WARNING) << "kafka consume timeout: " << _id;
+                }
                 break;
             default:
                 LOG(WARNING) << "kafka consume failed: " << _id
@@ -184,6 +206,14 @@ Status KafkaDataConsumer::group_consume(
                 break;
         }
 
+        if (err == RdKafka::ERR__TIMED_OUT
+                || batch->msgs.size() >= static_cast<size_t>(config::kafka_consume_batch_size)) {
+            if (!put_batch()) {
+                // queue is shutdown
+                done = true;
+            }
+        }
+
         left_time = max_running_time_ms - watch.elapsed_time() / 1000 / 1000;
         if (done) { break; }
     }
@@ -194,7 +224,8 @@ Status KafkaDataConsumer::group_consume(
             << ", total cost(ms): " << watch.elapsed_time() / 1000 / 1000
             << ", consume cost(ms): " << consumer_watch.elapsed_time() / 1000 / 1000
             << ", received rows: " << received_rows
-            << ", put rows: " << put_rows;
+            << ", put rows: " << put_rows
+            << ", put batches: " << put_batches;
 
     return st;
 }
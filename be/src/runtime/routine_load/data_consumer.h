@@ -19,6 +19,7 @@
 
 #include <ctime>
 #include <mutex>
+#include <vector>
 
 #include "librdkafka/rdkafkacpp.h"
 
@@ -32,6 +33,18 @@ class KafkaConsumerPipe;
 class Status;
 class StreamLoadPipe;
 
+// messages passed from a kafka consumer to its group at a time,
+// they are deleted with the batch
+struct KafkaMessageBatch {
+    ~KafkaMessageBatch() {
+        for (auto msg : msgs) {
+            delete msg;
+        }
+    }
+
+    std::vector<RdKafka::Message*> msgs;
+};
+
 class DataConsumer {
 public:
     DataConsumer(StreamLoadContext* ctx):
@@ -138,8 +151,9 @@ public:
             const std::string& topic,
             StreamLoadContext* ctx);
 
-    // start the consumer and put msgs to queue
-    Status group_consume(BlockingQueue<RdKafka::Message*>* queue, int64_t max_running_time_ms);
+    // start the consumer and put msgs to queue, at most
+    // config::kafka_consume_batch_size msgs in a batch
+    Status group_consume(BlockingQueue<KafkaMessageBatch*>* queue, int64_t max_running_time_ms);
 
 private:
     std::string _brokers;
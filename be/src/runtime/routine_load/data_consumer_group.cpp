@@ -48,10 +48,9 @@ KafkaDataConsumerGroup::~KafkaDataConsumerGroup() {
     // clean the msgs left in queue
     _queue.shutdown();
     while(true) {
-        RdKafka::Message* msg;
-        if (_queue.blocking_get(&msg)) {
-            delete msg;
-            msg = nullptr;
+        KafkaMessageBatch* batch;
+        if (_queue.blocking_get(&batch)) {
+            delete batch;
         } else {
             break;
         }
@@ -105,6 +104,9 @@ Status KafkaDataConsumerGroup::start_all(StreamLoadContext* ctx) {
     watch.start();
     Status st;
     bool eos = false;
+    // msgs of the batch are appended one by one
+    std::unique_ptr<KafkaMessageBatch> batch;
+    size_t batch_pos = 0;
     while (true) {
         if (eos || left_time <= 0 || left_rows <= 0 || left_bytes <=0) {
             LOG(INFO) << "consumer group done: " << _grp_id
@@ -144,32 +146,39 @@ Status KafkaDataConsumerGroup::start_all(StreamLoadContext* ctx) {
             }
         }
 
-        RdKafka::Message* msg;
-        bool res = _queue.blocking_get(&msg);
-        if (res) {
-            VLOG(3) << "get kafka message"
-                << ", partition: " << msg->partition()
-                << ", offset: " << msg->offset()
-                << ", len: " << msg->len();
-
-            st = kafka_pipe->append_with_line_delimiter(
-                    static_cast<const char *>(msg->payload()),
-                    static_cast<size_t>(msg->len()));
-            if (st.ok()) {
-                left_rows--;
-                left_bytes -= msg->len();
-                cmt_offset[msg->partition()] = msg->offset();
-                VLOG(3) << "consume partition[" << msg->partition()
-                    << " - " << msg->offset() << "]";
-            } else {
-                // failed to append this msg, we must stop
-                LOG(WARNING) << "failed to append msg to pipe. grp: " << _grp_id;
+        if (batch == nullptr || batch_pos == batch->msgs.size()) {
+            batch.reset();
+            KafkaMessageBatch* next_batch;
+            if (!_queue.blocking_get(&next_batch)) {
+                // queue is empty and shutdown
                 eos = true;
+                continue;
             }
-            delete msg;
+            batch.reset(next_batch);
+            batch_pos = 0;
+        }
+
+        // limits are checked after every msg, the rest of the batch is
+        // dropped and consumed again by the next task
+        RdKafka::Message* msg = batch->msgs[batch_pos++];
+        VLOG(3) << "get kafka message"
+            << ", partition: " << msg->partition()
+            << ", offset: " << msg->offset()
+            << ", len: " << msg->len();
+
+        st = kafka_pipe->append_with_line_delimiter(
+                static_cast<const char *>(msg->payload()),
+                static_cast<size_t>(msg->len()));
+        if (st.ok()) {
+            left_rows--;
+            left_bytes -= msg->len();
+            cmt_offset[msg->partition()] = msg->offset();
+            VLOG(3) << "consume partition[" << msg->partition()
+                << " - " << msg->offset() << "]";
         } else {
-            // queue is empty and shutdown
-            eos = true;   
+            // failed to append this msg, we must stop
+            LOG(WARNING) << "failed to append msg to pipe. grp: " << _grp_id;
+            eos = true;
         }
 
         left_time = ctx->max_interval_s * 1000 - watch.elapsed_time() / 1000 / 1000;
@@ -180,7 +189,7 @@ Status KafkaDataConsumerGroup::start_all(StreamLoadContext* ctx) {
 
 void KafkaDataConsumerGroup::actual_consume(
         std::shared_ptr<DataConsumer> consumer,
-        BlockingQueue<RdKafka::Message*>* queue,
+        BlockingQueue<KafkaMessageBatch*>* queue,
         int64_t max_running_time_ms,
         ConsumeFinishCallback cb) {
     Status st = std::static_pointer_cast<KafkaDataConsumer>(consumer)->group_consume(queue, max_running_time_ms);
@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <algorithm>
+
+#include "common/config.h"
 #include "runtime/routine_load/data_consumer.h"
 #include "util/blocking_queue.hpp"
 #include "util/thread_pool.hpp"
@@ -30,8 +33,9 @@ class DataConsumerGroup {
 public:
     typedef std::function<void (const Status&)> ConsumeFinishCallback;
 
-    DataConsumerGroup():
-        _thread_pool(3, 10),
+    // every consumer runs in its own thread
+    DataConsumerGroup(size_t consumer_num):
+        _thread_pool(std::max<size_t>(consumer_num, 1), std::max<size_t>(consumer_num, 1)),
         _counter(0) {}
 
     virtual ~DataConsumerGroup() {
@@ -69,9 +73,9 @@ protected:
 // for kafka
 class KafkaDataConsumerGroup : public DataConsumerGroup {
 public:
-    KafkaDataConsumerGroup():
-        DataConsumerGroup(),
-        _queue(500) {}
+    KafkaDataConsumerGroup(size_t consumer_num):
+        DataConsumerGroup(consumer_num),
+        _queue(std::max(500 / std::max(config::kafka_consume_batch_size, 1), 1)) {}
 
     virtual ~KafkaDataConsumerGroup();
 
@@ -83,13 +87,14 @@ private:
     // start a single consumer
     void actual_consume(
             std::shared_ptr<DataConsumer> consumer,
-            BlockingQueue<RdKafka::Message*>* queue,
+            BlockingQueue<KafkaMessageBatch*>* queue,
             int64_t max_running_time_ms,
             ConsumeFinishCallback cb);
 
 private:
-    // blocking queue to receive msgs from all consumers
-    BlockingQueue<RdKafka::Message*> _queue; 
+    // blocking queue to receive msgs from all consumers, about as many
+    // msgs as before they were batched
+    BlockingQueue<KafkaMessageBatch*> _queue;
 };
 
 } // end namespace doris
@@ -17,8 +17,12 @@
 
 #include "runtime/row_batch.h"
 
+#include "service/brpc.h"
+
 #include <stdint.h>  // for intptr_t
+#include <lz4/lz4.h>
 #include <snappy/snappy.h>
+#include <zstd.h>
 
 #include "runtime/exec_env.h"
 #include "runtime/runtime_state.h"
@@ -71,7 +75,8 @@ RowBatch::RowBatch(const RowDescriptor& row_desc, int capacity, MemTracker* mem_
 // (change via python script that runs over Data_types.cc)
 RowBatch::RowBatch(const RowDescriptor& row_desc,
                    const PRowBatch& input_batch,
-                   MemTracker* tracker)
+                   MemTracker* tracker,
+                   const butil::IOBuf* attachment)
             : _mem_tracker(tracker),
             _has_in_flight_row(false),
             _num_rows(input_batch.num_rows()),
@@ -95,23 +100,54 @@ RowBatch::RowBatch(const RowDescriptor& row_desc,
         _tuple_ptrs = reinterpret_cast<Tuple**>(_tuple_data_pool->allocate(_tuple_ptrs_size));
     }
 
+    // the compressed data must be contiguous, an attachment received in
+    // several blocks is copied once
+    const char* input_data = input_batch.tuple_data().data();
+    size_t input_size = input_batch.tuple_data().size();
+    std::string contiguous_attachment;
+    if (input_batch.tuple_data_in_attachment()) {
+        DCHECK(attachment != nullptr);
+        input_size = attachment->size();
+        if (!input_batch.is_compressed()) {
+            input_data = nullptr;
+        } else if (attachment->backing_block_num() == 1) {
+            input_data = attachment->backing_block(0).data();
+        } else {
+            attachment->copy_to(&contiguous_attachment);
+            input_data = contiguous_attachment.data();
+        }
+    }
+
     uint8_t* tuple_data = nullptr;
-    if (input_batch.is_compressed()) {
+    if (input_batch.is_compressed() && input_batch.codec() == ROW_BATCH_LZ4) {
+        int64_t uncompressed_size = input_batch.uncompressed_size();
+        tuple_data = _tuple_data_pool->allocate(uncompressed_size);
+        int res = LZ4_decompress_safe(input_data, reinterpret_cast<char*>(tuple_data),
+                                      input_size, uncompressed_size);
+        DCHECK_EQ(res, uncompressed_size) << "LZ4_decompress_safe failed";
+    } else if (input_batch.is_compressed() && input_batch.codec() == ROW_BATCH_ZSTD) {
+        int64_t uncompressed_size = input_batch.uncompressed_size();
+        tuple_data = _tuple_data_pool->allocate(uncompressed_size);
+        size_t res = ZSTD_decompress(tuple_data, uncompressed_size, input_data, input_size);
+        DCHECK(!ZSTD_isError(res) && res == uncompressed_size) << "ZSTD_decompress failed";
+    } else if (input_batch.is_compressed()) {
         // Decompress tuple data into data pool
-        const char* compressed_data = input_batch.tuple_data().c_str();
-        size_t compressed_size = input_batch.tuple_data().size();
         size_t uncompressed_size = 0;
-        bool success = snappy::GetUncompressedLength(compressed_data, compressed_size,
+        bool success = snappy::GetUncompressedLength(input_data, input_size,
                        &uncompressed_size);
         DCHECK(success) << "snappy::GetUncompressedLength failed";
         tuple_data = reinterpret_cast<uint8_t*>(_tuple_data_pool->allocate(uncompressed_size));
         success = snappy::RawUncompress(
-                compressed_data, compressed_size, reinterpret_cast<char*>(tuple_data));
+                input_data, input_size, reinterpret_cast<char*>(tuple_data));
         DCHECK(success) << "snappy::RawUncompress failed";
+    } else if (input_data == nullptr) {
+        // copied from the blocks of the attachment directly into data pool
+        tuple_data = _tuple_data_pool->allocate(input_size);
+        attachment->copy_to(tuple_data, input_size);
     } else {
         // Tuple data uncompressed, copy directly into data pool
-        tuple_data = _tuple_data_pool->allocate(input_batch.tuple_data().size());
-        memcpy(tuple_data, input_batch.tuple_data().c_str(), input_batch.tuple_data().size());
+        tuple_data = _tuple_data_pool->allocate(input_size);
+        memcpy(tuple_data, input_data, input_size);
     }
 
     // convert input_batch.tuple_offsets into pointers
@@ -353,6 +389,10 @@ int RowBatch::serialize(TRowBatch* output_batch) {
 }
 
 int RowBatch::serialize(PRowBatch* output_batch) {
+    return serialize(output_batch, config::compress_rowbatches, ROW_BATCH_SNAPPY);
+}
+
+int RowBatch::serialize(PRowBatch* output_batch, bool compress, PRowBatchCodec codec) {
     // num_rows
     output_batch->set_num_rows(_num_rows);
     // row_tuples
@@ -362,6 +402,8 @@ int RowBatch::serialize(PRowBatch* output_batch) {
     output_batch->mutable_tuple_offsets()->Reserve(_num_rows * _num_tuples_per_row);
     // is_compressed
     output_batch->set_is_compressed(false);
+    output_batch->clear_codec();
+    output_batch->clear_uncompressed_size();
     // tuple data
     int size = total_byte_size();
     auto mutable_tuple_data = output_batch->mutable_tuple_data();
@@ -390,24 +432,51 @@ int RowBatch::serialize(PRowBatch* output_batch) {
 
     DCHECK_EQ(offset, size);
 
-    if (config::compress_rowbatches && size > 0) {
+    if (compress && size > 0) {
         // Try compressing tuple_data to _compression_scratch, swap if compressed data is
         // smaller
-        int max_compressed_size = snappy::MaxCompressedLength(size);
+        size_t max_compressed_size = 0;
+        if (codec == ROW_BATCH_LZ4) {
+            max_compressed_size = LZ4_compressBound(size);
+        } else if (codec == ROW_BATCH_ZSTD) {
+            max_compressed_size = ZSTD_compressBound(size);
+        } else {
+            max_compressed_size = snappy::MaxCompressedLength(size);
+        }
 
         if (_compression_scratch.size() < max_compressed_size) {
             _compression_scratch.resize(max_compressed_size);
         }
 
-        size_t compressed_size = 0;
+        // failures leave compressed_size at size, so tuple_data is sent uncompressed
+        size_t compressed_size = size;
         char* compressed_output = const_cast<char*>(_compression_scratch.c_str());
-        snappy::RawCompress(mutable_tuple_data->data(), size,
-                            compressed_output, &compressed_size);
+        if (codec == ROW_BATCH_LZ4) {
+            int res = LZ4_compress_default(mutable_tuple_data->data(), compressed_output,
+                                           size, max_compressed_size);
+            if (res > 0) {
+                compressed_size = res;
+            }
+        } else if (codec == ROW_BATCH_ZSTD) {
+            size_t res = ZSTD_compress(compressed_output, max_compressed_size,
+                                       mutable_tuple_data->data(), size,
+                                       config::exchange_zstd_level);
+            if (!ZSTD_isError(res)) {
+                compressed_size = res;
+            }
+        } else {
+            snappy::RawCompress(mutable_tuple_data->data(), size,
+                                compressed_output, &compressed_size);
+        }
 
         if (LIKELY(compressed_size < size)) {
             _compression_scratch.resize(compressed_size);
             mutable_tuple_data->swap(_compression_scratch);
             output_batch->set_is_compressed(true);
+            if (codec != ROW_BATCH_SNAPPY) {
+                output_batch->set_codec(codec);
+                output_batch->set_uncompressed_size(size);
+            }
         }
 
         VLOG_ROW << "uncompressed size: " << size << ", compressed size: " << compressed_size;
@@ -545,13 +614,30 @@ int RowBatch::get_batch_size(const TRowBatch& batch) {
     return result;
 }
 
-int RowBatch::get_batch_size(const PRowBatch& batch) {
+int RowBatch::get_batch_size(const PRowBatch& batch, const butil::IOBuf* attachment) {
     int result = batch.tuple_data().size();
+    if (batch.tuple_data_in_attachment() && attachment != nullptr) {
+        result += attachment->size();
+    }
     result += batch.row_tuples().size() * sizeof(int32_t);
     result += batch.tuple_offsets().size() * sizeof(int32_t);
     return result;
 }
 
+void RowBatch::deep_copy_to(RowBatch* dst) {
+    DCHECK_EQ(dst->_num_tuples_per_row, _num_tuples_per_row);
+    DCHECK_EQ(dst->_num_rows, 0);
+    DCHECK_GE(dst->_capacity, _num_rows);
+    dst->add_rows(_num_rows);
+    for (int i = 0; i < _num_rows; ++i) {
+        TupleRow* src_row = get_row(i);
+        TupleRow* dst_row = dst->get_row(i);
+        src_row->deep_copy(dst_row, _row_desc.tuple_descriptors(),
+                           dst->_tuple_data_pool.get(), false);
+    }
+    dst->commit_rows(_num_rows);
+}
+
 void RowBatch::acquire_state(RowBatch* src) {
     // DCHECK(_row_desc.equals(src->_row_desc));
     DCHECK_EQ(_num_tuples_per_row, src->_num_tuples_per_row);
@@ -24,6 +24,7 @@
 
 #include "common/logging.h"
 #include "codegen/doris_ir.h"
+#include "gen_cpp/data.pb.h"
 #include "runtime/buffered_block_mgr2.h" // for BufferedBlockMgr2::Block
 // #include "runtime/buffered_tuple_stream2.inline.h"
 #include "runtime/bufferpool/buffer_pool.h"
@@ -32,6 +33,10 @@
 #include "runtime/mem_pool.h"
 #include "runtime/row_batch_interface.hpp"
 
+namespace butil {
+class IOBuf;
+}
+
 namespace doris {
 
 class BufferedTupleStream2;
@@ -39,7 +44,6 @@ class TRowBatch;
 class Tuple;
 class TupleRow;
 class TupleDescriptor;
-class PRowBatch;
 
 // A RowBatch encapsulates a batch of rows, each composed of a number of tuples.
 // The maximum number of rows is fixed at the time of construction, and the caller
@@ -92,7 +96,10 @@ public:
     // (so that we don't need to make yet another copy)
     RowBatch(const RowDescriptor& row_desc, const TRowBatch& input_batch, MemTracker* tracker);
 
-    RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch, MemTracker* tracker);
+    // 'attachment' holds the tuple data if input_batch.tuple_data_in_attachment(),
+    // it is copied into the mempool or decompressed from directly.
+    RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch, MemTracker* tracker,
+             const butil::IOBuf* attachment = nullptr);
 
     // Releases all resources accumulated at this row batch.  This includes
     //  - tuple_ptrs
@@ -369,10 +376,14 @@ public:
     // if tuple_data is actually uncompressed).
     int serialize(TRowBatch* output_batch);
     int serialize(PRowBatch* output_batch);
+    // Same as above, but tuple_data is compressed by 'codec' if 'compress' is true
+    // instead of as compress_rowbatches says.
+    int serialize(PRowBatch* output_batch, bool compress, PRowBatchCodec codec);
 
     // Utility function: returns total size of batch.
     static int get_batch_size(const TRowBatch& batch);
-    static int get_batch_size(const PRowBatch& batch);
+    static int get_batch_size(const PRowBatch& batch,
+                              const butil::IOBuf* attachment = nullptr);
 
     int num_rows() const {
         return _num_rows;
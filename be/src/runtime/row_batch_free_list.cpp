@@ -0,0 +1,67 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/row_batch_free_list.h"
+
+#include <mutex>
+
+#include "runtime/row_batch.h"
+
+namespace doris {
+
+RowBatchFreeList::RowBatchFreeList(const RowDescriptor& row_desc, int capacity,
+                                   MemTracker* mem_tracker, int max_batches)
+        : _row_desc(row_desc),
+        _capacity(capacity),
+        _mem_tracker(mem_tracker),
+        _max_batches(max_batches) {
+}
+
+RowBatchFreeList::~RowBatchFreeList() {
+    for (auto batch : _batches) {
+        delete batch;
+    }
+}
+
+RowBatch* RowBatchFreeList::get() {
+    {
+        std::lock_guard<SpinLock> l(_lock);
+        if (!_batches.empty()) {
+            RowBatch* batch = _batches.back();
+            _batches.pop_back();
+            return batch;
+        }
+    }
+    return new RowBatch(_row_desc, _capacity, _mem_tracker);
+}
+
+void RowBatchFreeList::put(RowBatch* batch) {
+    // resources of the batch are freed before it is kept
+    batch->reset();
+    DCHECK_EQ(batch->capacity(), _capacity);
+    {
+        std::lock_guard<SpinLock> l(_lock);
+        if (_batches.size() < _max_batches) {
+            _batches.push_back(batch);
+            return;
+        }
+    }
+    delete batch;
+}
+
+}
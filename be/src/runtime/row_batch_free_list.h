@@ -0,0 +1,64 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_RUNTIME_ROW_BATCH_FREE_LIST_H
+#define DORIS_BE_RUNTIME_ROW_BATCH_FREE_LIST_H
+
+#include <vector>
+
+#include "util/spinlock.h"
+
+namespace doris {
+
+class MemTracker;
+class RowBatch;
+class RowDescriptor;
+
+// Keeps the row batches an operator is done with, so that they are filled
+// again instead of being deleted and constructed for every batch. All
+// batches have the row descriptor, capacity and mem tracker of the list.
+//
+// This class is thread-safe.
+class RowBatchFreeList {
+public:
+    // At most 'max_batches' are kept, the others are deleted.
+    RowBatchFreeList(const RowDescriptor& row_desc, int capacity, MemTracker* mem_tracker,
+                     int max_batches);
+
+    // Deletes the kept batches, before the mem tracker is closed.
+    ~RowBatchFreeList();
+
+    // Returns an empty batch owned by the caller, a new one if none is kept.
+    RowBatch* get();
+
+    // Takes back a batch returned by get(), which is reset.
+    void put(RowBatch* batch);
+
+private:
+    const RowDescriptor& _row_desc;
+    int _capacity;
+    MemTracker* _mem_tracker;
+    int _max_batches;
+
+    SpinLock _lock;
+    std::vector<RowBatch*> _batches;
+};
+
+}
+
+#endif
@@ -0,0 +1,197 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/runtime_filter.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "olap/bloom_filter.hpp"
+#include "runtime/raw_value.h"
+
+namespace doris {
+
+// the storage layer keeps values of these types in the same layout as the
+// tuples do, so both hash the same bytes
+static bool supports_bloom_filter(PrimitiveType type) {
+    switch (type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_VARCHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+RuntimeFilter::RuntimeFilter(PrimitiveType type) :
+        _type(type),
+        _type_desc(type),
+        _min(nullptr),
+        _max(nullptr) {
+}
+
+RuntimeFilter::~RuntimeFilter() {
+}
+
+bool RuntimeFilter::is_supported(PrimitiveType type) {
+    switch (type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_DECIMAL:
+    case TYPE_VARCHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+Status RuntimeFilter::init(int64_t expected_entries) {
+    if (!supports_bloom_filter(_type)
+            || expected_entries > config::runtime_filter_max_bloom_filter_entries) {
+        return Status::OK;
+    }
+    _bloom_filter.reset(new BloomFilter());
+    if (!_bloom_filter->init(std::max<int64_t>(expected_entries, 1),
+                             config::runtime_filter_bloom_filter_fpp,
+                             config::bloom_filter_blocked_layout)) {
+        _bloom_filter.reset();
+        return Status("fail to init bloom filter of runtime filter");
+    }
+    return Status::OK;
+}
+
+void RuntimeFilter::insert(const void* value) {
+    if (value == nullptr) {
+        return;
+    }
+    if (_bloom_filter != nullptr) {
+        if (_type == TYPE_VARCHAR) {
+            const StringValue* str = reinterpret_cast<const StringValue*>(value);
+            // a null pointer is hashed as null, empty strings may have one
+            _bloom_filter->add_bytes(str->len == 0 ? "" : str->ptr, str->len);
+        } else {
+            _bloom_filter->add_bytes(reinterpret_cast<const char*>(value), get_slot_size(_type));
+        }
+    }
+    if (_min == nullptr || RawValue::compare(value, _min, _type_desc) < 0) {
+        _set_value(_value_bytes(value), &_min_buf, &_min_str, &_min);
+    }
+    if (_max == nullptr || RawValue::compare(value, _max, _type_desc) > 0) {
+        _set_value(_value_bytes(value), &_max_buf, &_max_str, &_max);
+    }
+}
+
+void RuntimeFilter::merge(const RuntimeFilter& other) {
+    DCHECK_EQ(_type, other._type);
+    if (_bloom_filter != nullptr) {
+        if (other._bloom_filter == nullptr || !_bloom_filter->merge(*other._bloom_filter)) {
+            _bloom_filter.reset();
+        }
+    }
+    if (other.is_empty()) {
+        return;
+    }
+    if (is_empty() || RawValue::compare(other._min, _min, _type_desc) < 0) {
+        _set_value(other._value_bytes(other._min), &_min_buf, &_min_str, &_min);
+    }
+    if (RawValue::compare(other._max, _max, _type_desc) > 0) {
+        _set_value(other._value_bytes(other._max), &_max_buf, &_max_str, &_max);
+    }
+}
+
+void RuntimeFilter::to_protobuf(PRuntimeFilter* pfilter) const {
+    pfilter->set_type(_type);
+    if (_min != nullptr) {
+        pfilter->set_min_value(_value_bytes(_min));
+        pfilter->set_max_value(_value_bytes(_max));
+    }
+    if (_bloom_filter != nullptr) {
+        pfilter->set_bloom_filter(reinterpret_cast<const char*>(_bloom_filter->bit_set_data()),
+                                  _bloom_filter->bit_set_data_len() * sizeof(uint64_t));
+        pfilter->set_bloom_filter_hash_num(_bloom_filter->hash_function_num());
+    }
+}
+
+Status RuntimeFilter::from_protobuf(const PRuntimeFilter& pfilter) {
+    if (pfilter.type() != _type) {
+        return Status("type of runtime filter mismatch");
+    }
+    if (pfilter.has_min_value() != pfilter.has_max_value()) {
+        return Status("invalid min max values of runtime filter");
+    }
+    if (pfilter.has_min_value()) {
+        size_t size = get_slot_size(_type);
+        if (_type != TYPE_VARCHAR
+                && (pfilter.min_value().size() != size || pfilter.max_value().size() != size)) {
+            return Status("invalid min max values of runtime filter");
+        }
+        _set_value(pfilter.min_value(), &_min_buf, &_min_str, &_min);
+        _set_value(pfilter.max_value(), &_max_buf, &_max_str, &_max);
+    }
+    if (pfilter.has_bloom_filter()) {
+        const std::string& data = pfilter.bloom_filter();
+        if (data.empty() || data.size() % sizeof(uint64_t) != 0
+                || pfilter.bloom_filter_hash_num() < 0) {
+            return Status("invalid bloom filter of runtime filter");
+        }
+        uint32_t len = data.size() / sizeof(uint64_t);
+        // owned by the bit set of the bloom filter
+        uint64_t* words = new uint64_t[len];
+        memcpy(words, data.data(), data.size());
+        _bloom_filter.reset(new BloomFilter());
+        if (!_bloom_filter->init(words, len, pfilter.bloom_filter_hash_num())) {
+            _bloom_filter.reset();
+            return Status("invalid bloom filter of runtime filter");
+        }
+    }
+    return Status::OK;
+}
+
+std::string RuntimeFilter::_value_bytes(const void* value) const {
+    if (_type == TYPE_VARCHAR) {
+        const StringValue* str = reinterpret_cast<const StringValue*>(value);
+        return std::string(str->ptr, str->len);
+    }
+    return std::string(reinterpret_cast<const char*>(value), get_slot_size(_type));
+}
+
+void RuntimeFilter::_set_value(const std::string& data, std::string* buf, StringValue* str,
+                               const void** value) {
+    *buf = data;
+    if (_type == TYPE_VARCHAR) {
+        str->ptr = const_cast<char*>(buf->data());
+        str->len = buf->size();
+        *value = str;
+    } else {
+        *value = buf->data();
+    }
+}
+
+}
@@ -0,0 +1,98 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_RUNTIME_FILTER_H
+#define DORIS_BE_RUNTIME_RUNTIME_FILTER_H
+
+#include <memory>
+#include <string>
+
+#include "common/status.h"
+#include "runtime/primitive_type.h"
+#include "runtime/string_value.h"
+#include "runtime/types.h"
+
+namespace doris {
+
+class BloomFilter;
+class PRuntimeFilter;
+
+// Values of the build side of a hash join, which are used to filter the rows
+// of the probe side before they are read: the min and max values of all types
+// and a bloom filter for integers and strings. The bloom filter hashes values
+// in the same layout the storage layer keeps them in, so it can be tested by
+// the column predicates of scans.
+class RuntimeFilter {
+public:
+    RuntimeFilter(PrimitiveType type);
+    ~RuntimeFilter();
+
+    // false if no filter can be built for values of 'type'
+    static bool is_supported(PrimitiveType type);
+
+    // Builds a bloom filter for 'expected_entries' values if the type supports
+    // it and there are not more than config::runtime_filter_max_bloom_filter_entries.
+    Status init(int64_t expected_entries);
+
+    // 'value' is nullptr for null, which is not added as no row matches it.
+    // It is copied if it becomes the min or max value, so it may be the
+    // result buffer of an expr.
+    void insert(const void* value);
+
+    // adds the values of 'other', which is built from another part of the
+    // build side, the bloom filter is dropped unless both are of the same size
+    void merge(const RuntimeFilter& other);
+
+    void to_protobuf(PRuntimeFilter* pfilter) const;
+    Status from_protobuf(const PRuntimeFilter& pfilter);
+
+    PrimitiveType type() const { return _type; }
+
+    // true if no value is inserted, then no probe row matches
+    bool is_empty() const { return _min == nullptr; }
+
+    // in the layout of type(), valid if not is_empty()
+    const void* min_value() const { return _min; }
+    const void* max_value() const { return _max; }
+
+    // nullptr if there is no bloom filter
+    std::shared_ptr<const BloomFilter> bloom_filter() const { return _bloom_filter; }
+
+private:
+    // bytes of 'value' as they are sent, strings without StringValue header
+    std::string _value_bytes(const void* value) const;
+
+    // makes 'value' point to a copy of 'data' kept in 'buf'
+    void _set_value(const std::string& data, std::string* buf, StringValue* str,
+                    const void** value);
+
+    PrimitiveType _type;
+    TypeDescriptor _type_desc;
+    std::shared_ptr<BloomFilter> _bloom_filter;
+
+    const void* _min;
+    const void* _max;
+    // point into the buffers below
+    std::string _min_buf;
+    std::string _max_buf;
+    StringValue _min_str;
+    StringValue _max_str;
+};
+
+}
+
+#endif // DORIS_BE_RUNTIME_RUNTIME_FILTER_H
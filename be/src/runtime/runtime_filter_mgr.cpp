@@ -0,0 +1,91 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/runtime_filter_mgr.h"
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "util/time.h"
+
+namespace doris {
+
+RuntimeFilterMgr::RuntimeFilterMgr() : _last_expire_time_ms(MonotonicMillis()) {
+}
+
+RuntimeFilterMgr::~RuntimeFilterMgr() {
+}
+
+void RuntimeFilterMgr::publish(const TUniqueId& finst_id, int filter_id,
+                               std::unique_ptr<RuntimeFilter> filter) {
+    int64_t now_ms = MonotonicMillis();
+    std::lock_guard<std::mutex> l(_lock);
+    FilterEntry& entry = _filters[FilterKey(finst_id, filter_id)];
+    if (entry.filter == nullptr) {
+        entry.filter.reset(filter.release());
+    } else if (entry.filter->type() == filter->type()) {
+        entry.filter->merge(*filter);
+    } else {
+        LOG(WARNING) << "type of runtime filter mismatch, fragment_instance_id="
+            << print_id(finst_id) << ", filter_id=" << filter_id;
+        return;
+    }
+    entry.num_parts++;
+    entry.publish_time_ms = now_ms;
+    _publish_cv.notify_all();
+
+    _remove_expired(now_ms);
+}
+
+std::shared_ptr<RuntimeFilter> RuntimeFilterMgr::take(
+        const TUniqueId& finst_id, int filter_id, int num_sources, int64_t deadline_ms) {
+    FilterKey key(finst_id, filter_id);
+    std::unique_lock<std::mutex> l(_lock);
+    while (true) {
+        auto it = _filters.find(key);
+        if (it != _filters.end() && it->second.num_parts >= num_sources) {
+            std::shared_ptr<RuntimeFilter> filter = it->second.filter;
+            _filters.erase(it);
+            return filter;
+        }
+        int64_t wait_ms = deadline_ms - MonotonicMillis();
+        if (wait_ms <= 0) {
+            // the parts coming later are dropped when they expire
+            if (it != _filters.end()) {
+                _filters.erase(it);
+            }
+            return nullptr;
+        }
+        _publish_cv.wait_for(l, std::chrono::milliseconds(wait_ms));
+    }
+}
+
+void RuntimeFilterMgr::_remove_expired(int64_t now_ms) {
+    int64_t expire_ms = config::runtime_filter_expire_time_s * 1000L;
+    if (now_ms - _last_expire_time_ms < expire_ms) {
+        return;
+    }
+    _last_expire_time_ms = now_ms;
+    for (auto it = _filters.begin(); it != _filters.end();) {
+        if (now_ms - it->second.publish_time_ms >= expire_ms) {
+            it = _filters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}
@@ -0,0 +1,73 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_RUNTIME_FILTER_MGR_H
+#define DORIS_BE_RUNTIME_RUNTIME_FILTER_MGR_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include <boost/unordered_map.hpp>
+
+#include "gen_cpp/Types_types.h"
+#include "runtime/runtime_filter.h"
+#include "util/uid_util.h"
+
+namespace doris {
+
+// Keeps the runtime filters published to the scans of the fragment instances
+// of this backend until they are taken. The filter of a partitioned join is
+// published in parts by all join instances, parts are merged as they come.
+class RuntimeFilterMgr {
+public:
+    RuntimeFilterMgr();
+    ~RuntimeFilterMgr();
+
+    // adds a part of filter 'filter_id' of fragment instance 'finst_id'
+    void publish(const TUniqueId& finst_id, int filter_id,
+                 std::unique_ptr<RuntimeFilter> filter);
+
+    // Waits until 'num_sources' parts of the filter are published, or until
+    // 'deadline_ms' of MonotonicMillis(). The filter is removed from this
+    // manager, nullptr is returned if it is not complete in time.
+    std::shared_ptr<RuntimeFilter> take(const TUniqueId& finst_id, int filter_id,
+                                        int num_sources, int64_t deadline_ms);
+
+private:
+    typedef std::pair<TUniqueId, int> FilterKey;
+
+    struct FilterEntry {
+        std::shared_ptr<RuntimeFilter> filter;
+        int num_parts = 0;
+        int64_t publish_time_ms = 0;
+    };
+
+    // drops the filters of fragments which never take them, e.g. which are
+    // cancelled, or which are published after the scan stops waiting
+    void _remove_expired(int64_t now_ms);
+
+    std::mutex _lock;
+    std::condition_variable _publish_cv;
+    boost::unordered_map<FilterKey, FilterEntry> _filters;
+    int64_t _last_expire_time_ms;
+};
+
+}
+
+#endif // DORIS_BE_RUNTIME_RUNTIME_FILTER_MGR_H
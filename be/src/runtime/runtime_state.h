@@ -35,6 +35,7 @@
 #include "util/logging.h"
 #include "runtime/mem_pool.h"
 #include "runtime/thread_resource_mgr.h"
+#include "runtime/tracer.h"
 #include "gen_cpp/Types_types.h"  // for TUniqueId
 #include "gen_cpp/PaloInternalService_types.h"  // for TQueryOptions
 #include "util/runtime_profile.h"
@@ -115,7 +116,7 @@ public:
     const DescriptorTbl& desc_tbl() const {
         return *_desc_tbl;
     }
-    void set_desc_tbl(DescriptorTbl* desc_tbl) {
+    void set_desc_tbl(const DescriptorTbl* desc_tbl) {
         _desc_tbl = desc_tbl;
     }
     int batch_size() const {
@@ -151,6 +152,14 @@ public:
     const TUniqueId& fragment_instance_id() const {
         return _fragment_instance_id;
     }
+    // The parent of the spans of this fragment instance, not sampled if the query
+    // is not traced.
+    const TraceContext& trace_context() const {
+        return _trace_context;
+    }
+    void set_trace_context(const TraceContext& trace_context) {
+        _trace_context = trace_context;
+    }
     ExecEnv* exec_env() {
         return _exec_env;
     }
@@ -510,7 +519,7 @@ private:
 
     static const int DEFAULT_BATCH_SIZE = 2048;
 
-    DescriptorTbl* _desc_tbl;
+    const DescriptorTbl* _desc_tbl;
     std::shared_ptr<ObjectPool> _obj_pool;
 
     // Protects _data_stream_recvrs_pool
@@ -540,6 +549,7 @@ private:
 
     TUniqueId _query_id;
     TUniqueId _fragment_instance_id;
+    TraceContext _trace_context;
     TQueryOptions _query_options;
     ExecEnv* _exec_env;
     boost::scoped_ptr<LlvmCodeGen> _codegen;
@@ -615,6 +625,9 @@ private:
     std::string _error_log_file_path;
     std::ofstream* _error_log_file; // error file path, absolute path
     std::unique_ptr<LoadErrorHub> _error_hub;
+    // Lock protecting _error_log_file and _error_hub, scanners of a load may
+    // append errors from several threads
+    boost::mutex _error_log_file_lock;
     std::vector<TTabletCommitInfo> _tablet_commit_infos;
 
     //TODO chenhao , remove this to QueryState 
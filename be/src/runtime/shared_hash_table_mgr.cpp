@@ -0,0 +1,129 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/shared_hash_table_mgr.h"
+
+#include "common/logging.h"
+#include "exec/join_hash_table.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/runtime_state.h"
+
+namespace doris {
+
+SharedJoinBuild::SharedJoinBuild(const std::vector<ExprContext*>& build_expr_ctxs,
+                                 int num_build_tuples, uint32_t seed, MemTracker* parent,
+                                 bool keys_only) :
+        _state(ADDING_ROWS),
+        _next_partition(0),
+        _num_built_partitions(0),
+        _mem_tracker(new MemTracker(-1, "SharedJoinBuild", parent)),
+        _build_pool(new MemPool(_mem_tracker.get())),
+        _table(new JoinHashTable(build_expr_ctxs, num_build_tuples, seed, _mem_tracker.get(),
+                                 keys_only)) {
+}
+
+SharedJoinBuild::~SharedJoinBuild() {
+    _table->close();
+    _build_pool->free_all();
+}
+
+Status SharedJoinBuild::build(const Status& status) {
+    std::unique_lock<std::mutex> l(_lock);
+    if (_state != ADDING_ROWS) {
+        // already failed when the builder was closed
+        return _status;
+    }
+    if (!status.ok()) {
+        _status = status;
+        _state = DONE;
+        _cv.notify_all();
+        return _status;
+    }
+    _table->prepare_build();
+    _state = BUILDING;
+    _cv.notify_all();
+    _build_partitions(&l);
+    // the partitions taken by the other instances
+    while (_state != DONE) {
+        _cv.wait(l);
+    }
+    return _status;
+}
+
+Status SharedJoinBuild::wait(RuntimeState* state) {
+    std::unique_lock<std::mutex> l(_lock);
+    while (true) {
+        if (_state == BUILDING) {
+            _build_partitions(&l);
+        }
+        if (_state == DONE) {
+            return _status;
+        }
+        if (state->is_cancelled()) {
+            return Status::CANCELLED;
+        }
+        _cv.wait_for(l, std::chrono::milliseconds(100));
+    }
+}
+
+void SharedJoinBuild::_build_partitions(std::unique_lock<std::mutex>* l) {
+    while (_state == BUILDING && _next_partition < JoinHashTable::NUM_PARTITIONS) {
+        int partition = _next_partition++;
+        l->unlock();
+        _table->build_partition(partition);
+        l->lock();
+        if (++_num_built_partitions == JoinHashTable::NUM_PARTITIONS) {
+            _table->finish_build();
+            _state = DONE;
+            _cv.notify_all();
+        }
+    }
+}
+
+SharedHashTableMgr::SharedHashTableMgr() {
+}
+
+SharedHashTableMgr::~SharedHashTableMgr() {
+}
+
+std::shared_ptr<SharedJoinBuild> SharedHashTableMgr::get_or_create(
+        const TUniqueId& query_id, int node_id,
+        const std::vector<ExprContext*>& build_expr_ctxs, int num_build_tuples,
+        uint32_t seed, MemTracker* parent, bool keys_only, bool* is_builder) {
+    std::lock_guard<std::mutex> l(_lock);
+    // the builds of finished queries
+    for (auto it = _builds.begin(); it != _builds.end();) {
+        if (it->second.expired()) {
+            it = _builds.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::weak_ptr<SharedJoinBuild>& entry = _builds[BuildKey(query_id, node_id)];
+    std::shared_ptr<SharedJoinBuild> build = entry.lock();
+    *is_builder = (build == nullptr);
+    if (build == nullptr) {
+        build.reset(new SharedJoinBuild(
+                build_expr_ctxs, num_build_tuples, seed, parent, keys_only));
+        entry = build;
+    }
+    return build;
+}
+
+}
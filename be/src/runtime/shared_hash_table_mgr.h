@@ -0,0 +1,115 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_RUNTIME_SHARED_HASH_TABLE_MGR_H
+#define DORIS_BE_RUNTIME_SHARED_HASH_TABLE_MGR_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+#include "common/status.h"
+#include "gen_cpp/Types_types.h"
+#include "util/uid_util.h"
+
+namespace doris {
+
+class ExprContext;
+class JoinHashTable;
+class MemPool;
+class MemTracker;
+class RuntimeState;
+
+// The hash table of a broadcast join, which all the instances of its fragment
+// on this backend receive the same build rows for. It is built once for them:
+// the instance which created it adds the build rows, then it and the instances
+// waiting for the table build its partitions together. They all probe it once
+// it is built.
+//
+// The memory of the table is tracked by its own tracker below the process one,
+// since it outlives the instance which built it if the others still use it.
+class SharedJoinBuild {
+public:
+    SharedJoinBuild(const std::vector<ExprContext*>& build_expr_ctxs, int num_build_tuples,
+                    uint32_t seed, MemTracker* parent, bool keys_only);
+    ~SharedJoinBuild();
+
+    JoinHashTable* table() { return _table.get(); }
+
+    // holds the build tuples, only used by the builder
+    MemPool* build_pool() { return _build_pool.get(); }
+
+    // Called by the builder once it added all the build rows, or failed to with
+    // 'status'. Returns the status of the build once the table is built.
+    Status build(const Status& status);
+
+    // Called by the other instances. Builds partitions of the table with the
+    // builder, and returns the status of the build once it is built.
+    Status wait(RuntimeState* state);
+
+private:
+    enum State {
+        ADDING_ROWS,
+        BUILDING,
+        DONE,
+    };
+
+    // Builds the partitions which no one builds yet, releasing 'l' meanwhile.
+    void _build_partitions(std::unique_lock<std::mutex>* l);
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+    State _state;
+    Status _status;
+    int _next_partition;
+    int _num_built_partitions;
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    std::unique_ptr<MemPool> _build_pool;
+    std::unique_ptr<JoinHashTable> _table;
+};
+
+// Hands out the hash tables shared by the instances of broadcast joins. A table
+// is kept as long as an instance uses it.
+class SharedHashTableMgr {
+public:
+    SharedHashTableMgr();
+    ~SharedHashTableMgr();
+
+    // Returns the build of join 'node_id' of query 'query_id'. If there is none
+    // it is created with the other arguments, and *is_builder is set: the
+    // caller must add the build rows and call build().
+    std::shared_ptr<SharedJoinBuild> get_or_create(
+        const TUniqueId& query_id, int node_id,
+        const std::vector<ExprContext*>& build_expr_ctxs, int num_build_tuples,
+        uint32_t seed, MemTracker* parent, bool keys_only, bool* is_builder);
+
+private:
+    typedef std::pair<TUniqueId, int> BuildKey;
+
+    std::mutex _lock;
+    boost::unordered_map<BuildKey, std::weak_ptr<SharedJoinBuild>> _builds;
+};
+
+}
+
+#endif // DORIS_BE_RUNTIME_SHARED_HASH_TABLE_MGR_H
@@ -950,13 +950,15 @@ Status SnapshotLoader::_replace_tablet_id(
     // 10007.hdr
     // 10007_2_2_0_0.idx
     // 10007_2_2_0_0.dat
+    // 10007_2_2_0_0.pack
     if (_end_with(file_name, ".hdr")) {
         std::stringstream ss;
         ss << tablet_id << ".hdr";
         *new_file_name = ss.str();
         return Status::OK;
     } else if (_end_with(file_name, ".idx")
-            || _end_with(file_name, ".dat")) {
+            || _end_with(file_name, ".dat")
+            || _end_with(file_name, ".pack")) {
         size_t pos = file_name.find_first_of("_");
         if (pos == std::string::npos) {
             return Status("invalid tablet file name: " + file_name);
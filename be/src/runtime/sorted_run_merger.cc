@@ -17,18 +17,30 @@
 
 #include "runtime/sorted_run_merger.h"
 
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 
+#include <boost/bind.hpp>
+#include <boost/mem_fn.hpp>
+
 #include "exprs/expr.h"
 #include "runtime/descriptors.h"
 #include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
 #include "runtime/sorter.h"
 #include "runtime/tuple_row.h"
+#include "util/blocking_queue.hpp"
 #include "util/runtime_profile.h"
 #include "util/debug_util.h"
 
 using std::vector;
 
+using boost::bind;
+using boost::mem_fn;
+
 namespace doris {
 
 // BatchedRowSupplier returns individual rows in a batch obtained from a sorted input
@@ -102,70 +114,223 @@ private:
     SortedRunMerger* _parent;
 };
 
-void SortedRunMerger::heapify(int parent_index) {
-    int left_index = 2 * parent_index + 1;
-    int right_index = left_index + 1;
-    if (left_index >= _min_heap.size()) {
-        return;
-    }
-    int least_child = 0;
-    // Find the least child of parent.
-    if (right_index >= _min_heap.size() ||
-            _compare_less_than(_min_heap[left_index]->current_row(),
-                _min_heap[right_index]->current_row())) {
-        least_child = left_index;
-    } else {
-        least_child = right_index;
-    }
-
-    // If the parent is out of place, swap it with the least child and invoke
-    // heapify recursively.
-    if (_compare_less_than(_min_heap[least_child]->current_row(),
-                _min_heap[parent_index]->current_row())) {
-        iter_swap(_min_heap.begin() + least_child, _min_heap.begin() + parent_index);
-        heapify(least_child);
+// MergeThread merges a group of the input runs into deep copied batches on a thread of
+// its own. The batches are queued for the merger of all groups, which reads them by
+// get_batch() as one of its runs.
+class SortedRunMerger::MergeThread {
+public:
+    MergeThread(SortedRunMerger* parent, const std::vector<RunBatchSupplier>& runs,
+                RuntimeState* state, MemTracker* mem_tracker) :
+            _parent(parent),
+            _runs(runs),
+            _state(state),
+            _mem_tracker(mem_tracker),
+            _batch_queue(BATCH_QUEUE_SIZE) {
+    }
+
+    // Stops the thread and frees the queued batches.
+    ~MergeThread() {
+        _batch_queue.shutdown();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+        RowBatch* batch = NULL;
+        while (_batch_queue.blocking_get(&batch)) {
+            delete batch;
+        }
+        Expr::close(_lhs_expr_ctxs, _state);
+        Expr::close(_rhs_expr_ctxs, _state);
+    }
+
+    // Clones the exprs of the comparator and starts merging.
+    Status start(RuntimeProfile* profile) {
+        const TupleRowComparator& less_than = _parent->_compare_less_than;
+        RETURN_IF_ERROR(Expr::clone_if_not_exists(
+                    less_than.key_expr_ctxs_lhs(), _state, &_lhs_expr_ctxs));
+        RETURN_IF_ERROR(Expr::clone_if_not_exists(
+                    less_than.key_expr_ctxs_rhs(), _state, &_rhs_expr_ctxs));
+        _merger.reset(new SortedRunMerger(
+                    TupleRowComparator(_lhs_expr_ctxs, _rhs_expr_ctxs,
+                                       less_than.is_asc(), less_than.nulls_first()),
+                    _parent->_input_row_desc, profile, true));
+        _thread = std::thread(&MergeThread::merge, this);
+        return Status::OK;
+    }
+
+    // The RunBatchSupplier of the group. The batch is owned by this object until the
+    // next call.
+    Status get_batch(RowBatch** batch) {
+        _current_batch.reset();
+        RowBatch* next_batch = NULL;
+        if (_batch_queue.blocking_get(&next_batch)) {
+            _current_batch.reset(next_batch);
+            *batch = next_batch;
+            return Status::OK;
+        }
+        *batch = NULL;
+        std::lock_guard<std::mutex> l(_status_lock);
+        return _status;
     }
+
+    RowBatch* current_batch() { return _current_batch.get(); }
+
+private:
+    // batches merged ahead of the merger of all groups
+    static const int BATCH_QUEUE_SIZE = 2;
+
+    void merge() {
+        Status status = _merger->prepare(_runs);
+        while (status.ok()) {
+            RowBatch* batch = new RowBatch(*_parent->_input_row_desc, _state->batch_size(),
+                                           _mem_tracker);
+            bool eos = false;
+            status = _merger->get_next(batch, &eos);
+            if (!status.ok() || batch->num_rows() == 0 || !_batch_queue.blocking_put(batch)) {
+                delete batch;
+                break;
+            }
+            if (eos) {
+                break;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> l(_status_lock);
+            _status = status;
+        }
+        _batch_queue.shutdown();
+    }
+
+    SortedRunMerger* _parent;
+    std::vector<RunBatchSupplier> _runs;
+    RuntimeState* _state;
+    MemTracker* _mem_tracker;
+
+    // clones of the exprs of the comparator, evaluated by the thread only
+    std::vector<ExprContext*> _lhs_expr_ctxs;
+    std::vector<ExprContext*> _rhs_expr_ctxs;
+    boost::scoped_ptr<SortedRunMerger> _merger;
+
+    BlockingQueue<RowBatch*> _batch_queue;
+    boost::scoped_ptr<RowBatch> _current_batch;
+
+    // status of the merge once _batch_queue is shut down by the thread
+    std::mutex _status_lock;
+    Status _status;
+
+    std::thread _thread;
+};
+
+inline bool SortedRunMerger::run_less(int lhs, int rhs) const {
+    if (_run_exhausted[lhs]) {
+        return false;
+    }
+    if (_run_exhausted[rhs]) {
+        return true;
+    }
+    return _compare_less_than(_runs[lhs]->current_row(), _runs[rhs]->current_row());
+}
+
+int SortedRunMerger::build_tree(int node) {
+    int num_runs = _runs.size();
+    if (node >= num_runs) {
+        return node - num_runs;
+    }
+    int left = build_tree(2 * node);
+    int right = build_tree(2 * node + 1);
+    if (run_less(right, left)) {
+        _loser_tree[node] = left;
+        return right;
+    }
+    _loser_tree[node] = right;
+    return left;
+}
+
+void SortedRunMerger::replay_winner() {
+    int winner = _winner;
+    for (int node = (winner + _runs.size()) / 2; node > 0; node /= 2) {
+        if (run_less(_loser_tree[node], winner)) {
+            std::swap(_loser_tree[node], winner);
+        }
+    }
+    _winner = winner;
 }
 
 SortedRunMerger::SortedRunMerger(const TupleRowComparator& compare_less_than,
         RowDescriptor* row_desc, RuntimeProfile* profile, bool deep_copy_input) :
+            _num_remaining_runs(0),
+            _winner(0),
             _compare_less_than(compare_less_than),
             _input_row_desc(row_desc),
-            _deep_copy_input(deep_copy_input) {
+            _deep_copy_input(deep_copy_input),
+            _profile(profile) {
         _get_next_timer = ADD_TIMER(profile, "MergeGetNext");
         _get_next_batch_timer = ADD_TIMER(profile, "MergeGetNextBatch");
     }
 
+SortedRunMerger::~SortedRunMerger() {
+    for (auto merge_thread : _merge_threads) {
+        delete merge_thread;
+    }
+}
+
 Status SortedRunMerger::prepare(const vector<RunBatchSupplier>& input_runs) {
-    DCHECK_EQ(_min_heap.size(), 0);
-    _min_heap.reserve(input_runs.size());
+    DCHECK_EQ(_runs.size(), 0);
+    _runs.reserve(input_runs.size());
     BOOST_FOREACH(const RunBatchSupplier& input_run, input_runs) {
         BatchedRowSupplier* new_elem = _pool.add(new BatchedRowSupplier(this, input_run));
         DCHECK(new_elem != NULL);
         bool empty = false;
         RETURN_IF_ERROR(new_elem->init(&empty));
         if (!empty) {
-            _min_heap.push_back(new_elem);
+            _runs.push_back(new_elem);
         }
     }
 
-    // Construct the min heap from the sorted runs.
-    const int last_parent = (_min_heap.size() / 2) - 1;
-    for (int i = last_parent; i >= 0; --i) {
-        heapify(i);
+    // Play the first matches of the sorted runs.
+    _num_remaining_runs = _runs.size();
+    _run_exhausted.assign(_runs.size(), false);
+    _loser_tree.assign(_runs.size(), -1);
+    if (!_runs.empty()) {
+        _winner = build_tree(1);
     }
     return Status::OK;
 }
 
+Status SortedRunMerger::prepare_parallel(const vector<RunBatchSupplier>& input_runs,
+        int num_threads, RuntimeState* state, MemTracker* mem_tracker) {
+    num_threads = std::min<int>(num_threads, input_runs.size() / 2);
+    if (num_threads <= 1) {
+        return prepare(input_runs);
+    }
+    DCHECK(_merge_threads.empty());
+    vector<RunBatchSupplier> thread_runs;
+    for (int i = 0; i < num_threads; ++i) {
+        // every thread merges an equal share of the runs
+        vector<RunBatchSupplier> runs;
+        for (int j = i; j < input_runs.size(); j += num_threads) {
+            runs.push_back(input_runs[j]);
+        }
+        MergeThread* merge_thread = new MergeThread(this, runs, state, mem_tracker);
+        _merge_threads.push_back(merge_thread);
+        std::stringstream name;
+        name << "MergeThread" << i;
+        RuntimeProfile* profile = _pool.add(new RuntimeProfile(&_pool, name.str()));
+        _profile->add_child(profile, true, NULL);
+        RETURN_IF_ERROR(merge_thread->start(profile));
+        thread_runs.push_back(bind(mem_fn(&MergeThread::get_batch), merge_thread, _1));
+    }
+    return prepare(thread_runs);
+}
+
 Status SortedRunMerger::get_next(RowBatch* output_batch, bool* eos) {
     ScopedTimer<MonotonicStopWatch> timer(_get_next_timer);
-    if (_min_heap.empty()) {
+    if (_num_remaining_runs == 0) {
         *eos = true;
         return Status::OK;
     }
 
     while (!output_batch->at_capacity()) {
-        BatchedRowSupplier* min = _min_heap[0];
+        BatchedRowSupplier* min = _runs[_winner];
         int output_row_index = output_batch->add_row();
         TupleRow* output_row = output_batch->get_row(output_row_index);
         if (_deep_copy_input) {
@@ -185,17 +350,24 @@ Status SortedRunMerger::get_next(RowBatch* output_batch, bool* eos) {
         RETURN_IF_ERROR(min->next(_deep_copy_input ? NULL : output_batch,
                     &min_run_complete));
         if (min_run_complete) {
-            // Remove the element from the heap.
-            iter_swap(_min_heap.begin(), _min_heap.end() - 1);
-            _min_heap.pop_back();
-            if (_min_heap.empty()) break;
+            // The run loses all following matches.
+            _run_exhausted[_winner] = true;
+            if (--_num_remaining_runs == 0) break;
         }
 
-        heapify(0);
+        replay_winner();
     }
 
-    *eos = _min_heap.empty();
+    *eos = _num_remaining_runs == 0;
     return Status::OK;
 }
 
+void SortedRunMerger::transfer_all_resources(RowBatch* transfer_resource_batch) {
+    for (auto merge_thread : _merge_threads) {
+        if (merge_thread->current_batch() != NULL) {
+            merge_thread->current_batch()->transfer_resource_ownership(transfer_resource_batch);
+        }
+    }
+}
+
 } // namespace doris
@@ -26,14 +26,22 @@
 
 namespace doris {
 
+class MemTracker;
 class RowBatch;
 class RowDescriptor;
 class RuntimeProfile;
+class RuntimeState;
 
 // SortedRunMerger is used to merge multiple sorted runs of tuples. A run is a sorted
 // sequence of row batches, which are fetched from a RunBatchSupplier function object.
-// Merging is implemented using a binary min-heap that maintains the run with the next
-// tuple in sorted order at the top of the heap.
+// Merging is implemented using a loser tree: every inner node holds the run which lost
+// the comparison there, so replacing the row of the winning run takes one comparison
+// per level on its way to the root.
+//
+// With prepare_parallel() the runs are split into groups, each merged by a thread of
+// its own into deep copied batches which this merger then merges. The threads read
+// their runs ahead of the final merge, which is no longer the only thread comparing
+// rows.
 //
 // Merged batches of rows are retrieved from SortedRunMerger via calls to get_next().
 // The merger is constructed with a boolean flag deep_copy_input.
@@ -51,35 +59,60 @@ public:
     SortedRunMerger(const TupleRowComparator& compare_less_than, RowDescriptor* row_desc,
             RuntimeProfile* profile, bool deep_copy_input);
 
-    ~SortedRunMerger() {}
+    // Stops the merge threads.
+    ~SortedRunMerger();
 
     // Prepare this merger to merge and return rows from the sorted runs in 'input_runs'.
-    // Retrieves the first batch from each run and sets up the binary heap implementing
-    // the priority queue.
+    // Retrieves the first batch from each run and sets up the loser tree.
     Status prepare(const std::vector<RunBatchSupplier>& input_runs);
 
+    // Like prepare(), but merges the runs by 'num_threads' threads if there are at
+    // least two runs for each. The runs are called by those threads and must not be
+    // called by others until this merger is destroyed. The exprs of the comparator
+    // are cloned for every thread in 'state', the batches of the threads are
+    // charged to 'mem_tracker'.
+    Status prepare_parallel(const std::vector<RunBatchSupplier>& input_runs, int num_threads,
+                            RuntimeState* state, MemTracker* mem_tracker);
+
     // Return the next batch of sorted rows from this merger.
     Status get_next(RowBatch* output_batch, bool* eos);
 
     // Called to finalize a merge when deep_copy is false. Transfers resources from
-    // all input batches to the specified output batch.
+    // the batches of the merge threads to the specified output batch, the batches of
+    // the input runs are owned by their suppliers.
     void transfer_all_resources(RowBatch* transfer_resource_batch);
 
 private:
     class BatchedRowSupplier;
+    class MergeThread;
+
+    // true if the current row of run 'lhs' is ordered before the one of 'rhs',
+    // exhausted runs are ordered after all others
+    bool run_less(int lhs, int rhs) const;
+
+    // Plays the matches of the subtree at 'node' and returns its winner.
+    int build_tree(int node);
+
+    // Replays the matches of _winner from its leaf to the root after its current
+    // row changed.
+    void replay_winner();
 
-    // Assuming the element at parent_index is the only out of place element in the heap,
-    // restore the heap property (i.e. swap elements so parent <= children).
-    void heapify(int parent_index);
+    // The input runs, owned by this SortedRunMerger instance.
+    std::vector<BatchedRowSupplier*> _runs;
 
-    // The binary min-heap used to merge rows from the sorted input runs. Since the heap is
-    // stored in a 0-indexed array, the 0-th element is the minimum element in the heap,
-    // and the children of the element at index i are 2*i+1 and 2*i+2. The heap property is
-    // that row of the parent element is <= the rows of the child elements according to the
-    // comparator _compare_less_than.
-    // The BatchedRowSupplier objects used in the _min_heap are owned by this
-    // SortedRunMerger instance.
-    std::vector<BatchedRowSupplier*> _min_heap;
+    // true for the runs which have no rows left
+    std::vector<bool> _run_exhausted;
+    int _num_remaining_runs;
+
+    // Loser tree over _runs. Run i is the leaf i + _runs.size(), the parent of node n is
+    // n / 2, and _loser_tree[n] is the loser of the match at inner node n.
+    std::vector<int> _loser_tree;
+
+    // run with the next row in sorted order
+    int _winner;
+
+    // Threads merging groups of the input runs, whose outputs are _runs.
+    std::vector<MergeThread*> _merge_threads;
 
     // Row comparator. Returns true if lhs < rhs.
     TupleRowComparator _compare_less_than;
@@ -99,6 +132,9 @@ private:
 
     // Times calls to get the next batch of rows from the input run.
     RuntimeProfile::Counter* _get_next_batch_timer;
+
+    // Profile of this merger, the merge threads add their own to it.
+    RuntimeProfile* _profile;
 };
 
 } // namespace doris
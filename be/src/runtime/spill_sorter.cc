@@ -17,12 +17,17 @@
 
 #include "runtime/spill_sorter.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <string>
 #include <sstream>
 
 #include <boost/mem_fn.hpp>
 
+#include "exec/normalized_sort_key.h"
 #include "runtime/buffered_block_mgr2.h"
+#include "runtime/mem_tracker.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "runtime/sorted_run_merger.h"
@@ -245,13 +250,17 @@ private:
 // instance to check for cancellation during an in-memory sort.
 class SpillSorter::TupleSorter {
 public:
+    // 'radix_sorted_runs' counts the runs sorted by normalized keys, the memory
+    // of the keys is consumed from 'mem_tracker'.
     TupleSorter(const TupleRowComparator& less_than_comp, int64_t block_size,
-            int tuple_size, RuntimeState* state);
+            int tuple_size, RuntimeState* state, MemTracker* mem_tracker,
+            RuntimeProfile::Counter* radix_sorted_runs);
 
     ~TupleSorter();
 
-    // Performs a quicksort for tuples in 'run' followed by an insertion sort to
-    // finish smaller blocks.
+    // Sorts the tuples in 'run' by the normalized keys of the ordering exprs if
+    // they can be built, else performs a quicksort followed by an insertion sort
+    // to finish smaller blocks.
     // Returns early if _stste->is_cancelled() is true. No status
     // is returned - the caller must check for cancellation.
     void sort(Run* run);
@@ -259,6 +268,19 @@ public:
 private:
     static const int INSERTION_THRESHOLD = 16;
 
+    // Bytes of the normalized key prefixes. Rows with equal prefixes are
+    // compared by _less_than_comp.
+    static const int KEY_SIZE = 16;
+
+    // Buckets of the radix sort with fewer entries are sorted by std::sort.
+    static const int RADIX_SORT_THRESHOLD = 256;
+
+    // normalized key prefix of the tuple at 'index' of the run
+    struct SortEntry {
+        uint8_t key[KEY_SIZE];
+        int64_t index;
+    };
+
     // Helper class used to iterate over tuples in a run during quick sort and insertion sort.
     class TupleIterator {
     public:
@@ -339,6 +361,12 @@ private:
     // Size of the tuples in memory.
     const int _tuple_size;
 
+    // NULL if no prefix of the ordering exprs can be normalized.
+    boost::scoped_ptr<NormalizedSortKey> _sort_key;
+
+    MemTracker* _mem_tracker;
+    RuntimeProfile::Counter* _radix_sorted_runs;
+
     // Number of tuples per block in a run.
     const int _block_capacity;
 
@@ -377,6 +405,25 @@ private:
 
     // Swaps tuples pointed to by left and right using the swap buffer.
     void swap(uint8_t* left, uint8_t* right);
+
+    // Returns the tuple at 'index' of the run.
+    uint8_t* tuple(int64_t index) {
+        return _run->_fixed_len_blocks[index / _block_capacity]->buffer()
+            + (index % _block_capacity) * _tuple_size;
+    }
+
+    // Sorts the run by normalized keys: builds the key of every tuple, sorts
+    // the keys and moves the tuples to their positions. Returns false without
+    // changing the run if the keys can't be built or their memory can't be
+    // consumed.
+    bool sort_by_keys();
+
+    // MSD radix sort of [begin, end) by the bytes of the keys from 'byte' on,
+    // 'temp' has room for as many entries.
+    void radix_sort(SortEntry* begin, SortEntry* end, SortEntry* temp, int byte);
+
+    // Moves the tuples of the run so the tuple of entries[i] is at i.
+    void permute(SortEntry* entries);
 }; // class TupleSorter
 
 // SpillSorter::Run methods
@@ -892,8 +939,11 @@ void SpillSorter::Run::copy_var_len_data_convert_offset(char* dest, int64_t offs
 // SpillSorter::TupleSorter methods.
 SpillSorter::TupleSorter::TupleSorter(
     const TupleRowComparator& comp, int64_t block_size,
-    int tuple_size, RuntimeState* state) :
+    int tuple_size, RuntimeState* state, MemTracker* mem_tracker,
+    RuntimeProfile::Counter* radix_sorted_runs) :
         _tuple_size(tuple_size),
+        _mem_tracker(mem_tracker),
+        _radix_sorted_runs(radix_sorted_runs),
         _block_capacity(block_size / tuple_size),
         _last_tuple_block_offset(tuple_size * ((block_size / tuple_size) - 1)),
         _less_than_comp(comp),
@@ -901,6 +951,13 @@ SpillSorter::TupleSorter::TupleSorter(
     _temp_tuple_buffer = new uint8_t[tuple_size];
     _temp_tuple_row = reinterpret_cast<TupleRow*>(&_temp_tuple_buffer);
     _swap_buffer = new uint8_t[tuple_size];
+    if (!comp.key_expr_ctxs_lhs().empty()) {
+        _sort_key.reset(new NormalizedSortKey(comp.key_expr_ctxs_lhs(), comp.is_asc(),
+                                              comp.nulls_first(), KEY_SIZE));
+        if (_sort_key->size() == 0) {
+            _sort_key.reset();
+        }
+    }
 }
 
 SpillSorter::TupleSorter::~TupleSorter() {
@@ -910,10 +967,112 @@ SpillSorter::TupleSorter::~TupleSorter() {
 
 void SpillSorter::TupleSorter::sort(Run* run) {
     _run = run;
-    sort_helper(TupleIterator(this, 0), TupleIterator(this, _run->_num_tuples));
+    if (sort_by_keys()) {
+        _radix_sorted_runs->update(1);
+    } else {
+        sort_helper(TupleIterator(this, 0), TupleIterator(this, _run->_num_tuples));
+    }
     run->_is_sorted = true;
 }
 
+bool SpillSorter::TupleSorter::sort_by_keys() {
+    int64_t num_tuples = _run->_num_tuples;
+    if (_sort_key == NULL || num_tuples <= INSERTION_THRESHOLD) {
+        return false;
+    }
+    // the entries and the temp entries of the radix sort
+    int64_t bytes = 2 * num_tuples * sizeof(SortEntry);
+    if (!_mem_tracker->try_consume(bytes)) {
+        return false;
+    }
+    std::vector<SortEntry> entries(num_tuples);
+    bool encoded = true;
+    for (int64_t i = 0; i < num_tuples && encoded; ++i) {
+        uint8_t* tuple_ptr = tuple(i);
+        memset(entries[i].key, 0, KEY_SIZE);
+        entries[i].index = i;
+        encoded = _sort_key->encode(reinterpret_cast<TupleRow*>(&tuple_ptr), entries[i].key);
+    }
+    if (encoded) {
+        std::vector<SortEntry> temp(num_tuples);
+        radix_sort(&entries[0], &entries[0] + num_tuples, &temp[0], 0);
+        if (!_state->is_cancelled()) {
+            permute(&entries[0]);
+        }
+    }
+    std::vector<SortEntry>().swap(entries);
+    _mem_tracker->release(bytes);
+    return encoded;
+}
+
+void SpillSorter::TupleSorter::radix_sort(SortEntry* begin, SortEntry* end,
+        SortEntry* temp, int byte) {
+    if (UNLIKELY(_state->is_cancelled())) {
+        return;
+    }
+    int key_size = _sort_key->size();
+    if (end - begin < RADIX_SORT_THRESHOLD || byte >= key_size) {
+        bool is_complete = _sort_key->is_complete();
+        std::sort(begin, end, [this, byte, key_size, is_complete](
+                    const SortEntry& lhs, const SortEntry& rhs) {
+            int result = memcmp(lhs.key + byte, rhs.key + byte, key_size - byte);
+            if (result != 0 || is_complete) {
+                return result < 0;
+            }
+            return _less_than_comp(reinterpret_cast<Tuple*>(tuple(lhs.index)),
+                                   reinterpret_cast<Tuple*>(tuple(rhs.index)));
+        });
+        return;
+    }
+
+    int64_t counts[256] = {0};
+    for (SortEntry* entry = begin; entry != end; ++entry) {
+        ++counts[entry->key[byte]];
+    }
+    int64_t offsets[256];
+    int64_t offset = 0;
+    for (int i = 0; i < 256; ++i) {
+        offsets[i] = offset;
+        offset += counts[i];
+    }
+    if (counts[begin->key[byte]] != end - begin) {
+        for (SortEntry* entry = begin; entry != end; ++entry) {
+            temp[offsets[entry->key[byte]]++] = *entry;
+        }
+        memcpy(begin, temp, (end - begin) * sizeof(SortEntry));
+    }
+    // buckets of the same byte go on with the next one
+    for (SortEntry* bucket = begin; bucket != end;) {
+        SortEntry* bucket_end = bucket + counts[bucket->key[byte]];
+        if (bucket_end - bucket > 1) {
+            radix_sort(bucket, bucket_end, temp, byte + 1);
+        }
+        bucket = bucket_end;
+    }
+}
+
+void SpillSorter::TupleSorter::permute(SortEntry* entries) {
+    // follows the cycles of the permutation, an entry whose tuple is in place
+    // gets its own index
+    for (int64_t i = 0; i < _run->_num_tuples; ++i) {
+        if (entries[i].index == i) {
+            continue;
+        }
+        memcpy(_temp_tuple_buffer, tuple(i), _tuple_size);
+        int64_t dest = i;
+        while (true) {
+            int64_t src = entries[dest].index;
+            entries[dest].index = dest;
+            if (src == i) {
+                memcpy(tuple(dest), _temp_tuple_buffer, _tuple_size);
+                break;
+            }
+            memcpy(tuple(dest), tuple(src), _tuple_size);
+            dest = src;
+        }
+    }
+}
+
 // Sort the sequence of tuples from [first, last).
 // Begin with a sorted sequence of size 1 [first, first+1).
 // During each pass of the outermost loop, add the next tuple (at position 'i') to
@@ -1030,7 +1189,8 @@ SpillSorter::SpillSorter(const TupleRowComparator& compare_less_than,
     _initial_runs_counter(NULL),
     _num_merges_counter(NULL),
     _in_mem_sort_timer(NULL),
-    _sorted_data_size(NULL) {
+    _sorted_data_size(NULL),
+    _radix_sorted_runs_counter(NULL) {
 }
 
 SpillSorter::~SpillSorter() {
@@ -1053,14 +1213,17 @@ Status SpillSorter::init() {
     DCHECK(_unsorted_run == NULL) << "Already initialized";
     TupleDescriptor* sort_tuple_desc = _output_row_desc->tuple_descriptors()[0];
     _has_var_len_slots = sort_tuple_desc->has_varlen_slots();
-    _in_mem_tuple_sorter.reset(new TupleSorter(_compare_less_than,
-                _block_mgr->max_block_size(), sort_tuple_desc->byte_size(), _state));
-    _unsorted_run = _obj_pool.add(new Run(this, sort_tuple_desc, true));
-
     _initial_runs_counter = ADD_COUNTER(_profile, "InitialRunsCreated", TUnit::UNIT);
     _num_merges_counter = ADD_COUNTER(_profile, "TotalMergesPerformed", TUnit::UNIT);
     _in_mem_sort_timer = ADD_TIMER(_profile, "InMemorySortTime");
     _sorted_data_size = ADD_COUNTER(_profile, "SortDataSize", TUnit::BYTES);
+    _radix_sorted_runs_counter = ADD_COUNTER(_profile, "RunsSortedByNormalizedKeys",
+                                             TUnit::UNIT);
+
+    _in_mem_tuple_sorter.reset(new TupleSorter(_compare_less_than,
+                _block_mgr->max_block_size(), sort_tuple_desc->byte_size(), _state,
+                _mem_tracker, _radix_sorted_runs_counter));
+    _unsorted_run = _obj_pool.add(new Run(this, sort_tuple_desc, true));
 
     int min_blocks_required = BLOCKS_REQUIRED_FOR_MERGE;
     // Fixed and var-length blocks are separate, so we need BLOCKS_REQUIRED_FOR_MERGE
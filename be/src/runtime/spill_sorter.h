@@ -212,6 +212,7 @@ private:
     RuntimeProfile::Counter* _num_merges_counter;
     RuntimeProfile::Counter* _in_mem_sort_timer;
     RuntimeProfile::Counter* _sorted_data_size;
+    RuntimeProfile::Counter* _radix_sorted_runs_counter;
 };
 
 } // namespace doris
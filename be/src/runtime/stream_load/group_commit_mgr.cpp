@@ -0,0 +1,360 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/stream_load/group_commit_mgr.h"
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <vector>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "common/utils.h"
+#include "gen_cpp/FrontendService.h"
+#include "gen_cpp/FrontendService_types.h"
+#include "gen_cpp/HeartbeatService_types.h"
+#include "runtime/exec_env.h"
+#include "runtime/stream_load/load_stream_mgr.h"
+#include "runtime/stream_load/stream_load_context.h"
+#include "runtime/stream_load/stream_load_executor.h"
+#include "runtime/stream_load/stream_load_pipe.h"
+#include "util/frontend_helper.h"
+#include "util/time.h"
+#include "util/uid_util.h"
+
+namespace doris {
+
+#ifdef BE_TEST
+TStreamLoadPutResult k_group_commit_put_result;
+#endif
+
+struct GroupCommitMgr::LoadGroup {
+    std::string key;
+    // when the group is committed, set to 0 once it holds group_commit_max_bytes
+    std::atomic<int64_t> commit_time_ms{0};
+
+    // held while the group starts and while a load appends its body to the
+    // pipe, so that the bodies of the loads are not mixed
+    std::mutex lock;
+    // no more appended to, the loads coming later take a new group
+    bool closed = false;
+    // the load of the group, which owns the transaction and reads the pipe.
+    // nullptr before the group starts and after it is committed
+    StreamLoadContext* ctx = nullptr;
+    std::shared_ptr<StreamLoadPipe> pipe;
+    size_t num_bytes = 0;
+    int num_loads = 0;
+
+    std::promise<Status> promise;
+    std::shared_future<Status> future = promise.get_future().share();
+    // the results of the group answered to its loads, set before the promise
+    int64_t txn_id = -1;
+    std::string label;
+    int64_t number_total_rows = 0;
+    int64_t number_loaded_rows = 0;
+    int64_t number_filtered_rows = 0;
+    int64_t number_unselected_rows = 0;
+    std::string error_url;
+};
+
+GroupCommitMgr::GroupCommitMgr(ExecEnv* exec_env) : _exec_env(exec_env) {
+}
+
+GroupCommitMgr::~GroupCommitMgr() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _stopped = true;
+    }
+    _cond.notify_all();
+    if (_commit_thread.joinable()) {
+        _commit_thread.join();
+    }
+}
+
+Status GroupCommitMgr::start_bg_worker() {
+    _commit_thread = std::thread(
+        [this] {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> l(_lock);
+                    if (_stopped) {
+                        break;
+                    }
+                }
+                _commit_due_groups();
+            }
+            // answer the loads still waiting
+            std::vector<LoadGroupPtr> groups;
+            {
+                std::lock_guard<std::mutex> l(_lock);
+                for (auto& it : _groups) {
+                    groups.push_back(it.second);
+                }
+                _groups.clear();
+            }
+            for (auto& group : groups) {
+                _commit_group(group.get());
+            }
+        });
+    return Status::OK;
+}
+
+std::string GroupCommitMgr::_group_key(const StreamLoadContext* ctx) {
+    // everything the plan and the transaction of the group are made of
+    const TStreamLoadPutRequest& request = ctx->put_request;
+    std::stringstream ss;
+    ss << ctx->db << '\1' << ctx->table << '\1'
+        << ctx->auth.user << '\1' << ctx->auth.passwd << '\1'
+        << ctx->auth.cluster << '\1' << ctx->auth.auth_code << '\1'
+        << ctx->format << '\1' << ctx->max_filter_ratio << '\1'
+        << request.columns << '\1' << request.where << '\1'
+        << request.columnSeparator << '\1' << request.jsonpaths << '\1'
+        << request.partitions << '\1' << request.negative;
+    return ss.str();
+}
+
+Status GroupCommitMgr::group_commit(StreamLoadContext* ctx, StreamLoadPipe* body) {
+    // take the whole body first, a body is never appended in part
+    RETURN_IF_ERROR(body->finish());
+    std::vector<ByteBufferPtr> bufs;
+    ByteBufferPtr buf;
+    while (true) {
+        RETURN_IF_ERROR(body->read_buffer(&buf));
+        if (buf == nullptr) {
+            break;
+        }
+        if (buf->has_remaining()) {
+            bufs.push_back(buf);
+        }
+    }
+    std::string key = _group_key(ctx);
+
+    LoadGroupPtr group;
+    std::unique_lock<std::mutex> group_lock;
+    while (true) {
+        bool is_new = false;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            if (_stopped) {
+                return Status("group commit is stopped");
+            }
+            auto it = _groups.find(key);
+            if (it == _groups.end()) {
+                group = std::make_shared<LoadGroup>();
+                group->key = key;
+                group->commit_time_ms = MonotonicMillis() + config::group_commit_interval_ms;
+                // nobody waits for the lock of a new group
+                group_lock = std::unique_lock<std::mutex>(group->lock);
+                _groups.emplace(key, group);
+                is_new = true;
+            } else {
+                group = it->second;
+            }
+        }
+        if (is_new) {
+            Status st = _start_group(group.get(), ctx);
+            if (!st.ok()) {
+                LOG(WARNING) << "start group commit failed, errmsg=" << st.get_error_msg()
+                    << ctx->brief();
+                if (group->ctx != nullptr) {
+                    if (group->pipe != nullptr) {
+                        group->pipe->cancel();
+                    }
+                    if (group->ctx->unref()) {
+                        delete group->ctx;
+                    }
+                    group->ctx = nullptr;
+                }
+                group->closed = true;
+                group->promise.set_value(st);
+                group_lock.unlock();
+
+                std::lock_guard<std::mutex> l(_lock);
+                auto it = _groups.find(key);
+                if (it != _groups.end() && it->second == group) {
+                    _groups.erase(it);
+                }
+                return st;
+            }
+            _cond.notify_one();
+        } else {
+            group_lock = std::unique_lock<std::mutex>(group->lock);
+        }
+        if (!group->closed) {
+            break;
+        }
+        // committed or failed to start in the meantime
+        group_lock.unlock();
+    }
+
+    // the body is ended by a line delimiter, so it is not joined with the next one.
+    // appends only fail once the group has failed
+    char last_char = '\n';
+    for (auto& buf : bufs) {
+        last_char = buf->ptr[buf->limit - 1];
+        group->num_bytes += buf->remaining();
+        RETURN_IF_ERROR(group->pipe->append(buf));
+    }
+    if (last_char != '\n') {
+        group->num_bytes += 1;
+        RETURN_IF_ERROR(group->pipe->append("\n", 1));
+    }
+    group->num_loads++;
+    bool is_full = group->num_bytes >= static_cast<size_t>(config::group_commit_max_bytes);
+    std::shared_future<Status> future = group->future;
+    group_lock.unlock();
+
+    if (is_full) {
+        std::lock_guard<std::mutex> l(_lock);
+        group->commit_time_ms = 0;
+        _cond.notify_one();
+    }
+
+    Status st = future.get();
+    ctx->txn_id = group->txn_id;
+    ctx->group_commit_label = group->label;
+    ctx->number_total_rows = group->number_total_rows;
+    ctx->number_loaded_rows = group->number_loaded_rows;
+    ctx->number_filtered_rows = group->number_filtered_rows;
+    ctx->number_unselected_rows = group->number_unselected_rows;
+    ctx->error_url = group->error_url;
+    return st;
+}
+
+Status GroupCommitMgr::_start_group(LoadGroup* group, const StreamLoadContext* load) {
+    StreamLoadContext* ctx = new StreamLoadContext(_exec_env);
+    ctx->ref();
+    group->ctx = ctx;
+
+    ctx->load_type = TLoadType::MANUL_LOAD;
+    ctx->load_src_type = TLoadSourceType::RAW;
+    ctx->db = load->db;
+    ctx->table = load->table;
+    ctx->auth = load->auth;
+    ctx->label = "group_commit_" + generate_uuid_string();
+    ctx->format = load->format;
+    ctx->use_streaming = true;
+    ctx->max_filter_ratio = load->max_filter_ratio;
+    group->label = ctx->label;
+
+    RETURN_IF_ERROR(_exec_env->stream_load_executor()->begin_txn(ctx));
+
+    TStreamLoadPutRequest request = load->put_request;
+    request.txnId = ctx->txn_id;
+    request.__set_loadId(ctx->id.to_thrift());
+    request.fileType = TFileType::FILE_STREAM;
+    group->pipe = std::make_shared<StreamLoadPipe>();
+    RETURN_IF_ERROR(_exec_env->load_stream_mgr()->put(ctx->id, group->pipe));
+    ctx->body_sink = group->pipe;
+
+#ifndef BE_TEST
+    TNetworkAddress master_addr = _exec_env->master_info()->network_address;
+    RETURN_IF_ERROR(FrontendHelper::rpc(
+            master_addr.hostname, master_addr.port,
+            [&request, ctx] (FrontendServiceConnection& client) {
+            client->streamLoadPut(ctx->put_result, request);
+            }));
+#else
+    ctx->put_result = k_group_commit_put_result;
+#endif
+    Status plan_status(ctx->put_result.status);
+    if (!plan_status.ok()) {
+        LOG(WARNING) << "plan group commit failed. errmsg=" << plan_status.get_error_msg()
+                << ctx->brief();
+        return plan_status;
+    }
+    RETURN_IF_ERROR(_exec_env->stream_load_executor()->execute_plan_fragment(ctx));
+
+    LOG(INFO) << "begin group commit." << ctx->brief()
+              << ", db: " << ctx->db << ", tbl: " << ctx->table;
+    return Status::OK;
+}
+
+void GroupCommitMgr::_commit_due_groups() {
+    std::vector<LoadGroupPtr> due_groups;
+    {
+        std::unique_lock<std::mutex> l(_lock);
+        int64_t now_ms = MonotonicMillis();
+        int64_t wait_ms = std::max(config::group_commit_interval_ms, 1);
+        for (auto it = _groups.begin(); it != _groups.end();) {
+            int64_t commit_time_ms = it->second->commit_time_ms;
+            if (commit_time_ms <= now_ms) {
+                due_groups.push_back(it->second);
+                it = _groups.erase(it);
+            } else {
+                wait_ms = std::min(wait_ms, commit_time_ms - now_ms);
+                ++it;
+            }
+        }
+        if (due_groups.empty()) {
+            _cond.wait_for(l, std::chrono::milliseconds(wait_ms));
+            return;
+        }
+    }
+    for (auto& group : due_groups) {
+        _commit_group(group.get());
+    }
+}
+
+void GroupCommitMgr::_commit_group(LoadGroup* group) {
+    {
+        std::lock_guard<std::mutex> l(group->lock);
+        // failed to start, its loads are answered
+        if (group->closed) {
+            return;
+        }
+        group->closed = true;
+    }
+    StreamLoadContext* ctx = group->ctx;
+    Status st = ctx->body_sink->finish();
+    if (st.ok()) {
+        st = ctx->future.get();
+    }
+    if (st.ok()) {
+        st = _exec_env->stream_load_executor()->commit_txn(ctx);
+    }
+    if (!st.ok()) {
+        LOG(WARNING) << "group commit failed, errmsg=" << st.get_error_msg()
+            << ", loads=" << group->num_loads << ", bytes=" << group->num_bytes
+            << ", " << ctx->brief();
+        ctx->status = st;
+        if (ctx->need_rollback) {
+            _exec_env->stream_load_executor()->rollback_txn(ctx);
+            ctx->need_rollback = false;
+        }
+        ctx->body_sink->cancel();
+    } else {
+        LOG(INFO) << "group committed, loads=" << group->num_loads
+            << ", bytes=" << group->num_bytes << ", " << ctx->brief();
+    }
+
+    group->txn_id = ctx->txn_id;
+    group->number_total_rows = ctx->number_total_rows;
+    group->number_loaded_rows = ctx->number_loaded_rows;
+    group->number_filtered_rows = ctx->number_filtered_rows;
+    group->number_unselected_rows = ctx->number_unselected_rows;
+    group->error_url = ctx->error_url;
+    group->ctx = nullptr;
+    if (ctx->unref()) {
+        delete ctx;
+    }
+    group->promise.set_value(st);
+}
+
+}
@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#pragma once
+
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "common/status.h"
+
+namespace doris {
+
+class ExecEnv;
+class StreamLoadContext;
+class StreamLoadPipe;
+
+// Small stream loads with the header group_commit: true have no transaction
+// of their own. Their bodies are appended one after another to a long-lived
+// load of their table, which is committed once group_commit_interval_ms has
+// passed since it began or once it holds group_commit_max_bytes. Every load
+// of a group is answered after the transaction of the group is committed, so
+// thousands of small loads make a few transactions and versions.
+// The loads of a group share its plan, so only the loads agreeing on the user,
+// the table and the load parameters are grouped, and they fail together.
+class GroupCommitMgr {
+public:
+    GroupCommitMgr(ExecEnv* exec_env);
+    ~GroupCommitMgr();
+
+    Status start_bg_worker();
+
+    // Appends the whole body received by 'ctx' in 'body' to a group planned
+    // by ctx->put_request, and waits until the group is committed.
+    Status group_commit(StreamLoadContext* ctx, StreamLoadPipe* body);
+
+private:
+    struct LoadGroup;
+    typedef std::shared_ptr<LoadGroup> LoadGroupPtr;
+
+    static std::string _group_key(const StreamLoadContext* ctx);
+
+    // begins the transaction of 'group' and starts its plan
+    Status _start_group(LoadGroup* group, const StreamLoadContext* ctx);
+    // stops appending to 'group', commits its transaction and answers its loads
+    void _commit_group(LoadGroup* group);
+
+    void _commit_due_groups();
+
+    ExecEnv* _exec_env;
+
+    std::mutex _lock;
+    std::condition_variable _cond;
+    // the open groups by _group_key()
+    std::unordered_map<std::string, LoadGroupPtr> _groups;
+    bool _stopped = false;
+
+    std::thread _commit_thread;
+};
+
+}
@@ -31,6 +31,11 @@ std::string StreamLoadContext::to_json() const {
     // label
     writer.Key("Label");
     writer.String(label.c_str());
+    if (group_commit) {
+        // the transaction and the numbers of rows are those of the group
+        writer.Key("GroupCommitLabel");
+        writer.String(group_commit_label.c_str());
+    }
 
     // status
     writer.Key("Status");
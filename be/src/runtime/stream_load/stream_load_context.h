@@ -150,6 +150,11 @@ public:
     std::shared_ptr<MessageBodySink> body_sink;
 
     TStreamLoadPutResult put_result;
+    // a load appended to a group of its table by GroupCommitMgr, which plans the
+    // group by put_request, and has no transaction of its own
+    bool group_commit = false;
+    TStreamLoadPutRequest put_request;
+    std::string group_commit_label;
     double max_filter_ratio = 0.0;
     std::vector<TTabletCommitInfo> commit_infos;
 
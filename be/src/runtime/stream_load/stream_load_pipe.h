@@ -73,6 +73,23 @@ public:
         return _append(buf);
     }
 
+    // The buffer is taken even if the pipe is full, the producer is expected
+    // to wait for has_room() before appending more.
+    Status append_nowait(const ByteBufferPtr& buf) override {
+        if (_write_buf != nullptr) {
+            _write_buf->flip();
+            RETURN_IF_ERROR(_append(_write_buf, false));
+            _write_buf.reset();
+        }
+        return _append(buf, false);
+    }
+
+    // a cancelled pipe has room, so that appends to it fail
+    bool has_room() override {
+        std::lock_guard<std::mutex> l(_lock);
+        return _cancelled || _buffered_bytes < _max_buffered_bytes;
+    }
+
     Status read(uint8_t* data, size_t* data_size, bool* eof) override {
         size_t bytes_read = 0;
         while (bytes_read < *data_size) {
@@ -107,6 +124,30 @@ public:
         return Status::OK;
     }
 
+    // Takes the next buffer in the pipe as it was appended, instead of
+    // copying it out as read() does. The data is in [buf->pos, buf->limit)
+    // and the pipe no longer refers to the buffer. 'buf' is nullptr once all
+    // data has been taken.
+    Status read_buffer(ByteBufferPtr* buf) {
+        std::unique_lock<std::mutex> l(_lock);
+        while (!_cancelled && !_finished && _buf_queue.empty()) {
+            _get_cond.wait(l);
+        }
+        if (_cancelled) {
+            return Status("cancelled");
+        }
+        if (_buf_queue.empty()) {
+            DCHECK(_finished);
+            buf->reset();
+            return Status::OK;
+        }
+        *buf = _buf_queue.front();
+        _buf_queue.pop_front();
+        _buffered_bytes -= (*buf)->limit;
+        _put_cond.notify_one();
+        return Status::OK;
+    }
+
     // called when comsumer finished
     void close() override {
         cancel();
@@ -138,11 +179,11 @@ public:
     }
 
 private:
-    Status _append(const ByteBufferPtr& buf) {
+    Status _append(const ByteBufferPtr& buf, bool wait = true) {
         {
             std::unique_lock<std::mutex> l(_lock);
             // if _buf_queue is empty, we append this buf without size check
-            while (!_cancelled &&
+            while (wait && !_cancelled &&
                    !_buf_queue.empty() &&
                    _buffered_bytes + buf->remaining() > _max_buffered_bytes) {
                 _put_cond.wait(l);
@@ -0,0 +1,106 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/string_search.hpp"
+
+#include <immintrin.h>
+
+#include "util/cpu_info.h"
+
+namespace doris {
+
+// Returns the first position in [s, s + num_blocks * 16) where 'pattern' starts,
+// NULL if there is none. The blocks and the pattern after them must be readable.
+static const char* find_sse2(const char* s, int num_blocks, const char* pattern,
+                             int pattern_len) {
+    const __m128i first = _mm_set1_epi8(pattern[0]);
+    const __m128i last = _mm_set1_epi8(pattern[pattern_len - 1]);
+    for (int k = 0; k < num_blocks; ++k, s += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        __m128i block_last = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(s + pattern_len - 1));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                   _mm_cmpeq_epi8(block_last, last));
+        for (uint32_t mask = _mm_movemask_epi8(eq); mask != 0; mask &= mask - 1) {
+            const char* candidate = s + __builtin_ctz(mask);
+            if (memcmp(candidate + 1, pattern + 1, pattern_len - 2) == 0) {
+                return candidate;
+            }
+        }
+    }
+    return NULL;
+}
+
+__attribute__((target("avx2")))
+static const char* find_avx2(const char* s, int num_blocks, const char* pattern,
+                             int pattern_len) {
+    const __m256i first = _mm256_set1_epi8(pattern[0]);
+    const __m256i last = _mm256_set1_epi8(pattern[pattern_len - 1]);
+    for (int k = 0; k < num_blocks; ++k, s += 32) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        __m256i block_last = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(s + pattern_len - 1));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                                      _mm256_cmpeq_epi8(block_last, last));
+        for (uint32_t mask = _mm256_movemask_epi8(eq); mask != 0; mask &= mask - 1) {
+            const char* candidate = s + __builtin_ctz(mask);
+            if (memcmp(candidate + 1, pattern + 1, pattern_len - 2) == 0) {
+                return candidate;
+            }
+        }
+    }
+    return NULL;
+}
+
+const char* StringSearch::find(const char* str, int len, const char* pattern,
+                               int pattern_len) {
+    DCHECK_GT(pattern_len, 0);
+    if (pattern_len == 1) {
+        // glibc already searches one byte with SIMD
+        return reinterpret_cast<const char*>(memchr(str, pattern[0], len));
+    }
+    // positions where the pattern may start
+    int num_positions = len - pattern_len + 1;
+    if (num_positions <= 0) {
+        return NULL;
+    }
+    int start = 0;
+    if (CpuInfo::is_supported(CpuInfo::AVX2)) {
+        int num_blocks = num_positions / 32;
+        const char* result = find_avx2(str, num_blocks, pattern, pattern_len);
+        if (result != NULL) {
+            return result;
+        }
+        start = num_blocks * 32;
+    }
+    int num_blocks = (num_positions - start) / 16;
+    const char* result = find_sse2(str + start, num_blocks, pattern, pattern_len);
+    if (result != NULL) {
+        return result;
+    }
+    // the last positions are too few for a block, which must not be read beyond the
+    // end of the string
+    for (int i = start + num_blocks * 16; i < num_positions; ++i) {
+        if (str[i] == pattern[0] && str[i + pattern_len - 1] == pattern[pattern_len - 1]
+                && memcmp(str + i + 1, pattern + 1, pattern_len - 2) == 0) {
+            return str + i;
+        }
+    }
+    return NULL;
+}
+
+}
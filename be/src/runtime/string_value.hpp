@@ -81,6 +81,12 @@ inline int StringValue::compare(const StringValue& other) const {
         }
     }
 
+    // Strings sharing a buffer, e.g. decoded from the same dictionary entry,
+    // are ordered by their lengths without reading the buffer.
+    if (this->ptr == other.ptr) {
+        return this->len - other.len;
+    }
+
     return string_compare(this->ptr, this->len, other.ptr, other.len, l);
 }
 
@@ -89,6 +95,10 @@ inline bool StringValue::eq(const StringValue& other) const {
         return false;
     }
 
+    if (this->ptr == other.ptr) {
+        return true;
+    }
+
     return string_compare(this->ptr, this->len, other.ptr, other.len, this->len) == 0;
 }
 
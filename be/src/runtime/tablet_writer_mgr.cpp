@@ -17,17 +17,28 @@
 
 #include "runtime/tablet_writer_mgr.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "common/config.h"
 #include "common/object_pool.h"
 #include "exec/olap_table_info.h"
+#include "runtime/columnar_row_batch.h"
 #include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/mem_pool.h"
 #include "runtime/mem_tracker.h"
 #include "runtime/row_batch.h"
 #include "runtime/tuple_row.h"
 #include "util/bitmap.h"
+#include "util/brpc_stub_cache.h"
+#include "util/ref_count_closure.h"
 #include "util/stopwatch.hpp"
 #include "olap/delta_writer.h"
 #include "olap/lru_cache.h"
@@ -37,7 +48,8 @@ namespace doris {
 // channel that process all data for this load
 class TabletsChannel {
 public:
-    TabletsChannel(const TabletsChannelKey& key) : _key(key), _closed_senders(64) { }
+    TabletsChannel(ExecEnv* exec_env, const TabletsChannelKey& key)
+        : _exec_env(exec_env), _key(key), _closed_senders(64) { }
     ~TabletsChannel();
 
     Status open(const PTabletWriterOpenRequest& params);
@@ -52,11 +64,28 @@ public:
         return _last_updated_time;
     }
 
+    // Appends the writers, unless the channel is being opened or closed.
+    // They are valid as long as the channel is.
+    void get_writers(std::vector<DeltaWriter*>* writers);
+
 private:
     // open all writer
     Status _open_all_writers(const PTabletWriterOpenRequest& params);
 
+    Status _write_batch(const PTabletWriterAddBatchRequest& params);
+    Status _write_local_batch(const PTabletWriterAddBatchRequest& params,
+                              const std::vector<Tuple*>& tuples);
+
+    // sends the rows of the tablets this backend is the primary replica of
+    // to the other replicas, the closures are to be waited for
+    void _forward_batch(const PTabletWriterAddBatchRequest& params,
+                        const std::vector<Tuple*>& tuples,
+                        std::vector<RefCountClosure<PTabletWriterAddBatchResult>*>* closures);
+    Status _wait_forwarded(
+        const std::vector<RefCountClosure<PTabletWriterAddBatchResult>*>& closures);
+
 private:
+    ExecEnv* _exec_env;
     // id of this load channel, just for 
     TabletsChannelKey _key;
 
@@ -74,12 +103,22 @@ private:
 
     // next sequence we expect
     int _num_remaining_senders = 0;
+    // _next_seqs[i] is protected by _sender_locks[i], so packets of one sender
+    // are written in order while different senders write in parallel. A sender
+    // may send several packets without waiting, the ones arriving early wait on
+    // _sender_conds[i] for the packets before them.
     std::vector<int64_t> _next_seqs;
+    std::vector<std::mutex> _sender_locks;
+    std::vector<std::condition_variable> _sender_conds;
+    // a packet of the sender failed, the ones after it can't be written
+    std::vector<bool> _sender_failed;
     Bitmap _closed_senders;
     Status _close_status;
 
     // tablet_id -> TabletChannel
     std::unordered_map<int64_t, DeltaWriter*> _tablet_writers;
+    // tablet_id -> replicas its rows are forwarded to
+    std::unordered_map<int64_t, std::vector<palo::PInternalService_Stub*>> _forward_stubs;
 
     std::unordered_set<int64_t> _partition_ids;
 
@@ -113,8 +152,21 @@ Status TabletsChannel::open(const PTabletWriterOpenRequest& params) {
 
     _num_remaining_senders = params.num_senders();
     _next_seqs.resize(_num_remaining_senders, 0);
+    _sender_locks = std::vector<std::mutex>(_num_remaining_senders);
+    _sender_conds = std::vector<std::condition_variable>(_num_remaining_senders);
+    _sender_failed.resize(_num_remaining_senders, false);
     _closed_senders.Reset(_num_remaining_senders);
 
+    for (auto& replica : params.forward_replicas()) {
+        auto stub = _exec_env->brpc_stub_cache()->get_stub(replica.host(), replica.brpc_port());
+        if (stub == nullptr) {
+            LOG(WARNING) << "Get rpc stub failed, host=" << replica.host()
+                << ", port=" << replica.brpc_port();
+            return Status("get rpc stub failed");
+        }
+        _forward_stubs[replica.tablet_id()].push_back(stub);
+    }
+
     RETURN_IF_ERROR(_open_all_writers(params));
     
     _opened = true;
@@ -123,44 +175,190 @@ Status TabletsChannel::open(const PTabletWriterOpenRequest& params) {
 }
 
 Status TabletsChannel::add_batch(const PTabletWriterAddBatchRequest& params) {
-    DCHECK(params.tablet_ids_size() == params.row_batch().num_rows());
-    std::lock_guard<std::mutex> l(_lock);
-    DCHECK(_opened);
-    auto next_seq = _next_seqs[params.sender_id()];
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        DCHECK(_opened);
+    }
+    if (params.forwarded()) {
+        // the primary replica forwards the rows of a tablet in order and waits
+        // for each packet. the sender lock is not taken, the primary may hold
+        // the one of its own channel which waits for this backend to forward
+        RETURN_IF_ERROR(_write_batch(params));
+        std::lock_guard<std::mutex> l(_lock);
+        _last_updated_time = time(nullptr);
+        return Status::OK;
+    }
+    int sender_id = params.sender_id();
+    std::unique_lock<std::mutex> sender_lock(_sender_locks[sender_id]);
+    bool ready = _sender_conds[sender_id].wait_for(
+        sender_lock, std::chrono::seconds(config::streaming_load_rpc_max_alive_time_sec),
+        [this, sender_id, &params] {
+            return _sender_failed[sender_id] || params.packet_seq() <= _next_seqs[sender_id];
+        });
+    auto next_seq = _next_seqs[sender_id];
+    if (_sender_failed[sender_id]) {
+        LOG(WARNING) << "packet before failed, expect_seq=" << next_seq
+            << ", recept_seq=" << params.packet_seq();
+        return Status("packet before failed");
+    }
     // check packet
     if (params.packet_seq() < next_seq) {
         LOG(INFO) << "packet has already recept before, expect_seq=" << next_seq
             << ", recept_seq=" << params.packet_seq();
         return Status::OK;
-    } else if (params.packet_seq() > next_seq) {
+    } else if (!ready) {
         LOG(WARNING) << "lost data packet, expect_seq=" << next_seq
             << ", recept_seq=" << params.packet_seq();
         return Status("lost data packet");
     }
 
-    RowBatch row_batch(*_row_desc, params.row_batch(), &_mem_tracker);
+    auto st = _write_batch(params);
+    if (st.ok()) {
+        _next_seqs[sender_id]++;
+    } else {
+        _sender_failed[sender_id] = true;
+    }
+    _sender_conds[sender_id].notify_all();
+    RETURN_IF_ERROR(st);
+    std::lock_guard<std::mutex> l(_lock);
+    _last_updated_time = time(nullptr);
+    return Status::OK;
+}
+
+Status TabletsChannel::_write_batch(const PTabletWriterAddBatchRequest& params) {
+    // tuples are valid until the end of this function, memtables copy them
+    std::vector<Tuple*> tuples;
+    std::unique_ptr<RowBatch> row_batch;
+    MemPool pool(&_mem_tracker);
+    if (params.has_columnar_batch()) {
+        ColumnarRowBatch columnar_batch(*_tuple_desc);
+        RETURN_IF_ERROR(columnar_batch.deserialize(params.columnar_batch(), &pool, &tuples));
+    } else {
+        row_batch.reset(new RowBatch(*_row_desc, params.row_batch(), &_mem_tracker));
+        tuples.reserve(row_batch->num_rows());
+        for (int i = 0; i < row_batch->num_rows(); ++i) {
+            tuples.push_back(row_batch->get_row(i)->get_tuple(0));
+        }
+    }
+    DCHECK(params.tablet_ids_size() == tuples.size());
+
+    // the replicas write the rows while this backend does
+    std::vector<RefCountClosure<PTabletWriterAddBatchResult>*> forward_closures;
+    if (!_forward_stubs.empty() && !params.forwarded()) {
+        _forward_batch(params, tuples, &forward_closures);
+    }
+    Status st = _write_local_batch(params, tuples);
+    Status forward_st = _wait_forwarded(forward_closures);
+    RETURN_IF_ERROR(st);
+    return forward_st;
+}
 
-    // iterator all data
+Status TabletsChannel::_write_local_batch(const PTabletWriterAddBatchRequest& params,
+                                          const std::vector<Tuple*>& tuples) {
+    // rows of a tablet are written together in the order they are sent
+    std::unordered_map<int64_t, size_t> writer_idx;
+    std::vector<std::pair<DeltaWriter*, std::vector<Tuple*>>> writer_tuples;
     for (int i = 0; i < params.tablet_ids_size(); ++i) {
         auto tablet_id = params.tablet_ids(i);
-        auto it = _tablet_writers.find(tablet_id);
-        if (it == std::end(_tablet_writers)) {
-            std::stringstream ss;
-            ss << "unknown tablet to append data, tablet=" << tablet_id;
-            return Status(ss.str());
+        auto idx = writer_idx.find(tablet_id);
+        if (idx == std::end(writer_idx)) {
+            auto it = _tablet_writers.find(tablet_id);
+            if (it == std::end(_tablet_writers)) {
+                std::stringstream ss;
+                ss << "unknown tablet to append data, tablet=" << tablet_id;
+                return Status(ss.str());
+            }
+            idx = writer_idx.emplace(tablet_id, writer_tuples.size()).first;
+            writer_tuples.emplace_back(it->second, std::vector<Tuple*>());
         }
-        auto st = it->second->write(row_batch.get_row(i)->get_tuple(0));
+        writer_tuples[idx->second].second.push_back(tuples[i]);
+    }
+    for (auto& it : writer_tuples) {
+        auto st = it.first->write_batch(it.second, params.sender_id());
         if (st != OLAP_SUCCESS) {
-            LOG(WARNING) << "tablet writer writer failed, tablet_id=" << it->first
+            LOG(WARNING) << "tablet writer writer failed, tablet_id=" << it.first->tablet_id()
                 << ", transaction_id=" << _txn_id;
             return Status("tablet writer write failed");
         }
     }
-    _next_seqs[params.sender_id()]++;
-    _last_updated_time = time(nullptr);
     return Status::OK;
 }
 
+void TabletsChannel::_forward_batch(
+        const PTabletWriterAddBatchRequest& params, const std::vector<Tuple*>& tuples,
+        std::vector<RefCountClosure<PTabletWriterAddBatchResult>*>* closures) {
+    std::unordered_map<palo::PInternalService_Stub*, size_t> request_idx;
+    std::vector<std::pair<palo::PInternalService_Stub*, PTabletWriterAddBatchRequest>> requests;
+    std::vector<std::unique_ptr<RowBatch>> batches;
+    for (int i = 0; i < params.tablet_ids_size(); ++i) {
+        auto it = _forward_stubs.find(params.tablet_ids(i));
+        if (it == std::end(_forward_stubs)) {
+            continue;
+        }
+        for (auto stub : it->second) {
+            auto idx = request_idx.find(stub);
+            if (idx == std::end(request_idx)) {
+                idx = request_idx.emplace(stub, requests.size()).first;
+                requests.emplace_back(stub, PTabletWriterAddBatchRequest());
+                batches.emplace_back(new RowBatch(*_row_desc, tuples.size(), &_mem_tracker));
+            }
+            auto& request = requests[idx->second].second;
+            RowBatch* batch = batches[idx->second].get();
+            int row_no = batch->add_row();
+            batch->get_row(row_no)->set_tuple(0, tuples[i]);
+            batch->commit_last_row();
+            request.add_tablet_ids(params.tablet_ids(i));
+        }
+    }
+    for (int i = 0; i < requests.size(); ++i) {
+        auto& request = requests[i].second;
+        request.mutable_id()->CopyFrom(params.id());
+        request.set_index_id(params.index_id());
+        request.set_sender_id(params.sender_id());
+        request.set_packet_seq(params.packet_seq());
+        request.set_forwarded(true);
+        if (params.has_trace_context()) {
+            request.mutable_trace_context()->CopyFrom(params.trace_context());
+        }
+        batches[i]->serialize(request.mutable_row_batch());
+
+        auto closure = new RefCountClosure<PTabletWriterAddBatchResult>();
+        closure->ref();
+        // This ref is for RPC's reference
+        closure->ref();
+        closure->cntl.set_timeout_ms(config::streaming_load_rpc_max_alive_time_sec * 1000);
+        requests[i].first->tablet_writer_add_batch(
+            &closure->cntl, &request, &closure->result, closure);
+        closures->push_back(closure);
+    }
+}
+
+Status TabletsChannel::_wait_forwarded(
+        const std::vector<RefCountClosure<PTabletWriterAddBatchResult>*>& closures) {
+    Status status;
+    for (auto closure : closures) {
+        closure->join();
+        if (closure->cntl.Failed()) {
+            LOG(WARNING) << "failed to forward batch, error="
+                << berror(closure->cntl.ErrorCode())
+                << ", error_text=" << closure->cntl.ErrorText()
+                << ", transaction_id=" << _txn_id;
+            status = Status("failed to forward batch");
+        } else {
+            Status st(closure->result.status());
+            if (!st.ok()) {
+                LOG(WARNING) << "replica failed to write forwarded batch, transaction_id="
+                    << _txn_id << ", errmsg=" << st.get_error_msg();
+                status = st;
+            }
+        }
+        if (closure->unref()) {
+            delete closure;
+        }
+    }
+    return status;
+}
+
 Status TabletsChannel::close(int sender_id, bool* finished,
         const google::protobuf::RepeatedField<int64_t>& partition_ids,
         google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
@@ -199,6 +397,16 @@ Status TabletsChannel::close(int sender_id, bool* finished,
     return Status::OK;
 }
 
+void TabletsChannel::get_writers(std::vector<DeltaWriter*>* writers) {
+    std::unique_lock<std::mutex> l(_lock, std::try_to_lock);
+    if (!l.owns_lock() || !_opened || _num_remaining_senders == 0) {
+        return;
+    }
+    for (auto& it : _tablet_writers) {
+        writers->push_back(it.second);
+    }
+}
+
 Status TabletsChannel::_open_all_writers(const PTabletWriterOpenRequest& params) {
     std::vector<SlotDescriptor*>* columns = nullptr;
     int32_t schema_hash = 0;
@@ -224,6 +432,9 @@ Status TabletsChannel::_open_all_writers(const PTabletWriterOpenRequest& params)
         request.load_id = params.id();
         request.need_gen_rollup = params.need_gen_rollup();
         request.tuple_desc = _tuple_desc;
+        if (params.has_trace_context()) {
+            request.trace_context = TraceContext::from_proto(params.trace_context());
+        }
 
         DeltaWriter* writer = nullptr;
         auto st = DeltaWriter::open(&request, &writer);
@@ -240,7 +451,8 @@ Status TabletsChannel::_open_all_writers(const PTabletWriterOpenRequest& params)
     return Status::OK;
 }
 
-TabletWriterMgr::TabletWriterMgr(ExecEnv* exec_env) :_exec_env(exec_env) {
+TabletWriterMgr::TabletWriterMgr(ExecEnv* exec_env)
+        : _exec_env(exec_env), _lock(LockStats::get("tablet_writer_mgr")) {
     _tablets_channels.init(2011);
     _lastest_success_channel = new_lru_cache(1024);
 }
@@ -253,13 +465,13 @@ Status TabletWriterMgr::open(const PTabletWriterOpenRequest& params) {
     TabletsChannelKey key(params.id(), params.index_id());
     std::shared_ptr<TabletsChannel> channel;
     {
-        std::lock_guard<std::mutex> l(_lock);
+        std::lock_guard<InstrumentedMutex> l(_lock);
         auto val = _tablets_channels.seek(key);
         if (val != nullptr) {
             channel = *val;
         } else {
             // create a new 
-            channel.reset(new TabletsChannel(key));
+            channel.reset(new TabletsChannel(_exec_env, key));
             _tablets_channels.insert(key, channel);
         }
     }
@@ -276,7 +488,7 @@ Status TabletWriterMgr::add_batch(
     TabletsChannelKey key(request.id(), request.index_id());
     std::shared_ptr<TabletsChannel> channel;
     {
-        std::lock_guard<std::mutex> l(_lock);
+        std::lock_guard<InstrumentedMutex> l(_lock);
         auto value = _tablets_channels.seek(key);
         if (value == nullptr) {
             auto handle = _lastest_success_channel->lookup(key.to_string());
@@ -291,8 +503,9 @@ Status TabletWriterMgr::add_batch(
         }
         channel = *value;
     }
-    if (request.has_row_batch()) {
+    if (request.has_row_batch() || request.has_columnar_batch()) {
         RETURN_IF_ERROR(channel->add_batch(request));
+        _handle_mem_usage();
     }
     Status st;
     if (request.has_eos() && request.eos()) {
@@ -304,7 +517,7 @@ Status TabletWriterMgr::add_batch(
                 << ", err_msg=" << st.get_error_msg();
         }
         if (finished) {
-            std::lock_guard<std::mutex> l(_lock);
+            std::lock_guard<InstrumentedMutex> l(_lock);
             _tablets_channels.erase(key);
             if (st.ok()) {
                 auto handle = _lastest_success_channel->insert(
@@ -316,10 +529,80 @@ Status TabletWriterMgr::add_batch(
     return st;
 }
 
+void TabletWriterMgr::_handle_mem_usage() {
+    // the memtables are checked by one thread at a time, the others go on
+    std::unique_lock<std::mutex> check_lock(_mem_usage_lock, std::try_to_lock);
+    if (!check_lock.owns_lock()) {
+        return;
+    }
+    std::vector<std::shared_ptr<TabletsChannel>> channels;
+    {
+        std::lock_guard<InstrumentedMutex> l(_lock);
+        for (auto& kv : _tablets_channels) {
+            channels.push_back(kv.second);
+        }
+    }
+    std::vector<DeltaWriter*> writers;
+    for (auto& channel : channels) {
+        channel->get_writers(&writers);
+    }
+    if (writers.empty()) {
+        return;
+    }
+
+    // the memory is shared by all the tablets being loaded, memtables of a
+    // load into few tablets grow larger and make fewer segments
+    int64_t limit = config::load_memtable_memory_limit;
+    int64_t max_mem_table_size = config::write_buffer_size;
+    if (limit > 0) {
+        max_mem_table_size = std::max(max_mem_table_size, std::min(
+                (int64_t) config::max_write_buffer_size, limit / (int64_t) writers.size()));
+    }
+    int64_t total_usage = 0;
+    std::vector<std::pair<int64_t, DeltaWriter*>> usages;
+    for (auto writer : writers) {
+        writer->set_max_mem_table_size(max_mem_table_size);
+        int64_t usage = writer->mem_usage();
+        if (usage > 0) {
+            total_usage += usage;
+            usages.emplace_back(usage, writer);
+        }
+    }
+    if (limit < 0 || total_usage <= limit) {
+        return;
+    }
+
+    // flush the largest memtables first, they free the most memory for the
+    // segments they make, until the usage is some way below the limit so
+    // that the next batches do not flush again at once
+    std::sort(usages.begin(), usages.end(),
+              [] (const std::pair<int64_t, DeltaWriter*>& lhs,
+                  const std::pair<int64_t, DeltaWriter*>& rhs) {
+                  return lhs.first > rhs.first;
+              });
+    int64_t target_usage = limit / 10 * 8;
+    int num_flushed = 0;
+    for (auto& it : usages) {
+        if (total_usage <= target_usage) {
+            break;
+        }
+        auto st = it.second->flush_mem_table();
+        if (st != OLAP_SUCCESS) {
+            // the load of the writer fails when it closes
+            LOG(WARNING) << "fail to flush memtable, tablet_id=" << it.second->tablet_id()
+                << ", status=" << st;
+        }
+        total_usage -= it.first;
+        ++num_flushed;
+    }
+    VLOG(1) << "memtables exceed load memory limit, flushed " << num_flushed
+        << " of " << usages.size() << " memtables, limit=" << limit;
+}
+
 Status TabletWriterMgr::cancel(const PTabletWriterCancelRequest& params) {
     TabletsChannelKey key(params.id(), params.index_id());
     {
-        std::lock_guard<std::mutex> l(_lock);
+        std::lock_guard<InstrumentedMutex> l(_lock);
         _tablets_channels.erase(key);
     }
     return Status::OK;
@@ -346,7 +629,7 @@ Status TabletWriterMgr::_start_tablets_channel_clean() {
     const int32_t max_alive_time = config::streaming_load_rpc_max_alive_time_sec;
     time_t now = time(nullptr);
     {
-        std::lock_guard<std::mutex> l(_lock);
+        std::lock_guard<InstrumentedMutex> l(_lock);
         std::vector<TabletsChannelKey> need_delete_keys;
 
         for (auto& kv : _tablets_channels) {
@@ -30,6 +30,7 @@
 #include "gen_cpp/PaloInternalService_types.h"
 #include "gen_cpp/internal_service.pb.h"
 #include "util/hash_util.hpp"
+#include "util/lock_stats.h"
 #include "util/uid_util.h"
 
 #include "service/brpc.h"
@@ -87,7 +88,7 @@ public:
 private:
     ExecEnv* _exec_env;
     // lock protect the channel map
-    std::mutex _lock;
+    InstrumentedMutex _lock;
 
     // A map from load_id|index_id to load channel
     butil::FlatMap<
@@ -101,6 +102,11 @@ private:
     std::thread _tablets_channel_clean_thread;
 
     Status _start_tablets_channel_clean();
+
+    // Sets the size at which memtables of all loads are flushed, and flushes
+    // the largest ones once they use more than config::load_memtable_memory_limit
+    void _handle_mem_usage();
+    std::mutex _mem_usage_lock;
 };
 
 std::ostream& operator<<(std::ostream& os, const TabletsChannelKey&);
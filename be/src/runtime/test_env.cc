@@ -16,6 +16,8 @@
 // under the License.
 
 #include "runtime/test_env.h"
+
+#include "common/config.h"
 #include "util/disk_info.h"
 #include "util/doris_metrics.h"
 
@@ -25,19 +27,35 @@ namespace doris {
 
 boost::scoped_ptr<MetricRegistry> TestEnv::_s_static_metrics;
 
+// bytes of the buffer pool of the queries of the tests
+static const int64_t BUFFER_POOL_CAPACITY = 1024L * 1024 * 1024;
+
 TestEnv::TestEnv() {
     if (_s_static_metrics == NULL) {
         _s_static_metrics.reset(new MetricRegistry("test_env"));
         // DorisMetrics::create_metrics(_s_static_metrics.get());
     }
-    _exec_env.reset(new ExecEnv());
-    // _exec_env->init_for_tests();
+    _exec_env = ExecEnv::GetInstance();
+    DCHECK(_exec_env->_thread_mgr == nullptr) << "only one TestEnv may live at a time";
+    _thread_mgr.reset(new ThreadResourceMgr());
+    _exec_env->_thread_mgr = _thread_mgr.get();
+    _process_mem_tracker.reset(new MemTracker(-1));
+    _exec_env->_mem_tracker = _process_mem_tracker.get();
+    _buffer_pool.reset(new BufferPool(config::min_buffer_size, BUFFER_POOL_CAPACITY, 0));
+    _exec_env->_buffer_pool = _buffer_pool.get();
+    _buffer_reservation.reset(new ReservationTracker());
+    _buffer_reservation->InitRootTracker(nullptr, BUFFER_POOL_CAPACITY);
+    _exec_env->_buffer_reservation = _buffer_reservation.get();
+
     _io_mgr_tracker.reset(new MemTracker(-1));
     _block_mgr_parent_tracker.reset(new MemTracker(-1));
+    _disk_io_mgr.reset(new DiskIoMgr());
+    _exec_env->_disk_io_mgr = _disk_io_mgr.get();
     _exec_env->disk_io_mgr()->init(_io_mgr_tracker.get());
     init_metrics();
     _tmp_file_mgr.reset(new TmpFileMgr());
     _tmp_file_mgr->init(_metrics.get());
+    _exec_env->_tmp_file_mgr = _tmp_file_mgr.get();
 }
 
 void TestEnv::init_metrics() {
@@ -50,13 +68,25 @@ void TestEnv::init_tmp_file_mgr(const std::vector<std::string>& tmp_dirs,
     init_metrics();
     _tmp_file_mgr.reset(new TmpFileMgr());
     _tmp_file_mgr->init_custom(tmp_dirs, one_dir_per_device, _metrics.get());
+    _exec_env->_tmp_file_mgr = _tmp_file_mgr.get();
 }
 
 TestEnv::~TestEnv() {
     // Queries must be torn down first since they are dependent on global state.
     tear_down_query_states();
     _block_mgr_parent_tracker.reset();
-    _exec_env.reset();
+    _exec_env->_tmp_file_mgr = nullptr;
+    _exec_env->_disk_io_mgr = nullptr;
+    _exec_env->_buffer_reservation = nullptr;
+    _exec_env->_buffer_pool = nullptr;
+    _exec_env->_mem_tracker = nullptr;
+    _exec_env->_thread_mgr = nullptr;
+    _disk_io_mgr.reset();
+    _buffer_reservation->Close();
+    _buffer_reservation.reset();
+    _buffer_pool.reset();
+    _process_mem_tracker.reset();
+    _thread_mgr.reset();
     _io_mgr_tracker.reset();
     _tmp_file_mgr.reset();
     _metrics.reset();
@@ -66,7 +96,7 @@ RuntimeState* TestEnv::create_runtime_state(int64_t query_id) {
     TExecPlanFragmentParams plan_params = TExecPlanFragmentParams();
     plan_params.params.query_id.hi = 0;
     plan_params.params.query_id.lo = query_id;
-    return new RuntimeState(plan_params, TQueryOptions(), "", _exec_env.get());
+    return new RuntimeState(plan_params, TQueryOptions(), "", _exec_env);
 }
 
 Status TestEnv::create_query_state(int64_t query_id, int max_buffers, int block_size,
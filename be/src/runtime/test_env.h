@@ -19,9 +19,12 @@
 #define DORIS_BE_TEST_QUERY_RUNTIME_TEST_ENV_H
 
 #include "runtime/buffered_block_mgr2.h"
+#include "runtime/bufferpool/buffer_pool.h"
+#include "runtime/bufferpool/reservation_tracker.h"
 #include "runtime/disk_io_mgr.h"
 #include "runtime/exec_env.h"
 #include "runtime/runtime_state.h"
+#include "runtime/thread_resource_mgr.h"
 
 namespace doris {
 
@@ -54,7 +57,7 @@ public:
     int64_t calculate_mem_tracker(int max_buffers, int block_size);
 
     ExecEnv* exec_env() {
-        return _exec_env.get();
+        return _exec_env;
     }
     MemTracker* block_mgr_parent_tracker() {
         return _block_mgr_parent_tracker.get();
@@ -79,7 +82,14 @@ private:
 
     // Global state for test environment.
     static boost::scoped_ptr<MetricRegistry> _s_static_metrics;
-    boost::scoped_ptr<ExecEnv> _exec_env;
+    // The global ExecEnv, which the runtime states and the buffer pool use. The
+    // members it needs for queries are set to the ones below while the TestEnv lives.
+    ExecEnv* _exec_env;
+    boost::scoped_ptr<ThreadResourceMgr> _thread_mgr;
+    boost::scoped_ptr<MemTracker> _process_mem_tracker;
+    boost::scoped_ptr<DiskIoMgr> _disk_io_mgr;
+    boost::scoped_ptr<BufferPool> _buffer_pool;
+    boost::scoped_ptr<ReservationTracker> _buffer_reservation;
     boost::scoped_ptr<MemTracker> _block_mgr_parent_tracker;
     boost::scoped_ptr<MemTracker> _io_mgr_tracker;
     boost::scoped_ptr<MetricRegistry> _metrics;
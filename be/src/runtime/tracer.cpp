@@ -0,0 +1,327 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/tracer.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include <chrono>
+#include <random>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "gen_cpp/Types_types.h"
+#include "gen_cpp/types.pb.h"
+#include "http/http_client.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "util/doris_metrics.h"
+#include "util/hash_util.hpp"
+#include "util/time.h"
+
+namespace doris {
+
+void TraceContext::to_thrift(TTraceContext* context) const {
+    context->trace_id_hi = trace_id_hi;
+    context->trace_id_lo = trace_id_lo;
+    context->span_id = span_id;
+}
+
+void TraceContext::to_proto(PTraceContext* context) const {
+    context->set_trace_id_hi(trace_id_hi);
+    context->set_trace_id_lo(trace_id_lo);
+    context->set_span_id(span_id);
+}
+
+TraceContext TraceContext::from_thrift(const TTraceContext& context) {
+    TraceContext trace;
+    trace.trace_id_hi = context.trace_id_hi;
+    trace.trace_id_lo = context.trace_id_lo;
+    trace.span_id = context.span_id;
+    trace.sampled = true;
+    return trace;
+}
+
+TraceContext TraceContext::from_proto(const PTraceContext& context) {
+    TraceContext trace;
+    trace.trace_id_hi = context.trace_id_hi();
+    trace.trace_id_lo = context.trace_id_lo();
+    trace.span_id = context.span_id();
+    trace.sampled = true;
+    return trace;
+}
+
+Span::Span(const TraceContext& parent, const char* name, int64_t start_ns) {
+    if (!parent.sampled) {
+        return;
+    }
+    _context = parent;
+    _context.span_id = Tracer::new_span_id();
+    _data.reset(new SpanData());
+    _data->context = _context;
+    _data->parent_span_id = parent.span_id;
+    _data->name = name;
+    _data->start_ns = start_ns != 0 ? start_ns : Tracer::now_ns();
+}
+
+void Span::add_attribute(const char* key, int64_t value) {
+    if (_data == nullptr) {
+        return;
+    }
+    _data->attributes.push_back({key, true, value, ""});
+}
+
+void Span::add_attribute(const char* key, const std::string& value) {
+    if (_data == nullptr) {
+        return;
+    }
+    _data->attributes.push_back({key, false, 0, value});
+}
+
+void Span::set_status(const Status& status) {
+    if (_data == nullptr || status.ok()) {
+        return;
+    }
+    _data->error_msg = status.get_error_msg();
+}
+
+void Span::end(int64_t end_ns) {
+    if (_data == nullptr) {
+        return;
+    }
+    _data->end_ns = end_ns != 0 ? end_ns : Tracer::now_ns();
+    // a span ended from a latency measured elsewhere must not end before it starts
+    if (_data->end_ns < _data->start_ns) {
+        _data->end_ns = _data->start_ns;
+    }
+    Tracer::instance()->record(std::move(_data));
+}
+
+Tracer* Tracer::instance() {
+    static Tracer tracer;
+    return &tracer;
+}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+TraceContext Tracer::trace_context(int64_t hi, int64_t lo) const {
+    TraceContext trace;
+    trace.trace_id_hi = hi;
+    trace.trace_id_lo = lo;
+    double ratio = config::trace_sample_ratio;
+    if (ratio <= 0) {
+        return trace;
+    }
+    uint64_t hash = HashUtil::murmur_hash64A(&hi, sizeof(hi), 0);
+    hash = HashUtil::murmur_hash64A(&lo, sizeof(lo), hash);
+    // the top 53 bits of the hash as a double in [0, 1)
+    trace.sampled = ratio >= 1 || (hash >> 11) * (1.0 / (1ull << 53)) < ratio;
+    return trace;
+}
+
+TraceContext Tracer::trace_context(const TUniqueId& id) const {
+    return trace_context(id.hi, id.lo);
+}
+
+void Tracer::record(std::unique_ptr<SpanData> span) {
+    DorisMetrics::trace_spans_total.increment(1);
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (!config::trace_export_url.empty()
+                && _spans.size() < static_cast<size_t>(config::trace_max_buffered_spans)) {
+            _spans.push_back(std::move(span));
+            return;
+        }
+    }
+    DorisMetrics::trace_spans_dropped_total.increment(1);
+}
+
+Status Tracer::start_bg_worker() {
+    _export_thread = std::thread(
+        [this] {
+            std::unique_lock<std::mutex> l(_lock);
+            while (!_stopped) {
+                _cv.wait_for(l, std::chrono::milliseconds(config::trace_export_interval_ms));
+                l.unlock();
+                _export_spans();
+                l.lock();
+            }
+        });
+    return Status::OK;
+}
+
+void Tracer::stop() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _stopped = true;
+    }
+    _cv.notify_all();
+    if (_export_thread.joinable()) {
+        _export_thread.join();
+        // the spans ended since the last export
+        _export_spans();
+    }
+}
+
+void Tracer::take_spans(std::vector<std::unique_ptr<SpanData>>* spans) {
+    std::lock_guard<std::mutex> l(_lock);
+    spans->swap(_spans);
+    _spans.clear();
+}
+
+void Tracer::_export_spans() {
+    std::vector<std::unique_ptr<SpanData>> spans;
+    take_spans(&spans);
+    if (spans.empty()) {
+        return;
+    }
+    std::string payload = to_otlp_json(spans);
+    HttpClient client;
+    Status status = client.init(config::trace_export_url);
+    if (status.ok()) {
+        client.set_content_type("application/json");
+        client.set_timeout_ms(config::trace_export_interval_ms);
+        std::string response;
+        status = client.execute_post_request(payload, &response);
+    }
+    if (!status.ok()) {
+        // the spans are not retried, tracing must not hold up the backend
+        LOG(WARNING) << "fail to export " << spans.size() << " spans to "
+            << config::trace_export_url << ", error=" << status.get_error_msg();
+        DorisMetrics::trace_spans_dropped_total.increment(spans.size());
+    }
+}
+
+static std::string to_hex(uint64_t value) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016lx", value);
+    return buf;
+}
+
+std::string Tracer::to_otlp_json(const std::vector<std::unique_ptr<SpanData>>& spans) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("resourceSpans");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("resource");
+    writer.StartObject();
+    writer.Key("attributes");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("key");
+    writer.String("service.name");
+    writer.Key("value");
+    writer.StartObject();
+    writer.Key("stringValue");
+    writer.String("doris-be");
+    writer.EndObject();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+    writer.Key("scopeSpans");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("scope");
+    writer.StartObject();
+    writer.Key("name");
+    writer.String("doris");
+    writer.EndObject();
+    writer.Key("spans");
+    writer.StartArray();
+    for (auto& span : spans) {
+        const TraceContext& context = span->context;
+        writer.StartObject();
+        writer.Key("traceId");
+        writer.String((to_hex(context.trace_id_hi) + to_hex(context.trace_id_lo)).c_str());
+        writer.Key("spanId");
+        writer.String(to_hex(context.span_id).c_str());
+        if (span->parent_span_id != 0) {
+            writer.Key("parentSpanId");
+            writer.String(to_hex(span->parent_span_id).c_str());
+        }
+        writer.Key("name");
+        writer.String(span->name.c_str());
+        // SPAN_KIND_INTERNAL
+        writer.Key("kind");
+        writer.Int(1);
+        // 64 bit integers are strings in the JSON encoding of OTLP
+        writer.Key("startTimeUnixNano");
+        writer.String(std::to_string(span->start_ns).c_str());
+        writer.Key("endTimeUnixNano");
+        writer.String(std::to_string(span->end_ns).c_str());
+        writer.Key("attributes");
+        writer.StartArray();
+        for (auto& attribute : span->attributes) {
+            writer.StartObject();
+            writer.Key("key");
+            writer.String(attribute.key.c_str());
+            writer.Key("value");
+            writer.StartObject();
+            if (attribute.is_int) {
+                writer.Key("intValue");
+                writer.String(std::to_string(attribute.int_value).c_str());
+            } else {
+                writer.Key("stringValue");
+                writer.String(attribute.string_value.c_str());
+            }
+            writer.EndObject();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        if (!span->error_msg.empty()) {
+            writer.Key("status");
+            writer.StartObject();
+            // STATUS_CODE_ERROR
+            writer.Key("code");
+            writer.Int(2);
+            writer.Key("message");
+            writer.String(span->error_msg.c_str());
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+    return buffer.GetString();
+}
+
+int64_t Tracer::now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * NANOS_PER_SEC + ts.tv_nsec;
+}
+
+int64_t Tracer::new_span_id() {
+    static thread_local std::mt19937_64 generator(std::random_device{}());
+    int64_t id = 0;
+    while (id == 0) {
+        id = generator();
+    }
+    return id;
+}
+
+}
@@ -0,0 +1,163 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_RUNTIME_TRACER_H
+#define DORIS_BE_SRC_RUNTIME_TRACER_H
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/status.h"
+#include "gutil/macros.h"
+
+namespace doris {
+
+class PTraceContext;
+class TTraceContext;
+class TUniqueId;
+
+// Identifies a span of a trace. Spans are only recorded for sampled traces, a
+// default constructed context is not sampled.
+struct TraceContext {
+    int64_t trace_id_hi = 0;
+    int64_t trace_id_lo = 0;
+    // 0 for the root of a trace
+    int64_t span_id = 0;
+    bool sampled = false;
+
+    void to_thrift(TTraceContext* context) const;
+    void to_proto(PTraceContext* context) const;
+
+    // Contexts are only sent for sampled traces
+    static TraceContext from_thrift(const TTraceContext& context);
+    static TraceContext from_proto(const PTraceContext& context);
+};
+
+// A finished span.
+struct SpanData {
+    struct Attribute {
+        std::string key;
+        bool is_int;
+        int64_t int_value;
+        std::string string_value;
+    };
+
+    TraceContext context;
+    int64_t parent_span_id = 0;
+    std::string name;
+    // nanoseconds since the Epoch
+    int64_t start_ns = 0;
+    int64_t end_ns = 0;
+    std::vector<Attribute> attributes;
+    // empty if the span succeeded
+    std::string error_msg;
+};
+
+// A timed step of a trace, recorded when it is ended or destroyed. It does nothing
+// if its parent is not sampled, so spans can be put on the paths of all queries.
+class Span {
+public:
+    // Starts a child of 'parent' at 'start_ns', nanoseconds since the Epoch, or now
+    // if it is 0.
+    Span(const TraceContext& parent, const char* name, int64_t start_ns = 0);
+
+    ~Span() {
+        end();
+    }
+
+    bool sampled() const {
+        return _data != nullptr;
+    }
+
+    // The parent of the children of this span, not sampled if this span is not.
+    const TraceContext& context() const {
+        return _context;
+    }
+
+    void add_attribute(const char* key, int64_t value);
+    void add_attribute(const char* key, const std::string& value);
+
+    // Marks the span failed if 'status' is not ok.
+    void set_status(const Status& status);
+
+    // Ends the span at 'end_ns', or now if it is 0. Does nothing if it has ended.
+    void end(int64_t end_ns = 0);
+
+private:
+    TraceContext _context;
+    std::unique_ptr<SpanData> _data;
+
+    DISALLOW_COPY_AND_ASSIGN(Span);
+};
+
+// Samples traces and exports their spans. The finished spans are buffered and sent
+// in batches by a background thread to 'trace_export_url', an OTLP/HTTP endpoint,
+// in the JSON encoding of OTLP.
+class Tracer {
+public:
+    static Tracer* instance();
+
+    ~Tracer();
+
+    // Returns the root context of the trace of the query, load or transaction with
+    // the id 'hi', 'lo', which is the trace id. Whether it is sampled only depends on
+    // the id and 'trace_sample_ratio', so all backends sample the same traces.
+    TraceContext trace_context(int64_t hi, int64_t lo) const;
+    TraceContext trace_context(const TUniqueId& id) const;
+
+    // Buffers the finished 'span' for the export, it is dropped if
+    // 'trace_max_buffered_spans' spans wait already.
+    void record(std::unique_ptr<SpanData> span);
+
+    Status start_bg_worker();
+
+    // Stops the background thread after it exported the buffered spans.
+    void stop();
+
+    // Takes the buffered spans, used by tests.
+    void take_spans(std::vector<std::unique_ptr<SpanData>>* spans);
+
+    static std::string to_otlp_json(const std::vector<std::unique_ptr<SpanData>>& spans);
+
+    // nanoseconds since the Epoch
+    static int64_t now_ns();
+
+    // a random id which is not 0
+    static int64_t new_span_id();
+
+private:
+    Tracer() { }
+
+    void _export_spans();
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+    bool _stopped = false;
+    std::vector<std::unique_ptr<SpanData>> _spans;
+    std::thread _export_thread;
+};
+
+}
+
+#endif
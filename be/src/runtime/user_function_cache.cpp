@@ -24,6 +24,7 @@
 #include <boost/algorithm/string/predicate.hpp> // boost::algorithm::ends_with
 #include <boost/algorithm/string/classification.hpp> // boost::is_any_of
 
+#include "common/config.h"
 #include "http/http_client.h"
 #include "util/dynamic_util.h"
 #include "util/file_utils.h"
@@ -119,9 +120,33 @@ Status UserFunctionCache::init(const std::string& lib_dir) {
     RETURN_IF_ERROR(dynamic_open(nullptr, &_current_process_handle));
     // 2. load all cached 
     RETURN_IF_ERROR(_load_cached_lib());
+    // 3. open cached libraries ahead of the first query
+    if (config::preload_user_function_libs) {
+        _preload_cached_lib();
+    }
     return Status::OK;
 }
 
+void UserFunctionCache::_preload_cached_lib() {
+    std::vector<UserFunctionCacheEntry*> entries;
+    {
+        std::lock_guard<std::mutex> l(_cache_lock);
+        for (auto& it : _entry_map) {
+            it.second->ref();
+            entries.push_back(it.second);
+        }
+    }
+    for (auto entry : entries) {
+        // cached libraries are already downloaded, so no url is needed
+        auto st = _load_cache_entry("", entry);
+        if (!st.ok()) {
+            LOG(WARNING) << "fail to preload user function library, file=" << entry->lib_file
+                << ", error=" << st.get_error_msg();
+        }
+        release_entry(entry);
+    }
+}
+
 Status UserFunctionCache::_load_entry_from_lib(const std::string& dir, const std::string& file) {
     if (!boost::algorithm::ends_with(file, ".so")) {
         return Status("unknown library file format");
@@ -179,16 +204,43 @@ std::string get_real_symbol(const std::string& symbol) {
 }
 
 Status UserFunctionCache::get_function_ptr(
+        int64_t fid,
+        const std::string& symbol,
+        const std::string& url,
+        const std::string& checksum,
+        void** fn_ptr,
+        UserFunctionCacheEntry** output_entry) {
+    return _get_function_ptr(fid, symbol, url, checksum, false, fn_ptr, output_entry);
+}
+
+Status UserFunctionCache::get_optional_function_ptr(
+        int64_t fid,
+        const std::string& symbol,
+        const std::string& url,
+        const std::string& checksum,
+        void** fn_ptr,
+        UserFunctionCacheEntry** output_entry) {
+    return _get_function_ptr(fid, symbol, url, checksum, true, fn_ptr, output_entry);
+}
+
+Status UserFunctionCache::_get_function_ptr(
         int64_t fid,
         const std::string& orig_symbol,
         const std::string& url,
         const std::string& checksum,
+        bool optional,
         void** fn_ptr,
         UserFunctionCacheEntry** output_entry) {
     auto symbol = get_real_symbol(orig_symbol);
     if (fid == 0) {
         // Just loading a function ptr in the current process. No need to take any locks.
-        RETURN_IF_ERROR(dynamic_lookup(_current_process_handle, symbol.c_str(), fn_ptr));
+        auto st = dynamic_lookup(_current_process_handle, symbol.c_str(), fn_ptr);
+        if (!st.ok()) {
+            if (!optional) {
+                return st;
+            }
+            *fn_ptr = nullptr;
+        }
         return Status::OK;
     }
 
@@ -211,10 +263,18 @@ Status UserFunctionCache::get_function_ptr(
         auto it = entry->fptr_map.find(symbol);
         if (it != entry->fptr_map.end()) {
             *fn_ptr = it->second;
+            if (*fn_ptr == nullptr && !optional) {
+                status = Status("fail to lookup symbol in library, symbol=" + symbol);
+            }
         } else {
             status = dynamic_lookup(entry->lib_handle, symbol.c_str(), fn_ptr);
             if (status.ok()) {
                 entry->fptr_map.emplace(symbol, *fn_ptr);
+            } else if (optional) {
+                // remember the missing symbol, so it is looked up only once
+                *fn_ptr = nullptr;
+                entry->fptr_map.emplace(symbol, nullptr);
+                status = Status::OK;
             } else {
                 LOG(WARNING) << "fail to lookup symbol in library, symbol=" << symbol
                     << ", file=" << entry->lib_file;
@@ -291,6 +351,10 @@ Status UserFunctionCache::_load_cache_entry(
     }
 
     std::unique_lock<std::mutex> l(entry->load_lock);
+    // another thread may have loaded it while we were waiting for the lock
+    if (entry->is_loaded.load()) {
+        return Status::OK;
+    }
     if (!entry->is_downloaded) {
         RETURN_IF_ERROR(_download_lib(url, entry));
     }
@@ -66,10 +66,30 @@ public:
                            const std::string& checksum,
                            void** fn_ptr,
                            UserFunctionCacheEntry** entry);
+
+    // Same as get_function_ptr, but a symbol which is not in the library is not
+    // an error: OK is returned with *fn_ptr set to nullptr. Used to look up the
+    // optional batch version of a UDF.
+    Status get_optional_function_ptr(int64_t fid,
+                                     const std::string& symbol,
+                                     const std::string& url,
+                                     const std::string& checksum,
+                                     void** fn_ptr,
+                                     UserFunctionCacheEntry** entry);
     void release_entry(UserFunctionCacheEntry* entry);
 
 private:
+    Status _get_function_ptr(int64_t fid,
+                             const std::string& symbol,
+                             const std::string& url,
+                             const std::string& checksum,
+                             bool optional,
+                             void** fn_ptr,
+                             UserFunctionCacheEntry** entry);
     Status _load_cached_lib();
+    // open all the cached libraries, so that the first query which calls
+    // a user function doesn't pay for dlopen
+    void _preload_cached_lib();
     Status _load_entry_from_lib(const std::string& dir, const std::string& file);
     Status _get_cache_entry(
         int64_t fid, const std::string& url,
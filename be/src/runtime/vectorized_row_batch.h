@@ -22,6 +22,7 @@
 #include <memory>
 #include <vector>
 
+#include "olap/byte_buffer.h"
 #include "olap/field.h"
 #include "runtime/descriptors.h"
 #include "runtime/mem_pool.h"
@@ -63,11 +64,45 @@ public:
     }
     void set_col_data(void* data) {
         _col_data = data;
+        _col_buffer.reset();
+    }
+
+    // col_data points into buffer, e.g. a decompressed chunk of a column
+    // stream, the vector owns buffer until col_data is set again
+    void set_col_data(void* data, StorageByteBuffer* buffer) {
+        _col_data = data;
+        _col_buffer.reset(buffer);
+    }
+
+    // Set by readers of dictionary encoded string columns besides col_data:
+    // row i holds dict_values()[dict_codes()[i]]. dict_id() is unique to one
+    // dictionary, so predicates can cache their result per dictionary entry.
+    // dict_codes() is nullptr for other columns.
+    const int32_t* dict_codes() const { return _dict_codes; }
+    const Slice* dict_values() const { return _dict_values; }
+    uint32_t dict_size() const { return _dict_size; }
+    int64_t dict_id() const { return _dict_id; }
+
+    void set_dict(const int32_t* codes, const Slice* values, uint32_t size, int64_t id) {
+        _dict_codes = codes;
+        _dict_values = values;
+        _dict_size = size;
+        _dict_id = id;
+    }
+
+    void clear_dict() {
+        _dict_codes = nullptr;
     }
 private:
     void* _col_data = nullptr;
+    std::unique_ptr<StorageByteBuffer> _col_buffer;
     bool _no_nulls = false;
     bool* _is_null = nullptr;
+
+    const int32_t* _dict_codes = nullptr;
+    const Slice* _dict_values = nullptr;
+    uint32_t _dict_size = 0;
+    int64_t _dict_id = -1;
 };
 
 class VectorizedRowBatch {
@@ -127,6 +162,9 @@ public:
         _size = 0;
         _selected_in_use = false;
         _limit = _capacity;
+        for (auto column_id : _cols) {
+            _col_vectors[column_id]->clear_dict();
+        }
         _mem_pool->clear();
     }
 
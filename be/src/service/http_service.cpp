@@ -18,15 +18,18 @@
 #include "service/http_service.h"
 
 #include "http/action/checksum_action.h"
+#include "http/action/compaction_action.h"
 #include "http/action/health_action.h"
 #include "http/action/meta_action.h"
 #include "http/action/metrics_action.h"
 #include "http/action/mini_load.h"
 #include "http/action/pprof_actions.h"
+#include "http/action/query_profile_action.h"
 #include "http/action/reload_tablet_action.h"
 #include "http/action/restore_tablet_action.h"
 #include "http/action/snapshot_action.h"
 #include "http/action/stream_load.h"
+#include "http/action/tablet_heat_action.h"
 #include "http/default_path_handlers.h"
 #include "http/download_action.h"
 #include "http/ev_http_server.h"
@@ -95,6 +98,17 @@ Status HttpService::start() {
     MetaAction* meta_action = new MetaAction(HEADER);
     _ev_http_server->register_handler(HttpMethod::GET, "/api/meta/header/{tablet_id}/{schema_hash}", meta_action);
 
+    CompactionScoreAction* compaction_score_action = new CompactionScoreAction();
+    _ev_http_server->register_handler(HttpMethod::GET,
+            "/api/compaction/score/{tablet_id}/{schema_hash}", compaction_score_action);
+
+    TabletHeatAction* tablet_heat_action = new TabletHeatAction();
+    _ev_http_server->register_handler(HttpMethod::GET, "/api/tablet_heat", tablet_heat_action);
+
+    // Register the profiles of the running queries
+    QueryProfileAction* query_profile_action = new QueryProfileAction(_env);
+    _ev_http_server->register_handler(HttpMethod::GET, "/api/query_profile", query_profile_action);
+
 #ifndef BE_TEST
     // Register BE checksum action
     ChecksumAction* checksum_action = new ChecksumAction(_env);
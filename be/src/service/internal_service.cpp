@@ -17,24 +17,36 @@
 
 #include "service/internal_service.h"
 
+#include <algorithm>
+#include <sstream>
+
 #include "common/config.h"
 #include "runtime/tablet_writer_mgr.h"
 #include "gen_cpp/BackendService.h"
+#include "olap/olap_engine.h"
+#include "olap/row_lookup.h"
 #include "runtime/exec_env.h"
 #include "runtime/data_stream_mgr.h"
 #include "runtime/fragment_mgr.h"
+#include "runtime/tracer.h"
 #include "service/brpc.h"
+#include "util/doris_metrics.h"
+#include "util/time.h"
 #include "util/uid_util.h"
 #include "util/thrift_util.h"
 #include "runtime/buffer_control_block.h"
 #include "runtime/result_buffer_mgr.h"
+#include "runtime/runtime_filter_mgr.h"
 
 namespace doris {
 
 template<typename T>
 PInternalServiceImpl<T>::PInternalServiceImpl(ExecEnv* exec_env)
-        : _exec_env(exec_env),
-        _tablet_worker_pool(config::number_tablet_writer_threads, 10240) {
+        : _exec_env(exec_env) {
+    for (int i = 0; i < std::max(config::tablet_writer_pools, 1); ++i) {
+        _tablet_worker_pools.emplace_back(new ThreadPool(
+            config::number_tablet_writer_threads, config::tablet_writer_pool_queue_size));
+    }
 }
 
 template<typename T>
@@ -48,10 +60,19 @@ void PInternalServiceImpl<T>::transmit_data(google::protobuf::RpcController* cnt
                                          google::protobuf::Closure* done) {
     VLOG_ROW << "transmit data: fragment_instance_id=" << print_id(request->finst_id())
             << " node=" << request->node_id();
-    _exec_env->stream_mgr()->transmit_data(request, &done);
+    int64_t start_us = MonotonicMicros();
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(cntl_base);
+    Span span(request->has_trace_context()
+              ? TraceContext::from_proto(request->trace_context()) : TraceContext(),
+              "exchange_receive");
+    span.add_attribute("node_id", request->node_id());
+    _exec_env->stream_mgr()->transmit_data(request, &done, &cntl->request_attachment());
+    // the response is deferred while the receiver's queue is full
+    span.add_attribute("deferred", done == nullptr ? 1 : 0);
     if (done != nullptr) {
         done->Run();
     }
+    DorisMetrics::transmit_data_latency_us.add(MonotonicMicros() - start_us);
 }
 
 template<typename T>
@@ -79,12 +100,14 @@ void PInternalServiceImpl<T>::exec_plan_fragment(
         PExecPlanFragmentResult* response,
         google::protobuf::Closure* done) {
     brpc::ClosureGuard closure_guard(done);
+    int64_t start_us = MonotonicMicros();
     brpc::Controller* cntl = static_cast<brpc::Controller*>(cntl_base);
     auto st = _exec_plan_fragment(cntl);
     if (!st.ok()) {
         LOG(WARNING) << "exec plan fragment failed, errmsg=" << st.get_error_msg();
     }
     st.to_protobuf(response->mutable_status());
+    DorisMetrics::exec_plan_fragment_latency_us.add(MonotonicMicros() - start_us);
 }
 
 template<typename T>
@@ -98,10 +121,19 @@ void PInternalServiceImpl<T>::tablet_writer_add_batch(google::protobuf::RpcContr
     // add batch maybe cost a lot of time, and this callback thread will be held.
     // this will influence query execute, because of no bthread. So, we put this to 
     // a local thread pool to process
-    _tablet_worker_pool.offer(
-        [request, response, done, this] () {
+    // the time waiting for the pool is part of the latency
+    int64_t start_us = MonotonicMicros();
+    int64_t start_ns = Tracer::now_ns();
+    _tablet_worker_pool(request->id(), request->index_id())->offer(
+        [request, response, done, start_us, start_ns, this] () {
             brpc::ClosureGuard closure_guard(done);
+            Span span(request->has_trace_context()
+                      ? TraceContext::from_proto(request->trace_context()) : TraceContext(),
+                      "tablet_writer_add_batch", start_ns);
+            span.add_attribute("index_id", request->index_id());
+            span.add_attribute("queue_wait_us", (Tracer::now_ns() - start_ns) / 1000);
             auto st = _exec_env->tablet_writer_mgr()->add_batch(*request, response->mutable_tablet_vec());
+            span.set_status(st);
             if (!st.ok()) {
                 LOG(WARNING) << "tablet writer add batch failed, message=" << st.get_error_msg()
                     << ", id=" << request->id()
@@ -109,6 +141,7 @@ void PInternalServiceImpl<T>::tablet_writer_add_batch(google::protobuf::RpcContr
                     << ", sender_id=" << request->sender_id();
             }
             st.to_protobuf(response->mutable_status());
+            DorisMetrics::tablet_writer_add_batch_latency_us.add(MonotonicMicros() - start_us);
         });
 }
 
@@ -129,6 +162,14 @@ void PInternalServiceImpl<T>::tablet_writer_cancel(google::protobuf::RpcControll
     }
 }
 
+template<typename T>
+ThreadPool* PInternalServiceImpl<T>::_tablet_worker_pool(const PUniqueId& load_id,
+                                                       int64_t id) {
+    TabletsChannelKey key(load_id, id);
+    return _tablet_worker_pools[
+        TabletsChannelKeyHasher()(key) % _tablet_worker_pools.size()].get();
+}
+
 template<typename T>
 Status PInternalServiceImpl<T>::_exec_plan_fragment(brpc::Controller* cntl) {
     auto ser_request = cntl->request_attachment().to_string();
@@ -183,6 +224,102 @@ void PInternalServiceImpl<T>::trigger_profile_report(
     st.to_protobuf(result->mutable_status());
 }
 
+template<typename T>
+void PInternalServiceImpl<T>::ingest_segment_groups(
+        google::protobuf::RpcController* controller,
+        const PIngestSegmentGroupsRequest* request,
+        PIngestSegmentGroupsResult* response,
+        google::protobuf::Closure* done) {
+    VLOG_RPC << "ingest segment groups, tablet_id=" << request->tablet_id()
+        << ", txn_id=" << request->txn_id() << ", dir=" << request->dir();
+    // the files may be copied, it takes long as adding a batch
+    _tablet_worker_pool(request->load_id(), request->tablet_id())->offer(
+        [request, response, done] () {
+            brpc::ClosureGuard closure_guard(done);
+            OLAPStatus res = OLAPEngine::get_instance()->ingest_segment_groups(
+                request->tablet_id(), request->schema_hash(), request->partition_id(),
+                request->txn_id(), request->load_id(), request->dir());
+            if (res != OLAP_SUCCESS) {
+                LOG(WARNING) << "ingest segment groups failed, res=" << res
+                    << ", tablet_id=" << request->tablet_id()
+                    << ", txn_id=" << request->txn_id()
+                    << ", dir=" << request->dir();
+                std::stringstream ss;
+                ss << "ingest segment groups failed, res=" << res;
+                Status(ss.str()).to_protobuf(response->mutable_status());
+                return;
+            }
+            PTabletInfo* tablet_info = response->add_tablet_vec();
+            tablet_info->set_tablet_id(request->tablet_id());
+            tablet_info->set_schema_hash(request->schema_hash());
+            Status::OK.to_protobuf(response->mutable_status());
+        });
+}
+
+template<typename T>
+void PInternalServiceImpl<T>::publish_runtime_filter(
+        google::protobuf::RpcController* controller,
+        const PPublishRuntimeFilterRequest* request,
+        PPublishRuntimeFilterResult* result,
+        google::protobuf::Closure* done) {
+    brpc::ClosureGuard closure_guard(done);
+    TUniqueId finst_id = UniqueId(request->finst_id()).to_thrift();
+    std::unique_ptr<RuntimeFilter> filter(
+        new RuntimeFilter(static_cast<PrimitiveType>(request->filter().type())));
+    auto st = filter->from_protobuf(request->filter());
+    if (!st.ok()) {
+        LOG(WARNING) << "invalid runtime filter, fragment_instance_id=" << print_id(finst_id)
+            << ", filter_id=" << request->filter_id() << ", errmsg=" << st.get_error_msg();
+        st.to_protobuf(result->mutable_status());
+        return;
+    }
+    _exec_env->runtime_filter_mgr()->publish(finst_id, request->filter_id(), std::move(filter));
+    Status::OK.to_protobuf(result->mutable_status());
+}
+
+template<typename T>
+void PInternalServiceImpl<T>::lookup_row(
+        google::protobuf::RpcController* controller,
+        const PLookupRowRequest* request,
+        PLookupRowResult* response,
+        google::protobuf::Closure* done) {
+    // read here, a lookup is shorter than handing it to another thread
+    brpc::ClosureGuard closure_guard(done);
+    std::string err;
+    OLAPTablePtr table = OLAPEngine::get_instance()->get_table(
+        request->tablet_id(), request->schema_hash(), true, &err);
+    if (table.get() == nullptr) {
+        std::stringstream ss;
+        ss << "failed to get tablet: " << request->tablet_id() << " with schema hash: "
+            << request->schema_hash() << ", reason: " << err;
+        LOG(WARNING) << ss.str();
+        Status(ss.str()).to_protobuf(response->mutable_status());
+        return;
+    }
+    OlapTuple key;
+    for (auto& value : request->key()) {
+        key.add_value(value);
+    }
+    std::vector<std::string> columns(request->columns().begin(), request->columns().end());
+    std::vector<OlapTuple> rows;
+    OLAPStatus res = RowLookup::lookup(table, request->version(), key, columns,
+                                       std::max(request->max_rows(), 0), &rows);
+    if (res != OLAP_SUCCESS) {
+        std::stringstream ss;
+        ss << "lookup row failed, res=" << res << ", tablet_id=" << request->tablet_id();
+        Status(ss.str()).to_protobuf(response->mutable_status());
+        return;
+    }
+    for (auto& row : rows) {
+        PLookupRowValues* values = response->add_rows();
+        for (size_t i = 0; i < row.size(); ++i) {
+            values->add_values(row.get_value(i));
+            values->add_is_null(row.is_null(i));
+        }
+    }
+    Status::OK.to_protobuf(response->mutable_status());
+}
+
 template class PInternalServiceImpl<PBackendService>;
 template class PInternalServiceImpl<palo::PInternalService>;
 
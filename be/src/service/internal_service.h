@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "common/status.h"
 #include "gen_cpp/internal_service.pb.h"
 #include "gen_cpp/palo_internal_service.pb.h"
@@ -80,11 +83,31 @@ public:
         PTriggerProfileReportResult* result,
         google::protobuf::Closure* done) override;
 
+    void publish_runtime_filter(
+        google::protobuf::RpcController* controller,
+        const PPublishRuntimeFilterRequest* request,
+        PPublishRuntimeFilterResult* result,
+        google::protobuf::Closure* done) override;
+
+    // only served by PBackendService
+    void ingest_segment_groups(google::protobuf::RpcController* controller,
+                               const PIngestSegmentGroupsRequest* request,
+                               PIngestSegmentGroupsResult* response,
+                               google::protobuf::Closure* done);
+
+    // only served by PBackendService
+    void lookup_row(google::protobuf::RpcController* controller,
+                    const PLookupRowRequest* request,
+                    PLookupRowResult* response,
+                    google::protobuf::Closure* done);
+
 private:
     Status _exec_plan_fragment(brpc::Controller* cntl);
+    // the pool of the requests for an index, or a tablet, of a load
+    ThreadPool* _tablet_worker_pool(const PUniqueId& load_id, int64_t id);
 private:
     ExecEnv* _exec_env;
-    ThreadPool _tablet_worker_pool;
+    std::vector<std::unique_ptr<ThreadPool>> _tablet_worker_pools;
 };
 
 }
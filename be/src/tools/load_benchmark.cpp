@@ -0,0 +1,509 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+// Replays a stream load inside one backend process, without the FE:
+//
+//   BrokerScanner -> OlapTableSink -> (brpc) -> TabletWriterMgr
+//       -> DeltaWriter -> MemTable flush
+//
+// The OLAPEngine and the ExecEnv are opened on a scratch directory, the tablets
+// are created locally and the sink sends to the brpc service of this process.
+// The time and the cpu spent by every stage are reported by a RuntimeProfile.
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "common/config.h"
+#include "common/logging.h"
+#include "common/status.h"
+#include "exec/broker_scanner.h"
+#include "exec/olap_table_sink.h"
+#include "gen_cpp/AgentService_types.h"
+#include "gen_cpp/DataSinks_types.h"
+#include "gen_cpp/Descriptors_types.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "olap/olap_engine.h"
+#include "olap/options.h"
+#include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple_row.h"
+#include "service/brpc_service.h"
+#include "util/cpu_info.h"
+#include "util/disk_info.h"
+#include "util/doris_metrics.h"
+#include "util/file_utils.h"
+#include "util/logging.h"
+#include "util/mem_info.h"
+#include "util/random.h"
+#include "util/runtime_profile.h"
+#include "util/time.h"
+// header only, shared with the unit tests
+#include "util/descriptor_helper.h"
+
+DEFINE_string(root_path, "./load_benchmark_storage",
+        "scratch storage root path, it is cleared before the run");
+DEFINE_string(conf_file, "", "be.conf to read the configs from, defaults are used if empty");
+DEFINE_string(input_file, "",
+        "csv file of (k1 INT, k2 BIGINT, v1 VARCHAR) to load, rows are generated if empty");
+DEFINE_string(column_separator, ",", "column separator of the input file");
+DEFINE_int64(num_rows, 1000000, "number of the generated rows");
+DEFINE_int32(key_cardinality, 100000, "number of the distinct k1 of the generated rows");
+DEFINE_int32(num_tablets, 8, "number of tablets the rows are distributed to");
+DEFINE_int32(batch_size, 1024, "number of rows of a batch sent to the tablets");
+DEFINE_int32(brpc_port, 18060, "port of the brpc service started by the benchmark");
+
+namespace doris {
+
+static const int64_t k_db_id = 1;
+static const int64_t k_table_id = 2;
+static const int64_t k_partition_id = 3;
+static const int64_t k_index_id = 4;
+static const int64_t k_tablet_id_base = 10000;
+static const int32_t k_schema_hash = 1111;
+static const int32_t k_value_len = 64;
+
+static void create_tablet_request(int64_t tablet_id, TCreateTabletReq* request) {
+    request->tablet_id = tablet_id;
+    request->__set_version(1);
+    request->__set_version_hash(0);
+    request->tablet_schema.schema_hash = k_schema_hash;
+    request->tablet_schema.short_key_column_count = 2;
+    request->tablet_schema.keys_type = TKeysType::DUP_KEYS;
+    request->tablet_schema.storage_type = TStorageType::COLUMN;
+
+    TColumn k1;
+    k1.column_name = "k1";
+    k1.__set_is_key(true);
+    k1.__set_is_allow_null(true);
+    k1.column_type.type = TPrimitiveType::INT;
+    request->tablet_schema.columns.push_back(k1);
+
+    TColumn k2;
+    k2.column_name = "k2";
+    k2.__set_is_key(true);
+    k2.__set_is_allow_null(true);
+    k2.column_type.type = TPrimitiveType::BIGINT;
+    request->tablet_schema.columns.push_back(k2);
+
+    TColumn v1;
+    v1.column_name = "v1";
+    v1.__set_is_key(false);
+    v1.__set_is_allow_null(true);
+    v1.column_type.type = TPrimitiveType::VARCHAR;
+    v1.column_type.__set_len(k_value_len);
+    v1.__set_aggregation_type(TAggregationType::NONE);
+    request->tablet_schema.columns.push_back(v1);
+}
+
+// Tuple 0 is the destination tuple of the scanner and the tuple of the sink,
+// tuple 1 is the source tuple holding the fields of a line.
+static TDescriptorTable create_descriptor_table() {
+    TDescriptorTableBuilder dtb;
+    {
+        TTupleDescriptorBuilder tuple_builder;
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().type(TYPE_INT).column_name("k1").column_pos(0).build());
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("k2").column_pos(1).build());
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().string_type(k_value_len).column_name("v1").column_pos(2).build());
+        tuple_builder.build(&dtb);
+    }
+    {
+        TTupleDescriptorBuilder tuple_builder;
+        for (int i = 0; i < 3; ++i) {
+            tuple_builder.add_slot(
+                TSlotDescriptorBuilder().string_type(65535).column_pos(i).build());
+        }
+        tuple_builder.build(&dtb);
+    }
+    return dtb.desc_tbl();
+}
+
+// Every destination slot is the source field of the same position, it is converted
+// from the text directly by the scanner.
+static TBrokerScanRangeParams create_scan_params(const TDescriptorTable& desc_tbl) {
+    TBrokerScanRangeParams params;
+    params.column_separator = FLAGS_column_separator[0];
+    params.line_delimiter = '\n';
+    params.src_tuple_id = 1;
+    params.dest_tuple_id = 0;
+
+    std::vector<TSlotDescriptor> dest_slots;
+    std::vector<TSlotDescriptor> src_slots;
+    for (auto& slot : desc_tbl.slotDescriptors) {
+        (slot.parent == 0 ? dest_slots : src_slots).push_back(slot);
+    }
+    for (int i = 0; i < dest_slots.size(); ++i) {
+        TExprNode slot_ref;
+        slot_ref.node_type = TExprNodeType::SLOT_REF;
+        slot_ref.type = src_slots[i].slotType;
+        slot_ref.num_children = 0;
+        slot_ref.__isset.slot_ref = true;
+        slot_ref.slot_ref.slot_id = src_slots[i].id;
+        slot_ref.slot_ref.tuple_id = 1;
+
+        TExpr expr;
+        expr.nodes.push_back(slot_ref);
+        params.expr_of_dest_slot.emplace(dest_slots[i].id, expr);
+        params.src_slot_ids.push_back(src_slots[i].id);
+    }
+    params.__isset.expr_of_dest_slot = true;
+    return params;
+}
+
+// One unpartitioned index distributed by k1, all the tablets are on this backend.
+static TDataSink create_data_sink(const TDescriptorTable& desc_tbl) {
+    TDataSink data_sink;
+    data_sink.type = TDataSinkType::OLAP_TABLE_SINK;
+    data_sink.__isset.olap_table_sink = true;
+
+    TOlapTableSink& tsink = data_sink.olap_table_sink;
+    tsink.load_id.hi = UnixMillis();
+    tsink.load_id.lo = getpid();
+    tsink.txn_id = UnixMillis();
+    tsink.db_id = k_db_id;
+    tsink.table_id = k_table_id;
+    tsink.tuple_id = 0;
+    tsink.num_replicas = 1;
+    tsink.need_gen_rollup = false;
+    tsink.db_name = "load_benchmark";
+    tsink.table_name = "load_benchmark";
+
+    TOlapTableSchemaParam& tschema = tsink.schema;
+    tschema.db_id = k_db_id;
+    tschema.table_id = k_table_id;
+    tschema.version = 0;
+    for (auto& slot : desc_tbl.slotDescriptors) {
+        if (slot.parent == 0) {
+            tschema.slot_descs.push_back(slot);
+        }
+    }
+    tschema.tuple_desc = desc_tbl.tupleDescriptors[0];
+    tschema.indexes.resize(1);
+    tschema.indexes[0].id = k_index_id;
+    tschema.indexes[0].columns = {"k1", "k2", "v1"};
+    tschema.indexes[0].schema_hash = k_schema_hash;
+
+    std::vector<int64_t> tablet_ids;
+    for (int i = 0; i < FLAGS_num_tablets; ++i) {
+        tablet_ids.push_back(k_tablet_id_base + i);
+    }
+    TOlapTablePartitionParam& tpartition = tsink.partition;
+    tpartition.db_id = k_db_id;
+    tpartition.table_id = k_table_id;
+    tpartition.version = 0;
+    tpartition.__set_distributed_columns({"k1"});
+    tpartition.partitions.resize(1);
+    tpartition.partitions[0].id = k_partition_id;
+    tpartition.partitions[0].num_buckets = FLAGS_num_tablets;
+    tpartition.partitions[0].indexes.resize(1);
+    tpartition.partitions[0].indexes[0].index_id = k_index_id;
+    tpartition.partitions[0].indexes[0].tablets = tablet_ids;
+
+    TOlapTableLocationParam& location = tsink.location;
+    location.db_id = k_db_id;
+    location.table_id = k_table_id;
+    location.version = 0;
+    location.tablets.resize(tablet_ids.size());
+    for (int i = 0; i < tablet_ids.size(); ++i) {
+        location.tablets[i].tablet_id = tablet_ids[i];
+        location.tablets[i].node_ids = {0};
+    }
+
+    TPaloNodesInfo& nodes_info = tsink.nodes_info;
+    nodes_info.nodes.resize(1);
+    nodes_info.nodes[0].id = 0;
+    nodes_info.nodes[0].host = "127.0.0.1";
+    nodes_info.nodes[0].async_internal_port = FLAGS_brpc_port;
+    return data_sink;
+}
+
+static Status generate_input_file(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return Status("fail to open input file " + path);
+    }
+    Random random(0);
+    char sep = FLAGS_column_separator[0];
+    for (int64_t i = 0; i < FLAGS_num_rows; ++i) {
+        out << random.Uniform(FLAGS_key_cardinality) << sep << i << sep
+            << "value_" << random.Next() << "_" << i << '\n';
+    }
+    out.close();
+    return out.good() ? Status::OK : Status("fail to write input file " + path);
+}
+
+static int64_t cpu_time_ns(const struct timeval& tv) {
+    return tv.tv_sec * 1000000000L + tv.tv_usec * 1000L;
+}
+
+class LoadBenchmark {
+public:
+    LoadBenchmark(ExecEnv* exec_env) : _exec_env(exec_env) { }
+
+    Status run(const std::string& input_file);
+
+private:
+    Status _create_tablets();
+    Status _load(const std::string& input_file, RuntimeState* state, RuntimeProfile* profile);
+    void _report(RuntimeProfile* profile, int64_t input_bytes);
+
+    ExecEnv* _exec_env;
+    ObjectPool _obj_pool;
+};
+
+Status LoadBenchmark::_create_tablets() {
+    for (int i = 0; i < FLAGS_num_tablets; ++i) {
+        TCreateTabletReq request;
+        create_tablet_request(k_tablet_id_base + i, &request);
+        OLAPStatus res = _exec_env->olap_engine()->create_table(request);
+        if (res != OLAP_SUCCESS) {
+            std::stringstream ss;
+            ss << "fail to create tablet " << request.tablet_id << ", res=" << res;
+            return Status(ss.str());
+        }
+    }
+    return Status::OK;
+}
+
+Status LoadBenchmark::run(const std::string& input_file) {
+    RETURN_IF_ERROR(_create_tablets());
+
+    TUniqueId fragment_id;
+    fragment_id.hi = UnixMillis();
+    fragment_id.lo = getpid();
+    TQueryOptions query_options;
+    query_options.batch_size = FLAGS_batch_size;
+    RuntimeState state(fragment_id, query_options, "2019-01-01 00:00:00", _exec_env);
+    RETURN_IF_ERROR(state.init_mem_trackers(fragment_id));
+    state.set_num_per_fragment_instances(1);
+
+    RuntimeProfile* profile = state.runtime_profile();
+    RETURN_IF_ERROR(_load(input_file, &state, profile));
+
+    struct stat input_stat;
+    int64_t input_bytes = stat(input_file.c_str(), &input_stat) == 0 ? input_stat.st_size : 0;
+    _report(profile, input_bytes);
+    return Status::OK;
+}
+
+Status LoadBenchmark::_load(const std::string& input_file,
+                            RuntimeState* state, RuntimeProfile* profile) {
+    TDescriptorTable tdesc_tbl = create_descriptor_table();
+    DescriptorTbl* desc_tbl = nullptr;
+    RETURN_IF_ERROR(DescriptorTbl::create(&_obj_pool, tdesc_tbl, &desc_tbl));
+    state->set_desc_tbl(desc_tbl);
+    RowDescriptor row_desc(*desc_tbl, {0}, {false});
+    TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+
+    RuntimeProfile::Counter* scan_timer = ADD_TIMER(profile, "ScanTime");
+    RuntimeProfile::Counter* send_timer = ADD_TIMER(profile, "SinkSendTime");
+    RuntimeProfile::Counter* close_timer = ADD_TIMER(profile, "SinkCloseTime");
+    RuntimeProfile::Counter* rows_counter = ADD_COUNTER(profile, "RowsScanned", TUnit::UNIT);
+    RuntimeProfile::Counter* filtered_counter = ADD_COUNTER(profile, "RowsFiltered", TUnit::UNIT);
+    RuntimeProfile::Counter* user_cpu_timer = ADD_TIMER(profile, "UserCpuTime");
+    RuntimeProfile::Counter* sys_cpu_timer = ADD_TIMER(profile, "SysCpuTime");
+    RuntimeProfile::Counter* add_batch_timer = ADD_TIMER(profile, "TabletWriterAddBatchTime");
+    RuntimeProfile::Counter* add_batch_counter =
+        ADD_COUNTER(profile, "TabletWriterAddBatchCount", TUnit::UNIT);
+    RuntimeProfile::Counter* flush_timer = ADD_TIMER(profile, "MemTableFlushTime");
+    RuntimeProfile::Counter* flush_counter = ADD_COUNTER(profile, "MemTableFlushCount", TUnit::UNIT);
+
+    TBrokerRangeDesc range;
+    range.path = input_file;
+    range.start_offset = 0;
+    range.size = -1;
+    range.splittable = true;
+    range.file_type = TFileType::FILE_LOCAL;
+    range.format_type = TFileFormatType::FORMAT_CSV_PLAIN;
+    std::vector<TBrokerRangeDesc> ranges = {range};
+    std::vector<TNetworkAddress> broker_addresses;
+    TBrokerScanRangeParams scan_params = create_scan_params(tdesc_tbl);
+    BrokerScanCounter scan_counter;
+    BrokerScanner scanner(state, profile, scan_params, ranges, broker_addresses, &scan_counter);
+
+    Status st;
+    OlapTableSink sink(&_obj_pool, row_desc, {}, &st);
+    RETURN_IF_ERROR(st);
+    RETURN_IF_ERROR(sink.init(create_data_sink(tdesc_tbl)));
+    RETURN_IF_ERROR(sink.prepare(state));
+
+    int64_t add_batch_us = DorisMetrics::tablet_writer_add_batch_latency_us.sum();
+    int64_t add_batch_count = DorisMetrics::tablet_writer_add_batch_latency_us.count();
+    int64_t flush_us = DorisMetrics::memtable_flush_duration_us.sum();
+    int64_t flush_count = DorisMetrics::memtable_flush_duration_us.count();
+    struct rusage start_usage;
+    getrusage(RUSAGE_SELF, &start_usage);
+
+    RETURN_IF_ERROR(scanner.open());
+    RETURN_IF_ERROR(sink.open(state));
+    RowBatch batch(row_desc, state->batch_size(), state->instance_mem_tracker());
+    bool eof = false;
+    while (!eof) {
+        batch.reset();
+        {
+            SCOPED_TIMER(scan_timer);
+            while (!batch.at_capacity()) {
+                Tuple* tuple = reinterpret_cast<Tuple*>(
+                    batch.tuple_data_pool()->allocate(tuple_desc->byte_size()));
+                memset(tuple, 0, tuple_desc->byte_size());
+                RETURN_IF_ERROR(scanner.get_next(tuple, batch.tuple_data_pool(), &eof));
+                if (eof) {
+                    break;
+                }
+                batch.get_row(batch.add_row())->set_tuple(0, tuple);
+                batch.commit_last_row();
+            }
+        }
+        COUNTER_UPDATE(rows_counter, batch.num_rows());
+        if (batch.num_rows() > 0) {
+            SCOPED_TIMER(send_timer);
+            RETURN_IF_ERROR(sink.send(state, &batch));
+        }
+    }
+    scanner.close();
+    {
+        // the last batches are sent and all the memtables are flushed when closing
+        SCOPED_TIMER(close_timer);
+        RETURN_IF_ERROR(sink.close(state, Status::OK));
+    }
+
+    struct rusage end_usage;
+    getrusage(RUSAGE_SELF, &end_usage);
+    COUNTER_SET(filtered_counter, scan_counter.num_rows_filtered);
+    COUNTER_SET(user_cpu_timer, cpu_time_ns(end_usage.ru_utime) - cpu_time_ns(start_usage.ru_utime));
+    COUNTER_SET(sys_cpu_timer, cpu_time_ns(end_usage.ru_stime) - cpu_time_ns(start_usage.ru_stime));
+    COUNTER_SET(add_batch_timer,
+                (DorisMetrics::tablet_writer_add_batch_latency_us.sum() - add_batch_us) * 1000);
+    COUNTER_SET(add_batch_counter,
+                DorisMetrics::tablet_writer_add_batch_latency_us.count() - add_batch_count);
+    COUNTER_SET(flush_timer, (DorisMetrics::memtable_flush_duration_us.sum() - flush_us) * 1000);
+    COUNTER_SET(flush_counter, DorisMetrics::memtable_flush_duration_us.count() - flush_count);
+    profile->add_child(sink.profile(), true, nullptr);
+    return Status::OK;
+}
+
+void LoadBenchmark::_report(RuntimeProfile* profile, int64_t input_bytes) {
+    int64_t rows = profile->get_counter("RowsScanned")->value();
+    auto print_stage = [&](const std::string& stage, const std::string& timer) {
+        double seconds = profile->get_counter(timer)->value() / 1e9;
+        std::cout << stage << ": " << seconds << " s, "
+            << (seconds > 0 ? static_cast<int64_t>(rows / seconds) : 0) << " rows/s" << std::endl;
+    };
+    std::stringstream ss;
+    profile->pretty_print(&ss);
+    std::cout << ss.str() << std::endl;
+
+    std::cout << "rows: " << rows << ", input bytes: " << input_bytes << std::endl;
+    print_stage("scan", "ScanTime");
+    print_stage("sink send", "SinkSendTime");
+    print_stage("sink close", "SinkCloseTime");
+    print_stage("tablet writer add batch", "TabletWriterAddBatchTime");
+    print_stage("memtable flush", "MemTableFlushTime");
+    print_stage("user cpu", "UserCpuTime");
+    print_stage("sys cpu", "SysCpuTime");
+}
+
+}
+
+int main(int argc, char** argv) {
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    if (!doris::config::init(FLAGS_conf_file.empty() ? nullptr : FLAGS_conf_file.c_str(), false)) {
+        std::cerr << "fail to read config file " << FLAGS_conf_file << std::endl;
+        return -1;
+    }
+    if (FLAGS_root_path.empty() || FLAGS_column_separator.size() != 1
+            || FLAGS_num_tablets <= 0 || FLAGS_batch_size <= 0) {
+        std::cerr << "invalid flags" << std::endl;
+        return -1;
+    }
+    if (doris::FileUtils::check_exist(FLAGS_root_path)) {
+        doris::FileUtils::remove_all(FLAGS_root_path);
+    }
+    doris::config::storage_root_path = FLAGS_root_path + "/storage";
+    doris::config::sys_log_dir = FLAGS_root_path + "/log";
+    doris::config::pull_load_task_dir = FLAGS_root_path + "/pull_load";
+    doris::config::brpc_port = FLAGS_brpc_port;
+    if (!doris::FileUtils::create_dir(doris::config::storage_root_path).ok()
+            || !doris::FileUtils::create_dir(doris::config::sys_log_dir).ok()) {
+        std::cerr << "fail to create scratch directory " << FLAGS_root_path << std::endl;
+        return -1;
+    }
+    doris::init_glog("load_benchmark", true);
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+    doris::MemInfo::init();
+
+    std::vector<doris::StorePath> paths;
+    if (doris::parse_conf_store_paths(doris::config::storage_root_path, &paths)
+            != doris::OLAP_SUCCESS) {
+        std::cerr << "fail to parse storage path " << doris::config::storage_root_path << std::endl;
+        return -1;
+    }
+    doris::EngineOptions options;
+    options.store_paths = paths;
+    doris::OLAPEngine* engine = nullptr;
+    doris::Status st = doris::OLAPEngine::open(options, &engine);
+    if (!st.ok()) {
+        std::cerr << "fail to open OLAPEngine, res=" << st.get_error_msg() << std::endl;
+        return -1;
+    }
+    auto exec_env = doris::ExecEnv::GetInstance();
+    doris::ExecEnv::init(exec_env, paths);
+    exec_env->set_olap_engine(engine);
+
+    doris::BRpcService brpc_service(exec_env);
+    st = brpc_service.start(FLAGS_brpc_port);
+    if (!st.ok()) {
+        std::cerr << "fail to start brpc service, res=" << st.get_error_msg() << std::endl;
+        return -1;
+    }
+
+    std::string input_file = FLAGS_input_file;
+    if (input_file.empty()) {
+        input_file = FLAGS_root_path + "/input.csv";
+        st = doris::generate_input_file(input_file);
+        if (!st.ok()) {
+            std::cerr << st.get_error_msg() << std::endl;
+            return -1;
+        }
+    }
+
+    doris::LoadBenchmark benchmark(exec_env);
+    st = benchmark.run(input_file);
+    if (!st.ok()) {
+        std::cerr << "load failed, res=" << st.get_error_msg() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -470,40 +470,12 @@ void HllVal::agg_parse_and_cal(const HllVal &other) {
         return;
     }
 
-    uint8_t* pdata = ptr + 1;
-    int data_len = doris::HLL_REGISTERS_COUNT;
-
-    if (resolver.get_hll_data_type() == doris::HLL_DATA_EXPLICIT) {
-        for (int i = 0; i < resolver.get_explicit_count(); i++) {
-            uint64_t hash_value = resolver.get_explicit_value(i);
-            int idx = hash_value % data_len;
-            uint8_t first_one_bit = __builtin_ctzl(hash_value >> doris::HLL_COLUMN_PRECISION) + 1;
-            pdata[idx] = std::max(pdata[idx], first_one_bit);
-        }
-    } else if (resolver.get_hll_data_type() == doris::HLL_DATA_SPRASE) {
-        std::map<doris::HllSetResolver::SparseIndexType,
-                 doris::HllSetResolver::SparseValueType>&
-                     sparse_map = resolver.get_sparse_map();
-        for (std::map<doris::HllSetResolver::SparseIndexType,
-                doris::HllSetResolver::SparseValueType>::iterator iter = sparse_map.begin();
-                                    iter != sparse_map.end(); iter++) {
-            pdata[iter->first] = std::max(pdata[iter->first], (uint8_t)iter->second);
-        }
-    } else if (resolver.get_hll_data_type() == doris::HLL_DATA_FULL) {
-        char* full_value = resolver.get_full_value();
-        for (int i = 0; i < doris::HLL_REGISTERS_COUNT; i++) {
-            pdata[i] = std::max(pdata[i], (uint8_t)full_value[i]);
-        }
-    }
+    resolver.fill_registers((char*)ptr + 1, doris::HLL_REGISTERS_COUNT);
 }
 
 void HllVal::agg_merge(const HllVal &other) {
-    uint8_t* pdata = ptr + 1;
-    uint8_t* pdata_other = other.ptr + 1;
-
-    for (int i = 0; i < doris::HLL_REGISTERS_COUNT; ++i) {
-        pdata[i] = std::max(pdata[i], pdata_other[i]);
-    }
+    doris::HllSetHelper::merge_registers(
+            (char*)ptr + 1, (const char*)other.ptr + 1, doris::HLL_REGISTERS_COUNT);
 }
 
 }
@@ -296,6 +296,35 @@ typedef void (*UdfPrepare)(FunctionContext* context,
 typedef void (*UdfClose)(FunctionContext* context,
                          FunctionContext::FunctionStateScope scope);
 
+/// --- Batch UDFs ---
+/// ------------------
+/// A native UDF can optionally export a batch version of itself, which is called
+/// once per row batch instead of once per row. The batch function must have C
+/// linkage and be named like the UDF's function, without namespace and arguments,
+/// with "_batch" appended, for example "my_score_batch" for "udf::my_score(...)".
+/// It is only used when the return type and all the
+/// argument types are BOOLEAN, TINYINT, SMALLINT, INT, BIGINT, LARGEINT, FLOAT,
+/// DOUBLE, CHAR or VARCHAR.
+//
+/// Each column holds one value per row of the batch: bool, int8_t ... __int128,
+/// float, double or BatchStringVal, and nulls[row] is 1 if the value is NULL. Only
+/// the rows sel[0], ..., sel[n - 1] (or 0, ..., n - 1 if sel is NULL) must be
+/// computed. The result nulls are 0 on entry, and result strings must be allocated
+/// with StringVal(context, len) like in the row-at-a-time UDF.
+struct BatchStringVal {
+    char* ptr;
+    int len;
+};
+
+struct BatchColumn {
+    void* values;
+    uint8_t* nulls;
+};
+
+typedef void (*UdfBatchFn)(FunctionContext* context, int num_args,
+                           const BatchColumn* args, const int* sel, int n,
+                           BatchColumn* result);
+
 //----------------------------------------------------------------------------
 //------------------------------- UDAs ---------------------------------------
 //----------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #include <memory>
 #include <mutex>
 
+#include "common/config.h"
 #include "gen_cpp/Types_types.h" // TNetworkAddress
 #include "gen_cpp/internal_service.pb.h"
 #include "gen_cpp/palo_internal_service.pb.h"
@@ -48,6 +49,7 @@ public:
         }
         // new one stub and insert into map
         brpc::ChannelOptions options;
+        options.connection_type = config::brpc_connection_type.c_str();
         std::unique_ptr<brpc::Channel> channel(new brpc::Channel());
         if (channel->Init(endpoint, &options)) {
             return nullptr;
@@ -22,6 +22,7 @@
 #endif
 
 #include <mmintrin.h>
+#include <pthread.h>
 #include <sched.h>
 #include <stdlib.h>
 #include <string.h>
@@ -244,6 +245,31 @@ void CpuInfo::_init_numa_node_to_cores() {
   }
 }
 
+bool CpuInfo::bind_thread_to_numa_node(int node) {
+  DCHECK_LE(0, node);
+  DCHECK_LT(node, max_num_numa_nodes_);
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (int core : numa_node_to_cores_[node]) {
+    CPU_SET(core, &cpus);
+  }
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  if (ret != 0) {
+    LOG(WARNING) << "Failed to bind thread to NUMA node " << node << ": " << strerror(ret);
+    return false;
+  }
+  return true;
+}
+
+void CpuInfo::unbind_thread() {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (int core = 0; core < max_num_cores_; ++core) {
+    CPU_SET(core, &cpus);
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
 void CpuInfo::verify_cpu_requirements() {
   if (!CpuInfo::is_supported(CpuInfo::SSSE3)) {
     LOG(ERROR) << "CPU does not support the Supplemental SSE3 (SSSE3) instruction set. "
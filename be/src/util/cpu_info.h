@@ -138,6 +138,18 @@ class CpuInfo {
     return numa_node_core_idx_[core];
   }
 
+  /// Returns the NUMA node of the core the current thread is running on.
+  static int get_current_numa_node() {
+    return get_numa_node_of_core(get_current_core());
+  }
+
+  /// Restricts the current thread to the cores of NUMA 'node', so the memory it
+  /// touches first is allocated on that node. Returns false if it failed.
+  static bool bind_thread_to_numa_node(int node);
+
+  /// Lets the current thread run on all the cores again.
+  static void unbind_thread();
+
   /// Returns the model name of the cpu (e.g. Intel i7-2600)
   static std::string model_name() {
     DCHECK(initialized_);
@@ -21,6 +21,8 @@
 #include <fstream>
 #include <sstream>
 #include <unistd.h>
+#include <limits.h>
+#include <stdlib.h>
 #include <sys/vfs.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -116,6 +118,23 @@ void DiskInfo::get_device_names() {
         if (rotational.is_open()) {
             rotational.close();
         }
+
+        // The NUMA node is in the numa_node file of the controller, a parent of the
+        // device in /sys/devices, e.g. /sys/devices/pci0000:00/0000:00:1f.2/numa_node.
+        ss.str("");
+        ss << "/sys/block/" << _s_disks[i].name;
+        char device_path[PATH_MAX];
+        if (realpath(ss.str().c_str(), device_path) != nullptr) {
+            std::string dir = device_path;
+            while (dir.size() > 1 && _s_disks[i].numa_node < 0) {
+                std::ifstream numa_node((dir + "/numa_node").c_str(), std::ios::in);
+                int node = -1;
+                if (numa_node.good() && (numa_node >> node) && node >= 0) {
+                    _s_disks[i].numa_node = node;
+                }
+                dir = dir.substr(0, dir.rfind('/'));
+            }
+        }
     }
 }
 
@@ -144,6 +163,9 @@ std::string DiskInfo::debug_string() {
 
     for (int i = 0; i < _s_disks.size(); ++i) {
         stream << _s_disks[i].name;
+        if (_s_disks[i].numa_node >= 0) {
+            stream << "(numa node " << _s_disks[i].numa_node << ")";
+        }
 
         if (i < num_disks() - 1) {
             stream << ", ";
@@ -77,6 +77,13 @@ public:
         return _s_disks[disk_id].is_rotational;
     }
 
+    // Returns the NUMA node the controller of the disk is attached to, -1 if unknown
+    static int numa_node(int disk_id) {
+        DCHECK_GE(disk_id, 0);
+        DCHECK_LT(disk_id, _s_disks.size());
+        return _s_disks[disk_id].numa_node;
+    }
+
     static std::string debug_string();
 
     // get disk devices of given path
@@ -96,6 +103,8 @@ private:
 
         bool is_rotational;
 
+        int numa_node = -1;
+
         Disk() : name(""), id(0) {}
         Disk(const std::string& name) : name(name), id(0), is_rotational(true) {}
         Disk(const std::string& name, int id) : name(name), id(id), is_rotational(true) {}
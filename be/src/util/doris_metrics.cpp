@@ -38,6 +38,8 @@ IntCounter DorisMetrics::http_request_duration_us;
 IntCounter DorisMetrics::http_request_send_bytes;
 IntCounter DorisMetrics::query_scan_bytes;
 IntCounter DorisMetrics::query_scan_rows;
+IntCounter DorisMetrics::scanner_tasks_total;
+IntCounter DorisMetrics::scanner_queue_wait_us;
 IntCounter DorisMetrics::ranges_processed_total;
 IntCounter DorisMetrics::push_requests_success_total;
 IntCounter DorisMetrics::push_requests_fail_total;
@@ -83,6 +85,9 @@ IntCounter DorisMetrics::cumulative_compaction_request_failed;
 IntCounter DorisMetrics::publish_task_request_total;
 IntCounter DorisMetrics::publish_task_failed_total;
 
+IntCounter DorisMetrics::tablets_loaded_total;
+IntCounter DorisMetrics::tablets_load_failed_total;
+
 IntCounter DorisMetrics::meta_write_request_total;
 IntCounter DorisMetrics::meta_write_request_duration_us;
 IntCounter DorisMetrics::meta_read_request_total;
@@ -95,8 +100,33 @@ IntCounter DorisMetrics::txn_exec_plan_total;
 IntCounter DorisMetrics::stream_receive_bytes_total;
 IntCounter DorisMetrics::stream_load_rows_total;
 
+IntCounter DorisMetrics::codegen_cache_hits_total;
+IntCounter DorisMetrics::codegen_cache_misses_total;
+
+IntCounter DorisMetrics::fragment_result_cache_hits_total;
+IntCounter DorisMetrics::fragment_result_cache_misses_total;
+
+IntCounter DorisMetrics::chunk_pool_local_core_alloc_count;
+IntCounter DorisMetrics::chunk_pool_other_core_alloc_count;
+IntCounter DorisMetrics::chunk_pool_system_alloc_count;
+IntCounter DorisMetrics::chunk_pool_system_free_count;
+
+IntCounter DorisMetrics::trace_spans_total;
+IntCounter DorisMetrics::trace_spans_dropped_total;
+
+// histograms
+Histogram DorisMetrics::fragment_request_latency_us;
+Histogram DorisMetrics::scanner_batch_latency_us;
+Histogram DorisMetrics::exec_plan_fragment_latency_us;
+Histogram DorisMetrics::transmit_data_latency_us;
+Histogram DorisMetrics::tablet_writer_add_batch_latency_us;
+Histogram DorisMetrics::memtable_flush_duration_us;
+Histogram DorisMetrics::base_compaction_duration_ms;
+Histogram DorisMetrics::cumulative_compaction_duration_ms;
+
 // gauges
 IntGauge DorisMetrics::memory_pool_bytes_total;
+IntGauge DorisMetrics::chunk_pool_reserved_bytes;
 IntGauge DorisMetrics::process_thread_num;
 IntGauge DorisMetrics::process_fd_num_used;
 IntGauge DorisMetrics::process_fd_num_limit_soft;
@@ -137,6 +167,8 @@ void DorisMetrics::initialize(
     REGISTER_DORIS_METRIC(http_request_send_bytes);
     REGISTER_DORIS_METRIC(query_scan_bytes);
     REGISTER_DORIS_METRIC(query_scan_rows);
+    REGISTER_DORIS_METRIC(scanner_tasks_total);
+    REGISTER_DORIS_METRIC(scanner_queue_wait_us);
     REGISTER_DORIS_METRIC(ranges_processed_total);
 
     // push request
@@ -202,6 +234,13 @@ void DorisMetrics::initialize(
         "compaction_bytes_total", MetricLabels().add("type", "cumulative"),
         &cumulative_compaction_bytes_total);
 
+    _metrics->register_metric(
+        "load_tablets_total", MetricLabels().add("status", "success"),
+        &tablets_loaded_total);
+    _metrics->register_metric(
+        "load_tablets_total", MetricLabels().add("status", "failed"),
+        &tablets_load_failed_total);
+
     _metrics->register_metric(
         "meta_request_total", MetricLabels().add("type", "write"),
         &meta_write_request_total);
@@ -235,8 +274,49 @@ void DorisMetrics::initialize(
         "stream_load", MetricLabels().add("type", "load_rows"),
         &stream_load_rows_total);
 
+    _metrics->register_metric(
+        "codegen_cache", MetricLabels().add("type", "hit"),
+        &codegen_cache_hits_total);
+    _metrics->register_metric(
+        "codegen_cache", MetricLabels().add("type", "miss"),
+        &codegen_cache_misses_total);
+    _metrics->register_metric(
+        "fragment_result_cache", MetricLabels().add("type", "hit"),
+        &fragment_result_cache_hits_total);
+    _metrics->register_metric(
+        "fragment_result_cache", MetricLabels().add("type", "miss"),
+        &fragment_result_cache_misses_total);
+
+    // histograms
+    REGISTER_DORIS_METRIC(fragment_request_latency_us);
+    REGISTER_DORIS_METRIC(scanner_batch_latency_us);
+    REGISTER_DORIS_METRIC(memtable_flush_duration_us);
+    _metrics->register_metric(
+        "rpc_latency_us", MetricLabels().add("method", "exec_plan_fragment"),
+        &exec_plan_fragment_latency_us);
+    _metrics->register_metric(
+        "rpc_latency_us", MetricLabels().add("method", "transmit_data"),
+        &transmit_data_latency_us);
+    _metrics->register_metric(
+        "rpc_latency_us", MetricLabels().add("method", "tablet_writer_add_batch"),
+        &tablet_writer_add_batch_latency_us);
+    _metrics->register_metric(
+        "compaction_duration_ms", MetricLabels().add("type", "base"),
+        &base_compaction_duration_ms);
+    _metrics->register_metric(
+        "compaction_duration_ms", MetricLabels().add("type", "cumulative"),
+        &cumulative_compaction_duration_ms);
+
+    REGISTER_DORIS_METRIC(chunk_pool_local_core_alloc_count);
+    REGISTER_DORIS_METRIC(chunk_pool_other_core_alloc_count);
+    REGISTER_DORIS_METRIC(chunk_pool_system_alloc_count);
+    REGISTER_DORIS_METRIC(chunk_pool_system_free_count);
+    REGISTER_DORIS_METRIC(trace_spans_total);
+    REGISTER_DORIS_METRIC(trace_spans_dropped_total);
+
     // Gauge
     REGISTER_DORIS_METRIC(memory_pool_bytes_total);
+    REGISTER_DORIS_METRIC(chunk_pool_reserved_bytes);
     REGISTER_DORIS_METRIC(process_thread_num);
     REGISTER_DORIS_METRIC(process_fd_num_used);
     REGISTER_DORIS_METRIC(process_fd_num_limit_soft);
@@ -57,6 +57,8 @@ public:
     static IntCounter http_request_send_bytes;
     static IntCounter query_scan_bytes;
     static IntCounter query_scan_rows;
+    static IntCounter scanner_tasks_total;
+    static IntCounter scanner_queue_wait_us;
     static IntCounter ranges_processed_total;
     static IntCounter push_requests_success_total;
     static IntCounter push_requests_fail_total;
@@ -103,6 +105,9 @@ public:
     static IntCounter publish_task_request_total;
     static IntCounter publish_task_failed_total;
 
+    static IntCounter tablets_loaded_total;
+    static IntCounter tablets_load_failed_total;
+
     static IntCounter meta_write_request_total;
     static IntCounter meta_write_request_duration_us;
     static IntCounter meta_read_request_total;
@@ -115,8 +120,33 @@ public:
     static IntCounter stream_receive_bytes_total;
     static IntCounter stream_load_rows_total;
 
+    static IntCounter codegen_cache_hits_total;
+    static IntCounter codegen_cache_misses_total;
+
+    static IntCounter fragment_result_cache_hits_total;
+    static IntCounter fragment_result_cache_misses_total;
+
+    static IntCounter chunk_pool_local_core_alloc_count;
+    static IntCounter chunk_pool_other_core_alloc_count;
+    static IntCounter chunk_pool_system_alloc_count;
+    static IntCounter chunk_pool_system_free_count;
+
+    static IntCounter trace_spans_total;
+    static IntCounter trace_spans_dropped_total;
+
+    // Histograms
+    static Histogram fragment_request_latency_us;
+    static Histogram scanner_batch_latency_us;
+    static Histogram exec_plan_fragment_latency_us;
+    static Histogram transmit_data_latency_us;
+    static Histogram tablet_writer_add_batch_latency_us;
+    static Histogram memtable_flush_duration_us;
+    static Histogram base_compaction_duration_ms;
+    static Histogram cumulative_compaction_duration_ms;
+
     // Gauges
     static IntGauge memory_pool_bytes_total;
+    static IntGauge chunk_pool_reserved_bytes;
     static IntGauge process_thread_num;
     static IntGauge process_fd_num_used;
     static IntGauge process_fd_num_limit_soft;
@@ -0,0 +1,90 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_COMMON_UTIL_EVENT_COUNT_H
+#define DORIS_BE_SRC_COMMON_UTIL_EVENT_COUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace doris {
+
+// Lets a thread wait for a condition which other threads change without a lock,
+// e.g. a lock-free queue becoming non-empty. notify() costs a fence and an atomic
+// load while nobody waits, so it can be called after every change.
+//
+//   EventCount::Key key = event_count.prepare_wait();
+//   if (condition()) {
+//       event_count.cancel_wait();
+//   } else {
+//       event_count.wait(key, timeout_ms);
+//   }
+//
+// A notify() after prepare_wait() wakes the waiter, even if it comes before wait().
+class EventCount {
+public:
+    typedef uint64_t Key;
+
+    Key prepare_wait() {
+        _num_waiters.fetch_add(1);
+        // orders the increment before the reads of the condition, pairs with the
+        // fence in notify()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return _epoch.load();
+    }
+
+    void cancel_wait() {
+        _num_waiters.fetch_sub(1);
+    }
+
+    // Returns false if nothing notified within 'timeout_ms'.
+    bool wait(Key key, int64_t timeout_ms) {
+        bool notified = false;
+        {
+            std::unique_lock<std::mutex> l(_lock);
+            notified = _cv.wait_for(l, std::chrono::milliseconds(timeout_ms),
+                                    [this, key]() { return _epoch.load() != key; });
+        }
+        _num_waiters.fetch_sub(1);
+        return notified;
+    }
+
+    // Called after the condition changed.
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_num_waiters.load() == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            _epoch.fetch_add(1);
+        }
+        _cv.notify_all();
+    }
+
+private:
+    std::atomic<uint64_t> _epoch{0};
+    std::atomic<int> _num_waiters{0};
+    std::mutex _lock;
+    std::condition_variable _cv;
+};
+
+}
+
+#endif
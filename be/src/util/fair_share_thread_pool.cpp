@@ -0,0 +1,153 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "util/fair_share_thread_pool.h"
+
+#include <algorithm>
+
+#include "util/cpu_info.h"
+#include "util/stopwatch.hpp"
+
+namespace doris {
+
+// nanos charged for the first task of a group
+static const double INITIAL_TASK_NANOS = 1000000;
+// weight of the last task in the average task nanos
+static const double SMOOTHING = 0.25;
+
+FairShareThreadPool::FairShareThreadPool(uint32_t num_threads, uint32_t queue_size,
+                                         int numa_node) :
+        _queue_size(queue_size),
+        _numa_node(numa_node) {
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        _threads.emplace_back(&FairShareThreadPool::_work_thread, this);
+    }
+}
+
+FairShareThreadPool::~FairShareThreadPool() {
+    shutdown();
+    join();
+}
+
+bool FairShareThreadPool::offer(uint64_t group_id, int weight, WorkFunction work) {
+    std::unique_lock<std::mutex> l(_lock);
+    while (_num_queued >= _queue_size && !_shutdown) {
+        _put_cv.wait(l);
+    }
+    if (_shutdown) {
+        return false;
+    }
+    auto it = _groups.find(group_id);
+    if (it == _groups.end()) {
+        it = _groups.emplace(group_id, Group()).first;
+        it->second.task_nanos = INITIAL_TASK_NANOS;
+    }
+    Group& group = it->second;
+    group.weight = std::max(1, weight);
+    if (group.tasks.empty()) {
+        // not in _ready_groups, time of an idle group is not saved up
+        group.vruntime = std::max(group.vruntime, _min_vruntime);
+        _ready_groups.emplace(group.vruntime, group_id);
+    }
+    group.tasks.push_back(std::move(work));
+    ++_num_queued;
+    l.unlock();
+    _get_cv.notify_one();
+    return true;
+}
+
+void FairShareThreadPool::_work_thread() {
+    if (_numa_node >= 0) {
+        CpuInfo::bind_thread_to_numa_node(_numa_node);
+    }
+    std::unique_lock<std::mutex> l(_lock);
+    while (true) {
+        while (_ready_groups.empty() && !_shutdown) {
+            _get_cv.wait(l);
+        }
+        if (_shutdown) {
+            return;
+        }
+
+        uint64_t group_id = _ready_groups.begin()->second;
+        _ready_groups.erase(_ready_groups.begin());
+        Group* group = &_groups[group_id];
+        _min_vruntime = std::max(_min_vruntime, group->vruntime);
+        WorkFunction work = std::move(group->tasks.front());
+        group->tasks.pop_front();
+        --_num_queued;
+        ++group->num_running;
+        double charged_nanos = group->task_nanos;
+        group->vruntime += charged_nanos / group->weight;
+        if (!group->tasks.empty()) {
+            _ready_groups.emplace(group->vruntime, group_id);
+        }
+        l.unlock();
+        _put_cv.notify_one();
+
+        MonotonicStopWatch watch;
+        watch.start();
+        work();
+        double nanos = watch.elapsed_time();
+
+        l.lock();
+        // groups with running tasks are not erased
+        group = &_groups[group_id];
+        bool ready = !group->tasks.empty();
+        if (ready) {
+            _ready_groups.erase(std::make_pair(group->vruntime, group_id));
+        }
+        group->vruntime += (nanos - charged_nanos) / group->weight;
+        group->task_nanos += SMOOTHING * (nanos - group->task_nanos);
+        --group->num_running;
+        if (ready) {
+            _ready_groups.emplace(group->vruntime, group_id);
+        } else if (group->num_running == 0) {
+            _groups.erase(group_id);
+        }
+    }
+}
+
+void FairShareThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _shutdown = true;
+    }
+    _get_cv.notify_all();
+    _put_cv.notify_all();
+}
+
+void FairShareThreadPool::join() {
+    for (auto& thread : _threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+uint32_t FairShareThreadPool::get_queue_size() const {
+    std::lock_guard<std::mutex> l(_lock);
+    return _num_queued;
+}
+
+uint32_t FairShareThreadPool::get_group_num() const {
+    std::lock_guard<std::mutex> l(_lock);
+    return _groups.size();
+}
+
+}
@@ -0,0 +1,104 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_UTIL_FAIR_SHARE_THREAD_POOL_H
+#define DORIS_BE_SRC_UTIL_FAIR_SHARE_THREAD_POOL_H
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace doris {
+
+// Thread pool whose tasks belong to groups, e.g. the queries, which share the
+// threads in proportion to their weights. Each group has a virtual time that
+// advances by the thread time of its tasks divided by its weight, the next
+// task is the oldest one of the group with the smallest virtual time. A group
+// which had nothing queued starts at the smallest virtual time of the others,
+// so a short query is served at once instead of behind the tasks queued by
+// big ones, and a group can not save up time while it is idle.
+//
+// Tasks should be short slices of work which queue their continuation.
+class FairShareThreadPool {
+public:
+    typedef std::function<void ()> WorkFunction;
+
+    // Starts 'num_threads' threads, offer() blocks while 'queue_size' tasks
+    // are queued. The threads run on the cores of 'numa_node' if it is not -1.
+    FairShareThreadPool(uint32_t num_threads, uint32_t queue_size, int numa_node = -1);
+
+    // Shuts down and joins the threads, queued tasks are dropped.
+    ~FairShareThreadPool();
+
+    // Queues 'work' of 'group', the last 'weight' given for a group is its
+    // weight. Returns false if the pool is shut down.
+    bool offer(uint64_t group, int weight, WorkFunction work);
+
+    // Stops the threads after their current tasks, returns at once.
+    void shutdown();
+
+    void join();
+
+    uint32_t get_queue_size() const;
+
+    // number of groups which have queued or running tasks
+    uint32_t get_group_num() const;
+
+private:
+    struct Group {
+        int weight = 1;
+        // nanos of thread time divided by the weight
+        double vruntime = 0;
+        // moving average of the nanos of the tasks, charged when a task starts
+        // so the tasks of a group started at the same time are not free
+        double task_nanos = 0;
+        int num_running = 0;
+        std::deque<WorkFunction> tasks;
+    };
+
+    void _work_thread();
+
+    const uint32_t _queue_size;
+    const int _numa_node;
+
+    mutable std::mutex _lock;
+    std::condition_variable _get_cv;
+    std::condition_variable _put_cv;
+    bool _shutdown = false;
+    uint32_t _num_queued = 0;
+
+    std::unordered_map<uint64_t, Group> _groups;
+    // groups with queued tasks by virtual time
+    std::set<std::pair<double, uint64_t>> _ready_groups;
+    // virtual time of the last group a task was taken from
+    double _min_vruntime = 0;
+
+    std::vector<std::thread> _threads;
+};
+
+}
+
+#endif
@@ -0,0 +1,64 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "util/lock_stats.h"
+
+#include <map>
+#include <mutex>
+
+#include "common/config.h"
+#include "util/doris_metrics.h"
+
+namespace doris {
+
+LockStats::LockStats(const std::string& name) {
+    MetricRegistry* metrics = DorisMetrics::metrics();
+    if (metrics == nullptr) {
+        // not initialized in some tests
+        return;
+    }
+    MetricLabels labels = MetricLabels().add("lock", name);
+    metrics->register_metric("lock_acquisitions_total", labels, &_acquisitions);
+    metrics->register_metric("lock_contentions_total", labels, &_contentions);
+    metrics->register_metric("lock_wait_ns_total", labels, &_wait_ns);
+    metrics->register_metric("lock_hold_ns_total", labels, &_hold_ns);
+}
+
+LockStats* LockStats::get(const std::string& name) {
+    static std::mutex lock;
+    static std::map<std::string, LockStats*>* all_stats = new std::map<std::string, LockStats*>();
+    std::lock_guard<std::mutex> l(lock);
+    auto it = all_stats->find(name);
+    if (it == all_stats->end()) {
+        it = all_stats->emplace(name, new LockStats(name)).first;
+    }
+    return it->second;
+}
+
+int64_t LockStats::on_acquired() {
+    _acquisitions.increment(1);
+    return config::lock_hold_time_stats ? MonotonicNanos() : 0;
+}
+
+void LockStats::on_released(int64_t acquired_ns) {
+    if (acquired_ns != 0) {
+        _hold_ns.increment(MonotonicNanos() - acquired_ns);
+    }
+}
+
+}
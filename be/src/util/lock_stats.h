@@ -0,0 +1,108 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_UTIL_LOCK_STATS_H
+#define DORIS_BE_SRC_UTIL_LOCK_STATS_H
+
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+
+#include "util/metrics.h"
+#include "util/time.h"
+
+namespace doris {
+
+// Contention of the locks of one name, exported as lock_acquisitions_total,
+// lock_contentions_total, lock_wait_ns_total and lock_hold_ns_total with the
+// label lock=<name>. Locks try to acquire first and read the clock only if
+// they have to wait, so uncontended locks cost one counter increment. Hold
+// time is only measured for exclusive locks and if lock_hold_time_stats is
+// set, it reads the clock twice on every acquisition.
+class LockStats {
+public:
+    explicit LockStats(const std::string& name);
+
+    // Stats of the locks of a name kept for the life of the process, used by
+    // locks which are created and destroyed with the objects they protect.
+    static LockStats* get(const std::string& name);
+
+    void on_contended(int64_t wait_ns) {
+        _contentions.increment(1);
+        _wait_ns.increment(wait_ns);
+    }
+
+    // Returns the time the lock was acquired if hold time is measured, else 0.
+    int64_t on_acquired();
+
+    void on_released(int64_t acquired_ns);
+
+    int64_t acquisitions() const { return _acquisitions.value(); }
+    int64_t contentions() const { return _contentions.value(); }
+    int64_t wait_ns() const { return _wait_ns.value(); }
+    int64_t hold_ns() const { return _hold_ns.value(); }
+
+private:
+    IntCounter _acquisitions;
+    IntCounter _contentions;
+    IntCounter _wait_ns;
+    IntCounter _hold_ns;
+};
+
+// A lock of 'LockType', e.g. std::mutex or SpinLock, which records its
+// contention in 'stats'. It can be used with std::lock_guard and
+// std::unique_lock like the lock it wraps.
+template<typename LockType>
+class InstrumentedLock {
+public:
+    explicit InstrumentedLock(LockStats* stats) : _stats(stats) { }
+
+    void lock() {
+        if (!_lock.try_lock()) {
+            int64_t start = MonotonicNanos();
+            _lock.lock();
+            _stats->on_contended(MonotonicNanos() - start);
+        }
+        _acquired_ns = _stats->on_acquired();
+    }
+
+    bool try_lock() {
+        if (!_lock.try_lock()) {
+            return false;
+        }
+        _acquired_ns = _stats->on_acquired();
+        return true;
+    }
+
+    void unlock() {
+        _stats->on_released(_acquired_ns);
+        _lock.unlock();
+    }
+
+private:
+    LockType _lock;
+    LockStats* _stats;
+    int64_t _acquired_ns = 0;
+};
+
+using InstrumentedMutex = InstrumentedLock<std::mutex>;
+
+}
+
+#endif // DORIS_BE_SRC_UTIL_LOCK_STATS_H
@@ -17,6 +17,8 @@
 
 #include "util/metrics.h"
 
+#include <algorithm>
+
 namespace doris {
 
 MetricLabels MetricLabels::EmptyLabels;
@@ -53,6 +55,63 @@ void Metric::hide() {
     _registry = nullptr;
 }
 
+const int Histogram::NUM_BUCKETS;
+
+int64_t Histogram::_sum_cores(const CoreLocalValue<int64_t>& value) {
+    int64_t sum = 0;
+    for (int i = 0; i < value.size(); ++i) {
+        sum += *value.access_at_core(i);
+    }
+    return sum;
+}
+
+void Histogram::get_buckets(std::vector<int64_t>* buckets) const {
+    buckets->resize(NUM_BUCKETS);
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        (*buckets)[i] = _sum_cores(_buckets[i]);
+    }
+}
+
+int64_t Histogram::count() const {
+    int64_t count = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        count += _sum_cores(_buckets[i]);
+    }
+    return count;
+}
+
+int64_t Histogram::sum() const {
+    return _sum_cores(_sum);
+}
+
+double Histogram::percentile(double percentile) const {
+    std::vector<int64_t> buckets;
+    get_buckets(&buckets);
+    int64_t count = 0;
+    for (auto bucket : buckets) {
+        count += bucket;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    double rank = std::min(std::max(percentile, 0.0), 100.0) / 100 * count;
+    int64_t below = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        if (buckets[i] == 0 || below + buckets[i] < rank) {
+            below += buckets[i];
+            continue;
+        }
+        int64_t lower = bucket_lower_bound(i);
+        if (i == NUM_BUCKETS - 1) {
+            // the last bucket has no end
+            return lower;
+        }
+        int64_t upper = bucket_lower_bound(i + 1);
+        return lower + (upper - lower) * (rank - below) / buckets[i];
+    }
+    return bucket_lower_bound(NUM_BUCKETS - 1);
+}
+
 bool MetricCollector::add_metic(const MetricLabels& labels, Metric* metric) {
     if (empty()) {
         _type = metric->type();
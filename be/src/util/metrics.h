@@ -25,6 +25,7 @@
 #include <string>
 #include <mutex>
 #include <iomanip>
+#include <vector>
 
 #include "util/spinlock.h"
 #include "util/core_local.h"
@@ -143,6 +144,54 @@ public:
     virtual ~LockGauge() { }
 };
 
+// Distribution of non-negative values, e.g. latencies. Values are counted in
+// log-linear buckets, four for every power of two like in HDR histograms, so
+// percentiles are at most 25% above the real ones, up to 2^32 where the last
+// bucket begins. Every bucket is a core local counter, so adding a value does
+// not contend with other cores.
+class Histogram : public Metric {
+public:
+    static const int NUM_BUCKETS = 124;
+
+    Histogram() : Metric(MetricType::HISTOGRAM) { }
+    virtual ~Histogram() { }
+
+    void add(int64_t value) {
+        __sync_fetch_and_add(_buckets[bucket_index(value)].access(), 1);
+        __sync_fetch_and_add(_sum.access(), value < 0 ? 0 : value);
+    }
+
+    // counts of the buckets on all cores
+    void get_buckets(std::vector<int64_t>* buckets) const;
+    int64_t count() const;
+    int64_t sum() const;
+    // value below which 'percentile' percent of the values are, interpolated
+    // in its bucket, 0 if there is none
+    double percentile(double percentile) const;
+
+    static int bucket_index(int64_t value) {
+        if (value < 4) {
+            return value < 0 ? 0 : value;
+        }
+        int exponent = 63 - __builtin_clzll(value);
+        int index = (exponent - 1) * 4 + ((value >> (exponent - 2)) & 3);
+        return index < NUM_BUCKETS ? index : NUM_BUCKETS - 1;
+    }
+    // lowest value of the bucket, the bucket ends at that of the next one
+    static int64_t bucket_lower_bound(int index) {
+        if (index < 4) {
+            return index;
+        }
+        return static_cast<int64_t>(4 + index % 4) << (index / 4 - 1);
+    }
+
+private:
+    static int64_t _sum_cores(const CoreLocalValue<int64_t>& value);
+
+    CoreLocalValue<int64_t> _buckets[NUM_BUCKETS];
+    CoreLocalValue<int64_t> _sum;
+};
+
 // one key-value pair used to
 struct MetricLabel {
     std::string name;
@@ -30,6 +30,7 @@ typedef unsigned char uchar;
 #define int3store(T, A) do { *(T) =  (uchar)((A));\
     *(T + 1) = (uchar)(((uint32_t)(A) >> 8));\
     *(T + 2) = (uchar)(((A) >> 16)); } while (0)
+#define int4store(T, A) *((uint32_t*)(T)) = (uint32_t)(A)
 #define int8store(T, A) *((int64_t *)(T)) = (uint64_t)(A)
 
 #define MY_ALIGN(A, L) (((A) + (L) - 1) & ~((L) - 1))
@@ -19,9 +19,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "common/logging.h"
 #include "gutil/strings/numbers.h"
+#include "runtime/datetime_value.h"
 #include "util/mysql_global.h"
 
 namespace doris {
@@ -56,6 +58,7 @@ static char* pack_vlen(char* packet, uint64_t length) {
     return packet + 8;
 }
 MysqlRowBuffer::MysqlRowBuffer():
+    _is_binary_format(false),
     _pos(_default_buf),
     _buf(_default_buf),
     _buf_size(sizeof(_default_buf)) {
@@ -100,29 +103,45 @@ int MysqlRowBuffer::reserve(int size) {
     return 0;
 }
 
-int MysqlRowBuffer::push_tinyint(int8_t data) {
-    // 1 for string trail, 1 for length, 1 for sign, other for digits
-    int ret = reserve(3 + MAX_TINYINT_WIDTH);
+int MysqlRowBuffer::push_fixed(const void* data, int size) {
+    int ret = reserve(size);
 
     if (0 != ret) {
         LOG(ERROR) << "mysql row buffer reserver failed.";
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_TINYINT_WIDTH + 2, "%d", data);
+    // values of the binary protocol are little endian as in memory
+    memcpy(_pos, data, size);
+    _pos += size;
+    return 0;
+}
 
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
+int MysqlRowBuffer::push_tinyint(int8_t data) {
+    if (_is_binary_format) {
+        return push_fixed(&data, sizeof(data));
     }
 
-    int1store(_pos, length);
-    _pos += length + 1;
+    // 1 for length, 1 for sign, 1 for string trail, other for digits
+    int ret = reserve(3 + MAX_TINYINT_WIDTH);
+
+    if (0 != ret) {
+        LOG(ERROR) << "mysql row buffer reserver failed.";
+        return ret;
+    }
+
+    char* end = FastInt32ToBufferLeft(data, _pos + 1);
+    int1store(_pos, end - _pos - 1);
+    _pos = end;
     return 0;
 }
 
 int MysqlRowBuffer::push_smallint(int16_t data) {
-    // 1 for string trail, 1 for length, 1 for sign, other for digits
+    if (_is_binary_format) {
+        return push_fixed(&data, sizeof(data));
+    }
+
+    // 1 for length, 1 for sign, 1 for string trail, other for digits
     int ret = reserve(3 + MAX_SMALLINT_WIDTH);
 
     if (0 != ret) {
@@ -130,20 +149,18 @@ int MysqlRowBuffer::push_smallint(int16_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_SMALLINT_WIDTH + 2, "%d", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
-
-    int1store(_pos, length);
-    _pos += length + 1;
+    char* end = FastInt32ToBufferLeft(data, _pos + 1);
+    int1store(_pos, end - _pos - 1);
+    _pos = end;
     return 0;
 }
 
 int MysqlRowBuffer::push_int(int32_t data) {
-    // 1 for string trail, 1 for length, 1 for sign, other for digits
+    if (_is_binary_format) {
+        return push_fixed(&data, sizeof(data));
+    }
+
+    // 1 for length, 1 for sign, 1 for string trail, other for digits
     int ret = reserve(3 + MAX_INT_WIDTH);
 
     if (0 != ret) {
@@ -151,20 +168,18 @@ int MysqlRowBuffer::push_int(int32_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_INT_WIDTH + 2, "%d", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
-
-    int1store(_pos, length);
-    _pos += length + 1;
+    char* end = FastInt32ToBufferLeft(data, _pos + 1);
+    int1store(_pos, end - _pos - 1);
+    _pos = end;
     return 0;
 }
 
 int MysqlRowBuffer::push_bigint(int64_t data) {
-    // 1 for string trail, 1 for length, 1 for sign, other for digits
+    if (_is_binary_format) {
+        return push_fixed(&data, sizeof(data));
+    }
+
+    // 1 for length, 1 for sign, 1 for string trail, other for digits
     int ret = reserve(3 + MAX_BIGINT_WIDTH);
 
     if (0 != ret) {
@@ -172,40 +187,36 @@ int MysqlRowBuffer::push_bigint(int64_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_BIGINT_WIDTH + 2, "%ld", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
-
-    int1store(_pos, length);
-    _pos += length + 1;
+    char* end = FastInt64ToBufferLeft(data, _pos + 1);
+    int1store(_pos, end - _pos - 1);
+    _pos = end;
     return 0;
 }
 
 int MysqlRowBuffer::push_unsigned_bigint(uint64_t data) {
-    // 1 for string trail, 1 for length, 1 for sign, other for digits
-    int ret = reserve(4 + MAX_BIGINT_WIDTH);
+    if (_is_binary_format) {
+        return push_fixed(&data, sizeof(data));
+    }
+
+    // 1 for length, 1 for string trail, other for digits
+    int ret = reserve(2 + MAX_BIGINT_WIDTH);
 
     if (0 != ret) {
         LOG(ERROR) << "mysql row buffer reserver failed.";
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_BIGINT_WIDTH + 3, "%ld", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
-
-    int1store(_pos, length);
-    _pos += length + 1;
+    char* end = FastUInt64ToBufferLeft(data, _pos + 1);
+    int1store(_pos, end - _pos - 1);
+    _pos = end;
     return 0;
 }
 
 int MysqlRowBuffer::push_float(float data) {
+    if (_is_binary_format) {
+        return push_fixed(&data, sizeof(data));
+    }
+
     // 1 for string trail, 1 for length, 1 for sign, other for digits
     int ret = reserve(3 + MAX_FLOAT_STR_LENGTH);
 
@@ -227,6 +238,10 @@ int MysqlRowBuffer::push_float(float data) {
 }
 
 int MysqlRowBuffer::push_double(double data) {
+    if (_is_binary_format) {
+        return push_fixed(&data, sizeof(data));
+    }
+
     // 1 for string trail, 1 for length, 1 for sign, other for digits
     int ret = reserve(3 + MAX_DOUBLE_STR_LENGTH);
 
@@ -247,6 +262,57 @@ int MysqlRowBuffer::push_double(double data) {
     return 0;
 }
 
+int MysqlRowBuffer::push_datetime(const DateTimeValue& data) {
+    // 1 for length, other for the longest binary value or text with sign,
+    // microseconds and string trail
+    int ret = reserve(1 + 32);
+
+    if (0 != ret) {
+        LOG(ERROR) << "mysql row buffer reserver failed.";
+        return ret;
+    }
+
+    if (!_is_binary_format) {
+        // to_string() formats by digit pairs, not by printf
+        char* end = data.to_string(_pos + 1);
+        int1store(_pos, end - _pos - 2);
+        _pos = end - 1;
+        return 0;
+    }
+
+    // the length is 0, 4, 7 or 11 as trailing zero parts are left out
+    int length = 11;
+    if (data.microsecond() == 0) {
+        length = 7;
+        if (data.hour() == 0 && data.minute() == 0 && data.second() == 0) {
+            length = 4;
+            if (data.year() == 0 && data.month() == 0 && data.day() == 0) {
+                length = 0;
+            }
+        }
+    }
+    char* pos = _pos;
+    int1store(pos++, length);
+    if (length >= 4) {
+        int2store(pos, data.year());
+        int1store(pos + 2, data.month());
+        int1store(pos + 3, data.day());
+        pos += 4;
+    }
+    if (length >= 7) {
+        int1store(pos, data.hour());
+        int1store(pos + 1, data.minute());
+        int1store(pos + 2, data.second());
+        pos += 3;
+    }
+    if (length == 11) {
+        int4store(pos, data.microsecond());
+        pos += 4;
+    }
+    _pos = pos;
+    return 0;
+}
+
 int MysqlRowBuffer::push_string(const char* str, int length) {
     // 9 for length pack max, 1 for sign, other for digits
     if (NULL == str) {
@@ -267,6 +333,16 @@ int MysqlRowBuffer::push_string(const char* str, int length) {
     return 0;
 }
 
+void MysqlRowBuffer::init_binary_row(int num_columns, std::string* row) {
+    // a 0 byte, then the NULL bits of the columns from bit 2 on
+    row->assign(1 + (num_columns + 7 + 2) / 8, '\0');
+}
+
+void MysqlRowBuffer::set_binary_null(int column, std::string* row) {
+    int bit = column + 2;
+    (*row)[1 + bit / 8] |= 1 << (bit % 8);
+}
+
 int MysqlRowBuffer::push_null() {
     int ret = reserve(1);
 
@@ -20,10 +20,16 @@
 
 #include <stdint.h>
 
+#include <string>
+
 namespace doris {
 
+class DateTimeValue;
+
 // helper for construct MySQL send row
-// Now only support text protocol
+// Values are in the text protocol, or in the binary protocol of the results
+// of prepared statements if set_binary_format() is called. NULLs of binary
+// rows are not values but bits in the row header, see init_binary_row().
 class MysqlRowBuffer {
 public:
     MysqlRowBuffer();
@@ -33,6 +39,10 @@ public:
         _pos = _buf;
     }
 
+    void set_binary_format(bool is_binary_format) {
+        _is_binary_format = is_binary_format;
+    }
+
     // TODO(zhaochun): add signed/unsigned support
     int push_tinyint(int8_t data);
     int push_smallint(int16_t data);
@@ -41,9 +51,17 @@ public:
     int push_unsigned_bigint(uint64_t data);
     int push_float(float data);
     int push_double(double data);
+    int push_datetime(const DateTimeValue& data);
     int push_string(const char* str, int length);
+    // only in the text protocol
     int push_null();
 
+    // Sets 'row' to the header of a binary row of 'num_columns' values, all
+    // not NULL.
+    static void init_binary_row(int num_columns, std::string* row);
+    // Marks the value of 'column' NULL in a row started by init_binary_row().
+    static void set_binary_null(int column, std::string* row);
+
     // this function reserved size, change the pos step size, return old pos
     // Becareful when use the returned pointer.
     char* reserved(int size);
@@ -59,7 +77,9 @@ public:
     }
 private:
     int reserve(int size);
+    int push_fixed(const void* data, int size);
 
+    bool _is_binary_format;
     char* _pos;
     char* _buf;
     int _buf_size;
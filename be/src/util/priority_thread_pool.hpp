@@ -18,7 +18,9 @@
 #ifndef DORIS_BE_SRC_COMMON_UTIL_PRIORITY_THREAD_POOL_HPP
 #define DORIS_BE_SRC_COMMON_UTIL_PRIORITY_THREAD_POOL_HPP
 
-#include "util/blocking_priority_queue.hpp"
+#include <algorithm>
+
+#include "util/work_stealing_queue.hpp"
 
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -35,6 +37,9 @@ public:
     // process.
     typedef boost::function<void ()> WorkFunction;
 
+    // Tasks are queued at one of these levels, see offer().
+    static const int NUM_PRIORITY_LEVELS = 16;
+
     struct Task {
     public:
         int priority;
@@ -57,7 +62,7 @@ public:
     //  -- work_function: the function to run every time an item is consumed from the queue
     PriorityThreadPool(uint32_t num_threads, uint32_t queue_size) :
             _thread_num(num_threads),
-            _work_queue(queue_size),
+            _work_queue(num_threads, queue_size, NUM_PRIORITY_LEVELS),
             _shutdown(false) {
         for (int i = 0; i < num_threads; ++i) {
             _threads.create_thread(
@@ -84,8 +89,12 @@ public:
     //
     // Returns true if the work item was successfully added to the queue, false otherwise
     // (which typically means that the thread pool has already been shut down).
+    //
+    // Tasks of a higher priority run first, priorities above NUM_PRIORITY_LEVELS - 1 are
+    // the same as it. The order is approximate, see WorkStealingQueue.
     bool offer(Task task) {
-        return _work_queue.blocking_put(task);
+        int level = std::min(std::max(task.priority, 0), NUM_PRIORITY_LEVELS - 1);
+        return _work_queue.blocking_put(task, level);
     }
 
     // Shuts the thread pool down, causing the work queue to cease accepting offered work
@@ -130,7 +139,7 @@ private:
     void work_thread(int thread_id) {
         while (!is_shutdown()) {
             Task task;
-            if (_work_queue.blocking_get(&task)) {
+            if (_work_queue.blocking_get(thread_id, &task)) {
                 task.work_function();
             }
             if (_work_queue.get_size() == 0) {
@@ -147,9 +156,8 @@ private:
 
     uint32_t _thread_num;
 
-    // Queue on which work items are held until a thread is available to process them in
-    // FIFO order.
-    BlockingPriorityQueue<Task> _work_queue;
+    // Queue on which work items are held until a thread is available to process them.
+    WorkStealingQueue<Task> _work_queue;
 
     // Collection of worker threads that process work from the queue.
     boost::thread_group _threads;
@@ -0,0 +1,55 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "util/rate_limiter.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "util/time.h"
+
+namespace doris {
+
+RateLimiter::RateLimiter(int64_t bytes_per_second)
+        : _bytes_per_second(bytes_per_second), _next_free_us(0) {
+}
+
+void RateLimiter::set_rate(int64_t bytes_per_second) {
+    std::lock_guard<std::mutex> l(_lock);
+    _bytes_per_second = bytes_per_second;
+}
+
+void RateLimiter::acquire(int64_t bytes) {
+    int64_t now = MonotonicMicros();
+    int64_t start = 0;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (_bytes_per_second <= 0) {
+            return;
+        }
+        // time not used by anyone is lost, it does not allow bursts later
+        start = std::max(now, _next_free_us);
+        _next_free_us = start + bytes * 1000000 / _bytes_per_second;
+    }
+    if (start > now) {
+        usleep(start - now);
+    }
+}
+
+}
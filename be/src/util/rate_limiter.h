@@ -0,0 +1,49 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#ifndef DORIS_BE_SRC_UTIL_RATE_LIMITER_H
+#define DORIS_BE_SRC_UTIL_RATE_LIMITER_H
+
+#include <stdint.h>
+
+#include <mutex>
+
+namespace doris {
+
+// Keeps the bytes used by several threads within a rate. Every caller is
+// given the next free span of time its bytes take at the rate, and sleeps
+// until it starts, so the callers share the rate in order of arrival.
+class RateLimiter {
+public:
+    explicit RateLimiter(int64_t bytes_per_second);
+
+    // Blocks until 'bytes' are within the rate.
+    void acquire(int64_t bytes);
+
+    void set_rate(int64_t bytes_per_second);
+
+private:
+    std::mutex _lock;
+    int64_t _bytes_per_second;
+    // time in microseconds when the bytes acquired so far are used
+    int64_t _next_free_us;
+};
+
+}
+
+#endif // DORIS_BE_SRC_UTIL_RATE_LIMITER_H
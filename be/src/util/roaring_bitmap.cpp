@@ -0,0 +1,348 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/roaring_bitmap.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace doris {
+
+static int popcount(const std::vector<uint64_t>& bits) {
+    int count = 0;
+    for (uint64_t word : bits) {
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+void RoaringBitmap::Container::add(uint16_t value) {
+    if (is_bitset()) {
+        uint64_t mask = 1ULL << (value % 64);
+        if ((bits[value / 64] & mask) == 0) {
+            bits[value / 64] |= mask;
+            ++cardinality;
+        }
+        return;
+    }
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    if (it != values.end() && *it == value) {
+        return;
+    }
+    values.insert(it, value);
+    ++cardinality;
+    if (cardinality > ARRAY_MAX_SIZE) {
+        to_bitset();
+    }
+}
+
+bool RoaringBitmap::Container::contains(uint16_t value) const {
+    if (is_bitset()) {
+        return (bits[value / 64] >> (value % 64)) & 1;
+    }
+    return std::binary_search(values.begin(), values.end(), value);
+}
+
+bool RoaringBitmap::Container::intersects(uint16_t lo, uint16_t hi) const {
+    if (is_bitset()) {
+        for (int i = lo / 64; i <= hi / 64; ++i) {
+            uint64_t word = bits[i];
+            if (i == lo / 64) {
+                word &= ~0ULL << (lo % 64);
+            }
+            if (i == hi / 64) {
+                word &= ~0ULL >> (63 - hi % 64);
+            }
+            if (word != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    auto it = std::lower_bound(values.begin(), values.end(), lo);
+    return it != values.end() && *it <= hi;
+}
+
+void RoaringBitmap::Container::union_with(const Container& other) {
+    if (!is_bitset() && !other.is_bitset()) {
+        std::vector<uint16_t> result;
+        result.reserve(values.size() + other.values.size());
+        std::set_union(values.begin(), values.end(), other.values.begin(), other.values.end(),
+                       std::back_inserter(result));
+        values.swap(result);
+        cardinality = values.size();
+        if (cardinality > ARRAY_MAX_SIZE) {
+            to_bitset();
+        }
+        return;
+    }
+    to_bitset();
+    if (other.is_bitset()) {
+        for (int i = 0; i < BITSET_WORDS; ++i) {
+            bits[i] |= other.bits[i];
+        }
+    } else {
+        for (uint16_t value : other.values) {
+            bits[value / 64] |= 1ULL << (value % 64);
+        }
+    }
+    cardinality = popcount(bits);
+}
+
+void RoaringBitmap::Container::intersect_with(const Container& other) {
+    if (is_bitset() && other.is_bitset()) {
+        for (int i = 0; i < BITSET_WORDS; ++i) {
+            bits[i] &= other.bits[i];
+        }
+        cardinality = popcount(bits);
+        if (cardinality <= ARRAY_MAX_SIZE) {
+            to_array();
+        }
+        return;
+    }
+    std::vector<uint16_t> result;
+    if (!is_bitset() && !other.is_bitset()) {
+        std::set_intersection(values.begin(), values.end(),
+                              other.values.begin(), other.values.end(),
+                              std::back_inserter(result));
+    } else {
+        // at most ARRAY_MAX_SIZE values are left, those of the array
+        const Container& array = is_bitset() ? other : *this;
+        const Container& bitset = is_bitset() ? *this : other;
+        for (uint16_t value : array.values) {
+            if (bitset.contains(value)) {
+                result.push_back(value);
+            }
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+    values.swap(result);
+    cardinality = values.size();
+}
+
+void RoaringBitmap::Container::to_bitset() {
+    if (is_bitset()) {
+        return;
+    }
+    bits.assign(BITSET_WORDS, 0);
+    for (uint16_t value : values) {
+        bits[value / 64] |= 1ULL << (value % 64);
+    }
+    values.clear();
+    values.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::to_array() {
+    values.clear();
+    values.reserve(cardinality);
+    for (int i = 0; i < BITSET_WORDS; ++i) {
+        for (uint64_t word = bits[i]; word != 0; word &= word - 1) {
+            values.push_back(i * 64 + __builtin_ctzll(word));
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+const RoaringBitmap::Container* RoaringBitmap::find(uint16_t key) const {
+    auto it = std::lower_bound(_containers.begin(), _containers.end(), key,
+            [](const Container& container, uint16_t key) { return container.key < key; });
+    if (it == _containers.end() || it->key != key) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t key = value >> 16;
+    // values mostly come in order, the last container is checked first
+    if (_containers.empty() || _containers.back().key < key) {
+        _containers.emplace_back();
+        _containers.back().key = key;
+        _containers.back().add(value & 0xFFFF);
+        return;
+    }
+    auto it = std::lower_bound(_containers.begin(), _containers.end(), key,
+            [](const Container& container, uint16_t key) { return container.key < key; });
+    if (it->key != key) {
+        it = _containers.emplace(it);
+        it->key = key;
+    }
+    it->add(value & 0xFFFF);
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    const Container* container = find(value >> 16);
+    return container != nullptr && container->contains(value & 0xFFFF);
+}
+
+bool RoaringBitmap::intersects(uint32_t begin, uint32_t end) const {
+    if (begin >= end) {
+        return false;
+    }
+    uint32_t last = end - 1;
+    uint16_t first_key = begin >> 16;
+    uint16_t last_key = last >> 16;
+    auto it = std::lower_bound(_containers.begin(), _containers.end(), first_key,
+            [](const Container& container, uint16_t key) { return container.key < key; });
+    for (; it != _containers.end() && it->key <= last_key; ++it) {
+        uint16_t lo = it->key == first_key ? begin & 0xFFFF : 0;
+        uint16_t hi = it->key == last_key ? last & 0xFFFF : 0xFFFF;
+        if (it->intersects(lo, hi)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RoaringBitmap::union_with(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    result.reserve(_containers.size() + other._containers.size());
+    auto it = _containers.begin();
+    auto other_it = other._containers.begin();
+    while (it != _containers.end() || other_it != other._containers.end()) {
+        if (other_it == other._containers.end()
+                || (it != _containers.end() && it->key < other_it->key)) {
+            result.push_back(std::move(*it++));
+        } else if (it == _containers.end() || other_it->key < it->key) {
+            result.push_back(*other_it++);
+        } else {
+            it->union_with(*other_it++);
+            result.push_back(std::move(*it++));
+        }
+    }
+    _containers.swap(result);
+}
+
+void RoaringBitmap::intersect_with(const RoaringBitmap& other) {
+    size_t num_left = 0;
+    for (size_t i = 0; i < _containers.size(); ++i) {
+        const Container* other_container = other.find(_containers[i].key);
+        if (other_container == nullptr) {
+            continue;
+        }
+        _containers[i].intersect_with(*other_container);
+        if (_containers[i].cardinality == 0) {
+            continue;
+        }
+        if (num_left != i) {
+            _containers[num_left] = std::move(_containers[i]);
+        }
+        ++num_left;
+    }
+    _containers.resize(num_left);
+}
+
+uint64_t RoaringBitmap::cardinality() const {
+    uint64_t cardinality = 0;
+    for (auto& container : _containers) {
+        cardinality += container.cardinality;
+    }
+    return cardinality;
+}
+
+size_t RoaringBitmap::serialized_size() const {
+    size_t size = sizeof(uint32_t);
+    for (auto& container : _containers) {
+        size += sizeof(uint16_t) + sizeof(uint32_t);
+        if (container.is_bitset()) {
+            size += BITSET_WORDS * sizeof(uint64_t);
+        } else {
+            size += container.values.size() * sizeof(uint16_t);
+        }
+    }
+    return size;
+}
+
+void RoaringBitmap::serialize(char* dst) const {
+    uint32_t num_containers = _containers.size();
+    memcpy(dst, &num_containers, sizeof(num_containers));
+    dst += sizeof(num_containers);
+    for (auto& container : _containers) {
+        memcpy(dst, &container.key, sizeof(container.key));
+        dst += sizeof(container.key);
+        memcpy(dst, &container.cardinality, sizeof(container.cardinality));
+        dst += sizeof(container.cardinality);
+        if (container.is_bitset()) {
+            memcpy(dst, container.bits.data(), BITSET_WORDS * sizeof(uint64_t));
+            dst += BITSET_WORDS * sizeof(uint64_t);
+        } else {
+            memcpy(dst, container.values.data(), container.values.size() * sizeof(uint16_t));
+            dst += container.values.size() * sizeof(uint16_t);
+        }
+    }
+}
+
+bool RoaringBitmap::deserialize(const char* src, size_t size) {
+    _containers.clear();
+    const char* end = src + size;
+    uint32_t num_containers = 0;
+    if (size < sizeof(num_containers)) {
+        return false;
+    }
+    memcpy(&num_containers, src, sizeof(num_containers));
+    src += sizeof(num_containers);
+    // every container takes at least 8 bytes, so a corrupt count is not reserved
+    if (num_containers > (end - src) / 8) {
+        return false;
+    }
+    _containers.resize(num_containers);
+    for (uint32_t i = 0; i < num_containers; ++i) {
+        Container& container = _containers[i];
+        if (end - src < static_cast<ptrdiff_t>(sizeof(uint16_t) + sizeof(uint32_t))) {
+            return false;
+        }
+        memcpy(&container.key, src, sizeof(container.key));
+        src += sizeof(container.key);
+        memcpy(&container.cardinality, src, sizeof(container.cardinality));
+        src += sizeof(container.cardinality);
+        if ((i > 0 && container.key <= _containers[i - 1].key)
+                || container.cardinality == 0 || container.cardinality > 65536) {
+            return false;
+        }
+        if (container.cardinality > ARRAY_MAX_SIZE) {
+            if (end - src < static_cast<ptrdiff_t>(BITSET_WORDS * sizeof(uint64_t))) {
+                return false;
+            }
+            container.bits.resize(BITSET_WORDS);
+            memcpy(container.bits.data(), src, BITSET_WORDS * sizeof(uint64_t));
+            src += BITSET_WORDS * sizeof(uint64_t);
+            if (static_cast<uint32_t>(popcount(container.bits)) != container.cardinality) {
+                return false;
+            }
+        } else {
+            size_t bytes = container.cardinality * sizeof(uint16_t);
+            if (end - src < static_cast<ptrdiff_t>(bytes)) {
+                return false;
+            }
+            container.values.resize(container.cardinality);
+            memcpy(container.values.data(), src, bytes);
+            src += bytes;
+            for (uint32_t j = 1; j < container.cardinality; ++j) {
+                if (container.values[j] <= container.values[j - 1]) {
+                    return false;
+                }
+            }
+        }
+    }
+    return src == end;
+}
+
+}
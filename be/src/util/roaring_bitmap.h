@@ -0,0 +1,98 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_UTIL_ROARING_BITMAP_H
+#define DORIS_BE_SRC_UTIL_ROARING_BITMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace doris {
+
+// A set of 32 bits unsigned integers in the layout of Roaring bitmaps. The values are
+// grouped by their high 16 bits. The low 16 bits of the values of a group are kept in
+// a sorted array while there are at most ARRAY_MAX_SIZE of them, in a bitset of 2^16
+// bits otherwise. So a set takes at most 2 bytes per value whatever the range of the
+// values, and unions and intersections work a group at a time.
+//
+// The serialized set is: the number of groups (4 bytes), then for each group its high
+// bits (2 bytes), its number of values (4 bytes) and either the array (2 bytes per
+// value) or the bitset (8192 bytes), all little endian.
+class RoaringBitmap {
+public:
+    static const uint32_t ARRAY_MAX_SIZE = 4096;
+
+    RoaringBitmap() { }
+
+    void add(uint32_t value);
+
+    bool contains(uint32_t value) const;
+
+    // Returns true if any value in [begin, end) is in this set.
+    bool intersects(uint32_t begin, uint32_t end) const;
+
+    // Sets this to the union of this and 'other'.
+    void union_with(const RoaringBitmap& other);
+
+    // Sets this to the intersection of this and 'other'.
+    void intersect_with(const RoaringBitmap& other);
+
+    uint64_t cardinality() const;
+
+    size_t serialized_size() const;
+
+    // Writes serialized_size() bytes to 'dst'.
+    void serialize(char* dst) const;
+
+    // Replaces this set by the serialized one, returns false if 'src' is not a
+    // serialized set.
+    bool deserialize(const char* src, size_t size);
+
+private:
+    static const int BITSET_WORDS = 65536 / 64;
+
+    struct Container {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        // sorted low bits of the values if 'bits' is empty
+        std::vector<uint16_t> values;
+        // BITSET_WORDS words if there are more than ARRAY_MAX_SIZE values
+        std::vector<uint64_t> bits;
+
+        bool is_bitset() const { return !bits.empty(); }
+        void add(uint16_t value);
+        bool contains(uint16_t value) const;
+        // whether any value in [lo, hi] is in this container
+        bool intersects(uint16_t lo, uint16_t hi) const;
+        void union_with(const Container& other);
+        void intersect_with(const Container& other);
+        void to_bitset();
+        void to_array();
+    };
+
+    // the container of 'key', nullptr if there is none
+    const Container* find(uint16_t key) const;
+
+    // sorted by key, none of them is empty
+    std::vector<Container> _containers;
+};
+
+}
+
+#endif
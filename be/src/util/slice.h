@@ -180,7 +180,7 @@ public:
 /// Check whether two slices are identical.
 inline bool operator==(const Slice& x, const Slice& y) {
     return ((x.size == y.size) &&
-            (Slice::mem_equal(x.data, y.data, x.size)));
+            (x.data == y.data || Slice::mem_equal(x.data, y.data, x.size)));
 }
 
 /// Check whether two slices are not identical.
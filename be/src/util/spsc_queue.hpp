@@ -0,0 +1,86 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_COMMON_UTIL_SPSC_QUEUE_HPP
+#define DORIS_BE_SRC_COMMON_UTIL_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+
+namespace doris {
+
+// Bounded ring of elements passed from one producer thread to one consumer thread
+// without a lock. The producer may be a different thread over time, as long as one
+// hands over to the next with a happens-before, e.g. through a lock; the same for
+// the consumer. The capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        _capacity = 1;
+        while (_capacity < capacity) {
+            _capacity <<= 1;
+        }
+        _buffer.reset(new T[_capacity]);
+    }
+
+    // Called by the producer, returns false if the queue is full.
+    bool try_push(const T& val) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == _capacity) {
+            return false;
+        }
+        _buffer[tail & (_capacity - 1)] = val;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Called by the consumer, returns false if the queue is empty.
+    bool try_pop(T* out) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *out = _buffer[head & (_capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Exact only when called by the producer or the consumer.
+    size_t size() const {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    bool full() const {
+        return size() >= _capacity;
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+private:
+    size_t _capacity;
+    std::unique_ptr<T[]> _buffer;
+    // written by the consumer, on another cache line than the producer's _tail
+    alignas(64) std::atomic<size_t> _head{0};
+    alignas(64) std::atomic<size_t> _tail{0};
+};
+
+}
+
+#endif
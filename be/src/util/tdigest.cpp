@@ -0,0 +1,186 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/tdigest.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace doris {
+
+constexpr double TDigest::DEFAULT_COMPRESSION;
+
+// values buffered per unit of compression before they are merged
+static const size_t BUFFER_FACTOR = 5;
+
+TDigest::TDigest(double compression) : _compression(compression) {
+}
+
+void TDigest::add(double value, double weight) {
+    if (isnan(value) || !(weight > 0)) {
+        return;
+    }
+    if (_total_weight == 0) {
+        _min = value;
+        _max = value;
+    } else {
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+    _total_weight += weight;
+    _unmerged.push_back({value, weight});
+    if (_unmerged.size() >= BUFFER_FACTOR * _compression) {
+        _compress();
+    }
+}
+
+void TDigest::merge(const TDigest& other) {
+    if (other._total_weight == 0) {
+        return;
+    }
+    if (_total_weight == 0) {
+        _min = other._min;
+        _max = other._max;
+    } else {
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+    }
+    _total_weight += other._total_weight;
+    _unmerged.insert(_unmerged.end(), other._centroids.begin(), other._centroids.end());
+    _unmerged.insert(_unmerged.end(), other._unmerged.begin(), other._unmerged.end());
+    if (_unmerged.size() >= BUFFER_FACTOR * _compression) {
+        _compress();
+    }
+}
+
+void TDigest::_compress() {
+    if (_unmerged.empty()) {
+        return;
+    }
+    _unmerged.insert(_unmerged.end(), _centroids.begin(), _centroids.end());
+    std::sort(_unmerged.begin(), _unmerged.end(),
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+    _centroids.clear();
+
+    double weight_so_far = 0;
+    Centroid current = _unmerged[0];
+    for (size_t i = 1; i < _unmerged.size(); ++i) {
+        const Centroid& next = _unmerged[i];
+        double proposed = current.weight + next.weight;
+        double q0 = weight_so_far / _total_weight;
+        double q2 = (weight_so_far + proposed) / _total_weight;
+        double limit = 4 * _total_weight * std::min(q0 * (1 - q0), q2 * (1 - q2)) / _compression;
+        if (proposed <= limit) {
+            current.mean += (next.mean - current.mean) * next.weight / proposed;
+            current.weight = proposed;
+        } else {
+            weight_so_far += current.weight;
+            _centroids.push_back(current);
+            current = next;
+        }
+    }
+    _centroids.push_back(current);
+    _unmerged.clear();
+}
+
+double TDigest::quantile(double q) {
+    _compress();
+    if (_centroids.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (_centroids.size() == 1) {
+        return _centroids[0].mean;
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    // the weight of a centroid is spread around its mean, values between the
+    // means of neighbouring centroids are interpolated
+    double index = q * _total_weight;
+    double first_center = _centroids[0].weight / 2;
+    if (index <= first_center) {
+        return _min + (_centroids[0].mean - _min) * index / first_center;
+    }
+    double weight_so_far = 0;
+    for (size_t i = 0; i + 1 < _centroids.size(); ++i) {
+        double center = weight_so_far + _centroids[i].weight / 2;
+        double next_center = weight_so_far + _centroids[i].weight + _centroids[i + 1].weight / 2;
+        if (index <= next_center) {
+            double fraction = (index - center) / (next_center - center);
+            return _centroids[i].mean + (_centroids[i + 1].mean - _centroids[i].mean) * fraction;
+        }
+        weight_so_far += _centroids[i].weight;
+    }
+    const Centroid& last = _centroids.back();
+    double last_center = _total_weight - last.weight / 2;
+    double fraction = (index - last_center) / (last.weight / 2);
+    return last.mean + (_max - last.mean) * std::min(1.0, fraction);
+}
+
+// compression, min, max, number of centroids, then mean and weight of each
+size_t TDigest::serialized_size() {
+    _compress();
+    return 3 * sizeof(double) + sizeof(uint32_t) + _centroids.size() * sizeof(Centroid);
+}
+
+void TDigest::serialize(char* dst) {
+    _compress();
+    memcpy(dst, &_compression, sizeof(double));
+    dst += sizeof(double);
+    memcpy(dst, &_min, sizeof(double));
+    dst += sizeof(double);
+    memcpy(dst, &_max, sizeof(double));
+    dst += sizeof(double);
+    uint32_t num_centroids = _centroids.size();
+    memcpy(dst, &num_centroids, sizeof(num_centroids));
+    dst += sizeof(num_centroids);
+    memcpy(dst, _centroids.data(), num_centroids * sizeof(Centroid));
+}
+
+bool TDigest::deserialize(const char* src, size_t size) {
+    size_t header_size = 3 * sizeof(double) + sizeof(uint32_t);
+    if (size < header_size) {
+        return false;
+    }
+    double compression = 0;
+    memcpy(&compression, src, sizeof(double));
+    uint32_t num_centroids = 0;
+    memcpy(&num_centroids, src + 3 * sizeof(double), sizeof(num_centroids));
+    if (!(compression > 0) || size != header_size + num_centroids * sizeof(Centroid)) {
+        return false;
+    }
+    std::vector<Centroid> centroids(num_centroids);
+    memcpy(centroids.data(), src + header_size, num_centroids * sizeof(Centroid));
+    double total_weight = 0;
+    for (size_t i = 0; i < centroids.size(); ++i) {
+        if (!(centroids[i].weight > 0) || isnan(centroids[i].mean)
+                || (i > 0 && centroids[i].mean < centroids[i - 1].mean)) {
+            return false;
+        }
+        total_weight += centroids[i].weight;
+    }
+    _compression = compression;
+    memcpy(&_min, src + sizeof(double), sizeof(double));
+    memcpy(&_max, src + 2 * sizeof(double), sizeof(double));
+    _centroids.swap(centroids);
+    _unmerged.clear();
+    _total_weight = total_weight;
+    return true;
+}
+
+}
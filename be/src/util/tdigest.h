@@ -0,0 +1,77 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_UTIL_TDIGEST_H
+#define DORIS_BE_SRC_UTIL_TDIGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace doris {
+
+// A merging t-digest (Dunning and Ertl, "Computing extremely accurate quantiles
+// using t-digests") summarizes a distribution by a sorted list of centroids. A
+// centroid near quantile q holds at most 4 * n * q * (1 - q) / compression of
+// the n values, so there are about compression centroids, the tails are kept
+// with more detail than the median, and the quantiles of merged digests are as
+// accurate as those of one digest of all values.
+//
+// Added values are buffered and merged into the centroids in batches.
+class TDigest {
+public:
+    static constexpr double DEFAULT_COMPRESSION = 100;
+
+    explicit TDigest(double compression = DEFAULT_COMPRESSION);
+
+    void add(double value, double weight = 1);
+
+    void merge(const TDigest& other);
+
+    // Estimate of the value at quantile q in [0, 1], NaN if there is no value.
+    double quantile(double q);
+
+    double total_weight() const { return _total_weight; }
+
+    // The digest is compressed before it is serialized.
+    size_t serialized_size();
+    void serialize(char* dst);
+    // Returns false if 'src' is not a serialized digest.
+    bool deserialize(const char* src, size_t size);
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    // merges the buffered values into the centroids
+    void _compress();
+
+    double _compression;
+    // sorted by mean
+    std::vector<Centroid> _centroids;
+    std::vector<Centroid> _unmerged;
+    double _total_weight = 0;
+    double _min = 0;
+    double _max = 0;
+};
+
+}
+
+#endif
@@ -18,7 +18,7 @@
 #ifndef DORIS_BE_SRC_COMMON_UTIL_THREAD_POOL_HPP
 #define DORIS_BE_SRC_COMMON_UTIL_THREAD_POOL_HPP
 
-#include "util/blocking_queue.hpp"
+#include "util/work_stealing_queue.hpp"
 
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -42,7 +42,7 @@ public:
     //     capacity available.
     //  -- work_function: the function to run every time an item is consumed from the queue
     ThreadPool(uint32_t num_threads, uint32_t queue_size) : 
-            _work_queue(queue_size),
+            _work_queue(num_threads, queue_size),
             _shutdown(false) {
         for (int i = 0; i < num_threads; ++i) {
             _threads.create_thread(
@@ -116,7 +116,7 @@ private:
         while (!is_shutdown()) {
             WorkFunction work_function;
 
-            if (_work_queue.blocking_get(&work_function)) {
+            if (_work_queue.blocking_get(thread_id, &work_function)) {
                 work_function();
             }
 
@@ -132,9 +132,9 @@ private:
         return _shutdown;
     }
 
-    // Queue on which work items are held until a thread is available to process them in
-    // FIFO order.
-    BlockingQueue<WorkFunction> _work_queue;
+    // Queue on which work items are held until a thread is available to process them,
+    // in FIFO order for each thread.
+    WorkStealingQueue<WorkFunction> _work_queue;
 
     // Collection of worker threads that process work from the queue.
     boost::thread_group _threads;
@@ -150,6 +150,18 @@ public:
 
     bool codegen(RuntimeState* state);
 
+    const std::vector<ExprContext*>& key_expr_ctxs_lhs() const { return _key_expr_ctxs_lhs; }
+    const std::vector<ExprContext*>& key_expr_ctxs_rhs() const { return _key_expr_ctxs_rhs; }
+    const std::vector<bool>& is_asc() const { return _is_asc; }
+
+    std::vector<bool> nulls_first() const {
+        std::vector<bool> nulls_first;
+        for (auto v : _nulls_first) {
+            nulls_first.push_back(v < 0);
+        }
+        return nulls_first;
+    }
+
 private:
     const std::vector<ExprContext*>& _key_expr_ctxs_lhs;
     const std::vector<ExprContext*>& _key_expr_ctxs_rhs;
@@ -0,0 +1,222 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_COMMON_UTIL_WORK_STEALING_QUEUE_HPP
+#define DORIS_BE_SRC_COMMON_UTIL_WORK_STEALING_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/logging.h"
+
+namespace doris {
+
+// Bounded queue of the tasks of a thread pool with 'num_workers' threads, which
+// does not serialize all the puts and gets on one lock like BlockingQueue.
+//
+// Each worker has its own shard, a deque per priority level behind a lock of its
+// own. A worker gets from its shard, else steals from the shards of the others,
+// spins over them a few rounds when all are empty and only then parks on a
+// condition variable. Tasks put by a worker are queued in its shard, so the
+// continuations of a task usually run on the same thread, and tasks put by other
+// threads go to the shards round robin.
+//
+// The levels order tasks approximately: a shard gives the task of its highest
+// non-empty level, except one get out of STARVATION_INTERVAL which takes from the
+// lowest so low levels are not starved. There is no order between shards.
+//
+// The queue may hold a few more than 'max_elements' tasks while several threads
+// put at once.
+template <typename T>
+class WorkStealingQueue {
+public:
+    WorkStealingQueue(uint32_t num_workers, uint32_t max_elements, int num_levels = 1) :
+            _max_elements(max_elements),
+            _num_levels(std::max(num_levels, 1)) {
+        num_workers = std::max<uint32_t>(num_workers, 1);
+        for (uint32_t i = 0; i < num_workers; ++i) {
+            _shards.emplace_back(new Shard(_num_levels));
+        }
+    }
+
+    // Puts 'val' at 'level' in [0, num_levels), higher levels are got first. Blocks
+    // while the queue is full. Returns false if the queue is shut down.
+    bool blocking_put(const T& val, int level = 0) {
+        DCHECK_GE(level, 0);
+        DCHECK_LT(level, _num_levels);
+        if (_size.load() >= _max_elements && !_shutdown.load()) {
+            std::unique_lock<std::mutex> l(_park_lock);
+            ++_num_put_waiters;
+            while (_size.load() >= _max_elements && !_shutdown.load()) {
+                _put_cv.wait(l);
+            }
+            --_num_put_waiters;
+        }
+        if (_shutdown.load()) {
+            return false;
+        }
+
+        WorkerTls& tls = _tls();
+        uint32_t shard_idx = (tls.queue == this)
+            ? tls.worker_id : _next_shard.fetch_add(1) % _shards.size();
+        Shard* shard = _shards[shard_idx].get();
+        {
+            std::lock_guard<std::mutex> l(shard->lock);
+            shard->levels[level].push_back(val);
+            ++shard->size;
+        }
+        // pairs with the check of _size in blocking_get() after it counts itself as
+        // a sleeper: either that check sees the task or this sees the sleeper
+        ++_size;
+        if (_num_sleepers.load() > 0) {
+            std::lock_guard<std::mutex> l(_park_lock);
+            _get_cv.notify_one();
+        }
+        return true;
+    }
+
+    // Gets a task for the worker 'worker_id' in [0, num_workers), waiting until one
+    // is available. Returns false if the queue is shut down and is empty.
+    bool blocking_get(int worker_id, T* out) {
+        DCHECK_GE(worker_id, 0);
+        DCHECK_LT(worker_id, _shards.size());
+        WorkerTls& tls = _tls();
+        tls.queue = this;
+        tls.worker_id = worker_id;
+
+        while (true) {
+            for (int round = 0; round < SPIN_ROUNDS; ++round) {
+                if (_try_get(worker_id, out)) {
+                    return true;
+                }
+                if (_shutdown.load()) {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+
+            std::unique_lock<std::mutex> l(_park_lock);
+            ++_num_sleepers;
+            while (_size.load() == 0 && !_shutdown.load()) {
+                _get_cv.wait(l);
+            }
+            --_num_sleepers;
+        }
+    }
+
+    // Wakes up all the threads blocked in blocking_get() or blocking_put().
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> l(_park_lock);
+            _shutdown.store(true);
+        }
+        _get_cv.notify_all();
+        _put_cv.notify_all();
+    }
+
+    uint32_t get_size() const {
+        return _size.load();
+    }
+
+private:
+    static const int SPIN_ROUNDS = 16;
+    static const uint32_t STARVATION_INTERVAL = 16;
+
+    struct Shard {
+        explicit Shard(int num_levels) : levels(num_levels) { }
+
+        std::mutex lock;
+        std::vector<std::deque<T>> levels;
+        // read without the lock to skip empty shards
+        std::atomic<uint32_t> size{0};
+        uint32_t num_gets = 0;
+        // keeps the locks of two shards off the same cache line
+        char padding[64];
+    };
+
+    // the queue the current thread is a worker of
+    struct WorkerTls {
+        const WorkStealingQueue* queue = nullptr;
+        uint32_t worker_id = 0;
+    };
+
+    static WorkerTls& _tls() {
+        static thread_local WorkerTls tls;
+        return tls;
+    }
+
+    bool _try_get(int worker_id, T* out) {
+        for (size_t i = 0; i < _shards.size(); ++i) {
+            Shard* shard = _shards[(worker_id + i) % _shards.size()].get();
+            if (shard->size.load() == 0) {
+                continue;
+            }
+            if (_try_pop(shard, out)) {
+                --_size;
+                if (_num_put_waiters.load() > 0) {
+                    std::lock_guard<std::mutex> l(_park_lock);
+                    _put_cv.notify_one();
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool _try_pop(Shard* shard, T* out) {
+        std::lock_guard<std::mutex> l(shard->lock);
+        if (shard->size.load() == 0) {
+            return false;
+        }
+        bool lowest_first = (++shard->num_gets % STARVATION_INTERVAL == 0);
+        for (int i = 0; i < _num_levels; ++i) {
+            std::deque<T>& level = shard->levels[lowest_first ? i : _num_levels - 1 - i];
+            if (!level.empty()) {
+                *out = std::move(level.front());
+                level.pop_front();
+                --shard->size;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const uint32_t _max_elements;
+    const int _num_levels;
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    std::atomic<uint32_t> _size{0};
+    std::atomic<uint32_t> _next_shard{0};
+    std::atomic<bool> _shutdown{false};
+
+    // guards the waits on the condition variables
+    std::mutex _park_lock;
+    std::condition_variable _get_cv;
+    std::condition_variable _put_cv;
+    std::atomic<int> _num_sleepers{0};
+    std::atomic<int> _num_put_waiters{0};
+};
+
+}
+
+#endif
@@ -177,6 +177,35 @@ TEST(TaskWorkerPoolTest, TestSubmitTask) {
     task_worker_pool._s_task_signatures[agent_task_request.task_type].clear();
 }
 
+TEST(TaskWorkerPoolTest, TestTakeHighPriorityTask) {
+    TMasterInfo master_info;
+    ExecEnv env;
+    TaskWorkerPool task_worker_pool(
+            TaskWorkerPool::TaskWorkerType::CLONE,
+            &env,
+            master_info);
+
+    TAgentTaskRequest normal_task;
+    normal_task.task_type = TTaskType::CLONE;
+    normal_task.signature = 1;
+    task_worker_pool.submit_task(normal_task);
+    TAgentTaskRequest high_task;
+    high_task.task_type = TTaskType::CLONE;
+    high_task.signature = 2;
+    high_task.__set_priority(TPriority::HIGH);
+    task_worker_pool.submit_task(high_task);
+
+    {
+        std::lock_guard<Mutex> l(task_worker_pool._worker_thread_lock);
+        EXPECT_EQ(2, task_worker_pool._take_task_with_lock().signature);
+        EXPECT_EQ(1, task_worker_pool._take_task_with_lock().signature);
+    }
+    EXPECT_EQ(0, task_worker_pool._num_high_priority_tasks);
+    EXPECT_TRUE(task_worker_pool._task_submit_us.empty());
+
+    task_worker_pool._s_task_signatures[TTaskType::CLONE].clear();
+}
+
 TEST(TaskWorkerPoolTest, TestRecordTaskInfo) {
     TMasterInfo master_info;
     ExecEnv env;
@@ -0,0 +1,216 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "codegen/codegen_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "codegen/llvm_codegen.h"
+#include "runtime/mem_tracker.h"
+#include "util/filesystem_util.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const std::string TMP_DIR = "/tmp/codegen-cache-test";
+// the function of the modules and the function it calls, which is mapped into them
+static const std::string FN = "codegen_cache_test_fn";
+static const std::string MAPPED_FN = "codegen_cache_test_mapped_fn";
+
+typedef int32_t (*TestFn)(int32_t);
+
+static int32_t add_one(int32_t x) {
+    return x + 1;
+}
+
+static int32_t add_two(int32_t x) {
+    return x + 2;
+}
+
+static CodegenCache::GlobalMappings mappings_of(TestFn mapped_fn) {
+    CodegenCache::GlobalMappings mappings;
+    mappings[MAPPED_FN] = reinterpret_cast<void*>(mapped_fn);
+    return mappings;
+}
+
+// The bitcode of a module defining FN(x) as MAPPED_FN(x) + 'addend', in a context
+// of its own as every codegen has
+static std::string make_bitcode(int32_t addend) {
+    llvm::LLVMContext context;
+    std::unique_ptr<llvm::Module> module(new llvm::Module("codegen_cache_test", context));
+    llvm::Type* int_type = llvm::Type::getInt32Ty(context);
+    std::vector<llvm::Type*> arg_types(1, int_type);
+    llvm::FunctionType* fn_type = llvm::FunctionType::get(int_type, arg_types, false);
+    llvm::Function* mapped_fn = llvm::Function::Create(
+            fn_type, llvm::Function::ExternalLinkage, MAPPED_FN, module.get());
+    llvm::Function* fn = llvm::Function::Create(
+            fn_type, llvm::Function::ExternalLinkage, FN, module.get());
+    llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", fn));
+    llvm::Value* value = builder.CreateCall(mapped_fn, &*fn->arg_begin());
+    builder.CreateRet(builder.CreateAdd(value, builder.getInt32(addend)));
+
+    std::string bitcode;
+    llvm::raw_string_ostream stream(bitcode);
+    llvm::WriteBitcodeToFile(module.get(), stream);
+    stream.flush();
+    return bitcode;
+}
+
+static int32_t call(const std::shared_ptr<CodegenCache::Entry>& entry, int32_t x) {
+    return reinterpret_cast<TestFn>(entry->fn(FN))(x);
+}
+
+class CodegenCacheTest : public testing::Test {
+public:
+    void SetUp() override {
+        FileSystemUtil::remove_paths({TMP_DIR});
+        ASSERT_TRUE(FileSystemUtil::create_directory(TMP_DIR).ok());
+    }
+
+    void TearDown() override {
+        FileSystemUtil::remove_paths({TMP_DIR});
+    }
+
+protected:
+    // Looks the module of 'addend' up in 'cache' and inserts it if it is not there.
+    // Returns whether it was there.
+    static bool lookup_or_insert(CodegenCache* cache, int32_t addend, TestFn mapped_fn,
+                                 std::shared_ptr<CodegenCache::Entry>* entry) {
+        std::string bitcode = make_bitcode(addend);
+        std::string key = CodegenCache::make_key(bitcode, {FN}, mappings_of(mapped_fn));
+        *entry = cache->lookup(key, {FN}, mappings_of(mapped_fn));
+        if (*entry != NULL) {
+            return true;
+        }
+        EXPECT_TRUE(cache->insert(key, bitcode, {FN}, mappings_of(mapped_fn), entry).ok());
+        return false;
+    }
+
+    static const int64_t CAPACITY = 1L << 30;
+};
+
+TEST_F(CodegenCacheTest, identical_module) {
+    // the modules of the same IR have the same key in other contexts
+    std::string key = CodegenCache::make_key(make_bitcode(10), {FN}, mappings_of(add_one));
+    EXPECT_EQ(key, CodegenCache::make_key(make_bitcode(10), {FN}, mappings_of(add_one)));
+    EXPECT_NE(key, CodegenCache::make_key(make_bitcode(20), {FN}, mappings_of(add_one)));
+    EXPECT_NE(key, CodegenCache::make_key(make_bitcode(10), {}, mappings_of(add_one)));
+    EXPECT_NE(key, CodegenCache::make_key(make_bitcode(10), {FN}, {}));
+
+    CodegenCache cache(CAPACITY, "");
+    std::shared_ptr<CodegenCache::Entry> entry;
+    EXPECT_FALSE(lookup_or_insert(&cache, 10, add_one, &entry));
+    EXPECT_EQ(1 + 1 + 10, call(entry, 1));
+    std::shared_ptr<CodegenCache::Entry> hit;
+    EXPECT_TRUE(lookup_or_insert(&cache, 10, add_one, &hit));
+    EXPECT_EQ(entry, hit);
+    std::shared_ptr<CodegenCache::Entry> miss;
+    EXPECT_FALSE(lookup_or_insert(&cache, 20, add_one, &miss));
+    EXPECT_EQ(1 + 1 + 20, call(miss, 1));
+    EXPECT_NE(entry, miss);
+}
+
+TEST_F(CodegenCacheTest, mapped_addresses) {
+    // the key does not depend on the addresses of the mapped functions, which
+    // change with every start of the process
+    std::string bitcode = make_bitcode(10);
+    EXPECT_EQ(CodegenCache::make_key(bitcode, {FN}, mappings_of(add_one)),
+              CodegenCache::make_key(bitcode, {FN}, mappings_of(add_two)));
+
+    // but the entry is compiled again for other addresses
+    CodegenCache cache(CAPACITY, "");
+    std::shared_ptr<CodegenCache::Entry> entry;
+    EXPECT_FALSE(lookup_or_insert(&cache, 10, add_one, &entry));
+    EXPECT_EQ(1 + 1 + 10, call(entry, 1));
+    std::shared_ptr<CodegenCache::Entry> other;
+    EXPECT_FALSE(lookup_or_insert(&cache, 10, add_two, &other));
+    EXPECT_EQ(1 + 2 + 10, call(other, 1));
+    std::shared_ptr<CodegenCache::Entry> hit;
+    EXPECT_TRUE(lookup_or_insert(&cache, 10, add_two, &hit));
+    EXPECT_EQ(other, hit);
+    // the replaced entry still works for its users
+    EXPECT_EQ(1 + 1 + 10, call(entry, 1));
+}
+
+TEST_F(CodegenCacheTest, cache_dir) {
+    {
+        CodegenCache cache(CAPACITY, TMP_DIR);
+        std::shared_ptr<CodegenCache::Entry> entry;
+        EXPECT_FALSE(lookup_or_insert(&cache, 10, add_one, &entry));
+    }
+    // a cache of a later process compiles the module of the dir, with the
+    // addresses of its functions
+    CodegenCache cache(CAPACITY, TMP_DIR);
+    std::shared_ptr<CodegenCache::Entry> entry;
+    EXPECT_TRUE(lookup_or_insert(&cache, 10, add_two, &entry));
+    EXPECT_EQ(1 + 2 + 10, call(entry, 1));
+    std::shared_ptr<CodegenCache::Entry> miss;
+    EXPECT_FALSE(lookup_or_insert(&cache, 20, add_two, &miss));
+}
+
+TEST_F(CodegenCacheTest, lru_eviction) {
+    // the entries of the modules have about the same size, the cache holds two
+    int64_t size = 0;
+    for (int32_t addend : {10, 20, 30}) {
+        size = std::max<int64_t>(size, make_bitcode(addend).size() * 2);
+    }
+    CodegenCache cache(size * 5 / 2, "");
+    std::shared_ptr<CodegenCache::Entry> entry;
+    EXPECT_FALSE(lookup_or_insert(&cache, 10, add_one, &entry));
+    std::shared_ptr<CodegenCache::Entry> evicted;
+    EXPECT_FALSE(lookup_or_insert(&cache, 20, add_one, &evicted));
+    // 10 is used more recently than 20, which is evicted for 30 although it is
+    // still in use
+    EXPECT_TRUE(lookup_or_insert(&cache, 10, add_one, &entry));
+    EXPECT_FALSE(lookup_or_insert(&cache, 30, add_one, &entry));
+    EXPECT_LE(cache._mem_tracker->consumption(), size * 5 / 2);
+    EXPECT_TRUE(lookup_or_insert(&cache, 10, add_one, &entry));
+    EXPECT_TRUE(lookup_or_insert(&cache, 30, add_one, &entry));
+    // an evicted entry works for its users, it is not part of the size of the
+    // cache any more
+    EXPECT_EQ(1 + 1 + 20, call(evicted, 1));
+    EXPECT_FALSE(lookup_or_insert(&cache, 20, add_one, &entry));
+    EXPECT_LE(cache._mem_tracker->consumption(), size * 5 / 2);
+    evicted.reset();
+
+    // an entry larger than the cache is only returned
+    CodegenCache small_cache(size / 2, "");
+    EXPECT_FALSE(lookup_or_insert(&small_cache, 10, add_one, &entry));
+    EXPECT_EQ(1 + 1 + 10, call(entry, 1));
+    EXPECT_EQ(0, small_cache._mem_tracker->consumption());
+    EXPECT_FALSE(lookup_or_insert(&small_cache, 10, add_one, &entry));
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::LlvmCodeGen::initialize_llvm();
+    return RUN_ALL_TESTS();
+}
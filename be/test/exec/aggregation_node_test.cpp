@@ -0,0 +1,321 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define private public
+#define protected public
+#include "exec/aggregation_node.h"
+#include "common/config.h"
+#include "runtime/descriptors.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "udf/udf.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/logging.h"
+
+using doris_udf::BigIntVal;
+using doris_udf::FunctionContext;
+using doris_udf::IntVal;
+
+// The aggregate functions of the tests, the sum of the INT values into a BIGINT which
+// is NULL until a value is added and the count of the values which are not NULL. The
+// evaluators look their symbols up in the test binary.
+extern "C" {
+
+void agg_test_sum_init(FunctionContext* ctx, BigIntVal* dst) {
+    dst->is_null = true;
+    dst->val = 0;
+}
+
+void agg_test_sum_update(FunctionContext* ctx, const IntVal& src, BigIntVal* dst) {
+    if (src.is_null) {
+        return;
+    }
+    if (dst->is_null) {
+        dst->is_null = false;
+        dst->val = 0;
+    }
+    dst->val += src.val;
+}
+
+void agg_test_sum_merge(FunctionContext* ctx, const BigIntVal& src, BigIntVal* dst) {
+    if (src.is_null) {
+        return;
+    }
+    if (dst->is_null) {
+        dst->is_null = false;
+        dst->val = 0;
+    }
+    dst->val += src.val;
+}
+
+void agg_test_count_init(FunctionContext* ctx, BigIntVal* dst) {
+    dst->is_null = false;
+    dst->val = 0;
+}
+
+void agg_test_count_update(FunctionContext* ctx, const IntVal& src, BigIntVal* dst) {
+    if (!src.is_null) {
+        ++dst->val;
+    }
+}
+
+void agg_test_count_merge(FunctionContext* ctx, const BigIntVal& src, BigIntVal* dst) {
+    dst->val += src.val;
+}
+
+}
+
+namespace doris {
+
+static const int BATCH_SIZE = 64;
+static const int NUM_THREADS = 4;
+
+struct AggregationResult {
+    std::vector<TestRow> rows;
+    int num_thread_states = 0;
+};
+
+// Groups (k0, k1, v) rows by k0 and k1 into (k0, k1, sum(v), count(v)) rows, the
+// aggregation with several threads returning the rows of the one with a single thread
+class AggregationNodeTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+        _num_threads = config::parallel_aggregation_num_threads;
+
+        // the input tuple and the intermediate tuple, which is the output one as well
+        TDescriptorTableBuilder builder;
+        TTupleDescriptorBuilder input_builder;
+        for (int i = 0; i < 3; ++i) {
+            input_builder.add_slot(
+                    TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build());
+        }
+        input_builder.build(&builder);
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_BIGINT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_BIGINT).nullable(true).build())
+            .build(&builder);
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* input = _desc_tbl->get_tuple_descriptor(0);
+        const TupleDescriptor* output = _desc_tbl->get_tuple_descriptor(1);
+        _input_slots.assign(input->slots().begin(), input->slots().end());
+        _output_slots.assign(output->slots().begin(), output->slots().end());
+    }
+
+    void TearDown() override {
+        config::parallel_aggregation_num_threads = _num_threads;
+        _test_env.reset();
+    }
+
+protected:
+    // Rows of about 'num_groups' groups, the NULL keys being groups as well. Some
+    // values are NULL, all the values of some groups are.
+    static std::vector<TestRow> make_rows(int num_rows, int num_groups) {
+        std::vector<TestRow> rows;
+        for (int i = 0; i < num_rows; ++i) {
+            int64_t key = (i % 17 == 0) ? TEST_NULL : (i * 7919L) % num_groups;
+            int64_t sub_key = (key != TEST_NULL && key % 5 == 0) ? TEST_NULL : i % 2;
+            bool null_value = i % 5 == 0 || (key != TEST_NULL && key % 11 == 3);
+            rows.push_back({key, sub_key, null_value ? TEST_NULL : i % 1000 - 500});
+        }
+        return rows;
+    }
+
+    // the groups of 'rows' aggregated in memory
+    static std::vector<TestRow> expected_rows(const std::vector<TestRow>& rows) {
+        std::map<std::pair<int64_t, int64_t>, std::pair<int64_t, int64_t>> groups;
+        for (const TestRow& row : rows) {
+            auto it = groups.emplace(std::make_pair(row[0], row[1]),
+                                     std::make_pair(TEST_NULL, 0L)).first;
+            if (row[2] != TEST_NULL) {
+                int64_t& sum = it->second.first;
+                sum = (sum == TEST_NULL ? 0 : sum) + row[2];
+                ++it->second.second;
+            }
+        }
+        std::vector<TestRow> expected;
+        for (const auto& group : groups) {
+            expected.push_back({group.first.first, group.first.second,
+                                group.second.first, group.second.second});
+        }
+        return sorted_test_rows(expected);
+    }
+
+    TExpr make_agg_fn(const std::string& name) const {
+        TExprNode node = make_test_expr_node(TExprNodeType::AGG_EXPR, TYPE_BIGINT);
+        node.__isset.fn = true;
+        node.fn.name.function_name = name;
+        node.fn.binary_type = TFunctionBinaryType::BUILTIN;
+        node.fn.arg_types.push_back(TypeDescriptor(TYPE_INT).to_thrift());
+        node.fn.ret_type = node.type;
+        node.fn.has_var_args = false;
+        node.fn.__isset.aggregate_fn = true;
+        node.fn.aggregate_fn.intermediate_type = node.type;
+        node.fn.aggregate_fn.__set_init_fn_symbol(name + "_init");
+        node.fn.aggregate_fn.__set_update_fn_symbol(name + "_update");
+        node.fn.aggregate_fn.__set_merge_fn_symbol(name + "_merge");
+        node.__isset.agg_expr = true;
+        node.agg_expr.is_merge_agg = false;
+        return make_test_expr(node, {make_test_slot_ref(_input_slots[2])});
+    }
+
+    // Aggregates 'rows' with 'num_threads', returns the sorted rows
+    Status aggregate(const std::vector<TestRow>& rows, int num_threads,
+                     const std::vector<TExpr>& conjuncts, int64_t limit,
+                     AggregationResult* result) {
+        config::parallel_aggregation_num_threads = num_threads;
+        RuntimeState* state = nullptr;
+        RETURN_IF_ERROR(_test_env->create_query_state(++_query_id, -1, 8 * 1024 * 1024,
+                                                      &state));
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+        state->_query_options.batch_size = BATCH_SIZE;
+
+        TPlanNode tnode = make_test_plan_node(TPlanNodeType::AGGREGATION_NODE, 0, {1},
+                                              {false});
+        tnode.num_children = 1;
+        tnode.limit = limit;
+        if (!conjuncts.empty()) {
+            tnode.__set_conjuncts(conjuncts);
+        }
+        tnode.__isset.agg_node = true;
+        tnode.agg_node.__set_grouping_exprs({make_test_slot_ref(_input_slots[0]),
+                                             make_test_slot_ref(_input_slots[1])});
+        tnode.agg_node.aggregate_functions = {make_agg_fn("agg_test_sum"),
+                                              make_agg_fn("agg_test_count")};
+        tnode.agg_node.intermediate_tuple_id = 1;
+        tnode.agg_node.output_tuple_id = 1;
+        tnode.agg_node.need_finalize = true;
+
+        AggregationNode node(&_pool, tnode, *_desc_tbl);
+        node._children.push_back(_pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 1, {0}, {false}),
+                *_desc_tbl, rows, BATCH_SIZE)));
+
+        RETURN_IF_ERROR(node.init(tnode, state));
+        Status status = node.prepare(state);
+        if (status.ok()) {
+            status = node.open(state);
+        }
+        if (status.ok()) {
+            status = read_test_rows(state, &node, _output_slots, &result->rows);
+        }
+        result->num_thread_states = node._thread_states.size();
+        node.close(state);
+        RETURN_IF_ERROR(status);
+        result->rows = sorted_test_rows(result->rows);
+        return Status::OK;
+    }
+
+    // Checks the aggregations with one and with several threads against the one in
+    // memory, 'having' filtering the groups
+    void check_aggregate(const std::vector<TestRow>& rows, const std::vector<TExpr>& having,
+                         const std::vector<TestRow>& expected) {
+        AggregationResult serial;
+        ASSERT_TRUE(aggregate(rows, 1, having, -1, &serial).ok());
+        EXPECT_EQ(0, serial.num_thread_states);
+        EXPECT_EQ(expected, serial.rows);
+        AggregationResult parallel;
+        ASSERT_TRUE(aggregate(rows, NUM_THREADS, having, -1, &parallel).ok());
+        EXPECT_EQ(NUM_THREADS, parallel.num_thread_states);
+        EXPECT_EQ(serial.rows, parallel.rows);
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    ObjectPool _pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::vector<const SlotDescriptor*> _input_slots;
+    std::vector<const SlotDescriptor*> _output_slots;
+    int64_t _query_id = 0;
+    int _num_threads = 1;
+};
+
+TEST_F(AggregationNodeTest, high_cardinality) {
+    std::vector<TestRow> rows = make_rows(20000, 6000);
+    check_aggregate(rows, {}, expected_rows(rows));
+}
+
+TEST_F(AggregationNodeTest, low_cardinality) {
+    // most partitions of the threads are empty
+    std::vector<TestRow> rows = make_rows(3000, 3);
+    check_aggregate(rows, {}, expected_rows(rows));
+}
+
+TEST_F(AggregationNodeTest, null_values) {
+    std::vector<TestRow> rows;
+    for (int i = 0; i < 1000; ++i) {
+        rows.push_back({i % 2 == 0 ? TEST_NULL : i % 7, TEST_NULL, TEST_NULL});
+    }
+    check_aggregate(rows, {}, expected_rows(rows));
+}
+
+TEST_F(AggregationNodeTest, empty_input) {
+    check_aggregate({}, {}, {});
+}
+
+TEST_F(AggregationNodeTest, having) {
+    std::vector<TestRow> rows = make_rows(20000, 6000);
+    TExpr having = make_test_binary_pred(TExprOpcode::GT, TYPE_BIGINT,
+            make_test_slot_ref(_output_slots[3]), make_test_int_literal(TYPE_BIGINT, 2));
+    std::vector<TestRow> expected;
+    for (const TestRow& row : expected_rows(rows)) {
+        if (row[3] > 2) {
+            expected.push_back(row);
+        }
+    }
+    check_aggregate(rows, {having}, expected);
+}
+
+TEST_F(AggregationNodeTest, limit) {
+    // the groups returned are any of them
+    std::vector<TestRow> rows = make_rows(20000, 6000);
+    std::vector<TestRow> expected = expected_rows(rows);
+    for (int num_threads : {1, NUM_THREADS}) {
+        AggregationResult result;
+        ASSERT_TRUE(aggregate(rows, num_threads, {}, 100, &result).ok());
+        ASSERT_EQ(100, result.rows.size());
+        EXPECT_TRUE(std::includes(expected.begin(), expected.end(),
+                                  result.rows.begin(), result.rows.end()));
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+
+    return RUN_ALL_TESTS();
+}
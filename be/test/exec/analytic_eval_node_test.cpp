@@ -0,0 +1,366 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+
+#define private public
+#define protected public
+#include "exec/analytic_eval_node.h"
+#include "common/config.h"
+#include "runtime/buffered_block_mgr.h"
+#include "runtime/descriptors.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "udf/udf.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/logging.h"
+
+using doris_udf::BigIntVal;
+using doris_udf::FunctionContext;
+using doris_udf::IntVal;
+
+// The analytic function of the tests, the sum of the INT values into a BIGINT which
+// is NULL until a value is added. The evaluator looks its symbols up in the test binary.
+extern "C" {
+
+void analytic_test_sum_init(FunctionContext* ctx, BigIntVal* dst) {
+    dst->is_null = true;
+    dst->val = 0;
+}
+
+void analytic_test_sum_update(FunctionContext* ctx, const IntVal& src, BigIntVal* dst) {
+    if (src.is_null) {
+        return;
+    }
+    if (dst->is_null) {
+        dst->is_null = false;
+        dst->val = 0;
+    }
+    dst->val += src.val;
+}
+
+void analytic_test_sum_remove(FunctionContext* ctx, const IntVal& src, BigIntVal* dst) {
+    if (src.is_null || dst->is_null) {
+        return;
+    }
+    dst->val -= src.val;
+}
+
+}
+
+namespace doris {
+
+static const int BATCH_SIZE = 64;
+static const int NUM_THREADS = 4;
+// the bound of a window which is not set
+static const int64_t UNBOUNDED = std::numeric_limits<int64_t>::max();
+
+struct AnalyticResult {
+    std::vector<TestRow> rows;
+    int num_workers = 0;
+};
+
+// Evaluates the sum of v over the windows of (k, v) rows partitioned by k, the parallel
+// node returning the rows of the serial one
+class AnalyticEvalNodeTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+        _num_threads = config::parallel_analytic_num_threads;
+        _enable_streaming = config::enable_streaming_analytic;
+
+        // the input tuple, the intermediate and output tuples of the sum and the
+        // buffered tuple the previous input rows are compared with
+        TDescriptorTableBuilder builder;
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .build(&builder);
+        for (int i = 0; i < 2; ++i) {
+            TTupleDescriptorBuilder()
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_BIGINT).nullable(true).build())
+                .build(&builder);
+        }
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .build(&builder);
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* input = _desc_tbl->get_tuple_descriptor(0);
+        const TupleDescriptor* buffered = _desc_tbl->get_tuple_descriptor(3);
+        _input_slots.assign(input->slots().begin(), input->slots().end());
+        _buffered_slots.assign(buffered->slots().begin(), buffered->slots().end());
+        _output_slot = _desc_tbl->get_tuple_descriptor(2)->slots()[0];
+    }
+
+    void TearDown() override {
+        config::parallel_analytic_num_threads = _num_threads;
+        config::enable_streaming_analytic = _enable_streaming;
+        _test_env.reset();
+    }
+
+protected:
+    // Rows sorted by (k, v), NULL first: a partition of NULL keys, one of several
+    // chunks of rows, partitions of 37 rows and partitions of a single row. Some
+    // values are NULL.
+    static std::vector<TestRow> make_rows() {
+        std::vector<TestRow> rows;
+        for (int i = 0; i < 5000; ++i) {
+            int64_t key = 0;
+            if (i < 100) {
+                key = TEST_NULL;
+            } else if (i >= 2100 && i < 4000) {
+                key = 1 + (i - 2100) / 37;
+            } else if (i >= 4000) {
+                key = i;
+            }
+            int64_t value = (i % 6 == 0) ? TEST_NULL : (i * 31) % 100 - 50;
+            rows.push_back({key, value});
+        }
+        return sorted_test_rows(rows);
+    }
+
+    // the bound 'offset' rows from the current one, which precede it when negative
+    static TAnalyticWindowBoundary make_bound(int64_t offset) {
+        TAnalyticWindowBoundary bound;
+        if (offset == 0) {
+            bound.type = TAnalyticWindowBoundaryType::CURRENT_ROW;
+        } else {
+            bound.type = offset < 0 ? TAnalyticWindowBoundaryType::PRECEDING
+                : TAnalyticWindowBoundaryType::FOLLOWING;
+            bound.__set_rows_offset_value(std::abs(offset));
+        }
+        return bound;
+    }
+
+    static TAnalyticWindow make_window(TAnalyticWindowType::type type, int64_t start,
+                                       int64_t end) {
+        TAnalyticWindow window;
+        window.type = type;
+        if (start != UNBOUNDED) {
+            window.__set_window_start(make_bound(start));
+        }
+        if (end != UNBOUNDED) {
+            window.__set_window_end(make_bound(end));
+        }
+        return window;
+    }
+
+    // the equality of the slots of the previous and the current row, NULL being
+    // equal to NULL
+    TExpr make_prev_row_eq(int slot_idx) const {
+        TExpr prev = make_test_fn_call("ifnull", TYPE_INT, {
+                make_test_slot_ref(_input_slots[slot_idx]),
+                make_test_int_literal(TYPE_INT, -1000)});
+        TExpr curr = make_test_fn_call("ifnull", TYPE_INT, {
+                make_test_slot_ref(_buffered_slots[slot_idx]),
+                make_test_int_literal(TYPE_INT, -1000)});
+        return make_test_binary_pred(TExprOpcode::EQ, TYPE_INT, prev, curr);
+    }
+
+    TExpr make_sum_fn() const {
+        TExprNode node = make_test_expr_node(TExprNodeType::AGG_EXPR, TYPE_BIGINT);
+        node.__isset.fn = true;
+        node.fn.name.function_name = "analytic_test_sum";
+        node.fn.binary_type = TFunctionBinaryType::BUILTIN;
+        node.fn.arg_types.push_back(TypeDescriptor(TYPE_INT).to_thrift());
+        node.fn.ret_type = node.type;
+        node.fn.has_var_args = false;
+        node.fn.__isset.aggregate_fn = true;
+        node.fn.aggregate_fn.intermediate_type = node.type;
+        node.fn.aggregate_fn.__set_init_fn_symbol("analytic_test_sum_init");
+        node.fn.aggregate_fn.__set_update_fn_symbol("analytic_test_sum_update");
+        node.fn.aggregate_fn.__set_remove_fn_symbol("analytic_test_sum_remove");
+        node.__isset.agg_expr = true;
+        node.agg_expr.is_merge_agg = false;
+        return make_test_expr(node, {make_test_slot_ref(_input_slots[1])});
+    }
+
+    // Returns the (k, v, sum) rows of the sum over 'window', the whole partition when
+    // NULL, evaluated by 'num_threads'
+    Status analytic(const std::vector<TestRow>& rows, const TAnalyticWindow* window,
+                    int num_threads, const std::vector<TExpr>& conjuncts, int64_t limit,
+                    AnalyticResult* result) {
+        config::parallel_analytic_num_threads = num_threads;
+        RuntimeState* state = nullptr;
+        RETURN_IF_ERROR(_test_env->create_query_state(++_query_id, -1,
+                                                      config::sorter_block_size, &state));
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+        state->_query_options.batch_size = BATCH_SIZE;
+        boost::shared_ptr<BufferedBlockMgr> block_mgr;
+        RETURN_IF_ERROR(BufferedBlockMgr::create(state, config::sorter_block_size, &block_mgr));
+        state->set_block_mgr(block_mgr);
+
+        TPlanNode tnode = make_test_plan_node(TPlanNodeType::ANALYTIC_EVAL_NODE, 0, {0, 2},
+                                              {false, false});
+        tnode.num_children = 1;
+        tnode.limit = limit;
+        if (!conjuncts.empty()) {
+            tnode.__set_conjuncts(conjuncts);
+        }
+        tnode.__isset.analytic_node = true;
+        TAnalyticNode& analytic_node = tnode.analytic_node;
+        analytic_node.partition_exprs.push_back(make_test_slot_ref(_input_slots[0]));
+        if (window != nullptr) {
+            analytic_node.order_by_exprs.push_back(make_test_slot_ref(_input_slots[1]));
+            analytic_node.__set_window(*window);
+            analytic_node.__set_order_by_eq(make_prev_row_eq(1));
+        }
+        analytic_node.analytic_functions.push_back(make_sum_fn());
+        analytic_node.intermediate_tuple_id = 1;
+        analytic_node.output_tuple_id = 2;
+        analytic_node.__set_buffered_tuple_id(3);
+        analytic_node.__set_partition_by_eq(make_prev_row_eq(0));
+
+        AnalyticEvalNode node(&_pool, tnode, *_desc_tbl);
+        node._children.push_back(_pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 1, {0}, {false}),
+                *_desc_tbl, rows, BATCH_SIZE)));
+
+        RETURN_IF_ERROR(node.init(tnode, state));
+        Status status = node.prepare(state);
+        if (status.ok()) {
+            status = node.open(state);
+        }
+        if (status.ok()) {
+            status = read_test_rows(state, &node,
+                                    {_input_slots[0], _input_slots[1], _output_slot},
+                                    &result->rows);
+        }
+        result->num_workers = node._workers.size();
+        node.close(state);
+        return status;
+    }
+
+    // Checks that the parallel node returns the rows of the serial one, in their order
+    void check_parallel(const std::vector<TestRow>& rows, const TAnalyticWindow* window,
+                        const std::vector<TExpr>& conjuncts, int64_t limit) {
+        AnalyticResult serial;
+        ASSERT_TRUE(analytic(rows, window, 1, conjuncts, limit, &serial).ok());
+        EXPECT_EQ(0, serial.num_workers);
+        AnalyticResult parallel;
+        ASSERT_TRUE(analytic(rows, window, NUM_THREADS, conjuncts, limit, &parallel).ok());
+        EXPECT_EQ(NUM_THREADS, parallel.num_workers);
+        EXPECT_EQ(serial.rows, parallel.rows);
+    }
+
+    // the ROWS windows, which are evaluated while streaming when they end at the
+    // current row
+    static std::vector<TAnalyticWindow> rows_windows() {
+        return {make_window(TAnalyticWindowType::ROWS, UNBOUNDED, 0),
+                make_window(TAnalyticWindowType::ROWS, -2, 0),
+                make_window(TAnalyticWindowType::ROWS, -2, 1),
+                make_window(TAnalyticWindowType::ROWS, 0, 3),
+                make_window(TAnalyticWindowType::ROWS, UNBOUNDED, -3)};
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    ObjectPool _pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::vector<const SlotDescriptor*> _input_slots;
+    std::vector<const SlotDescriptor*> _buffered_slots;
+    const SlotDescriptor* _output_slot = nullptr;
+    int64_t _query_id = 0;
+    int _num_threads = 1;
+    bool _enable_streaming = true;
+};
+
+TEST_F(AnalyticEvalNodeTest, partition_window) {
+    std::vector<TestRow> rows = make_rows();
+    check_parallel(rows, nullptr, {}, -1);
+
+    // the sums of the values of the partitions, NULL keys being a partition
+    std::vector<TestRow> expected;
+    for (int begin = 0, end = 0; begin < rows.size(); begin = end) {
+        int64_t sum = TEST_NULL;
+        for (end = begin; end < rows.size() && rows[end][0] == rows[begin][0]; ++end) {
+            if (rows[end][1] != TEST_NULL) {
+                sum = (sum == TEST_NULL ? 0 : sum) + rows[end][1];
+            }
+        }
+        for (int i = begin; i < end; ++i) {
+            expected.push_back({rows[i][0], rows[i][1], sum});
+        }
+    }
+    AnalyticResult result;
+    ASSERT_TRUE(analytic(rows, nullptr, NUM_THREADS, {}, -1, &result).ok());
+    EXPECT_EQ(expected, result.rows);
+}
+
+TEST_F(AnalyticEvalNodeTest, rows_windows) {
+    std::vector<TestRow> rows = make_rows();
+    for (bool enable_streaming : {true, false}) {
+        config::enable_streaming_analytic = enable_streaming;
+        std::vector<TAnalyticWindow> windows = rows_windows();
+        for (int i = 0; i < windows.size(); ++i) {
+            SCOPED_TRACE(i);
+            check_parallel(rows, &windows[i], {}, -1);
+        }
+    }
+}
+
+TEST_F(AnalyticEvalNodeTest, range_window) {
+    TAnalyticWindow window = make_window(TAnalyticWindowType::RANGE, UNBOUNDED, 0);
+    check_parallel(make_rows(), &window, {}, -1);
+}
+
+TEST_F(AnalyticEvalNodeTest, empty_input) {
+    check_parallel({}, nullptr, {}, -1);
+    for (const TAnalyticWindow& window : rows_windows()) {
+        check_parallel({}, &window, {}, -1);
+    }
+    AnalyticResult result;
+    ASSERT_TRUE(analytic({}, nullptr, NUM_THREADS, {}, -1, &result).ok());
+    EXPECT_TRUE(result.rows.empty());
+}
+
+TEST_F(AnalyticEvalNodeTest, conjuncts_and_limit) {
+    // the node applies them to the rows of all the workers
+    std::vector<TestRow> rows = make_rows();
+    TExpr positive_sum = make_test_binary_pred(TExprOpcode::GT, TYPE_BIGINT,
+            make_test_slot_ref(_output_slot), make_test_int_literal(TYPE_BIGINT, 0));
+    TAnalyticWindow window = make_window(TAnalyticWindowType::ROWS, -2, 1);
+    for (int64_t limit : {-1L, 1L, 700L, 3000L}) {
+        SCOPED_TRACE(limit);
+        check_parallel(rows, nullptr, {positive_sum}, limit);
+        check_parallel(rows, &window, {positive_sum}, limit);
+        check_parallel(rows, &window, {}, limit);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+
+    return RUN_ALL_TESTS();
+}
@@ -392,6 +392,48 @@ TEST_F(BrokerScannerTest, normal) {
     ASSERT_TRUE(eof);
 }
 
+TEST_F(BrokerScannerTest, invalid_int) {
+    std::vector<TBrokerRangeDesc> ranges;
+    TBrokerRangeDesc range;
+    range.path = "./be/test/exec/test_data/broker_scanner/invalid_int.csv";
+    range.start_offset = 0;
+    range.size = -1;
+    range.splittable = true;
+    range.file_type = TFileType::FILE_LOCAL;
+    range.format_type = TFileFormatType::FORMAT_CSV_PLAIN;
+    ranges.push_back(range);
+
+    BrokerScanCounter counter;
+    BrokerScanner scanner(&_runtime_state, _profile, _params, ranges, _addresses, &counter);
+    auto st = scanner.open();
+    ASSERT_TRUE(st.ok());
+
+    MemPool tuple_pool(&_tracker);
+    Tuple* tuple = (Tuple*)tuple_pool.allocate(20);
+    bool eof = false;
+    // 1,2,3
+    st = scanner.get_next(tuple, &tuple_pool, &eof);
+    ASSERT_TRUE(st.ok());
+    ASSERT_FALSE(eof);
+    ASSERT_EQ(1, *(int*)tuple->get_slot(0));
+    ASSERT_EQ(2, *(int*)tuple->get_slot(4));
+    ASSERT_EQ(3, *(int*)tuple->get_slot(8));
+    // a value which is not a number, and one which overflows, are null and
+    // the rows are filtered as the columns are not nullable
+    // 10,-11,+12
+    st = scanner.get_next(tuple, &tuple_pool, &eof);
+    ASSERT_TRUE(st.ok());
+    ASSERT_FALSE(eof);
+    ASSERT_EQ(10, *(int*)tuple->get_slot(0));
+    ASSERT_EQ(-11, *(int*)tuple->get_slot(4));
+    ASSERT_EQ(12, *(int*)tuple->get_slot(8));
+    ASSERT_EQ(2, counter.num_rows_filtered);
+    // end of file
+    st = scanner.get_next(tuple, &tuple_pool, &eof);
+    ASSERT_TRUE(st.ok());
+    ASSERT_TRUE(eof);
+}
+
 TEST_F(BrokerScannerTest, normal2) {
     std::vector<TBrokerRangeDesc> ranges;
 
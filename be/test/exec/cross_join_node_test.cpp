@@ -0,0 +1,267 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define private public
+#define protected public
+#include "exec/cross_join_node.h"
+#include "common/config.h"
+#include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/fair_share_thread_pool.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const int BATCH_SIZE = 64;
+static const int LEFT_BATCH_SIZE = 100;
+
+struct CrossJoinResult {
+    std::vector<TestRow> rows;
+    int64_t num_parallel_batches = 0;
+};
+
+// Joins a left tuple (k, v) and a build tuple (k, v), the conjuncts being
+// left.k < build.k and left.v + build.v > 10 when they are given
+class CrossJoinNodeTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+        _thread_pool.reset(new FairShareThreadPool(4, 64));
+        _test_env->exec_env()->_thread_pool = _thread_pool.get();
+        _probe_threads = config::cross_join_probe_threads;
+        _min_pairs = config::cross_join_parallel_probe_min_pairs;
+
+        TDescriptorTableBuilder builder;
+        for (int i = 0; i < 2; ++i) {
+            TTupleDescriptorBuilder()
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+                .build(&builder);
+        }
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* left = _desc_tbl->get_tuple_descriptor(0);
+        const TupleDescriptor* build = _desc_tbl->get_tuple_descriptor(1);
+        _left_slots.assign(left->slots().begin(), left->slots().end());
+        _build_slots.assign(build->slots().begin(), build->slots().end());
+    }
+
+    void TearDown() override {
+        config::cross_join_probe_threads = _probe_threads;
+        config::cross_join_parallel_probe_min_pairs = _min_pairs;
+        _test_env->exec_env()->_thread_pool = nullptr;
+        _thread_pool.reset();
+        _test_env.reset();
+    }
+
+protected:
+    // the rows of a side of the join, some keys and values are NULL
+    static std::vector<TestRow> make_rows(int num_rows, int seed) {
+        std::vector<TestRow> rows;
+        for (int i = 0; i < num_rows; ++i) {
+            int64_t key = (i % 9 == seed % 9) ? TEST_NULL : (i * 37L + seed) % 50;
+            int64_t value = (i % 7 == seed % 7) ? TEST_NULL : (i * 13L + seed) % 40 - 20;
+            rows.push_back({key, value});
+        }
+        return rows;
+    }
+
+    std::vector<TExpr> conjuncts() const {
+        TExpr less_key = make_test_binary_pred(TExprOpcode::LT, TYPE_INT,
+                make_test_slot_ref(_left_slots[0]), make_test_slot_ref(_build_slots[0]));
+        TExpr sum = make_test_arithmetic(TExprOpcode::ADD, TYPE_INT,
+                {make_test_slot_ref(_left_slots[1]), make_test_slot_ref(_build_slots[1])});
+        TExpr big_sum = make_test_binary_pred(TExprOpcode::GT, TYPE_INT, sum,
+                make_test_int_literal(TYPE_INT, 10));
+        return {less_key, big_sum};
+    }
+
+    // The rows of the join evaluating the conjuncts a row at a time, in the order
+    // of the left rows and then of the build rows. A comparison with NULL fails.
+    static std::vector<TestRow> expected_rows(const std::vector<TestRow>& left_rows,
+                                              const std::vector<TestRow>& build_rows,
+                                              bool has_conjuncts) {
+        std::vector<TestRow> rows;
+        for (const TestRow& left : left_rows) {
+            for (const TestRow& build : build_rows) {
+                if (has_conjuncts) {
+                    if (left[0] == TEST_NULL || build[0] == TEST_NULL || left[0] >= build[0]) {
+                        continue;
+                    }
+                    if (left[1] == TEST_NULL || build[1] == TEST_NULL
+                            || left[1] + build[1] <= 10) {
+                        continue;
+                    }
+                }
+                rows.push_back({left[0], left[1], build[0], build[1]});
+            }
+        }
+        return rows;
+    }
+
+    // Runs the join with 'num_threads' probe threads, a left batch of at least
+    // 'min_pairs' combinations being probed in parallel
+    Status cross_join(const std::vector<TestRow>& left_rows,
+                      const std::vector<TestRow>& build_rows,
+                      const std::vector<TExpr>& conjuncts, int num_threads,
+                      int64_t min_pairs, int64_t limit, CrossJoinResult* result) {
+        config::cross_join_probe_threads = num_threads;
+        config::cross_join_parallel_probe_min_pairs = min_pairs;
+        RuntimeState* state = nullptr;
+        RETURN_IF_ERROR(_test_env->create_query_state(++_query_id, -1, 8 * 1024 * 1024,
+                                                      &state));
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+        state->_query_options.batch_size = BATCH_SIZE;
+
+        TPlanNode tnode = make_test_plan_node(TPlanNodeType::CROSS_JOIN_NODE, 0, {0, 1},
+                                              {false, false});
+        tnode.num_children = 2;
+        tnode.limit = limit;
+        if (!conjuncts.empty()) {
+            tnode.__set_conjuncts(conjuncts);
+        }
+
+        CrossJoinNode node(&_pool, tnode, *_desc_tbl);
+        node._children.push_back(_pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 1, {0}, {false}),
+                *_desc_tbl, left_rows, LEFT_BATCH_SIZE)));
+        node._children.push_back(_pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 2, {1}, {false}),
+                *_desc_tbl, build_rows, BATCH_SIZE)));
+
+        RETURN_IF_ERROR(node.init(tnode, state));
+        Status status = node.prepare(state);
+        if (status.ok()) {
+            status = node.open(state);
+        }
+        if (status.ok()) {
+            std::vector<const SlotDescriptor*> slots = _left_slots;
+            slots.insert(slots.end(), _build_slots.begin(), _build_slots.end());
+            status = read_test_rows(state, &node, slots, &result->rows);
+        }
+        if (node._parallel_probe_counter != nullptr) {
+            result->num_parallel_batches = node._parallel_probe_counter->value();
+        }
+        node.close(state);
+        return status;
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    std::unique_ptr<FairShareThreadPool> _thread_pool;
+    ObjectPool _pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::vector<const SlotDescriptor*> _left_slots;
+    std::vector<const SlotDescriptor*> _build_slots;
+    int64_t _query_id = 0;
+    int _probe_threads = 1;
+    int64_t _min_pairs = 0;
+};
+
+TEST_F(CrossJoinNodeTest, tiles) {
+    std::vector<TestRow> left_rows = make_rows(250, 1);
+    std::vector<TestRow> build_rows = make_rows(120, 2);
+    CrossJoinResult result;
+    ASSERT_TRUE(cross_join(left_rows, build_rows, conjuncts(), 1, 1, -1, &result).ok());
+    EXPECT_EQ(expected_rows(left_rows, build_rows, true), result.rows);
+    EXPECT_EQ(0, result.num_parallel_batches);
+}
+
+TEST_F(CrossJoinNodeTest, parallel_probe) {
+    std::vector<TestRow> left_rows = make_rows(250, 1);
+    std::vector<TestRow> build_rows = make_rows(120, 2);
+    std::vector<TestRow> expected = expected_rows(left_rows, build_rows, true);
+    // all left batches, then all but the last one which has fewer rows
+    for (int64_t min_pairs : {1L, LEFT_BATCH_SIZE * 120L}) {
+        SCOPED_TRACE(min_pairs);
+        CrossJoinResult result;
+        ASSERT_TRUE(cross_join(left_rows, build_rows, conjuncts(), 4, min_pairs, -1,
+                               &result).ok());
+        EXPECT_EQ(expected, result.rows);
+        EXPECT_EQ(min_pairs == 1 ? 3 : 2, result.num_parallel_batches);
+    }
+
+    // fewer left rows than threads
+    left_rows.resize(3);
+    CrossJoinResult result;
+    ASSERT_TRUE(cross_join(left_rows, build_rows, conjuncts(), 4, 1, -1, &result).ok());
+    EXPECT_EQ(expected_rows(left_rows, build_rows, true), result.rows);
+}
+
+TEST_F(CrossJoinNodeTest, no_conjuncts) {
+    // the rows are copied by the calling thread
+    std::vector<TestRow> left_rows = make_rows(250, 1);
+    std::vector<TestRow> build_rows = make_rows(30, 2);
+    CrossJoinResult result;
+    ASSERT_TRUE(cross_join(left_rows, build_rows, {}, 4, 1, -1, &result).ok());
+    EXPECT_EQ(expected_rows(left_rows, build_rows, false), result.rows);
+    EXPECT_EQ(0, result.num_parallel_batches);
+}
+
+TEST_F(CrossJoinNodeTest, empty_inputs) {
+    std::vector<TestRow> rows = make_rows(250, 1);
+    for (int num_threads : {1, 4}) {
+        CrossJoinResult empty_left;
+        ASSERT_TRUE(cross_join({}, rows, conjuncts(), num_threads, 1, -1, &empty_left).ok());
+        EXPECT_TRUE(empty_left.rows.empty());
+        CrossJoinResult empty_build;
+        ASSERT_TRUE(cross_join(rows, {}, conjuncts(), num_threads, 1, -1, &empty_build).ok());
+        EXPECT_TRUE(empty_build.rows.empty());
+    }
+}
+
+TEST_F(CrossJoinNodeTest, limit) {
+    // the first rows are returned
+    std::vector<TestRow> left_rows = make_rows(250, 1);
+    std::vector<TestRow> build_rows = make_rows(120, 2);
+    std::vector<TestRow> expected = expected_rows(left_rows, build_rows, true);
+    ASSERT_GT(expected.size(), 1500);
+    for (int num_threads : {1, 4}) {
+        for (int64_t limit : {1L, 17L, 1500L}) {
+            SCOPED_TRACE(limit);
+            CrossJoinResult result;
+            ASSERT_TRUE(cross_join(left_rows, build_rows, conjuncts(), num_threads, 1, limit,
+                                   &result).ok());
+            EXPECT_EQ(std::vector<TestRow>(expected.begin(), expected.begin() + limit),
+                      result.rows);
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,126 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/csv_tokenizer.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "util/cpu_info.h"
+
+namespace doris {
+
+class CsvTokenizerTest : public testing::Test {
+public:
+    CsvTokenizerTest() { }
+
+protected:
+    std::vector<std::string> split(CsvTokenizer* tokenizer, const std::string& line) {
+        std::vector<Slice> values;
+        tokenizer->split_line(Slice(line.data(), line.size()), &values);
+        std::vector<std::string> result;
+        for (auto& value : values) {
+            result.push_back(value.to_string());
+        }
+        return result;
+    }
+
+    // fields of every length up to 100, so separators fall on all positions
+    // of the 64 bytes blocks
+    void check_long_line() {
+        CsvTokenizer tokenizer('\t', '\n');
+        std::vector<std::string> fields;
+        std::string line;
+        for (int i = 0; i <= 100; ++i) {
+            fields.push_back(std::string(i, 'a' + i % 26));
+            if (i > 0) {
+                line.push_back('\t');
+            }
+            line.append(fields.back());
+        }
+        ASSERT_EQ(fields, split(&tokenizer, line));
+    }
+};
+
+TEST_F(CsvTokenizerTest, split) {
+    CsvTokenizer tokenizer(',', '\n');
+    ASSERT_EQ(std::vector<std::string>({"1", "abc", "", "2.5"}), split(&tokenizer, "1,abc,,2.5"));
+    ASSERT_EQ(std::vector<std::string>({""}), split(&tokenizer, ""));
+    ASSERT_EQ(std::vector<std::string>({"", ""}), split(&tokenizer, ","));
+    // quotes are kept if fields are not quoted
+    ASSERT_EQ(std::vector<std::string>({"\"a", "b\""}), split(&tokenizer, "\"a,b\""));
+}
+
+TEST_F(CsvTokenizerTest, long_line) {
+    check_long_line();
+}
+
+TEST_F(CsvTokenizerTest, long_line_without_avx2) {
+    CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+    check_long_line();
+}
+
+TEST_F(CsvTokenizerTest, quoted) {
+    CsvTokenizer tokenizer(',', '\n', '"');
+    ASSERT_EQ(std::vector<std::string>({"a,b", "c", ""}), split(&tokenizer, "\"a,b\",c,\"\""));
+    ASSERT_EQ(std::vector<std::string>({"say \"hi\"", "x"}),
+              split(&tokenizer, "\"say \"\"hi\"\"\",x"));
+    ASSERT_EQ(std::vector<std::string>({"line1\nline2", "\"\""}),
+              split(&tokenizer, "\"line1\nline2\",\"\"\"\"\"\""));
+
+    // escaped fields after a long quoted one
+    std::string long_value(200, ',');
+    ASSERT_EQ(std::vector<std::string>({long_value, "\"", "b"}),
+              split(&tokenizer, "\"" + long_value + "\",\"\"\"\",b"));
+}
+
+TEST_F(CsvTokenizerTest, find_line_delimiter) {
+    CsvTokenizer tokenizer(',', '\n');
+    std::string data = "1,2\n3,4\n";
+    bool in_quote = false;
+    const uint8_t* start = reinterpret_cast<const uint8_t*>(data.data());
+    ASSERT_EQ(start + 3, tokenizer.find_line_delimiter(start, data.size(), &in_quote));
+    ASSERT_EQ(nullptr, tokenizer.find_line_delimiter(start, 3, &in_quote));
+}
+
+TEST_F(CsvTokenizerTest, find_quoted_line_delimiter) {
+    CsvTokenizer tokenizer(',', '\n', '"');
+    std::string data = "1,\"a\nb\"\n2";
+    data.insert(3, 3000, 'x');
+    const uint8_t* start = reinterpret_cast<const uint8_t*>(data.data());
+    bool in_quote = false;
+    ASSERT_EQ(start + data.size() - 2,
+              tokenizer.find_line_delimiter(start, data.size(), &in_quote));
+    ASSERT_FALSE(in_quote);
+
+    // the quote state is kept when the line is searched in parts
+    in_quote = false;
+    ASSERT_EQ(nullptr, tokenizer.find_line_delimiter(start, 10, &in_quote));
+    ASSERT_TRUE(in_quote);
+    ASSERT_EQ(start + data.size() - 2,
+              tokenizer.find_line_delimiter(start + 10, data.size() - 10, &in_quote));
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,99 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/es/es_agg_reader.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/logging.h"
+#include "exec/es/es_predicate.h"
+#include "exec/es/es_scan_reader.h"
+#include "rapidjson/document.h"
+
+namespace doris {
+
+class ESAggReaderTest : public testing::Test {
+public:
+    ESAggReaderTest() {
+        _properties[ESScanReader::KEY_BATCH_SIZE] = "100";
+    }
+
+protected:
+    std::map<std::string, std::string> _properties;
+    std::vector<EsPredicate*> _predicates;
+};
+
+static TEsAggregateFunction make_function(const std::string& name, const std::string& column) {
+    TEsAggregateFunction function;
+    function.function_name = name;
+    if (!column.empty()) {
+        function.__set_column(column);
+    }
+    return function;
+}
+
+TEST_F(ESAggReaderTest, without_group_by) {
+    TEsAggregation aggregation;
+    aggregation.functions.push_back(make_function("count", ""));
+    aggregation.functions.push_back(make_function("sum", "price"));
+    aggregation.functions.push_back(make_function("count", "price"));
+
+    rapidjson::Document query;
+    query.Parse(ESAggReader::build_query(_properties, aggregation, _predicates).c_str());
+    ASSERT_FALSE(query.HasParseError());
+    ASSERT_EQ(0, query["size"].GetInt());
+    const rapidjson::Value& aggs = query["aggs"];
+    // count(*) is the total of the hits
+    ASSERT_FALSE(aggs.HasMember("a0"));
+    ASSERT_STREQ("price", aggs["a1"]["sum"]["field"].GetString());
+    ASSERT_STREQ("price", aggs["a2"]["value_count"]["field"].GetString());
+}
+
+TEST_F(ESAggReaderTest, group_by) {
+    TEsAggregation aggregation;
+    TEsGroupBy by_city;
+    by_city.column = "city";
+    TEsGroupBy by_day;
+    by_day.column = "time";
+    by_day.__set_date_interval("1d");
+    aggregation.group_by = {by_city, by_day};
+    aggregation.functions.push_back(make_function("max", "price"));
+
+    rapidjson::Document query;
+    query.Parse(ESAggReader::build_query(_properties, aggregation, _predicates).c_str());
+    ASSERT_FALSE(query.HasParseError());
+    const rapidjson::Value& groups = query["aggs"]["groups"];
+    const rapidjson::Value& composite = groups["composite"];
+    ASSERT_EQ(100, composite["size"].GetInt());
+    ASSERT_EQ(2, composite["sources"].Size());
+    ASSERT_STREQ("city", composite["sources"][0]["g0"]["terms"]["field"].GetString());
+    ASSERT_TRUE(composite["sources"][0]["g0"]["terms"]["missing_bucket"].GetBool());
+    ASSERT_STREQ("1d", composite["sources"][1]["g1"]["date_histogram"]["interval"].GetString());
+    ASSERT_STREQ("price", groups["aggs"]["a0"]["max"]["field"].GetString());
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -237,6 +237,34 @@ TEST_F(MockESServerTest, workflow) {
     auto cst = reader.close();
     ASSERT_TRUE(cst.ok());
 }
+
+TEST_F(MockESServerTest, docvalue_and_slice) {
+    std::vector<std::string> fields = {"id", "value"};
+    std::map<std::string, std::string> props;
+    props[ESScanReader::KEY_BATCH_SIZE] = "100";
+    props[ESScanReader::KEY_DOCVALUE_FIELDS] = "id, unknown";
+    props[ESScanReader::KEY_SLICE_ID] = "1";
+    props[ESScanReader::KEY_SLICE_MAX] = "4";
+    std::vector<EsPredicate*> predicates;
+    rapidjson::Document query;
+    query.Parse(ESScrollQueryBuilder::build(props, fields, predicates).c_str());
+    ASSERT_FALSE(query.HasParseError());
+
+    ASSERT_EQ(1, query["_source"].Size());
+    ASSERT_STREQ("value", query["_source"][0].GetString());
+    ASSERT_EQ(1, query["docvalue_fields"].Size());
+    ASSERT_STREQ("id", query["docvalue_fields"][0].GetString());
+    ASSERT_EQ(1, query["slice"]["id"].GetInt());
+    ASSERT_EQ(4, query["slice"]["max"].GetInt());
+
+    // no _source at all if every field is read from doc values
+    props[ESScanReader::KEY_DOCVALUE_FIELDS] = "id,value";
+    props[ESScanReader::KEY_SLICE_MAX] = "1";
+    query.Parse(ESScrollQueryBuilder::build(props, fields, predicates).c_str());
+    ASSERT_TRUE(query["_source"].IsFalse());
+    ASSERT_EQ(2, query["docvalue_fields"].Size());
+    ASSERT_FALSE(query.HasMember("slice"));
+}
 }
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,446 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+// Micro benchmarks of the execution operators over synthetic row batches.
+// They are built with the unit tests but not run by run-ut.sh, run
+// exec_benchmark to print the throughput of every operator and --gtest_filter
+// to select some. Rows are one tuple of an INT key and a BIGINT value, keys
+// are drawn from --exec_benchmark_cardinality distinct values, skewed towards
+// the small ones by --exec_benchmark_skew. The data is generated from fixed
+// seeds and every benchmark reports the best of several rounds, so results of
+// two builds on one machine can be compared.
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exec/hash_table.hpp"
+#include "exec/join_hash_table.h"
+#include "exprs/binary_predicate.h"
+#include "exprs/expr.h"
+#include "exprs/expr_column.h"
+#include "exprs/expr_context.h"
+#include "exprs/literal.h"
+#include "exprs/slot_ref.h"
+#include "gen_cpp/data.pb.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/raw_value.h"
+#include "runtime/row_batch.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "testutil/desc_tbl_builder.h"
+#include "util/cpu_info.h"
+#include "util/random.h"
+#include "util/time.h"
+#include "util/tuple_row_compare.h"
+
+DEFINE_int32(exec_benchmark_rows, 1024 * 1024, "rows of the generated input");
+DEFINE_int32(exec_benchmark_cardinality, 100000, "distinct keys of the generated input");
+DEFINE_double(exec_benchmark_skew, 0, "0 draws the keys uniformly, larger values draw "
+              "the small keys more often");
+
+namespace doris {
+
+static const int NUM_ROUNDS = 5;
+static const int BATCH_SIZE = 1024;
+static const uint32_t SEED = 301;
+
+// Runs 'body' NUM_ROUNDS times after 'prepare', which is not timed, and
+// prints the throughput of the fastest round. 'memory' returns the bytes used
+// by the operator after the round, if any.
+static void run_benchmark(const std::string& name, int64_t rows,
+                          const std::function<void()>& prepare,
+                          const std::function<void()>& body,
+                          const std::function<int64_t()>& memory = nullptr) {
+    int64_t best_ns = -1;
+    int64_t bytes = 0;
+    for (int i = 0; i < NUM_ROUNDS; ++i) {
+        prepare();
+        int64_t start_ns = MonotonicNanos();
+        body();
+        int64_t ns = std::max<int64_t>(MonotonicNanos() - start_ns, 1);
+        if (best_ns < 0 || ns < best_ns) {
+            best_ns = ns;
+        }
+        if (memory != nullptr) {
+            bytes = std::max(bytes, memory());
+        }
+    }
+    std::cout << name << ": " << static_cast<int64_t>(rows * 1e9 / best_ns) << " rows/s, "
+        << static_cast<double>(best_ns) * CpuInfo::cycles_per_ms() / 1e6 / rows
+        << " cycles/row";
+    if (bytes > 0) {
+        std::cout << ", " << bytes / 1024 / 1024 << " MB";
+    }
+    std::cout << ", best of " << NUM_ROUNDS << " rounds " << best_ns / 1000 << "us"
+        << std::endl;
+}
+
+class ExecBenchmark : public testing::Test {
+public:
+    ExecBenchmark() : _mem_pool(&_tracker) { }
+
+    void SetUp() override {
+        DescriptorTblBuilder builder(&_pool);
+        builder.declare_tuple() << TYPE_INT << TYPE_BIGINT;
+        std::vector<bool> nullable_tuples(1, false);
+        std::vector<TTupleId> tuple_ids(1, static_cast<TTupleId>(0));
+        _row_desc = _pool.add(new RowDescriptor(*builder.build(), tuple_ids, nullable_tuples));
+        const TupleDescriptor* tuple_desc = _row_desc->tuple_descriptors()[0];
+        _key_offset = tuple_desc->slots()[0]->tuple_offset();
+        _value_offset = tuple_desc->slots()[1]->tuple_offset();
+
+        _num_rows = FLAGS_exec_benchmark_rows;
+        _batches = _generate_batches(SEED);
+    }
+
+    void TearDown() override {
+        for (auto& ctxs : {&_key_ctxs, &_probe_key_ctxs, &_value_ctxs}) {
+            Expr::close(*ctxs, NULL);
+        }
+        _batches.clear();
+        _mem_pool.free_all();
+    }
+
+protected:
+    // a key of [0, cardinality), uniform if skew is 0
+    int32_t _next_key(Random* random) {
+        double u = random->Next() / 2147483647.0;
+        int32_t key = static_cast<int32_t>(FLAGS_exec_benchmark_cardinality
+                                           * std::pow(u, 1 + FLAGS_exec_benchmark_skew));
+        return std::min(key, FLAGS_exec_benchmark_cardinality - 1);
+    }
+
+    std::vector<std::unique_ptr<RowBatch>> _generate_batches(uint32_t seed) {
+        Random random(seed);
+        int tuple_size = _row_desc->tuple_descriptors()[0]->byte_size();
+        std::vector<std::unique_ptr<RowBatch>> batches;
+        for (int i = 0; i < _num_rows; i += BATCH_SIZE) {
+            batches.emplace_back(new RowBatch(*_row_desc, BATCH_SIZE, &_tracker));
+            RowBatch* batch = batches.back().get();
+            for (int j = i; j < std::min(i + BATCH_SIZE, _num_rows); ++j) {
+                Tuple* tuple = Tuple::create(tuple_size, &_mem_pool);
+                *reinterpret_cast<int32_t*>(tuple->get_slot(_key_offset)) = _next_key(&random);
+                *reinterpret_cast<int64_t*>(tuple->get_slot(_value_offset)) = random.Next();
+                int idx = batch->add_row();
+                batch->get_row(idx)->set_tuple(0, tuple);
+                batch->commit_last_row();
+            }
+        }
+        return batches;
+    }
+
+    Expr* _slot_ref(PrimitiveType type, int offset) {
+        return _pool.add(new SlotRef(type, offset));
+    }
+
+    void _add_ctx(Expr* expr, std::vector<ExprContext*>* ctxs) {
+        ctxs->push_back(_pool.add(new ExprContext(expr)));
+    }
+
+    void _prepare(std::vector<ExprContext*>* ctxs) {
+        RowDescriptor desc;
+        ASSERT_TRUE(Expr::prepare(*ctxs, NULL, desc, &_tracker).ok());
+        ASSERT_TRUE(Expr::open(*ctxs, NULL).ok());
+    }
+
+    // key exprs of the build and probe sides, and an expr of the value
+    void _prepare_key_exprs() {
+        _add_ctx(_slot_ref(TYPE_INT, _key_offset), &_key_ctxs);
+        _add_ctx(_slot_ref(TYPE_INT, _key_offset), &_probe_key_ctxs);
+        _add_ctx(_slot_ref(TYPE_BIGINT, _value_offset), &_value_ctxs);
+        _prepare(&_key_ctxs);
+        _prepare(&_probe_key_ctxs);
+        _prepare(&_value_ctxs);
+    }
+
+    std::string _data_name() {
+        return std::to_string(FLAGS_exec_benchmark_cardinality) + " keys skew "
+            + std::to_string(FLAGS_exec_benchmark_skew).substr(0, 4);
+    }
+
+    ObjectPool _pool;
+    MemTracker _tracker;
+    MemPool _mem_pool;
+    RowDescriptor* _row_desc = nullptr;
+    int _key_offset = 0;
+    int _value_offset = 0;
+    int _num_rows = 0;
+    std::vector<std::unique_ptr<RowBatch>> _batches;
+    std::vector<ExprContext*> _key_ctxs;
+    std::vector<ExprContext*> _probe_key_ctxs;
+    std::vector<ExprContext*> _value_ctxs;
+};
+
+TEST_F(ExecBenchmark, join_hash_table) {
+    _prepare_key_exprs();
+    std::unique_ptr<MemTracker> tracker;
+    std::unique_ptr<JoinHashTable> table;
+    run_benchmark("JoinHashTable build " + _data_name(), _num_rows,
+        [&] () {
+            if (table != nullptr) {
+                table->close();
+            }
+            table.reset();
+            tracker.reset(new MemTracker());
+            table.reset(new JoinHashTable(_key_ctxs, 1, 0, tracker.get()));
+        },
+        [&] () {
+            for (auto& batch : _batches) {
+                table->add_batch(_key_ctxs, batch.get());
+            }
+            table->build();
+        },
+        [&] () { return tracker->peak_consumption(); });
+
+    // probes with other rows of the same distribution
+    std::vector<std::unique_ptr<RowBatch>> probe_batches = _generate_batches(SEED + 1);
+    JoinHashTable::ProbeBatch probe;
+    int64_t num_matches = 0;
+    run_benchmark("JoinHashTable probe " + _data_name(), _num_rows,
+        [] () { },
+        [&] () {
+            for (auto& batch : probe_batches) {
+                table->find_batch(_probe_key_ctxs, batch.get(), &probe);
+                for (int i = 0; i < batch->num_rows(); ++i) {
+                    for (int32_t idx = probe.first_match(i); idx != -1;
+                            idx = table->next_match(idx)) {
+                        ++num_matches;
+                    }
+                }
+            }
+        });
+    ASSERT_GT(num_matches, 0);
+    table->close();
+}
+
+// the grouping of an aggregation: every row finds its group or inserts it
+TEST_F(ExecBenchmark, aggregation_hash_table) {
+    _prepare_key_exprs();
+    std::unique_ptr<MemTracker> tracker;
+    std::unique_ptr<HashTable> table;
+    run_benchmark("HashTable group by " + _data_name(), _num_rows,
+        [&] () {
+            if (table != nullptr) {
+                table->close();
+            }
+            table.reset();
+            tracker.reset(new MemTracker());
+            table.reset(new HashTable(_key_ctxs, _probe_key_ctxs, 1, true, 0,
+                                      tracker.get(), 1024));
+        },
+        [&] () {
+            for (auto& batch : _batches) {
+                for (int i = 0; i < batch->num_rows(); ++i) {
+                    TupleRow* row = batch->get_row(i);
+                    if (table->find(row) == table->end()) {
+                        table->insert(row);
+                    }
+                }
+            }
+        },
+        [&] () { return table->byte_size(); });
+    ASSERT_GT(table->size(), 0);
+    table->close();
+}
+
+TEST_F(ExecBenchmark, sort) {
+    _prepare_key_exprs();
+    TupleRowComparator less_than(_key_ctxs, _probe_key_ctxs, true, false);
+    std::vector<TupleRow*> rows;
+    run_benchmark("sort " + _data_name(), _num_rows,
+        [&] () {
+            rows.clear();
+            for (auto& batch : _batches) {
+                for (int i = 0; i < batch->num_rows(); ++i) {
+                    rows.push_back(batch->get_row(i));
+                }
+            }
+        },
+        [&] () {
+            std::sort(rows.begin(), rows.end(), less_than);
+        });
+
+    // the limit of a top-n, the heap keeps its largest row on top
+    const int limit = 100;
+    typedef std::priority_queue<TupleRow*, std::vector<TupleRow*>, TupleRowComparator> Heap;
+    std::unique_ptr<Heap> heap;
+    run_benchmark("top " + std::to_string(limit) + " " + _data_name(), _num_rows,
+        [&] () { heap.reset(new Heap(less_than)); },
+        [&] () {
+            for (auto& batch : _batches) {
+                for (int i = 0; i < batch->num_rows(); ++i) {
+                    TupleRow* row = batch->get_row(i);
+                    if (heap->size() < limit) {
+                        heap->push(row);
+                    } else if (less_than(row, heap->top())) {
+                        heap->pop();
+                        heap->push(row);
+                    }
+                }
+            }
+        });
+    ASSERT_EQ(limit, heap->size());
+}
+
+// the hash partitioning of DataStreamSender over 16 channels
+TEST_F(ExecBenchmark, hash_partition) {
+    _prepare_key_exprs();
+    const int num_channels = 16;
+    std::vector<uint32_t> hash_vals;
+    std::vector<std::vector<int>> channel_rows(num_channels);
+    run_benchmark("hash partition " + std::to_string(num_channels) + " channels",
+                  _num_rows,
+        [] () { },
+        [&] () {
+            for (auto& batch : _batches) {
+                int num_rows = batch->num_rows();
+                hash_vals.assign(num_rows, 0);
+                for (auto ctx : _key_ctxs) {
+                    PrimitiveType type = ctx->root()->type().type;
+                    for (int i = 0; i < num_rows; ++i) {
+                        void* partition_val = ctx->get_value(batch->get_row(i));
+                        hash_vals[i] = RawValue::get_hash_value_fvn(
+                                partition_val, type, hash_vals[i]);
+                    }
+                }
+                for (auto& rows : channel_rows) {
+                    rows.clear();
+                }
+                for (int i = 0; i < num_rows; ++i) {
+                    channel_rows[hash_vals[i] % num_channels].push_back(i);
+                }
+            }
+        });
+}
+
+TEST_F(ExecBenchmark, row_batch_serialize) {
+    struct Codec {
+        std::string name;
+        bool compress;
+        PRowBatchCodec codec;
+    };
+    std::vector<Codec> codecs = {
+        {"uncompressed", false, ROW_BATCH_LZ4},
+        {"lz4", true, ROW_BATCH_LZ4},
+        {"snappy", true, ROW_BATCH_SNAPPY},
+    };
+    for (auto& codec : codecs) {
+        std::vector<PRowBatch> pbs(_batches.size());
+        int64_t bytes = 0;
+        run_benchmark("RowBatch::serialize " + codec.name, _num_rows,
+            [&] () { bytes = 0; },
+            [&] () {
+                for (int i = 0; i < _batches.size(); ++i) {
+                    _batches[i]->serialize(&pbs[i], codec.compress, codec.codec);
+                }
+            },
+            [&] () {
+                for (auto& pb : pbs) {
+                    bytes += pb.tuple_data().size();
+                }
+                return bytes;
+            });
+
+        int64_t num_rows = 0;
+        run_benchmark("RowBatch deserialize " + codec.name, _num_rows,
+            [] () { },
+            [&] () {
+                MemTracker tracker;
+                for (auto& pb : pbs) {
+                    RowBatch batch(*_row_desc, pb, &tracker);
+                    num_rows += batch.num_rows();
+                }
+            });
+        ASSERT_EQ(static_cast<int64_t>(_num_rows) * NUM_ROUNDS, num_rows);
+    }
+}
+
+// key < cardinality / 2, row by row as conjuncts and by batch
+TEST_F(ExecBenchmark, expr_evaluate) {
+    TExprNode pred_node;
+    pred_node.__set_node_type(TExprNodeType::BINARY_PRED);
+    pred_node.__set_type(TypeDescriptor(TYPE_BOOLEAN).to_thrift());
+    pred_node.__set_num_children(2);
+    pred_node.__set_opcode(TExprOpcode::LT);
+    pred_node.__set_child_type(TPrimitiveType::INT);
+    Expr* pred = _pool.add(BinaryPredicate::from_thrift(pred_node));
+    ASSERT_TRUE(pred != nullptr);
+
+    TExprNode literal_node;
+    literal_node.__set_node_type(TExprNodeType::INT_LITERAL);
+    literal_node.__set_type(TypeDescriptor(TYPE_INT).to_thrift());
+    literal_node.__set_num_children(0);
+    TIntLiteral int_literal;
+    int_literal.__set_value(FLAGS_exec_benchmark_cardinality / 2);
+    literal_node.__set_int_literal(int_literal);
+    pred->add_child(_slot_ref(TYPE_INT, _key_offset));
+    pred->add_child(_pool.add(new Literal(literal_node)));
+
+    std::vector<ExprContext*> ctxs;
+    _add_ctx(pred, &ctxs);
+    _prepare(&ctxs);
+
+    int64_t num_selected = 0;
+    run_benchmark("BinaryPredicate get_boolean_val", _num_rows,
+        [&] () { num_selected = 0; },
+        [&] () {
+            for (auto& batch : _batches) {
+                for (int i = 0; i < batch->num_rows(); ++i) {
+                    BooleanVal v = ctxs[0]->get_boolean_val(batch->get_row(i));
+                    num_selected += !v.is_null && v.val;
+                }
+            }
+        });
+    int64_t expected_selected = num_selected;
+
+    ExprColumn result;
+    run_benchmark("BinaryPredicate evaluate batch", _num_rows,
+        [&] () { num_selected = 0; },
+        [&] () {
+            for (auto& batch : _batches) {
+                ctxs[0]->evaluate(batch.get(), NULL, batch->num_rows(), &result);
+                const bool* values = result.values<bool>();
+                const uint8_t* nulls = result.nulls();
+                for (int i = 0; i < batch->num_rows(); ++i) {
+                    num_selected += !nulls[i] && values[i];
+                }
+            }
+        });
+    ASSERT_EQ(expected_selected, num_selected);
+    Expr::close(ctxs, NULL);
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    return RUN_ALL_TESTS();
+}
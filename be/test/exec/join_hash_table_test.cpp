@@ -0,0 +1,351 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/join_hash_table.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "exprs/slot_ref.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "testutil/desc_tbl_builder.h"
+#include "util/cpu_info.h"
+
+namespace doris {
+
+// rows of one tuple of two ints, the key is both of them
+class JoinHashTableTest : public testing::Test {
+public:
+    JoinHashTableTest() : _mem_pool(&_tracker) { }
+
+protected:
+    virtual void SetUp() {
+        DescriptorTblBuilder builder(&_pool);
+        builder.declare_tuple() << TYPE_INT << TYPE_INT;
+        std::vector<bool> nullable_tuples(1, true);
+        std::vector<TTupleId> tuple_ids(1, static_cast<TTupleId>(0));
+        _row_desc = _pool.add(new RowDescriptor(*builder.build(), tuple_ids, nullable_tuples));
+
+        add_exprs(&_build_expr_ctxs);
+        add_exprs(&_probe_expr_ctxs);
+    }
+
+    virtual void TearDown() {
+        Expr::close(_build_expr_ctxs, NULL);
+        Expr::close(_probe_expr_ctxs, NULL);
+        _mem_pool.free_all();
+    }
+
+    void add_exprs(std::vector<ExprContext*>* ctxs) {
+        for (int i = 0; i < 2; ++i) {
+            Expr* expr = _pool.add(new SlotRef(TYPE_INT, i * sizeof(int32_t)));
+            ctxs->push_back(_pool.add(new ExprContext(expr)));
+        }
+        RowDescriptor desc;
+        ASSERT_TRUE(Expr::prepare(*ctxs, NULL, desc, &_tracker).ok());
+        ASSERT_TRUE(Expr::open(*ctxs, NULL).ok());
+    }
+
+    // a NULL tuple makes a NULL key
+    Tuple* create_tuple(int32_t v1, int32_t v2) {
+        Tuple* tuple = Tuple::create(2 * sizeof(int32_t), &_mem_pool);
+        reinterpret_cast<int32_t*>(tuple)[0] = v1;
+        reinterpret_cast<int32_t*>(tuple)[1] = v2;
+        return tuple;
+    }
+
+    void add_row(RowBatch* batch, Tuple* tuple) {
+        int idx = batch->add_row();
+        batch->get_row(idx)->set_tuple(0, tuple);
+        batch->commit_last_row();
+    }
+
+    // in batches of 1000 rows followed by a NULL key
+    void add_build_rows(JoinHashTable* table, const std::vector<Tuple*>& tuples) {
+        for (int i = 0; i < tuples.size(); i += 1000) {
+            RowBatch batch(*_row_desc, 1024, &_tracker);
+            for (int j = i; j < i + 1000; ++j) {
+                add_row(&batch, tuples[j]);
+            }
+            add_row(&batch, NULL);
+            table->add_batch(_build_expr_ctxs, &batch);
+        }
+    }
+
+    // 'build_tuples' has every key of [0, num_keys) twice
+    void check_matches(const JoinHashTable& table, const std::vector<Tuple*>& build_tuples,
+                       int num_keys) {
+        check_matches(table, build_tuples, num_keys, _probe_expr_ctxs);
+    }
+
+    void check_matches(const JoinHashTable& table, const std::vector<Tuple*>& build_tuples,
+                       int num_keys, const std::vector<ExprContext*>& probe_expr_ctxs) {
+        MemTracker tracker;
+        MemPool mem_pool(&tracker);
+        RowBatch batch(*_row_desc, 1024, &tracker);
+        std::vector<Tuple*> tuples;
+        for (int i = 0; i < 1000; ++i) {
+            int32_t value = i * 23;
+            // the second value does not match above num_keys
+            Tuple* tuple = Tuple::create(2 * sizeof(int32_t), &mem_pool);
+            reinterpret_cast<int32_t*>(tuple)[0] = value;
+            reinterpret_cast<int32_t*>(tuple)[1] = value / 7;
+            add_row(&batch, tuple);
+        }
+        add_row(&batch, NULL);
+        JoinHashTable::ProbeBatch probe;
+        table.find_batch(probe_expr_ctxs, &batch, &probe);
+
+        for (int i = 0; i < 1000; ++i) {
+            int32_t value = i * 23;
+            int32_t row_idx = probe.first_match(i);
+            if (value >= num_keys) {
+                EXPECT_EQ(-1, row_idx);
+                continue;
+            }
+            std::vector<Tuple*> matches;
+            for (; row_idx != -1; row_idx = table.next_match(row_idx)) {
+                matches.push_back(table.get_row(row_idx)->get_tuple(0));
+            }
+            ASSERT_EQ(2U, matches.size());
+            // rows of a key are returned from the last added
+            EXPECT_EQ(build_tuples[value + num_keys], matches[0]);
+            EXPECT_EQ(build_tuples[value], matches[1]);
+        }
+        EXPECT_EQ(-1, probe.first_match(1000));
+        mem_pool.free_all();
+    }
+
+    // every key of [0, num_keys) is found as build row 0 of a keys only table
+    void check_keys_only_matches(const JoinHashTable& table, int num_keys,
+                                 const std::vector<ExprContext*>& probe_expr_ctxs) {
+        MemTracker tracker;
+        MemPool mem_pool(&tracker);
+        RowBatch batch(*_row_desc, 1024, &tracker);
+        for (int i = 0; i < 1000; ++i) {
+            int32_t value = i * 23 - 100;
+            Tuple* tuple = Tuple::create(2 * sizeof(int32_t), &mem_pool);
+            reinterpret_cast<int32_t*>(tuple)[0] = value;
+            reinterpret_cast<int32_t*>(tuple)[1] = value / 7;
+            add_row(&batch, tuple);
+        }
+        add_row(&batch, NULL);
+        JoinHashTable::ProbeBatch probe;
+        table.find_batch(probe_expr_ctxs, &batch, &probe);
+
+        for (int i = 0; i < 1000; ++i) {
+            int32_t value = i * 23 - 100;
+            if (value < 0 || value >= num_keys) {
+                EXPECT_EQ(-1, probe.first_match(i));
+                continue;
+            }
+            ASSERT_EQ(0, probe.first_match(i));
+        }
+        EXPECT_EQ(-1, probe.first_match(1000));
+        EXPECT_EQ(-1, table.next_match(0));
+        EXPECT_TRUE(table.get_row(0)->get_tuple(0) == NULL);
+        mem_pool.free_all();
+    }
+
+    ObjectPool _pool;
+    MemTracker _tracker;
+    MemPool _mem_pool;
+    RowDescriptor* _row_desc;
+    std::vector<ExprContext*> _build_expr_ctxs;
+    std::vector<ExprContext*> _probe_expr_ctxs;
+};
+
+TEST_F(JoinHashTableTest, can_normalize_keys) {
+    ASSERT_TRUE(JoinHashTable::can_normalize_keys(_build_expr_ctxs, _probe_expr_ctxs));
+
+    std::vector<ExprContext*> doubles;
+    doubles.push_back(_pool.add(new ExprContext(_pool.add(new SlotRef(TYPE_DOUBLE, 0)))));
+    ASSERT_FALSE(JoinHashTable::can_normalize_keys(doubles, doubles));
+
+    std::vector<ExprContext*> strings;
+    strings.push_back(_pool.add(new ExprContext(_pool.add(new SlotRef(TYPE_VARCHAR, 0)))));
+    ASSERT_FALSE(JoinHashTable::can_normalize_keys(strings, strings));
+
+    std::vector<ExprContext*> bigints;
+    bigints.push_back(_pool.add(new ExprContext(_pool.add(new SlotRef(TYPE_BIGINT, 0)))));
+    std::vector<ExprContext*> ints(_build_expr_ctxs.begin(), _build_expr_ctxs.begin() + 1);
+    ASSERT_FALSE(JoinHashTable::can_normalize_keys(bigints, ints));
+
+    std::vector<ExprContext*> wide_keys;
+    for (int i = 0; i < 3; ++i) {
+        wide_keys.push_back(
+            _pool.add(new ExprContext(_pool.add(new SlotRef(TYPE_LARGEINT, i * 16)))));
+    }
+    ASSERT_FALSE(JoinHashTable::can_normalize_keys(wide_keys, wide_keys));
+}
+
+TEST_F(JoinHashTableTest, find) {
+    MemTracker table_tracker;
+    JoinHashTable table(_build_expr_ctxs, 1, 0, &table_tracker);
+
+    // every key twice, in several batches
+    const int num_keys = 20000;
+    std::vector<Tuple*> build_tuples;
+    for (int i = 0; i < 2 * num_keys; ++i) {
+        build_tuples.push_back(create_tuple(i % num_keys, (i % num_keys) / 7));
+    }
+    add_build_rows(&table, build_tuples);
+    table.build();
+    ASSERT_EQ(2 * num_keys, table.size());
+    ASSERT_LE(table.load_factor(), 0.875);
+    ASSERT_GT(table.byte_size(), 0);
+    ASSERT_EQ(table.byte_size(), table_tracker.consumption());
+    check_matches(table, build_tuples, num_keys);
+
+    table.close();
+    ASSERT_EQ(0, table_tracker.consumption());
+}
+
+TEST_F(JoinHashTableTest, keys_only) {
+    MemTracker table_tracker;
+    JoinHashTable table(_build_expr_ctxs, 1, 0, &table_tracker, true);
+    ASSERT_TRUE(table.keys_only());
+
+    const int num_keys = 20000;
+    std::vector<Tuple*> build_tuples;
+    for (int i = 0; i < 2 * num_keys; ++i) {
+        build_tuples.push_back(create_tuple(i % num_keys, (i % num_keys) / 7));
+    }
+    add_build_rows(&table, build_tuples);
+    table.build();
+    // the added rows are counted, the keys are kept once
+    ASSERT_EQ(2 * num_keys, table.size());
+    int64_t num_distinct_keys = 0;
+    table.for_each_key([&](const uint8_t* key) {
+        int32_t v1 = *reinterpret_cast<const int32_t*>(key + table.key_offset(0));
+        int32_t v2 = *reinterpret_cast<const int32_t*>(key + table.key_offset(1));
+        EXPECT_EQ(v1 / 7, v2);
+        ++num_distinct_keys;
+    });
+    ASSERT_EQ(num_keys, num_distinct_keys);
+    ASSERT_EQ(table.byte_size(), table_tracker.consumption());
+    check_keys_only_matches(table, num_keys, _probe_expr_ctxs);
+
+    table.close();
+    ASSERT_EQ(0, table_tracker.consumption());
+}
+
+// a single dense integer key is kept in a bitmap
+TEST_F(JoinHashTableTest, keys_only_bitmap) {
+    std::vector<ExprContext*> build_expr_ctxs(_build_expr_ctxs.begin(), _build_expr_ctxs.begin() + 1);
+    std::vector<ExprContext*> probe_expr_ctxs(_probe_expr_ctxs.begin(), _probe_expr_ctxs.begin() + 1);
+    MemTracker table_tracker;
+    JoinHashTable table(build_expr_ctxs, 1, 0, &table_tracker, true);
+
+    const int num_keys = 20000;
+    std::vector<Tuple*> build_tuples;
+    for (int i = 0; i < 2 * num_keys; ++i) {
+        build_tuples.push_back(create_tuple(i % num_keys, 0));
+    }
+    for (int i = 0; i < build_tuples.size(); i += 1000) {
+        RowBatch batch(*_row_desc, 1024, &_tracker);
+        for (int j = i; j < i + 1000; ++j) {
+            add_row(&batch, build_tuples[j]);
+        }
+        add_row(&batch, NULL);
+        table.add_batch(build_expr_ctxs, &batch);
+    }
+    table.build();
+    // the partitions are replaced
+    ASSERT_EQ(0, table.num_buckets());
+    ASSERT_EQ(2 * num_keys, table.size());
+    int64_t num_distinct_keys = 0;
+    int32_t last_key = -1;
+    table.for_each_key([&](const uint8_t* key) {
+        int32_t value = *reinterpret_cast<const int32_t*>(key);
+        EXPECT_EQ(last_key + 1, value);
+        last_key = value;
+        ++num_distinct_keys;
+    });
+    ASSERT_EQ(num_keys, num_distinct_keys);
+    ASSERT_EQ(table.byte_size(), table_tracker.consumption());
+    check_keys_only_matches(table, num_keys, probe_expr_ctxs);
+
+    table.close();
+    ASSERT_EQ(0, table_tracker.consumption());
+}
+
+// the partitions are built by several threads, and probed by several threads
+TEST_F(JoinHashTableTest, parallel_build) {
+    MemTracker table_tracker;
+    JoinHashTable table(_build_expr_ctxs, 1, 0, &table_tracker);
+
+    const int num_keys = 20000;
+    std::vector<Tuple*> build_tuples;
+    for (int i = 0; i < 2 * num_keys; ++i) {
+        build_tuples.push_back(create_tuple(i % num_keys, (i % num_keys) / 7));
+    }
+    add_build_rows(&table, build_tuples);
+    table.prepare_build();
+    const int num_threads = 4;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&table, i] {
+            for (int p = i; p < JoinHashTable::NUM_PARTITIONS; p += num_threads) {
+                table.build_partition(p);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    table.finish_build();
+    ASSERT_EQ(2 * num_keys, table.size());
+
+    // the probe exprs are not shared by the threads in the join, neither here
+    std::vector<std::vector<ExprContext*>> probe_expr_ctxs(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+        add_exprs(&probe_expr_ctxs[i]);
+    }
+    threads.clear();
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([this, &table, &build_tuples, &probe_expr_ctxs, i] {
+            check_matches(table, build_tuples, num_keys, probe_expr_ctxs[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& ctxs : probe_expr_ctxs) {
+        Expr::close(ctxs, NULL);
+    }
+    table.close();
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,104 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/json_line_parser.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace doris {
+
+class JsonLineParserTest : public testing::Test {
+public:
+    JsonLineParserTest() { }
+
+protected:
+    // null values are "NULL"
+    std::vector<std::string> parse(JsonLineParser* parser, const std::string& line) {
+        std::vector<Slice> values;
+        std::vector<uint8_t> is_null;
+        std::string error;
+        EXPECT_TRUE(parser->parse(Slice(line), &values, &is_null, &error)) << error;
+        std::vector<std::string> result;
+        for (int i = 0; i < values.size(); ++i) {
+            result.push_back(is_null[i] ? "NULL" : values[i].to_string());
+        }
+        return result;
+    }
+};
+
+TEST_F(JsonLineParserTest, normal) {
+    JsonLineParser parser({"k1", "k2", "k3", "k4"});
+    ASSERT_EQ(std::vector<std::string>({"1", "abc", "2.50", "1"}),
+              parse(&parser, "{\"k1\": 1, \"k2\": \"abc\", \"k3\": 2.50, \"k4\": true}"));
+    // keys in any order, missing and null values
+    ASSERT_EQ(std::vector<std::string>({"-3", "NULL", "NULL", "0"}),
+              parse(&parser, "{\"k4\":false,\"k1\":-3,\"k3\":null}"));
+    // escaped strings
+    ASSERT_EQ(std::vector<std::string>({"NULL", "a\"b\\c\n", "NULL", "NULL"}),
+              parse(&parser, "{\"k2\":\"a\\\"b\\\\c\\n\"}"));
+}
+
+TEST_F(JsonLineParserTest, nested_path) {
+    JsonLineParser parser({"$.a.b", "$.c", "a.d"});
+    ASSERT_EQ(std::vector<std::string>({"x", "12345678901234567890", "NULL"}),
+              parse(&parser, "{\"a\": {\"b\": \"x\"}, \"c\": 12345678901234567890}"));
+    // a path through a scalar is missing
+    ASSERT_EQ(std::vector<std::string>({"NULL", "NULL", "NULL"}),
+              parse(&parser, "{\"a\": 1}"));
+}
+
+TEST_F(JsonLineParserTest, error) {
+    JsonLineParser parser({"k1"});
+    std::vector<Slice> values;
+    std::vector<uint8_t> is_null;
+    std::string error;
+    ASSERT_FALSE(parser.parse(Slice("{\"k1\": 1"), &values, &is_null, &error));
+    ASSERT_FALSE(error.empty());
+    ASSERT_FALSE(parser.parse(Slice("[1, 2]"), &values, &is_null, &error));
+    ASSERT_FALSE(parser.parse(Slice("{\"k1\": [1, 2]}"), &values, &is_null, &error));
+    ASSERT_FALSE(parser.parse(Slice("{\"k1\": {}}"), &values, &is_null, &error));
+
+    // the parser is usable after errors
+    ASSERT_EQ(std::vector<std::string>({"v"}), parse(&parser, "{\"k1\": \"v\"}"));
+}
+
+TEST_F(JsonLineParserTest, large_line) {
+    // larger than the buffers of the allocators
+    JsonLineParser parser({"k0", "k4999"});
+    std::string line = "{";
+    for (int i = 0; i < 5000; ++i) {
+        if (i > 0) {
+            line.push_back(',');
+        }
+        line.append("\"k" + std::to_string(i) + "\":\"" + std::string(20, 'a' + i % 26) + "\"");
+    }
+    line.push_back('}');
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(std::vector<std::string>({std::string(20, 'a'), std::string(20, 'a' + 4999 % 26)}),
+                  parse(&parser, line));
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/line_chunk_splitter.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "runtime/stream_load/stream_load_pipe.h"
+
+namespace doris {
+
+class LineChunkSplitterTest : public testing::Test {
+public:
+    LineChunkSplitterTest() { }
+
+protected:
+    std::vector<std::string> split(const std::string& data, size_t chunk_size) {
+        StreamLoadPipe pipe;
+        pipe.append(data.data(), data.size());
+        pipe.finish();
+        LineChunkSplitter splitter(&pipe, '\n', chunk_size);
+        std::vector<std::string> chunks;
+        int64_t expected_seq = 0;
+        while (true) {
+            std::string chunk;
+            int64_t seq = -1;
+            auto st = splitter.next_chunk(&chunk, &seq);
+            EXPECT_TRUE(st.ok());
+            EXPECT_EQ(expected_seq++, seq);
+            if (!st.ok() || chunk.empty()) {
+                break;
+            }
+            chunks.push_back(chunk);
+        }
+        return chunks;
+    }
+
+    std::vector<std::string> read_lines(const std::string& chunk) {
+        ChunkLineReader reader(reinterpret_cast<const uint8_t*>(chunk.data()),
+                               chunk.size(), '\n');
+        std::vector<std::string> lines;
+        while (true) {
+            const uint8_t* ptr = nullptr;
+            size_t size = 0;
+            bool eof = false;
+            EXPECT_TRUE(reader.read_line(&ptr, &size, &eof).ok());
+            if (eof) {
+                break;
+            }
+            lines.emplace_back(reinterpret_cast<const char*>(ptr), size);
+        }
+        return lines;
+    }
+};
+
+TEST_F(LineChunkSplitterTest, split) {
+    ASSERT_EQ(std::vector<std::string>({"a,1\nb,2\n", "c,3\nd,4\n", "e"}),
+              split("a,1\nb,2\nc,3\nd,4\ne", 10));
+    ASSERT_EQ(std::vector<std::string>({"a,1\n"}), split("a,1\n", 10));
+    ASSERT_TRUE(split("", 10).empty());
+}
+
+TEST_F(LineChunkSplitterTest, long_line) {
+    // a line longer than a chunk is not cut
+    std::string line(100, 'x');
+    std::string next_line(20, 'y');
+    ASSERT_EQ(std::vector<std::string>({line + "\n", next_line + "\n"}),
+              split(line + "\n" + next_line + "\n", 8));
+}
+
+TEST_F(LineChunkSplitterTest, keep_all_lines) {
+    std::string data;
+    std::vector<std::string> lines;
+    for (int i = 0; i < 1000; ++i) {
+        lines.push_back(std::to_string(i) + ",value" + std::to_string(i * 7));
+        data.append(lines.back()).push_back('\n');
+    }
+    std::vector<std::string> result;
+    for (auto& chunk : split(data, 100)) {
+        ASSERT_EQ('\n', chunk.back());
+        for (auto& line : read_lines(chunk)) {
+            result.push_back(line);
+        }
+    }
+    ASSERT_EQ(lines, result);
+}
+
+TEST_F(LineChunkSplitterTest, read_lines) {
+    ASSERT_EQ(std::vector<std::string>({"a", "", "b"}), read_lines("a\n\nb"));
+    ASSERT_EQ(std::vector<std::string>({"a"}), read_lines("a\n"));
+    ASSERT_TRUE(read_lines("").empty());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
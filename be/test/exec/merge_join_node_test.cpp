@@ -0,0 +1,260 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define private public
+#define protected public
+#include "exec/merge_join_node.h"
+#include "runtime/descriptors.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const int BATCH_SIZE = 64;
+// the groups of a key span the batches of the right child
+static const int RIGHT_BATCH_SIZE = 7;
+
+// Inner joins a left tuple (k0, k1, v) and a right tuple (k0, k1, v) on their
+// keys, the rows of the children being sorted by their keys
+class MergeJoinNodeTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+
+        TDescriptorTableBuilder builder;
+        for (int i = 0; i < 2; ++i) {
+            TTupleDescriptorBuilder()
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+                .build(&builder);
+        }
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* left = _desc_tbl->get_tuple_descriptor(0);
+        const TupleDescriptor* right = _desc_tbl->get_tuple_descriptor(1);
+        _left_slots.assign(left->slots().begin(), left->slots().end());
+        _right_slots.assign(right->slots().begin(), right->slots().end());
+    }
+
+    void TearDown() override {
+        _test_env.reset();
+    }
+
+protected:
+    // The rows of a side of the join sorted by their keys, NULL first. A key has
+    // up to 'num_rows' / 'num_keys' rows, some keys and values are NULL.
+    static std::vector<TestRow> make_rows(int num_rows, int num_keys, int seed) {
+        std::vector<TestRow> rows;
+        for (int i = 0; i < num_rows; ++i) {
+            int64_t key = (i * 7L + seed) % num_keys;
+            int64_t k0 = (i % 11 == seed % 11) ? TEST_NULL : key / 3;
+            int64_t k1 = (i % 13 == seed % 13) ? TEST_NULL : key % 3;
+            int64_t value = (i % 5 == seed % 5) ? TEST_NULL : (i * 17L + seed) % 30 - 15;
+            rows.push_back({k0, k1, value});
+        }
+        std::sort(rows.begin(), rows.end(), [](const TestRow& lhs, const TestRow& rhs) {
+            return std::make_pair(lhs[0], lhs[1]) < std::make_pair(rhs[0], rhs[1]);
+        });
+        return rows;
+    }
+
+    // left.v + right.v > 0
+    TExpr positive_sum() const {
+        TExpr sum = make_test_arithmetic(TExprOpcode::ADD, TYPE_INT,
+                {make_test_slot_ref(_left_slots[2]), make_test_slot_ref(_right_slots[2])});
+        return make_test_binary_pred(TExprOpcode::GT, TYPE_INT, sum,
+                                     make_test_int_literal(TYPE_INT, 0));
+    }
+
+    // The rows the hash join on the keys returns, in the order of the left rows
+    // and then of the right rows. NULL keys join nothing and a comparison with
+    // NULL fails.
+    static std::vector<TestRow> expected_rows(const std::vector<TestRow>& left_rows,
+                                              const std::vector<TestRow>& right_rows,
+                                              bool has_positive_sum) {
+        std::vector<TestRow> rows;
+        for (const TestRow& left : left_rows) {
+            for (const TestRow& right : right_rows) {
+                if (left[0] == TEST_NULL || left[1] == TEST_NULL
+                        || left[0] != right[0] || left[1] != right[1]) {
+                    continue;
+                }
+                if (has_positive_sum && (left[2] == TEST_NULL || right[2] == TEST_NULL
+                        || left[2] + right[2] <= 0)) {
+                    continue;
+                }
+                rows.push_back({left[0], left[1], left[2], right[0], right[1], right[2]});
+            }
+        }
+        return rows;
+    }
+
+    // Runs the merge join with 'other_join_conjuncts' and 'conjuncts'
+    Status merge_join(const std::vector<TestRow>& left_rows,
+                      const std::vector<TestRow>& right_rows,
+                      const std::vector<TExpr>& other_join_conjuncts,
+                      const std::vector<TExpr>& conjuncts, int64_t limit,
+                      std::vector<TestRow>* rows) {
+        RuntimeState* state = nullptr;
+        RETURN_IF_ERROR(_test_env->create_query_state(++_query_id, -1, 8 * 1024 * 1024,
+                                                      &state));
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+        state->_query_options.batch_size = BATCH_SIZE;
+
+        TPlanNode tnode = make_test_plan_node(TPlanNodeType::MERGE_JOIN_NODE, 0, {0, 1},
+                                              {false, false});
+        tnode.num_children = 2;
+        tnode.limit = limit;
+        tnode.__isset.merge_join_node = true;
+        for (int i = 0; i < 2; ++i) {
+            TEqJoinCondition cond;
+            cond.left = make_test_slot_ref(_left_slots[i]);
+            cond.right = make_test_slot_ref(_right_slots[i]);
+            tnode.merge_join_node.cmp_conjuncts.push_back(cond);
+        }
+        tnode.merge_join_node.__set_other_join_conjuncts(other_join_conjuncts);
+        tnode.merge_join_node.__set_join_op(TJoinOp::INNER_JOIN);
+        if (!conjuncts.empty()) {
+            tnode.__set_conjuncts(conjuncts);
+        }
+
+        MergeJoinNode node(&_pool, tnode, *_desc_tbl);
+        node._children.push_back(_pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 1, {0}, {false}),
+                *_desc_tbl, left_rows, BATCH_SIZE)));
+        node._children.push_back(_pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 2, {1}, {false}),
+                *_desc_tbl, right_rows, RIGHT_BATCH_SIZE)));
+
+        RETURN_IF_ERROR(node.init(tnode, state));
+        Status status = node.prepare(state);
+        if (status.ok()) {
+            status = node.open(state);
+        }
+        if (status.ok()) {
+            std::vector<const SlotDescriptor*> slots = _left_slots;
+            slots.insert(slots.end(), _right_slots.begin(), _right_slots.end());
+            status = read_test_rows(state, &node, slots, rows);
+        }
+        node.close(state);
+        return status;
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    ObjectPool _pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::vector<const SlotDescriptor*> _left_slots;
+    std::vector<const SlotDescriptor*> _right_slots;
+    int64_t _query_id = 0;
+};
+
+TEST_F(MergeJoinNodeTest, key_groups) {
+    // the groups of the right keys span the output batches
+    for (int num_keys : {4, 30, 300}) {
+        SCOPED_TRACE(num_keys);
+        std::vector<TestRow> left_rows = make_rows(200, num_keys, 1);
+        std::vector<TestRow> right_rows = make_rows(150, num_keys, 2);
+        std::vector<TestRow> rows;
+        ASSERT_TRUE(merge_join(left_rows, right_rows, {}, {}, -1, &rows).ok());
+        std::vector<TestRow> expected = expected_rows(left_rows, right_rows, false);
+        EXPECT_FALSE(expected.empty());
+        EXPECT_EQ(expected, rows);
+    }
+}
+
+TEST_F(MergeJoinNodeTest, other_join_conjuncts) {
+    std::vector<TestRow> left_rows = make_rows(200, 30, 1);
+    std::vector<TestRow> right_rows = make_rows(150, 30, 2);
+    std::vector<TestRow> expected = expected_rows(left_rows, right_rows, true);
+    EXPECT_FALSE(expected.empty());
+    // evaluated as a conjunct of the join or of the node
+    std::vector<TestRow> join_rows;
+    ASSERT_TRUE(merge_join(left_rows, right_rows, {positive_sum()}, {}, -1, &join_rows).ok());
+    EXPECT_EQ(expected, join_rows);
+    std::vector<TestRow> node_rows;
+    ASSERT_TRUE(merge_join(left_rows, right_rows, {}, {positive_sum()}, -1, &node_rows).ok());
+    EXPECT_EQ(expected, node_rows);
+}
+
+TEST_F(MergeJoinNodeTest, null_keys) {
+    // the rows with NULL keys are skipped on both sides
+    std::vector<TestRow> null_rows = {{TEST_NULL, TEST_NULL, 1}, {TEST_NULL, 0, 2},
+                                      {TEST_NULL, 1, 3}, {0, TEST_NULL, 4}};
+    std::vector<TestRow> left_rows = null_rows;
+    left_rows.push_back({0, 1, 5});
+    left_rows.push_back({2, 0, 6});
+    std::vector<TestRow> right_rows = null_rows;
+    right_rows.push_back({0, 1, 7});
+    right_rows.push_back({0, 1, 8});
+    right_rows.push_back({1, 0, 9});
+    std::vector<TestRow> rows;
+    ASSERT_TRUE(merge_join(left_rows, right_rows, {}, {}, -1, &rows).ok());
+    EXPECT_EQ(std::vector<TestRow>({{0, 1, 5, 0, 1, 7}, {0, 1, 5, 0, 1, 8}}), rows);
+    EXPECT_EQ(expected_rows(left_rows, right_rows, false), rows);
+
+    rows.clear();
+    ASSERT_TRUE(merge_join(null_rows, null_rows, {}, {}, -1, &rows).ok());
+    EXPECT_TRUE(rows.empty());
+}
+
+TEST_F(MergeJoinNodeTest, empty_inputs) {
+    std::vector<TestRow> rows = make_rows(200, 30, 1);
+    std::vector<TestRow> empty_left;
+    ASSERT_TRUE(merge_join({}, rows, {}, {}, -1, &empty_left).ok());
+    EXPECT_TRUE(empty_left.empty());
+    std::vector<TestRow> empty_right;
+    ASSERT_TRUE(merge_join(rows, {}, {}, {}, -1, &empty_right).ok());
+    EXPECT_TRUE(empty_right.empty());
+}
+
+TEST_F(MergeJoinNodeTest, limit) {
+    // the first rows are returned
+    std::vector<TestRow> left_rows = make_rows(200, 4, 1);
+    std::vector<TestRow> right_rows = make_rows(150, 4, 2);
+    std::vector<TestRow> expected = expected_rows(left_rows, right_rows, false);
+    ASSERT_GT(expected.size(), 1000);
+    for (int64_t limit : {1L, 17L, 1000L}) {
+        SCOPED_TRACE(limit);
+        std::vector<TestRow> rows;
+        ASSERT_TRUE(merge_join(left_rows, right_rows, {}, {}, limit, &rows).ok());
+        EXPECT_EQ(std::vector<TestRow>(expected.begin(), expected.begin() + limit), rows);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+
+    return RUN_ALL_TESTS();
+}
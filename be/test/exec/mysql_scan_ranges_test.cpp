@@ -0,0 +1,87 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "exec/mysql_scan_node.h"
+
+namespace doris {
+
+typedef std::vector<std::vector<std::string>> RangeFilters;
+
+TEST(MysqlScanRangesTest, split) {
+    RangeFilters ranges;
+    MysqlScanNode::split_int_key_range("`id`", 1, 100, 4, {"v > 0"}, &ranges);
+    // the first and the last ranges are open
+    RangeFilters expected = {
+        {"v > 0", "`id` < 26"},
+        {"v > 0", "`id` >= 26", "`id` < 51"},
+        {"v > 0", "`id` >= 51", "`id` < 76"},
+        {"v > 0", "`id` >= 76"}};
+    ASSERT_EQ(expected, ranges);
+}
+
+TEST(MysqlScanRangesTest, uneven_split) {
+    // the bounds increase and the ranges cover every key once
+    RangeFilters ranges;
+    MysqlScanNode::split_int_key_range("k", -7, 1000, 7, {}, &ranges);
+    ASSERT_EQ(7, ranges.size());
+    ASSERT_EQ(std::vector<std::string>({"k < 137"}), ranges[0]);
+    for (int i = 1; i < ranges.size(); ++i) {
+        const std::vector<std::string>& prev = ranges[i - 1];
+        ASSERT_EQ("k >= " + prev.back().substr(4), ranges[i][0]);
+    }
+    ASSERT_EQ(1, ranges.back().size());
+}
+
+TEST(MysqlScanRangesTest, full_int64_range) {
+    // the width of the range does not fit into int64
+    RangeFilters ranges;
+    MysqlScanNode::split_int_key_range("k", std::numeric_limits<int64_t>::min(),
+                                       std::numeric_limits<int64_t>::max(), 4, {}, &ranges);
+    RangeFilters expected = {
+        {"k < -4611686018427387904"},
+        {"k >= -4611686018427387904", "k < 0"},
+        {"k >= 0", "k < 4611686018427387904"},
+        {"k >= 4611686018427387904"}};
+    ASSERT_EQ(expected, ranges);
+}
+
+TEST(MysqlScanRangesTest, not_splittable) {
+    // the scan falls back to a single query
+    RangeFilters ranges;
+    MysqlScanNode::split_int_key_range("k", 5, 5, 8, {}, &ranges);
+    ASSERT_TRUE(ranges.empty());
+    MysqlScanNode::split_int_key_range("k", 1, 100, 1, {}, &ranges);
+    ASSERT_TRUE(ranges.empty());
+
+    // no more ranges than keys
+    MysqlScanNode::split_int_key_range("k", 5, 6, 8, {}, &ranges);
+    ASSERT_EQ(RangeFilters({{"k < 6"}, {"k >= 6"}}), ranges);
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
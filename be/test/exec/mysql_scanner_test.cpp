@@ -105,6 +105,31 @@ TEST_F(MysqlScannerTest, query_failed) {
     ASSERT_FALSE(status.ok());
 }
 
+TEST_F(MysqlScannerTest, key_range_then_query) {
+    // the scan node queries on the connection of the probe if it can not split
+    // the table, the rows being streamed
+    _param.use_result = true;
+    std::vector<std::string> fields;
+    fields.push_back("*");
+    std::vector<std::vector<std::string>> filters_list = {{"id = 1"}, {"id < 0"}};
+    for (const std::vector<std::string>& filters : filters_list) {
+        MysqlScanner scanner(_param);
+        ASSERT_TRUE(scanner.open().ok());
+        std::string key;
+        int64_t min_value = 0;
+        int64_t max_value = 0;
+        ASSERT_TRUE(scanner.get_int_key_range(
+                "dim_lbs_device", filters, &key, &min_value, &max_value).ok());
+        ASSERT_TRUE(scanner.query("dim_lbs_device", fields, filters).ok());
+        bool eos = false;
+        char** buf;
+        unsigned long* length;
+        while (!eos) {
+            ASSERT_TRUE(scanner.get_next_row(&buf, &length, &eos).ok());
+        }
+    }
+}
+
 TEST_F(MysqlScannerTest, open_failed) {
     MysqlScannerParam invalid_param;
     MysqlScanner scanner(invalid_param);
@@ -0,0 +1,400 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define private public
+#define protected public
+#include "exec/new_partitioned_aggregation_node.h"
+#include "common/config.h"
+#include "exprs/aggregate_functions.h"
+#include "runtime/descriptors.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/filesystem_util.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const std::string TMP_DIR = "/tmp/new-partitioned-aggregation-node-test";
+static const int BATCH_SIZE = 64;
+// small enough for the partitions to need many buffers for their rows
+static const int BUFFER_SIZE = 8 * 1024;
+// a buffer per partition, one for the serialize stream and one to read a spilled
+// partition, as the planner reserves them
+static const int64_t MIN_RESERVATION =
+    (NewPartitionedAggregationNode::PARTITION_FANOUT + 2) * BUFFER_SIZE;
+// enough for the hash tables of the partitions but not for all their rows
+static const int64_t SPILL_RESERVATION = MIN_RESERVATION + 48 * BUFFER_SIZE;
+static const int64_t NO_RESERVATION_LIMIT = std::numeric_limits<int64_t>::max();
+
+// The symbols of the built-in aggregate functions, as FunctionSet of the FE has
+// them. The evaluators look them up in the test binary.
+static const std::string PREFIX = "_ZN5doris18AggregateFunctions";
+static const std::string INIT_NULL =
+    PREFIX + "9init_nullEPN9doris_udf15FunctionContextEPNS1_6AnyValE";
+static const std::string INIT_ZERO =
+    PREFIX + "9init_zeroIN9doris_udf9BigIntValEEEvPNS2_15FunctionContextEPT_";
+static const std::string COUNT_STAR_UPDATE =
+    PREFIX + "17count_star_updateEPN9doris_udf15FunctionContextEPNS1_9BigIntValE";
+static const std::string COUNT_UPDATE =
+    PREFIX + "12count_updateEPN9doris_udf15FunctionContextERKNS1_6AnyValEPNS1_9BigIntValE";
+static const std::string COUNT_MERGE =
+    PREFIX + "11count_mergeEPN9doris_udf15FunctionContextERKNS1_9BigIntValEPS4_";
+static const std::string SUM_BIGINT =
+    PREFIX + "3sumIN9doris_udf9BigIntValES3_EEvPNS2_15FunctionContextERKT_PT0_";
+static const std::string SUM_DOUBLE =
+    PREFIX + "3sumIN9doris_udf9DoubleValES3_EEvPNS2_15FunctionContextERKT_PT0_";
+static const std::string AVG_INIT =
+    PREFIX + "8avg_initEPN9doris_udf15FunctionContextEPNS1_9StringValE";
+static const std::string AVG_UPDATE_BIGINT = PREFIX
+    + "10avg_updateIN9doris_udf9BigIntValEEEvPNS2_15FunctionContextERKT_PNS2_9StringValE";
+static const std::string AVG_UPDATE_DOUBLE = PREFIX
+    + "10avg_updateIN9doris_udf9DoubleValEEEvPNS2_15FunctionContextERKT_PNS2_9StringValE";
+static const std::string AVG_MERGE =
+    PREFIX + "9avg_mergeEPN9doris_udf15FunctionContextERKNS1_9StringValEPS4_";
+static const std::string AVG_SERIALIZE = PREFIX
+    + "32string_val_serialize_or_finalizeEPN9doris_udf15FunctionContextERKNS1_9StringValE";
+static const std::string AVG_GET_VALUE =
+    PREFIX + "13avg_get_valueEPN9doris_udf15FunctionContextERKNS1_9StringValE";
+static const std::string AVG_FINALIZE =
+    PREFIX + "12avg_finalizeEPN9doris_udf15FunctionContextERKNS1_9StringValE";
+static const std::string MIN_FLOAT =
+    PREFIX + "3minIN9doris_udf8FloatValEEEvPNS2_15FunctionContextERKT_PS6_";
+static const std::string MAX_FLOAT =
+    PREFIX + "3maxIN9doris_udf8FloatValEEEvPNS2_15FunctionContextERKT_PS6_";
+static const std::string MIN_DOUBLE =
+    PREFIX + "3minIN9doris_udf9DoubleValEEEvPNS2_15FunctionContextERKT_PS6_";
+static const std::string MAX_DOUBLE =
+    PREFIX + "3maxIN9doris_udf9DoubleValEEEvPNS2_15FunctionContextERKT_PS6_";
+
+// A built-in aggregate function of input slot 'input_slot', -1 for count(*). An
+// empty symbol is a step the function does not have.
+struct TestAggFn {
+    std::string name;
+    int input_slot;
+    PrimitiveType intermediate_type;
+    PrimitiveType ret_type;
+    std::string init;
+    std::string update;
+    std::string merge;
+    std::string serialize;
+    std::string get_value;
+    std::string finalize;
+};
+
+// count(*), count(b), sum(b), avg(b), sum(d), avg(d), min(f), max(f), min(d), max(d)
+// of the (k INT, b BIGINT, f FLOAT, d DOUBLE) rows
+static const std::vector<TestAggFn> AGG_FNS = {
+    {"count", -1, TYPE_BIGINT, TYPE_BIGINT, INIT_ZERO, COUNT_STAR_UPDATE, COUNT_MERGE,
+     "", "", ""},
+    {"count", 1, TYPE_BIGINT, TYPE_BIGINT, INIT_ZERO, COUNT_UPDATE, COUNT_MERGE, "", "", ""},
+    {"sum", 1, TYPE_BIGINT, TYPE_BIGINT, INIT_NULL, SUM_BIGINT, SUM_BIGINT, "", "", ""},
+    {"avg", 1, TYPE_VARCHAR, TYPE_DOUBLE, AVG_INIT, AVG_UPDATE_BIGINT, AVG_MERGE,
+     AVG_SERIALIZE, AVG_GET_VALUE, AVG_FINALIZE},
+    {"sum", 3, TYPE_DOUBLE, TYPE_DOUBLE, INIT_NULL, SUM_DOUBLE, SUM_DOUBLE, "", "", ""},
+    {"avg", 3, TYPE_VARCHAR, TYPE_DOUBLE, AVG_INIT, AVG_UPDATE_DOUBLE, AVG_MERGE,
+     AVG_SERIALIZE, AVG_GET_VALUE, AVG_FINALIZE},
+    // min() and max() merge with their update functions
+    {"min", 2, TYPE_FLOAT, TYPE_FLOAT, INIT_NULL, MIN_FLOAT, MIN_FLOAT, "", "", ""},
+    {"max", 2, TYPE_FLOAT, TYPE_FLOAT, INIT_NULL, MAX_FLOAT, MAX_FLOAT, "", "", ""},
+    {"min", 3, TYPE_DOUBLE, TYPE_DOUBLE, INIT_NULL, MIN_DOUBLE, MIN_DOUBLE, "", "", ""},
+    {"max", 3, TYPE_DOUBLE, TYPE_DOUBLE, INIT_NULL, MAX_DOUBLE, MAX_DOUBLE, "", "", ""},
+};
+
+// the value of a FLOAT or DOUBLE slot read by read_test_rows()
+static int64_t double_bits(double value) {
+    int64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+struct AggregationResult {
+    std::vector<TestRow> rows;
+    // whether AggUpdateKernels updated the intermediate values
+    bool vectorized = false;
+    int64_t num_spilled_partitions = 0;
+};
+
+// Aggregates (k, b, f, d) rows with AGG_FNS, grouped by k or not. The aggregation
+// updating the intermediate values of many rows at a time returns the rows of the
+// one updating them a row at a time.
+class NewPartitionedAggregationNodeTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+        ASSERT_TRUE(FileSystemUtil::create_directory(TMP_DIR).ok());
+        _test_env->init_tmp_file_mgr({TMP_DIR}, false);
+        _vectorized = config::enable_vectorized_aggregation;
+
+        TDescriptorTableBuilder builder;
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_BIGINT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_FLOAT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_DOUBLE).nullable(true).build())
+            .build(&builder);
+        // tuples 1 and 2 are the intermediate and the output tuples with grouping,
+        // tuples 3 and 4 the ones without it
+        for (bool grouped : {true, false}) {
+            for (bool intermediate : {true, false}) {
+                TTupleDescriptorBuilder tuple_builder;
+                if (grouped) {
+                    tuple_builder.add_slot(
+                            TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build());
+                }
+                for (const TestAggFn& fn : AGG_FNS) {
+                    TSlotDescriptorBuilder slot_builder;
+                    if (!intermediate) {
+                        slot_builder.type(fn.ret_type);
+                    } else if (fn.intermediate_type == TYPE_VARCHAR) {
+                        slot_builder.string_type(sizeof(AvgState));
+                    } else {
+                        slot_builder.type(fn.intermediate_type);
+                    }
+                    tuple_builder.add_slot(slot_builder.nullable(true).build());
+                }
+                tuple_builder.build(&builder);
+            }
+        }
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* input = _desc_tbl->get_tuple_descriptor(0);
+        _input_slots.assign(input->slots().begin(), input->slots().end());
+        for (TTupleId id : {2, 4}) {
+            const TupleDescriptor* output = _desc_tbl->get_tuple_descriptor(id);
+            _output_slots.emplace_back(output->slots().begin(), output->slots().end());
+        }
+    }
+
+    void TearDown() override {
+        config::enable_vectorized_aggregation = _vectorized;
+        _test_env.reset();
+        FileSystemUtil::remove_paths({TMP_DIR});
+    }
+
+protected:
+    // Rows of about 'num_groups' groups, the NULL key being a group as well. Some
+    // values are NULL, all the values of some groups are, and all the values of
+    // some groups are negative. The FLOAT and DOUBLE values are whole numbers, so
+    // their sums do not depend on the order of the rows.
+    static std::vector<TestRow> make_rows(int num_rows, int num_groups) {
+        std::vector<TestRow> rows;
+        for (int i = 0; i < num_rows; ++i) {
+            int64_t key = (i % 17 == 0) ? TEST_NULL : (i * 7919L) % num_groups;
+            bool null_value = i % 5 == 0 || (key != TEST_NULL && key % 11 == 3);
+            int64_t value = (key != TEST_NULL && key % 7 == 2) ? -1 - i % 1000
+                                                                : i % 1000 - 500;
+            rows.push_back({key, null_value ? TEST_NULL : value,
+                            null_value || i % 3 == 0 ? TEST_NULL : value * 3,
+                            null_value ? TEST_NULL : value * 7 + i % 2});
+        }
+        return rows;
+    }
+
+    TExpr make_agg_fn(const TestAggFn& fn) const {
+        TExprNode node = make_test_expr_node(TExprNodeType::AGG_EXPR, fn.ret_type);
+        node.__isset.fn = true;
+        node.fn.name.function_name = fn.name;
+        node.fn.binary_type = TFunctionBinaryType::BUILTIN;
+        std::vector<TExpr> children;
+        if (fn.input_slot != -1) {
+            const SlotDescriptor* input = _input_slots[fn.input_slot];
+            node.fn.arg_types.push_back(input->type().to_thrift());
+            children.push_back(make_test_slot_ref(input));
+        }
+        node.fn.ret_type = node.type;
+        node.fn.has_var_args = false;
+        node.fn.__isset.aggregate_fn = true;
+        node.fn.aggregate_fn.intermediate_type = fn.intermediate_type == TYPE_VARCHAR
+            ? TypeDescriptor::create_varchar_type(sizeof(AvgState)).to_thrift()
+            : TypeDescriptor(fn.intermediate_type).to_thrift();
+        node.fn.aggregate_fn.__set_init_fn_symbol(fn.init);
+        node.fn.aggregate_fn.__set_update_fn_symbol(fn.update);
+        node.fn.aggregate_fn.__set_merge_fn_symbol(fn.merge);
+        if (!fn.serialize.empty()) {
+            node.fn.aggregate_fn.__set_serialize_fn_symbol(fn.serialize);
+            node.fn.aggregate_fn.__set_get_value_fn_symbol(fn.get_value);
+            node.fn.aggregate_fn.__set_finalize_fn_symbol(fn.finalize);
+        }
+        node.__isset.agg_expr = true;
+        node.agg_expr.is_merge_agg = false;
+        return make_test_expr(node, children);
+    }
+
+    // Aggregates 'rows' with a reservation of at most 'max_reservation' bytes,
+    // returns the sorted rows
+    Status aggregate(const std::vector<TestRow>& rows, bool grouped, bool vectorized,
+                     int64_t max_reservation, AggregationResult* result) {
+        *result = AggregationResult();
+        config::enable_vectorized_aggregation = vectorized;
+        RuntimeState* state = nullptr;
+        RETURN_IF_ERROR(_test_env->create_query_state(++_query_id, -1, BUFFER_SIZE, &state));
+        // the initial reservation the node claims from
+        state->_query_options.__set_min_reservation(MIN_RESERVATION);
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+        state->_query_options.batch_size = BATCH_SIZE;
+
+        TTupleId output_tuple_id = grouped ? 2 : 4;
+        TPlanNode tnode = make_test_plan_node(TPlanNodeType::AGGREGATION_NODE, 0,
+                                              {output_tuple_id}, {false});
+        tnode.num_children = 1;
+        tnode.resource_profile.min_reservation = MIN_RESERVATION;
+        tnode.resource_profile.max_reservation = max_reservation;
+        tnode.resource_profile.__set_spillable_buffer_size(BUFFER_SIZE);
+        tnode.resource_profile.__set_max_row_buffer_size(BUFFER_SIZE);
+        tnode.__isset.agg_node = true;
+        if (grouped) {
+            tnode.agg_node.__set_grouping_exprs({make_test_slot_ref(_input_slots[0])});
+        }
+        for (const TestAggFn& fn : AGG_FNS) {
+            tnode.agg_node.aggregate_functions.push_back(make_agg_fn(fn));
+        }
+        tnode.agg_node.intermediate_tuple_id = output_tuple_id - 1;
+        tnode.agg_node.output_tuple_id = output_tuple_id;
+        tnode.agg_node.need_finalize = true;
+
+        NewPartitionedAggregationNode node(&_pool, tnode, *_desc_tbl);
+        node._children.push_back(_pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 1, {0}, {false}),
+                *_desc_tbl, rows, BATCH_SIZE)));
+
+        RETURN_IF_ERROR(node.init(tnode, state));
+        Status status = node.prepare(state);
+        if (status.ok()) {
+            status = node.open(state);
+        }
+        if (status.ok()) {
+            status = read_test_rows(state, &node, _output_slots[grouped ? 0 : 1],
+                                    &result->rows);
+        }
+        result->vectorized = !node.agg_update_kernels_.empty();
+        result->num_spilled_partitions = node.num_spilled_partitions_->value();
+        node.close(state);
+        RETURN_IF_ERROR(status);
+        result->rows = sorted_test_rows(result->rows);
+        return Status::OK;
+    }
+
+    // Checks the vectorized aggregation against the one a row at a time, both with
+    // a reservation of at most 'max_reservation' bytes
+    void check_aggregate(const std::vector<TestRow>& rows, bool grouped,
+                         int64_t max_reservation, AggregationResult* vectorized) {
+        AggregationResult row_at_a_time;
+        ASSERT_TRUE(aggregate(rows, grouped, false, max_reservation, &row_at_a_time).ok());
+        EXPECT_FALSE(row_at_a_time.vectorized);
+        ASSERT_TRUE(aggregate(rows, grouped, true, max_reservation, vectorized).ok());
+        EXPECT_TRUE(vectorized->vectorized);
+        EXPECT_EQ(row_at_a_time.rows, vectorized->rows);
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    ObjectPool _pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::vector<const SlotDescriptor*> _input_slots;
+    // the output slots with grouping and without it
+    std::vector<std::vector<const SlotDescriptor*>> _output_slots;
+    int64_t _query_id = 0;
+    bool _vectorized = true;
+};
+
+TEST_F(NewPartitionedAggregationNodeTest, null_values) {
+    std::vector<TestRow> rows = make_rows(5000, 500);
+    for (bool grouped : {true, false}) {
+        AggregationResult result;
+        check_aggregate(rows, grouped, NO_RESERVATION_LIMIT, &result);
+        EXPECT_EQ(grouped ? 501 : 1, result.rows.size());
+        EXPECT_EQ(0, result.num_spilled_partitions);
+    }
+}
+
+TEST_F(NewPartitionedAggregationNodeTest, all_null_values) {
+    // count(*) counts the rows, the other functions see no value
+    std::vector<TestRow> rows(1000, {TEST_NULL, TEST_NULL, TEST_NULL, TEST_NULL});
+    TestRow expected = {1000, 0};
+    expected.resize(AGG_FNS.size(), TEST_NULL);
+    AggregationResult result;
+    check_aggregate(rows, false, NO_RESERVATION_LIMIT, &result);
+    EXPECT_EQ(std::vector<TestRow>({expected}), result.rows);
+    check_aggregate(rows, true, NO_RESERVATION_LIMIT, &result);
+    expected.insert(expected.begin(), TEST_NULL);
+    EXPECT_EQ(std::vector<TestRow>({expected}), result.rows);
+}
+
+TEST_F(NewPartitionedAggregationNodeTest, min_max_of_negative_values) {
+    // the initial value of floating point max() is not below all the values
+    std::vector<TestRow> rows;
+    for (int i = 1; i <= 1000; ++i) {
+        rows.push_back({i % 3, -i, -i, -i * 1000L});
+    }
+    AggregationResult result;
+    check_aggregate(rows, false, NO_RESERVATION_LIMIT, &result);
+    ASSERT_EQ(1, result.rows.size());
+    const TestRow& row = result.rows[0];
+    EXPECT_EQ(double_bits(-1000.0), row[6]);
+    EXPECT_EQ(double_bits(-1.0), row[7]);
+    EXPECT_EQ(double_bits(-1000000.0), row[8]);
+    EXPECT_EQ(double_bits(-1000.0), row[9]);
+    check_aggregate(rows, true, NO_RESERVATION_LIMIT, &result);
+    EXPECT_EQ(3, result.rows.size());
+}
+
+TEST_F(NewPartitionedAggregationNodeTest, spill_in_group) {
+    // the partitions spill while the updates of the rows of a batch are pending, and
+    // the rows of the spilled ones are aggregated again
+    std::vector<TestRow> rows = make_rows(20000, 6000);
+    AggregationResult result;
+    check_aggregate(rows, true, SPILL_RESERVATION, &result);
+    EXPECT_GT(result.num_spilled_partitions, 0);
+    AggregationResult in_memory;
+    ASSERT_TRUE(aggregate(rows, true, false, NO_RESERVATION_LIMIT, &in_memory).ok());
+    EXPECT_EQ(0, in_memory.num_spilled_partitions);
+    EXPECT_EQ(in_memory.rows, result.rows);
+}
+
+TEST_F(NewPartitionedAggregationNodeTest, empty_input) {
+    AggregationResult result;
+    check_aggregate({}, true, NO_RESERVATION_LIMIT, &result);
+    EXPECT_TRUE(result.rows.empty());
+    check_aggregate({}, false, NO_RESERVATION_LIMIT, &result);
+    TestRow expected = {0, 0};
+    expected.resize(AGG_FNS.size(), TEST_NULL);
+    EXPECT_EQ(std::vector<TestRow>({expected}), result.rows);
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+
+    return RUN_ALL_TESTS();
+}
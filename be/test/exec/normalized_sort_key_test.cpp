@@ -0,0 +1,123 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/normalized_sort_key.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "runtime/datetime_value.h"
+#include "runtime/string_value.h"
+
+namespace doris {
+
+class NormalizedSortKeyTest : public testing::Test {
+public:
+    NormalizedSortKeyTest() { }
+
+protected:
+    std::string key(const void* value, PrimitiveType type, bool is_asc = true,
+                    bool nulls_first = true) {
+        std::string key(NormalizedSortKey::value_size(type), '\0');
+        NormalizedSortKey::encode_value(value, type, is_asc, nulls_first,
+                                        reinterpret_cast<uint8_t*>(&key[0]));
+        return key;
+    }
+
+    // true if the keys of 'values' are ascending
+    template<typename T>
+    void check_ascending(const std::vector<T>& values, PrimitiveType type) {
+        for (int i = 1; i < values.size(); ++i) {
+            ASSERT_LT(key(&values[i - 1], type), key(&values[i], type)) << i;
+            // reversed if descending
+            ASSERT_GT(key(&values[i - 1], type, false), key(&values[i], type, false)) << i;
+        }
+    }
+};
+
+TEST_F(NormalizedSortKeyTest, integers) {
+    check_ascending<int8_t>({-128, -1, 0, 1, 127}, TYPE_TINYINT);
+    check_ascending<int16_t>({-32768, -256, -1, 0, 255, 256, 32767}, TYPE_SMALLINT);
+    check_ascending<int32_t>({INT32_MIN, -65536, -1, 0, 1, 65536, INT32_MAX}, TYPE_INT);
+    check_ascending<int64_t>({INT64_MIN, -1, 0, 1LL << 40, INT64_MAX}, TYPE_BIGINT);
+    __int128 big = static_cast<__int128>(1) << 100;
+    check_ascending<__int128>({-big, -1, 0, 1, big}, TYPE_LARGEINT);
+
+    int32_t v = 5;
+    ASSERT_EQ(key(&v, TYPE_INT), key(&v, TYPE_INT));
+}
+
+TEST_F(NormalizedSortKeyTest, floats) {
+    check_ascending<double>({-1e300, -1.5, -1e-300, 0, 1e-300, 2.5, 1e300}, TYPE_DOUBLE);
+    check_ascending<float>({-1e30f, -0.5f, 0, 0.25f, 1e30f}, TYPE_FLOAT);
+
+    double zero = 0;
+    double negative_zero = -0.0;
+    ASSERT_EQ(key(&zero, TYPE_DOUBLE), key(&negative_zero, TYPE_DOUBLE));
+}
+
+TEST_F(NormalizedSortKeyTest, datetimes) {
+    std::vector<DateTimeValue> values(4);
+    std::vector<std::string> strs = {"1999-12-31 23:59:59", "2000-01-01 00:00:00",
+        "2000-01-01 00:00:01", "2000-02-01 00:00:00"};
+    for (int i = 0; i < strs.size(); ++i) {
+        ASSERT_TRUE(values[i].from_date_str(strs[i].data(), strs[i].size()));
+    }
+    check_ascending(values, TYPE_DATETIME);
+}
+
+TEST_F(NormalizedSortKeyTest, string_prefixes) {
+    auto prefix = [](const std::string& str, bool is_asc) {
+        StringValue value(const_cast<char*>(str.data()), str.size());
+        std::string key(9, '\0');
+        EXPECT_TRUE(NormalizedSortKey::encode_string_prefix(
+                &value, is_asc, true, key.size(), reinterpret_cast<uint8_t*>(&key[0])));
+        return key;
+    };
+    std::vector<std::string> strs = {"", "a", "ab", "abc", "b", "ba"};
+    for (int i = 1; i < strs.size(); ++i) {
+        ASSERT_LT(prefix(strs[i - 1], true), prefix(strs[i], true)) << i;
+        ASSERT_GT(prefix(strs[i - 1], false), prefix(strs[i], false)) << i;
+    }
+    // only the first 8 bytes are in the key
+    ASSERT_EQ(prefix("abcdefgh1", true), prefix("abcdefgh2", true));
+
+    std::string str("a\0b", 3);
+    StringValue value(const_cast<char*>(str.data()), str.size());
+    uint8_t key[9];
+    ASSERT_FALSE(NormalizedSortKey::encode_string_prefix(&value, true, true, 9, key));
+    ASSERT_TRUE(NormalizedSortKey::encode_string_prefix(nullptr, true, true, 9, key));
+    ASSERT_EQ(0, key[0]);
+}
+
+TEST_F(NormalizedSortKeyTest, nulls) {
+    int64_t v = INT64_MIN;
+    ASSERT_LT(key(nullptr, TYPE_BIGINT), key(&v, TYPE_BIGINT));
+    ASSERT_LT(key(nullptr, TYPE_BIGINT, false), key(&v, TYPE_BIGINT, false));
+    v = INT64_MAX;
+    ASSERT_GT(key(nullptr, TYPE_BIGINT, true, false), key(&v, TYPE_BIGINT, true, false));
+    ASSERT_GT(key(nullptr, TYPE_BIGINT, false, false), key(&v, TYPE_BIGINT, false, false));
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -23,6 +23,7 @@
 #include "runtime/mem_tracker.h"
 #include "runtime/row_batch.h"
 #include "runtime/tuple_row.h"
+#include "util/bitmap.h"
 
 namespace doris {
 
@@ -221,6 +222,42 @@ TEST_F(OlapTablePartitionParamTest, normal) {
         ASSERT_TRUE(found);
         ASSERT_EQ(12, partition->id);
     }
+
+    // c2 of the rows: 9, 9, 25, 50, 60, 9, the last one filtered
+    std::vector<int64_t> part_values = {9, 9, 25, 50, 60, 9};
+    for (int i = 0; i < part_values.size(); ++i) {
+        Tuple* tuple = (Tuple*)batch.tuple_data_pool()->allocate(tuple_desc->byte_size());
+        memset(tuple, 0, tuple_desc->byte_size());
+        *reinterpret_cast<int*>(tuple->get_slot(4)) = 20 + i;
+        *reinterpret_cast<int64_t*>(tuple->get_slot(8)) = part_values[i];
+        StringValue* str_val = reinterpret_cast<StringValue*>(tuple->get_slot(16));
+        str_val->ptr = reinterpret_cast<char*>(batch.tuple_data_pool()->allocate(10));
+        str_val->len = 1 + i;
+        memcpy(str_val->ptr, "abcdef", str_val->len);
+
+        int row_no = batch.add_row();
+        batch.get_row(row_no)->set_tuple(0, tuple);
+        batch.commit_last_row();
+    }
+    Bitmap filter(batch.num_rows());
+    filter.Set(5, true);
+    std::vector<const OlapTablePartition*> partitions;
+    std::vector<uint32_t> dist_hashes;
+    part.find_tablets(&batch, &filter, &partitions, &dist_hashes);
+    ASSERT_EQ(6, partitions.size());
+    ASSERT_EQ(6, dist_hashes.size());
+    std::vector<int64_t> partition_ids = {10, 10, 11, -1, 12, -1};
+    for (int i = 0; i < batch.num_rows(); ++i) {
+        if (partition_ids[i] < 0) {
+            ASSERT_TRUE(partitions[i] == nullptr);
+            continue;
+        }
+        ASSERT_EQ(partition_ids[i], partitions[i]->id);
+        uint32_t dist_hash = 0;
+        const OlapTablePartition* partition = nullptr;
+        ASSERT_TRUE(part.find_tablet(batch.get_row(i)->get_tuple(0), &partition, &dist_hash));
+        ASSERT_EQ(dist_hash, dist_hashes[i]);
+    }
 }
 
 TEST_F(OlapTablePartitionParamTest, to_protobuf) {
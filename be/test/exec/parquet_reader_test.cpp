@@ -0,0 +1,185 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/parquet_reader.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+
+#include "common/object_pool.h"
+#include "exec/local_file_reader.h"
+#include "runtime/descriptors.h"
+#include "util/descriptor_helper.h"
+
+namespace doris {
+
+class ParquetReaderTest : public testing::Test {
+public:
+    ParquetReaderTest() : _path("./parquet_reader_test.parquet") { }
+
+protected:
+    virtual void SetUp() {
+        TDescriptorTableBuilder dtb;
+        TTupleDescriptorBuilder tuple_builder;
+        for (auto name : {"id", "NAME", "price", "dt", "missing"}) {
+            tuple_builder.add_slot(
+                TSlotDescriptorBuilder().string_type(64).column_name(name).build());
+        }
+        tuple_builder.build(&dtb);
+        ASSERT_TRUE(DescriptorTbl::create(&_obj_pool, dtb.desc_tbl(), &_desc_tbl).ok());
+        _slots = _desc_tbl->get_tuple_descriptor(0)->slots();
+        write_file();
+    }
+
+    virtual void TearDown() {
+        remove(_path.c_str());
+    }
+
+    // 5 rows in row groups of 3 rows
+    void write_file() {
+        arrow::Int64Builder id_builder;
+        arrow::StringBuilder name_builder;
+        arrow::DoubleBuilder price_builder;
+        arrow::Date32Builder dt_builder;
+        const char* names[] = {"a", "bb", nullptr, "dddd", ""};
+        int32_t days[] = {0, -1, 17897, 17898, 17899};
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(id_builder.Append(i + 1).ok());
+            if (names[i] == nullptr) {
+                ASSERT_TRUE(name_builder.AppendNull().ok());
+            } else {
+                ASSERT_TRUE(name_builder.Append(names[i]).ok());
+            }
+            ASSERT_TRUE(price_builder.Append(i + 0.5).ok());
+            ASSERT_TRUE(dt_builder.Append(days[i]).ok());
+        }
+        std::vector<std::shared_ptr<arrow::Array>> arrays(4);
+        ASSERT_TRUE(id_builder.Finish(&arrays[0]).ok());
+        ASSERT_TRUE(name_builder.Finish(&arrays[1]).ok());
+        ASSERT_TRUE(price_builder.Finish(&arrays[2]).ok());
+        ASSERT_TRUE(dt_builder.Finish(&arrays[3]).ok());
+        auto schema = arrow::schema({
+            arrow::field("id", arrow::int64()),
+            arrow::field("name", arrow::utf8()),
+            arrow::field("price", arrow::float64()),
+            arrow::field("dt", arrow::date32())});
+        auto table = arrow::Table::Make(schema, arrays);
+
+        std::shared_ptr<arrow::io::FileOutputStream> out;
+        ASSERT_TRUE(arrow::io::FileOutputStream::Open(_path, &out).ok());
+        ASSERT_TRUE(parquet::arrow::WriteTable(
+                *table, arrow::default_memory_pool(), out, 3).ok());
+        ASSERT_TRUE(out->Close().ok());
+    }
+
+    std::unique_ptr<ParquetReaderWrap> open_reader(int64_t start_offset) {
+        LocalFileReader* file = new LocalFileReader(_path, 0);
+        std::unique_ptr<ParquetReaderWrap> reader(new ParquetReaderWrap(file));
+        EXPECT_TRUE(file->open().ok());
+        EXPECT_TRUE(reader->init(_slots, start_offset, -1).ok());
+        return reader;
+    }
+
+    std::string value(ParquetReaderWrap* reader, int slot_idx, int row) {
+        const ParquetColumnValues& column = reader->column(slot_idx);
+        if (column.is_null[row]) {
+            return "NULL";
+        }
+        return column.values[row].to_string();
+    }
+
+    std::string _path;
+    ObjectPool _obj_pool;
+    DescriptorTbl* _desc_tbl;
+    std::vector<SlotDescriptor*> _slots;
+};
+
+TEST_F(ParquetReaderTest, read) {
+    auto reader = open_reader(0);
+    int num_rows = 0;
+    bool eof = false;
+    ASSERT_TRUE(reader->next_rows(2, &num_rows, &eof).ok());
+    ASSERT_FALSE(eof);
+    ASSERT_EQ(2, num_rows);
+    ASSERT_EQ("1", value(reader.get(), 0, 0));
+    ASSERT_EQ("a", value(reader.get(), 1, 0));
+    ASSERT_EQ("0.5", value(reader.get(), 2, 0));
+    ASSERT_EQ("1970-01-01", value(reader.get(), 3, 0));
+    ASSERT_EQ("NULL", value(reader.get(), 4, 0));
+    ASSERT_EQ("2", value(reader.get(), 0, 1));
+    ASSERT_EQ("1969-12-31", value(reader.get(), 3, 1));
+
+    // rows are not read across row groups
+    ASSERT_TRUE(reader->next_rows(10, &num_rows, &eof).ok());
+    ASSERT_EQ(1, num_rows);
+    ASSERT_EQ("NULL", value(reader.get(), 1, 0));
+    ASSERT_EQ("2019-01-01", value(reader.get(), 3, 0));
+
+    ASSERT_TRUE(reader->next_rows(10, &num_rows, &eof).ok());
+    ASSERT_EQ(2, num_rows);
+    ASSERT_EQ("4", value(reader.get(), 0, 0));
+    ASSERT_EQ("dddd", value(reader.get(), 1, 0));
+    ASSERT_EQ("", value(reader.get(), 1, 1));
+    ASSERT_EQ("4.5", value(reader.get(), 2, 1));
+
+    ASSERT_TRUE(reader->next_rows(10, &num_rows, &eof).ok());
+    ASSERT_TRUE(eof);
+    ASSERT_EQ(0, num_rows);
+}
+
+TEST_F(ParquetReaderTest, range) {
+    // no row group starts after the footer
+    FILE* fp = fopen(_path.c_str(), "r");
+    fseek(fp, 0, SEEK_END);
+    int64_t file_size = ftell(fp);
+    fclose(fp);
+
+    auto reader = open_reader(file_size);
+    int num_rows = 0;
+    bool eof = false;
+    ASSERT_TRUE(reader->next_rows(10, &num_rows, &eof).ok());
+    ASSERT_TRUE(eof);
+}
+
+TEST_F(ParquetReaderTest, not_nullable_missing_column) {
+    TDescriptorTableBuilder dtb;
+    TTupleDescriptorBuilder tuple_builder;
+    tuple_builder.add_slot(TSlotDescriptorBuilder().string_type(64)
+                           .nullable(false).column_name("missing").build());
+    tuple_builder.build(&dtb);
+    DescriptorTbl* desc_tbl = nullptr;
+    ASSERT_TRUE(DescriptorTbl::create(&_obj_pool, dtb.desc_tbl(), &desc_tbl).ok());
+
+    LocalFileReader* file = new LocalFileReader(_path, 0);
+    ParquetReaderWrap reader(file);
+    ASSERT_TRUE(file->open().ok());
+    ASSERT_FALSE(reader.init(desc_tbl->get_tuple_descriptor(0)->slots(), 0, -1).ok());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
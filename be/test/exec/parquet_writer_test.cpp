@@ -0,0 +1,133 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/parquet_writer.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exec/local_file_reader.h"
+#include "exec/local_file_writer.h"
+#include "exec/parquet_reader.h"
+#include "runtime/descriptors.h"
+#include "util/descriptor_helper.h"
+
+namespace doris {
+
+class ParquetWriterTest : public testing::Test {
+public:
+    ParquetWriterTest() : _path("./parquet_writer_test.parquet") { }
+
+protected:
+    virtual void SetUp() {
+        _schema = arrow::schema({
+            arrow::field("id", arrow::int64()),
+            arrow::field("name", arrow::utf8())});
+    }
+
+    virtual void TearDown() {
+        remove(_path.c_str());
+    }
+
+    std::shared_ptr<arrow::Table> make_table(int64_t first_id, int num_rows) {
+        arrow::Int64Builder id_builder;
+        arrow::StringBuilder name_builder;
+        for (int i = 0; i < num_rows; ++i) {
+            EXPECT_TRUE(id_builder.Append(first_id + i).ok());
+            if (i % 2 == 0) {
+                EXPECT_TRUE(name_builder.Append("name" + std::to_string(first_id + i)).ok());
+            } else {
+                EXPECT_TRUE(name_builder.AppendNull().ok());
+            }
+        }
+        std::vector<std::shared_ptr<arrow::Array>> arrays(2);
+        EXPECT_TRUE(id_builder.Finish(&arrays[0]).ok());
+        EXPECT_TRUE(name_builder.Finish(&arrays[1]).ok());
+        return arrow::Table::Make(_schema, arrays);
+    }
+
+    ParquetWriterWrap* open_writer(const std::string& compression) {
+        LocalFileWriter* file = new LocalFileWriter(_path, 0);
+        EXPECT_TRUE(file->open().ok());
+        return new ParquetWriterWrap(file, _schema, compression);
+    }
+
+    std::string _path;
+    std::shared_ptr<arrow::Schema> _schema;
+};
+
+TEST_F(ParquetWriterTest, write) {
+    std::unique_ptr<ParquetWriterWrap> writer(open_writer("zstd"));
+    ASSERT_TRUE(writer->open().ok());
+    ASSERT_TRUE(writer->write(*make_table(1, 3)).ok());
+    ASSERT_TRUE(writer->write(*make_table(4, 2)).ok());
+    ASSERT_TRUE(writer->close().ok());
+
+    FILE* fp = fopen(_path.c_str(), "r");
+    fseek(fp, 0, SEEK_END);
+    int64_t file_size = ftell(fp);
+    fclose(fp);
+    ASSERT_EQ(file_size, writer->written_len());
+
+    ObjectPool obj_pool;
+    TDescriptorTableBuilder dtb;
+    TTupleDescriptorBuilder tuple_builder;
+    for (auto name : {"id", "name"}) {
+        tuple_builder.add_slot(
+            TSlotDescriptorBuilder().string_type(64).column_name(name).build());
+    }
+    tuple_builder.build(&dtb);
+    DescriptorTbl* desc_tbl = nullptr;
+    ASSERT_TRUE(DescriptorTbl::create(&obj_pool, dtb.desc_tbl(), &desc_tbl).ok());
+
+    LocalFileReader* file = new LocalFileReader(_path, 0);
+    ParquetReaderWrap reader(file);
+    ASSERT_TRUE(file->open().ok());
+    ASSERT_TRUE(reader.init(desc_tbl->get_tuple_descriptor(0)->slots(), 0, -1).ok());
+
+    // every table is a row group
+    int num_rows = 0;
+    bool eof = false;
+    ASSERT_TRUE(reader.next_rows(10, &num_rows, &eof).ok());
+    ASSERT_EQ(3, num_rows);
+    ASSERT_EQ("1", reader.column(0).values[0].to_string());
+    ASSERT_EQ("name1", reader.column(1).values[0].to_string());
+    ASSERT_TRUE(reader.column(1).is_null[1]);
+    ASSERT_TRUE(reader.next_rows(10, &num_rows, &eof).ok());
+    ASSERT_EQ(2, num_rows);
+    ASSERT_EQ("5", reader.column(0).values[1].to_string());
+    ASSERT_TRUE(reader.next_rows(10, &num_rows, &eof).ok());
+    ASSERT_TRUE(eof);
+}
+
+TEST_F(ParquetWriterTest, unknown_compression) {
+    std::unique_ptr<ParquetWriterWrap> writer(open_writer("brotli2"));
+    ASSERT_FALSE(writer->open().ok());
+    ASSERT_TRUE(writer->close().ok());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,424 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define private public
+#define protected public
+#include "exec/partitioned_hash_join_node.h"
+#include "common/config.h"
+#include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/runtime_filter.h"
+#include "runtime/runtime_filter_mgr.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "service/backend_options.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/filesystem_util.h"
+#include "util/logging.h"
+#include "util/time.h"
+
+namespace doris {
+
+static const std::string TMP_DIR = "/tmp/partitioned-hash-join-node-test";
+// small enough for the tuple streams not to use their small buffers, the joins
+// limited to the buffers they require spill
+static const int BLOCK_SIZE = 8 * 1024;
+static const int MIN_BUFFERS = 2 * PartitionedHashJoinNode::PARTITION_FANOUT + 1;
+
+struct JoinResult {
+    std::vector<TestRow> rows;
+    int64_t num_spilled_partitions = 0;
+    // the IN predicates pushed down to the probe side
+    int num_probe_conjuncts = 0;
+};
+
+// Joins a probe tuple (k, v) and a build tuple (k, v) on probe.k = build.k
+class PartitionedHashJoinNodeTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+        ASSERT_TRUE(FileSystemUtil::create_directory(TMP_DIR).ok());
+        _test_env->init_tmp_file_mgr({TMP_DIR}, false);
+        _test_env->exec_env()->_runtime_filter_mgr = &_runtime_filter_mgr;
+
+        TDescriptorTableBuilder builder;
+        for (int i = 0; i < 2; ++i) {
+            TTupleDescriptorBuilder()
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+                .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+                .build(&builder);
+        }
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* probe = _desc_tbl->get_tuple_descriptor(0);
+        const TupleDescriptor* build = _desc_tbl->get_tuple_descriptor(1);
+        _probe_slots.assign(probe->slots().begin(), probe->slots().end());
+        _build_slots.assign(build->slots().begin(), build->slots().end());
+    }
+
+    void TearDown() override {
+        _test_env->exec_env()->_runtime_filter_mgr = nullptr;
+        _test_env.reset();
+        FileSystemUtil::remove_paths({TMP_DIR});
+    }
+
+protected:
+    // the rows of a side of the join, some keys are NULL and some are repeated
+    static std::vector<TestRow> make_rows(int num_rows, int num_keys, int seed) {
+        std::vector<TestRow> rows;
+        for (int i = 0; i < num_rows; ++i) {
+            int64_t key = (i % 13 == seed % 13) ? TEST_NULL : (i * 7919L + seed) % num_keys;
+            rows.push_back({key, i});
+        }
+        return rows;
+    }
+
+    static TRuntimeFilterDesc make_filter_desc(int filter_id) {
+        TRuntimeFilterDesc desc;
+        desc.filter_id = filter_id;
+        desc.expr_order = 0;
+        TRuntimeFilterTarget target;
+        target.target_fragment_instance_id.hi = 1;
+        target.target_fragment_instance_id.lo = filter_id;
+        target.target_fragment_instance_addr.hostname = BackendOptions::get_localhost();
+        target.target_fragment_instance_addr.port = config::brpc_port;
+        desc.targets.push_back(target);
+        return desc;
+    }
+
+    std::shared_ptr<RuntimeFilter> take_filter(const TRuntimeFilterDesc& desc) {
+        return _runtime_filter_mgr.take(desc.targets[0].target_fragment_instance_id,
+                                        desc.filter_id, 1, MonotonicMillis());
+    }
+
+    // the slots of the rows 'op' returns
+    std::vector<const SlotDescriptor*> output_slots(TJoinOp::type op) const {
+        if (op == TJoinOp::LEFT_SEMI_JOIN || op == TJoinOp::LEFT_ANTI_JOIN) {
+            return _probe_slots;
+        }
+        if (op == TJoinOp::RIGHT_SEMI_JOIN || op == TJoinOp::RIGHT_ANTI_JOIN) {
+            return _build_slots;
+        }
+        std::vector<const SlotDescriptor*> slots = _probe_slots;
+        slots.insert(slots.end(), _build_slots.begin(), _build_slots.end());
+        return slots;
+    }
+
+    // The rows the join returns, from the rows matching each probe row. A NULL
+    // key matches no row.
+    static std::vector<TestRow> expected_rows(TJoinOp::type op,
+                                              const std::vector<TestRow>& probe_rows,
+                                              const std::vector<TestRow>& build_rows) {
+        std::multimap<int64_t, int> build_index;
+        for (int i = 0; i < build_rows.size(); ++i) {
+            if (build_rows[i][0] != TEST_NULL) {
+                build_index.emplace(build_rows[i][0], i);
+            }
+        }
+        std::vector<TestRow> rows;
+        std::vector<bool> build_matched(build_rows.size(), false);
+        const TestRow null_row = {TEST_NULL, TEST_NULL};
+        for (const TestRow& probe : probe_rows) {
+            auto range = build_index.equal_range(probe[0]);
+            bool matched = probe[0] != TEST_NULL && range.first != range.second;
+            for (auto it = range.first; matched && it != range.second; ++it) {
+                build_matched[it->second] = true;
+                if (op == TJoinOp::INNER_JOIN || op == TJoinOp::LEFT_OUTER_JOIN
+                        || op == TJoinOp::RIGHT_OUTER_JOIN || op == TJoinOp::FULL_OUTER_JOIN) {
+                    TestRow row = probe;
+                    row.insert(row.end(), build_rows[it->second].begin(),
+                               build_rows[it->second].end());
+                    rows.push_back(row);
+                }
+            }
+            if ((op == TJoinOp::LEFT_SEMI_JOIN && matched)
+                    || (op == TJoinOp::LEFT_ANTI_JOIN && !matched)) {
+                rows.push_back(probe);
+            } else if (!matched && (op == TJoinOp::LEFT_OUTER_JOIN
+                                    || op == TJoinOp::FULL_OUTER_JOIN)) {
+                TestRow row = probe;
+                row.insert(row.end(), null_row.begin(), null_row.end());
+                rows.push_back(row);
+            }
+        }
+        for (int i = 0; i < build_rows.size(); ++i) {
+            if ((op == TJoinOp::RIGHT_SEMI_JOIN && build_matched[i])
+                    || (op == TJoinOp::RIGHT_ANTI_JOIN && !build_matched[i])) {
+                rows.push_back(build_rows[i]);
+            } else if (!build_matched[i] && (op == TJoinOp::RIGHT_OUTER_JOIN
+                                             || op == TJoinOp::FULL_OUTER_JOIN)) {
+                TestRow row = null_row;
+                row.insert(row.end(), build_rows[i].begin(), build_rows[i].end());
+                rows.push_back(row);
+            }
+        }
+        return sorted_test_rows(rows);
+    }
+
+    // Runs the join with 'max_buffers' blocks of BLOCK_SIZE bytes, -1 for no limit
+    Status join(TJoinOp::type op, const std::vector<TestRow>& probe_rows,
+                const std::vector<TestRow>& build_rows, int max_buffers,
+                const std::vector<TRuntimeFilterDesc>& filters, bool is_push_down,
+                JoinResult* result) {
+        RuntimeState* state = nullptr;
+        RETURN_IF_ERROR(_test_env->create_query_state(++_query_id, max_buffers, BLOCK_SIZE,
+                                                      &state));
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+
+        bool probe_nullable = op == TJoinOp::RIGHT_OUTER_JOIN
+            || op == TJoinOp::FULL_OUTER_JOIN || op == TJoinOp::RIGHT_ANTI_JOIN;
+        bool build_nullable = op == TJoinOp::LEFT_OUTER_JOIN
+            || op == TJoinOp::FULL_OUTER_JOIN || op == TJoinOp::LEFT_ANTI_JOIN;
+        TPlanNode tnode = make_test_plan_node(TPlanNodeType::HASH_JOIN_NODE, 0, {0, 1},
+                                              {probe_nullable, build_nullable});
+        tnode.num_children = 2;
+        tnode.__isset.hash_join_node = true;
+        tnode.hash_join_node.join_op = op;
+        TEqJoinCondition eq_join_conjunct;
+        eq_join_conjunct.left = make_test_slot_ref(_probe_slots[0]);
+        eq_join_conjunct.right = make_test_slot_ref(_build_slots[0]);
+        tnode.hash_join_node.eq_join_conjuncts.push_back(eq_join_conjunct);
+        tnode.hash_join_node.__set_is_push_down(is_push_down);
+        if (!filters.empty()) {
+            tnode.hash_join_node.__set_runtime_filters(filters);
+        }
+
+        PartitionedHashJoinNode node(&_pool, tnode, *_desc_tbl);
+        TestRowsNode* probe = _pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 1, {0}, {false}),
+                *_desc_tbl, probe_rows, 100));
+        TestRowsNode* build = _pool.add(new TestRowsNode(&_pool,
+                make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 2, {1}, {false}),
+                *_desc_tbl, build_rows, 100));
+        node._children.push_back(probe);
+        node._children.push_back(build);
+
+        RETURN_IF_ERROR(node.init(tnode, state));
+        Status status = node.prepare(state);
+        if (status.ok()) {
+            status = node.open(state);
+        }
+        if (status.ok()) {
+            status = read_test_rows(state, &node, output_slots(op), &result->rows);
+        }
+        node.close(state);
+        RETURN_IF_ERROR(status);
+        result->rows = sorted_test_rows(result->rows);
+        result->num_spilled_partitions = node._num_spilled_partitions->value();
+        result->num_probe_conjuncts = probe->num_conjuncts();
+        return Status::OK;
+    }
+
+    // Checks 'op' against the reference join in memory, with empty inputs and
+    // spilling its partitions
+    void check_join_op(TJoinOp::type op) {
+        std::vector<TestRow> probe_rows = make_rows(500, 300, 1);
+        std::vector<TestRow> build_rows = make_rows(400, 300, 2);
+        JoinResult result;
+        ASSERT_TRUE(join(op, probe_rows, build_rows, -1, {}, false, &result).ok());
+        EXPECT_EQ(expected_rows(op, probe_rows, build_rows), result.rows);
+        EXPECT_EQ(0, result.num_spilled_partitions);
+
+        for (int empty_side = 0; empty_side < 2; ++empty_side) {
+            std::vector<TestRow> probe = empty_side == 0 ? std::vector<TestRow>() : probe_rows;
+            std::vector<TestRow> build = empty_side == 1 ? std::vector<TestRow>() : build_rows;
+            JoinResult empty_result;
+            ASSERT_TRUE(join(op, probe, build, -1, {}, false, &empty_result).ok());
+            EXPECT_EQ(expected_rows(op, probe, build), empty_result.rows);
+        }
+
+        // the partitions spill and are repartitioned
+        probe_rows = make_rows(20000, 15000, 3);
+        build_rows = make_rows(20000, 15000, 4);
+        JoinResult spilled_result;
+        ASSERT_TRUE(join(op, probe_rows, build_rows, MIN_BUFFERS, {}, false,
+                         &spilled_result).ok());
+        EXPECT_EQ(expected_rows(op, probe_rows, build_rows), spilled_result.rows);
+        EXPECT_GT(spilled_result.num_spilled_partitions, 0);
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    RuntimeFilterMgr _runtime_filter_mgr;
+    ObjectPool _pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::vector<const SlotDescriptor*> _probe_slots;
+    std::vector<const SlotDescriptor*> _build_slots;
+    int64_t _query_id = 0;
+};
+
+TEST_F(PartitionedHashJoinNodeTest, inner_join) {
+    check_join_op(TJoinOp::INNER_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, left_outer_join) {
+    check_join_op(TJoinOp::LEFT_OUTER_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, right_outer_join) {
+    check_join_op(TJoinOp::RIGHT_OUTER_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, full_outer_join) {
+    check_join_op(TJoinOp::FULL_OUTER_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, left_semi_join) {
+    check_join_op(TJoinOp::LEFT_SEMI_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, left_anti_join) {
+    check_join_op(TJoinOp::LEFT_ANTI_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, right_semi_join) {
+    check_join_op(TJoinOp::RIGHT_SEMI_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, right_anti_join) {
+    check_join_op(TJoinOp::RIGHT_ANTI_JOIN);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, runtime_filters) {
+    std::vector<TestRow> probe_rows = make_rows(500, 300, 1);
+    std::vector<TestRow> build_rows = {{7, 0}, {TEST_NULL, 1}, {42, 2}, {-3, 3}, {42, 4}};
+    // the planner sizes the filters of partitioned joins
+    TRuntimeFilterDesc sized = make_filter_desc(1);
+    sized.__set_bloom_filter_entries(1024);
+    TRuntimeFilterDesc unsized = make_filter_desc(2);
+
+    for (TJoinOp::type op : {TJoinOp::INNER_JOIN, TJoinOp::LEFT_SEMI_JOIN,
+                             TJoinOp::RIGHT_OUTER_JOIN, TJoinOp::RIGHT_SEMI_JOIN}) {
+        JoinResult result;
+        ASSERT_TRUE(join(op, probe_rows, build_rows, -1, {sized, unsized}, false,
+                         &result).ok());
+        EXPECT_EQ(expected_rows(op, probe_rows, build_rows), result.rows);
+        for (const TRuntimeFilterDesc& desc : {sized, unsized}) {
+            std::shared_ptr<RuntimeFilter> filter = take_filter(desc);
+            ASSERT_TRUE(filter != nullptr) << "op=" << op << " filter=" << desc.filter_id;
+            ASSERT_FALSE(filter->is_empty());
+            EXPECT_EQ(-3, *reinterpret_cast<const int32_t*>(filter->min_value()));
+            EXPECT_EQ(42, *reinterpret_cast<const int32_t*>(filter->max_value()));
+            EXPECT_TRUE(filter->bloom_filter() != nullptr);
+        }
+    }
+
+    // the probe rows matching no build row are returned
+    for (TJoinOp::type op : {TJoinOp::LEFT_OUTER_JOIN, TJoinOp::FULL_OUTER_JOIN,
+                             TJoinOp::LEFT_ANTI_JOIN, TJoinOp::RIGHT_ANTI_JOIN}) {
+        JoinResult result;
+        ASSERT_TRUE(join(op, probe_rows, build_rows, -1, {sized, unsized}, false,
+                         &result).ok());
+        EXPECT_EQ(expected_rows(op, probe_rows, build_rows), result.rows);
+        EXPECT_TRUE(take_filter(sized) == nullptr);
+        EXPECT_TRUE(take_filter(unsized) == nullptr);
+    }
+
+    // empty filters of an empty build side
+    JoinResult empty_result;
+    ASSERT_TRUE(join(TJoinOp::INNER_JOIN, probe_rows, {}, -1, {sized}, false,
+                     &empty_result).ok());
+    EXPECT_TRUE(empty_result.rows.empty());
+    std::shared_ptr<RuntimeFilter> empty_filter = take_filter(sized);
+    ASSERT_TRUE(empty_filter != nullptr);
+    EXPECT_TRUE(empty_filter->is_empty());
+}
+
+TEST_F(PartitionedHashJoinNodeTest, runtime_filters_of_spilled_join) {
+    std::vector<TestRow> probe_rows = make_rows(20000, 15000, 3);
+    std::vector<TestRow> build_rows = make_rows(20000, 15000, 4);
+    TRuntimeFilterDesc sized = make_filter_desc(1);
+    sized.__set_bloom_filter_entries(32768);
+    TRuntimeFilterDesc unsized = make_filter_desc(2);
+    JoinResult result;
+    ASSERT_TRUE(join(TJoinOp::INNER_JOIN, probe_rows, build_rows, MIN_BUFFERS,
+                     {sized, unsized}, false, &result).ok());
+    EXPECT_GT(result.num_spilled_partitions, 0);
+    EXPECT_EQ(expected_rows(TJoinOp::INNER_JOIN, probe_rows, build_rows), result.rows);
+
+    int32_t min_key = 15000;
+    int32_t max_key = -1;
+    for (const TestRow& row : build_rows) {
+        if (row[0] != TEST_NULL) {
+            min_key = std::min<int32_t>(min_key, row[0]);
+            max_key = std::max<int32_t>(max_key, row[0]);
+        }
+    }
+    std::shared_ptr<RuntimeFilter> filter = take_filter(sized);
+    ASSERT_TRUE(filter != nullptr);
+    EXPECT_EQ(min_key, *reinterpret_cast<const int32_t*>(filter->min_value()));
+    EXPECT_EQ(max_key, *reinterpret_cast<const int32_t*>(filter->max_value()));
+    EXPECT_TRUE(filter->bloom_filter() != nullptr);
+    // the build rows of the spilled partitions are not read again for it
+    filter = take_filter(unsized);
+    ASSERT_TRUE(filter != nullptr);
+    EXPECT_EQ(min_key, *reinterpret_cast<const int32_t*>(filter->min_value()));
+    EXPECT_EQ(max_key, *reinterpret_cast<const int32_t*>(filter->max_value()));
+    EXPECT_TRUE(filter->bloom_filter() == nullptr);
+}
+
+TEST_F(PartitionedHashJoinNodeTest, push_down) {
+    std::vector<TestRow> probe_rows = make_rows(500, 300, 1);
+    std::vector<TestRow> build_rows = make_rows(100, 300, 2);
+    for (TJoinOp::type op : {TJoinOp::INNER_JOIN, TJoinOp::LEFT_SEMI_JOIN,
+                             TJoinOp::RIGHT_OUTER_JOIN, TJoinOp::RIGHT_SEMI_JOIN}) {
+        JoinResult result;
+        ASSERT_TRUE(join(op, probe_rows, build_rows, -1, {}, true, &result).ok());
+        EXPECT_EQ(expected_rows(op, probe_rows, build_rows), result.rows);
+        EXPECT_EQ(1, result.num_probe_conjuncts) << "op=" << op;
+
+        ASSERT_TRUE(join(op, probe_rows, build_rows, -1, {}, false, &result).ok());
+        EXPECT_EQ(0, result.num_probe_conjuncts) << "op=" << op;
+    }
+    for (TJoinOp::type op : {TJoinOp::LEFT_OUTER_JOIN, TJoinOp::LEFT_ANTI_JOIN}) {
+        JoinResult result;
+        ASSERT_TRUE(join(op, probe_rows, build_rows, -1, {}, true, &result).ok());
+        EXPECT_EQ(expected_rows(op, probe_rows, build_rows), result.rows);
+        EXPECT_EQ(0, result.num_probe_conjuncts) << "op=" << op;
+    }
+
+    // too many build keys
+    build_rows = make_rows(2000, 3000, 2);
+    JoinResult result;
+    ASSERT_TRUE(join(TJoinOp::INNER_JOIN, probe_rows, build_rows, -1, {}, true, &result).ok());
+    EXPECT_EQ(expected_rows(TJoinOp::INNER_JOIN, probe_rows, build_rows), result.rows);
+    EXPECT_EQ(0, result.num_probe_conjuncts);
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::config::read_size = 8 * 1024;
+    doris::config::min_buffer_size = 1024;
+    doris::config::disable_mem_pools = false;
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+
+    return RUN_ALL_TESTS();
+}
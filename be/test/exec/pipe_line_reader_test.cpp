@@ -0,0 +1,118 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/pipe_line_reader.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "runtime/stream_load/stream_load_pipe.h"
+#include "util/runtime_profile.h"
+
+namespace doris {
+
+class PipeLineReaderTest : public testing::Test {
+public:
+    PipeLineReaderTest() : _profile(&_obj_pool, "TestProfile") { }
+
+protected:
+    // every part is appended to the pipe as one buffer
+    void append(StreamLoadPipe* pipe, const std::vector<std::string>& parts) {
+        for (auto& part : parts) {
+            auto buf = ByteBuffer::allocate(part.size() + 1);
+            buf->put_bytes(part.data(), part.size());
+            buf->flip();
+            ASSERT_TRUE(pipe->append(buf).ok());
+        }
+        ASSERT_TRUE(pipe->finish().ok());
+    }
+
+    std::vector<std::string> read_lines(LineReader* reader) {
+        std::vector<std::string> lines;
+        while (true) {
+            const uint8_t* ptr = nullptr;
+            size_t size = 0;
+            bool eof = false;
+            EXPECT_TRUE(reader->read_line(&ptr, &size, &eof).ok());
+            if (eof) {
+                break;
+            }
+            lines.emplace_back(reinterpret_cast<const char*>(ptr), size);
+        }
+        return lines;
+    }
+
+    ObjectPool _obj_pool;
+    RuntimeProfile _profile;
+};
+
+TEST_F(PipeLineReaderTest, normal) {
+    StreamLoadPipe pipe(1024 * 1024);
+    append(&pipe, {"1,2\n\n3,4\n", "5,6"});
+    PipeLineReader reader(&_profile, &pipe, '\n');
+    ASSERT_EQ(std::vector<std::string>({"1,2", "", "3,4", "5,6"}), read_lines(&reader));
+
+    // eof is kept
+    const uint8_t* ptr = nullptr;
+    size_t size = 1;
+    bool eof = false;
+    ASSERT_TRUE(reader.read_line(&ptr, &size, &eof).ok());
+    ASSERT_TRUE(eof);
+    ASSERT_EQ(0, size);
+}
+
+TEST_F(PipeLineReaderTest, split_lines) {
+    StreamLoadPipe pipe(1024 * 1024);
+    // lines split between buffers, empty buffers and a delimiter at the end
+    append(&pipe, {"ab", "c,d", "", "e\nf", "\n", "g,h\n"});
+    PipeLineReader reader(&_profile, &pipe, '\n');
+    ASSERT_EQ(std::vector<std::string>({"abc,de", "f", "g,h"}), read_lines(&reader));
+}
+
+TEST_F(PipeLineReaderTest, quoted) {
+    StreamLoadPipe pipe(1024 * 1024);
+    append(&pipe, {"\"a\n", "b\",c\n", "d\n"});
+    PipeLineReader reader(&_profile, &pipe, '\n', '"');
+    ASSERT_EQ(std::vector<std::string>({"\"a\nb\",c", "d"}), read_lines(&reader));
+}
+
+TEST_F(PipeLineReaderTest, empty) {
+    StreamLoadPipe pipe(1024 * 1024);
+    append(&pipe, {});
+    PipeLineReader reader(&_profile, &pipe, '\n');
+    ASSERT_TRUE(read_lines(&reader).empty());
+}
+
+TEST_F(PipeLineReaderTest, cancelled) {
+    StreamLoadPipe pipe(1024 * 1024);
+    pipe.cancel();
+    PipeLineReader reader(&_profile, &pipe, '\n');
+    const uint8_t* ptr = nullptr;
+    size_t size = 0;
+    bool eof = false;
+    ASSERT_FALSE(reader.read_line(&ptr, &size, &eof).ok());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,82 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "exec/scanner_concurrency_controller.h"
+
+#include <gtest/gtest.h>
+
+namespace doris {
+
+class ScannerConcurrencyControllerTest : public testing::Test {
+public:
+    ScannerConcurrencyControllerTest() { }
+
+protected:
+    // one window in which the parent consumed 'num_consumed' batches and
+    // waited for 'num_waited' of them
+    void run_window(ScannerConcurrencyController* controller, int num_consumed, int num_waited,
+                    int64_t io_nanos, size_t queue_size) {
+        for (int i = 0; i < num_consumed; ++i) {
+            controller->on_batch_consumed(i < num_waited);
+        }
+        for (int i = 0; i < ScannerConcurrencyController::WINDOW_SLICES; ++i) {
+            controller->on_slice_done(1000, io_nanos, queue_size, 100);
+        }
+    }
+};
+
+TEST_F(ScannerConcurrencyControllerTest, bounds) {
+    ASSERT_EQ(1, ScannerConcurrencyController(0, 4).target());
+    ASSERT_EQ(3, ScannerConcurrencyController(3, 4).target());
+    ASSERT_EQ(1, ScannerConcurrencyController(3, 0).target());
+}
+
+TEST_F(ScannerConcurrencyControllerTest, starved_parent) {
+    ScannerConcurrencyController controller(4, 2);
+    run_window(&controller, 10, 8, 100, 0);
+    ASSERT_EQ(3, controller.target());
+    run_window(&controller, 10, 8, 100, 0);
+    run_window(&controller, 10, 8, 100, 0);
+    ASSERT_EQ(4, controller.target());
+
+    // the parent keeps up
+    run_window(&controller, 10, 1, 100, 10);
+    ASSERT_EQ(4, controller.target());
+}
+
+TEST_F(ScannerConcurrencyControllerTest, io_bound) {
+    ScannerConcurrencyController controller(4, 2);
+    run_window(&controller, 10, 8, 900, 0);
+    ASSERT_EQ(2, controller.target());
+}
+
+TEST_F(ScannerConcurrencyControllerTest, blocked_parent) {
+    ScannerConcurrencyController controller(4, 3);
+    run_window(&controller, 10, 0, 100, 90);
+    ASSERT_EQ(2, controller.target());
+    run_window(&controller, 10, 0, 100, 90);
+    run_window(&controller, 10, 0, 100, 90);
+    ASSERT_EQ(1, controller.target());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,224 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <string.h>
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "exprs/expr.h"
+#include "exprs/expr_column.h"
+#include "exprs/expr_context.h"
+#include "gen_cpp/Exprs_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// Evaluates exprs on a tuple (c0 INT, c1 INT, c2 BIGINT) by batch and row by
+// row, the values of both must be the same
+class ExprBatchTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+        TDescriptorTableBuilder builder;
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_BIGINT).nullable(true).build())
+            .build(&builder);
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        _slots.assign(tuple_desc->slots().begin(), tuple_desc->slots().end());
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+
+        ASSERT_TRUE(_test_env->create_query_state(0, -1, 8 * 1024 * 1024, &_state).ok());
+        _state->init_mem_trackers(TUniqueId());
+        _state->set_desc_tbl(_desc_tbl);
+
+        // c1 is 0 for a quarter of the rows, each column has NULLs
+        for (int i = 0; i < 200; ++i) {
+            _rows.push_back({i % 7 == 0 ? TEST_NULL : i % 11 - 5,
+                             i % 5 == 0 ? TEST_NULL : i % 4 - 1,
+                             i % 9 == 0 ? TEST_NULL : i * 1000 - 30000});
+        }
+    }
+
+    void TearDown() override {
+        _test_env.reset();
+    }
+
+protected:
+    TExpr slot(int i) const {
+        return make_test_slot_ref(_slots[i]);
+    }
+
+    // Evaluates the selected rows of 'batch' and checks them against the
+    // values of the rows one by one
+    void check_rows(ExprContext* ctx, RowBatch* batch, const int* sel, int n) {
+        ExprColumn column;
+        ASSERT_TRUE(ctx->evaluate(batch, sel, n, &column).ok());
+        EXPECT_EQ(ctx->root()->type().type, column.type());
+        for_each_selected_row(sel, n, [&](int i) {
+            void* expected = ctx->get_value(batch->get_row(i));
+            ASSERT_EQ(expected == NULL, column.is_null(i)) << "row " << i;
+            if (expected != NULL) {
+                EXPECT_EQ(0, memcmp(expected, column.value(i), column.value_size()))
+                    << "row " << i;
+            }
+        });
+    }
+
+    // Checks the batch evaluation of 'texpr' for all rows, every other row and
+    // no row, and on an empty batch
+    void check_expr(const TExpr& texpr) {
+        ExprContext* ctx = nullptr;
+        ASSERT_TRUE(Expr::create_expr_tree(&_pool, texpr, &ctx).ok());
+        ASSERT_TRUE(ctx->prepare(_state, *_row_desc, &_tracker).ok());
+        ASSERT_TRUE(ctx->open(_state).ok());
+
+        RowBatch batch(*_row_desc, _rows.size(), &_tracker);
+        const TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        for (const TestRow& values : _rows) {
+            TupleRow* row = batch.get_row(batch.add_row());
+            row->set_tuple(0, write_test_tuple(tuple_desc, values, batch.tuple_data_pool()));
+            batch.commit_last_row();
+        }
+        check_rows(ctx, &batch, NULL, batch.num_rows());
+
+        std::vector<int> sel;
+        for (int i = 1; i < batch.num_rows(); i += 2) {
+            sel.push_back(i);
+        }
+        check_rows(ctx, &batch, sel.data(), sel.size());
+        check_rows(ctx, &batch, sel.data(), 0);
+
+        RowBatch empty_batch(*_row_desc, 1, &_tracker);
+        check_rows(ctx, &empty_batch, NULL, 0);
+        ctx->close(_state);
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    ObjectPool _pool;
+    MemTracker _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    std::vector<const SlotDescriptor*> _slots;
+    RuntimeState* _state = nullptr;
+    std::vector<TestRow> _rows;
+};
+
+TEST_F(ExprBatchTest, slot_refs_and_literals) {
+    check_expr(slot(0));
+    check_expr(slot(2));
+    check_expr(make_test_int_literal(TYPE_INT, 3));
+    check_expr(make_test_null_literal(TYPE_BIGINT));
+}
+
+TEST_F(ExprBatchTest, arithmetic) {
+    TExpr seven = make_test_int_literal(TYPE_BIGINT, 7);
+    for (TExprOpcode::type op : {TExprOpcode::ADD, TExprOpcode::SUBTRACT,
+                                 TExprOpcode::MULTIPLY, TExprOpcode::INT_DIVIDE,
+                                 TExprOpcode::MOD, TExprOpcode::BITAND, TExprOpcode::BITOR,
+                                 TExprOpcode::BITXOR}) {
+        // the divisor c1 is 0 in some rows
+        check_expr(make_test_arithmetic(op, TYPE_INT, {slot(0), slot(1)}));
+        check_expr(make_test_arithmetic(op, TYPE_BIGINT, {slot(2), seven}));
+    }
+    check_expr(make_test_arithmetic(TExprOpcode::BITNOT, TYPE_INT, {slot(0)}));
+    check_expr(make_test_arithmetic(TExprOpcode::ADD, TYPE_INT,
+                                    {slot(0), make_test_null_literal(TYPE_INT)}));
+    TExpr sum = make_test_arithmetic(TExprOpcode::ADD, TYPE_BIGINT, {slot(2), seven});
+    check_expr(make_test_arithmetic(TExprOpcode::MULTIPLY, TYPE_BIGINT, {sum, slot(2)}));
+}
+
+TEST_F(ExprBatchTest, double_arithmetic) {
+    TExpr c0 = make_test_cast(TYPE_DOUBLE, TYPE_INT, slot(0));
+    TExpr c1 = make_test_cast(TYPE_DOUBLE, TYPE_INT, slot(1));
+    TExpr c2 = make_test_cast(TYPE_DOUBLE, TYPE_BIGINT, slot(2));
+    for (TExprOpcode::type op : {TExprOpcode::ADD, TExprOpcode::SUBTRACT,
+                                 TExprOpcode::MULTIPLY, TExprOpcode::DIVIDE}) {
+        check_expr(make_test_arithmetic(op, TYPE_DOUBLE, {c0, c1}));
+    }
+    check_expr(make_test_arithmetic(TExprOpcode::MOD, TYPE_DOUBLE, {c2, c0}));
+}
+
+TEST_F(ExprBatchTest, casts) {
+    check_expr(make_test_cast(TYPE_BIGINT, TYPE_INT, slot(0)));
+    check_expr(make_test_cast(TYPE_INT, TYPE_BIGINT, slot(2)));
+    check_expr(make_test_cast(TYPE_SMALLINT, TYPE_BIGINT, slot(2)));
+    check_expr(make_test_cast(TYPE_BOOLEAN, TYPE_INT, slot(1)));
+    check_expr(make_test_cast(TYPE_FLOAT, TYPE_BIGINT, slot(2)));
+}
+
+TEST_F(ExprBatchTest, binary_predicates) {
+    TExpr zero = make_test_int_literal(TYPE_BIGINT, 0);
+    TExpr null = make_test_null_literal(TYPE_INT);
+    for (TExprOpcode::type op : {TExprOpcode::EQ, TExprOpcode::NE, TExprOpcode::LT,
+                                 TExprOpcode::LE, TExprOpcode::GT, TExprOpcode::GE}) {
+        check_expr(make_test_binary_pred(op, TYPE_INT, slot(0), slot(1)));
+        check_expr(make_test_binary_pred(op, TYPE_BIGINT, slot(2), zero));
+        check_expr(make_test_binary_pred(op, TYPE_INT, slot(0), null));
+    }
+}
+
+TEST_F(ExprBatchTest, compound_predicates) {
+    // both sides are NULL in some rows, to check the three-valued logic
+    TExpr lhs = make_test_binary_pred(TExprOpcode::LT, TYPE_INT, slot(0), slot(1));
+    TExpr rhs = make_test_binary_pred(TExprOpcode::GT, TYPE_BIGINT, slot(2),
+                                      make_test_int_literal(TYPE_BIGINT, 0));
+    TExpr disjunction = make_test_compound_pred(TExprOpcode::COMPOUND_OR, {lhs, rhs});
+    check_expr(make_test_compound_pred(TExprOpcode::COMPOUND_AND, {lhs, rhs}));
+    check_expr(disjunction);
+    check_expr(make_test_compound_pred(TExprOpcode::COMPOUND_NOT, {lhs}));
+    check_expr(make_test_compound_pred(TExprOpcode::COMPOUND_NOT, {disjunction}));
+}
+
+TEST_F(ExprBatchTest, in_predicates) {
+    for (bool is_not_in : {false, true}) {
+        check_expr(make_test_in_pred(is_not_in, {slot(0), make_test_int_literal(TYPE_INT, -3),
+                                                 make_test_int_literal(TYPE_INT, 0),
+                                                 make_test_int_literal(TYPE_INT, 4)}));
+        // a NULL in the list makes the rows not found NULL
+        check_expr(make_test_in_pred(is_not_in, {slot(0), make_test_int_literal(TYPE_INT, 1),
+                                                 make_test_null_literal(TYPE_INT)}));
+        check_expr(make_test_in_pred(is_not_in, {slot(2),
+                                                 make_test_int_literal(TYPE_BIGINT, 10000)}));
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,299 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "exec/exec_node.h"
+#include "exprs/expr.h"
+#include "exprs/expr_column.h"
+#include "exprs/expr_context.h"
+#include "exprs/folded_constant.h"
+#include "exprs/shared_subexpr.h"
+#include "gen_cpp/Exprs_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/disk_info.h"
+#include "util/exec_node_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// The values of conjuncts for each row and whether the row passes all of them
+struct ConjunctResult {
+    std::vector<std::vector<std::string>> values;
+    std::vector<bool> passed;
+    int num_folded = 0;
+    int num_shared = 0;
+};
+
+// Evaluates conjuncts on a tuple (c0 INT, c1 INT, c2 BIGINT) with and without the
+// folding of constant subexprs and the sharing of common subexprs, the values of
+// both must be the same
+class ExprRewriteTest : public testing::Test {
+public:
+    void SetUp() override {
+        _test_env.reset(new TestEnv());
+        TDescriptorTableBuilder builder;
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_BIGINT).nullable(true).build())
+            .build(&builder);
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        const TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        _slots.assign(tuple_desc->slots().begin(), tuple_desc->slots().end());
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+
+        for (int i = 0; i < 200; ++i) {
+            _rows.push_back({i % 7 == 0 ? TEST_NULL : i % 11 - 5,
+                             i % 5 == 0 ? TEST_NULL : i % 4 - 1,
+                             i % 9 == 0 ? TEST_NULL : i * 10 - 300});
+        }
+    }
+
+    void TearDown() override {
+        config::enable_expr_constant_folding = true;
+        config::enable_expr_subexpr_sharing = true;
+        _test_env.reset();
+    }
+
+protected:
+    TExpr slot(int i) const {
+        return make_test_slot_ref(_slots[i]);
+    }
+
+    static TExpr int_literal(int64_t value) {
+        return make_test_int_literal(TYPE_INT, value);
+    }
+
+    static TExpr add(const TExpr& lhs, const TExpr& rhs) {
+        return make_test_arithmetic(TExprOpcode::ADD, TYPE_INT, {lhs, rhs});
+    }
+
+    static TExpr multiply(const TExpr& lhs, const TExpr& rhs) {
+        return make_test_arithmetic(TExprOpcode::MULTIPLY, TYPE_INT, {lhs, rhs});
+    }
+
+    // c0 + c1 and c1 - 1 occur in several conjuncts, 3 * 2 - 4 and NULL + 1
+    // are constant
+    std::vector<TExpr> conjuncts() const {
+        TExpr sum = add(slot(0), slot(1));
+        TExpr c1_minus_1 = make_test_arithmetic(TExprOpcode::SUBTRACT, TYPE_INT,
+                                                {slot(1), int_literal(1)});
+        TExpr two = make_test_arithmetic(TExprOpcode::SUBTRACT, TYPE_INT,
+                                         {multiply(int_literal(3), int_literal(2)),
+                                          int_literal(4)});
+        TExpr null = add(make_test_null_literal(TYPE_INT), int_literal(1));
+        TExpr c2_bound = make_test_arithmetic(TExprOpcode::ADD, TYPE_BIGINT,
+                                              {slot(2), make_test_int_literal(TYPE_BIGINT, 25)});
+        return {
+            make_test_binary_pred(TExprOpcode::GE, TYPE_INT, sum, two),
+            make_test_binary_pred(TExprOpcode::LE, TYPE_BIGINT,
+                                  make_test_cast(TYPE_BIGINT, TYPE_INT, multiply(sum, sum)),
+                                  c2_bound),
+            make_test_compound_pred(TExprOpcode::COMPOUND_NOT,
+                    {make_test_binary_pred(TExprOpcode::EQ, TYPE_INT, sum, c1_minus_1)}),
+            make_test_compound_pred(TExprOpcode::COMPOUND_OR,
+                    {make_test_binary_pred(TExprOpcode::LT, TYPE_INT, c1_minus_1, two),
+                     make_test_binary_pred(TExprOpcode::NE, TYPE_INT, slot(0), null)}),
+            make_test_in_pred(false, {add(sum, two), int_literal(1), int_literal(3),
+                                      int_literal(5), int_literal(-1)}),
+        };
+    }
+
+    static std::string value_string(const void* value, const TypeDescriptor& type) {
+        if (value == NULL) {
+            return "NULL";
+        }
+        return std::string(reinterpret_cast<const char*>(value), type.get_slot_size());
+    }
+
+    static void count_nodes(Expr* expr, ConjunctResult* result) {
+        if (dynamic_cast<FoldedConstant*>(expr) != nullptr) {
+            ++result->num_folded;
+        }
+        if (dynamic_cast<SharedSubexpr*>(expr) != nullptr) {
+            ++result->num_shared;
+        }
+        for (Expr* child : expr->children()) {
+            count_nodes(child, result);
+        }
+    }
+
+    // Evaluates 'texprs' as the conjuncts of a node for each row, the exprs are
+    // rewritten if 'rewrite'
+    void evaluate(bool rewrite, const std::vector<TExpr>& texprs, ConjunctResult* result) {
+        config::enable_expr_constant_folding = rewrite;
+        config::enable_expr_subexpr_sharing = rewrite;
+        RuntimeState* state = nullptr;
+        ASSERT_TRUE(_test_env->create_query_state(++_query_id, -1, 8 * 1024 * 1024,
+                                                  &state).ok());
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+
+        std::vector<ExprContext*> ctxs;
+        ASSERT_TRUE(Expr::create_expr_trees(&_pool, texprs, &ctxs).ok());
+        ASSERT_TRUE(Expr::prepare(ctxs, state, *_row_desc, &_tracker).ok());
+        ASSERT_TRUE(Expr::open(ctxs, state).ok());
+        ASSERT_TRUE(ExprContext::share_subexprs(state, ctxs).ok());
+        for (ExprContext* ctx : ctxs) {
+            count_nodes(ctx->root(), result);
+        }
+
+        RowBatch batch(*_row_desc, std::max<int>(_rows.size(), 1), &_tracker);
+        const TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        for (const TestRow& values : _rows) {
+            TupleRow* row = batch.get_row(batch.add_row());
+            row->set_tuple(0, write_test_tuple(tuple_desc, values, batch.tuple_data_pool()));
+            batch.commit_last_row();
+        }
+        for (int i = 0; i < batch.num_rows(); ++i) {
+            TupleRow* row = batch.get_row(i);
+            std::vector<std::string> values;
+            {
+                // the conjuncts share the values of their subexprs for the row
+                ExprContext::SubexprScope scope(ctxs[0]);
+                for (ExprContext* ctx : ctxs) {
+                    values.push_back(value_string(ctx->get_value(row), ctx->root()->type()));
+                }
+            }
+            for (int j = 0; j < ctxs.size(); ++j) {
+                EXPECT_EQ(values[j], value_string(ctxs[j]->get_value(row),
+                                                  ctxs[j]->root()->type())) << "row " << i;
+            }
+            result->values.push_back(values);
+            result->passed.push_back(ExecNode::eval_conjuncts(ctxs.data(), ctxs.size(), row));
+        }
+
+        // the batch evaluation of the rewritten trees gives the same values
+        for (int j = 0; j < ctxs.size(); ++j) {
+            ExprColumn column;
+            ASSERT_TRUE(ctxs[j]->evaluate(&batch, NULL, batch.num_rows(), &column).ok());
+            for (int i = 0; i < batch.num_rows(); ++i) {
+                EXPECT_EQ(result->values[i][j],
+                          value_string(column.is_null(i) ? NULL : column.value(i),
+                                       ctxs[j]->root()->type())) << "row " << i;
+            }
+        }
+        Expr::close(ctxs, state);
+    }
+
+    // Returns the rows of a TestRowsNode with the conjuncts 'texprs'
+    void filter_rows(bool rewrite, const std::vector<TExpr>& texprs,
+                     std::vector<TestRow>* rows) {
+        config::enable_expr_constant_folding = rewrite;
+        config::enable_expr_subexpr_sharing = rewrite;
+        RuntimeState* state = nullptr;
+        ASSERT_TRUE(_test_env->create_query_state(++_query_id, -1, 8 * 1024 * 1024,
+                                                  &state).ok());
+        state->init_mem_trackers(TUniqueId());
+        state->set_desc_tbl(_desc_tbl);
+
+        TPlanNode tnode = make_test_plan_node(TPlanNodeType::OLAP_SCAN_NODE, 0, {0}, {false});
+        tnode.__set_conjuncts(texprs);
+        TestRowsNode node(&_pool, tnode, *_desc_tbl, _rows, 64);
+        ASSERT_TRUE(node.init(tnode, state).ok());
+        ASSERT_TRUE(node.prepare(state).ok());
+        ASSERT_TRUE(node.open(state).ok());
+        ASSERT_TRUE(read_test_rows(state, &node, _slots, rows).ok());
+        node.close(state);
+    }
+
+    std::unique_ptr<TestEnv> _test_env;
+    ObjectPool _pool;
+    MemTracker _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    std::vector<const SlotDescriptor*> _slots;
+    std::vector<TestRow> _rows;
+    int64_t _query_id = 0;
+};
+
+TEST_F(ExprRewriteTest, rewritten_conjuncts_give_the_same_values) {
+    ConjunctResult expected;
+    evaluate(false, conjuncts(), &expected);
+    EXPECT_EQ(0, expected.num_folded);
+    EXPECT_EQ(0, expected.num_shared);
+
+    ConjunctResult result;
+    evaluate(true, conjuncts(), &result);
+    EXPECT_LT(0, result.num_folded);
+    EXPECT_LT(0, result.num_shared);
+    EXPECT_EQ(expected.values, result.values);
+    EXPECT_EQ(expected.passed, result.passed);
+}
+
+TEST_F(ExprRewriteTest, rewritten_conjuncts_of_an_empty_input) {
+    _rows.clear();
+    ConjunctResult result;
+    evaluate(true, conjuncts(), &result);
+    EXPECT_LT(0, result.num_shared);
+    EXPECT_TRUE(result.values.empty());
+}
+
+// a conjunct sharing nothing with the others keeps its subexprs
+TEST_F(ExprRewriteTest, single_occurrences_are_not_shared) {
+    std::vector<TExpr> texprs = {
+        make_test_binary_pred(TExprOpcode::GT, TYPE_INT, add(slot(0), slot(1)),
+                              int_literal(0)),
+        make_test_binary_pred(TExprOpcode::LT, TYPE_INT, add(slot(1), slot(0)),
+                              int_literal(3)),
+    };
+    ConjunctResult expected;
+    evaluate(false, texprs, &expected);
+    ConjunctResult result;
+    evaluate(true, texprs, &result);
+    EXPECT_EQ(0, result.num_shared);
+    EXPECT_EQ(expected.values, result.values);
+}
+
+TEST_F(ExprRewriteTest, filtered_rows_of_a_node) {
+    std::vector<TestRow> expected;
+    filter_rows(false, conjuncts(), &expected);
+    ASSERT_FALSE(expected.empty());
+    ASSERT_LT(expected.size(), _rows.size());
+
+    std::vector<TestRow> rows;
+    filter_rows(true, conjuncts(), &rows);
+    EXPECT_EQ(expected, rows);
+
+    _rows.clear();
+    rows.clear();
+    filter_rows(true, conjuncts(), &rows);
+    EXPECT_TRUE(rows.empty());
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+    return RUN_ALL_TESTS();
+}
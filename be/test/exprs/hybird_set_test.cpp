@@ -18,6 +18,7 @@
 #include "exprs/hybird_set.h"
 
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 #include "util/logging.h"
 
@@ -371,6 +372,89 @@ TEST_F(HybirdSetTest, timestamp) {
     ASSERT_FALSE(set->find(&v23));
 }
 
+TEST_F(HybirdSetTest, large_set) {
+    HybirdSetBase* set = HybirdSetBase::create_set(TYPE_BIGINT);
+    // beyond the values searched linearly and several rehashes
+    for (int64_t i = 0; i < 1000; ++i) {
+        int64_t a = i * 7;
+        set->insert(&a);
+        set->insert(&a);
+    }
+    ASSERT_EQ(1000, set->size());
+    for (int64_t i = 0; i < 7000; ++i) {
+        ASSERT_EQ(i % 7 == 0, set->find(&i));
+    }
+
+    // values are iterated in insertion order
+    HybirdSetBase::IteratorBase* base = set->begin();
+    for (int64_t i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(base->has_next());
+        ASSERT_EQ(i * 7, *(const int64_t*)base->get_value());
+        base->next();
+    }
+    ASSERT_FALSE(base->has_next());
+    delete set;
+}
+
+TEST_F(HybirdSetTest, find_batch) {
+    for (int set_size : {3, 100}) {
+        HybirdSetBase* set = HybirdSetBase::create_set(TYPE_INT);
+        for (int32_t i = 0; i < set_size; ++i) {
+            int32_t a = i * 2;
+            set->insert(&a);
+        }
+        std::vector<int32_t> values;
+        for (int32_t i = 0; i < 300; ++i) {
+            values.push_back(i);
+        }
+        bool results[300];
+        set->find_batch(values.data(), NULL, values.size(), results);
+        for (int32_t i = 0; i < 300; ++i) {
+            ASSERT_EQ(i % 2 == 0 && i < set_size * 2, results[i]);
+        }
+
+        // rows which are not selected are unchanged
+        memset(results, 0, sizeof(results));
+        int sel[] = {1, 4, 5};
+        set->find_batch(values.data(), sel, 3, results);
+        ASSERT_FALSE(results[0]);
+        ASSERT_FALSE(results[1]);
+        ASSERT_TRUE(results[4]);
+        ASSERT_FALSE(results[5]);
+        delete set;
+    }
+}
+
+TEST_F(HybirdSetTest, string_batch) {
+    HybirdSetBase* set = HybirdSetBase::create_set(TYPE_VARCHAR);
+    std::vector<std::string> strs;
+    for (int i = 0; i < 50; ++i) {
+        strs.push_back(std::string(i, 'a'));
+    }
+    for (auto& str : strs) {
+        StringValue a(const_cast<char*>(str.data()), str.size());
+        set->insert(&a);
+    }
+    // the set keeps its own copies
+    strs.clear();
+    ASSERT_EQ(50, set->size());
+
+    std::string probe(60, 'a');
+    std::vector<StringValue> values;
+    for (int i = 0; i < 60; ++i) {
+        values.emplace_back(const_cast<char*>(probe.data()), i);
+    }
+    bool results[60];
+    set->find_batch(values.data(), NULL, values.size(), results);
+    for (int i = 0; i < 60; ++i) {
+        ASSERT_EQ(i < 50, results[i]);
+    }
+    std::string other = "b";
+    StringValue b(const_cast<char*>(other.data()), other.size());
+    ASSERT_FALSE(set->find(&b));
+    delete set;
+}
+
 }
 
 int main(int argc, char** argv) {
@@ -18,6 +18,7 @@
 #include "exprs/json_functions.h"
 
 #include <string>
+#include <vector>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 #include <gtest/gtest.h>
@@ -186,6 +187,51 @@ TEST_F(JsonFunctionTest, special_char)
     ASSERT_EQ(std::string(res3->GetString()), "v1");
 }
 
+TEST_F(JsonFunctionTest, find_json_object)
+{
+    std::vector<std::string> json_strings = {
+        "{\"id\":\"name\",\"age\":11,\"money\":123000.789}",
+        "{ \"a\" : { \"b\": [1, {\"c\": \"x]}\"}, [2, 3]], \"d\": null}, \"e\": 1e2 }",
+        "{\"a\": [{\"b\": 1}, {\"b\": [2, 3]}], \"s\\\"q\": true}",
+        "{\"a\": {\"b\": 1}, \"a\": 2, \"big\": 12345678901}",
+        "{\"a\": {\"b\": 1, \"c\": [1, 2}",
+        "[1, 2]",
+        "not json"};
+    std::vector<std::string> path_strings = {
+        "$", "$.id", "$.age", "$.money", "$.a", "$.a.b", "$.a.b[1]", "$.a.b[1].c",
+        "$.a.b[2][1]", "$.a.d", "$.a.d.x", "$.e", "$.a.b[5]", "$.big",
+        "$.a.c", "$.x", "$[1]", "$.a[0]", "x.a"};
+    for (auto& json_string : json_strings) {
+        for (auto& path_string : path_strings) {
+            for (auto fntype : {JSON_FUN_INT, JSON_FUN_DOUBLE, JSON_FUN_STRING}) {
+                rapidjson::Document document1;
+                rapidjson::Value* res1 = JsonFunctions::get_json_object(
+                    nullptr, json_string, path_string, fntype, &document1);
+                rapidjson::StringBuffer buf1;
+                rapidjson::Writer<rapidjson::StringBuffer> writer1(buf1);
+                res1->Accept(writer1);
+
+                rapidjson::Document document2;
+                rapidjson::Value* res2 = JsonFunctions::find_json_object(
+                    nullptr, json_string.data(), json_string.size(), path_string, fntype,
+                    &document2);
+                rapidjson::StringBuffer buf2;
+                rapidjson::Writer<rapidjson::StringBuffer> writer2(buf2);
+                res2->Accept(writer2);
+
+                // the document isn't parsed beyond the value
+                if (json_string == json_strings[4] && path_string == "$.a.b") {
+                    ASSERT_EQ(std::string(buf1.GetString()), "null");
+                    ASSERT_EQ(std::string(buf2.GetString()), "1");
+                    continue;
+                }
+                ASSERT_EQ(std::string(buf1.GetString()), std::string(buf2.GetString()))
+                    << json_string << " " << path_string;
+            }
+        }
+    }
+}
+
 }
 
 int main(int argc, char** argv) {
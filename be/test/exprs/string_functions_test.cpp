@@ -16,10 +16,15 @@
 // under the License.
 
 #include "exprs/string_functions.h"
+#include "exprs/string_batch_functions.h"
 #include "util/logging.h"
 #include "exprs/anyval_util.h"
+#include "exprs/expr_column.h"
+#include "udf/udf_internal.h"
+#include <ctype.h>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -123,6 +128,103 @@ TEST_F(StringFunctionsTest, money_format_decimal_v2) {
     ASSERT_EQ(expected, result);
 }
 
+TEST_F(StringFunctionsTest, ascii_case_and_spaces) {
+    // all lengths around the 16 bytes blocks, with bytes from 0x80
+    const char chars[] = {'a', 'z', 'A', 'Z', '@', '[', '`', '{', ' ', '\xc3', '\x80', '0'};
+    for (int len = 0; len < 50; ++len) {
+        std::string str;
+        for (int i = 0; i < len; ++i) {
+            str.push_back(chars[(i * 7 + len) % sizeof(chars)]);
+        }
+        std::string lower(len, 0);
+        std::string upper(len, 0);
+        StringBatchFunctions::to_lower_ascii(str.data(), len, &lower[0]);
+        StringBatchFunctions::to_upper_ascii(str.data(), len, &upper[0]);
+        for (int i = 0; i < len; ++i) {
+            ASSERT_EQ((char)::tolower(str[i]), lower[i]);
+            ASSERT_EQ((char)::toupper(str[i]), upper[i]);
+        }
+
+        std::string spaces = std::string(len, ' ') + "x" + std::string(len / 2, ' ');
+        ASSERT_EQ(len, StringBatchFunctions::find_first_not_space(spaces.data(), spaces.size()));
+        ASSERT_EQ(len + 1, StringBatchFunctions::find_end_not_space(spaces.data(), spaces.size()));
+        ASSERT_EQ(len, StringBatchFunctions::find_first_not_space(spaces.data(), len));
+        ASSERT_EQ(0, StringBatchFunctions::find_end_not_space(spaces.data(), len));
+    }
+}
+
+TEST_F(StringFunctionsTest, batch) {
+    FunctionContext::TypeDesc string_type;
+    string_type.type = FunctionContext::TYPE_VARCHAR;
+    FunctionContext::TypeDesc int_type;
+    int_type.type = FunctionContext::TYPE_INT;
+
+    std::vector<std::string> strs = {"  hello  ", "", "world", " ab"};
+    ExprColumn input;
+    input.reset(TYPE_VARCHAR, strs.size());
+    for (int i = 0; i < strs.size(); ++i) {
+        input.values<StringValue>()[i] = StringValue(const_cast<char*>(strs[i].data()),
+                                                     strs[i].size());
+    }
+    input.nulls()[1] = 1;
+    ExprColumn result;
+
+    // substring(str, 2, 3) with constant position and length
+    doris_udf::FunctionContext* context = FunctionContextImpl::create_context(
+            NULL, NULL, string_type, {string_type, int_type, int_type}, 0, false);
+    IntVal pos(2);
+    IntVal len(3);
+    context->impl()->set_constant_args({NULL, &pos, &len});
+    ExprColumn* args[] = {&input, NULL, NULL};
+    result.reset(TYPE_VARCHAR, strs.size());
+    result.nulls()[1] = 1;
+    StringBatchFunctions::substring(context, args, NULL, strs.size(), &result);
+    ASSERT_EQ(" he", result.values<StringValue>()[0].to_string());
+    ASSERT_EQ("orl", result.values<StringValue>()[2].to_string());
+    ASSERT_EQ("ab", result.values<StringValue>()[3].to_string());
+    // views of the input
+    ASSERT_EQ(strs[2].data() + 1, result.values<StringValue>()[2].ptr);
+    ASSERT_FALSE(result.owns_string_data());
+    delete context;
+
+    // concat(str, '-', upper(str)) on the selected rows
+    context = FunctionContextImpl::create_context(
+            NULL, NULL, string_type, {string_type}, 0, false);
+    context->impl()->set_constant_args({NULL});
+    ExprColumn upper;
+    upper.reset(TYPE_VARCHAR, strs.size());
+    upper.nulls()[1] = 1;
+    StringBatchFunctions::upper(context, args, NULL, strs.size(), &upper);
+    ASSERT_TRUE(upper.owns_string_data());
+    delete context;
+
+    context = FunctionContextImpl::create_context(
+            NULL, NULL, string_type, {string_type, string_type, string_type}, 0, false);
+    StringVal dash("-");
+    context->impl()->set_constant_args({NULL, &dash, NULL});
+    ExprColumn* concat_args[] = {&input, NULL, &upper};
+    int sel[] = {0, 3};
+    result.reset(TYPE_VARCHAR, strs.size());
+    StringBatchFunctions::concat(context, concat_args, sel, 2, &result);
+    ASSERT_EQ("  hello  -  HELLO  ", result.values<StringValue>()[0].to_string());
+    ASSERT_EQ(" ab- AB", result.values<StringValue>()[3].to_string());
+    delete context;
+
+    // trim of strings owned by the argument column is copied
+    context = FunctionContextImpl::create_context(
+            NULL, NULL, string_type, {string_type}, 0, false);
+    context->impl()->set_constant_args({NULL});
+    ExprColumn* trim_args[] = {&upper};
+    result.reset(TYPE_VARCHAR, strs.size());
+    result.nulls()[1] = 1;
+    StringBatchFunctions::trim(context, trim_args, NULL, strs.size(), &result);
+    ASSERT_EQ("HELLO", result.values<StringValue>()[0].to_string());
+    ASSERT_EQ("WORLD", result.values<StringValue>()[2].to_string());
+    ASSERT_EQ("AB", result.values<StringValue>()[3].to_string());
+    ASSERT_TRUE(result.owns_string_data());
+    delete context;
+}
+
 }
 
 int main(int argc, char** argv) {
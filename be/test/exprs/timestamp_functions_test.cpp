@@ -0,0 +1,117 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/timestamp_functions.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "runtime/datetime_value.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TimestampFunctionsTest : public testing::Test {
+public:
+    TimestampFunctionsTest() { }
+
+protected:
+    static void SetUpTestCase() {
+        TimezoneDatabase::init();
+    }
+
+    std::string convert_tz(const std::string& value, const std::string& from,
+                           const std::string& to) {
+        DateTimeValue ts_value;
+        ts_value.from_date_str(value.data(), value.size());
+        DateTimeVal ts_val;
+        ts_value.to_datetime_val(&ts_val);
+        DateTimeVal result = TimestampFunctions::convert_tz(
+            _context, ts_val, StringVal(from.c_str()), StringVal(to.c_str()));
+        if (result.is_null) {
+            return "NULL";
+        }
+        char buf[64];
+        DateTimeValue::from_datetime_val(result).to_string(buf);
+        return buf;
+    }
+
+    FunctionContext* _context = FunctionContext::create_test_context();
+};
+
+TEST_F(TimestampFunctionsTest, utc_offset) {
+    const Timezone* new_york = TimezoneDatabase::find_timezone("America/New_York");
+    ASSERT_TRUE(new_york != NULL);
+    // DST starts at 2024-03-10 07:00:00 UTC and ends at 2024-11-03 06:00:00 UTC
+    ASSERT_EQ(-5 * 3600, new_york->utc_offset(1710053999));
+    ASSERT_EQ(-4 * 3600, new_york->utc_offset(1710054000));
+    ASSERT_EQ(-4 * 3600, new_york->utc_offset(1730613599));
+    ASSERT_EQ(-5 * 3600, new_york->utc_offset(1730613600));
+    // 2101-07-01 is beyond the table, it is from the rule
+    ASSERT_EQ(-4 * 3600, new_york->utc_offset(4149619200LL));
+
+    // DST over the turn of the year
+    const Timezone* sydney = TimezoneDatabase::find_timezone("Australia/Sydney");
+    ASSERT_TRUE(sydney != NULL);
+    ASSERT_EQ(11 * 3600, sydney->utc_offset(1704067200));
+    ASSERT_EQ(10 * 3600, sydney->utc_offset(1719792000));
+
+    const Timezone* shanghai = TimezoneDatabase::find_timezone("Asia/Shanghai");
+    ASSERT_TRUE(shanghai != NULL);
+    ASSERT_EQ(8 * 3600, shanghai->utc_offset(1719792000));
+
+    ASSERT_TRUE(TimezoneDatabase::find_timezone("Mars/Olympus") == NULL);
+    // abbreviations
+    ASSERT_TRUE(TimezoneDatabase::find_timezone("EDT") != NULL);
+}
+
+TEST_F(TimestampFunctionsTest, to_utc) {
+    const Timezone* new_york = TimezoneDatabase::find_timezone("America/New_York");
+    // 2024-03-10 02:30:00 is skipped, it is taken as standard time
+    int64_t local = 1710037800;
+    ASSERT_EQ(local + 5 * 3600, new_york->to_utc(local));
+    // 2024-11-03 01:30:00 happens twice, it is taken as DST
+    local = 1730597400;
+    ASSERT_EQ(local + 4 * 3600, new_york->to_utc(local));
+    for (int64_t utc = 1700000000; utc < 1740000000; utc += 3600 * 7 + 13) {
+        int64_t local_seconds = new_york->from_utc(utc);
+        int64_t back = new_york->to_utc(local_seconds);
+        // only the repeated hour is ambiguous
+        ASSERT_TRUE(back == utc || back == utc - 3600);
+    }
+}
+
+TEST_F(TimestampFunctionsTest, convert_tz) {
+    ASSERT_EQ("2024-07-01 20:00:00",
+              convert_tz("2024-07-01 08:00:00", "America/New_York", "Asia/Shanghai"));
+    ASSERT_EQ("2024-01-01 21:00:00",
+              convert_tz("2024-01-01 08:00:00", "America/New_York", "Asia/Shanghai"));
+    ASSERT_EQ("2024-07-01 12:00:00", convert_tz("2024-07-01 08:00:00", "+08:00", "+12:00"));
+    ASSERT_EQ("2024-06-30 23:30:00", convert_tz("2024-07-01 05:00:00", "+05:30", "UTC"));
+    ASSERT_EQ("2024-07-01 09:00:00", convert_tz("2024-07-01 08:00:00", "UTC", "Europe/London"));
+    ASSERT_EQ("NULL", convert_tz("2024-07-01 08:00:00", "Mars/Olympus", "UTC"));
+    ASSERT_EQ("NULL", convert_tz("2024-07-01 08:00:00", "UTC", "+25:00"));
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
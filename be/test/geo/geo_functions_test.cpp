@@ -320,6 +320,55 @@ TEST_F(GeoFunctionsTest, st_contains_cached) {
     GeoFunctions::st_contains_close(ctx, FunctionContext::FRAGMENT_LOCAL);
 }
 
+TEST_F(GeoFunctionsTest, st_contains_polygon_index) {
+    FunctionUtils utils;
+    FunctionContext* ctx = utils.get_fn_ctx();
+
+    std::string polygon_wkt = "POLYGON ((10 10, 50 10, 50 50, 30 20, 10 50, 10 10))";
+    auto polygon = GeoFunctions::st_from_wkt(ctx, StringVal((uint8_t*)polygon_wkt.data(), polygon_wkt.size()));
+    std::unique_ptr<GeoShape> shape(GeoShape::from_encoded(polygon.ptr, polygon.len));
+    ASSERT_NE(nullptr, shape);
+
+    std::vector<doris_udf::AnyVal*> const_vals;
+    const_vals.push_back(&polygon);
+    const_vals.push_back(nullptr);
+    ctx->impl()->set_constant_args(const_vals);
+    GeoFunctions::st_contains_prepare(ctx, FunctionContext::FRAGMENT_LOCAL);
+    ASSERT_NE(nullptr, ctx->get_function_state(FunctionContext::FRAGMENT_LOCAL));
+
+    // points inside, outside and near the edges give the same results as the
+    // exact test
+    int num_contained = 0;
+    for (double x = 0; x <= 60; x += 0.7) {
+        for (double y = 0; y <= 60; y += 0.7) {
+            auto point = GeoFunctions::st_point(ctx, DoubleVal(x), DoubleVal(y));
+            std::unique_ptr<GeoShape> point_shape(GeoShape::from_encoded(point.ptr, point.len));
+            ASSERT_NE(nullptr, point_shape);
+            auto res = GeoFunctions::st_contains(ctx, polygon, point);
+            ASSERT_FALSE(res.is_null);
+            ASSERT_EQ(shape->contains(point_shape.get()), res.val) << x << ", " << y;
+            num_contained += res.val;
+        }
+    }
+    ASSERT_GT(num_contained, 0);
+    GeoFunctions::st_contains_close(ctx, FunctionContext::FRAGMENT_LOCAL);
+}
+
+TEST_F(GeoFunctionsTest, st_cell_id) {
+    FunctionUtils utils;
+    FunctionContext* ctx = utils.get_fn_ctx();
+
+    auto id = GeoFunctions::st_cell_id(ctx, DoubleVal(113), DoubleVal(64));
+    ASSERT_FALSE(id.is_null);
+    auto near_id = GeoFunctions::st_cell_id(ctx, DoubleVal(113.000001), DoubleVal(64));
+    ASSERT_NE(id.val, near_id.val);
+    // the cells of both points share a long prefix
+    ASSERT_LT(std::abs(id.val - near_id.val), 1LL << 40);
+
+    ASSERT_TRUE(GeoFunctions::st_cell_id(ctx, DoubleVal(0), DoubleVal(91)).is_null);
+    ASSERT_TRUE(GeoFunctions::st_cell_id(ctx, DoubleVal::null(), DoubleVal(0)).is_null);
+}
+
 }
 
 int main(int argc, char* argv[]) {
@@ -109,6 +109,8 @@ TEST_F(HttpClientTest, get_normal) {
     st = client.execute();
     ASSERT_TRUE(st.ok());
     ASSERT_EQ(5, client.get_content_length());
+    ASSERT_EQ("text/plain; version=0.0.4", client.get_response_header("content-type"));
+    ASSERT_EQ("", client.get_response_header("Content-MD5"));
 }
 
 TEST_F(HttpClientTest, download) {
@@ -71,6 +71,27 @@ TEST_F(MetricsActionTest, prometheus_output) {
     action.handle(&request);
 }
 
+TEST_F(MetricsActionTest, prometheus_histogram) {
+    MetricRegistry registry("test");
+    Histogram latency;
+    latency.add(1);
+    latency.add(3);
+    latency.add(6);
+    registry.register_metric("latency_us", MetricLabels().add("type", "put"), &latency);
+    s_expect_response =
+        "# TYPE test_latency_us histogram\n"
+        "test_latency_us_bucket{type=\"put\",le=\"1\"} 0\n"
+        "test_latency_us_bucket{type=\"put\",le=\"2\"} 1\n"
+        "test_latency_us_bucket{type=\"put\",le=\"4\"} 2\n"
+        "test_latency_us_bucket{type=\"put\",le=\"8\"} 3\n"
+        "test_latency_us_bucket{type=\"put\",le=\"+Inf\"} 3\n"
+        "test_latency_us_sum{type=\"put\"} 10\n"
+        "test_latency_us_count{type=\"put\"} 3\n";
+    HttpRequest request(_evhttp_req);
+    MetricsAction action(&registry);
+    action.handle(&request);
+}
+
 TEST_F(MetricsActionTest, prometheus_no_prefix) {
     MetricRegistry registry("");
     IntGauge cpu_idle;
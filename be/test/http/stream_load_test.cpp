@@ -26,8 +26,10 @@
 #include "exec/schema_scanner/schema_helper.h"
 #include "gen_cpp/HeartbeatService_types.h"
 #include "http/http_channel.h"
+#include "http/http_common.h"
 #include "http/http_request.h"
 #include "runtime/exec_env.h"
+#include "runtime/stream_load/group_commit_mgr.h"
 #include "runtime/stream_load/load_stream_mgr.h"
 #include "runtime/stream_load/stream_load_executor.h"
 #include "runtime/thread_resource_mgr.h"
@@ -64,6 +66,7 @@ extern TLoadTxnCommitResult k_stream_load_commit_result;
 extern TLoadTxnRollbackResult k_stream_load_rollback_result;
 extern TStreamLoadPutResult k_stream_load_put_result;
 extern Status k_stream_load_plan_status;
+extern TStreamLoadPutResult k_group_commit_put_result;
 
 class StreamLoadActionTest : public testing::Test {
 public:
@@ -75,18 +78,24 @@ public:
         k_stream_load_rollback_result = TLoadTxnRollbackResult();
         k_stream_load_put_result = TStreamLoadPutResult();
         k_stream_load_plan_status = Status::OK;
+        k_group_commit_put_result = TStreamLoadPutResult();
         k_response_str = "";
         config::streaming_load_max_mb = 1;
+        config::group_commit_interval_ms = 10;
 
         _env._thread_mgr = new ThreadResourceMgr();
         _env._master_info = new TMasterInfo();
         _env._load_stream_mgr = new LoadStreamMgr();
         _env._brpc_stub_cache = new BrpcStubCache();
         _env._stream_load_executor = new StreamLoadExecutor(&_env);
+        _env._group_commit_mgr = new GroupCommitMgr(&_env);
+        _env._group_commit_mgr->start_bg_worker();
 
         _evhttp_req = evhttp_request_new(nullptr, nullptr);
     }
     void TearDown() override {
+        delete _env._group_commit_mgr;
+        _env._group_commit_mgr = nullptr;
         delete _env._brpc_stub_cache;
         _env._brpc_stub_cache = nullptr;
         delete _env._load_stream_mgr;
@@ -269,6 +278,49 @@ TEST_F(StreamLoadActionTest, plan_fail) {
     ASSERT_STREQ("Fail", doc["Status"].GetString());
 }
 
+TEST_F(StreamLoadActionTest, group_commit) {
+    DorisMetrics::instance()->initialize("StreamLoadActionTest");
+    StreamLoadAction action(&_env);
+    k_stream_load_begin_result.__set_txnId(100);
+
+    HttpRequest request(_evhttp_req);
+    struct evhttp_request ev_req;
+    ev_req.remote_host = nullptr;
+    request._ev_req = &ev_req;
+    request._headers.emplace(HttpHeaders::AUTHORIZATION, "Basic cm9vdDo=");
+    request._headers.emplace(HttpHeaders::CONTENT_LENGTH, "0");
+    request._headers.emplace(HTTP_GROUP_COMMIT, "true");
+    action.on_header(&request);
+    action.handle(&request);
+
+    rapidjson::Document doc;
+    doc.Parse(k_response_str.c_str());
+    ASSERT_STREQ("Success", doc["Status"].GetString());
+    ASSERT_EQ(100, doc["TxnId"].GetInt64());
+    ASSERT_TRUE(doc.HasMember("GroupCommitLabel"));
+}
+
+TEST_F(StreamLoadActionTest, group_commit_plan_fail) {
+    DorisMetrics::instance()->initialize("StreamLoadActionTest");
+    StreamLoadAction action(&_env);
+
+    HttpRequest request(_evhttp_req);
+    struct evhttp_request ev_req;
+    ev_req.remote_host = nullptr;
+    request._ev_req = &ev_req;
+    request._headers.emplace(HttpHeaders::AUTHORIZATION, "Basic cm9vdDo=");
+    request._headers.emplace(HttpHeaders::CONTENT_LENGTH, "0");
+    request._headers.emplace(HTTP_GROUP_COMMIT, "true");
+    Status status("TestFail");
+    status.to_thrift(&k_group_commit_put_result.status);
+    action.on_header(&request);
+    action.handle(&request);
+
+    rapidjson::Document doc;
+    doc.Parse(k_response_str.c_str());
+    ASSERT_STREQ("Fail", doc["Status"].GetString());
+}
+
 }
 
 int main(int argc, char* argv[]) {
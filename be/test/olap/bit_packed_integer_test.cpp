@@ -0,0 +1,249 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "olap/bit_packed_integer_reader.h"
+#include "olap/bit_packed_integer_writer.h"
+#include "olap/byte_buffer.h"
+#include "olap/in_stream.h"
+#include "olap/out_stream.h"
+#include "olap/stream_index_reader.h"
+#include "olap/stream_index_writer.h"
+#include "util/cpu_info.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestBitPackedInteger : public testing::Test {
+public:
+    virtual void SetUp() {
+        system("mkdir -p ./ut_dir");
+        system("rm -rf ./ut_dir/tmp_file");
+        _out_stream = new (std::nothrow) OutStream(OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE, NULL);
+        ASSERT_TRUE(_out_stream != NULL);
+        _writer = new (std::nothrow) BitPackedIntegerWriter(_out_stream);
+        ASSERT_TRUE(_writer != NULL);
+        _reader = NULL;
+        _shared_buffer = NULL;
+        _stream = NULL;
+    }
+
+    virtual void TearDown() {
+        SAFE_DELETE(_reader);
+        SAFE_DELETE(_out_stream);
+        SAFE_DELETE(_writer);
+        SAFE_DELETE(_shared_buffer);
+        SAFE_DELETE(_stream);
+    }
+
+    void CreateReader() {
+        ASSERT_EQ(OLAP_SUCCESS, helper.open_with_mode(_file_path.c_str(),
+                O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        _out_stream->write_to_file(&helper, 0);
+        helper.close();
+
+        ASSERT_EQ(OLAP_SUCCESS, helper.open_with_mode(_file_path.c_str(),
+                O_RDONLY, S_IRUSR | S_IWUSR));
+
+        _shared_buffer = StorageByteBuffer::create(
+                OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE + sizeof(StreamHead));
+        ASSERT_TRUE(_shared_buffer != NULL);
+
+        _stream = new (std::nothrow) ReadOnlyFileStream(
+                &helper,
+                &_shared_buffer,
+                0,
+                helper.length(),
+                NULL,
+                OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE,
+                &_stats);
+        ASSERT_EQ(OLAP_SUCCESS, _stream->init());
+
+        _reader = new (std::nothrow) BitPackedIntegerReader(_stream);
+        ASSERT_TRUE(_reader != NULL);
+    }
+
+    void WriteAndCheck(const std::vector<int64_t>& data) {
+        for (int64_t value : data) {
+            ASSERT_EQ(OLAP_SUCCESS, _writer->write(value));
+        }
+        ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+        CreateReader();
+
+        for (int64_t expected : data) {
+            ASSERT_TRUE(_reader->has_next());
+            int64_t value = 0;
+            ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+            ASSERT_EQ(expected, value);
+        }
+        ASSERT_FALSE(_reader->has_next());
+    }
+
+    BitPackedIntegerReader* _reader;
+    OutStream* _out_stream;
+    BitPackedIntegerWriter* _writer;
+    FileHandler helper;
+    StorageByteBuffer* _shared_buffer;
+    ReadOnlyFileStream* _stream;
+    OlapReaderStatistics _stats;
+
+    std::string _file_path = "./ut_dir/tmp_file";
+};
+
+TEST_F(TestBitPackedInteger, ReadWriteOneInteger) {
+    WriteAndCheck({100});
+}
+
+TEST_F(TestBitPackedInteger, ReadWriteFrameOfReference) {
+    // values around a large base, not sorted, so no delta
+    std::vector<int64_t> data;
+    for (int64_t i = 0; i < 1000; ++i) {
+        data.push_back(1000000007 + (i * 7919) % 1000);
+    }
+    WriteAndCheck(data);
+}
+
+TEST_F(TestBitPackedInteger, ReadWriteDelta) {
+    std::vector<int64_t> data;
+    for (int64_t i = 0; i < 1000; ++i) {
+        data.push_back(20180101000000L + i * 3 + (i & 1));
+    }
+    WriteAndCheck(data);
+}
+
+TEST_F(TestBitPackedInteger, ReadWriteConstant) {
+    WriteAndCheck(std::vector<int64_t>(300, -5));
+}
+
+TEST_F(TestBitPackedInteger, ReadWriteExtremeValues) {
+    std::vector<int64_t> data = {INT64_MIN, INT64_MAX, 0, -1, 1, INT64_MAX, INT64_MIN};
+    for (int64_t i = 0; i < 200; ++i) {
+        data.push_back(i % 2 == 0 ? INT64_MIN + i : INT64_MAX - i);
+    }
+    WriteAndCheck(data);
+}
+
+// one mini block for every bit width
+static std::vector<int64_t> all_bit_widths_data() {
+    std::vector<int64_t> data;
+    for (uint32_t width = 1; width <= 64; ++width) {
+        uint64_t max = width == 64 ? ~0ULL : (1ULL << width) - 1;
+        for (uint32_t i = 0; i < BitPackedIntegerWriter::MINI_BLOCK_SIZE; ++i) {
+            uint64_t value = i % 3 == 0 ? max : (i * 0x9E3779B97F4A7C15ULL) & max;
+            data.push_back(static_cast<int64_t>(value));
+        }
+        data.back() = 0;
+    }
+    return data;
+}
+
+TEST_F(TestBitPackedInteger, ReadWriteAllBitWidths) {
+    WriteAndCheck(all_bit_widths_data());
+}
+
+TEST_F(TestBitPackedInteger, ReadWriteAllBitWidthsWithoutAvx2) {
+    CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+    WriteAndCheck(all_bit_widths_data());
+}
+
+TEST_F(TestBitPackedInteger, NextBatch) {
+    std::vector<int64_t> data;
+    for (int64_t i = 0; i < 1000; ++i) {
+        data.push_back(i * i);
+    }
+    for (int64_t value : data) {
+        ASSERT_EQ(OLAP_SUCCESS, _writer->write(value));
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+    CreateReader();
+
+    int64_t value = 0;
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(0, value);
+    std::vector<int32_t> values(998);
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next_batch(values.data(), 998));
+    for (int64_t i = 0; i < 998; ++i) {
+        ASSERT_EQ(data[i + 1], values[i]);
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(data[999], value);
+    ASSERT_NE(OLAP_SUCCESS, _reader->next_batch(values.data(), 1));
+}
+
+TEST_F(TestBitPackedInteger, seek) {
+    // positions in the middle of a mini block and at its start
+    int64_t starts[] = {300, 0, 640};
+    PositionEntryWriter index_entries[3];
+    for (int64_t i = 0; i < 1000; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (i == starts[j]) {
+                _writer->get_position(&index_entries[j], false);
+            }
+        }
+        ASSERT_EQ(OLAP_SUCCESS, _writer->write(i * 10 + 3));
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+    CreateReader();
+
+    int64_t value = 0;
+    for (int j : {2, 0, 1}) {
+        PositionEntryReader entry;
+        entry._positions = index_entries[j]._positions;
+        entry._positions_count = index_entries[j]._positions_count;
+        entry._statistics.init(OLAP_FIELD_TYPE_INT, false);
+
+        PositionProvider position(&entry);
+        ASSERT_EQ(OLAP_SUCCESS, _reader->seek(&position));
+        for (int64_t i = starts[j]; i < starts[j] + 200; ++i) {
+            ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+            ASSERT_EQ(i * 10 + 3, value);
+        }
+    }
+}
+
+TEST_F(TestBitPackedInteger, skip) {
+    for (int64_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(OLAP_SUCCESS, _writer->write(-i));
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+    CreateReader();
+
+    int64_t value = 0;
+    ASSERT_EQ(OLAP_SUCCESS, _reader->skip(2));
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(-2, value);
+    ASSERT_EQ(OLAP_SUCCESS, _reader->skip(500));
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(-503, value);
+    ASSERT_EQ(OLAP_SUCCESS, _reader->skip(495));
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(-999, value);
+    ASSERT_NE(OLAP_SUCCESS, _reader->next(&value));
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    testing::InitGoogleTest(&argc, argv);
+    int ret = RUN_ALL_TESTS();
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
@@ -0,0 +1,163 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "olap/bitmap_index_reader.h"
+#include "olap/bitmap_index_writer.h"
+#include "olap/olap_cond.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestBitmapIndex : public testing::Test {
+public:
+    virtual ~TestBitmapIndex() {}
+
+protected:
+    // writes the index of 'writer' and opens 'reader' on it
+    void write_and_read(BitmapIndexWriter* writer, BitmapIndexReader* reader) {
+        std::string buffer;
+        ASSERT_EQ(OLAP_SUCCESS, writer->write_to_buffer(&buffer));
+        char* copy = new char[buffer.size()];
+        memcpy(copy, buffer.data(), buffer.size());
+        ASSERT_EQ(OLAP_SUCCESS, reader->init(copy, buffer.size(), false));
+    }
+};
+
+TEST_F(TestBitmapIndex, normal_read_and_write) {
+    BitmapIndexWriter writer(16);
+    std::string values[] = {"beijing", "shanghai", "shenzhen"};
+    for (uint32_t row = 0; row < 1000; ++row) {
+        if (row % 10 == 9) {
+            writer.add_null(row);
+        } else {
+            const std::string& value = values[row % 3];
+            writer.add(value.data(), value.size(), row);
+        }
+    }
+    ASSERT_TRUE(writer.is_valid());
+
+    BitmapIndexReader reader;
+    write_and_read(&writer, &reader);
+    ASSERT_EQ(3, reader.num_values());
+
+    RoaringBitmap rows;
+    ASSERT_EQ(OLAP_SUCCESS, reader.lookup(values[1].data(), values[1].size(), &rows));
+    for (uint32_t row = 0; row < 1000; ++row) {
+        ASSERT_EQ(row % 10 != 9 && row % 3 == 1, rows.contains(row)) << row;
+    }
+
+    // lookups add up
+    ASSERT_EQ(OLAP_SUCCESS, reader.lookup_null(&rows));
+    for (uint32_t row = 0; row < 1000; ++row) {
+        ASSERT_EQ(row % 10 == 9 || row % 3 == 1, rows.contains(row)) << row;
+    }
+
+    RoaringBitmap missing;
+    ASSERT_EQ(OLAP_SUCCESS, reader.lookup("hangzhou", 8, &missing));
+    ASSERT_EQ(0, missing.cardinality());
+}
+
+TEST_F(TestBitmapIndex, too_many_values) {
+    BitmapIndexWriter writer(8);
+    for (uint32_t row = 0; row < 9; ++row) {
+        writer.add(reinterpret_cast<const char*>(&row), sizeof(row), row);
+    }
+    ASSERT_FALSE(writer.is_valid());
+    std::string buffer;
+    ASSERT_NE(OLAP_SUCCESS, writer.write_to_buffer(&buffer));
+}
+
+TEST_F(TestBitmapIndex, invalid_buffer) {
+    BitmapIndexReader reader;
+    char* buffer = new char[6];
+    memset(buffer, 0xFF, 6);
+    ASSERT_NE(OLAP_SUCCESS, reader.init(buffer, 6, false));
+}
+
+TEST_F(TestBitmapIndex, eval_conditions) {
+    BitmapIndexWriter writer(16);
+    for (uint32_t row = 0; row < 100; ++row) {
+        if (row % 5 == 0) {
+            writer.add_null(row);
+        } else {
+            int32_t value = row % 4;
+            writer.add(reinterpret_cast<const char*>(&value), sizeof(value), row);
+        }
+    }
+    BitmapIndexReader reader;
+    write_and_read(&writer, &reader);
+
+    FieldInfo field_info;
+    field_info.name = "k1";
+    field_info.type = OLAP_FIELD_TYPE_INT;
+    field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+    field_info.length = 4;
+    field_info.is_allow_null = true;
+
+    TCondition eq;
+    eq.__set_column_name("k1");
+    eq.__set_condition_op("=");
+    eq.__set_condition_values({"2"});
+    Cond eq_cond;
+    ASSERT_EQ(OLAP_SUCCESS, eq_cond.init(eq, field_info));
+    RoaringBitmap rows;
+    ASSERT_TRUE(eq_cond.eval(reader, &rows));
+    for (uint32_t row = 0; row < 100; ++row) {
+        ASSERT_EQ(row % 5 != 0 && row % 4 == 2, rows.contains(row)) << row;
+    }
+
+    TCondition in;
+    in.__set_column_name("k1");
+    in.__set_condition_op("*=");
+    in.__set_condition_values({"1", "3", "7"});
+    Cond in_cond;
+    ASSERT_EQ(OLAP_SUCCESS, in_cond.init(in, field_info));
+    ASSERT_TRUE(in_cond.eval(reader, &rows));
+    for (uint32_t row = 0; row < 100; ++row) {
+        ASSERT_EQ(row % 5 != 0 && row % 2 == 1, rows.contains(row)) << row;
+    }
+
+    TCondition is_null;
+    is_null.__set_column_name("k1");
+    is_null.__set_condition_op("is");
+    is_null.__set_condition_values({"NULL"});
+    Cond null_cond;
+    ASSERT_EQ(OLAP_SUCCESS, null_cond.init(is_null, field_info));
+    ASSERT_TRUE(null_cond.eval(reader, &rows));
+    ASSERT_EQ(20, rows.cardinality());
+
+    // ranges are not told by the index
+    TCondition lt;
+    lt.__set_column_name("k1");
+    lt.__set_condition_op("<");
+    lt.__set_condition_values({"2"});
+    Cond lt_cond;
+    ASSERT_EQ(OLAP_SUCCESS, lt_cond.init(lt, field_info));
+    ASSERT_FALSE(lt_cond.eval(reader, &rows));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
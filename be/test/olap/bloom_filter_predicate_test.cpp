@@ -0,0 +1,153 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+#include <google/protobuf/stubs/common.h>
+
+#include "common/config.h"
+#include "olap/bloom_filter_predicate.h"
+#include "olap/field.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/string_value.hpp"
+#include "runtime/vectorized_row_batch.h"
+#include "util/cpu_info.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestBloomFilterPredicate : public testing::Test {
+public:
+    TestBloomFilterPredicate() : _vectorized_batch(NULL) {
+        _mem_tracker.reset(new MemTracker(-1));
+        _mem_pool.reset(new MemPool(_mem_tracker.get()));
+    }
+
+    ~TestBloomFilterPredicate() {
+        if (_vectorized_batch != NULL) {
+            delete _vectorized_batch;
+        }
+    }
+
+    void InitVectorizedBatch(FieldType type, int size) {
+        FieldInfo field_info;
+        field_info.name = "column";
+        field_info.type = type;
+        field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+        field_info.length = 1;
+        field_info.is_allow_null = true;
+        field_info.is_key = true;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        std::vector<FieldInfo> schema;
+        schema.push_back(field_info);
+        std::vector<uint32_t> return_columns;
+        return_columns.push_back(0);
+        _vectorized_batch = new VectorizedRowBatch(schema, return_columns, size);
+        _vectorized_batch->set_size(size);
+    }
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    std::unique_ptr<MemPool> _mem_pool;
+    VectorizedRowBatch* _vectorized_batch;
+};
+
+TEST_F(TestBloomFilterPredicate, INT_COLUMN) {
+    int size = 100;
+    InitVectorizedBatch(OLAP_FIELD_TYPE_INT, size);
+    ColumnVector* col_vector = _vectorized_batch->column(0);
+    col_vector->set_no_nulls(true);
+    int32_t* col_data = reinterpret_cast<int32_t*>(_mem_pool->allocate(size * sizeof(int32_t)));
+    col_vector->set_col_data(col_data);
+    for (int i = 0; i < size; ++i) {
+        col_data[i] = i;
+    }
+
+    std::shared_ptr<BloomFilter> bloom_filter(new BloomFilter());
+    ASSERT_TRUE(bloom_filter->init(1000, 0.0001));
+    for (int32_t value : {3, 50, 97, 1000}) {
+        bloom_filter->add_bytes(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    BloomFilterPredicate<int32_t> pred(0, bloom_filter);
+    pred.evaluate(_vectorized_batch);
+    ASSERT_EQ(3, _vectorized_batch->size());
+    uint16_t* sel = _vectorized_batch->selected();
+    ASSERT_EQ(3, col_data[sel[0]]);
+    ASSERT_EQ(50, col_data[sel[1]]);
+    ASSERT_EQ(97, col_data[sel[2]]);
+
+    // null rows are dropped
+    bool* is_null = reinterpret_cast<bool*>(_mem_pool->allocate(size));
+    memset(is_null, 0, size);
+    is_null[50] = true;
+    col_vector->set_no_nulls(false);
+    col_vector->set_is_null(is_null);
+    _vectorized_batch->set_size(size);
+    _vectorized_batch->set_selected_in_use(false);
+    pred.evaluate(_vectorized_batch);
+    ASSERT_EQ(2, _vectorized_batch->size());
+    sel = _vectorized_batch->selected();
+    ASSERT_EQ(3, col_data[sel[0]]);
+    ASSERT_EQ(97, col_data[sel[1]]);
+
+    // only selected rows are evaluated
+    pred.evaluate(_vectorized_batch);
+    ASSERT_EQ(2, _vectorized_batch->size());
+}
+
+TEST_F(TestBloomFilterPredicate, VARCHAR_COLUMN) {
+    int size = 4;
+    InitVectorizedBatch(OLAP_FIELD_TYPE_VARCHAR, size);
+    ColumnVector* col_vector = _vectorized_batch->column(0);
+    col_vector->set_no_nulls(true);
+    StringValue* col_data = reinterpret_cast<StringValue*>(
+        _mem_pool->allocate(size * sizeof(StringValue)));
+    col_vector->set_col_data(col_data);
+    const char* values[] = {"abc", "", "b", "xyz"};
+    for (int i = 0; i < size; ++i) {
+        col_data[i] = StringValue(const_cast<char*>(values[i]), strlen(values[i]));
+    }
+    // empty strings may have no buffer
+    col_data[1].ptr = nullptr;
+
+    std::shared_ptr<BloomFilter> bloom_filter(new BloomFilter());
+    ASSERT_TRUE(bloom_filter->init(1000, 0.0001));
+    bloom_filter->add_bytes("xyz", 3);
+    bloom_filter->add_bytes("", 0);
+    BloomFilterPredicate<StringValue> pred(0, bloom_filter);
+    pred.evaluate(_vectorized_batch);
+    ASSERT_EQ(2, _vectorized_batch->size());
+    uint16_t* sel = _vectorized_batch->selected();
+    ASSERT_EQ(1, sel[0]);
+    ASSERT_EQ(3, sel[1]);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    int ret = RUN_ALL_TESTS();
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
@@ -18,8 +18,10 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <vector>
 
 #include "olap/bloom_filter.hpp"
+#include "util/cpu_info.h"
 #include "util/logging.h"
 
 using std::string;
@@ -152,6 +154,104 @@ TEST_F(TestBloomFilter, bloom_filter_info) {
     LOG(WARNING) << "bytes=" << bytes << " points=" << points;
 }
 
+// The blocked layout rounds up to whole blocks and records no hash function
+TEST_F(TestBloomFilter, init_blocked_bloom_filter) {
+    BloomFilter bf;
+    ASSERT_TRUE(bf.init(1024, 0.05, true));
+    ASSERT_TRUE(bf.is_blocked());
+    ASSERT_EQ(0, bf.bit_num() % BLOOM_FILTER_BLOCK_BITS);
+    ASSERT_GE(bf.bit_num(), 6400);
+    ASSERT_EQ(BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM, bf.hash_function_num());
+
+    BloomFilter tiny;
+    ASSERT_TRUE(tiny.init(1, 0.5, true));
+    ASSERT_EQ(BLOOM_FILTER_BLOCK_BITS, tiny.bit_num());
+
+    // a buffer of the blocked layout holds whole blocks
+    BloomFilter read_bf;
+    ASSERT_FALSE(read_bf.init(new uint64_t[6], 6, BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM));
+    BloomFilter other_bf;
+    ASSERT_TRUE(other_bf.init(new uint64_t[8], 8, BLOCKED_BLOOM_FILTER_HASH_FUNCTION_NUM));
+    ASSERT_TRUE(other_bf.is_blocked());
+}
+
+static void check_blocked_bloom_filter() {
+    BloomFilter bf;
+    ASSERT_TRUE(bf.init(10000, 0.05, true));
+    for (int i = 0; i < 10000; ++i) {
+        bf.add_bytes(reinterpret_cast<const char*>(&i), sizeof(i));
+    }
+    bf.add_bytes(nullptr, 0);
+    ASSERT_TRUE(bf.test_bytes(nullptr, 0));
+
+    int false_positives = 0;
+    for (int i = 0; i < 20000; ++i) {
+        bool found = bf.test_bytes(reinterpret_cast<const char*>(&i), sizeof(i));
+        if (i < 10000) {
+            ASSERT_TRUE(found) << i;
+        } else {
+            false_positives += found;
+        }
+    }
+    ASSERT_LT(false_positives, 10000 * 0.1);
+
+    // batches find the same, and so does a filter on a copy of the bits
+    std::vector<uint64_t> hashes;
+    for (int i = 0; i < 1000; ++i) {
+        int value = i * 20;
+        hashes.push_back(BloomFilter::hash_bytes(
+                reinterpret_cast<const char*>(&value), sizeof(value)));
+    }
+    std::vector<uint8_t> results(hashes.size());
+    bf.test_hashes(hashes.data(), hashes.size(), results.data());
+    uint64_t* data = new uint64_t[bf.bit_set_data_len()];
+    memcpy(data, bf.bit_set_data(), bf.bit_set_data_len() * sizeof(uint64_t));
+    BloomFilter read_bf;
+    ASSERT_TRUE(read_bf.init(data, bf.bit_set_data_len(), bf.hash_function_num()));
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        ASSERT_EQ(bf.test_hash(hashes[i]), results[i]) << i;
+        ASSERT_EQ(bf.test_hash(hashes[i]), read_bf.test_hash(hashes[i])) << i;
+    }
+
+    BloomFilter other;
+    ASSERT_TRUE(other.init(10000, 0.05, true));
+    std::string bytes = "doris";
+    other.add_bytes(bytes.c_str(), bytes.size());
+    ASSERT_TRUE(bf.merge(other));
+    ASSERT_TRUE(bf.test_bytes(bytes.c_str(), bytes.size()));
+
+    // filters of different layouts are not merged
+    BloomFilter classic;
+    classic.init(10000, 0.05);
+    ASSERT_FALSE(bf.merge(classic));
+}
+
+TEST_F(TestBloomFilter, blocked_bloom_filter) {
+    check_blocked_bloom_filter();
+}
+
+TEST_F(TestBloomFilter, blocked_bloom_filter_without_avx2) {
+    CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+    check_blocked_bloom_filter();
+}
+
+// the bits set do not depend on the instructions used
+TEST_F(TestBloomFilter, blocked_bloom_filter_layout) {
+    BloomFilter with_avx2;
+    with_avx2.init(1024, 0.05, true);
+    BloomFilter without_avx2;
+    {
+        CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+        without_avx2.init(1024, 0.05, true);
+    }
+    for (int i = 0; i < 1024; ++i) {
+        with_avx2.add_bytes(reinterpret_cast<const char*>(&i), sizeof(i));
+        without_avx2.add_bytes(reinterpret_cast<const char*>(&i), sizeof(i));
+    }
+    ASSERT_EQ(0, memcmp(with_avx2.bit_set_data(), without_avx2.bit_set_data(),
+                        with_avx2.bit_set_data_len() * sizeof(uint64_t)));
+}
+
 } // namespace doris
 
 int main(int argc, char **argv) {
@@ -161,6 +261,7 @@ int main(int argc, char **argv) {
         return -1;
     }
     doris::init_glog("be-test");
+    doris::CpuInfo::init();
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
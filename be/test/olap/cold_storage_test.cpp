@@ -0,0 +1,259 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "boost/filesystem.hpp"
+#include "olap/cold_storage.h"
+#include "olap/file_helper.h"
+#include "olap/lru_cache.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class ColdStorageTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        if (boost::filesystem::exists(_s_test_data_path)) {
+            boost::filesystem::remove_all(_s_test_data_path);
+        }
+        ASSERT_TRUE(boost::filesystem::create_directory(_s_test_data_path));
+        ASSERT_TRUE(boost::filesystem::create_directory(_s_test_data_path + "/store"));
+        ASSERT_TRUE(boost::filesystem::create_directory(_s_test_data_path + "/cold"));
+        FileHandler::set_fd_cache(new_lru_cache(100));
+        ASSERT_EQ(OLAP_SUCCESS, ColdStorage::create(
+                "file://" + _s_test_data_path + "/cold", &_storage));
+    }
+
+    virtual void TearDown() {
+        delete FileHandler::get_fd_cache();
+        FileHandler::set_fd_cache(nullptr);
+        ASSERT_TRUE(boost::filesystem::remove_all(_s_test_data_path));
+    }
+
+    std::unique_ptr<ColdFileManager> create_manager(int64_t capacity) {
+        std::unique_ptr<ColdFileManager> manager(
+                new ColdFileManager(_storage.get(), _s_test_data_path + "/cache", capacity));
+        EXPECT_EQ(OLAP_SUCCESS, manager->init());
+        return manager;
+    }
+
+    // a file of 'size' bytes, its byte i being 'a' + i % 26
+    std::string write_file(const std::string& name, size_t size) {
+        std::string content(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            content[i] = 'a' + i % 26;
+        }
+        std::string path = _s_test_data_path + "/store/" + name;
+        FileHandler handler;
+        EXPECT_EQ(OLAP_SUCCESS, handler.open_with_mode(
+                path, O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        EXPECT_EQ(OLAP_SUCCESS, handler.write(content.data(), content.size()));
+        EXPECT_EQ(OLAP_SUCCESS, handler.close());
+        return content;
+    }
+
+    std::string store_path(const std::string& name) {
+        return _s_test_data_path + "/store/" + name;
+    }
+
+    std::string read_all(FileHandler* handler) {
+        std::string content(handler->length(), '\0');
+        EXPECT_EQ(OLAP_SUCCESS, handler->pread(&content[0], content.size(), 0));
+        return content;
+    }
+
+    std::string read_file(const std::string& path) {
+        FileHandler handler;
+        EXPECT_EQ(OLAP_SUCCESS, handler.open(path, O_RDONLY));
+        std::string content = read_all(&handler);
+        EXPECT_EQ(OLAP_SUCCESS, handler.close());
+        return content;
+    }
+
+    static std::string _s_test_data_path;
+    std::unique_ptr<ColdStorage> _storage;
+};
+
+std::string ColdStorageTest::_s_test_data_path = "./log/cold_storage_test";
+
+TEST_F(ColdStorageTest, OnlyFileUrisAreSupported) {
+    std::unique_ptr<ColdStorage> storage;
+    ASSERT_NE(OLAP_SUCCESS, ColdStorage::create("s3://bucket/cold", &storage));
+    ASSERT_NE(OLAP_SUCCESS, ColdStorage::create("file://", &storage));
+    ASSERT_NE(OLAP_SUCCESS, ColdStorage::create(
+            "file://" + _s_test_data_path + "/not_exist", &storage));
+}
+
+TEST_F(ColdStorageTest, LocalStorageUploadDownloadRemove) {
+    std::string content = write_file("0.dat", 5000);
+    ASSERT_EQ(OLAP_SUCCESS, _storage->upload(store_path("0.dat"), "10/20/0.dat"));
+    ASSERT_TRUE(boost::filesystem::exists(_s_test_data_path + "/cold/10/20/0.dat"));
+
+    std::string path = _s_test_data_path + "/downloaded.dat";
+    ASSERT_EQ(OLAP_SUCCESS, _storage->download("10/20/0.dat", path));
+    ASSERT_EQ(content, read_file(path));
+
+    ASSERT_EQ(OLAP_SUCCESS, _storage->remove("10/20/0.dat"));
+    ASSERT_FALSE(boost::filesystem::exists(_s_test_data_path + "/cold/10/20/0.dat"));
+    ASSERT_EQ(OLAP_SUCCESS, _storage->remove("10/20/0.dat"));
+    ASSERT_NE(OLAP_SUCCESS, _storage->download("10/20/0.dat", path + ".1"));
+}
+
+TEST_F(ColdStorageTest, OffloadKeepsHeaderAndLength) {
+    std::unique_ptr<ColdFileManager> manager = create_manager(1 << 20);
+    std::string content = write_file("0.dat", 10000);
+    std::string path = store_path("0.dat");
+    // opened before, it keeps reading the whole file
+    FileHandler opened;
+    ASSERT_EQ(OLAP_SUCCESS, opened.open(path, O_RDONLY));
+    ASSERT_FALSE(manager->is_cold(path));
+
+    int64_t released_bytes = 0;
+    ASSERT_EQ(OLAP_SUCCESS, manager->offload(path, "10/20/0.dat", 100, &released_bytes));
+    ASSERT_EQ(9900, released_bytes);
+    ASSERT_TRUE(manager->is_cold(path));
+    ASSERT_TRUE(boost::filesystem::exists(cold_marker_path(path)));
+
+    std::string local = read_file(path);
+    ASSERT_EQ(content.size(), local.size());
+    ASSERT_EQ(content.substr(0, 100), local.substr(0, 100));
+    ASSERT_EQ(std::string(9900, '\0'), local.substr(100));
+    ASSERT_EQ(content, read_all(&opened));
+    ASSERT_EQ(OLAP_SUCCESS, opened.close());
+
+    // moved once
+    ASSERT_EQ(OLAP_SUCCESS, manager->offload(path, "10/20/0.dat", 100, &released_bytes));
+    ASSERT_EQ(9900, released_bytes);
+}
+
+TEST_F(ColdStorageTest, FilesNotLargerThanHeaderAreKept) {
+    std::unique_ptr<ColdFileManager> manager = create_manager(1 << 20);
+    write_file("0.dat", 100);
+    int64_t released_bytes = 0;
+    ASSERT_EQ(OLAP_SUCCESS, manager->offload(store_path("0.dat"), "0.dat", 100, &released_bytes));
+    ASSERT_EQ(0, released_bytes);
+    ASSERT_FALSE(manager->is_cold(store_path("0.dat")));
+    ASSERT_FALSE(boost::filesystem::exists(_s_test_data_path + "/cold/0.dat"));
+}
+
+TEST_F(ColdStorageTest, OpenReadsColdFilesFromCache) {
+    std::unique_ptr<ColdFileManager> manager = create_manager(1 << 20);
+    std::string hot_content = write_file("hot.dat", 1000);
+    std::string cold_content = write_file("cold.dat", 10000);
+    int64_t released_bytes = 0;
+    ASSERT_EQ(OLAP_SUCCESS, manager->offload(
+            store_path("cold.dat"), "10/20/cold.dat", 100, &released_bytes));
+
+    FileHandler hot;
+    ASSERT_EQ(OLAP_SUCCESS, manager->open(store_path("hot.dat"), &hot));
+    ASSERT_EQ(store_path("hot.dat"), hot.file_name());
+    ASSERT_EQ(hot_content, read_all(&hot));
+    ASSERT_EQ(0, manager->cache_size());
+
+    for (int i = 0; i < 2; ++i) {
+        FileHandler cold;
+        ASSERT_EQ(OLAP_SUCCESS, manager->open(store_path("cold.dat"), &cold));
+        ASSERT_EQ(_s_test_data_path + "/cache/10_20_cold.dat", cold.file_name());
+        ASSERT_EQ(cold_content, read_all(&cold));
+        ASSERT_EQ(10000, manager->cache_size());
+        ASSERT_EQ(OLAP_SUCCESS, cold.close());
+    }
+
+    std::string restored_path = _s_test_data_path + "/restored.dat";
+    ASSERT_EQ(OLAP_SUCCESS, manager->restore(store_path("cold.dat"), restored_path));
+    ASSERT_EQ(cold_content, read_file(restored_path));
+}
+
+TEST_F(ColdStorageTest, LeastRecentlyReadCopiesAreEvicted) {
+    std::unique_ptr<ColdFileManager> manager = create_manager(25000);
+    std::string contents[3];
+    int64_t released_bytes = 0;
+    for (int i = 0; i < 3; ++i) {
+        std::string name = std::to_string(i) + ".dat";
+        contents[i] = write_file(name, 10000);
+        ASSERT_EQ(OLAP_SUCCESS, manager->offload(store_path(name), name, 100, &released_bytes));
+    }
+    for (int i : {0, 1, 0, 2}) {
+        FileHandler handler;
+        ASSERT_EQ(OLAP_SUCCESS, manager->open(store_path(std::to_string(i) + ".dat"), &handler));
+        ASSERT_EQ(contents[i], read_all(&handler));
+    }
+    // 1 was read the least recently
+    ASSERT_EQ(20000, manager->cache_size());
+    ASSERT_TRUE(boost::filesystem::exists(_s_test_data_path + "/cache/0.dat"));
+    ASSERT_FALSE(boost::filesystem::exists(_s_test_data_path + "/cache/1.dat"));
+    ASSERT_TRUE(boost::filesystem::exists(_s_test_data_path + "/cache/2.dat"));
+
+    FileHandler handler;
+    ASSERT_EQ(OLAP_SUCCESS, manager->open(store_path("1.dat"), &handler));
+    ASSERT_EQ(contents[1], read_all(&handler));
+    ASSERT_FALSE(boost::filesystem::exists(_s_test_data_path + "/cache/0.dat"));
+}
+
+TEST_F(ColdStorageTest, ReleaseRemovesColdFileWithLastLink) {
+    std::unique_ptr<ColdFileManager> manager = create_manager(1 << 20);
+    write_file("0.dat", 10000);
+    std::string path = store_path("0.dat");
+    int64_t released_bytes = 0;
+    ASSERT_EQ(OLAP_SUCCESS, manager->offload(path, "10/20/0.dat", 100, &released_bytes));
+    FileHandler handler;
+    ASSERT_EQ(OLAP_SUCCESS, manager->open(path, &handler));
+    ASSERT_EQ(OLAP_SUCCESS, handler.close());
+
+    // as linked by a schema change
+    std::string linked_path = store_path("1.dat");
+    ASSERT_EQ(0, link(path.c_str(), linked_path.c_str()));
+    ASSERT_EQ(0, link(cold_marker_path(path).c_str(), cold_marker_path(linked_path).c_str()));
+
+    ASSERT_EQ(0, remove(path.c_str()));
+    manager->release(path);
+    ASSERT_FALSE(boost::filesystem::exists(cold_marker_path(path)));
+    ASSERT_TRUE(boost::filesystem::exists(_s_test_data_path + "/cold/10/20/0.dat"));
+    ASSERT_EQ(10000, manager->cache_size());
+    ASSERT_TRUE(manager->is_cold(linked_path));
+
+    ASSERT_EQ(0, remove(linked_path.c_str()));
+    manager->release(linked_path);
+    ASSERT_FALSE(boost::filesystem::exists(cold_marker_path(linked_path)));
+    ASSERT_FALSE(boost::filesystem::exists(_s_test_data_path + "/cold/10/20/0.dat"));
+    ASSERT_EQ(0, manager->cache_size());
+    ASSERT_FALSE(boost::filesystem::exists(_s_test_data_path + "/cache/10_20_0.dat"));
+
+    // files never moved have no marker
+    write_file("2.dat", 10);
+    manager->release(store_path("2.dat"));
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,185 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/column_distribution.h"
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "util/cpu_info.h"
+#include "util/slice.h"
+
+namespace doris {
+
+class ColumnDistributionTest : public testing::Test {
+public:
+    static FieldInfo make_field(const std::string& name, FieldType type, uint32_t length) {
+        FieldInfo field_info;
+        field_info.name = name;
+        field_info.type = type;
+        field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+        field_info.length = length;
+        field_info.is_allow_null = true;
+        field_info.is_key = true;
+        field_info.unique_id = 3;
+        field_info.is_bf_column = false;
+        return field_info;
+    }
+
+    static void add_int(ColumnDistributionCollector* collector, int32_t value) {
+        char cell[1 + sizeof(int32_t)];
+        cell[0] = 0;
+        memcpy(cell + 1, &value, sizeof(value));
+        collector->add(cell);
+    }
+
+    static void add_null(ColumnDistributionCollector* collector) {
+        char cell[1 + sizeof(Slice)];
+        cell[0] = 1;
+        collector->add(cell);
+    }
+
+    static void add_string(ColumnDistributionCollector* collector, const std::string& value) {
+        char cell[1 + sizeof(Slice)];
+        cell[0] = 0;
+        Slice slice(value);
+        memcpy(cell + 1, &slice, sizeof(slice));
+        collector->add(cell);
+    }
+
+    static int64_t sum(const std::vector<int64_t>& counts) {
+        int64_t total = 0;
+        for (int64_t count : counts) {
+            total += count;
+        }
+        return total;
+    }
+};
+
+TEST_F(ColumnDistributionTest, collect_and_merge) {
+    FieldInfo field_info = make_field("k1", OLAP_FIELD_TYPE_INT, 4);
+    ASSERT_TRUE(has_column_distribution(field_info));
+    ASSERT_FALSE(has_column_distribution(make_field("h", OLAP_FIELD_TYPE_HLL, 16385)));
+
+    ColumnDistribution first;
+    {
+        ColumnDistributionCollector collector(field_info);
+        for (int i = 0; i < 10000; ++i) {
+            add_int(&collector, i % 1000);
+        }
+        for (int i = 0; i < 100; ++i) {
+            add_null(&collector);
+        }
+        collector.finish(&first);
+    }
+    ASSERT_EQ(3, first.column_unique_id());
+    ASSERT_EQ(10100, first.num_rows());
+    ASSERT_EQ(100, first.null_count());
+    ASSERT_FALSE(first.hll().empty());
+    ASSERT_EQ(first.histogram_bound_size(), first.histogram_count_size());
+    ASSERT_LE(first.histogram_bound_size(), config::column_histogram_buckets);
+    ASSERT_EQ("999", first.histogram_bound(first.histogram_bound_size() - 1));
+    int64_t rows = 0;
+    for (int64_t count : first.histogram_count()) {
+        rows += count;
+    }
+    ASSERT_EQ(10000, rows);
+
+    ColumnDistribution second;
+    {
+        ColumnDistributionCollector collector(field_info);
+        for (int i = 500; i < 1500; ++i) {
+            add_int(&collector, i);
+        }
+        collector.finish(&second);
+    }
+
+    ColumnDistributionMerger merger(field_info);
+    merger.merge(first);
+    merger.merge(second);
+    TColumnDistribution merged;
+    merger.finish(&merged);
+    ASSERT_EQ("k1", merged.column_name);
+    ASSERT_EQ(11100, merged.num_rows);
+    ASSERT_EQ(100, merged.null_count);
+    ASSERT_NEAR(1500, merged.ndv, 1500 * 0.05);
+    ASSERT_EQ(merged.histogram_bounds.size(), merged.histogram_counts.size());
+    ASSERT_LE(merged.histogram_bounds.size(), config::column_histogram_buckets);
+    ASSERT_EQ("1499", merged.histogram_bounds.back());
+    ASSERT_EQ(11000, sum(merged.histogram_counts));
+}
+
+TEST_F(ColumnDistributionTest, few_distinct_strings) {
+    FieldInfo field_info = make_field("k2", OLAP_FIELD_TYPE_VARCHAR, 22);
+    std::vector<std::string> values = {"a", "bb", "ccc", "dddd", "eeeee"};
+    ColumnDistribution distribution;
+    {
+        ColumnDistributionCollector collector(field_info);
+        for (int i = 0; i < 3000; ++i) {
+            // every value but "a" once in a while
+            add_string(&collector, i % 100 == 0 ? values[1 + i / 100 % 4] : values[0]);
+        }
+        collector.finish(&distribution);
+    }
+    // one frequent value has one bucket, not all of them
+    ASSERT_LE(distribution.histogram_bound_size(), 5);
+    ASSERT_EQ("a", distribution.histogram_bound(0));
+
+    ColumnDistributionMerger merger(field_info);
+    merger.merge(distribution);
+    TColumnDistribution merged;
+    merger.finish(&merged);
+    // few hashes are kept explicitly, so they are counted exactly
+    ASSERT_EQ(5, merged.ndv);
+    ASSERT_EQ(3000, sum(merged.histogram_counts));
+    for (size_t i = 1; i < merged.histogram_bounds.size(); ++i) {
+        ASSERT_LT(merged.histogram_bounds[i - 1], merged.histogram_bounds[i]);
+    }
+}
+
+TEST_F(ColumnDistributionTest, only_nulls) {
+    FieldInfo field_info = make_field("k1", OLAP_FIELD_TYPE_INT, 4);
+    ColumnDistribution distribution;
+    {
+        ColumnDistributionCollector collector(field_info);
+        add_null(&collector);
+        collector.finish(&distribution);
+    }
+    ASSERT_EQ(1, distribution.null_count());
+    ASSERT_TRUE(distribution.hll().empty());
+    ASSERT_EQ(0, distribution.histogram_bound_size());
+
+    ColumnDistributionMerger merger(field_info);
+    merger.merge(distribution);
+    TColumnDistribution merged;
+    merger.finish(&merged);
+    ASSERT_EQ(0, merged.ndv);
+    ASSERT_TRUE(merged.histogram_bounds.empty());
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
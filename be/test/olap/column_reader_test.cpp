@@ -1206,6 +1206,131 @@ TEST_F(TestColumn, VectorizedIntColumnMassWithoutPresent) {
     }
 }
 
+TEST_F(TestColumn, VectorizedAdaptiveIntColumnWithoutPresent) {
+    // write data
+    std::vector<FieldInfo> tablet_schema;
+    FieldInfo field_info;
+    SetFieldInfo(field_info,
+                 std::string("IntColumn"), 
+                 OLAP_FIELD_TYPE_INT, 
+                 OLAP_FIELD_AGGREGATION_REPLACE, 
+                 4, 
+                 false,
+                 true);
+    tablet_schema.push_back(field_info);
+
+    // the writer reads the config when it is created
+    config::enable_adaptive_integer_encoding = true;
+    CreateColumnWriter(tablet_schema);
+    config::enable_adaptive_integer_encoding = false;
+    
+    RowCursor write_row;
+    write_row.init(tablet_schema);
+
+    RowBlock block(tablet_schema);
+    RowBlockInfo block_info;
+    block_info.row_num = 10000;
+    block.init(block_info);
+
+    for (int32_t i = 0; i < 10000; i++) {
+        int32_t value = i * 7 + (i % 3 == 0 ? 1000000 : 0);
+        write_row.set_field_content(0, reinterpret_cast<char *>(&value), _mem_pool.get());
+        block.set_row(i, write_row);
+    }
+    block.finalize(10000);
+    ASSERT_EQ(_column_writer->write_batch(&block, &write_row), OLAP_SUCCESS);
+
+    ColumnDataHeaderMessage header;
+    ASSERT_EQ(_column_writer->finalize(&header), OLAP_SUCCESS);
+
+    // the sample stats are saved with the chosen encoding
+    ASSERT_EQ(1, header.column_encoding_size());
+    ASSERT_GT(header.column_encoding(0).sample_bits_per_value(), 0);
+    ASSERT_GT(header.column_encoding(0).sample_decode_ns_per_value(), 0);
+
+    // read data
+    UniqueIdEncodingMap encodings;
+    encodings[0] = header.column_encoding(0);
+    CreateColumnReader(tablet_schema, encodings);
+    
+    _col_vector.reset(new ColumnVector());
+
+    char* data = NULL; 
+    for (int32_t i = 0; i < 10000; ++i) {
+        if (i % 1000 == 0) {
+            ASSERT_EQ(_column_reader->next_vector(
+                _col_vector.get(), 1000, _mem_pool.get()), OLAP_SUCCESS);
+            data = reinterpret_cast<char*>(_col_vector->col_data());
+        }
+
+        int32_t value = *reinterpret_cast<int*>(data);
+        ASSERT_EQ(value, i * 7 + (i % 3 == 0 ? 1000000 : 0));
+        data += sizeof(int32_t);
+    }
+}
+
+TEST_F(TestColumn, VectorizedIntColumnReadAsBigInt) {
+    // write data
+    std::vector<FieldInfo> tablet_schema;
+    FieldInfo field_info;
+    SetFieldInfo(field_info,
+                 std::string("IntColumn"), 
+                 OLAP_FIELD_TYPE_INT, 
+                 OLAP_FIELD_AGGREGATION_REPLACE, 
+                 4, 
+                 false,
+                 true);
+    tablet_schema.push_back(field_info);
+
+    CreateColumnWriter(tablet_schema);
+    
+    RowCursor write_row;
+    write_row.init(tablet_schema);
+
+    RowBlock block(tablet_schema);
+    RowBlockInfo block_info;
+    block_info.row_num = 10000;
+    block.init(block_info);
+
+    for (int32_t i = 0; i < 10000; i++) {
+        int32_t value = i % 2 == 0 ? INT32_MIN + i : INT32_MAX - i;
+        write_row.set_field_content(0, reinterpret_cast<char *>(&value), _mem_pool.get());
+        block.set_row(i, write_row);
+    }
+    block.finalize(10000);
+    ASSERT_EQ(_column_writer->write_batch(&block, &write_row), OLAP_SUCCESS);
+
+    ColumnDataHeaderMessage header;
+    ASSERT_EQ(_column_writer->finalize(&header), OLAP_SUCCESS);
+
+    // the column is widened by a linked schema change, the data is read as it is
+    std::vector<FieldInfo> widened_schema;
+    SetFieldInfo(field_info,
+                 std::string("IntColumn"), 
+                 OLAP_FIELD_TYPE_BIGINT, 
+                 OLAP_FIELD_AGGREGATION_REPLACE, 
+                 8, 
+                 false,
+                 true);
+    widened_schema.push_back(field_info);
+    CreateColumnReader(widened_schema);
+    
+    _col_vector.reset(new ColumnVector());
+
+    char* data = NULL; 
+    for (int32_t i = 0; i < 10000; ++i) {
+        if (i % 1000 == 0) {
+            ASSERT_EQ(_column_reader->next_vector(
+                _col_vector.get(), 1000, _mem_pool.get()), OLAP_SUCCESS);
+            data = reinterpret_cast<char*>(_col_vector->col_data());
+        }
+
+        int64_t value = *reinterpret_cast<int64_t*>(data);
+        ASSERT_EQ(value, i % 2 == 0 ? INT32_MIN + i : INT32_MAX - i);
+        data += sizeof(int64_t);
+    }
+}
+
 TEST_F(TestColumn, VectorizedIntColumnWithPresent) {
     // write data
     std::vector<FieldInfo> tablet_schema;
@@ -1670,6 +1795,54 @@ TEST_F(TestColumn, VectorizedDoubleColumnWithoutPresent) {
     ASSERT_DOUBLE_EQ(value, 3.23456789); 
 }
 
+TEST_F(TestColumn, VectorizedDoubleColumnMassWithoutPresent) {
+    // write data
+    std::vector<FieldInfo> tablet_schema;
+    FieldInfo field_info;
+    SetFieldInfo(field_info,
+                 std::string("DoubleColumnMassWithoutPresent"),
+                 OLAP_FIELD_TYPE_DOUBLE,
+                 OLAP_FIELD_AGGREGATION_REPLACE,
+                 8,
+                 false,
+                 true);
+    tablet_schema.push_back(field_info);
+
+    CreateColumnWriter(tablet_schema);
+
+    RowCursor write_row;
+    write_row.init(tablet_schema);
+
+    RowBlock block(tablet_schema);
+    RowBlockInfo block_info;
+    block_info.row_num = 10000;
+    block.init(block_info);
+
+    for (int32_t i = 0; i < 10000; i++) {
+        double value = i * 0.5;
+        write_row.set_field_content(0, reinterpret_cast<char *>(&value), _mem_pool.get());
+        block.set_row(i, write_row);
+    }
+    block.finalize(10000);
+    ASSERT_EQ(_column_writer->write_batch(&block, &write_row), OLAP_SUCCESS);
+
+    ColumnDataHeaderMessage header;
+    ASSERT_EQ(_column_writer->finalize(&header), OLAP_SUCCESS);
+
+    // read data, batches refer to chunks of the stream or span two of them
+    CreateColumnReader(tablet_schema);
+
+    _col_vector.reset(new ColumnVector());
+    for (int32_t i = 0; i < 10000; i += 1000) {
+        ASSERT_EQ(_column_reader->next_vector(
+            _col_vector.get(), 1000, _mem_pool.get()), OLAP_SUCCESS);
+        const double* data = reinterpret_cast<const double*>(_col_vector->col_data());
+        for (int32_t j = 0; j < 1000; ++j) {
+            ASSERT_DOUBLE_EQ((i + j) * 0.5, data[j]);
+        }
+    }
+}
+
 TEST_F(TestColumn, VectorizedDoubleColumnWithPresent) {
     // write data
     std::vector<FieldInfo> tablet_schema;
@@ -3004,6 +3177,78 @@ TEST_F(TestColumn, VectorizedStringColumnWithoutoutPresent2) {
     ASSERT_TRUE(strncmp(value->data, "ddddd", value->size) == 0);
 }
 
+TEST_F(TestColumn, VectorizedDictionaryStringColumnAcrossBatches) {
+    // write data
+    std::vector<FieldInfo> tablet_schema;
+    FieldInfo field_info;
+    SetFieldInfo(field_info,
+                 std::string("DictionaryVarcharColumn"),
+                 OLAP_FIELD_TYPE_VARCHAR,
+                 OLAP_FIELD_AGGREGATION_REPLACE,
+                 10,
+                 false,
+                 true);
+    tablet_schema.push_back(field_info);
+
+    CreateColumnWriter(tablet_schema);
+
+    RowCursor write_row;
+    write_row.init(tablet_schema);
+    write_row.allocate_memory_for_string_type(tablet_schema);
+
+    RowBlock block(tablet_schema);
+    RowBlockInfo block_info;
+    block_info.row_num = 10000;
+    block.init(block_info);
+
+    // the entries are sorted: "a" is 0, "bb" 1 and "ccc" 2
+    std::vector<string> values = {"a", "bb", "ccc"};
+    for (int i = 0; i < 20; ++i) {
+        values.push_back(i % 5 == 0 || i % 5 == 3 ? "bb" : "a");
+    }
+    for (const string& value : values) {
+        std::vector<string> val_string_array = {value};
+        OlapTuple tuple(val_string_array);
+        write_row.from_tuple(tuple);
+        block.set_row(0, write_row);
+        block.finalize(1);
+        ASSERT_EQ(_column_writer->write_batch(&block, &write_row), OLAP_SUCCESS);
+    }
+
+    ColumnDataHeaderMessage header;
+    ASSERT_EQ(_column_writer->finalize(&header), OLAP_SUCCESS);
+
+    UniqueIdEncodingMap encodings;
+    encodings[0] = ColumnEncodingMessage();
+    _column_writer->save_encoding(&encodings[0]);
+    ASSERT_EQ(ColumnEncodingMessage::DICTIONARY, encodings[0].kind());
+    ASSERT_EQ(3, encodings[0].dictionary_size());
+
+    // read data, a reader knowing the first two entries only fails on "ccc"
+    // after it copied "a" and "bb"
+    encodings[0].set_dictionary_size(2);
+    CreateColumnReader(tablet_schema, encodings);
+
+    _col_vector.reset(new ColumnVector());
+    ASSERT_EQ(_column_reader->next_vector(
+        _col_vector.get(), 3, _mem_pool.get()), OLAP_ERR_BUFFER_OVERFLOW);
+
+    // the entries are copied again by the next batches, each batch has its copies
+    const char* last_copy = nullptr;
+    for (int row = 3; row + 5 <= values.size(); row += 5) {
+        ASSERT_EQ(_column_reader->next_vector(
+            _col_vector.get(), 5, _mem_pool.get()), OLAP_SUCCESS);
+        Slice* value = reinterpret_cast<Slice*>(_col_vector->col_data());
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_EQ(values[row + i], string(value[i].data, value[i].size));
+        }
+        // rows 1 and 2 of the batches are "a"
+        ASSERT_EQ(value[1].data, value[2].data);
+        ASSERT_NE(last_copy, value[1].data);
+        last_copy = value[1].data;
+    }
+}
+
 TEST_F(TestColumn, VectorizedDirectVarcharColumnWith65533) {
     // write data
     std::vector<FieldInfo> tablet_schema;
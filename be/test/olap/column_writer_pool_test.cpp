@@ -0,0 +1,94 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "olap/column_writer_pool.h"
+#include "util/logging.h"
+
+namespace doris {
+
+TEST(ColumnWriterPoolTest, RunAllTasks) {
+    ColumnWriterPool pool(4);
+    ASSERT_EQ(OLAP_SUCCESS, pool.run({}));
+
+    std::vector<int> done(100, 0);
+    std::vector<ColumnWriterPool::Task> tasks;
+    for (int i = 0; i < 100; ++i) {
+        tasks.push_back([&done, i]() {
+            done[i]++;
+            return OLAP_SUCCESS;
+        });
+    }
+    ASSERT_EQ(OLAP_SUCCESS, pool.run(tasks));
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(1, done[i]);
+    }
+}
+
+TEST(ColumnWriterPoolTest, FirstError) {
+    ColumnWriterPool pool(2);
+    std::atomic<int> num_done(0);
+    std::vector<ColumnWriterPool::Task> tasks;
+    for (int i = 0; i < 10; ++i) {
+        tasks.push_back([&num_done, i]() {
+            num_done++;
+            if (i == 3) {
+                return OLAP_ERR_WRITE_PROTOBUF_ERROR;
+            } else if (i == 7) {
+                return OLAP_ERR_MALLOC_ERROR;
+            }
+            return OLAP_SUCCESS;
+        });
+    }
+    // all tasks are run even after one failed
+    ASSERT_EQ(OLAP_ERR_WRITE_PROTOBUF_ERROR, pool.run(tasks));
+    ASSERT_EQ(10, num_done);
+}
+
+TEST(ColumnWriterPoolTest, ConcurrentRuns) {
+    // more callers than threads, callers run their own tasks if threads are busy
+    ColumnWriterPool pool(1);
+    std::vector<std::thread> callers;
+    std::atomic<int> num_done(0);
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&pool, &num_done]() {
+            for (int j = 0; j < 50; ++j) {
+                std::vector<ColumnWriterPool::Task> tasks(8, [&num_done]() {
+                    num_done++;
+                    return OLAP_SUCCESS;
+                });
+                ASSERT_EQ(OLAP_SUCCESS, pool.run(tasks));
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    ASSERT_EQ(4 * 50 * 8, num_done);
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -25,6 +25,7 @@
 #include "runtime/mem_pool.h"
 #include "runtime/string_value.hpp"
 #include "runtime/vectorized_row_batch.h"
+#include "util/cpu_info.h"
 #include "util/logging.h"
 
 namespace doris {
@@ -397,6 +398,66 @@ TEST_F(TestEqualPredicate, STRING_COLUMN) {
     ASSERT_EQ(*(col_data + sel[0]), value);
 }
 
+TEST_F(TestEqualPredicate, STRING_DICT_COLUMN) {
+    std::vector<FieldInfo> schema;
+    FieldInfo field_info;
+    SetFieldInfo(field_info, std::string("STRING_COLUMN"), OLAP_FIELD_TYPE_VARCHAR,
+                 OLAP_FIELD_AGGREGATION_REPLACE, 1, false, true);
+    schema.push_back(field_info);
+    int size = 10;
+    std::vector<uint32_t> return_columns;
+    for (int i = 0; i < schema.size(); ++i) {
+        return_columns.push_back(i);
+    }
+    InitVectorizedBatch(schema, return_columns, size);
+    ColumnVector* col_vector = _vectorized_batch->column(0);
+
+    // dictionary of 3 values, rows refer to them by code
+    Slice dict[3] = {Slice("aa"), Slice("dddd"), Slice("z")};
+    int32_t codes[10] = {0, 1, 2, 1, 0, 1, 2, 2, 1, 0};
+    StringValue* col_data = reinterpret_cast<StringValue*>(_mem_pool->allocate(size * sizeof(StringValue)));
+    for (int i = 0; i < size; ++i) {
+        col_data[i] = StringValue(dict[codes[i]].data, dict[codes[i]].size);
+    }
+    col_vector->set_no_nulls(true);
+    col_vector->set_col_data(col_data);
+    col_vector->set_dict(codes, dict, 3, 1);
+
+    StringValue value;
+    const char* value_buffer = "dddd";
+    value.len = 4;
+    value.ptr = const_cast<char*>(value_buffer);
+
+    ColumnPredicate* pred = new EqualPredicate<StringValue>(0, value);
+    pred->evaluate(_vectorized_batch);
+    ASSERT_EQ(_vectorized_batch->size(), 4);
+    uint16_t* sel = _vectorized_batch->selected();
+    ASSERT_EQ(sel[0], 1);
+    ASSERT_EQ(sel[1], 3);
+    ASSERT_EQ(sel[2], 5);
+    ASSERT_EQ(sel[3], 8);
+
+    // a different dictionary must not reuse the cached matches
+    Slice dict2[2] = {Slice("dddd"), Slice("b")};
+    int32_t codes2[10] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 0};
+    for (int i = 0; i < size; ++i) {
+        col_data[i] = StringValue(dict2[codes2[i]].data, dict2[codes2[i]].size);
+    }
+    col_vector->set_no_nulls(false);
+    bool* is_null = reinterpret_cast<bool*>(_mem_pool->allocate(size));
+    memset(is_null, 0, size);
+    is_null[0] = true;
+    col_vector->set_is_null(is_null);
+    col_vector->set_dict(codes2, dict2, 2, 2);
+    _vectorized_batch->set_size(size);
+    _vectorized_batch->set_selected_in_use(false);
+    pred->evaluate(_vectorized_batch);
+    ASSERT_EQ(_vectorized_batch->size(), 1);
+    sel = _vectorized_batch->selected();
+    ASSERT_EQ(sel[0], 9);
+    delete pred;
+}
+
 TEST_F(TestEqualPredicate, DATE_COLUMN) {
     std::vector<FieldInfo> schema;
     FieldInfo field_info;
@@ -947,6 +1008,63 @@ TEST_F(TestLessPredicate, DATETIME_COLUMN) {
     ASSERT_EQ(datetime::to_datetime_string(*(col_data + sel[0])), "2017-09-08 00:01:00");
 }
 
+// Batches longer than one SIMD chunk, evaluated with every instruction set
+// this CPU has, must select exactly the rows the scalar loop would.
+TEST_F(TestLessPredicate, SIMD_CHUNKS) {
+    std::vector<FieldInfo> schema;
+    FieldInfo field_info;
+    SetFieldInfo(field_info, std::string("INT_COLUMN"), OLAP_FIELD_TYPE_INT,
+                 OLAP_FIELD_AGGREGATION_REPLACE, 1, true, true);
+    schema.push_back(field_info);
+    int size = 1021;
+    std::vector<uint32_t> return_columns;
+    for (int i = 0; i < schema.size(); ++i) {
+        return_columns.push_back(i);
+    }
+    InitVectorizedBatch(schema, return_columns, size);
+    ColumnVector* col_vector = _vectorized_batch->column(0);
+    int32_t* col_data = reinterpret_cast<int32_t*>(_mem_pool->allocate(size * sizeof(int32_t)));
+    bool* is_null = reinterpret_cast<bool*>(_mem_pool->allocate(size));
+    col_vector->set_col_data(col_data);
+    col_vector->set_is_null(is_null);
+    for (int i = 0; i < size; ++i) {
+        *(col_data + i) = (i * 7919) % 100 - 50;
+        is_null[i] = (i % 5 == 0);
+    }
+    int32_t value = 10;
+    ColumnPredicate* pred = new LessPredicate<int32_t>(0, value);
+
+    for (int round = 0; round < 3; ++round) {
+        std::unique_ptr<CpuInfo::TempDisable> disable_avx2;
+        std::unique_ptr<CpuInfo::TempDisable> disable_sse;
+        if (round >= 1) {
+            disable_avx2.reset(new CpuInfo::TempDisable(CpuInfo::AVX2));
+        }
+        if (round >= 2) {
+            disable_sse.reset(new CpuInfo::TempDisable(CpuInfo::SSE4_2));
+        }
+        for (int has_nulls = 0; has_nulls < 2; ++has_nulls) {
+            col_vector->set_no_nulls(!has_nulls);
+            _vectorized_batch->set_size(size);
+            _vectorized_batch->set_selected_in_use(false);
+            pred->evaluate(_vectorized_batch);
+
+            uint16_t* sel = _vectorized_batch->selected();
+            int expected = 0;
+            for (int i = 0; i < size; ++i) {
+                if ((has_nulls && is_null[i]) || !(col_data[i] < value)) {
+                    continue;
+                }
+                ASSERT_LT(expected, _vectorized_batch->size());
+                ASSERT_EQ(i, sel[expected]);
+                ++expected;
+            }
+            ASSERT_EQ(expected, _vectorized_batch->size());
+        }
+    }
+    delete pred;
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
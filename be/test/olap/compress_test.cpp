@@ -0,0 +1,159 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "olap/byte_buffer.h"
+#include "olap/compress.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const uint64_t CHUNK_SIZE = 10 * 1024;
+
+// a chunk of a string stream: urls of a few hosts
+static std::string make_chunk(uint32_t seed) {
+    static const char* hosts[] = {"www.example.com", "static.example.org", "api.example.net"};
+    std::string chunk;
+    while (chunk.size() < CHUNK_SIZE) {
+        seed = seed * 1103515245 + 12345;
+        chunk.append("https://");
+        chunk.append(hosts[seed % 3]);
+        chunk.append("/item/");
+        chunk.append(std::to_string(seed % 100000));
+        chunk.append("?from=search&page=");
+        chunk.append(std::to_string(seed % 17));
+    }
+    chunk.resize(CHUNK_SIZE);
+    return chunk;
+}
+
+class TestZstdCompress : public testing::Test {
+public:
+    virtual void SetUp() {
+        _in.reset(StorageByteBuffer::create(CHUNK_SIZE));
+        _compressed.reset(StorageByteBuffer::create(CHUNK_SIZE));
+        _out.reset(StorageByteBuffer::create(CHUNK_SIZE));
+    }
+
+    void set_input(const std::string& data) {
+        _in->set_position(0);
+        _in->set_limit(_in->capacity());
+        ASSERT_EQ(OLAP_SUCCESS, _in->put(data.data(), data.size()));
+        _in->flip();
+        _compressed->set_position(0);
+        _compressed->set_limit(_compressed->capacity());
+    }
+
+    std::string decompress(ZstdDecompressor* decompressor, OLAPStatus* res) {
+        _compressed->flip();
+        _out->set_position(0);
+        _out->set_limit(_out->capacity());
+        *res = decompressor->decompress(_compressed.get(), _out.get());
+        if (OLAP_SUCCESS != *res) {
+            return "";
+        }
+        return std::string(_out->array(), _out->limit());
+    }
+
+    std::unique_ptr<StorageByteBuffer> _in;
+    std::unique_ptr<StorageByteBuffer> _compressed;
+    std::unique_ptr<StorageByteBuffer> _out;
+};
+
+TEST_F(TestZstdCompress, RoundTrip) {
+    ZstdCompressor compressor(3, 0);
+    ZstdDecompressor decompressor;
+    ASSERT_EQ(OLAP_SUCCESS, decompressor.init(""));
+
+    std::string chunk = make_chunk(1);
+    set_input(chunk);
+    bool smaller = false;
+    ASSERT_EQ(OLAP_SUCCESS, compressor.compress(_in.get(), _compressed.get(), &smaller));
+    ASSERT_TRUE(smaller);
+
+    OLAPStatus res = OLAP_SUCCESS;
+    ASSERT_EQ(chunk, decompress(&decompressor, &res));
+    ASSERT_EQ(OLAP_SUCCESS, res);
+}
+
+TEST_F(TestZstdCompress, Incompressible) {
+    ZstdCompressor compressor(3, 0);
+    std::string chunk(CHUNK_SIZE, '\0');
+    uint64_t seed = 7;
+    for (size_t i = 0; i < chunk.size(); ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        chunk[i] = static_cast<char>(seed >> 56);
+    }
+    set_input(chunk);
+    bool smaller = true;
+    ASSERT_EQ(OLAP_SUCCESS, compressor.compress(_in.get(), _compressed.get(), &smaller));
+    ASSERT_FALSE(smaller);
+}
+
+TEST_F(TestZstdCompress, Dictionary) {
+    ZstdCompressor compressor(3, 4096);
+    bool smaller = false;
+    uint32_t num_chunks = 0;
+    // chunks are compressed without dictionary until enough samples are seen,
+    // training may also fail, then no dictionary is used at all
+    while (compressor.dictionary().empty() && num_chunks < 100) {
+        set_input(make_chunk(num_chunks++));
+        ASSERT_EQ(OLAP_SUCCESS,
+                  compressor.compress_with_dictionary(_in.get(), _compressed.get(), &smaller));
+    }
+    ASSERT_FALSE(compressor.dictionary().empty());
+
+    std::string chunk = make_chunk(1000);
+    set_input(chunk);
+    ASSERT_EQ(OLAP_SUCCESS,
+              compressor.compress_with_dictionary(_in.get(), _compressed.get(), &smaller));
+    ASSERT_TRUE(smaller);
+    uint64_t compressed_size = _compressed->position();
+
+    ZstdDecompressor decompressor;
+    ASSERT_EQ(OLAP_SUCCESS, decompressor.init(compressor.dictionary()));
+    OLAPStatus res = OLAP_SUCCESS;
+    ASSERT_EQ(chunk, decompress(&decompressor, &res));
+    ASSERT_EQ(OLAP_SUCCESS, res);
+
+    // the frame can not be read without the dictionary
+    ZstdDecompressor no_dictionary;
+    ASSERT_EQ(OLAP_SUCCESS, no_dictionary.init(""));
+    _compressed->set_position(compressed_size);
+    _compressed->set_limit(_compressed->capacity());
+    decompress(&no_dictionary, &res);
+    ASSERT_NE(OLAP_SUCCESS, res);
+
+    // streams without dictionary are still compressed plainly
+    set_input(chunk);
+    ASSERT_EQ(OLAP_SUCCESS, compressor.compress(_in.get(), _compressed.get(), &smaller));
+    ASSERT_TRUE(smaller);
+    ASSERT_LT(compressed_size, _compressed->position());
+    ASSERT_EQ(chunk, decompress(&no_dictionary, &res));
+    ASSERT_EQ(OLAP_SUCCESS, res);
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
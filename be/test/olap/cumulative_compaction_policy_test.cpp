@@ -0,0 +1,255 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#define private public
+#include "olap/cumulative_compaction_policy.h"
+#include "olap/olap_header.h"
+#include "olap/olap_table.h"
+#include "olap/segment_group.h"
+#undef private
+#include "util/logging.h"
+
+namespace doris {
+
+static const size_t KB = 1024;
+static const size_t MB = 1024 * 1024;
+
+// The versions of a tablet without files: the data sizes are those of their
+// segment groups, the base version is 0-10.
+class SizeTieredCumulativeCompactionPolicyTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        _header.reset(new OLAPHeader());
+        add_version(Version(0, 10), 500 * MB);
+    }
+
+    virtual void TearDown() {
+        for (SegmentGroup* segment_group : _segment_groups) {
+            delete segment_group;
+        }
+    }
+
+    void add_version(const Version& version, size_t data_size, bool load_delete = false) {
+        ASSERT_EQ(OLAP_SUCCESS, _header->add_version(
+                version, 0, 0, 1, 0, data_size, 0, false, nullptr));
+        _data_sizes.push_back(data_size);
+        _load_deletes.push_back(load_delete);
+        _versions.push_back(version);
+    }
+
+    // single versions from 'start', one per size
+    void add_deltas(int32_t start, const std::vector<size_t>& data_sizes) {
+        for (size_t data_size : data_sizes) {
+            add_version(Version(start, start), data_size);
+            ++start;
+        }
+    }
+
+    void add_delete_version(int32_t version) {
+        add_version(Version(version, version), 0);
+        DeleteConditionMessage delete_condition;
+        delete_condition.add_sub_conditions("k1=1");
+        _header->add_delete_condition(delete_condition, version);
+    }
+
+    // Picks the versions of the deltas from 'cumulative_layer_point', the last
+    // one being the latest version
+    OLAPStatus pick(SizeTieredCumulativeCompactionPolicy* policy,
+                    int32_t cumulative_layer_point, Versions* picked, int32_t* new_point) {
+        _table.reset(new OLAPTable(_header.get()));
+        Versions deltas;
+        for (size_t i = 0; i < _versions.size(); ++i) {
+            SegmentGroup* segment_group = new SegmentGroup(
+                    _table.get(), _versions[i], 0, _load_deletes[i], 0, 1);
+            segment_group->_index._data_size = _data_sizes[i];
+            _segment_groups.push_back(segment_group);
+            _table->_data_sources[_versions[i]].push_back(segment_group);
+            if (_versions[i].first >= cumulative_layer_point) {
+                deltas.push_back(_versions[i]);
+            }
+        }
+        return policy->pick_versions(_table.get(), deltas, picked, new_point);
+    }
+
+    static Versions singles(int32_t first, int32_t last) {
+        Versions versions;
+        for (int32_t version = first; version <= last; ++version) {
+            versions.push_back(Version(version, version));
+        }
+        return versions;
+    }
+
+private:
+    std::unique_ptr<OLAPHeader> _header;
+    // made by the constructor of the tables for checks, which does not delete
+    // the segment groups
+    std::unique_ptr<OLAPTable> _table;
+    std::vector<SegmentGroup*> _segment_groups;
+    Versions _versions;
+    std::vector<size_t> _data_sizes;
+    std::vector<bool> _load_deletes;
+};
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, SmallDeltasAreMergedBeforeLargerOne) {
+    // 11 is a tier of its own, 16 is the latest version
+    add_deltas(11, {20 * MB, 1 * KB, 2 * KB, 1 * KB, 3 * KB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 11, &picked, &new_point));
+    // 11 is larger than the promotion budget of 4 times 1MB
+    ASSERT_EQ(singles(12, 15), picked);
+    // 11 may still be merged later
+    ASSERT_EQ(11, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, PreviousCumulativeVersionIsPromoted) {
+    add_version(Version(11, 20), 3 * MB);
+    add_deltas(21, {1 * KB, 1 * KB, 1 * KB, 1 * KB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 21, &picked, &new_point));
+    Versions expected = singles(21, 24);
+    expected.insert(expected.begin(), Version(11, 20));
+    ASSERT_EQ(expected, picked);
+    ASSERT_EQ(25, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, PromotionBudgetIsExclusive) {
+    // exactly 4 times the scored size of the deltas
+    add_version(Version(11, 20), 4 * MB);
+    add_deltas(21, {1 * KB, 1 * KB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 21, &picked, &new_point));
+    ASSERT_EQ(singles(21, 22), picked);
+    ASSERT_EQ(23, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, PromotionBudgetIsBoundedByMaxSize) {
+    add_version(Version(11, 20), 5 * MB);
+    add_deltas(21, {1 * KB, 1 * KB, 1 * KB});
+    // the budget of 8 times 1MB is bounded by the max size less the 2KB to merge
+    SizeTieredCumulativeCompactionPolicy policy(5 * MB + 2 * KB, 8, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 21, &picked, &new_point));
+    ASSERT_EQ(singles(21, 22), picked);
+
+    SizeTieredCumulativeCompactionPolicy larger_policy(5 * MB + 3 * KB, 8, 10);
+    ASSERT_EQ(OLAP_SUCCESS, pick(&larger_policy, 21, &picked, &new_point));
+    Versions expected = singles(21, 22);
+    expected.insert(expected.begin(), Version(11, 20));
+    ASSERT_EQ(expected, picked);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, SizeRatioSplitsTiers) {
+    // 10MB is more than 4 times 2MB, not than 4 times 2MB + 1MB
+    add_deltas(11, {10 * MB, 2 * MB, 1 * MB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 11, &picked, &new_point));
+    // 12-13 saves a version per 3MB, 11-13 two per 13MB; 11 is then promoted
+    // within the budget of 4 times 3MB
+    ASSERT_EQ(singles(11, 13), picked);
+    ASSERT_EQ(11, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, DeleteVersionsSplitRuns) {
+    add_deltas(11, {1 * KB, 1 * KB});
+    add_delete_version(13);
+    add_deltas(14, {1 * KB, 1 * KB, 1 * KB, 1 * KB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 11, &picked, &new_point));
+    // the delete version is neither merged nor promoted
+    ASSERT_EQ(singles(14, 17), picked);
+    ASSERT_EQ(11, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, LoadDeleteVersionsSplitRuns) {
+    add_deltas(11, {1 * KB, 1 * KB, 1 * KB});
+    add_version(Version(14, 14), 1 * KB, true);
+    add_deltas(15, {1 * KB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 11, &picked, &new_point));
+    ASSERT_EQ(singles(11, 13), picked);
+    ASSERT_EQ(14, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, VersionHolesSplitRuns) {
+    add_deltas(11, {1 * KB, 1 * KB});
+    add_deltas(14, {1 * KB, 1 * KB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 11, &picked, &new_point));
+    // both runs save one version per 1MB, the first one is kept
+    ASSERT_EQ(singles(11, 12), picked);
+    ASSERT_EQ(14, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, RunsAreBoundedByMaxDeltas) {
+    add_deltas(11, {1 * KB, 1 * KB, 1 * KB, 1 * KB, 1 * KB, 1 * KB, 1 * KB});
+    SizeTieredCumulativeCompactionPolicy policy(100 * MB, 4, 3);
+    Versions picked;
+    int32_t new_point = 0;
+    ASSERT_EQ(OLAP_SUCCESS, pick(&policy, 11, &picked, &new_point));
+    ASSERT_EQ(singles(11, 13), picked);
+    ASSERT_EQ(14, new_point);
+}
+
+TEST_F(SizeTieredCumulativeCompactionPolicyTest, NothingToMerge) {
+    SizeTieredCumulativeCompactionPolicy policy(10 * MB, 4, 10);
+    Versions picked;
+    int32_t new_point = 0;
+
+    // only the latest version
+    add_deltas(11, {1 * KB});
+    ASSERT_EQ(OLAP_ERR_CUMULATIVE_NO_SUITABLE_VERSIONS, pick(&policy, 11, &picked, &new_point));
+    ASSERT_EQ(11, new_point);
+
+    // a delta of the max size is not merged, two others would exceed it
+    add_deltas(12, {10 * MB, 6 * MB, 5 * MB, 1 * KB});
+    ASSERT_EQ(OLAP_ERR_CUMULATIVE_NO_SUITABLE_VERSIONS, pick(&policy, 12, &picked, &new_point));
+    ASSERT_EQ(15, new_point);
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "olap/delete_bitmap.h"
+#include "olap/field.h"
+#include "runtime/vectorized_row_batch.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class DeleteBitmapTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        FieldInfo field_info;
+        field_info.name = "k1";
+        field_info.type = OLAP_FIELD_TYPE_INT;
+        field_info.aggregation = OLAP_FIELD_AGGREGATION_NONE;
+        field_info.length = 4;
+        field_info.is_allow_null = false;
+        field_info.is_key = true;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        _schema.push_back(field_info);
+        _batch.reset(new VectorizedRowBatch(_schema, {0}, 100));
+    }
+
+    std::vector<uint16_t> selected_rows() {
+        std::vector<uint16_t> rows;
+        for (uint16_t j = 0; j < _batch->size(); ++j) {
+            rows.push_back(_batch->selected_in_use() ? _batch->selected()[j] : j);
+        }
+        return rows;
+    }
+
+    std::vector<FieldInfo> _schema;
+    std::unique_ptr<VectorizedRowBatch> _batch;
+};
+
+TEST_F(DeleteBitmapTest, AddAndGet) {
+    DeleteBitmap bitmap;
+    ASSERT_TRUE(bitmap.empty());
+    ASSERT_EQ(-1, bitmap.max_version());
+
+    bitmap.add(0, 5, 10);
+    // a row keeps the version it was replaced in first
+    bitmap.add(0, 5, 12);
+    bitmap.add(1, 5, 8);
+    ASSERT_EQ(10, bitmap.get(0, 5));
+    ASSERT_EQ(8, bitmap.get(1, 5));
+    ASSERT_EQ(-1, bitmap.get(0, 6));
+    ASSERT_EQ(-1, bitmap.get(2, 5));
+    ASSERT_EQ(12, bitmap.max_version());
+
+    DeleteBitmap other;
+    other.add(0, 5, 9);
+    other.add(2, 0, 20);
+    bitmap.merge(other);
+    ASSERT_EQ(9, bitmap.get(0, 5));
+    ASSERT_EQ(20, bitmap.get(2, 0));
+    ASSERT_EQ(20, bitmap.max_version());
+}
+
+TEST_F(DeleteBitmapTest, Filter) {
+    DeleteBitmap bitmap;
+    // rows 1000..1099 of segment 1 are in the batch
+    bitmap.add(1, 999, 5);
+    bitmap.add(1, 1000, 5);
+    bitmap.add(1, 1003, 7);
+    bitmap.add(1, 1009, 5);
+    bitmap.add(1, 1100, 5);
+    bitmap.add(0, 1001, 5);
+
+    _batch->set_size(10);
+    ASSERT_EQ(2, bitmap.filter(1, 1000, 6, _batch.get()));
+    std::vector<uint16_t> expected = {1, 2, 3, 4, 5, 6, 7, 8};
+    ASSERT_EQ(expected, selected_rows());
+
+    // an existing selection is kept, rows replaced in newer versions are read
+    ASSERT_EQ(1, bitmap.filter(1, 1000, 7, _batch.get()));
+    expected = {1, 2, 4, 5, 6, 7, 8};
+    ASSERT_EQ(expected, selected_rows());
+
+    // nothing replaced in this range, the batch is left alone
+    _batch->clear();
+    _batch->set_size(10);
+    ASSERT_EQ(0, bitmap.filter(1, 1000, 4, _batch.get()));
+    ASSERT_EQ(0, bitmap.filter(2, 1000, 10, _batch.get()));
+    ASSERT_FALSE(_batch->selected_in_use());
+    ASSERT_EQ(10, _batch->size());
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
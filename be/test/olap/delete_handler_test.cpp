@@ -973,6 +973,57 @@ TEST_F(TestDeleteHandler, FilterDataSubconditions) {
     _delete_handler.finalize();
 }
 
+// predicate of a vectorized delete condition, only counted
+class TestDeletePredicate : public ColumnPredicate {
+public:
+    TestDeletePredicate(int32_t column_id) : _column_id(column_id) {}
+    void evaluate(VectorizedRowBatch* batch) const override {}
+    int32_t column_id() const override { return _column_id; }
+private:
+    int32_t _column_id;
+};
+
+TEST_F(TestDeleteHandler, InitColumnPredicates) {
+    DeleteConditionHandler cond_handler;
+    std::vector<TCondition> conditions;
+    TCondition condition;
+    condition.column_name = "k1";
+    condition.condition_op = "=";
+    condition.condition_values.push_back("1");
+    conditions.push_back(condition);
+    condition.column_name = "k2";
+    condition.condition_op = "!=";
+    condition.condition_values.clear();
+    condition.condition_values.push_back("4");
+    conditions.push_back(condition);
+    ASSERT_EQ(OLAP_SUCCESS, cond_handler.store_cond(_olap_table, 3, conditions));
+    ASSERT_EQ(OLAP_SUCCESS, push_empty_delta(3));
+
+    conditions.pop_back();
+    ASSERT_EQ(OLAP_SUCCESS, cond_handler.store_cond(_olap_table, 4, conditions));
+    ASSERT_EQ(OLAP_SUCCESS, push_empty_delta(4));
+
+    ASSERT_EQ(OLAP_SUCCESS, _delete_handler.init(_olap_table, 10));
+    // only equality is converted
+    _delete_handler.init_column_predicates(
+            _olap_table, [this] (const TCondition& condition) -> ColumnPredicate* {
+        if (condition.condition_op != "=") {
+            return nullptr;
+        }
+        return new TestDeletePredicate(_olap_table->get_field_index(condition.column_name));
+    });
+    auto& delete_conditions = _delete_handler.get_delete_conditions();
+    ASSERT_EQ(2U, delete_conditions.size());
+    ASSERT_EQ(2U, delete_conditions[0].sub_conditions.size());
+    ASSERT_FALSE(delete_conditions[0].vectorized);
+    ASSERT_TRUE(delete_conditions[0].col_predicates.empty());
+    ASSERT_TRUE(delete_conditions[1].vectorized);
+    ASSERT_EQ(1U, delete_conditions[1].col_predicates.size());
+    ASSERT_EQ(0, delete_conditions[1].col_predicates[0]->column_id());
+
+    _delete_handler.finalize();
+}
+
 // 测试多个过滤条件之间是or关系，
 // 即如果存在多个过滤条件，会一次检查数据是否符合这些过滤条件；只要有一个过滤条件符合，则过滤数据
 TEST_F(TestDeleteHandler, FilterDataConditions) {
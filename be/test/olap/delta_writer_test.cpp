@@ -19,6 +19,8 @@
 
 #include <sys/file.h>
 #include <string>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "gen_cpp/Descriptors_types.h"
@@ -418,6 +420,138 @@ TEST_F(TestDeltaWriter, write) {
     ASSERT_EQ(OLAP_SUCCESS, res);
 }
 
+TEST_F(TestDeltaWriter, write_from_senders_in_parallel) {
+    TCreateTabletReq request;
+    create_table_request(&request);
+    OLAPStatus res = k_engine->create_table(request);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+
+    TDescriptorTable tdesc_tbl = create_descriptor_table();
+    ObjectPool obj_pool;
+    DescriptorTbl* desc_tbl = nullptr;
+    DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+
+    PUniqueId load_id;
+    load_id.set_hi(0);
+    load_id.set_lo(0);
+    WriteRequest write_req = {10003, 270068375, WriteType::LOAD,
+                              20001, 30001, load_id, false, tuple_desc};
+    DeltaWriter* delta_writer = nullptr;
+    int32_t memtable_partitions = config::memtable_partitions;
+    int32_t write_buffer_size = config::write_buffer_size;
+    config::memtable_partitions = 4;
+    // small memtables are flushed in the background while the senders write
+    config::write_buffer_size = 16 * 1024;
+    DeltaWriter::open(&write_req, &delta_writer);
+    ASSERT_NE(delta_writer, nullptr);
+
+    // each sender writes its own keys into its own partition of the memtable
+    const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+    const int num_senders = 4;
+    const int num_rows = 100;
+    std::vector<std::thread> senders;
+    for (int sender_id = 0; sender_id < num_senders; ++sender_id) {
+        senders.emplace_back([&, sender_id]() {
+            Arena arena;
+            for (int i = 0; i < num_rows; ++i) {
+                Tuple* tuple = reinterpret_cast<Tuple*>(arena.Allocate(tuple_desc->byte_size()));
+                memset(tuple, 0, tuple_desc->byte_size());
+                *(int8_t*)(tuple->get_slot(slots[0]->tuple_offset())) = sender_id;
+                *(int16_t*)(tuple->get_slot(slots[1]->tuple_offset())) = i;
+                ASSERT_EQ(OLAP_SUCCESS, delta_writer->write(tuple, sender_id));
+            }
+        });
+    }
+    for (auto& sender : senders) {
+        sender.join();
+    }
+
+    res = delta_writer->close(nullptr);
+    ASSERT_EQ(res, OLAP_SUCCESS);
+    config::memtable_partitions = memtable_partitions;
+    config::write_buffer_size = write_buffer_size;
+
+    OLAPTablePtr table = OLAPEngine::get_instance()->get_table(write_req.tablet_id, write_req.schema_hash);
+    TPublishVersionRequest publish_req;
+    publish_req.transaction_id = write_req.transaction_id;
+    TPartitionVersionInfo info;
+    info.partition_id = write_req.partition_id;
+    info.version = table->lastest_version()->end_version() + 1;
+    info.version_hash = table->lastest_version()->version_hash() + 1;
+    std::vector<TPartitionVersionInfo> partition_version_infos;
+    partition_version_infos.push_back(info);
+    publish_req.partition_version_infos = partition_version_infos;
+    std::vector<TTabletId> error_tablet_ids;
+    res = k_engine->publish_version(publish_req, &error_tablet_ids);
+
+    ASSERT_EQ(num_senders * num_rows, table->get_num_rows());
+
+    res = k_engine->drop_table(write_req.tablet_id, write_req.schema_hash);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+}
+
+TEST_F(TestDeltaWriter, write_sorted_on_flush) {
+    TCreateTabletReq request;
+    create_table_request(&request);
+    OLAPStatus res = k_engine->create_table(request);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+
+    TDescriptorTable tdesc_tbl = create_descriptor_table();
+    ObjectPool obj_pool;
+    DescriptorTbl* desc_tbl = nullptr;
+    DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+
+    PUniqueId load_id;
+    load_id.set_hi(0);
+    load_id.set_lo(0);
+    WriteRequest write_req = {10003, 270068375, WriteType::LOAD,
+                              20002, 30001, load_id, false, tuple_desc};
+    DeltaWriter* delta_writer = nullptr;
+    int32_t memtable_partitions = config::memtable_partitions;
+    bool memtable_sort_on_flush = config::memtable_sort_on_flush;
+    config::memtable_partitions = 2;
+    config::memtable_sort_on_flush = true;
+    DeltaWriter::open(&write_req, &delta_writer);
+    ASSERT_NE(delta_writer, nullptr);
+
+    // keys arrive in descending order, they are only sorted on flush
+    const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+    const int num_rows = 200;
+    Arena arena;
+    for (int i = num_rows; i > 0; --i) {
+        Tuple* tuple = reinterpret_cast<Tuple*>(arena.Allocate(tuple_desc->byte_size()));
+        memset(tuple, 0, tuple_desc->byte_size());
+        *(int8_t*)(tuple->get_slot(slots[0]->tuple_offset())) = i % 2 == 0 ? -i % 128 : i % 128;
+        *(int16_t*)(tuple->get_slot(slots[1]->tuple_offset())) = i;
+        ASSERT_EQ(OLAP_SUCCESS, delta_writer->write(tuple, i % 2));
+    }
+
+    res = delta_writer->close(nullptr);
+    ASSERT_EQ(res, OLAP_SUCCESS);
+    config::memtable_partitions = memtable_partitions;
+    config::memtable_sort_on_flush = memtable_sort_on_flush;
+
+    OLAPTablePtr table = OLAPEngine::get_instance()->get_table(write_req.tablet_id, write_req.schema_hash);
+    TPublishVersionRequest publish_req;
+    publish_req.transaction_id = write_req.transaction_id;
+    TPartitionVersionInfo info;
+    info.partition_id = write_req.partition_id;
+    info.version = table->lastest_version()->end_version() + 1;
+    info.version_hash = table->lastest_version()->version_hash() + 1;
+    std::vector<TPartitionVersionInfo> partition_version_infos;
+    partition_version_infos.push_back(info);
+    publish_req.partition_version_infos = partition_version_infos;
+    std::vector<TTabletId> error_tablet_ids;
+    res = k_engine->publish_version(publish_req, &error_tablet_ids);
+
+    ASSERT_EQ(num_rows, table->get_num_rows());
+
+    res = k_engine->drop_table(write_req.tablet_id, write_req.schema_hash);
+    ASSERT_EQ(OLAP_SUCCESS, res);
+}
+
 // ######################### ALTER TABLE TEST BEGIN #########################
 
 void schema_change_request(const TCreateTabletReq& base_request, TCreateTabletReq* request) {
@@ -20,8 +20,10 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "agent/status.h"
+#include "olap/byte_buffer.h"
 #include "olap/olap_define.h"
 #include "olap/file_helper.h"
+#include "olap/lru_cache.h"
 #include "boost/filesystem.hpp"
 #include "util/logging.h"
 
@@ -100,6 +102,52 @@ TEST_F(FileHandlerTest, TestWrite) {
     }
 }
 
+TEST_F(FileHandlerTest, TestMmapWithCache) {
+    std::string file_name = _s_test_data_path + "/mapped.dat";
+    std::string content(10000, 'a');
+    content[4096] = 'b';
+    {
+        FileHandler file_handler;
+        ASSERT_EQ(OLAP_SUCCESS, file_handler.open_with_mode(file_name,
+                O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        ASSERT_EQ(OLAP_SUCCESS, file_handler.write(content.data(), content.size()));
+    }
+
+    FileHandler::set_fd_cache(new_lru_cache(10));
+    {
+        FileHandler file_handler;
+        StorageByteBuffer* buffer = NULL;
+        ASSERT_EQ(OLAP_SUCCESS, file_handler.open(file_name, O_RDONLY));
+        ASSERT_NE(OLAP_SUCCESS, file_handler.mmap_with_cache(&buffer));
+        ASSERT_TRUE(buffer == NULL);
+        ASSERT_EQ(OLAP_SUCCESS, file_handler.close());
+
+        ASSERT_EQ(OLAP_SUCCESS, file_handler.open_with_cache(file_name, O_RDONLY));
+        ASSERT_EQ(OLAP_SUCCESS, file_handler.mmap_with_cache(&buffer));
+        ASSERT_EQ(content.size(), buffer->limit());
+        ASSERT_EQ(0, memcmp(content.data(), buffer->array(), content.size()));
+
+        // a range shares the mapping of the cached descriptor
+        FileHandler range_handler;
+        StorageByteBuffer* range = NULL;
+        ASSERT_EQ(OLAP_SUCCESS, range_handler.open_range_with_cache(
+                file_name, O_RDONLY, 4096, 100));
+        ASSERT_EQ(OLAP_SUCCESS, range_handler.mmap_with_cache(&range));
+        ASSERT_EQ(100, range->limit());
+        ASSERT_EQ(buffer->array() + 4096, range->array());
+        ASSERT_EQ('b', range->array()[0]);
+
+        // the mapping outlives the descriptor while it is referenced
+        range_handler.close();
+        file_handler.close();
+        delete FileHandler::get_fd_cache();
+        FileHandler::set_fd_cache(NULL);
+        ASSERT_EQ('b', range->array()[0]);
+        delete range;
+        delete buffer;
+    }
+}
+
 }  // namespace doris
 
 int main(int argc, char **argv) {
@@ -0,0 +1,212 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/hll.h"
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "util/cpu_info.h"
+#include "util/slice.h"
+
+namespace doris {
+
+class HllTest : public testing::Test {
+public:
+    HllTest() { }
+    ~HllTest() {
+        for (auto context : _contexts) {
+            delete context->hash64_set;
+            delete context;
+        }
+    }
+
+protected:
+    HllContext* new_context() {
+        HllContext* context = new HllContext();
+        HllSetHelper::init_context(context);
+        _contexts.push_back(context);
+        return context;
+    }
+
+    // fills 'context' with the encoded set 'data'
+    void fill(HllContext* context, char* data, int len) {
+        Slice slice(data, len);
+        HllSetHelper::fill_set(reinterpret_cast<const char*>(&slice), context);
+    }
+
+    static uint64_t hash_of(int i) {
+        return (uint64_t)(i + 1) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    void check_merge_registers() {
+        // a length which is not a multiple of the vectors
+        const int len = 1000;
+        char registers[len];
+        char other[len];
+        char expected[len];
+        for (int i = 0; i < len; ++i) {
+            registers[i] = i % 61;
+            other[i] = i % 37;
+            expected[i] = std::max(registers[i], other[i]);
+        }
+        HllSetHelper::merge_registers(registers, other, len);
+        ASSERT_EQ(0, memcmp(expected, registers, len));
+    }
+
+    std::vector<HllContext*> _contexts;
+};
+
+TEST_F(HllTest, explicit_set) {
+    HllContext* context = new_context();
+    std::vector<uint64_t> hashes = { hash_of(3), hash_of(1), hash_of(2) };
+    char data[HLL_COLUMN_DEFAULT_LEN];
+    int len = 0;
+    HllSetHelper::set_explicit(data, hashes, len);
+    // the same hashes twice are kept once
+    fill(context, data, len);
+    fill(context, data, len);
+
+    char result[HLL_COLUMN_DEFAULT_LEN];
+    HllSetHelper::set_hll(result, context, len);
+    ASSERT_EQ(2 + 3 * (int)sizeof(uint64_t), len);
+    HllSetResolver resolver;
+    resolver.init(result, len);
+    resolver.parse();
+    ASSERT_EQ(HLL_DATA_EXPLICIT, resolver.get_hll_data_type());
+    ASSERT_EQ(3, resolver.get_explicit_count());
+    ASSERT_EQ(std::min(hash_of(1), std::min(hash_of(2), hash_of(3))),
+              resolver.get_explicit_value(0));
+}
+
+TEST_F(HllTest, many_explicit_sets) {
+    // more hashes than an explicit set holds end up in the registers
+    HllContext* context = new_context();
+    char expected[HLL_REGISTERS_COUNT];
+    memset(expected, 0, sizeof(expected));
+    std::vector<uint64_t> all_hashes;
+    for (int i = 0; i < 10; ++i) {
+        std::vector<uint64_t> hashes;
+        for (int j = 0; j < 100; ++j) {
+            hashes.push_back(hash_of(i * 50 + j));
+        }
+        std::sort(hashes.begin(), hashes.end());
+        all_hashes.insert(all_hashes.end(), hashes.begin(), hashes.end());
+        char data[HLL_COLUMN_DEFAULT_LEN];
+        int len = 0;
+        HllSetHelper::set_explicit(data, hashes, len);
+        fill(context, data, len);
+    }
+    HllSetHelper::set_max_register(expected, HLL_REGISTERS_COUNT, all_hashes);
+
+    char result[HLL_COLUMN_DEFAULT_LEN];
+    int len = 0;
+    HllSetHelper::set_hll(result, context, len);
+    HllSetResolver resolver;
+    resolver.init(result, len);
+    resolver.parse();
+    ASSERT_EQ(HLL_DATA_SPRASE, resolver.get_hll_data_type());
+    char registers[HLL_REGISTERS_COUNT];
+    memset(registers, 0, sizeof(registers));
+    resolver.fill_registers(registers, HLL_REGISTERS_COUNT);
+    ASSERT_EQ(0, memcmp(expected, registers, HLL_REGISTERS_COUNT));
+}
+
+TEST_F(HllTest, sparse_and_full) {
+    char registers[HLL_REGISTERS_COUNT];
+    memset(registers, 0, sizeof(registers));
+    registers[1] = 3;
+    registers[300] = 7;
+    registers[HLL_REGISTERS_COUNT - 1] = 1;
+    char sparse[HLL_COLUMN_DEFAULT_LEN];
+    int sparse_len = 0;
+    HllSetHelper::set_sparse(sparse, registers, HLL_REGISTERS_COUNT, sparse_len);
+    ASSERT_EQ(1 + 4 + 3 * 3, sparse_len);
+
+    char full_registers[HLL_REGISTERS_COUNT];
+    for (int i = 0; i < HLL_REGISTERS_COUNT; ++i) {
+        full_registers[i] = i % 5;
+    }
+    char full[HLL_COLUMN_DEFAULT_LEN];
+    int full_len = 0;
+    HllSetHelper::set_full(full, full_registers, HLL_REGISTERS_COUNT, full_len);
+
+    HllContext* context = new_context();
+    fill(context, sparse, sparse_len);
+    fill(context, full, full_len);
+    char result[HLL_COLUMN_DEFAULT_LEN];
+    int len = 0;
+    HllSetHelper::set_hll(result, context, len);
+    ASSERT_EQ(HLL_COLUMN_DEFAULT_LEN, len);
+    ASSERT_EQ((char)HLL_DATA_FULL, result[0]);
+    for (int i = 0; i < HLL_REGISTERS_COUNT; ++i) {
+        ASSERT_EQ(std::max(registers[i], full_registers[i]), result[1 + i]);
+    }
+}
+
+TEST_F(HllTest, merge_context) {
+    // merging contexts gives the set of filling one context with both sets
+    std::vector<uint64_t> hashes = { hash_of(1), hash_of(2) };
+    char explicit_data[HLL_COLUMN_DEFAULT_LEN];
+    int explicit_len = 0;
+    HllSetHelper::set_explicit(explicit_data, hashes, explicit_len);
+    char registers[HLL_REGISTERS_COUNT];
+    memset(registers, 0, sizeof(registers));
+    registers[7] = 5;
+    char sparse[HLL_COLUMN_DEFAULT_LEN];
+    int sparse_len = 0;
+    HllSetHelper::set_sparse(sparse, registers, HLL_REGISTERS_COUNT, sparse_len);
+
+    HllContext* filled = new_context();
+    fill(filled, explicit_data, explicit_len);
+    fill(filled, sparse, sparse_len);
+    HllContext* merged = new_context();
+    fill(merged, explicit_data, explicit_len);
+    HllContext* other = new_context();
+    fill(other, sparse, sparse_len);
+    HllSetHelper::merge_context(merged, *other);
+
+    char expected[HLL_COLUMN_DEFAULT_LEN];
+    int expected_len = 0;
+    HllSetHelper::set_hll(expected, filled, expected_len);
+    char result[HLL_COLUMN_DEFAULT_LEN];
+    int len = 0;
+    HllSetHelper::set_hll(result, merged, len);
+    ASSERT_EQ(expected_len, len);
+    ASSERT_EQ(0, memcmp(expected, result, len));
+}
+
+TEST_F(HllTest, merge_registers) {
+    check_merge_registers();
+}
+
+TEST_F(HllTest, merge_registers_without_avx2) {
+    CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+    check_merge_registers();
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/loser_tree.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace doris {
+
+typedef std::vector<std::vector<int>> Inputs;
+
+// Compares the current values of the inputs only, so equal values tie like rows
+// of segment groups of the same version. Inputs at their end go last.
+class ValueLess {
+public:
+    ValueLess(const Inputs* inputs, const std::vector<size_t>* pos)
+            : _inputs(inputs), _pos(pos) { }
+
+    bool operator()(int a, int b) const {
+        bool a_end = (*_pos)[a] == (*_inputs)[a].size();
+        bool b_end = (*_pos)[b] == (*_inputs)[b].size();
+        if (a_end || b_end) {
+            return b_end && !a_end;
+        }
+        return (*_inputs)[a][(*_pos)[a]] < (*_inputs)[b][(*_pos)[b]];
+    }
+
+private:
+    const Inputs* _inputs;
+    const std::vector<size_t>* _pos;
+};
+
+// Merges the inputs the way the collect iterator of the reader does, with the
+// runner-up shortcut. Returns (value, input) pairs in the merged order.
+static std::vector<std::pair<int, int>> merge(const Inputs& inputs) {
+    std::vector<size_t> pos(inputs.size(), 0);
+    LoserTree<ValueLess> tree(ValueLess(&inputs, &pos));
+    tree.build(inputs.size());
+    std::vector<std::pair<int, int>> result;
+    int runner_up = -1;
+    int winner = tree.winner();
+    while (pos[winner] < inputs[winner].size()) {
+        result.emplace_back(inputs[winner][pos[winner]], winner);
+        ++pos[winner];
+        bool has_next = pos[winner] < inputs[winner].size();
+        if (has_next && (inputs.size() == 1
+                || (runner_up >= 0 && tree.before(winner, runner_up)))) {
+            continue;
+        }
+        int last_winner = winner;
+        tree.adjust();
+        winner = tree.winner();
+        runner_up = winner == last_winner && has_next ? tree.runner_up() : -1;
+    }
+    return result;
+}
+
+// The expected order: by value, equal values by input
+static std::vector<std::pair<int, int>> expected(const Inputs& inputs) {
+    std::vector<std::pair<int, int>> result;
+    for (int i = 0; i < inputs.size(); ++i) {
+        for (int value : inputs[i]) {
+            result.emplace_back(value, i);
+        }
+    }
+    std::stable_sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(LoserTreeTest, three_inputs_with_ties) {
+    Inputs inputs = {{1, 1, 2, 5}, {1, 2, 2, 5}, {0, 1, 5, 5}};
+    ASSERT_EQ(expected(inputs), merge(inputs));
+}
+
+TEST(LoserTreeTest, five_inputs_with_ties) {
+    // all inputs tie on every value, the winner must follow the input order
+    // whatever the shape of the tree
+    Inputs inputs(5, {3, 3, 7, 7, 7});
+    ASSERT_EQ(expected(inputs), merge(inputs));
+
+    inputs = {{1, 4}, {1, 1, 1, 4}, {4}, {1, 4, 4}, {0, 1}};
+    ASSERT_EQ(expected(inputs), merge(inputs));
+}
+
+TEST(LoserTreeTest, single_input) {
+    Inputs inputs = {{1, 2, 2, 3}};
+    ASSERT_EQ(expected(inputs), merge(inputs));
+}
+
+TEST(LoserTreeTest, random) {
+    std::mt19937 rng(4);
+    for (int round = 0; round < 2000; ++round) {
+        Inputs inputs(1 + rng() % 9);
+        for (auto& input : inputs) {
+            // few distinct values, so most rows tie with rows of other inputs
+            input.resize(1 + rng() % 20);
+            for (auto& value : input) {
+                value = rng() % 5;
+            }
+            std::sort(input.begin(), input.end());
+        }
+        ASSERT_EQ(expected(inputs), merge(inputs)) << "round " << round;
+    }
+}
+
+TEST(LoserTreeTest, runner_up) {
+    Inputs inputs = {{5}, {2}, {9}, {2}, {7}};
+    std::vector<size_t> pos(inputs.size(), 0);
+    LoserTree<ValueLess> tree(ValueLess(&inputs, &pos));
+    tree.build(inputs.size());
+    ASSERT_EQ(1, tree.winner());
+    // ties with the winner, but goes after it
+    ASSERT_EQ(3, tree.runner_up());
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -15,12 +15,14 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
 
 #include "olap/lru_cache.h"
 #include "util/logging.h"
+#include "util/metrics.h"
 
 using namespace doris;
 using namespace std;
@@ -66,6 +68,9 @@ public:
         _s_current->_deleted_values.push_back(DecodeValue(v));
     }
 
+    static void DeleterNop(const CacheKey& key, void* v) {
+    }
+
     static const int kCacheSize = 1000;
     std::vector<int> _deleted_keys;
     std::vector<int> _deleted_values;
@@ -228,6 +233,108 @@ TEST_F(CacheTest, HeavyEntries) {
     ASSERT_LE(cached_weight, kCacheSize + kCacheSize / 10);
 }
 
+TEST_F(CacheTest, SegmentedLRUResistsScan) {
+    delete _cache;
+    _cache = new_lru_cache(kCacheSize, CACHE_POLICY_SEGMENTED_LRU);
+
+    // entries hit once are protected from a scan that touches every key once
+    for (int i = 0; i < 20; i++) {
+        Insert(i, 1000 + i, 1);
+        ASSERT_EQ(1000 + i, Lookup(i));
+    }
+    for (int i = 0; i < 2 * kCacheSize; i++) {
+        Insert(100 + i, 2000 + i, 1);
+    }
+    for (int i = 0; i < 20; i++) {
+        ASSERT_EQ(1000 + i, Lookup(i));
+    }
+
+    // the scan itself was evicted
+    ASSERT_EQ(-1, Lookup(100));
+    ASSERT_GE(_deleted_keys.size(), static_cast<size_t>(kCacheSize));
+}
+
+TEST_F(CacheTest, SegmentedLRUProtectedSegmentIsBounded) {
+    delete _cache;
+    _cache = new_lru_cache(kCacheSize, CACHE_POLICY_SEGMENTED_LRU);
+
+    // more hot entries than the protected segment can hold are still evicted
+    for (int i = 0; i < 2 * kCacheSize; i++) {
+        Insert(i, 1000 + i, 1);
+        ASSERT_EQ(1000 + i, Lookup(i));
+    }
+    ASSERT_EQ(-1, Lookup(0));
+    ASSERT_EQ(1000 + 2 * kCacheSize - 1, Lookup(2 * kCacheSize - 1));
+
+    _cache->prune();
+    ASSERT_EQ(0, _cache->get_memory_usage());
+}
+
+TEST_F(CacheTest, Metrics) {
+    MetricRegistry registry("test");
+    _cache->register_metrics(&registry, "test_cache");
+
+    Insert(100, 101, 1);
+    ASSERT_EQ(101, Lookup(100));
+    ASSERT_EQ(-1, Lookup(200));
+    ASSERT_EQ(-1, Lookup(300));
+    for (int i = 0; i < 2 * kCacheSize; i++) {
+        Insert(1000 + i, 2000 + i, 1);
+    }
+
+    IntCounter* hits = dynamic_cast<IntCounter*>(registry.get_metric(
+            "cache_requests_total", MetricLabels().add("name", "test_cache").add("type", "hit")));
+    IntCounter* misses = dynamic_cast<IntCounter*>(registry.get_metric(
+            "cache_requests_total", MetricLabels().add("name", "test_cache").add("type", "miss")));
+    IntCounter* evictions = dynamic_cast<IntCounter*>(registry.get_metric(
+            "cache_evictions_total", MetricLabels().add("name", "test_cache")));
+    ASSERT_TRUE(hits != nullptr);
+    ASSERT_TRUE(misses != nullptr);
+    ASSERT_TRUE(evictions != nullptr);
+    ASSERT_EQ(1, hits->value());
+    ASSERT_EQ(2, misses->value());
+    ASSERT_EQ(_deleted_keys.size(), static_cast<size_t>(evictions->value()));
+
+    // deregisters the counters while the registry is still alive
+    delete _cache;
+    _cache = NULL;
+}
+
+TEST_F(CacheTest, ConcurrentHits) {
+    // entries may be freed by any thread, so none of them records deletions
+    for (int i = 0; i < 100; i++) {
+        std::string result;
+        _cache->release(_cache->insert(EncodeKey(&result, i), EncodeValue(1000 + i), 1,
+                                       &CacheTest::DeleterNop));
+    }
+
+    // hits run under the shared lock while other threads insert and erase
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([this, t]() {
+            for (int i = 0; i < 10000; i++) {
+                int key = i % 100;
+                std::string result;
+                Cache::Handle* handle = _cache->lookup(EncodeKey(&result, key));
+                if (handle != NULL) {
+                    ASSERT_EQ(1000 + key, DecodeValue(_cache->value(handle)));
+                    _cache->release(handle);
+                }
+                if (t == 0) {
+                    std::string other;
+                    _cache->release(_cache->insert(EncodeKey(&other, 10000 + i % 2000),
+                                                   EncodeValue(i), 1, &CacheTest::DeleterNop));
+                } else if (t == 1 && i % 10 == 0) {
+                    Erase(200 + i % 100);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
 TEST_F(CacheTest, NewId) {
     uint64_t a = _cache->new_id();
     uint64_t b = _cache->new_id();
@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "olap/ngram_index_reader.h"
+#include "olap/ngram_index_writer.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestNgramIndex : public testing::Test {
+public:
+    virtual ~TestNgramIndex() {}
+
+protected:
+    // writes the index of 'writer' and opens 'reader' on it
+    void write_and_read(NgramIndexWriter* writer, NgramIndexReader* reader) {
+        std::string buffer;
+        ASSERT_EQ(OLAP_SUCCESS, writer->write_to_buffer(&buffer));
+        char* copy = new char[buffer.size()];
+        memcpy(copy, buffer.data(), buffer.size());
+        ASSERT_EQ(OLAP_SUCCESS, reader->init(copy, buffer.size(), false));
+    }
+};
+
+TEST_F(TestNgramIndex, like_literals) {
+    std::vector<std::string> literals;
+    NgramIndexReader::like_literals("%error%timeout_ms%", &literals);
+    ASSERT_EQ(std::vector<std::string>({"error", "timeout", "ms"}), literals);
+
+    NgramIndexReader::like_literals("100\\%_done", &literals);
+    ASSERT_EQ(std::vector<std::string>({"100%", "done"}), literals);
+
+    NgramIndexReader::like_literals("%%", &literals);
+    ASSERT_TRUE(literals.empty());
+}
+
+TEST_F(TestNgramIndex, match_like) {
+    NgramIndexWriter writer(1024);
+    std::string values[] = {
+        "connect timeout to host a", "read ok", "error: disk full", "ERROR: timeout"};
+    for (uint32_t row = 0; row < 100; ++row) {
+        const std::string& value = values[row % 4];
+        writer.add(value.data(), value.size(), row);
+    }
+    ASSERT_TRUE(writer.is_valid());
+
+    NgramIndexReader reader;
+    write_and_read(&writer, &reader);
+
+    RoaringBitmap rows;
+    ASSERT_TRUE(reader.match_like("%timeout%", &rows));
+    for (uint32_t row = 0; row < 100; ++row) {
+        ASSERT_EQ(row % 4 == 0 || row % 4 == 3, rows.contains(row)) << row;
+    }
+
+    // grams are case sensitive like LIKE
+    ASSERT_TRUE(reader.match_like("error%full", &rows));
+    for (uint32_t row = 0; row < 100; ++row) {
+        ASSERT_EQ(row % 4 == 2, rows.contains(row)) << row;
+    }
+
+    ASSERT_TRUE(reader.match_like("%no such text%", &rows));
+    ASSERT_EQ(0, rows.cardinality());
+
+    // literals shorter than a gram can not be told
+    ASSERT_FALSE(reader.match_like("%ok%", &rows));
+}
+
+TEST_F(TestNgramIndex, too_many_grams) {
+    NgramIndexWriter writer(4);
+    writer.add("abcdef", 6, 0);
+    ASSERT_TRUE(writer.is_valid());
+    writer.add("abcdefg", 7, 1);
+    ASSERT_FALSE(writer.is_valid());
+    std::string buffer;
+    ASSERT_NE(OLAP_SUCCESS, writer.write_to_buffer(&buffer));
+}
+
+TEST_F(TestNgramIndex, invalid_buffer) {
+    NgramIndexReader reader;
+    char* buffer = new char[6];
+    memset(buffer, 0xFF, 6);
+    ASSERT_NE(OLAP_SUCCESS, reader.init(buffer, 6, false));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -23,9 +23,11 @@
 #include <boost/filesystem.hpp>
 #include <json2pb/json_to_pb.h>
 
+#include "common/config.h"
 #include "olap/store.h"
 #include "olap/olap_header_manager.h"
 #include "olap/olap_define.h"
+#include "olap/olap_meta.h"
 #include "util/file_utils.h"
 
 #ifndef BE_TEST
@@ -101,6 +103,83 @@ TEST_F(OlapHeaderManagerTest, TestSaveAndGetAndRemove) {
     ASSERT_EQ(OLAP_ERR_META_KEY_NOT_FOUND, s);
 }
 
+TEST_F(OlapHeaderManagerTest, TestDeltaRecords) {
+    const TTabletId tablet_id = 20487;
+    const TSchemaHash schema_hash = 1520686811;
+    config::save_header_delta_records = true;
+    OLAPHeader header;
+    ASSERT_TRUE(json2pb::JsonToProtoMessage(_json_header, &header));
+    header.clear_file_version();
+    for (int64_t version : {1, 2, 3}) {
+        PDelta* delta = header.add_delta();
+        delta->set_start_version(version == 1 ? 0 : version);
+        delta->set_end_version(version);
+        delta->set_version_hash(version);
+        delta->set_creation_time(version);
+    }
+    OLAPStatus s = OlapHeaderManager::save(_store, tablet_id, schema_hash, &header);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+
+    auto count_records = [this]() {
+        int num_records = 0;
+        _store->get_meta()->iterate(META_COLUMN_FAMILY_INDEX, "hdrd_",
+                [&num_records](const std::string& key, const std::string& value) {
+                    ++num_records;
+                    return true;
+                });
+        return num_records;
+    };
+    ASSERT_EQ(3, count_records());
+    // the deltas are not in the header record
+    std::string value;
+    std::stringstream key_stream;
+    key_stream << "hdr_" << tablet_id << "_" << schema_hash;
+    s = _store->get_meta()->get(META_COLUMN_FAMILY_INDEX, key_stream.str(), value);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+    OLAPHeaderMessage base;
+    ASSERT_TRUE(base.ParseFromString(value));
+    ASSERT_EQ(0, base.delta_size());
+
+    OLAPHeader header_read;
+    s = OlapHeaderManager::get_header(_store, tablet_id, schema_hash, &header_read);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+    ASSERT_EQ(3, header_read.delta_size());
+    ASSERT_EQ(2, header_read.delta(1).start_version());
+    ASSERT_EQ(header.SerializeAsString(), header_read.SerializeAsString());
+
+    // deleted and changed deltas are found at the next save
+    ASSERT_EQ(OLAP_SUCCESS, header_read.delete_version(Version(3, 3)));
+    PSegmentGroup* segment_group =
+            const_cast<PDelta*>(&header_read.delta(1))->add_segment_group();
+    segment_group->set_segment_group_id(0);
+    segment_group->set_num_segments(1);
+    segment_group->set_index_size(10);
+    segment_group->set_data_size(10);
+    segment_group->set_num_rows(10);
+    s = OlapHeaderManager::save(_store, tablet_id, schema_hash, &header_read);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+    ASSERT_EQ(2, count_records());
+    OLAPHeader header_reread;
+    s = OlapHeaderManager::get_header(_store, tablet_id, schema_hash, &header_reread);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+    ASSERT_EQ(header_read.SerializeAsString(), header_reread.SerializeAsString());
+
+    // headers saved without delta records replace them
+    config::save_header_delta_records = false;
+    s = OlapHeaderManager::save(_store, tablet_id, schema_hash, &header_reread);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+    ASSERT_EQ(0, count_records());
+
+    config::save_header_delta_records = true;
+    s = OlapHeaderManager::save(_store, tablet_id, schema_hash, &header_reread);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+    ASSERT_EQ(2, count_records());
+    s = OlapHeaderManager::remove(_store, tablet_id, schema_hash);
+    ASSERT_EQ(OLAP_SUCCESS, s);
+    ASSERT_EQ(0, count_records());
+    config::save_header_delta_records = false;
+}
+
 TEST_F(OlapHeaderManagerTest, TestLoad) {
     const TTabletId tablet_id = 20487;
     const TSchemaHash schema_hash = 1520686811;
@@ -0,0 +1,114 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "boost/filesystem.hpp"
+#include "olap/file_helper.h"
+#include "olap/lru_cache.h"
+#include "olap/packed_file.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class PackedFileTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        if (boost::filesystem::exists(_s_test_data_path)) {
+            boost::filesystem::remove_all(_s_test_data_path);
+        }
+        ASSERT_TRUE(boost::filesystem::create_directory(_s_test_data_path));
+        FileHandler::set_fd_cache(new_lru_cache(100));
+    }
+
+    virtual void TearDown() {
+        delete FileHandler::get_fd_cache();
+        FileHandler::set_fd_cache(nullptr);
+        ASSERT_TRUE(boost::filesystem::remove_all(_s_test_data_path));
+    }
+
+    void write_file(const std::string& path, const std::string& content) {
+        FileHandler handler;
+        ASSERT_EQ(OLAP_SUCCESS, handler.open_with_mode(
+                path, O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        ASSERT_EQ(OLAP_SUCCESS, handler.write(content.data(), content.size()));
+        ASSERT_EQ(OLAP_SUCCESS, handler.close());
+    }
+
+    static std::string _s_test_data_path;
+};
+
+std::string PackedFileTest::_s_test_data_path = "./log/packed_file_test";
+
+TEST_F(PackedFileTest, PackAndReadMembers) {
+    std::vector<std::string> contents = {
+            std::string(10, 'a'), std::string(5000, 'b'), std::string(1, 'c')};
+    std::vector<std::string> names;
+    std::vector<std::string> paths;
+    for (int i = 0; i < contents.size(); ++i) {
+        names.push_back(packed_member_name(i, "dat"));
+        paths.push_back(_s_test_data_path + "/" + std::to_string(i) + ".dat");
+        write_file(paths.back(), contents[i]);
+    }
+    std::string packed_path = packed_file_path(paths[0]);
+    ASSERT_EQ(_s_test_data_path + "/0.pack", packed_path);
+    ASSERT_EQ(OLAP_SUCCESS, write_packed_file(names, paths, packed_path));
+
+    PackedFileDirectory directory;
+    ASSERT_EQ(OLAP_SUCCESS, read_packed_file_directory(packed_path, &directory));
+    ASSERT_EQ(contents.size(), directory.size());
+    for (int i = 0; i < contents.size(); ++i) {
+        auto it = directory.find(names[i]);
+        ASSERT_TRUE(it != directory.end());
+        ASSERT_EQ(0, it->second.offset % 4096);
+        ASSERT_EQ(contents[i].size(), it->second.length);
+
+        FileHandler handler;
+        ASSERT_EQ(OLAP_SUCCESS, handler.open_range_with_cache(
+                packed_path, O_RDONLY, it->second.offset, it->second.length));
+        ASSERT_EQ(contents[i].size(), handler.length());
+        ASSERT_EQ(it->second.offset, handler.base_offset());
+        std::string buf(contents[i].size(), '\0');
+        ASSERT_EQ(OLAP_SUCCESS, handler.pread(&buf[0], buf.size(), 0));
+        ASSERT_EQ(contents[i], buf);
+        ASSERT_EQ(OLAP_SUCCESS, handler.close());
+    }
+}
+
+TEST_F(PackedFileTest, ExistingPackedFileIsNotOverwritten) {
+    std::string path = _s_test_data_path + "/0.dat";
+    write_file(path, "abc");
+    std::string packed_path = packed_file_path(path);
+    write_file(packed_path, "xyz");
+    ASSERT_NE(OLAP_SUCCESS, write_packed_file({"0.dat"}, {path}, packed_path));
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "olap/pre_aggregate.h"
+#include "olap/row_cursor.h"
+#include "olap/sorted_run_file.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestPreAggregate : public testing::Test {
+public:
+    virtual void SetUp() {
+        system("mkdir -p ./ut_dir");
+        system("rm -rf ./ut_dir/pre_aggregate.pagg");
+        _schema.push_back(make_field("k1", OLAP_FIELD_TYPE_INT, 4,
+                                     OLAP_FIELD_AGGREGATION_NONE, true));
+        _schema.push_back(make_field("k2", OLAP_FIELD_TYPE_VARCHAR, 20,
+                                     OLAP_FIELD_AGGREGATION_NONE, true));
+        _schema.push_back(make_field("k3", OLAP_FIELD_TYPE_INT, 4,
+                                     OLAP_FIELD_AGGREGATION_NONE, true));
+        _schema.push_back(make_field("v1", OLAP_FIELD_TYPE_BIGINT, 8,
+                                     OLAP_FIELD_AGGREGATION_SUM, false));
+        _schema.push_back(make_field("v2", OLAP_FIELD_TYPE_INT, 4,
+                                     OLAP_FIELD_AGGREGATION_MAX, false));
+        _schema.push_back(make_field("v3", OLAP_FIELD_TYPE_VARCHAR, 20,
+                                     OLAP_FIELD_AGGREGATION_REPLACE, false));
+        ASSERT_EQ(OLAP_SUCCESS, _row.init(_schema));
+    }
+
+    virtual void TearDown() {
+        system("rm -rf ./ut_dir/pre_aggregate.pagg");
+    }
+
+    static FieldInfo make_field(const std::string& name, FieldType type, uint32_t length,
+                                FieldAggregationMethod aggregation, bool is_key) {
+        FieldInfo field_info;
+        field_info.name = name;
+        field_info.type = type;
+        field_info.aggregation = aggregation;
+        field_info.length = length;
+        field_info.is_allow_null = !is_key;
+        field_info.is_key = is_key;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        return field_info;
+    }
+
+    void set_row(int32_t k1, std::string* k2, int32_t k3, int64_t v1, int32_t v2) {
+        _row.set_not_null(0);
+        *reinterpret_cast<int32_t*>(_row.get_field_content_ptr(0)) = k1;
+        _row.set_not_null(1);
+        Slice* slice = reinterpret_cast<Slice*>(_row.get_field_content_ptr(1));
+        slice->data = &(*k2)[0];
+        slice->size = k2->size();
+        _row.set_not_null(2);
+        *reinterpret_cast<int32_t*>(_row.get_field_content_ptr(2)) = k3;
+        _row.set_not_null(3);
+        *reinterpret_cast<int64_t*>(_row.get_field_content_ptr(3)) = v1;
+        _row.set_not_null(4);
+        *reinterpret_cast<int32_t*>(_row.get_field_content_ptr(4)) = v2;
+        _row.set_null(5);
+    }
+
+    std::vector<FieldInfo> _schema;
+    RowCursor _row;
+    std::string _file_name = "./ut_dir/pre_aggregate.pagg";
+};
+
+TEST_F(TestPreAggregate, columns) {
+    std::vector<uint32_t> key_cids;
+    std::vector<uint32_t> value_cids;
+    ASSERT_TRUE(get_pre_aggregate_columns(_schema, 2, &key_cids, &value_cids));
+    ASSERT_EQ(std::vector<uint32_t>({0, 1}), key_cids);
+    // strings and replaced values are not kept
+    ASSERT_EQ(std::vector<uint32_t>({3, 4}), value_cids);
+
+    ASSERT_FALSE(get_pre_aggregate_columns(_schema, 0, &key_cids, &value_cids));
+
+    ASSERT_EQ("./data/10001_2_3_300_0_0.pagg",
+              pre_aggregate_file_path("./data/10001_2_3_300_0_0.dat"));
+}
+
+TEST_F(TestPreAggregate, write_and_read) {
+    std::vector<uint32_t> key_cids;
+    std::vector<uint32_t> value_cids;
+    ASSERT_TRUE(get_pre_aggregate_columns(_schema, 2, &key_cids, &value_cids));
+
+    PreAggregateWriter writer(_schema, key_cids, value_cids);
+    ASSERT_EQ(OLAP_SUCCESS, writer.open(_file_name));
+    // 5 rows of every prefix, whose strings change after they are added
+    for (int32_t i = 0; i < 100; ++i) {
+        std::string k2 = (i % 10) < 5 ? "a" : "b";
+        set_row(i / 10, &k2, i, i, i % 7);
+        ASSERT_EQ(OLAP_SUCCESS, writer.add(_row));
+        k2 = "x";
+    }
+    ASSERT_EQ(OLAP_SUCCESS, writer.close());
+    ASSERT_EQ(20U, writer.num_rows());
+
+    std::vector<uint32_t> columns(key_cids);
+    columns.insert(columns.end(), value_cids.begin(), value_cids.end());
+    SortedRunReader reader(_schema, columns, 1024);
+    ASSERT_EQ(OLAP_SUCCESS, reader.open(_file_name));
+    for (int32_t group = 0; group < 20; ++group) {
+        ASSERT_FALSE(reader.eof());
+        const RowCursor* row = reader.current();
+        ASSERT_EQ(group / 2, *reinterpret_cast<const int32_t*>(row->get_field_content_ptr(0)));
+        const Slice* slice = reinterpret_cast<const Slice*>(row->get_field_content_ptr(1));
+        ASSERT_EQ(group % 2 == 0 ? "a" : "b", std::string(slice->data, slice->size));
+        int64_t sum = 0;
+        int32_t max = 0;
+        for (int32_t i = group * 5; i < group * 5 + 5; ++i) {
+            sum += i;
+            max = std::max(max, i % 7);
+        }
+        ASSERT_EQ(sum, *reinterpret_cast<const int64_t*>(row->get_field_content_ptr(3)));
+        ASSERT_EQ(max, *reinterpret_cast<const int32_t*>(row->get_field_content_ptr(4)));
+        ASSERT_EQ(OLAP_SUCCESS, reader.next());
+    }
+    ASSERT_TRUE(reader.eof());
+}
+
+TEST_F(TestPreAggregate, out_of_order) {
+    std::vector<uint32_t> key_cids;
+    std::vector<uint32_t> value_cids;
+    ASSERT_TRUE(get_pre_aggregate_columns(_schema, 2, &key_cids, &value_cids));
+
+    PreAggregateWriter writer(_schema, key_cids, value_cids);
+    ASSERT_EQ(OLAP_SUCCESS, writer.open(_file_name));
+    std::string k2 = "b";
+    set_row(1, &k2, 0, 1, 1);
+    ASSERT_EQ(OLAP_SUCCESS, writer.add(_row));
+    k2 = "a";
+    set_row(1, &k2, 1, 1, 1);
+    ASSERT_NE(OLAP_SUCCESS, writer.add(_row));
+
+    writer.abandon();
+    FILE* file = fopen(_file_name.c_str(), "r");
+    ASSERT_TRUE(file == nullptr);
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
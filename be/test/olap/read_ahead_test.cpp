@@ -0,0 +1,166 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "boost/filesystem.hpp"
+#include "common/config.h"
+#include "olap/file_helper.h"
+#include "olap/olap_define.h"
+#include "olap/read_ahead.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class ReadAheadTest : public testing::Test {
+public:
+    virtual void SetUp() {
+        if (boost::filesystem::exists(_s_test_data_path)) {
+            boost::filesystem::remove_all(_s_test_data_path);
+        }
+        ASSERT_TRUE(boost::filesystem::create_directory(_s_test_data_path));
+
+        _data.resize(1 << 20);
+        for (size_t i = 0; i < _data.size(); ++i) {
+            _data[i] = static_cast<char>(i * 131 + (i >> 8));
+        }
+        FileHandler writer;
+        ASSERT_EQ(OLAP_SUCCESS, writer.open_with_mode(_file_name(),
+                O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        ASSERT_EQ(OLAP_SUCCESS, writer.write(_data.data(), _data.size()));
+        writer.close();
+        ASSERT_EQ(OLAP_SUCCESS, _file_handler.open(_file_name(), O_RDONLY));
+    }
+
+    virtual void TearDown() {
+        _file_handler.close();
+        ASSERT_TRUE(boost::filesystem::remove_all(_s_test_data_path));
+    }
+
+    std::string _file_name() {
+        return _s_test_data_path + "/data";
+    }
+
+    static std::string _s_test_data_path;
+
+    std::vector<char> _data;
+    FileHandler _file_handler;
+};
+
+std::string ReadAheadTest::_s_test_data_path = "./log/read_ahead_test";
+
+TEST_F(ReadAheadTest, SequentialRead) {
+    ReadAheadQueue queue(2, 4);
+    StreamReadAhead read_ahead(&queue, &_file_handler, 64 * 1024);
+
+    size_t begin = 100;
+    size_t end = _data.size() - 100;
+    std::vector<char> buf(10000);
+    for (size_t offset = begin; offset < end;) {
+        size_t length = std::min(buf.size(), end - offset);
+        ASSERT_EQ(OLAP_SUCCESS, read_ahead.read(buf.data(), length, offset, end));
+        ASSERT_EQ(0, memcmp(buf.data(), _data.data() + offset, length));
+        offset += length;
+    }
+}
+
+TEST_F(ReadAheadTest, Seek) {
+    // a queue of depth 1 also makes some reads fall back to pread
+    ReadAheadQueue queue(1, 1);
+    StreamReadAhead read_ahead1(&queue, &_file_handler, 10000);
+    StreamReadAhead read_ahead2(&queue, &_file_handler, 10000);
+
+    std::vector<char> buf(30000);
+    size_t offsets[] = {0, 5000, 200000, 4000, 4000, 1000000, 60000};
+    size_t lengths[] = {5000, 30000, 7, 1000, 30000, 48576, 1};
+    for (int i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+        for (StreamReadAhead* read_ahead : {&read_ahead1, &read_ahead2}) {
+            ASSERT_EQ(OLAP_SUCCESS, read_ahead->read(buf.data(), lengths[i], offsets[i],
+                                                     _data.size()));
+            ASSERT_EQ(0, memcmp(buf.data(), _data.data() + offsets[i], lengths[i]));
+        }
+    }
+}
+
+TEST_F(ReadAheadTest, GroupShare) {
+    // no workers, submitted reads stay in flight
+    ReadAheadQueue queue(0, 4);
+    std::vector<std::shared_ptr<ReadAheadBuffer>> buffers;
+    for (int i = 0; i < 5; ++i) {
+        buffers.emplace_back(new ReadAheadBuffer(1024));
+    }
+    ReadAheadQueue::set_thread_group(1, 1);
+    // a group alone gets half of the depth
+    ASSERT_TRUE(queue.submit(buffers[0], &_file_handler, 0, 1024));
+    ASSERT_TRUE(queue.submit(buffers[1], &_file_handler, 1024, 1024));
+    ASSERT_FALSE(queue.submit(buffers[2], &_file_handler, 2048, 1024));
+    ASSERT_FALSE(buffers[2]->is_busy());
+
+    ReadAheadQueue::set_thread_group(2, 1);
+    ASSERT_TRUE(queue.submit(buffers[2], &_file_handler, 2048, 1024));
+    ASSERT_TRUE(queue.submit(buffers[3], &_file_handler, 3072, 1024));
+    ASSERT_FALSE(queue.submit(buffers[4], &_file_handler, 4096, 1024));
+    ReadAheadQueue::set_thread_group(0, 1);
+
+    // queued reads are done by the waiting thread
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(OLAP_SUCCESS, buffers[i]->wait());
+        ASSERT_EQ(0, memcmp(buffers[i]->data(), _data.data() + i * 1024, 1024));
+    }
+}
+
+TEST_F(ReadAheadTest, BatchRead) {
+    // without a queue windows are filled by pread or by batches
+    StreamReadAhead read_ahead1(nullptr, &_file_handler, 20000);
+    StreamReadAhead read_ahead2(nullptr, &_file_handler, 20000);
+    std::vector<char> buf(20000);
+    size_t offsets[] = {0, 700000};
+    size_t end = _data.size();
+    for (int round = 0; round < 3; ++round) {
+        BatchReadRequest requests[2];
+        StreamReadAhead* streams[] = {&read_ahead1, &read_ahead2};
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_TRUE(streams[i]->prepare_batch_read(offsets[i], 20000, end, &requests[i]));
+        }
+        OLAPStatus res = FileHandler::pread_batch(requests, 2, round != 2);
+        ASSERT_EQ(OLAP_SUCCESS, res);
+        for (int i = 0; i < 2; ++i) {
+            streams[i]->finish_batch_read(requests[i].status);
+            // the window holds the range now
+            ASSERT_FALSE(streams[i]->prepare_batch_read(offsets[i], 20000, end, &requests[i]));
+            ASSERT_EQ(OLAP_SUCCESS, streams[i]->read(buf.data(), 15000, offsets[i], end));
+            ASSERT_EQ(0, memcmp(buf.data(), _data.data() + offsets[i], 15000));
+            offsets[i] += 15000;
+        }
+    }
+}
+
+}  // namespace doris
+
+int main(int argc, char **argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -453,6 +453,80 @@ TEST_F(TestRowCursor, FullKeyCmp) {
     ASSERT_GT(left.full_key_cmp(right_gt), 0);
 }
 
+TEST_F(TestRowCursor, FullKeyCmpWithNull) {
+    std::vector<FieldInfo> tablet_schema;
+    set_tablet_schema_for_cmp_and_aggregate(&tablet_schema);
+
+    RowCursor left;
+    OLAPStatus res = left.init(tablet_schema);
+    ASSERT_EQ(res, OLAP_SUCCESS);
+    Slice l_char("well");
+    left.set_not_null(0);
+    left.set_field_content(0, reinterpret_cast<char*>(&l_char), _mem_pool.get());
+    left.set_null(1);
+
+    RowCursor right;
+    res = right.init(tablet_schema);
+    ASSERT_EQ(res, OLAP_SUCCESS);
+    Slice r_char("well");
+    int32_t r_int = -10;
+    right.set_not_null(0);
+    right.set_field_content(0, reinterpret_cast<char*>(&r_char), _mem_pool.get());
+    right.set_not_null(1);
+    right.set_field_content(1, reinterpret_cast<char*>(&r_int), _mem_pool.get());
+    // nulls are less than any value
+    ASSERT_LT(left.full_key_cmp(right), 0);
+    ASSERT_GT(right.full_key_cmp(left), 0);
+    ASSERT_LT(left.cmp(right), 0);
+
+    right.set_null(1);
+    ASSERT_EQ(left.full_key_cmp(right), 0);
+
+    right.set_null(0);
+    ASSERT_GT(left.full_key_cmp(right), 0);
+    ASSERT_GT(left.cmp(right), 0);
+}
+
+TEST_F(TestRowCursor, FullKeyCmpBeyondInlineColumns) {
+    std::vector<FieldInfo> tablet_schema;
+    FieldType types[] = { OLAP_FIELD_TYPE_BIGINT, OLAP_FIELD_TYPE_DATETIME,
+                          OLAP_FIELD_TYPE_SMALLINT };
+    for (int i = 0; i < 3; ++i) {
+        FieldInfo key;
+        key.name = "k" + std::to_string(i + 1);
+        key.type = types[i];
+        key.length = i == 2 ? 2 : 8;
+        key.is_key = true;
+        key.index_length = key.length;
+        key.is_allow_null = true;
+        tablet_schema.push_back(key);
+    }
+
+    RowCursor left;
+    RowCursor right;
+    ASSERT_EQ(left.init(tablet_schema), OLAP_SUCCESS);
+    ASSERT_EQ(right.init(tablet_schema), OLAP_SUCCESS);
+    int64_t k1 = 7;
+    int64_t k2 = 20190101000000;
+    int16_t l_k3 = 3;
+    int16_t r_k3 = 4;
+    for (int i = 0; i < 3; ++i) {
+        left.set_not_null(i);
+        right.set_not_null(i);
+    }
+    left.set_field_content(0, reinterpret_cast<char*>(&k1), _mem_pool.get());
+    right.set_field_content(0, reinterpret_cast<char*>(&k1), _mem_pool.get());
+    left.set_field_content(1, reinterpret_cast<char*>(&k2), _mem_pool.get());
+    right.set_field_content(1, reinterpret_cast<char*>(&k2), _mem_pool.get());
+    left.set_field_content(2, reinterpret_cast<char*>(&l_k3), _mem_pool.get());
+    right.set_field_content(2, reinterpret_cast<char*>(&r_k3), _mem_pool.get());
+    ASSERT_LT(left.full_key_cmp(right), 0);
+    ASSERT_GT(right.full_key_cmp(left), 0);
+
+    right.set_field_content(2, reinterpret_cast<char*>(&l_k3), _mem_pool.get());
+    ASSERT_EQ(left.full_key_cmp(right), 0);
+}
+
 TEST_F(TestRowCursor, AggregateWithoutNull) {
     std::vector<FieldInfo> tablet_schema;
     set_tablet_schema_for_cmp_and_aggregate(&tablet_schema);
@@ -570,6 +644,92 @@ TEST_F(TestRowCursor, AggregateWithNull) {
     ASSERT_TRUE(is_null_varchar);
 }
 
+TEST_F(TestRowCursor, AggregateRun) {
+    std::vector<FieldInfo> tablet_schema;
+    FieldInfo k1;
+    k1.name = "k1";
+    k1.type = OLAP_FIELD_TYPE_INT;
+    k1.length = 4;
+    k1.is_key = true;
+    k1.index_length = 4;
+    k1.is_allow_null = true;
+    tablet_schema.push_back(k1);
+    FieldInfo v1;
+    v1.name = "v1";
+    v1.type = OLAP_FIELD_TYPE_BIGINT;
+    v1.length = 8;
+    v1.aggregation = OLAP_FIELD_AGGREGATION_SUM;
+    v1.is_key = false;
+    v1.is_allow_null = true;
+    tablet_schema.push_back(v1);
+    FieldInfo v2 = v1;
+    v2.name = "v2";
+    v2.type = OLAP_FIELD_TYPE_DOUBLE;
+    tablet_schema.push_back(v2);
+    FieldInfo v3 = v1;
+    v3.name = "v3";
+    v3.type = OLAP_FIELD_TYPE_INT;
+    v3.length = 4;
+    v3.aggregation = OLAP_FIELD_AGGREGATION_REPLACE;
+    tablet_schema.push_back(v3);
+    FieldInfo v4 = v3;
+    v4.name = "v4";
+    v4.aggregation = OLAP_FIELD_AGGREGATION_MAX;
+    tablet_schema.push_back(v4);
+    std::vector<uint32_t> value_cids = {1, 2, 3, 4};
+
+    // rows of a block, every third value is null
+    RowCursor block_row;
+    ASSERT_EQ(OLAP_SUCCESS, block_row.init(tablet_schema));
+    size_t row_bytes = block_row.get_fixed_len();
+    const size_t num_rows = 10;
+    std::vector<char> block(row_bytes * num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        block_row.attach(&block[i * row_bytes]);
+        int32_t key = 1;
+        int64_t sum = i * 100;
+        double double_sum = i * 0.5;
+        int32_t value = i * 7 % 5;
+        block_row.set_field_content(0, reinterpret_cast<char*>(&key), _mem_pool.get());
+        block_row.set_field_content(1, reinterpret_cast<char*>(&sum), _mem_pool.get());
+        block_row.set_field_content(2, reinterpret_cast<char*>(&double_sum), _mem_pool.get());
+        block_row.set_field_content(3, reinterpret_cast<char*>(&value), _mem_pool.get());
+        block_row.set_field_content(4, reinterpret_cast<char*>(&value), _mem_pool.get());
+        for (uint32_t cid : value_cids) {
+            if (i % 3 == 2) {
+                block_row.set_null(cid);
+            } else {
+                block_row.set_not_null(cid);
+            }
+        }
+    }
+
+    // a run gives the same result as aggregating the rows one by one
+    RowCursor expected;
+    ASSERT_EQ(OLAP_SUCCESS, expected.init(tablet_schema));
+    RowCursor row;
+    ASSERT_EQ(OLAP_SUCCESS, row.init(tablet_schema));
+    block_row.attach(&block[0]);
+    expected.agg_init(block_row);
+    row.agg_init(block_row);
+    for (size_t i = 1; i < num_rows; ++i) {
+        block_row.attach(&block[i * row_bytes]);
+        RowCursor::aggregate(value_cids, &expected, &block_row);
+    }
+    block_row.attach(&block[row_bytes]);
+    RowCursor::aggregate_run(value_cids, &row, &block_row, row_bytes, num_rows - 1);
+
+    for (uint32_t cid : value_cids) {
+        ASSERT_EQ(expected.is_null(cid), row.is_null(cid));
+        ASSERT_EQ(0, memcmp(expected.get_field_content_ptr(cid), row.get_field_content_ptr(cid),
+                            row.get_field_by_index(cid)->size()));
+    }
+    ASSERT_EQ(3000, *reinterpret_cast<int64_t*>(row.get_field_content_ptr(1)));
+    // replaced by the last row
+    ASSERT_FALSE(row.is_null(3));
+    ASSERT_EQ(3, *reinterpret_cast<int32_t*>(row.get_field_content_ptr(3)));
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
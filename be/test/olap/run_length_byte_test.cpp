@@ -26,6 +26,8 @@
 #include "olap/column_reader.h"
 #include "olap/stream_index_reader.h"
 #include "olap/stream_index_writer.h"
+#include "olap/lru_cache.h"
+#include "runtime/mem_tracker.h"
 #include "util/logging.h"
 
 namespace doris {
@@ -827,6 +829,41 @@ TEST_F(TestRunLengthByte, Seek) {
     ASSERT_EQ(value, 0x61);
 }
 
+TEST_F(TestRunLengthByte, ReadThroughPageCache) {
+    for (int32_t i = 0; i < 10000; i++) {
+        _writer->write(static_cast<char>(i % 7 == 0 ? 0x5a : i));
+    }
+    _writer->flush();
+    CreateReader();
+
+    for (bool decompressed : {false, true}) {
+        Cache* cache = new_lru_cache(10 * 1024 * 1024);
+        MemTracker mem_tracker(-1, "DataPageCache");
+        OlapReaderStatistics stats;
+        // the first stream fills the cache, the second one reads from it
+        for (int round = 0; round < 2; ++round) {
+            StorageByteBuffer* shared_buffer = StorageByteBuffer::create(
+                    OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE + sizeof(StreamHead));
+            ReadOnlyFileStream stream(&helper, &shared_buffer, 0, helper.length(),
+                    NULL, OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE, &stats);
+            ASSERT_EQ(OLAP_SUCCESS, stream.init());
+            stream.set_page_cache(cache, &mem_tracker, decompressed);
+            RunLengthByteReader reader(&stream);
+            for (int32_t i = 0; i < 10000; i++) {
+                char value = 0;
+                ASSERT_EQ(OLAP_SUCCESS, reader.next(&value));
+                ASSERT_EQ(static_cast<char>(i % 7 == 0 ? 0x5a : i), value);
+            }
+            ASSERT_FALSE(reader.has_next());
+            ASSERT_EQ(round == 0, stats.data_page_cache_hits == 0);
+            SAFE_DELETE(shared_buffer);
+        }
+        ASSERT_GT(mem_tracker.consumption(), 0);
+        delete cache;
+        ASSERT_EQ(0, mem_tracker.consumption());
+    }
+}
+
 TEST_F(TestRunLengthByte, Skip) {
     // write data
     char write_data[] = {0x5a, 0x5b, 0x5c, 0x5d};
@@ -0,0 +1,182 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/segment_group_builder.h"
+
+#include <unistd.h>
+
+#include <string>
+#include <gtest/gtest.h>
+
+#include "gen_cpp/AgentService_types.h"
+#include "olap/olap_engine.h"
+#include "olap/olap_table.h"
+#include "olap/options.h"
+#include "olap/utils.h"
+#include "util/cpu_info.h"
+#include "util/logging.h"
+
+namespace doris {
+
+static const uint32_t MAX_PATH_LEN = 1024;
+static const int64_t TABLET_ID = 10005;
+static const int32_t SCHEMA_HASH = 270068377;
+
+OLAPEngine* k_engine = nullptr;
+
+void set_up() {
+    char buffer[MAX_PATH_LEN];
+    getcwd(buffer, MAX_PATH_LEN);
+    config::storage_root_path = std::string(buffer) + "/data_ingest";
+    remove_all_dir(config::storage_root_path);
+    create_dir(config::storage_root_path);
+    std::vector<StorePath> paths;
+    paths.emplace_back(config::storage_root_path, -1);
+
+    doris::EngineOptions options;
+    options.store_paths = paths;
+    doris::OLAPEngine::open(options, &k_engine);
+}
+
+void tear_down() {
+    system("rm -rf ./data_ingest ./ingest_build");
+    remove_all_dir(std::string(getenv("DORIS_HOME")) + UNUSED_PREFIX);
+}
+
+void create_table_request(TCreateTabletReq* request) {
+    request->tablet_id = TABLET_ID;
+    request->__set_version(1);
+    request->__set_version_hash(0);
+    request->tablet_schema.schema_hash = SCHEMA_HASH;
+    request->tablet_schema.short_key_column_count = 1;
+    request->tablet_schema.keys_type = TKeysType::AGG_KEYS;
+    request->tablet_schema.storage_type = TStorageType::COLUMN;
+
+    TColumn k1;
+    k1.column_name = "k1";
+    k1.__set_is_key(true);
+    k1.column_type.type = TPrimitiveType::INT;
+    request->tablet_schema.columns.push_back(k1);
+
+    TColumn v1;
+    v1.column_name = "v1";
+    v1.__set_is_key(false);
+    v1.column_type.type = TPrimitiveType::BIGINT;
+    v1.__set_aggregation_type(TAggregationType::SUM);
+    request->tablet_schema.columns.push_back(v1);
+}
+
+class SegmentGroupBuilderTest : public testing::Test {
+public:
+    void SetUp() override {
+        TCreateTabletReq request;
+        create_table_request(&request);
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->create_table(request));
+        _table = k_engine->get_table(TABLET_ID, SCHEMA_HASH);
+        ASSERT_TRUE(_table != nullptr);
+
+        char buffer[MAX_PATH_LEN];
+        getcwd(buffer, MAX_PATH_LEN);
+        _build_root = std::string(buffer) + "/ingest_build";
+        remove_all_dir(_build_root);
+        ASSERT_EQ(OLAP_SUCCESS, create_dir(_build_root));
+    }
+
+    void TearDown() override {
+        _table.reset();
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->drop_table(TABLET_ID, SCHEMA_HASH));
+    }
+
+protected:
+    OLAPStatus add_row(SegmentGroupBuilder* builder, int32_t k1, int64_t v1) {
+        RowCursor row;
+        row.init(builder->tablet_schema());
+        row.set_not_null(0);
+        row.set_field_content(0, reinterpret_cast<char*>(&k1), nullptr);
+        row.set_not_null(1);
+        row.set_field_content(1, reinterpret_cast<char*>(&v1), nullptr);
+        return builder->add_row(row);
+    }
+
+    OLAPTablePtr _table;
+    std::string _build_root;
+};
+
+TEST_F(SegmentGroupBuilderTest, ingest) {
+    int64_t partition_id = 10;
+    int64_t transaction_id = 20;
+    SegmentGroupBuilder builder(*_table->get_header(), _build_root,
+                                partition_id, transaction_id, 0);
+    ASSERT_EQ(OLAP_SUCCESS, builder.init());
+    for (int32_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(OLAP_SUCCESS, add_row(&builder, i / 2, i));
+    }
+    ASSERT_EQ(OLAP_SUCCESS, builder.finalize());
+    ASSERT_EQ(1000, builder.num_rows());
+
+    PUniqueId load_id;
+    load_id.set_hi(1);
+    load_id.set_lo(2);
+    ASSERT_EQ(OLAP_SUCCESS, k_engine->ingest_segment_groups(
+            TABLET_ID, SCHEMA_HASH, partition_id, transaction_id, load_id, builder.dir_path()));
+    ASSERT_TRUE(_table->has_pending_data(transaction_id));
+    ASSERT_TRUE(k_engine->has_transaction(partition_id, transaction_id, TABLET_ID, SCHEMA_HASH));
+
+    // the same load is not ingested twice
+    ASSERT_EQ(OLAP_ERR_PUSH_TRANSACTION_ALREADY_EXIST, k_engine->ingest_segment_groups(
+            TABLET_ID, SCHEMA_HASH, partition_id, transaction_id, load_id, builder.dir_path()));
+
+    k_engine->delete_transaction(partition_id, transaction_id, TABLET_ID, SCHEMA_HASH);
+}
+
+TEST_F(SegmentGroupBuilderTest, unsorted) {
+    SegmentGroupBuilder builder(*_table->get_header(), _build_root, 10, 21, 0);
+    ASSERT_EQ(OLAP_SUCCESS, builder.init());
+    ASSERT_EQ(OLAP_SUCCESS, add_row(&builder, 2, 1));
+    ASSERT_EQ(OLAP_SUCCESS, add_row(&builder, 2, 1));
+    ASSERT_EQ(OLAP_ERR_PUSH_INPUT_DATA_ERROR, add_row(&builder, 1, 1));
+}
+
+TEST_F(SegmentGroupBuilderTest, no_segment_group) {
+    PUniqueId load_id;
+    load_id.set_hi(1);
+    load_id.set_lo(3);
+    ASSERT_EQ(OLAP_ERR_FILE_NOT_EXIST, k_engine->ingest_segment_groups(
+            TABLET_ID, SCHEMA_HASH, 10, 22, load_id, _build_root));
+    ASSERT_FALSE(k_engine->has_transaction(10, 22, TABLET_ID, SCHEMA_HASH));
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    doris::init_glog("be-test");
+    testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+
+    doris::set_up();
+    int ret = RUN_ALL_TESTS();
+    doris::tear_down();
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
@@ -0,0 +1,136 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "olap/row_cursor.h"
+#include "olap/sorted_run_file.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestSortedRunFile : public testing::Test {
+public:
+    virtual void SetUp() {
+        system("mkdir -p ./ut_dir");
+        system("rm -rf ./ut_dir/sorted_run");
+        _schema.push_back(make_field("k1", OLAP_FIELD_TYPE_INT, 4, false, true));
+        _schema.push_back(make_field("v1", OLAP_FIELD_TYPE_VARCHAR, 200, false, false));
+        _schema.push_back(make_field("v2", OLAP_FIELD_TYPE_BIGINT, 8, true, false));
+        ASSERT_EQ(OLAP_SUCCESS, _row.init(_schema));
+    }
+
+    virtual void TearDown() {
+        system("rm -rf ./ut_dir/sorted_run");
+    }
+
+    static FieldInfo make_field(const std::string& name, FieldType type, uint32_t length,
+                                bool is_allow_null, bool is_key) {
+        FieldInfo field_info;
+        field_info.name = name;
+        field_info.type = type;
+        field_info.aggregation = is_key ? OLAP_FIELD_AGGREGATION_NONE
+                                        : OLAP_FIELD_AGGREGATION_REPLACE;
+        field_info.length = length;
+        field_info.is_allow_null = is_allow_null;
+        field_info.is_key = is_key;
+        field_info.unique_id = 0;
+        field_info.is_bf_column = false;
+        return field_info;
+    }
+
+    std::string value_of(int32_t i) {
+        return std::string(i % 150, 'a' + i % 26);
+    }
+
+    void write_rows(size_t buffer_size, int32_t num_rows) {
+        SortedRunWriter writer(_schema, buffer_size);
+        ASSERT_EQ(OLAP_SUCCESS, writer.open(_file_name));
+        for (int32_t i = 0; i < num_rows; ++i) {
+            std::string value = value_of(i);
+            _row.set_not_null(0);
+            *reinterpret_cast<int32_t*>(_row.get_field_content_ptr(0)) = i;
+            _row.set_not_null(1);
+            Slice* slice = reinterpret_cast<Slice*>(_row.get_field_content_ptr(1));
+            slice->data = &value[0];
+            slice->size = value.size();
+            if (i % 3 == 0) {
+                _row.set_null(2);
+            } else {
+                _row.set_not_null(2);
+                *reinterpret_cast<int64_t*>(_row.get_field_content_ptr(2)) = -i * 1000L;
+            }
+            ASSERT_EQ(OLAP_SUCCESS, writer.append(_row));
+        }
+        ASSERT_EQ(static_cast<uint64_t>(num_rows), writer.num_rows());
+        ASSERT_EQ(OLAP_SUCCESS, writer.close());
+    }
+
+    void check_rows(size_t buffer_size, int32_t num_rows) {
+        SortedRunReader reader(_schema, buffer_size);
+        ASSERT_EQ(OLAP_SUCCESS, reader.open(_file_name));
+        for (int32_t i = 0; i < num_rows; ++i) {
+            ASSERT_FALSE(reader.eof());
+            const RowCursor* row = reader.current();
+            ASSERT_FALSE(row->is_null(0));
+            ASSERT_EQ(i, *reinterpret_cast<const int32_t*>(row->get_field_content_ptr(0)));
+            const Slice* slice = reinterpret_cast<const Slice*>(row->get_field_content_ptr(1));
+            ASSERT_EQ(value_of(i), std::string(slice->data, slice->size));
+            if (i % 3 == 0) {
+                ASSERT_TRUE(row->is_null(2));
+            } else {
+                ASSERT_FALSE(row->is_null(2));
+                ASSERT_EQ(-i * 1000L,
+                          *reinterpret_cast<const int64_t*>(row->get_field_content_ptr(2)));
+            }
+            ASSERT_EQ(OLAP_SUCCESS, reader.next());
+        }
+        ASSERT_TRUE(reader.eof());
+    }
+
+    std::vector<FieldInfo> _schema;
+    RowCursor _row;
+    std::string _file_name = "./ut_dir/sorted_run";
+};
+
+TEST_F(TestSortedRunFile, ReadWrite) {
+    write_rows(1024 * 1024, 10000);
+    check_rows(1024 * 1024, 10000);
+}
+
+TEST_F(TestSortedRunFile, SmallBuffer) {
+    // rows are longer than the buffers, which grow to hold one row
+    write_rows(64, 1000);
+    check_rows(100, 1000);
+}
+
+TEST_F(TestSortedRunFile, Empty) {
+    write_rows(1024, 0);
+    SortedRunReader reader(_schema, 1024);
+    ASSERT_EQ(OLAP_SUCCESS, reader.open(_file_name));
+    ASSERT_TRUE(reader.eof());
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,493 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+// Micro benchmarks of the storage kernels. They are built with the unit tests
+// but not run by run-ut.sh, run storage_benchmark to print the throughput of
+// every kernel and --gtest_filter to select some. The data is generated from
+// fixed seeds and every benchmark reports the best of several rounds, so
+// results of two builds on one machine can be compared.
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+#include "olap/bit_field_reader.h"
+#include "olap/bit_field_writer.h"
+#include "olap/byte_buffer.h"
+#include "olap/column_reader.h"
+#include "olap/column_writer.h"
+#include "olap/comparison_predicate.h"
+#include "olap/field.h"
+#include "olap/file_helper.h"
+#include "olap/in_list_predicate.h"
+#include "olap/in_stream.h"
+#include "olap/lru_cache.h"
+#include "olap/out_stream.h"
+#include "olap/row_block.h"
+#include "olap/row_cursor.h"
+#include "olap/run_length_integer_reader.h"
+#include "olap/run_length_integer_writer.h"
+#include "olap/skiplist.h"
+#include "olap/stream_name.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/vectorized_row_batch.h"
+#include "util/arena.h"
+#include "util/cpu_info.h"
+#include "util/logging.h"
+#include "util/random.h"
+#include "util/time.h"
+
+namespace doris {
+
+static const int NUM_ROUNDS = 5;
+static const int NUM_ROWS = 1024 * 1024;
+static const uint32_t SEED = 301;
+static const char* FILE_PATH = "./ut_dir/storage_benchmark_file";
+
+// Runs 'body' NUM_ROUNDS times after 'prepare', which is not timed, and
+// prints the throughput of the fastest round.
+static void run_benchmark(const std::string& name, int64_t rows, int64_t bytes,
+                          const std::function<void()>& prepare,
+                          const std::function<void()>& body) {
+    int64_t best_ns = -1;
+    for (int i = 0; i < NUM_ROUNDS; ++i) {
+        prepare();
+        int64_t start_ns = MonotonicNanos();
+        body();
+        int64_t ns = std::max<int64_t>(MonotonicNanos() - start_ns, 1);
+        if (best_ns < 0 || ns < best_ns) {
+            best_ns = ns;
+        }
+    }
+    std::cout << name << ": " << static_cast<int64_t>(rows * 1e9 / best_ns) << " rows/s";
+    if (bytes > 0) {
+        std::cout << ", " << static_cast<int64_t>(bytes * 1e9 / best_ns / 1024 / 1024)
+            << " MB/s";
+    }
+    std::cout << ", best of " << NUM_ROUNDS << " rounds " << best_ns / 1000 << "us"
+        << std::endl;
+}
+
+static void set_field_info(FieldInfo* field_info, FieldType type, uint32_t length) {
+    field_info->name = "c0";
+    field_info->type = type;
+    field_info->aggregation = OLAP_FIELD_AGGREGATION_REPLACE;
+    field_info->length = length;
+    field_info->is_allow_null = false;
+    field_info->is_key = true;
+    field_info->precision = 1000;
+    field_info->frac = 10000;
+    field_info->unique_id = 0;
+    field_info->is_bf_column = false;
+}
+
+class StorageBenchmark : public testing::Test {
+public:
+    StorageBenchmark() { }
+
+    void SetUp() override {
+        system("mkdir -p ./ut_dir");
+        system((std::string("rm -f ") + FILE_PATH).c_str());
+        _mem_tracker.reset(new MemTracker(-1));
+        _mem_pool.reset(new MemPool(_mem_tracker.get()));
+    }
+
+    void TearDown() override {
+        for (auto& it : _in_streams) {
+            delete it.second;
+        }
+        _in_streams.clear();
+        SAFE_DELETE(_shared_buffer);
+        _file.close();
+    }
+
+protected:
+    // writes the streams to the file, they are read by _open_in_streams
+    void _write_streams(const std::map<StreamName, OutStream*>& streams) {
+        ASSERT_EQ(OLAP_SUCCESS, _file.open_with_mode(
+                FILE_PATH, O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        for (auto& it : streams) {
+            if (it.second->is_suppressed()
+                    || it.first.kind() == StreamInfoMessage::ROW_INDEX) {
+                continue;
+            }
+            StreamPosition position;
+            position.offset = _file.tell();
+            position.length = it.second->get_stream_length();
+            position.buffer_size = it.second->get_total_buffer_size();
+            it.second->write_to_file(&_file, 0);
+            _positions.emplace(it.first, position);
+        }
+        _file.close();
+        ASSERT_EQ(OLAP_SUCCESS, _file.open_with_mode(FILE_PATH, O_RDONLY, S_IRUSR | S_IWUSR));
+        _shared_buffer = StorageByteBuffer::create(
+                OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE + sizeof(StreamHead));
+        ASSERT_TRUE(_shared_buffer != NULL);
+    }
+
+    // new streams reading the file from the beginning
+    void _open_in_streams(Decompressor decompressor) {
+        for (auto& it : _in_streams) {
+            delete it.second;
+        }
+        _in_streams.clear();
+        for (auto& it : _positions) {
+            ReadOnlyFileStream* stream = new ReadOnlyFileStream(
+                    &_file, &_shared_buffer, it.second.offset, it.second.length,
+                    decompressor, it.second.buffer_size, &_stats);
+            ASSERT_EQ(OLAP_SUCCESS, stream->init());
+            _in_streams.emplace(it.first, stream);
+        }
+    }
+
+    ReadOnlyFileStream* _data_stream() {
+        return _in_streams.begin()->second;
+    }
+
+    struct StreamPosition {
+        int64_t offset;
+        int64_t length;
+        int64_t buffer_size;
+    };
+
+    std::unique_ptr<MemTracker> _mem_tracker;
+    std::unique_ptr<MemPool> _mem_pool;
+    FileHandler _file;
+    StorageByteBuffer* _shared_buffer = nullptr;
+    std::map<StreamName, StreamPosition> _positions;
+    std::map<StreamName, ReadOnlyFileStream*> _in_streams;
+    OlapReaderStatistics _stats;
+};
+
+TEST_F(StorageBenchmark, run_length_integer) {
+    // values like timestamps, increasing by small random steps
+    std::vector<int64_t> values(NUM_ROWS);
+    Random random(SEED);
+    int64_t value = 1500000000;
+    for (auto& v : values) {
+        value += random.Uniform(16);
+        v = value;
+    }
+
+    std::unique_ptr<OutStream> out_stream;
+    std::unique_ptr<RunLengthIntegerWriter> writer;
+    run_benchmark("RunLengthIntegerWriter", NUM_ROWS, NUM_ROWS * sizeof(int64_t),
+        [&] () {
+            out_stream.reset(new OutStream(OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE, NULL));
+            writer.reset(new RunLengthIntegerWriter(out_stream.get(), true));
+        },
+        [&] () {
+            for (auto v : values) {
+                writer->write(v);
+            }
+            writer->flush();
+        });
+
+    std::map<StreamName, OutStream*> streams;
+    streams.emplace(StreamName(0, StreamInfoMessage::DATA), out_stream.get());
+    _write_streams(streams);
+    std::unique_ptr<RunLengthIntegerReader> reader;
+    int64_t sum = 0;
+    run_benchmark("RunLengthIntegerReader", NUM_ROWS, NUM_ROWS * sizeof(int64_t),
+        [&] () {
+            _open_in_streams(NULL);
+            reader.reset(new RunLengthIntegerReader(_data_stream(), true));
+        },
+        [&] () {
+            for (int i = 0; i < NUM_ROWS; ++i) {
+                reader->next(&value);
+                sum += value;
+            }
+        });
+    ASSERT_NE(0, sum);
+}
+
+TEST_F(StorageBenchmark, bit_field) {
+    std::vector<bool> values(NUM_ROWS);
+    Random random(SEED);
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        values[i] = random.OneIn(2);
+    }
+
+    std::unique_ptr<OutStream> out_stream;
+    std::unique_ptr<BitFieldWriter> writer;
+    run_benchmark("BitFieldWriter", NUM_ROWS, NUM_ROWS / 8,
+        [&] () {
+            out_stream.reset(new OutStream(OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE, NULL));
+            writer.reset(new BitFieldWriter(out_stream.get()));
+            writer->init();
+        },
+        [&] () {
+            for (auto v : values) {
+                writer->write(v);
+            }
+            writer->flush();
+        });
+
+    std::map<StreamName, OutStream*> streams;
+    streams.emplace(StreamName(0, StreamInfoMessage::PRESENT), out_stream.get());
+    _write_streams(streams);
+    std::unique_ptr<BitFieldReader> reader;
+    int64_t num_set = 0;
+    run_benchmark("BitFieldReader", NUM_ROWS, NUM_ROWS / 8,
+        [&] () {
+            _open_in_streams(NULL);
+            reader.reset(new BitFieldReader(_data_stream()));
+            reader->init();
+        },
+        [&] () {
+            char value = 0;
+            for (int i = 0; i < NUM_ROWS; ++i) {
+                reader->next(&value);
+                num_set += value;
+            }
+        });
+    ASSERT_NE(0, num_set);
+}
+
+class ColumnReaderBenchmark : public StorageBenchmark {
+public:
+    // writes NUM_ROWS rows of 'values' repeated to a column of 'type' and
+    // reads them with ColumnReader::next_vector in batches of 1024
+    void run(const std::string& name, FieldType type, uint32_t length, int64_t value_size,
+             const std::vector<std::string>& values) {
+        std::vector<FieldInfo> schema(1);
+        set_field_info(&schema[0], type, length);
+
+        std::unique_ptr<OutStreamFactory> stream_factory(
+                new OutStreamFactory(COMPRESS_LZ4, OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE));
+        std::unique_ptr<ColumnWriter> writer(ColumnWriter::create(
+                0, schema, stream_factory.get(), 1024, BLOOM_FILTER_DEFAULT_FPP));
+        ASSERT_TRUE(writer != nullptr);
+        ASSERT_EQ(OLAP_SUCCESS, writer->init());
+
+        RowCursor row;
+        row.init(schema);
+        row.allocate_memory_for_string_type(schema);
+        RowBlock block(schema);
+        RowBlockInfo block_info;
+        block_info.row_num = 1024;
+        block.init(block_info);
+        for (int i = 0; i < NUM_ROWS; i += 1024) {
+            for (int j = 0; j < 1024; ++j) {
+                OlapTuple tuple(std::vector<std::string>({values[(i + j) % values.size()]}));
+                row.from_tuple(tuple);
+                block.set_row(j, row);
+            }
+            block.finalize(1024);
+            ASSERT_EQ(OLAP_SUCCESS, writer->write_batch(&block, &row));
+        }
+        ColumnDataHeaderMessage header;
+        ASSERT_EQ(OLAP_SUCCESS, writer->finalize(&header));
+        _write_streams(stream_factory->streams());
+
+        UniqueIdEncodingMap encodings;
+        encodings[0] = ColumnEncodingMessage();
+        encodings[0].set_kind(ColumnEncodingMessage::DIRECT);
+        encodings[0].set_dictionary_size(1);
+        UniqueIdToColumnIdMap included;
+        included[0] = 0;
+        UniqueIdToColumnIdMap segment_included;
+        segment_included[0] = 0;
+
+        std::unique_ptr<ColumnReader> reader;
+        ColumnVector vector;
+        run_benchmark("ColumnReader::next_vector " + name, NUM_ROWS, NUM_ROWS * value_size,
+            [&] () {
+                _open_in_streams(lz4_decompress);
+                _mem_pool->clear();
+                reader.reset(ColumnReader::create(0, schema, included, segment_included,
+                                                  encodings));
+                ASSERT_TRUE(reader != nullptr);
+                ASSERT_EQ(OLAP_SUCCESS,
+                          reader->init(&_in_streams, 1024, _mem_pool.get(), &_stats));
+            },
+            [&] () {
+                for (int i = 0; i < NUM_ROWS; i += 1024) {
+                    reader->next_vector(&vector, 1024, _mem_pool.get());
+                }
+            });
+    }
+};
+
+TEST_F(ColumnReaderBenchmark, tinyint) {
+    run("tinyint", OLAP_FIELD_TYPE_TINYINT, 1, 1, {"1", "3", "-7", "100", "0", "42"});
+}
+
+TEST_F(ColumnReaderBenchmark, int) {
+    Random random(SEED);
+    std::vector<std::string> values;
+    for (int i = 0; i < 4096; ++i) {
+        values.push_back(std::to_string(static_cast<int32_t>(random.Next())));
+    }
+    run("int", OLAP_FIELD_TYPE_INT, 4, 4, values);
+}
+
+TEST_F(ColumnReaderBenchmark, bigint) {
+    Random random(SEED);
+    std::vector<std::string> values;
+    for (int i = 0; i < 4096; ++i) {
+        values.push_back(std::to_string((static_cast<int64_t>(random.Next()) << 31)
+                                        + random.Next()));
+    }
+    run("bigint", OLAP_FIELD_TYPE_BIGINT, 8, 8, values);
+}
+
+TEST_F(ColumnReaderBenchmark, double) {
+    Random random(SEED);
+    std::vector<std::string> values;
+    for (int i = 0; i < 4096; ++i) {
+        values.push_back(std::to_string(random.Next() / 1000.0));
+    }
+    run("double", OLAP_FIELD_TYPE_DOUBLE, 8, 8, values);
+}
+
+TEST_F(ColumnReaderBenchmark, varchar) {
+    Random random(SEED);
+    std::vector<std::string> values;
+    for (int i = 0; i < 4096; ++i) {
+        std::string value;
+        for (int j = random.Uniform(32); j >= 0; --j) {
+            value.push_back('a' + random.Uniform(26));
+        }
+        values.push_back(value);
+    }
+    // 16 bytes on average
+    run("varchar", OLAP_FIELD_TYPE_VARCHAR, 64, 16, values);
+}
+
+TEST_F(StorageBenchmark, column_predicate) {
+    std::vector<FieldInfo> schema(1);
+    set_field_info(&schema[0], OLAP_FIELD_TYPE_INT, 4);
+    const int batch_size = 1024;
+    VectorizedRowBatch batch(schema, {0}, batch_size);
+    ColumnVector* column = batch.column(0);
+    column->set_no_nulls(true);
+    int32_t* data = reinterpret_cast<int32_t*>(
+            _mem_pool->allocate(batch_size * sizeof(int32_t)));
+    Random random(SEED);
+    for (int i = 0; i < batch_size; ++i) {
+        data[i] = random.Uniform(1000);
+    }
+    column->set_col_data(data);
+
+    std::set<int32_t> in_values;
+    for (int i = 0; i < 10; ++i) {
+        in_values.insert(i * 100);
+    }
+    std::vector<std::pair<std::string, std::shared_ptr<ColumnPredicate>>> predicates = {
+        {"EqualPredicate", std::make_shared<EqualPredicate<int32_t>>(0, 500)},
+        {"LessPredicate", std::make_shared<LessPredicate<int32_t>>(0, 500)},
+        {"InListPredicate", std::make_shared<InListPredicate<int32_t>>(
+                0, std::move(in_values))},
+    };
+    const int num_batches = NUM_ROWS / batch_size;
+    for (auto& predicate : predicates) {
+        run_benchmark("ColumnPredicate::evaluate " + predicate.first,
+                      NUM_ROWS, NUM_ROWS * sizeof(int32_t),
+            [] () { },
+            [&] () {
+                for (int i = 0; i < num_batches; ++i) {
+                    batch.set_size(batch_size);
+                    batch.set_selected_in_use(false);
+                    predicate.second->evaluate(&batch);
+                }
+            });
+    }
+}
+
+struct KeyComparator {
+    int operator()(const uint64_t& a, const uint64_t& b) const {
+        return a < b ? -1 : (a > b ? 1 : 0);
+    }
+};
+
+TEST_F(StorageBenchmark, skiplist_insert) {
+    std::vector<uint64_t> keys(NUM_ROWS);
+    Random random(SEED);
+    for (auto& key : keys) {
+        key = (static_cast<uint64_t>(random.Next()) << 32) | random.Next();
+    }
+    std::unique_ptr<Arena> arena;
+    std::unique_ptr<SkipList<uint64_t, KeyComparator>> list;
+    run_benchmark("SkipList::Insert", NUM_ROWS, NUM_ROWS * sizeof(uint64_t),
+        [&] () {
+            list.reset();
+            arena.reset(new Arena());
+            list.reset(new SkipList<uint64_t, KeyComparator>(KeyComparator(), arena.get()));
+        },
+        [&] () {
+            bool overwritten = false;
+            for (auto key : keys) {
+                list->Insert(key, &overwritten, KeysType::DUP_KEYS);
+            }
+        });
+}
+
+static void delete_nothing(const CacheKey& key, void* value) {
+}
+
+TEST_F(StorageBenchmark, lru_cache_lookup) {
+    const int num_keys = 100000;
+    std::unique_ptr<Cache> cache(new_lru_cache(num_keys * 2));
+    for (int64_t i = 0; i < num_keys; ++i) {
+        cache->release(cache->insert(CacheKey(reinterpret_cast<char*>(&i), sizeof(i)),
+                                     nullptr, 1, &delete_nothing));
+    }
+    for (int num_threads : {1, 4, 16}) {
+        const int lookups_per_thread = NUM_ROWS / 4;
+        run_benchmark("LRUCache::lookup " + std::to_string(num_threads) + " threads",
+                      static_cast<int64_t>(num_threads) * lookups_per_thread, 0,
+            [] () { },
+            [&] () {
+                std::vector<std::thread> threads;
+                for (int t = 0; t < num_threads; ++t) {
+                    threads.emplace_back([&cache, t, lookups_per_thread] () {
+                        Random random(SEED + t);
+                        for (int i = 0; i < lookups_per_thread; ++i) {
+                            int64_t key = random.Uniform(num_keys);
+                            Cache::Handle* handle = cache->lookup(
+                                    CacheKey(reinterpret_cast<char*>(&key), sizeof(key)));
+                            if (handle != nullptr) {
+                                cache->release(handle);
+                            }
+                        }
+                    });
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+            });
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
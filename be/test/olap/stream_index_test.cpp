@@ -382,6 +382,65 @@ TEST_F(TestStreamIndex, statistic) {
     }
 }
 
+TEST_F(TestStreamIndex, merge_statistic) {
+    StreamIndexWriter writer(OLAP_FIELD_TYPE_INT);
+    PositionEntryWriter entry;
+    ColumnStatistics stat;
+    ASSERT_EQ(OLAP_SUCCESS, stat.init(OLAP_FIELD_TYPE_INT, true));
+
+    WrapperField* field = WrapperField::create_by_type(OLAP_FIELD_TYPE_INT);
+    ASSERT_TRUE(NULL != field);
+    // the blocks are {5, 9}, {null, 3} and {null}
+    const char* values[3][2] = {{"5", "9"}, {NULL, "3"}, {NULL, NULL}};
+    for (uint32_t i = 0; i < 3; i++) {
+        stat.reset();
+        entry.add_position(i);
+        for (uint32_t j = 0; j < 2; j++) {
+            if (values[i][j] == NULL) {
+                field->set_null();
+            } else {
+                field->set_not_null();
+                field->from_string(values[i][j]);
+            }
+            stat.add(field->field_ptr());
+        }
+        entry.set_statistic(&stat);
+        writer.add_index_entry(entry);
+        entry.reset_write_offset();
+    }
+
+    size_t output_size = writer.output_size();
+    char* buffer = new char[output_size];
+    ASSERT_EQ(OLAP_SUCCESS, writer.write_to_buffer(buffer, output_size));
+    StreamIndexReader reader;
+    ASSERT_EQ(OLAP_SUCCESS, reader.init(buffer, output_size, OLAP_FIELD_TYPE_INT, true, true));
+    ASSERT_EQ(3U, reader.entry_count());
+
+    ColumnStatistics merged;
+    ASSERT_EQ(OLAP_SUCCESS, merged.init(OLAP_FIELD_TYPE_INT, true));
+    ASSERT_TRUE(merged.maximum()->is_null());
+    merged.merge(&reader.entry(0).column_statistic());
+    ASSERT_FALSE(merged.minimum()->is_null());
+    ASSERT_STREQ("5", merged.minimum()->to_string().c_str());
+    ASSERT_STREQ("9", merged.maximum()->to_string().c_str());
+
+    // null sorts first, the minimum of the values is not known any more
+    merged.merge(&reader.entry(1).column_statistic());
+    merged.merge(&reader.entry(2).column_statistic());
+    ASSERT_TRUE(merged.minimum()->is_null());
+    ASSERT_FALSE(merged.maximum()->is_null());
+    ASSERT_STREQ("9", merged.maximum()->to_string().c_str());
+
+    // a block of only nulls has a null maximum
+    ColumnStatistics nulls;
+    ASSERT_EQ(OLAP_SUCCESS, nulls.init(OLAP_FIELD_TYPE_INT, true));
+    nulls.merge(&reader.entry(2).column_statistic());
+    ASSERT_TRUE(nulls.maximum()->is_null());
+
+    delete[] buffer;
+    delete field;
+}
+
 }
 
 int main(int argc, char** argv) {
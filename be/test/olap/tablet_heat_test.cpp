@@ -0,0 +1,83 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "olap/tablet_heat.h"
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "util/time.h"
+
+namespace doris {
+
+class TabletHeatTest : public testing::Test {
+public:
+    TabletHeatTest() { }
+    ~TabletHeatTest() { }
+
+    void SetUp() override {
+        _half_life_sec = config::tablet_heat_half_life_sec;
+        config::tablet_heat_half_life_sec = 10;
+    }
+    void TearDown() override {
+        config::tablet_heat_half_life_sec = _half_life_sec;
+    }
+
+private:
+    int32_t _half_life_sec;
+};
+
+TEST_F(TabletHeatTest, add_and_decay) {
+    TabletHeat heat;
+    int64_t now_ms = UnixMillis();
+    heat.add_scan(1000, 4096, 200);
+    heat.add_scan(3000, 4096, 600);
+    heat.add_write(500, 1024);
+
+    TTabletHeat result;
+    heat.get(now_ms, &result);
+    ASSERT_EQ(4000, result.rows_scanned);
+    ASSERT_EQ(8192, result.bytes_scanned);
+    ASSERT_EQ(2, result.scan_count);
+    ASSERT_EQ(800, result.scan_time_us);
+    ASSERT_EQ(500, result.rows_written);
+    ASSERT_EQ(1024, result.bytes_written);
+
+    // the sums are halved after a half-life, what is added later is not
+    heat.add_write(500, 1024);
+    heat.get(now_ms + 10 * 1000, &result);
+    ASSERT_EQ(2000, result.rows_scanned);
+    ASSERT_EQ(1, result.scan_count);
+    ASSERT_EQ(750, result.rows_written);
+    ASSERT_EQ(1536, result.bytes_written);
+
+    // reading again at the same time changes nothing
+    heat.get(now_ms + 10 * 1000, &result);
+    ASSERT_EQ(2000, result.rows_scanned);
+
+    heat.get(now_ms + 20 * 1000, &result);
+    ASSERT_EQ(1000, result.rows_scanned);
+    ASSERT_EQ(4096, result.bytes_scanned);
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,238 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "olap/byte_buffer.h"
+#include "olap/in_stream.h"
+#include "olap/out_stream.h"
+#include "olap/stream_index_reader.h"
+#include "olap/stream_index_writer.h"
+#include "olap/xor_float_reader.h"
+#include "olap/xor_float_writer.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class TestXorFloat : public testing::Test {
+public:
+    virtual void SetUp() {
+        system("mkdir -p ./ut_dir");
+        system("rm -rf ./ut_dir/tmp_file");
+        _out_stream = new (std::nothrow) OutStream(OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE, NULL);
+        ASSERT_TRUE(_out_stream != NULL);
+        _writer = new (std::nothrow) XorFloatWriter(_out_stream);
+        ASSERT_TRUE(_writer != NULL);
+        _reader = NULL;
+        _shared_buffer = NULL;
+        _stream = NULL;
+    }
+
+    virtual void TearDown() {
+        SAFE_DELETE(_reader);
+        SAFE_DELETE(_out_stream);
+        SAFE_DELETE(_writer);
+        SAFE_DELETE(_shared_buffer);
+        SAFE_DELETE(_stream);
+    }
+
+    void CreateReader() {
+        ASSERT_EQ(OLAP_SUCCESS, helper.open_with_mode(_file_path.c_str(),
+                O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR));
+        _out_stream->write_to_file(&helper, 0);
+        helper.close();
+
+        ASSERT_EQ(OLAP_SUCCESS, helper.open_with_mode(_file_path.c_str(),
+                O_RDONLY, S_IRUSR | S_IWUSR));
+
+        _shared_buffer = StorageByteBuffer::create(
+                OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE + sizeof(StreamHead));
+        ASSERT_TRUE(_shared_buffer != NULL);
+
+        _stream = new (std::nothrow) ReadOnlyFileStream(
+                &helper,
+                &_shared_buffer,
+                0,
+                helper.length(),
+                NULL,
+                OLAP_DEFAULT_COLUMN_STREAM_BUFFER_SIZE,
+                &_stats);
+        ASSERT_EQ(OLAP_SUCCESS, _stream->init());
+
+        _reader = new (std::nothrow) XorFloatReader(_stream);
+        ASSERT_TRUE(_reader != NULL);
+    }
+
+    // compares the bits, so nan and -0.0 are checked too
+    template<class T>
+    void WriteAndCheck(const std::vector<T>& data) {
+        for (T value : data) {
+            ASSERT_EQ(OLAP_SUCCESS, _writer->write(value));
+        }
+        ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+        CreateReader();
+
+        for (T expected : data) {
+            ASSERT_TRUE(_reader->has_next());
+            T value = 0;
+            ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+            ASSERT_EQ(0, memcmp(&expected, &value, sizeof(T)));
+        }
+        ASSERT_FALSE(_reader->has_next());
+    }
+
+    XorFloatReader* _reader;
+    OutStream* _out_stream;
+    XorFloatWriter* _writer;
+    FileHandler helper;
+    StorageByteBuffer* _shared_buffer;
+    ReadOnlyFileStream* _stream;
+    OlapReaderStatistics _stats;
+
+    std::string _file_path = "./ut_dir/tmp_file";
+};
+
+TEST_F(TestXorFloat, ReadWriteOneDouble) {
+    WriteAndCheck(std::vector<double>{3.25});
+}
+
+TEST_F(TestXorFloat, ReadWriteSlowlyChangingDoubles) {
+    std::vector<double> data;
+    double value = 20.5;
+    for (int i = 0; i < 1000; ++i) {
+        if (i % 7 == 0) {
+            value += 0.25;
+        }
+        data.push_back(value);
+    }
+    WriteAndCheck(data);
+    // far below the 8 bytes of a plain value
+    ASSERT_LT(_out_stream->get_stream_length(), data.size());
+}
+
+TEST_F(TestXorFloat, ReadWriteRandomDoubles) {
+    std::vector<double> data;
+    uint64_t bits = 1;
+    for (int i = 0; i < 1000; ++i) {
+        bits = bits * 6364136223846793005ULL + 1442695040888963407ULL;
+        double value = 0;
+        memcpy(&value, &bits, sizeof(value));
+        data.push_back(value);
+    }
+    WriteAndCheck(data);
+}
+
+TEST_F(TestXorFloat, ReadWriteFloats) {
+    std::vector<float> data;
+    for (int i = 0; i < 1000; ++i) {
+        data.push_back(std::sin(i * 0.01f) * 100);
+    }
+    WriteAndCheck(data);
+}
+
+TEST_F(TestXorFloat, ReadWriteSpecialValues) {
+    WriteAndCheck(std::vector<double>{0.0, -0.0, NAN, INFINITY, -INFINITY, 1e-310, 1.0, 1.0});
+}
+
+TEST_F(TestXorFloat, NextBatch) {
+    std::vector<double> data;
+    for (int i = 0; i < 1000; ++i) {
+        data.push_back(i * 0.5);
+    }
+    for (double value : data) {
+        ASSERT_EQ(OLAP_SUCCESS, _writer->write(value));
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+    CreateReader();
+
+    double value = 0;
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(0.0, value);
+    std::vector<double> values(998);
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next_batch(values.data(), 998));
+    for (int i = 0; i < 998; ++i) {
+        ASSERT_EQ(data[i + 1], values[i]);
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(data[999], value);
+    ASSERT_NE(OLAP_SUCCESS, _reader->next_batch(values.data(), 1));
+}
+
+TEST_F(TestXorFloat, seek) {
+    // positions in the middle of a mini block and at its start
+    int starts[] = {300, 0, 640};
+    PositionEntryWriter index_entries[3];
+    for (int i = 0; i < 1000; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (i == starts[j]) {
+                _writer->get_position(&index_entries[j], false);
+            }
+        }
+        ASSERT_EQ(OLAP_SUCCESS, _writer->write(i * 1.5f));
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+    CreateReader();
+
+    float value = 0;
+    for (int j : {2, 0, 1}) {
+        PositionEntryReader entry;
+        entry._positions = index_entries[j]._positions;
+        entry._positions_count = index_entries[j]._positions_count;
+        entry._statistics.init(OLAP_FIELD_TYPE_FLOAT, false);
+
+        PositionProvider position(&entry);
+        ASSERT_EQ(OLAP_SUCCESS, _reader->seek(&position));
+        for (int i = starts[j]; i < starts[j] + 200; ++i) {
+            ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+            ASSERT_EQ(i * 1.5f, value);
+        }
+    }
+}
+
+TEST_F(TestXorFloat, skip) {
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(OLAP_SUCCESS, _writer->write(-i * 0.1));
+    }
+    ASSERT_EQ(OLAP_SUCCESS, _writer->flush());
+    CreateReader();
+
+    double value = 0;
+    ASSERT_EQ(OLAP_SUCCESS, _reader->skip(2));
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(-2 * 0.1, value);
+    ASSERT_EQ(OLAP_SUCCESS, _reader->skip(500));
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(-503 * 0.1, value);
+    ASSERT_EQ(OLAP_SUCCESS, _reader->skip(495));
+    ASSERT_EQ(OLAP_SUCCESS, _reader->next(&value));
+    ASSERT_EQ(-999 * 0.1, value);
+    ASSERT_NE(OLAP_SUCCESS, _reader->next(&value));
+}
+
+}  // namespace doris
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    int ret = RUN_ALL_TESTS();
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
@@ -0,0 +1,186 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/admission_controller.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "runtime/exec_env.h"
+#include "runtime/mem_tracker.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// The BE is overloaded while the process tracker consumes more than half of
+// its limit
+class AdmissionControllerTest : public testing::Test {
+public:
+    void SetUp() override {
+        _mem_ratio = config::fragment_admission_mem_ratio;
+        _max_wait_ms = config::fragment_admission_max_wait_ms;
+        _check_interval_ms = config::fragment_admission_check_interval_ms;
+        config::fragment_admission_mem_ratio = 0.5;
+        config::fragment_admission_max_wait_ms = 60 * 1000;
+        config::fragment_admission_check_interval_ms = 5;
+        _process_tracker.reset(new MemTracker(1000));
+        _exec_env = ExecEnv::GetInstance();
+        _exec_env->_mem_tracker = _process_tracker.get();
+    }
+
+    void TearDown() override {
+        _exec_env->_mem_tracker = nullptr;
+        _process_tracker->release(_process_tracker->consumption());
+        _process_tracker.reset();
+        config::fragment_admission_mem_ratio = _mem_ratio;
+        config::fragment_admission_max_wait_ms = _max_wait_ms;
+        config::fragment_admission_check_interval_ms = _check_interval_ms;
+    }
+
+protected:
+    void set_overloaded(bool overloaded) {
+        _process_tracker->release(_process_tracker->consumption());
+        _process_tracker->consume(overloaded ? 900 : 100);
+    }
+
+    // the function of fragment 'id', which is recorded once it is started
+    AdmissionController::AdmitFunction admit_func(int id) {
+        return [this, id](int64_t queue_time_ns) {
+            std::lock_guard<std::mutex> l(_lock);
+            _admitted.push_back(id);
+            _queue_time_ns.push_back(queue_time_ns);
+        };
+    }
+
+    std::vector<int> admitted() {
+        std::lock_guard<std::mutex> l(_lock);
+        return _admitted;
+    }
+
+    // Waits up to 10s for 'num' fragments to be started by the controller
+    bool wait_admitted(int num) {
+        for (int i = 0; i < 2000; ++i) {
+            if (admitted().size() >= num) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    }
+
+    std::unique_ptr<MemTracker> _process_tracker;
+    ExecEnv* _exec_env = nullptr;
+    std::mutex _lock;
+    std::vector<int> _admitted;
+    std::vector<int64_t> _queue_time_ns;
+    double _mem_ratio = 0;
+    int32_t _max_wait_ms = 0;
+    int32_t _check_interval_ms = 0;
+};
+
+TEST_F(AdmissionControllerTest, not_overloaded) {
+    set_overloaded(false);
+    AdmissionController controller(_exec_env);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(controller.admit("", 1, admit_func(i)));
+    }
+    ASSERT_EQ(0, controller.num_queued());
+    ASSERT_TRUE(admitted().empty());
+}
+
+TEST_F(AdmissionControllerTest, fifo) {
+    set_overloaded(true);
+    AdmissionController controller(_exec_env);
+    // nothing runs, so the first one starts anyway
+    ASSERT_TRUE(controller.admit("", 1, admit_func(0)));
+    for (int i = 1; i <= 5; ++i) {
+        ASSERT_FALSE(controller.admit("", 1, admit_func(i)));
+    }
+    ASSERT_EQ(5, controller.num_queued());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(admitted().empty());
+
+    // the queued ones start in their order once the load is gone
+    set_overloaded(false);
+    ASSERT_TRUE(wait_admitted(5));
+    ASSERT_EQ(std::vector<int>({1, 2, 3, 4, 5}), admitted());
+    ASSERT_EQ(0, controller.num_queued());
+    // a new one waits for the queued ones
+    set_overloaded(true);
+    ASSERT_FALSE(controller.admit("", 1, admit_func(6)));
+    for (int i = 0; i < 6; ++i) {
+        controller.release();
+    }
+    ASSERT_TRUE(wait_admitted(6));
+    controller.release();
+}
+
+TEST_F(AdmissionControllerTest, max_wait) {
+    // a fragment which waited too long is started although the BE is overloaded,
+    // as the running fragments may wait for it
+    config::fragment_admission_max_wait_ms = 100;
+    set_overloaded(true);
+    AdmissionController controller(_exec_env);
+    ASSERT_TRUE(controller.admit("", 1, admit_func(0)));
+    ASSERT_FALSE(controller.admit("", 1, admit_func(1)));
+    ASSERT_TRUE(wait_admitted(1));
+    ASSERT_EQ(std::vector<int>({1}), admitted());
+    ASSERT_GE(_queue_time_ns[0], 100 * 1000 * 1000L);
+    ASSERT_EQ(0, controller.num_queued());
+    controller.release();
+    controller.release();
+}
+
+TEST_F(AdmissionControllerTest, release) {
+    // a slot given back by a finished fragment starts a queued one
+    set_overloaded(true);
+    AdmissionController controller(_exec_env);
+    ASSERT_TRUE(controller.admit("", 1, admit_func(0)));
+    ASSERT_FALSE(controller.admit("", 1, admit_func(1)));
+    ASSERT_FALSE(controller.admit("", 1, admit_func(2)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(admitted().empty());
+
+    controller.release();
+    ASSERT_TRUE(wait_admitted(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(std::vector<int>({1}), admitted());
+    ASSERT_EQ(1, controller.num_queued());
+
+    controller.release();
+    ASSERT_TRUE(wait_admitted(2));
+    ASSERT_EQ(std::vector<int>({1, 2}), admitted());
+    controller.release();
+
+    // nothing runs or is queued any more
+    ASSERT_TRUE(controller.admit("", 1, admit_func(3)));
+    controller.release();
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
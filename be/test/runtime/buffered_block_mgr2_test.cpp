@@ -724,6 +724,44 @@ TEST_F(BufferedBlockMgrTest, Deletion) {
     TearDownMgrs();
 }
 
+// Test that the buffers of unpinned blocks are freed when memory is revoked, and that
+// the blocks can be pinned again afterwards.
+TEST_F(BufferedBlockMgrTest, RevokeMemory) {
+    int max_num_buffers = 5;
+    const int block_size = 1024;
+    BufferedBlockMgr2* block_mgr;
+    BufferedBlockMgr2::Client* client;
+    block_mgr = CreateMgrAndClient(0, max_num_buffers, block_size, 0,
+            _client_tracker.get(), &client);
+
+    vector<BufferedBlockMgr2::Block*> blocks;
+    AllocateBlocks(block_mgr, client, max_num_buffers, &blocks);
+    // Pinned blocks can't be revoked.
+    EXPECT_EQ(0, block_mgr->revocable_memory());
+    EXPECT_EQ(0, block_mgr->revoke_memory(max_num_buffers * block_size));
+
+    UnpinBlocks(blocks);
+    WaitForWrites(block_mgr);
+    EXPECT_EQ(max_num_buffers * block_size, block_mgr->revocable_memory());
+
+    // The first call frees the buffers already written and writes the other blocks.
+    int64_t freed = block_mgr->revoke_memory(max_num_buffers * block_size);
+    EXPECT_GT(freed, 0);
+    WaitForWrites(block_mgr);
+    freed += block_mgr->revoke_memory(max_num_buffers * block_size - freed);
+    EXPECT_EQ(max_num_buffers * block_size, freed);
+    EXPECT_EQ(0, block_mgr->available_allocated_buffers());
+    EXPECT_EQ(0, block_mgr->revocable_memory());
+
+    for (int i = 0; i < blocks.size(); ++i) {
+        bool pinned;
+        EXPECT_TRUE(blocks[i]->pin(&pinned).ok());
+        EXPECT_TRUE(pinned);
+    }
+
+    TearDownMgrs();
+}
+
 // Delete blocks of various sizes and statuses to exercise the different code paths.
 // This relies on internal validation in block manager to detect many errors.
 TEST_F(BufferedBlockMgrTest, DeleteSingleBlocks) {
@@ -1248,6 +1286,16 @@ TEST_F(BufferedBlockMgrTest, SingleRandom_plain) {
     TestRandomInternalSingle(8 * 1024 * 1024);
 }
 
+// Blocks spilled with compression read back the same, whether they got smaller and
+// were written compressed or not.
+TEST_F(BufferedBlockMgrTest, SingleRandom_compressed) {
+    config::spill_compression = true;
+    TestEvictionImpl(1024);
+    TestRandomInternalSingle(1024);
+    TestRandomInternalSingle(8 * 1024);
+    config::spill_compression = false;
+}
+
 TEST_F(BufferedBlockMgrTest, Multi2Random_plain) {
     TestRandomInternalMulti(2, 1024);
     TestRandomInternalMulti(2, 8 * 1024);
@@ -0,0 +1,73 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/chunk_allocator.h"
+
+#include <gtest/gtest.h>
+
+namespace doris {
+
+TEST(ChunkAllocatorTest, reuse) {
+    ChunkAllocator allocator(1024 * 1024);
+    Chunk chunk;
+    ASSERT_TRUE(allocator.allocate(4096, &chunk));
+    ASSERT_EQ(4096, chunk.size);
+    uint8_t* data = chunk.data;
+    allocator.free(chunk);
+    ASSERT_EQ(4096, allocator.reserved_bytes());
+
+    // chunks of other sizes are not given out
+    Chunk other;
+    ASSERT_TRUE(allocator.allocate(8192, &other));
+    ASSERT_EQ(4096, allocator.reserved_bytes());
+
+    ASSERT_TRUE(allocator.allocate(4096, &chunk));
+    ASSERT_EQ(data, chunk.data);
+    ASSERT_EQ(0, allocator.reserved_bytes());
+    allocator.free(chunk);
+    allocator.free(other);
+    ASSERT_EQ(4096 + 8192, allocator.reserved_bytes());
+}
+
+TEST(ChunkAllocatorTest, not_kept) {
+    ChunkAllocator allocator(8192);
+    // sizes which are not a power of two or are too large
+    Chunk chunk;
+    ASSERT_TRUE(allocator.allocate(5000, &chunk));
+    allocator.free(chunk);
+    ASSERT_TRUE(allocator.allocate(2 * ChunkAllocator::MAX_CHUNK_SIZE, &chunk));
+    allocator.free(chunk);
+    ASSERT_EQ(0, allocator.reserved_bytes());
+
+    // up to the limit
+    Chunk chunks[3];
+    for (auto& c : chunks) {
+        ASSERT_TRUE(allocator.allocate(4096, &c));
+    }
+    for (auto& c : chunks) {
+        allocator.free(c);
+    }
+    ASSERT_EQ(8192, allocator.reserved_bytes());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,265 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/column_batch.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "gen_cpp/data.pb.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "util/cpu_info.h"
+#include "util/descriptor_helper.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// Rows of a tuple (INT, BIGINT NOT NULL, VARCHAR) and a nullable tuple
+// (INT, VARCHAR), some slots and tuples being NULL
+class ColumnBatchTest : public testing::Test {
+public:
+    void SetUp() override {
+        _compress_rowbatches = config::compress_rowbatches;
+
+        TDescriptorTableBuilder builder;
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_BIGINT).nullable(false).build())
+            .add_slot(TSlotDescriptorBuilder().string_type(64).nullable(true).build())
+            .build(&builder);
+        TTupleDescriptorBuilder()
+            .add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(true).build())
+            .add_slot(TSlotDescriptorBuilder().string_type(64).nullable(true).build())
+            .build(&builder);
+        ASSERT_TRUE(DescriptorTbl::create(&_pool, builder.desc_tbl(), &_desc_tbl).ok());
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0, 1}, {false, true}));
+    }
+
+    void TearDown() override {
+        config::compress_rowbatches = _compress_rowbatches;
+    }
+
+protected:
+    static void write_string(Tuple* tuple, const SlotDescriptor* slot, const std::string& value,
+                             MemPool* pool) {
+        StringValue* dst = tuple->get_string_slot(slot->tuple_offset());
+        dst->ptr = reinterpret_cast<char*>(pool->allocate(value.size()));
+        memcpy(dst->ptr, value.data(), value.size());
+        dst->len = value.size();
+    }
+
+    // Appends 'num_rows' rows to 'batch'. Strings repeat, so they compress, and
+    // some of them are empty.
+    void add_rows(int num_rows, RowBatch* batch) {
+        const std::vector<TupleDescriptor*>& tuple_descs = _row_desc->tuple_descriptors();
+        const std::vector<SlotDescriptor*>& slots0 = tuple_descs[0]->slots();
+        const std::vector<SlotDescriptor*>& slots1 = tuple_descs[1]->slots();
+        MemPool* pool = batch->tuple_data_pool();
+        for (int i = 0; i < num_rows; ++i) {
+            Tuple* tuple0 = Tuple::create(tuple_descs[0]->byte_size(), pool);
+            if (i % 5 == 0) {
+                tuple0->set_null(slots0[0]->null_indicator_offset());
+            } else {
+                *reinterpret_cast<int32_t*>(tuple0->get_slot(slots0[0]->tuple_offset())) = i - 50;
+            }
+            *reinterpret_cast<int64_t*>(tuple0->get_slot(slots0[1]->tuple_offset())) =
+                i * 1000000007L;
+            if (i % 7 == 0) {
+                tuple0->set_null(slots0[2]->null_indicator_offset());
+            } else {
+                write_string(tuple0, slots0[2], std::string(i % 20, 'a' + i % 26), pool);
+            }
+
+            Tuple* tuple1 = NULL;
+            if (i % 4 != 0) {
+                tuple1 = Tuple::create(tuple_descs[1]->byte_size(), pool);
+                if (i % 3 == 0) {
+                    tuple1->set_null(slots1[0]->null_indicator_offset());
+                } else {
+                    *reinterpret_cast<int32_t*>(tuple1->get_slot(slots1[0]->tuple_offset())) = i;
+                }
+                if (i % 6 == 1) {
+                    tuple1->set_null(slots1[1]->null_indicator_offset());
+                } else {
+                    write_string(tuple1, slots1[1], "value" + std::to_string(i % 9), pool);
+                }
+            }
+
+            TupleRow* row = batch->get_row(batch->add_row());
+            row->set_tuple(0, tuple0);
+            row->set_tuple(1, tuple1);
+            batch->commit_last_row();
+        }
+    }
+
+    std::vector<std::string> read_rows(RowBatch* batch) {
+        std::vector<std::string> rows;
+        for (int i = 0; i < batch->num_rows(); ++i) {
+            rows.push_back(batch->get_row(i)->to_string(*_row_desc));
+        }
+        return rows;
+    }
+
+    // the rows the row batch path of the exchange receives
+    std::vector<std::string> send_row_batch(RowBatch* batch) {
+        PRowBatch pb_batch;
+        batch->serialize(&pb_batch);
+        RowBatch received(*_row_desc, pb_batch, &_tracker);
+        return read_rows(&received);
+    }
+
+    // the rows the columnar path of the exchange receives, 'columns' being
+    // serialized as is
+    Status send_column_batch(ColumnBatch* columns, std::vector<std::string>* rows,
+                             PColumnarRowBatch* pb_batch) {
+        columns->serialize(pb_batch);
+        ColumnBatch received(*_row_desc);
+        RETURN_IF_ERROR(received.deserialize(*pb_batch));
+        RowBatch batch(*_row_desc, std::max(received.num_rows(), 1), &_tracker);
+        received.to_row_batch(&batch);
+        *rows = read_rows(&batch);
+        return Status::OK;
+    }
+
+    ObjectPool _pool;
+    MemTracker _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    bool _compress_rowbatches = true;
+};
+
+TEST_F(ColumnBatchTest, row_batch) {
+    RowBatch batch(*_row_desc, 1000, &_tracker);
+    add_rows(1000, &batch);
+    std::vector<std::string> rows = read_rows(&batch);
+
+    ColumnBatch columns(*_row_desc);
+    columns.from_row_batch(&batch);
+    ASSERT_EQ(1000, columns.num_rows());
+    ASSERT_EQ(5, columns.num_columns());
+    RowBatch copy(*_row_desc, 1000, &_tracker);
+    columns.to_row_batch(&copy);
+    ASSERT_EQ(rows, read_rows(&copy));
+}
+
+TEST_F(ColumnBatchTest, serialize) {
+    for (bool compress : {false, true}) {
+        SCOPED_TRACE(compress);
+        config::compress_rowbatches = compress;
+        RowBatch batch(*_row_desc, 1000, &_tracker);
+        add_rows(1000, &batch);
+        std::vector<std::string> expected = send_row_batch(&batch);
+        ASSERT_EQ(read_rows(&batch), expected);
+
+        ColumnBatch columns(*_row_desc);
+        columns.from_row_batch(&batch);
+        std::vector<std::string> rows;
+        PColumnarRowBatch pb_batch;
+        ASSERT_TRUE(send_column_batch(&columns, &rows, &pb_batch).ok());
+        ASSERT_EQ(compress, pb_batch.has_uncompressed_size());
+        ASSERT_EQ(expected, rows);
+    }
+}
+
+TEST_F(ColumnBatchTest, selection) {
+    RowBatch batch(*_row_desc, 100, &_tracker);
+    add_rows(100, &batch);
+    std::vector<std::string> all_rows = read_rows(&batch);
+
+    // every third row, and no row
+    std::vector<int> sel;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 100; i += 3) {
+        sel.push_back(i);
+        expected.push_back(all_rows[i]);
+    }
+    ColumnBatch columns(*_row_desc);
+    columns.from_row_batch(&batch);
+    columns.select(sel.data(), sel.size());
+    RowBatch copy(*_row_desc, 100, &_tracker);
+    columns.to_row_batch(&copy);
+    ASSERT_EQ(expected, read_rows(&copy));
+    std::vector<std::string> rows;
+    PColumnarRowBatch pb_batch;
+    ASSERT_TRUE(send_column_batch(&columns, &rows, &pb_batch).ok());
+    ASSERT_EQ(expected, rows);
+
+    columns.select(sel.data(), 0);
+    ASSERT_TRUE(send_column_batch(&columns, &rows, &pb_batch).ok());
+    ASSERT_TRUE(rows.empty());
+    columns.select_all();
+    ASSERT_TRUE(send_column_batch(&columns, &rows, &pb_batch).ok());
+    ASSERT_EQ(all_rows, rows);
+}
+
+TEST_F(ColumnBatchTest, empty_batch) {
+    RowBatch batch(*_row_desc, 10, &_tracker);
+    ColumnBatch columns(*_row_desc);
+    columns.from_row_batch(&batch);
+    ASSERT_EQ(0, columns.num_rows());
+    std::vector<std::string> rows;
+    PColumnarRowBatch pb_batch;
+    ASSERT_TRUE(send_column_batch(&columns, &rows, &pb_batch).ok());
+    ASSERT_EQ(0, pb_batch.num_rows());
+    ASSERT_TRUE(rows.empty());
+    ASSERT_EQ(send_row_batch(&batch), rows);
+}
+
+TEST_F(ColumnBatchTest, corrupt_data) {
+    config::compress_rowbatches = false;
+    RowBatch batch(*_row_desc, 100, &_tracker);
+    add_rows(100, &batch);
+    ColumnBatch columns(*_row_desc);
+    columns.from_row_batch(&batch);
+    PColumnarRowBatch pb_batch;
+    columns.serialize(&pb_batch);
+
+    ColumnBatch received(*_row_desc);
+    PColumnarRowBatch truncated = pb_batch;
+    truncated.mutable_data()->resize(pb_batch.data().size() - 1);
+    ASSERT_FALSE(received.deserialize(truncated).ok());
+    PColumnarRowBatch padded = pb_batch;
+    padded.mutable_data()->push_back('x');
+    ASSERT_FALSE(received.deserialize(padded).ok());
+    ASSERT_TRUE(received.deserialize(pb_batch).ok());
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+
+    doris::CpuInfo::init();
+
+    return RUN_ALL_TESTS();
+}
@@ -18,6 +18,7 @@
 #include "runtime/datetime_value.h"
 
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -386,6 +387,56 @@ TEST_F(DateTimeValueTest, add_interval) {
 }
 
 // Calculate format
+// strings of the fixed formats are parsed by the fast path, the same ones
+// after a space by the general one
+TEST_F(DateTimeValueTest, from_date_str_fast_path) {
+    const char* templates[] = {"YYYY-MM-DD", "YYYY-MM-DD HH:MM:SS"};
+    const char chars[] = "0123456789012345678901234567890123456789-:. T/x";
+    srand(1);
+    for (int i = 0; i < 100000; ++i) {
+        std::string str = templates[i % 2];
+        for (auto& c : str) {
+            if (isalpha(c) || rand() % 50 == 0) {
+                c = chars[rand() % (sizeof(chars) - 1)];
+            }
+        }
+        DateTimeValue fast;
+        DateTimeValue general;
+        std::string spaced = " " + str;
+        bool fast_ok = fast.from_date_str(str.data(), str.size());
+        bool general_ok = general.from_date_str(spaced.data(), spaced.size());
+        ASSERT_EQ(general_ok, fast_ok) << str;
+        if (fast_ok) {
+            ASSERT_EQ(general.to_int64(), fast.to_int64()) << str;
+        }
+    }
+
+    DateTimeValue value;
+    ASSERT_TRUE(value.from_date_str("2024-02-29 23:59:59", 19));
+    ASSERT_EQ(20240229235959L, value.to_int64());
+    ASSERT_TRUE(value.from_date_str("2024-02-29", 10));
+    ASSERT_EQ(20240229L, value.to_int64());
+    ASSERT_FALSE(value.from_date_str("2023-02-29", 10));
+    ASSERT_FALSE(value.from_date_str("2024-02-28 24:00:00", 19));
+}
+
+TEST_F(DateTimeValueTest, from_date_strs) {
+    std::vector<doris_udf::StringVal> strs;
+    strs.emplace_back("2024-01-02");
+    strs.emplace_back("bad");
+    strs.push_back(doris_udf::StringVal::null());
+    strs.emplace_back("20240102030405");
+    DateTimeValue values[4];
+    bool valid[4];
+    ASSERT_EQ(2, DateTimeValue::from_date_strs(strs.data(), 4, values, valid));
+    ASSERT_TRUE(valid[0]);
+    ASSERT_FALSE(valid[1]);
+    ASSERT_FALSE(valid[2]);
+    ASSERT_TRUE(valid[3]);
+    ASSERT_EQ(20240102L, values[0].to_int64());
+    ASSERT_EQ(20240102030405L, values[3].to_int64());
+}
+
 TEST_F(DateTimeValueTest, from_date_format_str) {
     // Used to check
     char str[MAX_DTVALUE_STR_LEN];
@@ -16,9 +16,11 @@
 // under the License.
 
 #include "runtime/decimalv2_value.h"
+#include "runtime/decimalv2_kernels.h"
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -273,6 +275,45 @@ TEST_F(DecimalV2ValueTest, div) {
     }
 }
 
+TEST_F(DecimalV2ValueTest, kernels) {
+    const int128_t max = DecimalV2Value::MAX_DECIMAL_VALUE;
+    ASSERT_EQ(max, DecimalV2Kernels::add(max - 1, 2));
+    ASSERT_EQ(-max, DecimalV2Kernels::subtract(-max + 1, 2));
+    ASSERT_EQ(1, DecimalV2Kernels::add(max, -max + 1));
+    // 1.5 * 1.000000001 = 1.5000000015, rounded half up
+    ASSERT_EQ(1500000002, DecimalV2Kernels::multiply(1500000000, 1000000001));
+    ASSERT_EQ(-1500000002, DecimalV2Kernels::multiply(-1500000000, 1000000001));
+    // a product beyond 64 bits
+    ASSERT_EQ(static_cast<int128_t>(10000000000LL) * 1000000000,
+              DecimalV2Kernels::multiply(static_cast<int128_t>(100000) * 1000000000,
+                                         static_cast<int128_t>(100000) * 1000000000));
+    ASSERT_EQ(max, DecimalV2Kernels::multiply(max, max));
+    // 2 / 3 = 0.666666667
+    ASSERT_EQ(666666667, DecimalV2Kernels::divide(2000000000, 3000000000LL));
+    ASSERT_EQ(0, DecimalV2Kernels::divide(2000000000, 0));
+}
+
+TEST_F(DecimalV2ValueTest, kernel_sum) {
+    std::vector<int128_t> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back((i % 2 == 0 ? 1 : -3) * static_cast<int128_t>(i) * 1000000007);
+    }
+    int128_t expected = 5;
+    for (auto value : values) {
+        expected = (DecimalV2Value(expected) + DecimalV2Value(value)).value();
+    }
+    int128_t sum = 5;
+    DecimalV2Kernels::sum(values.data(), values.size(), &sum);
+    ASSERT_EQ(expected, sum);
+
+    // saturated in the middle, then added one by one as operator+ does
+    const int128_t max = DecimalV2Value::MAX_DECIMAL_VALUE;
+    values = {max / 2, max / 2, max / 2, -max / 2};
+    sum = 0;
+    DecimalV2Kernels::sum(values.data(), values.size(), &sum);
+    ASSERT_EQ(max - max / 2, sum);
+}
+
 TEST_F(DecimalV2ValueTest, unary_minus_operator) {
     {
         DecimalV2Value value1(std::string("111111111.222222222"));
@@ -0,0 +1,75 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/descriptor_tbl_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "gen_cpp/Descriptors_types.h"
+#include "runtime/descriptors.h"
+
+namespace doris {
+
+class DescriptorTblCacheTest : public testing::Test {
+protected:
+    TDescriptorTable make_tbl(int num_tuples) {
+        TDescriptorTable tbl;
+        for (int i = 0; i < num_tuples; ++i) {
+            TTupleDescriptor tuple;
+            tuple.id = i;
+            tuple.byteSize = 8;
+            tuple.numNullBytes = 0;
+            tbl.tupleDescriptors.push_back(tuple);
+        }
+        return tbl;
+    }
+};
+
+TEST_F(DescriptorTblCacheTest, get) {
+    DescriptorTblCache cache(16);
+    std::shared_ptr<const DescriptorTbl> tbl;
+    ASSERT_TRUE(cache.get(1, make_tbl(1), &tbl).ok());
+    ASSERT_NE(nullptr, tbl->get_tuple_descriptor(0));
+
+    // instances of the same hash share the table
+    std::shared_ptr<const DescriptorTbl> other_tbl;
+    ASSERT_TRUE(cache.get(1, make_tbl(1), &other_tbl).ok());
+    ASSERT_EQ(tbl.get(), other_tbl.get());
+
+    // a colliding hash of another table
+    ASSERT_TRUE(cache.get(1, make_tbl(2), &other_tbl).ok());
+    ASSERT_NE(tbl.get(), other_tbl.get());
+    ASSERT_NE(nullptr, other_tbl->get_tuple_descriptor(1));
+}
+
+TEST_F(DescriptorTblCacheTest, outlive_cache) {
+    std::shared_ptr<const DescriptorTbl> tbl;
+    {
+        DescriptorTblCache cache(16);
+        ASSERT_TRUE(cache.get(1, make_tbl(1), &tbl).ok());
+    }
+    // the table is kept while it is used
+    ASSERT_NE(nullptr, tbl->get_tuple_descriptor(0));
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/exchange_compression_policy.h"
+
+#include <gtest/gtest.h>
+
+namespace doris {
+
+class ExchangeCompressionPolicyTest : public testing::Test {
+protected:
+    // sends 'num_batches' batches of 1MB, each codec compressing as 'ratios'
+    // says in 'nanos_per_byte'
+    void send(ExchangeCompressionPolicy* policy, int num_batches, const double* ratios,
+              const double* nanos_per_byte) {
+        const int64_t size = 1024 * 1024;
+        for (int i = 0; i < num_batches; ++i) {
+            ExchangeCompressionPolicy::Codec codec = policy->next_codec();
+            policy->update(size, static_cast<int64_t>(size * ratios[codec]),
+                           static_cast<int64_t>(size * nanos_per_byte[codec]));
+        }
+    }
+};
+
+// none, lz4 and zstd
+static const double RATIOS[] = {1.0, 0.5, 0.3};
+static const double NANOS_PER_BYTE[] = {0.2, 0.6, 3.0};
+
+TEST_F(ExchangeCompressionPolicyTest, fast_network) {
+    // 3GB/s, sending a byte takes 0.33ns
+    ExchangeCompressionPolicy policy(3LL * 1024 * 1024 * 1024);
+    send(&policy, 10, RATIOS, NANOS_PER_BYTE);
+    ASSERT_EQ(ExchangeCompressionPolicy::NONE, policy.best_codec());
+}
+
+TEST_F(ExchangeCompressionPolicyTest, slow_network) {
+    // 50MB/s, sending a byte takes 19ns
+    ExchangeCompressionPolicy policy(50LL * 1024 * 1024);
+    send(&policy, 10, RATIOS, NANOS_PER_BYTE);
+    ASSERT_EQ(ExchangeCompressionPolicy::ZSTD, policy.best_codec());
+}
+
+TEST_F(ExchangeCompressionPolicyTest, middle_network) {
+    // 1GB/s, sending a byte takes 1ns
+    ExchangeCompressionPolicy policy(1024LL * 1024 * 1024);
+    send(&policy, 10, RATIOS, NANOS_PER_BYTE);
+    ASSERT_EQ(ExchangeCompressionPolicy::LZ4, policy.best_codec());
+}
+
+TEST_F(ExchangeCompressionPolicyTest, incompressible_data) {
+    ExchangeCompressionPolicy policy(100LL * 1024 * 1024);
+    double ratios[] = {1.0, 1.0, 1.0};
+    send(&policy, 10, ratios, NANOS_PER_BYTE);
+    ASSERT_EQ(ExchangeCompressionPolicy::NONE, policy.best_codec());
+}
+
+TEST_F(ExchangeCompressionPolicyTest, probe) {
+    ExchangeCompressionPolicy policy(50LL * 1024 * 1024);
+    send(&policy, 10, RATIOS, NANOS_PER_BYTE);
+    ASSERT_EQ(ExchangeCompressionPolicy::ZSTD, policy.best_codec());
+
+    // the data becomes incompressible, which is noticed by the batches sent
+    // with zstd and kept noticed by the probes
+    double ratios[] = {1.0, 1.0, 1.0};
+    send(&policy, 200, ratios, NANOS_PER_BYTE);
+    ASSERT_EQ(ExchangeCompressionPolicy::NONE, policy.best_codec());
+    ASSERT_NEAR(0.2 + 1e9 / (50LL * 1024 * 1024),
+                policy.cost(ExchangeCompressionPolicy::NONE), 0.001);
+}
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
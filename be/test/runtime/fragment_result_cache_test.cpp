@@ -0,0 +1,226 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/fragment_result_cache.h"
+
+#include <gtest/gtest.h>
+
+#include "gen_cpp/PaloInternalService_types.h"
+#include "runtime/mem_tracker.h"
+
+namespace doris {
+
+class FragmentResultCacheTest : public testing::Test {
+protected:
+    // an aggregation on a scan of one tablet sending to a stream
+    TExecPlanFragmentParams make_params() {
+        TExecPlanFragmentParams params;
+        TPlanNode agg_node;
+        agg_node.node_id = 1;
+        agg_node.node_type = TPlanNodeType::AGGREGATION_NODE;
+        agg_node.num_children = 1;
+        agg_node.limit = -1;
+        TPlanNode scan_node;
+        scan_node.node_id = 0;
+        scan_node.node_type = TPlanNodeType::OLAP_SCAN_NODE;
+        scan_node.num_children = 0;
+        scan_node.limit = -1;
+        params.fragment.plan.nodes.push_back(agg_node);
+        params.fragment.plan.nodes.push_back(scan_node);
+        params.fragment.__isset.plan = true;
+        params.fragment.output_sink.type = TDataSinkType::DATA_STREAM_SINK;
+        params.fragment.__isset.output_sink = true;
+        params.__isset.desc_tbl = true;
+
+        TScanRangeParams range_params;
+        TPaloScanRange& range = range_params.scan_range.palo_scan_range;
+        range.tablet_id = 10001;
+        range.schema_hash = "1234";
+        range.version = "5";
+        range.version_hash = "0";
+        range.hosts.resize(1);
+        range.hosts[0].hostname = "host1";
+        range_params.scan_range.__isset.palo_scan_range = true;
+        params.params.per_node_scan_ranges[0].push_back(range_params);
+        return params;
+    }
+};
+
+TEST_F(FragmentResultCacheTest, make_key) {
+    TExecPlanFragmentParams params = make_params();
+    std::string key;
+    std::map<int64_t, int64_t> versions;
+    bool is_mergeable = false;
+    ASSERT_TRUE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+    ASSERT_EQ(1, versions.size());
+    ASSERT_EQ(5, versions[10001]);
+    ASSERT_TRUE(is_mergeable);
+
+    // the key does not depend on the replica read or on the version
+    std::string other_key;
+    params.params.per_node_scan_ranges[0][0].scan_range.palo_scan_range.hosts[0].hostname = "host2";
+    params.params.per_node_scan_ranges[0][0].scan_range.palo_scan_range.version = "6";
+    ASSERT_TRUE(FragmentResultCache::make_key(params, &other_key, &versions, &is_mergeable));
+    ASSERT_EQ(key, other_key);
+    ASSERT_EQ(6, versions[10001]);
+
+    // another tablet is another key
+    params.params.per_node_scan_ranges[0][0].scan_range.palo_scan_range.tablet_id = 10002;
+    ASSERT_TRUE(FragmentResultCache::make_key(params, &other_key, &versions, &is_mergeable));
+    ASSERT_NE(key, other_key);
+}
+
+TEST_F(FragmentResultCacheTest, is_mergeable) {
+    std::string key;
+    std::map<int64_t, int64_t> versions;
+    bool is_mergeable = true;
+    {
+        // final results
+        TExecPlanFragmentParams params = make_params();
+        params.fragment.plan.nodes[0].agg_node.need_finalize = true;
+        ASSERT_TRUE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+        ASSERT_FALSE(is_mergeable);
+    }
+    {
+        // a limit cuts the rows of each scan
+        TExecPlanFragmentParams params = make_params();
+        params.fragment.plan.nodes[1].limit = 10;
+        ASSERT_TRUE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+        ASSERT_FALSE(is_mergeable);
+    }
+    {
+        TExecPlanFragmentParams params = make_params();
+        params.fragment.output_sink.type = TDataSinkType::RESULT_SINK;
+        ASSERT_TRUE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+        ASSERT_FALSE(is_mergeable);
+    }
+}
+
+TEST_F(FragmentResultCacheTest, not_cacheable) {
+    std::string key;
+    std::map<int64_t, int64_t> versions;
+    bool is_mergeable = false;
+    {
+        // no aggregation
+        TExecPlanFragmentParams params = make_params();
+        params.fragment.plan.nodes.erase(params.fragment.plan.nodes.begin());
+        ASSERT_FALSE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+    }
+    {
+        // rows from other fragments
+        TExecPlanFragmentParams params = make_params();
+        params.fragment.plan.nodes[1].node_type = TPlanNodeType::EXCHANGE_NODE;
+        ASSERT_FALSE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+    }
+    {
+        // loads have side effects
+        TExecPlanFragmentParams params = make_params();
+        params.fragment.output_sink.type = TDataSinkType::OLAP_TABLE_SINK;
+        ASSERT_FALSE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+    }
+    {
+        TExecPlanFragmentParams params = make_params();
+        TExpr expr;
+        TExprNode expr_node;
+        expr_node.fn.name.function_name = "rand";
+        expr_node.__isset.fn = true;
+        expr.nodes.push_back(expr_node);
+        params.fragment.plan.nodes[0].conjuncts.push_back(expr);
+        params.fragment.plan.nodes[0].__isset.conjuncts = true;
+        ASSERT_FALSE(FragmentResultCache::make_key(params, &key, &versions, &is_mergeable));
+    }
+}
+
+TEST_F(FragmentResultCacheTest, insert) {
+    MemTracker tracker(-1);
+    FragmentResultCache cache(1024 * 1024, &tracker);
+    ASSERT_EQ(nullptr, cache.lookup("key"));
+
+    FragmentResultCache::Lookup lookup;
+    lookup.key = "key";
+    lookup.versions[10001] = 5;
+    FragmentResultCache::Batches batches;
+    batches.emplace_back(new PRowBatch());
+    batches.back()->set_num_rows(3);
+    cache.insert(lookup, batches, 100);
+    ASSERT_EQ(103, tracker.consumption());
+
+    std::shared_ptr<const FragmentResultCache::Entry> entry = cache.lookup("key");
+    ASSERT_NE(nullptr, entry);
+    ASSERT_EQ(1, entry->batches.size());
+    ASSERT_EQ(3, entry->batches[0]->num_rows());
+    ASSERT_EQ(5, entry->versions.at(10001));
+
+    // the batches of new versions follow the cached ones
+    lookup.entry = entry;
+    lookup.is_incremental = true;
+    lookup.versions[10001] = 6;
+    entry.reset();
+    cache.insert(lookup, batches, 50);
+    lookup.entry.reset();
+    ASSERT_EQ(153, tracker.consumption());
+    entry = cache.lookup("key");
+    ASSERT_EQ(2, entry->batches.size());
+    ASSERT_EQ(6, entry->versions.at(10001));
+    entry.reset();
+
+    // entries beyond the capacity are evicted and released
+    lookup.is_incremental = false;
+    cache.insert(lookup, batches, 2 * 1024 * 1024);
+    ASSERT_EQ(0, tracker.consumption());
+}
+
+TEST_F(FragmentResultCacheTest, lookup) {
+    MemTracker tracker(-1);
+    FragmentResultCache cache(1024 * 1024, &tracker);
+    TExecPlanFragmentParams params = make_params();
+    params.fragment.plan.nodes[0].agg_node.need_finalize = true;
+
+    FragmentResultCache::Lookup lookup;
+    cache.lookup(params, &lookup);
+    ASSERT_FALSE(lookup.key.empty());
+    ASSERT_EQ(nullptr, lookup.entry);
+    cache.insert(lookup, FragmentResultCache::Batches(), 0);
+
+    // the same versions
+    FragmentResultCache::Lookup hit;
+    cache.lookup(params, &hit);
+    ASSERT_NE(nullptr, hit.entry);
+    ASSERT_FALSE(hit.is_incremental);
+
+    // final results of new versions are not of the old ones
+    params.params.per_node_scan_ranges[0][0].scan_range.palo_scan_range.version = "6";
+    FragmentResultCache::Lookup miss;
+    cache.lookup(params, &miss);
+    ASSERT_EQ(nullptr, miss.entry);
+
+    // neither are partial aggregates of older versions than the cached ones
+    params = make_params();
+    params.params.per_node_scan_ranges[0][0].scan_range.palo_scan_range.version = "4";
+    FragmentResultCache::Lookup older;
+    cache.lookup(params, &older);
+    ASSERT_EQ(lookup.key, older.key);
+    ASSERT_TRUE(older.is_mergeable);
+    ASSERT_EQ(nullptr, older.entry);
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
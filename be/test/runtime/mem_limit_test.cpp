@@ -19,6 +19,11 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
 #include "util/metrics.h"
 #include "util/logging.h"
 
@@ -188,6 +193,77 @@ TEST(MemTestTest, TrackerHierarchyTryConsume) {
     EXPECT_FALSE(p.limit_exceeded());
 }
 
+TEST(MemTestTest, BatchedConsumption) {
+    int64_t batch_bytes = config::mem_tracker_consume_batch_bytes;
+    ASSERT_GT(batch_bytes, 0);
+    MemTracker p(-1);
+    MemTracker c(-1, "", &p);
+
+    // the child is exact, the parent gets the consumption in batches
+    c.consume(100);
+    EXPECT_EQ(c.consumption(), 100);
+    EXPECT_EQ(p.consumption(), 0);
+    c.consume(batch_bytes);
+    EXPECT_EQ(c.consumption(), batch_bytes + 100);
+    EXPECT_GE(p.consumption(), batch_bytes);
+    EXPECT_LE(p.consumption(), batch_bytes + 100);
+
+    // consumption on many threads is all counted once the child is closed
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&c, i] () {
+            for (int j = 0; j < 10000; ++j) {
+                c.consume(j % 1000 + i);
+                c.release(j % 1000 + i);
+            }
+            c.consume(1000 + i);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    int64_t expected = batch_bytes + 100 + 8 * 1000 + 28;
+    EXPECT_EQ(c.consumption(), expected);
+    c.close();
+    EXPECT_EQ(p.consumption(), expected);
+    c.release(expected);
+    c.close();
+    EXPECT_EQ(c.consumption(), 0);
+    EXPECT_EQ(p.consumption(), 0);
+}
+
+TEST(MemTestTest, BatchBudget) {
+    int64_t batch_bytes = config::mem_tracker_consume_batch_bytes;
+    ASSERT_GT(batch_bytes, 0);
+    int64_t num_cores = CoreLocalValueController<int64_t>::instance()->size();
+    // 1/64 of the limit is the full batches of two trackers
+    MemTracker p(2 * 64 * num_cores * batch_bytes);
+    std::vector<std::unique_ptr<MemTracker>> children;
+    for (int i = 0; i < 3; ++i) {
+        children.emplace_back(new MemTracker(-1, "", &p));
+    }
+    EXPECT_EQ(batch_bytes, children[0]->_batch_bytes);
+    EXPECT_EQ(batch_bytes, children[1]->_batch_bytes);
+    // the others are exact, the parent would lag more than 1/64 of its limit else
+    EXPECT_EQ(0, children[2]->_batch_bytes);
+    {
+        MemTracker grandchild(-1, "", children[0].get());
+        EXPECT_EQ(0, grandchild._batch_bytes);
+        grandchild.consume(10);
+        EXPECT_EQ(10, children[0]->consumption());
+        grandchild.release(10);
+    }
+    children[2]->consume(10);
+    EXPECT_EQ(10, p.consumption());
+    children[2]->release(10);
+
+    // the budget is given back when a tracker is destroyed
+    children[1].reset();
+    MemTracker c(-1, "", &p);
+    EXPECT_EQ(batch_bytes, c._batch_bytes);
+    EXPECT_EQ(0, p._batch_budget);
+}
+
 #if 0
 class GcFunctionHelper {
     public:
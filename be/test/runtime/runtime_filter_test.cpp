@@ -0,0 +1,204 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/runtime_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "common/config.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "olap/bloom_filter.hpp"
+#include "runtime/runtime_filter_mgr.h"
+#include "util/cpu_info.h"
+#include "util/time.h"
+
+namespace doris {
+
+class RuntimeFilterTest : public testing::Test {
+public:
+    RuntimeFilterTest() { }
+
+protected:
+    static bool test_int(const RuntimeFilter& filter, int32_t value) {
+        return filter.bloom_filter()->test_bytes(
+            reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static std::unique_ptr<RuntimeFilter> int_filter(int32_t begin, int32_t end) {
+        std::unique_ptr<RuntimeFilter> filter(new RuntimeFilter(TYPE_INT));
+        EXPECT_TRUE(filter->init(100).ok());
+        for (int32_t i = begin; i < end; ++i) {
+            filter->insert(&i);
+        }
+        return filter;
+    }
+};
+
+TEST_F(RuntimeFilterTest, int_filter) {
+    RuntimeFilter filter(TYPE_INT);
+    ASSERT_TRUE(filter.init(100).ok());
+    ASSERT_TRUE(filter.is_empty());
+    ASSERT_TRUE(filter.bloom_filter() != nullptr);
+
+    for (int32_t i = 50; i > 0; i -= 2) {
+        filter.insert(&i);
+    }
+    filter.insert(nullptr);
+    ASSERT_FALSE(filter.is_empty());
+    ASSERT_EQ(2, *reinterpret_cast<const int32_t*>(filter.min_value()));
+    ASSERT_EQ(50, *reinterpret_cast<const int32_t*>(filter.max_value()));
+
+    int num_false_positives = 0;
+    for (int32_t i = 2; i <= 50; ++i) {
+        if (i % 2 == 0) {
+            ASSERT_TRUE(test_int(filter, i));
+        } else {
+            num_false_positives += test_int(filter, i);
+        }
+    }
+    ASSERT_LT(num_false_positives, 10);
+}
+
+TEST_F(RuntimeFilterTest, string_filter) {
+    RuntimeFilter filter(TYPE_VARCHAR);
+    ASSERT_TRUE(filter.init(10).ok());
+    // the values are copied, the buffer may be reused
+    char buf[8];
+    for (const char* value : {"b", "abc", "c", "ba"}) {
+        strcpy(buf, value);
+        StringValue str(buf, strlen(value));
+        filter.insert(&str);
+    }
+    StringValue empty(nullptr, 0);
+    filter.insert(&empty);
+    strcpy(buf, "zzzz");
+
+    ASSERT_EQ("", reinterpret_cast<const StringValue*>(filter.min_value())->to_string());
+    ASSERT_EQ("c", reinterpret_cast<const StringValue*>(filter.max_value())->to_string());
+    ASSERT_TRUE(filter.bloom_filter()->test_bytes("abc", 3));
+    ASSERT_TRUE(filter.bloom_filter()->test_bytes("", 0));
+}
+
+TEST_F(RuntimeFilterTest, no_bloom_filter) {
+    RuntimeFilter date_filter(TYPE_DATE);
+    ASSERT_TRUE(date_filter.init(10).ok());
+    ASSERT_TRUE(date_filter.bloom_filter() == nullptr);
+
+    RuntimeFilter large_filter(TYPE_INT);
+    ASSERT_TRUE(large_filter.init(config::runtime_filter_max_bloom_filter_entries + 1).ok());
+    ASSERT_TRUE(large_filter.bloom_filter() == nullptr);
+
+    ASSERT_FALSE(RuntimeFilter::is_supported(TYPE_DOUBLE));
+    ASSERT_FALSE(RuntimeFilter::is_supported(TYPE_CHAR));
+}
+
+TEST_F(RuntimeFilterTest, protobuf) {
+    std::unique_ptr<RuntimeFilter> filter = int_filter(10, 20);
+    PRuntimeFilter pfilter;
+    filter->to_protobuf(&pfilter);
+
+    RuntimeFilter copy(TYPE_INT);
+    ASSERT_TRUE(copy.from_protobuf(pfilter).ok());
+    ASSERT_EQ(10, *reinterpret_cast<const int32_t*>(copy.min_value()));
+    ASSERT_EQ(19, *reinterpret_cast<const int32_t*>(copy.max_value()));
+    for (int32_t i = 10; i < 20; ++i) {
+        ASSERT_TRUE(test_int(copy, i));
+    }
+
+    RuntimeFilter wrong_type(TYPE_BIGINT);
+    ASSERT_FALSE(wrong_type.from_protobuf(pfilter).ok());
+
+    pfilter.mutable_min_value()->append("x");
+    RuntimeFilter wrong_size(TYPE_INT);
+    ASSERT_FALSE(wrong_size.from_protobuf(pfilter).ok());
+
+    // an empty filter has no values
+    RuntimeFilter empty(TYPE_INT);
+    ASSERT_TRUE(empty.init(10).ok());
+    PRuntimeFilter pempty;
+    empty.to_protobuf(&pempty);
+    RuntimeFilter empty_copy(TYPE_INT);
+    ASSERT_TRUE(empty_copy.from_protobuf(pempty).ok());
+    ASSERT_TRUE(empty_copy.is_empty());
+}
+
+TEST_F(RuntimeFilterTest, merge) {
+    std::unique_ptr<RuntimeFilter> filter = int_filter(10, 20);
+    filter->merge(*int_filter(30, 40));
+    ASSERT_EQ(10, *reinterpret_cast<const int32_t*>(filter->min_value()));
+    ASSERT_EQ(39, *reinterpret_cast<const int32_t*>(filter->max_value()));
+    ASSERT_TRUE(test_int(*filter, 15));
+    ASSERT_TRUE(test_int(*filter, 35));
+
+    RuntimeFilter empty(TYPE_INT);
+    ASSERT_TRUE(empty.init(100).ok());
+    empty.merge(*filter);
+    ASSERT_EQ(10, *reinterpret_cast<const int32_t*>(empty.min_value()));
+    ASSERT_EQ(39, *reinterpret_cast<const int32_t*>(empty.max_value()));
+
+    // bloom filters of different sizes can not be merged
+    RuntimeFilter other_size(TYPE_INT);
+    ASSERT_TRUE(other_size.init(100000).ok());
+    filter->merge(other_size);
+    ASSERT_TRUE(filter->bloom_filter() == nullptr);
+    ASSERT_EQ(39, *reinterpret_cast<const int32_t*>(filter->max_value()));
+}
+
+TEST_F(RuntimeFilterTest, mgr) {
+    RuntimeFilterMgr mgr;
+    TUniqueId finst_id;
+    finst_id.__set_hi(1);
+    finst_id.__set_lo(2);
+
+    mgr.publish(finst_id, 1, int_filter(0, 10));
+    // one of two parts is not enough, it is dropped when the scan stops waiting
+    ASSERT_TRUE(mgr.take(finst_id, 1, 2, MonotonicMillis() + 10) == nullptr);
+
+    mgr.publish(finst_id, 1, int_filter(0, 10));
+    std::thread publisher([&mgr, &finst_id] () {
+        mgr.publish(finst_id, 1, RuntimeFilterTest::int_filter(20, 30));
+    });
+    std::shared_ptr<RuntimeFilter> filter = mgr.take(finst_id, 1, 2, MonotonicMillis() + 60000);
+    publisher.join();
+    ASSERT_TRUE(filter != nullptr);
+    ASSERT_EQ(0, *reinterpret_cast<const int32_t*>(filter->min_value()));
+    ASSERT_EQ(29, *reinterpret_cast<const int32_t*>(filter->max_value()));
+
+    // the filter is taken once
+    ASSERT_TRUE(mgr.take(finst_id, 1, 1, MonotonicMillis()) == nullptr);
+    // filters of other fragment instances are not taken
+    TUniqueId other_id = finst_id;
+    other_id.__set_lo(3);
+    mgr.publish(other_id, 1, int_filter(0, 10));
+    ASSERT_TRUE(mgr.take(finst_id, 1, 1, MonotonicMillis()) == nullptr);
+    ASSERT_TRUE(mgr.take(other_id, 1, 1, MonotonicMillis()) != nullptr);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    return RUN_ALL_TESTS();
+}
@@ -19,6 +19,7 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
 #include <thread>
 
 namespace doris {
@@ -196,6 +197,37 @@ TEST_F(StreamLoadPipeTest, append_mix) {
     t1.join();
 }
 
+TEST_F(StreamLoadPipeTest, read_buffer) {
+    StreamLoadPipe pipe(66, 64);
+
+    auto appender = [&pipe] {
+        // 30 bytes written to a new buffer, the appended one after it
+        for (int i = 0; i < 30; ++i) {
+            char buf = 'a';
+            pipe.append(&buf, 1);
+        }
+        auto byte_buf = ByteBuffer::allocate(64);
+        byte_buf->put_bytes("0123456789", 10);
+        byte_buf->flip();
+        pipe.append(byte_buf);
+        pipe.finish();
+    };
+    std::thread t1(appender);
+
+    ByteBufferPtr buf;
+    auto st = pipe.read_buffer(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_EQ(std::string(30, 'a'), std::string(buf->ptr + buf->pos, buf->remaining()));
+    st = pipe.read_buffer(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_EQ("0123456789", std::string(buf->ptr + buf->pos, buf->remaining()));
+    st = pipe.read_buffer(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_TRUE(buf == nullptr);
+
+    t1.join();
+}
+
 TEST_F(StreamLoadPipeTest, cancel) {
     StreamLoadPipe pipe(66, 64);
 
@@ -218,6 +250,30 @@ TEST_F(StreamLoadPipeTest, cancel) {
     t1.join();
 }
 
+TEST_F(StreamLoadPipeTest, append_nowait) {
+    StreamLoadPipe pipe(66, 64);
+    ASSERT_TRUE(pipe.has_room());
+    for (int i = 0; i < 2; ++i) {
+        auto byte_buf = ByteBuffer::allocate(64);
+        byte_buf->put_bytes(std::string(64, 'a' + i).data(), 64);
+        byte_buf->flip();
+        // the second buffer is taken beyond the capacity without waiting
+        ASSERT_TRUE(pipe.append_nowait(byte_buf).ok());
+    }
+    ASSERT_FALSE(pipe.has_room());
+
+    ByteBufferPtr buf;
+    ASSERT_TRUE(pipe.read_buffer(&buf).ok());
+    ASSERT_EQ('a', buf->ptr[0]);
+    ASSERT_TRUE(pipe.has_room());
+
+    pipe.cancel();
+    ASSERT_TRUE(pipe.has_room());
+    auto byte_buf = ByteBuffer::allocate(64);
+    byte_buf->flip();
+    ASSERT_FALSE(pipe.append_nowait(byte_buf).ok());
+}
+
 TEST_F(StreamLoadPipeTest, close) {
     StreamLoadPipe pipe(66, 64);
 
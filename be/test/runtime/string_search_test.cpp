@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/string_search.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "util/cpu_info.h"
+
+namespace doris {
+
+class StringSearchTest : public testing::Test {
+public:
+    StringSearchTest() { }
+
+protected:
+    int search(const std::string& str, const std::string& pattern) {
+        StringValue pattern_value(const_cast<char*>(pattern.data()), pattern.size());
+        StringValue str_value(const_cast<char*>(str.data()), str.size());
+        return StringSearch(&pattern_value).search(&str_value);
+    }
+
+    // matches at every position of strings longer than some blocks, and
+    // candidates whose first and last bytes match but the middle does not
+    void check_positions() {
+        std::string pattern = "abcab";
+        int pattern_len = pattern.size();
+        for (int len = 0; len <= 100; ++len) {
+            std::string str(len, 'a');
+            for (int pos = 0; pos + pattern_len <= len; ++pos) {
+                std::string s = str;
+                s.replace(pos, pattern_len, pattern);
+                ASSERT_EQ(pos, search(s, pattern));
+            }
+            ASSERT_EQ(-1, search("aXcab" + str, pattern));
+        }
+    }
+};
+
+TEST_F(StringSearchTest, search) {
+    ASSERT_EQ(0, search("abc", "abc"));
+    ASSERT_EQ(1, search("xabc", "abc"));
+    ASSERT_EQ(-1, search("ab", "abc"));
+    ASSERT_EQ(2, search("xxc", "c"));
+    ASSERT_EQ(-1, search("abc", ""));
+    ASSERT_EQ(1, search("aaabaab", "aab"));
+}
+
+TEST_F(StringSearchTest, positions) {
+    check_positions();
+}
+
+TEST_F(StringSearchTest, positions_without_avx2) {
+    CpuInfo::TempDisable disable_avx2(CpuInfo::AVX2);
+    check_positions();
+}
+
+}
+
+int main(int argc, char** argv) {
+    doris::CpuInfo::init();
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -81,6 +81,22 @@ TEST(StringValueTest, TestCompare) {
     }
 }
 
+TEST(StringValueTest, TestCompareSharedBuffer) {
+    std::string str = "abcdef";
+    StringValue full = FromStdString(str);
+    StringValue prefix(full.ptr, 3);
+    std::string copy = str;
+    StringValue other_buffer = FromStdString(copy);
+
+    EXPECT_TRUE(full.eq(full));
+    EXPECT_FALSE(full.eq(prefix));
+    EXPECT_TRUE(prefix.lt(full));
+    EXPECT_TRUE(full.gt(prefix));
+    EXPECT_EQ(0, full.compare(StringValue(full.ptr, full.len)));
+    EXPECT_TRUE(prefix.lt(other_buffer));
+    EXPECT_TRUE(full.eq(other_buffer));
+}
+
 }
 
 int main(int argc, char** argv) {
@@ -18,16 +18,26 @@
 #include "runtime/tablet_writer_mgr.h"
 
 #include <gtest/gtest.h>
+#include <unistd.h>
 
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
 #include "common/object_pool.h"
 #include "gen_cpp/Descriptors_types.h"
 #include "gen_cpp/PaloInternalService_types.h"
 #include "gen_cpp/Types_types.h"
+#include "gen_cpp/data.pb.h"
+#include "runtime/columnar_row_batch.h"
 #include "runtime/exec_env.h"
 #include "runtime/descriptors.h"
 #include "runtime/primitive_type.h"
+#include "runtime/mem_pool.h"
 #include "runtime/mem_tracker.h"
 #include "runtime/row_batch.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
 #include "runtime/tuple_row.h"
 #include "util/descriptor_helper.h"
 #include "util/thrift_util.h"
@@ -36,6 +46,7 @@
 namespace doris {
 
 std::unordered_map<int64_t, int> _k_tablet_recorder;
+std::vector<int64_t> _k_flushed_tablets;
 OLAPStatus open_status;
 OLAPStatus add_status;
 OLAPStatus close_status;
@@ -59,15 +70,27 @@ OLAPStatus DeltaWriter::open(WriteRequest* req, DeltaWriter** writer) {
     return open_status;
 }
 
-OLAPStatus DeltaWriter::write(Tuple* tuple) {
+OLAPStatus DeltaWriter::write(Tuple* tuple, int sender_id) {
     if (_k_tablet_recorder.find(_req.tablet_id) == std::end(_k_tablet_recorder)) {
         _k_tablet_recorder[_req.tablet_id] = 1;
     } else {
         _k_tablet_recorder[_req.tablet_id]++;
     }
+    // every row takes 100 bytes of the memtable
+    _mem_usage += 100;
     return add_status;
 }
 
+OLAPStatus DeltaWriter::write_batch(const std::vector<Tuple*>& tuples, int sender_id) {
+    for (auto tuple : tuples) {
+        OLAPStatus st = write(tuple, sender_id);
+        if (st != OLAP_SUCCESS) {
+            return st;
+        }
+    }
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus DeltaWriter::close(google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
     return close_status;
 }
@@ -76,12 +99,19 @@ OLAPStatus DeltaWriter::cancel() {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus DeltaWriter::flush_mem_table() {
+    _k_flushed_tablets.push_back(_req.tablet_id);
+    _mem_usage = 0;
+    return OLAP_SUCCESS;
+}
+
 class TabletWriterMgrTest : public testing::Test {
 public:
     TabletWriterMgrTest() { }
     virtual ~TabletWriterMgrTest() { }
     void SetUp() override {
         _k_tablet_recorder.clear();
+        _k_flushed_tablets.clear();
         open_status = OLAP_SUCCESS;
         add_status = OLAP_SUCCESS;
         close_status = OLAP_SUCCESS;
@@ -232,6 +262,220 @@ TEST_F(TabletWriterMgrTest, normal) {
     ASSERT_EQ(_k_tablet_recorder[21], 1);
 }
 
+TEST_F(TabletWriterMgrTest, flush_largest_memtables) {
+    ExecEnv env;
+    TabletWriterMgr mgr(&env);
+
+    auto tdesc_tbl = create_descriptor_table();
+    ObjectPool obj_pool;
+    DescriptorTbl* desc_tbl = nullptr;
+    DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    auto tuple_desc = desc_tbl->get_tuple_descriptor(0);
+    RowDescriptor row_desc(*desc_tbl, {0}, {false});
+    MemTracker tracker;
+    PUniqueId load_id;
+    load_id.set_hi(2);
+    load_id.set_lo(3);
+    {
+        PTabletWriterOpenRequest request;
+        request.set_allocated_id(&load_id);
+        request.set_index_id(4);
+        request.set_txn_id(1);
+        create_schema(desc_tbl, request.mutable_schema());
+        for (int i = 0; i < 3; ++i) {
+            auto tablet = request.add_tablets();
+            tablet->set_partition_id(10 + i);
+            tablet->set_tablet_id(20 + i);
+        }
+        request.set_num_senders(1);
+        request.set_need_gen_rollup(false);
+        auto st = mgr.open(request);
+        request.release_id();
+        ASSERT_TRUE(st.ok());
+    }
+
+    int64_t load_memtable_memory_limit = config::load_memtable_memory_limit;
+    config::load_memtable_memory_limit = 500;
+    auto add_batch = [&](int64_t packet_seq, const std::vector<int64_t>& tablet_ids) {
+        PTabletWriterAddBatchRequest request;
+        request.set_allocated_id(&load_id);
+        request.set_index_id(4);
+        request.set_sender_id(0);
+        request.set_eos(false);
+        request.set_packet_seq(packet_seq);
+        RowBatch row_batch(row_desc, 1024, &tracker);
+        for (auto tablet_id : tablet_ids) {
+            request.add_tablet_ids(tablet_id);
+            auto id = row_batch.add_row();
+            auto tuple = (Tuple*)row_batch.tuple_data_pool()->allocate(tuple_desc->byte_size());
+            row_batch.get_row(id)->set_tuple(0, tuple);
+            memset(tuple, 0, tuple_desc->byte_size());
+            row_batch.commit_last_row();
+        }
+        row_batch.serialize(request.mutable_row_batch());
+        google::protobuf::RepeatedPtrField<PTabletInfo> tablet_vec;
+        auto st = mgr.add_batch(request, &tablet_vec);
+        request.release_id();
+        return st;
+    };
+    ASSERT_TRUE(add_batch(0, {20, 21, 22, 20, 21}).ok());
+    // 200 bytes of 20 and 21 and 100 bytes of 22 are not above the limit
+    ASSERT_TRUE(_k_flushed_tablets.empty());
+    ASSERT_TRUE(add_batch(1, {20}).ok());
+    // 600 bytes, flushing the largest memtable gets below 80% of the limit
+    ASSERT_EQ(std::vector<int64_t>({20}), _k_flushed_tablets);
+    ASSERT_TRUE(add_batch(2, {22, 22, 22, 22}).ok());
+    // 200 bytes of 21 and 500 bytes of 22
+    ASSERT_EQ(std::vector<int64_t>({20, 22}), _k_flushed_tablets);
+    ASSERT_TRUE(add_batch(3, {20, 20, 20, 21, 21}).ok());
+    // 300 bytes of 20 and 400 bytes of 21
+    ASSERT_EQ(std::vector<int64_t>({20, 22, 21}), _k_flushed_tablets);
+    config::load_memtable_memory_limit = load_memtable_memory_limit;
+}
+
+TEST_F(TabletWriterMgrTest, columnar_batch) {
+    ExecEnv env;
+    TabletWriterMgr mgr(&env);
+
+    auto tdesc_tbl = create_descriptor_table();
+    ObjectPool obj_pool;
+    DescriptorTbl* desc_tbl = nullptr;
+    DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    auto tuple_desc = desc_tbl->get_tuple_descriptor(0);
+    RowDescriptor row_desc(*desc_tbl, {0}, {false});
+    MemTracker tracker;
+    PUniqueId load_id;
+    load_id.set_hi(2);
+    load_id.set_lo(3);
+    {
+        PTabletWriterOpenRequest request;
+        request.set_allocated_id(&load_id);
+        request.set_index_id(4);
+        request.set_txn_id(1);
+        create_schema(desc_tbl, request.mutable_schema());
+        for (int i = 0; i < 2; ++i) {
+            auto tablet = request.add_tablets();
+            tablet->set_partition_id(10 + i);
+            tablet->set_tablet_id(20 + i);
+        }
+        request.set_num_senders(1);
+        request.set_need_gen_rollup(false);
+        auto st = mgr.open(request);
+        request.release_id();
+        ASSERT_TRUE(st.ok());
+    }
+
+    {
+        PTabletWriterAddBatchRequest request;
+        request.set_allocated_id(&load_id);
+        request.set_index_id(4);
+        request.set_sender_id(0);
+        request.set_eos(true);
+        request.set_packet_seq(0);
+
+        RowBatch row_batch(row_desc, 1024, &tracker);
+        for (int i = 0; i < 1000; ++i) {
+            request.add_tablet_ids(20 + i % 3 / 2);
+            auto id = row_batch.add_row();
+            auto tuple = (Tuple*)row_batch.tuple_data_pool()->allocate(tuple_desc->byte_size());
+            row_batch.get_row(id)->set_tuple(0, tuple);
+            memset(tuple, 0, tuple_desc->byte_size());
+            *(int*)tuple->get_slot(tuple_desc->slots()[0]->tuple_offset()) = i;
+            *(int64_t*)tuple->get_slot(tuple_desc->slots()[1]->tuple_offset()) = i * 1000L;
+            row_batch.commit_last_row();
+        }
+        ColumnarRowBatch columnar_batch(*tuple_desc);
+        columnar_batch.serialize(&row_batch, request.mutable_columnar_batch());
+        google::protobuf::RepeatedPtrField<PTabletInfo> tablet_vec;
+        auto st = mgr.add_batch(request, &tablet_vec);
+        request.release_id();
+        ASSERT_TRUE(st.ok());
+    }
+    ASSERT_EQ(_k_tablet_recorder[20], 667);
+    ASSERT_EQ(_k_tablet_recorder[21], 333);
+}
+
+TEST_F(TabletWriterMgrTest, columnar_batch_encoding) {
+    TDescriptorTableBuilder table_builder;
+    {
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder().type(TYPE_INT).nullable(false)
+                       .column_name("c1").column_pos(0).build());
+        tuple.add_slot(
+            TSlotDescriptorBuilder().type(TYPE_BIGINT).column_name("c2").column_pos(1).build());
+        tuple.add_slot(
+            TSlotDescriptorBuilder().string_type(64).column_name("c3").column_pos(2).build());
+        tuple.build(&table_builder);
+    }
+    DescriptorTbl* desc_tbl = nullptr;
+    ObjectPool obj_pool;
+    DescriptorTbl::create(&obj_pool, table_builder.desc_tbl(), &desc_tbl);
+    auto tuple_desc = desc_tbl->get_tuple_descriptor(0);
+    RowDescriptor row_desc(*desc_tbl, {0}, {false});
+    MemTracker tracker;
+    auto c1 = tuple_desc->slots()[0];
+    auto c2 = tuple_desc->slots()[1];
+    auto c3 = tuple_desc->slots()[2];
+
+    RowBatch row_batch(row_desc, 1024, &tracker);
+    std::vector<std::string> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(std::string(i % 50, 'a' + i % 26));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        auto id = row_batch.add_row();
+        auto tuple = (Tuple*)row_batch.tuple_data_pool()->allocate(tuple_desc->byte_size());
+        row_batch.get_row(id)->set_tuple(0, tuple);
+        memset(tuple, 0, tuple_desc->byte_size());
+        *(int*)tuple->get_slot(c1->tuple_offset()) = i;
+        if (i % 3 == 0) {
+            tuple->set_null(c2->null_indicator_offset());
+        } else {
+            *(int64_t*)tuple->get_slot(c2->tuple_offset()) = -i * 1000L;
+        }
+        if (i % 7 == 0) {
+            tuple->set_null(c3->null_indicator_offset());
+        } else {
+            StringValue* value = tuple->get_string_slot(c3->tuple_offset());
+            value->ptr = &values[i][0];
+            value->len = values[i].size();
+        }
+        row_batch.commit_last_row();
+    }
+
+    for (bool compress : {false, true}) {
+        bool old_compress = config::compress_rowbatches;
+        config::compress_rowbatches = compress;
+        ColumnarRowBatch columnar_batch(*tuple_desc);
+        PColumnarRowBatch pbatch;
+        columnar_batch.serialize(&row_batch, &pbatch);
+        config::compress_rowbatches = old_compress;
+        ASSERT_EQ(compress, pbatch.has_uncompressed_size());
+
+        MemPool pool(&tracker);
+        std::vector<Tuple*> tuples;
+        ASSERT_TRUE(columnar_batch.deserialize(pbatch, &pool, &tuples).ok());
+        ASSERT_EQ(1000, tuples.size());
+        for (int i = 0; i < 1000; ++i) {
+            Tuple* tuple = tuples[i];
+            ASSERT_EQ(i, *(int*)tuple->get_slot(c1->tuple_offset()));
+            ASSERT_EQ(i % 3 == 0, tuple->is_null(c2->null_indicator_offset()));
+            if (i % 3 != 0) {
+                ASSERT_EQ(-i * 1000L, *(int64_t*)tuple->get_slot(c2->tuple_offset()));
+            }
+            ASSERT_EQ(i % 7 == 0, tuple->is_null(c3->null_indicator_offset()));
+            if (i % 7 != 0) {
+                StringValue* value = tuple->get_string_slot(c3->tuple_offset());
+                ASSERT_EQ(values[i], std::string(value->ptr, value->len));
+            }
+        }
+
+        // truncated data is refused
+        pbatch.mutable_data()->resize(pbatch.data().size() - 1);
+        ASSERT_FALSE(columnar_batch.deserialize(pbatch, &pool, &tuples).ok());
+    }
+}
+
 TEST_F(TabletWriterMgrTest, cancel) {
     ExecEnv env;
     TabletWriterMgr mgr(&env);
@@ -671,6 +915,81 @@ TEST_F(TabletWriterMgrTest, duplicate_packet) {
     ASSERT_EQ(_k_tablet_recorder[21], 1);
 }
 
+TEST_F(TabletWriterMgrTest, out_of_order_packet) {
+    ExecEnv env;
+    TabletWriterMgr mgr(&env);
+
+    auto tdesc_tbl = create_descriptor_table();
+    ObjectPool obj_pool;
+    DescriptorTbl* desc_tbl = nullptr;
+    DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    auto tuple_desc = desc_tbl->get_tuple_descriptor(0);
+    RowDescriptor row_desc(*desc_tbl, {0}, {false});
+    MemTracker tracker;
+    PUniqueId load_id;
+    load_id.set_hi(2);
+    load_id.set_lo(3);
+    {
+        PTabletWriterOpenRequest request;
+        request.set_allocated_id(&load_id);
+        request.set_index_id(4);
+        request.set_txn_id(1);
+        create_schema(desc_tbl, request.mutable_schema());
+        for (int i = 0; i < 2; ++i) {
+            auto tablet = request.add_tablets();
+            tablet->set_partition_id(10 + i);
+            tablet->set_tablet_id(20 + i);
+        }
+        request.set_num_senders(1);
+        request.set_need_gen_rollup(false);
+        auto st = mgr.open(request);
+        request.release_id();
+        ASSERT_TRUE(st.ok());
+    }
+
+    // packet 'seq' has one row of tablet 20 + seq % 2
+    auto add_packet = [&](int64_t seq) {
+        PTabletWriterAddBatchRequest request;
+        request.set_allocated_id(&load_id);
+        request.set_index_id(4);
+        request.set_sender_id(0);
+        request.set_eos(false);
+        request.set_packet_seq(seq);
+        request.add_tablet_ids(20 + seq % 2);
+
+        RowBatch row_batch(row_desc, 1024, &tracker);
+        auto id = row_batch.add_row();
+        auto tuple = (Tuple*)row_batch.tuple_data_pool()->allocate(tuple_desc->byte_size());
+        row_batch.get_row(id)->set_tuple(0, tuple);
+        memset(tuple, 0, tuple_desc->byte_size());
+        *(int*)tuple->get_slot(tuple_desc->slots()[0]->tuple_offset()) = seq;
+        *(int64_t*)tuple->get_slot(tuple_desc->slots()[1]->tuple_offset()) = seq;
+        row_batch.commit_last_row();
+        row_batch.serialize(request.mutable_row_batch());
+        google::protobuf::RepeatedPtrField<PTabletInfo> tablet_vec;
+        auto st = mgr.add_batch(request, &tablet_vec);
+        request.release_id();
+        return st;
+    };
+
+    // packet 1 arrives first and waits for packet 0
+    Status second_status("not finished");
+    std::thread second([&] { second_status = add_packet(1); });
+    usleep(100 * 1000);
+    ASSERT_TRUE(_k_tablet_recorder.find(21) == std::end(_k_tablet_recorder));
+    ASSERT_TRUE(add_packet(0).ok());
+    second.join();
+    ASSERT_TRUE(second_status.ok());
+    ASSERT_EQ(_k_tablet_recorder[20], 1);
+    ASSERT_EQ(_k_tablet_recorder[21], 1);
+
+    // later packets fail once a packet failed
+    add_status = OLAP_ERR_TABLE_NOT_FOUND;
+    ASSERT_FALSE(add_packet(2).ok());
+    add_status = OLAP_SUCCESS;
+    ASSERT_FALSE(add_packet(3).ok());
+}
+
 }
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,141 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "runtime/tracer.h"
+
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "gen_cpp/Types_types.h"
+
+namespace doris {
+
+class TracerTest : public testing::Test {
+protected:
+    void SetUp() override {
+        config::trace_sample_ratio = 1;
+        config::trace_export_url = "http://127.0.0.1:1/v1/traces";
+        std::vector<std::unique_ptr<SpanData>> spans;
+        Tracer::instance()->take_spans(&spans);
+    }
+    void TearDown() override {
+        config::trace_sample_ratio = 0;
+        config::trace_export_url = "";
+    }
+};
+
+TEST_F(TracerTest, sample) {
+    config::trace_sample_ratio = 0;
+    ASSERT_FALSE(Tracer::instance()->trace_context(1, 2).sampled);
+
+    config::trace_sample_ratio = 0.5;
+    int num_sampled = 0;
+    for (int i = 0; i < 1000; ++i) {
+        TraceContext trace = Tracer::instance()->trace_context(i, i * 7);
+        // all backends agree on the sampled traces
+        ASSERT_EQ(trace.sampled, Tracer::instance()->trace_context(i, i * 7).sampled);
+        num_sampled += trace.sampled;
+    }
+    ASSERT_GT(num_sampled, 400);
+    ASSERT_LT(num_sampled, 600);
+}
+
+TEST_F(TracerTest, not_sampled) {
+    config::trace_sample_ratio = 0;
+    {
+        Span span(Tracer::instance()->trace_context(1, 2), "scan");
+        ASSERT_FALSE(span.sampled());
+        ASSERT_FALSE(span.context().sampled);
+        Span child(span.context(), "read");
+        ASSERT_FALSE(child.sampled());
+    }
+    std::vector<std::unique_ptr<SpanData>> spans;
+    Tracer::instance()->take_spans(&spans);
+    ASSERT_TRUE(spans.empty());
+}
+
+TEST_F(TracerTest, spans) {
+    TraceContext root = Tracer::instance()->trace_context(1, 2);
+    ASSERT_TRUE(root.sampled);
+    {
+        Span span(root, "scan", 100);
+        span.add_attribute("rows", 10);
+        span.add_attribute("table", std::string("t1"));
+        Span child(span.context(), "read", 100);
+        child.set_status(Status("read failed"));
+        // ended before it started
+        child.end(50);
+        span.end(200);
+    }
+    std::vector<std::unique_ptr<SpanData>> spans;
+    Tracer::instance()->take_spans(&spans);
+    ASSERT_EQ(2, spans.size());
+    const SpanData& child = *spans[0];
+    const SpanData& span = *spans[1];
+    ASSERT_EQ("read", child.name);
+    ASSERT_EQ(100, child.end_ns);
+    ASSERT_EQ("read failed", child.error_msg);
+    ASSERT_EQ(span.context.span_id, child.parent_span_id);
+    ASSERT_EQ("scan", span.name);
+    ASSERT_EQ(0, span.parent_span_id);
+    ASSERT_NE(0, span.context.span_id);
+    ASSERT_EQ(1, span.context.trace_id_hi);
+    ASSERT_EQ(2, span.context.trace_id_lo);
+    ASSERT_EQ(200, span.end_ns);
+    ASSERT_EQ(2, span.attributes.size());
+
+    std::string json = Tracer::to_otlp_json(spans);
+    ASSERT_NE(std::string::npos,
+              json.find("\"traceId\":\"00000000000000010000000000000002\""));
+    ASSERT_NE(std::string::npos, json.find("\"startTimeUnixNano\":\"100\""));
+    ASSERT_NE(std::string::npos, json.find("{\"key\":\"rows\",\"value\":{\"intValue\":\"10\"}}"));
+    ASSERT_NE(std::string::npos,
+              json.find("\"status\":{\"code\":2,\"message\":\"read failed\"}"));
+}
+
+TEST_F(TracerTest, thrift) {
+    TraceContext trace = Tracer::instance()->trace_context(1, 2);
+    trace.span_id = 3;
+    TTraceContext t_trace;
+    trace.to_thrift(&t_trace);
+    TraceContext other = TraceContext::from_thrift(t_trace);
+    ASSERT_TRUE(other.sampled);
+    ASSERT_EQ(1, other.trace_id_hi);
+    ASSERT_EQ(2, other.trace_id_lo);
+    ASSERT_EQ(3, other.span_id);
+}
+
+TEST_F(TracerTest, max_buffered_spans) {
+    int32_t max_buffered_spans = config::trace_max_buffered_spans;
+    config::trace_max_buffered_spans = 2;
+    TraceContext root = Tracer::instance()->trace_context(1, 2);
+    for (int i = 0; i < 3; ++i) {
+        Span span(root, "scan");
+    }
+    config::trace_max_buffered_spans = max_buffered_spans;
+    std::vector<std::unique_ptr<SpanData>> spans;
+    Tracer::instance()->take_spans(&spans);
+    ASSERT_EQ(2, spans.size());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
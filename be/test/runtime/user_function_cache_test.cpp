@@ -174,6 +174,39 @@ TEST_F(UserFunctionCacheTest, load_normal) {
     cache.release_entry(entry);
 }
 
+TEST_F(UserFunctionCacheTest, optional_symbol) {
+    UserFunctionCache cache;
+    std::string lib_dir = "./be/test/runtime/test_data/user_function_cache/download";
+    auto st = cache.init(lib_dir);
+    ASSERT_TRUE(st.ok());
+    void* fn_ptr = nullptr;
+    UserFunctionCacheEntry* entry = nullptr;
+    st = cache.get_optional_function_ptr(1,
+                                         "_Z6my_addv",
+                                         "http://127.0.0.1:29999/my_add.so",
+                                         my_add_md5sum, &fn_ptr, &entry);
+    ASSERT_TRUE(st.ok());
+    ASSERT_NE(nullptr, fn_ptr);
+    ASSERT_NE(nullptr, entry);
+
+    // a missing symbol is not an error, and is remembered as missing
+    for (int i = 0; i < 2; ++i) {
+        fn_ptr = &fn_ptr;
+        st = cache.get_optional_function_ptr(1,
+                                             "my_add_batch",
+                                             "http://127.0.0.1:29999/my_add.so",
+                                             my_add_md5sum, &fn_ptr, &entry);
+        ASSERT_TRUE(st.ok());
+        ASSERT_EQ(nullptr, fn_ptr);
+    }
+    st = cache.get_function_ptr(1,
+                                "my_add_batch",
+                                "http://127.0.0.1:29999/my_add.so",
+                                my_add_md5sum, &fn_ptr, &entry);
+    ASSERT_FALSE(st.ok());
+    cache.release_entry(entry);
+}
+
 TEST_F(UserFunctionCacheTest, download_fail) {
     UserFunctionCache cache;
     std::string lib_dir = "./be/test/runtime/test_data/user_function_cache/download";
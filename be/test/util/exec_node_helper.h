@@ -0,0 +1,268 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "exec/exec_node.h"
+#include "gen_cpp/Exprs_types.h"
+#include "gen_cpp/Opcodes_types.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/primitive_type.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "runtime/types.h"
+
+namespace doris {
+
+// The values of the INT, BIGINT, FLOAT and DOUBLE slots of the rows of the exec
+// node tests, TEST_NULL stands for NULL. FLOAT and DOUBLE slots are written with
+// the values converted and read as the bits of their double values, so that
+// they compare exactly; -0.0 reads as TEST_NULL.
+typedef std::vector<int64_t> TestRow;
+static const int64_t TEST_NULL = std::numeric_limits<int64_t>::min();
+
+// Allocates from 'pool' a tuple of 'tuple_desc' with the slot values of 'values'
+inline Tuple* write_test_tuple(const TupleDescriptor* tuple_desc, const TestRow& values,
+                               MemPool* pool) {
+    Tuple* tuple = Tuple::create(tuple_desc->byte_size(), pool);
+    for (int i = 0; i < tuple_desc->slots().size(); ++i) {
+        const SlotDescriptor* slot = tuple_desc->slots()[i];
+        if (values[i] == TEST_NULL) {
+            tuple->set_null(slot->null_indicator_offset());
+            continue;
+        }
+        tuple->set_not_null(slot->null_indicator_offset());
+        void* value = tuple->get_slot(slot->tuple_offset());
+        if (slot->type().type == TYPE_INT) {
+            *reinterpret_cast<int32_t*>(value) = values[i];
+        } else if (slot->type().type == TYPE_FLOAT) {
+            *reinterpret_cast<float*>(value) = values[i];
+        } else if (slot->type().type == TYPE_DOUBLE) {
+            *reinterpret_cast<double*>(value) = values[i];
+        } else {
+            *reinterpret_cast<int64_t*>(value) = values[i];
+        }
+    }
+    return tuple;
+}
+
+// A leaf node returning 'rows' as rows of its single tuple, row[i] being the
+// value of slot i, in batches of at most 'batch_size' rows. The conjuncts pushed
+// down to it are evaluated.
+class TestRowsNode : public ExecNode {
+public:
+    TestRowsNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs,
+                 const std::vector<TestRow>& rows, int batch_size)
+            : ExecNode(pool, tnode, descs), _rows(rows), _batch_size(batch_size) { }
+
+    Status open(RuntimeState* state) override {
+        RETURN_IF_ERROR(ExecNode::open(state));
+        _next_row = 0;
+        return Status::OK;
+    }
+
+    Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos) override {
+        const TupleDescriptor* tuple_desc = row_desc().tuple_descriptors()[0];
+        int num_rows = 0;
+        while (_next_row < _rows.size() && num_rows < _batch_size && !row_batch->at_capacity()) {
+            const TestRow& values = _rows[_next_row++];
+            ++num_rows;
+            Tuple* tuple = write_test_tuple(tuple_desc, values, row_batch->tuple_data_pool());
+            TupleRow* row = row_batch->get_row(row_batch->add_row());
+            row->set_tuple(0, tuple);
+            if (eval_conjuncts(_conjunct_ctxs.data(), _conjunct_ctxs.size(), row)) {
+                row_batch->commit_last_row();
+            }
+        }
+        *eos = _next_row == _rows.size();
+        return Status::OK;
+    }
+
+    // the conjuncts pushed down by the parent
+    int num_conjuncts() const { return _conjunct_ctxs.size(); }
+
+private:
+    std::vector<TestRow> _rows;
+    int _batch_size;
+    int _next_row = 0;
+};
+
+inline TPlanNode make_test_plan_node(TPlanNodeType::type type, int node_id,
+                                     const std::vector<TTupleId>& row_tuples,
+                                     const std::vector<bool>& nullable_tuples) {
+    TPlanNode tnode;
+    tnode.node_id = node_id;
+    tnode.node_type = type;
+    tnode.num_children = 0;
+    tnode.limit = -1;
+    tnode.row_tuples = row_tuples;
+    tnode.nullable_tuples = nullable_tuples;
+    tnode.compact_data = false;
+    return tnode;
+}
+
+inline TExpr make_test_slot_ref(const SlotDescriptor* slot) {
+    TExprNode node;
+    node.node_type = TExprNodeType::SLOT_REF;
+    node.type = slot->type().to_thrift();
+    node.num_children = 0;
+    node.__isset.slot_ref = true;
+    node.slot_ref.slot_id = slot->id();
+    node.slot_ref.tuple_id = slot->parent();
+    TExpr expr;
+    expr.nodes.push_back(node);
+    return expr;
+}
+
+inline TExprNode make_test_expr_node(TExprNodeType::type node_type, PrimitiveType type) {
+    TExprNode node;
+    node.node_type = node_type;
+    node.type = TypeDescriptor(type).to_thrift();
+    node.num_children = 0;
+    node.output_scale = -1;
+    return node;
+}
+
+// 'node' with 'children', in the pre-order of the thrift expr trees
+inline TExpr make_test_expr(TExprNode node, const std::vector<TExpr>& children) {
+    node.num_children = children.size();
+    TExpr expr;
+    expr.nodes.push_back(node);
+    for (const TExpr& child : children) {
+        expr.nodes.insert(expr.nodes.end(), child.nodes.begin(), child.nodes.end());
+    }
+    return expr;
+}
+
+inline TExpr make_test_int_literal(PrimitiveType type, int64_t value) {
+    TExprNode node = make_test_expr_node(TExprNodeType::INT_LITERAL, type);
+    node.__isset.int_literal = true;
+    node.int_literal.value = value;
+    return make_test_expr(node, {});
+}
+
+inline TExpr make_test_null_literal(PrimitiveType type) {
+    return make_test_expr(make_test_expr_node(TExprNodeType::NULL_LITERAL, type), {});
+}
+
+inline TExpr make_test_arithmetic(TExprOpcode::type op, PrimitiveType type,
+                                  const std::vector<TExpr>& children) {
+    TExprNode node = make_test_expr_node(TExprNodeType::ARITHMETIC_EXPR, type);
+    node.__set_opcode(op);
+    return make_test_expr(node, children);
+}
+
+inline TExpr make_test_binary_pred(TExprOpcode::type op, PrimitiveType child_type,
+                                   const TExpr& lhs, const TExpr& rhs) {
+    TExprNode node = make_test_expr_node(TExprNodeType::BINARY_PRED, TYPE_BOOLEAN);
+    node.__set_opcode(op);
+    node.__set_child_type(to_thrift(child_type));
+    return make_test_expr(node, {lhs, rhs});
+}
+
+inline TExpr make_test_compound_pred(TExprOpcode::type op, const std::vector<TExpr>& children) {
+    TExprNode node = make_test_expr_node(TExprNodeType::COMPOUND_PRED, TYPE_BOOLEAN);
+    node.__set_opcode(op);
+    return make_test_expr(node, children);
+}
+
+inline TExpr make_test_cast(PrimitiveType type, PrimitiveType child_type, const TExpr& child) {
+    TExprNode node = make_test_expr_node(TExprNodeType::CAST_EXPR, type);
+    node.__set_opcode(TExprOpcode::CAST);
+    node.__set_child_type(to_thrift(child_type));
+    return make_test_expr(node, {child});
+}
+
+// 'children' are the tested expr and the values of the list
+inline TExpr make_test_in_pred(bool is_not_in, const std::vector<TExpr>& children) {
+    TExprNode node = make_test_expr_node(TExprNodeType::IN_PRED, TYPE_BOOLEAN);
+    node.__set_opcode(is_not_in ? TExprOpcode::FILTER_NOT_IN : TExprOpcode::FILTER_IN);
+    node.__isset.in_predicate = true;
+    node.in_predicate.is_not_in = is_not_in;
+    return make_test_expr(node, children);
+}
+
+// A call of the builtin 'name' the expr factory builds without a symbol, e.g. ifnull
+inline TExpr make_test_fn_call(const std::string& name, PrimitiveType type,
+                               const std::vector<TExpr>& children) {
+    TExprNode node = make_test_expr_node(TExprNodeType::FUNCTION_CALL, type);
+    node.__isset.fn = true;
+    node.fn.name.function_name = name;
+    node.fn.binary_type = TFunctionBinaryType::BUILTIN;
+    node.fn.ret_type = node.type;
+    node.fn.has_var_args = false;
+    return make_test_expr(node, children);
+}
+
+// Reads the rows of opened 'node' as the values of 'slots', the slots of a NULL
+// tuple being NULL
+inline Status read_test_rows(RuntimeState* state, ExecNode* node,
+                             const std::vector<const SlotDescriptor*>& slots,
+                             std::vector<TestRow>* rows) {
+    MemTracker tracker(-1);
+    RowBatch batch(node->row_desc(), state->batch_size(), &tracker);
+    bool eos = false;
+    while (!eos) {
+        RETURN_IF_ERROR(node->get_next(state, &batch, &eos));
+        for (int i = 0; i < batch.num_rows(); ++i) {
+            TupleRow* row = batch.get_row(i);
+            TestRow values;
+            for (const SlotDescriptor* slot : slots) {
+                Tuple* tuple = row->get_tuple(node->row_desc().get_tuple_idx(slot->parent()));
+                if (tuple == nullptr || tuple->is_null(slot->null_indicator_offset())) {
+                    values.push_back(TEST_NULL);
+                } else if (slot->type().type == TYPE_INT) {
+                    values.push_back(*reinterpret_cast<int32_t*>(
+                            tuple->get_slot(slot->tuple_offset())));
+                } else if (slot->type().type == TYPE_FLOAT
+                        || slot->type().type == TYPE_DOUBLE) {
+                    double value = slot->type().type == TYPE_FLOAT
+                        ? *reinterpret_cast<float*>(tuple->get_slot(slot->tuple_offset()))
+                        : *reinterpret_cast<double*>(tuple->get_slot(slot->tuple_offset()));
+                    int64_t bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    values.push_back(bits);
+                } else {
+                    values.push_back(*reinterpret_cast<int64_t*>(
+                            tuple->get_slot(slot->tuple_offset())));
+                }
+            }
+            rows->push_back(values);
+        }
+        batch.reset();
+    }
+    return Status::OK;
+}
+
+// the rows of the tests are compared regardless of their order
+inline std::vector<TestRow> sorted_test_rows(std::vector<TestRow> rows) {
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+}
@@ -0,0 +1,149 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "util/fair_share_thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "util/stopwatch.hpp"
+
+namespace doris {
+
+class FairShareThreadPoolTest : public testing::Test {
+protected:
+    // a task of 'group' which takes about 'nanos' of cpu
+    FairShareThreadPool::WorkFunction task(int group, uint64_t nanos) {
+        return [this, group, nanos] () {
+            MonotonicStopWatch watch;
+            watch.start();
+            while (watch.elapsed_time() < nanos) {
+            }
+            std::lock_guard<std::mutex> l(_lock);
+            _order.push_back(group);
+        };
+    }
+
+    // blocks the thread of a pool of one until release()
+    void block(FairShareThreadPool* pool) {
+        _blocked = true;
+        pool->offer(0, 1, [this] () {
+            while (_blocked) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    void release() {
+        _blocked = false;
+    }
+
+    void wait(size_t num_tasks) {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> l(_lock);
+                if (_order.size() >= num_tasks) {
+                    return;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::atomic<bool> _blocked {false};
+    std::mutex _lock;
+    std::vector<int> _order;
+};
+
+TEST_F(FairShareThreadPoolTest, short_group_is_not_behind) {
+    FairShareThreadPool pool(1, 1000);
+    block(&pool);
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(pool.offer(1, 1, task(1, 1000000)));
+    }
+    ASSERT_TRUE(pool.offer(2, 1, task(2, 1000000)));
+    release();
+    wait(21);
+    // the task of group 2 runs after one of group 1 at most, not after all of them
+    int pos = std::find(_order.begin(), _order.end(), 2) - _order.begin();
+    ASSERT_LE(pos, 1);
+    ASSERT_EQ(0, pool.get_queue_size());
+}
+
+TEST_F(FairShareThreadPoolTest, weights) {
+    FairShareThreadPool pool(1, 1000);
+    block(&pool);
+    for (int i = 0; i < 40; ++i) {
+        ASSERT_TRUE(pool.offer(1, 3, task(1, 1000000)));
+        ASSERT_TRUE(pool.offer(2, 1, task(2, 1000000)));
+    }
+    release();
+    wait(80);
+    // group 1 gets about 3 of 4 of the first tasks
+    int num_group1 = std::count(_order.begin(), _order.begin() + 40, 1);
+    ASSERT_GE(num_group1, 26);
+    ASSERT_LE(num_group1, 34);
+}
+
+TEST_F(FairShareThreadPoolTest, idle_group_saves_no_time) {
+    FairShareThreadPool pool(1, 1000);
+    block(&pool);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(pool.offer(1, 1, task(1, 1000000)));
+    }
+    release();
+    wait(10);
+    // group 2 comes after group 1 ran alone
+    block(&pool);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(pool.offer(1, 1, task(1, 1000000)));
+        ASSERT_TRUE(pool.offer(2, 1, task(2, 1000000)));
+    }
+    release();
+    wait(30);
+    // group 1 is not starved until group 2 catches up
+    int num_group1 = std::count(_order.begin() + 10, _order.begin() + 20, 1);
+    ASSERT_GE(num_group1, 3);
+}
+
+TEST_F(FairShareThreadPoolTest, shutdown) {
+    FairShareThreadPool pool(4, 10);
+    std::atomic<int> count {0};
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(pool.offer(i % 3, 1, [&count] () { ++count; }));
+    }
+    while (pool.get_queue_size() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool.shutdown();
+    pool.join();
+    ASSERT_FALSE(pool.offer(1, 1, [] () {}));
+    ASSERT_GE(count, 96);
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
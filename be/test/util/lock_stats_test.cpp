@@ -0,0 +1,88 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+
+#include "util/lock_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+#include "util/doris_metrics.h"
+
+namespace doris {
+
+class LockStatsTest : public testing::Test {
+public:
+    LockStatsTest() { }
+};
+
+TEST_F(LockStatsTest, uncontended) {
+    LockStats stats("test_uncontended");
+    InstrumentedMutex lock(&stats);
+    for (int i = 0; i < 10; ++i) {
+        std::lock_guard<InstrumentedMutex> l(lock);
+    }
+    ASSERT_TRUE(lock.try_lock());
+    lock.unlock();
+    ASSERT_EQ(11, stats.acquisitions());
+    ASSERT_EQ(0, stats.contentions());
+    ASSERT_EQ(0, stats.wait_ns());
+    // hold time is not measured by default
+    ASSERT_EQ(0, stats.hold_ns());
+}
+
+TEST_F(LockStatsTest, contended) {
+    config::lock_hold_time_stats = true;
+    LockStats stats("test_contended");
+    InstrumentedMutex lock(&stats);
+    lock.lock();
+    std::thread waiter([&lock] () {
+        std::lock_guard<InstrumentedMutex> l(lock);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    lock.unlock();
+    waiter.join();
+    config::lock_hold_time_stats = false;
+
+    ASSERT_EQ(2, stats.acquisitions());
+    ASSERT_EQ(1, stats.contentions());
+    ASSERT_GT(stats.wait_ns(), 0);
+    ASSERT_GE(stats.hold_ns(), 50 * 1000 * 1000);
+}
+
+TEST_F(LockStatsTest, metrics) {
+    DorisMetrics::instance()->initialize("test");
+    LockStats* stats = LockStats::get("test_metrics");
+    ASSERT_EQ(stats, LockStats::get("test_metrics"));
+    InstrumentedMutex lock(stats);
+    { std::lock_guard<InstrumentedMutex> l(lock); }
+
+    auto metric = DorisMetrics::metrics()->get_metric(
+        "lock_acquisitions_total", MetricLabels().add("lock", "test_metrics"));
+    ASSERT_TRUE(metric != nullptr);
+    ASSERT_STREQ("1", ((SimpleMetric*)metric)->to_string().c_str());
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/mysql_row_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "runtime/datetime_value.h"
+
+namespace doris {
+
+class MysqlRowBufferTest : public testing::Test {
+public:
+    MysqlRowBufferTest() { }
+
+protected:
+    std::string value(const MysqlRowBuffer& buffer) {
+        return std::string(buffer.buf(), buffer.length());
+    }
+};
+
+TEST_F(MysqlRowBufferTest, text) {
+    MysqlRowBuffer buffer;
+    buffer.push_tinyint(-128);
+    ASSERT_EQ(std::string("\x04-128"), value(buffer));
+
+    buffer.reset();
+    buffer.push_int(0);
+    buffer.push_bigint(-9223372036854775807L - 1);
+    buffer.push_unsigned_bigint(18446744073709551615UL);
+    ASSERT_EQ(std::string("\x01" "0" "\x14-9223372036854775808" "\x14" "18446744073709551615"),
+              value(buffer));
+
+    buffer.reset();
+    DateTimeValue datetime;
+    datetime.from_date_int64(20191231235958L);
+    buffer.push_datetime(datetime);
+    ASSERT_EQ(std::string("\x13" "2019-12-31 23:59:58"), value(buffer));
+
+    buffer.reset();
+    buffer.push_null();
+    buffer.push_string("abc", 3);
+    ASSERT_EQ(std::string("\xfb\x03" "abc"), value(buffer));
+}
+
+TEST_F(MysqlRowBufferTest, binary) {
+    MysqlRowBuffer buffer;
+    buffer.set_binary_format(true);
+    buffer.push_smallint(0x0102);
+    buffer.push_int(-1);
+    ASSERT_EQ(std::string("\x02\x01\xff\xff\xff\xff"), value(buffer));
+
+    buffer.reset();
+    DateTimeValue datetime;
+    datetime.from_date_int64(20191231235958L);
+    buffer.push_datetime(datetime);
+    datetime.cast_to_date();
+    buffer.push_datetime(datetime);
+    ASSERT_EQ(std::string("\x07\xe3\x07\x0c\x1f\x17\x3b\x3a" "\x04\xe3\x07\x0c\x1f"),
+              value(buffer));
+
+    std::string row;
+    MysqlRowBuffer::init_binary_row(7, &row);
+    ASSERT_EQ(std::string(3, '\0'), row);
+    MysqlRowBuffer::set_binary_null(0, &row);
+    MysqlRowBuffer::set_binary_null(6, &row);
+    ASSERT_EQ(std::string("\x00\x04\x01", 3), row);
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -204,6 +204,38 @@ private:
     std::stringstream _ss;
 };
 
+TEST_F(MetricsTest, Histogram) {
+    // buckets are contiguous
+    for (int i = 0; i < Histogram::NUM_BUCKETS; ++i) {
+        int64_t lower = Histogram::bucket_lower_bound(i);
+        ASSERT_EQ(i, Histogram::bucket_index(lower));
+        if (i > 0) {
+            ASSERT_EQ(i - 1, Histogram::bucket_index(lower - 1));
+        }
+    }
+    ASSERT_EQ(0, Histogram::bucket_index(-5));
+    ASSERT_EQ(Histogram::NUM_BUCKETS - 1, Histogram::bucket_index(1L << 40));
+
+    Histogram histogram;
+    ASSERT_EQ(0, histogram.count());
+    ASSERT_EQ(0, histogram.percentile(99));
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.add(i);
+    }
+    ASSERT_EQ(1000, histogram.count());
+    ASSERT_EQ(500500, histogram.sum());
+    // within the 25% of a bucket
+    ASSERT_NEAR(500, histogram.percentile(50), 125);
+    ASSERT_NEAR(990, histogram.percentile(99), 248);
+    ASSERT_GE(1024, histogram.percentile(100));
+
+    std::vector<int64_t> buckets;
+    histogram.get_buckets(&buckets);
+    ASSERT_EQ(Histogram::NUM_BUCKETS, static_cast<int>(buckets.size()));
+    ASSERT_EQ(1, buckets[1]);
+    ASSERT_EQ(0, buckets[Histogram::NUM_BUCKETS - 1]);
+}
+
 TEST_F(MetricsTest, MetricCollector) {
     IntCounter puts;
     puts.increment(101);
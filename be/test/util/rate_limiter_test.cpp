@@ -0,0 +1,68 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/rate_limiter.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "util/stopwatch.hpp"
+
+namespace doris {
+
+class RateLimiterTest : public testing::Test {
+public:
+    RateLimiterTest() { }
+};
+
+TEST_F(RateLimiterTest, acquire) {
+    RateLimiter limiter(1024 * 1024);
+    MonotonicStopWatch watch;
+    watch.start();
+    for (int i = 0; i < 4; ++i) {
+        limiter.acquire(64 * 1024);
+    }
+    // 256KB at 1MB/s
+    ASSERT_GE(watch.elapsed_time(), 150L * 1000 * 1000);
+}
+
+TEST_F(RateLimiterTest, shared) {
+    RateLimiter limiter(1024 * 1024);
+    MonotonicStopWatch watch;
+    watch.start();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&limiter] () {
+            limiter.acquire(64 * 1024);
+            limiter.acquire(64 * 1024);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // the threads share the rate, 512KB at 1MB/s
+    ASSERT_GE(watch.elapsed_time(), 400L * 1000 * 1000);
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,162 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/roaring_bitmap.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+
+namespace doris {
+
+class RoaringBitmapTest : public testing::Test {
+protected:
+    std::string serialize(const RoaringBitmap& bitmap) {
+        std::string buf(bitmap.serialized_size(), '\0');
+        bitmap.serialize(&buf[0]);
+        return buf;
+    }
+};
+
+TEST_F(RoaringBitmapTest, add) {
+    RoaringBitmap bitmap;
+    ASSERT_EQ(0, bitmap.cardinality());
+    bitmap.add(1);
+    bitmap.add(1);
+    bitmap.add(65536 * 3 + 7);
+    bitmap.add(UINT32_MAX);
+    ASSERT_EQ(3, bitmap.cardinality());
+    ASSERT_TRUE(bitmap.contains(1));
+    ASSERT_TRUE(bitmap.contains(65536 * 3 + 7));
+    ASSERT_TRUE(bitmap.contains(UINT32_MAX));
+    ASSERT_FALSE(bitmap.contains(2));
+    ASSERT_FALSE(bitmap.contains(7));
+}
+
+// a group is kept in a bitset once it has more than ARRAY_MAX_SIZE values
+TEST_F(RoaringBitmapTest, dense) {
+    RoaringBitmap bitmap;
+    for (uint32_t i = 0; i < 10000; i += 2) {
+        bitmap.add(i);
+    }
+    ASSERT_EQ(5000, bitmap.cardinality());
+    for (uint32_t i = 0; i < 10000; ++i) {
+        ASSERT_EQ(i % 2 == 0, bitmap.contains(i));
+    }
+    // 4 bytes of count, 6 of group header and the bitset
+    ASSERT_EQ(4 + 6 + 8192, bitmap.serialized_size());
+
+    // few values are left, the intersection is an array again
+    RoaringBitmap other;
+    for (uint32_t i = 0; i < 100; ++i) {
+        other.add(i);
+    }
+    bitmap.intersect_with(other);
+    ASSERT_EQ(50, bitmap.cardinality());
+    ASSERT_EQ(4 + 6 + 50 * 2, bitmap.serialized_size());
+}
+
+TEST_F(RoaringBitmapTest, intersects) {
+    RoaringBitmap sparse;
+    sparse.add(100);
+    sparse.add(65536 * 2 + 5);
+    ASSERT_TRUE(sparse.intersects(100, 101));
+    ASSERT_FALSE(sparse.intersects(101, 65536 * 2 + 5));
+    ASSERT_TRUE(sparse.intersects(101, 65536 * 2 + 6));
+    ASSERT_FALSE(sparse.intersects(100, 100));
+
+    RoaringBitmap dense;
+    for (uint32_t i = 0; i < 10000; i += 200) {
+        for (uint32_t j = 0; j < 100; ++j) {
+            dense.add(i + j);
+        }
+    }
+    for (uint32_t begin = 0; begin < 10000; begin += 37) {
+        bool expected = false;
+        for (uint32_t i = begin; i < begin + 70; ++i) {
+            expected |= dense.contains(i);
+        }
+        ASSERT_EQ(expected, dense.intersects(begin, begin + 70)) << begin;
+    }
+}
+
+TEST_F(RoaringBitmapTest, union_and_intersect) {
+    RoaringBitmap a;
+    RoaringBitmap b;
+    std::set<uint32_t> set_a;
+    std::set<uint32_t> set_b;
+    for (uint32_t i = 0; i < 100000; ++i) {
+        uint32_t value = i * 7919 % 300000;
+        a.add(value);
+        set_a.insert(value);
+        value = i * 104729 % 500000;
+        b.add(value);
+        set_b.insert(value);
+    }
+    ASSERT_EQ(set_a.size(), a.cardinality());
+    ASSERT_EQ(set_b.size(), b.cardinality());
+
+    RoaringBitmap intersection = a;
+    intersection.intersect_with(b);
+    size_t num_common = 0;
+    for (uint32_t value : set_a) {
+        bool common = set_b.count(value) > 0;
+        num_common += common;
+        ASSERT_EQ(common, intersection.contains(value));
+    }
+    ASSERT_EQ(num_common, intersection.cardinality());
+
+    RoaringBitmap result = a;
+    result.union_with(b);
+    ASSERT_EQ(set_a.size() + set_b.size() - num_common, result.cardinality());
+    for (uint32_t value : set_b) {
+        ASSERT_TRUE(result.contains(value));
+    }
+}
+
+TEST_F(RoaringBitmapTest, serialize) {
+    RoaringBitmap bitmap;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        bitmap.add(i);
+        bitmap.add(i * 1000003);
+    }
+    std::string buf = serialize(bitmap);
+
+    RoaringBitmap result;
+    ASSERT_TRUE(result.deserialize(buf.data(), buf.size()));
+    ASSERT_EQ(bitmap.cardinality(), result.cardinality());
+    ASSERT_EQ(buf, serialize(result));
+
+    RoaringBitmap empty;
+    std::string empty_buf = serialize(empty);
+    ASSERT_TRUE(result.deserialize(empty_buf.data(), empty_buf.size()));
+    ASSERT_EQ(0, result.cardinality());
+
+    // truncated or trailing bytes
+    ASSERT_FALSE(result.deserialize(buf.data(), buf.size() - 1));
+    buf.push_back('\0');
+    ASSERT_FALSE(result.deserialize(buf.data(), buf.size()));
+    ASSERT_FALSE(result.deserialize("abc", 3));
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
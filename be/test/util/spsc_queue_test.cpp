@@ -0,0 +1,90 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/spsc_queue.hpp"
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "util/event_count.h"
+
+namespace doris {
+
+TEST(SpscQueueTest, Basic) {
+    SpscQueue<int> queue(3);
+    ASSERT_EQ(4, queue.capacity());
+    int i;
+    ASSERT_FALSE(queue.try_pop(&i));
+    for (int j = 0; j < 4; ++j) {
+        ASSERT_TRUE(queue.try_push(j));
+    }
+    ASSERT_TRUE(queue.full());
+    ASSERT_FALSE(queue.try_push(4));
+    ASSERT_TRUE(queue.try_pop(&i));
+    ASSERT_EQ(0, i);
+    ASSERT_TRUE(queue.try_push(4));
+    for (int j = 1; j < 5; ++j) {
+        ASSERT_TRUE(queue.try_pop(&i));
+        ASSERT_EQ(j, i);
+    }
+    ASSERT_EQ(0, queue.size());
+}
+
+// The consumer waits on an event count while the queue is empty, every element
+// must arrive in order.
+TEST(SpscQueueTest, ProducerConsumer) {
+    const int num_elements = 100000;
+    SpscQueue<int> queue(16);
+    EventCount added;
+    EventCount removed;
+
+    std::thread producer([&]() {
+        for (int i = 0; i < num_elements; ++i) {
+            while (!queue.try_push(i)) {
+                EventCount::Key key = removed.prepare_wait();
+                if (queue.try_push(i)) {
+                    removed.cancel_wait();
+                    break;
+                }
+                removed.wait(key, 1000);
+            }
+            added.notify();
+        }
+    });
+    for (int i = 0; i < num_elements; ++i) {
+        int val = -1;
+        while (!queue.try_pop(&val)) {
+            EventCount::Key key = added.prepare_wait();
+            if (queue.try_pop(&val)) {
+                added.cancel_wait();
+                break;
+            }
+            ASSERT_TRUE(added.wait(key, 10000));
+        }
+        removed.notify();
+        ASSERT_EQ(i, val);
+    }
+    producer.join();
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
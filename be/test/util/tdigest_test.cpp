@@ -0,0 +1,106 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/tdigest.h"
+
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace doris {
+
+class TDigestTest : public testing::Test {
+protected:
+    // the true value at quantile q of sorted values
+    double exact_quantile(const std::vector<double>& values, double q) {
+        size_t index = std::min(static_cast<size_t>(q * values.size()), values.size() - 1);
+        return values[index];
+    }
+};
+
+TEST_F(TDigestTest, empty) {
+    TDigest digest;
+    ASSERT_TRUE(isnan(digest.quantile(0.5)));
+    digest.add(3);
+    ASSERT_EQ(3, digest.quantile(0));
+    ASSERT_EQ(3, digest.quantile(0.5));
+    ASSERT_EQ(3, digest.quantile(1));
+}
+
+TEST_F(TDigestTest, uniform) {
+    TDigest digest;
+    for (int i = 1; i <= 10000; ++i) {
+        digest.add(i);
+    }
+    ASSERT_EQ(1, digest.quantile(0));
+    ASSERT_EQ(10000, digest.quantile(1));
+    ASSERT_NEAR(5000, digest.quantile(0.5), 50);
+    ASSERT_NEAR(9900, digest.quantile(0.99), 10);
+}
+
+// the digests of parts merged after a round trip through serialization are as
+// accurate as one digest, and the tails more than the median
+TEST_F(TDigestTest, merge) {
+    std::mt19937 generator(1);
+    std::exponential_distribution<double> distribution(1.0);
+    std::vector<double> values;
+    TDigest parts[8];
+    for (int i = 0; i < 200000; ++i) {
+        double value = distribution(generator);
+        values.push_back(value);
+        parts[i % 8].add(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    TDigest digest;
+    for (auto& part : parts) {
+        std::string buf(part.serialized_size(), '\0');
+        part.serialize(&buf[0]);
+        TDigest result;
+        ASSERT_TRUE(result.deserialize(buf.data(), buf.size()));
+        digest.merge(result);
+    }
+    ASSERT_EQ(200000, digest.total_weight());
+    ASSERT_NEAR(exact_quantile(values, 0.5), digest.quantile(0.5), 0.01);
+    ASSERT_NEAR(exact_quantile(values, 0.99), digest.quantile(0.99), 0.01);
+    ASSERT_NEAR(exact_quantile(values, 0.001), digest.quantile(0.001), 0.0001);
+}
+
+TEST_F(TDigestTest, deserialize) {
+    TDigest digest;
+    for (int i = 0; i < 1000; ++i) {
+        digest.add(i % 97);
+    }
+    std::string buf(digest.serialized_size(), '\0');
+    digest.serialize(&buf[0]);
+    TDigest result;
+    ASSERT_FALSE(result.deserialize(buf.data(), buf.size() - 1));
+    ASSERT_FALSE(result.deserialize(buf.data(), 4));
+    ASSERT_TRUE(result.deserialize(buf.data(), buf.size()));
+    ASSERT_EQ(digest.quantile(0.3), result.quantile(0.3));
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
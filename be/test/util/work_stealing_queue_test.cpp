@@ -0,0 +1,122 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/work_stealing_queue.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace doris {
+
+TEST(WorkStealingQueueTest, Basic) {
+    WorkStealingQueue<int> queue(1, 5);
+    ASSERT_TRUE(queue.blocking_put(1));
+    ASSERT_TRUE(queue.blocking_put(2));
+    ASSERT_TRUE(queue.blocking_put(3));
+    ASSERT_EQ(3, queue.get_size());
+    int i;
+    ASSERT_TRUE(queue.blocking_get(0, &i));
+    ASSERT_EQ(1, i);
+    ASSERT_TRUE(queue.blocking_get(0, &i));
+    ASSERT_EQ(2, i);
+    ASSERT_TRUE(queue.blocking_get(0, &i));
+    ASSERT_EQ(3, i);
+    ASSERT_EQ(0, queue.get_size());
+}
+
+TEST(WorkStealingQueueTest, GetFromShutdownQueue) {
+    WorkStealingQueue<int> queue(2, 2);
+    ASSERT_TRUE(queue.blocking_put(123));
+    queue.shutdown();
+    ASSERT_FALSE(queue.blocking_put(456));
+    int i;
+    // worker 1 steals it from the shard of worker 0
+    ASSERT_TRUE(queue.blocking_get(1, &i));
+    ASSERT_EQ(123, i);
+    ASSERT_FALSE(queue.blocking_get(0, &i));
+}
+
+TEST(WorkStealingQueueTest, Levels) {
+    WorkStealingQueue<int> queue(1, 100, 3);
+    ASSERT_TRUE(queue.blocking_put(0, 0));
+    ASSERT_TRUE(queue.blocking_put(2, 2));
+    ASSERT_TRUE(queue.blocking_put(1, 1));
+    ASSERT_TRUE(queue.blocking_put(3, 2));
+    int i;
+    ASSERT_TRUE(queue.blocking_get(0, &i));
+    ASSERT_EQ(2, i);
+    ASSERT_TRUE(queue.blocking_get(0, &i));
+    ASSERT_EQ(3, i);
+    ASSERT_TRUE(queue.blocking_get(0, &i));
+    ASSERT_EQ(1, i);
+    ASSERT_TRUE(queue.blocking_get(0, &i));
+    ASSERT_EQ(0, i);
+}
+
+// Producers put more than the queue holds while workers get, every task must
+// be got exactly once.
+TEST(WorkStealingQueueTest, MultiThread) {
+    const int num_workers = 4;
+    const int num_producers = 4;
+    const int num_tasks = 10000;
+    WorkStealingQueue<int> queue(num_workers, 64);
+
+    std::vector<std::atomic<int>> got(num_producers * num_tasks);
+    for (auto& g : got) {
+        g = 0;
+    }
+    std::vector<std::thread> workers;
+    for (int w = 0; w < num_workers; ++w) {
+        workers.emplace_back([&queue, &got, w]() {
+            int task;
+            while (queue.blocking_get(w, &task)) {
+                ++got[task];
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < num_tasks; ++i) {
+                ASSERT_TRUE(queue.blocking_put(p * num_tasks + i));
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    while (queue.get_size() > 0) {
+        std::this_thread::yield();
+    }
+    queue.shutdown();
+    for (auto& t : workers) {
+        t.join();
+    }
+    for (auto& g : got) {
+        ASSERT_EQ(1, g.load());
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -118,6 +118,18 @@ public class ColumnDef {
             }
         }
 
+        if (aggregateType == AggregateType.BITMAP_UNION) {
+            // the storage can aggregate bitmaps only up to the longest varchar
+            if (((ScalarType) type).getLength() != ScalarType.MAX_VARCHAR_LENGTH) {
+                throw new AnalysisException("BITMAP_UNION column must be VARCHAR("
+                        + ScalarType.MAX_VARCHAR_LENGTH + "): " + name);
+            }
+            if (defaultValue != null && !defaultValue.isEmpty()) {
+                throw new AnalysisException("BITMAP_UNION column can only have the empty bitmap ''"
+                        + " as default value: " + name);
+            }
+        }
+
         if (type.getPrimitiveType() == PrimitiveType.HLL) {
             if (defaultValue != null) {
                 throw new AnalysisException("Hll can not set default value");
@@ -26,6 +26,7 @@ import org.apache.doris.mysql.privilege.PrivPredicate;
 import org.apache.doris.mysql.privilege.UserResource;
 import org.apache.doris.qe.ConnectContext;
 import org.apache.doris.qe.SessionVariable;
+import org.apache.doris.thrift.TExchangeCompression;
 
 import com.google.common.base.Strings;
 
@@ -67,6 +68,15 @@ public class SetVar {
     }
 
     // Value can be null. When value is null, means to set variable to DEFAULT.
+    private static boolean isValidExchangeCompression(String compression) {
+        for (TExchangeCompression type : TExchangeCompression.values()) {
+            if (type.name().equalsIgnoreCase(compression)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     public void analyze(Analyzer analyzer) throws AnalysisException, UserException {
         if (type == null) {
             type = SetType.DEFAULT;
@@ -91,6 +101,13 @@ public class SetVar {
                 throw new AnalysisException("Invalid resource group, now we support {low, normal, high}.");
             }
         }
+        if (variable.equalsIgnoreCase(SessionVariable.EXCHANGE_COMPRESSION)) {
+            String compression = value.getStringValue();
+            if (!compression.isEmpty() && !isValidExchangeCompression(compression)) {
+                throw new AnalysisException("Invalid exchange compression, now we support "
+                        + "{none, snappy, lz4, zstd, adaptive}.");
+            }
+        }
     }
 
     public String toSql() {
@@ -296,6 +296,18 @@ public class FunctionSet {
                 .put(Type.HLL,
                         "20hll_union_agg_updateEPN9doris_udf15FunctionContextERKNS1_6HllValEPS4_")
                 .build();
+
+    private static final Map<Type, String> BITMAP_UPDATE_INT_SYMBOL =
+        ImmutableMap.<Type, String>builder()
+                .put(Type.TINYINT,
+                    "17bitmap_update_intIN9doris_udf10TinyIntValEEEvPNS2_15FunctionContextERKT_PNS2_9StringValE")
+                .put(Type.SMALLINT,
+                    "17bitmap_update_intIN9doris_udf11SmallIntValEEEvPNS2_15FunctionContextERKT_PNS2_9StringValE")
+                .put(Type.INT,
+                    "17bitmap_update_intIN9doris_udf6IntValEEEvPNS2_15FunctionContextERKT_PNS2_9StringValE")
+                .put(Type.BIGINT,
+                    "17bitmap_update_intIN9doris_udf9BigIntValEEEvPNS2_15FunctionContextERKT_PNS2_9StringValE")
+                .build();
  
     private static final Map<Type, String> OFFSET_FN_INIT_SYMBOL =
         ImmutableMap.<Type, String>builder()
@@ -1009,6 +1021,46 @@ public class FunctionSet {
                 prefix + "22string_concat_finalizeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
                 false, false, false));
 
+        // Percentile_approx
+        addBuiltin(AggregateFunction.createBuiltin("percentile_approx",
+                Lists.<Type>newArrayList(Type.DOUBLE, Type.DOUBLE), Type.DOUBLE, Type.VARCHAR,
+                prefix + "22percentile_approx_initEPN9doris_udf15FunctionContextEPNS1_9StringValE",
+                prefix + "24percentile_approx_updateEPN9doris_udf15FunctionContextERKNS1_9DoubleValES6_PNS1_9StringValE",
+                prefix + "23percentile_approx_mergeEPN9doris_udf15FunctionContextERKNS1_9StringValEPS4_",
+                prefix + "27percentile_approx_serializeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                prefix + "26percentile_approx_finalizeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                false, false, false));
+
+        // Bitmap union of serialized bitmaps
+        final String bitmapPrefix = "_ZN5doris15BitmapFunctions";
+        addBuiltin(AggregateFunction.createBuiltin("bitmap_union",
+                Lists.<Type>newArrayList(Type.VARCHAR), Type.VARCHAR, Type.VARCHAR,
+                bitmapPrefix + "11bitmap_initEPN9doris_udf15FunctionContextEPNS1_9StringValE",
+                bitmapPrefix + "12bitmap_unionEPN9doris_udf15FunctionContextERKNS1_9StringValEPS4_",
+                bitmapPrefix + "12bitmap_unionEPN9doris_udf15FunctionContextERKNS1_9StringValEPS4_",
+                bitmapPrefix + "16bitmap_serializeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                bitmapPrefix + "16bitmap_serializeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                true, false, true));
+        addBuiltin(AggregateFunction.createBuiltin("bitmap_union_count",
+                Lists.<Type>newArrayList(Type.VARCHAR), Type.BIGINT, Type.VARCHAR,
+                bitmapPrefix + "11bitmap_initEPN9doris_udf15FunctionContextEPNS1_9StringValE",
+                bitmapPrefix + "12bitmap_unionEPN9doris_udf15FunctionContextERKNS1_9StringValEPS4_",
+                bitmapPrefix + "12bitmap_unionEPN9doris_udf15FunctionContextERKNS1_9StringValEPS4_",
+                bitmapPrefix + "16bitmap_serializeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                bitmapPrefix + "15bitmap_finalizeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                true, false, true));
+        // Exact count distinct of integers in [0, 2^32)
+        for (Type t : Lists.newArrayList(Type.TINYINT, Type.SMALLINT, Type.INT, Type.BIGINT)) {
+            addBuiltin(AggregateFunction.createBuiltin("bitmap_union_int",
+                    Lists.newArrayList(t), Type.BIGINT, Type.VARCHAR,
+                    bitmapPrefix + "11bitmap_initEPN9doris_udf15FunctionContextEPNS1_9StringValE",
+                    bitmapPrefix + BITMAP_UPDATE_INT_SYMBOL.get(t),
+                    bitmapPrefix + "12bitmap_unionEPN9doris_udf15FunctionContextERKNS1_9StringValEPS4_",
+                    bitmapPrefix + "16bitmap_serializeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                    bitmapPrefix + "15bitmap_finalizeEPN9doris_udf15FunctionContextERKNS1_9StringValE",
+                    true, false, true));
+        }
+
         // analytic functions
         // Rank
         addBuiltin(AggregateFunction.createAnalyticBuiltin("rank",
@@ -100,7 +100,9 @@ public class TabletInvertedIndex {
         this.lock.writeLock().unlock();
     }
 
-    public void tabletReport(long backendId, Map<Long, TTablet> backendTablets,
+    // if 'isIncremental', 'backendTablets' only has the tablets changed since the last report
+    // of the backend, the others are not looked at and none is deleted from meta
+    public void tabletReport(long backendId, Map<Long, TTablet> backendTablets, boolean isIncremental,
                              final HashMap<Long, TStorageMedium> storageMediumMap,
                              ListMultimap<Long, Long> tabletSyncMap,
                              ListMultimap<Long, Long> tabletDeleteFromMeta,
@@ -117,8 +119,19 @@ public class TabletInvertedIndex {
             start = System.currentTimeMillis();
             Map<Long, Replica> replicaMetaWithBackend = backingReplicaMetaTable.row(backendId);
             if (replicaMetaWithBackend != null) {
+                Iterable<Map.Entry<Long, Replica>> replicaEntries = replicaMetaWithBackend.entrySet();
+                if (isIncremental) {
+                    List<Map.Entry<Long, Replica>> reportedEntries = Lists.newArrayList();
+                    for (Long tabletId : backendTablets.keySet()) {
+                        Replica replica = replicaMetaWithBackend.get(tabletId);
+                        if (replica != null) {
+                            reportedEntries.add(Maps.immutableEntry(tabletId, replica));
+                        }
+                    }
+                    replicaEntries = reportedEntries;
+                }
                 // traverse replicas in meta with this backend
-                for (Map.Entry<Long, Replica> entry : replicaMetaWithBackend.entrySet()) {
+                for (Map.Entry<Long, Replica> entry : replicaEntries) {
                     long tabletId = entry.getKey();
                     Preconditions.checkState(tabletMetaMap.containsKey(tabletId));
                     TabletMeta tabletMeta = tabletMetaMap.get(tabletId);
@@ -125,6 +125,7 @@ public class ReportHandler extends Daemon {
         Map<TTaskType, Set<Long>> tasks = null;
         Map<String, TDisk> disks = null;
         Map<Long, TTablet> tablets = null;
+        boolean isIncrementalTablets = false;
         boolean forceRecovery = false;
         long reportVersion = -1;
 
@@ -143,6 +144,10 @@ public class ReportHandler extends Daemon {
             tablets = request.getTablets();
             reportVersion = request.getReport_version();
             reportType += " tablet";
+            if (request.isSetIncremental_tablet_report() && request.isIncremental_tablet_report()) {
+                isIncrementalTablets = true;
+                reportType += "(incremental)";
+            }
         } else if (request.isSetTablet_list()) {
             // the 'tablets' member will be deprecated in future.
             tablets = buildTabletMap(request.getTablet_list());
@@ -154,7 +159,8 @@ public class ReportHandler extends Daemon {
             forceRecovery = request.isForce_recovery();
         }
         
-        ReportTask reportTask = new ReportTask(beId, tasks, disks, tablets, reportVersion, forceRecovery);
+        ReportTask reportTask = new ReportTask(beId, tasks, disks, tablets, isIncrementalTablets,
+                reportVersion, forceRecovery);
         try {
             putToQueue(reportTask);
         } catch (Exception e) {
@@ -199,17 +205,19 @@ public class ReportHandler extends Daemon {
         private Map<TTaskType, Set<Long>> tasks;
         private Map<String, TDisk> disks;
         private Map<Long, TTablet> tablets;
+        private boolean isIncrementalTablets;
         private long reportVersion;
         private boolean forceRecovery = false;
 
         public ReportTask(long beId, Map<TTaskType, Set<Long>> tasks,
                 Map<String, TDisk> disks,
-                Map<Long, TTablet> tablets, long reportVersion, 
+                Map<Long, TTablet> tablets, boolean isIncrementalTablets, long reportVersion,
                 boolean forceRecovery) {
             this.beId = beId;
             this.tasks = tasks;
             this.disks = disks;
             this.tablets = tablets;
+            this.isIncrementalTablets = isIncrementalTablets;
             this.reportVersion = reportVersion;
             this.forceRecovery = forceRecovery;
         }
@@ -228,17 +236,18 @@ public class ReportHandler extends Daemon {
                     LOG.warn("out of date report version {} from backend[{}]. current report version[{}]",
                              reportVersion, beId, backendReportVersion);
                 } else {
-                    ReportHandler.tabletReport(beId, tablets, reportVersion, forceRecovery);
+                    ReportHandler.tabletReport(beId, tablets, isIncrementalTablets, reportVersion,
+                            forceRecovery);
                 }
             }
         }
     }
 
-    private static void tabletReport(long backendId, Map<Long, TTablet> backendTablets, long backendReportVersion, 
-            boolean forceRecovery) {
+    private static void tabletReport(long backendId, Map<Long, TTablet> backendTablets,
+            boolean isIncremental, long backendReportVersion, boolean forceRecovery) {
         long start = System.currentTimeMillis();
-        LOG.info("backend[{}] reports {} tablet(s). report version: {}",
-                 backendId, backendTablets.size(), backendReportVersion);
+        LOG.info("backend[{}] reports {} tablet(s). incremental: {}, report version: {}",
+                 backendId, backendTablets.size(), isIncremental, backendReportVersion);
 
         // storage medium map
         HashMap<Long, TStorageMedium> storageMediumMap = Catalog.getInstance().getPartitionIdToStorageMediumMap();
@@ -261,7 +270,8 @@ public class ReportHandler extends Daemon {
         ListMultimap<Long, Long> tabletRecoveryMap = LinkedListMultimap.create();
 
         // 1. do the diff. find out (intersection) / (be - meta) / (meta - be)
-        Catalog.getCurrentInvertedIndex().tabletReport(backendId, backendTablets, storageMediumMap,
+        Catalog.getCurrentInvertedIndex().tabletReport(backendId, backendTablets, isIncremental,
+                                                       storageMediumMap,
                                                        tabletSyncMap,
                                                        tabletDeleteFromMeta,
                                                        foundTabletsWithValidSchema,
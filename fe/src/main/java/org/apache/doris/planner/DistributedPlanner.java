@@ -23,6 +23,7 @@ import org.apache.doris.analysis.InsertStmt;
 import org.apache.doris.analysis.JoinOperator;
 import org.apache.doris.analysis.QueryStmt;
 import org.apache.doris.analysis.SlotDescriptor;
+import org.apache.doris.analysis.SlotRef;
 import org.apache.doris.catalog.Catalog;
 import org.apache.doris.catalog.ColocateTableIndex;
 import org.apache.doris.catalog.Column;
@@ -343,6 +344,11 @@ public class DistributedPlanner {
 
         if (canColocateJoin(node, leftChildFragment, rightChildFragment)) {
             node.setColocate(true);
+            if (canSortMergeJoin(node, leftChildFragment.getPlanRoot(), rightChildFragment.getPlanRoot())) {
+                node.setSortMerge(true);
+                ((OlapScanNode) leftChildFragment.getPlanRoot()).setSortedOutput(true);
+                ((OlapScanNode) rightChildFragment.getPlanRoot()).setSortedOutput(true);
+            }
             //node.setDistributionMode(HashJoinNode.DistributionMode.PARTITIONED);
             node.setChild(0, leftChildFragment.getPlanRoot());
             node.setChild(1, rightChildFragment.getPlanRoot());
@@ -495,6 +501,63 @@ public class DistributedPlanner {
         return false;
     }
 
+    // a colocate inner join of two scans can merge their rows sorted by the key columns
+    // if the eqJoinConjuncts are on the leading key columns of both. the eqJoinConjuncts
+    // are put in the order of those columns
+    private boolean canSortMergeJoin(HashJoinNode node, PlanNode leftRoot, PlanNode rightRoot) {
+        if (!ConnectContext.get().getSessionVariable().isEnableSortMergeJoin()) {
+            return false;
+        }
+        if (node.getJoinOp() != JoinOperator.INNER_JOIN
+                || !(leftRoot instanceof OlapScanNode) || !(rightRoot instanceof OlapScanNode)) {
+            return false;
+        }
+        OlapScanNode leftScan = (OlapScanNode) leftRoot;
+        OlapScanNode rightScan = (OlapScanNode) rightRoot;
+        if (leftScan.getSelectedIndexId() == -1 || rightScan.getSelectedIndexId() == -1) {
+            return false;
+        }
+        List<Column> leftKeys = leftScan.getOlapTable().getKeyColumnsByIndexId(leftScan.getSelectedIndexId());
+        List<Column> rightKeys = rightScan.getOlapTable().getKeyColumnsByIndexId(rightScan.getSelectedIndexId());
+
+        List<Pair<Expr, Expr>> eqJoinConjuncts = node.getEqJoinConjuncts();
+        if (eqJoinConjuncts.isEmpty()
+                || eqJoinConjuncts.size() > leftKeys.size() || eqJoinConjuncts.size() > rightKeys.size()) {
+            return false;
+        }
+        List<Pair<Expr, Expr>> sortedConjuncts = Lists.newArrayList();
+        for (int i = 0; i < eqJoinConjuncts.size(); ++i) {
+            Column leftKey = leftKeys.get(i);
+            Column rightKey = rightKeys.get(i);
+            if (!leftKey.getType().equals(rightKey.getType())) {
+                return false;
+            }
+            Pair<Expr, Expr> keyConjunct = null;
+            for (Pair<Expr, Expr> eqJoinPredicate : eqJoinConjuncts) {
+                // casts would change the order of the values
+                if (!(eqJoinPredicate.first instanceof SlotRef) || !(eqJoinPredicate.second instanceof SlotRef)) {
+                    return false;
+                }
+                SlotDescriptor leftSlot = ((SlotRef) eqJoinPredicate.first).getDesc();
+                SlotDescriptor rightSlot = ((SlotRef) eqJoinPredicate.second).getDesc();
+                if (leftScan.getTupleIds().contains(leftSlot.getParent().getId())
+                        && leftKey.equals(leftSlot.getColumn())
+                        && rightScan.getTupleIds().contains(rightSlot.getParent().getId())
+                        && rightKey.equals(rightSlot.getColumn())) {
+                    keyConjunct = eqJoinPredicate;
+                    break;
+                }
+            }
+            if (keyConjunct == null) {
+                return false;
+            }
+            sortedConjuncts.add(keyConjunct);
+        }
+        eqJoinConjuncts.clear();
+        eqJoinConjuncts.addAll(sortedConjuncts);
+        return true;
+    }
+
     /**
      * Modifies the leftChildFragment to execute a cross join. The right child input is provided by an ExchangeNode,
      * which is the destination of the rightChildFragment's output.
@@ -32,6 +32,8 @@ import org.apache.doris.common.UserException;
 import org.apache.doris.thrift.TEqJoinCondition;
 import org.apache.doris.thrift.TExplainLevel;
 import org.apache.doris.thrift.THashJoinNode;
+import org.apache.doris.thrift.TJoinOp;
+import org.apache.doris.thrift.TMergeJoinNode;
 import org.apache.doris.thrift.TPlanNode;
 import org.apache.doris.thrift.TPlanNodeType;
 import com.google.common.base.Objects;
@@ -59,6 +61,8 @@ public class HashJoinNode extends PlanNode {
     private boolean isPushDown;
     private DistributionMode distrMode;
     private boolean isColocate = false; //the flag for colocate join
+    // the children return their rows sorted by the eq join exprs, which are merged
+    private boolean isSortMerge = false;
 
     public HashJoinNode(PlanNodeId id, PlanNode outer, PlanNode inner, TableRef innerRef,
                         List<Pair<Expr, Expr>> eqJoinConjuncts, List<Expr> otherJoinConjuncts) {
@@ -120,6 +124,14 @@ public class HashJoinNode extends PlanNode {
         isColocate = colocate;
     }
 
+    public boolean isSortMerge() {
+        return isSortMerge;
+    }
+
+    public void setSortMerge(boolean sortMerge) {
+        isSortMerge = sortMerge;
+    }
+
     @Override
     public void init(Analyzer analyzer) throws UserException {
         assignConjuncts(analyzer);
@@ -252,6 +264,19 @@ public class HashJoinNode extends PlanNode {
 
     @Override
     protected void toThrift(TPlanNode msg) {
+        if (isSortMerge) {
+            msg.node_type = TPlanNodeType.MERGE_JOIN_NODE;
+            msg.merge_join_node = new TMergeJoinNode();
+            for (Pair<Expr, Expr> entry : eqJoinConjuncts) {
+                msg.merge_join_node.addToCmp_conjuncts(
+                        new TEqJoinCondition(entry.first.treeToThrift(), entry.second.treeToThrift()));
+            }
+            for (Expr e : otherJoinConjuncts) {
+                msg.merge_join_node.addToOther_join_conjuncts(e.treeToThrift());
+            }
+            msg.merge_join_node.setJoin_op(TJoinOp.INNER_JOIN);
+            return;
+        }
         msg.node_type = TPlanNodeType.HASH_JOIN_NODE;
         msg.hash_join_node = new THashJoinNode();
         msg.hash_join_node.join_op = joinOp.toThrift();
@@ -264,6 +289,7 @@ public class HashJoinNode extends PlanNode {
             msg.hash_join_node.addToOther_join_conjuncts(e.treeToThrift());
         }
         msg.hash_join_node.setIs_push_down(isPushDown);
+        msg.hash_join_node.setIs_broadcast(distrMode == DistributionMode.BROADCAST);
     }
 
     @Override
@@ -271,6 +297,9 @@ public class HashJoinNode extends PlanNode {
     protected String getNodeExplainString(String detailPrefix, TExplainLevel detailLevel) {
         String distrModeStr =
           (distrMode != DistributionMode.NONE) ? (" (" + distrMode.toString() + ")") : "";
+        if (isSortMerge) {
+            distrModeStr += " (SORT MERGE)";
+        }
         StringBuilder output = new StringBuilder().append(
           detailPrefix + "join op: " + joinOp.toString() + distrModeStr + "\n").append(
           detailPrefix + "hash predicates:\n");
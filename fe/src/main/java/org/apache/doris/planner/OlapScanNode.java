@@ -92,6 +92,8 @@ public class OlapScanNode extends ScanNode {
     private long selectedTabletsNum = 0;
     private long totalTabletsNum = 0;
     private long selectedIndexId = -1;
+    // return the rows of each instance in the order of the key columns
+    private boolean sortedOutput = false;
     private int selectedPartitionNum = 0;
     private long totalBytes = 0;
 
@@ -120,6 +122,14 @@ public class OlapScanNode extends ScanNode {
         return isPreAggregation;
     }
 
+    public long getSelectedIndexId() {
+        return selectedIndexId;
+    }
+
+    public void setSortedOutput(boolean sortedOutput) {
+        this.sortedOutput = sortedOutput;
+    }
+
     public boolean getCanTurnOnPreAggr() {
         return canTurnOnPreAggr;
     }
@@ -396,6 +406,9 @@ public class OlapScanNode extends ScanNode {
         if (null != sortColumn) {
             output.append(prefix).append("SORT COLUMN: ").append(sortColumn).append("\n");
         }
+        if (sortedOutput) {
+            output.append(prefix).append("SORTED OUTPUT: ON").append("\n");
+        }
         if (isPreAggregation) {
             output.append(prefix).append("PREAGGREGATION: ON").append("\n");
         } else {
@@ -460,6 +473,9 @@ public class OlapScanNode extends ScanNode {
         if (null != sortColumn) {
             msg.olap_scan_node.setSort_column(sortColumn);
         }
+        if (sortedOutput) {
+            msg.olap_scan_node.setSorted_output(true);
+        }
     }
 
     // export some tablets
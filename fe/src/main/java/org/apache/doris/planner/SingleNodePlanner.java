@@ -499,6 +499,14 @@ public class SingleNodePlanner {
                         // do nothing
                     } else if (aggExpr.getFnName().getFunction().equalsIgnoreCase("HLL_RAW_AGG")) {
                         // do nothing
+                    } else if (aggExpr.getFnName().getFunction().equalsIgnoreCase("BITMAP_UNION")
+                            || aggExpr.getFnName().getFunction().equalsIgnoreCase("BITMAP_UNION_COUNT")) {
+                        if (col.getAggregationType() != AggregateType.BITMAP_UNION) {
+                            turnOffReason = "Aggregate Operator not match: "
+                                    + aggExpr.getFnName().getFunction() + " <--> " + col.getAggregationType();
+                            returnColumnValidate = false;
+                            break;
+                        }
                     } else if (aggExpr.getFnName().getFunction().equalsIgnoreCase("NDV")) {
                         if ((!col.isKey())) {
                             turnOffReason = "NDV function with non-key column: " + col.getName();
@@ -78,10 +78,12 @@ import com.google.common.collect.ImmutableMap;
 import com.google.common.collect.Lists;
 import com.google.common.collect.Maps;
 import com.google.common.collect.Sets;
+import com.google.common.hash.Hashing;
 
 import org.apache.logging.log4j.LogManager;
 import org.apache.logging.log4j.Logger;
 import org.apache.thrift.TException;
+import org.apache.thrift.TSerializer;
 
 import java.text.DateFormat;
 import java.text.SimpleDateFormat;
@@ -118,6 +120,8 @@ public class Coordinator {
 
     // copied from TQueryExecRequest; constant across all fragments
     private TDescriptorTable descTable;
+    // hash of descTable, backends share the descriptors of fragments with the same one
+    private Long descTableHash;
 
     // Why we use query global?
     // When `NOW()` function is in sql, we need only one now(),
@@ -1271,6 +1275,19 @@ public class Coordinator {
         }
     }
 
+    // null if descTable could not be serialized
+    private Long getDescTableHash() {
+        if (descTableHash == null) {
+            try {
+                byte[] bytes = new TSerializer().serialize(descTable);
+                descTableHash = Hashing.murmur3_128().hashBytes(bytes).asLong();
+            } catch (TException e) {
+                LOG.warn("failed to serialize descriptor table", e);
+            }
+        }
+        return descTableHash;
+    }
+
     // execution parameters for a single fragment,
     // per-fragment can have multiple FInstanceExecParam,
     // used to assemble TPlanFragmentExecParas  
@@ -1296,6 +1313,9 @@ public class Coordinator {
                 params.setProtocol_version(PaloInternalServiceVersion.V1);
                 params.setFragment(fragment.toThrift());
                 params.setDesc_tbl(descTable);
+                if (getDescTableHash() != null) {
+                    params.setDesc_tbl_hash(descTableHash);
+                }
                 params.setParams(new TPlanFragmentExecParams());
                 params.setResource_info(tResourceInfo);
                 params.params.setQuery_id(queryId);
@@ -21,6 +21,7 @@ import org.apache.doris.catalog.Catalog;
 import org.apache.doris.common.FeMetaVersion;
 import org.apache.doris.common.io.Text;
 import org.apache.doris.common.io.Writable;
+import org.apache.doris.thrift.TExchangeCompression;
 import org.apache.doris.thrift.TQueryOptions;
 
 import org.apache.logging.log4j.LogManager;
@@ -67,6 +68,8 @@ public class SessionVariable implements Serializable, Writable {
     public static final String BATCH_SIZE = "batch_size";
     public static final String DISABLE_STREAMING_PREAGGREGATIONS = "disable_streaming_preaggregations";
     public static final String DISABLE_COLOCATE_JOIN = "disable_colocate_join";
+    // join colocated tables on their leading key columns by merging their sorted scans
+    public static final String ENABLE_SORT_MERGE_JOIN = "enable_sort_merge_join";
     public static final String PARALLEL_FRAGMENT_EXEC_INSTANCE_NUM = "parallel_fragment_exec_instance_num";
     public static final String ENABLE_INSERT_STRICT = "enable_insert_strict";
     public static final int MIN_EXEC_INSTANCE_NUM = 1;
@@ -74,6 +77,8 @@ public class SessionVariable implements Serializable, Writable {
     public static final String MT_DOP = "mt_dop";
     // if set to true, some of stmt will be forwarded to master FE to get result
     public static final String FORWARD_TO_MASTER = "forward_to_master";
+    // compression of the row batches sent by exchanges: none, snappy, lz4, zstd or adaptive
+    public static final String EXCHANGE_COMPRESSION = "exchange_compression";
 
     // max memory used on every backend.
     @VariableMgr.VarAttr(name = EXEC_MEM_LIMIT)
@@ -180,6 +185,9 @@ public class SessionVariable implements Serializable, Writable {
     @VariableMgr.VarAttr(name = DISABLE_COLOCATE_JOIN)
     private boolean disableColocateJoin = false;
 
+    @VariableMgr.VarAttr(name = ENABLE_SORT_MERGE_JOIN)
+    private boolean enableSortMergeJoin = false;
+
     /*
      * the parallel exec instance num for one Fragment in one BE
      * 1 means disable this feature
@@ -193,6 +201,10 @@ public class SessionVariable implements Serializable, Writable {
     @VariableMgr.VarAttr(name = FORWARD_TO_MASTER)
     private boolean forwardToMaster = false;
 
+    // empty to use compress_rowbatches of the backends
+    @VariableMgr.VarAttr(name = EXCHANGE_COMPRESSION)
+    private String exchangeCompression = "";
+
     public long getMaxExecMemByte() {
         return maxExecMemByte;
     }
@@ -425,6 +437,14 @@ public class SessionVariable implements Serializable, Writable {
         this.disableColocateJoin = disableColocateJoin;
     }
 
+    public boolean isEnableSortMergeJoin() {
+        return enableSortMergeJoin;
+    }
+
+    public void setEnableSortMergeJoin(boolean enableSortMergeJoin) {
+        this.enableSortMergeJoin = enableSortMergeJoin;
+    }
+
     public int getParallelExecInstanceNum() {
         return parallelExecInstanceNum;
     }
@@ -442,6 +462,11 @@ public class SessionVariable implements Serializable, Writable {
     public boolean getEnableInsertStrict() { return enableInsertStrict; }
     public void setEnableInsertStrict(boolean enableInsertStrict) { this.enableInsertStrict = enableInsertStrict; }
 
+    public String getExchangeCompression() { return exchangeCompression; }
+    public void setExchangeCompression(String exchangeCompression) {
+        this.exchangeCompression = exchangeCompression;
+    }
+
     
    // Serialize to thrift object
     public boolean getForwardToMaster() {
@@ -469,6 +494,9 @@ public class SessionVariable implements Serializable, Writable {
 
         tResult.setBatch_size(batchSize);
         tResult.setDisable_stream_preaggregations(disableStreamPreaggregations);
+        if (!exchangeCompression.isEmpty()) {
+            tResult.setExchange_compression(TExchangeCompression.valueOf(exchangeCompression.toUpperCase()));
+        }
         return tResult;
     }
 
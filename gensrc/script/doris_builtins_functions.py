@@ -203,7 +203,18 @@ visible_functions = [
         '15FunctionContextERKNS1_9StringValES6_'],
     [['date_format'], 'VARCHAR', ['DATETIME', 'VARCHAR'],
         '_ZN5doris18TimestampFunctions11date_formatEPN9doris_udf'
-        '15FunctionContextERKNS1_11DateTimeValERKNS1_9StringValE'],
+        '15FunctionContextERKNS1_11DateTimeValERKNS1_9StringValE',
+        '_ZN5doris18TimestampFunctions19date_format_prepareEPN9doris_udf'
+        '15FunctionContextENS2_18FunctionStateScopeE',
+        '_ZN5doris18TimestampFunctions17date_format_closeEPN9doris_udf'
+        '15FunctionContextENS2_18FunctionStateScopeE'],
+    [['convert_tz'], 'DATETIME', ['DATETIME', 'VARCHAR', 'VARCHAR'],
+        '_ZN5doris18TimestampFunctions10convert_tzEPN9doris_udf'
+        '15FunctionContextERKNS1_11DateTimeValERKNS1_9StringValES9_',
+        '_ZN5doris18TimestampFunctions18convert_tz_prepareEPN9doris_udf'
+        '15FunctionContextENS2_18FunctionStateScopeE',
+        '_ZN5doris18TimestampFunctions16convert_tz_closeEPN9doris_udf'
+        '15FunctionContextENS2_18FunctionStateScopeE'],
     [['date', 'to_date'], 'DATE', ['DATETIME'],
         '_ZN5doris18TimestampFunctions7to_dateEPN9doris_udf15FunctionContextERKNS1_11DateTimeValE'],
 
@@ -585,6 +596,16 @@ visible_functions = [
     [['hll_hash'], 'VARCHAR', ['VARCHAR'],
         '_ZN5doris16HllHashFunctions8hll_hashEPN9doris_udf15FunctionContextERKNS1_9StringValE'],
 
+    # bitmap function
+    [['to_bitmap'], 'VARCHAR', ['VARCHAR'],
+        '_ZN5doris15BitmapFunctions9to_bitmapEPN9doris_udf15FunctionContextERKNS1_9StringValE'],
+    [['bitmap_count'], 'BIGINT', ['VARCHAR'],
+        '_ZN5doris15BitmapFunctions12bitmap_countEPN9doris_udf15FunctionContextERKNS1_9StringValE'],
+    [['bitmap_or'], 'VARCHAR', ['VARCHAR', 'VARCHAR'],
+        '_ZN5doris15BitmapFunctions9bitmap_orEPN9doris_udf15FunctionContextERKNS1_9StringValES6_'],
+    [['bitmap_and'], 'VARCHAR', ['VARCHAR', 'VARCHAR'],
+        '_ZN5doris15BitmapFunctions10bitmap_andEPN9doris_udf15FunctionContextERKNS1_9StringValES6_'],
+
     # aes and base64 function
     [['aes_encrypt'], 'VARCHAR', ['VARCHAR', 'VARCHAR'],
         '_ZN5doris19EncryptionFunctions11aes_encryptEPN9doris_udf'
@@ -607,6 +628,8 @@ visible_functions = [
     # geo functions
     [['ST_Point'], 'VARCHAR', ['DOUBLE', 'DOUBLE'],
         '_ZN5doris12GeoFunctions8st_pointEPN9doris_udf15FunctionContextERKNS1_9DoubleValES6_'],
+    [['ST_CellId'], 'BIGINT', ['DOUBLE', 'DOUBLE'],
+        '_ZN5doris12GeoFunctions10st_cell_idEPN9doris_udf15FunctionContextERKNS1_9DoubleValES6_'],
     [['ST_X'], 'DOUBLE', ['VARCHAR'],
         '_ZN5doris12GeoFunctions4st_xEPN9doris_udf15FunctionContextERKNS1_9StringValE'],
     [['ST_Y'], 'DOUBLE', ['VARCHAR'],
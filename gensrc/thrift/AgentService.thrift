@@ -30,6 +30,8 @@ struct TColumn {
     5: optional bool is_allow_null
     6: optional string default_value
     7: optional bool is_bloom_filter_column
+    8: optional bool has_bitmap_index
+    9: optional bool has_ngram_index
 }
 
 struct TTabletSchema {
@@ -39,6 +41,13 @@ struct TTabletSchema {
     4: required Types.TStorageType storage_type
     5: required list<TColumn> columns
     6: optional double bloom_filter_fpp
+    7: optional Types.TStorageCompressKind compress_kind
+    // zstd level, 0 means zstd's default
+    8: optional i32 compress_level
+    // train a zstd dictionary per segment for string columns
+    9: optional bool compress_dictionary
+    // keep the rows of every rowset aggregated by this many leading keys too
+    10: optional i32 pre_aggregate_key_num
 }
 
 struct TCreateTabletReq {
@@ -174,6 +183,9 @@ enum TAgentServiceVersion {
 struct TPublishVersionRequest {
     1: required Types.TTransactionId transaction_id
     2: required list<TPartitionVersionInfo> partition_version_infos
+    // span the publish is traced under, sampled publishes are traced under
+    // their transaction id if it is unset
+    3: optional Types.TTraceContext trace_context
 }
 
 struct TClearAlterTaskRequest {
@@ -22,6 +22,7 @@ include "Exprs.thrift"
 include "Types.thrift"
 include "Descriptors.thrift"
 include "Partitions.thrift"
+include "PlanNodes.thrift"
 
 enum TDataSinkType {
     DATA_STREAM_SINK,
@@ -48,7 +49,20 @@ struct TDataStreamSink {
 }
 
 // Reserved for 
+enum TResultSinkFormat {
+    // rows in the text protocol of MySQL
+    MYSQL_TEXT,
+    // rows in the binary protocol of the results of prepared statements, the
+    // FE sends them as they are
+    MYSQL_BINARY,
+    // every result batch has one Arrow IPC stream of a record batch instead
+    // of rows, for clients fetching results from the BEs
+    ARROW
+}
+
 struct TResultSink {
+    // MYSQL_TEXT if not set
+    1: optional TResultSinkFormat format
 }
 
 struct TMysqlTableSink {
@@ -83,6 +97,14 @@ struct TExportSink {
     // properties need to access broker.
     5: optional list<Types.TNetworkAddress> broker_addresses
     6: optional map<string, string> properties;
+    // FORMAT_CSV_PLAIN if unset, FORMAT_PARQUET writes the rows column-wise
+    7: optional PlanNodes.TFileFormatType format
+    // a new file is started once a file has this many bytes, unlimited if unset or 0
+    8: optional i64 max_file_size
+    // codec of parquet files: snappy, gzip, lz4, zstd or none, snappy if unset
+    9: optional string compression
+    // names of the columns of parquet files, col_<i> if unset
+    10: optional list<string> column_names
 }
 
 struct TOlapTableSink {
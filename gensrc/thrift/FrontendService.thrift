@@ -497,6 +497,8 @@ struct TStreamLoadPutRequest {
     15: optional string partitions
     16: optional i64 auth_code
     17: optional bool negative
+    // only valid when format is json, json paths of columns separated by ','
+    18: optional string jsonpaths
 }
 
 struct TStreamLoadPutResult {
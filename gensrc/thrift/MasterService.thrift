@@ -23,6 +23,30 @@ include "PaloInternalService.thrift"
 include "Types.thrift"
 include "Status.thrift"
 
+// value distribution of a column of a tablet, merged over its versions
+struct TColumnDistribution {
+    1: required string column_name
+    2: optional i64 num_rows
+    3: optional i64 null_count
+    4: optional i64 ndv
+    // hashes of the values in the hll encoding of the BE, to merge tablets
+    5: optional binary hll
+    // upper bounds and row counts of the buckets of an equi-depth histogram
+    6: optional list<string> histogram_bounds
+    7: optional list<i64> histogram_counts
+}
+
+// reads and writes of a tablet, decayed with the half-life tablet_heat_half_life_sec
+// of the BE so that recent activity weighs more
+struct TTabletHeat {
+    1: optional i64 rows_scanned
+    2: optional i64 bytes_scanned
+    3: optional i64 scan_count
+    4: optional i64 scan_time_us
+    5: optional i64 rows_written
+    6: optional i64 bytes_written
+}
+
 struct TTabletInfo {
     1: required Types.TTabletId tablet_id
     2: required Types.TSchemaHash schema_hash
@@ -36,6 +60,8 @@ struct TTabletInfo {
     10: optional i64 path_hash
     11: optional bool version_miss
     12: optional bool used
+    13: optional list<TColumnDistribution> column_distributions
+    14: optional TTabletHeat heat
 }
 
 struct TFinishTaskRequest {
@@ -79,6 +105,8 @@ struct TReportRequest {
     5: optional map<string, TDisk> disks // string root_path
     6: optional bool force_recovery
     7: optional list<TTablet> tablet_list
+    // 'tablets' only has the tablets changed since the last report
+    8: optional bool incremental_tablet_report
 }
 
 struct TMasterResult {
@@ -55,6 +55,16 @@ enum TPrefetchMode {
     HT_BUCKET
 }
 
+// compression of the row batches sent by exchanges, ADAPTIVE chooses among
+// NONE, LZ4 and ZSTD per channel by the compression ratio and time
+enum TExchangeCompression {
+    NONE,
+    SNAPPY,
+    LZ4,
+    ZSTD,
+    ADAPTIVE
+}
+
 struct TMysqlErrorHubInfo {
     1: required string host;
     2: required i32 port;
@@ -126,6 +136,13 @@ struct TQueryOptions {
 
   // multithreaded degree of intra-node parallelism
   27: optional i32 mt_dop = 0;
+
+  // max time an olap scan waits for the runtime filters published by hash
+  // joins, it scans without the filters which are not arrived in time
+  28: optional i32 runtime_filter_wait_time_ms = 1000;
+
+  // SNAPPY if compress_rowbatches of the backend is set and NONE else if not set
+  29: optional TExchangeCompression exchange_compression
 }
 
 // A scan range plus the parameters needed to execute that scan.
@@ -235,6 +252,13 @@ struct TExecPlanFragmentParams {
   12: optional string db_name
   13: optional i64 load_job_id
   14: optional TLoadErrorHubInfo load_error_hub_info
+
+  // hash of desc_tbl, instances of the same hash may share its descriptors
+  15: optional i64 desc_tbl_hash
+
+  // span of the coordinator the fragment is traced under, the backend traces
+  // sampled queries under their query id if it is unset
+  16: optional Types.TTraceContext trace_context
 }
 
 struct TExecPlanFragmentResult {
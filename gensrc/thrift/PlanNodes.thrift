@@ -86,6 +86,9 @@ struct TPaloScanRange {
   7: optional list<TKeyRange> partition_column_ranges
   8: optional string index_name
   9: optional string table_name
+  // set by the backend to scan only the versions from it to 'version', whose
+  // rows are added to cached results of the older ones
+  10: optional string start_version
 }
 
 enum TFileFormatType {
@@ -95,7 +98,10 @@ enum TFileFormatType {
     FORMAT_CSV_LZO,
     FORMAT_CSV_BZ2,
     FORMAT_CSV_LZ4FRAME,
-    FORMAT_CSV_LZOP
+    FORMAT_CSV_LZOP,
+    FORMAT_PARQUET,
+    // one json object in every line
+    FORMAT_JSON
 }
 
 // One broker range information.
@@ -111,6 +117,9 @@ struct TBrokerRangeDesc {
     6: required i64 size
     // used to get stream for this load
     7: optional Types.TUniqueId load_id
+    // size of the whole file, columnar formats read their footer at its end.
+    // It is got from broker if not set.
+    8: optional i64 file_size
 }
 
 struct TBrokerScanRangeParams {
@@ -136,6 +145,12 @@ struct TBrokerScanRangeParams {
 
     // If partition_ids is set, data that doesn't in this partition will be filtered.
     8: optional list<i64> partition_ids
+    // If set, fields may be quoted by this char, separators and line delimiters
+    // between quotes are part of the field
+    9: optional byte enclose
+    // json path of every src slot, like "$.a.b", in the order of src_slot_ids.
+    // If not set, slots are got from top level keys of their names.
+    10: optional list<string> json_paths
 }
 
 // Broker scan range
@@ -180,9 +195,35 @@ struct TBrokerScanNode {
     3: optional list<Partitions.TRangePartition> partition_infos
 }
 
+// a group by column of an aggregation pushed down into elasticsearch
+struct TEsGroupBy {
+    1: required string column
+    // buckets the dates of the column by this interval of a date_histogram,
+    // e.g. "1h" or "1d", instead of grouping by their terms
+    2: optional string date_interval
+}
+
+// an aggregate function pushed down into elasticsearch, one of count, sum,
+// min and max
+struct TEsAggregateFunction {
+    1: required string function_name
+    // unset for count(*)
+    2: optional string column
+}
+
+// the aggregation above an es scan evaluated by elasticsearch, the tuple of
+// the scan then holds one row per bucket of a shard: the group by columns
+// followed by the intermediate results of the functions, which are merged
+// by the aggregation node above the scan
+struct TEsAggregation {
+    1: required list<TEsGroupBy> group_by
+    2: required list<TEsAggregateFunction> functions
+}
+
 struct TEsScanNode {
     1: required Types.TTupleId tuple_id
     2: optional map<string,string> properties
+    3: optional TEsAggregation aggregation
 }
 
 struct TMiniLoadEtlFunction {
@@ -234,12 +275,36 @@ struct TMetaScanNode {
   5: optional string user
 }
 
+// A runtime filter the scan waits for, it is applied to 'column_name'
+struct TOlapScanRuntimeFilter {
+  1: required i32 filter_id
+  2: required string column_name
+  // number of join instances publishing this filter, the parts of all of
+  // them are merged before the filter is applied
+  3: optional i32 num_sources = 1
+}
+
+// Aggregates of a scan with no predicates left that it may answer from the
+// metadata of rowsets in place of their rows. MINMAX returns the minimum and
+// the maximum of every column as two rows, COUNT returns as many rows as
+// there are, without reading them.
+enum TPushAggOp {
+  NONE,
+  MINMAX,
+  COUNT
+}
+
 struct TOlapScanNode {
   1: required Types.TTupleId tuple_id
   2: required list<string> key_column_name
   3: required list<Types.TPrimitiveType> key_column_type
   4: required bool is_preaggregation
   5: optional string sort_column
+  // runtime filters published by hash joins which are applied to this scan
+  6: optional list<TOlapScanRuntimeFilter> runtime_filters
+  7: optional TPushAggOp push_agg_op
+  // the rows are returned in the order of the key columns, for the merge join above
+  8: optional bool sorted_output
 }
 struct TEqJoinCondition {
   // left-hand side of "<a> = <b>"
@@ -268,6 +333,22 @@ enum TJoinOp {
   NULL_AWARE_LEFT_ANTI_JOIN
 }
 
+struct TRuntimeFilterTarget {
+  1: required Types.TUniqueId target_fragment_instance_id
+  // brpc address of the backend running the target fragment instance
+  2: required Types.TNetworkAddress target_fragment_instance_addr
+}
+
+struct TRuntimeFilterDesc {
+  1: required i32 filter_id
+  // index of the equi-join conjunct whose build side values are filtered on
+  2: required i32 expr_order
+  3: required list<TRuntimeFilterTarget> targets
+  // size the bloom filter for this many entries instead of the number of build
+  // rows, parts of a partitioned join can only be merged if they are equal
+  4: optional i64 bloom_filter_entries
+}
+
 struct THashJoinNode {
   1: required TJoinOp join_op
 
@@ -282,6 +363,14 @@ struct THashJoinNode {
   // If true, this join node can (but may choose not to) generate slot filters
   // after constructing the build side that can be applied to the probe side.
   5: optional bool add_probe_filters
+
+  // filters built from the build side which are published to the scans of
+  // the probe side
+  6: optional list<TRuntimeFilterDesc> runtime_filters
+
+  // true if the build side is broadcast: all the instances of the fragment
+  // receive the same build rows
+  7: optional bool is_broadcast
 }
 
 struct TMergeJoinNode {
@@ -291,6 +380,11 @@ struct TMergeJoinNode {
   // anything from the ON or USING clauses (but *not* the WHERE clause) that's not an
   // equi-join predicate
   2: optional list<Exprs.TExpr> other_join_conjuncts
+
+  // if set, only INNER_JOIN, the children return their rows sorted by the left and
+  // right exprs of cmp_conjuncts and are joined on them. Otherwise the rows of the
+  // children are merged.
+  3: optional TJoinOp join_op
 }
 
 enum TAggregationOp {
@@ -127,7 +127,8 @@ enum TAggregationType {
     MIN,
     REPLACE,
     HLL_UNION,
-    NONE
+    NONE,
+    BITMAP_UNION
 }
 
 enum TPushType {
@@ -197,6 +198,14 @@ struct TUniqueId {
   2: required i64 lo
 }
 
+// Wire format for the span a remote span is a child of, only sent for sampled
+// traces
+struct TTraceContext {
+  1: required i64 trace_id_hi
+  2: required i64 trace_id_lo
+  3: required i64 span_id
+}
+
 enum QueryState {
   CREATED,
   INITIALIZED,
@@ -320,6 +329,13 @@ enum TKeysType {
     AGG_KEYS
 }
 
+enum TStorageCompressKind {
+    NONE,
+    LZO,
+    LZ4,
+    ZSTD
+}
+
 enum TPriority {
     NORMAL,
     HIGH
@@ -144,19 +144,33 @@ ${DORIS_TEST_BINARY_DIR}/util/doris_metrics_test
 ${DORIS_TEST_BINARY_DIR}/util/system_metrics_test
 ${DORIS_TEST_BINARY_DIR}/util/core_local_test
 ${DORIS_TEST_BINARY_DIR}/util/arena_test
+${DORIS_TEST_BINARY_DIR}/util/roaring_bitmap_test
+${DORIS_TEST_BINARY_DIR}/util/tdigest_test
+${DORIS_TEST_BINARY_DIR}/util/fair_share_thread_pool_test
+${DORIS_TEST_BINARY_DIR}/util/work_stealing_queue_test
+${DORIS_TEST_BINARY_DIR}/util/spsc_queue_test
 ${DORIS_TEST_BINARY_DIR}/util/types_test
 ${DORIS_TEST_BINARY_DIR}/util/json_util_test
 ${DORIS_TEST_BINARY_DIR}/util/byte_buffer_test2
 ${DORIS_TEST_BINARY_DIR}/util/uid_util_test
 ${DORIS_TEST_BINARY_DIR}/util/aes_util_test
 ${DORIS_TEST_BINARY_DIR}/util/string_util_test
+${DORIS_TEST_BINARY_DIR}/util/mysql_row_buffer_test
+${DORIS_TEST_BINARY_DIR}/util/rate_limiter_test
+${DORIS_TEST_BINARY_DIR}/util/lock_stats_test
 
 ## Running common Unittest
 ${DORIS_TEST_BINARY_DIR}/common/resource_tls_test
 
+## Running codegen unit test
+${DORIS_TEST_BINARY_DIR}/codegen/codegen_cache_test
+
 ## Running exprs unit test
 ${DORIS_TEST_BINARY_DIR}/exprs/string_functions_test
+${DORIS_TEST_BINARY_DIR}/exprs/timestamp_functions_test
 ${DORIS_TEST_BINARY_DIR}/exprs/json_function_test
+${DORIS_TEST_BINARY_DIR}/exprs/expr_batch_test
+${DORIS_TEST_BINARY_DIR}/exprs/expr_rewrite_test
 
 ## Running geo unit test
 ${DORIS_TEST_BINARY_DIR}/geo/geo_functions_test
@@ -170,14 +184,31 @@ ${DORIS_TEST_BINARY_DIR}/exec/plain_text_line_reader_bzip_test
 ${DORIS_TEST_BINARY_DIR}/exec/plain_text_line_reader_lz4frame_test
 ${DORIS_TEST_BINARY_DIR}/exec/plain_text_line_reader_lzop_test
 ${DORIS_TEST_BINARY_DIR}/exec/broker_scanner_test
+${DORIS_TEST_BINARY_DIR}/exec/csv_tokenizer_test
+${DORIS_TEST_BINARY_DIR}/exec/join_hash_table_test
+${DORIS_TEST_BINARY_DIR}/exec/partitioned_hash_join_node_test
+${DORIS_TEST_BINARY_DIR}/exec/analytic_eval_node_test
+${DORIS_TEST_BINARY_DIR}/exec/aggregation_node_test
+${DORIS_TEST_BINARY_DIR}/exec/new_partitioned_aggregation_node_test
+${DORIS_TEST_BINARY_DIR}/exec/cross_join_node_test
+${DORIS_TEST_BINARY_DIR}/exec/merge_join_node_test
+${DORIS_TEST_BINARY_DIR}/exec/mysql_scan_ranges_test
+${DORIS_TEST_BINARY_DIR}/exec/line_chunk_splitter_test
+${DORIS_TEST_BINARY_DIR}/exec/parquet_reader_test
+${DORIS_TEST_BINARY_DIR}/exec/parquet_writer_test
+${DORIS_TEST_BINARY_DIR}/exec/json_line_parser_test
+${DORIS_TEST_BINARY_DIR}/exec/pipe_line_reader_test
 ${DORIS_TEST_BINARY_DIR}/exec/broker_scan_node_test
 ${DORIS_TEST_BINARY_DIR}/exec/es_scan_node_test
 ${DORIS_TEST_BINARY_DIR}/exec/es_http_scan_node_test
 ${DORIS_TEST_BINARY_DIR}/exec/es_predicate_test
 ${DORIS_TEST_BINARY_DIR}/exec/es_scan_reader_test
+${DORIS_TEST_BINARY_DIR}/exec/es_agg_reader_test
 ${DORIS_TEST_BINARY_DIR}/exec/es_query_builder_test
 ${DORIS_TEST_BINARY_DIR}/exec/olap_table_info_test
 ${DORIS_TEST_BINARY_DIR}/exec/olap_table_sink_test
+${DORIS_TEST_BINARY_DIR}/exec/scanner_concurrency_controller_test
+${DORIS_TEST_BINARY_DIR}/exec/normalized_sort_key_test
 
 ## Running runtime Unittest
 ${DORIS_TEST_BINARY_DIR}/runtime/fragment_mgr_test
@@ -186,6 +217,7 @@ ${DORIS_TEST_BINARY_DIR}/runtime/datetime_value_test
 ${DORIS_TEST_BINARY_DIR}/runtime/large_int_value_test
 ${DORIS_TEST_BINARY_DIR}/runtime/string_value_test
 ${DORIS_TEST_BINARY_DIR}/runtime/free_list_test
+${DORIS_TEST_BINARY_DIR}/runtime/chunk_allocator_test
 ${DORIS_TEST_BINARY_DIR}/runtime/string_buffer_test
 ${DORIS_TEST_BINARY_DIR}/runtime/stream_load_pipe_test
 ${DORIS_TEST_BINARY_DIR}/runtime/tablet_writer_mgr_test
@@ -204,29 +236,56 @@ ${DORIS_TEST_BINARY_DIR}/olap/bit_field_test
 ${DORIS_TEST_BINARY_DIR}/olap/byte_buffer_test
 ${DORIS_TEST_BINARY_DIR}/olap/run_length_byte_test
 ${DORIS_TEST_BINARY_DIR}/olap/run_length_integer_test
+${DORIS_TEST_BINARY_DIR}/olap/bit_packed_integer_test
+${DORIS_TEST_BINARY_DIR}/olap/xor_float_test
+${DORIS_TEST_BINARY_DIR}/olap/compress_test
+${DORIS_TEST_BINARY_DIR}/olap/column_writer_pool_test
+${DORIS_TEST_BINARY_DIR}/olap/sorted_run_file_test
+${DORIS_TEST_BINARY_DIR}/olap/pre_aggregate_test
 ${DORIS_TEST_BINARY_DIR}/olap/stream_index_test
 ${DORIS_TEST_BINARY_DIR}/olap/lru_cache_test
 ${DORIS_TEST_BINARY_DIR}/olap/bloom_filter_test
 ${DORIS_TEST_BINARY_DIR}/olap/bloom_filter_index_test
+${DORIS_TEST_BINARY_DIR}/olap/bitmap_index_test
+${DORIS_TEST_BINARY_DIR}/olap/ngram_index_test
 ${DORIS_TEST_BINARY_DIR}/olap/row_block_test
 ${DORIS_TEST_BINARY_DIR}/olap/comparison_predicate_test
 ${DORIS_TEST_BINARY_DIR}/olap/in_list_predicate_test
 ${DORIS_TEST_BINARY_DIR}/olap/null_predicate_test
+${DORIS_TEST_BINARY_DIR}/olap/bloom_filter_predicate_test
 ${DORIS_TEST_BINARY_DIR}/olap/file_helper_test
+${DORIS_TEST_BINARY_DIR}/olap/packed_file_test
+${DORIS_TEST_BINARY_DIR}/olap/cold_storage_test
+${DORIS_TEST_BINARY_DIR}/olap/read_ahead_test
 ${DORIS_TEST_BINARY_DIR}/olap/file_utils_test
 ${DORIS_TEST_BINARY_DIR}/olap/delete_handler_test
+${DORIS_TEST_BINARY_DIR}/olap/delete_bitmap_test
 ${DORIS_TEST_BINARY_DIR}/olap/column_reader_test
 ${DORIS_TEST_BINARY_DIR}/olap/row_cursor_test
 ${DORIS_TEST_BINARY_DIR}/olap/skiplist_test
 ${DORIS_TEST_BINARY_DIR}/olap/serialize_test
 ${DORIS_TEST_BINARY_DIR}/olap/olap_header_manager_test
 ${DORIS_TEST_BINARY_DIR}/olap/olap_meta_test
+${DORIS_TEST_BINARY_DIR}/olap/cumulative_compaction_policy_test
 ${DORIS_TEST_BINARY_DIR}/olap/delta_writer_test
 ${DORIS_TEST_BINARY_DIR}/olap/field_info_test
+${DORIS_TEST_BINARY_DIR}/olap/segment_group_builder_test
+${DORIS_TEST_BINARY_DIR}/olap/hll_test
+${DORIS_TEST_BINARY_DIR}/olap/column_distribution_test
+${DORIS_TEST_BINARY_DIR}/olap/tablet_heat_test
+${DORIS_TEST_BINARY_DIR}/olap/loser_tree_test
 
 # Running routine load test
 ${DORIS_TEST_BINARY_DIR}/runtime/kafka_consumer_pipe_test
 ${DORIS_TEST_BINARY_DIR}/runtime/routine_load_task_executor_test
+${DORIS_TEST_BINARY_DIR}/runtime/runtime_filter_test
+${DORIS_TEST_BINARY_DIR}/runtime/exchange_compression_policy_test
+${DORIS_TEST_BINARY_DIR}/runtime/string_search_test
+${DORIS_TEST_BINARY_DIR}/runtime/fragment_result_cache_test
+${DORIS_TEST_BINARY_DIR}/runtime/descriptor_tbl_cache_test
+${DORIS_TEST_BINARY_DIR}/runtime/column_batch_test
+${DORIS_TEST_BINARY_DIR}/runtime/admission_controller_test
+${DORIS_TEST_BINARY_DIR}/runtime/tracer_test
 
 ## Running agent unittest
 # Prepare agent testdata
@@ -554,6 +554,8 @@ build_arrow() {
     else
         cp -rf ./zstd_ep-install/lib/libzstd.a $TP_INSTALL_DIR/lib64/libzstd.a
     fi
+    cp -rf ./zstd_ep-install/include/zstd.h ./zstd_ep-install/include/zdict.h \
+        ./zstd_ep-install/include/zstd_errors.h $TP_INSTALL_DIR/include/
     cp -rf ./double-conversion_ep/src/double-conversion_ep/lib/libdouble-conversion.a $TP_INSTALL_DIR/lib64/libdouble-conversion.a
     cp -rf ./uriparser_ep-install/lib/liburiparser.a $TP_INSTALL_DIR/lib64/liburiparser.a
 }